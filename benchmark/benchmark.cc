@@ -0,0 +1,1277 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+// Micro-benchmarks of ozz runtime jobs: SamplingJob, BlendingJob,
+// LocalToModelJob, SkinningJob and animation archive loading.
+// Benchmarks run on synthetic skeletons and animations, generated with
+// RawSkeleton and RawAnimation offline builders, across skeleton sizes, clip
+// lengths, blending layer counts and skinning influence counts.
+// Every result is reported as a time per processed unit (ns/joint, ns/vertex,
+// ns/byte), so regressions can be compared regardless of data sizes.
+// Load benchmarks (bank_load and skeleton_load) measure startup time across
+// load paths: archives read from memory, from a File, a BufferedStream or a
+// CompressedStream, and animation blobs read with a single call or memory
+// mapped. They report a time per loaded object, and the throughput in MB/s.
+// The millipede benchmark measures the full per character pipeline (sampling,
+// blending, local-to-model and skinning) on procedural millipedes of the
+// millipede sample, across character, joint and thread counts, characters
+// being updated concurrently on a tasks::ThreadPool. Its time per character
+// for every thread count gives the scaling curve.
+
+#ifdef _WIN32
+#include <windows.h>
+#else  // _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/geometry/runtime/skinning_job.h"
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/tasks/thread_pool.h"
+
+#include "ozz/options/options.h"
+
+#include "../samples/millipede/millipede.h"
+
+OZZ_OPTIONS_DECLARE_FLOAT(
+  min_time,
+  "Minimum time (in seconds) spent measuring each benchmark.",
+  .05f,
+  false)
+
+OZZ_OPTIONS_DECLARE_INT(
+  repetitions,
+  "Number of times each benchmark is measured, the fastest one being kept.",
+  3,
+  false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+  filter,
+  "Only runs benchmarks whose name contains this string.",
+  "",
+  false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+  report,
+  "Optional path to a csv file benchmark results are written to.",
+  "",
+  false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+  baseline,
+  "Optional path to a csv baseline file, as written by report option, that "
+  "results are compared against.",
+  "",
+  false)
+
+OZZ_OPTIONS_DECLARE_FLOAT(
+  threshold,
+  "Maximum ratio of a result to its baseline before it's considered a "
+  "regression.",
+  1.2f,
+  false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+  directory,
+  "Directory where load benchmarks write their temporary files.",
+  ".",
+  false)
+
+OZZ_OPTIONS_DECLARE_BOOL(
+  cold,
+  "Drops load benchmarks files from the page cache before every load, to "
+  "measure cold loads from the storage device (linux only).",
+  false,
+  false)
+
+OZZ_OPTIONS_DECLARE_INT(
+  threads,
+  "Maximum number of threads of the millipede benchmark, 0 for the number of "
+  "hardware threads.",
+  0,
+  false)
+
+namespace {
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+
+// Gets a monotonic time, in seconds.
+double Now() {
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+#else  // _WIN32
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif  // _WIN32
+}
+
+// Calls _fct _iterations times. Returns the overall duration in seconds, or a
+// negative value if any call failed.
+template <typename _Fct>
+double Time(_Fct& _fct, int _iterations) {
+  bool success = true;
+  const double begin = Now();
+  for (int i = 0; i < _iterations; ++i) {
+    success &= _fct();
+  }
+  const double elapsed = Now() - begin;
+  return success ? elapsed : -1.;
+}
+
+// Calls _fct repeatedly, doubling the number of calls until their overall
+// duration exceeds min_time option. The measure is then repeated according to
+// repetitions option, keeping the fastest one to limit system noise.
+// Returns the mean duration of a call, in ns, or a negative value if any call
+// failed.
+template <typename _Fct>
+double Measure(_Fct& _fct) {
+  if (!_fct()) {  // Warms up caches.
+    return -1.;
+  }
+  int iterations = 1;
+  double elapsed = Time(_fct, iterations);
+  for (; elapsed >= 0. && elapsed < OPTIONS_min_time &&
+         iterations < (1 << 30);
+       elapsed = Time(_fct, iterations)) {
+    iterations *= 2;
+  }
+  for (int i = 1; i < OPTIONS_repetitions && elapsed >= 0.; ++i) {
+    const double repetition = Time(_fct, iterations);
+    elapsed = repetition < elapsed ? repetition : elapsed;
+  }
+  return elapsed < 0. ? -1. : elapsed * 1e9 / iterations;
+}
+
+// Defines a benchmark result.
+struct Result {
+  char name[32];
+  char parameters[64];
+  const char* unit;
+  double ns_per_unit;
+};
+
+// Benchmark results, in execution order.
+ozz::Vector<Result>::Std g_results;
+
+// Tests if benchmark _name is selected by filter option.
+bool Selected(const char* _name) {
+  return std::strstr(_name, OPTIONS_filter) != NULL;
+}
+
+// Measures _fct and pushes its result, _units being the number of units
+// processed by a call. If _bytes isn't 0, it's the number of bytes read by a
+// call, used to output a throughput.
+// Returns false if _fct failed.
+template <typename _Fct>
+bool Run(const char* _name, const char* _parameters,
+         const char* _unit, int _units, _Fct& _fct, size_t _bytes = 0) {
+  const double ns = Measure(_fct);
+  if (ns < 0.) {
+    ozz::log::Err() << "Benchmark " << _name << " (" << _parameters <<
+      ") failed." << std::endl;
+    return false;
+  }
+  Result result;
+  std::strncpy(result.name, _name, sizeof(result.name) - 1);
+  result.name[sizeof(result.name) - 1] = 0;
+  std::strncpy(result.parameters, _parameters, sizeof(result.parameters) - 1);
+  result.parameters[sizeof(result.parameters) - 1] = 0;
+  result.unit = _unit;
+  result.ns_per_unit = ns / _units;
+  g_results.push_back(result);
+
+  char line[160];
+  int length = std::sprintf(line, "%-16s %-32s %10.3f ns/%s",
+                            result.name, result.parameters,
+                            result.ns_per_unit, _unit);
+  if (_bytes != 0) {
+    std::sprintf(line + length, " %10.1f MB/s", _bytes * 1e3 / ns);
+  }
+  ozz::log::Out() << line << std::endl;
+  return true;
+}
+
+// Recursively fills _joint hierarchy with _count joints, including _joint.
+// Each joint has up to 3 children, which makes a reasonably deep and wide
+// hierarchy.
+void FillJoint(RawSkeleton::Joint* _joint, int _count, int* _index) {
+  char name[16];
+  std::sprintf(name, "joint%d", (*_index)++);
+  _joint->name = name;
+  _joint->transform = ozz::math::Transform::identity();
+  _joint->transform.translation = ozz::math::Float3(0.f, .1f, 0.f);
+
+  const int remaining = _count - 1;
+  const int num_children = remaining < 3 ? remaining : 3;
+  _joint->children.resize(num_children);
+  for (int i = 0; i < num_children; ++i) {
+    const int count =
+      remaining / num_children + (i < remaining % num_children ? 1 : 0);
+    FillJoint(&_joint->children[i], count, _index);
+  }
+}
+
+// Builds a skeleton of _num_joints joints.
+Skeleton* BuildSkeleton(int _num_joints) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  int index = 0;
+  FillJoint(&raw_skeleton.roots[0], _num_joints, &index);
+  ozz::animation::offline::SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation of _duration seconds for _num_tracks joints.
+// Translations and rotations are keyed at 30 keys per second, with different
+// values for every joint and key.
+Animation* BuildAnimation(int _num_tracks, float _duration) {
+  RawAnimation raw_animation;
+  raw_animation.duration = _duration;
+  raw_animation.tracks.resize(_num_tracks);
+  const int num_keys = static_cast<int>(_duration * 30.f) + 1;
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = _duration * k / (num_keys - 1);
+      const float phase = time * 3.f + i * .7f;
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(std::sin(phase) * .1f, .1f, 0.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float4(0.f, 0.f, 1.f, std::cos(phase)))};
+      track.rotations.push_back(rkey);
+    }
+    const RawAnimation::ScaleKey skey = {0.f, ozz::math::Float3::one()};
+    track.scales.push_back(skey);
+  }
+  ozz::animation::offline::AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Benchmarked skeleton sizes.
+const int kNumJoints[] = {8, 64, 256, 1023};
+
+// Benchmarked animations durations, in seconds.
+const float kDurations[] = {1.f, 10.f};
+
+// Samples the animation, moving time forward every call so that cache
+// updates are included.
+struct SamplingFct {
+  bool operator()() {
+    job.time += 1.f / 60.f;
+    if (job.time > job.animation->duration()) {
+      job.time = 0.f;
+    }
+    return job.Run();
+  }
+  ozz::animation::SamplingJob job;
+};
+
+bool BenchmarkSampling() {
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  bool success = true;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(kNumJoints); ++i) {
+    const int num_joints = kNumJoints[i];
+    for (size_t d = 0; d < OZZ_ARRAY_SIZE(kDurations); ++d) {
+      Animation* animation = BuildAnimation(num_joints, kDurations[d]);
+      ozz::animation::SamplingCache cache(num_joints);
+      ozz::Range<ozz::math::SoaTransform> locals =
+        allocator->AllocateRange<ozz::math::SoaTransform>(
+          (num_joints + 3) / 4);
+
+      SamplingFct fct;
+      fct.job.animation = animation;
+      fct.job.cache = &cache;
+      fct.job.output = locals;
+
+      char parameters[64];
+      std::sprintf(parameters, "joints=%d duration=%gs",
+                   num_joints, kDurations[d]);
+      success &= Run("sampling", parameters, "joint", num_joints, fct);
+
+      allocator->Deallocate(locals);
+      allocator->Delete(animation);
+    }
+  }
+  return success;
+}
+
+struct BlendingFct {
+  bool operator()() {
+    return job.Run();
+  }
+  ozz::animation::BlendingJob job;
+};
+
+bool BenchmarkBlending() {
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const int kNumLayers[] = {1, 2, 4, 8};
+  bool success = true;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(kNumJoints); ++i) {
+    const int num_joints = kNumJoints[i];
+    Skeleton* skeleton = BuildSkeleton(num_joints);
+    ozz::Range<ozz::math::SoaTransform> output =
+      allocator->AllocateRange<ozz::math::SoaTransform>(
+        skeleton->num_soa_joints());
+    for (size_t l = 0; l < OZZ_ARRAY_SIZE(kNumLayers); ++l) {
+      // All layers use the bind pose, with equal weights.
+      ozz::animation::BlendingJob::Layer layers[8];
+      for (int j = 0; j < kNumLayers[l]; ++j) {
+        layers[j].weight = 1.f / kNumLayers[l];
+        layers[j].transform = skeleton->bind_pose();
+      }
+
+      BlendingFct fct;
+      fct.job.layers.begin = layers;
+      fct.job.layers.end = layers + kNumLayers[l];
+      fct.job.bind_pose = skeleton->bind_pose();
+      fct.job.output = output;
+
+      char parameters[64];
+      std::sprintf(parameters, "joints=%d layers=%d",
+                   num_joints, kNumLayers[l]);
+      success &= Run("blending", parameters, "joint", num_joints, fct);
+    }
+    allocator->Deallocate(output);
+    allocator->Delete(skeleton);
+  }
+  return success;
+}
+
+struct LocalToModelFct {
+  bool operator()() {
+    return job.Run();
+  }
+  ozz::animation::LocalToModelJob job;
+};
+
+bool BenchmarkLocalToModel() {
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  bool success = true;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(kNumJoints); ++i) {
+    const int num_joints = kNumJoints[i];
+    Skeleton* skeleton = BuildSkeleton(num_joints);
+    ozz::Range<ozz::math::Float4x4> models =
+      allocator->AllocateRange<ozz::math::Float4x4>(num_joints);
+
+    LocalToModelFct fct;
+    fct.job.skeleton = skeleton;
+    fct.job.input = skeleton->bind_pose();
+    fct.job.output = models;
+
+    char parameters[64];
+    std::sprintf(parameters, "joints=%d", num_joints);
+    success &= Run("local_to_model", parameters, "joint", num_joints, fct);
+
+    allocator->Deallocate(models);
+    allocator->Delete(skeleton);
+  }
+  return success;
+}
+
+struct SkinningFct {
+  bool operator()() {
+    return job.Run();
+  }
+  ozz::geometry::SkinningJob job;
+};
+
+bool BenchmarkSkinning() {
+  const int kNumVertices = 16384;
+  const int kNumMatrices = 64;
+  const int kInfluences[] = {1, 2, 3, 4, 8};
+
+  // Builds matrices and vertices. Joint indices and weights are stored for
+  // the maximum number of influences, and strided according to the current
+  // one.
+  ozz::Vector<ozz::math::Float4x4>::Std matrices(kNumMatrices);
+  for (int i = 0; i < kNumMatrices; ++i) {
+    matrices[i] = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(i * .1f, 0.f, 0.f, 1.f));
+  }
+  const int kMaxInfluences = 8;
+  ozz::Vector<uint16_t>::Std indices(kNumVertices * kMaxInfluences);
+  ozz::Vector<float>::Std weights(kNumVertices * kMaxInfluences);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    indices[i] = static_cast<uint16_t>((i * 7) % kNumMatrices);
+    weights[i] = .1f;
+  }
+  ozz::Vector<float>::Std in_positions(kNumVertices * 3, 1.f);
+  ozz::Vector<float>::Std in_normals(kNumVertices * 3, .57f);
+  ozz::Vector<float>::Std out_positions(kNumVertices * 3);
+  ozz::Vector<float>::Std out_normals(kNumVertices * 3);
+
+  bool success = true;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(kInfluences); ++i) {
+    const int influences = kInfluences[i];
+
+    SkinningFct fct;
+    ozz::geometry::SkinningJob& job = fct.job;
+    job.vertex_count = kNumVertices;
+    job.influences_count = influences;
+    job.joint_matrices =
+      ozz::Range<const ozz::math::Float4x4>(&matrices[0], matrices.size());
+    job.joint_indices = ozz::Range<const uint16_t>(&indices[0], indices.size());
+    job.joint_indices_stride = sizeof(uint16_t) * influences;
+    if (influences > 1) {
+      job.joint_weights = ozz::Range<const float>(&weights[0], weights.size());
+      job.joint_weights_stride = sizeof(float) * (influences - 1);
+    }
+    job.in_positions =
+      ozz::Range<const float>(&in_positions[0], in_positions.size());
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_normals = ozz::Range<const float>(&in_normals[0], in_normals.size());
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_positions =
+      ozz::Range<float>(&out_positions[0], out_positions.size());
+    job.out_positions_stride = sizeof(float) * 3;
+    job.out_normals = ozz::Range<float>(&out_normals[0], out_normals.size());
+    job.out_normals_stride = sizeof(float) * 3;
+
+    char parameters[64];
+    std::sprintf(parameters, "vertices=%d influences=%d",
+                 kNumVertices, influences);
+    success &= Run("skinning", parameters, "vertex", kNumVertices, fct);
+  }
+  return success;
+}
+
+// Loads an animation from a memory stream, which includes archive parsing
+// and animation allocation.
+struct LoadFct {
+  bool operator()() {
+    if (stream.Seek(0, ozz::io::Stream::kSet) != 0) {
+      return false;
+    }
+    ozz::io::IArchive archive(&stream);
+    if (!archive.TestTag<Animation>()) {
+      return false;
+    }
+    archive >> animation;
+    return true;
+  }
+  ozz::io::MemoryStream stream;
+  Animation animation;
+};
+
+bool BenchmarkArchive() {
+  bool success = true;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(kNumJoints); ++i) {
+    const int num_joints = kNumJoints[i];
+    for (size_t d = 0; d < OZZ_ARRAY_SIZE(kDurations); ++d) {
+      Animation* animation = BuildAnimation(num_joints, kDurations[d]);
+      LoadFct fct;
+      {
+        ozz::io::OArchive archive(&fct.stream);
+        archive << *animation;
+      }
+      ozz::memory::default_allocator()->Delete(animation);
+      const int size = static_cast<int>(fct.stream.Tell());
+
+      char parameters[64];
+      std::sprintf(parameters, "joints=%d duration=%gs",
+                   num_joints, kDurations[d]);
+      success &= Run("archive_load", parameters, "byte", size, fct);
+    }
+  }
+  return success;
+}
+
+// Defines the load paths measured by load benchmarks.
+enum LoadMode {
+  kMemoryLoad,  // Archive read from a MemoryStream.
+  kFileLoad,  // Archive read from a File.
+  kBufferedLoad,  // Archive read from a BufferedStream decorating a File.
+  kCompressedLoad,  // Archive read from a CompressedStream decorating a File.
+  kBlobLoad,  // Animation blobs read with a single File::Read, then mapped.
+  kMappedLoad,  // Animation blobs memory mapped (posix only), then mapped.
+                // Pages are only read when key frames are first accessed.
+};
+
+const char* const kLoadModeNames[] = {
+  "memory", "file", "buffered", "compressed", "blob", "mmap"};
+
+// Gets the path of the temporary file _name, in directory option.
+ozz::String::Std TempPath(const char* _name) {
+  return ozz::String::Std(OPTIONS_directory) + "/" + _name;
+}
+
+// Evicts file _filename from the page cache if cold option is set, so that it
+// is read again from the storage device.
+// Returns false if it's not supported or if it failed.
+bool DropPageCache(const char* _filename) {
+  if (!OPTIONS_cold) {
+    return true;
+  }
+#if defined(__linux__)
+  const int fd = open(_filename, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  // Dirty pages can't be dropped, so they are written back first.
+  const bool dropped = fdatasync(fd) == 0 &&
+                       posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close(fd);
+  return dropped;
+#else  // __linux__
+  (void)_filename;
+  ozz::log::Err() << "Cold loads are only supported on linux." << std::endl;
+  return false;
+#endif  // __linux__
+}
+
+// Writes _count times _object to _stream archive.
+template <typename _Ty>
+void WriteObjects(ozz::io::Stream* _stream, const _Ty& _object, int _count) {
+  ozz::io::OArchive archive(_stream);
+  for (int i = 0; i < _count; ++i) {
+    archive << _object;
+  }
+}
+
+// Writes _count times _object to archive file _filename, compressed if
+// _compress is true.
+// Returns false if the file can't be written.
+template <typename _Ty>
+bool WriteArchive(const char* _filename, const _Ty& _object, int _count,
+                  bool _compress) {
+  ozz::io::File file(_filename, "wb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open file \"" << _filename <<
+      "\" for writing." << std::endl;
+    return false;
+  }
+  if (!_compress) {
+    WriteObjects(&file, _object, _count);
+    return true;
+  }
+  ozz::io::CompressedStream compressed(&file,
+                                       ozz::io::CompressedStream::kWrite);
+  WriteObjects(&compressed, _object, _count);
+  return compressed.Close();
+}
+
+// Reads _count objects from _stream archive.
+template <typename _Ty>
+bool ReadArchive(ozz::io::Stream* _stream, _Ty* _objects, int _count) {
+  ozz::io::IArchive archive(_stream);
+  for (int i = 0; i < _count; ++i) {
+    if (!archive.TestTag<_Ty>()) {
+      return false;
+    }
+    archive >> _objects[i];
+  }
+  return true;
+}
+
+// Loads _count objects according to archive mode _mode, from _memory stream
+// or from _filename.
+template <typename _Ty>
+bool LoadArchive(LoadMode _mode, ozz::io::MemoryStream* _memory,
+                 const char* _filename, _Ty* _objects, int _count) {
+  if (_mode == kMemoryLoad) {
+    return _memory->Seek(0, ozz::io::Stream::kSet) == 0 &&
+           ReadArchive(_memory, _objects, _count);
+  }
+  if (!DropPageCache(_filename)) {
+    return false;
+  }
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    return false;
+  }
+  if (_mode == kFileLoad) {
+    return ReadArchive(&file, _objects, _count);
+  } else if (_mode == kBufferedLoad) {
+    ozz::io::BufferedStream buffered(&file);
+    return ReadArchive(&buffered, _objects, _count);
+  }
+  ozz::io::CompressedStream compressed(&file,
+                                       ozz::io::CompressedStream::kRead);
+  return compressed.opened() && ReadArchive(&compressed, _objects, _count);
+}
+
+// Number of clips of the benchmarked animation bank.
+const int kNumBankClips = 64;
+
+// Loads the whole animation bank. Blobs of the previous load are released
+// first, as mapped animations use them in place.
+struct BankLoadFct {
+  BankLoadFct()
+    : blob(NULL),
+      blob_size(0),
+      mapped(NULL) {
+  }
+  ~BankLoadFct() {
+    Release();
+  }
+  bool operator()() {
+    Release();
+    if (mode < kBlobLoad) {
+      return LoadArchive(mode, &memory, filename, animations, kNumBankClips);
+    }
+    if (!DropPageCache(filename)) {
+      return false;
+    }
+    if (mode == kBlobLoad) {
+      ozz::io::File file(filename, "rb");
+      blob = ozz::memory::default_allocator()->Allocate(
+        blob_size, Animation::kBlobAlignment);
+      if (!file.opened() || file.Read(blob, blob_size) != blob_size) {
+        return false;
+      }
+      return MapBlobs(blob);
+    }
+#ifndef _WIN32
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    void* address = mmap(NULL, blob_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+      return false;
+    }
+    mapped = address;
+    return MapBlobs(mapped);
+#else  // _WIN32
+    return false;
+#endif  // _WIN32
+  }
+  // Maps all bank animations to _blobs, clips blobs being consecutive.
+  bool MapBlobs(const void* _blobs) {
+    const size_t clip_size = blob_size / kNumBankClips;
+    bool success = true;
+    for (int i = 0; i < kNumBankClips; ++i) {
+      success &= animations[i].MapBlob(
+        static_cast<const char*>(_blobs) + i * clip_size, clip_size);
+    }
+    return success;
+  }
+  void Release() {
+    ozz::memory::default_allocator()->Deallocate(blob);
+    blob = NULL;
+#ifndef _WIN32
+    if (mapped) {
+      munmap(mapped, blob_size);
+    }
+#endif  // _WIN32
+    mapped = NULL;
+  }
+  LoadMode mode;
+  const char* filename;
+  ozz::io::MemoryStream memory;
+  Animation animations[kNumBankClips];
+  void* blob;
+  size_t blob_size;
+  void* mapped;
+};
+
+// Writes a bank of kNumBankClips animations to memory, and to temporary
+// archive, compressed archive and blobs files. Then measures bank loading
+// with every load mode.
+bool BenchmarkBank() {
+  const int kBankJoints = 64;
+  const float kBankDuration = 10.f;
+  // Bank clips are identical, as only their size matters.
+  Animation* animation = BuildAnimation(kBankJoints, kBankDuration);
+
+  const ozz::String::Std archive_path = TempPath("bank.ozz");
+  const ozz::String::Std compressed_path = TempPath("bank_lz4.ozz");
+  const ozz::String::Std blob_path = TempPath("bank.blob");
+
+  // Clips blobs are consecutive, each one padded to the blob alignment.
+  const size_t clip_size =
+    (animation->blob_size() + Animation::kBlobAlignment - 1) &
+    ~(Animation::kBlobAlignment - 1);
+  bool success = true;
+  {
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    void* blob = allocator->Allocate(clip_size, Animation::kBlobAlignment);
+    std::memset(blob, 0, clip_size);
+    success = animation->SaveBlob(blob, clip_size);
+    ozz::io::File file(blob_path.c_str(), "wb");
+    for (int i = 0; success && i < kNumBankClips; ++i) {
+      success = file.Write(blob, clip_size) == clip_size;
+    }
+    allocator->Deallocate(blob);
+  }
+  success = success &&
+            WriteArchive(archive_path.c_str(), *animation, kNumBankClips,
+                         false) &&
+            WriteArchive(compressed_path.c_str(), *animation, kNumBankClips,
+                         true);
+
+  BankLoadFct fct;
+  WriteObjects(&fct.memory, *animation, kNumBankClips);
+  const size_t archive_size = static_cast<size_t>(fct.memory.Tell());
+  ozz::memory::default_allocator()->Delete(animation);
+  if (!success) {
+    ozz::log::Err() << "Failed to write bank files to directory \"" <<
+      OPTIONS_directory << "\"." << std::endl;
+    return false;
+  }
+
+  fct.blob_size = clip_size * kNumBankClips;
+#ifdef _WIN32
+  const int num_modes = kMappedLoad;  // Memory mapping isn't supported.
+#else  // _WIN32
+  const int num_modes = kMappedLoad + 1;
+#endif  // _WIN32
+  for (int i = 0; i < num_modes; ++i) {
+    fct.mode = static_cast<LoadMode>(i);
+    fct.filename = fct.mode == kCompressedLoad ? compressed_path.c_str() :
+                   fct.mode >= kBlobLoad ? blob_path.c_str() :
+                   archive_path.c_str();
+    // Throughput is measured on uncompressed bytes.
+    const size_t bytes = fct.mode >= kBlobLoad ? fct.blob_size : archive_size;
+    char parameters[64];
+    std::sprintf(parameters, "mode=%s clips=%d%s", kLoadModeNames[i],
+                 kNumBankClips, OPTIONS_cold ? " cold" : "");
+    success &= Run("bank_load", parameters, "clip", kNumBankClips, fct,
+                   bytes);
+  }
+  fct.Release();
+
+  std::remove(archive_path.c_str());
+  std::remove(compressed_path.c_str());
+  std::remove(blob_path.c_str());
+  return success;
+}
+
+// Loads a skeleton, measuring Skeleton::Load startup time.
+struct SkeletonLoadFct {
+  bool operator()() {
+    return LoadArchive(mode, &memory, filename, &skeleton, 1);
+  }
+  LoadMode mode;
+  const char* filename;
+  ozz::io::MemoryStream memory;
+  Skeleton skeleton;
+};
+
+bool BenchmarkSkeletonLoad() {
+  const ozz::String::Std archive_path = TempPath("skeleton.ozz");
+  const ozz::String::Std compressed_path = TempPath("skeleton_lz4.ozz");
+  bool success = true;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(kNumJoints) && success; ++i) {
+    const int num_joints = kNumJoints[i];
+    Skeleton* skeleton = BuildSkeleton(num_joints);
+    SkeletonLoadFct fct;
+    WriteObjects(&fct.memory, *skeleton, 1);
+    const size_t archive_size = static_cast<size_t>(fct.memory.Tell());
+    success = WriteArchive(archive_path.c_str(), *skeleton, 1, false) &&
+              WriteArchive(compressed_path.c_str(), *skeleton, 1, true);
+    ozz::memory::default_allocator()->Delete(skeleton);
+    if (!success) {
+      ozz::log::Err() << "Failed to write skeleton files to directory \"" <<
+        OPTIONS_directory << "\"." << std::endl;
+      break;
+    }
+
+    for (int m = 0; m < kBlobLoad; ++m) {
+      fct.mode = static_cast<LoadMode>(m);
+      fct.filename = fct.mode == kCompressedLoad ?
+        compressed_path.c_str() : archive_path.c_str();
+      char parameters[64];
+      std::sprintf(parameters, "mode=%s joints=%d%s", kLoadModeNames[m],
+                   num_joints, OPTIONS_cold ? " cold" : "");
+      success &= Run("skeleton_load", parameters, "skeleton", 1, fct,
+                     archive_size);
+    }
+  }
+  std::remove(archive_path.c_str());
+  std::remove(compressed_path.c_str());
+  return success;
+}
+
+// Defines the data of a millipede benchmark character: its animation state
+// and its pipeline buffers.
+struct Character {
+  // Two sampled layers (the same walk animation at different times) are
+  // blended, then converted to model space and used to skin a mesh.
+  ozz::animation::SamplingCache* caches[2];
+  ozz::Range<ozz::math::SoaTransform> locals[2];
+  ozz::Range<ozz::math::SoaTransform> blended;
+  ozz::Range<ozz::math::Float4x4> models;
+  ozz::Range<ozz::math::Float4x4> skinning_matrices;
+  ozz::Range<float> out_positions;
+  ozz::Range<float> out_normals;
+  float time;
+};
+
+// Number of skinned vertices per joint, and of influences per vertex.
+const int kMillipedeVerticesPerJoint = 16;
+const int kMillipedeInfluences = 2;
+
+// Updates all characters of the millipede benchmark, a work item being the
+// whole pipeline of a character.
+class MillipedeTask : public ozz::tasks::Task {
+ public:
+  virtual void Run(int _index) const {
+    Character& character = characters[_index];
+    const float duration = animation->duration();
+    character.time = std::fmod(character.time + 1.f / 60.f, duration);
+
+    bool success = true;
+    ozz::animation::SamplingJob sampling_job;
+    sampling_job.animation = animation;
+    for (int i = 0; i < 2; ++i) {
+      sampling_job.cache = character.caches[i];
+      sampling_job.time =
+        std::fmod(character.time + i * duration * .5f, duration);
+      sampling_job.output = character.locals[i];
+      success &= sampling_job.Run();
+    }
+
+    ozz::animation::BlendingJob::Layer layers[2];
+    for (int i = 0; i < 2; ++i) {
+      layers[i].weight = .5f;
+      layers[i].transform = character.locals[i];
+    }
+    ozz::animation::BlendingJob blending_job;
+    blending_job.layers.begin = layers;
+    blending_job.layers.end = layers + 2;
+    blending_job.bind_pose = skeleton->bind_pose();
+    blending_job.output = character.blended;
+    success &= blending_job.Run();
+
+    ozz::animation::LocalToModelJob ltm_job;
+    ltm_job.skeleton = skeleton;
+    ltm_job.input = character.blended;
+    ltm_job.output = character.models;
+    success &= ltm_job.Run();
+
+    const int num_joints = skeleton->num_joints();
+    for (int i = 0; i < num_joints; ++i) {
+      character.skinning_matrices[i] =
+        character.models[i] * inverse_bind_poses[i];
+    }
+
+    ozz::geometry::SkinningJob skinning_job;
+    skinning_job.vertex_count = num_joints * kMillipedeVerticesPerJoint;
+    skinning_job.influences_count = kMillipedeInfluences;
+    skinning_job.joint_matrices = character.skinning_matrices;
+    skinning_job.joint_indices = joint_indices;
+    skinning_job.joint_indices_stride =
+      sizeof(uint16_t) * kMillipedeInfluences;
+    skinning_job.joint_weights = joint_weights;
+    skinning_job.joint_weights_stride =
+      sizeof(float) * (kMillipedeInfluences - 1);
+    skinning_job.in_positions = in_positions;
+    skinning_job.in_positions_stride = sizeof(float) * 3;
+    skinning_job.in_normals = in_normals;
+    skinning_job.in_normals_stride = sizeof(float) * 3;
+    skinning_job.out_positions = character.out_positions;
+    skinning_job.out_positions_stride = sizeof(float) * 3;
+    skinning_job.out_normals = character.out_normals;
+    skinning_job.out_normals_stride = sizeof(float) * 3;
+    success &= skinning_job.Run();
+
+    if (!success) {
+      failed = true;  // Only ever set to true, so races don't matter.
+    }
+  }
+
+  const Skeleton* skeleton;
+  const Animation* animation;
+  Character* characters;
+  // Shared mesh, whose vertices are evenly distributed to joints.
+  ozz::Range<const ozz::math::Float4x4> inverse_bind_poses;
+  ozz::Range<const uint16_t> joint_indices;
+  ozz::Range<const float> joint_weights;
+  ozz::Range<const float> in_positions;
+  ozz::Range<const float> in_normals;
+  mutable volatile bool failed;
+};
+
+struct MillipedeFct {
+  bool operator()() {
+    task.failed = false;
+    dispatcher->Dispatch(task, num_characters);
+    return !task.failed;
+  }
+  MillipedeTask task;
+  ozz::tasks::Dispatcher* dispatcher;
+  int num_characters;
+};
+
+// Allocates _count characters buffers for _skeleton, with animation times
+// spread over _duration.
+void CreateCharacters(const Skeleton& _skeleton, float _duration,
+                      Character* _characters, int _count) {
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const int num_joints = _skeleton.num_joints();
+  const int num_soa_joints = _skeleton.num_soa_joints();
+  const int num_vertices = num_joints * kMillipedeVerticesPerJoint;
+  for (int c = 0; c < _count; ++c) {
+    Character& character = _characters[c];
+    for (int i = 0; i < 2; ++i) {
+      character.caches[i] =
+        allocator->New<ozz::animation::SamplingCache>(num_joints);
+      character.locals[i] =
+        allocator->AllocateRange<ozz::math::SoaTransform>(num_soa_joints);
+    }
+    character.blended =
+      allocator->AllocateRange<ozz::math::SoaTransform>(num_soa_joints);
+    character.models =
+      allocator->AllocateRange<ozz::math::Float4x4>(num_joints);
+    character.skinning_matrices =
+      allocator->AllocateRange<ozz::math::Float4x4>(num_joints);
+    character.out_positions = allocator->AllocateRange<float>(num_vertices * 3);
+    character.out_normals = allocator->AllocateRange<float>(num_vertices * 3);
+    character.time = _duration * c / _count;
+  }
+}
+
+// Deallocates _count characters buffers.
+void DestroyCharacters(Character* _characters, int _count) {
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  for (int c = 0; c < _count; ++c) {
+    Character& character = _characters[c];
+    for (int i = 0; i < 2; ++i) {
+      allocator->Delete(character.caches[i]);
+      allocator->Deallocate(character.locals[i]);
+    }
+    allocator->Deallocate(character.blended);
+    allocator->Deallocate(character.models);
+    allocator->Deallocate(character.skinning_matrices);
+    allocator->Deallocate(character.out_positions);
+    allocator->Deallocate(character.out_normals);
+  }
+}
+
+bool BenchmarkMillipede() {
+  // Millipedes of 8, 64, 253 and 1023 joints.
+  const int kSliceCounts[] = {1, 9, 36, 146};
+  const int kNumCharacters[] = {1, 16, 64};
+  const int kMaxCharacters = 64;
+
+  // Thread counts are powers of 2, up to threads option.
+  const int max_threads = OPTIONS_threads > 0 ?
+    OPTIONS_threads.value() : ozz::tasks::ThreadPool::hardware_concurrency();
+  int thread_counts[32];
+  int num_thread_counts = 0;
+  for (int threads = 1; num_thread_counts < 32; threads *= 2) {
+    thread_counts[num_thread_counts++] =
+      threads < max_threads ? threads : max_threads;
+    if (threads >= max_threads) {
+      break;
+    }
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  bool success = true;
+  for (size_t s = 0; s < OZZ_ARRAY_SIZE(kSliceCounts) && success; ++s) {
+    const int slice_count = kSliceCounts[s];
+    RawSkeleton raw_skeleton;
+    ozz::sample::CreateMillipedeSkeleton(slice_count, &raw_skeleton);
+    Skeleton* skeleton =
+      ozz::animation::offline::SkeletonBuilder()(raw_skeleton);
+    Animation* animation = NULL;
+    if (skeleton) {
+      RawAnimation raw_animation;
+      ozz::sample::CreateMillipedeAnimation(slice_count, *skeleton,
+                                            &raw_animation);
+      animation = ozz::animation::offline::AnimationBuilder()(raw_animation);
+    }
+    if (!animation) {
+      ozz::log::Err() << "Failed to build millipede of " << slice_count <<
+        " slices." << std::endl;
+      allocator->Delete(skeleton);
+      return false;
+    }
+    const int num_joints = skeleton->num_joints();
+
+    // Inverse bind poses, from the bind pose model space matrices.
+    ozz::Vector<ozz::math::Float4x4>::Std inverse_bind_poses(num_joints);
+    {
+      ozz::animation::LocalToModelJob ltm_job;
+      ltm_job.skeleton = skeleton;
+      ltm_job.input = skeleton->bind_pose();
+      ltm_job.output = ozz::Range<ozz::math::Float4x4>(
+        &inverse_bind_poses[0], inverse_bind_poses.size());
+      ltm_job.Run();
+      for (int i = 0; i < num_joints; ++i) {
+        inverse_bind_poses[i] = ozz::math::Invert(inverse_bind_poses[i]);
+      }
+    }
+
+    // Builds the shared mesh.
+    const int num_vertices = num_joints * kMillipedeVerticesPerJoint;
+    ozz::Vector<uint16_t>::Std indices(num_vertices * kMillipedeInfluences);
+    ozz::Vector<float>::Std weights(num_vertices, .7f);
+    for (int i = 0; i < num_vertices; ++i) {
+      const int joint = i / kMillipedeVerticesPerJoint;
+      indices[i * 2] = static_cast<uint16_t>(joint);
+      indices[i * 2 + 1] = static_cast<uint16_t>(
+        skeleton->joint_properties()[joint].parent ==
+          Skeleton::kNoParentIndex ? joint :
+          skeleton->joint_properties()[joint].parent);
+    }
+    ozz::Vector<float>::Std in_positions(num_vertices * 3, .1f);
+    ozz::Vector<float>::Std in_normals(num_vertices * 3, .57f);
+
+    Character characters[kMaxCharacters];
+    CreateCharacters(*skeleton, animation->duration(), characters,
+                     kMaxCharacters);
+
+    MillipedeFct fct;
+    MillipedeTask& task = fct.task;
+    task.skeleton = skeleton;
+    task.animation = animation;
+    task.characters = characters;
+    task.inverse_bind_poses = ozz::Range<const ozz::math::Float4x4>(
+      &inverse_bind_poses[0], inverse_bind_poses.size());
+    task.joint_indices =
+      ozz::Range<const uint16_t>(&indices[0], indices.size());
+    task.joint_weights = ozz::Range<const float>(&weights[0], weights.size());
+    task.in_positions =
+      ozz::Range<const float>(&in_positions[0], in_positions.size());
+    task.in_normals =
+      ozz::Range<const float>(&in_normals[0], in_normals.size());
+
+    for (int t = 0; t < num_thread_counts; ++t) {
+      ozz::tasks::ThreadPool pool(thread_counts[t]);
+      fct.dispatcher = &pool;
+      for (size_t c = 0; c < OZZ_ARRAY_SIZE(kNumCharacters); ++c) {
+        fct.num_characters = kNumCharacters[c];
+        char parameters[64];
+        std::sprintf(parameters, "characters=%d joints=%d threads=%d",
+                     kNumCharacters[c], num_joints, thread_counts[t]);
+        success &= Run("millipede", parameters, "character",
+                       kNumCharacters[c], fct);
+      }
+    }
+
+    DestroyCharacters(characters, kMaxCharacters);
+    allocator->Delete(animation);
+    allocator->Delete(skeleton);
+  }
+  return success;
+}
+
+// Writes all results to csv file _filename.
+bool WriteReport(const char* _filename) {
+  ozz::io::File file(_filename, "wb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open report file \"" << _filename <<
+      "\" for writing." << std::endl;
+    return false;
+  }
+  const char header[] = "benchmark,parameters,unit,ns_per_unit\n";
+  file.Write(header, sizeof(header) - 1);
+  for (size_t i = 0; i < g_results.size(); ++i) {
+    const Result& result = g_results[i];
+    char line[160];
+    std::sprintf(line, "%s,%s,%s,%f\n", result.name, result.parameters,
+                 result.unit, result.ns_per_unit);
+    file.Write(line, std::strlen(line));
+  }
+  return true;
+}
+
+// Copies csv field starting at _begin to _field, which is truncated to _size.
+// Returns a pointer to the next field, or NULL if there's none.
+const char* ReadField(const char* _begin, char* _field, size_t _size) {
+  const char* end = _begin;
+  while (*end != 0 && *end != ',' && *end != '\n' && *end != '\r') {
+    ++end;
+  }
+  size_t length = static_cast<size_t>(end - _begin);
+  length = length < _size - 1 ? length : _size - 1;
+  std::memcpy(_field, _begin, length);
+  _field[length] = 0;
+  return *end == ',' ? end + 1 : NULL;
+}
+
+// Loads baseline results from csv file _filename, as written by WriteReport.
+bool LoadBaseline(const char* _filename, ozz::Vector<Result>::Std* _baseline) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open baseline file \"" << _filename <<
+      "\"." << std::endl;
+    return false;
+  }
+  file.Seek(0, ozz::io::Stream::kEnd);
+  const size_t size = static_cast<size_t>(file.Tell());
+  file.Seek(0, ozz::io::Stream::kSet);
+  ozz::Vector<char>::Std content(size + 1, 0);
+  if (size != 0 && file.Read(&content[0], size) != size) {
+    ozz::log::Err() << "Failed to read baseline file \"" << _filename <<
+      "\"." << std::endl;
+    return false;
+  }
+
+  // Parses lines, skipping the header.
+  const char* line = std::strchr(&content[0], '\n');
+  for (; line != NULL; line = std::strchr(line, '\n')) {
+    ++line;  // Skips '\n'.
+    if (*line == 0 || *line == '\n' || *line == '\r') {
+      continue;
+    }
+    Result result;
+    char unit[16];
+    char ns[32];
+    const char* field = line;
+    field = ReadField(field, result.name, sizeof(result.name));
+    field = field ? ReadField(field, result.parameters,
+                              sizeof(result.parameters)) : NULL;
+    field = field ? ReadField(field, unit, sizeof(unit)) : NULL;
+    if (!field) {
+      ozz::log::Err() << "Invalid baseline file \"" << _filename <<
+        "\"." << std::endl;
+      return false;
+    }
+    ReadField(field, ns, sizeof(ns));
+    result.unit = NULL;
+    result.ns_per_unit = std::atof(ns);
+    _baseline->push_back(result);
+  }
+  return true;
+}
+
+// Compares results to the baseline loaded from _filename.
+// Returns false if the baseline can't be loaded or if any result exceeds its
+// baseline by more than threshold option. Results missing from the baseline
+// are reported but aren't considered as failures.
+bool CompareBaseline(const char* _filename) {
+  ozz::Vector<Result>::Std baseline;
+  if (!LoadBaseline(_filename, &baseline)) {
+    return false;
+  }
+  bool success = true;
+  for (size_t i = 0; i < g_results.size(); ++i) {
+    const Result& result = g_results[i];
+    const Result* reference = NULL;
+    for (size_t j = 0; j < baseline.size() && !reference; ++j) {
+      if (std::strcmp(baseline[j].name, result.name) == 0 &&
+          std::strcmp(baseline[j].parameters, result.parameters) == 0) {
+        reference = &baseline[j];
+      }
+    }
+    if (!reference || reference->ns_per_unit <= 0.) {
+      ozz::log::Log() << "No baseline for " << result.name << " (" <<
+        result.parameters << ")." << std::endl;
+      continue;
+    }
+    const double ratio = result.ns_per_unit / reference->ns_per_unit;
+    if (ratio > OPTIONS_threshold) {
+      char line[160];
+      std::sprintf(line, "%s (%s): %.3f ns/%s, baseline %.3f (x%.2f).",
+                   result.name, result.parameters, result.ns_per_unit,
+                   result.unit, reference->ns_per_unit, ratio);
+      ozz::log::Err() << "Performance regression " << line << std::endl;
+      success = false;
+    }
+  }
+  return success;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+    _argc, _argv,
+    "1.0",
+    "Measures ozz runtime jobs performance on synthetic data.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ?
+      EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  const struct {
+    const char* name;
+    bool (*fct)();
+  } benchmarks[] = {
+    {"sampling", &BenchmarkSampling},
+    {"blending", &BenchmarkBlending},
+    {"local_to_model", &BenchmarkLocalToModel},
+    {"skinning", &BenchmarkSkinning},
+    {"archive_load", &BenchmarkArchive},
+    {"bank_load", &BenchmarkBank},
+    {"skeleton_load", &BenchmarkSkeletonLoad},
+    {"millipede", &BenchmarkMillipede}};
+
+  bool success = true;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(benchmarks); ++i) {
+    if (Selected(benchmarks[i].name)) {
+      success &= benchmarks[i].fct();
+    }
+  }
+
+  if (success && *OPTIONS_report.value() != 0) {
+    success = WriteReport(OPTIONS_report);
+  }
+
+  if (success && *OPTIONS_baseline.value() != 0) {
+    success = CompareBaseline(OPTIONS_baseline);
+  }
+
+  // Releases results memory before the allocator checks for leaks.
+  ozz::Vector<Result>::Std().swap(g_results);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -21,6 +21,30 @@ if(ozz_build_redebug_all)
   set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS_DEBUG OZZ_HAS_REDEBUG_ALL=1)
 endif()
 
+# Runtime jobs statistics
+if(ozz_build_stats)
+  message("OZZ_HAS_STATS is enabled")
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_HAS_STATS=1)
+endif()
+
+# Profiling hooks
+if(ozz_build_profile_hooks)
+  message("OZZ_HAS_PROFILE_HOOKS is enabled")
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_HAS_PROFILE_HOOKS=1)
+endif()
+
+# Runtime dispatch of hot kernels to the best x86 instructions set
+if(ozz_build_simd_dispatch)
+  message("OZZ_HAS_SIMD_DISPATCH is enabled")
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_HAS_SIMD_DISPATCH=1)
+endif()
+
+# Deterministic floating point results, for lockstep simulations
+if(ozz_build_deterministic)
+  message("OZZ_HAS_DETERMINISM is enabled")
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_HAS_DETERMINISM=1)
+endif()
+
 #------------------------
 # Lists all the cxx flags
 set(cxx_all_flags
@@ -75,6 +99,12 @@ if(MSVC)
     set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_HAS_SSE2=1)
   endif()
 
+  # neon
+  if(ozz_build_neon)
+    message("OZZ_HAS_NEON is enabled")
+    set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_HAS_NEON=1)
+  endif()
+
   # Removes any exception mode
   string(REGEX REPLACE " /EH.*" "" CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS}")
   string(REGEX REPLACE " /EH.*" "" CMAKE_C_FLAGS "${CMAKE_C_FLAGS}")
@@ -93,6 +123,23 @@ if(MSVC)
     set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} /arch:SSE2")
   endif()
 
+  # Adds support for AVX2 instructions
+  string(REGEX REPLACE " /arch:AVX[0-9]?" "" CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS}")
+  string(REGEX REPLACE " /arch:AVX[0-9]?" "" CMAKE_C_FLAGS "${CMAKE_C_FLAGS}")
+  if(ozz_build_avx2)
+    message("OZZ_HAS_AVX is enabled")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} /arch:AVX2")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} /arch:AVX2")
+  endif()
+
+  # Disallows floating point contractions and reassociations
+  if(ozz_build_deterministic)
+    string(REGEX REPLACE " /fp:[a-z]+" "" CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS}")
+    string(REGEX REPLACE " /fp:[a-z]+" "" CMAKE_C_FLAGS "${CMAKE_C_FLAGS}")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} /fp:precise")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} /fp:precise")
+  endif()
+
   # Adds support for multiple processes builds
   if(NOT ${CMAKE_CXX_FLAGS} MATCHES "/MP")
     set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} /MP")
@@ -146,6 +193,37 @@ else()
   #  set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -march=native")
   #endif()
 
+  # Adds support for NEON instructions. AArch64 implicitly supports NEON.
+  if(ozz_build_neon)
+    message("OZZ_HAS_NEON is enabled")
+    set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_HAS_NEON=1)
+    if(CMAKE_SYSTEM_PROCESSOR MATCHES "^arm" AND NOT CMAKE_CXX_FLAGS MATCHES "-mfpu")
+      set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mfpu=neon")
+      set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -mfpu=neon")
+    endif()
+  endif()
+
+  # Adds support for AVX2 instructions
+  if(ozz_build_avx2 AND NOT CMAKE_CXX_FLAGS MATCHES "-mavx2")
+    message("OZZ_HAS_AVX is enabled")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx2 -mfma -mf16c")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -mavx2 -mfma -mf16c")
+  endif()
+
+  # Adds support for FMA3 instructions, without AVX2
+  if(ozz_build_fma AND NOT CMAKE_CXX_FLAGS MATCHES "-mfma")
+    message("OZZ_HAS_FMA is enabled")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mfma")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -mfma")
+  endif()
+
+  # Disallows floating point contractions (fused multiply-add), which compilers
+  # would otherwise emit when targeting FMA3 or AArch64.
+  if(ozz_build_deterministic AND NOT CMAKE_CXX_FLAGS MATCHES "-ffp-contract")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -ffp-contract=off")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -ffp-contract=off")
+  endif()
+
   #----------------------
   # Enables debug glibcxx if NDebug isn't defined, not supported by APPLE
   if(NOT APPLE)
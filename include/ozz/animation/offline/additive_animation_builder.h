@@ -0,0 +1,83 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct Transform; }
+
+namespace animation {
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building additive animations, which can be
+// added to a posture by the BlendingJob (see BlendingJob::additive_layers).
+// Every key of an additive animation is the delta from a reference pose to the
+// input key: translations are subtracted, rotations are premultiplied by the
+// reference conjugate and scales are divided. Tangents of kHermite animations
+// are transformed the same way, so that additive curves keep their shape.
+class AdditiveAnimationBuilder {
+ public:
+  // Builds an additive animation from _input, relative to the first key of
+  // every track. Empty tracks remain empty, as they are identity deltas.
+  // Returns true on success and fills _output with the additive version of
+  // _input animation.
+  // *_output must be a valid RawAnimation instance.
+  // Returns false on failure and resets _output to an empty animation, if
+  // _input is invalid (see RawAnimation::Validate()) or if any reference scale
+  // component is 0.
+  bool operator()(const RawAnimation& _input, RawAnimation* _output) const;
+
+  // Builds an additive animation from _input, relative to _reference_pose,
+  // which is usually the posture the additive animation is meant to be added
+  // to (like a skeleton bind pose). _reference_pose must contain one local-
+  // space transform per _input track, otherwise building fails. Empty tracks
+  // are identity, so they get a single key if their reference isn't identity.
+  // Returns true on success and fills _output with the additive version of
+  // _input animation.
+  // *_output must be a valid RawAnimation instance.
+  // Returns false on failure and resets _output to an empty animation, if
+  // _input is invalid, if _reference_pose is too small or if any reference
+  // scale component is 0.
+  bool operator()(const RawAnimation& _input,
+                  const Range<const math::Transform>& _reference_pose,
+                  RawAnimation* _output) const;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
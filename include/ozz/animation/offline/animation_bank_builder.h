@@ -0,0 +1,71 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BANK_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BANK_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime animation and bank types.
+class Animation;
+class AnimationBank;
+
+namespace offline {
+
+// Defines the class responsible of building runtime animation banks from a
+// set of named runtime animations.
+// Animations key frames are copied to the bank, so source animations can be
+// destroyed once the bank is built.
+class AnimationBankBuilder {
+ public:
+  // Defines a bank entry, a named animation.
+  struct Entry {
+    // Animation name, which must be unique in the bank.
+    const char* name;
+
+    // Animation to copy to the bank.
+    const Animation* animation;
+  };
+
+  // Creates an AnimationBank with the animations of _entries, in the same
+  // order.
+  // Returns a valid AnimationBank on success, or NULL if any entry name or
+  // animation is NULL, or if two entries have the same name.
+  // The returned bank will then need to be deleted using the default allocator
+  // Delete() function.
+  AnimationBank* operator()(const ozz::Range<const Entry>& _entries) const;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BANK_BUILDER_H_
@@ -0,0 +1,85 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BOUNDS_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BOUNDS_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Box; }
+namespace animation {
+
+// Forward declares the runtime animation and skeleton types.
+class Animation;
+class Skeleton;
+
+namespace offline {
+
+// Defines the class responsible of precomputing the model-space bounding box
+// of a whole animation clip, so that a character can be culled before being
+// sampled (see ComputeBoundsJob::clip_bound).
+// The animation is sampled at a fixed rate, and at its end, and the box is
+// the union of all the sampled posture boxes. Joints can move out of the box
+// between two samples, which margin is intended to compensate for.
+class AnimationBoundsBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  AnimationBoundsBuilder();
+
+  // Computes the bounding box of _animation, played on _skeleton, and outputs
+  // it to _bound.
+  // Returns false if _animation doesn't match _skeleton number of joints, if
+  // parameters are invalid (see sampling_rate and radii), or if _bound is
+  // NULL.
+  bool operator()(const Animation& _animation, const Skeleton& _skeleton,
+                  math::Box* _bound) const;
+
+  // Computes the bounding box of _animation time range [_from,_to], played on
+  // _skeleton, and outputs it to _bound. Both ends of the range are sampled.
+  // Returns false in the same cases as the whole animation version, or if the
+  // range isn't included in [0,duration].
+  bool operator()(const Animation& _animation, const Skeleton& _skeleton,
+                  float _from, float _to, math::Box* _bound) const;
+
+  // Sampling rate, in hertz. Default is 30.
+  float sampling_rate;
+
+  // Distance the box is inflated by, in every direction. Default is 0.
+  float margin;
+
+  // Optional radius of every joint, see ComputeBoundsJob::radii. It must
+  // contain a radius per skeleton joint.
+  Range<const float> radii;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BOUNDS_BUILDER_H_
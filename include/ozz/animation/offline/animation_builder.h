@@ -32,27 +32,104 @@
 #define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BUILDER_H_
 
 namespace ozz {
+
+// Forward declaration of task dispatcher interface.
+namespace tasks { class Dispatcher; }
+
 namespace animation {
 
-// Forward declares the runtime animation type.
+// Forward declares the runtime animation and skeleton types.
 class Animation;
+class Skeleton;
 
 namespace offline {
 
-// Forward declares the offline animation type.
+// Forward declares the offline animation types.
 struct RawAnimation;
+class PackedRawAnimation;
 
 // Defines the class responsible of building runtime animation instances from
 // offline raw animations.
-// No optimization at all is performed on the raw animation.
+// No optimization at all is performed on the raw animation, but tracks whose
+// keys all have the same runtime (compressed) value are stored as constant
+// tracks, with a single key.
+// Runtime key frames are sorted by merging raw tracks, whose keys are already
+// time ordered. Translation, rotation and scale key streams are independent,
+// and can be processed concurrently by a dispatcher.
+// An optional seek index, key links and bounds can be built, see
+// seek_interval, key_links and bounds_skeleton.
 class AnimationBuilder {
  public:
+  // Initializes the builder with default parameters.
+  AnimationBuilder();
+
   // Creates an Animation based on _raw_animation and *this builder parameters.
   // Returns a valid Animation on success
   // The returned animation will then need to be deleted using the default 
   // allocator Delete() function.
-  // See RawAnimation::Validate() for more details about failure reasons.
+  // See RawAnimation::Validate() for more details about failure reasons. It
+  // also fails if bounds_skeleton number of joints doesn't match
+  // _raw_animation number of tracks, if bounds_margin is negative, or if
+  // time_step is negative.
   Animation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Creates an Animation from a packed raw animation, see PackedRawAnimation.
+  // The built animation is the same as the one built from the RawAnimation
+  // _packed_animation was packed from. Failure reasons are the same too.
+  Animation* operator()(const PackedRawAnimation& _packed_animation) const;
+
+  // The dispatcher used to sort translation, rotation and scale key streams
+  // concurrently. Built animation doesn't depend on the dispatcher. Default
+  // value is NULL, which processes the streams sequentially on the calling
+  // thread.
+  tasks::Dispatcher* dispatcher;
+
+  // Interval in seconds between seek index entries. The seek index stores
+  // sampling cache key cursors at regular times, so that sampling an
+  // animation at a random time (when seeking, scrubbing, or starting at
+  // random times) only fetches the keys since the previous entry instead of
+  // all the keys since the beginning of the animation. An entry costs
+  // (1 + 3 * (1 + 2 * aligned_tracks)) * 4 bytes. Default value is 0, which
+  // disables the seek index.
+  float seek_interval;
+
+  // Builds key links, from every key to the previous key of its track. They
+  // allow the sampling cache to play backward as efficiently as forward,
+  // instead of being invalidated each time sampling time decreases. Links
+  // cost 2 bytes per key. Default value is false.
+  bool key_links;
+
+  // Interval in seconds animated key times are rounded to, except the last key
+  // of each track. Keys are sorted by the time at which sampling needs them,
+  // then by track, hence by soa group of 4 tracks. Keys of different tracks
+  // needed at nearly the same time then share the same time, and are stored
+  // next to each other per soa group: sampling fetches contiguous keys and
+  // outdates fewer soa cache entries. It comes at the cost of a time error of
+  // up to half the step, and keys of a track that round to the same time are
+  // merged. It should thus be a fraction of the source sampling period.
+  // Default value is 0, which keeps the full key time precision.
+  float time_step;
+
+  // Skeleton the animation is played on, used to precompute conservative
+  // model-space bounds of the animation (see Animation::bound()). They allow
+  // to cull a character before sampling it. Bounds are computed by
+  // AnimationBoundsBuilder. Default value is NULL, which disables bounds.
+  const Skeleton* bounds_skeleton;
+
+  // Duration in seconds of the time segments a bounding box is computed for.
+  // The animation is evenly divided in ceil(duration / bounds_interval)
+  // segments, each box costing 24 bytes. Default value is 0, which computes a
+  // single box for the whole animation.
+  float bounds_interval;
+
+  // Distance bounds are inflated by, to compensate for joints moving out of
+  // the box between two samples. Default value is 0.
+  float bounds_margin;
+
+ private:
+  // Implements operator() for both raw animation types.
+  template <typename _Input>
+  Animation* Build(const _Input& _input) const;
 };
 }  // offline
 }  // animation
@@ -0,0 +1,150 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_FOOTPRINT_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_FOOTPRINT_H_
+
+#include <cstddef>
+
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime animation type.
+class Animation;
+
+namespace offline {
+
+// Describes the memory footprint of a runtime animation, broken down by
+// buffer and by track, along with an estimate of the memory saved by each
+// compression mode. See AnimationFootprintAnalyzer.
+struct AnimationFootprint {
+  // Default constructor, initializes an empty footprint.
+  AnimationFootprint();
+
+  // Defines the footprint of a single animation track.
+  struct Track {
+    // Number of keys of the track, per transformation type.
+    int translations;
+    int rotations;
+    int scales;
+
+    // Tells if the track is stored as a constant track (with a single key),
+    // per transformation type.
+    bool constant_translation;
+    bool constant_rotation;
+    bool constant_scale;
+
+    // Size in bytes of the track keys, including their tangents and key
+    // links.
+    size_t size;
+
+    // Number of keys of the track that are within analyzer tolerances of the
+    // interpolation of their neighbors, and could be removed.
+    int removable_keys;
+  };
+
+  // Footprint of every track of the animation.
+  ozz::Vector<Track>::Std tracks;
+
+  // Total size in bytes of the animation, as returned by Animation::size().
+  size_t size;
+
+  // Size in bytes of every animation buffer.
+  size_t translations_size;
+  size_t rotations_size;
+  size_t scales_size;
+  size_t translation_ranges_size;
+  size_t tangents_size;
+  size_t seek_index_size;
+  size_t key_links_size;
+  size_t bounds_size;
+
+  // Total number of keys and number of constant tracks, per transformation
+  // type.
+  int translations;
+  int rotations;
+  int scales;
+  int constant_translations;
+  int constant_rotations;
+  int constant_scales;
+
+  // Estimated number of bytes saved by every compression mode, compared to
+  // keys that store a float time and float values:
+  // - constant: storing constant tracks with a single key, instead of the two
+  // keys (at t = 0 and t = duration) that other tracks require.
+  // - time_quantization: storing key times as 16 bits ratios of the duration.
+  // - translation_quantization: storing 16 bits translation values relatively
+  // to their track range. Ranges cost is translation_ranges_size.
+  // - quaternion_packing: storing rotations with 3 quantized 16 bits
+  // components (smallest three).
+  // - scale_quantization: storing scales as half floats.
+  size_t constant_savings;
+  size_t time_quantization_savings;
+  size_t translation_quantization_savings;
+  size_t quaternion_packing_savings;
+  size_t scale_quantization_savings;
+
+  // Estimated number of bytes that would be saved by removing all
+  // removable_keys, with their tangents and key links, meaning by optimizing
+  // the animation with analyzer tolerances.
+  size_t tolerance_savings;
+};
+
+// Defines the class responsible for analyzing the memory footprint of a
+// runtime animation. Tracks are decompressed in order to estimate the number
+// of keys that could be removed by an optimization with tighter tolerances
+// (see AnimationOptimizer). This estimate always assumes linear
+// interpolation, so it's conservative for Hermite animations.
+class AnimationFootprintAnalyzer {
+ public:
+  // Initializes the analyzer with default parameters, which are the same as
+  // AnimationOptimizer ones.
+  AnimationFootprintAnalyzer();
+
+  // Analyzes _animation footprint and outputs it to _footprint.
+  // Returns false if _footprint is NULL or if tolerances are negative.
+  bool operator()(const Animation& _animation,
+                  AnimationFootprint* _footprint) const;
+
+  // Translation tolerance, in the animation unit (usually meters).
+  float translation_tolerance;
+
+  // Rotation tolerance in radians.
+  float rotation_tolerance;
+
+  // Scale tolerance, as a ratio.
+  float scale_tolerance;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_FOOTPRINT_H_
@@ -31,29 +31,137 @@
 #ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_OPTIMIZER_H_
 #define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_OPTIMIZER_H_
 
+#include "ozz/animation/offline/raw_animation.h"
+
 namespace ozz {
+
+// Forward declaration of task dispatcher interface.
+namespace tasks { class Dispatcher; }
+
 namespace animation {
+
+// Forward declare runtime skeleton type.
+class Skeleton;
+
 namespace offline {
 
-// Forward declare offline animation type.
-struct RawAnimation;
+// Forward declares the packed offline animation type.
+class PackedRawAnimation;
 
 // Defines the class responsible of optimizing an offline raw animation
 // instance. Default optimization tolerances are set in order to favor quality
 // over runtime performances and memory footprint.
+// Tracks are optimized independently, and can be processed concurrently by a
+// dispatcher.
 class AnimationOptimizer {
  public:
   // Initializes the optimizer with default tolerances (favoring quality).
   AnimationOptimizer();
 
+  // Defines key frame reduction algorithms.
+  enum Reduction {
+    // A key is removed if all the keys since the last kept one can be
+    // interpolated without it. This removes as many keys as possible, but
+    // complexity is quadratic with the number of keys in the worst case, ie:
+    // when long spans of keys can be interpolated.
+    kExhaustive,
+
+    // Same as kExhaustive, but a key is kept at least every reduction_window
+    // keys. Complexity is thus linear with the number of keys, at the cost of
+    // a few more keys for long spans of keys that can be interpolated.
+    kWindowed,
+  };
+
   // Optimizes _input using *this parameters.
   // Returns true on success and fills _output_animation with the optimized
   // version of _input animation.
   // *_output must be a valid RawAnimation instance.
   // Returns false on failure and resets _output to an empty animation.
-  // See RawAnimation::Validate() for more details about failure reasons.
+  // See RawAnimation::Validate() for more details about failure reasons, or
+  // if reduction_window or report_sampling_rate are invalid.
   bool operator()(const RawAnimation& _input, RawAnimation* _output) const;
 
+  // Optimizes _input using _skeleton hierarchy to measure errors in model
+  // space, instead of using per track local tolerances.
+  // The error of a joint is amplified by the length of the chain of joints it
+  // moves, and accumulates with the errors of its ancestors and descendants.
+  // Every joint is thus given a share of hierarchical_tolerance, and rotation
+  // and scale tolerances are derived from its distance to its farthest
+  // descendant. Keys of joints that move nothing, like leaves, can then be
+  // removed more aggressively, while keeping root joints accurate.
+  // _skeleton must have as many joints as _input has tracks, otherwise
+  // optimization fails.
+  // Returns true on success and fills _output_animation with the optimized
+  // version of _input animation.
+  // *_output must be a valid RawAnimation instance.
+  // Returns false on failure and resets _output to an empty animation.
+  bool operator()(const RawAnimation& _input,
+                  const Skeleton& _skeleton,
+                  RawAnimation* _output) const;
+
+  // Optimizes a packed animation, see PackedRawAnimation. Keys are decimated
+  // in per track key vectors, so _input is unpacked, optimized with the
+  // RawAnimation operator() (or the hierarchical one if _skeleton isn't NULL),
+  // and the result packed to _output.
+  // Returns false on failure and resets _output to an empty animation.
+  bool operator()(const PackedRawAnimation& _input,
+                  const Skeleton* _skeleton,
+                  PackedRawAnimation* _output) const;
+
+  // Defines the result of a progressive analysis, see Analyze().
+  struct Analysis {
+    // Default constructor, initializes interpolation to kLinear.
+    Analysis();
+
+    // Defines the removal errors of the keys of a track, in the order of the
+    // track keys. Errors are distances in meters for translations, angles in
+    // radian for rotations and norms of the difference for scales.
+    struct Track {
+      ozz::Vector<float>::Std translations;
+      ozz::Vector<float>::Std rotations;
+      ozz::Vector<float>::Std scales;
+    };
+
+    // The analyzed animation, ie: a copy of the input animation.
+    RawAnimation animation;
+
+    // The interpolation keys were removed with, which is also the
+    // interpolation of the animations extracted from this analysis.
+    RawAnimation::Interpolation interpolation;
+
+    // Removal errors of every track.
+    ozz::Vector<Track>::Std tracks;
+  };
+
+  // Analyzes _input once for all tolerances, in order to extract any number
+  // of optimized animations (quality tiers) without repeating the analysis.
+  // Keys are removed one by one, always the one whose removal introduces the
+  // smallest error, until no key can be removed. The error of a key is the
+  // largest error introduced in the track up to its removal, hence errors
+  // never decrease along the removal order. Keys whose error is below a
+  // tolerance can thus be removed together, and sorting keys by decreasing
+  // error gives a progressive order, whose prefixes are the animations
+  // optimized at every tolerance. First and last keys of a track, and keys
+  // that can't be removed because of reduction_window, are never removed.
+  // Uses interpolation, reduction, reduction_window and dispatcher
+  // parameters. Tolerances and report are ignored.
+  // Returns false on failure and resets _analysis, if _input is invalid or if
+  // reduction_window is invalid.
+  bool Analyze(const RawAnimation& _input, Analysis* _analysis) const;
+
+  // Extracts from _analysis the animation optimized with *this tolerances,
+  // ie: keeps only the keys whose error is greater than the tolerance. Output
+  // interpolation is _analysis one, and a report is computed if requested.
+  // Returns false on failure and resets _output to an empty animation, if
+  // _analysis is invalid or report_sampling_rate is invalid.
+  bool operator()(const Analysis& _analysis, RawAnimation* _output) const;
+
+  // Same as above, using _skeleton hierarchy to derive per track tolerances
+  // from hierarchical_tolerance, as the hierarchical operator() does.
+  bool operator()(const Analysis& _analysis,
+                  const Skeleton& _skeleton,
+                  RawAnimation* _output) const;
+
   // Translation optimization tolerance, defined as the distance between two
   // translation values in meters.
   float translation_tolerance;
@@ -64,6 +172,88 @@ class AnimationOptimizer {
 
   // Scale optimization tolerance, ie: the norm of the difference of two scales.
   float scale_tolerance;
+
+  // Hierarchical optimization tolerance, ie: the maximum model space distance
+  // in meters between any joint of the original and optimized animations.
+  // Only used when optimizing with a skeleton.
+  float hierarchical_tolerance;
+
+  // Distance in meters from a joint at which rotation and scale errors are
+  // measured when it has no descendant, representing skinned vertices. Only
+  // used when optimizing with a skeleton.
+  float hierarchical_distance;
+
+  // The key frame reduction algorithm. Default value is kExhaustive.
+  Reduction reduction;
+
+  // Maximum number of consecutive keys that can be removed when using
+  // kWindowed reduction. It must be greater than 0, default value is 64.
+  int reduction_window;
+
+  // The interpolation of the optimized animation. With kHermite, keys are
+  // removed if the cubic Hermite curves of the remaining ones are within
+  // tolerances, which keeps far fewer keys than kLinear on smooth curves.
+  // Output tangents are the input ones if _input is kHermite. Otherwise they
+  // are estimated from the input keys surrounding every key (Catmull-Rom
+  // tangents). Default value is kLinear.
+  RawAnimation::Interpolation interpolation;
+
+  // The dispatcher used to optimize tracks concurrently, one work item per
+  // track. Optimized animation doesn't depend on the dispatcher. Default value
+  // is NULL, which optimizes tracks sequentially on the calling thread.
+  tasks::Dispatcher* dispatcher;
+
+  // Defines the report of an optimization, which measures the keys removed
+  // and the error introduced by the optimizer. Errors are measured by
+  // sampling input and optimized animations at report_sampling_rate, and at
+  // the end of the animation.
+  struct Report {
+    // Defines key counts and errors of a track.
+    struct Track {
+      // Default constructor, initializes counts and errors to 0.
+      Track();
+
+      // Number of keys of the input and optimized tracks.
+      int input_translations;
+      int input_rotations;
+      int input_scales;
+      int output_translations;
+      int output_rotations;
+      int output_scales;
+
+      // Local space errors: distance between translations, angle in radian
+      // between rotations and norm of the difference of scales.
+      float max_translation_error;
+      float rms_translation_error;
+      float max_rotation_error;
+      float rms_rotation_error;
+      float max_scale_error;
+      float rms_scale_error;
+
+      // Model space error: the distance between input and optimized
+      // positions of the joint, and of the points at hierarchical_distance
+      // from the joint along its 3 axes. It's only measured when optimizing
+      // with a skeleton, and is 0 otherwise.
+      float max_model_error;
+      float rms_model_error;
+    };
+
+    // Report of every track.
+    ozz::Vector<Track>::Std tracks;
+
+    // Report of the whole animation: sum of all tracks key counts, maximum
+    // errors, and root mean square of the errors of all tracks samples.
+    Track total;
+  };
+
+  // Report output, filled when optimization succeeds. Default value is NULL,
+  // which doesn't compute any report.
+  Report* report;
+
+  // Rate, in hertz, at which input and optimized animations are sampled to
+  // measure report errors. It must be greater than 0 if a report is
+  // requested. Default value is 30.
+  float report_sampling_rate;
 };
 }  // offline
 }  // animation
@@ -0,0 +1,66 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_PAGE_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_PAGE_BUILDER_H_
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime animation type.
+class Animation;
+
+namespace offline {
+
+// Defines the class responsible of building animation pages, which are
+// self-sufficient runtime animations covering a time range of an original
+// runtime animation. Pages are used to stream animations, see
+// AnimationStreamer.
+// A page stores, for every track, the key frames required to sample the range:
+// the last key before or at range begin, and all the following keys until the
+// first key after range end. Key frames keep the original sorting, so a page
+// can be sampled with a SamplingJob at any time of its range, using the
+// original animation time. Page duration is the original animation duration,
+// but sampling a page out of its range gives undefined results.
+class AnimationPageBuilder {
+ public:
+  // Creates a page of _animation that covers [_begin,_end] time range.
+  // Returns a valid Animation on success, or NULL if _begin and _end don't
+  // define a valid range in [0,duration].
+  // The returned animation will then need to be deleted using the default
+  // allocator Delete() function.
+  Animation* operator()(const Animation& _animation,
+                        float _begin,
+                        float _end) const;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_PAGE_BUILDER_H_
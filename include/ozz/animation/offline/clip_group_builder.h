@@ -0,0 +1,88 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_CLIP_GROUP_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_CLIP_GROUP_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of task dispatcher interface.
+namespace tasks { class Dispatcher; }
+
+namespace animation {
+
+// Forward declares the runtime animation type.
+class Animation;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building synchronized clip groups, ie: a
+// single runtime animation that interleaves the keys of clips that are always
+// sampled together at the same normalized time, like the clips of a blend
+// space.
+// Every clip is normalized to a duration of 1, and its tracks are appended
+// to the group, padded to a multiple of 4 tracks so that every clip starts on
+// a soa track boundary. Clip c tracks are thus soa tracks
+// [c * num_soa_tracks / num_clips, (c + 1) * num_soa_tracks / num_clips[ of
+// the group. Runtime keys being sorted by time, the keys of all clips are
+// interleaved by normalized time, and a single sampling cache cursor walks
+// through all of them, with much better memory locality than one cursor per
+// clip. See ClipGroupSamplingJob to sample the group.
+class ClipGroupBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  ClipGroupBuilder();
+
+  // Creates the clip group of _clips, in the same order.
+  // Returns a valid Animation on success, or NULL if _clips is empty, if any
+  // clip is NULL or invalid (see RawAnimation::Validate()), if clips don't
+  // have the same number of tracks and interpolation, or if the group has
+  // more than Skeleton::kMaxJoints tracks.
+  // The returned animation will then need to be deleted using the default
+  // allocator Delete() function.
+  Animation* operator()(
+    const ozz::Range<const RawAnimation* const>& _clips) const;
+
+  // Group AnimationBuilder parameters, see AnimationBuilder::dispatcher,
+  // seek_interval and key_links. seek_interval is expressed in normalized
+  // time, as the group duration is 1.
+  tasks::Dispatcher* dispatcher;
+  float seek_interval;
+  bool key_links;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_CLIP_GROUP_BUILDER_H_
@@ -31,7 +31,15 @@
 #ifndef OZZ_OZZ_ANIMATION_OFFLINE_COLLADA_COLLADA_H_
 #define OZZ_OZZ_ANIMATION_OFFLINE_COLLADA_COLLADA_H_
 
+#include "ozz/base/platform.h"
+
 namespace ozz {
+namespace tasks {
+// Forward declares the task dispatcher used to import animation tracks
+// concurrently.
+class Dispatcher;
+}  // tasks
+
 namespace animation {
 
 //  Forward declares ozz runtime skeleton type.
@@ -42,6 +50,7 @@ namespace offline {
 //  Forward declares ozz offline animation and skeleton types.
 struct RawSkeleton;
 struct RawAnimation;
+class JointTrackSampler;
 
 namespace collada {
 
@@ -58,16 +67,23 @@ bool ImportFromMemory(const char* _xml, RawSkeleton* _skeleton);
 // and filled with animation data extracted from the Collada document.
 // _skeleton is a run-time Skeleton object used to select and sort animation
 // tracks.
+// Collada keys are imported as is, except for non-linear interpolations that
+// are sampled between keys with _sampler.
+// Once the document is parsed, tracks are baked concurrently using the optional
+// _dispatcher, one work item per track, which requires a thread safe default
+// allocator. Tracks are baked sequentially if _dispatcher is NULL.
 bool ImportFromFile(const char* _filename,
                     const Skeleton& _skeleton,
-                    float _sampling_rate,
-                    RawAnimation* _animation);
+                    const JointTrackSampler& _sampler,
+                    RawAnimation* _animation,
+                    tasks::Dispatcher* _dispatcher = NULL);
 
 // Same as ImportFromFile, but imports form a _xml located in memory.
 bool ImportFromMemory(const char* _xml,
                       const Skeleton& _skeleton,
-                      float _sampling_rate,
-                      RawAnimation* _animation);
+                      const JointTrackSampler& _sampler,
+                      RawAnimation* _animation,
+                      tasks::Dispatcher* _dispatcher = NULL);
 }  // collada
 }  // offline
 }  // animation
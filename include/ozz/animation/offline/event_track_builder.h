@@ -0,0 +1,59 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_EVENT_TRACK_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_EVENT_TRACK_BUILDER_H_
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime event track type.
+class EventTrack;
+
+namespace offline {
+
+// Forward declares the offline event track type.
+struct RawEventTrack;
+
+// Defines the class responsible of building runtime event tracks from offline
+// raw event tracks.
+class EventTrackBuilder {
+ public:
+  // Creates an EventTrack based on _raw_track.
+  // Returns a valid EventTrack on success, or NULL if _raw_track is invalid
+  // (see RawEventTrack::Validate()).
+  // The returned track will then need to be deleted using the default
+  // allocator Delete() function.
+  EventTrack* operator()(const RawEventTrack& _raw_track) const;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_EVENT_TRACK_BUILDER_H_
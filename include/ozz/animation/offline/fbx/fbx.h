@@ -31,7 +31,14 @@
 #ifndef OZZ_OZZ_ANIMATION_OFFLINE_FBX_FBX_H_
 #define OZZ_OZZ_ANIMATION_OFFLINE_FBX_FBX_H_
 
+#include "ozz/base/platform.h"
+
 namespace ozz {
+namespace tasks {
+// Forward declares the task dispatcher used to sample animations concurrently.
+class Dispatcher;
+}  // tasks
+
 namespace animation {
 
 //  Forward declares ozz runtime skeleton type.
@@ -42,6 +49,7 @@ namespace offline {
 //  Forward declares ozz offline animation and skeleton types.
 struct RawSkeleton;
 struct RawAnimation;
+class JointTrackSampler;
 
 namespace fbx {
 
@@ -54,11 +62,15 @@ bool ImportFromFile(const char* _filename, RawSkeleton* _skeleton);
 // _animation must point to a valid RawSkeleton instance, that will be cleared
 // and filled with animation data extracted from the fbx document.
 // _skeleton is a run-time Skeleton object used to select and sort animation
-// tracks.
+// tracks. Joint transformations are sampled with _sampler.
+// Animation time range is split in segments that are sampled concurrently using
+// the optional _dispatcher, each with its own Fbx evaluator, which requires a
+// thread safe default allocator. Sampling is sequential if _dispatcher is NULL.
 bool ImportFromFile(const char* _filename,
                     const Skeleton& _skeleton,
-                    float _sampling_rate,
-                    RawAnimation* _animation);
+                    const JointTrackSampler& _sampler,
+                    RawAnimation* _animation,
+                    tasks::Dispatcher* _dispatcher = NULL);
 }  // fbx
 }  // offline
 }  // animation
@@ -0,0 +1,93 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_JOINT_TRACK_SAMPLER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_JOINT_TRACK_SAMPLER_H_
+
+#include "ozz/animation/offline/raw_animation.h"
+
+namespace ozz {
+namespace math { struct Transform; }
+namespace animation {
+namespace offline {
+
+// Defines the class responsible of sampling a joint transformation curve, as
+// evaluated by importers (Collada, Fbx...), to the keys of a raw animation
+// track.
+// Keys are sampled at a fixed sampling_rate by default. The adaptive mode
+// subdivides time only where sampled transformations can't be interpolated
+// within tolerances, so that importers emit far fewer keys for the parts of
+// the curve that are (almost) linear. Adaptive sampling never samples more
+// keys than the fixed rate does, and those keys are a subset of the fixed
+// rate ones.
+class JointTrackSampler {
+ public:
+  // Defines the transformation curve to sample.
+  class Function {
+   public:
+    // Required virtual destructor.
+    virtual ~Function() {
+    }
+
+    // Evaluates the curve at _time to _transform. Returns false on failure,
+    // which fails sampling. Times aren't evaluated in increasing order in
+    // adaptive mode, but all of them are in the range given to the sampler.
+    virtual bool Evaluate(float _time, math::Transform* _transform) const = 0;
+  };
+
+  // Initializes the sampler with default parameters: 30hz fixed rate.
+  JointTrackSampler();
+
+  // Samples _function in range [_begin,_end] and appends keys to _track, in
+  // increasing time order. _begin and _end times are always sampled (once if
+  // they're equal), key times being the evaluated ones.
+  // Returns false if sampling_rate is invalid (<= 0), if _end is before
+  // _begin, or if _function evaluation fails.
+  bool operator()(const Function& _function, float _begin, float _end,
+                  RawAnimation::JointTrack* _track) const;
+
+  // Sampling rate in hertz. Default is 30.
+  float sampling_rate;
+
+  // Enables adaptive sampling. Default is false.
+  bool adaptive;
+
+  // Adaptive subdivision tolerances, compared to the error of interpolating
+  // surrounding keys. Translation tolerance is a distance in meters, rotation
+  // tolerance is an angle in radians, scale tolerance is the norm of the
+  // difference of two scales. Defaults match AnimationOptimizer ones.
+  float translation_tolerance;
+  float rotation_tolerance;
+  float scale_tolerance;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_JOINT_TRACK_SAMPLER_H_
@@ -0,0 +1,71 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_MODEL_SPACE_CLIP_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_MODEL_SPACE_CLIP_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class ModelSpaceClip;
+class Skeleton;
+
+namespace offline {
+
+// Defines the class responsible of baking an animation to a runtime
+// ModelSpaceClip, ie: its model-space joint matrices at a fixed rate.
+// The animation is sampled and converted to model-space with the
+// SampleToModelJob.
+class ModelSpaceClipBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  ModelSpaceClipBuilder();
+
+  // Bakes _animation of _skeleton.
+  // Returns a valid ModelSpaceClip on success, or NULL if sampling_rate isn't
+  // strictly positive, or if _animation doesn't have as many tracks as
+  // _skeleton joints.
+  // The returned clip will then need to be deleted using the default allocator
+  // Delete() function.
+  ModelSpaceClip* operator()(const Animation& _animation,
+                             const Skeleton& _skeleton) const;
+
+  // Number of frames baked per second. The actual rate is adjusted so that
+  // frames are evenly spaced over the animation. Default is 30.
+  float sampling_rate;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_MODEL_SPACE_CLIP_BUILDER_H_
@@ -0,0 +1,88 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_MOTION_DATABASE_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_MOTION_DATABASE_BUILDER_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class MotionDatabase;
+class Skeleton;
+
+namespace offline {
+
+// Defines the class responsible of building a motion matching database (see
+// MotionDatabase) from a set of runtime animations.
+// Every animation is sampled at a fixed rate with the SamplingJob and the
+// LocalToModelJob, from time 0 to its duration. The features of every sample
+// are extracted in the reference frame of the root joint, and finally
+// normalized over the whole database.
+class MotionDatabaseBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  MotionDatabaseBuilder();
+
+  // Builds the database of _animations, all of them animating _skeleton.
+  // Returns a valid MotionDatabase on success, or NULL on failure:
+  // -if any animation is NULL or doesn't have as many tracks as _skeleton
+  // joints, or if there's no animation.
+  // -if sampling_rate isn't strictly positive, if root or any feature joint
+  // isn't a valid joint index, or if any trajectory offset is negative.
+  // -if there's no feature, or more than MotionDatabase::kMaxFeatures.
+  // The returned instance will then need to be deleted using the default
+  // allocator Delete() function.
+  MotionDatabase* operator()(
+    const Skeleton& _skeleton,
+    const Range<const Animation* const>& _animations) const;
+
+  // Number of frames sampled per second. Default is 30.
+  float sampling_rate;
+
+  // Index of the joint that defines the reference frame of the features,
+  // usually the root or the hips. Default is 0.
+  int root;
+
+  // Joints whose position and velocity are features.
+  ozz::Vector<int>::Std joints;
+
+  // Time offsets, in seconds, of the future root positions that are features.
+  // Offsets beyond the end of an animation are clamped to its duration.
+  ozz::Vector<float>::Std trajectory;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_MOTION_DATABASE_BUILDER_H_
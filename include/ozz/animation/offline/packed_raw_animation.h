@@ -0,0 +1,211 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_PACKED_RAW_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_PACKED_RAW_ANIMATION_H_
+
+#include <cassert>
+#include <cstddef>
+
+#include "ozz/animation/offline/raw_animation.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Offline animation type, storing the same data as a RawAnimation in a packed
+// layout.
+// Instead of a vector of keys per track and per channel, keys of all the
+// tracks are stored in a single allocation, as separate time, value and
+// tangent arrays per channel (structure of arrays). Keys of a track are
+// contiguous in each array. This avoids the thousands of small allocations a
+// long RawAnimation requires, and lets the AnimationBuilder read key times
+// contiguously.
+// A PackedRawAnimation is created from a RawAnimation with Pack(), and is
+// read only afterwards. It can be converted back with Unpack().
+class PackedRawAnimation {
+ public:
+  // Defines a read only range of keys of a track, with the same interface as
+  // the RawAnimation::JointTrack key vectors. Keys are assembled on the fly
+  // from the time and value arrays, hence returned by value.
+  template <typename _Key, typename _Value>
+  class Keys {
+   public:
+    typedef _Key value_type;
+
+    Keys()
+      : times_(NULL),
+        values_(NULL),
+        size_(0) {
+    }
+    Keys(const float* _times, const _Value* _values, size_t _size)
+      : times_(_times),
+        values_(_values),
+        size_(_size) {
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    _Key operator[](size_t _index) const {
+      assert(_index < size_ && "Index out of range.");
+      const _Key key = {times_[_index], values_[_index]};
+      return key;
+    }
+    _Key front() const { return (*this)[0]; }
+    _Key back() const { return (*this)[size_ - 1]; }
+
+    // Returns the key times and values contiguous arrays.
+    const float* times() const { return times_; }
+    const _Value* values() const { return values_; }
+
+   private:
+    const float* times_;
+    const _Value* values_;
+    size_t size_;
+  };
+
+  // Defines a read only range of tangents of a track. Tangents are only stored
+  // by kHermite animations, the range is empty otherwise.
+  template <typename _Tangent>
+  class Tangents {
+   public:
+    typedef _Tangent value_type;
+
+    Tangents()
+      : tangents_(NULL),
+        size_(0) {
+    }
+    Tangents(const _Tangent* _tangents, size_t _size)
+      : tangents_(_tangents),
+        size_(_size) {
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const _Tangent& operator[](size_t _index) const {
+      assert(_index < size_ && "Index out of range.");
+      return tangents_[_index];
+    }
+
+   private:
+    const _Tangent* tangents_;
+    size_t size_;
+  };
+
+  // Defines a view of the keys of a track, whose members mirror
+  // RawAnimation::JointTrack ones.
+  struct JointTrack {
+    Keys<RawAnimation::TranslationKey, math::Float3> translations;
+    Keys<RawAnimation::RotationKey, math::Quaternion> rotations;
+    Keys<RawAnimation::ScaleKey, math::Float3> scales;
+    Tangents<math::Float3> translation_tangents;
+    Tangents<math::Float4> rotation_tangents;
+    Tangents<math::Float3> scale_tangents;
+  };
+
+  // Constructs an empty packed animation with a 1s default duration.
+  PackedRawAnimation();
+
+  // Deallocates packed animation.
+  ~PackedRawAnimation();
+
+  // Packs _raw keys to *this, replacing its content.
+  // Returns false and leaves *this empty if _raw isn't valid, see
+  // RawAnimation::Validate().
+  bool Pack(const RawAnimation& _raw);
+
+  // Unpacks *this keys to _raw, replacing its content.
+  void Unpack(RawAnimation* _raw) const;
+
+  // Tests for *this validity, following the same rules as
+  // RawAnimation::Validate(). Tangents count can't be wrong, as a kHermite
+  // packed animation has a tangent per key by construction.
+  bool Validate() const;
+
+  // Returns the number of tracks of this animation.
+  int num_tracks() const { return num_tracks_; }
+
+  // Returns a view of the keys of track _track.
+  JointTrack track(int _track) const;
+
+  // Returns the total number of keys of each channel.
+  size_t num_translations() const {
+    return num_tracks_ ? translations_.offsets[num_tracks_] : 0;
+  }
+  size_t num_rotations() const {
+    return num_tracks_ ? rotations_.offsets[num_tracks_] : 0;
+  }
+  size_t num_scales() const {
+    return num_tracks_ ? scales_.offsets[num_tracks_] : 0;
+  }
+
+  // The duration of the animation. All the keys of a valid animation are in
+  // the range [0,duration].
+  float duration;
+
+  // The interpolation of the key frames. Tangents are only packed for kHermite
+  // animations.
+  RawAnimation::Interpolation interpolation;
+
+ private:
+  // Disables copy and assignation.
+  PackedRawAnimation(PackedRawAnimation const&);
+  void operator=(PackedRawAnimation const&);
+
+  // Deallocates the packed buffer and resets *this to an empty animation.
+  void Reset();
+
+  // Defines the packed arrays of a channel. Keys of track i are in range
+  // [offsets[i],offsets[i + 1][ of times, values and tangents arrays.
+  template <typename _Value, typename _Tangent>
+  struct Channel {
+    size_t* offsets;
+    float* times;
+    _Value* values;
+    _Tangent* tangents;  // NULL unless kHermite.
+  };
+
+  // Number of tracks.
+  int num_tracks_;
+
+  // Per channel packed arrays, all pointing to the single buffer_ allocation.
+  Channel<math::Float3, math::Float3> translations_;
+  Channel<math::Quaternion, math::Float4> rotations_;
+  Channel<math::Float3, math::Float3> scales_;
+
+  // The single allocation all arrays are stored in.
+  void* buffer_;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_PACKED_RAW_ANIMATION_H_
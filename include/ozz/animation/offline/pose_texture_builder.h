@@ -0,0 +1,135 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_POSE_TEXTURE_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_POSE_TEXTURE_BUILDER_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace io { class Stream; }
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class Skeleton;
+
+namespace offline {
+
+// Defines a texture of baked model-space joint transforms, to evaluate an
+// animation on the GPU only, typically for far away crowd characters.
+// Every texel is made of 4 half floats (RGBA16F). Every row of the texture is
+// a frame, sampled at a fixed rate, and contains the transforms of all the
+// joints, texels_per_joint() texels per joint:
+// - kMatrix: the 3 first rows of the affine model-space matrix. Texel r of a
+// joint is (m[0][r], m[1][r], m[2][r], m[3][r]), so that the transformed
+// position is (dot(t0, p), dot(t1, p), dot(t2, p)) with p = (x, y, z, 1).
+// - kDualQuaternion: the unit dual quaternion of the model-space transform,
+// real part (x, y, z, w) followed by dual part (x, y, z, w). Scale isn't
+// supported by dual quaternions and is thus dropped. Signs of consecutive
+// frames are kept on the same hemisphere, so that frames can be linearly
+// interpolated.
+// Frames are evenly spaced, the first one at time 0 and the last one at the
+// end of the animation.
+struct PoseTexture {
+  // Default constructor, initializes an empty texture.
+  PoseTexture();
+
+  // Enumerates transform formats.
+  enum Format {
+    kMatrix,
+    kDualQuaternion
+  };
+
+  // Gets the number of texels per joint, depending on the format.
+  int texels_per_joint() const {
+    return format == kMatrix ? 3 : 2;
+  }
+
+  // Gets the texture width (number of texels per row), and height.
+  int width() const {
+    return num_joints * texels_per_joint();
+  }
+  int height() const {
+    return num_frames;
+  }
+
+  // Saves the texture to _stream, with the following layout, all values being
+  // little endian:
+  // - 4 bytes "ozzt" identifier, followed by a uint32 version (1).
+  // - uint32 format, num_joints, num_frames, width and height.
+  // - float32 frame rate and duration.
+  // - width * height * 4 texels half floats, row by row.
+  // The header is 36 bytes long.
+  // Returns false if the texture is empty or if writing failed.
+  bool Save(io::Stream* _stream) const;
+
+  // Transform format.
+  Format format;
+
+  // Number of joints and frames.
+  int num_joints;
+  int num_frames;
+
+  // Number of frames per second, and duration of the animation, in seconds.
+  float frame_rate;
+  float duration;
+
+  // Texels half float components, width() * height() * 4 values.
+  ozz::Vector<uint16_t>::Std texels;
+};
+
+// Defines the class responsible of baking an animation to a PoseTexture.
+// The animation is sampled with the SamplingJob and converted to model-space
+// with the LocalToModelJob.
+class PoseTextureBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  PoseTextureBuilder();
+
+  // Bakes _animation of _skeleton to _texture.
+  // Returns true on success, or false on failure:
+  // -if _texture is NULL, or if sampling_rate isn't strictly positive.
+  // -if _animation doesn't have as many tracks as _skeleton joints.
+  bool operator()(const Animation& _animation, const Skeleton& _skeleton,
+                  PoseTexture* _texture) const;
+
+  // Number of frames sampled per second. The actual rate is adjusted so that
+  // frames are evenly spaced over the animation. Default is 30.
+  float sampling_rate;
+
+  // Transform format. Default is kMatrix.
+  PoseTexture::Format format;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_POSE_TEXTURE_BUILDER_H_
@@ -0,0 +1,95 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_PROGRESSIVE_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_PROGRESSIVE_ANIMATION_BUILDER_H_
+
+#include "ozz/base/containers/vector.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_optimizer.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime types.
+class ProgressiveAnimation;
+class Skeleton;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building progressive animations, whose
+// levels are optimized with decreasing tolerances, see ProgressiveAnimation.
+// The raw animation is analyzed only once (see AnimationOptimizer::Analyze),
+// and every level is extracted from this analysis, so the keys of a level are
+// a subset of the keys of the finer levels.
+class ProgressiveAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters: 3 levels, scaling
+  // optimizer tolerances by 16, 4 and 1.
+  ProgressiveAnimationBuilder();
+
+  // Creates a ProgressiveAnimation from _raw_animation, using optimizer local
+  // tolerances.
+  // Returns a ProgressiveAnimation with all its levels resident on success,
+  // which must then be deleted using the default allocator Delete() function.
+  // Returns NULL if _raw_animation is invalid, if tolerance_scales is empty,
+  // not strictly decreasing or not strictly positive, or if optimizer or
+  // builder fail.
+  ProgressiveAnimation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Same as above, using optimizer hierarchical tolerances computed for
+  // _skeleton.
+  ProgressiveAnimation* operator()(const RawAnimation& _raw_animation,
+                                   const Skeleton& _skeleton) const;
+
+  // The optimizer used to analyze the raw animation and extract levels. Its
+  // tolerances are those of the finest level, scaled by tolerance_scales.
+  // Its report is ignored.
+  AnimationOptimizer optimizer;
+
+  // The builder used to build every level.
+  AnimationBuilder builder;
+
+  // Scale of optimizer tolerances for every level, coarsest level first.
+  ozz::Vector<float>::Std tolerance_scales;
+
+ private:
+  // Implements both operator().
+  ProgressiveAnimation* Build(const RawAnimation& _raw_animation,
+                              const Skeleton* _skeleton) const;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_PROGRESSIVE_ANIMATION_BUILDER_H_
@@ -55,6 +55,7 @@ namespace offline {
 //  1. Animation duration is greater than 0.
 //  2. Keyframes' time are sorted in a strict ascending order.
 //  3. Keyframes' time are all within [0,animation duration] range.
+//  4. Hermite animations tracks have as many tangents as keys.
 // Animations that would fail this validation will fail to be converted by the
 // AnimationBuilder.
 struct RawAnimation {
@@ -69,8 +70,20 @@ struct RawAnimation {
   //  1. Animation duration is greater than 0.
   //  2. Keyframes' time are sorted in a strict ascending order.
   //  3. Keyframes' time are all within [0,animation duration] range.
+  //  4. Hermite animations tracks have as many tangents as keys.
   bool Validate() const;
 
+  // Defines how key frames are interpolated.
+  enum Interpolation {
+    // Key frames are linearly interpolated, tangents are ignored.
+    kLinear,
+
+    // Key frames are interpolated with cubic Hermite curves, which are defined
+    // by the values and tangents of the 2 keys surrounding sampling time.
+    // Every track must have as many tangents as keys.
+    kHermite,
+  };
+
   // Defines a raw translation key frame.
   struct TranslationKey {
     float time;
@@ -113,6 +126,18 @@ struct RawAnimation {
     Rotations rotations;
     typedef ozz::Vector<ScaleKey>::Std Scales;
     Scales scales;
+
+    // Tangents of the key frames, ie: the derivative of their value, per
+    // second. The tangent at index i is the one of the key at index i. They
+    // are only used by kHermite interpolation, and can be left empty
+    // otherwise.
+    // Rotation tangents are the derivative of the quaternion components.
+    typedef ozz::Vector<math::Float3>::Std TranslationTangents;
+    TranslationTangents translation_tangents;
+    typedef ozz::Vector<math::Float4>::Std RotationTangents;
+    RotationTangents rotation_tangents;
+    typedef ozz::Vector<math::Float3>::Std ScaleTangents;
+    ScaleTangents scale_tangents;
   };
 
   // Returns the number of tracks of this animation.
@@ -127,11 +152,14 @@ struct RawAnimation {
   // The duration of the animation. All the keys of a valid RawAnimation are in
   // the range [0,duration].
   float duration;
+
+  // The interpolation of the key frames, kLinear by default.
+  Interpolation interpolation;
 };
 }  // offline
 }  // animation
 namespace io {
-OZZ_IO_TYPE_VERSION(1, animation::offline::RawAnimation)
+OZZ_IO_TYPE_VERSION(2, animation::offline::RawAnimation)
 OZZ_IO_TYPE_TAG("ozz-raw_animation", animation::offline::RawAnimation)
 
 // Should not be called directly but through io::Archive << and >> operators.
@@ -0,0 +1,87 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_RAW_EVENT_TRACK_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_RAW_EVENT_TRACK_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Offline event track type.
+// This type is not intended to be used in run time. It is used to define the
+// offline events (footsteps, notifies...) of an animation, that can be
+// converted to the runtime EventTrack using the EventTrackBuilder.
+// An event is defined with a time and a user defined id, which is usually an
+// index or a hash of the event name.
+// Finally the RawEventTrack structure exposes Validate() function to check
+// that it is valid, meaning that all the following rules are respected:
+//  1. Duration is greater than 0.
+//  2. Events' time are sorted in ascending order. Many events can be at the
+//  same time.
+//  3. Events' time are all within [0,duration] range.
+// Tracks that would fail this validation will fail to be converted by the
+// EventTrackBuilder.
+struct RawEventTrack {
+  // Constructs a valid RawEventTrack with a 1s default duration.
+  RawEventTrack();
+
+  // Deallocates raw event track.
+  ~RawEventTrack();
+
+  // Tests for *this validity, see rules above.
+  bool Validate() const;
+
+  // Defines a raw event.
+  struct Event {
+    float time;
+    uint32_t id;
+  };
+
+  // Returns the number of events of this track.
+  int num_events() const {
+    return static_cast<int>(events.size());
+  }
+
+  // Stores track events, sorted by time.
+  ozz::Vector<Event>::Std events;
+
+  // The duration of the track, which is usually the one of the animation it
+  // belongs to. All the events of a valid RawEventTrack are in the range
+  // [0,duration].
+  float duration;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_RAW_EVENT_TRACK_H_
@@ -0,0 +1,98 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_RAW_FLOAT_TRACK_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_RAW_FLOAT_TRACK_H_
+
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Offline float track type.
+// This type is not intended to be used in run time. It is used to define the
+// offline float curves (gameplay curves like ik weights, foot-plant flags,
+// blend-shape weights...) that can be converted to the runtime FloatTrack
+// using the FloatTrackBuilder. Curves aren't bound to any joint, and all
+// curves of a track share the same duration, which is usually the one of the
+// animation they are stored with.
+// Curves are made of linearly interpolated key frames, defined with a time and
+// a float value. Vector channels are defined with a curve per component, which
+// should be consecutive so that they are sampled together.
+// Finally the RawFloatTrack structure exposes Validate() function to check
+// that it is valid, meaning that all the following rules are respected:
+//  1. Duration is greater than 0.
+//  2. Keyframes' time are sorted in a strict ascending order.
+//  3. Keyframes' time are all within [0,duration] range.
+//  4. The number of curves is lower or equal to kMaxCurves.
+// Tracks that would fail this validation will fail to be converted by the
+// FloatTrackBuilder.
+struct RawFloatTrack {
+  // Constructs a valid RawFloatTrack with a 1s default duration.
+  RawFloatTrack();
+
+  // Deallocates raw float track.
+  ~RawFloatTrack();
+
+  // Tests for *this validity, see rules above.
+  bool Validate() const;
+
+  // Defines the maximum number of curves of a track.
+  static const int kMaxCurves = 1 << 16;
+
+  // Defines a raw float key frame.
+  struct Key {
+    float time;
+    float value;
+  };
+
+  // Defines a curve of key frames.
+  struct Curve {
+    typedef ozz::Vector<Key>::Std Keys;
+    Keys keys;
+  };
+
+  // Returns the number of curves of this track.
+  int num_curves() const {
+    return static_cast<int>(curves.size());
+  }
+
+  // Stores the curves of the track. A curve without any key is sampled as 0.
+  ozz::Vector<Curve>::Std curves;
+
+  // The duration of the track. All the keys of a valid RawFloatTrack are in
+  // the range [0,duration].
+  float duration;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_RAW_FLOAT_TRACK_H_
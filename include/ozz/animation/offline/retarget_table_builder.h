@@ -0,0 +1,65 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_RETARGET_TABLE_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_RETARGET_TABLE_BUILDER_H_
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime retarget table type.
+class RetargetTable;
+
+namespace offline {
+
+// Forward declares the offline skeleton type.
+struct RawSkeleton;
+
+// Defines the class responsible of building RetargetTable instances, which
+// retarget local transforms of a source skeleton to a target skeleton.
+// Target joints are mapped to the source joint with the same name. Joint
+// indices are the ones of the runtime skeletons built by the SkeletonBuilder
+// from the same raw skeletons. Bind pose corrections are computed from raw
+// skeletons bind poses, see RetargetTable.
+class RetargetTableBuilder {
+ public:
+  // Creates a RetargetTable that retargets _source skeleton transforms to
+  // _target skeleton.
+  // Returns a RetargetTable instance on success which will then be deleted
+  // using the default allocator Delete() function.
+  // Returns NULL on failure, if any of the raw skeletons isn't valid. See
+  // RawSkeleton::Validate() for more details about failure reasons.
+  RetargetTable* operator()(const RawSkeleton& _source,
+                            const RawSkeleton& _target) const;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_RETARGET_TABLE_BUILDER_H_
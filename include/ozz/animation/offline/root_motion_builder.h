@@ -0,0 +1,89 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ROOT_MOTION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ROOT_MOTION_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime root motion type.
+class RootMotion;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of extracting the root motion of an offline
+// raw animation, to a runtime RootMotion track (see RootMotionJob).
+// The horizontal translation (x and z) and the yaw (rotation around y axis) of
+// the root track are sampled at every root key, and reduced to the keys that
+// can't be interpolated within tolerances.
+// The motion can optionally be removed from the root track, so that the
+// animation is played "in place" while the motion is applied to the character.
+class RootMotionBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  RootMotionBuilder();
+
+  // Extracts the root motion of _input animation.
+  // Returns a valid RootMotion on success, or NULL on failure.
+  // If _output isn't NULL, it's filled with _input animation whose root track
+  // has the motion removed, ie: root keys are expressed relatively to the
+  // extracted motion. Removal doesn't support kHermite animations.
+  // The returned instance will then need to be deleted using the default
+  // allocator Delete() function.
+  // Returns NULL on failure, if _input is invalid (see
+  // RawAnimation::Validate()), if root isn't a valid track index or if
+  // removal is required for a kHermite animation. An animation without any
+  // track is accepted though, as a motionless animation.
+  RootMotion* operator()(const RawAnimation& _input,
+                         RawAnimation* _output) const;
+
+  // Index of the root track. Default is 0.
+  int root;
+
+  // Extracts vertical (y) translation also. Default is false.
+  bool vertical;
+
+  // Extracts yaw. Default is true.
+  bool yaw;
+
+  // Tolerances used to reduce motion keys, in meters and radians.
+  float translation_tolerance;
+  float yaw_tolerance;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ROOT_MOTION_BUILDER_H_
@@ -37,6 +37,10 @@
 #include "ozz/base/maths/transform.h"
 
 namespace ozz {
+
+// Forward declaration of task dispatcher interface.
+namespace tasks { class Dispatcher; }
+
 namespace animation {
 
 // Forward declares the runtime skeleton type.
@@ -48,14 +52,24 @@ namespace offline {
 struct RawSkeleton;
 
 // Defines the class responsible of building Skeleton instances.
+// Joints are listed iteratively, using a single scratch allocation, and their
+// parent index is known as they are listed instead of being searched for.
 class SkeletonBuilder {
  public:
+  // Initializes the builder with default parameters.
+  SkeletonBuilder();
+
   // Creates a Skeleton based on _raw_skeleton and *this builder parameters.
   // Returns a Skeleton instance on success which will then be deleted using
   // the default allocator Delete() function.
   // Returns NULL on failure. See RawSkeleton::Validate() for more details about
   // failure reasons.
   Skeleton* operator()(const RawSkeleton& _raw_skeleton) const;
+
+  // The dispatcher used to hash joint names concurrently. Built skeleton
+  // doesn't depend on the dispatcher. Default value is NULL, which hashes
+  // names sequentially on the calling thread.
+  tasks::Dispatcher* dispatcher;
 };
 }  // offline
 }  // animation
@@ -0,0 +1,91 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_SKELETON_LOD_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_SKELETON_LOD_BUILDER_H_
+
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime skeleton type.
+class Skeleton;
+
+namespace offline {
+
+// Defines the class responsible of building skeletons with levels of details
+// (lods) from runtime skeletons.
+// Joints are ranked by importance and reordered such that each lod is a prefix
+// of the joints of the built skeleton. Runtime jobs can then process the first
+// Skeleton::num_joints_lod() joints only, which allows far characters to skip
+// their fingers, face or twist joints.
+// Joints are sorted by decreasing importance, which is defined first by the
+// number of skinned vertices influenced by the joint and its descendants, then
+// by the number of joints of its hierarchy (leaves being the least important),
+// and finally by its depth. A parent is thus always more important than its
+// children, so the order preserves the skeleton DAG: parents are stored before
+// their children, as for any skeleton.
+// As joint indices change, meshes and animations that refer to the source
+// skeleton joint indices must be remapped, see _remap argument of operator().
+class SkeletonLodBuilder {
+ public:
+  // Initializes the builder with default parameters, which define 3 lods
+  // containing 100%, 50% and 25% of the joints.
+  SkeletonLodBuilder();
+
+  // Ratio of the joints of the source skeleton that each lod contains, lod 0
+  // being the most detailed one. Ratios must be in range ]0,1], and decreasing
+  // or equal. The number of joints of a lod is rounded up so that joints of
+  // equal importance, like symmetric ones, belong to the same lods.
+  ozz::Vector<float>::Std lod_ratios;
+
+  // Optional number of skinned vertices influenced by each joint of the source
+  // skeleton, usually accumulated from all the meshes of the character. Joints
+  // that don't influence any vertex, neither do their descendants, are the
+  // firsts to be removed from lods.
+  // If empty (default case), every joint is considered as influencing the
+  // same number of vertices. Otherwise it must contain a positive value per
+  // joint.
+  ozz::Vector<int>::Std influences;
+
+  // Creates a Skeleton with lods from _skeleton and *this builder parameters.
+  // If _remap isn't NULL, it's filled with the index in the built skeleton of
+  // every _skeleton joint.
+  // Returns a Skeleton instance on success which will then be deleted using
+  // the default allocator Delete() function.
+  // Returns NULL on failure, if lod ratios or influences are invalid.
+  Skeleton* operator()(const Skeleton& _skeleton,
+                       ozz::Vector<int>::Std* _remap = NULL) const;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_SKELETON_LOD_BUILDER_H_
@@ -0,0 +1,100 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_SPARSE_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_SPARSE_ANIMATION_BUILDER_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+
+// Forward declaration of task dispatcher interface.
+namespace tasks { class Dispatcher; }
+
+namespace animation {
+
+// Forward declares the runtime animation and skeleton types.
+class Animation;
+class Skeleton;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building sparse animations, ie: runtime
+// animations that only store the tracks of the joints an animation actually
+// moves, like facial or hand poses that animate a few joints of a full body
+// skeleton.
+// A joint is considered animated if any of its keys differs from the
+// skeleton bind pose, beyond the builder tolerances (empty channels being
+// identity). Animated tracks are built, in joint order, to a runtime animation
+// whose track i animates joint (*_joints)[i]. Sampling cost and memory then
+// scale with the number of animated joints, rather than with the skeleton
+// size. See SparseSamplingJob to sample it to a bind pose output.
+class SparseAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  SparseAnimationBuilder();
+
+  // Creates the sparse animation of _input, whose tracks animate _skeleton
+  // joints. _joints is filled with the joint animated by every track of the
+  // returned animation, sorted by increasing index.
+  // Returns a valid Animation on success, or NULL if _input is invalid (see
+  // RawAnimation::Validate()), or if its number of tracks doesn't match
+  // _skeleton number of joints.
+  // The returned animation will then need to be deleted using the default
+  // allocator Delete() function.
+  Animation* operator()(const RawAnimation& _input,
+                        const Skeleton& _skeleton,
+                        ozz::Vector<uint16_t>::Std* _joints) const;
+
+  // Maximum distance between a translation or scale key and the bind pose
+  // for the key to be considered unchanged.
+  // Default is 1e-5.
+  float translation_tolerance;
+  float scale_tolerance;
+
+  // Maximum angle (in radian) between a rotation key and the bind pose for
+  // the key to be considered unchanged.
+  // Default is 1e-5.
+  float rotation_tolerance;
+
+  // Sparse animation AnimationBuilder parameters, see
+  // AnimationBuilder::dispatcher, seek_interval and key_links.
+  tasks::Dispatcher* dispatcher;
+  float seek_interval;
+  bool key_links;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_SPARSE_ANIMATION_BUILDER_H_
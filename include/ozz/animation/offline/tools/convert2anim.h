@@ -31,7 +31,13 @@
 #ifndef OZZ_OZZ_ANIMATION_OFFLINE_TOOLS_CONVERT2ANIM_H_
 #define OZZ_OZZ_ANIMATION_OFFLINE_TOOLS_CONVERT2ANIM_H_
 
+#include "ozz/base/platform.h"
+
 namespace ozz {
+namespace tasks {
+class Dispatcher;
+}  // tasks
+
 namespace animation {
 
 class Skeleton;
@@ -39,16 +45,67 @@ class Skeleton;
 namespace offline {
 
 struct RawAnimation;
+class JointTrackSampler;
+
+namespace internal {
+class ConversionCache;
+}  // internal
 
 class AnimationConverter {
  public:
+  // Required virtual destructor.
+  virtual ~AnimationConverter() {
+  }
+
   int operator ()(int _argc, const char** _argv);
 
  private:
-  virtual bool Import(const char* _filename,
-                      const ozz::animation::Skeleton& _skeleton,
-                      float _sampling_rate,
-                      ozz::animation::offline::RawAnimation* _animation) = 0;
+  // Imports _filename animation to _animation, selecting _skeleton tracks.
+  // Importers that bake or resample curves do it with _sampler, configured
+  // from the command line sampling options.
+  // _dispatcher can be used to distribute the import workload, which allocates
+  // from a thread safe default allocator whenever _dispatcher has more than one
+  // thread.
+  virtual bool Import(
+    const char* _filename,
+    const ozz::animation::Skeleton& _skeleton,
+    const ozz::animation::offline::JointTrackSampler& _sampler,
+    ozz::animation::offline::RawAnimation* _animation,
+    ozz::tasks::Dispatcher* _dispatcher) = 0;
+
+  // Tells whether Import can be called concurrently from multiple threads, in
+  // which case batch conversions import files in parallel. Otherwise files are
+  // imported one at a time, while their optimization and build still run in
+  // parallel.
+  virtual bool IsImportThreadSafe() const {
+    return false;
+  }
+
+  // Loads the skeleton and converts the file specified by the command line, or
+  // all the files of the command line manifest if _batch is true.
+  bool Convert(bool _batch);
+
+  // Processes imported _raw_animation (root motion extraction, additive,
+  // optimization and build) and outputs it to _animation file, and root motion
+  // to _motion file if it isn't empty. _report is the optional optimization
+  // report output file.
+  bool Process(ozz::animation::offline::RawAnimation* _raw_animation,
+               const ozz::animation::Skeleton& _skeleton,
+               const char* _animation, const char* _motion,
+               const char* _report,
+               ozz::tasks::Dispatcher* _dispatcher);
+
+  // Converts all the files of manifest _manifest, the skeleton being loaded
+  // once for all of them. Files that are up to date in the optional _cache are
+  // skipped, _seed being the hash of the inputs shared by all files.
+  bool ConvertManifest(const char* _manifest,
+                       const ozz::animation::Skeleton& _skeleton,
+                       internal::ConversionCache* _cache,
+                       uint64_t _seed);
+
+  // Implements batch conversion task, which needs access to private members.
+  class ConvertTask;
+  friend class ConvertTask;
 };
 }  // offline
 }  // animation
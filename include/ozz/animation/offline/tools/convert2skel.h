@@ -39,11 +39,18 @@ struct RawSkeleton;
 
 class SkeletonConverter {
  public:
+  // Required virtual destructor.
+  virtual ~SkeletonConverter() {
+  }
+
   int operator ()(int _argc, const char** _argv);
 
  private:
   virtual bool Import(const char* _filename,
                       ozz::animation::offline::RawSkeleton* _skeleton) = 0;
+
+  // Imports skeleton file _filename and outputs it to _skeleton file.
+  bool Convert(const char* _filename, const char* _skeleton);
 };
 }  // offline
 }  // animation
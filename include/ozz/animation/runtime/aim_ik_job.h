@@ -0,0 +1,113 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_AIM_IK_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_AIM_IK_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace math { struct SoaTransform; }
+namespace animation {
+
+// Forward declares the Skeleton object used to describe joint hierarchy.
+class Skeleton;
+
+// Rotates a chain of joints (like spine, neck and head) so that the forward
+// axis of its last joint aims at a model space target.
+// The aiming correction is spread across the chain: walking the chain from its
+// first joint, every joint applies a fraction (its weight) of the correction
+// that remains to be done. The last joint of the chain should thus usually be
+// given a weight of 1, so that the aim is exact.
+// The job takes as input the model space matrices output by the
+// LocalToModelJob, as well as the local transforms they were computed from.
+// Local rotations of chain joints are corrected in place, and model space
+// matrices of the chain joints and all their descendants are updated in
+// place also. There's no need to run any ModelToLocalJob or LocalToModelJob
+// on the whole skeleton afterward.
+// The job does not owned any buffer and will thus not delete them during job's
+// destruction.
+struct AimIKJob {
+  // Default constructor, initializes default values.
+  AimIKJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer, including ranges, is NULL.
+  // -if locals or models ranges are smaller than the skeleton's number of
+  // joints.
+  // -if joints range is empty, or if any joint index is invalid.
+  // -if any joint of the chain isn't a descendant of the previous one.
+  // -if joint_weights range is smaller than the joints one.
+  // -if forward isn't normalized.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy.
+  const Skeleton* skeleton;
+
+  // Indices of the chain joints, ordered from the chain root to the aiming
+  // joint. Each joint must be a descendant of the previous one, but not
+  // necessarily a direct child.
+  Range<const int> joints;
+
+  // Per chain joint weights, in range [0,1], of the fraction of the remaining
+  // correction applied by each joint.
+  Range<const float> joint_weights;
+
+  // Model space target position. W component is ignored.
+  math::SimdFloat4 target;
+
+  // Normalized aiming joint local space axis that should point to the target.
+  // Default is x.
+  math::SimdFloat4 forward;
+
+  // Global weight given to the correction, clamped in range [0,1]. This allows
+  // to blend the aiming in and out. Default is 1.
+  float weight;
+
+  // Job input and output.
+
+  // Local transforms of the skeleton, in soa format. Chain joints rotations are
+  // updated.
+  Range<ozz::math::SoaTransform> locals;
+
+  // Model space matrices of the skeleton. Chain joints and their descendants
+  // are updated.
+  Range<ozz::math::Float4x4> models;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_AIM_IK_JOB_H_
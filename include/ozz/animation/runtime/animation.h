@@ -33,18 +33,27 @@
 
 #include "ozz/base/platform.h"
 #include "ozz/base/io/archive_traits.h"
+#include "ozz/base/endianness.h"
 
 namespace ozz {
 namespace io { class IArchive; class OArchive; }
+namespace math { struct Box; }
+namespace memory { class Allocator; }
 namespace animation {
 
 // Forward declares the AnimationBuilder, used to instantiate an Animation.
-namespace offline { class AnimationBuilder; }
+namespace offline {
+class AnimationBuilder;
+class AnimationPageBuilder;
+class AnimationBankBuilder;
+}
 
 // Forward declaration of key frame's type.
 struct TranslationKey;
 struct RotationKey;
 struct ScaleKey;
+struct SoaTranslationRange;
+struct KeyTangent;
 
 // Defines a runtime skeletal animation clip.
 // The runtime animation data structure stores animation keyframes, for all the
@@ -56,6 +65,19 @@ struct ScaleKey;
 // joints order of the runtime skeleton structure. In order to optimize cache
 // coherency when sampling the animation, Keyframes in this array are sorted by
 // time, then by track number.
+// Tracks whose value is constant for the whole clip are stored with a single
+// key, at the beginning of the array and sorted by track number. These keys
+// aren't part of the time sorted keys, so they are only decompressed when
+// sampling cache is filled.
+// Translation keys are quantized relatively to the range of values of their
+// track, which is stored per soa track (4 tracks).
+// Animations are linearly interpolated, unless they store a tangent for every
+// key, in which case they are interpolated with cubic Hermite curves. Tangents
+// are stored in a separate buffer, so linear animations don't pay for them.
+// An optional seek index stores sampling cache states at regular times, so
+// that sampling at a random time doesn't need to iterate all previous keys.
+// Optional key links, from every key to the previous key of its track, allow
+// sampling backward without invalidating the sampling cache.
 class Animation {
  public:
 
@@ -86,6 +108,12 @@ class Animation {
     return translations_;
   }
 
+  // Gets the buffer of translation ranges, one per soa track, used to decode
+  // translation keys.
+  ozz::Range<const SoaTranslationRange> translation_ranges() const {
+    return translation_ranges_;
+  }
+
   // Gets the buffer of rotation keys.
   ozz::Range<const RotationKey> rotations() const {
     return rotations_;
@@ -96,14 +124,188 @@ class Animation {
     return scales_;
   }
 
+  // Returns true if *this animation is interpolated with cubic Hermite curves,
+  // using key tangents, or false if it's linearly interpolated.
+  bool hermite() const {
+    return tangents_.begin != tangents_.end;
+  }
+
+  // Returns false if every scale key of *this animation is the unit scale, in
+  // which case sampling skips the scale channel and outputs unit scales. The
+  // flag is detected when the animation is built, loaded or mapped.
+  bool scaled() const {
+    return scaled_;
+  }
+
+  // Returns true if every scale key of *this animation is uniform, meaning its
+  // x, y and z components are equal. Unscaled animations are uniformly scaled.
+  // Along with Skeleton::uniformly_scaled(), this guarantees that skinning
+  // matrices have uniform scale, so normals can be skinned without inverse
+  // transpose matrices (see SkinningJob::joint_inverse_transpose_matrices).
+  // The flag is detected when the animation is built, loaded or mapped.
+  bool uniformly_scaled() const {
+    return uniformly_scaled_;
+  }
+
+  // Gets the buffer of key tangents, which is empty for linearly interpolated
+  // animations. Otherwise it stores one tangent per key, translation keys
+  // tangents first, then rotation and scale ones, in the same order as keys.
+  ozz::Range<const KeyTangent> tangents() const {
+    return tangents_;
+  }
+
+  // Gets the seek index buffer, which is empty unless the animation was built
+  // with a AnimationBuilder::seek_interval. It stores sampling key cursors at
+  // regular times, allowing to sample any time without fetching all the keys
+  // before it.
+  ozz::Range<const int32_t> seek_index() const {
+    return seek_index_;
+  }
+
+  // Gets the buffer of key links, which is empty unless the animation was
+  // built with AnimationBuilder::key_links. Otherwise it stores, for every
+  // key, its offset to the previous key of its track, or 0 if there's none or
+  // if it's too far. Translation keys links are stored first, then rotation
+  // and scale ones, in the same order as keys.
+  ozz::Range<const uint16_t> key_links() const {
+    return key_links_;
+  }
+
+  // Gets the bounds buffer, which is empty unless the animation was built with
+  // an AnimationBuilder::bounds_skeleton. Otherwise it stores the conservative
+  // model-space bounding boxes of the skeleton over consecutive time segments
+  // of equal duration, which cover the whole animation.
+  ozz::Range<const math::Box> bounds() const {
+    return bounds_;
+  }
+
+  // Gets the bounding box of the time segment that contains _time, which is
+  // clamped in range [0,duration]. The box can be transformed and tested for
+  // visibility before the animation is sampled at all, see
+  // ComputeBoundsJob::clip_bound.
+  // Returns NULL if the animation has no bounds.
+  const math::Box* bound(float _time) const;
+
+  // Gets the number of constant tracks, whose single key is stored at the
+  // beginning of translations, rotations and scales buffers.
+  int num_constant_translations() const {
+    return num_constant_translations_;
+  }
+  int num_constant_rotations() const {
+    return num_constant_rotations_;
+  }
+  int num_constant_scales() const {
+    return num_constant_scales_;
+  }
+
+  // Returns false if every translation track of *this animation is constant,
+  // like the bone lengths of a rigid hierarchy whose joints only rotate (and
+  // maybe scale). Sampling then outputs constant translations without
+  // interpolating them.
+  bool translated() const {
+    return num_constant_translations_ < num_soa_tracks() * 4;
+  }
+
   // Get the estimated animation's size in bytes.
   size_t size() const;
 
   // Serialization functions.
   // Should not be called directly but through io::Archive << and >> operators.
+  // Load packs all the key frame buffers in a single allocation from
+  // buffer_allocator(), so a loaded animation can be placed in caller memory,
+  // like a pool or a memory::LinearAllocator over a pre-reserved heap (see
+  // SetBufferAllocator). Version 10 archives are still loaded, with one
+  // allocation per buffer.
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // In-place blob functions.
+  // A blob is a versioned, native-endian and aligned image of the animation,
+  // which can be used in place (without any copy or deserialization) once it
+  // is memory mapped or read with a single io::Stream::Read call. Blobs aren't
+  // portable across platforms with different endianness or key frame layouts,
+  // they should be generated for (or on) the target platform.
+
+  // Required alignment of a blob buffer.
+  static const size_t kBlobAlignment = 16;
+
+  // Gets the size in bytes of the blob required to store *this animation.
+  size_t blob_size() const;
+
+  // Gets the size in bytes of a blob header, the first bytes of a blob. They
+  // are enough to know the size of the whole blob, see the static blob_size
+  // function below, and AnimationLoader.
+  static size_t blob_header_size();
+
+  // Gets the size in bytes of the blob whose header is _header, a buffer of
+  // _size bytes that contains at least the first blob_header_size() bytes of
+  // the blob.
+  // Returns 0 if _header is NULL, too small, or if it isn't a valid header.
+  static size_t blob_size(const void* _header, size_t _size);
+
+  // Writes *this animation to the _size bytes _blob buffer. _blob must be
+  // aligned to kBlobAlignment and be at least blob_size() bytes.
+  // Returns false if _blob is not valid.
+  bool SaveBlob(void* _blob, size_t _size) const;
+
+  // Same as above, but writes the blob for a platform of _endianness, so that
+  // blobs can be cooked offline for every target platform. Blobs only store
+  // offsets, so they don't depend on the target pointer size. RotationKey bit
+  // fields are laid out the way compilers allocate them for _endianness:
+  // from the least significant bit on little endian platforms, and from the
+  // most significant one on big endian platforms.
+  bool SaveBlob(void* _blob, size_t _size, Endianness _endianness) const;
+
+  // Maps *this animation to the _size bytes _blob buffer, which was written by
+  // SaveBlob. Key frames aren't copied, so _blob must remain valid and
+  // unchanged for the lifetime of *this animation (or until it is reloaded).
+  // It's never written to, so it can be mapped with read-only access.
+  // Returns false and leaves *this animation empty if _blob is not aligned to
+  // kBlobAlignment, or if its header, version or size are not valid.
+  bool MapBlob(const void* _blob, size_t _size);
+
+  // Returns true if *this animation key frames are mapped to a blob, meaning
+  // they aren't owned by *this animation. The blob itself is only owned by
+  // *this animation if it was loaded with an AnimationLoader.
+  bool mapped() const {
+    return mapped_;
+  }
+
+  // Exchanges the content of *this animation with _animation's, including key
+  // frame buffers ownership. This allows to reload an animation in place (for
+  // example from live tuning tools), at the same address, so that objects
+  // referencing it don't need to be updated. Generation ids of both animations
+  // are renewed, so sampling caches migrate to the new content on their next
+  // use: their cursors are restored at their current time from the seek index
+  // (if the animation has one), without requiring any explicit invalidation.
+  // Swap is cheap (no buffer is copied), but it isn't thread safe: it must be
+  // called while no job is using any of the two animations, typically between
+  // two frames. _animation must not be NULL.
+  void Swap(Animation* _animation);
+
+  // Sets the allocator of the key frame buffers of animations (and animation
+  // banks) that are built or loaded afterwards, and returns the previous one.
+  // Setting NULL restores memory::default_allocator(), which is used unless
+  // specified otherwise. Large animation sets can use
+  // memory::huge_page_allocator(), which reduces TLB misses when sampling
+  // randomly accesses many animations.
+  // Every animation deallocates its buffers with the allocator that allocated
+  // them, so the allocator can be changed at any time, but must outlive the
+  // animations it allocated.
+  static memory::Allocator* SetBufferAllocator(memory::Allocator* _allocator);
+
+  // Gets the allocator of the key frame buffers, see SetBufferAllocator.
+  // Never returns NULL.
+  static memory::Allocator* buffer_allocator();
+
+  // Gets *this animation generation id, which is unique to the program and
+  // renewed every time *this animation content is (re)built, loaded or mapped
+  // to a blob. SamplingCache relies on it to detect animation changes, even if
+  // a new animation is created at the address of a deleted one.
+  uint32_t id() const {
+    return id_;
+  }
+
  protected:
  private:
 
@@ -114,25 +316,82 @@ class Animation {
   // AnimationBuilder class is allowed to instantiate an Animation.
   friend class offline::AnimationBuilder;
 
+  // AnimationPageBuilder class is allowed to instantiate animation pages.
+  friend class offline::AnimationPageBuilder;
+
+  // AnimationBank class is allowed to map animations to its buffer.
+  friend class AnimationBank;
+
+  // AnimationLoader class is allowed to transfer a blob ownership.
+  friend class AnimationLoader;
+
+  // AnimationBankBuilder class is allowed to copy animations to a bank.
+  friend class offline::AnimationBankBuilder;
+
   // Internal destruction function.
   void Destroy();
 
+  // Loads version 10 archives, whose buffers are allocated one by one.
+  void LoadV10(ozz::io::IArchive& _archive);
+
   // Stores all translation/rotation/scale keys begin and end of buffers.
   ozz::Range<TranslationKey> translations_;
   ozz::Range<RotationKey> rotations_;
   ozz::Range<ScaleKey> scales_;
 
+  // Stores translation ranges, one per soa track.
+  ozz::Range<SoaTranslationRange> translation_ranges_;
+
+  // Stores key tangents, empty for linearly interpolated animations.
+  ozz::Range<KeyTangent> tangents_;
+
+  // Stores seek index entries, empty if the animation has no seek index.
+  ozz::Range<int32_t> seek_index_;
+
+  // Stores key links, empty if the animation has no key link.
+  ozz::Range<uint16_t> key_links_;
+
+  // Stores time segments bounds, empty if the animation has no bounds.
+  ozz::Range<math::Box> bounds_;
+
+  // Allocator of the key frame buffers, see SetBufferAllocator.
+  memory::Allocator* allocator_;
+
   // Duration of the animation clip.
   float duration_;
 
   // The number of joint tracks. Can differ from the data stored in translation/
   // rotation/scale buffers because of SoA requirements.
   int num_tracks_;
+
+  // The number of constant tracks, whose single key is stored at the
+  // beginning of the translation/rotation/scale buffers.
+  int num_constant_translations_;
+  int num_constant_rotations_;
+  int num_constant_scales_;
+
+  // At least one scale key isn't the unit scale, see scaled().
+  bool scaled_;
+
+  // Every scale key is uniform, see uniformly_scaled().
+  bool uniformly_scaled_;
+
+  // Key frame buffers are mapped to an external blob, so they aren't owned and
+  // mustn't be deallocated.
+  bool mapped_;
+
+  // Blob that key frame buffers are mapped to, when it's owned by *this
+  // animation (see AnimationLoader), or single buffer that Load packs all key
+  // frame buffers in. It's deallocated with allocator_.
+  void* blob_;
+
+  // Generation id of *this animation content, see id().
+  uint32_t id_;
 };
 }  // animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(2, animation::Animation)
+OZZ_IO_TYPE_VERSION(11, animation::Animation)
 OZZ_IO_TYPE_TAG("ozz-animation", animation::Animation)
 }  // io
 }  // ozz
@@ -0,0 +1,177 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_BANK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_BANK_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; }
+namespace math { struct Box; }
+namespace memory { class Allocator; }
+namespace animation {
+
+// Forward declares the AnimationBankBuilder, used to instantiate a bank.
+namespace offline { class AnimationBankBuilder; }
+
+// Forward declares the animation type.
+class Animation;
+
+// Forward declaration of key frame's type.
+struct TranslationKey;
+struct RotationKey;
+struct ScaleKey;
+struct SoaTranslationRange;
+struct KeyTangent;
+
+// Defines a bank of named runtime animations, like all the clips of a
+// character.
+// All bank animations, key frames, names and lookup table are stored in a
+// single allocation, with good memory locality. A bank is serialized as a
+// single archive object, with a single tag and version header, and a shared
+// names table. Animations can be looked up by name in constant time, names
+// being hashed to an open addressing table.
+// This structure is usually filled by the AnimationBankBuilder and
+// deserialized/loaded at runtime.
+class AnimationBank {
+ public:
+
+  // Builds an empty bank.
+  AnimationBank();
+
+  // Declares the public non-virtual destructor.
+  ~AnimationBank();
+
+  // Gets the number of animations in the bank.
+  int num_animations() const {
+    return static_cast<int>(animations_.Count());
+  }
+
+  // Gets animation at _index, which must be in range [0,num_animations()[.
+  const Animation& animation(int _index) const;
+
+  // Gets the name of the animation at _index, which must be in range
+  // [0,num_animations()[.
+  const char* name(int _index) const;
+
+  // Finds the animation named _name and returns its index, or -1 if there's
+  // no animation with this name in the bank.
+  int Find(const char* _name) const;
+
+  // Get the estimated bank's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  AnimationBank(AnimationBank const&);
+  void operator=(AnimationBank const&);
+
+  // AnimationBankBuilder class is allowed to instantiate a bank.
+  friend class offline::AnimationBankBuilder;
+
+  // Allocates the bank buffer for _num_animations animations, with the given
+  // total number of translation ranges, key frames, tangents, seek index, key
+  // links, bounds and names size, and sets all ranges into it. Animations are
+  // constructed but remain empty.
+  void Allocate(int _num_animations,
+                int _num_translation_ranges,
+                int _num_translations,
+                int _num_rotations,
+                int _num_scales,
+                int _num_tangents,
+                int _seek_index_size,
+                int _num_key_links,
+                int _num_bounds,
+                int _names_size);
+
+  // Fills name hashes and lookup table, once names are set.
+  void BuildLookupTable();
+
+  // Internal destruction function.
+  void Destroy();
+
+  // The bank buffer, that stores all of the following ranges. It's allocated
+  // with the animation buffer allocator, see Animation::SetBufferAllocator.
+  char* buffer_;
+  size_t buffer_size_;
+  memory::Allocator* allocator_;
+
+  // Bank animations, whose key frames are mapped to the buffer.
+  ozz::Range<Animation> animations_;
+
+  // Offset of each animation name in names_ buffer.
+  ozz::Range<int32_t> name_offsets_;
+
+  // Hash of each animation name.
+  ozz::Range<uint32_t> name_hashes_;
+
+  // Open addressing lookup table of animation indices, -1 for empty buckets.
+  // Its size is a power of 2.
+  ozz::Range<int32_t> lookup_;
+
+  // Translation ranges of all the animations, contiguously.
+  ozz::Range<SoaTranslationRange> translation_ranges_;
+
+  // Key frames of all the animations, contiguously.
+  ozz::Range<TranslationKey> translations_;
+  ozz::Range<RotationKey> rotations_;
+  ozz::Range<ScaleKey> scales_;
+
+  // Key tangents of all the animations, contiguously.
+  ozz::Range<KeyTangent> tangents_;
+
+  // Seek index of all the animations, contiguously.
+  ozz::Range<int32_t> seek_index_;
+
+  // Key links of all the animations, contiguously.
+  ozz::Range<uint16_t> key_links_;
+
+  // Bounds of all the animations, contiguously.
+  ozz::Range<math::Box> bounds_;
+
+  // Names buffer, storing all null terminated names.
+  ozz::Range<char> names_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(9, animation::AnimationBank)
+OZZ_IO_TYPE_TAG("ozz-animation_bank", animation::AnimationBank)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_BANK_H_
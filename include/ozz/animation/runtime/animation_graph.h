@@ -0,0 +1,232 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_GRAPH_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_GRAPH_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/animation/runtime/blending_job.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class Skeleton;
+class SamplingCache;
+
+// Evaluates a graph of sampling and blending nodes, aka a blend tree, to a
+// local-space posture of a skeleton. This wraps SamplingJob and BlendingJob,
+// along with the management of their intermediate buffers.
+// Nodes are added with Add*Node() functions, which return the node index. A
+// node can only use nodes that were added before it as inputs, which makes
+// the graph acyclic, but a node can be used by several others.
+// Intermediate postures are carved out of a scratch arena that is reused by
+// all evaluations. Inputs whose weight is 0 aren't evaluated, neither are the
+// nodes they depend on. Nodes can also cache their result (see SetCached()),
+// which is then reused until the node or one of the inputs it depends on is
+// modified, through SetTime(), SetWeight() or Invalidate().
+// All buffers are allocated while building the graph, evaluation doesn't
+// allocate any memory.
+// AnimationGraph isn't thread safe, an instance must not be used by multiple
+// threads concurrently.
+class AnimationGraph {
+ public:
+  // Constructs a graph of at most _max_nodes nodes and _max_inputs inputs
+  // overall, whose nodes evaluate postures of _skeleton. _skeleton must
+  // outlive the graph.
+  AnimationGraph(const Skeleton& _skeleton, int _max_nodes, int _max_inputs);
+
+  // Deallocates the graph.
+  ~AnimationGraph();
+
+  // Index returned by Add*Node() functions when a node can't be added.
+  static const int kInvalidNode = -1;
+
+  // Defines an input of a blend node.
+  struct Input {
+    // Default constructor, initializes default values.
+    Input();
+
+    // Index of the input node.
+    int node;
+
+    // Blending weight of the input, see BlendingJob::Layer::weight. An input
+    // whose weight is less than or equal to 0 isn't evaluated.
+    float weight;
+
+    // Optional blending weights of each soa joint, see
+    // BlendingJob::Layer::joint_weights. If specified, the range must contain
+    // at least skeleton num_soa_joints weights.
+    Range<const math::SimdFloat4> joint_weights;
+  };
+
+  // Adds a node that samples _animation using _cache, whose time is set with
+  // SetTime(). Joints that aren't animated are set to the skeleton bind pose.
+  // Returns kInvalidNode if graph is full, if any argument is NULL or if
+  // _animation has more tracks than the skeleton.
+  int AddSampleNode(const Animation* _animation, SamplingCache* _cache);
+
+  // Adds a node that blends _inputs, falling back to the skeleton bind pose as
+  // BlendingJob does. _inputs are copied to the graph.
+  // Returns kInvalidNode if graph is full or any input is invalid.
+  int AddBlendNode(Range<const Input> _inputs);
+
+  // Adds a node that adds _additive node to _base node with _weight, see
+  // BlendingJob::additive_layers. _base is input 0 and _additive is input 1,
+  // whose weight can be changed with SetWeight().
+  // Returns kInvalidNode if graph is full or any node is invalid.
+  int AddAdditiveNode(int _base, int _additive, float _weight);
+
+  // Adds a node that overrides the joints of _base node with the ones of
+  // _input node, according to _mask joint weights, 1 fully selecting _input.
+  // _mask must contain at least skeleton num_soa_joints weights, in range
+  // [0,1]. Mask content is copied to the graph.
+  // Returns kInvalidNode if graph is full or any argument is invalid.
+  int AddMaskNode(int _base, int _input, Range<const math::SimdFloat4> _mask);
+
+  // Sets sampling time of sample node _node.
+  void SetTime(int _node, float _time);
+
+  // Sets the weight of input _input of blend node _node, or the weight of
+  // additive node _node if _input is 1.
+  void SetWeight(int _node, int _input, float _weight);
+
+  // Enables or disables _node result caching. A cached node owns a posture
+  // buffer, allocated when caching is enabled.
+  void SetCached(int _node, bool _cached);
+
+  // Notifies that an external data used by _node changed, such as its
+  // animation or joint weights content, so that its cached result (and the
+  // one of the nodes that depend on it) can't be reused.
+  void Invalidate(int _node);
+
+  // Evaluates the posture of _node to _output, which must contain at least
+  // skeleton num_soa_joints transforms.
+  // Returns false if _node or _output are invalid, or if any sampling failed.
+  bool Evaluate(int _node, Range<math::SoaTransform> _output);
+
+  // Gets the number of nodes of the graph.
+  int num_nodes() const {
+    return num_nodes_;
+  }
+
+  // Gets the number of nodes that were computed during last evaluation,
+  // excluding skipped nodes and reused cached results.
+  int num_computed_nodes() const {
+    return num_computed_nodes_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  AnimationGraph(AnimationGraph const&);
+  void operator=(AnimationGraph const&);
+
+  // Defines node types.
+  enum NodeType {
+    kSample,
+    kBlend,
+    kAdditive,
+    kMask
+  };
+
+  // Defines a node.
+  struct Node;
+
+  // Allocates a node that uses _num_inputs inputs, whose inputs nodes must be
+  // set. Returns NULL if graph is full.
+  Node* NewNode(NodeType _type, int _num_inputs);
+
+  // Validates input node _index and _joint_weights.
+  bool ValidateInput(int _index,
+                     Range<const math::SimdFloat4> _joint_weights) const;
+
+  // Finalizes the last node allocated by NewNode(), whose inputs are set, and
+  // returns its index.
+  int FinalizeNode();
+
+  // Marks _node as modified.
+  void Modify(int _node);
+
+  // Returns the latest modification stamp of _node and the active inputs it
+  // depends on.
+  uint32_t Modified(int _node);
+
+  // Evaluates _node, and returns a pointer to its result, or NULL if
+  // evaluation failed. The result is computed to _dest if it isn't NULL and
+  // _node isn't cached, to a scratch buffer otherwise.
+  const math::SoaTransform* EvaluateNode(int _node, math::SoaTransform* _dest);
+
+  // Evaluates _node to _dest.
+  bool EvaluateNodeTo(int _node, math::SoaTransform* _dest);
+
+  // Blends _num_layers layers, that start at _node first input, and
+  // _num_additive_layers additive layers that follow them, to _output.
+  bool Blend(const Node& _node,
+             int _num_layers,
+             int _num_additive_layers,
+             math::SoaTransform* _output);
+
+  // The skeleton of all postures.
+  const Skeleton& skeleton_;
+
+  // Nodes and inputs, and their capacity.
+  Node* nodes_;
+  int max_nodes_;
+  int num_nodes_;
+  Input* inputs_;
+  int max_inputs_;
+  int num_inputs_;
+
+  // Blending layers, one per input. Layers of a node are set while evaluating
+  // it, from its first input.
+  BlendingJob::Layer* layers_;
+
+  // Scratch arena of postures, used as a stack during evaluation.
+  math::SoaTransform* scratch_;
+  int scratch_size_;
+  int scratch_top_;
+
+  // Modification stamp, incremented each time a node is modified.
+  uint32_t stamp_;
+
+  // Evaluation counter.
+  uint32_t evaluation_;
+
+  // Number of nodes computed during last evaluation.
+  int num_computed_nodes_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_GRAPH_H_
@@ -0,0 +1,137 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_LOADER_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_LOADER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace memory { class Allocator; }
+namespace animation {
+
+class Animation;
+
+// Loads an animation blob (see Animation::SaveBlob) incrementally, without
+// doing any io itself. The loader exposes the range of bytes of the blob that
+// must be read next, and the buffer to read them to. The application reads
+// them, possibly asynchronously (from a coroutine, an io completion...), and
+// resumes the loader once they are available:
+// - the header is read first, to a small loader buffer. It tells the size of
+// the whole blob.
+// - the body (the rest of the blob) is then read directly to the final buffer
+// of the animation, allocated with Animation::buffer_allocator(). There's no
+// intermediate buffer nor copy of key frames.
+// Once loaded, the animation is mapped to its blob buffer, which it owns and
+// deallocates when it's destroyed or reloaded.
+class AnimationLoader {
+ public:
+  // Loader states.
+  enum State {
+    kHeader,  // The blob header must be read.
+    kBody,  // The blob body must be read.
+    kLoaded,  // The animation is loaded.
+    kFailed,  // Loading failed, the animation is empty.
+  };
+
+  // Constructs a loader that loads a blob to _animation, which must outlive
+  // the loader. _animation is emptied and mustn't be used until loading
+  // completes. Loading fails immediately if _animation is NULL.
+  explicit AnimationLoader(Animation* _animation);
+
+  // Deallocates the blob buffer if loading didn't complete.
+  ~AnimationLoader();
+
+  // Gets loader current state.
+  State state() const {
+    return state_;
+  }
+
+  // Gets the offset, from the beginning of the blob, of the bytes to read
+  // next. 0 unless reading the body.
+  size_t offset() const {
+    return offset_;
+  }
+
+  // Gets the number of bytes to read next, 0 once loaded or failed.
+  size_t size() const {
+    return size_;
+  }
+
+  // Gets the buffer size() bytes must be read to, NULL once loaded or failed.
+  void* buffer() const {
+    return buffer_;
+  }
+
+  // Gets the size of the whole blob, known once the header was read, 0
+  // before.
+  size_t blob_size() const {
+    return blob_size_;
+  }
+
+  // Resumes loading once the size() bytes at offset() of the blob were read
+  // to buffer().
+  // Returns false if loading failed, because the header is invalid or the
+  // blob buffer couldn't be allocated, or if there was nothing to resume.
+  bool Resume();
+
+ private:
+  // Disables copy and assignation.
+  AnimationLoader(AnimationLoader const&);
+  void operator=(AnimationLoader const&);
+
+  // Sets failed state and releases the blob.
+  void Fail();
+
+  // The animation to load.
+  Animation* animation_;
+
+  // Loader state.
+  State state_;
+
+  // The range of bytes to read next, and the buffer to read them to.
+  size_t offset_;
+  size_t size_;
+  void* buffer_;
+
+  // The blob header, whose size is Animation::blob_header_size().
+  void* header_;
+
+  // Allocator of the blob buffer, the animation buffer allocator when the
+  // loader was constructed.
+  memory::Allocator* allocator_;
+
+  // The blob buffer, allocated once the header is read.
+  char* blob_;
+  size_t blob_size_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_LOADER_H_
@@ -0,0 +1,207 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_RESIDENCY_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_RESIDENCY_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the animation type.
+class Animation;
+
+// Keeps the memory used by a set of animation clips within a budget.
+// Clips are identified by an index. The manager tracks the memory size of
+// every resident clip (see Animation::size()) and the last time it was used.
+// When resident clips exceed the budget, Update() releases the least recently
+// used ones, or downgrades them to a lower quality variant if they have one
+// (like a more aggressively optimized build of the same clip). A downgraded
+// clip is upgraded back as soon as it's used again. Clips can also be
+// prefetched ahead of use, for example the targets of animation graph
+// transitions that are likely to be taken.
+// Like the AnimationStreamer, the manager doesn't perform any loading itself.
+// Clips are loaded and released by an application provided Loader, which can
+// work asynchronously. A clip being loaded keeps its current variant resident
+// until the new one is notified with OnLoaded, so it can still be sampled.
+// The SamplingCache is invalidated when a clip variant changes, as every
+// animation has its own generation id (see Animation::id()).
+class AnimationResidencyManager {
+ public:
+
+  // Declares the clip loading interface that must be implemented by the
+  // application.
+  class Loader {
+   public:
+    // Required virtual destructor.
+    virtual ~Loader() {
+    }
+
+    // Requests clip _clip to be loaded, its low quality variant if _low is
+    // true. Loading can be asynchronous, its completion must be notified with
+    // AnimationResidencyManager::OnLoaded, from the thread that updates the
+    // manager. OnLoaded can also be called from this function for synchronous
+    // loading.
+    virtual void Load(int _clip, bool _low) = 0;
+
+    // Releases clip _clip _animation, which isn't used anymore by the
+    // manager.
+    virtual void Unload(int _clip, Animation* _animation) = 0;
+  };
+
+  // Constructs a manager for _num_clips clips, whose resident animations
+  // should not exceed _budget bytes. Clips are loaded and released using
+  // _loader, which must be valid for the whole lifetime of the manager.
+  AnimationResidencyManager(int _num_clips, size_t _budget, Loader* _loader);
+
+  // Releases all resident clips.
+  ~AnimationResidencyManager();
+
+  // Gets the number of clips.
+  int num_clips() const {
+    return num_clips_;
+  }
+
+  // Sets and gets the memory budget, in bytes. It's enforced by the next
+  // Update().
+  void set_budget(size_t _budget) {
+    budget_ = _budget;
+  }
+  size_t budget() const {
+    return budget_;
+  }
+
+  // Declares whether clip _clip has a low quality variant, that can be loaded
+  // instead of evicting the clip. Default is false.
+  void set_low_variant(int _clip, bool _available);
+
+  // Marks clip _clip as used at _time, and requests its loading (full
+  // quality) if needed. _time is any application clock, that must not go
+  // backward. Returns the resident animation to sample, which can be the low
+  // quality variant, or NULL if none is resident yet.
+  const Animation* Use(int _clip, float _time);
+
+  // Requests clip _clip loading (full quality) ahead of use, like Use() does,
+  // but without returning its animation. It's considered used at _time, so
+  // that it isn't evicted by the next Update().
+  void Prefetch(int _clip, float _time);
+
+  // Enforces the budget. Clips that weren't used since _time are released
+  // from the least recently used, or downgraded if they have a low quality
+  // variant, until resident clips fit in the budget. Clips used at _time are
+  // never released, so the budget can be exceeded if they don't fit.
+  void Update(float _time);
+
+  // Notifies that clip _clip variant (the low quality one if _low is true),
+  // requested through Loader::Load, is loaded. The previously resident variant
+  // is released. Returns false if this variant isn't expected anymore (clip
+  // was evicted or upgraded meanwhile), in which case the manager doesn't take
+  // ownership of _animation.
+  bool OnLoaded(int _clip, bool _low, Animation* _animation);
+
+  // Gets clip _clip resident animation, or NULL if it isn't resident.
+  const Animation* animation(int _clip) const;
+
+  // Returns true if clip _clip resident animation is its low quality variant.
+  bool low_quality(int _clip) const;
+
+  // Gets the memory size of resident animations, in bytes.
+  size_t resident_size() const {
+    return resident_size_;
+  }
+
+  // Gets the number of resident clips.
+  int num_resident_clips() const;
+
+ private:
+
+  // Disables copy and assignation.
+  AnimationResidencyManager(AnimationResidencyManager const&);
+  void operator=(AnimationResidencyManager const&);
+
+  // Defines clip state.
+  struct Clip {
+    // Resident animation, NULL if not loaded.
+    Animation* animation;
+
+    // Memory size of the resident animation.
+    size_t size;
+
+    // Last time the clip was used or prefetched.
+    float last_use;
+
+    // The resident animation is the low quality variant.
+    bool low;
+
+    // The clip has a low quality variant.
+    bool low_variant;
+
+    // Loading of the full quality and low quality variants were requested,
+    // but aren't completed yet.
+    bool pending_high;
+    bool pending_low;
+  };
+
+  // Defines a clip that can be released, sorted by last use.
+  struct Candidate {
+    float last_use;
+    int clip;
+    bool operator<(const Candidate& _other) const {
+      return last_use < _other.last_use;
+    }
+  };
+
+  // Requests clip _clip full quality variant, if it isn't resident nor
+  // pending.
+  void Request(int _clip, float _time);
+
+  // Releases clip _clip resident animation.
+  void Release(int _clip);
+
+  // Clips states.
+  Range<Clip> clips_;
+
+  // Clips that can be released, allocated once for all clips.
+  Range<Candidate> candidates_;
+
+  // The application clip loader.
+  Loader* loader_;
+
+  // Number of clips.
+  int num_clips_;
+
+  // Memory budget, and size of resident animations, in bytes.
+  size_t budget_;
+  size_t resident_size_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_RESIDENCY_H_
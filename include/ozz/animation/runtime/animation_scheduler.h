@@ -0,0 +1,162 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_SCHEDULER_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_SCHEDULER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct Float4x4; }
+
+namespace animation {
+
+// Schedules crowd characters animation updates, so that sampling and
+// local-to-model conversion cost is bounded per frame whatever the number of
+// characters.
+// Every character is assigned an update interval, in frames, from its screen
+// size: characters at least full_rate_size large update every frame, and
+// smaller ones update less often, up to every max_interval frames. At most
+// budget characters are updated per frame, the ones that are the most overdue
+// relatively to their interval first. In between two updates, a character
+// holds its model matrices, or interpolates them with Interpolate() and
+// ratio(), in which case it's rendered one update late.
+// AnimationScheduler does not lock, so an instance must not be used by
+// multiple threads concurrently.
+class AnimationScheduler {
+ public:
+  // Age of characters that are waiting for their first update.
+  static const int kMaxAge = 1 << 20;
+
+  // Constructs a scheduler of _capacity characters, that updates at most
+  // _budget characters per frame, or all the scheduled ones if _budget is 0.
+  // Update intervals range from 1 frame, for characters whose screen size is
+  // at least _full_rate_size, to _max_interval frames.
+  // All characters are initially scheduled for an update, with a 0 screen
+  // size.
+  AnimationScheduler(int _capacity,
+                     int _budget,
+                     int _max_interval,
+                     float _full_rate_size);
+
+  // Deallocates scheduler buffers.
+  ~AnimationScheduler();
+
+  // Sets character _index screen size, usually its projected bounding
+  // radius (in any unit consistent with full_rate_size), which updates its
+  // interval. A character out of the screen should have a 0 size.
+  void SetScreenSize(int _index, float _screen_size);
+
+  // Forces character _index to be updated as soon as possible, for example
+  // when it starts a new animation or is teleported.
+  void Invalidate(int _index);
+
+  // Advances the scheduler to the next frame, and outputs to _updates the
+  // indices of the characters to update this frame, the most overdue first.
+  // Returns the number of characters output, which is at most budget and
+  // _updates size.
+  int Schedule(Range<int> _updates);
+
+  // Interpolates model matrices _from and _to by _ratio (usually ratio()),
+  // and outputs them to _output. Matrices are linearly interpolated, which
+  // is only accurate for the small changes that occur between two updates.
+  // Returns false if _from and _to sizes differ, or if _output is smaller.
+  static bool Interpolate(Range<const math::Float4x4> _from,
+                          Range<const math::Float4x4> _to,
+                          float _ratio,
+                          Range<math::Float4x4> _output);
+
+  // Gets character _index update interval, in frames.
+  int interval(int _index) const;
+
+  // Gets the number of frames since character _index last update, which is 0
+  // if it was updated by the last Schedule() call. It saturates to kMaxAge,
+  // which is also the age of characters that were never updated or were
+  // invalidated.
+  int age(int _index) const;
+
+  // Gets the ratio of character _index interval elapsed since its last
+  // update, in range [0,1]. To interpolate between its two last updates.
+  float ratio(int _index) const;
+
+  // Gets the number of characters.
+  int capacity() const {
+    return capacity_;
+  }
+
+  // Gets the maximum number of characters updated per frame, 0 if unbounded.
+  int budget() const {
+    return budget_;
+  }
+
+  // Gets the longest update interval, in frames.
+  int max_interval() const {
+    return max_interval_;
+  }
+
+  // Gets the screen size from which characters are updated every frame.
+  float full_rate_size() const {
+    return full_rate_size_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  AnimationScheduler(AnimationScheduler const&);
+  void operator=(AnimationScheduler const&);
+
+  // Number of characters.
+  int capacity_;
+
+  // Maximum number of characters updated per frame, 0 if unbounded.
+  int budget_;
+
+  // Longest update interval, in frames.
+  int max_interval_;
+
+  // Screen size from which characters are updated every frame.
+  float full_rate_size_;
+
+  // Buffer that stores all the arrays below.
+  int* buffer_;
+
+  // Update interval of every character, in frames.
+  int* intervals_;
+
+  // Number of frames since every character last update.
+  int* ages_;
+
+  // Indices of the characters due for an update, used by Schedule().
+  int* due_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_SCHEDULER_H_
@@ -0,0 +1,161 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_STREAMER_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_STREAMER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the animation type.
+class Animation;
+
+// Streams an animation split in time pages, so that only the pages around the
+// sampling time are resident in memory.
+// Each page is a self-sufficient Animation that covers a time range of the
+// original animation. It's built offline with the AnimationPageBuilder, using
+// the page time ranges defined by the streamer (see page_begin() and
+// page_end()). Pages are sampled with a SamplingJob using the original
+// animation time. The SamplingCache is automatically invalidated when the
+// sampled page changes, as every page has its own generation id (see
+// Animation::id()), even if it's allocated at the address of a released one.
+// The streamer doesn't perform any loading itself, pages are loaded and
+// released by an application provided Loader, which can work asynchronously.
+// Update() requests pages ahead of the sampling time and evicts the ones that
+// are behind, according to the number of pages ahead and behind that must be
+// kept resident.
+class AnimationStreamer {
+ public:
+
+  // Declares the page loading interface that must be implemented by the
+  // application.
+  class Loader {
+   public:
+    // Required virtual destructor.
+    virtual ~Loader() {
+    }
+
+    // Requests page _page to be loaded. Loading can be asynchronous, its
+    // completion must be notified with AnimationStreamer::OnLoaded, from the
+    // thread that updates the streamer. OnLoaded can also be called from this
+    // function for synchronous loading.
+    virtual void Load(int _page) = 0;
+
+    // Releases page _page _animation, which isn't used anymore by the
+    // streamer.
+    virtual void Unload(int _page, Animation* _animation) = 0;
+  };
+
+  // Constructs a streamer for an animation of _duration seconds, split in
+  // pages of _page_duration seconds. Pages are loaded and released using
+  // _loader, which must be valid for the whole lifetime of the streamer.
+  AnimationStreamer(float _duration, float _page_duration, Loader* _loader);
+
+  // Releases all resident pages.
+  ~AnimationStreamer();
+
+  // Gets the number of pages.
+  int num_pages() const {
+    return num_pages_;
+  }
+
+  // Gets the page index to use to sample at _time, which is clamped to the
+  // animation duration.
+  int page(float _time) const;
+
+  // Gets page _page begin and end times, in the original animation time.
+  // These are the time ranges pages must be built for.
+  float page_begin(int _page) const;
+  float page_end(int _page) const;
+
+  // Sets the number of pages kept resident ahead (default 1) and behind
+  // (default 0) of the page that matches sampling time.
+  void set_pages_ahead(int _pages);
+  void set_pages_behind(int _pages);
+
+  // Updates pages residency according to sampling _time. Requests the loading
+  // of pages in the resident window that aren't resident nor pending (the
+  // page at _time first), and releases resident pages out of this window.
+  void Update(float _time);
+
+  // Notifies that page _page requested through Loader::Load is loaded.
+  // Returns false if _page isn't pending, in which case the streamer doesn't
+  // take ownership of _animation.
+  bool OnLoaded(int _page, Animation* _animation);
+
+  // Gets the page animation to sample at _time, or NULL if it isn't resident
+  // yet.
+  const Animation* animation(float _time) const;
+
+  // Gets the number of resident pages.
+  int num_resident_pages() const;
+
+ private:
+
+  // Disables copy and assignation.
+  AnimationStreamer(AnimationStreamer const&);
+  void operator=(AnimationStreamer const&);
+
+  // Defines page state.
+  struct Page {
+    // Resident page animation, NULL if not loaded.
+    Animation* animation;
+
+    // Loading was requested, but isn't completed yet.
+    bool pending;
+  };
+
+  // Requests page _page loading if it's neither resident nor pending.
+  void Request(int _page);
+
+  // Pages states.
+  Range<Page> pages_;
+
+  // The application page loader.
+  Loader* loader_;
+
+  // Original animation duration.
+  float duration_;
+
+  // Duration of a page.
+  float page_duration_;
+
+  // Number of pages.
+  int num_pages_;
+
+  // Resident window, in number of pages.
+  int pages_ahead_;
+  int pages_behind_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_STREAMER_H_
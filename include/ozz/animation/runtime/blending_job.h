@@ -38,6 +38,9 @@ namespace ozz {
 // Forward declaration of math structures.
 namespace math { struct SoaTransform; }
 
+// Forward declares the allocator used for temporary buffers.
+namespace memory { class Allocator; }
+
 namespace animation {
 
 // Blends multiple input layer/postures to a single output. The number of
@@ -47,6 +50,13 @@ namespace animation {
 // Partial animation blending is supported through optional joint weights that
 // can be specified with layers joint_weights buffer. Unspecified joint weights
 // are considered as a unit weight of 1.f.
+// Additive layers (see AdditiveAnimationBuilder) are then added to the
+// normalized result. Bind pose fallback, normalization and additive layers are
+// processed in a single pass over the output.
+// All these stages are independent for each soa joint, so a job can be
+// restricted to a range of soa joints (see soa_range). Jobs that only differ
+// by disjoint soa ranges write disjoint outputs, so they can run concurrently
+// on different threads to spread the blending of a single character.
 // The job does not owned any buffers (input/output) and will thus not delete
 // them during job's destruction.
 struct BlendingJob {
@@ -56,11 +66,15 @@ struct BlendingJob {
   // Validates job parameters.
   // Returns true for a valid job, false otherwise:
   // -if layer range is not valid.
-  // -if any layer is not valid.
+  // -if any layer or additive layer is not valid.
   // -if output range is not valid.
   // -if any buffer (including layers' content : transform, joint weights...) is
   // smaller than the bind pose buffer.
+  // -if any layer soa ranges are not sorted or exceed the bind pose buffer.
   // -if the threshold value is less than or equal to 0.f.
+  // -if soa range is invalid.
+  // -if num_joints_lod is negative.
+  // -if bind_pose_flags range is not NULL and smaller than the bind pose.
   bool Validate() const;
 
   // Runs job's blending task.
@@ -69,6 +83,12 @@ struct BlendingJob {
   // Returns false if *this job is not valid.
   bool Run() const;
 
+  // Defines a range [begin,end[ of soa joints, ie: joints [begin*4,end*4[.
+  struct SoaRange {
+    int begin;
+    int end;
+  };
+
   // Defines a layer of blending input data (local space transforms) and
   // parameters (weights).
   struct Layer {
@@ -78,6 +98,8 @@ struct BlendingJob {
     // Blending weight of this layer. Negative values are considered as 0.
     // Normalization is performed during the blending stage so weight can be in
     // any range, even though range [0:1] is optimal.
+    // Additive layers aren't normalized though, 0 meaning no effect and 1 the
+    // full additive delta.
     float weight;
 
     // The range [begin,end[ of input layer posture. This buffer expect to store
@@ -101,7 +123,20 @@ struct BlendingJob {
     // Negative weight values are considered as 0, but positive ones aren't
     // clamped because they could exceed 1.f if all layers contains valid joint
     // weights.
+    // Transforms of the soa joints whose 4 weights are 0 aren't read, so they
+    // don't need to be sampled (see SamplingJob::soa_mask).
     Range<const math::SimdFloat4> joint_weights;
+
+    // Optional range [begin,end[ of the soa joint ranges blended by this
+    // layer, which allows a layer that affects a few joints to only process
+    // these ones. Soa joints that don't belong to any range are considered as
+    // having a weight of 0, so their transforms and joint weights aren't read.
+    // If both pointers are NULL (default case) then all soa joints are
+    // blended.
+    // A valid list of ranges is sorted, doesn't overlap and is within the
+    // bind pose range. A single range defines an active sub-range of soa
+    // joints. Additive layers don't support soa ranges.
+    Range<const SoaRange> soa_ranges;
   };
 
   // The job blends the bind pose to the output when the accumulated weight of
@@ -113,6 +148,14 @@ struct BlendingJob {
   // The range of layers that must be blended.
   Range<const Layer> layers;
 
+  // Job input additive layers.
+  // The optional range of additive layers, whose transforms are deltas from a
+  // reference pose, added to the normalized blending of layers in order. Their
+  // weight, and joint weights, scale the delta: translation is added, rotation
+  // is post-multiplied and scale is multiplied.
+  // If both pointers are NULL (default case), no additive layer is applied.
+  Range<const Layer> additive_layers;
+
   // The skeleton bind pose. The size of this buffer defines the number of
   // transforms to blend. This is the reference because this buffer is defined
   // by the skeleton that all the animations belongs to.
@@ -126,6 +169,81 @@ struct BlendingJob {
   // Must be at least as big as the bind pose buffer, but only the number of
   // transforms defined by the bind pose buffer size will be processed.
   Range<ozz::math::SoaTransform> output;
+
+  // Optional range [begin,end[ of flags, one per soa joint of the output,
+  // telling if the output soa joint holds the bind pose. These flags are
+  // expected to be kept by the user from one run to the next, along with the
+  // output buffer. Soa joints that no layer affects are set to the bind pose
+  // with a copy, rather than with a weighted blending. Moreover, the copy is
+  // skipped if the flag tells that the output already holds the bind pose.
+  // The job updates flags of the processed soa joints. They must be reset to
+  // false if the output is modified by anything else than this job, or if the
+  // bind pose changes.
+  // If both pointers are NULL (default case), bind pose is always copied.
+  // Must be at least as big as the bind pose buffer otherwise.
+  Range<bool> bind_pose_flags;
+
+  // The range of soa joints processed by the job, which is clamped to the bind
+  // pose size. Other soa joints of the output are left unchanged. All buffers
+  // and layer soa ranges keep on addressing all soa joints, so the same layers
+  // can be used by all jobs of a split.
+  // Default range contains all soa joints. begin must be positive, and end
+  // greater or equal to begin.
+  SoaRange soa_range;
+
+  // The number of joints of the skeleton level of details to blend, see
+  // Skeleton::num_joints_lod(). Processing stops after the soa joint that
+  // contains the last joint of the lod, further soa joints of the output being
+  // left unchanged. It is combined with soa_range.
+  // Default value is Skeleton::kMaxJoints, which blends all joints.
+  int num_joints_lod;
+
+  // Normalizes blended rotations and additive rotation deltas with a fast
+  // reciprocal square root estimation, skipping the Newton-Raphson step. This
+  // is cheaper but less accurate, see SamplingJob::fast_normalization.
+  // Default is false.
+  bool fast_normalization;
+
+  // Blends scales. Can be set to false if no layer, additive layer or bind
+  // pose transform is scaled, see Skeleton::scaled() and Animation::scaled().
+  // Output scales are then set to unit scales without being blended.
+  // Default is true.
+  bool scaled;
+
+  // Statistics of blending jobs, see stats member.
+  struct Stats {
+    // Initializes all counters to 0.
+    Stats();
+
+    // Number of blended layers whose weight is greater than 0, including
+    // partial ones.
+    int layers;
+
+    // Number of blended partial layers, aka with per-joint weights.
+    int partial_layers;
+
+    // Number of additive layers whose weight is greater than 0.
+    int additive_layers;
+
+    // Number of soa joints processed.
+    int soa_joints;
+
+    // Number of processed soa joints set to the bind pose without blending,
+    // either copied or skipped, see bind_pose_flags.
+    int bind_pose_joints;
+  };
+
+  // Optional statistics, accumulated by every run of the job. Counters are
+  // only updated if ozz is built with stats enabled (OZZ_HAS_STATS, see
+  // ozz_build_stats CMake option).
+  // Default is NULL.
+  Stats* stats;
+
+  // Optional allocator of the accumulated weights of the processed soa joints,
+  // which are sized to the soa range. It's meant to be a per-thread frame
+  // arena (see memory::ArenaAllocator), so it's used without any heap traffic
+  // nor lock. Default is NULL, which uses the default allocator.
+  memory::Allocator* scratch_allocator;
 };
 }  // animation
 }  // ozz
@@ -0,0 +1,188 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_CHARACTER_PIPELINE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_CHARACTER_PIPELINE_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; struct Float4x4; }
+
+// Forward declaration of the task dispatcher.
+namespace tasks { class Dispatcher; }
+
+namespace animation {
+
+// Forward declares the skeleton type.
+class Skeleton;
+
+// Executes a sequence of stages, like sampling, blending, local-to-model and
+// skinning, for a set of characters that share the same skeleton.
+// Stages are described once with AddStage(), and are executed in order for
+// every character. Characters are processed concurrently, by chunks of
+// contiguous characters dispatched to a tasks::Dispatcher.
+// Every character owns its model-space matrices, which remain valid after
+// Run(). Local-space transforms are scratch buffers instead, one per chunk,
+// that are reused by all the characters of the chunk, so memory doesn't grow
+// with the number of characters. All buffers are allocated at construction,
+// running the pipeline doesn't allocate any memory.
+// Time spent in every stage is measured during Run(), see stage_time().
+class CharacterPipeline {
+ public:
+  // Defines the buffers of the character being processed.
+  struct Context {
+    // Index of the character, in range [0,num_characters[ as specified to
+    // Run().
+    int character;
+
+    // Local-space transforms, skeleton num_soa_joints transforms. This is a
+    // scratch buffer, whose content is undefined when the first stage of a
+    // character is executed.
+    Range<math::SoaTransform> locals;
+
+    // Model-space matrices of the character, skeleton num_joints matrices.
+    Range<math::Float4x4> models;
+  };
+
+  // Declares a stage, implemented by the application.
+  class Stage {
+   public:
+    // Required virtual destructor.
+    virtual ~Stage() {
+    }
+
+    // Executes the stage for _context character. Run is called concurrently
+    // from multiple threads, with different characters.
+    // Returns false on failure, in which case following stages aren't executed
+    // for this character.
+    virtual bool Run(const Context& _context) const = 0;
+  };
+
+  // Constructs a pipeline of at most _max_stages stages, for at most
+  // _max_characters characters of _skeleton. _skeleton must outlive the
+  // pipeline. Characters are split in at most _max_chunks chunks, which is
+  // the maximum concurrency of Run(), and the number of local-space scratch
+  // buffers.
+  CharacterPipeline(const Skeleton& _skeleton,
+                    int _max_characters,
+                    int _max_stages,
+                    int _max_chunks);
+
+  // Deallocates the pipeline.
+  ~CharacterPipeline();
+
+  // Index returned by Add*Stage() functions when a stage can't be added.
+  static const int kInvalidStage = -1;
+
+  // Appends _stage, named _name, to the pipeline. _stage and _name must
+  // outlive the pipeline.
+  // Returns the stage index, or kInvalidStage if pipeline is full or _stage
+  // is NULL.
+  int AddStage(const Stage* _stage, const char* _name);
+
+  // Appends the built-in stage that converts local-space transforms to
+  // model-space matrices, using LocalToModelJob.
+  // Returns the stage index, or kInvalidStage if pipeline is full.
+  int AddLocalToModelStage();
+
+  // Executes all stages for characters [0,_num_characters[, dispatching
+  // chunks of characters to _dispatcher, or serially on the calling thread if
+  // _dispatcher is NULL.
+  // Returns false if _num_characters is invalid, or if a stage failed for any
+  // character.
+  bool Run(int _num_characters, tasks::Dispatcher* _dispatcher);
+
+  // Gets model-space matrices of character _character.
+  Range<const math::Float4x4> models(int _character) const;
+
+  // Gets the number of stages.
+  int num_stages() const {
+    return num_stages_;
+  }
+
+  // Gets the name of stage _stage.
+  const char* stage_name(int _stage) const;
+
+  // Gets the time spent in stage _stage during the last Run(), in seconds,
+  // summed over all characters and threads.
+  float stage_time(int _stage) const;
+
+  // Gets the maximum number of characters.
+  int max_characters() const {
+    return max_characters_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  CharacterPipeline(CharacterPipeline const&);
+  void operator=(CharacterPipeline const&);
+
+  // Executes all stages for the characters of chunk _chunk.
+  class ChunkTask;
+
+  // Implements the built-in local-to-model stage.
+  class LocalToModelStage;
+
+  // The skeleton of all characters.
+  const Skeleton& skeleton_;
+
+  // Maximum number of characters, stages and chunks.
+  int max_characters_;
+  int max_stages_;
+  int max_chunks_;
+
+  // Stages and their names.
+  const Stage** stages_;
+  const char** names_;
+  int num_stages_;
+
+  // Built-in local-to-model stage.
+  LocalToModelStage* local_to_model_;
+
+  // Model-space matrices of all characters.
+  math::Float4x4* models_;
+
+  // Local-space scratch buffers, one per chunk.
+  math::SoaTransform* locals_;
+
+  // Time spent in every stage by every chunk, in seconds, and the sum of all
+  // chunks.
+  double* chunk_times_;
+  float* stage_times_;
+
+  // Result of every chunk.
+  bool* chunk_results_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_CHARACTER_PIPELINE_H_
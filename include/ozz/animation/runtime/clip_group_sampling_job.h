@@ -0,0 +1,108 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_CLIP_GROUP_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_CLIP_GROUP_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares the animation and cache types to sample.
+class Animation;
+class SamplingCache;
+
+// Samples all the clips of a synchronized clip group (see
+// offline::ClipGroupBuilder) at the same normalized time, in a single pass.
+// The keys of all clips share a single cache cursor, which is stepped once per
+// run instead of once per clip.
+// The job either outputs all clip poses, one after the other, or their
+// weighted blend if weights are provided. Blended weights are normalized and
+// rotations are blended following BlendingJob rules, but no bind pose is
+// involved as weights always sum to 1. Clips whose weight is 0 aren't sampled.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct ClipGroupSamplingJob {
+  // Default constructor, initializes default values.
+  ClipGroupSamplingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if group or cache are NULL, or if num_clips is less than 1.
+  // -if group number of soa tracks isn't a multiple of num_clips.
+  // -if the cache is too small or can't address all group keys.
+  // -if weights isn't empty and its size isn't num_clips, or if no weight is
+  // greater than 0.
+  // -if output is smaller than group number of soa tracks, or than the number
+  // of soa tracks of a single clip when weights are provided.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Normalized time used to sample all clips, in range [0,1]. Values out of
+  // range are clamped.
+  float ratio;
+
+  // The clip group to sample.
+  const Animation* group;
+
+  // Number of clips of the group, which must match the number of clips the
+  // group was built with.
+  int num_clips;
+
+  // A cache object that must be big enough to sample the whole group.
+  SamplingCache* cache;
+
+  // Optional blending weight of each clip. Negative weights are considered as
+  // 0. If empty, all clip poses are output.
+  Range<const float> weights;
+
+  // Job output.
+  // If weights are empty, receives all clip poses: clip c pose starts at soa
+  // transform c * num_soa_tracks / num_clips. Otherwise receives the blended
+  // pose, whose size is the number of soa tracks of a single clip.
+  Range<ozz::math::SoaTransform> output;
+
+  // Normalizes sampled and blended rotations with a fast estimation, see
+  // SamplingJob::fast_normalization. Default is false.
+  bool fast_normalization;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_CLIP_GROUP_SAMPLING_JOB_H_
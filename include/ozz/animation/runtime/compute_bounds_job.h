@@ -0,0 +1,97 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_COMPUTE_BOUNDS_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_COMPUTE_BOUNDS_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Box; struct Float4x4; }
+namespace animation {
+
+// Computes the axis aligned bounding box of a posture, for example to frustum
+// cull a character.
+// The box is computed from one of the following inputs:
+// - models: the model-space matrices of the joints, as output by the
+// LocalToModelJob. The box contains all joint positions, optionally inflated
+// by per-joint radii. Positions are reduced with SIMD min/max.
+// - clip_bound: a conservative box, precomputed offline for a whole animation
+// clip (see offline::AnimationBoundsBuilder). It contains every posture of
+// the clip, which allows to cull a character before sampling it at all.
+// The output box can be transformed to another space, usually world-space,
+// using an optional transform.
+// The job does not owned any buffer (in/output) and will thus not delete them
+// during job's destruction.
+struct ComputeBoundsJob {
+  // Default constructor, initializes default values.
+  ComputeBoundsJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if output pointer is NULL.
+  // -if both or none of models and clip_bound are set.
+  // -if models or radii ranges are invalid, or if radii range is smaller than
+  // models range.
+  bool Validate() const;
+
+  // Runs job's bounds computation task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Model-space matrices of the joints. The output box is invalid if the
+  // range is empty.
+  Range<const math::Float4x4> models;
+
+  // Optional radius of every joint, which inflates the box around joint
+  // positions. It must contain at least as many radii as models.
+  Range<const float> radii;
+
+  // Precomputed bounding box of the sampled clip, used instead of models.
+  // Default is NULL.
+  const math::Box* clip_bound;
+
+  // Optional transform of the output box, NULL by default. It's expected to
+  // be a rigid transformation when radii are used, as radii aren't scaled.
+  // The box of a transformed clip_bound is the one of its 8 transformed
+  // corners.
+  const math::Float4x4* transform;
+
+  // Job output.
+
+  // Output bounding box.
+  math::Box* bound;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_COMPUTE_BOUNDS_JOB_H_
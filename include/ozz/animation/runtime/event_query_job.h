@@ -0,0 +1,130 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_EVENT_QUERY_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_EVENT_QUERY_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/animation/runtime/event_track.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the cache object used by the EventQueryJob.
+class EventQueryCache;
+
+// Queries the events of an EventTrack that are fired while playing from time
+// "from" to time "to". Fired events are output as ranges of the track events,
+// sorted by time, so nothing is copied:
+// - Playing forward (from < to), events in range [from,to[ are fired. Events
+// at the end of the track are also fired if "to" is the end of the track.
+// - Playing over the end of a looping track (see loop), events in range
+// [from,duration] are output to "events", followed by events in range [0,to[
+// output to "looped_events".
+// - Playing backward, events in range ]to,from] are fired. Events at the
+// beginning of the track are also fired if "to" is the beginning of the track.
+// No event is fired if "from" and "to" are equal.
+// Finding the first fired event is a binary search, which is spared if a cache
+// is provided and "from" is the "to" of the previous query, ie: when queries
+// follow the playback. Query is then only O(number of fired events). The cache
+// also knows the events that were already fired, so events at the end of the
+// track aren't fired again when looping from the end.
+// The job does not owned any buffer (in/output) and will thus not delete them
+// during job's destruction.
+struct EventQueryJob {
+  // Default constructor, initializes default values.
+  EventQueryJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if track or any output pointer is NULL.
+  bool Validate() const;
+
+  // Runs job's query task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The event track to query.
+  const EventTrack* track;
+
+  // Optional cache, that stores the cursor of the previous query. NULL by
+  // default.
+  EventQueryCache* cache;
+
+  // Times of the query, clamped in range [0,duration].
+  float from;
+  float to;
+
+  // If true and "to" is lower than "from", the track is considered looping
+  // over the end. Otherwise, the track is played backward.
+  // Default is false.
+  bool loop;
+
+  // Job output.
+
+  // Fired events.
+  Range<const EventTrack::Event>* events;
+
+  // Events fired after looping over the end of the track, from its beginning.
+  // This range is empty if the query doesn't loop.
+  Range<const EventTrack::Event>* looped_events;
+};
+
+// Declares the cache object used by the EventQueryJob to take advantage of
+// the frame coherency of event queries. It stores the index of the first
+// event after the "to" time of the previous query.
+class EventQueryCache {
+ public:
+  // Constructs an invalid cache.
+  EventQueryCache();
+
+  // Invalidates the cache.
+  // The EventQueryJob automatically invalidates a cache when the queried
+  // track changes. A cache must still be invalidated manually if a track is
+  // reloaded in place, or if a track address is reused by another track.
+  void Invalidate();
+
+ private:
+  friend struct EventQueryJob;
+
+  // The track this cache refers to. NULL means that the cache is invalid.
+  const EventTrack* track_;
+
+  // The "to" time of the previous query.
+  float time_;
+
+  // The index of the first event that wasn't fired by the previous query,
+  // when playing forward from time_.
+  int cursor_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_EVENT_QUERY_JOB_H_
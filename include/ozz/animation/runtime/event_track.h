@@ -0,0 +1,119 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_EVENT_TRACK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_EVENT_TRACK_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; }
+namespace animation {
+
+// Forward declares the EventTrackBuilder, used to instantiate an EventTrack.
+namespace offline { class EventTrackBuilder; }
+
+// Defines a runtime track of animation events (footsteps, notifies...),
+// sorted by time. Events fired while playing an animation are queried with the
+// EventQueryJob. The track is usually serialized alongside the Animation it
+// belongs to.
+// This structure is usually filled by the EventTrackBuilder and
+// deserialized/loaded at runtime.
+class EventTrack {
+ public:
+
+  // Builds an empty event track.
+  EventTrack();
+
+  // Declares the public non-virtual destructor.
+  ~EventTrack();
+
+  // Defines a runtime event.
+  struct Event {
+    // Event time, in seconds.
+    float time;
+
+    // User defined event id.
+    uint32_t id;
+  };
+
+  // Gets the track duration, which matches the animation one.
+  float duration() const {
+    return duration_;
+  }
+
+  // Returns the number of events.
+  int num_events() const {
+    return num_events_;
+  }
+
+  // Returns track events, sorted by time.
+  Range<const Event> events() const {
+    return Range<const Event>(events_, num_events_);
+  }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  EventTrack(EventTrack const&);
+  void operator=(EventTrack const&);
+
+  // EventTrackBuilder class is allowed to instantiate an event track.
+  friend class offline::EventTrackBuilder;
+
+  // Allocates events buffer for _num_events events.
+  void Allocate(int _num_events);
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Track events.
+  Event* events_;
+
+  // The number of events.
+  int num_events_;
+
+  // Duration of the track.
+  float duration_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::EventTrack)
+OZZ_IO_TYPE_TAG("ozz-event_track", animation::EventTrack)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_EVENT_TRACK_H_
@@ -0,0 +1,127 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_FLOAT_TRACK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_FLOAT_TRACK_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; }
+namespace animation {
+
+// Forward declares the FloatTrackBuilder, used to instantiate a FloatTrack.
+namespace offline { class FloatTrackBuilder; }
+
+// Forward declaration of key frame's type.
+struct FloatKey;
+
+// Defines a runtime set of float curves, like gameplay curves stored next to
+// an animation clip. Curves aren't bound to joints, and are sampled by the
+// FloatTrackSamplingJob, 4 curves at once.
+// Like Animation translation, rotation and scale tracks, all the keys of all
+// the curves are stored in a single array, sorted in the order they are
+// needed while sampling forward: the first 2 keys of every curve, followed by
+// the next keys sorted by the time of the previous key of their curve. Key
+// times are stored on 16 bits, as a ratio of the track duration.
+// The number of curves is aligned to a multiple of 4, padding curves being
+// null.
+// This structure is usually filled by the FloatTrackBuilder and
+// deserialized/loaded at runtime.
+class FloatTrack {
+ public:
+
+  // Builds a default float track.
+  FloatTrack();
+
+  // Declares the public non-virtual destructor.
+  ~FloatTrack();
+
+  // Gets the track duration.
+  float duration() const {
+    return duration_;
+  }
+
+  // Gets the number of curves of the track, as built from the raw track.
+  int num_curves() const {
+    return num_curves_;
+  }
+
+  // Gets the number of soa curves, ie: curves aligned to a multiple of 4.
+  int num_soa_curves() const {
+    return (num_curves_ + 3) / 4;
+  }
+
+  // Gets the buffer of keys.
+  ozz::Range<const FloatKey> keys() const {
+    return keys_;
+  }
+
+  // Gets the buffer size of all the track data.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  FloatTrack(FloatTrack const&);
+  void operator=(FloatTrack const&);
+
+  // FloatTrackBuilder class is allowed to instantiate a float track.
+  friend class offline::FloatTrackBuilder;
+
+  // Allocates keys buffer for _num_keys keys.
+  void Allocate(int _num_keys);
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Stores all keys, sorted for forward sampling.
+  ozz::Range<FloatKey> keys_;
+
+  // The number of curves, before soa alignment.
+  int num_curves_;
+
+  // Duration of the track.
+  float duration_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::FloatTrack)
+OZZ_IO_TYPE_TAG("ozz-float_track", animation::FloatTrack)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_FLOAT_TRACK_H_
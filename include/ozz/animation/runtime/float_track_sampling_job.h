@@ -0,0 +1,153 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_FLOAT_TRACK_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_FLOAT_TRACK_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the float track type.
+class FloatTrack;
+
+// Forward declares the cache object used by the FloatTrackSamplingJob.
+class FloatTrackSamplingCache;
+
+// Samples all the curves of a float track at a given time.
+// Like the SamplingJob, it uses a cache (aka FloatTrackSamplingCache) that
+// stores the left and right keys of every curve, along with their decoded soa
+// values. Keys are fetched incrementally while sampling forward, and only the
+// soa curves (4 curves) whose keys changed are decoded again, before all
+// curves are interpolated 4 at a time. Sampling backward rewinds the cache to
+// the first keys.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct FloatTrackSamplingJob {
+  // Default constructor, initializes default values.
+  FloatTrackSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL.
+  // -if output range is smaller than the number of curves of the track.
+  // -if cache is too small.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time used to sample the track, clamped in range [0,duration] before
+  // job execution.
+  float time;
+
+  // The float track to sample.
+  const FloatTrack* track;
+
+  // A cache object that must be big enough to sample *this track.
+  FloatTrackSamplingCache* cache;
+
+  // Job output.
+  // The output range to be filled with the sampled value of every curve. It
+  // must be at least as big as the number of curves, next values are left
+  // unchanged.
+  Range<float> output;
+};
+
+namespace internal {
+  // Soa hot data to interpolate.
+  struct InterpSoaFloat;
+}  // internal
+
+// Declares the cache object used by the FloatTrackSamplingJob to take
+// advantage of the frame coherency of curves sampling.
+class FloatTrackSamplingCache {
+ public:
+  // Constructs a cache that can be used to sample any float track with at most
+  // _max_curves curves. _max_curves is internally aligned to a multiple of
+  // soa size.
+  // All cache buffers are carved out of a single allocation.
+  explicit FloatTrackSamplingCache(int _max_curves);
+
+  // Deallocates cache.
+  ~FloatTrackSamplingCache();
+
+  // Invalidates the cache.
+  // The FloatTrackSamplingJob automatically invalidates a cache when the
+  // sampled track changes. A cache must still be invalidated manually if a
+  // track is reloaded in place, or if a track address is reused by another
+  // track.
+  void Invalidate();
+
+  // The maximum number of curves that the cache can handle.
+  int max_curves() const {
+    return max_soa_curves_ * 4;
+  }
+
+ private:
+  // Disables copy and assignation.
+  FloatTrackSamplingCache(FloatTrackSamplingCache const&);
+  void operator=(FloatTrackSamplingCache const&);
+
+  friend struct FloatTrackSamplingJob;
+
+  // Steps the cache in order to use it for a potentially new track and time.
+  // The cache is rewound if the track has changed or if _key_time is lower
+  // than the previous sampling time.
+  void Step(const FloatTrack& _track, float _key_time);
+
+  // The track this cache refers to. NULL means that the cache is invalid.
+  const FloatTrack* track_;
+
+  // The current key time of the cache.
+  float time_;
+
+  // The number of soa curves that can be stored.
+  int max_soa_curves_;
+
+  // Soa hot data to interpolate.
+  internal::InterpSoaFloat* soa_floats_;
+
+  // Points to the keys in the track that are valid for the current time, two
+  // per curve: the left and right keys.
+  int* keys_;
+
+  // Current cursor in the track keys.
+  int cursor_;
+
+  // Outdated soa entries. One bit per soa entry (32 curves per byte).
+  unsigned char* outdated_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_FLOAT_TRACK_SAMPLING_JOB_H_
@@ -0,0 +1,166 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/soa_float.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Inertialization allows to transition from a source to a target animation
+// without blending them: the offset between the source and the target poses
+// (and its velocity) is recorded once at transition time, and then decayed to
+// zero on top of the target pose. Transitions thus only require to sample the
+// target animation, instead of sampling and blending both animations for the
+// whole transition duration.
+// InertializationSetupJob computes the offsets at transition time, and
+// InertializationJob applies them every frame during the transition.
+// Offsets are decayed with a quintic polynomial that matches offset value and
+// velocity at transition time, and reaches zero with zero velocity and
+// acceleration at the end of the transition. Each component is decayed
+// independently, which allows to evaluate 4 joints at once with simd
+// instructions. The duration of a component is shortened when its velocity
+// would make it overshoot zero.
+
+// Soa offsets of 4 joints, as computed by InertializationSetupJob.
+// Content is opaque, it should only be written by InertializationSetupJob.
+struct SoaInertializationOffset {
+  // Per component decay of a SoaFloat3 offset.
+  struct Decay {
+    // Offset value at transition time.
+    math::SoaFloat3 value;
+    // Offset velocity at transition time, multiplied by decay duration.
+    math::SoaFloat3 velocity;
+    // Inverse of the decay duration.
+    math::SoaFloat3 inv_duration;
+  };
+
+  // Translation offset.
+  Decay translation;
+
+  // Rotation offset, as the vector part of the quaternion that rotates the
+  // target rotation to the source one.
+  Decay rotation;
+
+  // Scale offset.
+  Decay scale;
+};
+
+// Computes the inertialization offsets from the source pose to the target
+// pose, at transition time. Source velocity is computed from the two last
+// source poses, which are usually the last two poses outputted for the
+// character, so the source animation doesn't need to be sampled again. The
+// number of joints processed is defined by the size of the current buffer.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct InertializationSetupJob {
+  // Default constructor, initializes default values.
+  InertializationSetupJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any range is invalid.
+  // -if any buffer is smaller than the current buffer.
+  // -if delta time or duration is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's setup task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time elapsed between previous and current source poses.
+  // Must be greater than 0.f.
+  float delta_time;
+
+  // Transition duration, after which offsets are completely decayed.
+  // Must be greater than 0.f. Default value is .2f.
+  float duration;
+
+  // The source pose delta_time before current one.
+  Range<const ozz::math::SoaTransform> previous;
+
+  // The source pose at transition time. The size of this buffer defines the
+  // number of soa joints to process.
+  Range<const ozz::math::SoaTransform> current;
+
+  // The target pose at transition time.
+  Range<const ozz::math::SoaTransform> target;
+
+  // Job output.
+  // The range of offsets to be filled during job execution.
+  Range<SoaInertializationOffset> output;
+};
+
+// Applies inertialization offsets, computed by InertializationSetupJob, to a
+// target animation pose. The number of joints processed is defined by the
+// size of the offsets buffer.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct InertializationJob {
+  // Default constructor, initializes default values.
+  InertializationJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any range is invalid.
+  // -if input or output buffers are smaller than the offsets buffer.
+  bool Validate() const;
+
+  // Runs job's inertialization task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time elapsed since transition. Offsets are completely decayed once time
+  // reaches setup job duration, then output is equal to input. Negative
+  // values are considered as 0.
+  float time;
+
+  // The offsets computed at transition time.
+  Range<const SoaInertializationOffset> offsets;
+
+  // The target pose, sampled at the current time.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Job output.
+  // The range of output transforms, which can be the same as input.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
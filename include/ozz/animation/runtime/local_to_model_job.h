@@ -38,6 +38,11 @@ namespace ozz {
 // Forward declaration math structures.
 namespace math { struct SoaTransform; }
 namespace math { struct Float4x4; }
+namespace math { struct Float4x3; }
+namespace math { struct SoaFloat4x4; }
+
+// Forward declares the allocator used for temporary buffers.
+namespace memory { class Allocator; }
 
 namespace animation {
 
@@ -52,19 +57,32 @@ class Skeleton;
 // skeleton's joints. Job output is an array of matrices (in model-space),
 // ordered like skeleton's joints. Output are matrices, because the combination
 // of affine transformations can contain shearing or complex transformation
-// that cannot be represented as Transform object.
+// that cannot be represented as Transform object. Output can either be
+// Float4x4 matrices, or compact Float4x3 affine matrices which are suited for
+// uploading to skinning shaders constant buffers.
+// The job can also update a part of the hierarchy only, when a subset of the
+// local transforms changed (after an IK pass for example). See from, to and
+// dirty members. Matrices that aren't updated are left unchanged in the output
+// buffer, and are used as parents for the updated ones.
+// The job can finally process a skeleton level of details only, see
+// num_joints_lod member.
 struct LocalToModelJob {
   // Default constructor, initializes default values.
-  LocalToModelJob() :
-    skeleton(NULL) {
-  }
+  LocalToModelJob();
 
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer, including ranges, is NULL.
+  // -if none or both of output and output_4x3 are specified.
   // -if the size of the input is smaller than the skeleton's number of joints.
   // Note that this input has a SoA format.
-  // -if the size of of the output is smaller than the skeleton's number of
-  // joints.
+  // -if the size of of the specified output is smaller than the skeleton's
+  // number of joints.
+  // -if from is neither kNoParentIndex nor a valid joint index.
+  // -if num_joints_lod is negative.
+  // -if the dirty range is specified but is smaller than the number of words
+  // required to store one bit per skeleton joint.
+  // -if the changed range is specified but is smaller than the number of bytes
+  // required to store one bit per soa joint.
   bool Validate() const;
 
   // Runs job's local-to-model task.
@@ -77,13 +95,204 @@ struct LocalToModelJob {
   // model space conversion.
   const Skeleton* skeleton;
 
+  // The root joint of the hierarchy to update. The joint and all its
+  // descendants are updated, using the existing output matrix of from's parent.
+  // Default value is Skeleton::kNoParentIndex, which updates the whole
+  // hierarchy.
+  int from;
+
+  // The last joint index (included) to update. Joints with a higher index are
+  // left unchanged, as well as their descendants. Because joints are ordered
+  // such that parents are before their children, this allows to stop the
+  // update early.
+  // Default value is Skeleton::kMaxJoints, which processes all joints.
+  int to;
+
+  // The number of joints of the skeleton level of details to process, see
+  // Skeleton::num_joints_lod(). Joints with a higher index are left unchanged,
+  // which allows far characters to skip their less important joints. Buffers
+  // must still be big enough for the whole skeleton.
+  // Default value is Skeleton::kMaxJoints, which processes all joints.
+  int num_joints_lod;
+
+  // Optional bitset of joints whose local transform changed, one bit per joint,
+  // joint i being bit (i & 31) of word i / 32.
+  // If specified, only dirty joints and their descendants are updated (still in
+  // range [from,to]). A non dirty joint whose parent was updated is updated
+  // also.
+  // If both pointers are NULL (default case) all the joints are considered as
+  // dirty.
+  Range<const uint32_t> dirty;
+
+  // Optional bitset of soa joints whose local transforms changed, one bit per
+  // soa joint, soa joint i being bit (i & 7) of byte i / 8. This is the layout
+  // of SamplingJob::changed output, which can thus be forwarded as is when the
+  // sampled transforms are the job input. The 4 joints of a changed soa joint
+  // are considered as dirty, and are updated along with their descendants. The
+  // other ones keep the output matrices of the previous run, so the output
+  // range must be kept by the caller from a run to the next.
+  // changed can be combined with dirty, a joint being dirty if it's set in any
+  // of the two. If both pointers are NULL (default case) changed isn't used.
+  Range<const unsigned char> changed;
+
+  // Set to false when every input scale is known to be a unit scale, like
+  // when the skeleton and all the sampled animations are unscaled (see
+  // Skeleton::scaled() and Animation::scaled()). Scale channel is then ignored,
+  // which saves the scale multiplications of each local matrix.
+  // Default value is true.
+  bool scaled;
+
   // Job input.
   // The input range that store local transforms.
   Range<const ozz::math::SoaTransform> input;
 
   // Job output.
   // The output range to be filled with model matrices.
+  // Only one of output and output_4x3 must be specified.
+  Range<ozz::math::Float4x4> output;
+
+  // Job output, as compact affine matrices.
+  // The output range to be filled with 4x3 model matrices. The implicit last
+  // row of a Float4x3 is (0, 0, 0, 1), which saves 25% of the memory and
+  // bandwidth of output matrices.
+  // Only one of output and output_4x3 must be specified.
+  Range<ozz::math::Float4x3> output_4x3;
+
+  // Statistics of local-to-model jobs, see stats member.
+  struct Stats {
+    // Initializes all counters to 0.
+    Stats();
+
+    // Number of model matrices computed.
+    int joints;
+
+    // Number of soa transforms converted to matrices.
+    int soa_conversions;
+
+    // Number of runs that processed a partial update (from, to, dirty or
+    // changed).
+    int partial_runs;
+  };
+
+  // Optional statistics, accumulated by every run of the job. Counters are
+  // only updated if ozz is built with stats enabled (OZZ_HAS_STATS, see
+  // ozz_build_stats CMake option).
+  // Default is NULL.
+  Stats* stats;
+
+  // Optional allocator of the per-joint states of partial updates, which are
+  // sized to the [from,to] range of updated joints. Whole hierarchy updates
+  // don't allocate anything. It's meant to be a per-thread frame arena (see
+  // memory::ArenaAllocator), so it's used without any heap traffic nor lock.
+  // Default is NULL, which uses the default allocator.
+  memory::Allocator* scratch_allocator;
+};
+
+// Computes model-space joint matrices of a batch of characters that share the
+// same skeleton, like a LocalToModelJob per character would do.
+// Instead of walking the hierarchy of each character serially, the job
+// transposes the local transforms of 4 characters so that each simd lane
+// processes a different character. The hierarchy is thus walked once per group
+// of 4 characters, using soa matrices, and model matrices are finally
+// transposed back to every character output.
+// Intermediate soa model matrices are stored in the scratch buffer provided by
+// the user, which can be reused from a run to the next.
+// The job does not owned the buffers (items, scratch) and will thus not delete
+// them during job's destruction.
+struct BatchLocalToModelJob {
+  // Default constructor, initializes default values.
+  BatchLocalToModelJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if the skeleton pointer is NULL.
+  // -if items range is invalid.
+  // -if any item input is smaller than the skeleton's number of soa joints, or
+  // any item output is smaller than the skeleton's number of joints.
+  // -if scratch buffer is smaller than the skeleton's number of joints.
+  bool Validate() const;
+
+  // Runs job's batch local-to-model task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy shared by all items.
+  const Skeleton* skeleton;
+
+  // Defines a batch item, which has the same meaning as LocalToModelJob input
+  // and output members.
+  struct Item {
+    // The input range that store local transforms of this item.
+    Range<const ozz::math::SoaTransform> input;
+
+    // The output range to be filled with model matrices of this item.
+    Range<ozz::math::Float4x4> output;
+  };
+
+  // Job input items.
+  Range<const Item> items;
+
+  // Scratch buffer used to store intermediate soa model matrices. Must be at
+  // least as big as the skeleton's number of joints.
+  Range<ozz::math::SoaFloat4x4> scratch;
+};
+
+// Computes model-space matrices of a sparse set of joints only, like the few
+// hit-box joints needed by a game server. The job evaluates the joints of a
+// precomputed evaluation list, which must contain the requested joints and all
+// their ancestors, sorted by increasing index. See BuildJointEvaluationList()
+// from skeleton_utils.h, which also outputs the soa mask to use with a
+// SamplingJob so that only evaluated joints are sampled.
+// Matrices of joints that aren't listed are left unchanged in the output
+// buffer.
+struct SparseLocalToModelJob {
+  // Default constructor, initializes default values.
+  SparseLocalToModelJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL.
+  // -if none or both of output and output_4x3 are specified.
+  // -if the size of the input is smaller than the skeleton's number of soa
+  // joints, or the size of the output is smaller than the skeleton's number of
+  // joints.
+  // -if joints range is invalid, or isn't sorted by strictly increasing joint
+  // indices, or contains an invalid joint index.
+  bool Validate() const;
+
+  // Runs job's sparse local-to-model task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy used for local to
+  // model space conversion.
+  const Skeleton* skeleton;
+
+  // The evaluation list, sorted indices of the joints to evaluate. The parent
+  // of every listed joint must be listed as well, otherwise its existing
+  // output matrix is used.
+  Range<const uint16_t> joints;
+
+  // Set to false when every input scale is known to be a unit scale, see
+  // LocalToModelJob::scaled.
+  // Default value is true.
+  bool scaled;
+
+  // Job input.
+  // The input range that store local transforms. Only the soa transforms of
+  // listed joints are read.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Job output.
+  // The output range to be filled with model matrices.
+  // Only one of output and output_4x3 must be specified.
   Range<ozz::math::Float4x4> output;
+
+  // Job output, as compact affine matrices, see LocalToModelJob::output_4x3.
+  // Only one of output and output_4x3 must be specified.
+  Range<ozz::math::Float4x3> output_4x3;
 };
 }  // animation
 }  // ozz
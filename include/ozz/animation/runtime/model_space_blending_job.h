@@ -0,0 +1,144 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_BLENDING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_BLENDING_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares the Skeleton object used to describe joint hierarchy.
+class Skeleton;
+
+// Blends local-space layers in model-space, and outputs the local-space
+// result. Unlike BlendingJob, which interpolates local transforms, each joint
+// is blended at its model-space position and orientation, which keeps end
+// effectors (like feet) spatially coherent when the layers' hierarchies
+// differ.
+// The conversion to model-space, the blending and the conversion back to
+// local-space are fused in a single walk of the hierarchy: the model-space
+// transform of every layer joint is computed from its parent's one, blended
+// with the other layers, and finally expressed relatively to the blended
+// parent. Rotations are normalized lerps of model-space rotations, and
+// translations are linearly interpolated in model-space. Scales are
+// interpolated in local-space, and accumulated like LocalToModelJob does for
+// uniform scales, non-uniform ones being approximated.
+// The skeleton bind pose is blended, relatively to the blended parent, when
+// the accumulated weight of a joint is below the threshold, like BlendingJob.
+// Model-space transforms of the layers are stored in the scratch buffer
+// provided by the user, which can be reused from a run to the next.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct ModelSpaceBlendingJob {
+  // Default constructor, initializes default values.
+  ModelSpaceBlendingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if the skeleton pointer is NULL.
+  // -if layer range is not valid.
+  // -if any layer transform or joint weights range is smaller than the
+  // skeleton's number of soa joints.
+  // -if output is smaller than the skeleton's number of soa joints.
+  // -if models is specified and is smaller than the skeleton's number of
+  // joints.
+  // -if scratch is smaller than scratch_size().
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's model-space blending task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Returns the number of SimdFloat4 the scratch buffer must contain for
+  // _num_layers layers and a skeleton of _num_joints joints.
+  static size_t scratch_size(int _num_layers, int _num_joints);
+
+  // Defines a layer of blending input data (local space transforms) and
+  // parameters (weights), with the same meaning as BlendingJob::Layer.
+  struct Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // Blending weight of this layer. Negative values are considered as 0.
+    float weight;
+
+    // The range [begin,end[ of input layer local-space posture. This range
+    // must be at least as big as the skeleton's number of soa joints.
+    Range<const math::SoaTransform> transform;
+
+    // Optional range [begin,end[ of blending weight for each joint in this
+    // layer, considered as 1.f if both pointers are NULL (default case).
+    // Otherwise it must be at least as big as the skeleton's number of soa
+    // joints.
+    Range<const math::SimdFloat4> joint_weights;
+  };
+
+  // The Skeleton object describing the joint hierarchy of all layers. Its bind
+  // pose is used as a fallback when layers' weight is below the threshold.
+  const Skeleton* skeleton;
+
+  // The job blends the bind pose to the output when the accumulated weight of
+  // all layers is less than this threshold value.
+  // Must be greater than 0.f.
+  float threshold;
+
+  // Job input layers.
+  // The range of layers that must be blended.
+  Range<const Layer> layers;
+
+  // Scratch buffer used to store layers and blended model-space transforms.
+  // Must be at least as big as scratch_size().
+  Range<math::SimdFloat4> scratch;
+
+  // Job output.
+  // The range of local-space output transforms, which must be at least as big
+  // as the skeleton's number of soa joints.
+  Range<math::SoaTransform> output;
+
+  // Optional job output.
+  // Blended model-space matrices, which are the matrices LocalToModelJob
+  // would compute from output, saving this pass. If both pointers are NULL
+  // (default case), they aren't output. Otherwise the range must be at least
+  // as big as the skeleton's number of joints.
+  Range<math::Float4x4> models;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_BLENDING_JOB_H_
@@ -0,0 +1,130 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_CLIP_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_CLIP_H_
+
+#include <cstddef>
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; }
+namespace math { struct Float4x3; }
+namespace animation {
+
+// Forward declares the ModelSpaceClipBuilder, used to instantiate a clip.
+namespace offline { class ModelSpaceClipBuilder; }
+
+// Defines a clip whose model-space joint matrices are pre-baked at a fixed
+// rate, which suits rigid props and simple rigs (doors, vehicles, weapons...)
+// that replay fixed clips. Sampling a frame is a linear interpolation of two
+// baked frames (see ModelSpaceClipSamplingJob), so it neither decodes keys,
+// nor maintains a sampling cache, nor walks the hierarchy.
+// Frames are evenly spaced, the first one at time 0 and the last one at the
+// end of the clip. Each frame stores a compact Float4x3 matrix per joint.
+// This structure is usually filled by the ModelSpaceClipBuilder and
+// deserialized/loaded at runtime.
+class ModelSpaceClip {
+ public:
+
+  // Builds an empty clip.
+  ModelSpaceClip();
+
+  // Declares the public non-virtual destructor.
+  ~ModelSpaceClip();
+
+  // Gets the clip duration, which matches the source animation one.
+  float duration() const {
+    return duration_;
+  }
+
+  // Gets the number of frames per second.
+  float frame_rate() const {
+    return frame_rate_;
+  }
+
+  // Gets the number of joints of each frame.
+  int num_joints() const {
+    return num_joints_;
+  }
+
+  // Gets the number of frames.
+  int num_frames() const {
+    return num_frames_;
+  }
+
+  // Returns model-space matrices of frame _frame, which must be in range
+  // [0,num_frames[.
+  Range<const math::Float4x3> frame(int _frame) const;
+
+  // Get the estimated clip's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  ModelSpaceClip(ModelSpaceClip const&);
+  void operator=(ModelSpaceClip const&);
+
+  // ModelSpaceClipBuilder class is allowed to instantiate a clip.
+  friend class offline::ModelSpaceClipBuilder;
+
+  // Allocates matrices buffer for _num_frames frames of _num_joints joints.
+  void Allocate(int _num_joints, int _num_frames);
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Model-space matrices, frame by frame.
+  math::Float4x3* matrices_;
+
+  // The number of joints and frames.
+  int num_joints_;
+  int num_frames_;
+
+  // Number of frames per second, and duration of the clip.
+  float frame_rate_;
+  float duration_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::ModelSpaceClip)
+OZZ_IO_TYPE_TAG("ozz-model_space_clip", animation::ModelSpaceClip)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_CLIP_H_
@@ -0,0 +1,89 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_CLIP_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_CLIP_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct Float4x4; }
+namespace math { struct Float4x3; }
+
+namespace animation {
+
+// Forward declares the clip type to sample.
+class ModelSpaceClip;
+
+// Samples a ModelSpaceClip at a given time, to output model-space joint
+// matrices, like a SamplingJob followed by a LocalToModelJob would do.
+// Matrices of the two frames surrounding sampling time are linearly
+// interpolated, which is accurate enough as long as the clip was baked at a
+// rate matching its motion speed. The job is stateless, so it doesn't need any
+// cache and seeking is free.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct ModelSpaceClipSamplingJob {
+  // Default constructor, initializes default values.
+  ModelSpaceClipSamplingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if clip pointer is NULL, or if the clip has no frame.
+  // -if none or both of output and output_4x3 are specified, or if the
+  // specified output is smaller than the clip's number of joints.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time used to sample the clip, clamped in range [0,duration].
+  float time;
+
+  // The clip to sample.
+  const ModelSpaceClip* clip;
+
+  // Job output.
+  // The output range to be filled with model matrices.
+  // Only one of output and output_4x3 must be specified.
+  Range<ozz::math::Float4x4> output;
+
+  // Job output, as compact affine matrices, see LocalToModelJob::output_4x3.
+  // Only one of output and output_4x3 must be specified.
+  Range<ozz::math::Float4x3> output_4x3;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_CLIP_SAMPLING_JOB_H_
@@ -0,0 +1,104 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MODEL_TO_LOCAL_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MODEL_TO_LOCAL_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math { struct SoaTransform; }
+namespace math { struct Float4x4; }
+
+namespace animation {
+
+// Forward declares the Skeleton object used to describe joint hierarchy.
+class Skeleton;
+
+// Computes local-space SoaTransform from model-space joint matrices. This is
+// the inverse of the LocalToModelJob, typically used to get back local
+// transforms after an IK or physics (ragdoll) pass modified model-space
+// matrices, so that they can be blended with animations again.
+// Each local transform is decomposed from the matrix multiplication of the
+// inverse model-space matrix of the joint's parent, with the model-space
+// matrix of the joint. Skeleton's root joints model-space matrices are
+// directly decomposed.
+// Job inputs is an array of matrices (in model-space), ordered like skeleton's
+// joints. Job output is an array of SoaTransform objects (in local-space),
+// ordered like skeleton's joints.
+// The job can also update a range of joints only, see from and to members.
+// Joints out of this range are left unchanged in the output buffer. Padding
+// soa lanes of the last output element are set to identity when the last
+// joint is updated.
+// Model-space matrices that can't be decomposed (more than 1 axis scaled to
+// 0) output an identity rotation and a null scale.
+struct ModelToLocalJob {
+  // Default constructor, initializes default values.
+  ModelToLocalJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer, including ranges, is NULL.
+  // -if the size of the input is smaller than the skeleton's number of joints.
+  // -if the size of of the output is smaller than the skeleton's number of
+  // soa joints.
+  // -if from isn't a valid joint index, or to is lower than from.
+  bool Validate() const;
+
+  // Runs job's model-to-local task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy used for model to
+  // local space conversion.
+  const Skeleton* skeleton;
+
+  // The first joint index to update.
+  // Default value is 0, which is the first joint.
+  int from;
+
+  // The last joint index (included) to update.
+  // Default value is Skeleton::kMaxJoints, which processes all joints.
+  int to;
+
+  // Job input.
+  // The input range that store model matrices.
+  Range<const ozz::math::Float4x4> input;
+
+  // Job output.
+  // The output range to be filled with local transforms.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MODEL_TO_LOCAL_JOB_H_
@@ -0,0 +1,105 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MODEL_VELOCITY_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MODEL_VELOCITY_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math { struct Float4x4; }
+
+namespace animation {
+
+// Forward declares the Skeleton object used to describe joint hierarchy.
+class Skeleton;
+
+// Forward declares local-space velocities, output by SamplingJob.
+struct SoaJointVelocity;
+
+// Converts local-space joint velocities, as output by SamplingJob, to
+// model-space linear and angular velocities. This is the velocity counterpart
+// of the LocalToModelJob, whose output model-space matrices are an input of
+// this job.
+// Each joint angular velocity is the sum of its parent angular velocity and of
+// its local angular velocity, rotated to model-space by its parent rotation.
+// Its linear velocity is the velocity of its parent origin, plus the velocity
+// due to parent rotation (parent angular velocity cross the parent to joint
+// vector), plus its local translation velocity transformed to model-space.
+// Parent rotations are extracted from model-space matrices by normalizing
+// their axes. Velocities are exact for uniformly scaled joints. Scale
+// velocities aren't propagated, scales are assumed constant.
+// Skeleton's root joints velocities are local-space velocities.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct ModelVelocityJob {
+  // Default constructor, initializes default values.
+  ModelVelocityJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer, including ranges, is NULL.
+  // -if velocities is smaller than the skeleton's number of soa joints.
+  // -if models, linear or angular ranges are smaller than the skeleton's
+  // number of joints.
+  bool Validate() const;
+
+  // Runs job's local to model velocity task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy.
+  const Skeleton* skeleton;
+
+  // Job input.
+  // Local-space velocities, as output by SamplingJob.
+  Range<const SoaJointVelocity> velocities;
+
+  // Job input.
+  // Model-space matrices of the pose, as output by LocalToModelJob.
+  Range<const math::Float4x4> models;
+
+  // Job output.
+  // Model-space linear velocities of joints' origin, in units per second. The
+  // w component is undefined.
+  Range<math::SimdFloat4> linear;
+
+  // Job output.
+  // Model-space angular velocities of joints, as a rotation axis scaled by the
+  // rotation speed in radians per second. The w component is undefined.
+  Range<math::SimdFloat4> angular;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MODEL_VELOCITY_JOB_H_
@@ -0,0 +1,203 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DATABASE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DATABASE_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; }
+namespace animation {
+
+// Forward declares the MotionDatabaseBuilder, used to instantiate a database.
+namespace offline { class MotionDatabaseBuilder; }
+
+// Forward declares the job that searches the database.
+struct MotionSearchJob;
+
+// Defines a motion matching database: the pose features of every frame of a
+// set of animations, sampled at a fixed rate. The best matching frame for a
+// query is found with the MotionSearchJob.
+// Features of a frame are expressed in the reference frame of the root joint
+// at that time, and are laid out as follows:
+// - the model-space position (x, y, z) of every feature joint.
+// - the velocity (x, y, z) of every feature joint, in units per second.
+// - the position (x, y, z) of the root joint at every trajectory time offset.
+// Every feature is normalized, using its mean and standard deviation over the
+// whole database, so that features of different nature weight the same.
+// Features are stored as SoA blocks of 4 frames, to be compared against a
+// query 4 frames at a time. Contiguous frames are also grouped in clusters of
+// kClusterSize frames, whose bounds are used to skip whole clusters during
+// the search.
+// This structure is usually filled by the MotionDatabaseBuilder and
+// deserialized/loaded at runtime.
+class MotionDatabase {
+ public:
+
+  // Builds an empty database.
+  MotionDatabase();
+
+  // Declares the public non-virtual destructor.
+  ~MotionDatabase();
+
+  // Maximum number of features of a frame.
+  static const int kMaxFeatures = 128;
+
+  // Number of frames of a cluster, a multiple of 4.
+  static const int kClusterSize = 32;
+
+  // Defines the animation and time of a frame.
+  struct Frame {
+    // Index of the animation, in the range of animations given to the
+    // builder.
+    int animation;
+
+    // Time in the animation, in seconds.
+    float time;
+  };
+
+  // Returns the number of frames.
+  int num_frames() const {
+    return num_frames_;
+  }
+
+  // Returns the number of features of a frame.
+  int num_features() const {
+    return num_features_;
+  }
+
+  // Returns the animation and time of every frame.
+  Range<const Frame> frames() const {
+    return Range<const Frame>(frames_, num_frames_);
+  }
+
+  // Returns the index of the root joint, which defines the reference frame of
+  // the features.
+  int root() const {
+    return root_;
+  }
+
+  // Returns the feature joints.
+  Range<const int> joints() const {
+    return Range<const int>(joints_, num_joints_);
+  }
+
+  // Returns the trajectory time offsets, in seconds.
+  Range<const float> trajectory() const {
+    return Range<const float>(trajectory_, num_trajectory_);
+  }
+
+  // Returns the mean of every feature.
+  Range<const float> means() const {
+    return Range<const float>(means_, num_features_);
+  }
+
+  // Returns the inverse of the standard deviation of every feature, used to
+  // normalize features.
+  Range<const float> scales() const {
+    return Range<const float>(scales_, num_features_);
+  }
+
+  // Gets the normalized value of feature _feature of frame _frame.
+  float feature(int _frame, int _feature) const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  MotionDatabase(MotionDatabase const&);
+  void operator=(MotionDatabase const&);
+
+  // MotionDatabaseBuilder class is allowed to instantiate a database.
+  friend class offline::MotionDatabaseBuilder;
+
+  // The search job reads features and clusters directly.
+  friend struct MotionSearchJob;
+
+  // Allocates all buffers.
+  void Allocate(int _num_frames, int _num_joints, int _num_trajectory);
+
+  // Computes cluster bounds from the features.
+  void BuildIndex();
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Returns the number of blocks of 4 frames, and the number of clusters.
+  int num_blocks() const {
+    return (num_frames_ + 3) / 4;
+  }
+  int num_clusters() const {
+    return (num_frames_ + kClusterSize - 1) / kClusterSize;
+  }
+
+  // Number of frames and features.
+  int num_frames_;
+  int num_features_;
+
+  // Animation and time of every frame.
+  Frame* frames_;
+
+  // Feature definition.
+  int root_;
+  int* joints_;
+  int num_joints_;
+  float* trajectory_;
+  int num_trajectory_;
+
+  // Normalization of every feature.
+  float* means_;
+  float* scales_;
+
+  // Normalized features, num_blocks() * num_features_ SoA blocks, such that
+  // feature f of block b is features_[b * num_features_ + f]. Lanes beyond
+  // the last frame are zero.
+  math::SimdFloat4* features_;
+
+  // Minimum and maximum normalized value of every feature in every cluster,
+  // num_clusters() * num_features_ * 2 values. Minimums of cluster c start at
+  // cluster_bounds_[c * num_features_ * 2], followed by maximums.
+  float* cluster_bounds_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::MotionDatabase)
+OZZ_IO_TYPE_TAG("ozz-motion_database", animation::MotionDatabase)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DATABASE_H_
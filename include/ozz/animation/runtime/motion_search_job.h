@@ -0,0 +1,94 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MOTION_SEARCH_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MOTION_SEARCH_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the database type.
+class MotionDatabase;
+
+// Searches a MotionDatabase for the frame whose features best match a query,
+// ie: the frame minimizing the weighted squared distance between its
+// normalized features and the normalized query.
+// The query is compared against 4 frames at a time with SIMD instructions.
+// Unless disabled, clusters of contiguous frames whose bounds can't contain a
+// better frame than the best one found so far are skipped, which doesn't
+// affect the result.
+// The job does not owned any buffer (in/output) and will thus not delete them
+// during job's destruction.
+struct MotionSearchJob {
+  // Default constructor, initializes default values.
+  MotionSearchJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if database pointer is NULL or database has no frame.
+  // -if query range is smaller than database number of features.
+  // -if weights range isn't empty and is smaller than database number of
+  // features, or if any weight is negative.
+  // -if any output pointer is NULL.
+  bool Validate() const;
+
+  // Runs job's search task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // The database to search.
+  const MotionDatabase* database;
+
+  // Features to match, laid out like database features (see MotionDatabase),
+  // but not normalized.
+  Range<const float> query;
+
+  // Optional weight of every feature. All weights are 1 if empty.
+  Range<const float> weights;
+
+  // Skips clusters that can't contain a better frame. Default is true.
+  bool use_index;
+
+  // Job output.
+
+  // Index of the best matching frame, see MotionDatabase::frames().
+  int* frame;
+
+  // Weighted squared distance between the best frame and the query.
+  float* cost;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MOTION_SEARCH_JOB_H_
@@ -0,0 +1,117 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_NUMA_REPLICAS_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_NUMA_REPLICAS_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class Skeleton;
+
+// Stores replicas of read-only animations and skeletons on every NUMA node,
+// so that workers pinned to a node (see tasks::ThreadPool) sample animations
+// and traverse skeletons from local memory, instead of paying the latency of
+// the node that loaded them.
+// Replicas are deep copies: sources are serialized once, then loaded on every
+// node with buffers allocated from memory placed on the node (see
+// memory::NumaAllocator). Sources aren't referenced once replicated, and their
+// later changes aren't reflected until Replicate is called again.
+// Replicas are immutable, so they can be accessed from any thread. Animation
+// replicas have their own generation ids, so sampling caches should be per
+// node too.
+class NumaReplicas {
+ public:
+  // Constructs an empty replica set.
+  NumaReplicas();
+
+  // Releases all replicas.
+  ~NumaReplicas();
+
+  // Replicates _animations and _skeletons on NUMA nodes [0,_num_nodes[,
+  // usually tasks::ThreadPool::num_numa_nodes(). Previous replicas are
+  // released.
+  // Animation and Skeleton buffer allocators are changed while replicating, so
+  // no animation or skeleton must be built or loaded concurrently.
+  // Returns false and leaves *this empty if _num_nodes is lower than 1, if a
+  // source is NULL, or if replicas of a node can't be allocated.
+  bool Replicate(const Range<const Animation* const>& _animations,
+                 const Range<const Skeleton* const>& _skeletons,
+                 int _num_nodes);
+
+  // Releases all replicas.
+  void Clear();
+
+  // Gets the number of nodes animations and skeletons are replicated on.
+  int num_nodes() const {
+    return num_nodes_;
+  }
+
+  // Gets the number of replicated animations.
+  int num_animations() const {
+    return num_animations_;
+  }
+
+  // Gets the number of replicated skeletons.
+  int num_skeletons() const {
+    return num_skeletons_;
+  }
+
+  // Gets the replica of animation _index on node _node, usually
+  // tasks::ThreadPool::current_numa_node() or the pool node. Node 0 replica is
+  // returned if _node is out of range. Returns NULL if _index is out of range.
+  const Animation* animation(int _index, int _node) const;
+
+  // Gets the replica of skeleton _index on node _node, see animation().
+  const Skeleton* skeleton(int _index, int _node) const;
+
+ private:
+  // Disables copy and assignation.
+  NumaReplicas(NumaReplicas const&);
+  void operator=(NumaReplicas const&);
+
+  // Declares node replicas and their allocators.
+  struct Node;
+
+  // Replicas of every node.
+  Node** nodes_;
+  int num_nodes_;
+
+  // Number of replicated animations and skeletons, per node.
+  int num_animations_;
+  int num_skeletons_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_NUMA_REPLICAS_H_
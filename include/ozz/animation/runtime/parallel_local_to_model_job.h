@@ -0,0 +1,168 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PARALLEL_LOCAL_TO_MODEL_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PARALLEL_LOCAL_TO_MODEL_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math { struct SoaTransform; }
+namespace math { struct Float4x4; }
+
+// Forward declaration of task dispatcher interface.
+namespace tasks { class Dispatcher; }
+
+namespace animation {
+
+// Forward declares the Skeleton object used to describe joint hierarchy.
+class Skeleton;
+
+// Partitions a skeleton joint hierarchy into independent sets of subtrees, that
+// can be processed concurrently by the ParallelLocalToModelJob.
+// The partition is made of a trunk, which contains the joints that are
+// ancestors of all subtrees, and of a number of partitions. Every joint of the
+// skeleton belongs to the trunk or to a single partition. Joints of a partition
+// only depend on joints of the same partition or of the trunk.
+// The partition is computed once for a skeleton, usually when the skeleton is
+// loaded, and can then be shared by all the jobs that use this skeleton.
+class LocalToModelPartition {
+ public:
+  // Builds an empty partition.
+  LocalToModelPartition();
+
+  // Deallocates partition.
+  ~LocalToModelPartition();
+
+  // Builds *this partition for _skeleton, with at most _max_partitions
+  // partitions. Subtrees are split until they are smaller than the average
+  // partition size, and then distributed to balance the number of joints of
+  // each partition.
+  // Returns false if _max_partitions is less than 1.
+  bool Build(const Skeleton& _skeleton, int _max_partitions);
+
+  // Gets the number of joints of the skeleton *this partition was built for.
+  int num_joints() const {
+    return num_joints_;
+  }
+
+  // Gets the number of partitions. This doesn't include the trunk.
+  int num_partitions() const {
+    return num_partitions_;
+  }
+
+  // Gets the range of joint indices of the trunk, sorted in skeleton order.
+  Range<const uint16_t> trunk() const {
+    return Range<const uint16_t>(joints_, joints_ + offsets_[0]);
+  }
+
+  // Gets the range of joint indices of partition _partition, sorted in skeleton
+  // order.
+  Range<const uint16_t> partition(int _partition) const {
+    assert(_partition >= 0 && _partition < num_partitions_);
+    return Range<const uint16_t>(joints_ + offsets_[_partition],
+                                 joints_ + offsets_[_partition + 1]);
+  }
+
+ private:
+
+  // Disables copy and assignation.
+  LocalToModelPartition(LocalToModelPartition const&);
+  void operator=(LocalToModelPartition const&);
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Joint indices of the trunk, followed by the joint indices of every
+  // partition.
+  uint16_t* joints_;
+
+  // Offsets in joints_ array of the end of the trunk, and then the end of every
+  // partition. The array stores num_partitions_ + 1 elements.
+  int* offsets_;
+
+  // The number of partitions.
+  int num_partitions_;
+
+  // The number of joints of the partitioned skeleton.
+  int num_joints_;
+};
+
+// Computes model-space joint matrices from local-space SoaTransform, like the
+// LocalToModelJob, but distributing the workload on multiple threads.
+// The trunk of the partition is processed first on the calling thread, then
+// every partition is processed as an independent work item of a task submitted
+// to the user provided dispatcher.
+// Outputs are the same as the LocalToModelJob ones.
+struct ParallelLocalToModelJob {
+  // Default constructor, initializes default values.
+  ParallelLocalToModelJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer, including ranges, is NULL.
+  // -if the partition wasn't built for a skeleton with the same number of
+  // joints.
+  // -if the size of the input is smaller than the skeleton's number of joints.
+  // Note that this input has a SoA format.
+  // -if the size of of the output is smaller than the skeleton's number of
+  // joints.
+  bool Validate() const;
+
+  // Runs job's local-to-model task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy used for local to
+  // model space conversion.
+  const Skeleton* skeleton;
+
+  // The partition of the skeleton, built with LocalToModelPartition::Build.
+  const LocalToModelPartition* partition;
+
+  // The dispatcher used to process partitions. Use
+  // ozz::tasks::serial_dispatcher() to process all partitions on the calling
+  // thread.
+  tasks::Dispatcher* dispatcher;
+
+  // Job input.
+  // The input range that store local transforms.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Job output.
+  // The output range to be filled with model matrices.
+  Range<ozz::math::Float4x4> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PARALLEL_LOCAL_TO_MODEL_JOB_H_
@@ -0,0 +1,114 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PHYSICS_POSE_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PHYSICS_POSE_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math { struct SoaTransform; }
+
+// Forward declares the allocator used for temporary buffers.
+namespace memory { class Allocator; }
+
+namespace animation {
+
+// Forward declares the Skeleton object used to describe joint hierarchy.
+class Skeleton;
+
+// Computes the local-space pose that matches physics rigid bodies, typically
+// to blend out of a ragdoll back to animations.
+// Bodies are mapped to a sparse set of joints, and their world-space
+// transforms are the world-space transforms of these joints (any offset
+// between a body and its joint must be applied beforehand). Joints that aren't
+// mapped to a body keep their local transform from the animation input pose,
+// so they follow their parent body.
+// Model-space matrices of the animation pose are computed 4 joints at a time
+// from soa transforms, like LocalToModelJob does. Only the local transforms of
+// mapped joints are then decomposed and written back to the output soa pose.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct PhysicsPoseJob {
+  // Default constructor, initializes default values.
+  PhysicsPoseJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer, including ranges, is NULL.
+  // -if input or output is smaller than the skeleton's number of soa joints.
+  // -if models is smaller than the skeleton's number of joints.
+  // -if bodies and body_joints have different sizes.
+  // -if a body joint index is out of range, or if a joint is mapped twice.
+  bool Validate() const;
+
+  // Runs job's physics pose matching task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy.
+  const Skeleton* skeleton;
+
+  // World-space transform of the character, as model-space matrices are
+  // computed relatively to it. Default is identity.
+  math::Float4x4 root;
+
+  // Index of the joint every body is mapped to.
+  Range<const uint16_t> body_joints;
+
+  // World-space transforms of the bodies, one per body joint.
+  Range<const math::Float4x4> bodies;
+
+  // Local-space animation pose, used for joints that aren't mapped to a body.
+  Range<const math::SoaTransform> input;
+
+  // Job output.
+  // Model-space matrices of the matched pose, one per skeleton joint.
+  Range<math::Float4x4> models;
+
+  // Job output.
+  // The matched local-space pose, which can be the same as input. Model-space
+  // matrices that can't be decomposed (more than 1 axis scaled to 0) output an
+  // identity rotation and a null scale.
+  Range<math::SoaTransform> output;
+
+  // Optional allocator of the job temporary buffers, which are sized to the
+  // skeleton. It's meant to be a per-thread frame arena (see
+  // memory::ArenaAllocator), so it's used without any heap traffic nor lock.
+  // Default is NULL, which uses the default allocator.
+  memory::Allocator* scratch_allocator;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PHYSICS_POSE_JOB_H_
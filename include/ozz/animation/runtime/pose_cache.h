@@ -0,0 +1,178 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_CACHE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_CACHE_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; struct Float4x4; }
+
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class Skeleton;
+class SamplingCache;
+
+// Shares sampled postures between the characters that play the same animation
+// at the same time, which is common for crowd agents.
+// Postures are identified by the animation generation id (see
+// Animation::id()), sampling time and optional soa tracks mask. Sampling time
+// is quantized to a configurable time step, so that characters playing at
+// close times share the same posture. A posture is sampled (and its model
+// matrices computed if enabled) the first time it's requested within a frame,
+// and then shared by next requests, so sampling cost depends on the number of
+// unique postures instead of the number of characters.
+// All postures are carved out of a single slab, allocated at construction.
+// PoseCache does not lock, so an instance must not be used by multiple threads
+// concurrently.
+class PoseCache {
+ public:
+  // Constructs a cache of at most _capacity postures of _skeleton, which
+  // must outlive the cache. Sampling times are quantized to _time_step
+  // seconds, or aren't quantized at all if _time_step is 0. Model matrices
+  // are computed with a LocalToModelJob if _models is true.
+  PoseCache(const Skeleton& _skeleton,
+            int _capacity,
+            float _time_step,
+            bool _models);
+
+  // Deallocates the slab.
+  ~PoseCache();
+
+  // Defines a cached posture.
+  struct Pose {
+    // Local-space transforms, one SoaTransform per skeleton soa joint. Joints
+    // that are masked out, or that aren't animated, are set to the skeleton
+    // bind pose.
+    Range<const math::SoaTransform> locals;
+
+    // Model-space matrices, one per skeleton joint. Empty if model matrices
+    // are disabled.
+    Range<const math::Float4x4> models;
+  };
+
+  // Gets the posture of _animation at _time, quantized to time_step(), and
+  // sampled with the optional _soa_mask (see SamplingJob::soa_mask). An empty
+  // _soa_mask means that all soa tracks are sampled, otherwise it must contain
+  // at least (skeleton num_soa_joints + 7) / 8 bytes.
+  // _pose remains valid until Clear() is called or the cache is destroyed.
+  // Returns false and leaves _pose unchanged if _animation has more tracks
+  // than the skeleton, if _soa_mask is invalid, or if the cache is full.
+  bool Get(const Animation& _animation,
+           float _time,
+           Range<const unsigned char> _soa_mask,
+           Pose* _pose);
+
+  // Releases all cached postures, usually at the beginning of every frame so
+  // that postures aren't shared across frames. Previously returned postures
+  // are invalidated.
+  void Clear();
+
+  // Quantizes _time to time_step().
+  float Quantize(float _time) const;
+
+  // Gets the time step sampling times are quantized to, 0 if none.
+  float time_step() const {
+    return time_step_;
+  }
+
+  // Gets the maximum number of postures of the cache.
+  int capacity() const {
+    return capacity_;
+  }
+
+  // Gets the number of postures cached since last Clear().
+  int num_poses() const {
+    return num_poses_;
+  }
+
+  // Gets the number of Get() calls that were served with an already cached
+  // posture since last Clear().
+  int num_hits() const {
+    return num_hits_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  PoseCache(PoseCache const&);
+  void operator=(PoseCache const&);
+
+  // Defines a cached posture key.
+  struct Key {
+    uint32_t animation_id;
+    float time;
+    uint32_t hash;
+  };
+
+  // The skeleton of all postures.
+  const Skeleton& skeleton_;
+
+  // Maximum number of postures.
+  int capacity_;
+
+  // Sampling time quantization step.
+  float time_step_;
+
+  // Number of bytes of a soa tracks mask.
+  int mask_size_;
+
+  // Number of postures cached, and of Get() calls served from the cache,
+  // since last Clear().
+  int num_poses_;
+  int num_hits_;
+
+  // Number of slots of the hash table, a power of 2.
+  int num_slots_;
+
+  // The slab, that stores all the buffers below.
+  char* slab_;
+
+  // Postures local-space transforms and model-space matrices (if enabled).
+  math::SoaTransform* locals_;
+  math::Float4x4* models_;
+
+  // Postures keys and soa tracks masks.
+  Key* keys_;
+  unsigned char* masks_;
+
+  // Open addressing hash table of postures indices, -1 for empty slots.
+  int* slots_;
+
+  // Cache used to sample all postures.
+  SamplingCache* cache_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_CACHE_H_
@@ -0,0 +1,106 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_DELTA_ENCODER_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_DELTA_ENCODER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; struct CompactSoaTransform; }
+
+namespace animation {
+
+// Forward declares runtime types.
+class Skeleton;
+
+// Encodes skeleton poses as deltas to a reference pose, in order to replicate
+// them over the network (ragdoll or physics synchronization for example).
+// Poses are first quantized to CompactSoaTransform (see
+// ozz/base/maths/compact_soa_transform.h), then compared to the reference
+// pose, which is usually the last pose acknowledged by the receiver. Only the
+// channels (translation, rotation, scale) of the joints that changed are
+// written, as variable length bit packed differences of their quantized
+// values.
+// The stream starts with one bit per soa joint, set if any of its 4 joints
+// changed, followed by one bit per joint of the soa joints that changed. Each
+// changed joint then stores a 3 bits channel mask, and for every channel that
+// changed, 3 component differences. Rotations also store the 3 bits of their
+// dropped component index and sign (see CompactSoaTransform::largest).
+// Differences are zig-zag encoded and written with a 2 bits length prefix,
+// selecting 4, 8, 12 or 16 bits.
+// Encoder and decoder share the same reference pose, so the sender should keep
+// the quantized pose of every message until it's acknowledged. Quantized poses
+// are output by Encode() and Decode() for that purpose.
+// PoseDeltaEncoder is stateless once constructed, and can be used by multiple
+// threads concurrently.
+class PoseDeltaEncoder {
+ public:
+  // Constructs an encoder of poses of _skeleton, which must outlive the
+  // encoder.
+  explicit PoseDeltaEncoder(const Skeleton& _skeleton);
+
+  // Quantizes _pose to _quantized, and encodes it as a delta to _reference in
+  // _buffer. _pose, _reference and _quantized must store at least skeleton
+  // num_soa_joints elements. Soa padding joints aren't encoded.
+  // Returns the number of bytes written to _buffer, which is always greater
+  // than 0 if the skeleton has joints, or 0 if a range is too small.
+  size_t Encode(Range<const math::SoaTransform> _pose,
+                Range<const math::CompactSoaTransform> _reference,
+                Range<math::CompactSoaTransform> _quantized,
+                Range<char> _buffer) const;
+
+  // Decodes _buffer, encoded as a delta to _reference, to the quantized pose
+  // _quantized and to the unpacked pose _pose. Soa padding joints are copied
+  // from _reference. _reference, _quantized and _pose must store at least
+  // skeleton num_soa_joints elements.
+  // Returns false if a range is too small, including _buffer if it's
+  // truncated.
+  bool Decode(Range<const char> _buffer,
+              Range<const math::CompactSoaTransform> _reference,
+              Range<math::CompactSoaTransform> _quantized,
+              Range<math::SoaTransform> _pose) const;
+
+  // Gets the maximum number of bytes of an encoded pose, to size buffers.
+  size_t max_size() const;
+
+ private:
+  // Disables copy and assignation.
+  PoseDeltaEncoder(PoseDeltaEncoder const&);
+  void operator=(PoseDeltaEncoder const&);
+
+  // The skeleton of all poses.
+  const Skeleton& skeleton_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_DELTA_ENCODER_H_
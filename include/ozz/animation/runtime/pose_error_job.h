@@ -0,0 +1,101 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_ERROR_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_ERROR_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Float4x4; }
+namespace animation {
+
+// Forward declares the Skeleton object used to compute joint weights.
+class Skeleton;
+
+// Measures how much a pose differs from a reference one, as the distance
+// between the model-space positions of their joints. It's meant to compare a
+// cheaper evaluation of a character (lower update rate, fewer blending layers,
+// skipped joints...) to the full one, so that LOD schedulers can adapt
+// evaluation quality from measured errors rather than from fixed distances.
+// Distances are computed 4 joints at a time with SIMD instructions. The job
+// outputs their weighted mean, and optionally their maximum.
+// The job does not owned any buffer (in/output) and will thus not delete them
+// during job's destruction.
+struct PoseErrorJob {
+  // Default constructor, initializes default values.
+  PoseErrorJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if error output pointer is NULL.
+  // -if reference or pose ranges are invalid, or have different sizes.
+  // -if weights range is specified and is smaller than the number of joints.
+  bool Validate() const;
+
+  // Runs job's error computation task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Model-space matrices of the reference (usually full quality) pose.
+  Range<const math::Float4x4> reference;
+
+  // Model-space matrices of the pose to compare to the reference, with the
+  // same number of joints.
+  Range<const math::Float4x4> pose;
+
+  // Optional weight of every joint error, see ComputeJointLengthWeights. All
+  // joints have the same weight if the range is empty.
+  Range<const float> weights;
+
+  // Job output.
+
+  // Weighted mean of joint position errors. It's 0 if there's no joint, or if
+  // the sum of weights is 0.
+  float* error;
+
+  // Optional maximum joint position error, unweighted. Default is NULL.
+  float* max_error;
+};
+
+// Fills _weights with the length of every joint's bone in _skeleton bind pose,
+// which is the length of its local translation. Errors on joints that carry short
+// bones, like fingers or twist joints, thus count less than the ones of long
+// limbs. Roots, that have no bone, are given the longest bone length, so their
+// error is never ignored.
+// Returns false if _weights is smaller than the number of joints.
+bool ComputeJointLengthWeights(const Skeleton& _skeleton,
+                               Range<float> _weights);
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_ERROR_JOB_H_
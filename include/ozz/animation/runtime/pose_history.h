@@ -0,0 +1,167 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_HISTORY_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_HISTORY_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; struct Float4x4; }
+
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class Skeleton;
+class SamplingCache;
+
+// Stores the recent history of a character animation state, so that its pose
+// can be rewound to any past time, like a game server does to compensate
+// clients lag when it checks hits.
+// Instead of storing a pose per tick, the history records the state of the
+// animation layers (animation, sampling time and blending weight), in a fixed
+// size ring of records. A pose is only reconstructed when it's needed,
+// sampling and blending layers at the requested time, and then computing
+// model-space matrices of the requested joints only. Layers states are
+// interpolated in between records.
+// Every layer uses its own SamplingCache, which is restored from the animation
+// seek index when rewinding (see AnimationBuilder::seek_interval), instead of
+// being rebuilt from the beginning of the animation.
+// PoseHistory does not lock, so an instance must not be used by multiple
+// threads concurrently.
+class PoseHistory {
+ public:
+  // Defines PoseHistory constant values.
+  enum Constants {
+    // Maximum number of layers of a record.
+    kMaxLayers = 4,
+  };
+
+  // Defines the state of an animation layer.
+  struct Layer {
+    // The animation played by this layer, which must outlive the record.
+    const Animation* animation;
+
+    // The sampling time of the animation, see SamplingJob::time.
+    float time;
+
+    // The blending weight of the layer, see BlendingJob::Layer::weight.
+    float weight;
+  };
+
+  // Constructs a history of at most _capacity records, for characters that
+  // use _skeleton. _skeleton must outlive the history.
+  PoseHistory(const Skeleton& _skeleton, int _capacity);
+
+  // Deallocates records, caches and buffers.
+  ~PoseHistory();
+
+  // Records layers states _layers at simulation time _time. The oldest record
+  // is discarded if the history is full.
+  // Returns false and leaves the history unchanged if _time isn't after the
+  // newest record time, if there are more than kMaxLayers layers, or if a layer
+  // animation is NULL or has more tracks than the skeleton.
+  bool Record(float _time, Range<const Layer> _layers);
+
+  // Reconstructs the pose at simulation time _time, and computes model-space
+  // matrices of the joints of the evaluation list _joints (see
+  // BuildJointEvaluationList() and SparseLocalToModelJob), or of all joints if
+  // _joints is empty. Only the soa tracks of these joints are sampled.
+  // Layers of the record preceding _time are interpolated with the next
+  // record ones, if they play the same animation forward. Times after the
+  // newest record use the newest record.
+  // _models must be at least as big as the skeleton's number of joints.
+  // Matrices of joints that aren't evaluated are left unchanged.
+  // Returns false if _time is before the oldest record, or if an argument is
+  // invalid.
+  bool Evaluate(float _time,
+                Range<const uint16_t> _joints,
+                Range<math::Float4x4> _models);
+
+  // Discards all records.
+  void Clear();
+
+  // Gets the maximum number of records.
+  int capacity() const {
+    return capacity_;
+  }
+
+  // Gets the number of records.
+  int num_records() const {
+    return num_records_;
+  }
+
+  // Gets the oldest and newest records times. Only valid if the history
+  // isn't empty.
+  float oldest_time() const;
+  float newest_time() const;
+
+ private:
+  // Disables copy and assignation.
+  PoseHistory(PoseHistory const&);
+  void operator=(PoseHistory const&);
+
+  // Defines a record, the layers states at a simulation time.
+  struct Entry {
+    float time;
+    int num_layers;
+    Layer layers[kMaxLayers];
+  };
+
+  // Gets the _i th record, from the oldest one.
+  const Entry& entry(int _i) const {
+    return entries_[(first_ + _i) % capacity_];
+  }
+
+  // The skeleton of all poses.
+  const Skeleton& skeleton_;
+
+  // Maximum number of records.
+  int capacity_;
+
+  // Index of the oldest record in the ring, and number of records.
+  int first_;
+  int num_records_;
+
+  // Ring of records.
+  Entry* entries_;
+
+  // Local-space transforms of every layer, followed by the blended ones.
+  math::SoaTransform* locals_;
+
+  // Sampling caches, one per layer.
+  SamplingCache* caches_[kMaxLayers];
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_HISTORY_H_
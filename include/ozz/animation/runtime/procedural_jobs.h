@@ -0,0 +1,227 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PROCEDURAL_JOBS_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PROCEDURAL_JOBS_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/maths/vec_float.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Procedural jobs post-process a local-space pose, usually the output of the
+// blending stage, to layer secondary motions on top of animations. They work
+// on SoaTransform, so they process 4 joints at once with simd instructions,
+// and are restricted to a subset of the joints with per joint weights, like
+// BlendingJob layers.
+// Look-at isn't part of this set, as it requires model-space matrices, see
+// AimIKJob.
+
+// Soa spring state of 4 joints, as updated by JiggleJob from a frame to the
+// next one. Content is opaque, it should only be written by JiggleJob.
+struct SoaJiggleState {
+  // Spring translation and its velocity.
+  math::SoaFloat3 translation;
+  math::SoaFloat3 translation_velocity;
+
+  // Spring rotation and its velocity, per quaternion component.
+  math::SoaQuaternion rotation;
+  math::SoaQuaternion rotation_velocity;
+};
+
+// Makes joints translation and rotation lag behind the input pose, like
+// springs attached to it, which is how jiggle bones (hair, cloth, fat...)
+// are animated. Springs are integrated with an implicit Euler step, which is
+// stable whatever the stiffness and frame rate. Scales aren't affected.
+// The number of joints processed is defined by the size of the input buffer.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct JiggleJob {
+  // Default constructor, initializes default values.
+  JiggleJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any range is invalid.
+  // -if state, output or joint weights buffers are smaller than the input
+  // buffer.
+  // -if delta time or damping is negative, or stiffness is not positive.
+  bool Validate() const;
+
+  // Runs job's jiggle task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time elapsed since the previous frame. Must be positive.
+  float delta_time;
+
+  // Springs stiffness, the higher the quicker springs follow the input pose.
+  // Must be greater than 0.f. Default value is 100.f.
+  float stiffness;
+
+  // Springs damping, the higher the sooner springs stop oscillating. Must be
+  // positive. Default value is 10.f.
+  float damping;
+
+  // Resets springs to the input pose at rest, which must be done the first
+  // time the job runs with a state buffer, or when the character teleports.
+  // Default is false.
+  bool reset;
+
+  // Optional per joint weights, blending from the input pose (0.f) to the
+  // spring pose (1.f). Springs are updated whatever their weight, so they
+  // don't pop when their weight changes.
+  // If both pointers are NULL (default case) then all joints use a weight of
+  // 1.f. Otherwise the range must be at least as big as the input buffer.
+  Range<const math::SimdFloat4> joint_weights;
+
+  // The local-space pose springs are attached to. The size of this buffer
+  // defines the number of soa joints to process.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Springs state, that must be kept from a frame to the next one.
+  Range<SoaJiggleState> state;
+
+  // Job output.
+  // The range of output transforms, which can be the same as input.
+  Range<ozz::math::SoaTransform> output;
+};
+
+// Updates the jiggle springs of a batch of characters, each one with its own
+// input, state and output, but sharing the same spring parameters. This job
+// is an alternative to running one JiggleJob per character, which allows to
+// amortize job setup and validation costs when simulating many characters,
+// like crowd agents with hair or cloth proxies. Its output is a local-space
+// pose, that is usually then converted to model-space with LocalToModelJob.
+// Every item must conform with JiggleJob requirements.
+// The job does not owned the buffers (items, in/output) and will thus not
+// delete them during job's destruction.
+struct BatchJiggleJob {
+  // Default constructor, initializes default values.
+  BatchJiggleJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if items range is invalid.
+  // -if any item is invalid, according to JiggleJob::Validate() rules.
+  bool Validate() const;
+
+  // Runs job's batch jiggle task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time elapsed since the previous frame, see JiggleJob::delta_time.
+  float delta_time;
+
+  // Springs stiffness, see JiggleJob::stiffness.
+  float stiffness;
+
+  // Springs damping, see JiggleJob::damping.
+  float damping;
+
+  // Defines a batch item, which has the same meaning as JiggleJob members.
+  struct Item {
+    // Default constructor, initializes default values.
+    Item();
+
+    // Resets springs to the input pose, see JiggleJob::reset.
+    bool reset;
+
+    // Optional per joint weights, see JiggleJob::joint_weights.
+    Range<const math::SimdFloat4> joint_weights;
+
+    // The local-space pose springs are attached to, see JiggleJob::input.
+    Range<const ozz::math::SoaTransform> input;
+
+    // Springs state of this item, see JiggleJob::state.
+    Range<SoaJiggleState> state;
+
+    // The output range of this item, see JiggleJob::output.
+    Range<ozz::math::SoaTransform> output;
+  };
+
+  // Job input items.
+  Range<const Item> items;
+};
+
+// Rotates joints around an axis, distributing the rotation over them with per
+// joint weights. It's used to lean a spine when turning or accelerating, or
+// to breathe by animating the angle over time.
+// The number of joints processed is defined by the size of the input buffer.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct LeanJob {
+  // Default constructor, initializes default values.
+  LeanJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any range is invalid.
+  // -if output or joint weights buffers are smaller than the input buffer.
+  // -if axis isn't normalized.
+  bool Validate() const;
+
+  // Runs job's lean task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Lean rotation axis, in the parent space of every joint. Must be
+  // normalized. Default is x axis.
+  math::Float3 axis;
+
+  // Lean angle in radians, applied to joints whose weight is 1.f.
+  float angle;
+
+  // Per joint weights, the fraction of the lean angle applied to every joint.
+  // Joints with a 0.f weight aren't affected. The range must be at least as
+  // big as the input buffer.
+  Range<const math::SimdFloat4> joint_weights;
+
+  // The local-space pose to lean. The size of this buffer defines the number
+  // of soa joints to process.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Job output.
+  // The range of output transforms, which can be the same as input.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PROCEDURAL_JOBS_H_
@@ -0,0 +1,129 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PROGRESSIVE_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PROGRESSIVE_ANIMATION_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class OArchive;
+template <typename _Ty> class IContainer;
+}
+namespace animation {
+
+// Forward declares the animation type.
+class Animation;
+
+// Defines an animation clip stored as levels of increasing quality, coarsest
+// first. Every level is a self-sufficient Animation built from the same clip
+// with finer optimization tolerances than the previous one (see
+// offline::ProgressiveAnimationBuilder). Sampling thus only needs the finest
+// resident level, see animation().
+// Levels are saved coarsest first as an io::OContainer<Animation>, whose table
+// of contents gives every level offset. They are loaded in the same order, so
+// resident levels are always a prefix of all levels: a clip can start playing
+// as soon as its first (smallest) level is read or downloaded, and sharpens as
+// following levels are loaded. Finest levels can be released again under
+// memory pressure.
+// Sampling with a SamplingCache is safe when the finest level changes, as
+// every level has its own generation id (see Animation::id()), which resets
+// the cache.
+class ProgressiveAnimation {
+ public:
+  // Builds a progressive animation without any level.
+  ProgressiveAnimation();
+
+  // Releases all resident levels.
+  ~ProgressiveAnimation();
+
+  // Releases all resident levels, and sets the number of levels to
+  // _num_levels.
+  void Reset(int _num_levels);
+
+  // Gets the number of levels.
+  int num_levels() const {
+    return num_levels_;
+  }
+
+  // Gets the number of resident levels, which are always the coarsest ones.
+  int num_resident_levels() const {
+    return num_resident_levels_;
+  }
+
+  // Gets the finest resident level, or NULL if no level is resident.
+  const Animation* animation() const {
+    return num_resident_levels_ ? levels_.begin[num_resident_levels_ - 1]
+                                : NULL;
+  }
+
+  // Gets level _level, or NULL if it isn't resident.
+  const Animation* level(int _level) const;
+
+  // Makes _animation the next resident level, and takes its ownership.
+  // _animation must be allocated with the default allocator.
+  // Returns false if all levels are already resident, or if _animation is
+  // NULL or doesn't match the duration and number of tracks of the first
+  // level, in which case ownership isn't taken.
+  bool PushLevel(Animation* _animation);
+
+  // Loads the next level from _container, a container of the levels saved by
+  // Save(). The number of levels is set to the number of objects of the
+  // container if no level is resident yet.
+  // Returns false if all levels are already resident, or if loading fails.
+  bool LoadLevel(io::IContainer<Animation>* _container);
+
+  // Releases the finest resident levels, such that only _num_levels remain.
+  void ReleaseLevels(int _num_levels);
+
+  // Saves all levels, coarsest first, as a container to _archive. All levels
+  // must be resident.
+  // Returns false and saves nothing if a level isn't resident.
+  bool Save(io::OArchive* _archive) const;
+
+  // Gets the size in bytes of the resident levels.
+  size_t size() const;
+
+ private:
+  // Disables copy and assignation.
+  ProgressiveAnimation(ProgressiveAnimation const&);
+  void operator=(ProgressiveAnimation const&);
+
+  // Levels, coarsest first. Non resident ones are NULL.
+  Range<Animation*> levels_;
+
+  // Number of levels, and of resident levels.
+  int num_levels_;
+  int num_resident_levels_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PROGRESSIVE_ANIMATION_H_
@@ -0,0 +1,84 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct SoaTransform; }
+namespace animation {
+
+// Forward declares the retarget table type.
+class RetargetTable;
+
+// Retargets local transforms of a source skeleton to a target skeleton, using
+// the precomputed joint mapping and bind pose corrections of a RetargetTable.
+// This allows a single animation, sampled with the source skeleton, to drive
+// many skeleton variants without duplicating animation data: the output of the
+// SamplingJob (or BlendingJob) of the source is retargeted to every target.
+// Source transforms are gathered to target soa joints, then corrected in soa
+// format.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct RetargetJob {
+  // Default constructor, initializes default values.
+  RetargetJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer, including ranges, is NULL.
+  // -if the size of the input is smaller than the table number of source
+  // joints.
+  // -if the size of the output is smaller than the table number of target
+  // joints.
+  bool Validate() const;
+
+  // Runs job's retargeting task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The table that maps source joints to target joints.
+  const RetargetTable* table;
+
+  // Job input.
+  // Local transforms of the source skeleton, in soa format.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Job output.
+  // Local transforms of the target skeleton, in soa format. Its range must not
+  // overlap with input's one.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_JOB_H_
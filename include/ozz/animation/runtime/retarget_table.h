@@ -0,0 +1,148 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_TABLE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_TABLE_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; }
+namespace animation {
+
+// Forward declares the RetargetTableBuilder, used to instantiate a table.
+namespace offline { class RetargetTableBuilder; }
+
+// Defines the precomputed data required to retarget local transforms of a
+// source skeleton to a target skeleton, see RetargetJob.
+// Every target joint is mapped to a source joint, or to none. Mapped joints
+// preserve the source deviation from its bind pose:
+// - rotation = target_bind_rotation * source_bind_rotation^-1 * rotation.
+// - translation = target_bind_translation + (translation -
+//   source_bind_translation) * ratio, ratio being the length ratio of target
+//   and source bind translations, which adapts root motion to target
+//   proportions.
+// - scale = target_bind_scale * scale / source_bind_scale.
+// Unmapped target joints are set to their bind pose.
+// Corrections are stored in soa format, per target soa joint.
+// This structure is usually filled by the RetargetTableBuilder and
+// deserialized/loaded at runtime.
+class RetargetTable {
+ public:
+
+  // Builds an empty table.
+  RetargetTable();
+
+  // Declares the public non-virtual destructor.
+  ~RetargetTable();
+
+  // Defines the bind pose correction of 4 target joints.
+  struct SoaCorrection {
+    // Rotation applied to the source rotation.
+    math::SoaQuaternion rotation;
+
+    // Translation added to the scaled source translation.
+    math::SoaFloat3 translation;
+
+    // Ratio applied to the source translation.
+    math::SimdFloat4 translation_ratio;
+
+    // Scale applied to the source scale.
+    math::SoaFloat3 scale;
+  };
+
+  // Returns the number of target joints.
+  int num_joints() const {
+    return num_joints_;
+  }
+
+  // Returns the number of target soa joints.
+  int num_soa_joints() const {
+    return (num_joints_ + 3) / 4;
+  }
+
+  // Returns the number of source joints.
+  int num_source_joints() const {
+    return num_source_joints_;
+  }
+
+  // Returns the source joint index of every target joint, or
+  // Skeleton::kNoParentIndex for unmapped joints. The range is padded to a
+  // multiple of 4 joints.
+  Range<const uint16_t> sources() const {
+    return Range<const uint16_t>(sources_, num_soa_joints() * 4);
+  }
+
+  // Returns bind pose corrections, per target soa joint.
+  Range<const SoaCorrection> corrections() const {
+    return Range<const SoaCorrection>(corrections_, num_soa_joints());
+  }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  RetargetTable(RetargetTable const&);
+  void operator=(RetargetTable const&);
+
+  // RetargetTableBuilder class is allowed to instantiate a table.
+  friend class offline::RetargetTableBuilder;
+
+  // Allocates table buffers for _num_joints target joints.
+  void Allocate(int _num_joints, int _num_source_joints);
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Source joint of every target joint.
+  uint16_t* sources_;
+
+  // Bind pose corrections of every target soa joint.
+  SoaCorrection* corrections_;
+
+  // The number of target and source joints.
+  int num_joints_;
+  int num_source_joints_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::RetargetTable)
+OZZ_IO_TYPE_TAG("ozz-retarget_table", animation::RetargetTable)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_TABLE_H_
@@ -0,0 +1,126 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/maths/vec_float.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; }
+namespace animation {
+
+// Forward declares the RootMotionBuilder, used to instantiate a root motion.
+namespace offline { class RootMotionBuilder; }
+
+// Defines the root motion track of an animation, ie: the translation and yaw
+// (rotation around y axis) of the root joint over time, extracted offline by
+// the RootMotionBuilder.
+// The track is a compact list of linearly interpolated keys, sampled by the
+// RootMotionJob, which outputs motion deltas between two times without
+// sampling the animation of the whole skeleton.
+// This structure is usually filled by the RootMotionBuilder and
+// deserialized/loaded at runtime.
+class RootMotion {
+ public:
+
+  // Builds an empty root motion.
+  RootMotion();
+
+  // Declares the public non-virtual destructor.
+  ~RootMotion();
+
+  // Defines a root motion key.
+  struct Key {
+    // Key time, in seconds.
+    float time;
+
+    // Root translation.
+    math::Float3 translation;
+
+    // Root yaw, in radians. Yaw is continuous from a key to the next, so it
+    // isn't limited to range [-pi,pi].
+    float yaw;
+  };
+
+  // Gets the root motion duration, which matches the animation one.
+  float duration() const {
+    return duration_;
+  }
+
+  // Returns the number of keys.
+  int num_keys() const {
+    return num_keys_;
+  }
+
+  // Returns motion keys, sorted by time.
+  Range<const Key> keys() const {
+    return Range<const Key>(keys_, num_keys_);
+  }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  RootMotion(RootMotion const&);
+  void operator=(RootMotion const&);
+
+  // RootMotionBuilder class is allowed to instantiate a root motion.
+  friend class offline::RootMotionBuilder;
+
+  // Allocates keys buffer for _num_keys keys.
+  void Allocate(int _num_keys);
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Motion keys.
+  Key* keys_;
+
+  // The number of keys.
+  int num_keys_;
+
+  // Duration of the motion.
+  float duration_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::RootMotion)
+OZZ_IO_TYPE_TAG("ozz-root_motion", animation::RootMotion)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_H_
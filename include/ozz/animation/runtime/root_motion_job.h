@@ -0,0 +1,89 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Float3; }
+namespace animation {
+
+// Forward declares the root motion type.
+class RootMotion;
+
+// Computes the root motion delta between two times of a RootMotion track,
+// without sampling the animation of the whole skeleton. The delta is the
+// motion to apply to the character, after the one at time "from":
+// - translation is expressed in the root frame at time "from", ie: rotated by
+// the inverse of the yaw at time "from".
+// - yaw is the rotation around y axis from time "from" to time "to".
+// The job does not owned any buffer (in/output) and will thus not delete them
+// during job's destruction.
+struct RootMotionJob {
+  // Default constructor, initializes default values.
+  RootMotionJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input or output pointer is NULL.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The root motion track to sample.
+  const RootMotion* motion;
+
+  // Times the delta is computed between, clamped in range [0,duration].
+  float from;
+  float to;
+
+  // If true and "to" is lower than "from", the motion is considered looping
+  // over the end of the track: the delta accumulates motion from "from" to the
+  // end, then from the beginning to "to". Otherwise, the motion from "from" to
+  // "to" is computed directly, which is reversed if "to" is lower than "from".
+  // Default is false.
+  bool loop;
+
+  // Job output.
+
+  // Delta translation.
+  math::Float3* translation;
+
+  // Delta yaw, in radians.
+  float* yaw;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
@@ -0,0 +1,132 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_BLEND_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_BLEND_JOB_H_
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares the animation and cache types to sample.
+class Animation;
+class SamplingCache;
+
+// Samples and blends multiple animations to a single output, in a single job.
+// This job is equivalent to running a SamplingJob per layer followed by a
+// BlendingJob, but without the intermediate local-space buffers: soa joints
+// are processed by small chunks, whose layers are interpolated to a stack
+// buffer and then accumulated to the output. Output and intermediate data
+// thus remain in cpu caches for all layers, which saves most of the memory
+// traffic of multi-layer characters.
+// Blending follows BlendingJob rules: weights are normalized, joint weights
+// allow partial blending and the bind pose is blended when the accumulated
+// weight of a joint is less than the threshold value. The number of joints
+// processed is defined by the number of soa transforms of the bind pose.
+// Soa joints whose weights are all 0 aren't sampled. A layer whose animation
+// has fewer soa tracks than the bind pose considers remaining joints with a
+// weight of 0.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct SampleBlendJob {
+  // Default constructor, initializes default values.
+  SampleBlendJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if layer range is not valid.
+  // -if any layer animation or cache is NULL, or if a cache is too small or
+  // can't address all the keys of its layer animation.
+  // -if any layer joint weights range is smaller than the bind pose buffer.
+  // -if output range is smaller than the bind pose buffer.
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's sampling and blending task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines a layer, ie: an animation to sample and its blending parameters.
+  struct Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // Time used to sample animation, see SamplingJob::time.
+    float time;
+
+    // The animation to sample.
+    const Animation* animation;
+
+    // The cache object used to sample animation, see SamplingJob::cache. A
+    // cache stores per-animation sampling state, so layers can't share it.
+    SamplingCache* cache;
+
+    // Blending weight of this layer, see BlendingJob::Layer::weight.
+    float weight;
+
+    // Optional range [begin,end[ of blending weight for each soa joint of this
+    // layer, see BlendingJob::Layer::joint_weights.
+    Range<const math::SimdFloat4> joint_weights;
+  };
+
+  // The job blends the bind pose to the output when the accumulated weight of
+  // all layers is less than this threshold value.
+  // Must be greater than 0.f.
+  float threshold;
+
+  // Job input layers.
+  // The range of layers that must be sampled and blended.
+  Range<const Layer> layers;
+
+  // The skeleton bind pose. The size of this buffer defines the number of
+  // transforms to sample and blend.
+  Range<const ozz::math::SoaTransform> bind_pose;
+
+  // Job output.
+  // The range of output transforms to be filled with blended layer
+  // transforms during job execution.
+  // Must be at least as big as the bind pose buffer, but only the number of
+  // transforms defined by the bind pose buffer size will be processed.
+  Range<ozz::math::SoaTransform> output;
+
+  // Normalizes sampled and blended rotations with a fast estimation, see
+  // SamplingJob::fast_normalization. Default is false.
+  bool fast_normalization;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_BLEND_JOB_H_
@@ -0,0 +1,119 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_TO_MODEL_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_TO_MODEL_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct Float4x4; }
+namespace math { struct Float4x3; }
+
+namespace animation {
+
+// Forward declares the animation, cache and skeleton types.
+class Animation;
+class SamplingCache;
+class Skeleton;
+
+// Samples an animation and computes model-space joint matrices in a single
+// job, which is equivalent to running a SamplingJob followed by a
+// LocalToModelJob, but without the intermediate local-space buffer. Soa joints
+// are sampled by small chunks to a stack buffer, which is immediately
+// converted to model-space while it's still in cpu caches. This halves the
+// memory traffic of characters that play a single animation without blending,
+// like far level of details.
+// Local scales are only applied if the animation is scaled, see
+// Animation::scaled().
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct SampleToModelJob {
+  // Default constructor, initializes default values.
+  SampleToModelJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if animation, cache or skeleton pointers are NULL.
+  // -if the animation has fewer soa tracks than the skeleton has soa joints.
+  // -if the cache is too small or can't address all animation keys.
+  // -if none or both of output and output_4x3 are specified, or if the
+  // specified output is smaller than the skeleton's number of joints.
+  // -if num_joints_lod is negative.
+  bool Validate() const;
+
+  // Runs job's sampling and local-to-model task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time used to sample animation, see SamplingJob::time.
+  float time;
+
+  // The animation to sample.
+  const Animation* animation;
+
+  // The cache object used to sample animation, see SamplingJob::cache.
+  SamplingCache* cache;
+
+  // The Skeleton object describing the joint hierarchy.
+  const Skeleton* skeleton;
+
+  // The number of joints of the skeleton level of details to process, see
+  // LocalToModelJob::num_joints_lod. Only the soa tracks of these joints are
+  // sampled. Default value is Skeleton::kMaxJoints, which processes all
+  // joints.
+  int num_joints_lod;
+
+  // Job output.
+  // The output range to be filled with model matrices.
+  // Only one of output and output_4x3 must be specified.
+  Range<ozz::math::Float4x4> output;
+
+  // Job output, as compact affine matrices, see LocalToModelJob::output_4x3.
+  // Only one of output and output_4x3 must be specified.
+  Range<ozz::math::Float4x3> output_4x3;
+
+  // Normalizes sampled rotations with a fast estimation, see
+  // SamplingJob::fast_normalization. Default is false.
+  bool fast_normalization;
+
+ private:
+  // Samples and converts joints chunk by chunk to _model_matrices, from a
+  // prepared cache.
+  template <typename _Matrix>
+  void RunChunks(int _num_joints, _Matrix* _model_matrices) const;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_TO_MODEL_JOB_H_
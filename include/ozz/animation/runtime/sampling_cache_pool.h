@@ -0,0 +1,114 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the cache type.
+class SamplingCache;
+
+// Defines a pool of SamplingCache, that can all sample animations of up to the
+// same max_tracks tracks.
+// All caches and their buffers are carved out of a single contiguous slab,
+// allocated at pool construction. Acquiring and releasing a cache are O(1) and
+// don't allocate, which avoids heap fragmentation when caches are constantly
+// created and destroyed, for example by crowd agents.
+// SamplingCachePool does not lock, so an instance must not be used by multiple
+// threads concurrently.
+class SamplingCachePool {
+ public:
+  // Constructs a pool of _capacity caches, that can sample animations with at
+  // most _max_tracks tracks. Caches are compact if _compact is true, see
+  // SamplingCache constructor.
+  SamplingCachePool(int _max_tracks, int _capacity, bool _compact = false);
+
+  // Deallocates the slab. All caches must have been released.
+  ~SamplingCachePool();
+
+  // Acquires an invalidated cache from the pool.
+  // Returns NULL if all pool caches are already acquired.
+  SamplingCache* Acquire();
+
+  // Releases _cache to the pool. _cache must have been acquired from *this
+  // pool and must not be used anymore. _cache can be NULL.
+  void Release(SamplingCache* _cache);
+
+  // Gets the maximum number of tracks that pool caches can handle.
+  int max_tracks() const {
+    return max_tracks_;
+  }
+
+  // Returns true if pool caches are compact.
+  bool compact() const {
+    return compact_;
+  }
+
+  // Gets the number of caches of the pool.
+  int capacity() const {
+    return capacity_;
+  }
+
+  // Gets the number of caches that can still be acquired.
+  int num_free() const {
+    return num_free_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  SamplingCachePool(SamplingCachePool const&);
+  void operator=(SamplingCachePool const&);
+
+  // The maximum number of tracks of pool caches.
+  int max_tracks_;
+
+  // Number of caches of the pool.
+  int capacity_;
+
+  // true if pool caches are compact.
+  bool compact_;
+
+  // The slab, that stores caches, free list and caches buffers.
+  char* slab_;
+
+  // Array of capacity_ caches.
+  SamplingCache* caches_;
+
+  // Stack of free caches indices, whose size is num_free_.
+  int* free_;
+  int num_free_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
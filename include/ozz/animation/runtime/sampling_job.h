@@ -32,6 +32,7 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_JOB_H_
 
 #include "ozz/base/platform.h"
+#include "ozz/base/maths/soa_float.h"
 
 namespace ozz {
 
@@ -46,13 +47,30 @@ class Animation;
 // Forward declares the cache object used by the SamplingJob.
 class SamplingCache;
 
+// Soa local-space velocities of 4 joints, as output by SamplingJob.
+struct SoaJointVelocity {
+  // Translation velocity, in units per second.
+  math::SoaFloat3 translation;
+
+  // Angular velocity, as a rotation axis scaled by the rotation speed in
+  // radians per second. It's expressed in the parent joint space, like local
+  // rotations are.
+  math::SoaFloat3 rotation;
+
+  // Scale velocity, per second.
+  math::SoaFloat3 scale;
+};
+
 // Samples an animation at a given time, to output the corresponding posture in
 // local-space.
 // SamplingJob uses a cache (aka SamplingCache) to store intermediate values
 // (decompressed animation keyframes...) while sampling. This cache also stores
 // pre-computed values that allows drastic optimization while playing/sampling
-// the animation forward. Backward sampling works, but isn't optimized through
-// the cache.
+// the animation forward. Backward sampling works, but is only optimized through
+// the cache if the animation has key links, which allow to rewind the cache.
+// Otherwise the cache is rewound to the first keys, which only outdates tracks
+// whose keys change, so looping an animation doesn't reset the whole cache. A
+// seek index also allows to restore the cache close to any time.
 // The job does not owned the buffers (in/output) and will thus not delete them
 // during job's destruction.
 struct SamplingJob {
@@ -62,6 +80,12 @@ struct SamplingJob {
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer is NULL
   // -if output range is invalid.
+  // -if cache is too small, or is compact and animation has too many keys.
+  // -if soa mask range is invalid.
+  // -if num_joints_lod is negative.
+  // -if soa update periods range is invalid, or update_frame is negative.
+  // -if velocities range is invalid.
+  // -if changed range is invalid.
   bool Validate() const;
 
   // Runs job's sampling task.
@@ -87,6 +111,222 @@ struct SamplingJob {
   // If there are more joints in the animation, then the last joints are not
   // sampled.
   Range<ozz::math::SoaTransform> output;
+
+  // Optional mask of the soa tracks to sample, one bit per soa track: soa
+  // track i is sampled if bit (i & 7) of byte (i / 8) is set. Masked out soa
+  // tracks are neither decompressed nor interpolated, and their output
+  // SoaTransform is left unchanged. This allows to sample only the joints that
+  // are used, for example by a partial blending layer.
+  // If both pointers are NULL (default case) then all soa tracks are sampled.
+  // Otherwise the range must contain at least (num_soa_tracks + 7) / 8 bytes.
+  Range<const unsigned char> soa_mask;
+
+  // The number of joints of the skeleton level of details to sample, see
+  // Skeleton::num_joints_lod(). Only the soa tracks that contain lod joints
+  // are decompressed and interpolated, next soa tracks of the output being
+  // left unchanged. It is combined with soa_mask.
+  // Default value is Skeleton::kMaxJoints, which samples all joints.
+  int num_joints_lod;
+
+  // Optional table of soa tracks update periods, one byte per soa track,
+  // usually built offline by joint groups (see BuildSoaUpdatePeriods()). Soa
+  // track i is only sampled on frames where update_frame is a multiple of its
+  // period, and is left unchanged otherwise, so that less important joints
+  // (like fingers) are refreshed at a lower rate than the rest of the
+  // character. Skipped soa tracks remain outdated in the cache, so they are
+  // interpolated at the right time once refreshed. A period of 0 or 1 samples
+  // the soa track every frame. It is combined with soa_mask and
+  // num_joints_lod.
+  // If both pointers are NULL (default case) then all soa tracks are sampled
+  // every frame. Otherwise the range must contain at least num_soa_tracks
+  // bytes.
+  Range<const unsigned char> soa_update_periods;
+
+  // Frame index that selects the soa tracks to sample according to
+  // soa_update_periods. It's usually incremented every frame, and can be
+  // offset per character to spread refreshes over frames. Must be positive.
+  // Default is 0.
+  int update_frame;
+
+  // Optional velocities output, computed analytically from the keys that
+  // are interpolated, so that velocities don't require to sample the animation
+  // twice and to differentiate the results. Velocities are the derivative of
+  // the interpolation curves (linear or Hermite) at the sampled time, so they
+  // are constant between two keys of linear animations. They're set to zero
+  // when time is out of the animation range, and when translations or scales
+  // are constant. Velocities of soa tracks that aren't sampled (see soa_mask,
+  // num_joints_lod and soa_update_periods) are left unchanged. See
+  // ModelVelocityJob to convert them to model-space.
+  // If both pointers are NULL (default case) then velocities aren't computed.
+  // Otherwise the range must be at least as big as the animation number of
+  // soa tracks.
+  Range<SoaJointVelocity> velocities;
+
+  // Optional output mask of the soa tracks whose output SoaTransform changed,
+  // one bit per soa track, laid out like soa_mask: bit (i & 7) of byte (i / 8)
+  // is set if soa track i output is different from the value the output range
+  // held before the job ran. As long as the output range isn't modified
+  // between two runs, this is the set of soa tracks that changed since the
+  // previous run, allowing downstream jobs (blending, local to model,
+  // replication...) to skip unchanged joints. Constant stretches of keys,
+  // paused animations and soa tracks that aren't sampled (see soa_mask,
+  // num_joints_lod and soa_update_periods) don't change. Detection compares
+  // new and previous outputs, which costs a copy and a comparison per soa
+  // track.
+  // If both pointers are NULL (default case) then changes aren't detected.
+  // Otherwise the range must contain at least (num_soa_tracks + 7) / 8 bytes.
+  Range<unsigned char> changed;
+
+  // Normalizes interpolated rotations with a fast reciprocal square root
+  // estimation, skipping the Newton-Raphson refinement step. This is cheaper
+  // but less accurate (see math::NormalizeFastEst()), which suits characters
+  // whose precision matters less, like distant or low lod ones.
+  // Default is false.
+  bool fast_normalization;
+
+ private:
+
+  // BatchSamplingJob, ClipGroupSamplingJob, SampleBlendJob,
+  // SampleToModelJob and SparseSamplingJob share SamplingJob implementation.
+  // SharedSamplingCache validates caches before sampling.
+  friend struct BatchSamplingJob;
+  friend struct ClipGroupSamplingJob;
+  friend struct SampleBlendJob;
+  friend struct SampleToModelJob;
+  friend struct SparseSamplingJob;
+  friend class SharedSamplingCache;
+
+  // Returns true if _cache is big enough to sample _animation, and if its key
+  // indices can address all _animation keys.
+  static bool IsCompatible(const Animation& _animation,
+                           const SamplingCache& _cache);
+
+  // Samples _animation at _time to _output using _cache, assuming that all
+  // arguments have already been validated. _soa_mask is NULL if all soa
+  // tracks are sampled. Only the _num_soa_lod first soa tracks are sampled.
+  static void Sample(const Animation& _animation,
+                     float _time,
+                     SamplingCache* _cache,
+                     const unsigned char* _soa_mask,
+                     int _num_soa_lod,
+                     bool _fast_normalization,
+                     ozz::math::SoaTransform* _output);
+
+  // Same as Sample, and sets the bits of _changed, a mask of all _animation
+  // soa tracks, whose _output is modified.
+  static void SampleChanged(const Animation& _animation,
+                            float _time,
+                            SamplingCache* _cache,
+                            const unsigned char* _soa_mask,
+                            int _num_soa_lod,
+                            bool _fast_normalization,
+                            ozz::math::SoaTransform* _output,
+                            unsigned char* _changed);
+
+  // Returns _time clamped to _animation duration, in key time unit.
+  static float KeyTime(const Animation& _animation, float _time);
+
+  // Computes the velocities of soa tracks [0,_num_soa_lod[ of a _cache
+  // prepared at _time, skipping those masked out by _soa_mask.
+  static void Differentiate(const Animation& _animation,
+                            const SamplingCache& _cache,
+                            float _time,
+                            int _num_soa_lod,
+                            const unsigned char* _soa_mask,
+                            SoaJointVelocity* _velocities);
+
+  // Steps _cache to _animation at _time and fetches the keys of the soa
+  // tracks that aren't masked out by _soa_mask, among the _num_soa_lod first
+  // ones.
+  static void Prepare(const Animation& _animation,
+                       float _time,
+                       const unsigned char* _soa_mask,
+                       int _num_soa_lod,
+                       SamplingCache* _cache);
+
+  // Interpolates soa tracks [_begin,_end[ of a _cache prepared at the time
+  // matching _key_time (see KeyTime()), skipping those masked out by
+  // _soa_mask. _output is the output of soa track _begin. Rotations are
+  // normalized with a fast estimation if _fast_normalization is true.
+  static void Interpolate(const Animation& _animation,
+                          const SamplingCache& _cache,
+                          float _key_time,
+                          int _begin,
+                          int _end,
+                          const unsigned char* _soa_mask,
+                          bool _fast_normalization,
+                          ozz::math::SoaTransform* _output);
+
+  // Fetches _animation keys at _key_time to _cache, whose key indices are of
+  // _Index type, and updates outdated soa entries that aren't masked out by
+  // _soa_mask, among the _num_soa_lod first ones.
+  template<typename _Index>
+  static void UpdateCache(const Animation& _animation,
+                          float _key_time,
+                          const unsigned char* _soa_mask,
+                          int _num_soa_lod,
+                          SamplingCache* _cache);
+};
+
+// Samples a batch of animations, each one with its own time, cache and output.
+// This job is an alternative to running one SamplingJob per character, which
+// allows to amortize job setup and validation costs when sampling many
+// characters, like crowd agents. Batch items that share the same animation are
+// sampled consecutively, so that animation key frames are kept hot in cpu
+// caches while the cache and output of the next item are prefetched.
+// Every item must conform with SamplingJob requirements. An item that refers to
+// an animation that is already sampled by another item of the batch must use a
+// different cache, as caches store per-character sampling state.
+// The job does not owned the buffers (items, in/output) and will thus not
+// delete them during job's destruction.
+struct BatchSamplingJob {
+  // Default constructor, initializes default values.
+  BatchSamplingJob() {
+  }
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if items range is invalid.
+  // -if any item is invalid, according to SamplingJob::Validate() rules.
+  bool Validate() const;
+
+  // Runs job's batch sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines a batch item, which has the same meaning as SamplingJob members.
+  struct Item {
+    // Default constructor, initializes default values.
+    Item();
+
+    // Time used to sample animation, see SamplingJob::time.
+    float time;
+
+    // The animation to sample, see SamplingJob::animation.
+    const Animation* animation;
+
+    // The cache object used to sample this item, see SamplingJob::cache.
+    SamplingCache* cache;
+
+    // The output range of this item, see SamplingJob::output.
+    Range<ozz::math::SoaTransform> output;
+
+    // The optional soa tracks mask of this item, see SamplingJob::soa_mask.
+    Range<const unsigned char> soa_mask;
+
+    // The number of joints of the lod to sample, see
+    // SamplingJob::num_joints_lod.
+    int num_joints_lod;
+
+    // Rotations normalization mode, see SamplingJob::fast_normalization.
+    bool fast_normalization;
+  };
+
+  // Job input items.
+  // The range of items to sample. Items order has no impact on the result,
+  // only on performance. Sorting items by animation is optimal.
+  Range<const Item> items;
 };
 
 namespace internal {
@@ -94,6 +334,7 @@ namespace internal {
   struct InterpSoaTranslation;
   struct InterpSoaRotation;
   struct InterpSoaScale;
+  struct InterpSoaTangents;
 }  // internal
 
 // Declares the cache object used by the workload to take advantage of the
@@ -103,25 +344,108 @@ class SamplingCache {
   // Construct a cache that can be used to sample any animation with at most
   // _max_tracks tracks. _num_tracks is internally aligned to a multiple of
   // soa size.
-  SamplingCache(int _max_tracks);
+  // A _compact cache stores key indices on 16 bits instead of 32, reducing
+  // its footprint, but can only sample animations with at most
+  // kMaxCompactKeys translation, rotation and scale keys.
+  // All cache buffers are carved out of a single allocation.
+  SamplingCache(int _max_tracks, bool _compact = false);
+
+  // Construct a cache for at most _max_tracks tracks, whose buffers are
+  // carved out of the external _buffer of _size bytes. _buffer must be aligned
+  // to kBufferAlignment and at least buffer_size(_max_tracks, _compact) bytes.
+  // It isn't owned by the cache and must outlive it.
+  SamplingCache(int _max_tracks, void* _buffer, size_t _size,
+                bool _compact = false);
 
   // Deallocate cache.
   ~SamplingCache();
 
+  // Alignment required by the external buffer of a cache.
+  static const size_t kBufferAlignment;
+
+  // Gets the size of the buffer required by a cache for _max_tracks tracks.
+  static size_t buffer_size(int _max_tracks, bool _compact = false);
+
+  // The maximum number of keys per stream (translation, rotation or scale) of
+  // an animation sampled with a compact cache.
+  static const int kMaxCompactKeys = 1 << 16;
+
   // Invalidate the cache.
   // The SamplingJob automatically invalidates a cache when required
   // during sampling. This automatic mechanism is based on the animation
-  // address and sampling time. The weak point is that it can result in a
-  // crash if ever the address of an animation is used again with another
-  // animation (could be the result of successive call to delete / new).
-  // Therefore it is recommended to manually invalidate a cache when it is
-  // known that this cache will not be used for with an animation again.
+  // generation id (see Animation::id()) and sampling time, so it's robust to
+  // an animation address being reused by another animation (successive calls
+  // to delete / new), or to an animation being reloaded in place. Manually
+  // invalidating a cache is still recommended when it is known that this
+  // cache will not be used with an animation again.
   void Invalidate();
 
+  // Gets the size of a snapshot of this cache, see Snapshot().
+  size_t snapshot_size() const;
+
+  // Copies the whole cache state (animation id, time, key cursors, key
+  // indices, decoded soa keys and outdated flags) to the _snapshot blob of
+  // _size bytes, which has no alignment requirement. Restoring it later (see
+  // Restore()) brings the cache back to the exact same state, so that a
+  // rollback re-samples from there as cheaply as forward sampling would,
+  // instead of rewinding the cache.
+  // Snapshots aren't portable, they can only be restored on the same platform
+  // by a cache of the same max_tracks() and compact().
+  // Returns false if _size is smaller than snapshot_size().
+  bool Snapshot(void* _snapshot, size_t _size) const;
+
+  // Restores the cache state saved to _snapshot by Snapshot().
+  // Returns false and leaves the cache unchanged if _size is smaller than
+  // snapshot_size(), or if _snapshot was taken from a cache with a different
+  // max_tracks() or compact().
+  bool Restore(const void* _snapshot, size_t _size);
+
+  // Gets the time, in seconds, at which sampling _animation forward will fetch
+  // its next keys to the cache. Sampling any time from the last sampled one
+  // up to (excluding) this time only interpolates the keys that are already
+  // cached, without reading _animation key frames. Key streams are sorted by
+  // the time at which keys are needed, so this is computed from the stream
+  // cursors in constant time.
+  // Returns 0 if the cache isn't valid for _animation (see Invalidate()), and
+  // the maximum float value if all keys were fetched.
+  float NextKeyTime(const Animation& _animation) const;
+
   // The maximum number of tracks that the cache can handle.
   int max_tracks() const { return max_soa_tracks_ * 4; }
   int max_soa_tracks() const { return max_soa_tracks_; }
 
+  // Returns true if the cache stores key indices on 16 bits.
+  bool compact() const { return compact_; }
+
+  // Statistics of the sampling jobs that used this cache, accumulated until
+  // they are reset. Counters are only updated if ozz is built with stats
+  // enabled (OZZ_HAS_STATS, see ozz_build_stats CMake option), they remain 0
+  // otherwise.
+  struct Stats {
+    // Initializes all counters to 0.
+    Stats();
+
+    // Number of keys fetched from the animation.
+    int keys;
+
+    // Number of outdated soa entries that were decoded, summed for
+    // translations, rotations and scales.
+    int soa_updates;
+
+    // Number of times the cache was reset, because it was invalidated or
+    // used with another animation.
+    int resets;
+
+    // Number of times the cache was restored from an animation seek index.
+    int seeks;
+  };
+
+  // Gets statistics accumulated since cache creation or last ResetStats call.
+  const Stats& stats() const { return stats_; }
+
+  // Resets all statistics counters to 0.
+  void ResetStats() { stats_ = Stats(); }
+
  private:
 
   // Disables copy and assignation.
@@ -129,15 +453,40 @@ class SamplingCache {
   void operator=(SamplingCache const&);
 
   friend struct SamplingJob;
+  friend struct BatchSamplingJob;
 
   // Steps the cache in order to use it for a potentially new animation and
-  // time. If the _animation is different from the animation currently cached,
-  // or if the _time shows that the animation is played backward, then the
-  // cache is invalidated and reseted for the new _animation and _time.
+  // time. If the _animation id is different from the one currently cached,
+  // then the cache is invalidated and reseted for the new _animation and
+  // _time. Backward time is handled when updating keys, which rewinds the
+  // cache with key links, or to the first keys otherwise. If
+  // _animation has a seek index, the cache is then restored from the closest
+  // index entry before _time, unless the cache is already beyond it. Backward
+  // steps that stay within the current keys interval, like time jitter,
+  // reuse the cached keys instead.
   void Step(const Animation& _animation, float _time);
 
-  // The animation this cache refers to. NULL means that the cache is invalid.
-  const Animation* animation_;
+  // Returns true if updating the cache, whose key indices are of _Index type,
+  // to _key_time would rewind any of its streams.
+  template<typename _Index>
+  bool Rewinds(const Animation& _animation, float _key_time) const;
+
+  // Implements NextKeyTime() for key indices of _Index type. Returns the key
+  // time of the next keys.
+  template<typename _Index>
+  int NextKey(const Animation& _animation) const;
+
+  // Restores cache key indices, of _Index type, and cursors from the seek
+  // index _entry.
+  template<typename _Index>
+  void Seek(const int32_t* _entry, int _num_soa_tracks);
+
+  // Dispatches _buffer memory to cache buffers.
+  void Dispatch(void* _buffer);
+
+  // The generation id of the animation this cache refers to, see
+  // Animation::id(). 0 means that the cache is invalid.
+  uint32_t animation_id_;
 
   // The current time in the animation.
   float time_;
@@ -145,15 +494,26 @@ class SamplingCache {
   // The number of soa tracks that can store this cache.
   int max_soa_tracks_;
 
+  // true if soa_translations_, that points the beginning of the buffer, was
+  // allocated by *this cache.
+  bool owns_buffer_;
+
+  // true if key indices are uint16_t, int otherwise.
+  bool compact_;
+
   // Soa hot data to interpolate.
   internal::InterpSoaTranslation* soa_translations_;
   internal::InterpSoaRotation* soa_rotations_;
   internal::InterpSoaScale* soa_scales_;
 
+  // Soa key tangents, only used by Hermite animations.
+  internal::InterpSoaTangents* soa_tangents_;
+
   // Points to the keys in the animation that are valid for the current time.
-  int* translation_keys_;
-  int* rotation_keys_;
-  int* scale_keys_;
+  // Key indices are uint16_t for compact caches, int otherwise.
+  void* translation_keys_;
+  void* rotation_keys_;
+  void* scale_keys_;
 
   // Current cursors in the animation. 0 means that the cache is invalid.
   int translation_cursor_;
@@ -164,6 +524,9 @@ class SamplingCache {
   unsigned char* outdated_translations_;
   unsigned char* outdated_rotations_;
   unsigned char* outdated_scales_;
+
+  // Sampling statistics, see stats().
+  Stats stats_;
 };
 }  // animation
 }  // ozz
@@ -0,0 +1,157 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SHARED_SAMPLING_CACHE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SHARED_SAMPLING_CACHE_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class SamplingCache;
+
+// Shares sampled local-space transforms between the threads that sample the
+// same animation at the same time during a frame, which is common for crowd
+// agents updated in parallel. Without sharing, each thread decompresses the
+// same keys to its private SamplingCache.
+// Entries are identified by the animation generation id (see Animation::id())
+// and sampling time, quantized to a configurable time step. The first thread
+// that requests an entry within a frame claims it, samples it with its
+// private SamplingCache and publishes it. Next requests copy the published
+// entry instead of sampling.
+// The cache is lock-free: a thread never waits for another one. An entry that
+// is being sampled by another thread is skipped, so the same entry can
+// exceptionally be sampled twice. Entries are versioned with the frame they
+// were published in, so NewFrame() invalidates them all at once without
+// clearing the cache.
+// All entries are carved out of a single slab, allocated at construction.
+class SharedSamplingCache {
+ public:
+  // Constructs a cache of at least _capacity entries, rounded up to a power of
+  // 2, of animations of at most _max_tracks tracks. Sampling times are
+  // quantized to _time_step seconds, or aren't quantized at all if _time_step
+  // is 0.
+  SharedSamplingCache(int _max_tracks, int _capacity, float _time_step);
+
+  // Deallocates the slab.
+  ~SharedSamplingCache();
+
+  // Samples _animation at _time, quantized to time_step(), to _output. The
+  // entry is copied from the cache if another thread already published it
+  // during this frame. Otherwise it's sampled with _cache, which must be
+  // private to the calling thread, and published. If the cache is full, the
+  // animation is sampled with _cache directly to _output.
+  // Sample can be called concurrently from multiple threads.
+  // Returns false if _cache is NULL, if _animation has more tracks than
+  // max_tracks(), if _output is smaller than _animation soa tracks, or if
+  // _cache is too small or too compact to sample _animation.
+  bool Sample(const Animation& _animation,
+              float _time,
+              SamplingCache* _cache,
+              Range<math::SoaTransform> _output);
+
+  // Starts a new frame, which invalidates all entries published so far.
+  // NewFrame must not be called concurrently with Sample.
+  void NewFrame();
+
+  // Quantizes _time to time_step().
+  float Quantize(float _time) const;
+
+  // Gets the time step sampling times are quantized to, 0 if none.
+  float time_step() const {
+    return time_step_;
+  }
+
+  // Gets the maximum number of entries of the cache.
+  int capacity() const {
+    return num_slots_;
+  }
+
+  // Gets the maximum number of tracks of sampled animations.
+  int max_tracks() const {
+    return max_soa_tracks_ * 4;
+  }
+
+  // Gets the current frame, incremented by NewFrame().
+  int64_t frame() const {
+    return frame_;
+  }
+
+  // Gets the number of entries published during the current frame. The result
+  // is only exact if no Sample call is running concurrently.
+  int num_entries() const;
+
+ private:
+  // Disables copy and assignation.
+  SharedSamplingCache(SharedSamplingCache const&);
+  void operator=(SharedSamplingCache const&);
+
+  // Defines an entry key.
+  struct Key {
+    uint32_t animation_id;
+    float time;
+  };
+
+  // Maximum number of soa tracks of an entry.
+  int max_soa_tracks_;
+
+  // Number of slots of the hash table, a power of 2. Each slot stores an
+  // entry.
+  int num_slots_;
+
+  // Sampling time quantization step.
+  float time_step_;
+
+  // Current frame, starting from 1.
+  int64_t frame_;
+
+  // The slab, that stores all the buffers below.
+  char* slab_;
+
+  // Entries local-space transforms, max_soa_tracks_ per slot.
+  math::SoaTransform* locals_;
+
+  // Slots state, made of the frame they were last claimed in and of a
+  // published flag, see shared_sampling_cache.cc. Accessed atomically.
+  volatile int64_t* states_;
+
+  // Entries keys, only valid once published.
+  Key* keys_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SHARED_SAMPLING_CACHE_H_
@@ -36,11 +36,14 @@
 
 namespace ozz {
 namespace io { class IArchive; class OArchive; }
+namespace tasks { class Dispatcher; }
 namespace math { struct SoaTransform; }
+namespace memory { class Allocator; }
 namespace animation {
 
-// Forward declaration of SkeletonBuilder, used to instantiate a skeleton.
-namespace offline { class SkeletonBuilder; }
+// Forward declaration of SkeletonBuilder and SkeletonLodBuilder, used to
+// instantiate a skeleton.
+namespace offline { class SkeletonBuilder; class SkeletonLodBuilder; }
 
 // This runtime skeleton data structure provides a const-only access to joint
 // hierarchy, joint names and bind-pose. This structure is filled by the
@@ -53,6 +56,11 @@ namespace offline { class SkeletonBuilder; }
 // whole joint hierarchy in breadth-first order. JointProperties::is_leaf is a
 // helper that is used to speed-up some algorithms: See IterateJointsDF() from
 // skeleton_utils.h that implements a depth-first traversal utility.
+// Joint names are also hashed to an open addressing table, so that FindJoint()
+// doesn't need to compare every joint name.
+// A skeleton built by the SkeletonLodBuilder also defines levels of details,
+// each lod being a prefix of the joints that runtime jobs can stop at, see
+// num_joints_lod().
 class Skeleton {
  public:
 
@@ -62,10 +70,11 @@ class Skeleton {
     // required to store a joint index. Limiting the number of joints also helps
     // handling worst size cases, like when it is required to allocate an array
     // of joints on the stack.
-    // The definitive value isn't decided yet, it'll depend on the number of
-    // bits available in the runtime animation key frame structure once it'll be
-    // compressed.
-    kMaxJointsNumBits = 10,
+    // The value matches the number of bits available to store a track index
+    // in the runtime rotation key frame structure (RotationKey::track), which
+    // is the narrowest of all key frames. Archives written with the former
+    // 10 bits limit are converted at load time.
+    kMaxJointsNumBits = 13,
 
     // Defines the maximum number of joints.
     // Reserves one index (the last) for kNoParentIndex value.
@@ -80,6 +89,23 @@ class Skeleton {
     kNoParentIndex = kMaxJoints,
   };
 
+  // Defines which joint names data are loaded from an archive. Names are
+  // stored after all other data in the archive, so they can be skipped
+  // without being read.
+  enum JointNamesLoading {
+    // Loads joint names and their lookup table.
+    kLoadJointNames,
+
+    // Only loads the lookup table of joint names hashes. joint_names() returns
+    // NULL, and FindJoint only compares hashes, so it could find a joint whose
+    // name has the same hash.
+    kLoadJointNameHashes,
+
+    // Loads neither joint names nor their lookup table. joint_names() returns
+    // NULL and FindJoint always fails.
+    kSkipJointNames,
+  };
+
   // Builds a default skeleton.
   Skeleton();
 
@@ -114,16 +140,74 @@ class Skeleton {
   // Returns joint's bind poses. Bind poses are stored in soa format.
   Range<const math::SoaTransform> bind_pose() const;
 
-  // Returns joint's name collection.
+  // Returns false if every joint bind pose scale is the unit scale. In this
+  // case, and if its animations aren't scaled either (see
+  // Animation::scaled()), BlendingJob and LocalToModelJob scaled option can be
+  // disabled. The flag is detected when the skeleton is built or loaded.
+  bool scaled() const {
+    return scaled_;
+  }
+
+  // Returns true if every joint bind pose scale is uniform, meaning its x, y
+  // and z components are equal. Unscaled skeletons are uniformly scaled. See
+  // Animation::uniformly_scaled(). The flag is detected when the skeleton is
+  // built or loaded.
+  bool uniformly_scaled() const {
+    return uniformly_scaled_;
+  }
+
+  // Returns joint's name collection, or NULL if names weren't loaded, see
+  // JointNamesLoading.
   const char* const* joint_names() const {
     return joint_names_;
   }
 
+  // Sets which joint names data are loaded by the next Load calls. Defaults to
+  // kLoadJointNames. This setting isn't changed by loading.
+  void set_joint_names_loading(JointNamesLoading _loading) {
+    joint_names_loading_ = _loading;
+  }
+
+  // Gets which joint names data are loaded by Load.
+  JointNamesLoading joint_names_loading() const {
+    return joint_names_loading_;
+  }
+
+  // Finds the joint named _name, using a hash table of joint names.
+  // Returns the index of the joint, or -1 if no joint is named _name. The
+  // first joint (in skeleton order) is returned if multiple joints share the
+  // same name. Only hashes are compared if names weren't loaded.
+  int FindJoint(const char* _name) const;
+
+  // Returns the number of levels of details of *this skeleton. A skeleton
+  // that wasn't built by the SkeletonLodBuilder has a single lod that contains
+  // all its joints.
+  int num_lods() const {
+    return num_lods_ ? num_lods_ : 1;
+  }
+
+  // Returns the number of joints of lod _lod, which is clamped to range
+  // [0,num_lods()[. Lod 0 is the most detailed one. Joints of a lod are the
+  // first joints of the skeleton, so this value can be used as the
+  // num_joints_lod parameter of SamplingJob, BlendingJob and LocalToModelJob.
+  int num_joints_lod(int _lod) const;
+
   // Serialization functions.
   // Should not be called directly but through io::Archive << and >> operators.
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // Sets the allocator of the buffers of skeletons that are built or loaded
+  // afterwards, and returns the previous one. Setting NULL restores
+  // memory::default_allocator(), which is used unless specified otherwise.
+  // Every skeleton deallocates its buffers with the allocator that allocated
+  // them, which must outlive it. See Animation::SetBufferAllocator.
+  static memory::Allocator* SetBufferAllocator(memory::Allocator* _allocator);
+
+  // Gets the allocator of the skeleton buffers, see SetBufferAllocator. Never
+  // returns NULL.
+  static memory::Allocator* buffer_allocator();
+
  private:
 
   // Disables copy and assignation.
@@ -133,8 +217,27 @@ class Skeleton {
   // Internal destruction function.
   void Destroy();
 
-  // SkeletonBuilder class is allowed to instantiate an Skeleton.
+  // Sets scaled_ and uniformly_scaled_ flags from the bind pose, see scaled()
+  // and uniformly_scaled().
+  void DetectScale();
+
+  // Allocates and fills joint name hashes and lookup table, once names are
+  // set. Names are hashed concurrently by _dispatcher if it isn't NULL.
+  void BuildJointNamesLookup(tasks::Dispatcher* _dispatcher);
+
+  // Load helpers, for data that are stored at different places depending on
+  // _version.
+  void LoadLods(ozz::io::IArchive& _archive);
+  void LoadJointNamesLookup(ozz::io::IArchive& _archive, uint32_t _version);
+  void LoadJointNames(ozz::io::IArchive& _archive, uint32_t _version);
+
+  // SkeletonBuilder and SkeletonLodBuilder classes are allowed to instantiate
+  // an Skeleton.
   friend class offline::SkeletonBuilder;
+  friend class offline::SkeletonLodBuilder;
+
+  // Allocator of the buffers below, see SetBufferAllocator.
+  memory::Allocator* allocator_;
 
   // Buffers below store joint informations in DAG order. Their size is equal to
   // the number of joints of the skeleton.
@@ -149,13 +252,34 @@ class Skeleton {
   // Uses a single allocation to store the array and all the c strings.
   char** joint_names_;
 
+  // Hash of every joint name.
+  uint32_t* joint_name_hashes_;
+
+  // Open addressing lookup table of joint indices, kNoParentIndex for empty
+  // buckets. Its size is a power of 2.
+  uint16_t* joint_names_lookup_;
+  int joint_names_lookup_size_;
+
+  // Number of joints of every lod, NULL if the skeleton has no lod.
+  uint16_t* lod_num_joints_;
+  int num_lods_;
+
   // The number of joints.
   int num_joints_;
+
+  // At least one joint bind pose isn't the unit scale, see scaled().
+  bool scaled_;
+
+  // Every joint bind pose scale is uniform, see uniformly_scaled().
+  bool uniformly_scaled_;
+
+  // Joint names data loaded by Load.
+  JointNamesLoading joint_names_loading_;
 };
 }  // animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(1, animation::Skeleton)
+OZZ_IO_TYPE_VERSION(4, animation::Skeleton)
 OZZ_IO_TYPE_TAG("ozz-skeleton", animation::Skeleton)
 }  // io
 }  // ozz
@@ -34,6 +34,7 @@
 #include "skeleton.h"
 
 #include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
 
 namespace ozz {
 namespace animation {
@@ -60,6 +61,19 @@ void IterateJointsDF(const Skeleton& _skeleton,
                      int _from,
                      JointsIterator* _iterator);
 
+// Fills _joints with the index of the joints of _skeleton traversed in depth-
+// first order, and returns their number.
+// Unlike the JointsIterator variant, which is sized for Skeleton::kMaxJoints,
+// buffers are sized to the skeleton: _joints must store at least num_joints
+// indices, and the traversal stack is allocated from _scratch (the default
+// allocator if NULL). _scratch is meant to be a per-thread frame arena (see
+// memory::ArenaAllocator), so that neither the stack nor the heap are used.
+// Returns 0 if _from is invalid, or if _joints is too small.
+int IterateJointsDF(const Skeleton& _skeleton,
+                    int _from,
+                    Range<uint16_t> _joints,
+                    memory::Allocator* _scratch);
+
 // Applies a specified functor to each joint in a depth-first order.
 // _Fct is of type void(int _current, int _parent) where the first argument is
 // the child of the second argument. _parent is kNoParentIndex if the _current
@@ -84,6 +98,56 @@ inline _Fct IterateJointsDF(const Skeleton& _skeleton, int _from, _Fct _fct) {
   }
   return _fct;
 }
+
+// Variant of the functor IterateJointsDF, whose temporary buffers are sized to
+// the skeleton and allocated from _scratch allocator (the default allocator if
+// NULL), typically a per-thread frame arena.
+template<typename _Fct>
+inline _Fct IterateJointsDF(const Skeleton& _skeleton,
+                            int _from,
+                            _Fct _fct,
+                            memory::Allocator* _scratch) {
+  memory::Allocator* scratch =
+    _scratch ? _scratch : memory::default_allocator();
+  const Range<uint16_t> joints =
+    scratch->AllocateRange<uint16_t>(_skeleton.num_joints());
+  const int num_joints = IterateJointsDF(_skeleton, _from, joints, scratch);
+
+  // Consumes joints and call _fct.
+  Range<const Skeleton::JointProperties> properties =
+    _skeleton.joint_properties();
+  for (int i = 0; i < num_joints; ++i) {
+    const int joint = joints.begin[i];
+    _fct(joint, properties.begin[joint].parent);
+  }
+  scratch->Deallocate(joints);
+  return _fct;
+}
+
+// Fills _list with the sorted indices of _joints and of all their ancestors,
+// which is the minimal set of joints whose model-space matrices must be
+// computed to know _joints ones. As parents are ordered before their children,
+// the list can be evaluated in order, see SparseLocalToModelJob.
+// If _soa_mask is specified, it's also filled with the soa mask of the listed
+// joints, so that a SamplingJob only decompresses the joints that are
+// evaluated (see SamplingJob::soa_mask).
+// Returns the number of joints written to _list, or 0 if a joint index is
+// invalid, or if _list or _soa_mask are too small.
+int BuildJointEvaluationList(const Skeleton& _skeleton,
+                             Range<const int> _joints,
+                             Range<uint16_t> _list,
+                             Range<unsigned char> _soa_mask);
+
+// Fills _soa_periods with the soa update periods table of _skeleton, see
+// SamplingJob::soa_update_periods. _joint_periods contains the update period
+// of every joint, usually assigned by joint groups (1 for every frame, 4 for
+// fingers...). As the 4 joints of a soa track are sampled together, the
+// period of a soa track is the smallest period of its joints.
+// Returns false if _joint_periods has less than num_joints entries, or if
+// _soa_periods has less than num_soa_joints entries.
+bool BuildSoaUpdatePeriods(const Skeleton& _skeleton,
+                           Range<const unsigned char> _joint_periods,
+                           Range<unsigned char> _soa_periods);
 }  // animation
 }  // ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_SKELETON_UTILS_H_
@@ -0,0 +1,101 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SPARSE_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SPARSE_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares the animation and cache types to sample.
+class Animation;
+class SamplingCache;
+
+// Samples a sparse animation, whose tracks only animate a subset of the
+// skeleton joints (see offline::SparseAnimationBuilder), and writes every
+// track to the joint it animates.
+// The output is expected to be pre-filled (usually with the skeleton bind
+// pose, or with another layer pose), as joints that aren't animated are left
+// unchanged. Sampling cost only depends on the number of animated tracks.
+// Soa tracks whose 4 joints are consecutive and aligned on a soa boundary are
+// copied at once, others are scattered lane by lane.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct SparseSamplingJob {
+  // Default constructor, initializes default values.
+  SparseSamplingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if animation or cache are NULL.
+  // -if the cache is too small or can't address all animation keys.
+  // -if joints size doesn't match animation number of tracks, or if joints
+  // aren't sorted in strictly increasing order.
+  // -if output is too small to store the last animated joint.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time used to sample animation, clamped in range [0,duration] before
+  // job execution.
+  float time;
+
+  // The sparse animation to sample.
+  const Animation* animation;
+
+  // Joint animated by each track of the animation, as output by
+  // offline::SparseAnimationBuilder.
+  Range<const uint16_t> joints;
+
+  // A cache object that must be big enough to sample the animation.
+  SamplingCache* cache;
+
+  // Job output.
+  // Pre-filled joints' local transforms, in soa format. Animated joints are
+  // overwritten by their sampled track.
+  Range<ozz::math::SoaTransform> output;
+
+  // Normalizes sampled rotations with a fast estimation, see
+  // SamplingJob::fast_normalization. Default is false.
+  bool fast_normalization;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SPARSE_SAMPLING_JOB_H_
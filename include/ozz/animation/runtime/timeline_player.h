@@ -0,0 +1,176 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_PLAYER_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_PLAYER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class SamplingCache;
+
+// Plays a timeline of animation clips that start at staggered times, like the
+// hundreds of clips of a cinematic, sampling every clip at the timeline time.
+// Clips that haven't started yet are kept in a queue sorted by start time, so
+// they cost nothing until they start, and clips that ended are sampled once at
+// their end time (so their output holds the last pose) and then left alone.
+// The cost of an update is thus proportional to the number of clips playing,
+// not to the size of the timeline.
+// Every clip has its own SamplingCache, whose cursors in the animation key
+// streams know when the next keys are needed (see
+// SamplingCache::NextKeyTime()). Between two key transitions, sampling only
+// interpolates the cached keys without reading animation key frames.
+// transitions() reports how many clips fetched keys during the last update.
+// TimelinePlayer does not lock, so an instance must not be used by multiple
+// threads concurrently.
+class TimelinePlayer {
+ public:
+  // Defines a clip of the timeline.
+  struct Clip {
+    // Default constructor, initializes default values.
+    Clip();
+
+    // The animation to play.
+    const Animation* animation;
+
+    // Timeline time at which the clip starts, in seconds. The clip ends at
+    // start + animation duration.
+    float start;
+
+    // The cache used to sample the clip, which must be big enough for the
+    // animation and mustn't be shared with other clips.
+    SamplingCache* cache;
+
+    // The output range that the clip is sampled to, which must be at least as
+    // big as the animation number of soa tracks.
+    Range<math::SoaTransform> output;
+  };
+
+  // Constructs a player that can play at most _capacity clips. Timeline time
+  // is initially 0.
+  explicit TimelinePlayer(int _capacity);
+
+  // Deallocates player buffers.
+  ~TimelinePlayer();
+
+  // Adds _clip to the timeline. It starts playing on the first update whose
+  // time is after its start time.
+  // Returns the index of the clip, or -1 if the player is full, or if _clip
+  // animation, cache or output are invalid.
+  int AddClip(const Clip& _clip);
+
+  // Advances the timeline to _time and samples all the clips that are playing
+  // at _time. Clips that start are sampled from their start, and clips that
+  // ended since the last update are sampled at their end time.
+  // Updating to a time before the previous one (scrubbing backward) resets the
+  // queue of clips to start, which costs a sort of the timeline.
+  // Returns false if sampling a clip failed.
+  bool Update(float _time);
+
+  // Gets the timeline time of the last update.
+  float time() const {
+    return time_;
+  }
+
+  // Gets the number of clips of the timeline.
+  int num_clips() const {
+    return num_clips_;
+  }
+
+  // Gets the number of clips that are playing at time().
+  int num_playing() const {
+    return num_playing_;
+  }
+
+  // Gets the number of clips that fetched keys from their animation during
+  // the last update, including clips that started. Other playing clips only
+  // interpolated their cached keys.
+  int transitions() const {
+    return transitions_;
+  }
+
+  // Returns true if clip _index is playing at time().
+  bool playing(int _index) const;
+
+  // Gets clip _index.
+  const Clip& clip(int _index) const;
+
+ private:
+  // Disables copy and assignation.
+  TimelinePlayer(TimelinePlayer const&);
+  void operator=(TimelinePlayer const&);
+
+  // Pushes all clips back to the queue of clips to start.
+  void Rewind();
+
+  // Maximum number of clips.
+  int capacity_;
+
+  // Number of clips of the timeline.
+  int num_clips_;
+
+  // Timeline time of the last update.
+  float time_;
+
+  // Number of clips in the queue of clips to start.
+  int num_pending_;
+
+  // Number of clips playing.
+  int num_playing_;
+
+  // Number of clips that fetched keys during the last update.
+  int transitions_;
+
+  // Clips of the timeline.
+  Clip* clips_;
+
+  // Timeline time at which every clip needs its next keys.
+  float* next_keys_;
+
+  // Min-heap of the indices of the clips to start, sorted by start time.
+  int* pending_;
+
+  // Indices of the clips playing, unsorted.
+  int* playing_;
+
+  // Index of every clip in playing_, or -1 if it isn't playing.
+  int* slots_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_PLAYER_H_
@@ -0,0 +1,148 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_TWO_BONE_IK_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_TWO_BONE_IK_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+
+namespace ozz {
+namespace math {
+struct Quaternion;
+struct SoaQuaternion;
+}
+namespace animation {
+
+// Solves a two bone inverse kinematic chain (like an arm or a leg: start, mid
+// and end joints), so that the end joint reaches a model space target.
+// The job works on the model space matrices output by the LocalToModelJob, and
+// computes local space rotation corrections, to be post-multiplied with the
+// local rotations of the start and mid joints before running the
+// LocalToModelJob again. The mid joint bends around its local mid_axis,
+// while the pole vector defines the direction of the plane the chain lies in.
+// If the target can't be reached, the chain is stretched (or folded) as
+// much as possible towards it.
+// The job does not owned any buffer (in/output) and will thus not delete them
+// during job's destruction.
+struct TwoBoneIKJob {
+  // Default constructor, initializes default values.
+  TwoBoneIKJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input or output pointer is NULL, except optional "reached".
+  // -if mid_axis isn't normalized.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Model space target position of the end joint. W component is ignored.
+  math::SimdFloat4 target;
+
+  // Model space pole vector, defining the direction the mid joint should point
+  // to, relatively to the start-target axis. W component is ignored.
+  math::SimdFloat4 pole_vector;
+
+  // Normalized mid joint local space rotation axis, around which the mid
+  // joint bends. It should be perpendicular to the chain plane. Default is z.
+  math::SimdFloat4 mid_axis;
+
+  // Weight given to the IK correction, clamped in range [0,1]. This allows to
+  // blend the correction in and out. Default is 1.
+  float weight;
+
+  // Model space matrices of the start, mid and end joints of the chain.
+  const math::Float4x4* start_joint;
+  const math::Float4x4* mid_joint;
+  const math::Float4x4* end_joint;
+
+  // Job output.
+
+  // Local space rotation corrections of the start and mid joints.
+  math::Quaternion* start_joint_correction;
+  math::Quaternion* mid_joint_correction;
+
+  // Optional output, set to true if the target is within chain's reach.
+  bool* reached;
+};
+
+// Batched version of the TwoBoneIKJob, solving 4 independent chains at once
+// in soa format. Each lane of soa inputs and outputs corresponds to one
+// chain. Chain joints of a lane can all be set to NULL, in which case the lane
+// is inactive and outputs identity corrections.
+// The job does not owned any buffer (in/output) and will thus not delete them
+// during job's destruction.
+struct BatchTwoBoneIKJob {
+  // Default constructor, initializes default values.
+  BatchTwoBoneIKJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any output pointer is NULL, except optional "reached".
+  // -if start, mid and end joint pointers of a lane aren't all set, or all
+  // NULL.
+  // -if mid_axis isn't normalized.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input, see TwoBoneIKJob for details about every member.
+
+  math::SoaFloat3 target;
+  math::SoaFloat3 pole_vector;
+  math::SoaFloat3 mid_axis;
+  math::SimdFloat4 weight;
+
+  const math::Float4x4* start_joints[4];
+  const math::Float4x4* mid_joints[4];
+  const math::Float4x4* end_joints[4];
+
+  // Job output.
+
+  math::SoaQuaternion* start_joint_corrections;
+  math::SoaQuaternion* mid_joint_corrections;
+
+  // Optional output, set to a per lane true mask if the target is within
+  // chain's reach.
+  math::SimdInt4* reached;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_TWO_BONE_IK_JOB_H_
@@ -0,0 +1,177 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_FLAT_MAP_H_
+#define OZZ_OZZ_BASE_CONTAINERS_FLAT_MAP_H_
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "ozz/base/containers/map.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+
+// Implements an associative container whose elements are stored contiguously
+// in a sorted ozz::Vector. Compared to ozz::Map, lookups are cache friendly
+// and don't allocate per element, at the cost of a linear insertion. It best
+// suits maps that are built once and searched many times, which is the case
+// of joint name lookups. assign() function allows to build the whole map
+// with a single sort.
+// Iterators are invalidated by insertions and erasures.
+template <class _Key,
+          class _Ty,
+          class _Pred = std::less<_Key> >
+class FlatMap {
+ public:
+  typedef _Key key_type;
+  typedef _Ty mapped_type;
+  typedef std::pair<_Key, _Ty> value_type;
+  typedef typename ozz::Vector<value_type>::Std Container;
+  typedef typename Container::iterator iterator;
+  typedef typename Container::const_iterator const_iterator;
+
+  // Compares elements by key.
+  struct KeyCompare {
+    bool operator()(const value_type& _left, const _Key& _right) const {
+      return _Pred()(_left.first, _right);
+    }
+    bool operator()(const value_type& _left, const value_type& _right) const {
+      return _Pred()(_left.first, _right.first);
+    }
+  };
+
+  // Iterators.
+  iterator begin() { return elements_.begin(); }
+  const_iterator begin() const { return elements_.begin(); }
+  iterator end() { return elements_.end(); }
+  const_iterator end() const { return elements_.end(); }
+
+  // Capacity.
+  bool empty() const { return elements_.empty(); }
+  size_t size() const { return elements_.size(); }
+  void reserve(size_t _capacity) { elements_.reserve(_capacity); }
+
+  // Returns an iterator to the first element whose key isn't less than _key.
+  iterator lower_bound(const _Key& _key) {
+    return std::lower_bound(elements_.begin(), elements_.end(), _key,
+                            KeyCompare());
+  }
+  const_iterator lower_bound(const _Key& _key) const {
+    return std::lower_bound(elements_.begin(), elements_.end(), _key,
+                            KeyCompare());
+  }
+
+  // Returns an iterator to the element whose key is _key, end() otherwise.
+  iterator find(const _Key& _key) {
+    const iterator it = lower_bound(_key);
+    return it != end() && !_Pred()(_key, it->first) ? it : end();
+  }
+  const_iterator find(const _Key& _key) const {
+    const const_iterator it = lower_bound(_key);
+    return it != end() && !_Pred()(_key, it->first) ? it : end();
+  }
+
+  // Returns the number of elements whose key is _key, either 0 or 1.
+  size_t count(const _Key& _key) const {
+    return find(_key) != end() ? 1 : 0;
+  }
+
+  // Inserts _value if its key isn't already in the map. Returns a pair whose
+  // first member is an iterator to the element with the same key as _value,
+  // and whose second member is true if insertion happened.
+  std::pair<iterator, bool> insert(const value_type& _value) {
+    iterator it = lower_bound(_value.first);
+    if (it != end() && !_Pred()(_value.first, it->first)) {
+      return std::make_pair(it, false);
+    }
+    it = elements_.insert(it, _value);
+    return std::make_pair(it, true);
+  }
+
+  // Returns a reference to the value mapped to _key, inserting a default one
+  // if _key isn't in the map yet.
+  _Ty& operator[](const _Key& _key) {
+    return insert(value_type(_key, _Ty())).first->second;
+  }
+
+  // Replaces map content with elements of range [_begin,_end[, which doesn't
+  // need to be sorted. Only the first of elements sharing the same key is
+  // kept, as std::map would do if elements were inserted in order.
+  template <typename _Iterator>
+  void assign(_Iterator _begin, _Iterator _end) {
+    elements_.assign(_begin, _end);
+    std::stable_sort(elements_.begin(), elements_.end(), KeyCompare());
+    elements_.erase(std::unique(elements_.begin(), elements_.end(),
+                                Equivalent()),
+                    elements_.end());
+  }
+
+  // Erases element at _where.
+  void erase(iterator _where) {
+    elements_.erase(_where);
+  }
+
+  // Erases the element whose key is _key, returns the number of erased
+  // elements.
+  size_t erase(const _Key& _key) {
+    const iterator it = find(_key);
+    if (it == end()) {
+      return 0;
+    }
+    elements_.erase(it);
+    return 1;
+  }
+
+  // Removes all elements.
+  void clear() { elements_.clear(); }
+
+ private:
+  // Tests key equivalence of two elements.
+  struct Equivalent {
+    bool operator()(const value_type& _left, const value_type& _right) const {
+      return !_Pred()(_left.first, _right.first) &&
+             !_Pred()(_right.first, _left.first);
+    }
+  };
+
+  // Sorted elements.
+  Container elements_;
+};
+
+// Specializes FlatMap to use c-string as a key. Strings aren't copied, so
+// they must outlive the map.
+template <class _Ty>
+struct CStringFlatMap {
+  typedef FlatMap<const char*, _Ty, str_less> Type;
+};
+}  // ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_FLAT_MAP_H_
@@ -0,0 +1,99 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_INTERNAL_ATOMIC_H_
+#define OZZ_OZZ_BASE_CONTAINERS_INTERNAL_ATOMIC_H_
+
+// Implements the few atomic operations required by lock-free containers, on
+// top of compiler intrinsics. Every operation acts as a full memory barrier.
+
+#include "ozz/base/platform.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedCompareExchange64)
+#endif  // _MSC_VER
+
+namespace ozz {
+namespace containers {
+namespace internal {
+
+// Atomically compares *_dest with _comparand and sets it to _exchange if they
+// are equal. Returns the initial value of *_dest.
+inline void* CompareExchange(void* volatile* _dest,
+                             void* _exchange,
+                             void* _comparand) {
+#if defined(_MSC_VER)
+  return _InterlockedCompareExchangePointer(_dest, _exchange, _comparand);
+#else  // _MSC_VER
+  return __sync_val_compare_and_swap(_dest, _comparand, _exchange);
+#endif  // _MSC_VER
+}
+
+inline int64_t CompareExchange(volatile int64_t* _dest,
+                               int64_t _exchange,
+                               int64_t _comparand) {
+#if defined(_MSC_VER)
+  return _InterlockedCompareExchange64(
+    reinterpret_cast<volatile __int64*>(_dest), _exchange, _comparand);
+#else  // _MSC_VER
+  return __sync_val_compare_and_swap(_dest, _comparand, _exchange);
+#endif  // _MSC_VER
+}
+
+// Atomically loads *_src value.
+inline void* Load(void* volatile* _src) {
+  return CompareExchange(_src, NULL, NULL);
+}
+
+inline int64_t Load(volatile int64_t* _src) {
+  return CompareExchange(_src, 0, 0);
+}
+
+// Atomically sets *_dest to _exchange and returns its previous value.
+inline void* Exchange(void* volatile* _dest, void* _exchange) {
+  void* previous;
+  do {
+    previous = Load(_dest);
+  } while (CompareExchange(_dest, _exchange, previous) != previous);
+  return previous;
+}
+
+inline int64_t Exchange(volatile int64_t* _dest, int64_t _exchange) {
+  int64_t previous;
+  do {
+    previous = Load(_dest);
+  } while (CompareExchange(_dest, _exchange, previous) != previous);
+  return previous;
+}
+}  // internal
+}  // containers
+}  // ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_INTERNAL_ATOMIC_H_
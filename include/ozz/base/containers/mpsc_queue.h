@@ -0,0 +1,160 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_MPSC_QUEUE_H_
+#define OZZ_OZZ_BASE_CONTAINERS_MPSC_QUEUE_H_
+
+#include <cassert>
+#include <cstddef>
+
+#include "ozz/base/containers/internal/atomic.h"
+
+namespace ozz {
+namespace containers {
+
+// Implements an intrusive lock-free multi-producer single-consumer FIFO
+// queue. As for IntrusiveList, the queued type must inherit from
+// MpscQueue::Hook, so pushing and popping never allocate memory.
+// Any thread can push, concurrently, but a single thread at a time can pop.
+// Pushing is wait-free (a single atomic exchange), and popping is lock-free
+// but can report an empty queue while another thread is in the middle of
+// pushing. The consumer is expected to try again later, which is the way
+// schedulers poll queues anyway.
+// _Unique differentiates queue types at compile time, allowing the same object
+// to inherit from multiple hooks, to be stored in more than one queue.
+// The implementation is based on Dmitry Vyukov intrusive MPSC node-based
+// queue.
+template <typename _Ty, int _Unique = 0>
+class MpscQueue {
+ public:
+  // Hook to inherit from. A hook can only be pushed to a single queue at a
+  // time.
+  class Hook {
+   protected:
+    Hook()
+        : next_(NULL) {
+    }
+   private:
+    friend class MpscQueue;
+    Hook* volatile next_;
+  };
+
+  // Constructs an empty queue.
+  MpscQueue()
+      : head_(&stub_),
+        tail_(&stub_) {
+  }
+
+  // Queue must be empty when it's destroyed.
+  ~MpscQueue() {
+    assert(empty() && "Queue isn't empty");
+  }
+
+  // Pushes _value at the end of the queue. Can be called from any thread.
+  void push(_Ty* _value) {
+    assert(_value && "Invalid NULL value");
+    Push(static_cast<Hook*>(_value));
+  }
+
+  // Pops the element at the front of the queue. Returns NULL if the queue is
+  // empty, or if the first element is being pushed by another thread.
+  // Must only be called from the consumer thread.
+  _Ty* pop() {
+    Hook* tail = tail_;
+    Hook* next = Next(tail);
+    if (tail == &stub_) {  // Skips the stub, which isn't an element.
+      if (!next) {
+        return NULL;
+      }
+      tail_ = next;
+      tail = next;
+      next = Next(tail);
+    }
+    if (next) {
+      tail_ = next;
+      return static_cast<_Ty*>(tail);
+    }
+    // tail is the last element, unless a push is in progress.
+    if (tail != internal::Load(reinterpret_cast<void* volatile*>(&head_))) {
+      return NULL;
+    }
+    // Pushes the stub back, so that tail can be popped without leaving the
+    // queue without any hook.
+    Push(&stub_);
+    next = Next(tail);
+    if (next) {
+      tail_ = next;
+      return static_cast<_Ty*>(tail);
+    }
+    return NULL;
+  }
+
+  // Tests if the queue is empty. Must only be called from the consumer
+  // thread, the result being immediately outdated if producers are pushing.
+  bool empty() const {
+    return tail_ ==
+      internal::Load(reinterpret_cast<void* volatile*>(
+        const_cast<Hook* volatile*>(&head_))) &&
+      tail_ == &stub_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  MpscQueue(const MpscQueue&);
+  void operator=(const MpscQueue&);
+
+  void Push(Hook* _hook) {
+    _hook->next_ = NULL;
+    Hook* previous = static_cast<Hook*>(internal::Exchange(
+      reinterpret_cast<void* volatile*>(&head_), _hook));
+    // Between the exchange and this store, the queue is temporarily split,
+    // which pop() detects.
+    internal::Exchange(reinterpret_cast<void* volatile*>(&previous->next_),
+                       _hook);
+  }
+
+  static Hook* Next(Hook* _hook) {
+    return static_cast<Hook*>(
+      internal::Load(reinterpret_cast<void* volatile*>(&_hook->next_)));
+  }
+
+  // Last pushed hook, updated by producers.
+  Hook* volatile head_;
+
+  // Next hook to pop, only accessed by the consumer.
+  Hook* tail_;
+
+  // Always queued hook, that allows to pop the last element.
+  class Stub : public Hook {};
+  Stub stub_;
+};
+}  // containers
+}  // ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_MPSC_QUEUE_H_
@@ -0,0 +1,278 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_SMALL_VECTOR_H_
+#define OZZ_OZZ_BASE_CONTAINERS_SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include "ozz/base/platform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+
+// Implements a vector that stores up to _capacity elements in place, without
+// any allocation, and switches to the ozz default allocator beyond. This is
+// useful for the many small arrays of offline and sample code, whose size
+// is usually small but unbounded.
+// SmallVector implements a subset of std::vector interface. Iterators are
+// pointers, which are invalidated by any operation that changes the size of
+// the vector. Elements are copied when the vector grows. Alignment of elements
+// is limited to 16 bytes.
+template <typename _Ty, size_t _capacity>
+class SmallVector {
+ public:
+  typedef _Ty value_type;
+  typedef _Ty* iterator;
+  typedef const _Ty* const_iterator;
+  typedef _Ty& reference;
+  typedef const _Ty& const_reference;
+  typedef size_t size_type;
+
+  // Constructs an empty vector.
+  SmallVector()
+      : begin_(local()),
+        size_(0),
+        capacity_(_capacity) {
+    OZZ_STATIC_ASSERT(_capacity > 0);
+  }
+
+  // Constructs a vector of _size copies of _value.
+  explicit SmallVector(size_t _size, const _Ty& _value = _Ty())
+      : begin_(local()),
+        size_(0),
+        capacity_(_capacity) {
+    resize(_size, _value);
+  }
+
+  // Constructs a copy of _other.
+  SmallVector(const SmallVector& _other)
+      : begin_(local()),
+        size_(0),
+        capacity_(_capacity) {
+    assign(_other.begin(), _other.end());
+  }
+
+  // Destroys elements and deallocates memory.
+  ~SmallVector() {
+    clear();
+    if (begin_ != local()) {
+      memory::default_allocator()->Deallocate(begin_);
+    }
+  }
+
+  // Copies _other elements.
+  SmallVector& operator=(const SmallVector& _other) {
+    if (this != &_other) {
+      assign(_other.begin(), _other.end());
+    }
+    return *this;
+  }
+
+  // Replaces elements by a copy of range [_begin,_end[, which must not be
+  // part of *this vector.
+  void assign(const _Ty* _begin, const _Ty* _end) {
+    clear();
+    reserve(static_cast<size_t>(_end - _begin));
+    for (; _begin < _end; ++_begin, ++size_) {
+      new(begin_ + size_) _Ty(*_begin);
+    }
+  }
+
+  // Element access.
+  _Ty& operator[](size_t _index) {
+    assert(_index < size_ && "Index out of range.");
+    return begin_[_index];
+  }
+  const _Ty& operator[](size_t _index) const {
+    assert(_index < size_ && "Index out of range.");
+    return begin_[_index];
+  }
+  _Ty& front() {
+    return (*this)[0];
+  }
+  const _Ty& front() const {
+    return (*this)[0];
+  }
+  _Ty& back() {
+    return (*this)[size_ - 1];
+  }
+  const _Ty& back() const {
+    return (*this)[size_ - 1];
+  }
+  _Ty* data() {
+    return begin_;
+  }
+  const _Ty* data() const {
+    return begin_;
+  }
+
+  // Iterators.
+  iterator begin() {
+    return begin_;
+  }
+  const_iterator begin() const {
+    return begin_;
+  }
+  iterator end() {
+    return begin_ + size_;
+  }
+  const_iterator end() const {
+    return begin_ + size_;
+  }
+
+  // Capacity.
+  bool empty() const {
+    return size_ == 0;
+  }
+  size_t size() const {
+    return size_;
+  }
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  // Returns true if elements are stored in place, ie without allocation.
+  bool is_local() const {
+    return begin_ == local();
+  }
+
+  // Ensures capacity is at least _count elements.
+  void reserve(size_t _count) {
+    if (_count <= capacity_) {
+      return;
+    }
+    _Ty* elements = memory::default_allocator()->Allocate<_Ty>(_count);
+    for (size_t i = 0; i < size_; ++i) {
+      new(elements + i) _Ty(begin_[i]);
+      begin_[i].~_Ty();
+    }
+    if (begin_ != local()) {
+      memory::default_allocator()->Deallocate(begin_);
+    }
+    begin_ = elements;
+    capacity_ = _count;
+  }
+
+  // Modifiers.
+  void push_back(const _Ty& _value) {
+    if (size_ == capacity_) {
+      // _value could be an element of *this vector, so it's copied first.
+      const _Ty copy(_value);
+      reserve(capacity_ * 2);
+      new(begin_ + size_) _Ty(copy);
+    } else {
+      new(begin_ + size_) _Ty(_value);
+    }
+    ++size_;
+  }
+  void pop_back() {
+    assert(size_ && "Vector is empty.");
+    begin_[--size_].~_Ty();
+  }
+
+  // Inserts a copy of _value before _where, returns an iterator to the
+  // inserted element.
+  iterator insert(iterator _where, const _Ty& _value) {
+    assert(_where >= begin() && _where <= end() && "Invalid iterator.");
+    const size_t index = static_cast<size_t>(_where - begin_);
+    push_back(_value);
+    for (size_t i = size_ - 1; i > index; --i) {
+      std::swap(begin_[i], begin_[i - 1]);
+    }
+    return begin_ + index;
+  }
+
+  // Erases elements of range [_begin,_end[, returns an iterator to the
+  // element that follows the last erased one.
+  iterator erase(iterator _begin, iterator _end) {
+    assert(_begin >= begin() && _end <= end() && _begin <= _end &&
+           "Invalid iterator.");
+    const size_t count = static_cast<size_t>(_end - _begin);
+    for (iterator it = _end; it < end(); ++it) {
+      *(it - count) = *it;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      pop_back();
+    }
+    return _begin;
+  }
+  iterator erase(iterator _where) {
+    return erase(_where, _where + 1);
+  }
+
+  // Resizes to _size elements, copies of _value being appended if the vector
+  // grows.
+  void resize(size_t _size, const _Ty& _value = _Ty()) {
+    if (_size > size_) {
+      reserve(_size);
+      for (; size_ < _size; ++size_) {
+        new(begin_ + size_) _Ty(_value);
+      }
+    } else {
+      while (size_ > _size) {
+        pop_back();
+      }
+    }
+  }
+
+  // Destroys all elements. Capacity is unchanged.
+  void clear() {
+    while (size_) {
+      pop_back();
+    }
+  }
+
+ private:
+  _Ty* local() {
+    return reinterpret_cast<_Ty*>(local_);
+  }
+  const _Ty* local() const {
+    return reinterpret_cast<const _Ty*>(local_);
+  }
+
+  // In place storage, aligned for SIMD types. Types requiring more than 16
+  // bytes alignment aren't supported.
+  OZZ_ALIGN(16) char local_[_capacity * sizeof(_Ty)];
+
+  // Elements, either local_ or allocated.
+  _Ty* begin_;
+
+  // Number of elements.
+  size_t size_;
+
+  // Number of elements that can be stored without reallocation.
+  size_t capacity_;
+};
+}  // ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_SMALL_VECTOR_H_
@@ -0,0 +1,172 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_WORK_STEALING_DEQUE_H_
+#define OZZ_OZZ_BASE_CONTAINERS_WORK_STEALING_DEQUE_H_
+
+#include <cassert>
+#include <cstddef>
+
+#include "ozz/base/containers/internal/atomic.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace containers {
+
+// Implements a bounded lock-free work-stealing deque of pointers, as used by
+// task schedulers: the owner thread pushes and pops at the bottom (LIFO),
+// while any other thread can steal from the top (FIFO).
+// The buffer is allocated once at construction, so pushing and popping never
+// allocate memory. Memory of elements is owned by the user.
+// pop() and steal() return NULL if the deque is empty, steal() also returning
+// NULL if it lost the race for an element against the owner or another thief.
+// The implementation is based on Chase and Lev dynamic circular work-stealing
+// deque, without buffer growth.
+template <typename _Ty>
+class WorkStealingDeque {
+ public:
+  // Constructs an empty deque that can store up to _capacity elements.
+  // _capacity is rounded up to the next power of 2.
+  explicit WorkStealingDeque(int _capacity)
+      : top_(0),
+        bottom_(0),
+        mask_(0),
+        buffer_(NULL) {
+    int capacity = 1;
+    while (capacity < _capacity) {
+      capacity <<= 1;
+    }
+    mask_ = capacity - 1;
+    buffer_ = memory::default_allocator()->Allocate<void*>(capacity);
+  }
+
+  // Deallocates the buffer. Remaining elements aren't deleted.
+  ~WorkStealingDeque() {
+    memory::default_allocator()->Deallocate(const_cast<void**>(buffer_));
+  }
+
+  // Gets the maximum number of elements.
+  int capacity() const {
+    return static_cast<int>(mask_ + 1);
+  }
+
+  // Pushes _value at the bottom of the deque. Returns false if the deque is
+  // full. Must only be called from the owner thread.
+  bool push(_Ty* _value) {
+    assert(_value && "Invalid NULL value");
+    const int64_t bottom = bottom_;
+    const int64_t top = internal::Load(&top_);
+    if (bottom - top > mask_) {
+      return false;
+    }
+    // Element is written before it's published by the bottom update.
+    internal::Exchange(&buffer_[bottom & mask_], _value);
+    internal::Exchange(&bottom_, bottom + 1);
+    return true;
+  }
+
+  // Pops the element at the bottom of the deque, ie the last pushed one.
+  // Returns NULL if the deque is empty. Must only be called from the owner
+  // thread.
+  _Ty* pop() {
+    // Reserves the bottom element before reading top, so thieves see it.
+    const int64_t bottom = bottom_ - 1;
+    internal::Exchange(&bottom_, bottom);
+    int64_t top = internal::Load(&top_);
+    if (top > bottom) {  // Empty.
+      internal::Exchange(&bottom_, bottom + 1);
+      return NULL;
+    }
+    void* value = internal::Load(&buffer_[bottom & mask_]);
+    if (top == bottom) {
+      // Last element, races against thieves by incrementing top.
+      if (internal::CompareExchange(&top_, top + 1, top) != top) {
+        value = NULL;
+      }
+      internal::Exchange(&bottom_, bottom + 1);
+    }
+    return static_cast<_Ty*>(value);
+  }
+
+  // Steals the element at the top of the deque, ie the first pushed one.
+  // Returns NULL if the deque is empty, or if the element was taken
+  // concurrently. Can be called from any thread.
+  _Ty* steal() {
+    const int64_t top = internal::Load(&top_);
+    const int64_t bottom = internal::Load(&bottom_);
+    if (top >= bottom) {
+      return NULL;
+    }
+    // The element is read before top is incremented, as the owner can push
+    // to this slot as soon as top moved.
+    void* value = internal::Load(&buffer_[top & mask_]);
+    if (internal::CompareExchange(&top_, top + 1, top) != top) {
+      return NULL;
+    }
+    return static_cast<_Ty*>(value);
+  }
+
+  // Tests if the deque is empty. Result is immediately outdated if other
+  // threads access the deque.
+  bool empty() const {
+    return size() == 0;
+  }
+
+  // Gets the number of elements in the deque. Result is immediately outdated
+  // if other threads access the deque.
+  int size() const {
+    const int64_t top = internal::Load(const_cast<volatile int64_t*>(&top_));
+    const int64_t bottom =
+      internal::Load(const_cast<volatile int64_t*>(&bottom_));
+    return bottom > top ? static_cast<int>(bottom - top) : 0;
+  }
+
+ private:
+  // Disables copy and assignation.
+  WorkStealingDeque(const WorkStealingDeque&);
+  void operator=(const WorkStealingDeque&);
+
+  // Index of the next element to steal. Top and bottom are on different cache
+  // lines to prevent false sharing between owner and thieves.
+  volatile int64_t top_;
+  char padding_[64 - sizeof(int64_t)];
+
+  // Index of the next element to push, only written by the owner.
+  volatile int64_t bottom_;
+
+  // Capacity - 1, used for wrapping indices in the circular buffer.
+  int64_t mask_;
+
+  // Circular buffer of elements.
+  void* volatile* buffer_;
+};
+}  // containers
+}  // ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_WORK_STEALING_DEQUE_H_
@@ -55,6 +55,16 @@ inline Endianness GetNativeEndianness() {
   return Endianness(u.c[0]);
 }
 
+namespace internal {
+// Swaps in place _count elements of 2, 4 or 8 bytes of the array _data, that
+// doesn't need to be aligned. Arrays are swapped in bulk using SIMD byte
+// shuffles when available (SSSE3 pshufb, SSE2, NEON), which matters when
+// loading archives of the opposite endianness.
+void EndianSwap16(void* _data, size_t _count);
+void EndianSwap32(void* _data, size_t _count);
+void EndianSwap64(void* _data, size_t _count);
+}  // internal
+
 // Declare the endian swapper struct that is aimed to be specialized (template
 // meaning) for every type sizes.
 // The swapper provides two functions:
@@ -88,10 +98,7 @@ struct EndianSwapper<_Ty, 1> {
 template <typename _Ty>
 struct EndianSwapper<_Ty, 2> {
   OZZ_INLINE static void Swap(_Ty* _ty, size_t _count) {
-    char* alias = reinterpret_cast<char*>(_ty);
-    for (size_t i = 0; i < _count * 2; i += 2) {
-      _OZZ_BYTE_SWAP(alias[i + 0], alias[i + 1]);
-    }
+    internal::EndianSwap16(_ty, _count);
   }
   OZZ_INLINE static _Ty Swap(_Ty _ty) {  // Pass by copy to swap _ty in-place.
     char* alias = reinterpret_cast<char*>(&_ty);
@@ -104,11 +111,7 @@ struct EndianSwapper<_Ty, 2> {
 template <typename _Ty>
 struct EndianSwapper<_Ty, 4> {
   OZZ_INLINE static void Swap(_Ty* _ty, size_t _count) {
-    char* alias = reinterpret_cast<char*>(_ty);
-    for (size_t i = 0; i < _count * 4; i += 4) {
-      _OZZ_BYTE_SWAP(alias[i + 0], alias[i + 3]);
-      _OZZ_BYTE_SWAP(alias[i + 1], alias[i + 2]);
-    }
+    internal::EndianSwap32(_ty, _count);
   }
   OZZ_INLINE static _Ty Swap(_Ty _ty) {  // Pass by copy to swap _ty in-place.
     char* alias = reinterpret_cast<char*>(&_ty);
@@ -122,13 +125,7 @@ struct EndianSwapper<_Ty, 4> {
 template <typename _Ty>
 struct EndianSwapper<_Ty, 8> {
   OZZ_INLINE static void Swap(_Ty* _ty, size_t _count) {
-    char* alias = reinterpret_cast<char*>(_ty);
-    for (size_t i = 0; i < _count * 8; i += 8) {
-      _OZZ_BYTE_SWAP(alias[i + 0], alias[i + 7]);
-      _OZZ_BYTE_SWAP(alias[i + 1], alias[i + 6]);
-      _OZZ_BYTE_SWAP(alias[i + 2], alias[i + 5]);
-      _OZZ_BYTE_SWAP(alias[i + 3], alias[i + 4]);
-    }
+    internal::EndianSwap64(_ty, _count);
   }
   OZZ_INLINE static _Ty Swap(_Ty _ty) {  // Pass by copy to swap _ty in-place.
     char* alias = reinterpret_cast<char*>(&_ty);
@@ -74,18 +74,35 @@
 // that allows to check the tag (ie the type) of the next object to read. Stream
 // integrity, like data corruption or file truncation, must also be validated on
 // the user side.
+//
+// To help with integrity validation, an OArchive can optionally store a
+// checksum (CRC32C) section for every object saved with the << operator,
+// except objects nested in another saved object. An IArchive with verification
+// enabled (see IArchive::set_verify) validates each object data in a single
+// pass before loading it. Objects whose data are corrupted aren't loaded, and
+// IArchive::corrupted() reports it. Archives with checksums can't be read by
+// ozz versions prior to this feature.
+//
+// Many objects of the same type can also be saved as a container (see
+// archive_container.h), which stores their tag and version once, followed by a
+// table of contents allowing to seek to any object directly.
 
 #include "ozz/base/endianness.h"
 #include "ozz/base/platform.h"
 #include "ozz/base/io/stream.h"
 
 #include <cassert>
+#include <cstring>
 #include <stdint.h>
 
 #include "ozz/base/io/archive_traits.h"
 
 namespace ozz {
 namespace io {
+// Forward declares container types, see archive_container.h.
+template <typename _Ty> class OContainer;
+template <typename _Ty> class IContainer;
+
 namespace internal {
 // Defines Tagger helper object struct.
 // The boolean template argument is used to automatically select a template
@@ -102,9 +119,20 @@ class OArchive {
  public:
 
   // Constructs an output archive from the Stream _stream that must be valid
-  // and opened for writing.
-  explicit OArchive(Stream* _stream, 
-                    Endianness _endianness = GetNativeEndianness());
+  // and opened for writing. If _checksum is true, a checksum is saved with
+  // every object, see the header description. Objects are then serialized to
+  // memory first, in order to compute their checksum.
+  explicit OArchive(Stream* _stream,
+                    Endianness _endianness = GetNativeEndianness(),
+                    bool _checksum = false);
+
+  // Required as objects being checksummed can own a memory stream.
+  ~OArchive();
+
+  // Returns true if a checksum is saved with every object.
+  bool checksum() const {
+    return checksum_;
+  }
 
   // Returns true if an endian swap is required while writing.
   bool endian_swap() const {
@@ -121,7 +149,9 @@ class OArchive {
   void operator<<(const _Ty& _ty) {
     internal::Tagger<const _Ty>::Write(*this);
     SaveVersion<_Ty>();
+    const bool checksummed = BeginObject();
     Save(*this, &_ty, 1);
+    EndObject(checksummed);
   }
 
   // Primitive type saving.
@@ -151,6 +181,18 @@ class OArchive {
   }
 
  private:
+  // Disables copy and assignation.
+  OArchive(OArchive const&);
+  void operator=(OArchive const&);
+
+  // Containers save objects data directly, without their tag and version.
+  template <typename _Ty> friend class OContainer;
+
+  // Redirects top level objects data to a memory stream, in order to write
+  // their checksum section first. Returns true if the object is checksummed.
+  bool BeginObject();
+  void EndObject(bool _checksummed);
+
   template <typename _Ty>
   void SaveVersion() {
     // Compilation could fail here if the version is not defined for _Ty, or if
@@ -162,11 +204,18 @@ class OArchive {
     }
   }
 
-  // The output stream.
+  // The output stream, or the memory stream of the object being checksummed.
   Stream* stream_;
 
+  // The output stream while an object is being checksummed, NULL otherwise.
+  Stream* output_;
+
   // Endian swap state, true if a conversion is required while writing.
   bool endian_swap_;
+
+  // Checksum mode, and depth of the objects being saved.
+  bool checksum_;
+  int depth_;
 };
 
 // Implements input archive concept used to load/de-serialize data to a Stream.
@@ -185,6 +234,27 @@ class IArchive {
     return endian_swap_;
   }
 
+  // Returns true if the archive stores a checksum with every object.
+  bool checksum() const {
+    return checksum_;
+  }
+
+  // Enables verification of objects checksum before loading them. Has no
+  // effect if the archive stores no checksum. Disabled by default.
+  void set_verify(bool _verify) {
+    verify_ = _verify;
+  }
+  bool verify() const {
+    return verify_;
+  }
+
+  // Returns true if an object with a corrupted checksum was found while
+  // loading. Such objects aren't loaded, and the stream is moved past their
+  // data.
+  bool corrupted() const {
+    return corrupted_;
+  }
+
   // Loads _size bytes of binary data to _data.
   size_t LoadBinary(void* _data, size_t _size) {
     return stream_->Read(_data, _size);
@@ -197,9 +267,12 @@ class IArchive {
     OZZ_IF_DEBUG(bool valid =) internal::Tagger<const _Ty>::Validate(*this);
     assert(valid && "Type tag does not match archive content.");
 
-    // Loads instance.
+    // Loads instance, unless its checksum is wrong.
     uint32_t version = LoadVersion<_Ty>();
-    Load(*this, &_ty, 1, version);
+    if (BeginObject()) {
+      Load(*this, &_ty, 1, version);
+    }
+    EndObject();
   }
 
   // Primitive type loading.
@@ -230,7 +303,7 @@ class IArchive {
     // mean the file containing tag declaration is not included.
     OZZ_STATIC_ASSERT(internal::Tag<const _Ty>::kTagLength != 0);
 
-    const int tell = stream_->Tell();
+    const int64_t tell = stream_->Tell();
     bool valid = internal::Tagger<const _Ty>::Validate(*this);
     stream_->Seek(tell, Stream::kSet); // Rewinds before the tag test.
     return valid;
@@ -242,6 +315,14 @@ class IArchive {
   }
 
  private:
+  // Containers load objects data directly, without their tag and version.
+  template <typename _Ty> friend class IContainer;
+
+  // Reads top level objects checksum section, and verifies their data if
+  // requested. Returns false if the object must not be loaded.
+  bool BeginObject();
+  void EndObject();
+
   template <typename _Ty>
   uint32_t LoadVersion() {
     uint32_t version = 0;
@@ -256,6 +337,13 @@ class IArchive {
 
   // Endian swap state, true if a conversion is required while reading.
   bool endian_swap_;
+
+  // Checksum mode, verification mode and result, and depth of the objects
+  // being loaded.
+  bool checksum_;
+  bool verify_;
+  bool corrupted_;
+  int depth_;
 };
 
 // Primitive type are not versionable.
@@ -309,16 +397,29 @@ template <typename _Ty> struct Version<const Array<_Ty> > {
   enum { kValue = Version<const _Ty>::kValue };
 };
 
+// Saves _count primitive _Ty values from _array, swapping their endianness.
+// As the whole buffer cannot be swapped in place, values are copied and swapped
+// by chunks to a local buffer, each chunk being saved with a single
+// OArchive::SaveBinary call.
+template <typename _Ty>
+inline void SaveSwapped(OArchive& _archive, const _Ty* _array, size_t _count) {
+  const size_t kChunkSize = 1024 / sizeof(_Ty);
+  _Ty chunk[kChunkSize];
+  for (size_t i = 0; i < _count; i += kChunkSize) {
+    const size_t count = _count - i < kChunkSize ? _count - i : kChunkSize;
+    std::memcpy(chunk, _array + i, count * sizeof(_Ty));
+    EndianSwapper<_Ty>::Swap(chunk, count);
+    OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(chunk, count * sizeof(_Ty));
+    assert(size == count * sizeof(_Ty));
+  }
+}
+
 // Specializes Array Save/Load for primitive types.
 #define _OZZ_IO_PRIMITIVE_TYPE(_type)\
 template <>\
 inline void Array<const _type>::Save(OArchive& _archive) const {\
   if (_archive.endian_swap()) {\
-    /* Save element by element as swapping in place the whole buffer is not*/\
-    /* possible.*/\
-    for (size_t i = 0; i < count; ++i) {\
-      _archive << array[i];\
-    }\
+    SaveSwapped(_archive, array, count);\
   } else {\
     OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(array, count * sizeof(_type));\
     assert(size == count * sizeof(_type));\
@@ -327,11 +428,7 @@ inline void Array<const _type>::Save(OArchive& _archive) const {\
 template <>\
 inline void Array<_type>::Save(OArchive& _archive) const {\
   if (_archive.endian_swap()) {\
-    /* Save element by element as swapping in place the whole buffer is not*/\
-    /* possible.*/\
-    for (size_t i = 0; i < count; ++i) {\
-      _archive << array[i];\
-    }\
+    SaveSwapped(_archive, array, count);\
   } else {\
     OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(array, count * sizeof(_type));\
     assert(size == count * sizeof(_type));\
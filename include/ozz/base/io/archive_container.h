@@ -0,0 +1,231 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_IO_ARCHIVE_CONTAINER_H_
+#define OZZ_OZZ_BASE_IO_ARCHIVE_CONTAINER_H_
+
+// Provides containers to save (OContainer) and load (IContainer) many objects
+// of the same type _Ty to/from a single archive.
+// Objects saved with archive << operator each store their tag and version. A
+// container instead stores them once, followed by the number of objects and a
+// table of contents with every object offset. Objects can then be loaded in any
+// order, with a single seek each, or none when they are loaded sequentially.
+// This allows to pack many related objects (like all the animations of a
+// skeleton) in a single file, saving per file open and tag overhead.
+//
+// Container layout is:
+// - _Ty tag and version, if _Ty has any.
+// - uint32_t number of objects n.
+// - uint64_t table of contents of n + 1 offsets, relative to the number of
+// objects position. The last one is the end of the container.
+// - Objects data, each with a checksum section if the archive has checksums.
+//
+// The table of contents is written when the OContainer is destroyed, which
+// requires the output stream to be seekable. Containers can't be nested in
+// another object being saved or loaded.
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace io {
+
+// Saves objects of type _Ty to an OArchive as a container.
+template <typename _Ty>
+class OContainer {
+ public:
+  // Writes container header to _archive, and reserves the table of contents
+  // for _count objects. All _count objects must then be saved before the
+  // container is destroyed.
+  OContainer(OArchive* _archive, int _count)
+      : archive_(_archive),
+        count_(_count) {
+    assert(_count >= 0 && "Invalid number of objects.");
+    assert(archive_->depth_ == 0 && "Containers can't be nested.");
+    internal::Tagger<const _Ty>::Write(*archive_);
+    archive_->SaveVersion<_Ty>();
+
+    Stream* stream = archive_->stream();
+    begin_ = stream->Tell();
+    *archive_ << static_cast<uint32_t>(_count);
+    toc_ = stream->Tell();
+    for (int i = 0; i <= _count; ++i) {
+      *archive_ << static_cast<uint64_t>(0);
+    }
+    offsets_.reserve(_count + 1);
+  }
+
+  // Writes the table of contents, and moves the stream back past the last
+  // object.
+  ~OContainer() {
+    assert(static_cast<int>(offsets_.size()) == count_ &&
+           "All container objects must be saved.");
+    Stream* stream = archive_->stream();
+    const int64_t end = stream->Tell();
+    offsets_.push_back(static_cast<uint64_t>(end - begin_));
+    stream->Seek(toc_, Stream::kSet);
+    for (size_t i = 0; i < offsets_.size(); ++i) {
+      *archive_ << offsets_[i];
+    }
+    stream->Seek(end, Stream::kSet);
+  }
+
+  // Saves the next object of the container.
+  void operator<<(const _Ty& _ty) {
+    assert(static_cast<int>(offsets_.size()) < count_ &&
+           "Too many objects saved to the container.");
+    offsets_.push_back(
+      static_cast<uint64_t>(archive_->stream()->Tell() - begin_));
+    const bool checksummed = archive_->BeginObject();
+    Save(*archive_, &_ty, 1);
+    archive_->EndObject(checksummed);
+  }
+
+  // Returns the number of objects of the container.
+  int count() const {
+    return count_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  OContainer(OContainer const&);
+  void operator=(OContainer const&);
+
+  // The archive objects are saved to.
+  OArchive* archive_;
+
+  // Number of objects, as declared at construction time.
+  int count_;
+
+  // Stream positions of the container and its table of contents.
+  int64_t begin_;
+  int64_t toc_;
+
+  // Offsets of the objects saved so far.
+  ozz::Vector<uint64_t>::Std offsets_;
+};
+
+// Loads objects of type _Ty from a container saved to an IArchive.
+template <typename _Ty>
+class IContainer {
+ public:
+  // Reads container header and table of contents from _archive. The container
+  // is invalid, and has no object, if _archive next content isn't a container
+  // of _Ty.
+  explicit IContainer(IArchive* _archive)
+      : archive_(_archive),
+        version_(0),
+        begin_(0),
+        valid_(false) {
+    assert(archive_->depth_ == 0 && "Containers can't be nested.");
+    if (!internal::Tagger<const _Ty>::Validate(*archive_)) {
+      return;
+    }
+    version_ = archive_->LoadVersion<_Ty>();
+
+    begin_ = archive_->stream()->Tell();
+    uint32_t count;
+    *archive_ >> count;
+    offsets_.resize(count + 1);
+    for (size_t i = 0; i < offsets_.size(); ++i) {
+      *archive_ >> offsets_[i];
+    }
+    valid_ = true;
+  }
+
+  // Returns true if a container of _Ty was read.
+  bool valid() const {
+    return valid_;
+  }
+
+  // Returns the number of objects of the container.
+  int count() const {
+    return valid_ ? static_cast<int>(offsets_.size()) - 1 : 0;
+  }
+
+  // Returns the version of _Ty at the time the container was saved.
+  uint32_t version() const {
+    return version_;
+  }
+
+  // Loads object _index to _ty. The stream is moved to the object first, unless
+  // it's already there (like when objects are loaded sequentially). Returns
+  // false if _index is out of range, or if the object checksum verification
+  // failed (see IArchive::set_verify), in which case _ty isn't loaded.
+  bool Load(int _index, _Ty* _ty) {
+    if (_index < 0 || _index >= count()) {
+      return false;
+    }
+    Stream* stream = archive_->stream();
+    const int64_t position =
+      begin_ + static_cast<int64_t>(offsets_[_index]);
+    if (stream->Tell() != position) {
+      stream->Seek(position, Stream::kSet);
+    }
+    const bool load = archive_->BeginObject();
+    if (load) {
+      ozz::io::Load(*archive_, _ty, 1, version_);
+    }
+    archive_->EndObject();
+    return load;
+  }
+
+  // Moves the stream past the container, so that the following archive
+  // content can be read.
+  void Skip() {
+    if (valid_) {
+      archive_->stream()->Seek(
+        begin_ + static_cast<int64_t>(offsets_.back()), Stream::kSet);
+    }
+  }
+
+ private:
+  // Disables copy and assignation.
+  IContainer(IContainer const&);
+  void operator=(IContainer const&);
+
+  // The archive objects are loaded from.
+  IArchive* archive_;
+
+  // Version of _Ty at the time the container was saved.
+  uint32_t version_;
+
+  // Stream position of the container.
+  int64_t begin_;
+
+  // Table of contents, with container end as last offset.
+  ozz::Vector<uint64_t>::Std offsets_;
+
+  // True if a container of _Ty was read.
+  bool valid_;
+};
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_BASE_IO_ARCHIVE_CONTAINER_H_
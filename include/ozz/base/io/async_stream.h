@@ -0,0 +1,209 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_IO_ASYNC_STREAM_H_
+#define OZZ_OZZ_BASE_IO_ASYNC_STREAM_H_
+
+// Provides asynchronous read streams, so that assets can be loaded without
+// blocking the calling thread, and without dedicated loader threads per file.
+
+#include <cstddef>
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/stream.h"
+
+namespace ozz {
+namespace io {
+
+// Declares an asynchronous read request of size bytes at offset of the stream,
+// to buffer. The request is submitted to an AsyncStream, which owns it until
+// it's completed. Inputs must not be modified while the request is pending.
+struct AsyncReadRequest {
+  // Constructs an empty request.
+  AsyncReadRequest()
+      : offset(0),
+        buffer(NULL),
+        size(0),
+        read(0),
+        state_(kIdle),
+        next_(NULL) {
+  }
+
+  // Offset of the data to read, from the beginning of the stream.
+  int64_t offset;
+
+  // Buffer that receives the data, at least size bytes long.
+  void* buffer;
+
+  // Number of bytes to read.
+  size_t size;
+
+  // Number of bytes actually read, valid once the request is completed.
+  size_t read;
+
+  // Returns true if the completed request read all its bytes.
+  bool succeeded() const {
+    return state_ == kCompleted && read == size;
+  }
+
+  // Internal request state, managed by AsyncStream implementations.
+  enum State {
+    kIdle,
+    kPending,
+    kCompleted,
+  };
+  volatile int state_;
+  AsyncReadRequest* next_;
+};
+
+// Declares the asynchronous read stream interface. Requests are submitted
+// with Submit, then completion is tested with Poll or awaited with Wait.
+// Requests can be submitted from any thread, and many requests can be pending
+// at the same time. They are completed in submission order by ozz backends.
+class AsyncStream {
+ public:
+  // Required virtual destructor. Implementations complete pending requests
+  // before returning.
+  virtual ~AsyncStream() {
+  }
+
+  // Tests whether the stream is opened and can execute requests.
+  virtual bool opened() const = 0;
+
+  // Gets the size of the stream in bytes, or -1 if it's unknown.
+  virtual int64_t size() const = 0;
+
+  // Submits _request for asynchronous execution. _request must not be pending
+  // already, and must remain valid until it's completed.
+  // Returns false if the request cannot be submitted.
+  virtual bool Submit(AsyncReadRequest* _request) = 0;
+
+  // Returns true if _request is completed, without blocking.
+  virtual bool Poll(const AsyncReadRequest& _request) = 0;
+
+  // Blocks until _request is completed, or immediately returns if it's not
+  // pending. Returns true if the request read all its bytes.
+  virtual bool Wait(const AsyncReadRequest& _request) = 0;
+};
+
+// Implements an AsyncStream backend that executes requests on a dedicated I/O
+// thread, reading from a synchronous Stream (a File for example).
+// The decorated stream must be valid for the whole *this stream lifetime, as
+// it's not owned, and must not be accessed directly while it's used by *this
+// stream.
+class ThreadedAsyncStream : public AsyncStream {
+ public:
+  // Constructs an asynchronous stream that reads from _stream, and starts its
+  // I/O thread. Use opened() to test if the thread could be started.
+  explicit ThreadedAsyncStream(Stream* _stream);
+
+  // Completes pending requests and stops the I/O thread.
+  virtual ~ThreadedAsyncStream();
+
+  // See AsyncStream::opened for details.
+  virtual bool opened() const;
+
+  // See AsyncStream::size for details.
+  virtual int64_t size() const;
+
+  // See AsyncStream::Submit for details.
+  virtual bool Submit(AsyncReadRequest* _request);
+
+  // See AsyncStream::Poll for details.
+  virtual bool Poll(const AsyncReadRequest& _request);
+
+  // See AsyncStream::Wait for details.
+  virtual bool Wait(const AsyncReadRequest& _request);
+
+ private:
+  // Disables copy and assignation.
+  ThreadedAsyncStream(ThreadedAsyncStream const&);
+  void operator=(ThreadedAsyncStream const&);
+
+  // Declares platform specific implementation, which also implements the I/O
+  // thread.
+  struct Impl;
+  Impl* impl_;
+
+  // Size of the decorated stream, computed at construction time.
+  int64_t size_;
+};
+
+// Implements a two-phase asynchronous load of a range of an AsyncStream, an
+// asset file or an asset in a pak file for example:
+// - Begin allocates a buffer and submits the read request, then returns
+//   immediately, so the calling thread can do other work. Small headers can
+//   be read first to find out the range of the asset body.
+// - Finalize waits for the read to complete, and returns a stream over the
+//   buffer, from which an IArchive deserializes the asset without any further
+//   blocking I/O.
+// The load can be tested for completion with done() in between.
+class AsyncLoad {
+ public:
+  // Constructs an empty load.
+  AsyncLoad();
+
+  // Waits for the pending read, and deallocates the buffer.
+  ~AsyncLoad();
+
+  // Submits the read of the whole _stream.
+  bool Begin(AsyncStream* _stream);
+
+  // Submits the read of _size bytes at _offset of _stream. Any previous load
+  // is ended first. Returns false if the read couldn't be submitted.
+  bool Begin(AsyncStream* _stream, int64_t _offset, size_t _size);
+
+  // Returns true if the read is completed, or if no read is pending.
+  bool done() const;
+
+  // Waits for the read to complete. Returns a stream over the data that were
+  // read, valid until *this load ends, or NULL if the read failed.
+  Stream* Finalize();
+
+  // Waits for the pending read, and deallocates the buffer.
+  void End();
+
+ private:
+  // Disables copy and assignation.
+  AsyncLoad(AsyncLoad const&);
+  void operator=(AsyncLoad const&);
+
+  // Stream the pending request was submitted to.
+  AsyncStream* stream_;
+
+  // The read request, whose buffer is owned by *this load.
+  AsyncReadRequest request_;
+
+  // Read-only stream over the request buffer, created by Finalize.
+  ReadOnlyMemoryStream* memory_;
+};
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_BASE_IO_ASYNC_STREAM_H_
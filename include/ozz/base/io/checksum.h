@@ -0,0 +1,51 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_IO_CHECKSUM_H_
+#define OZZ_OZZ_BASE_IO_CHECKSUM_H_
+
+// Provides the checksum function used to validate archives integrity.
+
+#include <cstddef>
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+
+// Computes the CRC32C (Castagnoli) checksum of the _size bytes of _data,
+// continuing a previous checksum _crc, so that data can be processed in many
+// calls. The first call must use a _crc of 0.
+// Uses the SSE4.2 crc32 instruction when available, or software slicing-by-8
+// otherwise.
+uint32_t Crc32c(const void* _data, size_t _size, uint32_t _crc = 0);
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_BASE_IO_CHECKSUM_H_
@@ -67,12 +67,13 @@ class Stream {
   };
   // Sets the position indicator associated with the stream to a new position
   // defined by adding _offset to a reference position specified by _origin.
+  // Offsets are 64 bits, so that streams aren't limited to 2GB.
   // Returns a zero value if successful, otherwise returns a non-zero value.
-  virtual int Seek(int _offset, Origin _origin) = 0;
+  virtual int Seek(int64_t _offset, Origin _origin) = 0;
 
   // Returns the current value of the position indicator of the stream.
   // Returns -1 if an error occurs.
-  virtual int Tell() const = 0;
+  virtual int64_t Tell() const = 0;
 
  protected:
 
@@ -109,10 +110,10 @@ class File : public Stream {
   virtual size_t Write(const void* _buffer, size_t _size);
 
   // See Stream::Seek for details.
-  virtual int Seek(int _offset, Origin _origin);
+  virtual int Seek(int64_t _offset, Origin _origin);
 
   // See Stream::Tell for details.
-  virtual int Tell() const;
+  virtual int64_t Tell() const;
 
  private:
   // The CRT file pointer.
@@ -139,10 +140,10 @@ class MemoryStream : public Stream {
   virtual size_t Write(const void* _buffer, size_t _size);
 
   // See Stream::Seek for details.
-  virtual int Seek(int _offset, Origin _origin);
+  virtual int Seek(int64_t _offset, Origin _origin);
 
   // See Stream::Tell for details.
-  virtual int Tell() const;
+  virtual int64_t Tell() const;
 
  private:
 
@@ -170,6 +171,262 @@ class MemoryStream : public Stream {
   // The cursor position in the buffer of data.
   int tell_;
 };
+
+// Implements a read-only Stream over an external memory buffer, like a pak
+// file already loaded in memory or a memory mapped region. The buffer isn't
+// copied nor owned, so it must remain valid for the whole stream lifetime.
+// Offsets are 64 bits, so the buffer isn't limited to 2GB.
+// The opening mode is equivalent to fopen rb (binary read only), writes always
+// fail.
+class ReadOnlyMemoryStream : public Stream {
+ public:
+  // Constructs a stream that reads from the _size bytes of _data. _data can be
+  // NULL only if _size is 0.
+  ReadOnlyMemoryStream(const void* _data, size_t _size);
+
+  // Does nothing, as the buffer isn't owned.
+  virtual ~ReadOnlyMemoryStream();
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // Writing to a read-only stream is an error, always returns 0.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int64_t Tell() const;
+
+  // Returns a pointer to the data at the current position indicator, which
+  // allows to access the buffer without any copy. Returns NULL if the
+  // position indicator is beyond the end of the buffer.
+  const void* current() const;
+
+  // Returns the number of bytes that remain to be read from the current
+  // position indicator.
+  size_t remaining() const;
+
+ private:
+  // Disallow copy and assignment.
+  ReadOnlyMemoryStream(const ReadOnlyMemoryStream&);
+  void operator=(const ReadOnlyMemoryStream&);
+
+  // The external buffer of data.
+  const char* data_;
+
+  // The size of the buffer of data.
+  int64_t size_;
+
+  // The cursor position in the buffer of data. Can be beyond size_.
+  int64_t tell_;
+};
+
+// Implements a buffered Stream decorator, that reduces the number of calls to
+// the decorated stream (and to CRT functions for a File) when reading or
+// writing small amounts of data, like archives do.
+// Reads are performed ahead by blocks of block_size() bytes, and writes are
+// accumulated and flushed by blocks too. Reads or writes bigger than a block
+// bypass the buffer. Seeking inside the current read-ahead block doesn't access
+// the decorated stream.
+// The decorated stream must not be accessed directly while it is used by a
+// BufferedStream, as its position indicator doesn't match BufferedStream one.
+// It's synchronized again when the BufferedStream is flushed or destroyed.
+class BufferedStream : public Stream {
+ public:
+  // Default size of the buffer.
+  static const size_t kDefaultBlockSize;
+
+  // Constructs a buffered stream that decorates _stream, using a buffer of
+  // _block_size bytes. _stream must be valid for the whole *this stream
+  // lifetime, as it's not owned by the BufferedStream.
+  explicit BufferedStream(Stream* _stream,
+                          size_t _block_size = kDefaultBlockSize);
+
+  // Flushes pending writes, and deallocates the buffer.
+  virtual ~BufferedStream();
+
+  // Writes pending data to the decorated stream, and discards read-ahead
+  // data, so that decorated stream position indicator matches *this one.
+  // Returns false if pending data couldn't be written or if decorated stream
+  // position couldn't be restored.
+  bool Flush();
+
+  // Gets the size of the buffer.
+  size_t block_size() const {
+    return block_size_;
+  }
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // See Stream::Write for details.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int64_t Tell() const;
+
+ private:
+
+  // Disables copy and assignation.
+  BufferedStream(BufferedStream const&);
+  void operator=(BufferedStream const&);
+
+  // The decorated stream.
+  Stream* stream_;
+
+  // The buffer of block_size_ bytes.
+  char* buffer_;
+
+  // The size of the buffer.
+  size_t block_size_;
+
+  // The cursor position in the buffer. While writing, this is also the number
+  // of pending bytes.
+  size_t cursor_;
+
+  // The number of read-ahead bytes in the buffer, 0 while writing.
+  size_t end_;
+
+  // Buffer holds data to write if true, read-ahead data otherwise.
+  bool writing_;
+};
+
+// Implements a compressing Stream decorator, that reduces the size of the data
+// written to the decorated stream, typically a File.
+// Data are split in blocks of block_size() bytes, that are compressed
+// independently using LZ4 block format. Blocks that don't compress are stored
+// as is. A seek table of block sizes is written after the blocks, so that Seek
+// and Tell keep working on uncompressed positions while reading: reading from
+// a new position only fetches and decompresses the block containing it.
+// A CompressedStream is opened either for writing or for reading. Writes are
+// sequential, so seeking while writing only succeeds if the position indicator
+// doesn't change. Compressed data are finalized by Close(), or when the
+// CompressedStream is destroyed.
+// The decorated stream must be seekable, and must not be accessed directly
+// while it is used by a CompressedStream.
+class CompressedStream : public Stream {
+ public:
+  // Default size of uncompressed blocks.
+  static const size_t kDefaultBlockSize;
+
+  // Defines stream opening modes.
+  enum Mode {
+    kRead,  // Decompresses data from the decorated stream.
+    kWrite,  // Compresses data to the decorated stream.
+  };
+
+  // Tests whether _stream content at its current position starts with a
+  // compressed stream header. _stream position indicator is restored.
+  static bool IsCompressed(Stream* _stream);
+
+  // Constructs a compressed stream that decorates _stream, starting at its
+  // current position. _stream must be valid for the whole *this stream
+  // lifetime, as it's not owned by the CompressedStream.
+  // _block_size is only used while writing, as it's read back from the
+  // stream header while reading.
+  // Use opened() to test opening result, which fails if _stream isn't opened,
+  // or while reading if _stream doesn't contain a valid compressed stream. In
+  // this later case _stream position indicator is restored.
+  CompressedStream(Stream* _stream,
+                   Mode _mode,
+                   size_t _block_size = kDefaultBlockSize);
+
+  // Closes the stream, see Close().
+  virtual ~CompressedStream();
+
+  // Compresses and writes pending data, seek table and header to the
+  // decorated stream if writing, and deallocates buffers. The decorated
+  // stream position indicator is left at the end of the compressed data.
+  // Returns false if compressed data couldn't be written.
+  bool Close();
+
+  // Gets the uncompressed size of the blocks.
+  size_t block_size() const {
+    return block_size_;
+  }
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // See Stream::Write for details.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int64_t Tell() const;
+
+ private:
+
+  // Disables copy and assignation.
+  CompressedStream(CompressedStream const&);
+  void operator=(CompressedStream const&);
+
+  // Reads header and seek table. Returns false if they aren't valid.
+  bool OpenRead();
+
+  // Fetches and decompresses block _block to the block buffer.
+  bool LoadBlock(size_t _block);
+
+  // Compresses and writes the block buffer.
+  bool FlushBlock();
+
+  // The decorated stream.
+  Stream* stream_;
+
+  // Opening mode.
+  Mode mode_;
+
+  // The uncompressed size of the blocks.
+  size_t block_size_;
+
+  // Position of the header in the decorated stream.
+  int64_t origin_;
+
+  // Buffer of block_size_ bytes for uncompressed block data.
+  char* block_;
+
+  // Buffer for compressed block data.
+  char* compressed_;
+
+  // Seek table. While reading, it stores num_blocks_ + 1 offsets of the blocks
+  // from origin_. While writing, it stores compressed blocks sizes.
+  uint64_t* table_;
+
+  // Number of blocks, and capacity of the seek table while writing.
+  size_t num_blocks_;
+  size_t table_capacity_;
+
+  // Index of the block stored in block_ buffer while reading.
+  size_t loaded_block_;
+
+  // Number of bytes in block_ buffer while writing.
+  size_t pending_;
+
+  // Uncompressed size of the stream.
+  int64_t size_;
+
+  // Uncompressed position indicator.
+  int64_t position_;
+
+  // Opening state.
+  bool opened_;
+};
 }  // io
 }  // ozz
 #endif  // OZZ_OZZ_BASE_IO_STREAM_H_
@@ -0,0 +1,87 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_COMPACT_SOA_TRANSFORM_H_
+#define OZZ_OZZ_BASE_MATHS_COMPACT_SOA_TRANSFORM_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+
+struct SoaTransform;
+
+// Stores 4 transforms, like SoaTransform, in 76 bytes instead of 160. It's
+// meant for poses that are stored rather than processed, like pose histories
+// used for inertialization, replays or network replication.
+// Translations and scales are half precision floats. Rotations are smallest
+// three compressed: the largest component of the normalized quaternion is
+// dropped, and the 3 remaining ones, in range [-1/√2:1/√2], are pre-multiplied
+// by √2 and quantized to signed 16 bits integers. The dropped component is
+// restored from the unit length of the quaternion, its index and sign being
+// stored on 3 bits. Quaternions aren't negated, so packing preserves rotation
+// hemisphere which blending relies on.
+// Components are stored in soa layout: the first index is the component and
+// the second one the lane.
+struct CompactSoaTransform {
+  // Half precision translation, x, y and z components.
+  uint16_t translation[3][4];
+
+  // Smallest three rotation components, in x, y, z, w order once the largest
+  // component is dropped.
+  int16_t rotation[3][4];
+
+  // Half precision scale, x, y and z components.
+  uint16_t scale[3][4];
+
+  // Per lane index of the rotation dropped component (bits 0 and 1), and sign
+  // of this component (bit 2, set if positive).
+  uint8_t largest[4];
+};
+
+// Defines the factor applied to the smallest three components of a rotation
+// before they are quantized to CompactSoaTransform values.
+const float kCompactRotationScale = 1.41421356f * 32767.f;
+
+// Packs the _input.Count() soa transforms of _input to _output.
+// Rotations must be normalized.
+// Returns false if _output is smaller than _input, in which case nothing is
+// packed.
+bool Pack(const Range<const SoaTransform>& _input,
+          const Range<CompactSoaTransform>& _output);
+
+// Unpacks the _input.Count() compact transforms of _input to _output.
+// Returns false if _output is smaller than _input, in which case nothing is
+// unpacked.
+bool Unpack(const Range<const CompactSoaTransform>& _input,
+            const Range<SoaTransform>& _output);
+}  // math
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MATHS_COMPACT_SOA_TRANSFORM_H_
@@ -0,0 +1,158 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_DUAL_QUATERNION_H_
+#define OZZ_OZZ_BASE_MATHS_DUAL_QUATERNION_H_
+
+// Provides unit dual quaternions, which represent rigid transformations
+// (rotation and translation, but no scale) in 8 floats, ie 32 bytes compared
+// to the 64 bytes of a Float4x4. Dual quaternions are used for skinning, as
+// their blending doesn't suffer from the volume loss (aka candy-wrapper effect)
+// of matrix blending.
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace math {
+
+// Declares a dual quaternion made of two SimdFloat4 quaternions, with x, y,
+// z and w components.
+struct DualQuaternion {
+  // The real part, which is the rotation quaternion.
+  SimdFloat4 real;
+
+  // The dual part, which is 1/2 * translation * real.
+  SimdFloat4 dual;
+
+  // Returns the identity dual quaternion.
+  static OZZ_INLINE DualQuaternion identity() {
+    const DualQuaternion ret = {simd_float4::w_axis(), simd_float4::zero()};
+    return ret;
+  }
+
+  // Builds a dual quaternion from translation x, y, z components of
+  // _translation and normalized rotation quaternion _rotation.
+  static OZZ_INLINE DualQuaternion FromAffine(_SimdFloat4 _translation,
+                                              _SimdFloat4 _rotation);
+};
+
+namespace internal {
+// Returns the product of quaternions _a and _b, stored in x, y, z and w
+// components.
+OZZ_INLINE SimdFloat4 QuaternionMultiply(_SimdFloat4 _a, _SimdFloat4 _b) {
+  const SimdFloat4 aw = SplatW(_a);
+  const SimdFloat4 bw = SplatW(_b);
+  const SimdFloat4 xyz = MAdd(aw, _b, MAdd(bw, _a, Cross3(_a, _b)));
+  const SimdFloat4 w = aw * bw - SplatX(Dot3(_a, _b));
+  return Select(simd_int4::mask_fff0(), xyz, w);
+}
+
+// Returns the conjugate of quaternion _q.
+OZZ_INLINE SimdFloat4 QuaternionConjugate(_SimdFloat4 _q) {
+  return Xor(_q, And(simd_int4::mask_sign(), simd_int4::mask_fff0()));
+}
+}  // internal
+
+OZZ_INLINE DualQuaternion DualQuaternion::FromAffine(_SimdFloat4 _translation,
+                                                     _SimdFloat4 _rotation) {
+  const SimdFloat4 t = And(_translation, simd_int4::mask_fff0());
+  const DualQuaternion ret = {
+    _rotation,
+    internal::QuaternionMultiply(t, _rotation) * simd_float4::Load1(.5f)};
+  return ret;
+}
+
+// Returns the conjugate of unit dual quaternion _dq, which is also its inverse.
+OZZ_INLINE DualQuaternion Conjugate(const DualQuaternion& _dq) {
+  const DualQuaternion ret = {internal::QuaternionConjugate(_dq.real),
+                              internal::QuaternionConjugate(_dq.dual)};
+  return ret;
+}
+
+// Returns the translation of unit dual quaternion _dq, in x, y and z
+// components. w is set to 0.
+OZZ_INLINE SimdFloat4 GetTranslation(const DualQuaternion& _dq) {
+  const SimdFloat4 t =
+    internal::QuaternionMultiply(_dq.dual,
+                                  internal::QuaternionConjugate(_dq.real));
+  return And(t + t, simd_int4::mask_fff0());
+}
+
+// Transforms vector _v with unit dual quaternion _dq. Only the rotation is
+// applied. The w component of the returned vector is undefined.
+OZZ_INLINE SimdFloat4 TransformVector(const DualQuaternion& _dq,
+                                      _SimdFloat4 _v) {
+  // v' = v + 2w(u x v) + 2u x (u x v), with u = real.xyz and w = real.w.
+  const SimdFloat4 c = Cross3(_dq.real, _v);
+  const SimdFloat4 t = c + c;
+  return MAdd(SplatW(_dq.real), t, _v + Cross3(_dq.real, t));
+}
+
+// Transforms point _p with unit dual quaternion _dq. The w component of the
+// returned point is undefined.
+OZZ_INLINE SimdFloat4 TransformPoint(const DualQuaternion& _dq,
+                                     _SimdFloat4 _p) {
+  // t = 2 * (real.w * dual.xyz - dual.w * real.xyz + real.xyz x dual.xyz)
+  const SimdFloat4 t = MAdd(SplatW(_dq.real), _dq.dual,
+                            Cross3(_dq.real, _dq.dual)) -
+                       SplatW(_dq.dual) * _dq.real;
+  return TransformVector(_dq, _p) + t + t;
+}
+
+// Converts the 4 transforms of soa transform _transform to dual quaternions
+// _out. Scale is ignored, as dual quaternions can't represent it. Rotations
+// must be normalized.
+OZZ_INLINE void FromSoaTransform(const SoaTransform& _transform,
+                                 DualQuaternion _out[4]) {
+  SimdFloat4 translations[4];
+  Transpose3x4(&_transform.translation.x, translations);
+  SimdFloat4 rotations[4];
+  Transpose4x4(&_transform.rotation.x, rotations);
+  for (int i = 0; i < 4; ++i) {
+    _out[i] = DualQuaternion::FromAffine(translations[i], rotations[i]);
+  }
+}
+}  // math
+}  // ozz
+
+// Returns the composition of dual quaternions _a and _b, which transforms by
+// _b first and then by _a.
+OZZ_INLINE ozz::math::DualQuaternion operator*(
+  const ozz::math::DualQuaternion& _a, const ozz::math::DualQuaternion& _b) {
+  using ozz::math::internal::QuaternionMultiply;
+  const ozz::math::DualQuaternion ret = {
+    QuaternionMultiply(_a.real, _b.real),
+    QuaternionMultiply(_a.real, _b.dual) +
+      QuaternionMultiply(_a.dual, _b.real)};
+  return ret;
+}
+#endif  // OZZ_OZZ_BASE_MATHS_DUAL_QUATERNION_H_
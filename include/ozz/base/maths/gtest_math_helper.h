@@ -160,6 +160,18 @@ do {\
   IMPL_EXPECT_SIMDFLOAT_EQ(expected.cols[3], _w0, _w1, _w2, _w3);\
 } while(void(0), 0)
 
+// Macro for testing ozz::math::Float4x3 rows with x, y, z, w float values.
+#define EXPECT_FLOAT4x3_EQ(_expected, _x0, _y0, _z0, _w0,\
+                                      _x1, _y1, _z1, _w1,\
+                                      _x2, _y2, _z2, _w2)\
+do {\
+  SCOPED_TRACE("");\
+  const ozz::math::Float4x3 expected(_expected);\
+  IMPL_EXPECT_SIMDFLOAT_EQ(expected.rows[0], _x0, _y0, _z0, _w0);\
+  IMPL_EXPECT_SIMDFLOAT_EQ(expected.rows[1], _x1, _y1, _z1, _w1);\
+  IMPL_EXPECT_SIMDFLOAT_EQ(expected.rows[2], _x2, _y2, _z2, _w2);\
+} while(void(0), 0)
+
 // Macro for testing ozz::math::SoaFloat4 members with x, y, z, w float values.
 #define EXPECT_SOAFLOAT4_EQ(_expected, _x0, _x1, _x2, _x3,\
                                        _y0, _y1, _y2, _y3,\
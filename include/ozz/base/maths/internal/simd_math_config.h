@@ -33,6 +33,28 @@
 
 #include "ozz/base/platform.h"
 
+// F16C half-precision conversions are detected first, as they imply AVX.
+// MSVC doesn't define __F16C__, but every AVX2 processor supports F16C.
+#if defined(__F16C__) || defined(OZZ_HAS_F16C) || \
+    (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#ifndef OZZ_HAS_F16C
+#define OZZ_HAS_F16C
+#endif  // OZZ_HAS_F16C
+#define OZZ_HAS_AVX
+#endif
+
+// FMA3 fused multiply-add instructions imply AVX. MSVC doesn't define __FMA__,
+// but every AVX2 processor supports FMA3.
+#if defined(__FMA__) || defined(OZZ_HAS_FMA) || \
+    (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#ifndef OZZ_HAS_FMA
+#define OZZ_HAS_FMA
+#endif  // OZZ_HAS_FMA
+#define OZZ_HAS_AVX
+#endif
+
 // Try to match a SSE version
 #if defined(__AVX__)  || defined(OZZ_HAS_AVX)
 #include <immintrin.h>
@@ -100,6 +122,33 @@ typedef const __m128i _SimdInt4;
 }  // math
 }  // ozz
 
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(OZZ_HAS_NEON)
+#if defined(_M_ARM64)
+#include <arm64_neon.h>
+#else  // _M_ARM64
+#include <arm_neon.h>
+#endif  // _M_ARM64
+#ifndef OZZ_HAS_NEON
+#define OZZ_HAS_NEON
+#endif  // OZZ_HAS_NEON
+
+namespace ozz {
+namespace math {
+
+// Vector of four floating point values.
+typedef float32x4_t SimdFloat4;
+
+// Argument type for Float4.
+typedef const float32x4_t _SimdFloat4;
+
+// Vector of four integer values.
+typedef int32x4_t SimdInt4;
+
+// Argument type for Int4.
+typedef const int32x4_t _SimdInt4;
+}  // math
+}  // ozz
+
 #else  // OZZ_HAS_x
 
 // No simd instruction set detected, switch back to reference implementation.
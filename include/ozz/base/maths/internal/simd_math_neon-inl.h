@@ -0,0 +1,1775 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
+#define OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
+
+#include <cassert>
+#include <stdint.h>
+
+// Temporarly needed while trigonometric functions aren't implemented.
+#include <cmath>
+
+#include "ozz/base/maths/math_constant.h"
+
+// AArch64 provides native float division, square root and rounding
+// conversions, which must be emulated on ARMv7 NEON.
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define OZZ_NEON_A64
+#endif  // __aarch64__ || _M_ARM64
+
+namespace ozz {
+namespace math {
+
+namespace simd_float4 {
+
+// Internal macros.
+// Unused components of the result vector are replicated from the first input
+// argument.
+
+#define OZZ_NEON_SPLAT_F(_v, _i)\
+  vdupq_lane_f32(((_i) < 2 ? vget_low_f32(_v) : vget_high_f32(_v)), (_i) & 1)
+
+// _v.x + _v.y
+#define OZZ_NEON_HADD2_F(_v)\
+  vget_lane_f32(vpadd_f32(vget_low_f32(_v), vget_low_f32(_v)), 0)
+
+// _v.x + _v.z + _v.y, summed in the same order as the SSE implementation.
+#define OZZ_NEON_HADD3_F(_v)\
+  ((vgetq_lane_f32(_v, 0) + vgetq_lane_f32(_v, 2)) + vgetq_lane_f32(_v, 1))
+
+// _v.x + _v.y + _v.z + _v.w
+#define OZZ_NEON_HADD4_F(_v)\
+  vget_lane_f32(vpadd_f32(vadd_f32(vget_low_f32(_v), vget_high_f32(_v)),\
+                          vadd_f32(vget_low_f32(_v), vget_high_f32(_v))), 0)
+
+// dot2
+#define OZZ_NEON_DOT2_F(_a, _b)\
+  OZZ_NEON_HADD2_F(vmulq_f32(_a, _b))
+
+// dot3
+#define OZZ_NEON_DOT3_F(_a, _b)\
+  OZZ_NEON_HADD3_F(vmulq_f32(_a, _b))
+
+// dot4
+#define OZZ_NEON_DOT4_F(_a, _b)\
+  OZZ_NEON_HADD4_F(vmulq_f32(_a, _b))
+
+// _v.y, _v.z, _v.x, _v.w
+#define OZZ_NEON_YZXW_F(_v)\
+  vcombine_f32(vget_low_f32(vextq_f32(_v, _v, 1)),\
+               vrev64_f32(vget_high_f32(vextq_f32(_v, _v, 1))))
+
+#define OZZ_NEON_SELECT_F(_b, _true, _false)\
+  vbslq_f32(vreinterpretq_u32_s32(_b), _true, _false)
+
+// _a + _b * _c and _a - _b * _c. AArch64 compilers emit fused instructions for
+// vmlaq/vmlsq, which deterministic builds avoid as other implementations round
+// the intermediate product.
+#ifdef OZZ_HAS_DETERMINISM
+#define OZZ_NEON_MLA_F(_a, _b, _c) vaddq_f32(_a, vmulq_f32(_b, _c))
+#define OZZ_NEON_MLS_F(_a, _b, _c) vsubq_f32(_a, vmulq_f32(_b, _c))
+#define OZZ_NEON_MLA_LANE_F(_a, _b, _c, _l)\
+  vaddq_f32(_a, vmulq_lane_f32(_b, _c, _l))
+#else  // OZZ_HAS_DETERMINISM
+#define OZZ_NEON_MLA_F(_a, _b, _c) vmlaq_f32(_a, _b, _c)
+#define OZZ_NEON_MLS_F(_a, _b, _c) vmlsq_f32(_a, _b, _c)
+#define OZZ_NEON_MLA_LANE_F(_a, _b, _c, _l) vmlaq_lane_f32(_a, _b, _c, _l)
+#endif  // OZZ_HAS_DETERMINISM
+
+#define OZZ_NEON_SPLAT_I(_v, _i)\
+  vdupq_lane_s32(((_i) < 2 ? vget_low_s32(_v) : vget_high_s32(_v)), (_i) & 1)
+
+#define OZZ_NEON_SELECT_I(_b, _true, _false)\
+  vbslq_s32(vreinterpretq_u32_s32(_b), _true, _false)
+
+OZZ_INLINE SimdFloat4 zero() {
+  return vdupq_n_f32(0.f);
+}
+
+OZZ_INLINE SimdFloat4 one() {
+  return vdupq_n_f32(1.f);
+}
+
+OZZ_INLINE SimdFloat4 x_axis() {
+  return vsetq_lane_f32(1.f, vdupq_n_f32(0.f), 0);
+}
+
+OZZ_INLINE SimdFloat4 y_axis() {
+  return vsetq_lane_f32(1.f, vdupq_n_f32(0.f), 1);
+}
+
+OZZ_INLINE SimdFloat4 z_axis() {
+  return vsetq_lane_f32(1.f, vdupq_n_f32(0.f), 2);
+}
+
+OZZ_INLINE SimdFloat4 w_axis() {
+  return vsetq_lane_f32(1.f, vdupq_n_f32(0.f), 3);
+}
+
+OZZ_INLINE SimdFloat4 Load(float _x, float _y, float _z, float _w) {
+  const float f[4] = {_x, _y, _z, _w};
+  return vld1q_f32(f);
+}
+
+OZZ_INLINE SimdFloat4 LoadX(float _x) {
+  return vsetq_lane_f32(_x, vdupq_n_f32(0.f), 0);
+}
+
+OZZ_INLINE SimdFloat4 Load1(float _x) {
+  return vdupq_n_f32(_x);
+}
+
+OZZ_INLINE SimdFloat4 LoadPtr(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  return vld1q_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 LoadPtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 LoadXPtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_lane_f32(_f, vdupq_n_f32(0.f), 0);
+}
+
+OZZ_INLINE SimdFloat4 Load1PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_dup_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 Load2PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vcombine_f32(vld1_f32(_f), vdup_n_f32(0.f));
+}
+
+OZZ_INLINE SimdFloat4 Load3PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vcombine_f32(vld1_f32(_f), vld1_lane_f32(_f + 2, vdup_n_f32(0.f), 0));
+}
+
+OZZ_INLINE SimdFloat4 FromInt(_SimdInt4 _i) {
+  return vcvtq_f32_s32(_i);
+}
+}  // ozz::math::simd_float4
+
+OZZ_INLINE float GetX(_SimdFloat4 _v) {
+  return vgetq_lane_f32(_v, 0);
+}
+
+OZZ_INLINE float GetY(_SimdFloat4 _v) {
+  return vgetq_lane_f32(_v, 1);
+}
+
+OZZ_INLINE float GetZ(_SimdFloat4 _v) {
+  return vgetq_lane_f32(_v, 2);
+}
+
+OZZ_INLINE float GetW(_SimdFloat4 _v) {
+  return vgetq_lane_f32(_v, 3);
+}
+
+OZZ_INLINE SimdFloat4 SetX(_SimdFloat4 _v, float _f) {
+  return vsetq_lane_f32(_f, _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 SetY(_SimdFloat4 _v, float _f) {
+  return vsetq_lane_f32(_f, _v, 1);
+}
+
+OZZ_INLINE SimdFloat4 SetZ(_SimdFloat4 _v, float _f) {
+  return vsetq_lane_f32(_f, _v, 2);
+}
+
+OZZ_INLINE SimdFloat4 SetW(_SimdFloat4 _v, float _f) {
+  return vsetq_lane_f32(_f, _v, 3);
+}
+
+OZZ_INLINE SimdFloat4 SetI(_SimdFloat4 _v, int _ith, float _f) {
+  assert(_ith >= 0 && _ith <= 3 && "Invalid index ranges");
+  union {
+    SimdFloat4 ret;
+    float af[4];
+  } u = {_v};
+  u.af[_ith] = _f;
+  return u.ret;
+}
+
+OZZ_INLINE void StorePtr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1q_f32(_f, _v);
+}
+
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  StorePtr(_v, _f);
+}
+
+OZZ_INLINE void StreamFence() {
+}
+
+OZZ_INLINE void Store1Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1q_lane_f32(_f, _v, 0);
+}
+
+OZZ_INLINE void Store2Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+}
+
+OZZ_INLINE void Store3Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+  vst1q_lane_f32(_f + 2, _v, 2);
+}
+
+OZZ_INLINE void StorePtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1q_f32(_f, _v);
+}
+
+OZZ_INLINE void Store1PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1q_lane_f32(_f, _v, 0);
+}
+
+OZZ_INLINE void Store2PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+}
+
+OZZ_INLINE void Store3PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+  vst1q_lane_f32(_f + 2, _v, 2);
+}
+
+OZZ_INLINE SimdFloat4 SplatX(_SimdFloat4 _v) {
+  return OZZ_NEON_SPLAT_F(_v, 0);
+}
+
+OZZ_INLINE SimdFloat4 SplatY(_SimdFloat4 _v) {
+  return OZZ_NEON_SPLAT_F(_v, 1);
+}
+
+OZZ_INLINE SimdFloat4 SplatZ(_SimdFloat4 _v) {
+  return OZZ_NEON_SPLAT_F(_v, 2);
+}
+
+OZZ_INLINE SimdFloat4 SplatW(_SimdFloat4 _v) {
+  return OZZ_NEON_SPLAT_F(_v, 3);
+}
+
+OZZ_INLINE void Transpose4x1(const SimdFloat4 _in[4], SimdFloat4 _out[1]) {
+  const float32x4_t xz = vzipq_f32(_in[0], _in[2]).val[0];
+  const float32x4_t yw = vzipq_f32(_in[1], _in[3]).val[0];
+  _out[0] = vzipq_f32(xz, yw).val[0];
+}
+
+OZZ_INLINE void Transpose1x4(const SimdFloat4 _in[1], SimdFloat4 _out[4]) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  _out[0] = vsetq_lane_f32(vgetq_lane_f32(_in[0], 0), zero, 0);
+  _out[1] = vsetq_lane_f32(vgetq_lane_f32(_in[0], 1), zero, 0);
+  _out[2] = vsetq_lane_f32(vgetq_lane_f32(_in[0], 2), zero, 0);
+  _out[3] = vsetq_lane_f32(vgetq_lane_f32(_in[0], 3), zero, 0);
+}
+
+OZZ_INLINE void Transpose4x2(const SimdFloat4 _in[4], SimdFloat4 _out[2]) {
+  const float32x4_t tmp0 = vzipq_f32(_in[0], _in[2]).val[0];
+  const float32x4_t tmp1 = vzipq_f32(_in[1], _in[3]).val[0];
+  const float32x4x2_t res = vzipq_f32(tmp0, tmp1);
+  _out[0] = res.val[0];
+  _out[1] = res.val[1];
+}
+
+OZZ_INLINE void Transpose2x4(const SimdFloat4 _in[2], SimdFloat4 _out[4]) {
+  const float32x4x2_t tmp = vzipq_f32(_in[0], _in[1]);
+  const float32x2_t zero = vdup_n_f32(0.f);
+  _out[0] = vcombine_f32(vget_low_f32(tmp.val[0]), zero);
+  _out[1] = vcombine_f32(vget_high_f32(tmp.val[0]), zero);
+  _out[2] = vcombine_f32(vget_low_f32(tmp.val[1]), zero);
+  _out[3] = vcombine_f32(vget_high_f32(tmp.val[1]), zero);
+}
+
+OZZ_INLINE void Transpose4x3(
+  const SimdFloat4 _in[4], SimdFloat4 _out[3]) {
+  const float32x4x2_t tmp02 = vzipq_f32(_in[0], _in[2]);
+  const float32x4x2_t tmp13 = vzipq_f32(_in[1], _in[3]);
+  const float32x4x2_t res01 = vzipq_f32(tmp02.val[0], tmp13.val[0]);
+  _out[0] = res01.val[0];
+  _out[1] = res01.val[1];
+  _out[2] = vzipq_f32(tmp02.val[1], tmp13.val[1]).val[0];
+}
+
+OZZ_INLINE void Transpose3x4(const SimdFloat4 _in[3], SimdFloat4 _out[4]) {
+  const float32x4x2_t tmp01 = vzipq_f32(_in[0], _in[1]);
+  const float32x4x2_t tmp2z = vzipq_f32(_in[2], vdupq_n_f32(0.f));
+  _out[0] = vcombine_f32(vget_low_f32(tmp01.val[0]),
+                         vget_low_f32(tmp2z.val[0]));
+  _out[1] = vcombine_f32(vget_high_f32(tmp01.val[0]),
+                         vget_high_f32(tmp2z.val[0]));
+  _out[2] = vcombine_f32(vget_low_f32(tmp01.val[1]),
+                         vget_low_f32(tmp2z.val[1]));
+  _out[3] = vcombine_f32(vget_high_f32(tmp01.val[1]),
+                         vget_high_f32(tmp2z.val[1]));
+}
+
+OZZ_INLINE void Transpose4x4(const SimdFloat4 _in[4], SimdFloat4 _out[4]) {
+  const float32x4x2_t tmp02 = vzipq_f32(_in[0], _in[2]);
+  const float32x4x2_t tmp13 = vzipq_f32(_in[1], _in[3]);
+  const float32x4x2_t res01 = vzipq_f32(tmp02.val[0], tmp13.val[0]);
+  const float32x4x2_t res23 = vzipq_f32(tmp02.val[1], tmp13.val[1]);
+  _out[0] = res01.val[0];
+  _out[1] = res01.val[1];
+  _out[2] = res23.val[0];
+  _out[3] = res23.val[1];
+}
+
+OZZ_INLINE void Transpose16x16(const SimdFloat4 _in[16], SimdFloat4 _out[16]) {
+  const float32x4x2_t tmp0 = vzipq_f32(_in[0], _in[2]);
+  const float32x4x2_t tmp1 = vzipq_f32(_in[1], _in[3]);
+  const float32x4x2_t tmp2 = vzipq_f32(_in[4], _in[6]);
+  const float32x4x2_t tmp3 = vzipq_f32(_in[5], _in[7]);
+  const float32x4x2_t tmp4 = vzipq_f32(_in[8], _in[10]);
+  const float32x4x2_t tmp5 = vzipq_f32(_in[9], _in[11]);
+  const float32x4x2_t tmp6 = vzipq_f32(_in[12], _in[14]);
+  const float32x4x2_t tmp7 = vzipq_f32(_in[13], _in[15]);
+  const float32x4x2_t res0 = vzipq_f32(tmp0.val[0], tmp1.val[0]);
+  const float32x4x2_t res1 = vzipq_f32(tmp2.val[0], tmp3.val[0]);
+  const float32x4x2_t res2 = vzipq_f32(tmp4.val[0], tmp5.val[0]);
+  const float32x4x2_t res3 = vzipq_f32(tmp6.val[0], tmp7.val[0]);
+  const float32x4x2_t res4 = vzipq_f32(tmp0.val[1], tmp1.val[1]);
+  const float32x4x2_t res5 = vzipq_f32(tmp2.val[1], tmp3.val[1]);
+  const float32x4x2_t res6 = vzipq_f32(tmp4.val[1], tmp5.val[1]);
+  const float32x4x2_t res7 = vzipq_f32(tmp6.val[1], tmp7.val[1]);
+  _out[0] = res0.val[0];
+  _out[1] = res1.val[0];
+  _out[2] = res2.val[0];
+  _out[3] = res3.val[0];
+  _out[4] = res0.val[1];
+  _out[5] = res1.val[1];
+  _out[6] = res2.val[1];
+  _out[7] = res3.val[1];
+  _out[8] = res4.val[0];
+  _out[9] = res5.val[0];
+  _out[10] = res6.val[0];
+  _out[11] = res7.val[0];
+  _out[12] = res4.val[1];
+  _out[13] = res5.val[1];
+  _out[14] = res6.val[1];
+  _out[15] = res7.val[1];
+}
+
+OZZ_INLINE SimdFloat4 MAdd(
+  _SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _addend) {
+  return OZZ_NEON_MLA_F(_addend, _a, _b);
+}
+
+OZZ_INLINE SimdFloat4 DivX(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vsetq_lane_f32(vgetq_lane_f32(_a, 0) / vgetq_lane_f32(_b, 0), _a, 0);
+}
+
+OZZ_INLINE SimdFloat4 HAdd2(_SimdFloat4 _v) {
+  return vsetq_lane_f32(OZZ_NEON_HADD2_F(_v), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 HAdd3(_SimdFloat4 _v) {
+  return vsetq_lane_f32(OZZ_NEON_HADD3_F(_v), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 HAdd4(_SimdFloat4 _v) {
+  return vsetq_lane_f32(OZZ_NEON_HADD4_F(_v), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Dot2(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vsetq_lane_f32(OZZ_NEON_DOT2_F(_a, _b), _a, 0);
+}
+
+OZZ_INLINE SimdFloat4 Dot3(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vsetq_lane_f32(OZZ_NEON_DOT3_F(_a, _b), _a, 0);
+}
+
+OZZ_INLINE SimdFloat4 Dot4(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vsetq_lane_f32(OZZ_NEON_DOT4_F(_a, _b), _a, 0);
+}
+
+OZZ_INLINE SimdFloat4 Cross3(_SimdFloat4 _a, _SimdFloat4 _b) {
+  // Computes (_a * _b.yzx - _a.yzx * _b).yzx, which requires only one
+  // permutation type.
+  const float32x4_t a_yzxw = OZZ_NEON_YZXW_F(_a);
+  const float32x4_t b_yzxw = OZZ_NEON_YZXW_F(_b);
+  const float32x4_t c = OZZ_NEON_MLS_F(vmulq_f32(_a, b_yzxw), a_yzxw, _b);
+  return OZZ_NEON_YZXW_F(c);
+}
+
+#ifdef OZZ_HAS_DETERMINISM
+// Deterministic builds use correctly rounded divisions, so that results match
+// bit for bit the SSE and reference implementations.
+OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) {
+#if defined(OZZ_NEON_A64)
+  return vdivq_f32(vdupq_n_f32(1.f), _v);
+#else  // OZZ_NEON_A64
+  const float f[4] = {1.f / vgetq_lane_f32(_v, 0),
+                      1.f / vgetq_lane_f32(_v, 1),
+                      1.f / vgetq_lane_f32(_v, 2),
+                      1.f / vgetq_lane_f32(_v, 3)};
+  return vld1q_f32(f);
+#endif  // OZZ_NEON_A64
+}
+
+OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) {
+  return RcpEst(_v);
+}
+#else  // OZZ_HAS_DETERMINISM
+// Note that NEON reciprocal estimates are only 8 bits precise, compared to 12
+// bits for SSE. One Newton-Raphson step is thus always added to the estimation,
+// so that precision matches other implementations.
+OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) {
+  const float32x4_t est = vrecpeq_f32(_v);
+  return vmulq_f32(vrecpsq_f32(_v, est), est);
+}
+
+OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) {
+  const float32x4_t est = RcpEst(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  return vmulq_f32(vrecpsq_f32(_v, est), est);
+}
+#endif  // OZZ_HAS_DETERMINISM
+
+OZZ_INLINE SimdFloat4 RcpEstX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vgetq_lane_f32(RcpEst(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Sqrt(_SimdFloat4 _v) {
+#if defined(OZZ_NEON_A64)
+  return vsqrtq_f32(_v);
+#else  // OZZ_NEON_A64
+  const float f[4] = {std::sqrt(vgetq_lane_f32(_v, 0)),
+                      std::sqrt(vgetq_lane_f32(_v, 1)),
+                      std::sqrt(vgetq_lane_f32(_v, 2)),
+                      std::sqrt(vgetq_lane_f32(_v, 3))};
+  return vld1q_f32(f);
+#endif  // OZZ_NEON_A64
+}
+
+OZZ_INLINE SimdFloat4 SqrtX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::sqrt(vgetq_lane_f32(_v, 0)), _v, 0);
+}
+
+#ifdef OZZ_HAS_DETERMINISM
+OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) {
+  return RcpEst(Sqrt(_v));
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) {
+  return RSqrtEst(_v);
+}
+#else  // OZZ_HAS_DETERMINISM
+OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) {
+  const float32x4_t est = vrsqrteq_f32(_v);
+  return vmulq_f32(vrsqrtsq_f32(vmulq_f32(_v, est), est), est);
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) {
+  const float32x4_t est = RSqrtEst(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  return vmulq_f32(vrsqrtsq_f32(vmulq_f32(_v, est), est), est);
+}
+#endif  // OZZ_HAS_DETERMINISM
+
+OZZ_INLINE SimdFloat4 RSqrtEstX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vgetq_lane_f32(RSqrtEst(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Abs(_SimdFloat4 _v) {
+  return vabsq_f32(_v);
+}
+
+OZZ_INLINE SimdInt4 Sign(_SimdFloat4 _v) {
+  return vreinterpretq_s32_u32(
+    vandq_u32(vreinterpretq_u32_f32(_v), vdupq_n_u32(0x80000000u)));
+}
+
+OZZ_INLINE SimdFloat4 Length2(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::sqrt(OZZ_NEON_DOT2_F(_v, _v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Length3(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::sqrt(OZZ_NEON_DOT3_F(_v, _v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Length4(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::sqrt(OZZ_NEON_DOT4_F(_v, _v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Normalize2(_SimdFloat4 _v) {
+  const float sq_len = OZZ_NEON_DOT2_F(_v, _v);
+  assert(sq_len != 0.f && "_v is not normalizable");
+  const float32x4_t norm = vmulq_n_f32(_v, 1.f / std::sqrt(sq_len));
+  return vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 Normalize3(_SimdFloat4 _v) {
+  const float sq_len = OZZ_NEON_DOT3_F(_v, _v);
+  assert(sq_len != 0.f && "_v is not normalizable");
+  const float32x4_t norm = vmulq_n_f32(_v, 1.f / std::sqrt(sq_len));
+  return vsetq_lane_f32(vgetq_lane_f32(_v, 3), norm, 3);
+}
+
+OZZ_INLINE SimdFloat4 Normalize4(_SimdFloat4 _v) {
+  const float sq_len = OZZ_NEON_DOT4_F(_v, _v);
+  assert(sq_len != 0.f && "_v is not normalizable");
+  return vmulq_n_f32(_v, 1.f / std::sqrt(sq_len));
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst2(_SimdFloat4 _v) {
+  const float sq_len = OZZ_NEON_DOT2_F(_v, _v);
+  assert(sq_len != 0.f && "_v is not normalizable");
+  const float32x4_t norm = vmulq_f32(_v, RSqrtEst(vdupq_n_f32(sq_len)));
+  return vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) {
+  const float sq_len = OZZ_NEON_DOT3_F(_v, _v);
+  assert(sq_len != 0.f && "_v is not normalizable");
+  const float32x4_t norm = vmulq_f32(_v, RSqrtEst(vdupq_n_f32(sq_len)));
+  return vsetq_lane_f32(vgetq_lane_f32(_v, 3), norm, 3);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst4(_SimdFloat4 _v) {
+  const float sq_len = OZZ_NEON_DOT4_F(_v, _v);
+  assert(sq_len != 0.f && "_v is not normalizable");
+  return vmulq_f32(_v, RSqrtEst(vdupq_n_f32(sq_len)));
+}
+
+OZZ_INLINE SimdInt4 IsNormalized2(_SimdFloat4 _v) {
+  const float dot = OZZ_NEON_DOT2_F(_v, _v);
+  const bool normalized = dot < 1.f + kNormalizationTolerance &&
+                          dot > 1.f - kNormalizationTolerance;
+  return vsetq_lane_s32(-static_cast<int>(normalized), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 IsNormalized3(_SimdFloat4 _v) {
+  const float dot = OZZ_NEON_DOT3_F(_v, _v);
+  const bool normalized = dot < 1.f + kNormalizationTolerance &&
+                          dot > 1.f - kNormalizationTolerance;
+  return vsetq_lane_s32(-static_cast<int>(normalized), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 IsNormalized4(_SimdFloat4 _v) {
+  const float dot = OZZ_NEON_DOT4_F(_v, _v);
+  const bool normalized = dot < 1.f + kNormalizationTolerance &&
+                          dot > 1.f - kNormalizationTolerance;
+  return vsetq_lane_s32(-static_cast<int>(normalized), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst2(_SimdFloat4 _v) {
+  const float dot = OZZ_NEON_DOT2_F(_v, _v);
+  const bool normalized = dot < 1.f + kNormalizationToleranceEst &&
+                          dot > 1.f - kNormalizationToleranceEst;
+  return vsetq_lane_s32(-static_cast<int>(normalized), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst3(_SimdFloat4 _v) {
+  const float dot = OZZ_NEON_DOT3_F(_v, _v);
+  const bool normalized = dot < 1.f + kNormalizationToleranceEst &&
+                          dot > 1.f - kNormalizationToleranceEst;
+  return vsetq_lane_s32(-static_cast<int>(normalized), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst4(_SimdFloat4 _v) {
+  const float dot = OZZ_NEON_DOT4_F(_v, _v);
+  const bool normalized = dot < 1.f + kNormalizationToleranceEst &&
+                          dot > 1.f - kNormalizationToleranceEst;
+  return vsetq_lane_s32(-static_cast<int>(normalized), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe2(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  const float sq_len = OZZ_NEON_DOT2_F(_v, _v);
+  if (sq_len == 0.f) {
+    return _safe;
+  }
+  const float32x4_t norm = vmulq_n_f32(_v, 1.f / std::sqrt(sq_len));
+  return vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe3(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  const float sq_len = OZZ_NEON_DOT3_F(_v, _v);
+  if (sq_len == 0.f) {
+    return _safe;
+  }
+  const float32x4_t norm = vmulq_n_f32(_v, 1.f / std::sqrt(sq_len));
+  return vsetq_lane_f32(vgetq_lane_f32(_v, 3), norm, 3);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe4(
+  _SimdFloat4 _v, _SimdFloat4 _safe) {
+  const float sq_len = OZZ_NEON_DOT4_F(_v, _v);
+  if (sq_len == 0.f) {
+    return _safe;
+  }
+  return vmulq_n_f32(_v, 1.f / std::sqrt(sq_len));
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst2(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  const float sq_len = OZZ_NEON_DOT2_F(_v, _v);
+  if (sq_len == 0.f) {
+    return _safe;
+  }
+  const float32x4_t norm = vmulq_f32(_v, RSqrtEst(vdupq_n_f32(sq_len)));
+  return vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  const float sq_len = OZZ_NEON_DOT3_F(_v, _v);
+  if (sq_len == 0.f) {
+    return _safe;
+  }
+  const float32x4_t norm = vmulq_f32(_v, RSqrtEst(vdupq_n_f32(sq_len)));
+  return vsetq_lane_f32(vgetq_lane_f32(_v, 3), norm, 3);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  const float sq_len = OZZ_NEON_DOT4_F(_v, _v);
+  if (sq_len == 0.f) {
+    return _safe;
+  }
+  return vmulq_f32(_v, RSqrtEst(vdupq_n_f32(sq_len)));
+}
+
+OZZ_INLINE SimdFloat4 Lerp(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _alpha) {
+  return OZZ_NEON_MLA_F(_a, _alpha, vsubq_f32(_b, _a));
+}
+
+OZZ_INLINE SimdFloat4 Min(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vminq_f32(_a, _b);
+}
+
+OZZ_INLINE SimdFloat4 Max(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vmaxq_f32(_a, _b);
+}
+
+OZZ_INLINE SimdFloat4 Min0(_SimdFloat4 _v) {
+  return vminq_f32(vdupq_n_f32(0.f), _v);
+}
+
+OZZ_INLINE SimdFloat4 Max0(_SimdFloat4 _v) {
+  return vmaxq_f32(vdupq_n_f32(0.f), _v);
+}
+
+OZZ_INLINE SimdFloat4 Clamp(
+  _SimdFloat4 _a, _SimdFloat4 _v, _SimdFloat4 _b) {
+  return vmaxq_f32(_a, vminq_f32(_v, _b));
+}
+
+OZZ_INLINE SimdFloat4 Select(
+  _SimdInt4 _b, _SimdFloat4 _true, _SimdFloat4 _false) {
+  return OZZ_NEON_SELECT_F(_b, _true, _false);
+}
+
+OZZ_INLINE SimdInt4 CmpEq(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_s32_u32(vceqq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpNe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_s32_u32(vmvnq_u32(vceqq_f32(_a, _b)));
+}
+
+OZZ_INLINE SimdInt4 CmpLt(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_s32_u32(vcltq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpLe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_s32_u32(vcleq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGt(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_s32_u32(vcgtq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_s32_u32(vcgeq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdFloat4 And(_SimdFloat4 _a, _SimdInt4 _b) {
+  return vreinterpretq_f32_s32(vandq_s32(vreinterpretq_s32_f32(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Or(_SimdFloat4 _a, _SimdInt4 _b) {
+  return vreinterpretq_f32_s32(vorrq_s32(vreinterpretq_s32_f32(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Xor(_SimdFloat4 _a, _SimdInt4 _b) {
+  return vreinterpretq_f32_s32(veorq_s32(vreinterpretq_s32_f32(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Cos(_SimdFloat4 _v) {
+  return simd_float4::Load(std::cos(GetX(_v)),
+                           std::cos(GetY(_v)),
+                           std::cos(GetZ(_v)),
+                           std::cos(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 CosX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::cos(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ACos(_SimdFloat4 _v) {
+  return simd_float4::Load(std::acos(GetX(_v)),
+                           std::acos(GetY(_v)),
+                           std::acos(GetZ(_v)),
+                           std::acos(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ACosX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::acos(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ACosEst(_SimdFloat4 _v) {
+  // acos(x) ~= sqrt(1 - x) * P(x) for x in [0,1], and acos(-x) = pi - acos(x).
+  const SimdFloat4 one = simd_float4::one();
+  const SimdFloat4 x = Min(Abs(_v), one);
+  const SimdFloat4 p =
+    MAdd(MAdd(MAdd(simd_float4::Load1(-.0187293f), x,
+                   simd_float4::Load1(.0742610f)), x,
+              simd_float4::Load1(-.2121144f)), x,
+         simd_float4::Load1(1.5707288f));
+  const SimdFloat4 acos = Sqrt(one - x) * p;
+  return Select(CmpLt(_v, simd_float4::zero()),
+                simd_float4::Load1(kPi) - acos, acos);
+}
+
+OZZ_INLINE SimdFloat4 Sin(_SimdFloat4 _v) {
+  return simd_float4::Load(std::sin(GetX(_v)),
+                           std::sin(GetY(_v)),
+                           std::sin(GetZ(_v)),
+                           std::sin(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 SinX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::sin(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ASin(_SimdFloat4 _v) {
+  return simd_float4::Load(std::asin(GetX(_v)),
+                           std::asin(GetY(_v)),
+                           std::asin(GetZ(_v)),
+                           std::asin(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ASinX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::asin(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Tan(_SimdFloat4 _v) {
+  return simd_float4::Load(std::tan(GetX(_v)),
+                           std::tan(GetY(_v)),
+                           std::tan(GetZ(_v)),
+                           std::tan(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 TanX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::tan(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ATan(_SimdFloat4 _v) {
+  return simd_float4::Load(std::atan(GetX(_v)),
+                           std::atan(GetY(_v)),
+                           std::atan(GetZ(_v)),
+                           std::atan(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ATanX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::atan(GetX(_v)), _v, 0);
+}
+
+namespace simd_int4 {
+
+OZZ_INLINE SimdInt4 zero() {
+  return vdupq_n_s32(0);
+}
+
+OZZ_INLINE SimdInt4 one() {
+  return vdupq_n_s32(1);
+}
+
+OZZ_INLINE SimdInt4 x_axis() {
+  return vsetq_lane_s32(1, vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 y_axis() {
+  return vsetq_lane_s32(1, vdupq_n_s32(0), 1);
+}
+
+OZZ_INLINE SimdInt4 z_axis() {
+  return vsetq_lane_s32(1, vdupq_n_s32(0), 2);
+}
+
+OZZ_INLINE SimdInt4 w_axis() {
+  return vsetq_lane_s32(1, vdupq_n_s32(0), 3);
+}
+
+OZZ_INLINE SimdInt4 all_true() {
+  return vdupq_n_s32(-1);
+}
+
+OZZ_INLINE SimdInt4 all_false() {
+  return vdupq_n_s32(0);
+}
+
+OZZ_INLINE SimdInt4 mask_sign() {
+  return vreinterpretq_s32_u32(vdupq_n_u32(0x80000000u));
+}
+
+OZZ_INLINE SimdInt4 mask_not_sign() {
+  return vdupq_n_s32(0x7fffffff);
+}
+
+OZZ_INLINE SimdInt4 mask_ffff() {
+  return vdupq_n_s32(-1);
+}
+
+OZZ_INLINE SimdInt4 mask_0000() {
+  return vdupq_n_s32(0);
+}
+
+OZZ_INLINE SimdInt4 mask_fff0() {
+  return vsetq_lane_s32(0, vdupq_n_s32(-1), 3);
+}
+
+OZZ_INLINE SimdInt4 mask_f000() {
+  return vsetq_lane_s32(-1, vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 mask_0f00() {
+  return vsetq_lane_s32(-1, vdupq_n_s32(0), 1);
+}
+
+OZZ_INLINE SimdInt4 mask_00f0() {
+  return vsetq_lane_s32(-1, vdupq_n_s32(0), 2);
+}
+
+OZZ_INLINE SimdInt4 mask_000f() {
+  return vsetq_lane_s32(-1, vdupq_n_s32(0), 3);
+}
+
+OZZ_INLINE SimdInt4 Load(int _x, int _y, int _z, int _w) {
+  const int32_t i[4] = {_x, _y, _z, _w};
+  return vld1q_s32(i);
+}
+
+OZZ_INLINE SimdInt4 LoadX(int _x) {
+  return vsetq_lane_s32(_x, vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1(int _x) {
+  return vdupq_n_s32(_x);
+}
+
+OZZ_INLINE SimdInt4 Load(bool _x, bool _y, bool _z, bool _w) {
+  const int32_t i[4] = {-static_cast<int32_t>(_x),
+                        -static_cast<int32_t>(_y),
+                        -static_cast<int32_t>(_z),
+                        -static_cast<int32_t>(_w)};
+  return vld1q_s32(i);
+}
+
+OZZ_INLINE SimdInt4 LoadX(bool _x) {
+  return vsetq_lane_s32(-static_cast<int32_t>(_x), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1(bool _x) {
+  return vdupq_n_s32(-static_cast<int32_t>(_x));
+}
+
+OZZ_INLINE SimdInt4 LoadPtr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_s32(reinterpret_cast<const int32_t*>(_i));
+}
+
+OZZ_INLINE SimdInt4 LoadXPtr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_lane_s32(reinterpret_cast<const int32_t*>(_i),
+                        vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_dup_s32(reinterpret_cast<const int32_t*>(_i));
+}
+
+OZZ_INLINE SimdInt4 Load2Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(reinterpret_cast<const int32_t*>(_i)),
+                      vdup_n_s32(0));
+}
+
+OZZ_INLINE SimdInt4 Load3Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vcombine_s32(
+    vld1_s32(reinterpret_cast<const int32_t*>(_i)),
+    vld1_lane_s32(reinterpret_cast<const int32_t*>(_i) + 2,
+                  vdup_n_s32(0), 0));
+}
+
+OZZ_INLINE SimdInt4 LoadPtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_s32(reinterpret_cast<const int32_t*>(_i));
+}
+
+OZZ_INLINE SimdInt4 LoadXPtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_lane_s32(reinterpret_cast<const int32_t*>(_i),
+                        vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_dup_s32(reinterpret_cast<const int32_t*>(_i));
+}
+
+OZZ_INLINE SimdInt4 Load2PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(reinterpret_cast<const int32_t*>(_i)),
+                      vdup_n_s32(0));
+}
+
+OZZ_INLINE SimdInt4 Load3PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vcombine_s32(
+    vld1_s32(reinterpret_cast<const int32_t*>(_i)),
+    vld1_lane_s32(reinterpret_cast<const int32_t*>(_i) + 2,
+                  vdup_n_s32(0), 0));
+}
+
+OZZ_INLINE SimdInt4 FromFloatRound(_SimdFloat4 _f) {
+#if defined(OZZ_NEON_A64)
+  return vcvtnq_s32_f32(_f);
+#else  // OZZ_NEON_A64
+  // Rounds half away from zero, as ARMv7 conversion always truncates.
+  const float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(
+    vreinterpretq_u32_f32(vdupq_n_f32(.5f)),
+    vandq_u32(vreinterpretq_u32_f32(_f), vdupq_n_u32(0x80000000u))));
+  return vcvtq_s32_f32(vaddq_f32(_f, half));
+#endif  // OZZ_NEON_A64
+}
+
+OZZ_INLINE SimdInt4 FromFloatTrunc(_SimdFloat4 _f) {
+  return vcvtq_s32_f32(_f);
+}
+}  // ozz::math::simd_int4
+
+OZZ_INLINE int GetX(_SimdInt4 _v) {
+  return vgetq_lane_s32(_v, 0);
+}
+
+OZZ_INLINE int GetY(_SimdInt4 _v) {
+  return vgetq_lane_s32(_v, 1);
+}
+
+OZZ_INLINE int GetZ(_SimdInt4 _v) {
+  return vgetq_lane_s32(_v, 2);
+}
+
+OZZ_INLINE int GetW(_SimdInt4 _v) {
+  return vgetq_lane_s32(_v, 3);
+}
+
+OZZ_INLINE SimdInt4 SetX(_SimdInt4 _v, int _i) {
+  return vsetq_lane_s32(_i, _v, 0);
+}
+
+OZZ_INLINE SimdInt4 SetY(_SimdInt4 _v, int _i) {
+  return vsetq_lane_s32(_i, _v, 1);
+}
+
+OZZ_INLINE SimdInt4 SetZ(_SimdInt4 _v, int _i) {
+  return vsetq_lane_s32(_i, _v, 2);
+}
+
+OZZ_INLINE SimdInt4 SetW(_SimdInt4 _v, int _i) {
+  return vsetq_lane_s32(_i, _v, 3);
+}
+
+OZZ_INLINE SimdInt4 SetI(_SimdInt4 _v, int _ith, int _i) {
+  assert(_ith >= 0 && _ith <= 3 && "Invalid index ranges");
+  union {
+    SimdInt4 ret;
+    int af[4];
+  } u = {_v};
+  u.af[_ith] = _i;
+  return u.ret;
+}
+
+OZZ_INLINE void StorePtr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1q_s32(reinterpret_cast<int32_t*>(_i), _v);
+}
+
+OZZ_INLINE void Store1Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1q_lane_s32(reinterpret_cast<int32_t*>(_i), _v, 0);
+}
+
+OZZ_INLINE void Store2Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1_s32(reinterpret_cast<int32_t*>(_i), vget_low_s32(_v));
+}
+
+OZZ_INLINE void Store3Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1_s32(reinterpret_cast<int32_t*>(_i), vget_low_s32(_v));
+  vst1q_lane_s32(reinterpret_cast<int32_t*>(_i) + 2, _v, 2);
+}
+
+OZZ_INLINE void StorePtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1q_s32(reinterpret_cast<int32_t*>(_i), _v);
+}
+
+OZZ_INLINE void Store1PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1q_lane_s32(reinterpret_cast<int32_t*>(_i), _v, 0);
+}
+
+OZZ_INLINE void Store2PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1_s32(reinterpret_cast<int32_t*>(_i), vget_low_s32(_v));
+}
+
+OZZ_INLINE void Store3PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1_s32(reinterpret_cast<int32_t*>(_i), vget_low_s32(_v));
+  vst1q_lane_s32(reinterpret_cast<int32_t*>(_i) + 2, _v, 2);
+}
+
+OZZ_INLINE SimdInt4 SplatX(_SimdInt4 _a) {
+  return OZZ_NEON_SPLAT_I(_a, 0);
+}
+
+OZZ_INLINE SimdInt4 SplatY(_SimdInt4 _a) {
+  return OZZ_NEON_SPLAT_I(_a, 1);
+}
+
+OZZ_INLINE SimdInt4 SplatZ(_SimdInt4 _a) {
+  return OZZ_NEON_SPLAT_I(_a, 2);
+}
+
+OZZ_INLINE SimdInt4 SplatW(_SimdInt4 _a) {
+  return OZZ_NEON_SPLAT_I(_a, 3);
+}
+
+OZZ_INLINE int MoveMask(_SimdInt4 _v) {
+  // Moves each sign bit to its lane index, then sums lanes.
+  const int32_t shifts[4] = {0, 1, 2, 3};
+  const uint32x4_t signs = vshrq_n_u32(vreinterpretq_u32_s32(_v), 31);
+  const uint32x4_t bits = vshlq_u32(signs, vld1q_s32(shifts));
+  const uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+  return static_cast<int>(vget_lane_u32(vpadd_u32(sum, sum), 0));
+}
+
+OZZ_INLINE bool AreAllTrue(_SimdInt4 _v) {
+  return MoveMask(_v) == 0xf;
+}
+
+OZZ_INLINE bool AreAllTrue3(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x7) == 0x7;
+}
+
+OZZ_INLINE bool AreAllTrue2(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x3) == 0x3;
+}
+
+OZZ_INLINE bool AreAllTrue1(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x1) == 0x1;
+}
+
+OZZ_INLINE bool AreAllFalse(_SimdInt4 _v) {
+  return MoveMask(_v) == 0;
+}
+
+OZZ_INLINE bool AreAllFalse3(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x7) == 0;
+}
+
+OZZ_INLINE bool AreAllFalse2(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x3) == 0;
+}
+
+OZZ_INLINE bool AreAllFalse1(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x1) == 0;
+}
+
+OZZ_INLINE SimdInt4 HAdd2(_SimdInt4 _v) {
+  const int32x2_t hadd = vpadd_s32(vget_low_s32(_v), vget_low_s32(_v));
+  return vsetq_lane_s32(vget_lane_s32(hadd, 0), _v, 0);
+}
+
+OZZ_INLINE SimdInt4 HAdd3(_SimdInt4 _v) {
+  const int32x2_t hadd = vpadd_s32(vget_low_s32(_v), vget_low_s32(_v));
+  return vsetq_lane_s32(vget_lane_s32(hadd, 0) + vgetq_lane_s32(_v, 2), _v, 0);
+}
+
+OZZ_INLINE SimdInt4 HAdd4(_SimdInt4 _v) {
+  const int32x2_t sum = vadd_s32(vget_low_s32(_v), vget_high_s32(_v));
+  return vsetq_lane_s32(vget_lane_s32(vpadd_s32(sum, sum), 0), _v, 0);
+}
+
+OZZ_INLINE SimdInt4 Abs(_SimdInt4 _v) {
+  return vabsq_s32(_v);
+}
+
+OZZ_INLINE SimdInt4 Sign(_SimdInt4 _v) {
+  return vandq_s32(_v, vreinterpretq_s32_u32(vdupq_n_u32(0x80000000u)));
+}
+
+OZZ_INLINE SimdInt4 Min(_SimdInt4 _a, _SimdInt4 _b) {
+  return vminq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Max(_SimdInt4 _a, _SimdInt4 _b) {
+  return vmaxq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Min0(_SimdInt4 _v) {
+  return vminq_s32(vdupq_n_s32(0), _v);
+}
+
+OZZ_INLINE SimdInt4 Max0(_SimdInt4 _v) {
+  return vmaxq_s32(vdupq_n_s32(0), _v);
+}
+
+OZZ_INLINE SimdInt4 Clamp(_SimdInt4 _a, _SimdInt4 _v, _SimdInt4 _b) {
+  return vmaxq_s32(_a, vminq_s32(_v, _b));
+}
+
+OZZ_INLINE SimdInt4 Select(
+  _SimdInt4 _b, _SimdInt4 _true, _SimdInt4 _false) {
+  return OZZ_NEON_SELECT_I(_b, _true, _false);
+}
+
+OZZ_INLINE SimdInt4 And(_SimdInt4 _a, _SimdInt4 _b) {
+  return vandq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Or(_SimdInt4 _a, _SimdInt4 _b) {
+  return vorrq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Xor(_SimdInt4 _a, _SimdInt4 _b) {
+  return veorq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Not(_SimdInt4 _v) {
+  return vmvnq_s32(_v);
+}
+
+OZZ_INLINE SimdInt4 ShiftL(_SimdInt4 _v, int _bits) {
+  return vshlq_s32(_v, vdupq_n_s32(_bits));
+}
+
+OZZ_INLINE SimdInt4 ShiftR(_SimdInt4 _v, int _bits) {
+  // Negative shifts are right shifts, arithmetic for signed integers.
+  return vshlq_s32(_v, vdupq_n_s32(-_bits));
+}
+
+OZZ_INLINE SimdInt4 ShiftRu(_SimdInt4 _v, int _bits) {
+  return vreinterpretq_s32_u32(
+    vshlq_u32(vreinterpretq_u32_s32(_v), vdupq_n_s32(-_bits)));
+}
+
+OZZ_INLINE SimdInt4 CmpEq(_SimdInt4 _a, _SimdInt4 _b) {
+  return vreinterpretq_s32_u32(vceqq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpNe(_SimdInt4 _a, _SimdInt4 _b) {
+  return vreinterpretq_s32_u32(vmvnq_u32(vceqq_s32(_a, _b)));
+}
+
+OZZ_INLINE SimdInt4 CmpLt(_SimdInt4 _a, _SimdInt4 _b) {
+  return vreinterpretq_s32_u32(vcltq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpLe(_SimdInt4 _a, _SimdInt4 _b) {
+  return vreinterpretq_s32_u32(vcleq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGt(_SimdInt4 _a, _SimdInt4 _b) {
+  return vreinterpretq_s32_u32(vcgtq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGe(_SimdInt4 _a, _SimdInt4 _b) {
+  return vreinterpretq_s32_u32(vcgeq_s32(_a, _b));
+}
+
+OZZ_INLINE Float4x4 Float4x4::identity() {
+  const Float4x4 ret = {{simd_float4::x_axis(),
+                         simd_float4::y_axis(),
+                         simd_float4::z_axis(),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Transpose(const Float4x4& _m) {
+  Float4x4 ret;
+  Transpose4x4(_m.cols, ret.cols);
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Invert(const Float4x4& _m) {
+  // Uses scalar cofactors, which are cheap compared to the lanes shuffling
+  // that would be required on NEON to reproduce SSE implementation.
+  float m[16];
+  vst1q_f32(m + 0, _m.cols[0]);
+  vst1q_f32(m + 4, _m.cols[1]);
+  vst1q_f32(m + 8, _m.cols[2]);
+  vst1q_f32(m + 12, _m.cols[3]);
+
+  float inv[16];
+  inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] +
+           m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+  inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] -
+           m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+  inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] +
+           m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+  inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] -
+            m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+  inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] -
+           m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+  inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] +
+           m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+  inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] -
+           m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+  inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] +
+            m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+  inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] +
+           m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+  inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] -
+           m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+  inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] +
+            m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+  inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] -
+            m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+  inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] -
+           m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+  inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] +
+           m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+  inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] -
+            m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+  inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] +
+            m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+  const float det =
+    m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+  assert(det != 0.f && "Matrix is not invertible");
+  const float inv_det = 1.f / det;
+
+  const Float4x4 ret = {{vmulq_n_f32(vld1q_f32(inv + 0), inv_det),
+                         vmulq_n_f32(vld1q_f32(inv + 4), inv_det),
+                         vmulq_n_f32(vld1q_f32(inv + 8), inv_det),
+                         vmulq_n_f32(vld1q_f32(inv + 12), inv_det)}};
+  return ret;
+}
+
+Float4x4 Float4x4::Translation(_SimdFloat4 _v) {
+  const Float4x4 ret = {{simd_float4::x_axis(),
+                         simd_float4::y_axis(),
+                         simd_float4::z_axis(),
+                         vsetq_lane_f32(1.f, _v, 3)}};
+  return ret;
+}
+
+Float4x4 Float4x4::Scaling(_SimdFloat4 _v) {
+  const Float4x4 ret = {{And(_v, simd_int4::mask_f000()),
+                         And(_v, simd_int4::mask_0f00()),
+                         And(_v, simd_int4::mask_00f0()),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Translate(const Float4x4& _m, _SimdFloat4 _v) {
+  const float32x2_t vxy = vget_low_f32(_v);
+  const float32x4_t a01 = OZZ_NEON_MLA_LANE_F(
+    vmulq_lane_f32(_m.cols[0], vxy, 0), _m.cols[1], vxy, 1);
+  const float32x4_t m3 = OZZ_NEON_MLA_LANE_F(
+    _m.cols[3], _m.cols[2], vget_high_f32(_v), 0);
+  const Float4x4 ret = {{_m.cols[0], _m.cols[1], _m.cols[2],
+                         vaddq_f32(a01, m3)}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Scale(const Float4x4& _m, _SimdFloat4 _v) {
+  const Float4x4 ret = {{vmulq_lane_f32(_m.cols[0], vget_low_f32(_v), 0),
+                         vmulq_lane_f32(_m.cols[1], vget_low_f32(_v), 1),
+                         vmulq_lane_f32(_m.cols[2], vget_high_f32(_v), 0),
+                         _m.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 ColumnMultiply(const Float4x4& _m, _SimdFloat4 _v) {
+  const Float4x4 ret = {{vmulq_f32(_m.cols[0], _v),
+                         vmulq_f32(_m.cols[1], _v),
+                         vmulq_f32(_m.cols[2], _v),
+                         vmulq_f32(_m.cols[3], _v)}};
+  return ret;
+}
+
+OZZ_INLINE SimdInt4 IsNormalized(const Float4x4& _m) {
+  const float32x4_t max = vdupq_n_f32(1.f + kNormalizationTolerance);
+  const float32x4_t min = vdupq_n_f32(1.f - kNormalizationTolerance);
+
+  SimdFloat4 rows[4];
+  Transpose4x4(_m.cols, rows);
+  const float32x4_t dot = OZZ_NEON_MLA_F(
+    OZZ_NEON_MLA_F(vmulq_f32(rows[0], rows[0]), rows[1], rows[1]),
+    rows[2], rows[2]);
+  const uint32x4_t normalized = vandq_u32(vcltq_f32(dot, max),
+                                          vcgtq_f32(dot, min));
+  return vandq_s32(vreinterpretq_s32_u32(normalized), simd_int4::mask_fff0());
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst(const Float4x4& _m) {
+  const float32x4_t max = vdupq_n_f32(1.f + kNormalizationToleranceEst);
+  const float32x4_t min = vdupq_n_f32(1.f - kNormalizationToleranceEst);
+
+  SimdFloat4 rows[4];
+  Transpose4x4(_m.cols, rows);
+  const float32x4_t dot = OZZ_NEON_MLA_F(
+    OZZ_NEON_MLA_F(vmulq_f32(rows[0], rows[0]), rows[1], rows[1]),
+    rows[2], rows[2]);
+  const uint32x4_t normalized = vandq_u32(vcltq_f32(dot, max),
+                                          vcgtq_f32(dot, min));
+  return vandq_s32(vreinterpretq_s32_u32(normalized), simd_int4::mask_fff0());
+}
+
+OZZ_INLINE SimdInt4 IsOrthogonal(const Float4x4& _m) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+
+  // Use simd_float4::zero() if one of the normalization fails. _m will then be
+  // considered not orthogonal.
+  const SimdFloat4 cross =
+    NormalizeSafe3(Cross3(_m.cols[0], _m.cols[1]), zero);
+  const SimdFloat4 at = NormalizeSafe3(_m.cols[2], zero);
+
+  const float dot = OZZ_NEON_DOT3_F(cross, at);
+  const bool orthogonal = dot < 1.f + kNormalizationTolerance &&
+                          dot > 1.f - kNormalizationTolerance;
+  return vsetq_lane_s32(-static_cast<int>(orthogonal), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdFloat4 ToQuaternion(const Float4x4& _m) {
+  assert(AreAllTrue3(IsNormalizedEst(_m)));
+  assert(AreAllTrue1(IsOrthogonal(_m)));
+
+  // Cf From Quaternion to Matrix and Back, J.M.P. van Waveren 2005.
+  const float m00 = GetX(_m.cols[0]);
+  const float m01 = GetY(_m.cols[0]);
+  const float m02 = GetZ(_m.cols[0]);
+  const float m10 = GetX(_m.cols[1]);
+  const float m11 = GetY(_m.cols[1]);
+  const float m12 = GetZ(_m.cols[1]);
+  const float m20 = GetX(_m.cols[2]);
+  const float m21 = GetY(_m.cols[2]);
+  const float m22 = GetZ(_m.cols[2]);
+
+  SimdFloat4 ret;
+  if (m00 + m11 + m22 > .0f) {
+    const float t = m00 + m11 + m22 + 1.0f;
+    const float s = (1.f / std::sqrt(t)) * .5f;
+    ret = simd_float4::Load(
+      (m12 - m21) * s, (m20 - m02) * s, (m01 - m10) * s, s * t);
+  } else if (m00 > m11 && m00 > m22) {
+    const float t = m00 - m11 - m22 + 1.0f;
+    const float s = (1.f / std::sqrt(t)) * .5f;
+    ret = simd_float4::Load(
+      s * t, (m01 + m10) * s, (m20 + m02) * s, (m12 - m21) * s);
+  } else if (m11 > m22) {
+    const float t = -m00 + m11 - m22 + 1.0f;
+    const float s = (1.f / std::sqrt(t)) * .5f;
+    ret = simd_float4::Load(
+      (m01 + m10) * s, s * t, (m12 + m21) * s, (m20 - m02) * s);
+  } else {
+    const float t = -m00 - m11 + m22 + 1.0f;
+    const float s = (1.f / std::sqrt(t)) * .5f;
+    ret = simd_float4::Load(
+      (m20 + m02) * s, (m12 + m21) * s, s * t, (m01 - m10) * s);
+  }
+
+  assert(AreAllTrue1(IsNormalizedEst4(ret)));
+  return ret;
+}
+
+OZZ_INLINE bool ToAffine(const Float4x4& _m,
+                         SimdFloat4* _translation,
+                         SimdFloat4* _quaternion,
+                         SimdFloat4* _scale) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  const float32x4_t one = vdupq_n_f32(1.f);
+  const int32x4_t fff0 = simd_int4::mask_fff0();
+  const float32x4_t max = vdupq_n_f32(kNormalizationTolerance);
+  const float32x4_t min = vnegq_f32(max);
+
+  // Extracts translation.
+  *_translation = OZZ_NEON_SELECT_F(fff0, _m.cols[3], one);
+
+  // Extracts scale.
+  SimdFloat4 m_rows[4];
+  Transpose4x4(_m.cols, m_rows);
+  const float32x4_t dot = OZZ_NEON_MLA_F(
+    OZZ_NEON_MLA_F(vmulq_f32(m_rows[0], m_rows[0]), m_rows[1], m_rows[1]),
+    m_rows[2], m_rows[2]);
+  const float32x4_t abs_scale = Sqrt(dot);
+
+  const int32x4_t zero_axis = vreinterpretq_s32_u32(
+    vandq_u32(vcltq_f32(dot, max), vcgtq_f32(dot, min)));
+
+  // Builds an orthonormal matrix in order to support quaternion extraction.
+  Float4x4 orthonormal;
+  const int mask = MoveMask(zero_axis);
+  if (mask & 1) {
+    if (mask & 6) {
+      return false;
+    }
+    orthonormal.cols[1] =
+      vmulq_n_f32(_m.cols[1], 1.f / vgetq_lane_f32(abs_scale, 1));
+    orthonormal.cols[0] = Normalize3(
+      Cross3(orthonormal.cols[1], _m.cols[2]));
+    orthonormal.cols[2] = Normalize3(
+      Cross3(orthonormal.cols[0], orthonormal.cols[1]));
+  } else if (mask & 4) {
+    if (mask & 3) {
+      return false;
+    }
+    orthonormal.cols[0] =
+      vmulq_n_f32(_m.cols[0], 1.f / vgetq_lane_f32(abs_scale, 0));
+    orthonormal.cols[2] = Normalize3(
+      Cross3(orthonormal.cols[0], _m.cols[1]));
+    orthonormal.cols[1] = Normalize3(
+      Cross3(orthonormal.cols[2], orthonormal.cols[0]));
+  } else {  // Favor z axis in the default case
+    if (mask & 5) {
+      return false;
+    }
+    orthonormal.cols[2] =
+      vmulq_n_f32(_m.cols[2], 1.f / vgetq_lane_f32(abs_scale, 2));
+    orthonormal.cols[1] = Normalize3(
+      Cross3(orthonormal.cols[2], _m.cols[0]));
+    orthonormal.cols[0] = Normalize3(
+      Cross3(orthonormal.cols[1], orthonormal.cols[2]));
+  }
+  orthonormal.cols[3] = simd_float4::w_axis();
+
+  // Get back scale signs in case of reflexions
+  SimdFloat4 o_rows[4];
+  Transpose4x4(orthonormal.cols, o_rows);
+  const float32x4_t scale_dot = OZZ_NEON_MLA_F(
+    OZZ_NEON_MLA_F(vmulq_f32(o_rows[0], m_rows[0]), o_rows[1], m_rows[1]),
+    o_rows[2], m_rows[2]);
+
+  const int32x4_t cond = vreinterpretq_s32_u32(vcgtq_f32(scale_dot, zero));
+  const float32x4_t scale =
+    OZZ_NEON_SELECT_F(cond, abs_scale, vnegq_f32(abs_scale));
+  *_scale = OZZ_NEON_SELECT_F(fff0, scale, one);
+
+  // Extracts quaternion.
+  *_quaternion = ToQuaternion(orthonormal);
+  return true;
+}
+
+OZZ_INLINE Float4x4 Float4x4::FromEuler(_SimdFloat4 _v) {
+  const float32x4_t cos = Cos(_v);
+  const float32x4_t sin = Sin(_v);
+
+  const float cx = GetX(cos);
+  const float sx = GetX(sin);
+  const float cy = GetY(cos);
+  const float sy = GetY(sin);
+  const float cz = GetZ(cos);
+  const float sz = GetZ(sin);
+
+  const float sycz = sy*cz;
+  const float sysz = sy*sz;
+
+  const Float4x4 ret = {{
+    simd_float4::Load(cx * cy, sx * sz - cx * sycz, cx * sysz + sx * cz, 0.f),
+    simd_float4::Load(sy, cy * cz, -cy * sz, 0.f),
+    simd_float4::Load(-sx * cy, sx * sycz + cx * sz, -sx * sysz + cx * cz, 0.f),
+    simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Float4x4::FromAxisAngle(_SimdFloat4 _v) {
+  assert(AreAllTrue1(IsNormalizedEst3(_v)));
+
+  const float x = GetX(_v);
+  const float y = GetY(_v);
+  const float z = GetZ(_v);
+  const float cos = std::cos(GetW(_v));
+  const float sin = std::sin(GetW(_v));
+  const float t = 1.f - cos;
+
+  const float a = x * y * t;
+  const float b = z * sin;
+  const float c = x * z * t;
+  const float d = y * sin;
+  const float e = y * z * t;
+  const float f = x * sin;
+
+  const Float4x4 ret = {{simd_float4::Load(cos + x * x * t, a + b, c - d, 0.f),
+                         simd_float4::Load(a - b, cos + y * y * t, e + f, 0.f),
+                         simd_float4::Load(c + d, e - f, cos + z * z * t, 0.f),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Float4x4::FromQuaternion(_SimdFloat4 _quaternion) {
+  assert(AreAllTrue1(IsNormalizedEst4(_quaternion)));
+  return FromAffine(simd_float4::zero(), _quaternion, simd_float4::one());
+}
+
+OZZ_INLINE Float4x4 Float4x4::FromAffine(_SimdFloat4 _translation,
+                                         _SimdFloat4 _quaternion,
+                                         _SimdFloat4 _scale) {
+  assert(AreAllTrue1(IsNormalizedEst4(_quaternion)));
+
+  // Computes the 3 rotation columns with quaternion components products.
+  // 2 * (x, y, z, w) * (x, y, z, w) terms are gathered in vectors so that
+  // each column is computed with a few multiply-add only.
+  const float32x4_t q2 = vaddq_f32(_quaternion, _quaternion);
+  const float x = GetX(_quaternion);
+  const float y = GetY(_quaternion);
+  const float z = GetZ(_quaternion);
+  const float w = GetW(_quaternion);
+  const float x2 = GetX(q2);
+  const float y2 = GetY(q2);
+  const float z2 = GetZ(q2);
+
+  const float xx = x * x2;
+  const float xy = x * y2;
+  const float xz = x * z2;
+  const float xw = w * x2;
+  const float yy = y * y2;
+  const float yz = y * z2;
+  const float yw = w * y2;
+  const float zz = z * z2;
+  const float zw = w * z2;
+
+  const Float4x4 ret = {{
+    vmulq_lane_f32(simd_float4::Load(1.f - (yy + zz), xy + zw, xz - yw, 0.f),
+                   vget_low_f32(_scale), 0),
+    vmulq_lane_f32(simd_float4::Load(xy - zw, 1.f - (xx + zz), yz + xw, 0.f),
+                   vget_low_f32(_scale), 1),
+    vmulq_lane_f32(simd_float4::Load(xz + yw, yz - xw, 1.f - (xx + yy), 0.f),
+                   vget_high_f32(_scale), 0),
+    vsetq_lane_f32(1.f, _translation, 3)}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(
+  const ozz::math::Float4x4& _m, ozz::math::_SimdFloat4 _v) {
+  const float32x2_t vxy = vget_low_f32(_v);
+  const float32x4_t a01 = OZZ_NEON_MLA_LANE_F(
+    vmulq_lane_f32(_m.cols[0], vxy, 0), _m.cols[1], vxy, 1);
+  const float32x4_t a23 = OZZ_NEON_MLA_LANE_F(
+    _m.cols[3], _m.cols[2], vget_high_f32(_v), 0);
+  return vaddq_f32(a01, a23);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformVector(
+  const ozz::math::Float4x4& _m, ozz::math::_SimdFloat4 _v) {
+  const float32x2_t vxy = vget_low_f32(_v);
+  const float32x4_t a01 = OZZ_NEON_MLA_LANE_F(
+    vmulq_lane_f32(_m.cols[0], vxy, 0), _m.cols[1], vxy, 1);
+  return OZZ_NEON_MLA_LANE_F(a01, _m.cols[2], vget_high_f32(_v), 0);
+}
+}  // math
+}  // ozz
+
+#if !defined(__GNUC__)
+OZZ_INLINE ozz::math::SimdFloat4 operator+(
+  ozz::math::_SimdFloat4 _a, ozz::math::_SimdFloat4 _b) {
+  return vaddq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator-(
+  ozz::math::_SimdFloat4 _a, ozz::math::_SimdFloat4 _b) {
+  return vsubq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator-(ozz::math::_SimdFloat4 _v) {
+  return vnegq_f32(_v);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator*(
+  ozz::math::_SimdFloat4 _a, ozz::math::_SimdFloat4 _b) {
+  return vmulq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator/(
+  ozz::math::_SimdFloat4 _a, ozz::math::_SimdFloat4 _b) {
+#if defined(OZZ_NEON_A64)
+  return vdivq_f32(_a, _b);
+#else  // OZZ_NEON_A64
+  const float f[4] = {vgetq_lane_f32(_a, 0) / vgetq_lane_f32(_b, 0),
+                      vgetq_lane_f32(_a, 1) / vgetq_lane_f32(_b, 1),
+                      vgetq_lane_f32(_a, 2) / vgetq_lane_f32(_b, 2),
+                      vgetq_lane_f32(_a, 3) / vgetq_lane_f32(_b, 3)};
+  return vld1q_f32(f);
+#endif  // OZZ_NEON_A64
+}
+#endif  // !defined(__GNUC__)
+
+OZZ_INLINE ozz::math::SimdFloat4 operator*(
+  const ozz::math::Float4x4& _m, ozz::math::_SimdFloat4 _v) {
+  const float32x2_t vxy = vget_low_f32(_v);
+  const float32x2_t vzw = vget_high_f32(_v);
+  const float32x4_t a01 = OZZ_NEON_MLA_LANE_F(
+    vmulq_lane_f32(_m.cols[0], vxy, 0), _m.cols[1], vxy, 1);
+  const float32x4_t a23 = OZZ_NEON_MLA_LANE_F(
+    vmulq_lane_f32(_m.cols[2], vzw, 0), _m.cols[3], vzw, 1);
+  return vaddq_f32(a01, a23);
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator*(
+  const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {{_a * _b.cols[0],
+                                    _a * _b.cols[1],
+                                    _a * _b.cols[2],
+                                    _a * _b.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator+(
+  const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {{vaddq_f32(_a.cols[0], _b.cols[0]),
+                                    vaddq_f32(_a.cols[1], _b.cols[1]),
+                                    vaddq_f32(_a.cols[2], _b.cols[2]),
+                                    vaddq_f32(_a.cols[3], _b.cols[3])}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator-(
+  const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {{vsubq_f32(_a.cols[0], _b.cols[0]),
+                                    vsubq_f32(_a.cols[1], _b.cols[1]),
+                                    vsubq_f32(_a.cols[2], _b.cols[2]),
+                                    vsubq_f32(_a.cols[3], _b.cols[3])}};
+  return ret;
+}
+
+namespace ozz {
+namespace math {
+OZZ_INLINE uint16_t FloatToHalf(float _f) {
+  const int h = vgetq_lane_s32(FloatToHalf(vdupq_n_f32(_f)), 0);
+  return static_cast<uint16_t>(h);
+}
+
+OZZ_INLINE float HalfToFloat(uint16_t _h) {
+  return vgetq_lane_f32(HalfToFloat(vdupq_n_s32(_h)), 0);
+}
+
+// Half <-> Float implementation is based on:
+// http://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/.
+OZZ_INLINE SimdInt4 FloatToHalf(_SimdFloat4 _f) {
+  const uint32x4_t mask_sign = vdupq_n_u32(0x80000000u);
+  const uint32x4_t mask_round = vdupq_n_u32(~0xfffu);
+  const int32x4_t f32infty = vdupq_n_s32(255 << 23);
+  const float32x4_t magic = vreinterpretq_f32_s32(vdupq_n_s32(15 << 23));
+  const int32x4_t nanbit = vdupq_n_s32(0x200);
+  const int32x4_t infty_as_fp16 = vdupq_n_s32(0x7c00);
+  const float32x4_t clamp =
+    vreinterpretq_f32_s32(vdupq_n_s32((31 << 23) - 0x1000));
+
+  const uint32x4_t f = vreinterpretq_u32_f32(_f);
+  const uint32x4_t justsign = vandq_u32(mask_sign, f);
+  const int32x4_t absf_int = vreinterpretq_s32_u32(veorq_u32(f, justsign));
+  const uint32x4_t b_isnan = vcgtq_s32(absf_int, f32infty);
+  const uint32x4_t b_isnormal = vcgtq_s32(f32infty, absf_int);
+  const int32x4_t inf_or_nan = vorrq_s32(
+    vandq_s32(vreinterpretq_s32_u32(b_isnan), nanbit), infty_as_fp16);
+  const float32x4_t fnosticky = vreinterpretq_f32_u32(
+    vandq_u32(vreinterpretq_u32_s32(absf_int), mask_round));
+  const float32x4_t scaled = vmulq_f32(fnosticky, magic);
+  // Logically, we want PMINSD on "biased", but this should gen better code
+  const float32x4_t clamped = vminq_f32(scaled, clamp);
+  const int32x4_t biased = vsubq_s32(vreinterpretq_s32_f32(clamped),
+                                     vreinterpretq_s32_u32(mask_round));
+  const int32x4_t shifted = vreinterpretq_s32_u32(
+    vshrq_n_u32(vreinterpretq_u32_s32(biased), 13));
+  const int32x4_t normal =
+    vandq_s32(shifted, vreinterpretq_s32_u32(b_isnormal));
+  const int32x4_t not_normal =
+    vbicq_s32(inf_or_nan, vreinterpretq_s32_u32(b_isnormal));
+  const int32x4_t joined = vorrq_s32(normal, not_normal);
+
+  const int32x4_t sign_shift = vreinterpretq_s32_u32(vshrq_n_u32(justsign, 16));
+  return vorrq_s32(joined, sign_shift);
+}
+
+OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
+  const int32x4_t mask_nosign = vdupq_n_s32(0x7fff);
+  const float32x4_t magic =
+    vreinterpretq_f32_s32(vdupq_n_s32((254 - 15) << 23));
+  const int32x4_t was_infnan = vdupq_n_s32(0x7bff);
+  const int32x4_t exp_infnan = vdupq_n_s32(255 << 23);
+
+  const int32x4_t expmant = vandq_s32(mask_nosign, _h);
+  const int32x4_t shifted = vshlq_n_s32(expmant, 13);
+  const float32x4_t scaled = vmulq_f32(vreinterpretq_f32_s32(shifted), magic);
+  const uint32x4_t b_wasinfnan = vcgtq_s32(expmant, was_infnan);
+  const int32x4_t sign = vshlq_n_s32(veorq_s32(_h, expmant), 16);
+  const int32x4_t infnanexp =
+    vandq_s32(vreinterpretq_s32_u32(b_wasinfnan), exp_infnan);
+  const int32x4_t sign_inf = vorrq_s32(sign, infnanexp);
+  return vreinterpretq_f32_s32(
+    vorrq_s32(vreinterpretq_s32_f32(scaled), sign_inf));
+}
+}  // math
+}  // ozz
+
+#undef OZZ_NEON_A64
+#undef OZZ_NEON_SPLAT_F
+#undef OZZ_NEON_HADD2_F
+#undef OZZ_NEON_HADD3_F
+#undef OZZ_NEON_HADD4_F
+#undef OZZ_NEON_DOT2_F
+#undef OZZ_NEON_DOT3_F
+#undef OZZ_NEON_DOT4_F
+#undef OZZ_NEON_YZXW_F
+#undef OZZ_NEON_SELECT_F
+#undef OZZ_NEON_SPLAT_I
+#undef OZZ_NEON_SELECT_I
+#undef OZZ_NEON_MLA_F
+#undef OZZ_NEON_MLS_F
+#undef OZZ_NEON_MLA_LANE_F
+#endif  // OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
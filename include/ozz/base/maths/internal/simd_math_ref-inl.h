@@ -54,6 +54,22 @@ union SimdIF4 {
 };
 }  // internal
 
+// Deterministic builds (OZZ_HAS_DETERMINISM) use correctly rounded divisions
+// and square roots, so that results match bit for bit the SSE and NEON
+// implementations.
+#ifdef OZZ_HAS_DETERMINISM
+#define OZZ_RCP_EST(_in, _out) do {\
+  _out = 1.f / (_in);\
+} while (void(0), 0)
+
+#define OZZ_RCP_EST_NR(_in, _out) OZZ_RCP_EST(_in, _out)
+
+#define OZZ_RSQRT_EST(_in, _out) do {\
+  _out = 1.f / std::sqrt(_in);\
+} while (void(0), 0)
+
+#define OZZ_RSQRT_EST_NR(_in, _out) OZZ_RSQRT_EST(_in, _out)
+#else  // OZZ_HAS_DETERMINISM
 #define OZZ_RCP_EST(_in, _out) do {\
   const float in = _in;\
   const union {float f; int i;} uf = {in};\
@@ -81,6 +97,7 @@ union SimdIF4 {
   OZZ_RSQRT_EST(_in, fp2);\
   _out = fp2 * (1.5f - (_in * .5f * fp2 * fp2));\
 } while (void(0), 0)
+#endif  // OZZ_HAS_DETERMINISM
 
 namespace simd_float4 {
 
@@ -226,6 +243,14 @@ OZZ_INLINE void StorePtr(_SimdFloat4 _v, float* _f) {
   _f[3] = _v.w;
 }
 
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  StorePtr(_v, _f);
+}
+
+OZZ_INLINE void StreamFence() {
+}
+
 OZZ_INLINE void Store1Ptr(_SimdFloat4 _v, float* _f) {
   assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
   _f[0] = _v.x;
@@ -428,13 +453,15 @@ OZZ_INLINE SimdFloat4 HAdd2(_SimdFloat4 _v) {
   return ret;
 }
 
+// Horizontal sums are evaluated in the same order as the SSE implementation,
+// so that both produce the same bits.
 OZZ_INLINE SimdFloat4 HAdd3(_SimdFloat4 _v) {
-  const SimdFloat4 ret = {_v.x + _v.y + _v.z, _v.y, _v.z, _v.w};
+  const SimdFloat4 ret = {(_v.x + _v.z) + _v.y, _v.y, _v.z, _v.w};
   return ret;
 }
 
 OZZ_INLINE SimdFloat4 HAdd4(_SimdFloat4 _v) {
-  const SimdFloat4 ret = {_v.x + _v.y + _v.z + _v.w, _v.y, _v.z, _v.w};
+  const SimdFloat4 ret = {(_v.x + _v.z) + (_v.y + _v.w), _v.y, _v.z, _v.w};
   return ret;
 }
 
@@ -444,7 +471,7 @@ OZZ_INLINE SimdFloat4 Dot2(_SimdFloat4 _a, _SimdFloat4 _b) {
 }
 
 OZZ_INLINE SimdFloat4 Dot3(_SimdFloat4 _a, _SimdFloat4 _b) {
-  const SimdFloat4 ret = {_a.x * _b.x + _a.y * _b.y + _a.z * _b.z,
+  const SimdFloat4 ret = {(_a.x * _b.x + _a.z * _b.z) + _a.y * _b.y,
                           _a.y,
                           _a.z,
                           _a.w};
@@ -452,7 +479,8 @@ OZZ_INLINE SimdFloat4 Dot3(_SimdFloat4 _a, _SimdFloat4 _b) {
 }
 
 OZZ_INLINE SimdFloat4 Dot4(_SimdFloat4 _a, _SimdFloat4 _b) {
-  const SimdFloat4 ret = {_a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w,
+  const SimdFloat4 ret = {(_a.x * _b.x + _a.z * _b.z) +
+                          (_a.y * _b.y + _a.w * _b.w),
                           _a.y,
                           _a.z,
                           _a.w};
@@ -555,13 +583,14 @@ OZZ_INLINE SimdFloat4 Length2(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 Length3(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z;
+  const float sq_len = (_v.x * _v.x + _v.z * _v.z) + _v.y * _v.y;
   const SimdFloat4 ret = {std::sqrt(sq_len), _v.y, _v.z, _v.w};
   return ret;
 }
 
 OZZ_INLINE SimdFloat4 Length4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+    (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   const SimdFloat4 ret = {std::sqrt(sq_len), _v.y, _v.z, _v.w};
   return ret;
 }
@@ -575,7 +604,7 @@ OZZ_INLINE SimdFloat4 Normalize2(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 Normalize3(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z;
+  const float sq_len = (_v.x * _v.x + _v.z * _v.z) + _v.y * _v.y;
   assert(sq_len != 0.f && "_v is not normalizable");
   const float inv_len = 1.f / std::sqrt(sq_len);
   const SimdFloat4 ret = {_v.x * inv_len, _v.y * inv_len, _v.z * inv_len, _v.w};
@@ -583,7 +612,8 @@ OZZ_INLINE SimdFloat4 Normalize3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 Normalize4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+    (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   assert(sq_len != 0.f && "_v is not normalizable");
   const float inv_len = 1.f / std::sqrt(sq_len);
   const SimdFloat4 ret = {_v.x * inv_len,
@@ -603,7 +633,7 @@ OZZ_INLINE SimdFloat4 NormalizeEst2(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z;
+  const float sq_len = (_v.x * _v.x + _v.z * _v.z) + _v.y * _v.y;
   assert(sq_len != 0.f && "_v is not normalizable");
   float inv_len;
   OZZ_RSQRT_EST(sq_len, inv_len);
@@ -612,7 +642,8 @@ OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 NormalizeEst4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+    (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   assert(sq_len != 0.f && "_v is not normalizable");
   float inv_len;
   OZZ_RSQRT_EST(sq_len, inv_len);
@@ -631,14 +662,15 @@ OZZ_INLINE SimdInt4 IsNormalized2(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdInt4 IsNormalized3(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z;
+  const float sq_len = (_v.x * _v.x + _v.z * _v.z) + _v.y * _v.y;
   const bool normalized = std::abs(sq_len - 1.f) < kNormalizationTolerance;
   const SimdInt4 ret = {-static_cast<int>(normalized), 0, 0, 0};
   return ret;
 }
 
 OZZ_INLINE SimdInt4 IsNormalized4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+    (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   const bool normalized = std::abs(sq_len - 1.f) < kNormalizationTolerance;
   const SimdInt4 ret = {-static_cast<int>(normalized), 0, 0, 0};
   return ret;
@@ -653,7 +685,7 @@ OZZ_INLINE SimdInt4 IsNormalizedEst2(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdInt4 IsNormalizedEst3(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z;
+  const float sq_len = (_v.x * _v.x + _v.z * _v.z) + _v.y * _v.y;
   const bool normalized =
     std::abs(sq_len - 1.f) < kNormalizationToleranceEst;
   const SimdInt4 ret = {-static_cast<int>(normalized), 0, 0, 0};
@@ -661,7 +693,8 @@ OZZ_INLINE SimdInt4 IsNormalizedEst3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdInt4 IsNormalizedEst4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+    (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   const bool normalized =
     std::abs(sq_len - 1.f) < kNormalizationToleranceEst;
   const SimdInt4 ret = {-static_cast<int>(normalized), 0, 0, 0};
@@ -680,7 +713,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafe2(_SimdFloat4 _v, _SimdFloat4 _safe) {
 }
 
 OZZ_INLINE SimdFloat4 NormalizeSafe3(_SimdFloat4 _v, _SimdFloat4 _safe) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z;
+  const float sq_len = (_v.x * _v.x + _v.z * _v.z) + _v.y * _v.y;
   if (sq_len == 0.f) {
     const SimdFloat4 ret = {_safe.x, _safe.y, _safe.z, _v.w};
     return ret;
@@ -691,7 +724,8 @@ OZZ_INLINE SimdFloat4 NormalizeSafe3(_SimdFloat4 _v, _SimdFloat4 _safe) {
 }
 
 OZZ_INLINE SimdFloat4 NormalizeSafe4(_SimdFloat4 _v, _SimdFloat4 _safe) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+    (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   if (sq_len == 0.f) {
     return _safe;
   }
@@ -716,7 +750,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst2(_SimdFloat4 _v, _SimdFloat4 _safe) {
 }
 
 OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z;
+  const float sq_len = (_v.x * _v.x + _v.z * _v.z) + _v.y * _v.y;
   if (sq_len == 0.f) {
     const SimdFloat4 ret = {_safe.x, _safe.y, _safe.z, _v.w};
     return ret;
@@ -728,7 +762,8 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
 }
 
 OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+    (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   if (sq_len == 0.f) {
     return _safe;
   }
@@ -908,6 +943,20 @@ OZZ_INLINE SimdFloat4 ACosX(_SimdFloat4 _v) {
   return ret;
 }
 
+OZZ_INLINE SimdFloat4 ACosEst(_SimdFloat4 _v) {
+  // acos(x) ~= sqrt(1 - x) * P(x) for x in [0,1], and acos(-x) = pi - acos(x).
+  const SimdFloat4 one = simd_float4::one();
+  const SimdFloat4 x = Min(Abs(_v), one);
+  const SimdFloat4 p =
+    MAdd(MAdd(MAdd(simd_float4::Load1(-.0187293f), x,
+                   simd_float4::Load1(.0742610f)), x,
+              simd_float4::Load1(-.2121144f)), x,
+         simd_float4::Load1(1.5707288f));
+  const SimdFloat4 acos = Sqrt(one - x) * p;
+  return Select(CmpLt(_v, simd_float4::zero()),
+                simd_float4::Load1(kPi) - acos, acos);
+}
+
 OZZ_INLINE SimdFloat4 Sin(_SimdFloat4 _v) {
   const SimdFloat4 ret = {
     std::sin(_v.x), std::sin(_v.y), std::sin(_v.z), std::sin(_v.w)};
@@ -1928,22 +1977,22 @@ OZZ_INLINE Float4x4 Float4x4::FromAffine(_SimdFloat4 _translation,
 
 OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(
   const ozz::math::Float4x4& _m, ozz::math::_SimdFloat4 _v) {
-  const ozz::math::SimdFloat4 ret = {_m.cols[0].x * _v.x +
-                                     _m.cols[1].x * _v.y +
-                                     _m.cols[2].x * _v.z +
-                                     _m.cols[3].x,
-                                     _m.cols[0].y * _v.x +
-                                     _m.cols[1].y * _v.y +
-                                     _m.cols[2].y * _v.z +
-                                     _m.cols[3].y,
-                                     _m.cols[0].z * _v.x +
-                                     _m.cols[1].z * _v.y +
-                                     _m.cols[2].z * _v.z +
-                                     _m.cols[3].z,
-                                     _m.cols[0].w * _v.x +
-                                     _m.cols[1].w * _v.y +
-                                     _m.cols[2].w * _v.z +
-                                     _m.cols[3].w};
+  const ozz::math::SimdFloat4 ret = {(_m.cols[0].x * _v.x +
+                                      _m.cols[1].x * _v.y) +
+                                     (_m.cols[2].x * _v.z +
+                                      _m.cols[3].x),
+                                     (_m.cols[0].y * _v.x +
+                                      _m.cols[1].y * _v.y) +
+                                     (_m.cols[2].y * _v.z +
+                                      _m.cols[3].y),
+                                     (_m.cols[0].z * _v.x +
+                                      _m.cols[1].z * _v.y) +
+                                     (_m.cols[2].z * _v.z +
+                                      _m.cols[3].z),
+                                     (_m.cols[0].w * _v.x +
+                                      _m.cols[1].w * _v.y) +
+                                     (_m.cols[2].w * _v.z +
+                                      _m.cols[3].w)};
   return ret;
 }
 
@@ -2001,22 +2050,22 @@ OZZ_INLINE ozz::math::SimdFloat4 operator/(
 
 OZZ_INLINE ozz::math::SimdFloat4 operator*(
   const ozz::math::Float4x4& _m, ozz::math::_SimdFloat4 _v) {
-  const ozz::math::SimdFloat4 ret = {_m.cols[0].x * _v.x +
-                                     _m.cols[1].x * _v.y +
-                                     _m.cols[2].x * _v.z +
-                                     _m.cols[3].x * _v.w,
-                                     _m.cols[0].y * _v.x +
-                                     _m.cols[1].y * _v.y +
-                                     _m.cols[2].y * _v.z +
-                                     _m.cols[3].y * _v.w,
-                                     _m.cols[0].z * _v.x +
-                                     _m.cols[1].z * _v.y +
-                                     _m.cols[2].z * _v.z +
-                                     _m.cols[3].z * _v.w,
-                                     _m.cols[0].w * _v.x +
-                                     _m.cols[1].w * _v.y +
-                                     _m.cols[2].w * _v.z +
-                                     _m.cols[3].w * _v.w};
+  const ozz::math::SimdFloat4 ret = {(_m.cols[0].x * _v.x +
+                                      _m.cols[1].x * _v.y) +
+                                     (_m.cols[2].x * _v.z +
+                                      _m.cols[3].x * _v.w),
+                                     (_m.cols[0].y * _v.x +
+                                      _m.cols[1].y * _v.y) +
+                                     (_m.cols[2].y * _v.z +
+                                      _m.cols[3].y * _v.w),
+                                     (_m.cols[0].z * _v.x +
+                                      _m.cols[1].z * _v.y) +
+                                     (_m.cols[2].z * _v.z +
+                                      _m.cols[3].z * _v.w),
+                                     (_m.cols[0].w * _v.x +
+                                      _m.cols[1].w * _v.y) +
+                                     (_m.cols[2].w * _v.z +
+                                      _m.cols[3].w * _v.w)};
   return ret;
 }
 
@@ -87,6 +87,32 @@ namespace simd_float4 {
   _mm_xor_ps(_false, _mm_and_ps(_mm_castsi128_ps(_b),\
                                 _mm_xor_ps(_true, _false)))\
 
+// Computes _a * _b + _c, using a single fused multiply-add instruction when
+// FMA3 is available. Deterministic builds never fuse, as the reference and
+// NEON implementations round the intermediate product.
+#if defined(OZZ_HAS_FMA) && !defined(OZZ_HAS_DETERMINISM)
+#define OZZ_SSE_MADD(_a, _b, _c) _mm_fmadd_ps(_a, _b, _c)
+#else  // OZZ_HAS_FMA && !OZZ_HAS_DETERMINISM
+#define OZZ_SSE_MADD(_a, _b, _c) _mm_add_ps(_mm_mul_ps(_a, _b), _c)
+#endif  // OZZ_HAS_FMA && !OZZ_HAS_DETERMINISM
+
+// Reciprocal and reciprocal square root estimates. rcpps and rsqrtps precision
+// is implementation defined (Intel and AMD cpus return different bits), so
+// deterministic builds replace them with correctly rounded divisions and
+// square roots. Arguments are evaluated more than once.
+#ifdef OZZ_HAS_DETERMINISM
+#define OZZ_SSE_RCP_PS(_v) _mm_div_ps(_mm_set_ps1(1.f), _v)
+#define OZZ_SSE_RCP_SS(_v) _mm_move_ss(_v, _mm_div_ss(_mm_set_ps1(1.f), _v))
+#define OZZ_SSE_RSQRT_PS(_v) _mm_div_ps(_mm_set_ps1(1.f), _mm_sqrt_ps(_v))
+#define OZZ_SSE_RSQRT_SS(_v)\
+  _mm_move_ss(_v, _mm_div_ss(_mm_set_ps1(1.f), _mm_sqrt_ss(_v)))
+#else  // OZZ_HAS_DETERMINISM
+#define OZZ_SSE_RCP_PS(_v) _mm_rcp_ps(_v)
+#define OZZ_SSE_RCP_SS(_v) _mm_rcp_ss(_v)
+#define OZZ_SSE_RSQRT_PS(_v) _mm_rsqrt_ps(_v)
+#define OZZ_SSE_RSQRT_SS(_v) _mm_rsqrt_ss(_v)
+#endif  // OZZ_HAS_DETERMINISM
+
 #define OZZ_SSE_SPLAT_I(_v, _i)\
   _mm_castps_si128(_mm_shuffle_ps(\
     _mm_castsi128_ps(_v),\
@@ -236,6 +262,15 @@ OZZ_INLINE void StorePtr(_SimdFloat4 _v, float* _f) {
   _mm_store_ps(_f, _v);
 }
 
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  _mm_stream_ps(_f, _v);
+}
+
+OZZ_INLINE void StreamFence() {
+  _mm_sfence();
+}
+
 OZZ_INLINE void Store1Ptr(_SimdFloat4 _v, float* _f) {
   assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
   _mm_store_ss(_f, _v);
@@ -396,7 +431,7 @@ OZZ_INLINE void Transpose16x16(const SimdFloat4 _in[16], SimdFloat4 _out[16]) {
 
 OZZ_INLINE SimdFloat4 MAdd(
   _SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _addend) {
-  return _mm_add_ps(_mm_mul_ps(_a, _b), _addend);
+  return OZZ_SSE_MADD(_a, _b, _addend);
 }
 
 OZZ_INLINE SimdFloat4 DivX(_SimdFloat4 _a, _SimdFloat4 _b) {
@@ -444,17 +479,22 @@ OZZ_INLINE SimdFloat4 Cross3(_SimdFloat4 _a, _SimdFloat4 _b) {
 }
 
 OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) {
-  return _mm_rcp_ps(_v);
+  return OZZ_SSE_RCP_PS(_v);
 }
 
 OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) {
+#ifdef OZZ_HAS_DETERMINISM
+  // Already correctly rounded, a Newton-Raphson step would only degrade it.
+  return OZZ_SSE_RCP_PS(_v);
+#else  // OZZ_HAS_DETERMINISM
   const __m128 nr = _mm_rcp_ps(_v);
   // Do one more Newton-Raphson step to improve precision.
   return _mm_sub_ps(_mm_add_ps(nr, nr), _mm_mul_ps(_mm_mul_ps(nr, nr), _v));
+#endif  // OZZ_HAS_DETERMINISM
 }
 
 OZZ_INLINE SimdFloat4 RcpEstX(_SimdFloat4 _v) {
-  return _mm_rcp_ss(_v);
+  return OZZ_SSE_RCP_SS(_v);
 }
 
 OZZ_INLINE SimdFloat4 Sqrt(_SimdFloat4 _v) {
@@ -466,19 +506,24 @@ OZZ_INLINE SimdFloat4 SqrtX(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) {
-  return _mm_rsqrt_ps(_v);
+  return OZZ_SSE_RSQRT_PS(_v);
 }
 
 OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) {
+#ifdef OZZ_HAS_DETERMINISM
+  // Already correctly rounded, a Newton-Raphson step would only degrade it.
+  return OZZ_SSE_RSQRT_PS(_v);
+#else  // OZZ_HAS_DETERMINISM
   const __m128 nr = _mm_rsqrt_ps(_v);
   // Do one more Newton-Raphson step to improve precision.
   const __m128 muls = _mm_mul_ps(_mm_mul_ps(_v, nr), nr);
   return _mm_mul_ps(_mm_mul_ps(_mm_set_ps1(.5f), nr),
                     _mm_sub_ps(_mm_set_ps1(3.f), muls));
+#endif  // OZZ_HAS_DETERMINISM
 }
 
 OZZ_INLINE SimdFloat4 RSqrtEstX(_SimdFloat4 _v) {
-  return _mm_rsqrt_ss(_v);
+  return OZZ_SSE_RSQRT_SS(_v);
 }
 
 OZZ_INLINE SimdFloat4 Abs(_SimdFloat4 _v) {
@@ -543,7 +588,7 @@ OZZ_INLINE SimdFloat4 NormalizeEst2(_SimdFloat4 _v) {
   __m128 sq_len;
   OZZ_SSE_DOT2_F(_v, _v, sq_len);
   assert(_mm_cvtss_f32(sq_len) != 0.f && "_v is not normalizable");
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = OZZ_SSE_RSQRT_SS(sq_len);
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128 norm = _mm_mul_ps(_v, inv_lenxxxx);
   return _mm_movelh_ps(norm, _mm_movehl_ps(_v, _v));
@@ -553,7 +598,7 @@ OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) {
   __m128 sq_len;
   OZZ_SSE_DOT3_F(_v, _v, sq_len);
   assert(_mm_cvtss_f32(sq_len) != 0.f && "_v is not normalizable");
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = OZZ_SSE_RSQRT_SS(sq_len);
   const __m128 vwxyz = _mm_shuffle_ps(_v, _v, _MM_SHUFFLE(0, 1, 2, 3));
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128 normwxyz = _mm_move_ss(_mm_mul_ps(vwxyz, inv_lenxxxx), vwxyz);
@@ -564,7 +609,7 @@ OZZ_INLINE SimdFloat4 NormalizeEst4(_SimdFloat4 _v) {
   __m128 sq_len;
   OZZ_SSE_DOT4_F(_v, _v, sq_len);
   assert(_mm_cvtss_f32(sq_len) != 0.f && "_v is not normalizable");
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = OZZ_SSE_RSQRT_SS(sq_len);
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   return _mm_mul_ps(_v, inv_lenxxxx);
 }
@@ -670,7 +715,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafe4(
 OZZ_INLINE SimdFloat4 NormalizeSafeEst2(_SimdFloat4 _v, _SimdFloat4 _safe) {
   __m128 sq_len;
   OZZ_SSE_DOT2_F(_v, _v, sq_len);
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = OZZ_SSE_RSQRT_SS(sq_len);
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128 norm = _mm_mul_ps(_v, inv_lenxxxx);
   const __m128i cond = _mm_castps_si128(
@@ -682,7 +727,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst2(_SimdFloat4 _v, _SimdFloat4 _safe) {
 OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
   __m128 sq_len;
   OZZ_SSE_DOT3_F(_v, _v, sq_len);
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = OZZ_SSE_RSQRT_SS(sq_len);
   const __m128 vwxyz = _mm_shuffle_ps(_v, _v, _MM_SHUFFLE(0, 1, 2, 3));
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128 normwxyz = _mm_move_ss(_mm_mul_ps(vwxyz, inv_lenxxxx), vwxyz);
@@ -696,7 +741,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
 OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
   __m128 sq_len;
   OZZ_SSE_DOT4_F(_v, _v, sq_len);
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = OZZ_SSE_RSQRT_SS(sq_len);
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128i cond = _mm_castps_si128(
     _mm_cmpeq_ps(OZZ_SSE_SPLAT_F(sq_len, 0), _mm_setzero_ps()));
@@ -705,7 +750,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
 }
 
 OZZ_INLINE SimdFloat4 Lerp(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _alpha) {
-  return _mm_add_ps(_mm_mul_ps(_alpha, _mm_sub_ps(_b, _a)), _a);
+  return OZZ_SSE_MADD(_alpha, _mm_sub_ps(_b, _a), _a);
 }
 
 OZZ_INLINE SimdFloat4 Min(_SimdFloat4 _a, _SimdFloat4 _b) {
@@ -798,6 +843,20 @@ OZZ_INLINE SimdFloat4 ACosX(_SimdFloat4 _v) {
                     std::acos(GetX(_v)));
 }
 
+OZZ_INLINE SimdFloat4 ACosEst(_SimdFloat4 _v) {
+  // acos(x) ~= sqrt(1 - x) * P(x) for x in [0,1], and acos(-x) = pi - acos(x).
+  const SimdFloat4 one = simd_float4::one();
+  const SimdFloat4 x = Min(Abs(_v), one);
+  const SimdFloat4 p =
+    MAdd(MAdd(MAdd(simd_float4::Load1(-.0187293f), x,
+                   simd_float4::Load1(.0742610f)), x,
+              simd_float4::Load1(-.2121144f)), x,
+         simd_float4::Load1(1.5707288f));
+  const SimdFloat4 acos = Sqrt(one - x) * p;
+  return Select(CmpLt(_v, simd_float4::zero()),
+                simd_float4::Load1(kPi) - acos, acos);
+}
+
 OZZ_INLINE SimdFloat4 Sin(_SimdFloat4 _v) {
   return _mm_set_ps(std::sin(GetW(_v)),
                     std::sin(GetZ(_v)),
@@ -1404,7 +1463,7 @@ OZZ_INLINE Float4x4 Invert(const Float4x4& _m) {
   det = _mm_mul_ps(c0, minor0);
   det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
   det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
-  tmp1 = _mm_rcp_ss(det);
+  tmp1 = OZZ_SSE_RCP_SS(det);
   det = _mm_sub_ss(_mm_add_ss(tmp1, tmp1),
                    _mm_mul_ss(det, _mm_mul_ss(tmp1, tmp1)));
   det = _mm_shuffle_ps(det, det, 0x00);
@@ -1855,11 +1914,9 @@ OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(
   const __m128 vxxxx = OZZ_SSE_SPLAT_F(_v, 0);
   const __m128 vyyyy = OZZ_SSE_SPLAT_F(_v, 1);
   const __m128 vzzzz = OZZ_SSE_SPLAT_F(_v, 2);
-  const __m128 m0 = _mm_mul_ps(_m.cols[0], vxxxx);
-  const __m128 m1 = _mm_mul_ps(_m.cols[1], vyyyy);
-  const __m128 m2 = _mm_mul_ps(_m.cols[2], vzzzz);
-  const __m128 a01 = _mm_add_ps(m0, m1);
-  const __m128 a23 = _mm_add_ps(m2, _m.cols[3]);
+  const __m128 a01 = OZZ_SSE_MADD(_m.cols[1], vyyyy,
+                                  _mm_mul_ps(_m.cols[0], vxxxx));
+  const __m128 a23 = OZZ_SSE_MADD(_m.cols[2], vzzzz, _m.cols[3]);
   return _mm_add_ps(a01, a23);
 }
 
@@ -1868,11 +1925,9 @@ OZZ_INLINE ozz::math::SimdFloat4 TransformVector(
   const __m128 vxxxx = OZZ_SSE_SPLAT_F(_v, 0);
   const __m128 vyyyy = OZZ_SSE_SPLAT_F(_v, 1);
   const __m128 vzzzz = OZZ_SSE_SPLAT_F(_v, 2);
-  const __m128 m0 = _mm_mul_ps(_m.cols[0], vxxxx);
-  const __m128 m1 = _mm_mul_ps(_m.cols[1], vyyyy);
-  const __m128 m2 = _mm_mul_ps(_m.cols[2], vzzzz);
-  const __m128 a01 = _mm_add_ps(m0, m1);
-  return _mm_add_ps(a01, m2);
+  const __m128 a01 = OZZ_SSE_MADD(_m.cols[1], vyyyy,
+                                  _mm_mul_ps(_m.cols[0], vxxxx));
+  return OZZ_SSE_MADD(_m.cols[2], vzzzz, a01);
 }
 }  // math
 }  // ozz
@@ -1907,15 +1962,13 @@ OZZ_INLINE ozz::math::SimdFloat4 operator*(
   const ozz::math::Float4x4& _m, ozz::math::_SimdFloat4 _v) {
   const __m128 vxxxx = OZZ_SSE_SPLAT_F(_v, 0);
   const __m128 vyyyy = OZZ_SSE_SPLAT_F(_v, 1);
-  const __m128 m0 = _mm_mul_ps(_m.cols[0], vxxxx);
-  const __m128 m1 = _mm_mul_ps(_m.cols[1], vyyyy);
   const __m128 vzzzz = OZZ_SSE_SPLAT_F(_v, 2);
   const __m128 vwwww = OZZ_SSE_SPLAT_F(_v, 3);
-  const __m128 a01 = _mm_add_ps(m0, m1);
-  const __m128 m2 = _mm_mul_ps(_m.cols[2], vzzzz);
-  const __m128 m3 = _mm_mul_ps(_m.cols[3], vwwww);
-  const __m128 a012 = _mm_add_ps(a01, m2);
-  return _mm_add_ps(a012, m3);
+  const __m128 a01 = OZZ_SSE_MADD(_m.cols[1], vyyyy,
+                                  _mm_mul_ps(_m.cols[0], vxxxx));
+  const __m128 a23 = OZZ_SSE_MADD(_m.cols[3], vwwww,
+                                  _mm_mul_ps(_m.cols[2], vzzzz));
+  return _mm_add_ps(a01, a23);
 }
 
 OZZ_INLINE ozz::math::Float4x4 operator*(
@@ -1924,54 +1977,46 @@ OZZ_INLINE ozz::math::Float4x4 operator*(
   {
     const __m128 vxxxx = OZZ_SSE_SPLAT_F(_b.cols[0], 0);
     const __m128 vyyyy = OZZ_SSE_SPLAT_F(_b.cols[0], 1);
-    const __m128 m0 = _mm_mul_ps(_a.cols[0], vxxxx);
-    const __m128 m1 = _mm_mul_ps(_a.cols[1], vyyyy);
     const __m128 vzzzz = OZZ_SSE_SPLAT_F(_b.cols[0], 2);
     const __m128 vwwww = OZZ_SSE_SPLAT_F(_b.cols[0], 3);
-    const __m128 a01 = _mm_add_ps(m0, m1);
-    const __m128 m2 = _mm_mul_ps(_a.cols[2], vzzzz);
-    const __m128 m3 = _mm_mul_ps(_a.cols[3], vwwww);
-    const __m128 a012 = _mm_add_ps(a01, m2);
-    ret.cols[0] = _mm_add_ps(a012, m3);
+    const __m128 a01 = OZZ_SSE_MADD(_a.cols[1], vyyyy,
+                                    _mm_mul_ps(_a.cols[0], vxxxx));
+    const __m128 a23 = OZZ_SSE_MADD(_a.cols[3], vwwww,
+                                    _mm_mul_ps(_a.cols[2], vzzzz));
+    ret.cols[0] = _mm_add_ps(a01, a23);
   }
   {
     const __m128 vxxxx = OZZ_SSE_SPLAT_F(_b.cols[1], 0);
     const __m128 vyyyy = OZZ_SSE_SPLAT_F(_b.cols[1], 1);
-    const __m128 m0 = _mm_mul_ps(_a.cols[0], vxxxx);
-    const __m128 m1 = _mm_mul_ps(_a.cols[1], vyyyy);
     const __m128 vzzzz = OZZ_SSE_SPLAT_F(_b.cols[1], 2);
     const __m128 vwwww = OZZ_SSE_SPLAT_F(_b.cols[1], 3);
-    const __m128 a01 = _mm_add_ps(m0, m1);
-    const __m128 m2 = _mm_mul_ps(_a.cols[2], vzzzz);
-    const __m128 m3 = _mm_mul_ps(_a.cols[3], vwwww);
-    const __m128 a012 = _mm_add_ps(a01, m2);
-    ret.cols[1] = _mm_add_ps(a012, m3);
+    const __m128 a01 = OZZ_SSE_MADD(_a.cols[1], vyyyy,
+                                    _mm_mul_ps(_a.cols[0], vxxxx));
+    const __m128 a23 = OZZ_SSE_MADD(_a.cols[3], vwwww,
+                                    _mm_mul_ps(_a.cols[2], vzzzz));
+    ret.cols[1] = _mm_add_ps(a01, a23);
   }
   {
     const __m128 vxxxx = OZZ_SSE_SPLAT_F(_b.cols[2], 0);
     const __m128 vyyyy = OZZ_SSE_SPLAT_F(_b.cols[2], 1);
-    const __m128 m0 = _mm_mul_ps(_a.cols[0], vxxxx);
-    const __m128 m1 = _mm_mul_ps(_a.cols[1], vyyyy);
     const __m128 vzzzz = OZZ_SSE_SPLAT_F(_b.cols[2], 2);
     const __m128 vwwww = OZZ_SSE_SPLAT_F(_b.cols[2], 3);
-    const __m128 a01 = _mm_add_ps(m0, m1);
-    const __m128 m2 = _mm_mul_ps(_a.cols[2], vzzzz);
-    const __m128 m3 = _mm_mul_ps(_a.cols[3], vwwww);
-    const __m128 a012 = _mm_add_ps(a01, m2);
-    ret.cols[2] = _mm_add_ps(a012, m3);
+    const __m128 a01 = OZZ_SSE_MADD(_a.cols[1], vyyyy,
+                                    _mm_mul_ps(_a.cols[0], vxxxx));
+    const __m128 a23 = OZZ_SSE_MADD(_a.cols[3], vwwww,
+                                    _mm_mul_ps(_a.cols[2], vzzzz));
+    ret.cols[2] = _mm_add_ps(a01, a23);
   }
   {
     const __m128 vxxxx = OZZ_SSE_SPLAT_F(_b.cols[3], 0);
     const __m128 vyyyy = OZZ_SSE_SPLAT_F(_b.cols[3], 1);
-    const __m128 m0 = _mm_mul_ps(_a.cols[0], vxxxx);
-    const __m128 m1 = _mm_mul_ps(_a.cols[1], vyyyy);
     const __m128 vzzzz = OZZ_SSE_SPLAT_F(_b.cols[3], 2);
     const __m128 vwwww = OZZ_SSE_SPLAT_F(_b.cols[3], 3);
-    const __m128 a01 = _mm_add_ps(m0, m1);
-    const __m128 m2 = _mm_mul_ps(_a.cols[2], vzzzz);
-    const __m128 m3 = _mm_mul_ps(_a.cols[3], vwwww);
-    const __m128 a012 = _mm_add_ps(a01, m2);
-    ret.cols[3] = _mm_add_ps(a012, m3);
+    const __m128 a01 = OZZ_SSE_MADD(_a.cols[1], vyyyy,
+                                    _mm_mul_ps(_a.cols[0], vxxxx));
+    const __m128 a23 = OZZ_SSE_MADD(_a.cols[3], vwwww,
+                                    _mm_mul_ps(_a.cols[2], vzzzz));
+    ret.cols[3] = _mm_add_ps(a01, a23);
   }
   return ret;
 }
@@ -2005,6 +2050,28 @@ OZZ_INLINE float HalfToFloat(uint16_t _h) {
   return _mm_cvtss_f32(HalfToFloat(_mm_set1_epi32(_h)));
 }
 
+#ifdef OZZ_HAS_F16C
+// Half <-> Float implementation uses F16C hardware conversions. Halves are
+// stored in the low 16 bits of each 32 bits lane, so they need to be packed
+// and unpacked.
+OZZ_INLINE SimdInt4 FloatToHalf(_SimdFloat4 _f) {
+  const __m128i h = _mm_unpacklo_epi16(
+      _mm_cvtps_ph(_f, _MM_FROUND_TO_NEAREST_INT), _mm_setzero_si128());
+  // Hardware conversion preserves NaN payloads, where emulation outputs a
+  // canonical quiet NaN.
+  const __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(_f, _f));
+  const __m128i qnan = _mm_or_si128(_mm_and_si128(h, _mm_set1_epi32(0x8000)),
+                                    _mm_set1_epi32(0x7e00));
+  return _mm_or_si128(_mm_andnot_si128(nan, h), _mm_and_si128(nan, qnan));
+}
+
+OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
+  // Packs the low 16 bits of each lane, ignoring high bits.
+  const __m128i pack = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13,
+                                     -1, -1, -1, -1, -1, -1, -1, -1);
+  return _mm_cvtph_ps(_mm_shuffle_epi8(_h, pack));
+}
+#else  // OZZ_HAS_F16C
 // Half <-> Float implementation is based on:
 // http://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/.
 OZZ_INLINE SimdInt4 FloatToHalf(_SimdFloat4 _f) {
@@ -2055,6 +2122,7 @@ OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
   const __m128  sign_inf = _mm_or_ps(_mm_castsi128_ps(sign), infnanexp);
   return _mm_or_ps(scaled, sign_inf);
 }
+#endif  // OZZ_HAS_F16C
 }  // math
 }  // ozz
 
@@ -2068,4 +2136,8 @@ OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
 #undef OZZ_SSE_SELECT_F
 #undef OZZ_SSE_SPLAT_I
 #undef OZZ_SSE_SELECT_I
+#undef OZZ_SSE_RCP_PS
+#undef OZZ_SSE_RCP_SS
+#undef OZZ_SSE_RSQRT_PS
+#undef OZZ_SSE_RSQRT_SS
 #endif  // OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_SSE_INL_H_
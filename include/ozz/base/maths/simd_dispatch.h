@@ -0,0 +1,89 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_DISPATCH_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_DISPATCH_H_
+
+// Provides runtime dispatch of hot kernels to the best x86 instruction set
+// supported by the cpu, so that a single binary built for the lowest common
+// denominator (see ozz_build_sse2 cmake option) runs at full speed everywhere.
+//
+// OZZ_SIMD_DISPATCH, placed before a function declaration, compiles the
+// function for SSE4.1, AVX2 and AVX-512 in addition to the default instruction
+// set. The best variant is selected once, at load time, through CPUID. Simd
+// math functions inlined in a dispatched kernel are encoded with the kernel's
+// instruction set (VEX encoding with AVX), and scalar parts of the kernel can
+// be vectorized accordingly.
+// Dispatch is enabled with ozz_build_simd_dispatch cmake option. It requires a
+// compiler that supports function multi-versioning (gcc, clang) and an ELF
+// target (ifunc). OZZ_SIMD_DISPATCH_ENABLED is defined in this case,
+// OZZ_SIMD_DISPATCH is empty otherwise, or if the build already targets AVX.
+
+#include "ozz/base/maths/internal/simd_math_config.h"
+
+#if defined(OZZ_HAS_SIMD_DISPATCH) && defined(OZZ_HAS_SSEx) && \
+    !defined(OZZ_HAS_AVX) && defined(__GNUC__) && defined(__ELF__) && \
+    defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define OZZ_SIMD_DISPATCH_ENABLED
+#define OZZ_SIMD_DISPATCH \
+  __attribute__((target_clones("avx512f", "avx2", "sse4.1", "default")))
+#endif  // __has_attribute(target_clones)
+#endif
+
+#ifndef OZZ_SIMD_DISPATCH
+#define OZZ_SIMD_DISPATCH
+#endif  // OZZ_SIMD_DISPATCH
+
+namespace ozz {
+namespace math {
+
+// Enumerates the instruction sets dispatched kernels can be compiled for.
+enum SimdLevel {
+  kSimdLevelDefault,  // Build instruction set, no dispatch.
+  kSimdLevelSse4_1,
+  kSimdLevelAvx2,
+  kSimdLevelAvx512,
+};
+
+// Returns true if runtime dispatch is enabled for this build, meaning that
+// OZZ_SIMD_DISPATCH kernels are multi-versioned.
+bool IsSimdDispatchEnabled();
+
+// Returns the instruction set dispatched kernels run with on this cpu.
+// Returns kSimdLevelDefault if dispatch isn't enabled, or if the cpu doesn't
+// support any of the dispatched instruction sets.
+SimdLevel GetDispatchedSimdLevel();
+
+// Returns a printable name for _level.
+const char* GetSimdLevelName(SimdLevel _level);
+}  // math
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_DISPATCH_H_
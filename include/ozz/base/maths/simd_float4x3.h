@@ -0,0 +1,148 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_FLOAT4X3_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_FLOAT4X3_H_
+
+// Provides Float4x3, a compact 48 bytes affine matrix type. Float4x3 stores
+// the 3 first rows of an affine transformation, the last row being implicitly
+// (0, 0, 0, 1). This is the layout usually expected by skinning shaders and
+// constant buffers, which saves 25% of the memory and bandwidth of a Float4x4.
+// Float4x3 is built on top of SimdFloat4 functions, so it runs on all the
+// simd implementations.
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace math {
+
+// Declares the affine 4x3 matrix type. Uses the row major convention, where
+// the matrix-times-vector is written v'=Mv:
+// [ m.rows[0].x m.rows[0].y m.rows[0].z m.rows[0].w ]   {v.x}
+// | m.rows[1].x m.rows[1].y m.rows[1].z m.rows[1].w | * {v.y}
+// | m.rows[2].x m.rows[2].y m.rows[2].z m.rows[2].w |   {v.z}
+// [ 0           0           0           1           ]   {v.1}
+// Translation is thus stored in the w component of the 3 rows.
+struct Float4x3 {
+  // Matrix rows.
+  SimdFloat4 rows[3];
+
+  // Returns the identity matrix.
+  static OZZ_INLINE Float4x3 identity() {
+    const Float4x3 ret = {{simd_float4::x_axis(),
+                           simd_float4::y_axis(),
+                           simd_float4::z_axis()}};
+    return ret;
+  }
+
+  // Returns the 4x3 matrix built from the 3 first rows of _m. The last row of
+  // _m is expected to be (0, 0, 0, 1), which is the case of affine matrices.
+  static OZZ_INLINE Float4x3 FromFloat4x4(const Float4x4& _m) {
+    Float4x3 ret;
+    Transpose4x3(_m.cols, ret.rows);
+    return ret;
+  }
+};
+
+// Returns the Float4x4 matrix equivalent to _m, whose last row is
+// (0, 0, 0, 1).
+OZZ_INLINE Float4x4 ToFloat4x4(const Float4x3& _m) {
+  Float4x4 ret;
+  Transpose3x4(_m.rows, ret.cols);
+  ret.cols[3] = SetW(ret.cols[3], 1.f);
+  return ret;
+}
+
+// Multiplies each row of matrix _m with vector _v.
+// Multiplying by a splatted value scales all the matrix coefficients, which
+// is what weighted matrix blending (skinning) requires.
+OZZ_INLINE Float4x3 RowMultiply(const Float4x3& _m, _SimdFloat4 _v) {
+  const Float4x3 ret = {{_m.rows[0] * _v,
+                         _m.rows[1] * _v,
+                         _m.rows[2] * _v}};
+  return ret;
+}
+
+// Computes the transformation of a Float4x3 matrix and a point _p.
+// This is equivalent to multiplying a matrix by a SimdFloat4 with a w component
+// of 1. w component of the returned vector is 0.
+OZZ_INLINE SimdFloat4 TransformPoint(const Float4x3& _m, _SimdFloat4 _p) {
+  SimdFloat4 cols[4];
+  Transpose3x4(_m.rows, cols);
+  const SimdFloat4 xxxx = cols[0] * SplatX(_p);
+  const SimdFloat4 a23 = MAdd(cols[2], SplatZ(_p), cols[3]);
+  const SimdFloat4 a01 = MAdd(cols[1], SplatY(_p), xxxx);
+  return a01 + a23;
+}
+
+// Computes the transformation of a Float4x3 matrix and a vector _v.
+// This is equivalent to multiplying a matrix by a SimdFloat4 with a w component
+// of 0. w component of the returned vector is 0.
+OZZ_INLINE SimdFloat4 TransformVector(const Float4x3& _m, _SimdFloat4 _v) {
+  SimdFloat4 cols[4];
+  Transpose3x4(_m.rows, cols);
+  const SimdFloat4 xxxx = cols[0] * SplatX(_v);
+  const SimdFloat4 zzzz = cols[2] * SplatZ(_v);
+  const SimdFloat4 a01 = MAdd(cols[1], SplatY(_v), xxxx);
+  return a01 + zzzz;
+}
+}  // math
+}  // ozz
+
+// Computes the multiplication of affine matrices _a and _b. This requires 9
+// multiplications, compared to the 16 of a Float4x4 multiplication.
+OZZ_INLINE ozz::math::Float4x3 operator*(const ozz::math::Float4x3& _a,
+                                         const ozz::math::Float4x3& _b) {
+  using ozz::math::SimdFloat4;
+  ozz::math::Float4x3 ret;
+  for (int i = 0; i < 3; ++i) {
+    const SimdFloat4 row = _a.rows[i];
+    const SimdFloat4 translation =
+      ozz::math::And(row, ozz::math::simd_int4::mask_000f());
+    const SimdFloat4 a01 =
+      ozz::math::MAdd(ozz::math::SplatY(row), _b.rows[1],
+                      ozz::math::SplatX(row) * _b.rows[0]);
+    const SimdFloat4 a2t =
+      ozz::math::MAdd(ozz::math::SplatZ(row), _b.rows[2], translation);
+    ret.rows[i] = a01 + a2t;
+  }
+  return ret;
+}
+
+// Computes the per element addition of matrices _a and _b.
+OZZ_INLINE ozz::math::Float4x3 operator+(const ozz::math::Float4x3& _a,
+                                         const ozz::math::Float4x3& _b) {
+  const ozz::math::Float4x3 ret = {{_a.rows[0] + _b.rows[0],
+                                    _a.rows[1] + _b.rows[1],
+                                    _a.rows[2] + _b.rows[2]}};
+  return ret;
+}
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_FLOAT4X3_H_
@@ -0,0 +1,345 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_FLOAT8_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_FLOAT8_H_
+
+// Provides 8-wide simd floating point vectors, SimdFloat8. SimdFloat8 maps to
+// a single AVX register when AVX instructions set is enabled (see
+// ozz_build_avx2 cmake option), or to a pair of SimdFloat4 otherwise. This
+// allows to write 8-wide algorithms that are portable to all platforms.
+// SimdFloat8 can be built from, and split back to, two SimdFloat4. This is
+// the way 8-wide algorithms process two consecutive soa elements of 4-wide
+// runtime data structures.
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+#if defined(OZZ_HAS_AVX)
+
+namespace ozz {
+namespace math {
+
+// Vector of eight floating point values.
+typedef __m256 SimdFloat8;
+
+// Argument type for SimdFloat8.
+typedef const __m256 _SimdFloat8;
+}  // math
+}  // ozz
+
+#else  // OZZ_HAS_AVX
+
+// Declares SimdFloat8 emulation outside of ozz::math, in order to match
+// reference SimdFloat4 implementation details (operators lookup).
+struct SimdFloat8Def {
+  ozz::math::SimdFloat4 lo;
+  ozz::math::SimdFloat4 hi;
+};
+
+namespace ozz {
+namespace math {
+
+// Vector of eight floating point values, emulated with two SimdFloat4.
+typedef SimdFloat8Def SimdFloat8;
+
+// Argument type for SimdFloat8.
+typedef const SimdFloat8& _SimdFloat8;
+}  // math
+}  // ozz
+#endif  // OZZ_HAS_AVX
+
+namespace ozz {
+namespace math {
+namespace simd_float8 {
+
+#if defined(OZZ_HAS_AVX)
+
+// Returns a SimdFloat8 vector with all components set to 0.
+OZZ_INLINE SimdFloat8 zero() {
+  return _mm256_setzero_ps();
+}
+
+// Returns a SimdFloat8 vector with all components set to 1.
+OZZ_INLINE SimdFloat8 one() {
+  return _mm256_set1_ps(1.f);
+}
+
+// Returns a SimdFloat8 vector with all components set to _x.
+OZZ_INLINE SimdFloat8 Load1(float _x) {
+  return _mm256_set1_ps(_x);
+}
+
+// Loads eight floating point values from an unaligned array _f.
+OZZ_INLINE SimdFloat8 LoadPtrU(const float* _f) {
+  return _mm256_loadu_ps(_f);
+}
+
+// Builds a SimdFloat8 from two SimdFloat4. _lo is stored in the 4 first
+// components, _hi in the 4 last.
+OZZ_INLINE SimdFloat8 Load(_SimdFloat4 _lo, _SimdFloat4 _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+#else  // OZZ_HAS_AVX
+
+OZZ_INLINE SimdFloat8 zero() {
+  const SimdFloat8 r = {simd_float4::zero(), simd_float4::zero()};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 one() {
+  const SimdFloat8 r = {simd_float4::one(), simd_float4::one()};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Load1(float _x) {
+  const SimdFloat4 x = simd_float4::Load1(_x);
+  const SimdFloat8 r = {x, x};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 LoadPtrU(const float* _f) {
+  const SimdFloat8 r = {simd_float4::LoadPtrU(_f),
+                        simd_float4::LoadPtrU(_f + 4)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Load(_SimdFloat4 _lo, _SimdFloat4 _hi) {
+  const SimdFloat8 r = {_lo, _hi};
+  return r;
+}
+#endif  // OZZ_HAS_AVX
+}  // simd_float8
+
+#if defined(OZZ_HAS_AVX)
+
+// Returns the 4 first components of _v.
+OZZ_INLINE SimdFloat4 GetLow(_SimdFloat8 _v) {
+  return _mm256_castps256_ps128(_v);
+}
+
+// Returns the 4 last components of _v.
+OZZ_INLINE SimdFloat4 GetHigh(_SimdFloat8 _v) {
+  return _mm256_extractf128_ps(_v, 1);
+}
+
+// Stores the 8 components of _v to the unaligned float array _f.
+OZZ_INLINE void StorePtrU(_SimdFloat8 _v, float* _f) {
+  _mm256_storeu_ps(_f, _v);
+}
+
+// Returns per element (_a * _b) + _addend.
+OZZ_INLINE SimdFloat8 MAdd(_SimdFloat8 _a, _SimdFloat8 _b,
+                           _SimdFloat8 _addend) {
+#if defined(__FMA__) && !defined(OZZ_HAS_DETERMINISM)
+  return _mm256_fmadd_ps(_a, _b, _addend);
+#else  // __FMA__ && !OZZ_HAS_DETERMINISM
+  return _mm256_add_ps(_mm256_mul_ps(_a, _b), _addend);
+#endif  // __FMA__ && !OZZ_HAS_DETERMINISM
+}
+
+// Returns the per component minimum of _a and _b.
+OZZ_INLINE SimdFloat8 Min(_SimdFloat8 _a, _SimdFloat8 _b) {
+  return _mm256_min_ps(_a, _b);
+}
+
+// Returns the per component maximum of _a and _b.
+OZZ_INLINE SimdFloat8 Max(_SimdFloat8 _a, _SimdFloat8 _b) {
+  return _mm256_max_ps(_a, _b);
+}
+
+// Returns the per component estimated reciprocal of _v.
+OZZ_INLINE SimdFloat8 RcpEst(_SimdFloat8 _v) {
+#ifdef OZZ_HAS_DETERMINISM
+  return _mm256_div_ps(_mm256_set1_ps(1.f), _v);
+#else  // OZZ_HAS_DETERMINISM
+  return _mm256_rcp_ps(_v);
+#endif  // OZZ_HAS_DETERMINISM
+}
+
+// Returns the per component estimated reciprocal of _v, with one more
+// Newton-Raphson step to improve precision.
+OZZ_INLINE SimdFloat8 RcpEstNR(_SimdFloat8 _v) {
+#ifdef OZZ_HAS_DETERMINISM
+  return RcpEst(_v);
+#else  // OZZ_HAS_DETERMINISM
+  const __m256 nr = _mm256_rcp_ps(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  return _mm256_sub_ps(_mm256_add_ps(nr, nr),
+                       _mm256_mul_ps(_mm256_mul_ps(nr, nr), _v));
+#endif  // OZZ_HAS_DETERMINISM
+}
+
+// Returns the per component square root of _v.
+OZZ_INLINE SimdFloat8 Sqrt(_SimdFloat8 _v) {
+  return _mm256_sqrt_ps(_v);
+}
+
+// Returns the per component estimated reciprocal square root of _v.
+OZZ_INLINE SimdFloat8 RSqrtEst(_SimdFloat8 _v) {
+#ifdef OZZ_HAS_DETERMINISM
+  return _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(_v));
+#else  // OZZ_HAS_DETERMINISM
+  return _mm256_rsqrt_ps(_v);
+#endif  // OZZ_HAS_DETERMINISM
+}
+
+// Returns the per component estimated reciprocal square root of _v, with one
+// more Newton-Raphson step to improve precision.
+OZZ_INLINE SimdFloat8 RSqrtEstNR(_SimdFloat8 _v) {
+#ifdef OZZ_HAS_DETERMINISM
+  return RSqrtEst(_v);
+#else  // OZZ_HAS_DETERMINISM
+  const __m256 nr = _mm256_rsqrt_ps(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  const __m256 muls = _mm256_mul_ps(_mm256_mul_ps(_v, nr), nr);
+  return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(.5f), nr),
+                       _mm256_sub_ps(_mm256_set1_ps(3.f), muls));
+#endif  // OZZ_HAS_DETERMINISM
+}
+
+#else  // OZZ_HAS_AVX
+
+OZZ_INLINE SimdFloat4 GetLow(_SimdFloat8 _v) {
+  return _v.lo;
+}
+
+OZZ_INLINE SimdFloat4 GetHigh(_SimdFloat8 _v) {
+  return _v.hi;
+}
+
+OZZ_INLINE void StorePtrU(_SimdFloat8 _v, float* _f) {
+  StorePtrU(_v.lo, _f);
+  StorePtrU(_v.hi, _f + 4);
+}
+
+OZZ_INLINE SimdFloat8 MAdd(_SimdFloat8 _a, _SimdFloat8 _b,
+                           _SimdFloat8 _addend) {
+  const SimdFloat8 r = {MAdd(_a.lo, _b.lo, _addend.lo),
+                        MAdd(_a.hi, _b.hi, _addend.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Min(_SimdFloat8 _a, _SimdFloat8 _b) {
+  const SimdFloat8 r = {Min(_a.lo, _b.lo), Min(_a.hi, _b.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Max(_SimdFloat8 _a, _SimdFloat8 _b) {
+  const SimdFloat8 r = {Max(_a.lo, _b.lo), Max(_a.hi, _b.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 RcpEst(_SimdFloat8 _v) {
+  const SimdFloat8 r = {RcpEst(_v.lo), RcpEst(_v.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 RcpEstNR(_SimdFloat8 _v) {
+  const SimdFloat8 r = {RcpEstNR(_v.lo), RcpEstNR(_v.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Sqrt(_SimdFloat8 _v) {
+  const SimdFloat8 r = {Sqrt(_v.lo), Sqrt(_v.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 RSqrtEst(_SimdFloat8 _v) {
+  const SimdFloat8 r = {RSqrtEst(_v.lo), RSqrtEst(_v.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 RSqrtEstNR(_SimdFloat8 _v) {
+  const SimdFloat8 r = {RSqrtEstNR(_v.lo), RSqrtEstNR(_v.hi)};
+  return r;
+}
+#endif  // OZZ_HAS_AVX
+}  // math
+}  // ozz
+
+#if defined(OZZ_HAS_AVX)
+#if !defined(__GNUC__)
+OZZ_INLINE ozz::math::SimdFloat8 operator+(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_add_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_sub_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(ozz::math::_SimdFloat8 _v) {
+  return _mm256_sub_ps(_mm256_setzero_ps(), _v);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator*(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_mul_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator/(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_div_ps(_a, _b);
+}
+#endif  // !defined(__GNUC__)
+#else  // OZZ_HAS_AVX
+OZZ_INLINE ozz::math::SimdFloat8 operator+(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  const ozz::math::SimdFloat8 r = {_a.lo + _b.lo, _a.hi + _b.hi};
+  return r;
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  const ozz::math::SimdFloat8 r = {_a.lo - _b.lo, _a.hi - _b.hi};
+  return r;
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(ozz::math::_SimdFloat8 _v) {
+  const ozz::math::SimdFloat8 r = {-_v.lo, -_v.hi};
+  return r;
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator*(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  const ozz::math::SimdFloat8 r = {_a.lo * _b.lo, _a.hi * _b.hi};
+  return r;
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator/(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  const ozz::math::SimdFloat8 r = {_a.lo / _b.lo, _a.hi / _b.hi};
+  return r;
+}
+#endif  // OZZ_HAS_AVX
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_FLOAT8_H_
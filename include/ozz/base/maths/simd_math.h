@@ -172,6 +172,22 @@ OZZ_INLINE SimdFloat4 SetI(_SimdFloat4 _v, int _i, float _f);
 // _f[3] = _v.w
 OZZ_INLINE void StorePtr(_SimdFloat4 _v, float* _f);
 
+// Stores the 4 components of _v to the four first floats of _f, using a
+// non-temporal hint: the write bypasses caches, which suits write-combined
+// memory (like GPU mapped buffers) that isn't read back by the cpu.
+// StreamFence() must be called once all non-temporal stores are issued.
+// Platforms without non-temporal stores fall back to StorePtr.
+// _f must be aligned to 16 bytes.
+// _f[0] = _v.x
+// _f[1] = _v.y
+// _f[2] = _v.z
+// _f[3] = _v.w
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f);
+
+// Orders all previous non-temporal stores (see StreamPtr) before any following
+// store, so that they are visible once the memory is handed to another agent.
+OZZ_INLINE void StreamFence();
+
 // Stores the x component of _v to the first float of _f.
 // _f must be aligned to 16 bytes.
 // _f[0] = _v.x
@@ -519,6 +535,12 @@ OZZ_INLINE SimdFloat4 ACos(_SimdFloat4 _v);
 // same as their respective components in _v.
 OZZ_INLINE SimdFloat4 ACosX(_SimdFloat4 _v);
 
+// Computes the per element estimated arccosine of _v, with a polynomial
+// approximation (Abramowitz and Stegun 4.4.45) that doesn't leave simd
+// registers. Absolute error is lower than 7e-5 radians. _v is clamped to
+// range [-1,1].
+OZZ_INLINE SimdFloat4 ACosEst(_SimdFloat4 _v);
+
 // Computes the per element sines of _v.
 OZZ_INLINE SimdFloat4 Sin(_SimdFloat4 _v);
 
@@ -1150,6 +1172,8 @@ OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h);
 
 #if defined(OZZ_HAS_SSEx)
 #include "ozz/base/maths/internal/simd_math_sse-inl.h"
+#elif defined(OZZ_HAS_NEON)
+#include "ozz/base/maths/internal/simd_math_neon-inl.h"
 #elif defined(OZZ_HAS_REF)
 #include "ozz/base/maths/internal/simd_math_ref-inl.h"
 #else
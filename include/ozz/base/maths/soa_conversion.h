@@ -0,0 +1,73 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SOA_CONVERSION_H_
+#define OZZ_OZZ_BASE_MATHS_SOA_CONVERSION_H_
+
+// Converts arrays of aos (array of structures) math types, as used by physics
+// or networking integrations, to ozz soa (structure of arrays) types and back.
+// Conversions process 4 elements at a time with simd transpositions. Aos
+// arrays don't need to be aligned, and their count doesn't need to be a
+// multiple of 4: the last soa element is partially converted.
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+
+struct Float3;
+struct Quaternion;
+struct Transform;
+struct SoaFloat3;
+struct SoaQuaternion;
+struct SoaTransform;
+
+// Converts the _aos.Count() elements of _aos to the soa array _soa, which must
+// store at least (_aos.Count() + 3) / 4 elements. The lanes of the last soa
+// element that have no aos counterpart are set to zero for Float3, and to
+// identity for Quaternion and Transform.
+// Returns false if _soa is too small, in which case nothing is converted.
+bool ToSoa(const Range<const Float3>& _aos, const Range<SoaFloat3>& _soa);
+bool ToSoa(const Range<const Quaternion>& _aos,
+           const Range<SoaQuaternion>& _soa);
+bool ToSoa(const Range<const Transform>& _aos,
+           const Range<SoaTransform>& _soa);
+
+// Converts the first _aos.Count() lanes of the soa array _soa to _aos. _soa
+// must store at least (_aos.Count() + 3) / 4 elements.
+// Returns false if _soa is too small, in which case nothing is converted.
+bool FromSoa(const Range<const SoaFloat3>& _soa, const Range<Float3>& _aos);
+bool FromSoa(const Range<const SoaQuaternion>& _soa,
+             const Range<Quaternion>& _aos);
+bool FromSoa(const Range<const SoaTransform>& _soa,
+             const Range<Transform>& _aos);
+}  // math
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SOA_CONVERSION_H_
@@ -111,45 +111,61 @@ struct SoaFloat4x4 {
     return ret;
   }
 
-  // Returns the affine transformation matrix built from split translation,
-  // rotation (quaternion) and scale.
+  // Returns the affine transformation matrix built from split translation and
+  // rotation (quaternion), assuming a unit scale.
   static OZZ_INLINE SoaFloat4x4 FromAffine(const SoaFloat3& _translation,
-                                           const SoaQuaternion& _quaternion,
-                                           const SoaFloat3& _scale) {
+                                           const SoaQuaternion& _quaternion) {
     assert(AreAllTrue(IsNormalizedEst(_quaternion)));
 
     const SimdFloat4 zero = simd_float4::zero();
     const SimdFloat4 one = simd_float4::one();
-    const SimdFloat4 two = one + one;
 
-    const SimdFloat4 xx = _quaternion.x * _quaternion.x;
-    const SimdFloat4 xy = _quaternion.x * _quaternion.y;
-    const SimdFloat4 xz = _quaternion.x * _quaternion.z;
-    const SimdFloat4 xw = _quaternion.x * _quaternion.w;
-    const SimdFloat4 yy = _quaternion.y * _quaternion.y;
-    const SimdFloat4 yz = _quaternion.y * _quaternion.z;
-    const SimdFloat4 yw = _quaternion.y * _quaternion.w;
-    const SimdFloat4 zz = _quaternion.z * _quaternion.z;
-    const SimdFloat4 zw = _quaternion.z * _quaternion.w;
+    // Products are computed with doubled quaternion components, which saves
+    // the multiplications by two. Sums of products are fused multiply-adds
+    // when available.
+    const SimdFloat4 x2 = _quaternion.x + _quaternion.x;
+    const SimdFloat4 y2 = _quaternion.y + _quaternion.y;
+    const SimdFloat4 z2 = _quaternion.z + _quaternion.z;
 
-    const SoaFloat4x4 ret = {{{_scale.x * (one - two * (yy + zz)),
-                               _scale.x * two * (xy + zw),
-                               _scale.x * two * (xz - yw),
-                               zero},
-                              {_scale.y * two * (xy - zw),
-                               _scale.y * (one - two * (xx + zz)),
-                               _scale.y * two * (yz + xw),
-                               zero},
-                              {_scale.z * two * (xz + yw),
-                               _scale.z * two * (yz - xw),
-                               _scale.z * (one - two * (xx + yy)),
-                               zero},
+    const SimdFloat4 xx = _quaternion.x * x2;
+    const SimdFloat4 xy = _quaternion.x * y2;
+    const SimdFloat4 xz = _quaternion.x * z2;
+    const SimdFloat4 xw = _quaternion.w * x2;
+    const SimdFloat4 yw = _quaternion.w * y2;
+    const SimdFloat4 zw = _quaternion.w * z2;
+
+    const SimdFloat4 yy_zz = MAdd(_quaternion.y, y2, _quaternion.z * z2);
+    const SimdFloat4 xx_zz = MAdd(_quaternion.z, z2, xx);
+    const SimdFloat4 xx_yy = MAdd(_quaternion.y, y2, xx);
+    const SimdFloat4 yz = _quaternion.y * z2;
+
+    const SoaFloat4x4 ret = {{{one - yy_zz, xy + zw, xz - yw, zero},
+                              {xy - zw, one - xx_zz, yz + xw, zero},
+                              {xz + yw, yz - xw, one - xx_yy, zero},
                               {_translation.x,
                                _translation.y,
                                _translation.z,
                                one}}};
     return ret;
   }
+
+  // Returns the affine transformation matrix built from split translation,
+  // rotation (quaternion) and scale.
+  static OZZ_INLINE SoaFloat4x4 FromAffine(const SoaFloat3& _translation,
+                                           const SoaQuaternion& _quaternion,
+                                           const SoaFloat3& _scale) {
+    SoaFloat4x4 ret = FromAffine(_translation, _quaternion);
+    ret.cols[0].x = ret.cols[0].x * _scale.x;
+    ret.cols[0].y = ret.cols[0].y * _scale.x;
+    ret.cols[0].z = ret.cols[0].z * _scale.x;
+    ret.cols[1].x = ret.cols[1].x * _scale.y;
+    ret.cols[1].y = ret.cols[1].y * _scale.y;
+    ret.cols[1].z = ret.cols[1].z * _scale.y;
+    ret.cols[2].x = ret.cols[2].x * _scale.z;
+    ret.cols[2].y = ret.cols[2].y * _scale.z;
+    ret.cols[2].z = ret.cols[2].z * _scale.z;
+    return ret;
+  }
 };
 
 // Returns the transpose of matrix _m.
@@ -256,22 +272,16 @@ OZZ_INLINE SoaFloat4x4 Scale(const SoaFloat4x4& _m, const SoaFloat4& _v) {
 // Computes the multiplication of matrix Float4x4 and vector  _v.
 OZZ_INLINE ozz::math::SoaFloat4 operator*(const ozz::math::SoaFloat4x4& _m,
                                           const ozz::math::SoaFloat4& _v) {
-  const ozz::math::SoaFloat4 ret = {_m.cols[0].x * _v.x +
-                                    _m.cols[1].x * _v.y +
-                                    _m.cols[2].x * _v.z +
-                                    _m.cols[3].x * _v.w,
-                                    _m.cols[0].y * _v.x +
-                                    _m.cols[1].y * _v.y +
-                                    _m.cols[2].y * _v.z +
-                                    _m.cols[3].y * _v.w,
-                                    _m.cols[0].z * _v.x +
-                                    _m.cols[1].z * _v.y +
-                                    _m.cols[2].z * _v.z +
-                                    _m.cols[3].z * _v.w,
-                                    _m.cols[0].w * _v.x +
-                                    _m.cols[1].w * _v.y +
-                                    _m.cols[2].w * _v.z +
-                                    _m.cols[3].w * _v.w};
+  using ozz::math::MAdd;
+  const ozz::math::SoaFloat4 ret = {
+    MAdd(_m.cols[1].x, _v.y, _m.cols[0].x * _v.x) +
+      MAdd(_m.cols[3].x, _v.w, _m.cols[2].x * _v.z),
+    MAdd(_m.cols[1].y, _v.y, _m.cols[0].y * _v.x) +
+      MAdd(_m.cols[3].y, _v.w, _m.cols[2].y * _v.z),
+    MAdd(_m.cols[1].z, _v.y, _m.cols[0].z * _v.x) +
+      MAdd(_m.cols[3].z, _v.w, _m.cols[2].z * _v.z),
+    MAdd(_m.cols[1].w, _v.y, _m.cols[0].w * _v.x) +
+      MAdd(_m.cols[3].w, _v.w, _m.cols[2].w * _v.z)};
   return ret;
 }
 
@@ -35,6 +35,7 @@
 
 #include "ozz/base/platform.h"
 #include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/math_constant.h"
 
 namespace ozz {
 namespace math {
@@ -89,6 +90,17 @@ OZZ_INLINE SoaQuaternion NormalizeEst(const SoaQuaternion& _q) {
   return r;
 }
 
+// Returns the fast estimated normalized SoaQuaternion _q. As opposed to
+// NormalizeEst, the reciprocal square root estimate (RSqrtEst) isn't refined
+// with a Newton-Raphson step, which leaves a relative error of about 4e-4 on
+// the normalized quaternion length.
+OZZ_INLINE SoaQuaternion NormalizeFastEst(const SoaQuaternion& _q) {
+  const SimdFloat4 len2 = _q.x * _q.x + _q.y * _q.y + _q.z * _q.z + _q.w * _q.w;
+  const SimdFloat4 inv_len = RSqrtEst(len2);
+  const SoaQuaternion r = {_q.x * inv_len, _q.y * inv_len, _q.z * inv_len, _q.w * inv_len};
+  return r;
+}
+
 // Test if each quaternion of _q is normalized.
 OZZ_INLINE SimdInt4 IsNormalized(const SoaQuaternion& _q) {
   const SimdFloat4 len2 = _q.x * _q.x + _q.y * _q.y + _q.z * _q.z + _q.w * _q.w;
@@ -137,6 +149,70 @@ OZZ_INLINE SoaQuaternion NLerpEst(const SoaQuaternion& _a, const SoaQuaternion&
   const SoaQuaternion r = {lerp.x * inv_len, lerp.y * inv_len, lerp.z * inv_len, lerp.w * inv_len};
   return r;
 }
+
+// Returns the fast estimated linear interpolation of SoaQuaternion _a and _b
+// with coefficient _f. Normalization is estimated as NormalizeFastEst does.
+OZZ_INLINE SoaQuaternion NLerpFastEst(const SoaQuaternion& _a, const SoaQuaternion& _b, _SimdFloat4 _f) {
+  const SoaQuaternion lerp = {(_b.x - _a.x) * _f + _a.x,
+                              (_b.y - _a.y) * _f + _a.y,
+                              (_b.z - _a.z) * _f + _a.z,
+                              (_b.w - _a.w) * _f + _a.w};
+  return NormalizeFastEst(lerp);
+}
+
+namespace internal {
+// Computes the per element estimated sine of _v, which must be in range
+// [0,pi]. Uses sin(x) = sin(pi - x) to fold _v to range [0,pi/2], where a 9th
+// degree polynomial has an absolute error lower than 4e-6.
+OZZ_INLINE SimdFloat4 SinEst0Pi(_SimdFloat4 _v) {
+  const SimdFloat4 x = Min(_v, simd_float4::Load1(kPi) - _v);
+  const SimdFloat4 x2 = x * x;
+  const SimdFloat4 p =
+    MAdd(MAdd(MAdd(MAdd(simd_float4::Load1(1.f / 362880.f), x2,
+                        simd_float4::Load1(-1.f / 5040.f)), x2,
+                   simd_float4::Load1(1.f / 120.f)), x2,
+              simd_float4::Load1(-1.f / 6.f)), x2,
+         simd_float4::one());
+  return x * p;
+}
+}  // internal
+
+// Returns the estimated spherical linear interpolation of SoaQuaternion _a and
+// _b with coefficient _f, in range [0,1]. Like NLerp, quaternions aren't
+// negated to take the shortest path, so _a and _b should be in the same
+// hemisphere.
+// The angle between _a and _b is estimated with ACosEst, and interpolation
+// weights with a polynomial sine, all in simd registers. The result is
+// normalized, and its error on the interpolated angle is lower than 1e-4
+// radians. Quaternions closer than 2e-3 radians are linearly interpolated.
+OZZ_INLINE SoaQuaternion SlerpEst(const SoaQuaternion& _a, const SoaQuaternion& _b, _SimdFloat4 _f) {
+  const SimdFloat4 one = simd_float4::one();
+  const SimdFloat4 cos = _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+  const SimdFloat4 angle = ACosEst(cos);
+  const SimdFloat4 sin = internal::SinEst0Pi(angle);
+  const SimdFloat4 one_minus_f = one - _f;
+  const SimdInt4 linear = CmpLt(sin, simd_float4::Load1(2e-3f));
+  const SimdFloat4 inv_sin = RcpEstNR(Max(sin, simd_float4::Load1(2e-3f)));
+  const SimdFloat4 wa = Select(
+    linear, one_minus_f, internal::SinEst0Pi(one_minus_f * angle) * inv_sin);
+  const SimdFloat4 wb = Select(
+    linear, _f, internal::SinEst0Pi(_f * angle) * inv_sin);
+  const SoaQuaternion r = {_a.x * wa + _b.x * wb,
+                           _a.y * wa + _b.y * wb,
+                           _a.z * wa + _b.z * wb,
+                           _a.w * wa + _b.w * wb};
+  return NormalizeEst(r);
+}
+
+// Returns the estimated angle in radians of the rotation from _a to _b, in
+// range [0,pi]. Both quaternions must be normalized. Opposite quaternions
+// represent the same rotation, so their angle is 0. Uses ACosEst, so the
+// absolute error is lower than 1.4e-4 radians.
+OZZ_INLINE SimdFloat4 AngleEst(const SoaQuaternion& _a, const SoaQuaternion& _b) {
+  const SimdFloat4 cos = _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+  const SimdFloat4 half = ACosEst(Abs(cos));
+  return half + half;
+}
 }  // maths
 }  // ozz
 
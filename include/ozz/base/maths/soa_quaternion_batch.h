@@ -0,0 +1,75 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SOA_QUATERNION_BATCH_H_
+#define OZZ_OZZ_BASE_MATHS_SOA_QUATERNION_BATCH_H_
+
+// Processes arrays of soa quaternions, for custom blending nodes, IK or motion
+// matching that work on thousands of quaternions. Functions process whole
+// arrays with simd kernels (see OZZ_SIMD_DISPATCH), and never go through
+// scalar trigonometry.
+// Output arrays can be the same as input ones.
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace math {
+
+struct SoaQuaternion;
+
+// Interpolates every quaternion of _a with the one of _b, with coefficient
+// _alpha, using NLerpEst.
+// Returns false if _b or _output are smaller than _a, in which case nothing is
+// processed.
+bool NLerpEst(const Range<const SoaQuaternion>& _a,
+              const Range<const SoaQuaternion>& _b,
+              float _alpha,
+              const Range<SoaQuaternion>& _output);
+
+// Interpolates every quaternion of _a with the one of _b, with coefficient
+// _alpha in range [0,1], using SlerpEst.
+// Returns false if _b or _output are smaller than _a, in which case nothing is
+// processed.
+bool SlerpEst(const Range<const SoaQuaternion>& _a,
+              const Range<const SoaQuaternion>& _b,
+              float _alpha,
+              const Range<SoaQuaternion>& _output);
+
+// Computes the angles between every quaternion of _a and the one of _b, using
+// AngleEst.
+// Returns false if _b or _angles are smaller than _a, in which case nothing is
+// processed.
+bool AngleEst(const Range<const SoaQuaternion>& _a,
+              const Range<const SoaQuaternion>& _b,
+              const Range<SimdFloat4>& _angles);
+}  // math
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SOA_QUATERNION_BATCH_H_
@@ -52,6 +52,39 @@ Allocator* default_allocator();
 // Returns current memory allocator, such that in can be restored if needed.
 Allocator* SetDefaulAllocator(Allocator* _allocator);
 
+// Enumerates the tags ozz uses to attribute allocations to its subsystems.
+// Allocators can read the current tag (see current_tag()) to track memory
+// usage, like the TrackingAllocator does.
+enum Tag {
+  kTagDefault,  // Allocations that aren't attributed to a subsystem.
+  kTagAnimation,  // Runtime animations and animation banks.
+  kTagSkeleton,  // Runtime skeletons.
+  kTagCache,  // Sampling caches.
+  kTagOffline,  // Offline builders and the objects they build.
+  kTagCount  // Number of tags, not a valid tag.
+};
+
+// Gets the tag that currently applies to allocations, see ScopedTag.
+Tag current_tag();
+
+// Sets the current tag for the lifetime of a ScopedTag object, and restores
+// the previous one at destruction time. Scopes can be nested.
+// The current tag is a global state, not a thread local one. Allocations made
+// concurrently while a tag is set can thus be attributed to this tag.
+class ScopedTag {
+ public:
+  explicit ScopedTag(Tag _tag);
+  ~ScopedTag();
+
+ private:
+  // Disables copy and assignation.
+  ScopedTag(const ScopedTag&);
+  void operator=(const ScopedTag&);
+
+  // Tag to restore at destruction time.
+  Tag previous_;
+};
+
 // Defines an abstract allocator class.
 // Implements helper methods to allocate/deallocate POD typed objects instead of
 // raw memory.
@@ -0,0 +1,60 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_HUGE_PAGE_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_HUGE_PAGE_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Size of the huge pages the huge page allocator maps large blocks to.
+static const size_t kHugePageSize = 2 << 20;
+
+// Minimum size of the blocks that are mapped to huge pages. Smaller blocks
+// would waste most of their page.
+static const size_t kHugePageThreshold = 1 << 20;
+
+// Gets the huge page allocator, a thread safe allocator that maps large blocks
+// to 2MB pages. It's meant for big key frame buffers (see
+// Animation::SetBufferAllocator) that are randomly accessed while sampling,
+// where 4KB pages cause TLB misses.
+// Blocks of kHugePageThreshold bytes or more are rounded up to kHugePageSize
+// and mapped to huge pages: explicit huge pages (MAP_HUGETLB) or transparent
+// ones (madvise MADV_HUGEPAGE) on Linux, large pages (MEM_LARGE_PAGES) on
+// Windows if the process holds the lock memory privilege. The allocator falls
+// back to regular pages when huge pages aren't available, so allocation only
+// fails if the system is out of memory.
+// Smaller blocks are forwarded to the default allocator.
+Allocator* huge_page_allocator();
+}  // memory
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_HUGE_PAGE_ALLOCATOR_H_
@@ -0,0 +1,187 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements a linear (aka stack or bump) allocator, that serves allocations
+// from a fixed size buffer by incrementing an offset.
+// Deallocate only reclaims the latest allocation, otherwise memory is
+// reclaimed all at once by Reset(), in O(1). This allocator is meant to be
+// used for transient allocations, like per-frame job buffers (SoaTransform,
+// matrices...), that would otherwise go through the global heap.
+// Allocate returns NULL, malloc-like, when the buffer is exhausted.
+// LinearAllocator does not lock, so an instance must not be used by multiple
+// threads concurrently.
+// Allocator interface functions, including typed helpers, are meant to be
+// called through a memory::Allocator pointer or reference.
+class LinearAllocator : public Allocator {
+ public:
+  // Constructs an allocator that serves allocations from a buffer of _size
+  // bytes, allocated from _backing allocator.
+  explicit LinearAllocator(size_t _size,
+                           Allocator* _backing = default_allocator());
+
+  // Constructs an allocator that serves allocations from the external _buffer
+  // of _size bytes. _buffer isn't owned by *this allocator and must outlive it.
+  LinearAllocator(void* _buffer, size_t _size);
+
+  // Deallocates the buffer if it's owned by *this allocator.
+  virtual ~LinearAllocator();
+
+  // Releases all allocations at once. Memory that was allocated from *this
+  // allocator must not be used anymore.
+  void Reset() {
+    top_ = begin_;
+    last_ = NULL;
+  }
+
+  // Gets the number of bytes currently allocated, including alignment padding.
+  size_t used() const {
+    return static_cast<size_t>(top_ - begin_);
+  }
+
+  // Gets buffer size in bytes.
+  size_t capacity() const {
+    return static_cast<size_t>(end_ - begin_);
+  }
+
+ protected:
+  // Allocator interface implementation.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+  virtual void Deallocate(void* _block);
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignation.
+  LinearAllocator(const LinearAllocator&);
+  void operator=(const LinearAllocator&);
+
+  // Allocator used to allocate the buffer, NULL if buffer is external.
+  Allocator* backing_;
+
+  // Buffer range.
+  char* begin_;
+  char* end_;
+
+  // Current allocation offset in the buffer.
+  char* top_;
+
+  // Last allocated block, which can be resized in place.
+  char* last_;
+};
+
+// Implements an arena allocator, that serves allocations linearly from a list
+// of blocks. Unlike LinearAllocator, it isn't limited to a fixed size, as a new
+// block is allocated from the backing allocator when the current one is
+// exhausted.
+// Deallocate only reclaims the latest allocation, otherwise memory is
+// reclaimed all at once by Reset(), in O(1). Reset keeps all blocks for
+// reuse, so once an arena has reached its peak size it doesn't touch the
+// backing allocator anymore. Blocks are released to
+// the backing allocator at destruction time.
+// ArenaAllocator does not lock. It's designed to be owned by a single thread,
+// for example one arena per worker of a tasks::Dispatcher, which is reset at
+// the end of every frame.
+// Allocator interface functions, including typed helpers, are meant to be
+// called through a memory::Allocator pointer or reference.
+class ArenaAllocator : public Allocator {
+ public:
+  // Default arena block size.
+  static const size_t kDefaultBlockSize;
+
+  // Constructs an arena whose blocks of _block_size bytes are allocated from
+  // _backing allocator. Allocations bigger than _block_size get their own
+  // block. No memory is allocated until the first allocation.
+  explicit ArenaAllocator(size_t _block_size = kDefaultBlockSize,
+                          Allocator* _backing = default_allocator());
+
+  // Deallocates all blocks.
+  virtual ~ArenaAllocator();
+
+  // Releases all allocations at once, keeping blocks for reuse. Memory
+  // that was allocated from *this allocator must not be used anymore.
+  void Reset();
+
+  // Gets the number of bytes currently allocated, including alignment padding
+  // and space left at the end of used blocks.
+  size_t used() const;
+
+  // Gets the total size in bytes of all the blocks.
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  // Gets the size in bytes of arena's blocks.
+  size_t block_size() const {
+    return block_size_;
+  }
+
+ protected:
+  // Allocator interface implementation.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+  virtual void Deallocate(void* _block);
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignation.
+  ArenaAllocator(const ArenaAllocator&);
+  void operator=(const ArenaAllocator&);
+
+  // Arena block header, followed by block memory.
+  struct Block;
+
+  // Allocator used to allocate blocks.
+  Allocator* backing_;
+
+  // Default size of the blocks.
+  size_t block_size_;
+
+  // Sum of all blocks size.
+  size_t capacity_;
+
+  // Linked list of blocks, and current block allocations are served from.
+  Block* first_;
+  Block* current_;
+
+  // Current allocation offset in the current block.
+  char* top_;
+
+  // Last allocated block, which can be resized in place.
+  char* last_;
+};
+}  // memory
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
@@ -0,0 +1,76 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_NUMA_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_NUMA_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements an allocator that places memory on a NUMA node, whatever the
+// node of the thread that allocates or first writes it.
+// Every block is mapped to its own pages (rounded up to the system page size),
+// which are bound to the node with a preferred policy: mbind on Linux,
+// VirtualAllocExNuma on Windows. Memory falls back to other nodes if the node
+// is out of memory, and to regular pages on other platforms.
+// This allocator is meant for few and large blocks, like the backing allocator
+// of an ArenaAllocator that stores per node replicas of animation data (see
+// animation::NumaReplicas).
+// NumaAllocator has no state but the node, so it's thread safe.
+class NumaAllocator : public Allocator {
+ public:
+  // Constructs an allocator that places memory on NUMA node _node, see
+  // tasks::ThreadPool::num_numa_nodes().
+  explicit NumaAllocator(int _node);
+
+  // Gets the NUMA node of *this allocator.
+  int node() const {
+    return node_;
+  }
+
+ protected:
+  // Allocator interface implementation.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+  virtual void Deallocate(void* _block);
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignation.
+  NumaAllocator(const NumaAllocator&);
+  void operator=(const NumaAllocator&);
+
+  // NUMA node memory is placed on.
+  int node_;
+};
+}  // memory
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_NUMA_ALLOCATOR_H_
@@ -0,0 +1,61 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_THREAD_CACHING_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_THREAD_CACHING_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Gets the thread caching allocator, a thread safe allocator that can be
+// selected at startup as the default allocator, with
+// SetDefaulAllocator(thread_caching_allocator()). It's meant to scale when
+// jobs are run from many threads.
+// Every thread gets its own cache, that serves small allocations from
+// power-of-2 size classes (up to 32KB) without any lock or atomic operation.
+// Blocks deallocated by the thread that allocated them go back to its cache.
+// Blocks deallocated by another thread are pushed to the owner cache with a
+// lock-free operation, and are reclaimed by the owner on its next cache miss.
+// Large or over-aligned (>16 bytes) allocations are forwarded to malloc.
+// Cache memory is only released to the system when the allocator is destroyed,
+// at program exit.
+Allocator* thread_caching_allocator();
+
+// Releases calling thread's cache, which should be called by threads that
+// used the thread caching allocator before they exit. The cache and its free
+// blocks are then adopted by the next thread that needs a cache. Memory
+// allocated by the calling thread remains valid and can be deallocated from
+// any thread.
+void ReleaseThreadCache();
+}  // memory
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_THREAD_CACHING_ALLOCATOR_H_
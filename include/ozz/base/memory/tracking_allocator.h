@@ -0,0 +1,117 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements an allocator decorator, that forwards allocations to a backing
+// allocator and records memory statistics per tag (see memory::Tag).
+// Allocations are attributed to the tag that's current at allocation time, and
+// deallocations to the tag of the allocation, which is stored in a small header
+// in front of every allocated block.
+// TrackingAllocator is usually installed as the default allocator, with
+// SetDefaulAllocator(), to budget ozz memory usage.
+// TrackingAllocator does not lock, so allocations must not be made from
+// multiple threads concurrently.
+class TrackingAllocator : public Allocator {
+ public:
+  // Defines memory statistics.
+  struct Stats {
+    // Number of bytes currently allocated, not including tracking headers.
+    size_t live_bytes;
+
+    // Highest live_bytes value since construction or last ResetPeaks().
+    size_t peak_bytes;
+
+    // Number of blocks currently allocated.
+    int live_count;
+
+    // Number of allocations since construction.
+    int total_count;
+  };
+
+  // Defines a snapshot of all statistics.
+  struct Snapshot {
+    // Statistics per tag.
+    Stats tags[kTagCount];
+
+    // Statistics of all tags. Peak is the highest sum of all tags live bytes.
+    Stats total;
+  };
+
+  // Constructs an allocator that forwards allocations to _backing.
+  explicit TrackingAllocator(Allocator* _backing = default_allocator());
+
+  // Asserts that all allocations have been deallocated.
+  virtual ~TrackingAllocator();
+
+  // Gets current statistics of _tag.
+  const Stats& stats(Tag _tag) const {
+    return snapshot_.tags[_tag];
+  }
+
+  // Gets current statistics of all tags.
+  const Stats& total() const {
+    return snapshot_.total;
+  }
+
+  // Copies all current statistics to _snapshot.
+  void GetSnapshot(Snapshot* _snapshot) const {
+    *_snapshot = snapshot_;
+  }
+
+  // Resets peaks of all statistics to current live bytes.
+  void ResetPeaks();
+
+ protected:
+  // Allocator interface implementation.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+  virtual void Deallocate(void* _block);
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignation.
+  TrackingAllocator(const TrackingAllocator&);
+  void operator=(const TrackingAllocator&);
+
+  // Allocator used to allocate tracked blocks.
+  Allocator* backing_;
+
+  // Current statistics.
+  Snapshot snapshot_;
+};
+}  // memory
+}  // ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
@@ -0,0 +1,126 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_PROFILE_H_
+#define OZZ_OZZ_BASE_PROFILE_H_
+
+// Defines OZZ_PROFILE_SCOPE(_name) macro, which annotates the scope it's
+// declared in (jobs Run functions, offline building stages...) for external
+// profilers. _name must be a string literal.
+// The macro is routed as follows:
+// - If OZZ_PROFILE_SCOPE is already defined when this file is included, for
+//   example from a forced include file or a compiler definition, it's used as
+//   is. This allows to compile scopes directly to Tracy (ZoneScopedN), ITT or
+//   PIX markers, with no indirection.
+// - If ozz is built with profile hooks (OZZ_HAS_PROFILE_HOOKS, see
+//   ozz_build_profile_hooks CMake option), scopes are forwarded to the user
+//   callbacks installed with ozz::profile::SetHooks().
+// - Otherwise the macro compiles to nothing.
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace profile {
+
+// Profiling callbacks, called when a scope begins and ends. begin returns a
+// context (like a zone identifier) that is passed back to end. _user_data is
+// Hooks::user_data.
+// Callbacks are called from the thread the scope belongs to, so they must be
+// thread safe.
+typedef void* (*BeginFct)(const char* _name, void* _user_data);
+typedef void (*EndFct)(const char* _name, void* _context, void* _user_data);
+
+// Defines the profiling callbacks.
+struct Hooks {
+  // Default constructor, initializes defaults values (no hook).
+  Hooks()
+    : begin(NULL),
+      end(NULL),
+      user_data(NULL) {
+  }
+
+  // Scope begin and end callbacks. Hooks are disabled if any is NULL.
+  BeginFct begin;
+  EndFct end;
+
+  // User data passed to callbacks.
+  void* user_data;
+};
+
+// Installs profiling hooks, replacing the current ones. Default hooks disable
+// profiling. This function isn't thread safe, it's expected to be called
+// during initialization, while no ozz scope is being executed.
+void SetHooks(const Hooks& _hooks);
+
+// Gets installed profiling hooks.
+const Hooks& GetHooks();
+
+namespace internal {
+// Installed hooks, NULL if disabled.
+extern const Hooks* g_hooks;
+}  // internal
+
+// RAII object that notifies hooks of scope begin and end.
+class Scope {
+ public:
+  explicit Scope(const char* _name)
+    : hooks_(internal::g_hooks),
+      name_(_name),
+      context_(hooks_ ? hooks_->begin(_name, hooks_->user_data) : NULL) {
+  }
+  ~Scope() {
+    if (hooks_) {
+      hooks_->end(name_, context_, hooks_->user_data);
+    }
+  }
+
+ private:
+  // Disables copy and assignment.
+  Scope(const Scope&);
+  void operator = (const Scope&);
+
+  const Hooks* hooks_;
+  const char* name_;
+  void* context_;
+};
+}  // profile
+}  // ozz
+
+#ifndef OZZ_PROFILE_SCOPE
+#ifdef OZZ_HAS_PROFILE_HOOKS
+#define OZZ_PROFILE_SCOPE_CONCAT(_a, _b) _a##_b
+#define OZZ_PROFILE_SCOPE_NAME(_l) OZZ_PROFILE_SCOPE_CONCAT(ozz_scope_, _l)
+#define OZZ_PROFILE_SCOPE(_name) \
+  ozz::profile::Scope OZZ_PROFILE_SCOPE_NAME(__LINE__)(_name)
+#else  // OZZ_HAS_PROFILE_HOOKS
+#define OZZ_PROFILE_SCOPE(_name)
+#endif  // OZZ_HAS_PROFILE_HOOKS
+#endif  // OZZ_PROFILE_SCOPE
+#endif  // OZZ_OZZ_BASE_PROFILE_H_
@@ -0,0 +1,76 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_TASKS_TASK_DISPATCHER_H_
+#define OZZ_OZZ_BASE_TASKS_TASK_DISPATCHER_H_
+
+// Provides the interface used by ozz jobs to distribute their workload on
+// user's threads. ozz does not implement any threading itself: applications
+// map this interface on their own task system (thread pool, job system...).
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace tasks {
+
+// Declares a task, made of a number of independent work items that can be
+// executed concurrently.
+class Task {
+ public:
+  // Required virtual destructor.
+  virtual ~Task() {
+  }
+
+  // Executes work item _index, in range [0,count[ as specified to
+  // Dispatcher::Dispatch. Run can be called concurrently from multiple threads,
+  // with different _index values.
+  virtual void Run(int _index) const = 0;
+};
+
+// Declares the dispatcher interface that must be implemented by the
+// application to execute tasks on its own threads.
+class Dispatcher {
+ public:
+  // Required virtual destructor.
+  virtual ~Dispatcher() {
+  }
+
+  // Executes _count work items of _task, calling _task.Run(i) once for every i
+  // in range [0,_count[. Work items can be executed in any order and from any
+  // thread, but Dispatch must not return before all of them are completed.
+  virtual void Dispatch(const Task& _task, int _count) = 0;
+};
+
+// Gets a dispatcher that executes all work items sequentially on the calling
+// thread.
+Dispatcher* serial_dispatcher();
+}  // tasks
+}  // ozz
+#endif  // OZZ_OZZ_BASE_TASKS_TASK_DISPATCHER_H_
@@ -0,0 +1,126 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_TASKS_THREAD_POOL_H_
+#define OZZ_OZZ_BASE_TASKS_THREAD_POOL_H_
+
+// Provides an optional built-in implementation of the tasks::Dispatcher
+// interface, for applications that don't have their own task system.
+
+#include "ozz/base/tasks/task_dispatcher.h"
+
+namespace ozz {
+namespace tasks {
+
+// Implements a dispatcher that executes work items on a pool of persistent
+// worker threads, the thread calling Dispatch being a worker too.
+// Work items of a dispatch are initially split in contiguous ranges, one per
+// worker, and a worker that completes its range steals half of the remaining
+// range of another worker. Load is thus balanced, even if work items cost
+// differs, while workers mostly execute contiguous work items.
+// Dispatch can be called concurrently from multiple threads, and from work
+// items themselves: nested dispatches are executed by the calling worker and
+// by idle workers, which is how dependencies between tasks are expressed.
+// Dispatching doesn't allocate memory, and at most 32 workers execute the
+// work items of a single dispatch.
+// On NUMA systems (multi-socket servers), a pool can be pinned to a node, so
+// that its workers access the node local memory, see
+// animation::NumaReplicas. Applications typically create a pool per node, and
+// dispatch to it from a thread pinned to the same node (see
+// PinCurrentThread).
+class ThreadPool : public Dispatcher {
+ public:
+  // Constructs a pool of _num_threads workers, including the thread calling
+  // Dispatch, so _num_threads - 1 threads are created. A pool of 1 thread
+  // executes all work items on the calling thread. If a thread fails to be
+  // created, the pool continues with the threads created so far.
+  explicit ThreadPool(int _num_threads);
+
+  // Constructs a pool of _num_threads workers, whose threads are pinned to the
+  // processors of NUMA node _numa_node, in range [0,num_numa_nodes()[. The
+  // thread calling Dispatch isn't pinned by the pool. Workers aren't pinned if
+  // _numa_node is out of range, or if the platform doesn't support affinity.
+  ThreadPool(int _num_threads, int _numa_node);
+
+  // Stops and joins all worker threads. No dispatch must be running.
+  virtual ~ThreadPool();
+
+  // Executes _count work items of _task, see Dispatcher::Dispatch.
+  virtual void Dispatch(const Task& _task, int _count);
+
+  // Gets the number of workers, including the thread calling Dispatch.
+  int num_threads() const {
+    return num_threads_;
+  }
+
+  // Gets the NUMA node workers are pinned to, -1 if they aren't pinned.
+  int numa_node() const {
+    return numa_node_;
+  }
+
+  // Gets the number of hardware threads of the system, at least 1.
+  static int hardware_concurrency();
+
+  // Gets the number of NUMA nodes of the system, 1 if the system isn't NUMA or
+  // if the platform doesn't expose its topology.
+  static int num_numa_nodes();
+
+  // Gets the NUMA node of the processor currently executing the calling
+  // thread, 0 if the platform doesn't expose it.
+  static int current_numa_node();
+
+  // Pins the calling thread to the processors of NUMA node _numa_node.
+  // Returns false if _numa_node is out of range or if the platform doesn't
+  // support affinity, in which case the thread affinity is unchanged.
+  static bool PinCurrentThread(int _numa_node);
+
+ private:
+  // Disables copy and assignation.
+  ThreadPool(ThreadPool const&);
+  void operator=(ThreadPool const&);
+
+  // Declares platform specific implementation, which also implements workers.
+  struct Impl;
+
+  // Starts _num_threads - 1 worker threads.
+  void Start(int _num_threads);
+
+  // Number of workers, including the thread calling Dispatch.
+  int num_threads_;
+
+  // NUMA node workers are pinned to, -1 if they aren't pinned.
+  int numa_node_;
+
+  // Platform specific implementation.
+  Impl* impl_;
+};
+}  // tasks
+}  // ozz
+#endif  // OZZ_OZZ_BASE_TASKS_THREAD_POOL_H_
@@ -0,0 +1,109 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_OFFLINE_INFLUENCE_PARTITION_BUILDER_H_
+#define OZZ_OZZ_GEOMETRY_OFFLINE_INFLUENCE_PARTITION_BUILDER_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+// Stores mesh vertices partitioned by their exact number of joint influences.
+// SkinningJob selects its skinning function according to influences_count, so
+// skinning each partition with its own job runs the tightest function for
+// every vertex, instead of paying the maximum influences count cost for the
+// whole mesh.
+struct InfluencePartitions {
+  // Defines the joint influences of a partition, laid out as expected by
+  // SkinningJob joint_indices and joint_weights.
+  struct Partition {
+    // Number of joints influencing each vertex of the partition.
+    int influences_count;
+
+    // Number of vertices of the partition.
+    int vertex_count;
+
+    // Joint indices, influences_count per vertex, sorted by decreasing weight.
+    ozz::Vector<uint16_t>::Std joint_indices;
+
+    // Joint weights, influences_count - 1 per vertex, as the last one is
+    // restored by the skinning job.
+    ozz::Vector<float>::Std joint_weights;
+  };
+
+  // Partitions, sorted by increasing influences count.
+  ozz::Vector<Partition>::Std partitions;
+
+  // Vertices are sorted by partition. vertex_remap stores, for every
+  // partitioned vertex, the index of the source vertex. Vertex attributes
+  // (positions, normals...) and triangle indices must be remapped accordingly.
+  ozz::Vector<int>::Std vertex_remap;
+};
+
+// Defines the class responsible of building InfluencePartitions from per
+// vertex joint indices and weights, laid out like SkinningJob inputs.
+class InfluencePartitionBuilder {
+ public:
+  // Default constructor, initializes default values.
+  InfluencePartitionBuilder();
+
+  // Builds _partitions from _vertex_count vertices, each one influenced by up
+  // to _influences_count joints. _joint_indices stores _influences_count
+  // indices per vertex, and _joint_weights stores _influences_count - 1
+  // weights per vertex, the last one being restored from the others.
+  // Influences whose weight is less or equal to weight_epsilon are pruned,
+  // and remaining weights are renormalized. A vertex keeps at least its
+  // biggest influence.
+  // The relative order of the vertices of a partition is preserved.
+  // Returns false on failure:
+  // - if _influences_count is less than 1, or _vertex_count is negative.
+  // - if input ranges are too small, or _partitions is NULL.
+  bool operator()(int _vertex_count,
+                  int _influences_count,
+                  Range<const uint16_t> _joint_indices,
+                  Range<const float> _joint_weights,
+                  InfluencePartitions* _partitions) const;
+
+  // Influences with a weight less or equal to weight_epsilon are pruned.
+  // Default is 0, which only prunes null (and negative) weights.
+  float weight_epsilon;
+
+  // Partitions with less vertices than min_partition_vertices are merged into
+  // the next partition, padding their influences with null weights. This
+  // limits skinning jobs fixed cost overhead. Default is 16.
+  int min_partition_vertices;
+};
+}  // offline
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_OFFLINE_INFLUENCE_PARTITION_BUILDER_H_
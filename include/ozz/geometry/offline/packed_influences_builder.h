@@ -0,0 +1,100 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_OFFLINE_PACKED_INFLUENCES_BUILDER_H_
+#define OZZ_OZZ_GEOMETRY_OFFLINE_PACKED_INFLUENCES_BUILDER_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+// Stores compressed joint influences, as expected by the PackedSkinningJob.
+// See PackedSkinningJob for more details about each member.
+struct PackedInfluences {
+  // Number of joints influencing each vertex.
+  int influences_count;
+
+  // Vertices are sorted by influence set. vertex_remap stores, for every
+  // packed vertex, the index of the source vertex. Vertex attributes
+  // (positions, normals...) and triangle indices must be remapped accordingly.
+  ozz::Vector<int>::Std vertex_remap;
+
+  // Joint indices referenced by palette-local indices.
+  ozz::Vector<uint16_t>::Std palette;
+
+  // Number of vertices of each influence set.
+  ozz::Vector<uint16_t>::Std set_vertex_counts;
+
+  // Palette-local joint indices of each set, influences_count per set.
+  ozz::Vector<uint8_t>::Std set_joint_indices;
+
+  // Quantized weights, influences_count - 1 per packed vertex. Only one of
+  // them is filled, depending on PackedInfluencesBuilder::weight_bits.
+  ozz::Vector<uint8_t>::Std joint_weights_8;
+  ozz::Vector<uint16_t>::Std joint_weights_16;
+};
+
+// Defines the class responsible of building PackedInfluences from per vertex
+// joint indices and weights, laid out like SkinningJob inputs.
+class PackedInfluencesBuilder {
+ public:
+  // Default constructor, initializes default values.
+  PackedInfluencesBuilder();
+
+  // Builds _packed influences from _vertex_count vertices, each one
+  // influenced by _influences_count joints. _joint_indices stores
+  // _influences_count indices per vertex, and _joint_weights stores
+  // _influences_count - 1 weights per vertex, the last one being restored
+  // from the others as the sum of the weights is 1.
+  // Joints of each vertex are sorted by index, such that vertices influenced
+  // by the same joints share the same influence set, whatever the order of
+  // their source indices.
+  // Returns false on failure:
+  // - if _influences_count is less than 1, or _vertex_count is negative.
+  // - if input ranges are too small.
+  // - if more than 256 different joints are referenced, as they can't be
+  // addressed by 8 bits palette-local indices. Such meshes must be split.
+  // - if weight_bits isn't 8 or 16.
+  bool operator()(int _vertex_count,
+                  int _influences_count,
+                  Range<const uint16_t> _joint_indices,
+                  Range<const float> _joint_weights,
+                  PackedInfluences* _packed) const;
+
+  // Number of bits used to quantize weights, 8 or 16. Default is 16.
+  int weight_bits;
+};
+}  // offline
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_OFFLINE_PACKED_INFLUENCES_BUILDER_H_
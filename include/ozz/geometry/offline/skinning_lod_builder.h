@@ -0,0 +1,81 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_OFFLINE_SKINNING_LOD_BUILDER_H_
+#define OZZ_OZZ_GEOMETRY_OFFLINE_SKINNING_LOD_BUILDER_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+// Stores the vertex order and the vertex counts of mesh skinning levels of
+// detail.
+// Vertices are reordered such that every level of detail is a prefix of the
+// mesh. Skinning a level of detail, for example a shadow or a physics proxy,
+// is thus a matter of setting skinning job vertex_count to the level vertex
+// count, with unmodified (remapped) buffers. No job needs to support sparse
+// vertex lists.
+struct SkinningLods {
+  // vertex_remap stores, for every reordered vertex, the index of the source
+  // vertex. Vertex attributes (positions, normals, joint influences...) and
+  // triangle indices must be remapped accordingly.
+  ozz::Vector<int>::Std vertex_remap;
+
+  // Number of vertices of each level, which are the first level_vertex_counts
+  // [level] reordered vertices. Counts never decrease, the last one being the
+  // total number of vertices.
+  ozz::Vector<int>::Std level_vertex_counts;
+};
+
+// Defines the class responsible of building SkinningLods from the level of
+// each vertex.
+class SkinningLodBuilder {
+ public:
+  // Builds _lods from _vertex_count vertices levels _vertex_levels. The level
+  // of a vertex is the lowest (cheapest) level that uses it. Level n includes
+  // all the vertices of levels lower than n, the highest level being the
+  // full mesh.
+  // The relative order of the vertices of a level is preserved, so that
+  // vertex cache optimizations are mostly kept.
+  // Returns false on failure:
+  // - if _vertex_count is negative or _lods is NULL.
+  // - if _vertex_levels range is too small.
+  // - if a level is negative.
+  bool operator()(int _vertex_count,
+                  Range<const int> _vertex_levels,
+                  SkinningLods* _lods) const;
+};
+}  // offline
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_OFFLINE_SKINNING_LOD_BUILDER_H_
@@ -0,0 +1,90 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_OFFLINE_VERTEX_ORDER_BUILDER_H_
+#define OZZ_OZZ_GEOMETRY_OFFLINE_VERTEX_ORDER_BUILDER_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+// Stores an optimized order of a mesh triangles and vertices.
+struct VertexOrder {
+  // Vertices are sorted by VertexOrderBuilder. vertex_remap stores, for every
+  // sorted vertex, the index of the source vertex. Vertex attributes
+  // (positions, normals, joint influences...) must be remapped accordingly.
+  ozz::Vector<int>::Std vertex_remap;
+
+  // Reordered triangle indices, indexing sorted vertices.
+  ozz::Vector<uint16_t>::Std triangle_indices;
+};
+
+// Defines the class responsible of optimizing the order of a skinned mesh
+// triangles and vertices, for both rendering and skinning:
+// - triangles are reordered to maximize GPU post-transform vertex cache reuse,
+// using Tom Forsyth's "linear-speed vertex cache optimisation" algorithm.
+// - vertices are then numbered in the order triangles first use them, so that
+// vertex fetches are mostly sequential. If dominant joints are provided,
+// vertices are grouped by dominant joint first, so that SkinningJob reads the
+// same few matrices for consecutive vertices.
+// The relative order of vertices is what InfluencePartitionBuilder preserves
+// within a partition, so the optimization should be applied before
+// partitioning.
+class VertexOrderBuilder {
+ public:
+  // Default constructor, initializes default values.
+  VertexOrderBuilder();
+
+  // Builds _order for a mesh of _vertex_count vertices and triangles
+  // _triangle_indices. _dominant_joints optionally stores the most
+  // influencing joint of every vertex, usually the first joint index of the
+  // vertex as sorted by decreasing weight. Vertices that aren't used by any
+  // triangle are moved at the end, in their source order.
+  // Returns false on failure:
+  // - if _vertex_count is negative, or _order is NULL.
+  // - if the number of triangle indices isn't a multiple of 3, or an index is
+  // out of vertices range.
+  // - if _dominant_joints is provided but stores less than _vertex_count
+  // joints.
+  bool operator()(int _vertex_count,
+                  Range<const uint16_t> _triangle_indices,
+                  Range<const uint16_t> _dominant_joints,
+                  VertexOrder* _order) const;
+
+  // Size of the simulated post-transform vertex cache. Default is 32.
+  int cache_size;
+};
+}  // offline
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_OFFLINE_VERTEX_ORDER_BUILDER_H_
@@ -0,0 +1,136 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct DualQuaternion; }
+namespace geometry {
+
+// Provides per-vertex dual quaternion skinning job implementation.
+// Dual quaternion skinning is an alternative to matrix palette skinning (see
+// SkinningJob), where joint transformations are stored as unit dual
+// quaternions. Blending dual quaternions preserves the rigidity of the
+// transformation, which fixes the volume loss (aka candy-wrapper effect) that
+// matrix blending produces on twisted joints. Dual quaternions only store 32
+// bytes per joint, which halves joints palette memory bandwidth compared to
+// matrices. They can't represent scaling though.
+// As dual quaternions are rigid transformations, vectors (normals and
+// tangents) are transformed with the same rotation as points, so no inverse
+// transpose palette is needed.
+// Joint dual quaternions must be pre-multiplied with the inverse of the
+// skeleton bind-pose dual quaternions. They can be built from model-space
+// SoaTransform using math::FromSoaTransform.
+// Vertex (positions, normals, tangents, joint indices and weights) buffers
+// have the same layout and strides as SkinningJob.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct DualQuaternionSkinningJob {
+  // Default constructor, initializes default values.
+  DualQuaternionSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if normals are provided but positions aren't.
+  // - if tangents are provided but normals aren't.
+  // - if no output is provided while an input is. For example, if input normals
+  // are provided, then output normals must also.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Number of vertices to transform. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Maximum number of joints influencing each vertex. Must be greater than 0.
+  // See SkinningJob::influences_count.
+  int influences_count;
+
+  // Array of unit dual quaternions for each joint. Joint are indexed through
+  // indices array.
+  Range<const math::DualQuaternion> joint_dual_quaternions;
+
+  // Array of joints indices and stride. See SkinningJob::joint_indices.
+  Range<const uint16_t> joint_indices;
+  size_t joint_indices_stride;
+
+  // Array of joints weights and stride. See SkinningJob::joint_weights.
+  Range<const float> joint_weights;
+  size_t joint_weights_stride;
+
+  // Input vertex positions array (3 float values per vertex) and stride (number
+  // of bytes between each position).
+  // Array length must be at least vertex_count * in_positions_stride.
+  Range<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Input vertex normals (3 float values per vertex) array and stride (number
+  // of bytes between each normal).
+  // Array length must be at least vertex_count * in_normals_stride.
+  Range<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Input vertex tangents (3 float values per vertex) array and stride (number
+  // of bytes between each tangent).
+  // Array length must be at least vertex_count * in_tangents_stride.
+  Range<const float> in_tangents;
+  size_t in_tangents_stride;
+
+  // Output vertex positions (3 float values per vertex) array and stride
+  // (number of bytes between each position).
+  // Array length must be at least vertex_count * out_positions_stride.
+  Range<float> out_positions;
+  size_t out_positions_stride;
+
+  // Output vertex normals (3 float values per vertex) array and stride (number
+  // of bytes between each normal). As dual quaternions are rigid
+  // transformations, normals remain normalized.
+  // Array length must be at least vertex_count * out_normals_stride.
+  Range<float> out_normals;
+  size_t out_normals_stride;
+
+  // Output vertex tangents (3 float values per vertex) array and stride
+  // (number of bytes between each tangent).
+  // Array length must be at least vertex_count * out_tangents_stride.
+  Range<float> out_tangents;
+  size_t out_tangents_stride;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
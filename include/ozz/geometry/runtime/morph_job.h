@@ -0,0 +1,123 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace geometry {
+
+// Provides morph targets (aka blend shapes) job implementation.
+// Morphing deforms a mesh by adding a weighted sum of per-vertex deltas to its
+// base positions (and optionally normals), typically for facial expressions.
+// Morphing is applied before skinning, in mesh bind-pose space.
+// Every target provides its deltas as a sparse stream: the index of every
+// vertex the target moves, along with its delta. Only these vertices are
+// touched, and targets whose weight is zero are skipped. Deltas are
+// accumulated with SIMD instructions.
+// Input and output buffers are provided with a stride value, like the
+// SkinningJob ones, so that output positions can be used as SkinningJob input
+// positions directly. Output buffers can also be the input buffers (same range
+// and stride), in which case morphing is done in-place, without copying base
+// vertices.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct MorphJob {
+  // Default constructor, initializes default values.
+  MorphJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if weights range is smaller than targets range.
+  // - if a target doesn't provide as many deltas as it has indices, or if it
+  // provides normal deltas while normals aren't morphed.
+  // - if normals are provided but positions aren't.
+  // - if no output is provided while an input is.
+  bool Validate() const;
+
+  // Runs job's morphing task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines the sparse deltas of a morph target.
+  struct Target {
+    // Indices of the vertices moved by the target. Every index must be in range
+    // [0,vertex_count[. An index shouldn't appear twice in a target.
+    Range<const uint32_t> indices;
+
+    // Position deltas (3 float values per delta), one per index.
+    Range<const float> position_deltas;
+
+    // Optional normal deltas (3 float values per delta), one per index.
+    Range<const float> normal_deltas;
+  };
+
+  // Number of vertices to morph. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Morph targets.
+  Range<const Target> targets;
+
+  // Weight of every target. Targets whose weight is 0 are skipped.
+  Range<const float> weights;
+
+  // Input vertex positions array (3 float values per vertex) and stride (number
+  // of bytes between each position).
+  // Array length must be at least vertex_count * in_positions_stride.
+  Range<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Optional input vertex normals (3 float values per vertex) array and stride
+  // (number of bytes between each normal).
+  // Array length must be at least vertex_count * in_normals_stride.
+  Range<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Output vertex positions (3 float values per vertex) array and stride
+  // (number of bytes between each position).
+  // Array length must be at least vertex_count * out_positions_stride.
+  Range<float> out_positions;
+  size_t out_positions_stride;
+
+  // Output vertex normals (3 float values per vertex) array and stride (number
+  // of bytes between each normal). Output normals aren't normalized.
+  // Array length must be at least vertex_count * out_normals_stride.
+  Range<float> out_normals;
+  size_t out_normals_stride;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
@@ -0,0 +1,151 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_PACKED_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_PACKED_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Float4x4; }
+namespace geometry {
+
+// Provides matrix palette skinning from compressed joint influences.
+// The algorithm is the same as SkinningJob's one (see SkinningJob for more
+// details), but influences are compressed to reduce skinning input bandwidth:
+// - Vertices are sorted such that vertices influenced by the same set of
+// joints are contiguous. Joint indices are thus stored once per influence set,
+// rather than once per vertex.
+// - Joint indices are 8 bits palette-local indices, that are remapped to
+// joint_matrices indices through a palette of at most 256 joints.
+// - Joint weights are quantized to 8 or 16 bits normalized integers.
+// Joint matrices of a set are fetched once for all the vertices of the set,
+// which are skinned without any per vertex joint index read. This format can be
+// built with ozz::geometry::offline::PackedInfluencesBuilder.
+// Vertex positions, normals and tangents buffers have the same layout and
+// strides as SkinningJob.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct PackedSkinningJob {
+  // Default constructor, initializes default values.
+  PackedSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if influence sets don't cover exactly vertex_count vertices.
+  // - if both or none of the weights formats are provided while
+  // influences_count is greater than 1.
+  // - if normals are provided but positions aren't.
+  // - if tangents are provided but normals aren't.
+  // - if no output is provided while an input is. For example, if input normals
+  // are provided, then output normals must also.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Number of vertices to transform. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Number of joints influencing each vertex. Must be greater than 0.
+  int influences_count;
+
+  // Array of matrices for each joint. Joint are indexed through the palette.
+  Range<const math::Float4x4> joint_matrices;
+
+  // Optional array of inverse transposed matrices for each joint, used to
+  // transform vectors. See SkinningJob::joint_inverse_transpose_matrices.
+  Range<const math::Float4x4> joint_inverse_transpose_matrices;
+
+  // Palette that maps palette-local joint indices to joint_matrices indices.
+  // It can't store more than 256 joints, as palette-local indices are 8 bits.
+  Range<const uint16_t> palette;
+
+  // Number of consecutive vertices of each influence set. The sum of all sets
+  // vertex counts must be equal to vertex_count.
+  Range<const uint16_t> set_vertex_counts;
+
+  // Palette-local joint indices of each influence set, influences_count
+  // indices per set.
+  Range<const uint8_t> set_joint_indices;
+
+  // Quantized joint weights, with influences_count - 1 weights per vertex
+  // stored contiguously. Like SkinningJob, the weight of the last joint is
+  // restored at runtime. Weights are normalized integers, either 8 bits
+  // (weight * 255) or 16 bits (weight * 65535). One and only one of these
+  // ranges must be provided if influences_count is greater than 1.
+  Range<const uint8_t> joint_weights_8;
+  Range<const uint16_t> joint_weights_16;
+
+  // Input vertex positions array (3 float values per vertex) and stride (number
+  // of bytes between each position).
+  // Array length must be at least vertex_count * in_positions_stride.
+  Range<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Input vertex normals (3 float values per vertex) array and stride (number
+  // of bytes between each normal).
+  // Array length must be at least vertex_count * in_normals_stride.
+  Range<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Input vertex tangents (3 float values per vertex) array and stride (number
+  // of bytes between each tangent).
+  // Array length must be at least vertex_count * in_tangents_stride.
+  Range<const float> in_tangents;
+  size_t in_tangents_stride;
+
+  // Output vertex positions (3 float values per vertex) array and stride
+  // (number of bytes between each position).
+  // Array length must be at least vertex_count * out_positions_stride.
+  Range<float> out_positions;
+  size_t out_positions_stride;
+
+  // Output vertex normals (3 float values per vertex) array and stride (number
+  // of bytes between each normal). Output normals are not normalized.
+  // Array length must be at least vertex_count * out_normals_stride.
+  Range<float> out_normals;
+  size_t out_normals_stride;
+
+  // Output vertex tangents (3 float values per vertex) array and stride
+  // (number of bytes between each tangent). Output tangents are not
+  // normalized.
+  // Array length must be at least vertex_count * out_tangents_stride.
+  Range<float> out_tangents;
+  size_t out_tangents_stride;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_PACKED_SKINNING_JOB_H_
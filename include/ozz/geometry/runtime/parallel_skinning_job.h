@@ -0,0 +1,90 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+#include "ozz/geometry/runtime/skinning_job.h"
+
+namespace ozz {
+
+// Forward declaration of task dispatcher interface.
+namespace tasks { class Dispatcher; }
+
+namespace geometry {
+
+// Runs a SkinningJob, distributing its workload on multiple threads.
+// The vertex range of the skinning job is split into chunks of consecutive
+// vertices, every chunk being processed as an independent work item of a task
+// submitted to the user provided dispatcher. Vertices are independent from each
+// other, so chunks can be processed in any order.
+// Chunk sizes are rounded so that, in all output buffers, chunks start on a
+// cache line boundary relatively to the beginning of the buffer. If output
+// buffers are aligned on cache lines, work items never write to the same cache
+// line, which avoids false sharing.
+// Outputs are the same as the SkinningJob ones. Optional output bounds are
+// computed per chunk, and merged once all chunks are processed.
+struct ParallelSkinningJob {
+  // Default constructor, initializes default values.
+  ParallelSkinningJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if skinning job is invalid, according to SkinningJob::Validate() rules.
+  // -if dispatcher is NULL.
+  // -if chunk_size is less than 1.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Gets the number of vertices processed by each work item, computed from
+  // chunk_size and skinning job output strides. The last work item can
+  // process less vertices.
+  int chunk_vertex_count() const;
+
+  // The skinning job to split. Its buffers are shared by all work items.
+  SkinningJob skinning;
+
+  // The dispatcher used to process chunks. Use ozz::tasks::serial_dispatcher()
+  // to process all chunks on the calling thread.
+  tasks::Dispatcher* dispatcher;
+
+  // Minimum number of vertices per work item. Small chunks allow better load
+  // balancing, at the cost of more work items. Default value is 1024.
+  int chunk_size;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
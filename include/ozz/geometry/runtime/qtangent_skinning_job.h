@@ -0,0 +1,150 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_QTANGENT_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_QTANGENT_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Float4x4; }
+namespace math { struct DualQuaternion; }
+namespace geometry {
+
+// Provides per-vertex skinning of positions and quaternion tangent frames
+// (QTangents).
+// A QTangent is a unit quaternion q (x, y, z, w) that encodes a whole tangent
+// frame: the tangent is q applied to the x axis, the normal is q applied to
+// the z axis, and the bitangent handedness is the sign of w (q and -q are the
+// same rotation, so the sign is free to store it). Input QTangents w must thus
+// never be 0, otherwise handedness is lost. Compared to SkinningJob separate
+// normals and tangents, a single 4 floats stream is read per vertex, instead
+// of 6 floats.
+// Joints are either unit dual quaternions (see DualQuaternionSkinningJob), or
+// matrices (see SkinningJob). Only one palette must be set:
+// - dual quaternions rotate QTangents with a single quaternion product.
+// Skinned QTangents can be output directly, and/or decoded to normals and
+// tangents.
+// - matrices blending doesn't produce a rotation, so QTangents are decoded to
+// normals and tangents, which are then transformed like SkinningJob does.
+// QTangents can't be output.
+// Vertex positions, joint indices and weights buffers have the same layout and
+// strides as SkinningJob.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct QTangentSkinningJob {
+  // Default constructor, initializes default values.
+  QTangentSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if none, or both, joint palettes are set.
+  // - if output QTangents are requested with a matrix palette.
+  // - if input QTangents are provided, but no tangent frame output is.
+  // - if tangent frame outputs are requested without input QTangents.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Number of vertices to transform. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Maximum number of joints influencing each vertex. Must be greater than 0.
+  // See SkinningJob::influences_count.
+  int influences_count;
+
+  // Array of unit dual quaternions for each joint. See
+  // DualQuaternionSkinningJob::joint_dual_quaternions.
+  Range<const math::DualQuaternion> joint_dual_quaternions;
+
+  // Array of matrices for each joint. See SkinningJob::joint_matrices.
+  Range<const math::Float4x4> joint_matrices;
+
+  // Array of joints indices and stride. See SkinningJob::joint_indices.
+  Range<const uint16_t> joint_indices;
+  size_t joint_indices_stride;
+
+  // Array of joints weights and stride. See SkinningJob::joint_weights.
+  Range<const float> joint_weights;
+  size_t joint_weights_stride;
+
+  // Input vertex positions array (3 float values per vertex) and stride (number
+  // of bytes between each position).
+  // Array length must be at least vertex_count * in_positions_stride.
+  Range<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Optional input vertex QTangents (4 float values per vertex, x, y, z and w)
+  // array and stride (number of bytes between each QTangent).
+  // Array length must be at least vertex_count * in_qtangents_stride.
+  Range<const float> in_qtangents;
+  size_t in_qtangents_stride;
+
+  // Output vertex positions (3 float values per vertex) array and stride
+  // (number of bytes between each position).
+  // Array length must be at least vertex_count * out_positions_stride.
+  Range<float> out_positions;
+  size_t out_positions_stride;
+
+  // Optional output vertex QTangents (4 float values per vertex) array and
+  // stride (number of bytes between each QTangent). Requires a dual quaternion
+  // palette. Input handedness (w sign) is preserved, and w is biased away from
+  // 0 (see kQTangentBias), so that it can be quantized to 16 bits.
+  // Array length must be at least vertex_count * out_qtangents_stride.
+  Range<float> out_qtangents;
+  size_t out_qtangents_stride;
+
+  // Optional output vertex normals (3 float values per vertex) array and stride
+  // (number of bytes between each normal).
+  // Array length must be at least vertex_count * out_normals_stride.
+  Range<float> out_normals;
+  size_t out_normals_stride;
+
+  // Optional output vertex tangents (4 float values per vertex) array and
+  // stride (number of bytes between each tangent). The w component stores
+  // bitangent handedness, 1 or -1, so that:
+  // bitangent = cross(normal, tangent.xyz) * tangent.w.
+  // Array length must be at least vertex_count * out_tangents_stride.
+  Range<float> out_tangents;
+  size_t out_tangents_stride;
+};
+
+// Minimum absolute value of skinned QTangents w component. It's the smallest
+// value a 16 bits signed normalized integer can represent.
+extern const float kQTangentBias;
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_QTANGENT_SKINNING_JOB_H_
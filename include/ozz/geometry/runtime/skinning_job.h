@@ -35,6 +35,9 @@
 
 namespace ozz {
 namespace math { struct Float4x4; }
+namespace math { struct Float4x3; }
+namespace math { struct Box; }
+namespace tasks { class Dispatcher; }
 namespace geometry {
 
 // Provides per-vertex matrix palette skinning job implementation.
@@ -66,6 +69,8 @@ namespace geometry {
 // Joint matrices are accessed using the per-vertex joints indices provided as
 // input. These matrices must be pre-multiplied with the inverse of the skeleton
 // bind-pose matrices. This allows to transform vertices to joints local space. 
+// Joint matrices can be provided either as Float4x4 or as compact Float4x3
+// affine matrices, as output by LocalToModelJob::output_4x3.
 // In case of non-uniform-scale matrices, the job proposes to transform vectors
 // using an optional set of matrices, whose are usually inverse transpose of
 // joints matrices (see http://www.glprogramming.com/red/appendixf.html). This
@@ -80,10 +85,13 @@ struct SkinningJob {
   // Validates job parameters.
   // Returns true for a valid job, false otherwise:
   // - if any range is invalid. See each range description.
+  // - if none or both of joint_matrices and joint_matrices_4x3 are provided.
+  // - if inverse transposed matrices type doesn't match joint matrices type.
   // - if normals are provided but positions aren't.
   // - if tangents are provided but normals aren't.
   // - if no output is provided while an input is. For example, if input normals
   // are provided, then output normals must also.
+  // - if none or both of out_positions and soa output positions are provided.
   bool Validate() const;
 
   // Runs job's skinning task.
@@ -92,6 +100,14 @@ struct SkinningJob {
   // Returns false if *this job is not valid.
   bool Run() const;
 
+  // Output normals and tangents normalization modes.
+  enum Normalization {
+    kNoNormalization,  // Vectors are output as transformed, default.
+    kNormalizeEst,  // Vectors are normalized with an estimated reciprocal
+                    // square root, see math::NormalizeEst3.
+    kNormalize,  // Vectors are normalized with full precision.
+  };
+
   // Number of vertices to transform. All input and output arrays must store at
   // least this number of vertices.
   int vertex_count;
@@ -118,8 +134,22 @@ struct SkinningJob {
   // transforms points. Any rotation matrix is good though.
   // These matrices are optional as they might by costly to compute, and also
   // fall into a more costly code path in the skinning algorithm. 
+  // Uniformly scaled matrices don't need them: if the skeleton and its
+  // animations are uniformly scaled (see Skeleton::uniformly_scaled() and
+  // Animation::uniformly_scaled()), vectors transformed by joint_matrices only
+  // need to be renormalized, using kNormalizeEst or kNormalize normalization.
   Range<const math::Float4x4> joint_inverse_transpose_matrices;
 
+  // Array of compact affine 4x3 matrices for each joint, to be used instead of
+  // joint_matrices. Only one of joint_matrices and joint_matrices_4x3 must be
+  // specified.
+  Range<const math::Float4x3> joint_matrices_4x3;
+
+  // Optional array of inverse transposed 4x3 matrices for each joint, see
+  // joint_inverse_transpose_matrices. Can only be used with
+  // joint_matrices_4x3, as both matrix types can't be mixed.
+  Range<const math::Float4x3> joint_inverse_transpose_matrices_4x3;
+
   // Array of joints indices. This array is used to indexes matrices in joints
   // array.
   // Each vertex has influences_max number of indices, meaning that the size of
@@ -127,6 +157,14 @@ struct SkinningJob {
   Range<const uint16_t> joint_indices;
   size_t joint_indices_stride;
 
+  // Optional joint indices remapping table. If provided, joint_indices are
+  // local to a mesh part palette and are remapped while skinning, matrices
+  // being read from joint_matrices[joint_remap[index]]. This avoids gathering
+  // a matrix palette per part every frame. Every joint index must be in range
+  // of this table, and every remapped index in range of the matrices.
+  // Default is an empty range, meaning joint_indices index matrices directly.
+  Range<const uint16_t> joint_remap;
+
   // Array of joints weights. This array is used to associate a weight to every
   // joint that influences a vertex. The number of weights required per vertex
   // is "influences_max - 1". The weight for the last joint (for each vertex) is
@@ -161,12 +199,22 @@ struct SkinningJob {
   Range<float> out_positions;
   size_t out_positions_stride;
 
+  // Optional output vertex positions as struct-of-arrays, with one array per
+  // component, to be used instead of out_positions. This suits consumers like
+  // cloth or physics solvers, which would otherwise need to transpose skinned
+  // positions. Every array must store at least vertex_count floats. Either
+  // out_positions or all three of these arrays must be specified.
+  Range<float> out_positions_x;
+  Range<float> out_positions_y;
+  Range<float> out_positions_z;
+
   // Output vertex normals (3 float values per vertex) array and stride (number
   // of bytes between each normal).
-  // Note that output normals are not normalized by the skinning job. This task
-  // should be handled by the application, who knows if transform matrices have
-  // uniform scale, and if normals are re-normalized later in the rendering
-  // pipeline (shader vertex transformation stage).  
+  // Note that output normals are not normalized by the skinning job, unless
+  // requested with normalization member. Otherwise this task should be handled
+  // by the application, who knows if transform matrices have uniform scale, and
+  // if normals are re-normalized later in the rendering pipeline (shader vertex
+  // transformation stage).
   // Array length must be at least vertex_count * out_normals_stride.
   Range<float> out_normals;
   size_t out_normals_stride;
@@ -178,6 +226,121 @@ struct SkinningJob {
   // Array length must be at least vertex_count * out_tangents_stride.
   Range<float> out_tangents;
   size_t out_tangents_stride;
+
+  // Output normals and tangents normalization mode, see Normalization enum.
+  // Normalizing while vectors are still in registers saves a pass over output
+  // buffers. Input vectors can't be null when normalization is enabled.
+  // Default is kNoNormalization.
+  Normalization normalization;
+
+  // Optional output bounding box of skinned positions. Bounds are accumulated
+  // while skinning, which saves a read pass over output positions compared to
+  // computing them afterward. An empty job (no vertex) outputs an invalid box.
+  math::Box* out_bounds;
+
+  // Statistics of skinning jobs, see stats member.
+  struct Stats {
+    // Initializes all counters to 0.
+    Stats();
+
+    // Number of kernels by influences count, the last one handling
+    // kMaxKernelInfluences influences and above.
+    enum {kMaxKernelInfluences = 5};
+
+    // Number of kernels by skinned components: positions only, positions and
+    // normals, positions normals and tangents.
+    enum {kNumComponentKernels = 3};
+
+    // Number of vertices skinned by each kernel, indexed by influences count
+    // minus one and by components (see kNumComponentKernels).
+    int vertices[kMaxKernelInfluences][kNumComponentKernels];
+  };
+
+  // Optional statistics, accumulated by every run of the job. Counters are
+  // only updated if ozz is built with stats enabled (OZZ_HAS_STATS, see
+  // ozz_build_stats CMake option).
+  // Default is NULL.
+  Stats* stats;
+};
+
+// Skins a batch of mesh parts that share the same joint matrices palette, like
+// a SkinningJob per part would do.
+// Shared parameters (matrices and normalization mode) are specified once for
+// the whole batch. Parts are processed one after the other, so the palette
+// stays hot in cache, or distributed as independent work items if a
+// dispatcher is provided.
+// Every part is subject to the same rules as a SkinningJob, see
+// SkinningJob::Validate().
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct BatchSkinningJob {
+  // Default constructor, initializes default values.
+  BatchSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if parts range is invalid.
+  // - if any part, skinned with shared matrices and normalization mode, isn't
+  // a valid SkinningJob.
+  bool Validate() const;
+
+  // Runs job's skinning task on all parts.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Shared matrices, see SkinningJob members with the same names. Only one
+  // of joint_matrices and joint_matrices_4x3 must be specified.
+  Range<const math::Float4x4> joint_matrices;
+  Range<const math::Float4x4> joint_inverse_transpose_matrices;
+  Range<const math::Float4x3> joint_matrices_4x3;
+  Range<const math::Float4x3> joint_inverse_transpose_matrices_4x3;
+
+  // Shared normalization mode, see SkinningJob::normalization.
+  SkinningJob::Normalization normalization;
+
+  // Defines a mesh part, whose members have the same meaning as the
+  // SkinningJob ones.
+  struct Part {
+    // Default constructor, initializes default values.
+    Part();
+
+    int vertex_count;
+    int influences_count;
+
+    Range<const uint16_t> joint_indices;
+    size_t joint_indices_stride;
+    Range<const uint16_t> joint_remap;
+
+    Range<const float> joint_weights;
+    size_t joint_weights_stride;
+
+    Range<const float> in_positions;
+    size_t in_positions_stride;
+    Range<const float> in_normals;
+    size_t in_normals_stride;
+    Range<const float> in_tangents;
+    size_t in_tangents_stride;
+
+    Range<float> out_positions;
+    size_t out_positions_stride;
+    Range<float> out_normals;
+    size_t out_normals_stride;
+    Range<float> out_tangents;
+    size_t out_tangents_stride;
+
+    math::Box* out_bounds;
+  };
+
+  // Mesh parts to skin.
+  Range<const Part> parts;
+
+  // Optional dispatcher used to process parts concurrently, every part being
+  // a work item. Parts must then not share any output buffer.
+  // Default is NULL, meaning parts are processed serially on the calling
+  // thread.
+  tasks::Dispatcher* dispatcher;
 };
 }  // geometry
 }  // ozz
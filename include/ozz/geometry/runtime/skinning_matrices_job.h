@@ -0,0 +1,90 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_SKINNING_MATRICES_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_SKINNING_MATRICES_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Float4x4; }
+namespace geometry {
+
+// Builds the matrix palette used by SkinningJob from model-space joint
+// matrices (usually LocalToModelJob output), in a single pass:
+// - every palette entry i is remapped to joint joint_remaps[i], which allows to
+// build a per-mesh palette that only contains the joints used by the mesh.
+// - the model-space matrix of this joint is multiplied by the inverse bind-pose
+// matrix of the palette entry.
+// - optionally, the inverse transpose of the resulting matrix is output as
+// expected by SkinningJob::joint_inverse_transpose_matrices.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct SkinningMatricesJob {
+  // Default constructor, initializes default values.
+  SkinningMatricesJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if a joint remap index is out of model_matrices range.
+  bool Validate() const;
+
+  // Runs job's task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Model-space matrices of all the joints of the skeleton.
+  Range<const math::Float4x4> model_matrices;
+
+  // Inverse bind-pose matrices of every palette entry. The number of palette
+  // entries is defined by the size of this range.
+  Range<const math::Float4x4> inverse_bind_poses;
+
+  // Optional joint indices of every palette entry, used to index
+  // model_matrices. If not provided, palette entry i uses joint i. If provided,
+  // it must store as many indices as inverse_bind_poses.
+  Range<const uint16_t> joint_remaps;
+
+  // Job output.
+  // Skinning matrices of every palette entry, which size must be at least the
+  // number of palette entries.
+  Range<math::Float4x4> skinning_matrices;
+
+  // Optional job output.
+  // Inverse transpose of each skinning matrix. Size must be at least the
+  // number of palette entries if provided.
+  Range<math::Float4x4> inverse_transpose_matrices;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_SKINNING_MATRICES_JOB_H_
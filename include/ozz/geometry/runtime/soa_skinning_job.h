@@ -0,0 +1,139 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_SOA_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_SOA_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Float4x4; }
+namespace geometry {
+
+// Provides matrix palette skinning job implementation for vertices stored as
+// struct-of-arrays streams, where each component (x, y and z) of a vertex
+// attribute is stored in a separate array.
+// The algorithm is the same as SkinningJob's one (see SkinningJob for more
+// details), but instead of transforming vertices one at a time, the job
+// transforms 4 vertices (or 8 if AVX is enabled) per loop. Joint matrices of
+// all the vertices processed by a loop are gathered and transposed, so that
+// every SIMD lane processes a different vertex. When all the vertices of
+// the loop are influenced by the same joint (which is common when vertices are
+// sorted by joint), this matrix is broadcasted to all lanes instead of being
+// gathered.
+// Vertex streams don't need to be aligned or padded, the job handles
+// remaining vertices when vertex_count isn't a multiple of the SIMD width.
+// Joint indices and weights are provided per vertex, with the same layout as
+// SkinningJob.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct SoaSkinningJob {
+  // Default constructor, initializes default values.
+  SoaSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if normals are provided but positions aren't.
+  // - if tangents are provided but normals aren't.
+  // - if no output is provided while an input is. For example, if input normals
+  // are provided, then output normals must also.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Declares an input vertex attribute stream, with one array per component.
+  // Every array must store at least vertex_count floats.
+  struct InStream {
+    Range<const float> x;
+    Range<const float> y;
+    Range<const float> z;
+  };
+
+  // Declares an output vertex attribute stream, with one array per component.
+  // Every array must store at least vertex_count floats.
+  struct OutStream {
+    Range<float> x;
+    Range<float> y;
+    Range<float> z;
+  };
+
+  // Number of vertices to transform. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Maximum number of joints influencing each vertex. Must be greater than 0.
+  // See SkinningJob::influences_count.
+  int influences_count;
+
+  // Array of matrices for each joint. Joint are indexed through indices array.
+  Range<const math::Float4x4> joint_matrices;
+
+  // Optional array of inverse transposed matrices for each joint, used to
+  // transform vectors. See SkinningJob::joint_inverse_transpose_matrices.
+  Range<const math::Float4x4> joint_inverse_transpose_matrices;
+
+  // Array of joints indices and stride (number of bytes between each vertex
+  // indices). See SkinningJob::joint_indices.
+  Range<const uint16_t> joint_indices;
+  size_t joint_indices_stride;
+
+  // Array of joints weights and stride (number of bytes between each vertex
+  // weights). See SkinningJob::joint_weights.
+  Range<const float> joint_weights;
+  size_t joint_weights_stride;
+
+  // Input vertex positions streams, mandatory.
+  InStream in_positions;
+
+  // Input vertex normals streams, optional.
+  InStream in_normals;
+
+  // Input vertex tangents streams, optional but requires normals.
+  InStream in_tangents;
+
+  // Output vertex positions streams.
+  OutStream out_positions;
+
+  // Output vertex normals streams, required if input normals are provided.
+  // Like SkinningJob, output normals are not normalized.
+  OutStream out_normals;
+
+  // Output vertex tangents streams, required if input tangents are provided.
+  // Like SkinningJob, output tangents are not normalized.
+  OutStream out_tangents;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_SOA_SKINNING_JOB_H_
@@ -0,0 +1,128 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_STREAMED_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_STREAMED_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Float4x4; }
+namespace geometry {
+
+// Provides matrix palette skinning to write-combined memory, like mapped GPU
+// vertex buffers.
+// The algorithm is the same as SkinningJob's one (see SkinningJob for more
+// details), but outputs are written as full 16 bytes aligned vertices, with
+// non-temporal (streaming) stores, instead of regular stores of every
+// component with arbitrary strides. Write-combining buffers are thus always
+// flushed completely. A store fence is issued at the end of the job, so that
+// the buffer can be handed to the GPU once Run() returns.
+// Output vertices are interleaved, with the following layout:
+// - without normals, 16 bytes: position (3 floats), and 1.f.
+// - with normals, 16 bytes: position (3 floats), and the normal packed as 2
+// octahedral encoded 16 bits signed normalized integers, x in the lower bits.
+// - with normals and tangents, 32 bytes: the 16 bytes above, followed by the
+// tangent packed as the normal is, and 12 bytes of zero padding.
+// Octahedral encoding preserves unit vectors directions with a 16 bits
+// precision, for half the size of 3 16 bits components. Vectors are decoded
+// with: n = (x, y, 1 - |x| - |y|), n.xy += (n.z < 0 ? (|n.yx| - 1) *
+// sign(n.xy) : 0), and normalize(n).
+// Vectors are transformed by joint matrices, which thus must not have non
+// uniform scaling.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct StreamedSkinningJob {
+  // Default constructor, initializes default values.
+  StreamedSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if output vertices aren't aligned to 16 bytes.
+  // - if normals are provided but positions aren't.
+  // - if tangents are provided but normals aren't.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Gets the size in bytes of an output vertex, depending on the inputs.
+  size_t vertex_size() const {
+    return in_tangents.begin ? 32 : 16;
+  }
+
+  // Number of vertices to transform. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Maximum number of joints influencing each vertex. Must be greater than 0.
+  // See SkinningJob::influences_count.
+  int influences_count;
+
+  // Array of matrices for each joint. Joint are indexed through indices array.
+  Range<const math::Float4x4> joint_matrices;
+
+  // Array of joints indices, see SkinningJob::joint_indices.
+  Range<const uint16_t> joint_indices;
+  size_t joint_indices_stride;
+
+  // Array of joints weights, see SkinningJob::joint_weights.
+  Range<const float> joint_weights;
+  size_t joint_weights_stride;
+
+  // Input vertex positions array (3 float values per vertex) and stride (number
+  // of bytes between each position).
+  // Array length must be at least vertex_count * in_positions_stride.
+  Range<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Optional input vertex normals (3 float values per vertex) array and stride
+  // (number of bytes between each normal).
+  // Array length must be at least vertex_count * in_normals_stride.
+  Range<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Optional input vertex tangents (3 float values per vertex) array and
+  // stride (number of bytes between each tangent). Requires normals.
+  // Array length must be at least vertex_count * in_tangents_stride.
+  Range<const float> in_tangents;
+  size_t in_tangents_stride;
+
+  // Output interleaved vertices, see layout above. Must be aligned to 16 bytes.
+  // Array length must be at least vertex_count * vertex_size() bytes.
+  Range<float> out_vertices;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_STREAMED_SKINNING_JOB_H_
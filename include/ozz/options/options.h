@@ -60,6 +60,10 @@
 // As in getopt() and gflags, -- by itself terminates flags processing. So in:
 // "foo -f1=1 -- -f2=2", f1 is considered but -f2 is not.
 //
+// An argument of the form @file is replaced by the arguments read from the
+// response file "file". Arguments of a response file are separated by white
+// spaces, or grouped with double quotes. Response files can't be nested.
+//
 // Parsing is invoked through ozz::options::ParseCommandLine function, providing
 // argc and argv arguments of the main function. This function also takes as
 // argument two strings to specify the version and usage message.
@@ -335,7 +339,11 @@ class Parser {
   // _argv arguments are parser until the end to the first "--" argument found.
   // Note that _argv arguments memory allocations must remains valid for the
   // life of parser, as some arguments like string options or executable path
-  // and name will be pointed by the parser (ie: not copied).
+  // and name will be pointed by the parser (ie: not copied). Arguments read
+  // from response files are stored by the parser until the next call to
+  // Parse().
+  // Every argument is matched in constant time with a hash table of options,
+  // so parsing is linear with the number of arguments.
   // See ParseResult for more details about returned values.
   ParseResult Parse(int _argc, const char* const *_argv);
 
@@ -390,8 +398,32 @@ class Parser {
     return options_ + options_count_;
   }
 
+  // Finds the option whose name is [_begin,_end[, case insensitive.
+  // Returns NULL if there's none.
+  Option* FindOption(const char* _begin, const char* _end) const;
+
+  // Rebuilds options hash table from registered options.
+  void RebuildHashTable();
+
+  // Inserts _option to the hash table.
+  void HashOption(Option* _option);
+
+  // Maximum number of registered options, including built-in options, and
+  // size of the options hash table, a power of 2 at least twice as big.
+  enum {
+    kMaxOptions = 512,
+    kHashTableSize = 1024,
+  };
+
   // Collection of registered options.
-  Option* options_[32];
+  Option* options_[kMaxOptions];
+
+  // Hash table of registered options, indexed by the hash of their lower case
+  // name, with linear probing. Empty slots are NULL.
+  Option* hash_table_[kHashTableSize];
+
+  // Arguments read from response files, separated by '\0' characters.
+  std::string response_files_;
 
   // Number of registered options, including built-in options.
   int options_count_;
@@ -0,0 +1,561 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/sampling_cache_pool.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+
+#include "ozz/base/log.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/box.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/base/tasks/thread_pool.h"
+
+#include "ozz/options/options.h"
+
+#include "framework/application.h"
+#include "framework/renderer.h"
+#include "framework/imgui.h"
+#include "framework/profile.h"
+#include "framework/utils.h"
+
+// Skeleton archive can be specified as an option.
+OZZ_OPTIONS_DECLARE_STRING(
+  skeleton,
+  "Path to the skeleton (ozz archive format).",
+  "media/skeleton.ozz",
+  false)
+
+// First animation archive can be specified as an option.
+OZZ_OPTIONS_DECLARE_STRING(
+  animation1,
+  "Path to the first animation (ozz archive format).",
+  "media/walk.ozz",
+  false)
+
+// Second animation archive can be specified as an option.
+OZZ_OPTIONS_DECLARE_STRING(
+  animation2,
+  "Path to the second animation (ozz archive format).",
+  "media/jog.ozz",
+  false)
+
+// Third animation archive can be specified as an option.
+OZZ_OPTIONS_DECLARE_STRING(
+  animation3,
+  "Path to the third animation (ozz archive format).",
+  "media/run.ozz",
+  false)
+
+// Measures crowd update scaling at initialization, see MeasureScaling().
+OZZ_OPTIONS_DECLARE_BOOL(
+  scaling,
+  "Measures and logs crowd update time from 1 to 64 threads.",
+  false,
+  false)
+
+// Interval between each character.
+const float kInterval = 2.f;
+
+// Width and depth of characters repartition.
+const int kWidth = 16;
+const int kDepth = 16;
+
+// Number of animations characters are playing.
+const int kNumAnimations = 3;
+
+// Number of thread counts scaling is measured for: 1, 2, 4... 64 threads.
+const int kNumScalingSteps = 7;
+
+// Number of updates averaged by each scaling step.
+const int kScalingLoops = 16;
+
+class CrowdSampleApplication : public ozz::sample::Application {
+ public:
+  CrowdSampleApplication()
+    : num_characters_(kWidth * kDepth),
+      enable_threads_(true),
+      num_threads_(1),
+      num_procs_(ozz::tasks::ThreadPool::hardware_concurrency()),
+      pool_(NULL),
+      partitions_(NULL),
+      num_partitions_(0),
+      partitioned_characters_(0) {
+    // Do not allocate all threads to the pool by default, as it is too
+    // intensive.
+    num_threads_ = (num_procs_ > 2) ? num_procs_ - 1 : num_procs_;
+    for (int i = 0; i < kNumScalingSteps; ++i) {
+      scaling_[i] = 0.f;
+    }
+  }
+
+ private:
+
+  // Nested structs forward declaration.
+  struct Character;
+  struct Partition;
+
+ protected:
+
+  // Updates current animation time.
+  virtual bool OnUpdate(float _dt) {
+    return Update(_dt);
+  }
+
+  // Updates all characters, a work item per partition.
+  bool Update(float _dt) {
+
+    // Recreates the pool and the partitions if the number of threads or
+    // characters changed.
+    if (pool_->num_threads() != num_threads_) {
+      ozz::memory::default_allocator()->Delete(pool_);
+      pool_ = ozz::memory::default_allocator()->
+        New<ozz::tasks::ThreadPool>(num_threads_);
+    }
+    if (num_partitions_ != num_threads_ ||
+        partitioned_characters_ != num_characters_) {
+      PartitionCharacters();
+    }
+
+    // Each partition is a work item, processed by a single thread.
+    const UpdateTask task(this, _dt);
+    if (enable_threads_) {
+      pool_->Dispatch(task, num_partitions_);
+    } else {
+      ozz::tasks::serial_dispatcher()->Dispatch(task, num_partitions_);
+    }
+
+    return true;
+  }
+
+  // Updates all the characters of a partition per work item.
+  class UpdateTask : public ozz::tasks::Task {
+   public:
+    UpdateTask(CrowdSampleApplication* _application, float _dt)
+      : application_(_application),
+        dt_(_dt) {
+    }
+    virtual void Run(int _index) const {
+      application_->UpdatePartition(application_->partitions_[_index], dt_);
+    }
+   private:
+    CrowdSampleApplication* application_;
+    float dt_;
+  };
+
+  // Updates partition characters, in their sorted order so that characters
+  // playing the same animation are updated one after the other.
+  bool UpdatePartition(const Partition& _partition, float _dt) {
+    ozz::sample::TraceScope trace("partition");
+    bool success = true;
+    for (int i = _partition.begin; i < _partition.end; ++i) {
+      success &= UpdateCharacter(&characters_[order_[i]], _dt);
+    }
+    return success;
+  }
+
+  bool UpdateCharacter(Character* _character, float _dt) {
+    const ozz::animation::Animation& animation =
+      animations_[_character->animation];
+
+    // Updates animation time.
+    _character->controller.Update(animation, _dt);
+
+    // Samples animation.
+    ozz::animation::SamplingJob sampling_job;
+    sampling_job.animation = &animation;
+    sampling_job.cache = _character->cache;
+    sampling_job.time = _character->controller.time();
+    sampling_job.output = _character->locals;
+    if (!sampling_job.Run()) {
+      return false;
+    }
+
+    // Converts from local space to model space matrices.
+    ozz::animation::LocalToModelJob ltm_job;
+    ltm_job.skeleton = &skeleton_;
+    ltm_job.input = _character->locals;
+    ltm_job.output = _character->models;
+    return ltm_job.Run();
+  }
+
+  // Renders all skeletons at once, so the renderer can batch them in a single
+  // instanced draw call.
+  virtual bool OnDisplay(ozz::sample::Renderer* _renderer) {
+    for (int c = 0; c < num_characters_; ++c) {
+      postures_[c] = characters_[c].models;
+    }
+    return _renderer->DrawPostures(
+      skeleton_,
+      ozz::Range<const ozz::Range<const ozz::math::Float4x4> >(
+        postures_.begin, num_characters_),
+      ozz::Range<const ozz::math::Float4x4>(
+        transforms_.begin, num_characters_),
+      false);
+  }
+
+  virtual bool OnInitialize() {
+
+    // Reading skeleton.
+    if (!ozz::sample::LoadSkeleton(OPTIONS_skeleton, &skeleton_)) {
+      return false;
+    }
+
+    // Reading animations.
+    const char* filenames[kNumAnimations] = {
+      OPTIONS_animation1, OPTIONS_animation2, OPTIONS_animation3};
+    int max_tracks = 0;
+    for (int i = 0; i < kNumAnimations; ++i) {
+      if (!ozz::sample::LoadAnimation(filenames[i], &animations_[i])) {
+        return false;
+      }
+      max_tracks = ozz::math::Max(max_tracks, animations_[i].num_tracks());
+    }
+    max_tracks_ = max_tracks;
+
+    // Initializes characters. Animations are interleaved, so that neighbour
+    // characters don't play the same animation.
+    for (int c = 0; c < kMaxCharacters; ++c) {
+      Character& character = characters_[c];
+      character.animation = c % kNumAnimations;
+      const float duration = animations_[character.animation].duration();
+      character.controller.set_time(duration * rand() / RAND_MAX);
+    }
+
+    // Allocates rendering postures and transforms. Transforms are constant,
+    // they only depend on character index.
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    postures_ = allocator->
+      AllocateRange<ozz::Range<const ozz::math::Float4x4> >(kMaxCharacters);
+    transforms_ =
+      allocator->AllocateRange<ozz::math::Float4x4>(kMaxCharacters);
+    for (int c = 0; c < kMaxCharacters; ++c) {
+      ozz::math::Float4 position(
+        ((c % kWidth) - kWidth / 2) * kInterval,
+        ((c / kWidth) / kDepth) * kInterval,
+        (((c / kWidth) % kDepth) - kDepth / 2) * kInterval,
+        1.f);
+      transforms_[c] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::LoadPtrU(&position.x));
+    }
+
+    pool_ = allocator->New<ozz::tasks::ThreadPool>(num_threads_);
+    PartitionCharacters();
+
+    if (OPTIONS_scaling) {
+      return MeasureScaling();
+    }
+    return true;
+  }
+
+  virtual void OnDestroy() {
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    allocator->Delete(pool_);
+    DeallocatePartitions();
+    allocator->Deallocate(postures_);
+    allocator->Deallocate(transforms_);
+  }
+
+  virtual bool OnGui(ozz::sample::ImGui* _im_gui) {
+    // Exposes multi-threading parameters.
+    {
+      static bool oc_open = true;
+      ozz::sample::ImGui::OpenClose oc(_im_gui, "Threads control", &oc_open);
+      if (oc_open) {
+        _im_gui->DoCheckBox("Enables multi-threading", &enable_threads_);
+        char label[64];
+        std::sprintf(label, "Number of processors: %d", num_procs_);
+        _im_gui->DoLabel(label);
+
+        const int max = ozz::math::Max(2, num_procs_ + 2);
+        std::sprintf(label, "Number of threads: %d/%d", num_threads_, max);
+        _im_gui->DoSlider(label, 1, max, &num_threads_);
+      }
+    }
+    // Exposes crowd parameters.
+    {
+      static bool oc_open = true;
+      ozz::sample::ImGui::OpenClose oc(_im_gui, "Crowd control", &oc_open);
+      if (oc_open) {
+        char label[64];
+        std::sprintf(label, "Number of entities: %d", num_characters_);
+        _im_gui->DoSlider(label, 1, kMaxCharacters, &num_characters_, .5f);
+        const int num_joints = num_characters_ * skeleton_.num_joints();
+        std::sprintf(label, "Number of joints: %d", num_joints);
+        _im_gui->DoLabel(label);
+        std::sprintf(label, "Number of partitions: %d", num_partitions_);
+        _im_gui->DoLabel(label);
+      }
+    }
+    // Exposes scaling measurement.
+    {
+      static bool oc_open = true;
+      ozz::sample::ImGui::OpenClose oc(_im_gui, "Scaling", &oc_open);
+      if (oc_open) {
+        if (_im_gui->DoButton("Measure scaling")) {
+          MeasureScaling();
+        }
+        for (int i = 0; i < kNumScalingSteps && scaling_[0] > 0.f; ++i) {
+          char label[64];
+          std::sprintf(label, "%d threads: %.2fms, x%.1f", 1 << i,
+                       scaling_[i], scaling_[0] / scaling_[i]);
+          _im_gui->DoLabel(label);
+        }
+      }
+    }
+    return true;
+  }
+
+  virtual void GetSceneBounds(ozz::math::Box* _bound) const {
+    _bound->min.x = -(kWidth / 2) * kInterval;
+    _bound->max.x =
+      _bound->min.x + ozz::math::Min(num_characters_, kWidth) * kInterval;
+    _bound->min.y = 0.f;
+    _bound->max.y = ((num_characters_ / kWidth / kDepth) + 1) * kInterval;
+    _bound->min.z = -(kDepth / 2) * kInterval;
+    _bound->max.z =
+      _bound->min.z +
+      ozz::math::Min(num_characters_ / kWidth, kDepth) * kInterval;
+  }
+
+ private:
+
+  // Sorts characters by animation and splits them in a partition per thread.
+  // Each partition allocates the local transforms and model matrices of its
+  // characters in a single contiguous arena, and their sampling caches from a
+  // pool of its own. A thread thus only touches its own memory, while
+  // characters playing the same animation share animation key-frames in its
+  // cache.
+  void PartitionCharacters() {
+    DeallocatePartitions();
+
+    // Sorts characters by animation, with a counting sort that keeps
+    // characters order within each animation.
+    int offsets[kNumAnimations + 1] = {0};
+    for (int c = 0; c < num_characters_; ++c) {
+      ++offsets[characters_[c].animation + 1];
+    }
+    for (int i = 0; i < kNumAnimations; ++i) {
+      offsets[i + 1] += offsets[i];
+    }
+    for (int c = 0; c < num_characters_; ++c) {
+      order_[offsets[characters_[c].animation]++] = c;
+    }
+
+    // Splits sorted characters in contiguous partitions.
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    num_partitions_ = ozz::math::Min(num_threads_, num_characters_);
+    partitions_ = allocator->Allocate<Partition>(num_partitions_);
+    const int num_soa_joints = skeleton_.num_soa_joints();
+    const int num_joints = skeleton_.num_joints();
+    for (int p = 0; p < num_partitions_; ++p) {
+      Partition& partition = partitions_[p];
+      partition.begin = num_characters_ * p / num_partitions_;
+      partition.end = num_characters_ * (p + 1) / num_partitions_;
+      const int count = partition.end - partition.begin;
+
+      // Allocates the arena: all local transforms, then all model matrices.
+      const size_t locals_size = sizeof(ozz::math::SoaTransform) *
+                                 num_soa_joints * count;
+      const size_t models_size = sizeof(ozz::math::Float4x4) *
+                                 num_joints * count;
+      partition.arena = reinterpret_cast<char*>(
+        allocator->Allocate(locals_size + models_size, 16));
+      ozz::math::SoaTransform* locals =
+        reinterpret_cast<ozz::math::SoaTransform*>(partition.arena);
+      ozz::math::Float4x4* models = reinterpret_cast<ozz::math::Float4x4*>(
+        partition.arena + locals_size);
+
+      partition.caches = allocator->New<ozz::animation::SamplingCachePool>(
+        max_tracks_, count);
+
+      for (int i = 0; i < count; ++i) {
+        Character& character = characters_[order_[partition.begin + i]];
+        character.locals.begin = locals + i * num_soa_joints;
+        character.locals.end = character.locals.begin + num_soa_joints;
+        character.models.begin = models + i * num_joints;
+        character.models.end = character.models.begin + num_joints;
+        character.cache = partition.caches->Acquire();
+      }
+    }
+    partitioned_characters_ = num_characters_;
+  }
+
+  void DeallocatePartitions() {
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    for (int p = 0; p < num_partitions_; ++p) {
+      Partition& partition = partitions_[p];
+      for (int i = partition.begin; i < partition.end; ++i) {
+        Character& character = characters_[order_[i]];
+        partition.caches->Release(character.cache);
+        character.cache = NULL;
+      }
+      allocator->Delete(partition.caches);
+      allocator->Deallocate(partition.arena);
+    }
+    allocator->Deallocate(partitions_);
+    partitions_ = NULL;
+    num_partitions_ = 0;
+  }
+
+  // Measures the average update time of the crowd with 1, 2, 4... up to 64
+  // threads, whatever the number of processors, and logs the speedup compared
+  // to a single thread.
+  bool MeasureScaling() {
+    const int num_threads = num_threads_;
+    const bool enable_threads = enable_threads_;
+    enable_threads_ = true;
+    bool success = true;
+    for (int i = 0; i < kNumScalingSteps; ++i) {
+      num_threads_ = 1 << i;
+
+      // The first update reallocates the pool and the partitions.
+      success &= Update(0.f);
+
+      ozz::sample::Record record(kScalingLoops);
+      for (int l = 0; l < kScalingLoops; ++l) {
+        ozz::sample::Profiler profile(&record);
+        success &= Update(1.f / 60.f);
+      }
+      scaling_[i] = record.GetStatistics().mean;
+      ozz::log::Log() << "Crowd of " << num_characters_ << " characters, " <<
+        num_threads_ << " threads: " << scaling_[i] << "ms, speedup x" <<
+        scaling_[0] / scaling_[i] << std::endl;
+    }
+    num_threads_ = num_threads;
+    enable_threads_ = enable_threads;
+    return success;
+  }
+
+  // Runtime skeleton.
+  ozz::animation::Skeleton skeleton_;
+
+  // Runtime animations.
+  ozz::animation::Animation animations_[kNumAnimations];
+
+  // Maximum number of tracks of all animations.
+  int max_tracks_;
+
+  // Character structure contains all the data required to sample a character.
+  struct Character {
+    Character()
+     : animation(0),
+       cache(NULL) {
+    }
+
+    // Playback animation controller. This is a utility class that helps with
+    // controlling animation playback time.
+    ozz::sample::PlaybackController controller;
+
+    // Index of the animation played by this character.
+    int animation;
+
+    // Sampling cache, acquired from the partition pool.
+    ozz::animation::SamplingCache* cache;
+
+    // Buffer of local transforms, in the partition arena.
+    ozz::Range<ozz::math::SoaTransform> locals;
+
+    // Buffer of model space matrices, in the partition arena.
+    ozz::Range<ozz::math::Float4x4> models;
+  };
+
+  // A partition of characters, updated by a single thread.
+  struct Partition {
+    // Range [begin,end[ of characters of order_ array.
+    int begin;
+    int end;
+
+    // Contiguous arena that stores characters local transforms and model
+    // matrices.
+    char* arena;
+
+    // Pool of characters sampling caches.
+    ozz::animation::SamplingCachePool* caches;
+  };
+
+  // The maximum number of characters.
+  enum {
+      kMaxCharacters = 4096,
+  };
+
+  // Array of characters of the sample.
+  Character characters_[kMaxCharacters];
+
+  // Characters indices, sorted by animation.
+  int order_[kMaxCharacters];
+
+  // Number of used characters.
+  int num_characters_;
+
+  // Per character model space matrices and world transforms, as expected by
+  // the renderer.
+  ozz::Range<ozz::Range<const ozz::math::Float4x4> > postures_;
+  ozz::Range<ozz::math::Float4x4> transforms_;
+
+  // Enables/disables multi-threading.
+  bool enable_threads_;
+
+  // The number of threads as selected from the UI.
+  int num_threads_;
+
+  // The number of hardware threads.
+  int num_procs_;
+
+  // The pool of threads partitions update is dispatched to.
+  ozz::tasks::ThreadPool* pool_;
+
+  // Characters partitions, one per thread.
+  Partition* partitions_;
+  int num_partitions_;
+
+  // Number of characters partitions were built for.
+  int partitioned_characters_;
+
+  // Average update time, in ms, of each scaling step.
+  float scaling_[kNumScalingSteps];
+};
+
+int main(int _argc, const char** _argv) {
+  const char* title =
+    "Ozz-animation sample: Partitioned crowd update";
+  return CrowdSampleApplication().Run(_argc, _argv, "1.0", title);
+}
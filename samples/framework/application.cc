@@ -34,6 +34,7 @@
 
 #include <cstdlib>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 
 #ifdef __APPLE__
@@ -71,6 +72,23 @@ OZZ_OPTIONS_DECLARE_BOOL(
   true,
   false);
 
+OZZ_OPTIONS_DECLARE_STRING(
+  report,
+  "Path to the timing report file written when the application exits. Frame,"
+  " update and render records statistics (in ms) are written as csv if the"
+  " file extension is \".csv\", as json otherwise. Combined with --norender"
+  " and --max_idle_loops, it allows to benchmark samples headlessly.",
+  "",
+  false);
+
+OZZ_OPTIONS_DECLARE_STRING(
+  trace,
+  "Path to the Chrome trace_event json file written when the application"
+  " exits, to be loaded in chrome://tracing. It contains timings of the frame,"
+  " update and render scopes, as well as of samples markers from all threads.",
+  "",
+  false);
+
 namespace {
 // Screen resolution presets.
 const ozz::sample::Resolution resolution_presets[] = {
@@ -171,12 +189,21 @@ int Application::Run(int _argc, const char** _argv,
   // Initialize help.
   ParseReadme();
 
+  // Starts tracing.
+  Trace* trace = NULL;
+  if (*OPTIONS_trace.value() != 0) {
+    trace = memory::default_allocator()->New<Trace>(1 << 20);
+    Trace::set_current(trace);
+  }
+
   // Open an OpenGL window
   bool success = true;
   if(OPTIONS_render) {
 
     // Initialize GLFW
     if (!glfwInit()) {
+      Trace::set_current(NULL);
+      memory::default_allocator()->Delete(trace);
       application_ = NULL;
       return EXIT_FAILURE;
     }
@@ -237,6 +264,20 @@ int Application::Run(int _argc, const char** _argv,
     success = Loop();
   }
 
+  // Outputs timing report.
+  if (success && *OPTIONS_report.value() != 0) {
+    success = WriteReport(OPTIONS_report, _title);
+  }
+
+  // Stops tracing and outputs trace.
+  if (trace) {
+    Trace::set_current(NULL);
+    if (success) {
+      success = trace->Export(OPTIONS_trace);
+    }
+    memory::default_allocator()->Delete(trace);
+  }
+
   // Notifies that an error occurred.
   if (!success) {
     log::Err() << "An error occurred during sample execution." <<
@@ -248,6 +289,67 @@ int Application::Run(int _argc, const char** _argv,
   return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+bool Application::WriteReport(const char* _filename, const char* _title) {
+  ozz::io::File file(_filename, "wb");
+  if (!file.opened()) {
+    log::Err() << "Failed to open report file \"" << _filename <<
+      "\" for writing." << std::endl;
+    return false;
+  }
+
+  // Selects output format from file extension.
+  const size_t length = std::strlen(_filename);
+  const bool csv =
+    length >= 4 && std::strcmp(_filename + length - 4, ".csv") == 0;
+
+  const struct {
+    const char* name;
+    Record* record;
+  } records[] = {
+    {"frame", fps_}, {"update", update_time_}, {"render", render_time_}};
+
+  char line[256];
+  if (csv) {
+    std::sprintf(line, "record,min,max,mean,latest\n");
+    file.Write(line, std::strlen(line));
+  } else {
+    std::sprintf(line, "{\n  \"title\": \"%s\",\n  \"render\": %s,\n"
+                       "  \"unit\": \"ms\",\n  \"records\": {\n",
+                 _title, OPTIONS_render ? "true" : "false");
+    file.Write(line, std::strlen(line));
+  }
+  bool first = true;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(records); ++i) {
+    // Skips empty records, like render one when rendering is disabled.
+    const Record::Statistics statistics = records[i].record->GetStatistics();
+    if (statistics.min > statistics.max) {
+      continue;
+    }
+    if (csv) {
+      std::sprintf(line, "%s,%f,%f,%f,%f\n",
+                   records[i].name, statistics.min, statistics.max,
+                   statistics.mean, statistics.latest);
+    } else {
+      std::sprintf(line, "%s    \"%s\": {\"min\": %f, \"max\": %f, "
+                         "\"mean\": %f, \"latest\": %f}",
+                   first ? "" : ",\n",
+                   records[i].name, statistics.min, statistics.max,
+                   statistics.mean, statistics.latest);
+    }
+    file.Write(line, std::strlen(line));
+    first = false;
+  }
+  if (!csv) {
+    std::sprintf(line, "\n  }\n}\n");
+    file.Write(line, std::strlen(line));
+  }
+
+  log::Out() << "Timing report written to \"" << _filename << "\"." <<
+    std::endl;
+
+  return true;
+}
+
 void OneLoopCbk(void* _arg) {
   Application* app = reinterpret_cast<Application*>(_arg);
   static int loops = 0;
@@ -257,6 +359,7 @@ void OneLoopCbk(void* _arg) {
 Application::LoopStatus Application::OneLoop(int _loops) {
 
   Profiler profile(fps_);  // Profiles frame.
+  TraceScope trace("frame");
 
   // Tests for a manual exit request.
   if (exit_ || glfwGetKey(GLFW_KEY_ESC) == GLFW_PRESS) {
@@ -343,6 +446,7 @@ bool Application::Display() {
 
   { // Profiles rendering excluding GUI.
     Profiler profile(render_time_);
+    TraceScope trace("render");
 
     GL(ClearColor(.33f, .333f, .315f, 0.f));
     GL(Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
@@ -427,6 +531,7 @@ bool Application::Idle(bool _first_frame) {
   bool update_result;
   {  // Profiles update scope.
     Profiler profile(update_time_);
+    TraceScope trace("update");
     update_result = OnUpdate(update_delta);
   }
 
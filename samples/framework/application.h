@@ -147,6 +147,10 @@ class Application {
   // Get README for content to display it in the help ui.
   void ParseReadme();
 
+  // Writes timing records statistics to _filename, as csv or json depending on
+  // _filename extension.
+  bool WriteReport(const char* _filename, const char* _title);
+
   // Disallow copy and assignment.
   Application(const Application& _application);
   void operator = (const Application& _application);
@@ -66,6 +66,26 @@ bool WriteTGA(const char* _filename,
               Format::Value _src_format,
               const uint8_t* _src_buffer,
               bool _write_alpha) {
+  uint8_t* scratch_buffer = ozz::memory::default_allocator()->
+    Allocate<uint8_t>(TGAScratchSize(_width, _height, _write_alpha));
+  const bool success = WriteTGA(_filename, _width, _height,
+                                _src_format, _src_buffer, _write_alpha,
+                                scratch_buffer);
+  ozz::memory::default_allocator()->Deallocate(scratch_buffer);
+  return success;
+}
+
+size_t TGAScratchSize(int _width, int _height, bool _write_alpha) {
+  // Enough space to store RLE packets for the worst case scenario.
+  return (1 + (_write_alpha ? 4 : 3)) * _width * _height;
+}
+
+bool WriteTGA(const char* _filename,
+              int _width, int _height,
+              Format::Value _src_format,
+              const uint8_t* _src_buffer,
+              bool _write_alpha,
+              uint8_t* _scratch_buffer) {
   union Pixel { uint8_t c[4]; uint32_t p;};
 
   assert(_filename && _src_buffer);
@@ -110,9 +130,10 @@ bool WriteTGA(const char* _filename,
     {2, 1, 0, 0}, {0, 1, 2, 0}, {2, 1, 0, 3}, {0, 1, 2, 3}};
   const uint8_t* mapping = mappings[_src_format];
 
-  // Allocates enough space to store RLE packets for the worst case scenario.
-  uint8_t* dest_buffer = ozz::memory::default_allocator()->
-    Allocate<uint8_t>((1 + (_write_alpha ? 4 : 3)) * _width * _height);
+  // Scratch buffer has enough space to store RLE packets for the worst case
+  // scenario.
+  assert(_scratch_buffer);
+  uint8_t* dest_buffer = _scratch_buffer;
 
   size_t dest_size = 0;
   if (HasAlpha(_src_format)) {
@@ -210,8 +231,6 @@ bool WriteTGA(const char* _filename,
   // Writes all the RLE packets buffer at once.
   file.Write(dest_buffer, dest_size);
 
-  ozz::memory::default_allocator()->Deallocate(dest_buffer);
-
   return true;
 }
 #undef PUSH_PIXEL_RGB
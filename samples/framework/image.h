@@ -62,6 +62,20 @@ bool WriteTGA(const char* _filename,
               const uint8_t* _src_buffer,
               bool _write_alpha);
 
+// Gets the size in bytes of the scratch buffer required by WriteTGA to encode
+// a _width * _height image.
+size_t TGAScratchSize(int _width, int _height, bool _write_alpha);
+
+// Writes as TARGA image to file _filename, using _scratch_buffer to encode the
+// image instead of allocating memory. _scratch_buffer must be at least
+// TGAScratchSize bytes. This allows to write images from any thread.
+bool WriteTGA(const char* _filename,
+              int _width, int _height,
+              Format::Value _src_format,
+              const uint8_t* _src_buffer,
+              bool _write_alpha,
+              uint8_t* _scratch_buffer);
+
 }  // image
 }  // sample
 }  // ozz
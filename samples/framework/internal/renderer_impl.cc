@@ -104,6 +104,81 @@ Renderer::Mesh::Indices Renderer::Mesh::indices() const {
   return buffer;
 }
 
+// 3 positions + 3 normals + 1 color + 2 joint indices + 4 joint weights
+static const size_t kSkinnedMeshStride = sizeof(uint32_t) * 13;
+
+Renderer::SkinnedMesh::SkinnedMesh(int _vertex_count, int _index_count) {
+  vertices_ =
+    memory::default_allocator()->AllocateRange<char>(
+      kSkinnedMeshStride * _vertex_count);
+  indices_ =
+    memory::default_allocator()->AllocateRange<uint16_t>(_index_count);
+}
+
+Renderer::SkinnedMesh::~SkinnedMesh() {
+  memory::default_allocator()->Deallocate(vertices_);
+  memory::default_allocator()->Deallocate(indices_);
+}
+
+Renderer::SkinnedMesh::Vertices Renderer::SkinnedMesh::vertices() const {
+  const Vertices buffer = {vertices_, kSkinnedMeshStride};
+  return buffer;
+}
+
+Renderer::SkinnedMesh::Positions Renderer::SkinnedMesh::positions() const {
+  const Positions buffer = {
+    Positions::DataRange(
+      reinterpret_cast<float*>(vertices_.begin + 0),
+      reinterpret_cast<const float*>(vertices_.end - sizeof(uint32_t) * 10)),
+    kSkinnedMeshStride};
+  return buffer;
+}
+
+Renderer::SkinnedMesh::Normals Renderer::SkinnedMesh::normals() const {
+  const Normals buffer = {
+    Normals::DataRange(
+      reinterpret_cast<float*>(vertices_.begin + sizeof(uint32_t) * 3),
+      reinterpret_cast<const float*>(vertices_.end - sizeof(uint32_t) * 7)),
+    kSkinnedMeshStride};
+  return buffer;
+}
+
+Renderer::SkinnedMesh::Colors Renderer::SkinnedMesh::colors() const {
+  const Colors buffer = {
+    Colors::DataRange(
+      reinterpret_cast<Mesh::Color*>(vertices_.begin + sizeof(uint32_t) * 6),
+      reinterpret_cast<const Mesh::Color*>(
+        vertices_.end - sizeof(uint32_t) * 6)),
+    kSkinnedMeshStride};
+  return buffer;
+}
+
+Renderer::SkinnedMesh::JointIndices
+Renderer::SkinnedMesh::joint_indices() const {
+  const JointIndices buffer = {
+    JointIndices::DataRange(
+      reinterpret_cast<uint16_t*>(vertices_.begin + sizeof(uint32_t) * 7),
+      reinterpret_cast<const uint16_t*>(
+        vertices_.end - sizeof(uint32_t) * 4)),
+    kSkinnedMeshStride};
+  return buffer;
+}
+
+Renderer::SkinnedMesh::JointWeights
+Renderer::SkinnedMesh::joint_weights() const {
+  const JointWeights buffer = {
+    JointWeights::DataRange(
+      reinterpret_cast<float*>(vertices_.begin + sizeof(uint32_t) * 9),
+      reinterpret_cast<const float*>(vertices_.end - 0)),
+    kSkinnedMeshStride};
+  return buffer;
+}
+
+Renderer::SkinnedMesh::Indices Renderer::SkinnedMesh::indices() const {
+  const Indices buffer = {indices_, 1 * sizeof(uint16_t)};
+  return buffer;
+}
+
 namespace internal {
 
 namespace {
@@ -137,14 +212,13 @@ RendererImpl::RendererImpl(Camera* _camera)
     : camera_(_camera),
       max_skeleton_pieces_(animation::Skeleton::kMaxJoints * 2),
       prealloc_uniforms_(NULL),
+      prealloc_uniforms_capacity_(0),
       dynamic_array_vbo_(0),
       dynamic_index_vbo_(0),
       immediate_(NULL),
-      mesh_shader_(NULL) {
-  prealloc_uniforms_ = reinterpret_cast<float*>(
-    memory::default_allocator()->Allocate(
-      max_skeleton_pieces_ * 16 * sizeof(float),
-      AlignOf<math::SimdFloat4>::value));
+      mesh_shader_(NULL),
+      skinning_shader_(NULL) {
+  ReserveUniforms(max_skeleton_pieces_);
 }
 
 RendererImpl::~RendererImpl() {
@@ -168,6 +242,9 @@ RendererImpl::~RendererImpl() {
 
   memory::default_allocator()->Delete(mesh_shader_);
   mesh_shader_ = NULL;
+
+  memory::default_allocator()->Delete(skinning_shader_);
+  skinning_shader_ = NULL;
 }
 
 bool RendererImpl::Initialize() {
@@ -194,6 +271,13 @@ bool RendererImpl::Initialize() {
     return false;
   }
 
+  // Instantiate gpu skinned mesh rendering shader. This one is optional, gpu
+  // skinning is reported as unsupported if it fails.
+  skinning_shader_ = SkinningShader::Build();
+  if (!skinning_shader_) {
+    log::Err() << "Gpu skinning isn't supported." << std::endl;
+  }
+
   return true;
 }
 
@@ -609,6 +693,90 @@ bool RendererImpl::DrawPosture(const ozz::animation::Skeleton& _skeleton,
   return true;
 }
 
+// Postures are converted to world space, so they can all be rendered with the
+// same (identity) model matrix in a single instanced draw call.
+// Falls back to a DrawPosture call per posture if instancing isn't available.
+bool RendererImpl::DrawPostures(
+  const animation::Skeleton& _skeleton,
+  ozz::Range<const ozz::Range<const ozz::math::Float4x4> > _matrices,
+  ozz::Range<const ozz::math::Float4x4> _transforms,
+  bool _draw_joints) {
+  const int num_postures = static_cast<int>(_matrices.Count());
+  if (num_postures != static_cast<int>(_transforms.Count())) {
+    return false;
+  }
+  const int num_joints = _skeleton.num_joints();
+  for (int i = 0; i < num_postures; ++i) {
+    const ozz::Range<const ozz::math::Float4x4>& matrices = _matrices.begin[i];
+    if (!matrices.begin || !matrices.end) {
+      return false;
+    }
+    if (matrices.end - matrices.begin < num_joints) {
+      return false;
+    }
+  }
+
+  if (!GL_ARB_instanced_arrays) {
+    for (int i = 0; i < num_postures; ++i) {
+      DrawPosture(_skeleton, _matrices.begin[i], _transforms.begin[i],
+                  _draw_joints);
+    }
+    return true;
+  }
+
+  if (!num_joints || !num_postures) {
+    return true;
+  }
+
+  // Reallocate matrix array if necessary.
+  if (prealloc_models_.Count() < static_cast<size_t>(num_joints)) {
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    allocator->Deallocate(prealloc_models_);
+    prealloc_models_ =
+      allocator->AllocateRange<ozz::math::Float4x4>(num_joints);
+  }
+
+  // A skeleton is rendered with at most 2 pieces per joint.
+  const int max_pieces = num_joints * 2;
+  if (!prealloc_models_.begin ||
+      !ReserveUniforms(num_postures * max_pieces)) {
+    return false;
+  }
+
+  // Convert world space matrices to uniforms.
+  int instance_count = 0;
+  for (int i = 0; i < num_postures; ++i) {
+    const ozz::math::Float4x4& transform = _transforms.begin[i];
+    const ozz::math::Float4x4* matrices = _matrices.begin[i].begin;
+    for (int j = 0; j < num_joints; ++j) {
+      prealloc_models_.begin[j] = transform * matrices[j];
+    }
+    instance_count += DrawPosture_FillUniforms(
+      _skeleton, prealloc_models_,
+      prealloc_uniforms_ + instance_count * 16, max_pieces);
+  }
+  assert(instance_count <= prealloc_uniforms_capacity_);
+
+  DrawPosture_InstancedImpl(ozz::math::Float4x4::identity(),
+                            instance_count,
+                            _draw_joints);
+
+  return true;
+}
+
+bool RendererImpl::ReserveUniforms(int _instance_count) {
+  if (_instance_count <= prealloc_uniforms_capacity_) {
+    return true;
+  }
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Deallocate(prealloc_uniforms_);
+  prealloc_uniforms_ = reinterpret_cast<float*>(
+    allocator->Allocate(_instance_count * 16 * sizeof(float),
+                        AlignOf<math::SimdFloat4>::value));
+  prealloc_uniforms_capacity_ = prealloc_uniforms_ ? _instance_count : 0;
+  return prealloc_uniforms_ != NULL;
+}
+
 bool RendererImpl::DrawBox(const ozz::math::Box& _box,
                            const ozz::math::Float4x4& _transform,
                            const Color _colors[2]) {
@@ -719,6 +887,81 @@ bool RendererImpl::DrawMesh(const ozz::math::Float4x4& _transform,
   return true;
 }
 
+int RendererImpl::max_skinning_matrices() const {
+  if (!skinning_shader_) {
+    return 0;
+  }
+  // Palette is stored in prealloc_uniforms_ buffer before being uploaded.
+  return math::Min(skinning_shader_->max_joints(), max_skeleton_pieces_);
+}
+
+bool RendererImpl::DrawSkinnedMesh(
+  const ozz::math::Float4x4& _transform,
+  const SkinnedMesh& _mesh,
+  ozz::Range<const ozz::math::Float4x4> _skinning_matrices) {
+  const int joint_count = static_cast<int>(_skinning_matrices.Count());
+  if (joint_count > max_skinning_matrices()) {
+    return false;
+  }
+
+  // Fills palette uniforms.
+  for (int i = 0; i < joint_count; ++i) {
+    const math::Float4x4& matrix = _skinning_matrices.begin[i];
+    float* uniform = prealloc_uniforms_ + 16 * i;
+    math::StorePtr(matrix.cols[0], uniform + 0);
+    math::StorePtr(matrix.cols[1], uniform + 4);
+    math::StorePtr(matrix.cols[2], uniform + 8);
+    math::StorePtr(matrix.cols[3], uniform + 12);
+  }
+
+  // Maps the vertex dynamic buffer and update it.
+  // Skinned mesh vertices are static, they would be uploaded once to a static
+  // vbo in a production renderer. The sample framework doesn't keep any
+  // per-mesh state though.
+  GL(BindBuffer(GL_ARRAY_BUFFER, dynamic_array_vbo_));
+  const SkinnedMesh::Vertices vertices_buffer = _mesh.vertices();
+  const size_t array_vbo_size = vertices_buffer.data.Size();
+  GL(BufferData(GL_ARRAY_BUFFER,
+                array_vbo_size,
+                vertices_buffer.data.begin,
+                GL_DYNAMIC_DRAW));
+
+  // Binds shader with this array buffer.
+  const GLsizei stride = static_cast<GLsizei>(vertices_buffer.stride);
+  skinning_shader_->Bind(_transform,
+                         camera()->view_proj(),
+                         prealloc_uniforms_, joint_count,
+                         stride, sizeof(float) * 0,
+                         stride, sizeof(float) * 3,
+                         stride, sizeof(float) * 6,
+                         stride, sizeof(float) * 7,
+                         stride, sizeof(float) * 9);
+
+  GL(BindBuffer(GL_ARRAY_BUFFER, 0));
+
+  // Maps the index dynamic buffer and update it.
+  GL(BindBuffer(GL_ELEMENT_ARRAY_BUFFER, dynamic_index_vbo_));
+  const SkinnedMesh::Indices indices_buffer = _mesh.indices();
+  const GLsizei index_vbo_size =
+    static_cast<GLsizei>(indices_buffer.data.Size());
+  GL(BufferData(GL_ELEMENT_ARRAY_BUFFER,
+                index_vbo_size,
+                indices_buffer.data.begin,
+                GL_DYNAMIC_DRAW));
+
+  // Draws the mesh.
+  GL(DrawElements(GL_TRIANGLES,
+                  index_vbo_size / sizeof(uint16_t),
+                  GL_UNSIGNED_SHORT,
+                  0));
+
+  // Unbinds.
+  GL(BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  skinning_shader_->Unbind();
+
+  return true;
+}
+
 // Helper macro used to initialize extension function pointer.
 #define OZZ_INIT_GL_EXT(_fct, _fct_type, _success) \
 do {\
@@ -80,6 +80,7 @@ class Camera;
 class Shader;
 class SkeletonShader;
 class AmbientShader;
+class SkinningShader;
 class GlImmediateRenderer;
 
 // Implements Renderer interface.
@@ -105,6 +106,12 @@ class RendererImpl : public Renderer {
                            const ozz::math::Float4x4& _transform,
                            bool _draw_joints);
 
+  virtual bool DrawPostures(
+    const animation::Skeleton& _skeleton,
+    ozz::Range<const ozz::Range<const ozz::math::Float4x4> > _matrices,
+    ozz::Range<const ozz::math::Float4x4> _transforms,
+    bool _draw_joints);
+
   virtual bool DrawBox(const ozz::math::Box& _box,
                        const ozz::math::Float4x4& _transform,
                        const Color _colors[2]);
@@ -112,6 +119,13 @@ class RendererImpl : public Renderer {
   virtual bool DrawMesh(const ozz::math::Float4x4& _transform,
                         const Mesh& _mesh);
 
+  virtual int max_skinning_matrices() const;
+
+  virtual bool DrawSkinnedMesh(
+    const ozz::math::Float4x4& _transform,
+    const SkinnedMesh& _mesh,
+    ozz::Range<const ozz::math::Float4x4> _skinning_matrices);
+
   // Get GL immediate renderer implementation;
   GlImmediateRenderer* immediate_renderer() const {
     return immediate_;
@@ -151,6 +165,10 @@ class RendererImpl : public Renderer {
   void DrawPosture_InstancedImpl(const ozz::math::Float4x4& _transform,
                                  int _instance_count, bool _draw_joints);
 
+  // Ensures prealloc_uniforms_ can store _instance_count matrices.
+  // Return false if reallocation failed.
+  bool ReserveUniforms(int _instance_count);
+
   // Array of matrices used to store model space matrices during DrawSkeleton
   // execution.
   ozz::Range<ozz::math::Float4x4> prealloc_models_;
@@ -165,6 +183,10 @@ class RendererImpl : public Renderer {
   // without gl instancing extension.
   float* prealloc_uniforms_;
 
+  // The number of matrices prealloc_uniforms_ can store. It's at least
+  // max_skeleton_pieces_, and grows to fit DrawPostures needs.
+  int prealloc_uniforms_capacity_;
+
   // Bone and joint model objects.
   Model models_[2];
 
@@ -179,6 +201,10 @@ class RendererImpl : public Renderer {
 
   // Mesh rendering shader.
   AmbientShader* mesh_shader_;
+
+  // Gpu skinned mesh rendering shader. Can be NULL if gpu skinning isn't
+  // supported.
+  SkinningShader* skinning_shader_;
 };
 }  // internal
 }  // sample
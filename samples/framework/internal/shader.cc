@@ -629,6 +629,139 @@ void AmbientShader::Unbind() {
   UnbindAttribs();
   GL(UseProgram(0));
 }
+
+SkinningShader* SkinningShader::Build() {
+  bool success = true;
+
+  // Deduces palette size from the number of uniform components available,
+  // keeping some room for the mvp matrix and driver internal uniforms.
+  GLint max_components = 0;
+  GL(GetIntegerv(GL_MAX_VERTEX_UNIFORM_COMPONENTS, &max_components));
+  const int max_joints = (max_components - 64) / 16;
+  if (max_joints <= 0) {
+    return NULL;
+  }
+  char max_joints_define[64];
+  std::sprintf(max_joints_define, "#define MAX_JOINTS %d\n", max_joints);
+
+  // Joint matrices are blended according to their respective weights, which
+  // sum to one. Normals are transformed by the blended matrix, the same way
+  // SkinningJob does.
+  const char* skinning_vs =
+    "uniform mat4 u_mvp;\n"
+    "uniform mat4 u_joints[MAX_JOINTS];\n"
+    "attribute vec3 a_position;\n"
+    "attribute vec3 a_normal;\n"
+    "attribute vec4 a_color;\n"
+    "attribute vec4 a_joint_indices;\n"
+    "attribute vec4 a_joint_weights;\n"
+    "varying vec3 v_world_normal;\n"
+    "varying vec4 v_vertex_color;\n"
+    "void main() {\n"
+    "  mat4 skinning_matrix =\n"
+    "    u_joints[int(a_joint_indices.x)] * a_joint_weights.x +\n"
+    "    u_joints[int(a_joint_indices.y)] * a_joint_weights.y +\n"
+    "    u_joints[int(a_joint_indices.z)] * a_joint_weights.z +\n"
+    "    u_joints[int(a_joint_indices.w)] * a_joint_weights.w;\n"
+    "  vec4 vertex = skinning_matrix * vec4(a_position.xyz, 1.);\n"
+    "  gl_Position = u_mvp * vertex;\n"
+    "  v_world_normal = (skinning_matrix * vec4(a_normal.xyz, 0.)).xyz;\n"
+    "  v_vertex_color = a_color;\n"
+    "}\n";
+
+  const char* vs[] = {
+    kPlatformSpecivicVSHeader,
+    max_joints_define,
+    skinning_vs};
+  const char* fs[] = {
+    kPlatformSpecivicFSHeader,
+    shader_ambient_fs};
+
+  SkinningShader* shader =
+    memory::default_allocator()->New<SkinningShader>();
+  success &= shader->BuildFromSource(OZZ_ARRAY_SIZE(vs), vs,
+                                     OZZ_ARRAY_SIZE(fs), fs);
+
+  // Binds default attributes
+  success &= shader->FindAttrib("a_position");
+  success &= shader->FindAttrib("a_normal");
+  success &= shader->FindAttrib("a_color");
+  success &= shader->FindAttrib("a_joint_indices");
+  success &= shader->FindAttrib("a_joint_weights");
+
+  // Binds default uniforms
+  success &= shader->BindUniform("u_mvp");
+  success &= shader->BindUniform("u_joints");
+
+  if (!success) {
+    memory::default_allocator()->Delete(shader);
+    shader = NULL;
+  } else {
+    shader->max_joints_ = max_joints;
+  }
+
+  return shader;
+}
+
+void SkinningShader::Bind(const math::Float4x4& _model,
+                          const math::Float4x4& _view_proj,
+                          const float* _joints, int _joint_count,
+                          GLsizei _pos_stride, GLsizei _pos_offset,
+                          GLsizei _normal_stride, GLsizei _normal_offset,
+                          GLsizei _color_stride, GLsizei _color_offset,
+                          GLsizei _joint_indices_stride,
+                          GLsizei _joint_indices_offset,
+                          GLsizei _joint_weights_stride,
+                          GLsizei _joint_weights_offset) {
+  assert(_joint_count <= max_joints_);
+
+  GL(UseProgram(program()));
+
+  const GLint position_attrib = attrib(0);
+  GL(EnableVertexAttribArray(position_attrib));
+  GL(VertexAttribPointer(position_attrib, 3, GL_FLOAT, GL_FALSE,
+    _pos_stride, GL_PTR_OFFSET(_pos_offset)));
+
+  const GLint normal_attrib = attrib(1);
+  GL(EnableVertexAttribArray(normal_attrib));
+  GL(VertexAttribPointer(normal_attrib, 3, GL_FLOAT, GL_TRUE,
+    _normal_stride, GL_PTR_OFFSET(_normal_offset)));
+
+  const GLint color_attrib = attrib(2);
+  GL(EnableVertexAttribArray(color_attrib));
+  GL(VertexAttribPointer(color_attrib, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+    _color_stride, GL_PTR_OFFSET(_color_offset)));
+
+  // Joint indices aren't normalized, they are converted to float values.
+  const GLint joint_indices_attrib = attrib(3);
+  GL(EnableVertexAttribArray(joint_indices_attrib));
+  GL(VertexAttribPointer(joint_indices_attrib, 4, GL_UNSIGNED_SHORT, GL_FALSE,
+    _joint_indices_stride, GL_PTR_OFFSET(_joint_indices_offset)));
+
+  const GLint joint_weights_attrib = attrib(4);
+  GL(EnableVertexAttribArray(joint_weights_attrib));
+  GL(VertexAttribPointer(joint_weights_attrib, 4, GL_FLOAT, GL_FALSE,
+    _joint_weights_stride, GL_PTR_OFFSET(_joint_weights_offset)));
+
+  // Binds mvp uniform
+  const GLint mvp_uniform = uniform(0);
+  const ozz::math::Float4x4 mvp = _view_proj * _model;
+  float values[16];
+  math::StorePtrU(mvp.cols[0], values + 0);
+  math::StorePtrU(mvp.cols[1], values + 4);
+  math::StorePtrU(mvp.cols[2], values + 8);
+  math::StorePtrU(mvp.cols[3], values + 12);
+  GL(UniformMatrix4fv(mvp_uniform, 1, false, values));
+
+  // Binds joints palette uniform.
+  const GLint joints_uniform = uniform(1);
+  GL(UniformMatrix4fv(joints_uniform, _joint_count, false, _joints));
+}
+
+void SkinningShader::Unbind() {
+  UnbindAttribs();
+  GL(UseProgram(0));
+}
 }  // internal
 }  // sample
 }  // ozz
@@ -206,6 +206,43 @@ public:
 
   void Unbind();
 };
+
+class SkinningShader : public Shader{
+public:
+  SkinningShader()
+    : max_joints_(0) {
+  }
+  virtual ~SkinningShader() {}
+
+  // Constructs the shader. The size of the joints palette is deduced from
+  // the number of uniforms available to the vertex shader.
+  // Returns NULL if shader compilation failed or a valid Shader pointer on
+  // success. The shader must then be deleted using default allocator Delete
+  // function.
+  static SkinningShader* Build();
+
+  // Binds the shader.
+  // _joints is an array of _joint_count matrices, each made of 16 floats.
+  void Bind(const math::Float4x4& _model,
+            const math::Float4x4& _view_proj,
+            const float* _joints, int _joint_count,
+            GLsizei _pos_stride, GLsizei _pos_offset,
+            GLsizei _normal_stride, GLsizei _normal_offset,
+            GLsizei _color_stride, GLsizei _color_offset,
+            GLsizei _joint_indices_stride, GLsizei _joint_indices_offset,
+            GLsizei _joint_weights_stride, GLsizei _joint_weights_offset);
+
+  void Unbind();
+
+  // Get the maximum number of joints the palette can store.
+  int max_joints() const {
+    return max_joints_;
+  }
+
+ private:
+  // The maximum number of joints the palette can store.
+  int max_joints_;
+};
 }  // internal
 }  // sample
 }  // ozz
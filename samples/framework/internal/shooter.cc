@@ -34,17 +34,217 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 
 #include "renderer_impl.h"
 
+#include "ozz/base/memory/allocator.h"
+
 namespace ozz {
 namespace sample {
 namespace internal {
 
+// Writes captured images to files from a background thread. Pixels are copied
+// to one of the pending image buffers, so the pbo can be unmapped immediately.
+// All memory is allocated from the main thread, the default allocator isn't
+// thread safe. Images are written synchronously if the thread can't be
+// created.
+struct Shooter::Writer {
+  explicit Writer(image::Format::Value _format);
+
+  // Writes all pending images and joins the thread.
+  ~Writer();
+
+  // Writes all pending images and reallocates buffers for _width * _height
+  // images.
+  void Resize(int _width, int _height);
+
+  // Pushes _pixels image to the pending stack, to be written as file number
+  // _number. Waits for an image buffer to be available if all are pending.
+  void Push(int _number, const void* _pixels);
+
+  // Waits for all pending images to be written.
+  void Flush();
+
+  // Implements thread loop.
+  void Run();
+
+  // Thread entry point, _writer is the Writer instance.
+  static void GLFWCALL ThreadFct(void* _writer);
+
+  // Writes image _number from _pixels buffer.
+  void Write(int _number, const uint8_t* _pixels);
+
+  // Defines a pending image.
+  struct Image {
+    uint8_t* pixels;
+    int number;
+  };
+
+  // Ring of pending images. begin and count are protected by mutex.
+  enum {
+    kMaxPendingImages = 4,
+  };
+  Image images[kMaxPendingImages];
+  int begin;
+  int count;
+
+  // Images format and size.
+  image::Format::Value format;
+  int width;
+  int height;
+
+  // Tga encoding scratch buffer, only used by the writing thread.
+  uint8_t* scratch;
+
+  // Requests thread to exit, protected by mutex.
+  bool exit;
+
+  // Threading objects, thread is negative if it couldn't be created.
+  GLFWmutex mutex;
+  GLFWcond cond;
+  GLFWthread thread;
+};
+
+Shooter::Writer::Writer(image::Format::Value _format)
+    : begin(0),
+      count(0),
+      format(_format),
+      width(0),
+      height(0),
+      scratch(NULL),
+      exit(false),
+      mutex(NULL),
+      cond(NULL),
+      thread(-1) {
+  for (int i = 0; i < kMaxPendingImages; ++i) {
+    images[i].pixels = NULL;
+    images[i].number = 0;
+  }
+#ifndef EMSCRIPTEN  // Threads aren't available.
+  mutex = glfwCreateMutex();
+  cond = glfwCreateCond();
+  if (mutex && cond) {
+    thread = glfwCreateThread(&ThreadFct, this);
+  }
+#endif  // EMSCRIPTEN
+}
+
+Shooter::Writer::~Writer() {
+  if (thread >= 0) {
+    glfwLockMutex(mutex);
+    exit = true;
+    glfwBroadcastCond(cond);
+    glfwUnlockMutex(mutex);
+    glfwWaitThread(thread, GLFW_WAIT);
+  }
+  if (cond) {
+    glfwDestroyCond(cond);
+  }
+  if (mutex) {
+    glfwDestroyMutex(mutex);
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  for (int i = 0; i < kMaxPendingImages; ++i) {
+    allocator->Deallocate(images[i].pixels);
+  }
+  allocator->Deallocate(scratch);
+}
+
+void Shooter::Writer::Resize(int _width, int _height) {
+  Flush();
+
+  width = _width;
+  height = _height;
+
+  memory::Allocator* allocator = memory::default_allocator();
+  const size_t size = image::Stride(format) * _width * _height;
+  for (int i = 0; i < kMaxPendingImages; ++i) {
+    allocator->Deallocate(images[i].pixels);
+    images[i].pixels = allocator->Allocate<uint8_t>(size);
+  }
+  allocator->Deallocate(scratch);
+  scratch = allocator->Allocate<uint8_t>(
+    image::TGAScratchSize(_width, _height, false));
+}
+
+void Shooter::Writer::Push(int _number, const void* _pixels) {
+  const size_t size = image::Stride(format) * width * height;
+  if (thread < 0) {
+    Write(_number, static_cast<const uint8_t*>(_pixels));
+    return;
+  }
+
+  // Waits for an available image. Only this thread pushes images, so the
+  // available one can be filled without locking.
+  glfwLockMutex(mutex);
+  while (count == kMaxPendingImages) {
+    glfwWaitCond(cond, mutex, GLFW_INFINITY);
+  }
+  Image& image = images[(begin + count) % kMaxPendingImages];
+  glfwUnlockMutex(mutex);
+
+  std::memcpy(image.pixels, _pixels, size);
+  image.number = _number;
+
+  // Notifies the writer.
+  glfwLockMutex(mutex);
+  ++count;
+  glfwBroadcastCond(cond);
+  glfwUnlockMutex(mutex);
+}
+
+void Shooter::Writer::Flush() {
+  if (thread < 0) {
+    return;
+  }
+  glfwLockMutex(mutex);
+  while (count != 0) {
+    glfwWaitCond(cond, mutex, GLFW_INFINITY);
+  }
+  glfwUnlockMutex(mutex);
+}
+
+void Shooter::Writer::Run() {
+  glfwLockMutex(mutex);
+  for (;;) {
+    while (count == 0 && !exit) {
+      glfwWaitCond(cond, mutex, GLFW_INFINITY);
+    }
+    // Exits once all pending images are written.
+    if (count == 0) {
+      break;
+    }
+    const Image& image = images[begin];
+    glfwUnlockMutex(mutex);
+
+    // The image can't be modified by the main thread until it's popped.
+    Write(image.number, image.pixels);
+
+    glfwLockMutex(mutex);
+    begin = (begin + 1) % kMaxPendingImages;
+    --count;
+    glfwBroadcastCond(cond);
+  }
+  glfwUnlockMutex(mutex);
+}
+
+void GLFWCALL Shooter::Writer::ThreadFct(void* _writer) {
+  static_cast<Writer*>(_writer)->Run();
+}
+
+void Shooter::Writer::Write(int _number, const uint8_t* _pixels) {
+  char name[16];
+  sprintf(name, "%06d.tga", _number);
+  image::WriteTGA(name, width, height, format, _pixels, false, scratch);
+}
+
 Shooter::Shooter()
     : gl_shot_format_(GL_RGBA),  // Default fail safe format and types.
       image_format_(image::Format::kRGBA),
-      shot_number_(0) {
+      shot_number_(0),
+      writer_(NULL) {
   // Test required extension (optional for the framework).
   supported_ = glMapBuffer != NULL && glUnmapBuffer != NULL;
 
@@ -90,6 +290,9 @@ Shooter::Shooter()
     gl_shot_format_ = GL_RGBA;
     image_format_ = image::Format::kRGBA;
   }
+
+  // Images writer must be created once format is known.
+  writer_ = memory::default_allocator()->New<Writer>(image_format_);
 }
 
 Shooter::~Shooter() {
@@ -103,6 +306,9 @@ Shooter::~Shooter() {
 
     assert(shot.cooldown == 0);  // Must have been processed.
   }
+
+  // Writes all pending images.
+  memory::default_allocator()->Delete(writer_);
 }
 
 void Shooter::Resize(int _width, int _height) {
@@ -114,6 +320,9 @@ void Shooter::Resize(int _width, int _height) {
   // Process all remaining shots.
   ProcessAll();
 
+  // Resizes writer images, once pending ones are written.
+  writer_->Resize(_width, _height);
+
   // Resizes all pbos.
   for (int i = 0; i < kNumShots; ++i) {
     Shot& shot = shots_[i];
@@ -150,19 +359,12 @@ bool Shooter::Process() {
       continue;
     }
 
-    // Processes this shot.
+    // Processes this shot. Pixels are copied to the writer, which outputs
+    // the file from its thread.
     GL(BindBuffer(GL_PIXEL_PACK_BUFFER, shot.pbo));
     const void* pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
     if(pixels) {
-      char name[16];
-      sprintf(name, "%06d.tga", shot_number_++);
-
-      ozz::sample::image::WriteTGA(name,
-                                   shot.width,
-                                   shot.height,
-                                   image_format_,
-                                   reinterpret_cast<const uint8_t*>(pixels),
-                                   false);
+      writer_->Push(shot_number_++, pixels);
       GL(UnmapBuffer(GL_PIXEL_PACK_BUFFER));
     }
     GL(BindBuffer(GL_PIXEL_PACK_BUFFER, 0));
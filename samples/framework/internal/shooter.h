@@ -39,7 +39,10 @@ namespace ozz {
 namespace sample {
 namespace internal {
 
-// Implements GL screen shot and video shooter
+// Implements GL screen shot and video shooter.
+// Pixels are read back asynchronously to a ring of pbos, which are mapped a
+// few frames later. Captured images are then written to files by a
+// background thread, so that recording doesn't stall the rendering loop.
 class Shooter {
  public:
   Shooter();
@@ -91,6 +94,10 @@ class Shooter {
 
   // Is the shooter functionality supported.
   bool supported_;
+
+  // Declares background images writer, which also implements the thread.
+  struct Writer;
+  Writer* writer_;
 };
 }  // internal
 }  // sample
@@ -28,28 +28,116 @@
 //                                                                            //
 //============================================================================//
 
-#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
-
 #include "framework/profile.h"
-#include "framework/internal/renderer_impl.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else  // _WIN32
+#include <time.h>
+#endif  // _WIN32
+
+#include <cassert>
 #include <cfloat>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
 #include "ozz/base/memory/allocator.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedExchangeAdd)
+#define OZZ_THREAD_LOCAL __declspec(thread)
+#else  // _MSC_VER
+#define OZZ_THREAD_LOCAL __thread
+#endif  // _MSC_VER
+
 namespace ozz {
 namespace sample {
 
+namespace {
+// Gets a monotonic time, in seconds. glfw timer isn't used as it's only
+// available once glfw is initialized, which isn't the case when rendering is
+// disabled.
+double Now() {
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+#else  // _WIN32
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif  // _WIN32
+}
+
+// Atomically adds _add to *_value and returns its previous value. Acts as a
+// full barrier.
+int FetchAdd(volatile int* _value, int _add) {
+#if defined(_MSC_VER)
+  return _InterlockedExchangeAdd(reinterpret_cast<volatile long*>(_value),
+                                 _add);
+#else  // _MSC_VER
+  return __sync_fetch_and_add(_value, _add);
+#endif  // _MSC_VER
+}
+
+// Atomically loads *_value. Acts as a full barrier.
+int Load(volatile int* _value) {
+  return FetchAdd(_value, 0);
+}
+
+// Counters used to assign unique trace and thread identifiers, 0 being
+// reserved.
+volatile int g_trace_counter = 0;
+volatile int g_thread_counter = 0;
+
+// Gets calling thread identifier, assigned the first time it's requested.
+OZZ_THREAD_LOCAL int g_thread_id = 0;
+int GetThreadId() {
+  if (g_thread_id == 0) {
+    g_thread_id = FetchAdd(&g_thread_counter, 1) + 1;
+  }
+  return g_thread_id;
+}
+
+// Chunk the calling thread pushes events to, which belongs to the trace
+// identified by g_chunk_trace.
+OZZ_THREAD_LOCAL void* g_chunk = NULL;
+OZZ_THREAD_LOCAL uint32_t g_chunk_trace = 0;
+
+// The trace markers are recorded to.
+Trace* g_current_trace = NULL;
+
+// Number of events per chunk.
+const int kChunkEvents = 1024;
+
+// Writes _string to _file, escaping json special characters.
+void WriteJsonString(io::File* _file, const char* _string) {
+  _file->Write("\"", 1);
+  for (const char* c = _string; *c != 0; ++c) {
+    if (*c == '"' || *c == '\\') {
+      _file->Write("\\", 1);
+    }
+    _file->Write(c, 1);
+  }
+  _file->Write("\"", 1);
+}
+}  // namespace
+
 Profiler::Profiler(Record* _record)
-    : begin_(static_cast<float>(glfwGetTime())),
+    : begin_(Now()),
       record_(_record) {
 }
 
 Profiler::~Profiler() {
   if (record_) {
-    float end = static_cast<float>(glfwGetTime());
-    record_->Push((end - begin_) * 1000.f);
+    const double end = Now();
+    record_->Push(static_cast<float>((end - begin_) * 1000.));
   }
 }
 
@@ -117,5 +205,170 @@ Record::Statistics Record::GetStatistics() {
 
   return statistics;
 }
+
+// A trace event, times are in micro seconds.
+struct Trace::Event {
+  const char* name;
+  double begin;
+  double end;
+};
+
+// A chunk of events owned by a single thread.
+struct Trace::Chunk {
+  // Owner thread identifier.
+  int thread;
+  // Number of events published to the chunk. Only the owner thread modifies
+  // it, after events are written.
+  volatile int count;
+  Event events[kChunkEvents];
+};
+
+Trace::Trace(int _max_events)
+    : id_(static_cast<uint32_t>(FetchAdd(&g_trace_counter, 1) + 1)),
+      origin_(ozz::sample::Now()),
+      main_thread_(GetThreadId()),
+      chunks_(NULL),
+      num_chunks_((_max_events + kChunkEvents - 1) / kChunkEvents),
+      next_chunk_(0),
+      dropped_(0) {
+  if (num_chunks_ < 1) {
+    num_chunks_ = 1;
+  }
+  chunks_ = memory::default_allocator()->Allocate<Chunk>(num_chunks_);
+}
+
+Trace::~Trace() {
+  assert(g_current_trace != this && "Trace must not be current anymore.");
+  memory::default_allocator()->Deallocate(chunks_);
+}
+
+void Trace::set_current(Trace* _trace) {
+  g_current_trace = _trace;
+}
+
+Trace* Trace::current() {
+  return g_current_trace;
+}
+
+double Trace::Now() const {
+  return (ozz::sample::Now() - origin_) * 1e6;
+}
+
+int Trace::dropped() const {
+  return Load(const_cast<volatile int*>(&dropped_));
+}
+
+void Trace::Push(const char* _name, double _begin, double _end) {
+  Chunk* chunk = static_cast<Chunk*>(g_chunk);
+  if (g_chunk_trace != id_ || !chunk || chunk->count == kChunkEvents) {
+    // Acquires a new chunk.
+    const int index = FetchAdd(&next_chunk_, 1);
+    if (index >= num_chunks_) {
+      FetchAdd(&dropped_, 1);
+      g_chunk = NULL;
+      return;
+    }
+    chunk = chunks_ + index;
+    chunk->thread = GetThreadId();
+    chunk->count = 0;
+    g_chunk = chunk;
+    g_chunk_trace = id_;
+  }
+
+  Event& event = chunk->events[chunk->count];
+  event.name = _name;
+  event.begin = _begin;
+  event.end = _end;
+
+  // Publishes the event, after it's written.
+  FetchAdd(&chunk->count, 1);
+}
+
+bool Trace::Export(const char* _filename) const {
+  io::File file(_filename, "wb");
+  if (!file.opened()) {
+    log::Err() << "Failed to open trace file \"" << _filename <<
+      "\" for writing." << std::endl;
+    return false;
+  }
+
+  const char header[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  file.Write(header, sizeof(header) - 1);
+
+  // Outputs events, while listing threads.
+  ozz::Vector<int>::Std threads;
+  const int next_chunk = Load(const_cast<volatile int*>(&next_chunk_));
+  const int num_chunks = next_chunk < num_chunks_ ? next_chunk : num_chunks_;
+  bool first = true;
+  char line[128];
+  for (int c = 0; c < num_chunks; ++c) {
+    Chunk& chunk = chunks_[c];
+    const int count = Load(&chunk.count);
+    for (int e = 0; e < count; ++e) {
+      const Event& event = chunk.events[e];
+      if (!first) {
+        file.Write(",\n", 2);
+      }
+      first = false;
+      file.Write("{\"name\":", 8);
+      WriteJsonString(&file, event.name);
+      std::sprintf(line,
+                   ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+                   "\"ts\":%.3f,\"dur\":%.3f}",
+                   chunk.thread, event.begin, event.end - event.begin);
+      file.Write(line, std::strlen(line));
+    }
+    if (count != 0) {
+      size_t t = 0;
+      for (; t < threads.size() && threads[t] != chunk.thread; ++t) {
+      }
+      if (t == threads.size()) {
+        threads.push_back(chunk.thread);
+      }
+    }
+  }
+
+  // Outputs threads names metadata.
+  for (size_t t = 0; t < threads.size(); ++t) {
+    if (!first) {
+      file.Write(",\n", 2);
+    }
+    first = false;
+    if (threads[t] == main_thread_) {
+      std::sprintf(line, "{\"name\":\"thread_name\",\"ph\":\"M\","
+                   "\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"main\"}}",
+                   threads[t]);
+    } else {
+      std::sprintf(line, "{\"name\":\"thread_name\",\"ph\":\"M\","
+                   "\"pid\":0,\"tid\":%d,"
+                   "\"args\":{\"name\":\"thread %d\"}}",
+                   threads[t], threads[t]);
+    }
+    file.Write(line, std::strlen(line));
+  }
+
+  const char footer[] = "\n]}\n";
+  file.Write(footer, sizeof(footer) - 1);
+
+  log::Out() << "Trace written to \"" << _filename << "\"." << std::endl;
+  const int dropped = this->dropped();
+  if (dropped != 0) {
+    log::Err() << dropped << " trace events were dropped as the trace buffer "
+      "was full." << std::endl;
+  }
+  return true;
+}
+
+TraceScope::TraceScope(const char* _name)
+    : trace_(Trace::current()),
+      name_(_name),
+      begin_(trace_ ? trace_->Now() : 0.) {
+}
+
+TraceScope::~TraceScope() {
+  if (trace_) {
+    trace_->Push(name_, begin_, trace_->Now());
+  }
+}
 }  // sample
 }  // ozz
@@ -31,6 +31,8 @@
 #ifndef OZZ_SAMPLES_FRAMEWORK_PROFILE_H_
 #define OZZ_SAMPLES_FRAMEWORK_PROFILE_H_
 
+#include "ozz/base/platform.h"
+
 namespace ozz {
 namespace sample {
 // Records up to a maximum number of float values. Once the maximum number is
@@ -115,12 +117,110 @@ class Profiler {
   Profiler(const Profiler& _profiler);
   void operator = (const Profiler& _profiler);
 
-  // The time at which profiling began.
-  float begin_;
+  // The time at which profiling began, in seconds.
+  double begin_;
 
   // Profiling result is pushed in the record_ object.
   Record* record_;
 };
+
+// Collects timings of scoped markers (see TraceScope) from any thread, and
+// exports them to Chrome trace_event json format, to be visualized with
+// chrome://tracing. Nested markers appear as a hierarchy in the timeline of
+// their thread.
+// Events are stored in a buffer allocated once at construction. This buffer
+// is divided in chunks of events, that threads acquire with a single atomic
+// operation. A chunk is owned by a single thread, which appends events to it
+// without any lock or atomic operation. Events are dropped once the buffer is
+// full.
+class Trace {
+ public:
+  // Constructs a trace that can store up to _max_events events. Markers are
+  // recorded only once the trace is set as the current one.
+  explicit Trace(int _max_events);
+
+  // Deallocates events buffer. The trace must not be current anymore.
+  ~Trace();
+
+  // Sets the trace markers are recorded to, which can be NULL to disable
+  // recording. This function isn't thread safe, it's expected to be called
+  // while no marker is being recorded.
+  static void set_current(Trace* _trace);
+
+  // Gets the trace markers are recorded to, NULL if none.
+  static Trace* current();
+
+  // Writes recorded events to _filename, in Chrome trace_event json format.
+  // Events being recorded concurrently might not be exported.
+  // Returns false if the file couldn't be written.
+  bool Export(const char* _filename) const;
+
+  // Gets the number of events that were dropped because the buffer was full.
+  int dropped() const;
+
+ private:
+  // Disables assignment and copy.
+  Trace(const Trace& _trace);
+  void operator = (const Trace& _trace);
+
+  // TraceScope pushes events.
+  friend class TraceScope;
+
+  // Pushes an event from the calling thread. _name must outlive the trace.
+  void Push(const char* _name, double _begin, double _end);
+
+  // Gets the current time, relative to trace creation, in micro seconds.
+  double Now() const;
+
+  struct Event;
+  struct Chunk;
+
+  // Unique trace identifier, used to invalidate threads cached chunk.
+  uint32_t id_;
+
+  // Creation time, in seconds.
+  double origin_;
+
+  // Identifier of the thread that created the trace.
+  int main_thread_;
+
+  // Chunks buffer.
+  Chunk* chunks_;
+  int num_chunks_;
+
+  // Index of the next chunk to acquire, atomically incremented.
+  volatile int next_chunk_;
+
+  // Number of dropped events, atomically incremented.
+  volatile int dropped_;
+};
+
+// Records the time spent between the constructor and the destructor (as a
+// RAII object) as an event of the current trace (see Trace::set_current).
+// Does nothing if there's no current trace.
+class TraceScope {
+ public:
+  // Starts measurement. _name must outlive the trace, which is the case of
+  // string literals.
+  explicit TraceScope(const char* _name);
+
+  // Ends measurement and pushes the event to the trace.
+  ~TraceScope();
+
+ private:
+  // Disables assignment and copy.
+  TraceScope(const TraceScope& _scope);
+  void operator = (const TraceScope& _scope);
+
+  // The trace the event is pushed to, NULL if none.
+  Trace* trace_;
+
+  // Name of the marker.
+  const char* name_;
+
+  // The time at which the scope began, in micro seconds.
+  double begin_;
+};
 }  // sample
 }  // ozz
 #endif  // OZZ_SAMPLES_FRAMEWORK_PROFILE_H_
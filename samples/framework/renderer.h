@@ -76,6 +76,20 @@ class Renderer {
                            const ozz::math::Float4x4& _transform,
                            bool _draw_joints = true) = 0;
 
+  // Renders multiple skeletons, sharing the same _skeleton, in the postures
+  // given by each of the _matrices model space ranges. Every posture is
+  // rendered at the location given by the corresponding _transforms matrix.
+  // Whenever possible, all postures are rendered in a single instanced draw
+  // call.
+  // Returns true on success, or false if _matrices and _transforms counts
+  // mismatch, or if any of the _matrices range does not match with the
+  // _skeleton.
+  virtual bool DrawPostures(
+    const animation::Skeleton& _skeleton,
+    ozz::Range<const ozz::Range<const ozz::math::Float4x4> > _matrices,
+    ozz::Range<const ozz::math::Float4x4> _transforms,
+    bool _draw_joints = true) = 0;
+
   // Renders a box at a specified location.
   // The 2 slots of _colors array respectively defines color of the filled
   // faces and color of the box outlines.
@@ -127,6 +141,71 @@ class Renderer {
   // Renders a mesh at a specified location.
   virtual bool DrawMesh(const ozz::math::Float4x4& _transform,
                         const Mesh& _mesh) = 0;
+
+  // Defines a mesh that is skinned by the GPU. Vertices store bind pose
+  // positions and normals, along with the indices and weights of up to
+  // kMaxInfluences joints. In opposition to Mesh, these data are static, they
+  // do not need to be updated every frame.
+  class SkinnedMesh {
+   public:
+    SkinnedMesh(int _vertex_count, int _index_count);
+    ~SkinnedMesh();
+
+    // The maximum number of joints influencing a vertex.
+    enum {
+      kMaxInfluences = 4
+    };
+
+    // Vertices are a buffered positions, normals, colors, joint indices and
+    // joint weights.
+    typedef Mesh::Vertices Vertices;
+    Vertices vertices() const;
+
+    // Positions are a buffer of 3 consecutive floats per vertex.
+    typedef Mesh::Positions Positions;
+    Positions positions() const;
+
+    // Normals are a buffer of 3 float per vertex.
+    typedef Mesh::Normals Normals;
+    Normals normals() const;
+
+    // Colors are a buffer of 4 unsigned byte per vertex.
+    typedef Mesh::Colors Colors;
+    Colors colors() const;
+
+    // Joint indices are a buffer of kMaxInfluences uint16_t per vertex.
+    typedef Mesh::Buffer<uint16_t> JointIndices;
+    JointIndices joint_indices() const;
+
+    // Joint weights are a buffer of kMaxInfluences float per vertex. Unused
+    // influences must have a null weight.
+    typedef Mesh::Buffer<float> JointWeights;
+    JointWeights joint_weights() const;
+
+    // Indices are a buffer of 3 consecutive uint16_t per triangle.
+    typedef Mesh::Indices Indices;
+    Indices indices() const;
+
+   private:
+     SkinnedMesh(const SkinnedMesh&);
+     void operator=(const SkinnedMesh&);
+
+     Vertices::DataRange vertices_;
+     Indices::DataRange indices_;
+  };
+
+  // Returns the maximum number of skinning matrices supported by
+  // DrawSkinnedMesh, which depends on GPU capabilities. Returns 0 if GPU
+  // skinning isn't supported.
+  virtual int max_skinning_matrices() const = 0;
+
+  // Renders a mesh at a specified location, skinned by the GPU using
+  // _skinning_matrices palette.
+  // Returns false if _skinning_matrices range exceeds max_skinning_matrices().
+  virtual bool DrawSkinnedMesh(
+    const ozz::math::Float4x4& _transform,
+    const SkinnedMesh& _mesh,
+    ozz::Range<const ozz::math::Float4x4> _skinning_matrices) = 0;
 };
 }  // sample
 }  // ozz
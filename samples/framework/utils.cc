@@ -38,6 +38,7 @@
 #include "ozz/base/memory/allocator.h"
 
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/compute_bounds_job.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
 
@@ -132,7 +133,7 @@ void ComputeSkeletonBounds(const animation::Skeleton& _skeleton,
   allocator->Deallocate(models);
 }
 
-// Loop through matrices and collect min and max bounds.
+// Collects min and max bounds of matrices translations.
 void ComputePostureBounds(ozz::Range<const ozz::math::Float4x4> _matrices,
                           math::Box* _bound) {
   assert(_bound);
@@ -140,27 +141,12 @@ void ComputePostureBounds(ozz::Range<const ozz::math::Float4x4> _matrices,
   // Set a default box.
   *_bound = ozz::math::Box();
 
-  if (!_matrices.begin || !_matrices.end) {
-    return;
-  }
-  if (_matrices.begin > _matrices.end) {
-    return;
-  }
-
-  math::SimdFloat4 min =
-    math::simd_float4::Load1(std::numeric_limits<float>::max());
-  math::SimdFloat4 max = -min;
-  const ozz::math::Float4x4* current = _matrices.begin;
-  while (current < _matrices.end) {
-    min = math::Min(min, current->cols[3]);
-    max = math::Max(max, current->cols[3]);
-    ++current;
-  }
-
-  math::Store3PtrU(min, &_bound->min.x);
-  math::Store3PtrU(max, &_bound->max.x);
-
-  return;
+  // Reduces joint positions with the ComputeBoundsJob, which leaves the
+  // default box if _matrices range is invalid.
+  ozz::animation::ComputeBoundsJob job;
+  job.models = _matrices;
+  job.bound = _bound;
+  job.Run();
 }
 
 bool LoadSkeleton(const char* _filename,
@@ -174,15 +160,28 @@ bool LoadSkeleton(const char* _filename,
       << std::endl;
     return false;
   }
-  ozz::io::IArchive archive(&file);
+  // Buffers file accesses, as archives perform many small reads. Compressed
+  // archives are decompressed transparently.
+  ozz::io::BufferedStream buffered(&file);
+  ozz::io::CompressedStream compressed(&buffered,
+                                       ozz::io::CompressedStream::kRead);
+  ozz::io::IArchive archive(compressed.opened() ?
+    static_cast<ozz::io::Stream*>(&compressed) : &buffered);
   if (!archive.TestTag<ozz::animation::Skeleton>()) {
     ozz::log::Err() << "Failed to load skeleton instance from file " <<
       _filename << "." << std::endl;
     return false;
   }
 
-  // Once the tag is validated, reading cannot fail.
+  // Once the tag is validated, reading cannot fail, but data can be
+  // corrupted if the archive stores checksums.
+  archive.set_verify(true);
   archive >> *_skeleton;
+  if (archive.corrupted()) {
+    ozz::log::Err() << "Corrupted skeleton data in file " << _filename << "." <<
+      std::endl;
+    return false;
+  }
 
   return true;
 }
@@ -198,15 +197,28 @@ bool LoadAnimation(const char* _filename,
       "." << std::endl;
     return false;
   }
-  ozz::io::IArchive archive(&file);
+  // Buffers file accesses, as archives perform many small reads. Compressed
+  // archives are decompressed transparently.
+  ozz::io::BufferedStream buffered(&file);
+  ozz::io::CompressedStream compressed(&buffered,
+                                       ozz::io::CompressedStream::kRead);
+  ozz::io::IArchive archive(compressed.opened() ?
+    static_cast<ozz::io::Stream*>(&compressed) : &buffered);
   if (!archive.TestTag<ozz::animation::Animation>()) {
     ozz::log::Err() << "Failed to load animation instance from file " <<
       _filename << "." << std::endl;
     return false;
   }
 
-  // Once the tag is validated, reading cannot fail.
+  // Once the tag is validated, reading cannot fail, but data can be
+  // corrupted if the archive stores checksums.
+  archive.set_verify(true);
   archive >> *_animation;
+  if (archive.corrupted()) {
+    ozz::log::Err() << "Corrupted animation data in file " << _filename << "." <<
+      std::endl;
+    return false;
+  }
 
   return true;
 }
@@ -0,0 +1,66 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_SAMPLES_MILLIPEDE_MILLIPEDE_H_
+#define OZZ_SAMPLES_MILLIPEDE_MILLIPEDE_H_
+
+// Procedurally generates millipede skeletons and walk animations, with an
+// arbitrary number of joints. The generator doesn't depend on the sample
+// framework, so it's shared by the millipede sample and the benchmarks.
+
+namespace ozz {
+namespace animation {
+class Skeleton;
+namespace offline {
+struct RawAnimation;
+struct RawSkeleton;
+}  // offline
+}  // animation
+namespace sample {
+
+// Gets the number of joints of a millipede skeleton of _slice_count slices. A
+// slice is made of 2 legs of 3 joints and a spine joint, after the root.
+inline int MillipedeJointCount(int _slice_count) {
+  return 1 + _slice_count * 7;
+}
+
+// Fills _skeleton with a millipede of _slice_count slices.
+void CreateMillipedeSkeleton(int _slice_count,
+                             animation::offline::RawSkeleton* _skeleton);
+
+// Fills _animation with a looping walk animation of the millipede _skeleton,
+// built from a RawSkeleton filled by CreateMillipedeSkeleton with the same
+// _slice_count.
+void CreateMillipedeAnimation(int _slice_count,
+                              const animation::Skeleton& _skeleton,
+                              animation::offline::RawAnimation* _animation);
+}  // sample
+}  // ozz
+#endif  // OZZ_SAMPLES_MILLIPEDE_MILLIPEDE_H_
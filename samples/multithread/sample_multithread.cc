@@ -28,7 +28,7 @@
 //                                                                            //
 //============================================================================//
 
-#include <omp.h>
+#include <cstdio>
 #include <cstdlib>
 
 #include "ozz/animation/runtime/animation.h"
@@ -48,11 +48,14 @@
 
 #include "ozz/base/memory/allocator.h"
 
+#include "ozz/base/tasks/thread_pool.h"
+
 #include "ozz/options/options.h"
 
 #include "framework/application.h"
 #include "framework/renderer.h"
 #include "framework/imgui.h"
+#include "framework/profile.h"
 #include "framework/utils.h"
 
 // Skeleton archive can be specified as an option.
@@ -80,12 +83,13 @@ class MultithreadSampleApplication : public ozz::sample::Application {
  public:
   MultithreadSampleApplication()
     : num_characters_(kWidth * kDepth),
-      enable_openmp_(true),
+      enable_threads_(true),
       num_threads_(1),
-      openmp_statistics() {
-    // Do not allocate all threads to OpenMp by default, as it is too intensive.
-    const int max_threads = omp_get_max_threads();
-    num_threads_ = (max_threads > 2) ? max_threads - 1 : max_threads;
+      num_procs_(ozz::tasks::ThreadPool::hardware_concurrency()),
+      pool_(NULL) {
+    // Do not allocate all threads to the pool by default, as it is too
+    // intensive.
+    num_threads_ = (num_procs_ > 2) ? num_procs_ - 1 : num_procs_;
   }
 
  private:
@@ -98,25 +102,39 @@ class MultithreadSampleApplication : public ozz::sample::Application {
   // Updates current animation time.
   virtual bool OnUpdate(float _dt) {
 
-    #pragma omp parallel if (enable_openmp_) num_threads(num_threads_)
-    {
-        // Collect open mp statistics on the master thread.
-        #pragma omp single
-        {
-          openmp_statistics.num_procs = omp_get_num_procs();
-          openmp_statistics.num_threads = omp_get_num_threads();
-          openmp_statistics.max_threads = omp_get_max_threads();
-        }
-        // Updates all animations.
-        #pragma omp for
-        for (int i = 0; i < num_characters_; ++i) {
-          UpdateCharacter(&characters_[i], _dt);
-        }
+    // Recreates the pool if the number of threads changed.
+    if (pool_->num_threads() != num_threads_) {
+      ozz::memory::default_allocator()->Delete(pool_);
+      pool_ = ozz::memory::default_allocator()->
+        New<ozz::tasks::ThreadPool>(num_threads_);
+    }
+
+    // Updates all animations, a work item per character.
+    const UpdateTask task(this, _dt);
+    if (enable_threads_) {
+      pool_->Dispatch(task, num_characters_);
+    } else {
+      ozz::tasks::serial_dispatcher()->Dispatch(task, num_characters_);
     }
 
     return true;
   }
 
+  // Updates a character per work item.
+  class UpdateTask : public ozz::tasks::Task {
+   public:
+    UpdateTask(MultithreadSampleApplication* _application, float _dt)
+      : application_(_application),
+        dt_(_dt) {
+    }
+    virtual void Run(int _index) const {
+      application_->UpdateCharacter(&application_->characters_[_index], dt_);
+    }
+   private:
+    MultithreadSampleApplication* application_;
+    float dt_;
+  };
+
   bool UpdateCharacter(Character* _character, float _dt) {
 
     // Samples animation.
@@ -130,8 +148,11 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     sampling_job.output = _character->locals;
 
     // Samples animation.
-    if (!sampling_job.Run()) {
-      return false;
+    {
+      ozz::sample::TraceScope trace("sampling");
+      if (!sampling_job.Run()) {
+        return false;
+      }
     }
 
     // Converts from local space to model space matrices.
@@ -139,33 +160,29 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     ltm_job.skeleton = &skeleton_;
     ltm_job.input = _character->locals;
     ltm_job.output = _character->models;
-    if (!ltm_job.Run()) {
-      return false;
+    {
+      ozz::sample::TraceScope trace("local_to_model");
+      if (!ltm_job.Run()) {
+        return false;
+      }
     }
 
     return true;
   }
 
-  // Renders all skeletons.
+  // Renders all skeletons at once, so the renderer can batch them in a single
+  // instanced draw call.
   virtual bool OnDisplay(ozz::sample::Renderer* _renderer) {
-
-    bool success = true;
-    for (int c = 0; success && c < num_characters_; ++c) {
-      ozz::math::Float4 position(
-        ((c % kWidth) - kWidth / 2) * kInterval,
-        ((c / kWidth) / kDepth) * kInterval,
-        (((c / kWidth) % kDepth) - kDepth / 2) * kInterval,
-        1.f);
-      ;
-      const ozz::math::Float4x4 transform =
-        ozz::math::Float4x4::Translation(
-          ozz::math::simd_float4::LoadPtrU(&position.x));
-      success &=
-        _renderer->DrawPosture(
-        skeleton_, characters_[c].models, transform, false);
+    for (int c = 0; c < num_characters_; ++c) {
+      postures_[c] = characters_[c].models;
     }
-
-    return true;
+    return _renderer->DrawPostures(
+      skeleton_,
+      ozz::Range<const ozz::Range<const ozz::math::Float4x4> >(
+        postures_.begin, num_characters_),
+      ozz::Range<const ozz::math::Float4x4>(
+        transforms_.begin, num_characters_),
+      false);
   }
 
   virtual bool OnInitialize() {
@@ -183,10 +200,14 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     // Allocate a default number of characters.
     AllocateCharaters();
 
+    pool_ = ozz::memory::default_allocator()->
+      New<ozz::tasks::ThreadPool>(num_threads_);
+
     return true;
   }
 
   virtual void OnDestroy() {
+      ozz::memory::default_allocator()->Delete(pool_);
       DeallocateCharaters();
   }
 
@@ -194,15 +215,14 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     // Exposes multi-threading parameters.
     {
       static bool oc_open = true;
-      ozz::sample::ImGui::OpenClose oc(_im_gui, "OpenMP control", &oc_open);
+      ozz::sample::ImGui::OpenClose oc(_im_gui, "Threads control", &oc_open);
       if (oc_open) {
-        _im_gui->DoCheckBox("Enables OpenMP", &enable_openmp_);
+        _im_gui->DoCheckBox("Enables multi-threading", &enable_threads_);
         char label[64];
-        std::sprintf(label, "Number of processors: %d",
-                     openmp_statistics.num_procs);
+        std::sprintf(label, "Number of processors: %d", num_procs_);
         _im_gui->DoLabel(label);
 
-        const int max = ozz::math::Max(2, openmp_statistics.max_threads + 2);
+        const int max = ozz::math::Max(2, num_procs_ + 2);
         std::sprintf(label, "Number of threads: %d/%d", num_threads_, max);
         _im_gui->DoSlider(label, 1, max, &num_threads_);
       }
@@ -255,6 +275,22 @@ class MultithreadSampleApplication : public ozz::sample::Application {
         AllocateRange<ozz::math::Float4x4>(skeleton_.num_joints());
     }
 
+    // Allocates rendering postures and transforms. Transforms are constant,
+    // they only depend on character index.
+    postures_ = allocator->
+      AllocateRange<ozz::Range<const ozz::math::Float4x4> >(kMaxCharacters);
+    transforms_ =
+      allocator->AllocateRange<ozz::math::Float4x4>(kMaxCharacters);
+    for (int c = 0; c < kMaxCharacters; ++c) {
+      ozz::math::Float4 position(
+        ((c % kWidth) - kWidth / 2) * kInterval,
+        ((c / kWidth) / kDepth) * kInterval,
+        (((c / kWidth) % kDepth) - kDepth / 2) * kInterval,
+        1.f);
+      transforms_[c] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::LoadPtrU(&position.x));
+    }
+
     return true;
   }
 
@@ -266,6 +302,8 @@ class MultithreadSampleApplication : public ozz::sample::Application {
       allocator->Deallocate(character.locals);
       allocator->Deallocate(character.models);
     }
+    allocator->Deallocate(postures_);
+    allocator->Deallocate(transforms_);
   }
 
   // Runtime skeleton.
@@ -307,20 +345,26 @@ class MultithreadSampleApplication : public ozz::sample::Application {
   // Number of used characters.
   int num_characters_;
 
-  // Enables/disables OpenMP.
-  bool enable_openmp_;
+  // Per character model space matrices and world transforms, as expected by
+  // the renderer.
+  ozz::Range<ozz::Range<const ozz::math::Float4x4> > postures_;
+  ozz::Range<ozz::math::Float4x4> transforms_;
+
+  // Enables/disables multi-threading.
+  bool enable_threads_;
 
   // The number of threads as selected from the UI.
   int num_threads_;
 
-  struct {
-    int num_procs;
-    int num_threads;
-    int max_threads;
-  } openmp_statistics;
+  // The number of hardware threads.
+  int num_procs_;
+
+  // The pool of threads characters' update is dispatched to.
+  ozz::tasks::ThreadPool* pool_;
 };
 
 int main(int _argc, const char** _argv) {
-  const char* title = "Ozz-animation sample: Multi-threading with OpenMp";
+  const char* title =
+    "Ozz-animation sample: Multi-threading with a thread pool";
   return MultithreadSampleApplication().Run(_argc, _argv, "1.0", title);
 }
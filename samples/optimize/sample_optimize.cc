@@ -262,11 +262,6 @@ class OptimizeSampleApplication : public ozz::sample::Application {
           ozz::memory::default_allocator()->Delete(animation_opt_);
           animation_opt_ = NULL;
 
-          // Invalidates the cache in case the new animation has the same
-          // address as the previous one. Other cases are automatic handled by
-          // the cache. See SamplingCache::Invalidate for more details.
-          cache_->Invalidate();
-
           // Rebuilds a new runtime animation.
           if (!BuildAnimations()) {
             return false;
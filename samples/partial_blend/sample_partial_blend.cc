@@ -100,6 +100,9 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
       sampling_job.time = sampler.controller.time();
       sampling_job.output = sampler.locals;
 
+      // Only samples the joints that are blended, according to their weights.
+      sampling_job.soa_mask = sampler.soa_mask;
+
       // Samples animation.
       if (!sampling_job.Run()) {
         return false;
@@ -119,6 +122,11 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
 
       // Set per-joint weights for the partially blended layer.
       layers[i].joint_weights = samplers_[i].joint_weights;
+
+      // Only blends the soa joints that have a weight.
+      layers[i].soa_ranges.begin = samplers_[i].soa_ranges.begin;
+      layers[i].soa_ranges.end =
+        samplers_[i].soa_ranges.begin + samplers_[i].num_soa_ranges;
     }
 
     // Setups blending job.
@@ -187,6 +195,16 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
       sampler.joint_weights =
         allocator->AllocateRange<ozz::math::SimdFloat4>(num_soa_joints);
 
+      // Allocates the mask of the soa joints to sample, one bit per soa joint.
+      sampler.soa_mask =
+        allocator->AllocateRange<unsigned char>((num_soa_joints + 7) / 8);
+
+      // Allocates soa joint ranges to blend, built from the same weights. There
+      // can't be more ranges than half the soa joints, rounded up.
+      sampler.soa_ranges =
+        allocator->AllocateRange<ozz::animation::BlendingJob::SoaRange>(
+          (num_soa_joints + 1) / 2);
+
       // Allocates a cache that matches animation requirements.
       sampler.cache = allocator->New<ozz::animation::SamplingCache>(num_joints);
     }
@@ -256,6 +274,32 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
           weight_setting, joint_id %4, upper_body_sampler.joint_weight_setting);
       }
     }
+
+    // Builds sampling masks and blending soa ranges from per-joint weights.
+    // Soa joints whose weights are all 0 don't need to be sampled nor
+    // blended.
+    const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+    for (int i = 0; i < kNumLayers; ++i) {
+      Sampler& sampler = samplers_[i];
+      std::memset(sampler.soa_mask.begin, 0, sampler.soa_mask.Size());
+      sampler.num_soa_ranges = 0;
+      for (int j = 0; j < skeleton_.num_soa_joints(); ++j) {
+        if (ozz::math::AreAllFalse(
+              ozz::math::CmpGt(sampler.joint_weights[j], zero))) {
+          continue;
+        }
+        sampler.soa_mask[j / 8] |= 1 << (j & 7);
+
+        // Extends the last range if it ends with the previous soa joint.
+        const int last = sampler.num_soa_ranges - 1;
+        if (last >= 0 && sampler.soa_ranges[last].end == j) {
+          sampler.soa_ranges[last].end = j + 1;
+        } else {
+          const ozz::animation::BlendingJob::SoaRange range = {j, j + 1};
+          sampler.soa_ranges[sampler.num_soa_ranges++] = range;
+        }
+      }
+    }
   }
 
   virtual void OnDestroy() {
@@ -264,6 +308,8 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
       Sampler& sampler = samplers_[i];
       allocator->Deallocate(sampler.locals);
       allocator->Deallocate(sampler.joint_weights);
+      allocator->Deallocate(sampler.soa_mask);
+      allocator->Deallocate(sampler.soa_ranges);
       allocator->Delete(sampler.cache);
     }
     allocator->Deallocate(blended_locals_);
@@ -384,7 +430,8 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
     Sampler()
      : weight_setting(1.f),
        joint_weight_setting(1.f),
-       cache(NULL) {
+       cache(NULL),
+       num_soa_ranges(0) {
     }
 
     // Playback animation controller. This is a utility class that helps with
@@ -411,6 +458,15 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
     // select which joints are considered during blending, and their individual
     // weight_setting.
     ozz::Range<ozz::math::SimdFloat4> joint_weights;
+
+    // Mask of the soa joints to sample, built from joint_weights.
+    ozz::Range<unsigned char> soa_mask;
+
+    // Ranges of the soa joints to blend, built from joint_weights.
+    ozz::Range<ozz::animation::BlendingJob::SoaRange> soa_ranges;
+
+    // The number of used soa_ranges.
+    int num_soa_ranges;
   } samplers_[kNumLayers];  // kNumLayers animations to blend.
 
   // Index of the joint at the base of the upper body hierarchy.
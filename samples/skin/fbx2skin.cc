@@ -46,6 +46,9 @@
 #include "ozz/base/containers/map.h"
 #include "ozz/base/containers/vector.h"
 
+#include "ozz/geometry/offline/influence_partition_builder.h"
+#include "ozz/geometry/offline/vertex_order_builder.h"
+
 #include "ozz/options/options.h"
 
 #include <algorithm>
@@ -55,6 +58,15 @@
 OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file.", "", true)
 OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies the skeleton that the skin is bound to.", "", true)
 OZZ_OPTIONS_DECLARE_STRING(skin, "Specifies ozz skin ouput file.", "", true)
+OZZ_OPTIONS_DECLARE_FLOAT(
+  weight_epsilon,
+  "Prunes joint influences whose weight is less or equal to this value",
+  ozz::geometry::offline::InfluencePartitionBuilder().weight_epsilon, false)
+OZZ_OPTIONS_DECLARE_BOOL(
+  optimize,
+  "Reorders triangles and vertices for post-transform cache and skinning "
+  "memory access efficiency",
+  true, false)
 
 namespace {
 
@@ -384,116 +396,117 @@ bool BuildSkin(FbxMesh* _fbx_mesh,
   return !vertex_isnt_influenced;
 }
 
+bool OptimizeVertexOrder(ozz::sample::SkinnedMesh* _mesh) {
+  assert(_mesh->parts.size() == 1);
+
+  ozz::sample::SkinnedMesh::Part& part = _mesh->parts.front();
+  const int vertex_count = part.vertex_count();
+  const int max_influences = part.influences_count();
+
+  // Extracts the dominant joint of every vertex, which is the first one as
+  // influences are sorted by decreasing weight.
+  ozz::Vector<uint16_t>::Std dominant_joints;
+  if (max_influences > 0) {
+    dominant_joints.resize(vertex_count);
+    for (int i = 0; i < vertex_count; ++i) {
+      dominant_joints[i] = part.joint_indices[i * max_influences];
+    }
+  }
+
+  ozz::geometry::offline::VertexOrderBuilder builder;
+  ozz::geometry::offline::VertexOrder order;
+  if (!builder(vertex_count,
+               ozz::Range<const uint16_t>(
+                 ozz::array_begin(_mesh->triangle_indices),
+                 ozz::array_end(_mesh->triangle_indices)),
+               ozz::Range<const uint16_t>(ozz::array_begin(dominant_joints),
+                                          ozz::array_end(dominant_joints)),
+               &order)) {
+    return false;
+  }
+
+  // Reorders vertex attributes.
+  ozz::sample::SkinnedMesh::Part sorted;
+  sorted.positions.resize(vertex_count);
+  sorted.normals.resize(vertex_count);
+  sorted.joint_indices.resize(part.joint_indices.size());
+  sorted.joint_weights.resize(part.joint_weights.size());
+  for (int i = 0; i < vertex_count; ++i) {
+    const int source = order.vertex_remap[i];
+    sorted.positions[i] = part.positions[source];
+    sorted.normals[i] = part.normals[source];
+    for (int j = 0; j < max_influences; ++j) {
+      sorted.joint_indices[i * max_influences + j] =
+        part.joint_indices[source * max_influences + j];
+      sorted.joint_weights[i * max_influences + j] =
+        part.joint_weights[source * max_influences + j];
+    }
+  }
+  part = sorted;
+  _mesh->triangle_indices = order.triangle_indices;
+
+  return true;
+}
+
 bool SplitParts(const ozz::sample::SkinnedMesh& _output_mesh,
                 ozz::sample::SkinnedMesh* _partitionned_mesh) {
   assert(_output_mesh.parts.size() == 1);
   assert(_partitionned_mesh->parts.size() == 0);
 
   const ozz::sample::SkinnedMesh::Part& in_part = _output_mesh.parts.front();
-  const size_t vertex_count = in_part.vertex_count();
-
-  // Creates one mesh part per influence.
+  const int vertex_count = in_part.vertex_count();
   const int max_influences = in_part.influences_count();
   assert(max_influences > 0);
 
-  // Bucket-sort vertices per influence count.
-  typedef ozz::Vector<ozz::Vector<size_t>::Std>::Std BuckedVertices;
-  BuckedVertices bucked_vertices;
-  bucked_vertices.resize(max_influences);
-  if (max_influences > 1) {
-    for (size_t i = 0; i < vertex_count; ++i) {
-      const float* weights = &in_part.joint_weights[i * max_influences];
-      int j = 0;
-      for (; j < max_influences && weights[j] > 0.f; ++j) {
-      }
-      const int influences = j - 1;
-      bucked_vertices[influences].push_back(i);
-    }
-  } else {
-    for (size_t i = 0; i < vertex_count; ++i) {
-      bucked_vertices[0].push_back(i);
+  // Strips the last weight of every vertex, as expected by the partition
+  // builder (and skinning job) layout.
+  ozz::Vector<float>::Std weights;
+  weights.reserve(vertex_count * (max_influences - 1));
+  for (int i = 0; i < vertex_count; ++i) {
+    for (int j = 0; j < max_influences - 1; ++j) {
+      weights.push_back(in_part.joint_weights[i * max_influences + j]);
     }
   }
 
-  // Group vertices if there's not enough of them for a given part. This allows to
-  // limit SkinningJob fix cost overhead.
-  const size_t kMinBucketSize = 16;
-
-  for (size_t i = 0; i < bucked_vertices.size() - 1; ++i) {
-    BuckedVertices::reference bucket = bucked_vertices[i];
-    if (bucket.size() < kMinBucketSize) {
-      // Transfers vertices to next bucket if there aren't enough.
-      BuckedVertices::reference next_bucket = bucked_vertices[i + 1];
-      next_bucket.reserve(next_bucket.size() + bucket.size());
-      for (size_t j = 0; j < bucket.size(); ++j) {
-        next_bucket.push_back(bucket[j]);
-      }
-      bucket.clear();
-    }
+  // Partitions vertices by their exact number of influences. Small partitions
+  // are merged with the next ones, to limit SkinningJob fix cost overhead.
+  ozz::geometry::offline::InfluencePartitionBuilder builder;
+  builder.weight_epsilon = OPTIONS_weight_epsilon;
+  ozz::geometry::offline::InfluencePartitions partitions;
+  if (!builder(vertex_count, max_influences,
+               ozz::Range<const uint16_t>(
+                 ozz::array_begin(in_part.joint_indices),
+                 ozz::array_end(in_part.joint_indices)),
+               ozz::Range<const float>(ozz::array_begin(weights),
+                                       ozz::array_end(weights)),
+               &partitions)) {
+    return false;
   }
 
   // Fills mesh parts.
-  _partitionned_mesh->parts.reserve(max_influences);
-  for (int i = 0; i < max_influences; ++i) {
-
-    const ozz::Vector<size_t>::Std& bucket = bucked_vertices[i];
-    const size_t bucket_vertex_count = bucket.size();
-    if (bucket_vertex_count == 0) {
-      // No Mesh part if no vertices.
-      continue;
-    }
-
-    // Adds a new part.
-    _partitionned_mesh->parts.resize(_partitionned_mesh->parts.size() + 1);
-    ozz::sample::SkinnedMesh::Part& out_part = _partitionned_mesh->parts.back();
-
-    // Resize output part.
-    const int influences = i + 1;
-    out_part.positions.resize(bucket_vertex_count);
-    out_part.normals.resize(bucket_vertex_count);
-    out_part.joint_indices.resize(bucket_vertex_count * influences);
-    out_part.joint_weights.resize(bucket_vertex_count * influences);
-
-    // Fills output of this part.
-    for (size_t j = 0; j < bucket_vertex_count; ++j) {
-      // Fills positions.
-      const size_t bucket_vertex_index = bucket[j];
-      out_part.positions[j] = in_part.positions[bucket_vertex_index];
-      // Fills normals.
-      out_part.normals[j] = in_part.normals[bucket_vertex_index];
-      // Fills joints indices.
-      const uint16_t* in_indices =
-        &in_part.joint_indices[bucket_vertex_index * max_influences];
-      uint16_t* out_indices =
-        &out_part.joint_indices[j * influences];
-      for (int k = 0; k < influences; ++k) {
-        out_indices[k] = in_indices[k];
-      }
-      // Fills weights. Note that there's no weight if there's only one joint
-      // influencing a vertex.
-      if (influences > 1) {
-        const float* in_weights =
-          &in_part.joint_weights[bucket_vertex_index * max_influences];
-        float* out_weights =
-          &out_part.joint_weights[j * influences];
-        for (int k = 0; k < influences; ++k) {
-          out_weights[k] = in_weights[k];
-        }
-      }
+  _partitionned_mesh->parts.resize(partitions.partitions.size());
+  size_t processed_vertices = 0;
+  for (size_t i = 0; i < partitions.partitions.size(); ++i) {
+    const ozz::geometry::offline::InfluencePartitions::Partition& partition =
+      partitions.partitions[i];
+    ozz::sample::SkinnedMesh::Part& out_part = _partitionned_mesh->parts[i];
+    out_part.positions.resize(partition.vertex_count);
+    out_part.normals.resize(partition.vertex_count);
+    for (int j = 0; j < partition.vertex_count; ++j) {
+      const int source = partitions.vertex_remap[processed_vertices + j];
+      out_part.positions[j] = in_part.positions[source];
+      out_part.normals[j] = in_part.normals[source];
     }
+    out_part.joint_indices = partition.joint_indices;
+    out_part.joint_weights = partition.joint_weights;
+    processed_vertices += partition.vertex_count;
   }
 
   // Builds a vertex remapping table to help rebuild triangle indices.
   ozz::Vector<uint16_t>::Std vertices_remap;
   vertices_remap.resize(vertex_count);
-  uint16_t processed_vertices = 0;
-  for (size_t i = 0; i < bucked_vertices.size(); ++i) {
-    const ozz::Vector<size_t>::Std& bucket = bucked_vertices[i];
-    const uint16_t bucket_vertex_count = static_cast<uint16_t>(bucket.size());
-    for (uint16_t j = 0; j < bucket_vertex_count; ++j) {
-      vertices_remap[bucket[j]] = j + processed_vertices;
-    }
-    processed_vertices += bucket_vertex_count;
+  for (int i = 0; i < vertex_count; ++i) {
+    vertices_remap[partitions.vertex_remap[i]] = static_cast<uint16_t>(i);
   }
 
   // Remaps triangle indices, using vertex mapping table.
@@ -510,31 +523,6 @@ bool SplitParts(const ozz::sample::SkinnedMesh& _output_mesh,
   return true;
 }
 
-bool StripWeights(ozz::sample::SkinnedMesh* _mesh) {
-  for (size_t i = 0; i < _mesh->parts.size(); ++i) {
-    ozz::sample::SkinnedMesh::Part& part = _mesh->parts[i];
-    const int influence_count = part.influences_count();
-    const int vertex_count = part.vertex_count();
-    if (influence_count <= 1) {
-      part.joint_weights.clear();
-    } else {
-      const ozz::Vector<float>::Std copy = part.joint_weights;
-      part.joint_weights.clear();
-      part.joint_weights.reserve(vertex_count * (influence_count - 1));
-
-      for (int j = 0; j < vertex_count; ++j) {
-        for (int k = 0; k < influence_count - 1; ++k) {
-          part.joint_weights.push_back(copy[j * influence_count + k]);
-        }
-      }
-    }
-    assert(static_cast<int>(part.joint_weights.size()) ==
-           vertex_count * (influence_count - 1));
-  }
-
-  return true;
-}
-
 int main(int _argc, const char** _argv) {
   // Parses arguments.
   ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
@@ -619,6 +607,14 @@ int main(int _argc, const char** _argv) {
       return EXIT_FAILURE;
     }
 
+    if (OPTIONS_optimize) {
+      ozz::log::LogV() << "Optimizing vertex order." << std::endl;
+      if (!OptimizeVertexOrder(&output_mesh)) {
+        ozz::log::Err() << "Failed to optimize vertex order." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
     ozz::log::LogV() << "Partitioning meshes." << std::endl;
     ozz::sample::SkinnedMesh partitioned_meshes;
     if (!SplitParts(output_mesh, &partitioned_meshes)) {
@@ -626,12 +622,6 @@ int main(int _argc, const char** _argv) {
       return EXIT_FAILURE;
     }
 
-    ozz::log::LogV() << "Stripping skinning weights." << std::endl;
-    if (!StripWeights(&partitioned_meshes)) {
-      ozz::log::Err() << "Failed to strip weights." << std::endl;
-      return EXIT_FAILURE;
-    }
-
     // Copy partitioned mesh back to the output mesh.
     output_mesh = partitioned_meshes;
   }
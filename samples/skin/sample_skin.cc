@@ -34,6 +34,7 @@
 #include "ozz/animation/runtime/local_to_model_job.h"
 
 #include "ozz/geometry/runtime/skinning_job.h"
+#include "ozz/geometry/runtime/skinning_matrices_job.h"
 
 #include "ozz/base/log.h"
 #include "ozz/base/io/stream.h"
@@ -53,6 +54,7 @@
 #include "framework/application.h"
 #include "framework/renderer.h"
 #include "framework/imgui.h"
+#include "framework/profile.h"
 #include "framework/utils.h"
 
 #include "skin_mesh.h"
@@ -83,7 +85,14 @@ class SkinSampleApplication : public ozz::sample::Application {
   SkinSampleApplication()
     : show_influences_count_(false),
       limit_influences_count_(0),
-      cache_(NULL) {
+      gpu_skinning_(false),
+      gpu_skinning_supported_(true),
+      cpu_time_(NULL),
+      gpu_time_(NULL),
+      cache_(NULL),
+      gpu_mesh_(NULL),
+      gpu_mesh_influences_count_(0),
+      gpu_mesh_show_influences_count_(false) {
   }
 
  protected:
@@ -114,15 +123,39 @@ class SkinSampleApplication : public ozz::sample::Application {
     return true;
   }
 
-  // Build skinning matrices, transform mesh vertices using the SkinningJob and
-  // renders.
+  // Build skinning matrices, then skins and renders the mesh either on the
+  // cpu or the gpu.
   virtual bool OnDisplay(ozz::sample::Renderer* _renderer) {
 
     // Builds skinning matrices, based on the output of the animation stage.
-    for (int i = 0; i < skeleton_.num_joints(); ++i) {
-      skinning_matrices_[i] = models_[i] * mesh_.inverse_bind_poses[i];
+    ozz::geometry::SkinningMatricesJob matrices_job;
+    matrices_job.model_matrices = models_;
+    matrices_job.inverse_bind_poses.begin =
+      array_begin(mesh_.inverse_bind_poses);
+    matrices_job.inverse_bind_poses.end = array_end(mesh_.inverse_bind_poses);
+    matrices_job.skinning_matrices = skinning_matrices_;
+    if (!matrices_job.Run()) {
+      return false;
+    }
+
+    // Gpu skinning is only possible if the whole palette fits in the
+    // renderer's limits.
+    gpu_skinning_supported_ = _renderer->max_skinning_matrices() >=
+      static_cast<int>(skinning_matrices_.Count());
+
+    // Skinning and rendering cost is profiled for each mode, so they can be
+    // compared.
+    if (gpu_skinning_ && gpu_skinning_supported_) {
+      ozz::sample::Profiler profile(gpu_time_);
+      return DrawGpuSkinned(_renderer);
+    } else {
+      ozz::sample::Profiler profile(cpu_time_);
+      return DrawCpuSkinned(_renderer);
     }
+  }
 
+  // Transforms mesh vertices using the SkinningJob and renders.
+  bool DrawCpuSkinned(ozz::sample::Renderer* _renderer) {
     // Prepares rendering mesh, which allocates the buffers that are filled as
     // output of the skinning job. 
     const int vertex_count = mesh_.vertex_count();
@@ -202,8 +235,11 @@ class SkinSampleApplication : public ozz::sample::Application {
       skinning_job.out_normals_stride = nbuffer.stride;
 
       // Execute the job, which should succeed unless a parameter is invalid.
-      if (!skinning_job.Run()) {
-        return false;
+      {
+        ozz::sample::TraceScope trace("skinning");
+        if (!skinning_job.Run()) {
+          return false;
+        }
       }
 
       // Also fills colors for this part.
@@ -244,6 +280,114 @@ class SkinSampleApplication : public ozz::sample::Application {
     return true;
   }
 
+  // Renders the mesh, skinned by the gpu. The gpu mesh is only rebuilt when
+  // skinning options change, as its vertices are static.
+  bool DrawGpuSkinned(ozz::sample::Renderer* _renderer) {
+    if (!gpu_mesh_ ||
+        gpu_mesh_influences_count_ != limit_influences_count_ ||
+        gpu_mesh_show_influences_count_ != show_influences_count_) {
+      BuildGpuMesh();
+    }
+
+    return _renderer->DrawSkinnedMesh(ozz::math::Float4x4::identity(),
+                                      *gpu_mesh_,
+                                      skinning_matrices_);
+  }
+
+  // Fills gpu mesh from all mesh parts, according to the current skinning
+  // options. Vertices influenced by more than
+  // Renderer::SkinnedMesh::kMaxInfluences joints are clamped, the same way
+  // SkinningJob does when limiting influences.
+  void BuildGpuMesh() {
+    typedef ozz::sample::Renderer::SkinnedMesh GpuMesh;
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    allocator->Delete(gpu_mesh_);
+
+    const int vertex_count = mesh_.vertex_count();
+    const int index_count = mesh_.triangle_index_count();
+    const int max_influences_count = mesh_.max_influences_count();
+    gpu_mesh_ = allocator->New<GpuMesh>(vertex_count, index_count);
+    gpu_mesh_influences_count_ = limit_influences_count_;
+    gpu_mesh_show_influences_count_ = show_influences_count_;
+
+    const GpuMesh::Positions pbuffer = gpu_mesh_->positions();
+    const GpuMesh::Normals nbuffer = gpu_mesh_->normals();
+    const GpuMesh::Colors cbuffer = gpu_mesh_->colors();
+    const GpuMesh::JointIndices ibuffer = gpu_mesh_->joint_indices();
+    const GpuMesh::JointWeights wbuffer = gpu_mesh_->joint_weights();
+    float* positions = pbuffer.data.begin;
+    float* normals = nbuffer.data.begin;
+    ozz::sample::Renderer::Mesh::Color* colors = cbuffer.data.begin;
+    uint16_t* indices = ibuffer.data.begin;
+    float* weights = wbuffer.data.begin;
+
+    for (size_t i = 0; i < mesh_.parts.size(); ++i) {
+      const ozz::sample::SkinnedMesh::Part& part = mesh_.parts[i];
+      const int part_vertex_count = part.vertex_count();
+      const int part_influences_count = part.influences_count();
+
+      // Clamps joints influence count according to the option and gpu limits.
+      const int influences_count = ozz::math::Min(
+        ozz::math::Min(limit_influences_count_, part_influences_count),
+        static_cast<int>(GpuMesh::kMaxInfluences));
+
+      ozz::sample::Renderer::Mesh::Color color = {255, 255, 255, 255};
+      if (show_influences_count_) {
+        color.red = static_cast<uint8_t>(
+          influences_count * 255 / max_influences_count);
+        color.green = 255 - color.red;
+        color.blue = 0;
+      }
+
+      for (int j = 0; j < part_vertex_count; ++j) {
+        const ozz::math::Float3& position = part.positions[j];
+        positions[0] = position.x;
+        positions[1] = position.y;
+        positions[2] = position.z;
+        const ozz::math::Float3& normal = part.normals[j];
+        normals[0] = normal.x;
+        normals[1] = normal.y;
+        normals[2] = normal.z;
+        *colors = color;
+
+        // Last weight is deduced from the previous ones, so that they sum
+        // to one.
+        const uint16_t* part_indices =
+          &part.joint_indices[j * part_influences_count];
+        const float* part_weights = part_influences_count > 1 ?
+          &part.joint_weights[j * (part_influences_count - 1)] : NULL;
+        float weight_sum = 0.f;
+        for (int k = 0; k < GpuMesh::kMaxInfluences; ++k) {
+          if (k < influences_count - 1) {
+            indices[k] = part_indices[k];
+            weights[k] = part_weights[k];
+            weight_sum += part_weights[k];
+          } else if (k == influences_count - 1) {
+            indices[k] = part_indices[k];
+            weights[k] = 1.f - weight_sum;
+          } else {
+            indices[k] = 0;
+            weights[k] = 0.f;
+          }
+        }
+
+        positions = ozz::PointerStride(positions, pbuffer.stride);
+        normals = ozz::PointerStride(normals, nbuffer.stride);
+        colors = ozz::PointerStride(colors, cbuffer.stride);
+        indices = ozz::PointerStride(indices, ibuffer.stride);
+        weights = ozz::PointerStride(weights, wbuffer.stride);
+      }
+    }
+
+    // Triangle indices.
+    const GpuMesh::Indices buffer = gpu_mesh_->indices();
+    uint16_t* triangle_indices = buffer.data.begin;
+    for (int i = 0; i < index_count; ++i) {
+      *triangle_indices = mesh_.triangle_indices[i];
+      triangle_indices = ozz::PointerStride(triangle_indices, buffer.stride);
+    }
+  }
+
   virtual bool OnInitialize() {
     ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
 
@@ -267,6 +411,10 @@ class SkinSampleApplication : public ozz::sample::Application {
     // Allocates a cache that matches animation requirements.
     cache_ = allocator->New<ozz::animation::SamplingCache>(num_joints);
 
+    // Allocates skinning profiling records.
+    cpu_time_ = allocator->New<ozz::sample::Record>(128);
+    gpu_time_ = allocator->New<ozz::sample::Record>(128);
+
     // Reading mesh.
     if (!LoadSkinMesh()) {
       return false;
@@ -291,6 +439,9 @@ class SkinSampleApplication : public ozz::sample::Application {
     allocator->Deallocate(models_);
     allocator->Deallocate(skinning_matrices_);
     allocator->Delete(cache_);
+    allocator->Delete(cpu_time_);
+    allocator->Delete(gpu_time_);
+    allocator->Delete(gpu_mesh_);
   }
 
   bool LoadSkinMesh() {
@@ -335,6 +486,37 @@ class SkinSampleApplication : public ozz::sample::Application {
                           1, mesh_.max_influences_count(),
                           &limit_influences_count_);
         _im_gui->DoCheckBox("Show influences", &show_influences_count_);
+
+        // Gpu skinning is disabled if the renderer doesn't support it.
+        _im_gui->DoCheckBox("GPU skinning",
+                            &gpu_skinning_,
+                            gpu_skinning_supported_);
+      }
+    }
+
+    { // Display skinning timings, including rendering submission. Gpu
+      // execution time isn't included, it's only reflected by the frame rate.
+      static bool open = true;
+      ozz::sample::ImGui::OpenClose oc(_im_gui, "Skinning timings", &open);
+      if (open) {
+        char label[64];
+        const ozz::sample::Record::Statistics cpu_stats =
+          cpu_time_->GetStatistics();
+        sprintf(label, "CPU skinning: %.2f ms", cpu_stats.mean);
+        _im_gui->DoLabel(label);
+        const ozz::sample::Record::Statistics gpu_stats =
+          gpu_time_->GetStatistics();
+        sprintf(label, "GPU skinning: %.2f ms", gpu_stats.mean);
+        _im_gui->DoLabel(label);
+
+        // Graph displays current mode timings.
+        const bool gpu = gpu_skinning_ && gpu_skinning_supported_;
+        ozz::sample::Record* record = gpu ? gpu_time_ : cpu_time_;
+        const ozz::sample::Record::Statistics& statistics =
+          gpu ? gpu_stats : cpu_stats;
+        _im_gui->DoGraph(
+          NULL, 0.f, statistics.max, statistics.latest,
+          record->cursor(), record->record_begin(), record->record_end());
       }
     }
 
@@ -354,6 +536,17 @@ class SkinSampleApplication : public ozz::sample::Application {
   // Option that limits the number of influences.
   int limit_influences_count_;
 
+  // Option that selects gpu skinning instead of cpu SkinningJob.
+  bool gpu_skinning_;
+
+  // Gpu skinning can be unsupported if the renderer can't handle the
+  // skeleton's palette.
+  bool gpu_skinning_supported_;
+
+  // Cpu and gpu skinning paths timings.
+  ozz::sample::Record* cpu_time_;
+  ozz::sample::Record* gpu_time_;
+
   // Playback animation controller. This is a utility class that helps with
   // controlling animation playback time.
   ozz::sample::PlaybackController controller_;
@@ -379,6 +572,12 @@ class SkinSampleApplication : public ozz::sample::Application {
   // The input mesh containing skinning information (joint indices, weights...).
   // This mesh is loaded from a file.
   ozz::sample::SkinnedMesh mesh_;
+
+  // The mesh used for gpu skinning, built from mesh_ parts. It's rebuilt
+  // whenever skinning options it was built with change.
+  ozz::sample::Renderer::SkinnedMesh* gpu_mesh_;
+  int gpu_mesh_influences_count_;
+  bool gpu_mesh_show_influences_count_;
 };
 
 int main(int _argc, const char** _argv) {
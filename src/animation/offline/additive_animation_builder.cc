@@ -0,0 +1,196 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/additive_animation_builder.h"
+
+#include <cassert>
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Returns true if no component of _scale is 0, so it can be inverted.
+bool IsInvertible(const math::Float3& _scale) {
+  return _scale.x != 0.f && _scale.y != 0.f && _scale.z != 0.f;
+}
+
+// Builds _output track as the delta from _reference to _input track, for
+// _interpolation mode.
+void MakeDelta(const RawAnimation::JointTrack& _input,
+               const math::Transform& _reference,
+               RawAnimation::Interpolation _interpolation,
+               RawAnimation::JointTrack* _output) {
+  const bool hermite = _interpolation == RawAnimation::kHermite;
+  const math::Quaternion inv_rotation = Conjugate(_reference.rotation);
+  const math::Float3 inv_scale = math::Float3::one() / _reference.scale;
+
+  // Translations, whose tangents aren't affected by the subtraction.
+  _output->translations = _input.translations;
+  for (size_t i = 0; i < _output->translations.size(); ++i) {
+    _output->translations[i].value =
+      _output->translations[i].value - _reference.translation;
+  }
+  if (hermite) {
+    _output->translation_tangents = _input.translation_tangents;
+  }
+
+  // Rotations, delta is computed such that reference * delta = rotation.
+  _output->rotations = _input.rotations;
+  for (size_t i = 0; i < _output->rotations.size(); ++i) {
+    _output->rotations[i].value = inv_rotation * _output->rotations[i].value;
+  }
+  if (hermite) {
+    // Quaternion product is linear, so tangents are premultiplied as well.
+    _output->rotation_tangents = _input.rotation_tangents;
+    for (size_t i = 0; i < _output->rotation_tangents.size(); ++i) {
+      math::Float4& tangent = _output->rotation_tangents[i];
+      const math::Quaternion delta =
+        inv_rotation *
+        math::Quaternion(tangent.x, tangent.y, tangent.z, tangent.w);
+      tangent = math::Float4(delta.x, delta.y, delta.z, delta.w);
+    }
+  }
+
+  // Scales, and their tangents, are divided by reference scale.
+  _output->scales = _input.scales;
+  for (size_t i = 0; i < _output->scales.size(); ++i) {
+    _output->scales[i].value = _output->scales[i].value * inv_scale;
+  }
+  if (hermite) {
+    _output->scale_tangents = _input.scale_tangents;
+    for (size_t i = 0; i < _output->scale_tangents.size(); ++i) {
+      _output->scale_tangents[i] = _output->scale_tangents[i] * inv_scale;
+    }
+  }
+
+  // Empty streams are identity, which needs a key if the reference isn't.
+  if (_input.translations.empty() &&
+      _reference.translation != RawAnimation::TranslationKey::identity()) {
+    const RawAnimation::TranslationKey key = {0.f, -_reference.translation};
+    _output->translations.push_back(key);
+    if (hermite) {
+      _output->translation_tangents.push_back(math::Float3::zero());
+    }
+  }
+  if (_input.rotations.empty() &&
+      _reference.rotation != RawAnimation::RotationKey::identity()) {
+    const RawAnimation::RotationKey key = {0.f, inv_rotation};
+    _output->rotations.push_back(key);
+    if (hermite) {
+      _output->rotation_tangents.push_back(math::Float4::zero());
+    }
+  }
+  if (_input.scales.empty() &&
+      _reference.scale != RawAnimation::ScaleKey::identity()) {
+    const RawAnimation::ScaleKey key = {0.f, inv_scale};
+    _output->scales.push_back(key);
+    if (hermite) {
+      _output->scale_tangents.push_back(math::Float3::zero());
+    }
+  }
+}
+}  // namespace
+
+bool AdditiveAnimationBuilder::operator()(const RawAnimation& _input,
+                                          RawAnimation* _output) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  // The reference pose is the first key of every track, or identity for
+  // empty tracks. _input is validated when building the additive animation.
+  const int num_tracks = _input.num_tracks();
+  ozz::Vector<math::Transform>::Std reference(num_tracks,
+                                              math::Transform::identity());
+  for (int i = 0; i < num_tracks; ++i) {
+    const RawAnimation::JointTrack& track = _input.tracks[i];
+    if (!track.translations.empty()) {
+      reference[i].translation = track.translations[0].value;
+    }
+    if (!track.rotations.empty()) {
+      reference[i].rotation = track.rotations[0].value;
+    }
+    if (!track.scales.empty()) {
+      reference[i].scale = track.scales[0].value;
+    }
+  }
+
+  const math::Transform* begin = num_tracks ? &reference[0] : NULL;
+  return (*this)(_input,
+                 Range<const math::Transform>(begin, begin + num_tracks),
+                 _output);
+}
+
+bool AdditiveAnimationBuilder::operator()(
+  const RawAnimation& _input,
+  const Range<const math::Transform>& _reference_pose,
+  RawAnimation* _output) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  if (!_output) {
+    return false;
+  }
+  // Reset output animation to default.
+  *_output = RawAnimation();
+
+  // Validates animation and reference pose.
+  const int num_tracks = _input.num_tracks();
+  if (!_input.Validate() ||
+      _reference_pose.end - _reference_pose.begin < num_tracks ||
+      (num_tracks && !_reference_pose.begin)) {
+    return false;
+  }
+  for (int i = 0; i < num_tracks; ++i) {
+    if (!IsInvertible(_reference_pose.begin[i].scale)) {
+      return false;
+    }
+  }
+
+  // Builds additive tracks.
+  _output->duration = _input.duration;
+  _output->interpolation = _input.interpolation;
+  _output->tracks.resize(num_tracks);
+  for (int i = 0; i < num_tracks; ++i) {
+    MakeDelta(_input.tracks[i], _reference_pose.begin[i],
+              _input.interpolation, &_output->tracks[i]);
+  }
+
+  // Output animation is always valid though.
+  assert(_output->Validate());
+  return true;
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,162 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_bank_builder.h"
+
+#include <cstring>
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/animation_bank.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+// Copies _src keys (or ranges, tangents, seek index, key links) to _dest, and
+// returns the range that was copied.
+template<typename _Key>
+ozz::Range<_Key> CopyKeys(const ozz::Range<_Key>& _src, _Key** _dest) {
+  const size_t count = _src.end - _src.begin;
+  if (count) {
+    std::memcpy(*_dest, _src.begin, count * sizeof(_Key));
+  }
+  ozz::Range<_Key> copy(*_dest, *_dest + count);
+  *_dest += count;
+  return copy;
+}
+}  // namespace
+
+AnimationBank* AnimationBankBuilder::operator()(
+  const ozz::Range<const Entry>& _entries) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+  if (!_entries.begin && _entries.end) {
+    return NULL;
+  }
+  const int num_animations = static_cast<int>(_entries.end - _entries.begin);
+
+  // Validates entries and computes bank sizes.
+  int num_translation_ranges = 0;
+  int num_translations = 0;
+  int num_rotations = 0;
+  int num_scales = 0;
+  int num_tangents = 0;
+  int seek_index_size = 0;
+  int num_key_links = 0;
+  int num_bounds = 0;
+  int names_size = 0;
+  for (int i = 0; i < num_animations; ++i) {
+    const Entry& entry = _entries.begin[i];
+    if (!entry.name || !entry.animation) {
+      return NULL;
+    }
+    for (int j = 0; j < i; ++j) {
+      if (std::strcmp(entry.name, _entries.begin[j].name) == 0) {
+        return NULL;  // Names must be unique.
+      }
+    }
+    const Animation& animation = *entry.animation;
+    num_translation_ranges += static_cast<int>(
+      animation.translation_ranges_.end - animation.translation_ranges_.begin);
+    num_translations += static_cast<int>(
+      animation.translations_.end - animation.translations_.begin);
+    num_rotations += static_cast<int>(
+      animation.rotations_.end - animation.rotations_.begin);
+    num_scales += static_cast<int>(
+      animation.scales_.end - animation.scales_.begin);
+    num_tangents += static_cast<int>(
+      animation.tangents_.end - animation.tangents_.begin);
+    seek_index_size += static_cast<int>(
+      animation.seek_index_.end - animation.seek_index_.begin);
+    num_key_links += static_cast<int>(
+      animation.key_links_.end - animation.key_links_.begin);
+    num_bounds += static_cast<int>(
+      animation.bounds_.end - animation.bounds_.begin);
+    names_size += static_cast<int>(std::strlen(entry.name)) + 1;
+  }
+
+  // Allocates the bank and all its content at once.
+  AnimationBank* bank = memory::default_allocator()->New<AnimationBank>();
+  bank->Allocate(num_animations, num_translation_ranges, num_translations,
+                 num_rotations, num_scales, num_tangents, seek_index_size,
+                 num_key_links, num_bounds, names_size);
+
+  // Copies names, translation ranges, key frames, tangents, seek index, key
+  // links and bounds.
+  char* name = bank->names_.begin;
+  SoaTranslationRange* translation_ranges = bank->translation_ranges_.begin;
+  TranslationKey* translations = bank->translations_.begin;
+  RotationKey* rotations = bank->rotations_.begin;
+  ScaleKey* scales = bank->scales_.begin;
+  KeyTangent* tangents = bank->tangents_.begin;
+  int32_t* seek_index = bank->seek_index_.begin;
+  uint16_t* key_links = bank->key_links_.begin;
+  math::Box* bounds = bank->bounds_.begin;
+  for (int i = 0; i < num_animations; ++i) {
+    const Entry& entry = _entries.begin[i];
+    const size_t name_size = std::strlen(entry.name) + 1;
+    std::memcpy(name, entry.name, name_size);
+    bank->name_offsets_.begin[i] =
+      static_cast<int32_t>(name - bank->names_.begin);
+    name += name_size;
+
+    const Animation& src = *entry.animation;
+    Animation& dest = bank->animations_.begin[i];
+    dest.duration_ = src.duration_;
+    dest.num_tracks_ = src.num_tracks_;
+    dest.num_constant_translations_ = src.num_constant_translations_;
+    dest.num_constant_rotations_ = src.num_constant_rotations_;
+    dest.num_constant_scales_ = src.num_constant_scales_;
+    dest.scaled_ = src.scaled_;
+    dest.uniformly_scaled_ = src.uniformly_scaled_;
+    dest.translation_ranges_ =
+      CopyKeys(src.translation_ranges_, &translation_ranges);
+    dest.translations_ = CopyKeys(src.translations_, &translations);
+    dest.rotations_ = CopyKeys(src.rotations_, &rotations);
+    dest.scales_ = CopyKeys(src.scales_, &scales);
+    dest.tangents_ = CopyKeys(src.tangents_, &tangents);
+    dest.seek_index_ = CopyKeys(src.seek_index_, &seek_index);
+    dest.key_links_ = CopyKeys(src.key_links_, &key_links);
+    dest.bounds_ = CopyKeys(src.bounds_, &bounds);
+  }
+
+  bank->BuildLookupTable();
+
+  return bank;
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,132 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_bounds_builder.h"
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/compute_bounds_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+AnimationBoundsBuilder::AnimationBoundsBuilder()
+    : sampling_rate(30.f),
+      margin(0.f) {
+}
+
+bool AnimationBoundsBuilder::operator()(const Animation& _animation,
+                                        const Skeleton& _skeleton,
+                                        math::Box* _bound) const {
+  return (*this)(_animation, _skeleton, 0.f, _animation.duration(), _bound);
+}
+
+bool AnimationBoundsBuilder::operator()(const Animation& _animation,
+                                        const Skeleton& _skeleton,
+                                        float _from, float _to,
+                                        math::Box* _bound) const {
+  const int num_joints = _skeleton.num_joints();
+  if (!_bound || sampling_rate <= 0.f || margin < 0.f ||
+      !(_from >= 0.f && _from <= _to && _to <= _animation.duration()) ||
+      _animation.num_tracks() != num_joints ||
+      (radii.begin && radii.end - radii.begin < num_joints)) {
+    return false;
+  }
+
+  // Allocates sampling buffers.
+  memory::Allocator* allocator = memory::default_allocator();
+  Range<math::SoaTransform> locals =
+    allocator->AllocateRange<math::SoaTransform>(_skeleton.num_soa_joints());
+  Range<math::Float4x4> models =
+    allocator->AllocateRange<math::Float4x4>(num_joints);
+  SamplingCache* cache = allocator->New<SamplingCache>(num_joints);
+
+  // Samples the range at the fixed rate, and finally at its end.
+  bool success = true;
+  math::Box bound;
+  const float step = 1.f / sampling_rate;
+  for (int i = 0; success; ++i) {
+    const float time = _from + i * step < _to ? _from + i * step : _to;
+
+    SamplingJob sampling_job;
+    sampling_job.animation = &_animation;
+    sampling_job.cache = cache;
+    sampling_job.time = time;
+    sampling_job.output = locals;
+    success &= sampling_job.Run();
+
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = &_skeleton;
+    ltm_job.input = locals;
+    ltm_job.output = models;
+    success &= ltm_job.Run();
+
+    math::Box posture;
+    ComputeBoundsJob bounds_job;
+    bounds_job.models = models;
+    bounds_job.radii = radii;
+    bounds_job.bound = &posture;
+    success &= bounds_job.Run();
+    bound = Merge(bound, posture);
+
+    if (time >= _to) {
+      break;
+    }
+  }
+
+  allocator->Delete(cache);
+  allocator->Deallocate(models);
+  allocator->Deallocate(locals);
+
+  if (!success) {
+    return false;
+  }
+
+  // Inflates the box by margin.
+  if (bound.is_valid()) {
+    const math::Float3 inflate(margin);
+    bound.min = bound.min - inflate;
+    bound.max = bound.max + inflate;
+  }
+  *_bound = bound;
+
+  return true;
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -32,17 +32,24 @@
 
 #include <cstddef>
 #include <cassert>
+#include <cmath>
 #include <algorithm>
 #include <limits>
 
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
 
+#include "ozz/base/maths/box.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/tasks/task_dispatcher.h"
 
+#include "ozz/animation/offline/animation_bounds_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/packed_raw_animation.h"
 
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
@@ -53,22 +60,30 @@ namespace animation {
 namespace offline {
 namespace {
 
+// Sorting keys store the tangent of their key, in value per animation
+// duration. Tangents are null for linear animations.
 struct SortingTranslationKey {
+  typedef math::Float3 Tangent;
   uint16_t track;
   float prev_key_time;
   RawAnimation::TranslationKey key;
+  Tangent tangent;
 };
 
 struct SortingRotationKey {
+  typedef math::Float4 Tangent;
   uint16_t track;
   float prev_key_time;
   RawAnimation::RotationKey key;
+  Tangent tangent;
 };
 
 struct SortingScaleKey {
+  typedef math::Float3 Tangent;
   uint16_t track;
   float prev_key_time;
   RawAnimation::ScaleKey key;
+  Tangent tangent;
 };
 
 // Keyframe sorting. Stores first by time and then track number.
@@ -86,17 +101,23 @@ void PushBackIdentityKey(uint16_t _track, float _time, _DestTrack* _dest) {
   if (!_dest->empty() && _dest->back().track == _track) {
     prev_time =  _dest->back().key.time;
   }
-  const DestKey key = {_track, prev_time, {_time, _SrcKey::identity()}};
+  const DestKey key = {_track, prev_time, {_time, _SrcKey::identity()},
+                       DestKey::Tangent::zero()};
   _dest->push_back(key);
 }
 
 // Copies a track from a RawAnimation to an Animation.
 // Also fixes up the front (t = 0) and back keys (t = duration).
-template<typename _SrcTrack, typename _DestTrack>
-void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
-             _DestTrack* _dest) {
+// Key tangents are copied from _tangents, converted to value per animation
+// duration, or set to zero if _tangents is NULL. Added keys have null
+// tangents, as well as single key tracks.
+template<typename _SrcTrack, typename _SrcTangents, typename _DestTrack>
+void CopyRaw(const _SrcTrack& _src, const _SrcTangents* _tangents,
+             uint16_t _track, float _duration, _DestTrack* _dest) {
   typedef typename _SrcTrack::value_type SrcKey;
   typedef typename _DestTrack::value_type DestKey;
+  typedef typename DestKey::Tangent Tangent;
+  const Tangent zero = Tangent::zero();
 
   if (_src.size() == 0) {  // Adds 2 new keys.
     PushBackIdentityKey<SrcKey, _DestTrack>(_track, 0.f, _dest);
@@ -104,158 +125,737 @@ void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
   } else if (_src.size() == 1) {  // Adds 1 new key.
     const SrcKey& raw_key = _src.front();
     assert(raw_key.time >= 0 && raw_key.time <= _duration);
-    const DestKey first = {_track, -1.f, {0.f, raw_key.value}};
+    const DestKey first = {_track, -1.f, {0.f, raw_key.value}, zero};
       _dest->push_back(first);
-    const DestKey last = {_track, 0.f, {_duration, raw_key.value}};
+    const DestKey last = {_track, 0.f, {_duration, raw_key.value}, zero};
       _dest->push_back(last);
   } else {  // Copies all keys, and fixes up first and last keys.
     float prev_time = -1.f;
     if (_src.front().time != 0.f) {  // Needs a key at t = 0.f.
-      const DestKey first = {_track, prev_time, {0.f, _src.front().value}};
+      const DestKey first = {
+        _track, prev_time, {0.f, _src.front().value}, zero};
       _dest->push_back(first);
       prev_time = 0.f;
     }
     for (size_t k = 0; k < _src.size(); ++k) {  // Copies all keys.
       const SrcKey& raw_key = _src[k];
       assert(raw_key.time >= 0 && raw_key.time <= _duration);
-      const DestKey key = {_track, prev_time, {raw_key.time, raw_key.value}};
+      const Tangent tangent = _tangents ? (*_tangents)[k] * _duration : zero;
+      const DestKey key = {
+        _track, prev_time, {raw_key.time, raw_key.value}, tangent};
       _dest->push_back(key);
       prev_time = raw_key.time;
     }
     if (_src.back().time != _duration) {  // Needs a key at t = _duration.
       const DestKey last = {
-        _track, prev_time, {_duration, _src.back().value}};
+        _track, prev_time, {_duration, _src.back().value}, zero};
       _dest->push_back(last);
     }
   }
   assert(_dest->front().key.time == 0.f && _dest->back().key.time == _duration);
 }
 
-ozz::Range<TranslationKey> CopyToAnimation(
-  ozz::Vector<SortingTranslationKey>::Std* _src) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return ozz::Range<TranslationKey>();
+// Defines the maximum difference between translation values of a track that
+// is considered constant. Translation keys precision depends on their track
+// range, so they aren't compared once compressed.
+const float kConstantTranslationTolerance = 1e-5f;
+
+// Compares runtime values of two keys, once compressed.
+bool CompressedEqual(const SortingTranslationKey& _a,
+                     const SortingTranslationKey& _b) {
+  const math::Float3 diff = _a.key.value - _b.key.value;
+  return std::abs(diff.x) <= kConstantTranslationTolerance &&
+         std::abs(diff.y) <= kConstantTranslationTolerance &&
+         std::abs(diff.z) <= kConstantTranslationTolerance;
+}
+
+// Scales are compared once compressed to half floats.
+bool CompressedEqual(const SortingScaleKey& _a, const SortingScaleKey& _b) {
+  const math::Float3& a = _a.key.value;
+  const math::Float3& b = _b.key.value;
+  return math::FloatToHalf(a.x) == math::FloatToHalf(b.x) &&
+         math::FloatToHalf(a.y) == math::FloatToHalf(b.y) &&
+         math::FloatToHalf(a.z) == math::FloatToHalf(b.z);
+}
+
+// Quantizes normalized quaternion _quat values to _key, using smallest three
+// compression: the largest component is dropped, and the 3 others are
+// quantized in x, y, z, w order.
+void QuantizeRotation(const math::Quaternion& _quat, RotationKey* _key) {
+  const float components[4] = {_quat.x, _quat.y, _quat.z, _quat.w};
+  int largest = 0;
+  for (int i = 1; i < 4; ++i) {
+    if (std::abs(components[i]) > std::abs(components[largest])) {
+      largest = i;
+    }
   }
+  _key->largest = largest & 3;
+  _key->sign = components[largest] >= 0.f;
+  for (int i = 0, j = 0; i < 4; ++i) {
+    if (i == largest) {
+      continue;
+    }
+    const int value = static_cast<int>(
+      floor(components[i] * kRotationQuantizationScale + .5f));
+    _key->value[j++] = math::Clamp(-32767, value, 32767) & 0xffff;
+  }
+}
 
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingTranslationKey>);
+// Rotations are compared once normalized and with a positive w, as this is
+// how FixUpRotations processes the keys of a constant track.
+bool CompressedEqual(const SortingRotationKey& _a,
+                     const SortingRotationKey& _b) {
+  const math::Quaternion identity = math::Quaternion::identity();
+  math::Quaternion a = NormalizeSafe(_a.key.value, identity);
+  if (a.w < 0.f) {
+    a = -a;
+  }
+  math::Quaternion b = NormalizeSafe(_b.key.value, identity);
+  if (b.w < 0.f) {
+    b = -b;
+  }
+  RotationKey qa, qb;
+  QuantizeRotation(a, &qa);
+  QuantizeRotation(b, &qb);
+  return qa.largest == qb.largest && qa.sign == qb.sign &&
+         qa.value[0] == qb.value[0] &&
+         qa.value[1] == qb.value[1] &&
+         qa.value[2] == qb.value[2];
+}
 
-  // Fills output.
-  ozz::Range<TranslationKey> dest =
-    memory::default_allocator()->AllocateRange<TranslationKey>(src_count);
-  const SortingTranslationKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
-    TranslationKey& key = dest.begin[i];
-    key.time = src[i].key.time;
-    key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
+// Converts the times of the keys of a track, stored from _first to the end of
+// _dest, to key time unit. Keys that fall in the same key time unit are merged,
+// keeping the first one, except for the last key of the track which is always
+// kept. If _time_step is greater than a key time unit, key times are first
+// rounded to multiples of _time_step seconds, except the last one.
+template<typename _DestTrack>
+void QuantizeTimes(float _duration, float _time_step,
+                   size_t _first, _DestTrack* _dest) {
+  typedef typename _DestTrack::value_type DestKey;
+  const size_t end = _dest->size();
+  const float max_time = static_cast<float>(kMaxKeyTime);
+  const float step = ToKeyTime(_time_step, _duration);
+  size_t count = 0;  // Number of keys kept.
+  for (size_t i = _first; i < end; ++i) {
+    DestKey key = (*_dest)[i];
+    float time = ToKeyTime(key.key.time, _duration);
+    if (step > 1.f && i != end - 1) {
+      time = std::floor(time / step + .5f) * step;
+    }
+    key.key.time = math::Clamp(0.f, std::floor(time + .5f), max_time);
+    if (count && key.key.time <= (*_dest)[_first + count - 1].key.time) {
+      if (i != end - 1) {
+        continue;  // Merged with the previous key.
+      }
+      --count;  // The last key replaces the previous one.
+    }
+    key.prev_key_time = count ? (*_dest)[_first + count - 1].key.time : -1.f;
+    (*_dest)[_first + count++] = key;
   }
-  return dest;
+  _dest->erase(_dest->begin() + _first + count, _dest->end());
+  assert(count >= 2 && (*_dest)[_first].key.time == 0.f &&
+         _dest->back().key.time == max_time);
 }
 
-ozz::Range<ScaleKey> CopyToAnimation(
-  ozz::Vector<SortingScaleKey>::Std* _src) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return ozz::Range<ScaleKey>();
+// Tests if a tangent is null once compressed to half floats.
+bool IsNullTangent(const math::Float3& _tangent) {
+  return (math::FloatToHalf(_tangent.x) & 0x7fff) == 0 &&
+         (math::FloatToHalf(_tangent.y) & 0x7fff) == 0 &&
+         (math::FloatToHalf(_tangent.z) & 0x7fff) == 0;
+}
+
+bool IsNullTangent(const math::Float4& _tangent) {
+  return IsNullTangent(math::Float3(_tangent.x, _tangent.y, _tangent.z)) &&
+         (math::FloatToHalf(_tangent.w) & 0x7fff) == 0;
+}
+
+// Copies a track from a RawAnimation to an Animation, as CopyRaw does, and
+// converts key times to key time unit, see QuantizeTimes.
+// If all the keys of the track have the same runtime value, and null tangents,
+// then only the first one is kept and moved to _constants.
+template<typename _SrcTrack, typename _SrcTangents, typename _DestTrack>
+void CopyTrack(const _SrcTrack& _src, const _SrcTangents* _tangents,
+               uint16_t _track, float _duration, float _time_step,
+               _DestTrack* _dest, _DestTrack* _constants) {
+  const size_t first = _dest->size();
+  CopyRaw(_src, _tangents, _track, _duration, _dest);
+  QuantizeTimes(_duration, _time_step, first, _dest);
+  for (size_t i = first; i < _dest->size(); ++i) {
+    if (!IsNullTangent((*_dest)[i].tangent) ||
+        !CompressedEqual((*_dest)[first], (*_dest)[i])) {
+      return;
+    }
   }
+  _constants->push_back((*_dest)[first]);
+  _dest->erase(_dest->begin() + first, _dest->end());
+}
 
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingScaleKey>);
+// Compares indices of keys in a sorting key array, such that std heap
+// functions build a min-heap of keys.
+template<typename _Key>
+class HeapGreater {
+ public:
+  explicit HeapGreater(const _Key* _keys)
+      : keys_(_keys) {
+  }
+  bool operator()(size_t _left, size_t _right) const {
+    return SortingKeyLess(keys_[_right], keys_[_left]);
+  }
+ private:
+  const _Key* keys_;
+};
 
-  // Fills output.
-  ozz::Range<ScaleKey> dest =
-    memory::default_allocator()->AllocateRange<ScaleKey>(src_count);
-  const SortingScaleKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
-    ScaleKey& key = dest.begin[i];
-    key.time = src[i].key.time;
-    key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
+// Sorts _src keys to _sorted, using SortingKeyLess order.
+// Keys in _src are stored track by track, and they are already sorted within
+// each track. sorted order is thus built by merging all tracks (k-way merge
+// with a min-heap of track heads), which is O(n.log(num_tracks)) instead of
+// O(n.log(n)) for a comparison sort of all the keys.
+// _heap must be big enough to store one index per track.
+template<typename _Key>
+void MergeKeys(const typename ozz::Vector<_Key>::Std& _src,
+               _Key* _sorted,
+               size_t* _heap) {
+  const size_t count = _src.size();
+  if (!count) {
+    return;
+  }
+  const _Key* src = &_src.front();
+  const HeapGreater<_Key> greater(src);
+
+  // Pushes the first key of every track.
+  size_t heap_size = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (i == 0 || src[i].track != src[i - 1].track) {
+      _heap[heap_size++] = i;
+    }
+  }
+  std::make_heap(_heap, _heap + heap_size, greater);
+
+  // Pops the smallest key, and replaces it with the next key of its track.
+  for (size_t i = 0; heap_size; ++i) {
+    std::pop_heap(_heap, _heap + heap_size, greater);
+    const size_t smallest = _heap[heap_size - 1];
+    _sorted[i] = src[smallest];
+    const size_t next = smallest + 1;
+    if (next < count && src[next].track == src[smallest].track) {
+      assert(SortingKeyLess(src[smallest], src[next]));
+      _heap[heap_size - 1] = next;
+      std::push_heap(_heap, _heap + heap_size, greater);
+    } else {
+      --heap_size;
+    }
   }
-  return dest;
 }
 
-// Specialize for rotations in order to normalize quaternions.
+// Computes the range of translation values of every track to _ranges, and
+// normalizes _constants and _keys values to [0,kMaxTranslationValue] in the
+// range of their track. Values are rounded when copied to the animation.
+void NormalizeTranslations(
+  ozz::Vector<SortingTranslationKey>::Std* _constants,
+  ozz::Vector<SortingTranslationKey>::Std* _keys,
+  const ozz::Range<SoaTranslationRange>& _ranges) {
+  ozz::Vector<SortingTranslationKey>::Std* const streams[] = {
+    _constants, _keys};
+
+  // Finds min and max values, temporarily storing max values in scale.
+  const float max_float = std::numeric_limits<float>::max();
+  for (SoaTranslationRange* range = _ranges.begin;
+       range < _ranges.end;
+       ++range) {
+    for (int c = 0; c < 3; ++c) {
+      for (int t = 0; t < 4; ++t) {
+        range->min[c][t] = max_float;
+        range->scale[c][t] = -max_float;
+      }
+    }
+  }
+  for (size_t s = 0; s < OZZ_ARRAY_SIZE(streams); ++s) {
+    ozz::Vector<SortingTranslationKey>::Std& stream = *streams[s];
+    for (size_t i = 0; i < stream.size(); ++i) {
+      const SortingTranslationKey& key = stream[i];
+      SoaTranslationRange& range = _ranges.begin[key.track / 4];
+      const int t = key.track & 3;
+      const float values[3] = {key.key.value.x,
+                               key.key.value.y,
+                               key.key.value.z};
+      for (int c = 0; c < 3; ++c) {
+        range.min[c][t] = math::Min(range.min[c][t], values[c]);
+        range.scale[c][t] = math::Max(range.scale[c][t], values[c]);
+      }
+    }
+  }
+
+  // Converts max values to scales. Every track has at least a key.
+  const float max_value = static_cast<float>(kMaxTranslationValue);
+  for (SoaTranslationRange* range = _ranges.begin;
+       range < _ranges.end;
+       ++range) {
+    for (int c = 0; c < 3; ++c) {
+      for (int t = 0; t < 4; ++t) {
+        assert(range->min[c][t] <= range->scale[c][t]);
+        range->scale[c][t] =
+          (range->scale[c][t] - range->min[c][t]) / max_value;
+      }
+    }
+  }
+
+  // Normalizes values. Constant tracks have a null scale, their value is min.
+  for (size_t s = 0; s < OZZ_ARRAY_SIZE(streams); ++s) {
+    ozz::Vector<SortingTranslationKey>::Std& stream = *streams[s];
+    for (size_t i = 0; i < stream.size(); ++i) {
+      SortingTranslationKey& key = stream[i];
+      const SoaTranslationRange& range = _ranges.begin[key.track / 4];
+      const int t = key.track & 3;
+      float* values[3] = {&key.key.value.x,
+                          &key.key.value.y,
+                          &key.key.value.z};
+      for (int c = 0; c < 3; ++c) {
+        const float scale = range.scale[c][t];
+        *values[c] =
+          scale > 0.f ? (*values[c] - range.min[c][t]) / scale : 0.f;
+      }
+    }
+  }
+}
+
+// Rounds a normalized translation value to its quantized value.
+uint16_t QuantizeTranslation(float _value) {
+  const int value = static_cast<int>(floor(_value + .5f));
+  return static_cast<uint16_t>(
+    math::Clamp(0, value, static_cast<int>(kMaxTranslationValue)));
+}
+
+// Translations must have been normalized by NormalizeTranslations.
+void CopyToAnimation(const SortingTranslationKey* _src,
+                     const ozz::Range<TranslationKey>& _dest) {
+  const size_t count = _dest.Count();
+  for (size_t i = 0; i < count; ++i) {
+    TranslationKey& key = _dest.begin[i];
+    key.time = static_cast<uint16_t>(_src[i].key.time);
+    key.track = _src[i].track;
+    key.value[0] = QuantizeTranslation(_src[i].key.value.x);
+    key.value[1] = QuantizeTranslation(_src[i].key.value.y);
+    key.value[2] = QuantizeTranslation(_src[i].key.value.z);
+  }
+}
+
+void CopyToAnimation(const SortingScaleKey* _src,
+                     const ozz::Range<ScaleKey>& _dest) {
+  const size_t count = _dest.Count();
+  for (size_t i = 0; i < count; ++i) {
+    ScaleKey& key = _dest.begin[i];
+    key.time = static_cast<uint16_t>(_src[i].key.time);
+    key.track = _src[i].track;
+    key.value[0] = ozz::math::FloatToHalf(_src[i].key.value.x);
+    key.value[1] = ozz::math::FloatToHalf(_src[i].key.value.y);
+    key.value[2] = ozz::math::FloatToHalf(_src[i].key.value.z);
+  }
+}
+
+// Normalizes quaternions.
 // Consecutive opposite quaternions are also fixed up in order to avoid checking
 // for the smallest path during the NLerp runtime algorithm.
-ozz::Range<RotationKey> CopyToAnimation(
-  ozz::Vector<SortingRotationKey>::Std* _src) {
+// Note that keys must still be sorted per-track at that point, which allows
+// this algorithm to process all consecutive keys.
+void FixUpRotations(ozz::Vector<SortingRotationKey>::Std* _src) {
   const size_t src_count = _src->size();
   if (!src_count) {
-    return ozz::Range<RotationKey>();
+    return;
   }
 
-  // Normalize quaternions.
-  // Also fixes-up successive opposite quaternions that would fail to take the
-  // shortest path during the normalized-lerp.
-  // Note that keys are still sorted per-track at that point, which allows this
-  // algorithm to process all consecutive keys.
   size_t track = std::numeric_limits<size_t>::max();
   const math::Quaternion identity = math::Quaternion::identity();
   SortingRotationKey* src = &_src->front();
   for (size_t i = 0; i < src_count; ++i) {
     math::Quaternion normalized = NormalizeSafe(src[i].key.value, identity);
+    bool negate;
     if (track != src[i].track) {  // First key of the track.
-      if (normalized.w < 0.f) {  // .w eq to a dot with identity quaternion.
-        normalized = -normalized;  // Q an -Q are the same rotation.
-      }
+      // .w eq to a dot with identity quaternion.
+      negate = normalized.w < 0.f;
     } else {  // Still on the same track: so fixes-up quaternion.
       const math::Float4 prev(src[i - 1].key.value.x, src[i - 1].key.value.y,
                               src[i - 1].key.value.z, src[i - 1].key.value.w);
       const math::Float4 curr(normalized.x, normalized.y,
                               normalized.z, normalized.w);
-      if (Dot(prev, curr) < 0.f) {
-        normalized = -normalized;  // Q an -Q are the same rotation.
-      }
+      negate = Dot(prev, curr) < 0.f;
+    }
+    if (negate) {  // Q an -Q are the same rotation, so are their tangents.
+      normalized = -normalized;
+      src[i].tangent = -src[i].tangent;
     }
     // Stores fixed-up quaternion.
     src[i].key.value = normalized;
     track = src[i].track;
   }
+}
+
+// Specialize for rotations in order to quantize quaternions.
+void CopyToAnimation(const SortingRotationKey* _src,
+                     const ozz::Range<RotationKey>& _dest) {
+  const size_t count = _dest.Count();
+  for (size_t i = 0; i < count; ++i) {
+    RotationKey& dkey = _dest.begin[i];
+    dkey.time = static_cast<uint16_t>(_src[i].key.time);
+    dkey.track = _src[i].track;
+    QuantizeRotation(_src[i].key.value, &dkey);
+  }
+}
 
-  // Sort.
-  std::sort(array_begin(*_src),
-            array_end(*_src),
-            &SortingKeyLess<SortingRotationKey>);
+// Compresses key _tangent to half floats.
+void CompressTangent(const math::Float3& _tangent, KeyTangent* _dest) {
+  _dest->value[0] = math::FloatToHalf(_tangent.x);
+  _dest->value[1] = math::FloatToHalf(_tangent.y);
+  _dest->value[2] = math::FloatToHalf(_tangent.z);
+  _dest->value[3] = 0;
+}
 
-  // Fills output.
-  ozz::Range<RotationKey> dest =
-    memory::default_allocator()->AllocateRange<RotationKey>(src_count);
-  for (size_t i = 0; i < src_count; ++i) {
-    RotationKey& dkey = dest.begin[i];
-    dkey.time = src[i].key.time;
-    dkey.track = src[i].track;
-    // Stores the sign of the 4th component.
-    const math::Quaternion& squat = src[i].key.value;
-    dkey.wsign = squat.w >= 0.f;
-    // Quantize x, y, z components on 16 bits signed integers.
-    const int x = static_cast<int>(floor(squat.x * 32767.f + .5f));
-    const int y = static_cast<int>(floor(squat.y * 32767.f + .5f));
-    const int z = static_cast<int>(floor(squat.z * 32767.f + .5f));
-    dkey.value[0] = math::Clamp(-32767, x, 32767) & 0xffff;
-    dkey.value[1] = math::Clamp(-32767, y, 32767) & 0xffff;
-    dkey.value[2] = math::Clamp(-32767, z, 32767) & 0xffff;
-  }
-  return dest;
+void CompressTangent(const math::Float4& _tangent, KeyTangent* _dest) {
+  _dest->value[0] = math::FloatToHalf(_tangent.x);
+  _dest->value[1] = math::FloatToHalf(_tangent.y);
+  _dest->value[2] = math::FloatToHalf(_tangent.z);
+  _dest->value[3] = math::FloatToHalf(_tangent.w);
+}
+
+// Copies _src keys tangents to _dest, which is empty for linear animations.
+template<typename _SortingKey>
+void CopyTangents(const _SortingKey* _src,
+                  const ozz::Range<KeyTangent>& _dest) {
+  const size_t count = _dest.Count();
+  for (size_t i = 0; i < count; ++i) {
+    CompressTangent(_src[i].tangent, &_dest.begin[i]);
+  }
+}
+
+// Defines the buffers used to sort a key stream and copy it to the animation.
+// All of them are allocated by the calling thread before dispatching, so that
+// the allocator is never accessed concurrently.
+// Constant tracks keys are copied first, as they aren't sorted. Tangents are
+// copied in the same order as keys to the tangents range, which is empty for
+// linear animations.
+template<typename _SortingKey, typename _Key>
+struct KeyStream {
+  KeyStream(typename ozz::Vector<_SortingKey>::Std* _src,
+            typename ozz::Vector<_SortingKey>::Std* _constants)
+      : keys(_src),
+        constants(_constants),
+        sorted(_src->size()) {
+  }
+  typename ozz::Vector<_SortingKey>::Std* keys;
+  typename ozz::Vector<_SortingKey>::Std* constants;
+  typename ozz::Vector<_SortingKey>::Std sorted;
+  ozz::Vector<size_t>::Std heap;
+  ozz::Range<_Key> dest;
+  ozz::Range<KeyTangent> tangents;
+
+  void Allocate(int _num_tracks, memory::Allocator* _allocator) {
+    heap.resize(_num_tracks);
+    dest = _allocator->AllocateRange<_Key>(
+      constants->size() + keys->size());
+  }
+
+  // Returns the number of keys of the stream, once copied to the animation.
+  size_t count() const {
+    return constants->size() + keys->size();
+  }
+
+  void Sort() {
+    OZZ_PROFILE_SCOPE("AnimationBuilder::Sort");
+    const size_t num_constants = constants->size();
+    const bool hermite = tangents.begin != tangents.end;
+    _Key* sorted_dest = dest.begin + num_constants;
+    if (num_constants) {
+      CopyToAnimation(&constants->front(),
+                      ozz::Range<_Key>(dest.begin, sorted_dest));
+      if (hermite) {
+        CopyTangents(&constants->front(), ozz::Range<KeyTangent>(
+          tangents.begin, tangents.begin + num_constants));
+      }
+    }
+    if (keys->empty()) {
+      return;
+    }
+    MergeKeys<_SortingKey>(*keys, &sorted.front(), &heap.front());
+    CopyToAnimation(&sorted.front(), ozz::Range<_Key>(sorted_dest, dest.end));
+    if (hermite) {
+      CopyTangents(&sorted.front(), ozz::Range<KeyTangent>(
+        tangents.begin + num_constants, tangents.end));
+    }
+  }
+};
+
+typedef KeyStream<SortingTranslationKey, TranslationKey> TranslationStream;
+typedef KeyStream<SortingRotationKey, RotationKey> RotationStream;
+typedef KeyStream<SortingScaleKey, ScaleKey> ScaleStream;
+
+// Implements the task that sorts and copies the 3 key streams concurrently.
+class SortTask : public tasks::Task {
+ public:
+  SortTask(TranslationStream* _translations,
+           const ozz::Range<SoaTranslationRange>& _translation_ranges,
+           RotationStream* _rotations,
+           ScaleStream* _scales)
+      : translations_(_translations),
+        translation_ranges_(_translation_ranges),
+        rotations_(_rotations),
+        scales_(_scales) {
+  }
+
+  virtual void Run(int _index) const {
+    switch (_index) {
+      case 0: {
+        NormalizeTranslations(translations_->constants,
+                              translations_->keys,
+                              translation_ranges_);
+        translations_->Sort();
+        break;
+      }
+      case 1: {
+        FixUpRotations(rotations_->constants);
+        FixUpRotations(rotations_->keys);
+        rotations_->Sort();
+        break;
+      }
+      case 2: {
+        scales_->Sort();
+        break;
+      }
+      default: {
+        assert(false && "Invalid work item.");
+        break;
+      }
+    }
+  }
+
+ private:
+  TranslationStream* translations_;
+  ozz::Range<SoaTranslationRange> translation_ranges_;
+  RotationStream* rotations_;
+  ScaleStream* scales_;
+};
+
+// Fills the _stream state of every seek index entry of _index, by fetching
+// _keys up to entries key time the same way the sampling job does.
+template<typename _Key>
+void FillSeekIndex(const ozz::Range<const _Key>& _keys,
+                   int _num_soa_tracks,
+                   int _num_constants,
+                   int _stream,
+                   const ozz::Range<int32_t>& _index) {
+  const int num_tracks = _num_soa_tracks * 4;
+  const int num_animated = num_tracks - _num_constants;
+
+  // Initializes left and right keys of every track, see UpdateKeys.
+  ozz::Vector<int>::Std cache(num_tracks * 2);
+  for (int i = 0; i < _num_constants; ++i) {
+    const int base = _keys.begin[i].track * 2;
+    cache[base + 0] = i;
+    cache[base + 1] = i;
+  }
+  const int row0 = _num_constants;
+  const int row1 = row0 + num_animated;
+  for (int i = 0; i < num_animated; ++i) {
+    const int base = _keys.begin[row0 + i].track * 2;
+    cache[base + 0] = row0 + i;
+    cache[base + 1] = row1 + i;
+  }
+  const _Key* cursor = _keys.begin + row1 + num_animated;
+
+  const int entry_size = SeekEntrySize(_num_soa_tracks);
+  const int stream_size = SeekStreamSize(_num_soa_tracks);
+  for (int32_t* entry = _index.begin;
+       entry < _index.end;
+       entry += entry_size) {
+    const int key_time = entry[0];
+    while (cursor < _keys.end &&
+           _keys.begin[cache[cursor->track * 2 + 1]].time <= key_time) {
+      const int base = cursor->track * 2;
+      cache[base] = cache[base + 1];
+      cache[base + 1] = static_cast<int>(cursor - _keys.begin);
+      ++cursor;
+    }
+    int32_t* state = entry + 1 + _stream * stream_size;
+    state[0] = static_cast<int32_t>(cursor - _keys.begin);
+    std::copy(cache.begin(), cache.end(), state + 1);
+  }
+}
+
+// Allocates and builds _animation seek index, with an entry every _interval
+// seconds, with _allocator. Returns an empty range if there's no entry.
+ozz::Range<int32_t> BuildSeekIndex(float _interval,
+                                   const Animation& _animation,
+                                   memory::Allocator* _allocator) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  if (_interval <= 0.f || num_soa_tracks == 0) {
+    return ozz::Range<int32_t>();
+  }
+
+  // Entries key times are strictly increasing and lower than the last key
+  // time, as sampling the first and last keys doesn't need any index.
+  ozz::Vector<int32_t>::Std key_times;
+  const float duration = _animation.duration();
+  for (int i = 1; i * _interval < duration; ++i) {
+    const int32_t key_time =
+      static_cast<int32_t>(ToKeyTime(i * _interval, duration));
+    if (key_time >= kMaxKeyTime) {
+      break;
+    }
+    if (key_times.empty() || key_time > key_times.back()) {
+      key_times.push_back(key_time);
+    }
+  }
+  if (key_times.empty()) {
+    return ozz::Range<int32_t>();
+  }
+
+  const int entry_size = SeekEntrySize(num_soa_tracks);
+  const ozz::Range<int32_t> index =
+    _allocator->AllocateRange<int32_t>(
+      key_times.size() * entry_size);
+  for (size_t i = 0; i < key_times.size(); ++i) {
+    index.begin[i * entry_size] = key_times[i];
+  }
+  FillSeekIndex(_animation.translations(), num_soa_tracks,
+                _animation.num_constant_translations(), 0, index);
+  FillSeekIndex(_animation.rotations(), num_soa_tracks,
+                _animation.num_constant_rotations(), 1, index);
+  FillSeekIndex(_animation.scales(), num_soa_tracks,
+                _animation.num_constant_scales(), 2, index);
+  return index;
+}
+
+// Fills _links with the offset from every key of _keys to the previous key of
+// its track. Offsets are 0 for keys without previous key (constant and first
+// keys), or if they don't fit 16 bits.
+template<typename _Key>
+uint16_t* FillKeyLinks(const ozz::Range<const _Key>& _keys,
+                       int _num_soa_tracks,
+                       int _num_constants,
+                       uint16_t* _links) {
+  ozz::Vector<int>::Std previous(_num_soa_tracks * 4, -1);
+  const int count = static_cast<int>(_keys.Count());
+  for (int i = 0; i < count; ++i) {
+    int offset = 0;
+    if (i >= _num_constants) {
+      int& prev = previous[_keys.begin[i].track];
+      if (prev >= 0 && i - prev <= 0xffff) {
+        offset = i - prev;
+      }
+      prev = i;
+    }
+    _links[i] = static_cast<uint16_t>(offset);
+  }
+  return _links + count;
+}
+
+// Allocates with _allocator and builds _animation key links for the 3 key
+// streams.
+ozz::Range<uint16_t> BuildKeyLinks(const Animation& _animation,
+                                   memory::Allocator* _allocator) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  if (num_soa_tracks == 0) {
+    return ozz::Range<uint16_t>();
+  }
+  const ozz::Range<uint16_t> links =
+    _allocator->AllocateRange<uint16_t>(
+      _animation.translations().Count() + _animation.rotations().Count() +
+      _animation.scales().Count());
+  uint16_t* cursor = links.begin;
+  cursor = FillKeyLinks(_animation.translations(), num_soa_tracks,
+                        _animation.num_constant_translations(), cursor);
+  cursor = FillKeyLinks(_animation.rotations(), num_soa_tracks,
+                        _animation.num_constant_rotations(), cursor);
+  cursor = FillKeyLinks(_animation.scales(), num_soa_tracks,
+                        _animation.num_constant_scales(), cursor);
+  assert(cursor == links.end);
+  return links;
+}
+
+// Computes a bounding box per time segment of _animation, segments evenly
+// dividing animation duration. Bounds are allocated with _allocator.
+ozz::Range<math::Box> BuildBounds(const Animation& _animation,
+                                  const Skeleton& _skeleton,
+                                  float _interval,
+                                  float _margin,
+                                  memory::Allocator* _allocator) {
+  const float duration = _animation.duration();
+  int count = 1;
+  if (_interval > 0.f) {
+    const float segments = std::ceil(duration / _interval);
+    count = segments > 1.f ? static_cast<int>(segments) : 1;
+  }
+  const ozz::Range<math::Box> bounds =
+    _allocator->AllocateRange<math::Box>(count);
+
+  AnimationBoundsBuilder builder;
+  builder.margin = _margin;
+  for (int i = 0; i < count; ++i) {
+    const float from = duration * i / count;
+    const float to = i == count - 1 ? duration : duration * (i + 1) / count;
+    const bool success =
+      builder(_animation, _skeleton, from, to, bounds.begin + i);
+    (void)success;
+    assert(success && "Parameters were validated.");
+  }
+  return bounds;
+}
+// Returns the keys of track _track of _input, as a RawAnimation::JointTrack or
+// PackedRawAnimation::JointTrack, which share the same interface.
+const RawAnimation::JointTrack& GetTrack(const RawAnimation& _input,
+                                         int _track) {
+  return _input.tracks[_track];
+}
+
+PackedRawAnimation::JointTrack GetTrack(const PackedRawAnimation& _input,
+                                        int _track) {
+  return _input.track(_track);
 }
 }  // namespace
 
+AnimationBuilder::AnimationBuilder()
+    : dispatcher(NULL),
+      seek_interval(0.f),
+      key_links(false),
+      time_step(0.f),
+      bounds_skeleton(NULL),
+      bounds_interval(0.f),
+      bounds_margin(0.f) {
+}
+
 // Ensures _input's validity and allocates _animation.
 // An animation needs to have at least two key frames per joint, the first at
 // t = 0 and the last at t = duration. If at least one of those keys are not
-// in the RawAnimation then the builder creates it.
+// in the RawAnimation then the builder creates it. Constant tracks are the
+// exception, they only store a single key.
 Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
+  OZZ_PROFILE_SCOPE("AnimationBuilder::operator()");
+  return Build(_input);
+}
+
+Animation* AnimationBuilder::operator()(
+    const PackedRawAnimation& _input) const {
+  OZZ_PROFILE_SCOPE("AnimationBuilder::operator()");
+  return Build(_input);
+}
+
+template <typename _Input>
+Animation* AnimationBuilder::Build(const _Input& _input) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+
   // Tests _raw_animation validity.
   if (!_input.Validate()) {
     return NULL;
   }
 
+  // Tests time step and bounds parameters validity.
+  if (time_step < 0.f) {
+    return NULL;
+  }
+  if (bounds_skeleton &&
+      (bounds_skeleton->num_joints() != _input.num_tracks() ||
+       bounds_margin < 0.f)) {
+    return NULL;
+  }
+
   // Everything is fine, allocates and fills the animation.
   // Nothing can fail now.
   Animation* animation = memory::default_allocator()->New<Animation>();
@@ -277,7 +877,7 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   // Declares and preallocates tracks to sort.
   size_t translations = 0, rotations = 0, scales = 0;
   for (int i = 0; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& raw_track =  _input.tracks[i];
+    const typename _Input::JointTrack& raw_track = GetTrack(_input, i);
     translations += raw_track.translations.size() + 2;  // +2 because worst case
     rotations += raw_track.rotations.size() + 2;        // needs to add the
     scales += raw_track.scales.size() + 2;              // first and last keys.
@@ -289,34 +889,106 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   ozz::Vector<SortingScaleKey>::Std sorting_scales;
   sorting_scales.reserve(scales);
 
+  // Constant tracks store a single key each, including soa padding tracks.
+  ozz::Vector<SortingTranslationKey>::Std constant_translations;
+  constant_translations.reserve(num_soa_tracks);
+  ozz::Vector<SortingRotationKey>::Std constant_rotations;
+  constant_rotations.reserve(num_soa_tracks);
+  ozz::Vector<SortingScaleKey>::Std constant_scales;
+  constant_scales.reserve(num_soa_tracks);
+
   // Filters RawAnimation keys and copies them to the output sorting structure.
+  // Tangents are ignored by linear animations.
+  const bool hermite = _input.interpolation == RawAnimation::kHermite;
   uint16_t i = 0;
   for (; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    CopyRaw(raw_track.translations, i, duration, &sorting_translations);
-    CopyRaw(raw_track.rotations, i, duration, &sorting_rotations);
-    CopyRaw(raw_track.scales, i, duration, &sorting_scales);
+    const typename _Input::JointTrack& raw_track = GetTrack(_input, i);
+    CopyTrack(raw_track.translations,
+              hermite ? &raw_track.translation_tangents : NULL,
+              i, duration, time_step,
+              &sorting_translations, &constant_translations);
+    CopyTrack(raw_track.rotations,
+              hermite ? &raw_track.rotation_tangents : NULL,
+              i, duration, time_step,
+              &sorting_rotations, &constant_rotations);
+    CopyTrack(raw_track.scales,
+              hermite ? &raw_track.scale_tangents : NULL,
+              i, duration, time_step,
+              &sorting_scales, &constant_scales);
   }
 
   // Add enough identity keys to match soa requirements.
   for (; i < num_soa_tracks; ++i) {
     typedef RawAnimation::TranslationKey SrcTKey;
-    PushBackIdentityKey<SrcTKey>(i, 0.f, &sorting_translations);
-    PushBackIdentityKey<SrcTKey>(i, duration, &sorting_translations);
+    PushBackIdentityKey<SrcTKey>(i, 0.f, &constant_translations);
 
     typedef RawAnimation::RotationKey SrcRKey;
-    PushBackIdentityKey<SrcRKey>(i, 0.f, &sorting_rotations);
-    PushBackIdentityKey<SrcRKey>(i, duration, &sorting_rotations);
+    PushBackIdentityKey<SrcRKey>(i, 0.f, &constant_rotations);
 
     typedef RawAnimation::ScaleKey SrcSKey;
-    PushBackIdentityKey<SrcSKey>(i, 0.f, &sorting_scales);
-    PushBackIdentityKey<SrcSKey>(i, duration, &sorting_scales);
+    PushBackIdentityKey<SrcSKey>(i, 0.f, &constant_scales);
   }
 
-  // Copy sorted keys to final animation.
-  animation->translations_ = CopyToAnimation(&sorting_translations);
-  animation->rotations_ = CopyToAnimation(&sorting_rotations);
-  animation->scales_ = CopyToAnimation(&sorting_scales);
+  // Allocates sorting buffers and animation keys.
+  TranslationStream translation_stream(&sorting_translations,
+                                       &constant_translations);
+  translation_stream.Allocate(num_soa_tracks, animation->allocator_);
+  RotationStream rotation_stream(&sorting_rotations, &constant_rotations);
+  rotation_stream.Allocate(num_soa_tracks, animation->allocator_);
+  ScaleStream scale_stream(&sorting_scales, &constant_scales);
+  scale_stream.Allocate(num_soa_tracks, animation->allocator_);
+  animation->translation_ranges_ =
+    animation->allocator_->AllocateRange<SoaTranslationRange>(
+      num_soa_tracks / 4);
+
+  // Tangents of the 3 streams are stored contiguously, in a single buffer.
+  if (hermite && num_soa_tracks) {
+    const size_t num_translations = translation_stream.count();
+    const size_t num_rotations = rotation_stream.count();
+    animation->tangents_ =
+      animation->allocator_->AllocateRange<KeyTangent>(
+        num_translations + num_rotations + scale_stream.count());
+    KeyTangent* tangents = animation->tangents_.begin;
+    translation_stream.tangents.begin = tangents;
+    translation_stream.tangents.end = tangents += num_translations;
+    rotation_stream.tangents.begin = tangents;
+    rotation_stream.tangents.end = tangents += num_rotations;
+    scale_stream.tangents.begin = tangents;
+    scale_stream.tangents.end = animation->tangents_.end;
+  }
+
+  // Sorts and copies keys to final animation, a work item per key stream.
+  const SortTask task(&translation_stream, animation->translation_ranges_,
+                      &rotation_stream, &scale_stream);
+  tasks::Dispatcher* task_dispatcher =
+    dispatcher ? dispatcher : tasks::serial_dispatcher();
+  task_dispatcher->Dispatch(task, 3);
+
+  animation->translations_ = translation_stream.dest;
+  animation->rotations_ = rotation_stream.dest;
+  animation->scales_ = scale_stream.dest;
+  animation->num_constant_translations_ =
+    static_cast<int>(constant_translations.size());
+  animation->num_constant_rotations_ =
+    static_cast<int>(constant_rotations.size());
+  animation->num_constant_scales_ = static_cast<int>(constant_scales.size());
+  animation->scaled_ = internal::HasScale(animation->scales_);
+  animation->uniformly_scaled_ =
+    internal::HasUniformScale(animation->scales_);
+
+  // Seek index and key links are built from the sorted keys.
+  animation->seek_index_ = BuildSeekIndex(seek_interval, *animation,
+                                          animation->allocator_);
+  if (key_links) {
+    animation->key_links_ = BuildKeyLinks(*animation, animation->allocator_);
+  }
+
+  // Bounds are computed by sampling the built animation.
+  if (bounds_skeleton) {
+    animation->bounds_ = BuildBounds(*animation, *bounds_skeleton,
+                                     bounds_interval, bounds_margin,
+                                     animation->allocator_);
+  }
 
   return animation;  // Success.
 }
@@ -0,0 +1,393 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_footprint.h"
+
+#include <cmath>
+
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+AnimationFootprint::AnimationFootprint()
+    : size(0),
+      translations_size(0),
+      rotations_size(0),
+      scales_size(0),
+      translation_ranges_size(0),
+      tangents_size(0),
+      seek_index_size(0),
+      key_links_size(0),
+      bounds_size(0),
+      translations(0),
+      rotations(0),
+      scales(0),
+      constant_translations(0),
+      constant_rotations(0),
+      constant_scales(0),
+      constant_savings(0),
+      time_quantization_savings(0),
+      translation_quantization_savings(0),
+      quaternion_packing_savings(0),
+      scale_quantization_savings(0),
+      tolerance_savings(0) {
+}
+
+// Setup default values, matching AnimationOptimizer ones.
+AnimationFootprintAnalyzer::AnimationFootprintAnalyzer()
+  : translation_tolerance(1e-3f),  // 1 mm.
+    rotation_tolerance(.1f * math::kPi / 180.f),  // 0.1 degree.
+    scale_tolerance(1e-3f) {  // 0.1%.
+}
+
+namespace {
+
+// Defines a decompressed key, whose value has 3 (translation and scale) or 4
+// (rotation) components.
+struct DecodedKey {
+  float time;
+  float value[4];
+};
+
+// Decompresses keys of each type, and tests interpolated values against
+// tolerances.
+class TranslationDecoder {
+ public:
+  TranslationDecoder(const ozz::Range<const SoaTranslationRange>& _ranges,
+                     float _tolerance)
+      : ranges_(_ranges),
+        tolerance_(_tolerance) {
+  }
+  int track(const TranslationKey& _key) const {
+    return _key.track;
+  }
+  void Decode(const TranslationKey& _key, DecodedKey* _decoded) const {
+    const SoaTranslationRange& range = ranges_.begin[_key.track / 4];
+    const int lane = _key.track & 3;
+    _decoded->time = _key.time;
+    for (int i = 0; i < 3; ++i) {
+      _decoded->value[i] = range.min[i][lane] + _key.value[i] *
+                           range.scale[i][lane];
+    }
+    _decoded->value[3] = 0.f;
+  }
+  bool Within(const float* _a, const float* _b) const {
+    return std::abs(_a[0] - _b[0]) <= tolerance_ &&
+           std::abs(_a[1] - _b[1]) <= tolerance_ &&
+           std::abs(_a[2] - _b[2]) <= tolerance_;
+  }
+  bool normalize() const {
+    return false;
+  }
+ private:
+  ozz::Range<const SoaTranslationRange> ranges_;
+  float tolerance_;
+};
+
+class RotationDecoder {
+ public:
+  explicit RotationDecoder(float _tolerance)
+      : distance_tolerance_(2.f * std::sin(_tolerance * .25f)) {
+  }
+  int track(const RotationKey& _key) const {
+    return _key.track;
+  }
+  void Decode(const RotationKey& _key, DecodedKey* _decoded) const {
+    const int largest = _key.largest;
+    float dot = 0.f;
+    for (int i = 0, j = 0; i < 4; ++i) {
+      if (i == largest) {
+        continue;
+      }
+      const float value = _key.value[j++] / kRotationQuantizationScale;
+      _decoded->value[i] = value;
+      dot += value * value;
+    }
+    const float restored = std::sqrt(math::Max(0.f, 1.f - dot));
+    _decoded->value[largest] = _key.sign ? restored : -restored;
+    _decoded->time = _key.time;
+  }
+  // Compares the angle between the 2 rotations. The distance between the 2
+  // (same hemisphere) unit quaternions is used, as it's 2sin(angle/4), which
+  // is more precise than the dot product for small angles.
+  bool Within(const float* _a, const float* _b) const {
+    const float dot =
+      _a[0] * _b[0] + _a[1] * _b[1] + _a[2] * _b[2] + _a[3] * _b[3];
+    const float sign = dot < 0.f ? -1.f : 1.f;
+    float sqr_distance = 0.f;
+    for (int i = 0; i < 4; ++i) {
+      const float diff = _a[i] - sign * _b[i];
+      sqr_distance += diff * diff;
+    }
+    return std::sqrt(sqr_distance) <= distance_tolerance_;
+  }
+  bool normalize() const {
+    return true;
+  }
+ private:
+  float distance_tolerance_;
+};
+
+class ScaleDecoder {
+ public:
+  explicit ScaleDecoder(float _tolerance)
+      : tolerance_(_tolerance) {
+  }
+  int track(const ScaleKey& _key) const {
+    return _key.track;
+  }
+  void Decode(const ScaleKey& _key, DecodedKey* _decoded) const {
+    _decoded->time = _key.time;
+    for (int i = 0; i < 3; ++i) {
+      _decoded->value[i] = math::HalfToFloat(_key.value[i]);
+    }
+    _decoded->value[3] = 0.f;
+  }
+  bool Within(const float* _a, const float* _b) const {
+    return std::abs(_a[0] - _b[0]) <= tolerance_ &&
+           std::abs(_a[1] - _b[1]) <= tolerance_ &&
+           std::abs(_a[2] - _b[2]) <= tolerance_;
+  }
+  bool normalize() const {
+    return false;
+  }
+ private:
+  float tolerance_;
+};
+
+// Counts the keys of a track that can be removed without interpolated values
+// going out of tolerance. Keys are greedily removed from the first one, as
+// AnimationOptimizer does. First and last keys are always kept.
+template<typename _Decoder>
+int CountRemovableKeys(const ozz::Vector<DecodedKey>::Std& _keys,
+                       const _Decoder& _decoder) {
+  const int count = static_cast<int>(_keys.size());
+  int removable = 0;
+  for (int left = 0, candidate = 1; candidate < count - 1; ++candidate) {
+    // Tests if all keys in range ]left,candidate] can be interpolated from
+    // left and candidate + 1 keys.
+    const DecodedKey& from = _keys[left];
+    const DecodedKey& to = _keys[candidate + 1];
+    bool within = true;
+    for (int k = left + 1; within && k <= candidate; ++k) {
+      const DecodedKey& key = _keys[k];
+      const float alpha = (key.time - from.time) / (to.time - from.time);
+      float value[4];
+      float sqr_len = 0.f;
+      for (int i = 0; i < 4; ++i) {
+        value[i] = from.value[i] + (to.value[i] - from.value[i]) * alpha;
+        sqr_len += value[i] * value[i];
+      }
+      if (_decoder.normalize() && sqr_len != 0.f) {
+        const float inv_len = 1.f / std::sqrt(sqr_len);
+        for (int i = 0; i < 4; ++i) {
+          value[i] *= inv_len;
+        }
+      }
+      within = _decoder.Within(value, key.value);
+    }
+    if (within) {
+      ++removable;
+    } else {
+      left = candidate;
+    }
+  }
+  return removable;
+}
+
+// Accumulates footprint of _keys to _footprint tracks, per track key count is
+// accumulated to _num_keys member, and constant track flag to _constant
+// member. Returns the number of removable keys.
+template<typename _Key, typename _Decoder>
+int AnalyzeKeys(const ozz::Range<const _Key>& _keys,
+                int _num_constants,
+                size_t _key_size,
+                const _Decoder& _decoder,
+                int AnimationFootprint::Track::* _num_keys,
+                bool AnimationFootprint::Track::* _constant,
+                AnimationFootprint* _footprint) {
+  const int num_tracks = static_cast<int>(_footprint->tracks.size());
+  const int num_keys = static_cast<int>(_keys.Count());
+
+  // Builds the list of keys of every track, in time order.
+  ozz::Vector<int>::Std offsets(num_tracks + 1, 0);
+  for (int i = _num_constants; i < num_keys; ++i) {
+    const int track = _decoder.track(_keys.begin[i]);
+    if (track < num_tracks) {  // Soa padding tracks are skipped.
+      ++offsets[track + 1];
+    }
+  }
+  for (int i = 0; i < num_tracks; ++i) {
+    offsets[i + 1] += offsets[i];
+  }
+  ozz::Vector<int>::Std cursors(offsets.begin(), offsets.end() - 1);
+  ozz::Vector<int>::Std keys(offsets.back());
+  for (int i = _num_constants; i < num_keys; ++i) {
+    const int track = _decoder.track(_keys.begin[i]);
+    if (track < num_tracks) {
+      keys[cursors[track]++] = i;
+    }
+  }
+
+  // Accumulates constant keys.
+  for (int i = 0; i < _num_constants; ++i) {
+    const int track = _decoder.track(_keys.begin[i]);
+    if (track < num_tracks) {
+      AnimationFootprint::Track& footprint = _footprint->tracks[track];
+      footprint.*_constant = true;
+      ++(footprint.*_num_keys);
+      footprint.size += _key_size;
+    }
+  }
+
+  // Accumulates animated keys, and counts removable ones.
+  int removable = 0;
+  ozz::Vector<DecodedKey>::Std decoded;
+  for (int i = 0; i < num_tracks; ++i) {
+    const int count = offsets[i + 1] - offsets[i];
+    decoded.resize(count);
+    for (int k = 0; k < count; ++k) {
+      _decoder.Decode(_keys.begin[keys[offsets[i] + k]], &decoded[k]);
+    }
+    const int track_removable = CountRemovableKeys(decoded, _decoder);
+    AnimationFootprint::Track& footprint = _footprint->tracks[i];
+    footprint.*_num_keys += count;
+    footprint.size += count * _key_size;
+    footprint.removable_keys += track_removable;
+    removable += track_removable;
+  }
+  return removable;
+}
+}  // namespace
+
+bool AnimationFootprintAnalyzer::operator()(
+  const Animation& _animation, AnimationFootprint* _footprint) const {
+  if (!_footprint) {
+    return false;
+  }
+  *_footprint = AnimationFootprint();
+
+  if (translation_tolerance < 0.f ||
+      rotation_tolerance < 0.f ||
+      scale_tolerance < 0.f) {
+    return false;
+  }
+
+  AnimationFootprint& footprint = *_footprint;
+  footprint.size = _animation.size();
+  footprint.translations_size = _animation.translations().Size();
+  footprint.rotations_size = _animation.rotations().Size();
+  footprint.scales_size = _animation.scales().Size();
+  footprint.translation_ranges_size = _animation.translation_ranges().Size();
+  footprint.tangents_size = _animation.tangents().Size();
+  footprint.seek_index_size = _animation.seek_index().Size();
+  footprint.key_links_size = _animation.key_links().Size();
+  footprint.bounds_size = _animation.bounds().Size();
+
+  footprint.translations = static_cast<int>(_animation.translations().Count());
+  footprint.rotations = static_cast<int>(_animation.rotations().Count());
+  footprint.scales = static_cast<int>(_animation.scales().Count());
+  footprint.constant_translations = _animation.num_constant_translations();
+  footprint.constant_rotations = _animation.num_constant_rotations();
+  footprint.constant_scales = _animation.num_constant_scales();
+
+  // Every key has a tangent and a link if the animation has some.
+  const size_t key_extra_size =
+    (_animation.hermite() ? sizeof(KeyTangent) : 0) +
+    (_animation.key_links().Count() ? sizeof(uint16_t) : 0);
+
+  const AnimationFootprint::Track default_track = {
+    0, 0, 0, false, false, false, 0, 0};
+  footprint.tracks.resize(_animation.num_tracks(), default_track);
+
+  const int removable_translations = AnalyzeKeys(
+    _animation.translations(),
+    footprint.constant_translations,
+    sizeof(TranslationKey) + key_extra_size,
+    TranslationDecoder(_animation.translation_ranges(), translation_tolerance),
+    &AnimationFootprint::Track::translations,
+    &AnimationFootprint::Track::constant_translation,
+    &footprint);
+  const int removable_rotations = AnalyzeKeys(
+    _animation.rotations(),
+    footprint.constant_rotations,
+    sizeof(RotationKey) + key_extra_size,
+    RotationDecoder(rotation_tolerance),
+    &AnimationFootprint::Track::rotations,
+    &AnimationFootprint::Track::constant_rotation,
+    &footprint);
+  const int removable_scales = AnalyzeKeys(
+    _animation.scales(),
+    footprint.constant_scales,
+    sizeof(ScaleKey) + key_extra_size,
+    ScaleDecoder(scale_tolerance),
+    &AnimationFootprint::Track::scales,
+    &AnimationFootprint::Track::constant_scale,
+    &footprint);
+
+  // A constant track saves a key, compared to the 2 keys required otherwise.
+  footprint.constant_savings =
+    footprint.constant_translations * (sizeof(TranslationKey) +
+                                         key_extra_size) +
+    footprint.constant_rotations * (sizeof(RotationKey) + key_extra_size) +
+    footprint.constant_scales * (sizeof(ScaleKey) + key_extra_size);
+
+  // Compares to keys storing a float time and float values.
+  const size_t num_keys =
+    footprint.translations + footprint.rotations + footprint.scales;
+  footprint.time_quantization_savings =
+    num_keys * (sizeof(float) - sizeof(uint16_t));
+  footprint.translation_quantization_savings =
+    footprint.translations * (sizeof(float) - sizeof(uint16_t)) * 3;
+  footprint.quaternion_packing_savings =
+    footprint.rotations * (sizeof(float) * 4 - sizeof(int16_t) * 3);
+  footprint.scale_quantization_savings =
+    footprint.scales * (sizeof(float) - sizeof(uint16_t)) * 3;
+
+  footprint.tolerance_savings =
+    removable_translations * (sizeof(TranslationKey) + key_extra_size) +
+    removable_rotations * (sizeof(RotationKey) + key_extra_size) +
+    removable_scales * (sizeof(ScaleKey) + key_extra_size);
+
+  return true;
+}
+}  // offline
+}  // animation
+}  // ozz
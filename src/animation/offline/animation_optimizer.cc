@@ -30,12 +30,24 @@
 
 #include "ozz/animation/offline/animation_optimizer.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cassert>
+#include <cmath>
+#include <limits>
 
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
+#include "ozz/base/tasks/task_dispatcher.h"
 
+#include "ozz/animation/offline/packed_raw_animation.h"
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
 
 namespace ozz {
 namespace animation {
@@ -45,49 +57,212 @@ namespace offline {
 AnimationOptimizer::AnimationOptimizer()
   : translation_tolerance(1e-3f),  // 1 mm.
     rotation_tolerance(.1f * math::kPi / 180.f),  // 0.1 degree.
-    scale_tolerance(1e-3f) {  // 0.1%.
+    scale_tolerance(1e-3f),  // 0.1%.
+    hierarchical_tolerance(1e-3f),  // 1 mm.
+    hierarchical_distance(1e-1f),  // 10 cm.
+    reduction(kExhaustive),
+    reduction_window(64),
+    interpolation(RawAnimation::kLinear),
+    dispatcher(NULL),
+    report(NULL),
+    report_sampling_rate(30.f) {
+}
+
+AnimationOptimizer::Report::Track::Track()
+  : input_translations(0),
+    input_rotations(0),
+    input_scales(0),
+    output_translations(0),
+    output_rotations(0),
+    output_scales(0),
+    max_translation_error(0.f),
+    rms_translation_error(0.f),
+    max_rotation_error(0.f),
+    rms_rotation_error(0.f),
+    max_scale_error(0.f),
+    rms_scale_error(0.f),
+    max_model_error(0.f),
+    rms_model_error(0.f) {
+}
+
+AnimationOptimizer::Analysis::Analysis()
+  : interpolation(RawAnimation::kLinear) {
 }
 
 namespace {
+// Computes cubic Hermite basis functions at _alpha.
+struct HermiteBasis {
+  explicit HermiteBasis(float _alpha) {
+    const float a2 = _alpha * _alpha;
+    const float a3 = a2 * _alpha;
+    h00 = 2.f * a3 - 3.f * a2 + 1.f;
+    h10 = a3 - 2.f * a2 + _alpha;
+    h01 = -2.f * a3 + 3.f * a2;
+    h11 = a3 - a2;
+  }
+  float h00, h10, h01, h11;
+};
+
+// Estimates the tangent of a translation or scale _curr key, from the
+// surrounding keys values, which are separated by _dt seconds.
+math::Float3 EstimateTangent(const math::Float3& _prev,
+                             const math::Float3& _curr,
+                             const math::Float3& _next,
+                             float _dt) {
+  (void)_curr;
+  return (_next - _prev) / _dt;
+}
+
+// Returns _q as a Float4, negated if it isn't in the same hemisphere as _ref.
+math::Float4 Aligned(const math::Quaternion& _q, const math::Float4& _ref) {
+  const math::Float4 q(_q.x, _q.y, _q.z, _q.w);
+  return Dot(q, _ref) < 0.f ? -q : q;
+}
+
+// Estimates the tangent of a rotation _curr key, from the surrounding keys
+// values, which are separated by _dt seconds. Surrounding keys are taken in
+// the hemisphere of _curr.
+math::Float4 EstimateTangent(const math::Quaternion& _prev,
+                             const math::Quaternion& _curr,
+                             const math::Quaternion& _next,
+                             float _dt) {
+  const math::Float4 curr(_curr.x, _curr.y, _curr.z, _curr.w);
+  return (Aligned(_next, curr) - Aligned(_prev, curr)) / _dt;
+}
+
+// Gets the tangent of _track key _i, from _tangents if it isn't NULL.
+// Otherwise it's estimated from the keys surrounding _i, as the slope between
+// them (Catmull-Rom tangent). First and last keys use a one sided slope.
+template<typename _RawTrack, typename _Tangents>
+typename _Tangents::value_type TrackTangent(const _RawTrack& _track,
+                                            const _Tangents* _tangents,
+                                            size_t _i) {
+  typedef typename _Tangents::value_type Tangent;
+  if (_tangents) {
+    return (*_tangents)[_i];
+  }
+  const size_t prev = _i > 0 ? _i - 1 : _i;
+  const size_t next = _i + 1 < _track.size() ? _i + 1 : _i;
+  if (prev == next) {
+    return Tangent::zero();  // Single key tracks are constant.
+  }
+  return EstimateTangent(_track[prev].value,
+                         _track[_i].value,
+                         _track[next].value,
+                         _track[next].time - _track[prev].time);
+}
+
 // Copy _src keys to _dest but except the ones that can be interpolated.
-template<typename _RawTrack, typename _Comparator, typename _Lerp>
+// At most _window consecutive keys are removed, 0 meaning unbounded.
+// _interp interpolates _src keys, using _src_tangents if not NULL. The
+// tangents of the keys copied to _dest are pushed back to _dest_tangents, if
+// it isn't NULL.
+template<typename _RawTrack, typename _Tangents,
+         typename _Comparator, typename _Interp>
 void Filter(const _RawTrack& _src,
+            const _Tangents* _src_tangents,
             const _Comparator& _comparator,
-            const _Lerp& _lerp,
+            const _Interp& _interp,
             float _tolerance,
-            _RawTrack* _dest) {
-  _dest->clear();  // Reset and reserve destination.
+            size_t _window,
+            _RawTrack* _dest,
+            _Tangents* _dest_tangents) {
+  // Reset and reserve destination. Nothing is allocated if _dest was already
+  // reserved, which allows to filter concurrently.
+  _dest->clear();
   _dest->reserve(_src.size());
+  if (_dest_tangents) {
+    _dest_tangents->clear();
+    _dest_tangents->reserve(_src.size());
+  }
 
   // Only copies the key that cannot be interpolated from the others.
   size_t last_src_pushed = 0;  // Index (in src) of the last pushed key.
   for (size_t i = 0; i < _src.size(); ++i) {
     // First and last keys are always pushed.
-    if (i == 0 || i == _src.size() - 1) {
-      _dest->push_back(_src[i]);
-      last_src_pushed = i;
-    } else {
+    // So is a key that ends a window, which bounds the number of keys tested
+    // below.
+    bool push = i == 0 || i == _src.size() - 1 ||
+                (_window != 0 && i - last_src_pushed > _window);
+    if (!push) {
       // Only inserts i key if keys in range ]last_src_pushed,i] cannot be
       // interpolated from keys last_src_pushed and i + 1.
       typename _RawTrack::const_reference left = _src[last_src_pushed];
       typename _RawTrack::const_reference right = _src[i + 1];
-      for (size_t j = last_src_pushed + 1; j <= i; ++j) {
+      for (size_t j = last_src_pushed + 1; j <= i && !push; ++j) {
         typename _RawTrack::const_reference test = _src[j];
         const float alpha = (test.time - left.time) / (right.time - left.time);
         assert(alpha >= 0.f && alpha <= 1.f);
-        if (!_comparator(_lerp(left.value, right.value, alpha),
-                         test.value,
-                         _tolerance)) {
-          _dest->push_back(_src[i]);
-          last_src_pushed = i;
-          break;
-        }
+        push = !_comparator(
+          _interp(_src, _src_tangents, last_src_pushed, i + 1, alpha),
+          test.value,
+          _tolerance);
+      }
+    }
+    if (push) {
+      _dest->push_back(_src[i]);
+      if (_dest_tangents) {
+        _dest_tangents->push_back(TrackTangent(_src, _src_tangents, i));
       }
+      last_src_pushed = i;
     }
   }
   assert(_dest->size() <= _src.size());
 }
 
+// Evaluates the cubic Hermite curve between _track keys _left and _right.
+// This must be the same interpolation as the one used by the sampling job.
+template<typename _RawTrack, typename _Tangents>
+math::Float3 HermiteFloat3(const _RawTrack& _track,
+                           const _Tangents* _tangents,
+                           size_t _left,
+                           size_t _right,
+                           float _alpha) {
+  const float dt = _track[_right].time - _track[_left].time;
+  const HermiteBasis h(_alpha);
+  return _track[_left].value * h.h00 + _track[_right].value * h.h01 +
+         TrackTangent(_track, _tangents, _left) * (h.h10 * dt) +
+         TrackTangent(_track, _tangents, _right) * (h.h11 * dt);
+}
+
+// Evaluates and normalizes the component-wise cubic Hermite curve between
+// _track keys _left and _right. Right key and its tangent are negated if
+// needed to interpolate along the shortest path, as the AnimationBuilder
+// does. This must be the same interpolation as the one used by the sampling
+// job.
+template<typename _RawTrack, typename _Tangents>
+math::Quaternion HermiteQuaternion(const _RawTrack& _track,
+                                   const _Tangents* _tangents,
+                                   size_t _left,
+                                   size_t _right,
+                                   float _alpha) {
+  const math::Quaternion& q0 = _track[_left].value;
+  const math::Quaternion& q1 = _track[_right].value;
+  const math::Float4 p0(q0.x, q0.y, q0.z, q0.w);
+  math::Float4 p1(q1.x, q1.y, q1.z, q1.w);
+  math::Float4 m1 = TrackTangent(_track, _tangents, _right);
+  if (Dot(p0, p1) < 0.f) {
+    p1 = -p1;
+    m1 = -m1;
+  }
+  const float dt = _track[_right].time - _track[_left].time;
+  const HermiteBasis h(_alpha);
+  const math::Float4 r =
+    p0 * h.h00 + p1 * h.h01 +
+    TrackTangent(_track, _tangents, _left) * (h.h10 * dt) +
+    m1 * (h.h11 * dt);
+  const float inv_len = 1.f / std::sqrt(Dot(r, r));
+  return math::Quaternion(
+    r.x * inv_len, r.y * inv_len, r.z * inv_len, r.w * inv_len);
+}
+
+typedef RawAnimation::JointTrack::Translations Translations;
+typedef RawAnimation::JointTrack::TranslationTangents TranslationTangents;
+typedef RawAnimation::JointTrack::Rotations Rotations;
+typedef RawAnimation::JointTrack::RotationTangents RotationTangents;
+typedef RawAnimation::JointTrack::Scales Scales;
+typedef RawAnimation::JointTrack::ScaleTangents ScaleTangents;
+
 // Translation filtering comparator.
 bool CompareTranslation(const math::Float3& _a,
                    const math::Float3& _b,
@@ -95,12 +270,22 @@ bool CompareTranslation(const math::Float3& _a,
   return Compare(_a, _b, _tolerance);
 }
 
-// Translation interpolation method.
-// This must be the same Lerp as the one used by the sampling job.
-math::Float3 LerpTranslation(const math::Float3& _a,
-                             const math::Float3& _b,
+// Translation interpolation methods.
+// These must be the same as the ones used by the sampling job.
+math::Float3 LerpTranslation(const Translations& _track,
+                             const TranslationTangents*,
+                             size_t _left,
+                             size_t _right,
                              float _alpha) {
-  return math::Lerp(_a, _b, _alpha);
+  return math::Lerp(_track[_left].value, _track[_right].value, _alpha);
+}
+
+math::Float3 HermiteTranslation(const Translations& _track,
+                                const TranslationTangents* _tangents,
+                                size_t _left,
+                                size_t _right,
+                                float _alpha) {
+  return HermiteFloat3(_track, _tangents, _left, _right, _alpha);
 }
 
 // Rotation filtering comparator.
@@ -110,12 +295,22 @@ bool CompareRotation(const math::Quaternion& _a,
   return Compare(_a, _b, _tolerance);
 }
 
-// Rotation interpolation method.
-// This must be the same Lerp as the one used by the sampling job.
-math::Quaternion LerpRotation(const math::Quaternion& _a,
-                              const math::Quaternion& _b,
+// Rotation interpolation methods.
+// These must be the same as the ones used by the sampling job.
+math::Quaternion LerpRotation(const Rotations& _track,
+                              const RotationTangents*,
+                              size_t _left,
+                              size_t _right,
                               float _alpha) {
-  return math::NLerp(_a, _b, _alpha);
+  return math::NLerp(_track[_left].value, _track[_right].value, _alpha);
+}
+
+math::Quaternion HermiteRotation(const Rotations& _track,
+                                 const RotationTangents* _tangents,
+                                 size_t _left,
+                                 size_t _right,
+                                 float _alpha) {
+  return HermiteQuaternion(_track, _tangents, _left, _right, _alpha);
 }
 
 // Scale filtering comparator.
@@ -125,45 +320,906 @@ bool CompareScale(const math::Float3& _a,
   return Compare(_a, _b, _tolerance);
 }
 
-// Scale interpolation method.
-// This must be the same Lerp as the one used by the sampling job.
-math::Float3 LerpScale(const math::Float3& _a,
-                       const math::Float3& _b,
+// Scale interpolation methods.
+// These must be the same as the ones used by the sampling job.
+math::Float3 LerpScale(const Scales& _track,
+                       const ScaleTangents*,
+                       size_t _left,
+                       size_t _right,
                        float _alpha) {
-  return math::Lerp(_a, _b, _alpha);
+  return math::Lerp(_track[_left].value, _track[_right].value, _alpha);
+}
+
+math::Float3 HermiteScale(const Scales& _track,
+                          const ScaleTangents* _tangents,
+                          size_t _left,
+                          size_t _right,
+                          float _alpha) {
+  return HermiteFloat3(_track, _tangents, _left, _right, _alpha);
+}
+
+// Defines the tolerances used to filter a track.
+struct Tolerances {
+  float translation;
+  float rotation;
+  float scale;
+};
+
+// Computes model space tolerances of all _input tracks, see
+// AnimationOptimizer hierarchical operator() for more details.
+void ComputeHierarchicalTolerances(const RawAnimation& _input,
+                                   const Skeleton& _skeleton,
+                                   float _tolerance,
+                                   float _distance,
+                                   Tolerances* _tolerances) {
+  const int num_joints = _skeleton.num_joints();
+  const Skeleton::JointProperties* properties =
+    _skeleton.joint_properties().begin;
+
+  // Bone lengths, ie: the maximum distance from each joint to its parent.
+  // Empty tracks are sampled as identity, whose length is 0.
+  ozz::Vector<float>::Std lengths(num_joints, 0.f);
+  for (int i = 0; i < num_joints; ++i) {
+    const RawAnimation::JointTrack::Translations& translations =
+      _input.tracks[i].translations;
+    for (size_t j = 0; j < translations.size(); ++j) {
+      lengths[i] = math::Max(lengths[i], math::Length(translations[j].value));
+    }
+  }
+
+  // Joints are ordered such that a parent is always before its children.
+  // spans: distance covered by the joints moved by each joint.
+  // heights: number of joints of the longest chain of descendants, including
+  // the joint itself.
+  ozz::Vector<float>::Std spans(num_joints, _distance);
+  ozz::Vector<int>::Std heights(num_joints, 1);
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = properties[i].parent;
+    if (parent != Skeleton::kNoParentIndex) {
+      spans[parent] = math::Max(spans[parent], spans[i] + lengths[i]);
+      heights[parent] = math::Max(heights[parent], heights[i] + 1);
+    }
+  }
+
+  // depths: number of ancestors.
+  ozz::Vector<int>::Std depths(num_joints, 0);
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = properties[i].parent;
+    if (parent != Skeleton::kNoParentIndex) {
+      depths[i] = depths[parent] + 1;
+    }
+  }
+
+  for (int i = 0; i < num_joints; ++i) {
+    // Errors of all the joints of a chain accumulate, so every joint of the
+    // longest chain going through i gets the same share of the tolerance.
+    const float budget = _tolerance / (depths[i] + heights[i]);
+    Tolerances& tolerances = _tolerances[i];
+    tolerances.translation = budget;
+    if (spans[i] > 0.f) {
+      // A rotation of angle a moves a point at distance d of 2.d.sin(a/2).
+      tolerances.rotation =
+        2.f * std::asin(math::Min(budget / (2.f * spans[i]), 1.f));
+      tolerances.scale = budget / spans[i];
+    } else {
+      // Rotations and scales of i don't move anything.
+      tolerances.rotation = math::kPi;
+      tolerances.scale = 1e10f;
+    }
+  }
+}
+
+// Implements the task that filters every track, one work item per track.
+class OptimizeTask : public tasks::Task {
+ public:
+  OptimizeTask(const RawAnimation& _input,
+               const Tolerances* _tolerances,
+               size_t _window,
+               RawAnimation* _output)
+      : input_(_input),
+        tolerances_(_tolerances),
+        window_(_window),
+        output_(_output) {
+  }
+
+  virtual void Run(int _index) const {
+    const RawAnimation::JointTrack& src = input_.tracks[_index];
+    RawAnimation::JointTrack& dest = output_->tracks[_index];
+    const Tolerances& tolerances = tolerances_[_index];
+    // Input tangents are used if there are some, otherwise Hermite
+    // interpolation estimates them.
+    const bool src_hermite = input_.interpolation == RawAnimation::kHermite;
+    const TranslationTangents* translation_tangents =
+      src_hermite ? &src.translation_tangents : NULL;
+    const RotationTangents* rotation_tangents =
+      src_hermite ? &src.rotation_tangents : NULL;
+    const ScaleTangents* scale_tangents =
+      src_hermite ? &src.scale_tangents : NULL;
+
+    if (output_->interpolation == RawAnimation::kHermite) {
+      Filter(src.translations, translation_tangents,
+             CompareTranslation, HermiteTranslation, tolerances.translation,
+             window_, &dest.translations, &dest.translation_tangents);
+      Filter(src.rotations, rotation_tangents,
+             CompareRotation, HermiteRotation, tolerances.rotation,
+             window_, &dest.rotations, &dest.rotation_tangents);
+      Filter(src.scales, scale_tangents,
+             CompareScale, HermiteScale, tolerances.scale,
+             window_, &dest.scales, &dest.scale_tangents);
+    } else {
+      Filter(src.translations, translation_tangents,
+             CompareTranslation, LerpTranslation, tolerances.translation,
+             window_, &dest.translations,
+             static_cast<TranslationTangents*>(NULL));
+      Filter(src.rotations, rotation_tangents,
+             CompareRotation, LerpRotation, tolerances.rotation,
+             window_, &dest.rotations,
+             static_cast<RotationTangents*>(NULL));
+      Filter(src.scales, scale_tangents,
+             CompareScale, LerpScale, tolerances.scale,
+             window_, &dest.scales,
+             static_cast<ScaleTangents*>(NULL));
+    }
+  }
+
+ private:
+  const RawAnimation& input_;
+  const Tolerances* tolerances_;
+  size_t window_;
+  RawAnimation* output_;
+};
+
+// Filters all _input tracks using per track _tolerances, to an _interpolation
+// animation.
+void Optimize(const RawAnimation& _input,
+              const Tolerances* _tolerances,
+              size_t _window,
+              RawAnimation::Interpolation _interpolation,
+              tasks::Dispatcher* _dispatcher,
+              RawAnimation* _output) {
+  OZZ_PROFILE_SCOPE("AnimationOptimizer::Filter");
+  // Rebuilds output animation.
+  _output->duration = _input.duration;
+  _output->interpolation = _interpolation;
+  const int num_tracks = _input.num_tracks();
+  _output->tracks.resize(num_tracks);
+
+  // Allocates all output tracks on the calling thread, as allocators aren't
+  // required to be thread safe.
+  for (int i = 0; i < num_tracks; ++i) {
+    const RawAnimation::JointTrack& src = _input.tracks[i];
+    RawAnimation::JointTrack& dest = _output->tracks[i];
+    dest.translations.reserve(src.translations.size());
+    dest.rotations.reserve(src.rotations.size());
+    dest.scales.reserve(src.scales.size());
+    if (_interpolation == RawAnimation::kHermite) {
+      dest.translation_tangents.reserve(src.translations.size());
+      dest.rotation_tangents.reserve(src.rotations.size());
+      dest.scale_tangents.reserve(src.scales.size());
+    }
+  }
+
+  const OptimizeTask task(_input, _tolerances, _window, _output);
+  tasks::Dispatcher* task_dispatcher =
+    _dispatcher ? _dispatcher : tasks::serial_dispatcher();
+  task_dispatcher->Dispatch(task, num_tracks);
+
+  // Output animation is always valid.
+  assert(_output->Validate());
+}
+
+// Samples _track at _time, using optimizer _interp function. _cursor is the
+// index of the first key after the previous sampling time, which allows to
+// sample at increasing times without searching keys from the beginning.
+template<typename _Value, typename _RawTrack, typename _Tangents,
+         typename _Interp>
+_Value SampleTrack(const _RawTrack& _track,
+                   const _Tangents* _tangents,
+                   const _Interp& _interp,
+                   float _time,
+                   const _Value& _identity,
+                   size_t* _cursor) {
+  if (_track.empty()) {
+    return _identity;
+  }
+  size_t& right = *_cursor;
+  while (right < _track.size() && _track[right].time <= _time) {
+    ++right;
+  }
+  if (right == 0) {
+    return _track.front().value;
+  }
+  if (right == _track.size()) {
+    return _track.back().value;
+  }
+  const size_t left = right - 1;
+  const float alpha = (_time - _track[left].time) /
+                      (_track[right].time - _track[left].time);
+  return _interp(_track, _tangents, left, right, alpha);
+}
+
+// Samples all _animation tracks at _time, to _transforms. _cursors stores 3
+// cursors per track, see SampleTrack.
+void SampleAnimation(const RawAnimation& _animation,
+                     float _time,
+                     size_t* _cursors,
+                     math::Transform* _transforms) {
+  const bool hermite = _animation.interpolation == RawAnimation::kHermite;
+  for (int i = 0; i < _animation.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& track = _animation.tracks[i];
+    math::Transform& transform = _transforms[i];
+    size_t* cursors = _cursors + i * 3;
+    if (hermite) {
+      transform.translation = SampleTrack(
+        track.translations, &track.translation_tangents, HermiteTranslation,
+        _time, math::Float3::zero(), &cursors[0]);
+      transform.rotation = SampleTrack(
+        track.rotations, &track.rotation_tangents, HermiteRotation,
+        _time, math::Quaternion::identity(), &cursors[1]);
+      transform.scale = SampleTrack(
+        track.scales, &track.scale_tangents, HermiteScale,
+        _time, math::Float3::one(), &cursors[2]);
+    } else {
+      transform.translation = SampleTrack(
+        track.translations, static_cast<const TranslationTangents*>(NULL),
+        LerpTranslation, _time, math::Float3::zero(), &cursors[0]);
+      transform.rotation = SampleTrack(
+        track.rotations, static_cast<const RotationTangents*>(NULL),
+        LerpRotation, _time, math::Quaternion::identity(), &cursors[1]);
+      transform.scale = SampleTrack(
+        track.scales, static_cast<const ScaleTangents*>(NULL),
+        LerpScale, _time, math::Float3::one(), &cursors[2]);
+    }
+  }
+}
+
+// Computes model space matrices of _transforms local space transforms.
+void LocalToModel(const Skeleton& _skeleton,
+                  const math::Transform* _transforms,
+                  math::Float4x4* _models) {
+  const Skeleton::JointProperties* properties =
+    _skeleton.joint_properties().begin;
+  for (int i = 0; i < _skeleton.num_joints(); ++i) {
+    const math::Transform& transform = _transforms[i];
+    const math::Float4x4 local = math::Float4x4::FromAffine(
+      math::simd_float4::Load3PtrU(&transform.translation.x),
+      math::simd_float4::LoadPtrU(&transform.rotation.x),
+      math::simd_float4::Load3PtrU(&transform.scale.x));
+    const int parent = properties[i].parent;
+    _models[i] =
+      parent == Skeleton::kNoParentIndex ? local : _models[parent] * local;
+  }
+}
+
+// Gets the angle between 2 rotations, from the distance between the (same
+// hemisphere) unit quaternions, which is 2sin(angle/4). This is more precise
+// than the dot product for small angles.
+float RotationError(const math::Quaternion& _a, const math::Quaternion& _b) {
+  const math::Quaternion identity = math::Quaternion::identity();
+  const math::Quaternion a = NormalizeSafe(_a, identity);
+  math::Quaternion b = NormalizeSafe(_b, identity);
+  if (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.f) {
+    b = -b;
+  }
+  const math::Float4 diff(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w);
+  return 4.f * std::asin(math::Min(math::Length(diff) * .5f, 1.f));
+}
+
+// Accumulates an error sample: updates _max, and adds the square of _error
+// to _sum.
+void Accumulate(float _error, float* _max, float* _sum) {
+  *_max = math::Max(*_max, _error);
+  *_sum += _error * _error;
+}
+
+// Fills _report with keys counts of _input and _output, and with errors
+// measured by sampling them at _rate. Model space errors are measured only if
+// _skeleton isn't NULL, at _distance from every joint.
+void ComputeReport(const RawAnimation& _input,
+                   const RawAnimation& _output,
+                   const Skeleton* _skeleton,
+                   float _distance,
+                   float _rate,
+                   AnimationOptimizer::Report* _report) {
+  typedef AnimationOptimizer::Report::Track Track;
+  const int num_tracks = _input.num_tracks();
+  _report->tracks.clear();
+  _report->tracks.resize(num_tracks);
+  _report->total = Track();
+
+  // Key counts.
+  for (int i = 0; i < num_tracks; ++i) {
+    const RawAnimation::JointTrack& input = _input.tracks[i];
+    const RawAnimation::JointTrack& output = _output.tracks[i];
+    Track& track = _report->tracks[i];
+    track.input_translations = static_cast<int>(input.translations.size());
+    track.input_rotations = static_cast<int>(input.rotations.size());
+    track.input_scales = static_cast<int>(input.scales.size());
+    track.output_translations = static_cast<int>(output.translations.size());
+    track.output_rotations = static_cast<int>(output.rotations.size());
+    track.output_scales = static_cast<int>(output.scales.size());
+    _report->total.input_translations += track.input_translations;
+    _report->total.input_rotations += track.input_rotations;
+    _report->total.input_scales += track.input_scales;
+    _report->total.output_translations += track.output_translations;
+    _report->total.output_rotations += track.output_rotations;
+    _report->total.output_scales += track.output_scales;
+  }
+  if (!num_tracks) {
+    return;
+  }
+
+  // Sampling buffers. Rms members accumulate the sum of squared errors until
+  // all samples are processed.
+  memory::Allocator* allocator = memory::default_allocator();
+  ozz::Vector<size_t>::Std input_cursors(num_tracks * 3, 0);
+  ozz::Vector<size_t>::Std output_cursors(num_tracks * 3, 0);
+  ozz::Vector<math::Transform>::Std input_transforms(num_tracks);
+  ozz::Vector<math::Transform>::Std output_transforms(num_tracks);
+  ozz::Range<math::Float4x4> input_models;
+  ozz::Range<math::Float4x4> output_models;
+  if (_skeleton) {
+    input_models = allocator->AllocateRange<math::Float4x4>(num_tracks);
+    output_models = allocator->AllocateRange<math::Float4x4>(num_tracks);
+  }
+  const math::SimdFloat4 points[4] = {
+    math::simd_float4::zero(),
+    math::simd_float4::Load(_distance, 0.f, 0.f, 0.f),
+    math::simd_float4::Load(0.f, _distance, 0.f, 0.f),
+    math::simd_float4::Load(0.f, 0.f, _distance, 0.f)};
+
+  // Samples at _rate, and at the end of the animation.
+  int num_samples = 0;
+  for (bool end = false; !end; ++num_samples) {
+    float time = num_samples / _rate;
+    if (time >= _input.duration) {
+      time = _input.duration;
+      end = true;
+    }
+    SampleAnimation(_input, time, &input_cursors[0], &input_transforms[0]);
+    SampleAnimation(_output, time, &output_cursors[0], &output_transforms[0]);
+    if (_skeleton) {
+      LocalToModel(*_skeleton, &input_transforms[0], input_models.begin);
+      LocalToModel(*_skeleton, &output_transforms[0], output_models.begin);
+    }
+
+    for (int i = 0; i < num_tracks; ++i) {
+      const math::Transform& input = input_transforms[i];
+      const math::Transform& output = output_transforms[i];
+      Track& track = _report->tracks[i];
+      Accumulate(math::Length(input.translation - output.translation),
+                 &track.max_translation_error, &track.rms_translation_error);
+      Accumulate(RotationError(input.rotation, output.rotation),
+                 &track.max_rotation_error, &track.rms_rotation_error);
+      Accumulate(math::Length(input.scale - output.scale),
+                 &track.max_scale_error, &track.rms_scale_error);
+      if (_skeleton) {
+        float error = 0.f;
+        for (int p = 0; p < 4; ++p) {
+          const math::SimdFloat4 diff =
+            math::TransformPoint(input_models.begin[i], points[p]) -
+            math::TransformPoint(output_models.begin[i], points[p]);
+          error = math::Max(error, math::GetX(math::Length3(diff)));
+        }
+        Accumulate(error, &track.max_model_error, &track.rms_model_error);
+      }
+    }
+  }
+
+  allocator->Deallocate(input_models);
+  allocator->Deallocate(output_models);
+
+  // Computes root mean squares, and whole animation errors.
+  Track& total = _report->total;
+  for (int i = 0; i < num_tracks; ++i) {
+    Track& track = _report->tracks[i];
+    total.max_translation_error =
+      math::Max(total.max_translation_error, track.max_translation_error);
+    total.max_rotation_error =
+      math::Max(total.max_rotation_error, track.max_rotation_error);
+    total.max_scale_error =
+      math::Max(total.max_scale_error, track.max_scale_error);
+    total.max_model_error =
+      math::Max(total.max_model_error, track.max_model_error);
+    total.rms_translation_error += track.rms_translation_error;
+    total.rms_rotation_error += track.rms_rotation_error;
+    total.rms_scale_error += track.rms_scale_error;
+    total.rms_model_error += track.rms_model_error;
+    track.rms_translation_error =
+      std::sqrt(track.rms_translation_error / num_samples);
+    track.rms_rotation_error =
+      std::sqrt(track.rms_rotation_error / num_samples);
+    track.rms_scale_error = std::sqrt(track.rms_scale_error / num_samples);
+    track.rms_model_error = std::sqrt(track.rms_model_error / num_samples);
+  }
+  const float total_samples = static_cast<float>(num_samples) * num_tracks;
+  total.rms_translation_error =
+    std::sqrt(total.rms_translation_error / total_samples);
+  total.rms_rotation_error =
+    std::sqrt(total.rms_rotation_error / total_samples);
+  total.rms_scale_error = std::sqrt(total.rms_scale_error / total_samples);
+  total.rms_model_error = std::sqrt(total.rms_model_error / total_samples);
+}
+
+// Removal error functions, which measure the same errors as filtering
+// comparators.
+float TranslationError(const math::Float3& _a, const math::Float3& _b) {
+  return math::Length(_a - _b);
+}
+
+float ScaleError(const math::Float3& _a, const math::Float3& _b) {
+  return math::Length(_a - _b);
+}
+
+// Error of the keys that can't be removed.
+const float kUnremovable = std::numeric_limits<float>::max();
+
+// Defines the removal of a key, and the error it introduces.
+struct Removal {
+  float error;
+  size_t index;
+};
+
+// Orders removals such that the heap top is the smallest error.
+struct GreaterError {
+  bool operator()(const Removal& _a, const Removal& _b) const {
+    return _a.error > _b.error;
+  }
+};
+
+// Scratch buffers used to rank the keys of a track, see Rank().
+struct RankBuffers {
+  // Reserves buffers for tracks of up to _size keys. Nothing is allocated
+  // afterwards, which allows to rank concurrently.
+  void Reserve(size_t _size) {
+    prev.reserve(_size);
+    next.reserve(_size);
+    errors.reserve(_size);
+    // Every removal pushes at most 2 updated errors.
+    heap.reserve(_size * 3);
+  }
+  ozz::Vector<size_t>::Std prev;
+  ozz::Vector<size_t>::Std next;
+  ozz::Vector<float>::Std errors;
+  ozz::Vector<Removal>::Std heap;
+};
+
+// Computes the error of interpolating _src keys ]_left,_right[ from keys
+// _left and _right, or kUnremovable if there are more than _window of them
+// (0 meaning unbounded).
+template<typename _RawTrack, typename _Tangents,
+         typename _Error, typename _Interp>
+float RemovalError(const _RawTrack& _src,
+                   const _Tangents* _src_tangents,
+                   const _Error& _error,
+                   const _Interp& _interp,
+                   size_t _window,
+                   size_t _left,
+                   size_t _right) {
+  if (_window != 0 && _right - _left - 1 > _window) {
+    return kUnremovable;
+  }
+  typename _RawTrack::const_reference left = _src[_left];
+  typename _RawTrack::const_reference right = _src[_right];
+  float error = 0.f;
+  for (size_t j = _left + 1; j < _right; ++j) {
+    typename _RawTrack::const_reference test = _src[j];
+    const float alpha = (test.time - left.time) / (right.time - left.time);
+    error = math::Max(
+      error,
+      _error(_interp(_src, _src_tangents, _left, _right, alpha), test.value));
+  }
+  return error;
+}
+
+// Fills _ranks with the removal error of every _src key, see
+// AnimationOptimizer::Analyze(). _ranks must already be sized to _src.
+template<typename _RawTrack, typename _Tangents,
+         typename _Error, typename _Interp>
+void Rank(const _RawTrack& _src,
+          const _Tangents* _src_tangents,
+          const _Error& _error,
+          const _Interp& _interp,
+          size_t _window,
+          RankBuffers* _buffers,
+          ozz::Vector<float>::Std* _ranks) {
+  const size_t num_keys = _src.size();
+  assert(_ranks->size() == num_keys);
+  ozz::Vector<float>::Std& ranks = *_ranks;
+  std::fill(ranks.begin(), ranks.end(), kUnremovable);
+  if (num_keys < 3) {
+    return;  // First and last keys are never removed.
+  }
+
+  // Remaining keys are linked to their remaining neighbours.
+  ozz::Vector<size_t>::Std& prev = _buffers->prev;
+  ozz::Vector<size_t>::Std& next = _buffers->next;
+  ozz::Vector<float>::Std& errors = _buffers->errors;
+  ozz::Vector<Removal>::Std& heap = _buffers->heap;
+  prev.resize(num_keys);
+  next.resize(num_keys);
+  errors.resize(num_keys);
+  heap.clear();
+  next[0] = 1;
+  prev[num_keys - 1] = num_keys - 2;
+  for (size_t i = 1; i < num_keys - 1; ++i) {
+    prev[i] = i - 1;
+    next[i] = i + 1;
+    errors[i] = RemovalError(
+      _src, _src_tangents, _error, _interp, _window, i - 1, i + 1);
+    const Removal removal = {errors[i], i};
+    heap.push_back(removal);
+  }
+  std::make_heap(heap.begin(), heap.end(), GreaterError());
+
+  // Removes keys by increasing error. Errors of the neighbours of a removed
+  // key are updated by pushing them again, outdated ones are skipped.
+  float level = 0.f;
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), GreaterError());
+    const Removal removal = heap.back();
+    heap.pop_back();
+    const size_t i = removal.index;
+    if (ranks[i] != kUnremovable || removal.error != errors[i]) {
+      continue;
+    }
+    if (removal.error == kUnremovable) {
+      break;
+    }
+    level = math::Max(level, removal.error);
+    ranks[i] = level;
+
+    const size_t left = prev[i];
+    const size_t right = next[i];
+    next[left] = right;
+    prev[right] = left;
+    if (left != 0) {
+      errors[left] = RemovalError(
+        _src, _src_tangents, _error, _interp, _window, prev[left], right);
+      const Removal update = {errors[left], left};
+      heap.push_back(update);
+      std::push_heap(heap.begin(), heap.end(), GreaterError());
+    }
+    if (right != num_keys - 1) {
+      errors[right] = RemovalError(
+        _src, _src_tangents, _error, _interp, _window, left, next[right]);
+      const Removal update = {errors[right], right};
+      heap.push_back(update);
+      std::push_heap(heap.begin(), heap.end(), GreaterError());
+    }
+  }
+}
+
+// Implements the task that ranks the keys of every track, one work item per
+// track.
+class AnalyzeTask : public tasks::Task {
+ public:
+  AnalyzeTask(size_t _window,
+              RankBuffers* _buffers,
+              AnimationOptimizer::Analysis* _analysis)
+      : window_(_window),
+        buffers_(_buffers),
+        analysis_(_analysis) {
+  }
+
+  virtual void Run(int _index) const {
+    const RawAnimation& input = analysis_->animation;
+    const RawAnimation::JointTrack& src = input.tracks[_index];
+    AnimationOptimizer::Analysis::Track& dest = analysis_->tracks[_index];
+    RankBuffers* buffers = &buffers_[_index];
+    // Input tangents are used if there are some, otherwise Hermite
+    // interpolation estimates them.
+    const bool src_hermite = input.interpolation == RawAnimation::kHermite;
+    const TranslationTangents* translation_tangents =
+      src_hermite ? &src.translation_tangents : NULL;
+    const RotationTangents* rotation_tangents =
+      src_hermite ? &src.rotation_tangents : NULL;
+    const ScaleTangents* scale_tangents =
+      src_hermite ? &src.scale_tangents : NULL;
+
+    if (analysis_->interpolation == RawAnimation::kHermite) {
+      Rank(src.translations, translation_tangents, TranslationError,
+           HermiteTranslation, window_, buffers, &dest.translations);
+      Rank(src.rotations, rotation_tangents, RotationError,
+           HermiteRotation, window_, buffers, &dest.rotations);
+      Rank(src.scales, scale_tangents, ScaleError,
+           HermiteScale, window_, buffers, &dest.scales);
+    } else {
+      Rank(src.translations, translation_tangents, TranslationError,
+           LerpTranslation, window_, buffers, &dest.translations);
+      Rank(src.rotations, rotation_tangents, RotationError,
+           LerpRotation, window_, buffers, &dest.rotations);
+      Rank(src.scales, scale_tangents, ScaleError,
+           LerpScale, window_, buffers, &dest.scales);
+    }
+  }
+
+ private:
+  size_t window_;
+  RankBuffers* buffers_;
+  AnimationOptimizer::Analysis* analysis_;
+};
+
+// Checks that _analysis has removal errors for all its animation keys.
+bool ValidateAnalysis(const AnimationOptimizer::Analysis& _analysis) {
+  const RawAnimation& animation = _analysis.animation;
+  if (!animation.Validate() ||
+      _analysis.tracks.size() != animation.tracks.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < _analysis.tracks.size(); ++i) {
+    const RawAnimation::JointTrack& track = animation.tracks[i];
+    const AnimationOptimizer::Analysis::Track& ranks = _analysis.tracks[i];
+    if (ranks.translations.size() != track.translations.size() ||
+        ranks.rotations.size() != track.rotations.size() ||
+        ranks.scales.size() != track.scales.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copy _src keys whose removal error is greater than _tolerance to _dest. The
+// tangents of the keys copied to _dest are pushed back to _dest_tangents, if
+// it isn't NULL.
+template<typename _RawTrack, typename _Tangents>
+void Extract(const _RawTrack& _src,
+             const _Tangents* _src_tangents,
+             const ozz::Vector<float>::Std& _ranks,
+             float _tolerance,
+             _RawTrack* _dest,
+             _Tangents* _dest_tangents) {
+  for (size_t i = 0; i < _src.size(); ++i) {
+    if (_ranks[i] > _tolerance) {
+      _dest->push_back(_src[i]);
+      if (_dest_tangents) {
+        _dest_tangents->push_back(TrackTangent(_src, _src_tangents, i));
+      }
+    }
+  }
+}
+
+// Extracts all _analysis tracks using per track _tolerances.
+void Extract(const AnimationOptimizer::Analysis& _analysis,
+             const Tolerances* _tolerances,
+             RawAnimation* _output) {
+  OZZ_PROFILE_SCOPE("AnimationOptimizer::Extract");
+  const RawAnimation& input = _analysis.animation;
+  _output->duration = input.duration;
+  _output->interpolation = _analysis.interpolation;
+  const int num_tracks = input.num_tracks();
+  _output->tracks.resize(num_tracks);
+
+  const bool src_hermite = input.interpolation == RawAnimation::kHermite;
+  const bool dest_hermite = _analysis.interpolation == RawAnimation::kHermite;
+  for (int i = 0; i < num_tracks; ++i) {
+    const RawAnimation::JointTrack& src = input.tracks[i];
+    const AnimationOptimizer::Analysis::Track& ranks = _analysis.tracks[i];
+    RawAnimation::JointTrack& dest = _output->tracks[i];
+    const Tolerances& tolerances = _tolerances[i];
+    Extract(src.translations,
+            src_hermite ? &src.translation_tangents : NULL,
+            ranks.translations, tolerances.translation, &dest.translations,
+            dest_hermite ? &dest.translation_tangents : NULL);
+    Extract(src.rotations,
+            src_hermite ? &src.rotation_tangents : NULL,
+            ranks.rotations, tolerances.rotation, &dest.rotations,
+            dest_hermite ? &dest.rotation_tangents : NULL);
+    Extract(src.scales,
+            src_hermite ? &src.scale_tangents : NULL,
+            ranks.scales, tolerances.scale, &dest.scales,
+            dest_hermite ? &dest.scale_tangents : NULL);
+  }
+
+  // Output animation is always valid.
+  assert(_output->Validate());
 }
 }  // namespace
 
 bool AnimationOptimizer::operator()(const RawAnimation& _input,
                                     RawAnimation* _output) const {
+  OZZ_PROFILE_SCOPE("AnimationOptimizer::operator()");
+  memory::ScopedTag tag(memory::kTagOffline);
+
   if (!_output) {
     return false;
   }
   // Reset output animation to default.
   *_output = RawAnimation();
 
-  // Validate animation.
-  if (!_input.Validate()) {
+  // Validate animation, reduction and report parameters.
+  if (!_input.Validate() || (reduction == kWindowed && reduction_window < 1) ||
+      (report && report_sampling_rate <= 0.f)) {
     return false;
   }
 
-  // Rebuilds output animation.
-  _output->duration = _input.duration;
-  int num_tracks = _input.num_tracks();
-  _output->tracks.resize(num_tracks);
+  // All tracks share the same local tolerances.
+  const Tolerances tolerances = {
+    translation_tolerance, rotation_tolerance, scale_tolerance};
+  const int num_tracks = _input.num_tracks();
+  ozz::Vector<Tolerances>::Std track_tolerances(num_tracks, tolerances);
+
+  const size_t window =
+    reduction == kWindowed ? static_cast<size_t>(reduction_window) : 0;
+  Optimize(_input, num_tracks ? &track_tolerances[0] : NULL, window,
+           interpolation, dispatcher, _output);
+
+  if (report) {
+    ComputeReport(_input, *_output, NULL, hierarchical_distance,
+                  report_sampling_rate, report);
+  }
+
+  return true;
+}
+
+bool AnimationOptimizer::operator()(const RawAnimation& _input,
+                                    const Skeleton& _skeleton,
+                                    RawAnimation* _output) const {
+  OZZ_PROFILE_SCOPE("AnimationOptimizer::operator()");
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  if (!_output) {
+    return false;
+  }
+  // Reset output animation to default.
+  *_output = RawAnimation();
+
+  // Validate animation, reduction and report parameters, and skeleton
+  // compatibility.
+  if (!_input.Validate() || (reduction == kWindowed && reduction_window < 1) ||
+      (report && report_sampling_rate <= 0.f) ||
+      _input.num_tracks() != _skeleton.num_joints()) {
+    return false;
+  }
+
+  const int num_tracks = _input.num_tracks();
+  ozz::Vector<Tolerances>::Std track_tolerances(num_tracks);
+  if (num_tracks) {
+    ComputeHierarchicalTolerances(_input, _skeleton, hierarchical_tolerance,
+                                  hierarchical_distance, &track_tolerances[0]);
+  }
+
+  const size_t window =
+    reduction == kWindowed ? static_cast<size_t>(reduction_window) : 0;
+  Optimize(_input, num_tracks ? &track_tolerances[0] : NULL, window,
+           interpolation, dispatcher, _output);
+
+  if (report) {
+    ComputeReport(_input, *_output, &_skeleton, hierarchical_distance,
+                  report_sampling_rate, report);
+  }
+
+  return true;
+}
+
+bool AnimationOptimizer::operator()(const PackedRawAnimation& _input,
+                                    const Skeleton* _skeleton,
+                                    PackedRawAnimation* _output) const {
+  if (!_output) {
+    return false;
+  }
+  RawAnimation input;
+  _input.Unpack(&input);
+  RawAnimation output;
+  const bool success = _skeleton ? (*this)(input, *_skeleton, &output) :
+                                   (*this)(input, &output);
+  // Packing fails and resets _output if output is invalid.
+  return _output->Pack(output) && success;
+}
+
+bool AnimationOptimizer::Analyze(const RawAnimation& _input,
+                                 Analysis* _analysis) const {
+  OZZ_PROFILE_SCOPE("AnimationOptimizer::Analyze");
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  if (!_analysis) {
+    return false;
+  }
+  // Reset analysis to default.
+  *_analysis = Analysis();
+
+  // Validate animation and reduction parameters.
+  if (!_input.Validate() || (reduction == kWindowed && reduction_window < 1)) {
+    return false;
+  }
+
+  _analysis->animation = _input;
+  _analysis->interpolation = interpolation;
+
+  // Allocates all outputs and scratch buffers on the calling thread, as
+  // allocators aren't required to be thread safe.
+  const int num_tracks = _input.num_tracks();
+  _analysis->tracks.resize(num_tracks);
+  ozz::Vector<RankBuffers>::Std buffers(num_tracks);
   for (int i = 0; i < num_tracks; ++i) {
-    Filter(_input.tracks[i].translations,
-           CompareTranslation, LerpTranslation, translation_tolerance,
-           &_output->tracks[i].translations);
-    Filter(_input.tracks[i].rotations,
-           CompareRotation, LerpRotation, rotation_tolerance,
-           &_output->tracks[i].rotations);
-    Filter(_input.tracks[i].scales,
-           CompareScale, LerpScale, scale_tolerance,
-           &_output->tracks[i].scales);
+    const RawAnimation::JointTrack& src = _input.tracks[i];
+    Analysis::Track& dest = _analysis->tracks[i];
+    dest.translations.resize(src.translations.size());
+    dest.rotations.resize(src.rotations.size());
+    dest.scales.resize(src.scales.size());
+    buffers[i].Reserve(math::Max(
+      src.translations.size(),
+      math::Max(src.rotations.size(), src.scales.size())));
+  }
+
+  if (num_tracks) {
+    const size_t window =
+      reduction == kWindowed ? static_cast<size_t>(reduction_window) : 0;
+    const AnalyzeTask task(window, &buffers[0], _analysis);
+    tasks::Dispatcher* task_dispatcher =
+      dispatcher ? dispatcher : tasks::serial_dispatcher();
+    task_dispatcher->Dispatch(task, num_tracks);
+  }
+
+  return true;
+}
+
+bool AnimationOptimizer::operator()(const Analysis& _analysis,
+                                    RawAnimation* _output) const {
+  OZZ_PROFILE_SCOPE("AnimationOptimizer::operator()");
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  if (!_output) {
+    return false;
+  }
+  // Reset output animation to default.
+  *_output = RawAnimation();
+
+  // Validate analysis and report parameters.
+  if (!ValidateAnalysis(_analysis) ||
+      (report && report_sampling_rate <= 0.f)) {
+    return false;
+  }
+
+  // All tracks share the same local tolerances.
+  const Tolerances tolerances = {
+    translation_tolerance, rotation_tolerance, scale_tolerance};
+  const int num_tracks = _analysis.animation.num_tracks();
+  ozz::Vector<Tolerances>::Std track_tolerances(num_tracks, tolerances);
+
+  Extract(_analysis, num_tracks ? &track_tolerances[0] : NULL, _output);
+
+  if (report) {
+    ComputeReport(_analysis.animation, *_output, NULL, hierarchical_distance,
+                  report_sampling_rate, report);
+  }
+
+  return true;
+}
+
+bool AnimationOptimizer::operator()(const Analysis& _analysis,
+                                    const Skeleton& _skeleton,
+                                    RawAnimation* _output) const {
+  OZZ_PROFILE_SCOPE("AnimationOptimizer::operator()");
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  if (!_output) {
+    return false;
+  }
+  // Reset output animation to default.
+  *_output = RawAnimation();
+
+  // Validate analysis and report parameters, and skeleton compatibility.
+  if (!ValidateAnalysis(_analysis) ||
+      (report && report_sampling_rate <= 0.f) ||
+      _analysis.animation.num_tracks() != _skeleton.num_joints()) {
+    return false;
+  }
+
+  const int num_tracks = _analysis.animation.num_tracks();
+  ozz::Vector<Tolerances>::Std track_tolerances(num_tracks);
+  if (num_tracks) {
+    ComputeHierarchicalTolerances(_analysis.animation, _skeleton,
+                                  hierarchical_tolerance,
+                                  hierarchical_distance, &track_tolerances[0]);
+  }
+
+  Extract(_analysis, num_tracks ? &track_tolerances[0] : NULL, _output);
+
+  if (report) {
+    ComputeReport(_analysis.animation, *_output, &_skeleton,
+                  hierarchical_distance, report_sampling_rate, report);
   }
-  // Output animation is always valid.
-  assert(_output->Validate());
 
   return true;
 }
@@ -0,0 +1,222 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_page_builder.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Copies the keys of _keys that are required to sample [_begin,_end] range,
+// which is expressed in key time unit.
+// Keys of a track are stored in time order in _keys, even though they are
+// interleaved with other tracks keys. Output keys keep the same sorting as
+// the AnimationBuilder: the _num_constants keys of constant tracks first, then
+// two rows that store the first two keys of every other track, and the
+// remaining ones keep their original order.
+// The index in _keys of every page key is pushed back to _sources, which allows
+// to copy key tangents. Page keys are allocated with _allocator.
+template<typename _Key>
+ozz::Range<_Key> CopyPage(ozz::Range<const _Key> _keys,
+                          int _num_tracks,
+                          int _num_constants,
+                          float _begin,
+                          float _end,
+                          ozz::Vector<int>::Std* _sources,
+                          memory::Allocator* _allocator) {
+  const int count = static_cast<int>(_keys.Count());
+  if (!count) {
+    return ozz::Range<_Key>();
+  }
+  const int num_animated = _num_tracks - _num_constants;
+  assert(count >= _num_constants + num_animated * 2);
+
+  // Finds, for every track, the rank (index in the track) of the last key at
+  // or before _begin, and of the first key after _end. Constant tracks have
+  // no rank, as they are copied as is.
+  const int kNoRank = -1;
+  ozz::Vector<int>::Std ranks(count);
+  ozz::Vector<int>::Std counts(_num_tracks, 0);
+  ozz::Vector<int>::Std firsts(_num_tracks, 0);
+  ozz::Vector<int>::Std lasts(_num_tracks, kNoRank);
+  for (int i = _num_constants; i < count; ++i) {
+    const _Key& key = _keys.begin[i];
+    const int rank = counts[key.track]++;
+    ranks[i] = rank;
+    if (key.time <= _begin) {
+      firsts[key.track] = rank;
+    }
+    if (key.time > _end && lasts[key.track] == kNoRank) {
+      lasts[key.track] = rank;
+    }
+  }
+
+  // Every track needs at least two keys, so the first key can't be the last
+  // key of the track.
+  // slots: index of the track in the two first rows.
+  int page_count = _num_constants;
+  ozz::Vector<int>::Std slots(_num_tracks, 0);
+  for (int t = 0, slot = 0; t < _num_tracks; ++t) {
+    if (!counts[t]) {  // Constant track.
+      continue;
+    }
+    assert(counts[t] >= 2);
+    slots[t] = slot++;
+    firsts[t] = math::Min(firsts[t], counts[t] - 2);
+    if (lasts[t] == kNoRank) {
+      lasts[t] = counts[t] - 1;
+    }
+    lasts[t] = math::Max(lasts[t], firsts[t] + 1);
+    page_count += lasts[t] - firsts[t] + 1;
+  }
+
+  // Copies keys.
+  ozz::Range<_Key> page = _allocator->AllocateRange<_Key>(page_count);
+  _Key* rows = page.begin + _num_constants;
+  _Key* cursor = rows + num_animated * 2;
+  const size_t sources_offset = _sources->size();
+  _sources->resize(sources_offset + page_count);
+  int* sources = &(*_sources)[sources_offset];
+  for (int i = 0; i < _num_constants; ++i) {
+    page.begin[i] = _keys.begin[i];
+    sources[i] = i;
+  }
+  for (int i = _num_constants; i < count; ++i) {
+    const _Key& key = _keys.begin[i];
+    const int rank = ranks[i];
+    _Key* dest = NULL;
+    if (rank == firsts[key.track]) {
+      dest = &rows[slots[key.track]];
+    } else if (rank == firsts[key.track] + 1) {
+      dest = &rows[num_animated + slots[key.track]];
+    } else if (rank > firsts[key.track] && rank <= lasts[key.track]) {
+      dest = cursor++;
+    } else {
+      continue;
+    }
+    *dest = key;
+    sources[dest - page.begin] = i;
+  }
+  assert(cursor == page.end);
+  return page;
+}
+}  // namespace
+
+Animation* AnimationPageBuilder::operator()(const Animation& _animation,
+                                            float _begin,
+                                            float _end) const {
+  // Pages are runtime animations, even if they are built by this class.
+  memory::ScopedTag tag(memory::kTagAnimation);
+
+  // Tests range validity.
+  if (!(_begin >= 0.f && _begin <= _end && _end <= _animation.duration())) {
+    return NULL;
+  }
+
+  Animation* page = memory::default_allocator()->New<Animation>();
+  page->duration_ = _animation.duration_;
+  page->num_tracks_ = _animation.num_tracks_;
+  page->num_constant_translations_ = _animation.num_constant_translations_;
+  page->num_constant_rotations_ = _animation.num_constant_rotations_;
+  page->num_constant_scales_ = _animation.num_constant_scales_;
+  page->scaled_ = _animation.scaled_;
+  page->uniformly_scaled_ = _animation.uniformly_scaled_;
+
+  // Translation ranges are per track, so every page copies all of them.
+  page->translation_ranges_ =
+    page->allocator_->AllocateRange<SoaTranslationRange>(
+      _animation.translation_ranges_.Count());
+  std::memcpy(page->translation_ranges_.begin,
+              _animation.translation_ranges_.begin,
+              _animation.translation_ranges_.Size());
+
+  // Copies keys, including soa padding tracks. Range is converted to key time
+  // unit, the same way the SamplingJob does.
+  const int num_tracks = _animation.num_soa_tracks() * 4;
+  const float begin = ToKeyTime(_begin, _animation.duration_);
+  const float end = ToKeyTime(_end, _animation.duration_);
+  ozz::Vector<int>::Std translation_sources;
+  page->translations_ =
+    CopyPage(_animation.translations(), num_tracks,
+             _animation.num_constant_translations_, begin, end,
+             &translation_sources, page->allocator_);
+  ozz::Vector<int>::Std rotation_sources;
+  page->rotations_ =
+    CopyPage(_animation.rotations(), num_tracks,
+             _animation.num_constant_rotations_, begin, end,
+             &rotation_sources, page->allocator_);
+  ozz::Vector<int>::Std scale_sources;
+  page->scales_ =
+    CopyPage(_animation.scales(), num_tracks,
+             _animation.num_constant_scales_, begin, end,
+             &scale_sources, page->allocator_);
+
+  // Copies the tangents of the page keys, which are stored in the same order
+  // as the keys, for translations, rotations and then scales.
+  if (_animation.hermite()) {
+    const ozz::Vector<int>::Std* const sources[] = {
+      &translation_sources, &rotation_sources, &scale_sources};
+    const int offsets[] = {
+      0,
+      static_cast<int>(_animation.translations_.Count()),
+      static_cast<int>(_animation.translations_.Count() +
+                       _animation.rotations_.Count())};
+    page->tangents_ =
+      page->allocator_->AllocateRange<KeyTangent>(
+        translation_sources.size() + rotation_sources.size() +
+        scale_sources.size());
+    KeyTangent* tangent = page->tangents_.begin;
+    for (size_t s = 0; s < OZZ_ARRAY_SIZE(sources); ++s) {
+      for (size_t i = 0; i < sources[s]->size(); ++i) {
+        *tangent++ = _animation.tangents_.begin[offsets[s] + (*sources[s])[i]];
+      }
+    }
+    assert(tangent == page->tangents_.end);
+  }
+
+  return page;
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,129 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/clip_group_builder.h"
+
+#include <cstddef>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+// Copies _src keys to _dest, normalizing their time with _inv_duration.
+template<typename _Keys>
+void NormalizeKeys(const _Keys& _src, float _inv_duration, _Keys* _dest) {
+  *_dest = _src;
+  for (size_t i = 0; i < _dest->size(); ++i) {
+    (*_dest)[i].time *= _inv_duration;
+  }
+}
+
+// Copies _src tangents to _dest, converting them from per second to per
+// normalized time unit.
+template<typename _Tangents>
+void NormalizeTangents(const _Tangents& _src, float _duration,
+                       _Tangents* _dest) {
+  *_dest = _src;
+  for (size_t i = 0; i < _dest->size(); ++i) {
+    (*_dest)[i] = (*_dest)[i] * _duration;
+  }
+}
+}  // namespace
+
+ClipGroupBuilder::ClipGroupBuilder()
+    : dispatcher(NULL),
+      seek_interval(0.f),
+      key_links(false) {
+}
+
+Animation* ClipGroupBuilder::operator()(
+  const ozz::Range<const RawAnimation* const>& _clips) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+  if (!_clips.begin || _clips.end <= _clips.begin) {
+    return NULL;
+  }
+  const int num_clips = static_cast<int>(_clips.end - _clips.begin);
+
+  // Validates clips, which must all match the first one.
+  const RawAnimation* first = _clips.begin[0];
+  if (!first) {
+    return NULL;
+  }
+  for (int i = 0; i < num_clips; ++i) {
+    const RawAnimation* clip = _clips.begin[i];
+    if (!clip || !clip->Validate() ||
+        clip->num_tracks() != first->num_tracks() ||
+        clip->interpolation != first->interpolation) {
+      return NULL;
+    }
+  }
+
+  // Appends normalized clip tracks, padded to a multiple of 4 tracks. Padding
+  // tracks have no key, so they are identity tracks.
+  const int num_padded_tracks = math::Align(first->num_tracks(), 4);
+  RawAnimation group;
+  group.duration = 1.f;
+  group.interpolation = first->interpolation;
+  group.tracks.resize(num_padded_tracks * num_clips);
+  for (int i = 0; i < num_clips; ++i) {
+    const RawAnimation& clip = *_clips.begin[i];
+    const float inv_duration = 1.f / clip.duration;
+    for (int j = 0; j < clip.num_tracks(); ++j) {
+      const RawAnimation::JointTrack& src = clip.tracks[j];
+      RawAnimation::JointTrack& dest =
+        group.tracks[i * num_padded_tracks + j];
+      NormalizeKeys(src.translations, inv_duration, &dest.translations);
+      NormalizeKeys(src.rotations, inv_duration, &dest.rotations);
+      NormalizeKeys(src.scales, inv_duration, &dest.scales);
+      NormalizeTangents(src.translation_tangents, clip.duration,
+                        &dest.translation_tangents);
+      NormalizeTangents(src.rotation_tangents, clip.duration,
+                        &dest.rotation_tangents);
+      NormalizeTangents(src.scale_tangents, clip.duration,
+                        &dest.scale_tangents);
+    }
+  }
+
+  // Builds the group, which fails if it has too many tracks.
+  AnimationBuilder builder;
+  builder.dispatcher = dispatcher;
+  builder.seek_interval = seek_interval;
+  builder.key_links = key_links;
+  return builder(group);
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -40,6 +40,7 @@
 
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/io/stream.h"
+#include "ozz/base/profile.h"
 
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/offline/raw_animation.h"
@@ -47,6 +48,7 @@
 
 #include "animation/offline/collada/collada_skeleton.h"
 #include "animation/offline/collada/collada_animation.h"
+#include "animation/offline/collada/collada_stream.h"
 
 namespace ozz {
 namespace animation {
@@ -54,50 +56,52 @@ namespace offline {
 namespace collada {
 
 namespace {
-
-// Load _filename to memory as a string. Return a valid pointer if read was
-// successful, or NULL otherwise. The caller is responsible for deleting the
-// return string using default_allocator().Deallocate() function.
-char* LoadFileToString(const char* _filename) {
+// Opens _filename Collada document, and streams its content to _visitors.
+bool StreamFile(const char* _filename,
+                TiXmlDocument* _doc,
+                TiXmlVisitor** _visitors,
+                int _num_visitors) {
   if (!_filename) {
-    return NULL;
+    return false;
   }
   log::Log() << "Reads Collada document " << _filename << "." << std::endl;
-  // Loads file to memory.
-  char* content = NULL;
   io::File file(_filename, "rb");
-  if (file.opened()) {
-    // Gets file size.
-    file.Seek(0, io::Stream::kEnd);
-    size_t file_length = file.Tell();
-    file.Seek(0, io::Stream::kSet);
-
-    // Allocates and read file.
-    content = memory::default_allocator()->Allocate<char>(file_length + 1);
-    content[file_length] = '\0';
-    if (file.Read(content, file_length) != file_length) {
-      log::Err() << "Failed to read file " << _filename << "." << std::endl;
-      memory::default_allocator()->Deallocate(content);
-      content = NULL;
-    }
-  } else {
+  if (!file.opened()) {
     log::Err() << "Failed to open file " << _filename << "." << std::endl;
+    return false;
   }
-  return content;
+  return StreamDocument(&file, _doc, _visitors, _num_visitors);
 }
 }  // namespace
 
 bool ImportFromFile(const char* _filename, RawSkeleton* _skeleton) {
-  char* xml = LoadFileToString(_filename);
+  OZZ_PROFILE_SCOPE("collada::ImportSkeleton");
+  if (!_skeleton) {
+    return false;
+  }
+  // Reset skeleton.
+  *_skeleton = RawSkeleton();
 
-  // Import xml from memory even if load from file has failed. ImportFromMemory
-  // supports NULL argument and will fill output.
-  bool success = ImportFromMemory(xml, _skeleton);
-  memory::default_allocator()->Deallocate(xml);
-  return success;
+  // Streams the document, so that it's never loaded in memory as a whole.
+  // Document nodes are referenced by the visitor, so it must outlive it.
+  TiXmlDocument doc;
+  SkeletonVisitor skeleton_visitor;
+  TiXmlVisitor* visitors[] = {&skeleton_visitor};
+  if (!StreamFile(_filename, &doc, visitors, OZZ_ARRAY_SIZE(visitors))) {
+    log::Err() << "Collada skeleton parsing failed." << std::endl;
+    return false;
+  }
+
+  if (!ExtractSkeleton(skeleton_visitor, _skeleton)) {
+    log::Err() << "Collada skeleton extraction failed." << std::endl;
+    return false;
+  }
+
+  return true;
 }
 
 bool ParseDocument(TiXmlDocument* _doc, const char* _xml) {
+  OZZ_PROFILE_SCOPE("collada::ParseDocument");
   if (!_doc || !_xml) {
     return false;
   }
@@ -119,6 +123,7 @@ bool ParseDocument(TiXmlDocument* _doc, const char* _xml) {
 }
 
 bool ImportFromMemory(const char* _xml, RawSkeleton* _skeleton) {
+  OZZ_PROFILE_SCOPE("collada::ImportSkeleton");
   if (!_skeleton) {
     return false;
   }
@@ -147,22 +152,48 @@ bool ImportFromMemory(const char* _xml, RawSkeleton* _skeleton) {
 
 bool ImportFromFile(const char* _filename,
                     const Skeleton& _skeleton,
-                    float _sampling_rate,
-                    RawAnimation* _animation) {
-  char* xml = LoadFileToString(_filename);
-
-  // Import xml from memory even if load from file has failed. ImportFromMemory
-  // supports NULL argument and will fill output.
-  bool success = ImportFromMemory(xml, _skeleton, _sampling_rate, _animation);
-  memory::default_allocator()->Deallocate(xml);
-  return success;
+                    const JointTrackSampler& _sampler,
+                    RawAnimation* _animation,
+                    tasks::Dispatcher* _dispatcher) {
+  OZZ_PROFILE_SCOPE("collada::ImportAnimation");
+
+  if (!_animation) {
+    return false;
+  }
+  // Reset animation.
+  *_animation = RawAnimation();
+
+  // Streams the document once, extracting skeletons and animations at the
+  // same time.
+  TiXmlDocument doc;
+  SkeletonVisitor skeleton_visitor;
+  AnimationVisitor animation_visitor;
+  TiXmlVisitor* visitors[] = {&skeleton_visitor, &animation_visitor};
+  if (!StreamFile(_filename, &doc, visitors, OZZ_ARRAY_SIZE(visitors))) {
+    log::Err() << "Collada animation import failed." << std::endl;
+    return false;
+  }
+
+  // Allocates RawAnimation.
+  if (!ExtractAnimation(animation_visitor,
+                        skeleton_visitor,
+                        _skeleton,
+                        _sampler,
+                        _dispatcher,
+                        _animation)) {
+    log::Err() << "Collada animation extraction failed." << std::endl;
+    return false;
+  }
+
+  return true;
 }
 
 bool ImportFromMemory(const char* _xml,
                       const Skeleton& _skeleton,
-                      float _sampling_rate,
-                      RawAnimation* _animation) {
-  (void)_sampling_rate;
+                      const JointTrackSampler& _sampler,
+                      RawAnimation* _animation,
+                      tasks::Dispatcher* _dispatcher) {
+  OZZ_PROFILE_SCOPE("collada::ImportAnimation");
   
   if (!_animation) {
     return false;
@@ -194,6 +225,8 @@ bool ImportFromMemory(const char* _xml,
   if (!ExtractAnimation(animation_visitor,
                         skeleton_visitor,
                         _skeleton,
+                        _sampler,
+                        _dispatcher,
                         _animation)) {
     log::Err() << "Collada animation extraction failed." << std::endl;
     return false;
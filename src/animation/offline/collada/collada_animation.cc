@@ -36,8 +36,13 @@
 #include <cstring>
 #include <limits>
 
+#include "ozz/base/containers/flat_map.h"
+#include "ozz/base/containers/small_vector.h"
 #include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/tasks/task_dispatcher.h"
 
+#include "ozz/animation/offline/joint_track_sampler.h"
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
@@ -245,24 +250,24 @@ bool AnimationVisitor::HandleFloatArray(const TiXmlElement& _element) {
 
   // The number of values in the array. Required.
   int num_elements;
-  if (!_element.Attribute("count", &num_elements)) {
+  if (!_element.Attribute("count", &num_elements) || num_elements < 0) {
     log::Err() << "Failed to find float_array element count." << std::endl;
     set_error();
     return false;
   }
 
-  source.values.reserve(num_elements);
+  // Parses values directly to the array, allocated once from the count. The
+  // array must contain exactly count values.
+  source.values.resize(num_elements);
   const char* text = _element.GetText();
-  if (text) {
-    char* end;
-    for (double double_value = strtod(text, &end);
-         text != end;
-         double_value = strtod(text, &end)) {
-      source.values.push_back(static_cast<float>(double_value));
-      text = end;
-    }
+  size_t num_parsed = 0;
+  if (text && num_elements) {
+    num_parsed = internal::ParseFloats(
+      text, &source.values[0], source.values.size(), &text);
   }
-  if (source.values.size() != static_cast<size_t>(num_elements)) {
+  float extra;
+  if (num_parsed != source.values.size() ||
+      (text && internal::ParseFloat(text, &extra))) {
     log::Err() << "Failed to read all float_array values." << std::endl;
     set_error();
     return false;
@@ -487,20 +492,16 @@ bool AnimationVisitor::HandleChannel(const TiXmlElement& _element) {
 
 namespace {
 
-typedef ozz::CStringMap<const ColladaJoint*>::Std
-  JointsByName;
+typedef ozz::CStringFlatMap<const ColladaJoint*>::Type JointsByName;
 
 bool MapJointsByName(const ColladaJoint& _src, JointsByName* _joints) {
-  // Detects non unique names
-  if (_joints->count(_src.name.c_str())) {
+  // Maps this joint, detecting non unique names.
+  if (!_joints->insert(std::make_pair(_src.name.c_str(), &_src)).second) {
     log::Err() << "Multiple joints with the same name \"" << _src.name <<
       "\" found." << std::endl;
     return false;
   }
 
-  // This name is unique, maps it.
-  (*_joints)[_src.name.c_str()] = &_src;
-
   // Now maps children.
   for (size_t i = 0; i < _src.children.size(); ++i) {
     if (!MapJointsByName(_src.children[i], _joints)) {
@@ -521,7 +522,9 @@ struct Sampler {
   const AnimationVisitor::FloatSource* in_tangent;
   const AnimationVisitor::FloatSource* out_tangent;
 };
-typedef ozz::Vector<Sampler>::Std Samplers;
+// A joint is rarely animated by more than a few samplers, which are stored in
+// place to avoid allocating for each track.
+typedef ozz::SmallVector<Sampler, 4> Samplers;
 
 struct Track {
   const ColladaJoint* joint;
@@ -686,11 +689,6 @@ bool FindSampleKeysUnion(const Samplers& _samplers,
         return false;
       }
       _times->push_back(v_value);
-      static bool b = true;
-      if (b && v_value > 0.03f && v_value < 0.07f) {
-        _times->push_back(v_value + 0.01f);
-        b = false;
-      }
       // Output keys should be ordered.
       assert(_times->size() < 2 ||
              (*_times)[_times->size() - 2] < _times->back());
@@ -1077,11 +1075,197 @@ void PushKeys(const math::Transform& _transform, float _time,
     }
   }
 }
+
+// Evaluates all _track samplers at _time, from _caches, and concatenates them
+// to _transform, converted to ozz system coordinates. _transforms is a scratch
+// buffer, declared by the caller to avoid vector reallocations.
+bool EvaluateTrack(const AnimationVisitor& _animation_visitor,
+                   const Track& _track, float _time, Caches* _caches,
+                   ozz::Vector<NodeTransform>::Std* _transforms,
+                   math::Transform* _transform, bool* _subsample) {
+  *_subsample = false;
+
+  // Uses a local copy of joint NodeTransform's in order to keep joint
+  // unchanged.
+  *_transforms = _track.joint->transforms;
+  for (size_t k = 0; k < _track.samplers.size(); ++k) {
+    const Sampler& sampler = _track.samplers[k];
+    bool subsample;
+    if (!Evaluate(sampler, _time, &(*_caches)[k],
+                  &(*_transforms)[sampler.transform], &subsample)) {
+      return false;
+    }
+    *_subsample |= subsample;
+  }
+
+  // Concatenates all transforms.
+  TransformBuilder builder;
+  for (size_t t = 0; t < _transforms->size(); ++t) {
+    if (!(*_transforms)[t].Build(&builder)) {
+      return false;
+    }
+  }
+
+  if (!builder.GetAsTransform(_transform)) {
+    log::Err() << "Failed to build affine tranformation for joint \"" <<
+      _track.joint->name << "\" at t=" << _time << "." << std::endl;
+    return false;
+  }
+  // Convert to ozz y_up/meter system coordinate.
+  *_transform = _animation_visitor.asset().ConvertTransform(*_transform);
+  return true;
+}
+
+// Evaluates a track between two of its keys, for JointTrackSampler. Caches are
+// copied for every evaluation, as times aren't evaluated in order.
+class TrackFunction : public JointTrackSampler::Function {
+ public:
+  TrackFunction(const AnimationVisitor& _animation_visitor,
+                const Track& _track, const Caches& _caches) :
+    animation_visitor_(_animation_visitor),
+    track_(_track),
+    caches_(_caches) {
+  }
+
+  virtual bool Evaluate(float _time, math::Transform* _transform) const {
+    scratch_caches_ = caches_;
+    bool subsample;
+    return EvaluateTrack(animation_visitor_, track_, _time, &scratch_caches_,
+                         &transforms_, _transform, &subsample);
+  }
+
+ private:
+  const AnimationVisitor& animation_visitor_;
+  const Track& track_;
+  const Caches& caches_;
+  mutable Caches scratch_caches_;
+  mutable ozz::Vector<NodeTransform>::Std transforms_;
+};
+
+// Bakes _track samplers to _output track, for joint _joint of _skeleton.
+// Keys that require subsampling, ie non-linear interpolations, are sampled
+// with _sampler until the next key.
+bool BakeTrack(const AnimationVisitor& _animation_visitor,
+               const Skeleton& _skeleton, int _joint, const Track& _track,
+               const JointTrackSampler& _sampler,
+               float _start_time, float _end_time,
+               RawAnimation::JointTrack* _output) {
+  // Get the union of all the key-frame's time.
+  ozz::Vector<float>::Std times;
+  if (!FindSampleKeysUnion(_track.samplers, &times, _start_time, _end_time)) {
+    return false;
+  }
+
+  // Evaluates all samplers for all sampler keys.
+  RawAnimation::JointTrack& output_track = *_output;
+  if (!_track.joint || _track.samplers.empty() || times.empty()) {
+    ozz::log::Err() << "No animation track found for joint \"" <<
+      _skeleton.joint_names()[_joint] <<
+      "\". Using skeleton bind-pose instead" << std::endl;
+
+    // Get joint's bind pose.
+    const ozz::math::Transform& bind_pose =
+      ozz::animation::GetJointBindPose(_skeleton, _joint);
+
+    PushKeys(bind_pose, 0.f, &output_track);
+    return true;
+  }
+
+  // Uses animated transformations.
+  // Declares containers outside of the loop to avoid vector reallocation.
+  ozz::Vector<NodeTransform>::Std transforms;
+  RawAnimation::JointTrack subsamples;
+
+  // Initializes sampling evaluation chache.
+  Caches caches;
+  if (!SetupCaches(_track.samplers, &caches)) {
+    return false;
+  }
+
+  for (size_t j = 0; j < times.size(); ++j) {  // For all the key-frames.
+    const float time = times[j];
+
+    // Does evaluation requires to subsample between keys? This is the case
+    // for all non-linear interpolations.
+    math::Transform transform;
+    bool subsample;
+    if (!EvaluateTrack(_animation_visitor, _track, time, &caches, &transforms,
+                       &transform, &subsample)) {
+      return false;
+    }
+
+    // Shift all keys such that the first key is a t = 0.
+    assert(time - _start_time >= 0.f);
+
+    if (!subsample || j == times.size() - 1) {
+      // Adds this key-frame to the current track.
+      PushKeys(transform, time - _start_time, &output_track);
+      continue;
+    }
+
+    // Subsamples until next key-frame, which is excluded as it's pushed by the
+    // next iteration.
+    subsamples.translations.clear();
+    subsamples.rotations.clear();
+    subsamples.scales.clear();
+    const TrackFunction function(_animation_visitor, _track, caches);
+    if (!_sampler(function, time, times[j + 1], &subsamples)) {
+      return false;
+    }
+    for (size_t k = 0; k < subsamples.translations.size() - 1; ++k) {
+      const math::Transform key = {subsamples.translations[k].value,
+                                   subsamples.rotations[k].value,
+                                   subsamples.scales[k].value};
+      PushKeys(key, subsamples.translations[k].time - _start_time,
+               &output_track);
+    }
+  }
+  return true;
+}
+
+// Bakes a track per work item. Tracks only share read-only parsed data, and
+// each one outputs to its own JointTrack and success flag.
+class BakeTask : public tasks::Task {
+ public:
+  BakeTask(const AnimationVisitor& _animation_visitor,
+           const Skeleton& _skeleton, const Tracks& _tracks,
+           const JointTrackSampler& _sampler,
+           float _start_time, float _end_time,
+           RawAnimation* _animation, bool* _success) :
+    animation_visitor_(_animation_visitor),
+    skeleton_(_skeleton),
+    tracks_(_tracks),
+    sampler_(_sampler),
+    start_time_(_start_time),
+    end_time_(_end_time),
+    animation_(_animation),
+    success_(_success) {
+  }
+
+  virtual void Run(int _index) const {
+    success_[_index] = BakeTrack(animation_visitor_, skeleton_, _index,
+                                 tracks_[_index], sampler_,
+                                 start_time_, end_time_,
+                                 &animation_->tracks[_index]);
+  }
+
+ private:
+  const AnimationVisitor& animation_visitor_;
+  const Skeleton& skeleton_;
+  const Tracks& tracks_;
+  const JointTrackSampler& sampler_;
+  float start_time_;
+  float end_time_;
+  RawAnimation* animation_;
+  bool* success_;
+};
 }  // namespace
 
 bool ExtractAnimation(const AnimationVisitor& _animation_visitor,
                       const SkeletonVisitor& _skeleton_visitor,
                       const Skeleton& _skeleton,
+                      const JointTrackSampler& _sampler,
+                      tasks::Dispatcher* _dispatcher,
                       RawAnimation* _animation) {
   // Build a joint-name mapping
   JointsByName joints;
@@ -1133,92 +1317,26 @@ bool ExtractAnimation(const AnimationVisitor& _animation_visitor,
     _animation->duration = end_time - start_time;
   }
 
-  // Fills animation tracks.
-  _animation->tracks.resize(_skeleton.num_joints());
-  for (int i = 0; i < _skeleton.num_joints(); ++i) {
-    const Track& track = tracks[i];
-
-    // Get the union of all the key-frame's time.
-    ozz::Vector<float>::Std times;
-    if (!FindSampleKeysUnion(track.samplers, &times, start_time, end_time)) {
-      return false;
-    }
-
-    // Evaluates all samplers for all sampler keys.
-    RawAnimation::JointTrack& output_track = _animation->tracks[i];
-    if (!track.joint || track.samplers.empty() || times.empty()) {
-      ozz::log::Err() << "No animation track found for joint \"" <<
-        _skeleton.joint_names()[i] << "\". Using skeleton bind-pose instead" <<
-        std::endl;
-      
-      // Get joint's bind pose.
-      const ozz::math::Transform& bind_pose =
-        ozz::animation::GetJointBindPose(_skeleton, i);
-
-      PushKeys(bind_pose, 0.f, &output_track);
-    } else {  // Uses animated transformations.
-      // Uses a local copy of joint NodeTransform's in order to keep joint
-      // unchanged. Declares transforms container outside of the loop to avoid
-      // vector reallocation.
-      ozz::Vector<NodeTransform>::Std transforms;
-
-      // Initializes sampling evaluation chache.
-      Caches caches;
-      if (!SetupCaches(track.samplers, &caches)) {
-        return false;
-      }
-
-      for (size_t j = 0; j < times.size(); ++j) {  // For all the key-frames.
-        float time = times[j];
-
-        // Does evaluation requires to subsample between keys? This is the case
-        // for all non-linear interpolations.
-        bool subsample;
-        do {  // Subsampling loop.
-          subsample = false;
-
-          transforms = track.joint->transforms;  // Reset output transforms.
-          for (size_t k = 0; k < track.samplers.size(); ++k) {
-            const Sampler& sampler = track.samplers[k];
-            if (!Evaluate(sampler, time, &caches[k],
-                          &transforms[sampler.transform], &subsample)) {
-              return false;
-            }
-          }
-
-          // Concatenates all transforms.
-          TransformBuilder builder;
-          for (size_t t = 0; t < transforms.size(); ++t) {
-            if (!transforms[t].Build(&builder)) {
-              return false;
-            }
-          }
-
-          // Push key to animation track.
-          math::Transform transform;
-          if (!builder.GetAsTransform(&transform)) {
-            log::Err() << "Failed to build affine tranformation for joint \"" <<
-              track.joint->name << "\" at t=" << time << "." << std::endl;
-            return false;
-          }
-          // Convert to ozz y_up/meter system coordinate.
-          transform = _animation_visitor.asset().ConvertTransform(transform);
-
-          // Shift all keys such that the first key is a t = 0.
-          const float key_time = time - start_time;
-          assert(key_time >= 0.f);
-
-          // Adds those key-frames to the current track.
-          PushKeys(transform, key_time, &output_track);
-
-          // Subsample while next key-frame is not reached.
-          const float subsampling_rate = 1.f / 30.f;
-          time += subsampling_rate;
-        } while (subsample && j != times.size() - 1 && time < times[j + 1]);
-      }
-    }
+  // Fills animation tracks, baking every track in its own work item.
+  const int num_tracks = _skeleton.num_joints();
+  _animation->tracks.resize(num_tracks);
+  if (num_tracks == 0) {
+    return true;
   }
-  return true;
+  memory::Allocator* allocator = memory::default_allocator();
+  bool* success = allocator->Allocate<bool>(num_tracks);
+  const BakeTask task(_animation_visitor, _skeleton, tracks, _sampler,
+                      start_time, end_time, _animation, success);
+  tasks::Dispatcher* task_dispatcher =
+    _dispatcher ? _dispatcher : tasks::serial_dispatcher();
+  task_dispatcher->Dispatch(task, num_tracks);
+
+  bool baked = true;
+  for (int i = 0; i < num_tracks; ++i) {
+    baked &= success[i];
+  }
+  allocator->Deallocate(success);
+  return baked;
 }
 }  // collada
 }  // ozz
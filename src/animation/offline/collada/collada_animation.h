@@ -44,21 +44,29 @@
 #include "ozz/base/containers/vector.h"
 
 namespace ozz {
+namespace tasks {
+class Dispatcher;
+}  // tasks
 namespace animation {
 // Forward declares the runtime skeleton.
 class Skeleton;
 namespace offline {
 struct RawAnimation;
+class JointTrackSampler;
 namespace collada {
 // Forward declares Collada visitors.
 class AnimationVisitor;
 class SkeletonVisitor;
 
 // Extracts all animation tracks of _skeleton that were found in the Collada
-// document (_animation_visitor + _skeleton_visitor).
+// document (_animation_visitor + _skeleton_visitor). Non-linear interpolations
+// are sampled with _sampler. Tracks are baked concurrently using _dispatcher,
+// or sequentially if _dispatcher is NULL.
 bool ExtractAnimation(const AnimationVisitor& _animation_visitor,
                       const SkeletonVisitor& _skeleton_visitor,
                       const Skeleton& _skeleton,
+                      const JointTrackSampler& _sampler,
+                      tasks::Dispatcher* _dispatcher,
                       RawAnimation* _animation);
 
 // Collada xml document traverser, aiming to build extract anim ation channels.
@@ -33,6 +33,7 @@
 #include "animation/offline/collada/collada_base.h"
 
 #include <cstring>
+#include <limits>
 
 #include "ozz/base/log.h"
 
@@ -50,6 +51,137 @@ bool str_less::operator()(const char* const& _left,
                           const char* const& _right) const {
   return strcmp(_left, _right) < 0;
 }
+
+namespace {
+// Powers of 10 that are exactly representable in double precision, which
+// makes the conversion correctly rounded when the mantissa fits 53 bits.
+const double kPow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+  1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+const int kMaxPow10 = OZZ_ARRAY_SIZE(kPow10) - 1;
+
+// Maximum number of significant digits accumulated in the 64 bits mantissa.
+const int kMaxDigits = 19;
+
+inline bool IsDigit(char _c) {
+  return static_cast<unsigned char>(_c - '0') < 10;
+}
+
+inline bool IsSpace(char _c) {
+  return _c == ' ' || _c == '\t' || _c == '\n' || _c == '\r';
+}
+
+// Compares _text to lower case _word, ignoring _text case.
+bool MatchNoCase(const char* _text, const char* _word) {
+  for (; *_word; ++_text, ++_word) {
+    if ((*_text | 0x20) != *_word) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+const char* ParseFloat(const char* _text, float* _value) {
+  const char* c = _text;
+  while (IsSpace(*c)) {
+    ++c;
+  }
+  const bool negative = *c == '-';
+  if (*c == '-' || *c == '+') {
+    ++c;
+  }
+
+  // Special values.
+  if (MatchNoCase(c, "inf")) {
+    const float inf = std::numeric_limits<float>::infinity();
+    *_value = negative ? -inf : inf;
+    return c + (MatchNoCase(c, "infinity") ? 8 : 3);
+  } else if (MatchNoCase(c, "nan")) {
+    *_value = std::numeric_limits<float>::quiet_NaN();
+    return c + 3;
+  }
+
+  // Accumulates significant digits to the mantissa, and tracks the decimal
+  // exponent of the last accumulated digit.
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any = false;
+  for (; IsDigit(*c); ++c) {
+    any = true;
+    if (digits < kMaxDigits) {
+      mantissa = mantissa * 10 + static_cast<unsigned int>(*c - '0');
+      digits += mantissa != 0;
+    } else {
+      ++exponent;
+    }
+  }
+  if (*c == '.') {
+    ++c;
+    for (; IsDigit(*c); ++c) {
+      any = true;
+      if (digits < kMaxDigits) {
+        mantissa = mantissa * 10 + static_cast<unsigned int>(*c - '0');
+        digits += mantissa != 0;
+        --exponent;
+      }
+    }
+  }
+  if (!any) {
+    return NULL;
+  }
+
+  // Exponent is only consumed if it's valid.
+  if (*c == 'e' || *c == 'E') {
+    const char* e = c + 1;
+    const bool negative_exponent = *e == '-';
+    if (*e == '-' || *e == '+') {
+      ++e;
+    }
+    if (IsDigit(*e)) {
+      int value = 0;
+      for (; IsDigit(*e); ++e) {
+        if (value < 10000) {
+          value = value * 10 + (*e - '0');
+        }
+      }
+      exponent += negative_exponent ? -value : value;
+      c = e;
+    }
+  }
+
+  // Scales the mantissa by 10^exponent, in exact steps when possible.
+  double value = static_cast<double>(mantissa);
+  if (mantissa != 0) {
+    for (; exponent > kMaxPow10; exponent -= kMaxPow10) {
+      value *= kPow10[kMaxPow10];
+    }
+    for (; exponent < -kMaxPow10; exponent += kMaxPow10) {
+      value /= kPow10[kMaxPow10];
+    }
+    value = exponent >= 0 ?
+      value * kPow10[exponent] : value / kPow10[-exponent];
+  }
+  *_value = static_cast<float>(negative ? -value : value);
+  return c;
+}
+
+size_t ParseFloats(const char* _text,
+                   float* _values,
+                   size_t _count,
+                   const char** _end) {
+  size_t i = 0;
+  for (; i < _count; ++i) {
+    const char* next = ParseFloat(_text, &_values[i]);
+    if (!next) {
+      break;
+    }
+    _text = next;
+  }
+  *_end = _text;
+  return i;
+}
 }  // internal
 
 ColladaAsset::ColladaAsset()
@@ -52,6 +52,23 @@ namespace internal {
 struct str_less {
   bool operator()(const char* const& _left, const char* const& _right) const;
 };
+
+// Parses a floating point value from _text, after skipping leading white
+// spaces. Parsing is locale independent, and supports xml schema double
+// values: optional sign, digits with an optional '.', optional exponent, and
+// INF or NaN.
+// Returns a pointer to the first character following the value, or NULL if no
+// value could be parsed.
+const char* ParseFloat(const char* _text, float* _value);
+
+// Parses up to _count white space separated floating point values from _text
+// to _values, see ParseFloat. _end is set to the first character following the
+// last parsed value.
+// Returns the number of values parsed.
+size_t ParseFloats(const char* _text,
+                   float* _values,
+                   size_t _count,
+                   const char** _end);
 }  // internal
 
 // Extract Collada <asset> element.
@@ -0,0 +1,572 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+
+#include "animation/offline/collada/collada_stream.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace collada {
+
+namespace {
+
+// Tells whether _name element handlers read element content (text or child
+// elements) when the element is entered, in which case the element must be
+// completely read before being visited.
+bool IsContentElement(const char* _name) {
+  const char* elements[] = {
+    "float_array", "Name_array", "accessor",  // AnimationVisitor.
+    "matrix", "rotate", "scale", "translate", "lookat", "skew",  // Transforms.
+    "up_axis"};  // BaseVisitor.
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(elements); ++i) {
+    if (std::strcmp(_name, elements[i]) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsSpace(int _c) {
+  return _c == ' ' || _c == '\t' || _c == '\n' || _c == '\r';
+}
+
+// Reads a stream by chunks, and counts lines for error reporting.
+class Reader {
+ public:
+  explicit Reader(io::Stream* _stream)
+    : stream_(_stream),
+      buffer_(memory::default_allocator()->Allocate<char>(kBufferSize)),
+      begin_(buffer_),
+      end_(buffer_),
+      line_(1) {
+  }
+
+  ~Reader() {
+    memory::default_allocator()->Deallocate(buffer_);
+  }
+
+  // Returns the next character without consuming it, or -1 at the end of the
+  // stream.
+  int Peek() {
+    if (begin_ == end_) {
+      const size_t read = stream_->Read(buffer_, kBufferSize);
+      begin_ = buffer_;
+      end_ = buffer_ + read;
+      if (read == 0) {
+        return -1;
+      }
+    }
+    return static_cast<unsigned char>(*begin_);
+  }
+
+  // Consumes and returns the next character, or -1 at the end of the stream.
+  int Get() {
+    const int c = Peek();
+    if (c >= 0) {
+      ++begin_;
+      line_ += c == '\n';
+    }
+    return c;
+  }
+
+  // Consumes _str characters, and returns false if they don't match.
+  bool Expect(const char* _str) {
+    for (; *_str; ++_str) {
+      if (Get() != static_cast<unsigned char>(*_str)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Consumes characters until _terminator sequence is found, which is
+  // consumed too. Consumed characters are appended to _text if it isn't NULL.
+  // Returns false if the end of the stream is reached first.
+  bool SkipUntil(const char* _terminator, ozz::String::Std* _text) {
+    const size_t len = std::strlen(_terminator);
+    ozz::String::Std tail;
+    for (int c = Get(); c >= 0; c = Get()) {
+      tail.push_back(static_cast<char>(c));
+      if (tail.size() > len) {
+        if (_text) {
+          _text->push_back(tail[0]);
+        }
+        tail.erase(0, 1);
+      }
+      if (tail == _terminator) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void SkipSpaces() {
+    while (IsSpace(Peek())) {
+      Get();
+    }
+  }
+
+  int line() const {
+    return line_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  Reader(Reader const&);
+  void operator=(Reader const&);
+
+  // Size of the chunks read from the stream.
+  static const size_t kBufferSize = 64 << 10;
+
+  io::Stream* stream_;
+  char* buffer_;
+  const char* begin_;
+  const char* end_;
+  int line_;
+};
+
+// Appends _code point to _str, utf-8 encoded.
+void AppendUtf8(unsigned long _code, ozz::String::Std* _str) {
+  if (_code < 0x80) {
+    _str->push_back(static_cast<char>(_code));
+  } else if (_code < 0x800) {
+    _str->push_back(static_cast<char>(0xc0 | (_code >> 6)));
+    _str->push_back(static_cast<char>(0x80 | (_code & 0x3f)));
+  } else if (_code < 0x10000) {
+    _str->push_back(static_cast<char>(0xe0 | (_code >> 12)));
+    _str->push_back(static_cast<char>(0x80 | ((_code >> 6) & 0x3f)));
+    _str->push_back(static_cast<char>(0x80 | (_code & 0x3f)));
+  } else {
+    _str->push_back(static_cast<char>(0xf0 | (_code >> 18)));
+    _str->push_back(static_cast<char>(0x80 | ((_code >> 12) & 0x3f)));
+    _str->push_back(static_cast<char>(0x80 | ((_code >> 6) & 0x3f)));
+    _str->push_back(static_cast<char>(0x80 | (_code & 0x3f)));
+  }
+}
+
+// Reads an entity, whose '&' was already consumed, and appends it decoded to
+// _str. Unknown entities are appended unchanged, like tinyxml does.
+void ReadEntity(Reader* _reader, ozz::String::Std* _str) {
+  ozz::String::Std entity;
+  for (int c = _reader->Peek();
+       c >= 0 && c != ';' && c != '<' && !IsSpace(c) && entity.size() < 10;
+       c = _reader->Peek()) {
+    entity.push_back(static_cast<char>(_reader->Get()));
+  }
+  const bool terminated = _reader->Peek() == ';';
+  if (terminated) {
+    _reader->Get();
+    const char* names[][2] = {
+      {"lt", "<"}, {"gt", ">"}, {"amp", "&"}, {"quot", "\""}, {"apos", "'"}};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(names); ++i) {
+      if (entity == names[i][0]) {
+        _str->append(names[i][1]);
+        return;
+      }
+    }
+    if (entity.size() > 1 && entity[0] == '#') {
+      const bool hex = entity[1] == 'x';
+      char* end;
+      const unsigned long code =
+        std::strtoul(entity.c_str() + (hex ? 2 : 1), &end, hex ? 16 : 10);
+      if (*end == 0 && code != 0) {
+        AppendUtf8(code, _str);
+        return;
+      }
+    }
+  }
+  _str->push_back('&');
+  _str->append(entity);
+  if (terminated) {
+    _str->push_back(';');
+  }
+}
+
+// Implements the streaming parser and the visit of the document.
+class Parser {
+ public:
+  Parser(io::Stream* _stream,
+         TiXmlDocument* _document,
+         TiXmlVisitor** _visitors,
+         int _num_visitors)
+    : reader_(_stream),
+      document_(_document),
+      visitors_(_visitors),
+      num_visitors_(_num_visitors),
+      content_(-1),
+      has_root_(false) {
+  }
+
+  bool Run() {
+    // The document is the root of the visit.
+    Frame document;
+    document.node = document_;
+    for (int i = 0; i < num_visitors_; ++i) {
+      document.active[i] = true;
+      document.children[i] = visitors_[i]->VisitEnter(*document_);
+    }
+    frames_.push_back(document);
+
+    // Skips utf-8 byte order mark.
+    if (reader_.Peek() == 0xef && !reader_.Expect("\xef\xbb\xbf")) {
+      return Error("Invalid byte order mark");
+    }
+
+    // Parses the document.
+    for (int c = reader_.Peek(); c >= 0; c = reader_.Peek()) {
+      if (c == '<') {
+        reader_.Get();
+        if (!ParseMarkup()) {
+          return false;
+        }
+      } else if (!ParseText()) {
+        return false;
+      }
+    }
+    if (frames_.size() != 1) {
+      return Error("Unexpected end of document, element not closed");
+    }
+    if (!has_root_) {
+      return Error("Document empty");
+    }
+
+    bool success = true;
+    for (int i = 0; i < num_visitors_; ++i) {
+      success &= visitors_[i]->VisitExit(*document_);
+    }
+    return success;
+  }
+
+ private:
+  // Stores the visit state of an open element.
+  struct Frame {
+    ozz::String::Std name;
+    // The element node, or NULL if it isn't built.
+    TiXmlNode* node;
+    // Visitors that accept this element.
+    bool active[kMaxStreamVisitors];
+    // Visitors that visit this element children.
+    bool children[kMaxStreamVisitors];
+  };
+
+  bool Error(const char* _message) {
+    log::Err() << "Failed to parse xml document (line " << reader_.line() <<
+      "): " << _message << "." << std::endl;
+    return false;
+  }
+
+  // Parses markup whose '<' was already consumed.
+  bool ParseMarkup() {
+    const int c = reader_.Peek();
+    if (c == '/') {
+      reader_.Get();
+      ozz::String::Std name;
+      ReadName(&name);
+      reader_.SkipSpaces();
+      if (reader_.Get() != '>') {
+        return Error("Malformed end tag");
+      }
+      return EndElement(name);
+    } else if (c == '?') {
+      // Declaration or processing instruction.
+      return reader_.SkipUntil("?>", NULL) ||
+             Error("Unterminated declaration");
+    } else if (c == '!') {
+      reader_.Get();
+      if (reader_.Peek() == '-') {
+        if (!reader_.Expect("--") || !reader_.SkipUntil("-->", NULL)) {
+          return Error("Malformed comment");
+        }
+        return true;
+      } else if (reader_.Peek() == '[') {
+        if (!reader_.Expect("[CDATA[")) {
+          return Error("Malformed CDATA section");
+        }
+        ozz::String::Std text;
+        if (!reader_.SkipUntil("]]>", Building() ? &text : NULL)) {
+          return Error("Unterminated CDATA section");
+        }
+        return HandleText(text, true);
+      }
+      // Doctype, whose internal subset can contain '>'.
+      int depth = 0;
+      for (int d = reader_.Get(); d >= 0; d = reader_.Get()) {
+        if (d == '[') {
+          ++depth;
+        } else if (d == ']') {
+          --depth;
+        } else if (d == '>' && depth <= 0) {
+          return true;
+        }
+      }
+      return Error("Unterminated doctype");
+    }
+    return ParseStartTag();
+  }
+
+  bool ParseStartTag() {
+    ozz::String::Std name;
+    ReadName(&name);
+    if (name.empty()) {
+      return Error("Invalid element name");
+    }
+
+    // Reads attributes.
+    ozz::Vector<ozz::String::Std>::Std attributes;
+    for (;;) {
+      reader_.SkipSpaces();
+      const int c = reader_.Peek();
+      if (c == '>') {
+        reader_.Get();
+        return StartElement(name, attributes);
+      } else if (c == '/') {
+        reader_.Get();
+        if (reader_.Get() != '>') {
+          return Error("Malformed empty element tag");
+        }
+        return StartElement(name, attributes) && EndElement(name);
+      }
+      ozz::String::Std attribute;
+      ReadName(&attribute);
+      reader_.SkipSpaces();
+      if (attribute.empty() || reader_.Get() != '=') {
+        return Error("Malformed attribute");
+      }
+      reader_.SkipSpaces();
+      const int quote = reader_.Get();
+      if (quote != '"' && quote != '\'') {
+        return Error("Malformed attribute value");
+      }
+      ozz::String::Std value;
+      for (int v = reader_.Get(); v != quote; v = reader_.Get()) {
+        if (v < 0) {
+          return Error("Unterminated attribute value");
+        } else if (v == '&') {
+          ReadEntity(&reader_, &value);
+        } else {
+          value.push_back(static_cast<char>(v));
+        }
+      }
+      attributes.push_back(attribute);
+      attributes.push_back(value);
+    }
+  }
+
+  // Reads text up to the next markup, condensing white spaces as tinyxml does.
+  bool ParseText() {
+    const bool building = Building();
+    ozz::String::Std text;
+    bool space = false;
+    for (int c = reader_.Peek(); c >= 0 && c != '<'; c = reader_.Peek()) {
+      reader_.Get();
+      if (!building) {
+        continue;
+      }
+      if (IsSpace(c)) {
+        space = true;
+        continue;
+      }
+      if (space && !text.empty()) {
+        text.push_back(' ');
+      }
+      space = false;
+      if (c == '&') {
+        ReadEntity(&reader_, &text);
+      } else {
+        text.push_back(static_cast<char>(c));
+      }
+    }
+    return text.empty() || HandleText(text, false);
+  }
+
+  void ReadName(ozz::String::Std* _name) {
+    for (int c = reader_.Peek();
+         c >= 0 && !IsSpace(c) && c != '/' && c != '>' && c != '=';
+         c = reader_.Peek()) {
+      _name->push_back(static_cast<char>(reader_.Get()));
+    }
+  }
+
+  // Tells whether the current element is built, so its content must be read.
+  bool Building() const {
+    return frames_.back().node != NULL;
+  }
+
+  bool StartElement(const ozz::String::Std& _name,
+                    const ozz::Vector<ozz::String::Std>::Std& _attributes) {
+    Frame& parent = frames_.back();
+    if (frames_.size() == 1) {
+      has_root_ = true;
+    }
+
+    Frame frame;
+    frame.name = _name;
+    bool any_active = false;
+    for (int i = 0; i < num_visitors_; ++i) {
+      frame.active[i] = content_ < 0 && parent.children[i];
+      frame.children[i] = false;
+      any_active |= frame.active[i];
+    }
+
+    // Builds the element if it's visited, or part of a content element.
+    frame.node = NULL;
+    if (content_ >= 0 || any_active) {
+      TiXmlElement* element = new TiXmlElement(_name.c_str());
+      for (size_t i = 0; i < _attributes.size(); i += 2) {
+        element->SetAttribute(_attributes[i].c_str(),
+                              _attributes[i + 1].c_str());
+      }
+      parent.node->LinkEndChild(element);
+      frame.node = element;
+
+      if (content_ < 0) {
+        if (IsContentElement(element->Value())) {
+          // Visit is delayed until the element is complete.
+          content_ = static_cast<int>(frames_.size());
+        } else {
+          for (int i = 0; i < num_visitors_; ++i) {
+            if (frame.active[i]) {
+              frame.children[i] =
+                visitors_[i]->VisitEnter(*element, element->FirstAttribute());
+            }
+          }
+        }
+      }
+    }
+    frames_.push_back(frame);
+    return true;
+  }
+
+  bool EndElement(const ozz::String::Std& _name) {
+    if (frames_.size() < 2 || frames_.back().name != _name) {
+      return Error("Mismatched end tag");
+    }
+    const int index = static_cast<int>(frames_.size()) - 1;
+    Frame& frame = frames_[index];
+    Frame& parent = frames_[index - 1];
+    if (frame.node && (content_ < 0 || content_ == index)) {
+      TiXmlElement* element = frame.node->ToElement();
+      for (int i = 0; i < num_visitors_; ++i) {
+        if (!frame.active[i]) {
+          continue;
+        }
+        // A content element is visited at once, while other elements were
+        // already entered.
+        const bool success = content_ == index ?
+          element->Accept(visitors_[i]) :
+          visitors_[i]->VisitExit(*element);
+        if (!success) {
+          parent.children[i] = false;  // Stops visiting siblings.
+        }
+      }
+      if (content_ == index) {
+        // Releases content, but keeps the element whose attributes can be
+        // referenced by visitors.
+        element->Clear();
+        content_ = -1;
+      }
+    }
+    frames_.pop_back();
+    return true;
+  }
+
+  bool HandleText(const ozz::String::Std& _text, bool _cdata) {
+    Frame& frame = frames_.back();
+    if (frames_.size() == 1) {
+      return _text.empty() || Error("Text outside of the root element");
+    }
+    if (!frame.node) {
+      return true;
+    }
+    TiXmlText* text = new TiXmlText(_text.c_str());
+    text->SetCDATA(_cdata);
+    frame.node->LinkEndChild(text);
+    if (content_ < 0) {
+      // Visits text of an element that isn't a content element, and releases
+      // it.
+      for (int i = 0; i < num_visitors_; ++i) {
+        if (frame.children[i] && !visitors_[i]->Visit(*text)) {
+          frame.children[i] = false;
+        }
+      }
+      frame.node->RemoveChild(text);
+    }
+    return true;
+  }
+
+  Reader reader_;
+  TiXmlDocument* document_;
+  TiXmlVisitor** visitors_;
+  int num_visitors_;
+
+  // Stack of open elements, the document being the first one.
+  ozz::Vector<Frame>::Std frames_;
+
+  // Index of the content element frame being read, or -1.
+  int content_;
+
+  // Set once the root element is found.
+  bool has_root_;
+};
+}  // namespace
+
+bool StreamDocument(io::Stream* _stream,
+                    TiXmlDocument* _document,
+                    TiXmlVisitor** _visitors,
+                    int _num_visitors) {
+  OZZ_PROFILE_SCOPE("collada::StreamDocument");
+  if (!_stream || !_stream->opened() || !_document ||
+      _num_visitors < 0 || _num_visitors > kMaxStreamVisitors) {
+    return false;
+  }
+  Parser parser(_stream, _document, _visitors, _num_visitors);
+  if (!parser.Run()) {
+    return false;
+  }
+  log::Log() << "Successfully parsed xml document." << std::endl;
+  return true;
+}
+}  // collada
+}  // offline
+}  // animation
+}  // ozz
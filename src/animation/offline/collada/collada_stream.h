@@ -0,0 +1,71 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_OFFLINE_COLLADA_COLLADA_STREAM_H_
+#define OZZ_ANIMATION_OFFLINE_COLLADA_COLLADA_STREAM_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include "tinyxml.h"
+
+namespace ozz {
+namespace io { class Stream; }
+namespace animation {
+namespace offline {
+namespace collada {
+
+// Defines the maximum number of visitors of a single StreamDocument call.
+const int kMaxStreamVisitors = 4;
+
+// Reads the xml document from _stream and visits it with the _num_visitors
+// _visitors in a single pass, as TiXmlDocument::Accept would do for each of
+// them, but while the document is being read.
+// Only the visited elements are built in _document, which must outlive the
+// visitors as they keep pointers to elements attributes. Elements whose
+// handlers read their content (text or child elements) when entered, like
+// <float_array> or <accessor>, are built completely and visited once closed,
+// their content being released right after. Other elements are visited as
+// soon as their start tag is read, and the elements that no visitor enters
+// are skipped without being built.
+// Memory usage is thus bounded by the structure of the visited part of the
+// document and by its largest content element, rather than by document size.
+// Returns false if the document isn't a valid xml document, or if a visitor
+// failed.
+bool StreamDocument(io::Stream* _stream,
+                    TiXmlDocument* _document,
+                    TiXmlVisitor** _visitors,
+                    int _num_visitors);
+}  // collada
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_OFFLINE_COLLADA_COLLADA_STREAM_H_
@@ -46,13 +46,21 @@
 class ColladaAnimationConverter :
   public ozz::animation::offline::AnimationConverter {
 private:
+  // Collada files are streamed independently, with no shared state, so
+  // multiple files can be imported concurrently.
+  virtual bool IsImportThreadSafe() const {
+    return true;
+  }
+
   // Implement SkeletonConverter::Import function.
-  virtual bool Import(const char* _filename,
-                      const ozz::animation::Skeleton& _skeleton,
-                      float _sampling_rate,
-                      ozz::animation::offline::RawAnimation* _animation) {
+  virtual bool Import(
+    const char* _filename,
+    const ozz::animation::Skeleton& _skeleton,
+    const ozz::animation::offline::JointTrackSampler& _sampler,
+    ozz::animation::offline::RawAnimation* _animation,
+    ozz::tasks::Dispatcher* _dispatcher) {
     return ozz::animation::offline::collada::ImportFromFile(
-      _filename, _skeleton, _sampling_rate, _animation);
+      _filename, _skeleton, _sampler, _animation, _dispatcher);
   }
 };
 
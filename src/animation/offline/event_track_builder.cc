@@ -0,0 +1,67 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/event_track_builder.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_event_track.h"
+#include "ozz/animation/runtime/event_track.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+EventTrack* EventTrackBuilder::operator()(
+  const RawEventTrack& _raw_track) const {
+  // Tests _raw_track validity.
+  if (!_raw_track.Validate()) {
+    return NULL;
+  }
+
+  // Everything is fine, allocates and fills the event track.
+  // Nothing can fail now.
+  EventTrack* track = memory::default_allocator()->New<EventTrack>();
+  track->duration_ = _raw_track.duration;
+
+  // Copies events, which are already sorted.
+  track->Allocate(_raw_track.num_events());
+  for (int i = 0; i < _raw_track.num_events(); ++i) {
+    const RawEventTrack::Event& src = _raw_track.events[i];
+    EventTrack::Event& event = track->events_[i];
+    event.time = src.time;
+    event.id = src.id;
+  }
+
+  return track;  // Success.
+}
+}  // offline
+}  // animation
+}  // ozz
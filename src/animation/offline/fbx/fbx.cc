@@ -73,8 +73,9 @@ bool ImportFromFile(const char* _filename, RawSkeleton* _skeleton) {
 
 bool ImportFromFile(const char* _filename,
                     const Skeleton& _skeleton,
-                    float _sampling_rate,
-                    RawAnimation* _animation) {
+                    const JointTrackSampler& _sampler,
+                    RawAnimation* _animation,
+                    tasks::Dispatcher* _dispatcher) {
   if (!_animation) {
     return false;
   }
@@ -93,7 +94,8 @@ bool ImportFromFile(const char* _filename,
 
   if (!ExtractAnimation(&scene_loader,
                         _skeleton,
-                        _sampling_rate,
+                        _sampler,
+                        _dispatcher,
                         _animation)) {
     log::Err() << "Fbx animation extraction failed." << std::endl;
     return false;
@@ -47,12 +47,14 @@ class FbxAnimationConverter :
   public ozz::animation::offline::AnimationConverter {
 private:
   // Implement SkeletonConverter::Import function.
-  virtual bool Import(const char* _filename,
-                      const ozz::animation::Skeleton& _skeleton,
-                      float _sampling_rate,
-                      ozz::animation::offline::RawAnimation* _animation) {
+  virtual bool Import(
+    const char* _filename,
+    const ozz::animation::Skeleton& _skeleton,
+    const ozz::animation::offline::JointTrackSampler& _sampler,
+    ozz::animation::offline::RawAnimation* _animation,
+    ozz::tasks::Dispatcher* _dispatcher) {
     return ozz::animation::offline::fbx::ImportFromFile(
-      _filename, _skeleton, _sampling_rate, _animation);
+      _filename, _skeleton, _sampler, _animation, _dispatcher);
   }
 };
 
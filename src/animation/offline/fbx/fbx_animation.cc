@@ -34,11 +34,17 @@
 
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/animation/offline/joint_track_sampler.h"
 #include "ozz/animation/offline/raw_animation.h"
 
+#include <cmath>
+
 #include "ozz/base/log.h"
 
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/transform.h"
+#include "ozz/base/tasks/task_dispatcher.h"
 
 namespace ozz {
 namespace animation {
@@ -46,14 +52,120 @@ namespace offline {
 namespace fbx {
 
 namespace {
+
+// Evaluates a node transformation with a Fbx evaluator, for JointTrackSampler.
+class NodeFunction : public JointTrackSampler::Function {
+ public:
+  NodeFunction(FbxAnimEvaluator* _evaluator, FbxNode* _node, bool _root,
+               const FbxSystemConverter* _converter) :
+    evaluator_(_evaluator),
+    node_(_node),
+    root_(_root),
+    converter_(_converter) {
+  }
+
+  virtual bool Evaluate(float _time, math::Transform* _transform) const {
+    // Evaluate local transform at fbx_time.
+    *_transform = converter_->ConvertTransform(
+      root_ ?
+        evaluator_->GetNodeGlobalTransform(node_, FbxTimeSeconds(_time)):
+        evaluator_->GetNodeLocalTransform(node_, FbxTimeSeconds(_time)));
+    return true;
+  }
+
+ private:
+  FbxAnimEvaluator* evaluator_;
+  FbxNode* node_;
+  bool root_;
+  const FbxSystemConverter* converter_;
+};
+
+// Samples all animated joints for a segment of the animation time range, a
+// work item per segment. Every segment uses its own evaluator, as Fbx
+// evaluators cache evaluation states and can't be shared by multiple threads.
+// Segment keys are output to their own tracks, _tracks[segment * num_joints +
+// joint], which are merged once all segments are sampled.
+class SampleTask : public tasks::Task {
+ public:
+  SampleTask(FbxSceneLoader* _scene_loader,
+             const Skeleton& _skeleton,
+             const JointTrackSampler& _sampler,
+             FbxNode* const* _nodes,
+             FbxAnimEvaluator* const* _evaluators,
+             const float* _bounds,
+             RawAnimation::JointTrack* _tracks,
+             bool* _success) :
+    scene_loader_(_scene_loader),
+    skeleton_(_skeleton),
+    sampler_(_sampler),
+    nodes_(_nodes),
+    evaluators_(_evaluators),
+    bounds_(_bounds),
+    tracks_(_tracks),
+    success_(_success) {
+  }
+
+  virtual void Run(int _index) const {
+    const int num_joints = skeleton_.num_joints();
+    success_[_index] = true;
+    for (int i = 0; i < num_joints && success_[_index]; i++) {
+      if (!nodes_[i]) {
+        continue;
+      }
+      const bool root =
+        skeleton_.joint_properties()[i].parent == Skeleton::kNoParentIndex;
+      const NodeFunction function(evaluators_[_index], nodes_[i], root,
+                                  scene_loader_->converter());
+      success_[_index] = sampler_(function,
+                                  bounds_[_index], bounds_[_index + 1],
+                                  &tracks_[_index * num_joints + i]);
+    }
+  }
+
+ private:
+  FbxSceneLoader* scene_loader_;
+  const Skeleton& skeleton_;
+  const JointTrackSampler& sampler_;
+  FbxNode* const* nodes_;
+  FbxAnimEvaluator* const* evaluators_;
+  const float* bounds_;
+  RawAnimation::JointTrack* tracks_;
+  bool* success_;
+};
+
+// Appends _segment keys to _track, shifting them by -_start. The first key is
+// skipped if _skip_first, as it's the last key of the previous segment.
+template<typename _Keys>
+void AppendKeys(const _Keys& _segment, float _start, bool _skip_first,
+                _Keys* _track) {
+  for (size_t k = _skip_first ? 1 : 0; k < _segment.size(); ++k) {
+    typename _Keys::value_type key = _segment[k];
+    key.time -= _start;
+    _track->push_back(key);
+  }
+}
+
+// Animation time range is split in at most kMaxSegments segments (the maximum
+// number of concurrent workers of a dispatch), of at least kMinSegmentSize
+// sampling periods so that short animations don't pay for evaluators they
+// don't need.
+const int kMaxSegments = 32;
+const int kMinSegmentSize = 64;
+
 bool ExtractAnimation(FbxSceneLoader* _scene_loader,
                       FbxAnimStack* anim_stack,
                       const Skeleton& _skeleton,
-                      float _sampling_rate,
+                      const JointTrackSampler& _sampler,
+                      tasks::Dispatcher* _dispatcher,
                       RawAnimation* _animation) {
   FbxScene* scene = _scene_loader->scene();
   assert(scene);
 
+  if (_sampler.sampling_rate <= 0.f) {
+    ozz::log::Err() << "Invalid sampling rate." << std::endl;
+    return false;
+  }
+
   // Setup Fbx animation evaluator.
   scene->SetCurrentAnimationStack(anim_stack);
 
@@ -87,16 +199,19 @@ bool ExtractAnimation(FbxSceneLoader* _scene_loader,
   // Allocates all tracks with the same number of joints as the skeleton.
   // Tracks that would not be found will be set to skeleton bind-pose
   // transformation.
-  _animation->tracks.resize(_skeleton.num_joints());
-
-  // Iterate all skeleton joints and fills there track with key frames.
-  FbxAnimEvaluator* evaluator = scene->GetAnimationEvaluator();
-  for (int i = 0; i < _skeleton.num_joints(); i++) {
-    RawAnimation::JointTrack& track = _animation->tracks[i];
+  const int num_joints = _skeleton.num_joints();
+  _animation->tracks.resize(num_joints);
+  if (num_joints == 0) {
+    return true;
+  }
 
+  // Finds nodes that match skeleton joints.
+  ozz::Vector<FbxNode*>::Std nodes(num_joints);
+  for (int i = 0; i < num_joints; i++) {
     // Find a node that matches skeleton joint.
     const char* joint_name = _skeleton.joint_names()[i];
     FbxNode* node = scene->FindNodeByName(joint_name);
+    nodes[i] = node;
 
     if (!node) {
       // Empty joint track.
@@ -107,6 +222,7 @@ bool ExtractAnimation(FbxSceneLoader* _scene_loader,
       const ozz::math::Transform& bind_pose =
         ozz::animation::GetJointBindPose(_skeleton, i);
 
+      RawAnimation::JointTrack& track = _animation->tracks[i];
       const RawAnimation::TranslationKey tkey = {0.f, bind_pose.translation};
       track.translations.push_back(tkey);
 
@@ -115,46 +231,64 @@ bool ExtractAnimation(FbxSceneLoader* _scene_loader,
 
       const RawAnimation::ScaleKey skey = {0.f, bind_pose.scale};
       track.scales.push_back(skey);
-
-      continue;
     }
+  }
 
-    // Reserve keys in animation tracks (allocation strategy optimization
-    // purpose).
-    const float sampling_period = 1.f / _sampling_rate;
-    const int max_keys =
-      static_cast<int>(3.f + (end - start) / sampling_period);
-    track.translations.reserve(max_keys);
-    track.rotations.reserve(max_keys);
-    track.scales.reserve(max_keys);
-
-    // Evaluate joint transformation at the specified time.
-    // Make sure to include "end" time, and enter the loop once at least.
-    bool loop_again = true;
-    for (float t = start; loop_again; t += sampling_period) {
-      if (t >= end) {
-        t = end;
-        loop_again = false;
-      }
+  // Splits time range in segments of whole sampling periods, sampled
+  // concurrently if a dispatcher is provided. The first segment uses scene
+  // evaluator, others are created (from the calling thread, as Fbx object
+  // creation isn't thread safe) and destroyed once sampling is done.
+  const float sampling_period = 1.f / _sampler.sampling_rate;
+  const int num_periods = math::Max(
+    static_cast<int>(std::ceil((end - start) / sampling_period)), 1);
+  int num_segments = 1;
+  if (_dispatcher) {
+    num_segments = math::Min(
+      (num_periods + kMinSegmentSize - 1) / kMinSegmentSize, kMaxSegments);
+  }
+  const int segment_size = (num_periods + num_segments - 1) / num_segments;
+  num_segments = (num_periods + segment_size - 1) / segment_size;
+  float bounds[kMaxSegments + 1];
+  FbxAnimEvaluator* evaluators[kMaxSegments];
+  for (int i = 0; i < num_segments; ++i) {
+    bounds[i] = start + i * segment_size * sampling_period;
+    evaluators[i] = i == 0 ?
+      scene->GetAnimationEvaluator() : FbxAnimEvalClassic::Create(scene, "");
+  }
+  bounds[num_segments] = math::Max(end, start);
 
-      // Evaluate local transform at fbx_time.
-      const ozz::math::Transform transform =
-        _scene_loader->converter()->ConvertTransform(
-          _skeleton.joint_properties()[i].parent == Skeleton::kNoParentIndex?
-            evaluator->GetNodeGlobalTransform(node, FbxTimeSeconds(t)):
-            evaluator->GetNodeLocalTransform(node, FbxTimeSeconds(t)));
-
-      // Fills corresponding track.
-      const float local_time = t - start;
-      const RawAnimation::TranslationKey translation = {
-        local_time, transform.translation};
-      track.translations.push_back(translation);
-      const RawAnimation::RotationKey rotation = {
-        local_time, transform.rotation};
-      track.rotations.push_back(rotation);
-      const RawAnimation::ScaleKey scale = {
-        local_time, transform.scale};
-      track.scales.push_back(scale);
+  ozz::Vector<RawAnimation::JointTrack>::Std segment_tracks(
+    num_segments * num_joints);
+  bool success[kMaxSegments];
+  const SampleTask task(_scene_loader, _skeleton, _sampler, &nodes[0],
+                        evaluators, bounds, &segment_tracks[0], success);
+  tasks::Dispatcher* task_dispatcher =
+    _dispatcher ? _dispatcher : tasks::serial_dispatcher();
+  task_dispatcher->Dispatch(task, num_segments);
+
+  bool sampled = true;
+  for (int i = 0; i < num_segments; ++i) {
+    sampled &= success[i];
+    if (i != 0) {
+      evaluators[i]->Destroy();
+    }
+  }
+  if (!sampled) {
+    return false;
+  }
+
+  // Merges segments keys, shifting keys such that the first one is at t = 0.
+  for (int i = 0; i < num_joints; i++) {
+    if (!nodes[i]) {
+      continue;
+    }
+    RawAnimation::JointTrack& track = _animation->tracks[i];
+    for (int s = 0; s < num_segments; ++s) {
+      const RawAnimation::JointTrack& segment =
+        segment_tracks[s * num_joints + i];
+      AppendKeys(segment.translations, start, s != 0, &track.translations);
+      AppendKeys(segment.rotations, start, s != 0, &track.rotations);
+      AppendKeys(segment.scales, start, s != 0, &track.scales);
     }
   }
 
@@ -167,7 +301,8 @@ bool ExtractAnimation(FbxSceneLoader* _scene_loader,
 
 bool ExtractAnimation(FbxSceneLoader* _scene_loader,
                       const Skeleton& _skeleton,
-                      float _sampling_rate,
+                      const JointTrackSampler& _sampler,
+                      tasks::Dispatcher* _dispatcher,
                       RawAnimation* _animation) {
   FbxScene* scene = _scene_loader->scene();
   assert(scene);
@@ -192,7 +327,8 @@ bool ExtractAnimation(FbxSceneLoader* _scene_loader,
   return ExtractAnimation(_scene_loader,
                           anim_stack,
                           _skeleton,
-                          _sampling_rate,
+                          _sampler,
+                          _dispatcher,
                           _animation);
 }
 }  // fbx
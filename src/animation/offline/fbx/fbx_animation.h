@@ -38,6 +38,9 @@
 #include "ozz/animation/offline/fbx/fbx_base.h"
 
 namespace ozz {
+namespace tasks {
+class Dispatcher;
+}  // tasks
 namespace animation {
 
 class Skeleton;
@@ -45,12 +48,17 @@ class Skeleton;
 namespace offline {
 
 struct RawAnimation;
+class JointTrackSampler;
 
 namespace fbx {
 
+// Extracts _skeleton joint tracks of _scene_loader first animation, sampled
+// with _sampler. Time segments are sampled concurrently using _dispatcher, or
+// sequentially if _dispatcher is NULL.
 bool ExtractAnimation(FbxSceneLoader* _scene_loader,
                       const Skeleton& _skeleton,
-                      float _sampling_rate,
+                      const JointTrackSampler& _sampler,
+                      tasks::Dispatcher* _dispatcher,
                       RawAnimation* _animation);
 
 }  // fbx
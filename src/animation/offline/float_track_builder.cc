@@ -0,0 +1,156 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/float_track_builder.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/math_ex.h"
+
+#include "ozz/animation/offline/raw_float_track.h"
+#include "ozz/animation/runtime/float_track.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+struct SortingFloatKey {
+  float prev_key_time;
+  FloatKey key;
+};
+
+// Keyframe sorting. Stores first by previous key time and then curve number.
+bool SortingKeyLess(const SortingFloatKey& _left,
+                    const SortingFloatKey& _right) {
+  return _left.prev_key_time < _right.prev_key_time
+         || (_left.prev_key_time == _right.prev_key_time
+             && _left.key.curve < _right.key.curve);
+}
+
+typedef ozz::Vector<SortingFloatKey>::Std SortingKeys;
+
+// Pushes a key of _curve, converting _time to key time unit. Keys that fall in
+// the same key time unit as the previous key of the curve are merged with it,
+// keeping the first one, except if _last which always replaces the previous
+// one. First key is expected to be at t = 0.
+void PushBackKey(uint16_t _curve, float _time, float _value, float _duration,
+                 bool _last, SortingKeys* _keys) {
+  const float max_time = static_cast<float>(kMaxKeyTime);
+  const float key_time = math::Clamp(
+    0.f, std::floor(ToKeyTime(_time, _duration) + .5f), max_time);
+  float prev_time = -1.f;
+  if (!_keys->empty() && _keys->back().key.curve == _curve) {
+    SortingFloatKey& back = _keys->back();
+    if (key_time <= back.key.time) {
+      if (!_last) {
+        return;  // Merged with the previous key.
+      }
+      prev_time = back.prev_key_time;
+      _keys->pop_back();  // The last key replaces the previous one.
+    } else {
+      prev_time = back.key.time;
+    }
+  }
+  const SortingFloatKey key = {
+    prev_time,
+    {static_cast<uint16_t>(key_time), _curve, _value}};
+  _keys->push_back(key);
+}
+
+// Copies a curve from a RawFloatTrack to _keys, fixing up the front (t = 0)
+// and back keys (t = duration). A curve without any key is null.
+void CopyRaw(const RawFloatTrack::Curve::Keys& _src, uint16_t _curve,
+             float _duration, SortingKeys* _keys) {
+  if (_src.empty()) {
+    PushBackKey(_curve, 0.f, 0.f, _duration, false, _keys);
+    PushBackKey(_curve, _duration, 0.f, _duration, true, _keys);
+  } else {
+    PushBackKey(_curve, 0.f, _src.front().value, _duration, false, _keys);
+    for (size_t k = 0; k < _src.size(); ++k) {
+      PushBackKey(_curve, _src[k].time, _src[k].value, _duration,
+                  false, _keys);
+    }
+    PushBackKey(_curve, _duration, _src.back().value, _duration, true, _keys);
+  }
+  assert(_keys->back().key.time == kMaxKeyTime);
+}
+}  // namespace
+
+FloatTrack* FloatTrackBuilder::operator()(
+  const RawFloatTrack& _raw_track) const {
+  // Tests _raw_track validity.
+  if (!_raw_track.Validate()) {
+    return NULL;
+  }
+
+  // Everything is fine, allocates and fills the float track.
+  // Nothing can fail now.
+  FloatTrack* track = memory::default_allocator()->New<FloatTrack>();
+
+  // Sets duration.
+  const float duration = _raw_track.duration;
+  track->duration_ = duration;
+
+  // Copies curves, padded to a multiple of 4.
+  const int num_curves = _raw_track.num_curves();
+  track->num_curves_ = num_curves;
+  const int num_padded = (num_curves + 3) & ~3;
+  const RawFloatTrack::Curve::Keys empty;
+  SortingKeys keys;
+  for (int i = 0; i < num_padded; ++i) {
+    const RawFloatTrack::Curve::Keys& src =
+      i < num_curves ? _raw_track.curves[i].keys : empty;
+    CopyRaw(src, static_cast<uint16_t>(i), duration, &keys);
+  }
+
+  // The first key of every curve is at t = 0, so sorting by previous key time
+  // stores the 2 first keys of every curve first, sorted by curve.
+  std::sort(keys.begin(), keys.end(), &SortingKeyLess);
+
+  // Copies sorted keys to the runtime track.
+  track->Allocate(static_cast<int>(keys.size()));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    track->keys_.begin[i] = keys[i].key;
+  }
+
+  return track;  // Success.
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,194 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/joint_track_sampler.h"
+
+#include <cmath>
+
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/transform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+JointTrackSampler::JointTrackSampler()
+  : sampling_rate(30.f),
+    adaptive(false),
+    translation_tolerance(1e-3f),  // 1 mm.
+    rotation_tolerance(.1f * math::kPi / 180.f),  // 0.1 degree.
+    scale_tolerance(1e-3f) {  // 0.1%.
+}
+
+namespace {
+
+// Adaptive sampling starts from intervals of kMaxInterval sampling periods,
+// which are then subdivided by dichotomy. Curvature can't be detected below
+// that resolution, as midpoints are the only keys tested.
+const int kMaxInterval = 8;
+
+// Defines the sampling grid: times are regularly spaced from _begin, the last
+// one being _end.
+class Grid {
+ public:
+  Grid(float _begin, float _end, float _period)
+    : begin_(_begin),
+      end_(_end),
+      period_(_period),
+      last_(0) {
+    while (_begin + last_ * _period < _end) {
+      ++last_;
+    }
+  }
+
+  // Index of the last time of the grid, which is _end.
+  int last() const {
+    return last_;
+  }
+
+  float time(int _index) const {
+    return _index < last_ ? begin_ + _index * period_ : end_;
+  }
+
+ private:
+  float begin_;
+  float end_;
+  float period_;
+  int last_;
+};
+
+struct Sample {
+  float time;
+  math::Transform transform;
+};
+
+void PushKey(const Sample& _sample, RawAnimation::JointTrack* _track) {
+  const RawAnimation::TranslationKey tkey = {
+    _sample.time, _sample.transform.translation};
+  _track->translations.push_back(tkey);
+  const RawAnimation::RotationKey rkey = {
+    _sample.time, _sample.transform.rotation};
+  _track->rotations.push_back(rkey);
+  const RawAnimation::ScaleKey skey = {
+    _sample.time, _sample.transform.scale};
+  _track->scales.push_back(skey);
+}
+
+// Compares rotations angle to _tolerance. Unlike math::Compare, it's robust to
+// dot products slightly greater than 1, and to opposite quaternions.
+bool CompareRotation(const math::Quaternion& _a, const math::Quaternion& _b,
+                     float _tolerance) {
+  const float dot = _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+  return std::fabs(dot) >= std::cos(_tolerance * .5f);
+}
+
+// Subdivides grid interval [_a,_b] while its midpoint can't be interpolated
+// from its ends within tolerances. Keys strictly inside the interval are
+// pushed in increasing time order.
+bool Subdivide(const JointTrackSampler& _sampler,
+               const JointTrackSampler::Function& _function,
+               const Grid& _grid,
+               int _a, const Sample& _sa, int _b, const Sample& _sb,
+               RawAnimation::JointTrack* _track) {
+  if (_b - _a < 2) {
+    return true;
+  }
+  const int m = (_a + _b) / 2;
+  Sample sm;
+  sm.time = _grid.time(m);
+  if (!_function.Evaluate(sm.time, &sm.transform)) {
+    return false;
+  }
+
+  // Interpolates the same way as the sampling job.
+  const float alpha = (sm.time - _sa.time) / (_sb.time - _sa.time);
+  const math::Transform& ta = _sa.transform;
+  const math::Transform& tb = _sb.transform;
+  if (Compare(math::Lerp(ta.translation, tb.translation, alpha),
+              sm.transform.translation, _sampler.translation_tolerance) &&
+      CompareRotation(math::NLerp(ta.rotation, tb.rotation, alpha),
+                      sm.transform.rotation, _sampler.rotation_tolerance) &&
+      Compare(math::Lerp(ta.scale, tb.scale, alpha),
+              sm.transform.scale, _sampler.scale_tolerance)) {
+    return true;
+  }
+  if (!Subdivide(_sampler, _function, _grid, _a, _sa, m, sm, _track)) {
+    return false;
+  }
+  PushKey(sm, _track);
+  return Subdivide(_sampler, _function, _grid, m, sm, _b, _sb, _track);
+}
+}  // namespace
+
+bool JointTrackSampler::operator()(const Function& _function,
+                                   float _begin, float _end,
+                                   RawAnimation::JointTrack* _track) const {
+  if (!_track || sampling_rate <= 0.f || _end < _begin) {
+    return false;
+  }
+  const Grid grid(_begin, _end, 1.f / sampling_rate);
+
+  // Fixed rate samples all grid times.
+  if (!adaptive) {
+    for (int i = 0; i <= grid.last(); ++i) {
+      Sample sample;
+      sample.time = grid.time(i);
+      if (!_function.Evaluate(sample.time, &sample.transform)) {
+        return false;
+      }
+      PushKey(sample, _track);
+    }
+    return true;
+  }
+
+  // Adaptive sampling subdivides every interval independently.
+  Sample sa;
+  sa.time = grid.time(0);
+  if (!_function.Evaluate(sa.time, &sa.transform)) {
+    return false;
+  }
+  PushKey(sa, _track);
+  for (int a = 0; a < grid.last(); a += kMaxInterval) {
+    const int b = math::Min(a + kMaxInterval, grid.last());
+    Sample sb;
+    sb.time = grid.time(b);
+    if (!_function.Evaluate(sb.time, &sb.transform) ||
+        !Subdivide(*this, _function, grid, a, sa, b, sb, _track)) {
+      return false;
+    }
+    PushKey(sb, _track);
+    sa = sb;
+  }
+  return true;
+}
+}  // offline
+}  // animation
+}  // ozz
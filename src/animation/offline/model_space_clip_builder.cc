@@ -0,0 +1,95 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/model_space_clip_builder.h"
+
+#include <cmath>
+
+#include "ozz/base/maths/simd_float4x3.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/model_space_clip.h"
+#include "ozz/animation/runtime/sample_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+ModelSpaceClipBuilder::ModelSpaceClipBuilder()
+    : sampling_rate(30.f) {
+}
+
+ModelSpaceClip* ModelSpaceClipBuilder::operator()(
+  const Animation& _animation, const Skeleton& _skeleton) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+  const int num_joints = _skeleton.num_joints();
+  if (!(sampling_rate > 0.f) || _animation.num_tracks() != num_joints) {
+    return NULL;
+  }
+
+  // Computes evenly spaced frames, the last one at the end of the animation.
+  const float duration = _animation.duration();
+  const int intervals = static_cast<int>(std::ceil(duration * sampling_rate));
+  const float frame_rate =
+    intervals > 0 ? intervals / duration : sampling_rate;
+
+  memory::Allocator* allocator = memory::default_allocator();
+  ModelSpaceClip* clip = allocator->New<ModelSpaceClip>();
+  clip->Allocate(num_joints, intervals + 1);
+  clip->frame_rate_ = frame_rate;
+  clip->duration_ = duration;
+
+  // Bakes every frame.
+  SamplingCache* cache = allocator->New<SamplingCache>(num_joints);
+  bool success = true;
+  for (int f = 0; success && f < clip->num_frames_; ++f) {
+    math::Float4x3* matrices = clip->matrices_ + f * num_joints;
+    SampleToModelJob job;
+    job.animation = &_animation;
+    job.cache = cache;
+    job.skeleton = &_skeleton;
+    job.time = f == intervals ? duration : f / frame_rate;
+    job.output_4x3 = Range<math::Float4x3>(matrices, num_joints);
+    success &= job.Run();
+  }
+  allocator->Delete(cache);
+
+  if (!success) {
+    allocator->Delete(clip);
+    return NULL;
+  }
+  return clip;
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,243 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/motion_database_builder.h"
+
+#include <cmath>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/motion_database.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+MotionDatabaseBuilder::MotionDatabaseBuilder()
+    : sampling_rate(30.f),
+      root(0) {
+}
+
+namespace {
+// Samples _animation at _time, to model-space matrices _models.
+bool Sample(const Animation& _animation, const Skeleton& _skeleton,
+            float _time, SamplingCache* _cache,
+            const Range<math::SoaTransform>& _locals,
+            const Range<math::Float4x4>& _models) {
+  SamplingJob sampling_job;
+  sampling_job.animation = &_animation;
+  sampling_job.cache = _cache;
+  sampling_job.time = _time;
+  sampling_job.output = _locals;
+  if (!sampling_job.Run()) {
+    return false;
+  }
+
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = &_skeleton;
+  ltm_job.input = _locals;
+  ltm_job.output = _models;
+  return ltm_job.Run();
+}
+
+// Appends x, y and z components of _v to _features.
+void PushBack3(math::SimdFloat4 _v, ozz::Vector<float>::Std* _features) {
+  _features->push_back(math::GetX(_v));
+  _features->push_back(math::GetY(_v));
+  _features->push_back(math::GetZ(_v));
+}
+
+// Gets the number of frames sampled from an animation of duration _duration.
+int NumFrames(float _duration, float _sampling_rate) {
+  return static_cast<int>(std::floor(_duration * _sampling_rate)) + 1;
+}
+}  // namespace
+
+MotionDatabase* MotionDatabaseBuilder::operator()(
+    const Skeleton& _skeleton,
+    const Range<const Animation* const>& _animations) const {
+  // Tests parameters validity.
+  const int num_joints = _skeleton.num_joints();
+  const int num_features =
+    static_cast<int>(joints.size() * 6 + trajectory.size() * 3);
+  if (!(sampling_rate > 0.f) || root < 0 || root >= num_joints ||
+      num_features == 0 || num_features > MotionDatabase::kMaxFeatures ||
+      !_animations.begin || _animations.end <= _animations.begin) {
+    return NULL;
+  }
+  for (size_t i = 0; i < joints.size(); ++i) {
+    if (joints[i] < 0 || joints[i] >= num_joints) {
+      return NULL;
+    }
+  }
+  for (size_t i = 0; i < trajectory.size(); ++i) {
+    if (!(trajectory[i] >= 0.f)) {
+      return NULL;
+    }
+  }
+  int num_frames = 0;
+  for (const Animation* const* it = _animations.begin;
+       it < _animations.end; ++it) {
+    if (!*it || (*it)->num_tracks() != num_joints) {
+      return NULL;
+    }
+    num_frames += NumFrames((*it)->duration(), sampling_rate);
+  }
+
+  // Allocates sampling buffers.
+  memory::Allocator* allocator = memory::default_allocator();
+  Range<math::SoaTransform> locals =
+    allocator->AllocateRange<math::SoaTransform>(_skeleton.num_soa_joints());
+  Range<math::Float4x4> models =
+    allocator->AllocateRange<math::Float4x4>(num_joints);
+  Range<math::Float4x4> previous =
+    allocator->AllocateRange<math::Float4x4>(num_joints);
+  Range<math::Float4x4> current =
+    allocator->AllocateRange<math::Float4x4>(num_joints);
+  SamplingCache* cache = allocator->New<SamplingCache>(num_joints);
+
+  // Extracts raw features of every frame.
+  bool success = true;
+  ozz::Vector<float>::Std features;
+  features.reserve(num_frames * num_features);
+  ozz::Vector<MotionDatabase::Frame>::Std frames;
+  frames.reserve(num_frames);
+  const float step = 1.f / sampling_rate;
+  const int num_animations = static_cast<int>(_animations.Count());
+  for (int a = 0; success && a < num_animations; ++a) {
+    const Animation& animation = *_animations.begin[a];
+    const float duration = animation.duration();
+    const int count = NumFrames(duration, sampling_rate);
+    for (int i = 0; success && i < count; ++i) {
+      const float time = math::Min(i * step, duration);
+      const MotionDatabase::Frame frame = {a, time};
+      frames.push_back(frame);
+
+      // Velocities are computed from the next step, or the previous one at
+      // the end of the animation.
+      const float to = math::Min(time + step, duration);
+      const float from = math::Max(to - step, 0.f);
+      success &= Sample(animation, _skeleton, from, cache, locals, previous);
+      success &= Sample(animation, _skeleton, to, cache, locals, current);
+      success &= Sample(animation, _skeleton, time, cache, locals, models);
+
+      const math::Float4x4 inv_root = Invert(models[root]);
+      for (size_t j = 0; j < joints.size(); ++j) {
+        PushBack3(TransformPoint(inv_root, models[joints[j]].cols[3]),
+                  &features);
+      }
+      const math::SimdFloat4 inv_dt =
+        math::simd_float4::Load1(to > from ? 1.f / (to - from) : 0.f);
+      for (size_t j = 0; j < joints.size(); ++j) {
+        const math::SimdFloat4 delta =
+          current[joints[j]].cols[3] - previous[joints[j]].cols[3];
+        PushBack3(TransformVector(inv_root, delta) * inv_dt, &features);
+      }
+      for (size_t t = 0; t < trajectory.size(); ++t) {
+        const float future = math::Min(time + trajectory[t], duration);
+        success &=
+          Sample(animation, _skeleton, future, cache, locals, current);
+        PushBack3(TransformPoint(inv_root, current[root].cols[3]),
+                  &features);
+      }
+    }
+  }
+
+  allocator->Delete(cache);
+  allocator->Deallocate(current);
+  allocator->Deallocate(previous);
+  allocator->Deallocate(models);
+  allocator->Deallocate(locals);
+
+  if (!success) {
+    return NULL;
+  }
+
+  // Everything is fine, allocates and fills the database.
+  MotionDatabase* database = allocator->New<MotionDatabase>();
+  database->Allocate(num_frames, static_cast<int>(joints.size()),
+                     static_cast<int>(trajectory.size()));
+  database->root_ = root;
+  for (size_t j = 0; j < joints.size(); ++j) {
+    database->joints_[j] = joints[j];
+  }
+  for (size_t t = 0; t < trajectory.size(); ++t) {
+    database->trajectory_[t] = trajectory[t];
+  }
+  for (int i = 0; i < num_frames; ++i) {
+    database->frames_[i] = frames[i];
+  }
+
+  // Computes normalization of every feature, in double precision as
+  // databases are large.
+  for (int f = 0; f < num_features; ++f) {
+    double sum = 0.;
+    double sum2 = 0.;
+    for (int i = 0; i < num_frames; ++i) {
+      const double value = features[i * num_features + f];
+      sum += value;
+      sum2 += value * value;
+    }
+    const double mean = sum / num_frames;
+    const double variance = math::Max(sum2 / num_frames - mean * mean, 0.);
+    const double deviation = std::sqrt(variance);
+    database->means_[f] = static_cast<float>(mean);
+    database->scales_[f] =
+      deviation > 1e-6 ? static_cast<float>(1. / deviation) : 1.f;
+  }
+
+  // Stores normalized features by blocks of 4 frames. Lanes beyond the last
+  // frame are zero.
+  for (int b = 0; b < (num_frames + 3) / 4; ++b) {
+    for (int f = 0; f < num_features; ++f) {
+      float values[4] = {0.f, 0.f, 0.f, 0.f};
+      for (int l = 0; l < 4 && b * 4 + l < num_frames; ++l) {
+        values[l] = (features[(b * 4 + l) * num_features + f] -
+                     database->means_[f]) * database->scales_[f];
+      }
+      database->features_[b * num_features + f] =
+        math::simd_float4::LoadPtrU(values);
+    }
+  }
+
+  database->BuildIndex();
+
+  return database;  // Success.
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,284 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/packed_raw_animation.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+PackedRawAnimation::PackedRawAnimation()
+  : duration(1.f),
+    interpolation(RawAnimation::kLinear),
+    num_tracks_(0),
+    buffer_(NULL) {
+  Reset();
+}
+
+PackedRawAnimation::~PackedRawAnimation() {
+  Reset();
+}
+
+void PackedRawAnimation::Reset() {
+  memory::default_allocator()->Deallocate(buffer_);
+  buffer_ = NULL;
+  num_tracks_ = 0;
+  const Channel<math::Float3, math::Float3> translations = {
+    NULL, NULL, NULL, NULL};
+  translations_ = translations;
+  const Channel<math::Quaternion, math::Float4> rotations = {
+    NULL, NULL, NULL, NULL};
+  rotations_ = rotations;
+  const Channel<math::Float3, math::Float3> scales = {NULL, NULL, NULL, NULL};
+  scales_ = scales;
+}
+
+namespace {
+
+// Returns a pointer to _count objects of type _Ty at *_cursor, and moves
+// *_cursor after them.
+template <typename _Ty>
+_Ty* Reserve(size_t _count, char** _cursor) {
+  _Ty* range = reinterpret_cast<_Ty*>(*_cursor);
+  *_cursor += _count * sizeof(_Ty);
+  return range;
+}
+
+// Computes per-track key offsets of a channel from _raw tracks.
+template <typename _Track>
+void FillOffsets(const RawAnimation& _raw,
+                 _Track RawAnimation::JointTrack::*_keys,
+                 size_t* _offsets) {
+  _offsets[0] = 0;
+  for (int i = 0; i < _raw.num_tracks(); ++i) {
+    _offsets[i + 1] = _offsets[i] + (_raw.tracks[i].*_keys).size();
+  }
+}
+
+// Copies _src keys, and tangents if _src_tangents isn't NULL, to a packed
+// channel at offset _offset.
+template <typename _Keys, typename _Tangents, typename _Channel>
+void PackKeys(const _Keys& _src, const _Tangents* _src_tangents,
+              size_t _offset, const _Channel& _dest) {
+  for (size_t k = 0; k < _src.size(); ++k) {
+    _dest.times[_offset + k] = _src[k].time;
+    _dest.values[_offset + k] = _src[k].value;
+  }
+  if (_src_tangents) {
+    for (size_t k = 0; k < _src.size(); ++k) {
+      _dest.tangents[_offset + k] = (*_src_tangents)[k];
+    }
+  }
+}
+
+// Copies packed keys and tangents to RawAnimation vectors.
+template <typename _Keys, typename _Tangents, typename _DestKeys,
+          typename _DestTangents>
+void UnpackKeys(const _Keys& _src, const _Tangents& _src_tangents,
+                _DestKeys* _dest, _DestTangents* _dest_tangents) {
+  _dest->resize(_src.size());
+  for (size_t k = 0; k < _src.size(); ++k) {
+    (*_dest)[k] = _src[k];
+  }
+  _dest_tangents->resize(_src_tangents.size());
+  for (size_t k = 0; k < _src_tangents.size(); ++k) {
+    (*_dest_tangents)[k] = _src_tangents[k];
+  }
+}
+
+// Implements key frames' time range and ordering checks, see
+// RawAnimation::Validate().
+bool ValidateTimes(const float* _times, size_t _count, float _duration) {
+  float previous_time = -1.f;
+  for (size_t k = 0; k < _count; ++k) {
+    const float frame_time = _times[k];
+    // Tests frame's time is in range [0:duration].
+    if (frame_time < 0.f || frame_time > _duration) {
+      return false;
+    }
+    // Tests that frames are sorted.
+    if (frame_time <= previous_time) {
+      return false;
+    }
+    previous_time = frame_time;
+  }
+  return true;  // Validated.
+}
+}  // namespace
+
+bool PackedRawAnimation::Pack(const RawAnimation& _raw) {
+  Reset();
+  duration = _raw.duration;
+  interpolation = _raw.interpolation;
+
+  if (!_raw.Validate()) {
+    return false;
+  }
+  const int num_tracks = _raw.num_tracks();
+  if (!num_tracks) {
+    return true;
+  }
+
+  // Computes channels sizes.
+  size_t num_translations = 0, num_rotations = 0, num_scales = 0;
+  for (int i = 0; i < num_tracks; ++i) {
+    const RawAnimation::JointTrack& track = _raw.tracks[i];
+    num_translations += track.translations.size();
+    num_rotations += track.rotations.size();
+    num_scales += track.scales.size();
+  }
+  const bool hermite = interpolation == RawAnimation::kHermite;
+  const size_t num_keys = num_translations + num_rotations + num_scales;
+  const size_t buffer_size =
+    3 * (num_tracks + 1) * sizeof(size_t) +
+    num_keys * sizeof(float) +
+    num_translations * sizeof(math::Float3) +
+    num_rotations * sizeof(math::Quaternion) +
+    num_scales * sizeof(math::Float3) +
+    (hermite ? num_translations * sizeof(math::Float3) +
+               num_rotations * sizeof(math::Float4) +
+               num_scales * sizeof(math::Float3) : 0);
+
+  // Offsets come first, as they have the strictest alignment requirements.
+  // All other arrays are made of floats.
+  buffer_ = memory::default_allocator()->Allocate(
+    buffer_size, AlignOf<size_t>::value);
+  num_tracks_ = num_tracks;
+  char* cursor = static_cast<char*>(buffer_);
+  translations_.offsets = Reserve<size_t>(num_tracks + 1, &cursor);
+  rotations_.offsets = Reserve<size_t>(num_tracks + 1, &cursor);
+  scales_.offsets = Reserve<size_t>(num_tracks + 1, &cursor);
+  translations_.times = Reserve<float>(num_translations, &cursor);
+  rotations_.times = Reserve<float>(num_rotations, &cursor);
+  scales_.times = Reserve<float>(num_scales, &cursor);
+  translations_.values = Reserve<math::Float3>(num_translations, &cursor);
+  rotations_.values = Reserve<math::Quaternion>(num_rotations, &cursor);
+  scales_.values = Reserve<math::Float3>(num_scales, &cursor);
+  if (hermite) {
+    translations_.tangents = Reserve<math::Float3>(num_translations, &cursor);
+    rotations_.tangents = Reserve<math::Float4>(num_rotations, &cursor);
+    scales_.tangents = Reserve<math::Float3>(num_scales, &cursor);
+  }
+  assert(cursor == static_cast<char*>(buffer_) + buffer_size);
+
+  FillOffsets(_raw, &RawAnimation::JointTrack::translations,
+              translations_.offsets);
+  FillOffsets(_raw, &RawAnimation::JointTrack::rotations, rotations_.offsets);
+  FillOffsets(_raw, &RawAnimation::JointTrack::scales, scales_.offsets);
+
+  for (int i = 0; i < num_tracks; ++i) {
+    const RawAnimation::JointTrack& track = _raw.tracks[i];
+    PackKeys(track.translations,
+             hermite ? &track.translation_tangents : NULL,
+             translations_.offsets[i], translations_);
+    PackKeys(track.rotations,
+             hermite ? &track.rotation_tangents : NULL,
+             rotations_.offsets[i], rotations_);
+    PackKeys(track.scales,
+             hermite ? &track.scale_tangents : NULL,
+             scales_.offsets[i], scales_);
+  }
+  return true;
+}
+
+void PackedRawAnimation::Unpack(RawAnimation* _raw) const {
+  _raw->duration = duration;
+  _raw->interpolation = interpolation;
+  _raw->tracks.resize(num_tracks_);
+  for (int i = 0; i < num_tracks_; ++i) {
+    const JointTrack src = track(i);
+    RawAnimation::JointTrack& dest = _raw->tracks[i];
+    UnpackKeys(src.translations, src.translation_tangents,
+               &dest.translations, &dest.translation_tangents);
+    UnpackKeys(src.rotations, src.rotation_tangents,
+               &dest.rotations, &dest.rotation_tangents);
+    UnpackKeys(src.scales, src.scale_tangents,
+               &dest.scales, &dest.scale_tangents);
+  }
+}
+
+bool PackedRawAnimation::Validate() const {
+  if (duration <= 0.f) {  // Tests duration is valid.
+    return false;
+  }
+  if (num_tracks_ > Skeleton::kMaxJoints) {  // Tests number of tracks.
+    return false;
+  }
+  // Ensures that all key frames' time are valid, ie: in a strict ascending
+  // order and within range [0:duration].
+  for (int i = 0; i < num_tracks_; ++i) {
+    const JointTrack keys = track(i);
+    if (!ValidateTimes(keys.translations.times(), keys.translations.size(),
+                       duration) ||
+        !ValidateTimes(keys.rotations.times(), keys.rotations.size(),
+                       duration) ||
+        !ValidateTimes(keys.scales.times(), keys.scales.size(), duration)) {
+      return false;
+    }
+  }
+  // Tangents are only available if *this was packed from a kHermite
+  // animation.
+  if (interpolation == RawAnimation::kHermite && num_tracks_ &&
+      !translations_.tangents) {
+    return false;
+  }
+  return true;  // *this is valid.
+}
+
+PackedRawAnimation::JointTrack PackedRawAnimation::track(int _track) const {
+  assert(_track >= 0 && _track < num_tracks_ && "Track index out of range.");
+  JointTrack track;
+  const size_t t0 = translations_.offsets[_track];
+  const size_t tn = translations_.offsets[_track + 1] - t0;
+  track.translations = Keys<RawAnimation::TranslationKey, math::Float3>(
+    translations_.times + t0, translations_.values + t0, tn);
+  const size_t r0 = rotations_.offsets[_track];
+  const size_t rn = rotations_.offsets[_track + 1] - r0;
+  track.rotations = Keys<RawAnimation::RotationKey, math::Quaternion>(
+    rotations_.times + r0, rotations_.values + r0, rn);
+  const size_t s0 = scales_.offsets[_track];
+  const size_t sn = scales_.offsets[_track + 1] - s0;
+  track.scales = Keys<RawAnimation::ScaleKey, math::Float3>(
+    scales_.times + s0, scales_.values + s0, sn);
+  if (translations_.tangents) {
+    track.translation_tangents =
+      Tangents<math::Float3>(translations_.tangents + t0, tn);
+    track.rotation_tangents =
+      Tangents<math::Float4>(rotations_.tangents + r0, rn);
+    track.scale_tangents = Tangents<math::Float3>(scales_.tangents + s0, sn);
+  }
+  return track;
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,205 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/pose_texture_builder.h"
+
+#include <cmath>
+
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+PoseTexture::PoseTexture()
+    : format(kMatrix),
+      num_joints(0),
+      num_frames(0),
+      frame_rate(0.f),
+      duration(0.f) {
+}
+
+namespace {
+// Writes _count values to _stream, little endian.
+template<typename _Ty>
+bool WriteLittleEndian(io::Stream* _stream, const _Ty* _values,
+                       size_t _count) {
+  if (GetNativeEndianness() == kLittleEndian) {
+    return _stream->Write(_values, _count * sizeof(_Ty)) ==
+           _count * sizeof(_Ty);
+  }
+  for (size_t i = 0; i < _count; ++i) {
+    const _Ty swapped = EndianSwap(_values[i]);
+    if (_stream->Write(&swapped, sizeof(_Ty)) != sizeof(_Ty)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Stores the 4 components of _v as half floats to _texel.
+void StoreHalf(math::SimdFloat4 _v, uint16_t* _texel) {
+  int halves[4];
+  math::StorePtrU(math::FloatToHalf(_v), halves);
+  for (int i = 0; i < 4; ++i) {
+    _texel[i] = static_cast<uint16_t>(halves[i]);
+  }
+}
+}  // namespace
+
+bool PoseTexture::Save(io::Stream* _stream) const {
+  if (!_stream || num_joints <= 0 || num_frames <= 0 ||
+      texels.size() != static_cast<size_t>(width() * height() * 4)) {
+    return false;
+  }
+  const char identifier[4] = {'o', 'z', 'z', 't'};
+  const uint32_t header[] = {1,
+                             static_cast<uint32_t>(format),
+                             static_cast<uint32_t>(num_joints),
+                             static_cast<uint32_t>(num_frames),
+                             static_cast<uint32_t>(width()),
+                             static_cast<uint32_t>(height())};
+  const float timing[] = {frame_rate, duration};
+  return _stream->Write(identifier, sizeof(identifier)) ==
+           sizeof(identifier) &&
+         WriteLittleEndian(_stream, header, OZZ_ARRAY_SIZE(header)) &&
+         WriteLittleEndian(_stream, timing, OZZ_ARRAY_SIZE(timing)) &&
+         WriteLittleEndian(_stream, &texels[0], texels.size());
+}
+
+PoseTextureBuilder::PoseTextureBuilder()
+    : sampling_rate(30.f),
+      format(PoseTexture::kMatrix) {
+}
+
+bool PoseTextureBuilder::operator()(const Animation& _animation,
+                                    const Skeleton& _skeleton,
+                                    PoseTexture* _texture) const {
+  const int num_joints = _skeleton.num_joints();
+  if (!_texture || !(sampling_rate > 0.f) ||
+      _animation.num_tracks() != num_joints) {
+    return false;
+  }
+
+  // Computes evenly spaced frames, the last one at the end of the animation.
+  const float duration = _animation.duration();
+  const int intervals = static_cast<int>(std::ceil(duration * sampling_rate));
+  const float frame_rate =
+    intervals > 0 ? intervals / duration : sampling_rate;
+
+  PoseTexture& texture = *_texture;
+  texture.format = format;
+  texture.num_joints = num_joints;
+  texture.num_frames = intervals + 1;
+  texture.frame_rate = frame_rate;
+  texture.duration = duration;
+  texture.texels.resize(texture.width() * texture.height() * 4);
+
+  // Allocates sampling buffers.
+  memory::Allocator* allocator = memory::default_allocator();
+  Range<math::SoaTransform> locals =
+    allocator->AllocateRange<math::SoaTransform>(_skeleton.num_soa_joints());
+  Range<math::Float4x4> models =
+    allocator->AllocateRange<math::Float4x4>(num_joints);
+  Range<math::SimdFloat4> previous =
+    allocator->AllocateRange<math::SimdFloat4>(num_joints);
+  SamplingCache* cache = allocator->New<SamplingCache>(num_joints);
+
+  bool success = true;
+  const int texels_per_joint = texture.texels_per_joint();
+  for (int f = 0; success && f < texture.num_frames; ++f) {
+    SamplingJob sampling_job;
+    sampling_job.animation = &_animation;
+    sampling_job.cache = cache;
+    sampling_job.time = f == intervals ? duration : f / frame_rate;
+    sampling_job.output = locals;
+    success &= sampling_job.Run();
+
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = &_skeleton;
+    ltm_job.input = locals;
+    ltm_job.output = models;
+    success &= ltm_job.Run();
+
+    uint16_t* row = &texture.texels[f * texture.width() * 4];
+    for (int j = 0; j < num_joints; ++j) {
+      uint16_t* texel = row + j * texels_per_joint * 4;
+      const math::Float4x4& model = models[j];
+      if (format == PoseTexture::kMatrix) {
+        math::SimdFloat4 rows[4];
+        math::Transpose4x4(model.cols, rows);
+        StoreHalf(rows[0], texel + 0);
+        StoreHalf(rows[1], texel + 4);
+        StoreHalf(rows[2], texel + 8);
+      } else {
+        math::SimdFloat4 translation, real, scale;
+        if (!ToAffine(model, &translation, &real, &scale)) {
+          real = math::simd_float4::w_axis();
+        }
+
+        // Keeps the quaternion on the hemisphere of the previous frame.
+        if (f > 0 && math::GetX(math::Dot4(real, previous[j])) < 0.f) {
+          real = -real;
+        }
+        previous[j] = real;
+
+        // Dual part is half the product of the translation quaternion
+        // (t, 0) and the real part.
+        const math::SimdFloat4 t = math::SetW(translation, 0.f);
+        const math::SimdFloat4 vector =
+          t * math::SplatW(real) + math::Cross3(t, real);
+        const math::SimdFloat4 dual =
+          math::SetW(vector, -math::GetX(math::Dot3(t, real))) *
+          math::simd_float4::Load1(.5f);
+        StoreHalf(real, texel + 0);
+        StoreHalf(dual, texel + 4);
+      }
+    }
+  }
+
+  allocator->Delete(cache);
+  allocator->Deallocate(previous);
+  allocator->Deallocate(models);
+  allocator->Deallocate(locals);
+
+  return success;
+}
+}  // offline
+}  // animation
+}  // ozz
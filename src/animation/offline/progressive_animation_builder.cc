@@ -0,0 +1,112 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/progressive_animation_builder.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/progressive_animation.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+ProgressiveAnimationBuilder::ProgressiveAnimationBuilder() {
+  tolerance_scales.push_back(16.f);
+  tolerance_scales.push_back(4.f);
+  tolerance_scales.push_back(1.f);
+}
+
+ProgressiveAnimation* ProgressiveAnimationBuilder::operator()(
+  const RawAnimation& _raw_animation) const {
+  return Build(_raw_animation, NULL);
+}
+
+ProgressiveAnimation* ProgressiveAnimationBuilder::operator()(
+  const RawAnimation& _raw_animation,
+  const Skeleton& _skeleton) const {
+  return Build(_raw_animation, &_skeleton);
+}
+
+ProgressiveAnimation* ProgressiveAnimationBuilder::Build(
+  const RawAnimation& _raw_animation,
+  const Skeleton* _skeleton) const {
+  OZZ_PROFILE_SCOPE("ProgressiveAnimationBuilder::operator()");
+
+  // Validates tolerance scales.
+  const int num_levels = static_cast<int>(tolerance_scales.size());
+  if (!num_levels) {
+    return NULL;
+  }
+  for (int i = 0; i < num_levels; ++i) {
+    if (tolerance_scales[i] <= 0.f ||
+        (i > 0 && tolerance_scales[i] >= tolerance_scales[i - 1])) {
+      return NULL;
+    }
+  }
+
+  // Analyzes the raw animation once for all levels.
+  AnimationOptimizer level_optimizer = optimizer;
+  level_optimizer.report = NULL;
+  AnimationOptimizer::Analysis analysis;
+  if (!level_optimizer.Analyze(_raw_animation, &analysis)) {
+    return NULL;
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  ProgressiveAnimation* progressive = allocator->New<ProgressiveAnimation>();
+  progressive->Reset(num_levels);
+  RawAnimation raw_level;
+  for (int i = 0; i < num_levels; ++i) {
+    const float scale = tolerance_scales[i];
+    level_optimizer.translation_tolerance =
+      optimizer.translation_tolerance * scale;
+    level_optimizer.rotation_tolerance = optimizer.rotation_tolerance * scale;
+    level_optimizer.scale_tolerance = optimizer.scale_tolerance * scale;
+    level_optimizer.hierarchical_tolerance =
+      optimizer.hierarchical_tolerance * scale;
+    const bool extracted =
+      _skeleton ? level_optimizer(analysis, *_skeleton, &raw_level)
+                : level_optimizer(analysis, &raw_level);
+    Animation* level = extracted ? builder(raw_level) : NULL;
+    if (!progressive->PushLevel(level)) {
+      allocator->Delete(level);
+      allocator->Delete(progressive);
+      return NULL;
+    }
+  }
+  return progressive;
+}
+}  // offline
+}  // animation
+}  // ozz
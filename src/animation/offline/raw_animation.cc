@@ -36,7 +36,8 @@ namespace animation {
 namespace offline {
 
 RawAnimation::RawAnimation()
-  : duration(1.f) {
+  : duration(1.f),
+    interpolation(kLinear) {
 }
 
 RawAnimation::~RawAnimation() {
@@ -82,6 +83,13 @@ bool RawAnimation::Validate() const {
         !ValidateTrack<ScaleKey>(track.scales, duration)) {
       return false;
     }
+    // Hermite interpolation requires a tangent per key.
+    if (interpolation == kHermite &&
+        (track.translation_tangents.size() != track.translations.size() ||
+         track.rotation_tangents.size() != track.rotations.size() ||
+         track.scale_tangents.size() != track.scales.size())) {
+      return false;
+    }
   }
 
   return true;  // *this is valid.
@@ -45,6 +45,7 @@ void Save(OArchive& _archive,
   for (size_t i = 0; i < _count; ++i) {
     const animation::offline::RawAnimation& animation = _animations[i];
     _archive << animation.duration;
+    _archive << static_cast<int32_t>(animation.interpolation);
     _archive << animation.tracks;
   }
 }
@@ -54,10 +55,18 @@ void Load(IArchive& _archive,
           animation::offline::RawAnimation* _animations,
           size_t _count,
           uint32_t _version) {
-  (void)_version;
   for (size_t i = 0; i < _count; ++i) {
     animation::offline::RawAnimation& animation = _animations[i];
     _archive >> animation.duration;
+    // Version 1 animations are linearly interpolated.
+    animation.interpolation = animation::offline::RawAnimation::kLinear;
+    if (_version > 1) {
+      int32_t interpolation;
+      _archive >> interpolation;
+      animation.interpolation =
+        static_cast<animation::offline::RawAnimation::Interpolation>(
+          interpolation);
+    }
     _archive >> animation.tracks;
   }
 }
@@ -66,7 +75,7 @@ void Load(IArchive& _archive,
 // this cpp file only.
 
 
-OZZ_IO_TYPE_VERSION(1, animation::offline::RawAnimation::JointTrack)
+OZZ_IO_TYPE_VERSION(2, animation::offline::RawAnimation::JointTrack)
 
 template <>
 void Save(OArchive& _archive,
@@ -77,6 +86,9 @@ void Save(OArchive& _archive,
     _archive << track.translations;
     _archive << track.rotations;
     _archive << track.scales;
+    _archive << track.translation_tangents;
+    _archive << track.rotation_tangents;
+    _archive << track.scale_tangents;
   }
 }
 
@@ -85,12 +97,20 @@ void Load(IArchive& _archive,
           animation::offline::RawAnimation::JointTrack* _tracks,
           size_t _count,
           uint32_t _version) {
-  (void)_version;
   for (size_t i = 0; i < _count; ++i) {
     animation::offline::RawAnimation::JointTrack& track = _tracks[i];
     _archive >> track.translations;
     _archive >> track.rotations;
     _archive >> track.scales;
+    // Version 1 tracks have no tangent.
+    track.translation_tangents.clear();
+    track.rotation_tangents.clear();
+    track.scale_tangents.clear();
+    if (_version > 1) {
+      _archive >> track.translation_tangents;
+      _archive >> track.rotation_tangents;
+      _archive >> track.scale_tangents;
+    }
   }
 }
 
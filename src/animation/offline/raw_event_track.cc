@@ -0,0 +1,62 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/raw_event_track.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+RawEventTrack::RawEventTrack()
+  : duration(1.f) {
+}
+
+RawEventTrack::~RawEventTrack() {
+}
+
+bool RawEventTrack::Validate() const {
+  if (duration <= 0.f) {  // Tests duration is valid.
+    return false;
+  }
+  // Ensures that all events' time are valid, ie: in ascending order and
+  // within range [0:duration].
+  float previous_time = 0.f;
+  for (size_t e = 0; e < events.size(); ++e) {
+    const float event_time = events[e].time;
+    if (event_time < previous_time || event_time > duration) {
+      return false;
+    }
+    previous_time = event_time;
+  }
+  return true;  // *this is valid.
+}
+}  // offline
+}  // animation
+}  // ozz
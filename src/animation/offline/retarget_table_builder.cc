@@ -0,0 +1,170 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/retarget_table_builder.h"
+
+#include "ozz/base/containers/flat_map.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/runtime/retarget_table.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Stores each traversed joint to a vector, in the order of the runtime
+// skeleton built by the SkeletonBuilder.
+struct JointLister {
+  explicit JointLister(int _num_joints) {
+    linear_joints.reserve(_num_joints);
+  }
+  void operator()(const RawSkeleton::Joint& _current,
+                  const RawSkeleton::Joint* _parent) {
+    (void)_parent;
+    linear_joints.push_back(&_current);
+  }
+  // Array of joints in the traversed DAG order.
+  ozz::Vector<const RawSkeleton::Joint*>::Std linear_joints;
+};
+
+// Returns the ratio _a / _b, or _a if _b is 0.
+float Ratio(float _a, float _b) {
+  return _b != 0.f ? _a / _b : _a;
+}
+}  // namespace
+
+RetargetTable* RetargetTableBuilder::operator()(
+  const RawSkeleton& _source, const RawSkeleton& _target) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  // Tests raw skeletons validity.
+  if (!_source.Validate() || !_target.Validate()) {
+    return NULL;
+  }
+
+  // Lists joints of both skeletons in runtime order.
+  JointLister source(_source.num_joints());
+  _source.IterateJointsBF<JointLister&>(source);
+  JointLister target(_target.num_joints());
+  _target.IterateJointsBF<JointLister&>(target);
+  const int num_source_joints = static_cast<int>(source.linear_joints.size());
+  const int num_joints = static_cast<int>(target.linear_joints.size());
+
+  // Indexes source joints by name, sorting them once. The first joint is kept
+  // if names are duplicated, as Skeleton::FindJoint() does.
+  typedef ozz::CStringFlatMap<int>::Type NameMap;
+  ozz::Vector<NameMap::value_type>::Std elements;
+  elements.reserve(num_source_joints);
+  for (int i = 0; i < num_source_joints; ++i) {
+    elements.push_back(
+      std::make_pair(source.linear_joints[i]->name.c_str(), i));
+  }
+  NameMap names;
+  names.assign(elements.begin(), elements.end());
+
+  // Everything is fine, allocates and fills the table.
+  RetargetTable* table = memory::default_allocator()->New<RetargetTable>();
+  table->Allocate(num_joints, num_source_joints);
+
+  for (int i = 0; i < table->num_soa_joints(); ++i) {
+    math::SimdFloat4 rotations[4];
+    math::SimdFloat4 translations[4];
+    float ratios[4];
+    math::SimdFloat4 scales[4];
+    for (int j = 0; j < 4; ++j) {
+      const int joint = i * 4 + j;
+      uint16_t& source_index = table->sources_[joint];
+      source_index = Skeleton::kNoParentIndex;
+
+      // Padding lanes are mapped to nothing, with identity corrections.
+      if (joint >= num_joints) {
+        rotations[j] = math::simd_float4::w_axis();
+        translations[j] = math::simd_float4::zero();
+        ratios[j] = 0.f;
+        scales[j] = math::simd_float4::one();
+        continue;
+      }
+
+      // Target bind pose is the correction of unmapped joints.
+      const math::Transform& target_bind =
+        target.linear_joints[joint]->transform;
+      const math::Quaternion target_rotation =
+        NormalizeSafe(target_bind.rotation, math::Quaternion::identity());
+      NameMap::const_iterator it =
+        names.find(target.linear_joints[joint]->name.c_str());
+      if (it == names.end()) {
+        rotations[j] = math::simd_float4::LoadPtrU(&target_rotation.x);
+        translations[j] =
+          math::simd_float4::Load3PtrU(&target_bind.translation.x);
+        ratios[j] = 0.f;
+        scales[j] = math::simd_float4::Load3PtrU(&target_bind.scale.x);
+        continue;
+      }
+      source_index = static_cast<uint16_t>(it->second);
+
+      // Computes mapped joint corrections.
+      const math::Transform& source_bind =
+        source.linear_joints[it->second]->transform;
+      const math::Quaternion source_rotation =
+        NormalizeSafe(source_bind.rotation, math::Quaternion::identity());
+      const math::Quaternion rotation =
+        target_rotation * Conjugate(source_rotation);
+      const float source_length = Length(source_bind.translation);
+      const float ratio = source_length != 0.f ?
+        Length(target_bind.translation) / source_length : 1.f;
+      const math::Float3 translation =
+        target_bind.translation - source_bind.translation * ratio;
+      const math::Float3 scale(
+        Ratio(target_bind.scale.x, source_bind.scale.x),
+        Ratio(target_bind.scale.y, source_bind.scale.y),
+        Ratio(target_bind.scale.z, source_bind.scale.z));
+      rotations[j] = math::simd_float4::LoadPtrU(&rotation.x);
+      translations[j] = math::simd_float4::Load3PtrU(&translation.x);
+      ratios[j] = ratio;
+      scales[j] = math::simd_float4::Load3PtrU(&scale.x);
+    }
+
+    // Fills the soa correction.
+    RetargetTable::SoaCorrection& correction = table->corrections_[i];
+    math::Transpose4x4(rotations, &correction.rotation.x);
+    math::Transpose4x3(translations, &correction.translation.x);
+    correction.translation_ratio = math::simd_float4::LoadPtrU(ratios);
+    math::Transpose4x3(scales, &correction.scale.x);
+  }
+
+  return table;  // Success.
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,242 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/root_motion_builder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/root_motion.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+RootMotionBuilder::RootMotionBuilder()
+    : root(0),
+      vertical(false),
+      yaw(true),
+      translation_tolerance(1e-3f),
+      yaw_tolerance(1e-3f) {
+}
+
+namespace {
+// Compares key time with a time value, used to search keys.
+struct KeyTimeLess {
+  template <typename _Key>
+  bool operator()(float _time, const _Key& _key) const {
+    return _time < _key.time;
+  }
+};
+
+// Finds the keys surrounding _time in _keys, and the interpolation ratio
+// between them. _keys must not be empty.
+template <typename _Keys>
+void Locate(const _Keys& _keys, float _time,
+            size_t* _left, size_t* _right, float* _alpha) {
+  const size_t right = std::upper_bound(_keys.begin(), _keys.end(), _time,
+                                        KeyTimeLess()) - _keys.begin();
+  if (right == 0) {
+    *_left = *_right = 0;
+    *_alpha = 0.f;
+  } else if (right == _keys.size()) {
+    *_left = *_right = right - 1;
+    *_alpha = 0.f;
+  } else {
+    *_left = right - 1;
+    *_right = right;
+    *_alpha = (_time - _keys[right - 1].time) /
+              (_keys[right].time - _keys[right - 1].time);
+  }
+}
+
+// Linearly samples a root translation, as the sampling job does.
+math::Float3 SampleTranslation(const RawAnimation::JointTrack& _track,
+                               float _time) {
+  if (_track.translations.empty()) {
+    return RawAnimation::TranslationKey::identity();
+  }
+  size_t left, right;
+  float alpha;
+  Locate(_track.translations, _time, &left, &right, &alpha);
+  return math::Lerp(_track.translations[left].value,
+                    _track.translations[right].value, alpha);
+}
+
+// Linearly samples a root rotation, as the sampling job does.
+math::Quaternion SampleRotation(const RawAnimation::JointTrack& _track,
+                                float _time) {
+  if (_track.rotations.empty()) {
+    return RawAnimation::RotationKey::identity();
+  }
+  size_t left, right;
+  float alpha;
+  Locate(_track.rotations, _time, &left, &right, &alpha);
+  const math::Quaternion& a = _track.rotations[left].value;
+  const math::Quaternion& b = _track.rotations[right].value;
+  const float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+  return math::NLerp(a, dot < 0.f ? -b : b, alpha);
+}
+
+// Computes the yaw of rotation _q, which is the angle around y axis of the
+// rotated z axis.
+float ExtractYaw(const math::Quaternion& _q) {
+  return std::atan2(2.f * (_q.x * _q.z + _q.w * _q.y),
+                    1.f - 2.f * (_q.x * _q.x + _q.y * _q.y));
+}
+
+// Returns true if all the keys in range ]_left,_right[ can be interpolated
+// from _left and _right within tolerances.
+bool CanInterpolate(const RootMotion::Key* _keys, size_t _left, size_t _right,
+                    float _translation_tolerance, float _yaw_tolerance) {
+  const RootMotion::Key& left = _keys[_left];
+  const RootMotion::Key& right = _keys[_right];
+  for (size_t i = _left + 1; i < _right; ++i) {
+    const RootMotion::Key& key = _keys[i];
+    const float alpha = (key.time - left.time) / (right.time - left.time);
+    const math::Float3 translation =
+        math::Lerp(left.translation, right.translation, alpha);
+    const float yaw = left.yaw + (right.yaw - left.yaw) * alpha;
+    if (Length(translation - key.translation) > _translation_tolerance ||
+        std::abs(yaw - key.yaw) > _yaw_tolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+RootMotion* RootMotionBuilder::operator()(const RawAnimation& _input,
+                                          RawAnimation* _output) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  // Validates inputs. An animation without any track is motionless.
+  const int num_tracks = _input.num_tracks();
+  if (!_input.Validate() || root < 0 || (num_tracks && root >= num_tracks) ||
+      (_output && _input.interpolation != RawAnimation::kLinear)) {
+    return NULL;
+  }
+  const RawAnimation::JointTrack empty_track;
+  const RawAnimation::JointTrack& track =
+      num_tracks ? _input.tracks[root] : empty_track;
+
+  // Motion is sampled at every root translation and rotation key time.
+  ozz::Vector<float>::Std times;
+  for (size_t i = 0; i < track.translations.size(); ++i) {
+    times.push_back(track.translations[i].time);
+  }
+  for (size_t i = 0; i < track.rotations.size(); ++i) {
+    times.push_back(track.rotations[i].time);
+  }
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+  if (times.empty()) {
+    times.push_back(0.f);
+  }
+
+  // Extracts motion keys, unwrapping yaw so that it's continuous.
+  ozz::Vector<RootMotion::Key>::Std keys(times.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    RootMotion::Key& key = keys[i];
+    key.time = times[i];
+    const math::Float3 translation = SampleTranslation(track, key.time);
+    key.translation = math::Float3(translation.x,
+                                   vertical ? translation.y : 0.f,
+                                   translation.z);
+    key.yaw = yaw ? ExtractYaw(SampleRotation(track, key.time)) : 0.f;
+    if (i > 0) {
+      const float previous = keys[i - 1].yaw;
+      while (key.yaw - previous > math::kPi) {
+        key.yaw -= math::k2Pi;
+      }
+      while (key.yaw - previous < -math::kPi) {
+        key.yaw += math::k2Pi;
+      }
+    }
+  }
+
+  // Removes the motion from the root track, which is resampled at motion key
+  // times: root' = motion^-1 * root.
+  if (_output) {
+    *_output = _input;
+  }
+  if (_output && num_tracks) {
+    RawAnimation::JointTrack& output_track = _output->tracks[root];
+    output_track.translations.clear();
+    output_track.rotations.clear();
+    for (size_t i = 0; i < keys.size(); ++i) {
+      const RootMotion::Key& key = keys[i];
+      const float c = std::cos(key.yaw);
+      const float s = std::sin(key.yaw);
+      const math::Float3 delta =
+          SampleTranslation(track, key.time) - key.translation;
+      const RawAnimation::TranslationKey translation = {
+          key.time, math::Float3(delta.x * c - delta.z * s, delta.y,
+                                 delta.x * s + delta.z * c)};
+      output_track.translations.push_back(translation);
+      const math::Quaternion inv_yaw = math::Quaternion::FromAxisAngle(
+          math::Float4(0.f, 1.f, 0.f, -key.yaw));
+      const RawAnimation::RotationKey rotation = {
+          key.time, Normalize(inv_yaw * SampleRotation(track, key.time))};
+      output_track.rotations.push_back(rotation);
+    }
+  }
+
+  // Reduces keys: a key is kept when the keys since the last kept one can't
+  // be interpolated without it.
+  ozz::Vector<RootMotion::Key>::Std reduced;
+  reduced.push_back(keys.front());
+  size_t last = 0;
+  for (size_t i = 1; i + 1 < keys.size(); ++i) {
+    if (!CanInterpolate(&keys[0], last, i + 1, translation_tolerance,
+                        yaw_tolerance)) {
+      reduced.push_back(keys[i]);
+      last = i;
+    }
+  }
+  if (keys.size() > 1) {
+    reduced.push_back(keys.back());
+  }
+
+  // Allocates and fills the runtime root motion.
+  RootMotion* motion = memory::default_allocator()->New<RootMotion>();
+  motion->Allocate(static_cast<int>(reduced.size()));
+  motion->duration_ = _input.duration;
+  std::copy(reduced.begin(), reduced.end(), motion->keys_);
+  return motion;
+}
+}  // offline
+}  // animation
+}  // ozz
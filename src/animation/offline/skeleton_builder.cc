@@ -32,9 +32,10 @@
 
 #include <cstring>
 
-#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/runtime/skeleton.h"
 
@@ -43,89 +44,133 @@ namespace animation {
 namespace offline {
 
 namespace {
-// Stores each traversed joint to a vector.
-struct JointLister {
-  explicit JointLister(int _num_joints) {
-    linear_joints.reserve(_num_joints);
-  }
-  void operator()(const RawSkeleton::Joint& _current,
-                  const RawSkeleton::Joint* _parent) {
-    // Looks for the "lister" parent.
-    int parent = Skeleton::kNoParentIndex;
-    if (_parent) {
-      // Start searching from the last joint.
-      int j = static_cast<int>(linear_joints.size()) - 1;
-      for (; j >= 0; --j) {
-        if (linear_joints[j].joint == _parent) {
-          parent = j;
-          break;
-        }
+// Defines a joint listed in the order of the runtime skeleton.
+struct ListedJoint {
+  const RawSkeleton::Joint* joint;
+  int parent;
+};
+
+// Defines a group of sibling joints whose children remain to be listed.
+struct SiblingGroup {
+  const RawSkeleton::Joint::Children* joints;
+  int first;  // Index of the first sibling in the listed joints.
+  size_t next;  // Next sibling whose children must be listed.
+};
+
+// Lists _raw_skeleton joints to _joints in RawSkeleton::IterateJointsBF order:
+// all siblings are listed first, then the children of each of them in turn.
+// The traversal is iterative, using _stack to store pending sibling groups.
+// _joints and _stack must be able to store as many elements as there are
+// joints. Parent indices are known when siblings are listed, so no search is
+// needed.
+void ListJoints(const RawSkeleton& _raw_skeleton,
+                ListedJoint* _joints,
+                SiblingGroup* _stack) {
+  int num_listed = 0;
+  int depth = 0;
+  const RawSkeleton::Joint::Children* children = &_raw_skeleton.roots;
+  int parent = Skeleton::kNoParentIndex;
+  for (;;) {
+    // Lists all the siblings, and pushes them to the stack so that their
+    // children are listed afterwards.
+    if (!children->empty()) {
+      const SiblingGroup group = {children, num_listed, 0};
+      for (size_t i = 0; i < children->size(); ++i, ++num_listed) {
+        const ListedJoint listed = {&(*children)[i], parent};
+        _joints[num_listed] = listed;
       }
-      assert(parent >= 0);
+      _stack[depth++] = group;
+    }
+
+    // Finds the next sibling with children to list.
+    children = NULL;
+    while (depth && !children) {
+      SiblingGroup& top = _stack[depth - 1];
+      if (top.next == top.joints->size()) {
+        --depth;
+        continue;
+      }
+      const size_t sibling = top.next++;
+      if (!(*top.joints)[sibling].children.empty()) {
+        children = &(*top.joints)[sibling].children;
+        parent = top.first + static_cast<int>(sibling);
+      }
+    }
+    if (!children) {
+      break;
     }
-    const Joint listed = {&_current, parent};
-    linear_joints.push_back(listed);
   }
-  struct Joint {
-    const RawSkeleton::Joint* joint;
-    int parent;
-  };
-  // Array of joints in the traversed DAG order.
-  ozz::Vector<Joint>::Std linear_joints;
-};
+}
 }  // namespace
 
+SkeletonBuilder::SkeletonBuilder()
+    : dispatcher(NULL) {
+}
+
 // Validates the RawSkeleton and fills a Skeleton.
-// Uses RawSkeleton::IterateJointsBF to traverse in DAG breadth-first order.
+// Joints are sorted in RawSkeleton::IterateJointsBF order (see ListJoints).
 // This favors cache coherency (when traversing joints) and reduces
 // Load-Hit-Stores (reusing the parent that has just been computed).
 Skeleton* SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton) const {
-  // Tests _raw_skeleton validity.
-  if (!_raw_skeleton.Validate()) {
+  OZZ_PROFILE_SCOPE("SkeletonBuilder::operator()");
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  // Tests _raw_skeleton validity. This is the same test as
+  // RawSkeleton::Validate(), without counting joints twice.
+  const int num_joints = _raw_skeleton.num_joints();
+  if (num_joints > Skeleton::kMaxJoints) {
     return NULL;
   }
 
   // Everything is fine, allocates and fills the skeleton.
   // Will not fail.
-  Skeleton* skeleton = memory::default_allocator()->New<Skeleton>();
-  const int num_joints = _raw_skeleton.num_joints();
+  memory::Allocator* allocator = memory::default_allocator();
+  Skeleton* skeleton = allocator->New<Skeleton>();
   skeleton->num_joints_ = num_joints;
   const int num_soa_joints = skeleton->num_soa_joints();
 
   // Iterates through all the joint of the raw skeleton and fills a sorted joint
-  // list.
-  JointLister lister(num_joints);
-  _raw_skeleton.IterateJointsBF<JointLister&>(lister);
-  assert(static_cast<int>(lister.linear_joints.size()) == num_joints);
+  // list. Listed joints and traversal stack share a single allocation.
+  const size_t scratch_size =
+    num_joints * (sizeof(ListedJoint) + sizeof(SiblingGroup));
+  void* scratch =
+    allocator->Allocate(scratch_size, AlignOf<SiblingGroup>::value);
+  SiblingGroup* stack = static_cast<SiblingGroup*>(scratch);
+  ListedJoint* linear_joints =
+    reinterpret_cast<ListedJoint*>(stack + num_joints);
+  ListJoints(_raw_skeleton, linear_joints, stack);
 
   // Transfers sorted joints hierarchy to the new skeleton.
   skeleton->joint_properties_ =
-    memory::default_allocator()->Allocate<Skeleton::JointProperties>(num_joints);
+    skeleton->allocator_->Allocate<Skeleton::JointProperties>(num_joints);
   for (int i = 0; i < num_joints; ++i) {
-    skeleton->joint_properties_[i].parent = lister.linear_joints[i].parent;
+    skeleton->joint_properties_[i].parent = linear_joints[i].parent;
     skeleton->joint_properties_[i].is_leaf =
-      lister.linear_joints[i].joint->children.empty();
+      linear_joints[i].joint->children.empty();
   }
   // Transfers joint's names: First computes name's buffer size, then allocate
   // and do the copy.
   size_t buffer_size = num_joints * sizeof(char*);
   for (int i = 0; i < num_joints; ++i) {
-    const RawSkeleton::Joint& current = *lister.linear_joints[i].joint;
+    const RawSkeleton::Joint& current = *linear_joints[i].joint;
     buffer_size += (current.name.size() + 1) * sizeof(char);
   }
   skeleton->joint_names_ =
-    memory::default_allocator()->Allocate<char*>(buffer_size);
+    skeleton->allocator_->Allocate<char*>(buffer_size);
   char* cursor = reinterpret_cast<char*>(skeleton->joint_names_ + num_joints);
   for (int i = 0; i < num_joints; ++i) {
-    const RawSkeleton::Joint& current = *lister.linear_joints[i].joint;
+    const RawSkeleton::Joint& current = *linear_joints[i].joint;
     skeleton->joint_names_[i] = cursor;
     strcpy(cursor, current.name.c_str());
     cursor += (current.name.size() + 1) * sizeof(char);
   }
 
+  // Builds joint names lookup table.
+  skeleton->BuildJointNamesLookup(dispatcher);
+
   // Transfers t-poses.
   skeleton->bind_pose_ =
-    memory::default_allocator()->Allocate<math::SoaTransform>(num_soa_joints);
+    skeleton->allocator_->Allocate<math::SoaTransform>(num_soa_joints);
 
   const math::SimdFloat4 w_axis = math::simd_float4::w_axis();
   const math::SimdFloat4 zero = math::simd_float4::zero();
@@ -138,7 +183,7 @@ Skeleton* SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton) const {
     for (int j = 0; j < 4; ++j) {
       if (i * 4 + j < num_joints) {
         const RawSkeleton::Joint& src_joint =
-          *lister.linear_joints[i * 4 + j].joint;
+          *linear_joints[i * 4 + j].joint;
         translations[j] =
           math::simd_float4::Load3PtrU(&src_joint.transform.translation.x);
         rotations[j] = math::NormalizeSafe4(
@@ -156,6 +201,9 @@ Skeleton* SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton) const {
     math::Transpose4x4(rotations, &skeleton->bind_pose_[i].rotation.x);
     math::Transpose4x3(scales, &skeleton->bind_pose_[i].scale.x);
   }
+  skeleton->DetectScale();
+
+  allocator->Deallocate(scratch);
 
   return skeleton;  // Success.
 }
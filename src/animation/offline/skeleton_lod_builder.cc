@@ -0,0 +1,251 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/skeleton_lod_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Defines the importance of a joint, used to sort joints.
+struct Importance {
+  // Number of vertices influenced by the joint and its descendants.
+  int influences;
+  // Number of joints of the hierarchy of the joint, including itself.
+  int joints;
+  // Depth of the joint in the skeleton.
+  int depth;
+};
+
+bool operator==(const Importance& _a, const Importance& _b) {
+  return _a.influences == _b.influences &&
+         _a.joints == _b.joints &&
+         _a.depth == _b.depth;
+}
+
+// Sorts joint indices by decreasing importance, and by increasing index for
+// joints of equal importance.
+struct ImportanceLess {
+  explicit ImportanceLess(const ozz::Vector<Importance>::Std& _importances)
+      : importances(_importances) {
+  }
+  bool operator()(int _a, int _b) const {
+    const Importance& a = importances[_a];
+    const Importance& b = importances[_b];
+    if (a.influences != b.influences) {
+      return a.influences > b.influences;
+    }
+    if (a.joints != b.joints) {
+      return a.joints > b.joints;
+    }
+    if (a.depth != b.depth) {
+      return a.depth < b.depth;
+    }
+    return _a < _b;
+  }
+  const ozz::Vector<Importance>::Std& importances;
+};
+}  // namespace
+
+SkeletonLodBuilder::SkeletonLodBuilder() {
+  lod_ratios.push_back(1.f);
+  lod_ratios.push_back(.5f);
+  lod_ratios.push_back(.25f);
+}
+
+Skeleton* SkeletonLodBuilder::operator()(const Skeleton& _skeleton,
+                                         ozz::Vector<int>::Std* _remap) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+
+  const int num_joints = _skeleton.num_joints();
+  const int num_soa_joints = _skeleton.num_soa_joints();
+
+  // Tests parameters validity.
+  bool valid = !lod_ratios.empty();
+  for (size_t i = 0; i < lod_ratios.size(); ++i) {
+    valid &= lod_ratios[i] > 0.f && lod_ratios[i] <= 1.f;
+    valid &= i == 0 || lod_ratios[i] <= lod_ratios[i - 1];
+  }
+  valid &= num_joints == 0 || _skeleton.joint_names() != NULL;
+  valid &= influences.empty() ||
+           influences.size() == static_cast<size_t>(num_joints);
+  for (size_t i = 0; i < influences.size(); ++i) {
+    valid &= influences[i] >= 0;
+  }
+  if (!valid) {
+    return NULL;
+  }
+
+  // Computes joints importance. Parents are stored before their children, so
+  // depths are computed forward, and hierarchy accumulations backward.
+  Range<const Skeleton::JointProperties> properties =
+    _skeleton.joint_properties();
+  ozz::Vector<Importance>::Std importances(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = properties.begin[i].parent;
+    importances[i].influences = influences.empty() ? 1 : influences[i];
+    importances[i].joints = 1;
+    importances[i].depth =
+      parent == Skeleton::kNoParentIndex ? 0 : importances[parent].depth + 1;
+  }
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = properties.begin[i].parent;
+    if (parent != Skeleton::kNoParentIndex) {
+      importances[parent].influences += importances[i].influences;
+      importances[parent].joints += importances[i].joints;
+    }
+  }
+
+  // Sorts joints by importance. A parent always has more joints in its
+  // hierarchy than its children, and at least their influences, so sorting
+  // preserves the DAG order.
+  ozz::Vector<int>::Std order(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), ImportanceLess(importances));
+  ozz::Vector<int>::Std remap(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    remap[order[i]] = i;
+  }
+
+  // Allocates and fills the skeleton.
+  Skeleton* skeleton = memory::default_allocator()->New<Skeleton>();
+  skeleton->num_joints_ = num_joints;
+
+  // Transfers joints hierarchy, in the new order.
+  skeleton->joint_properties_ = skeleton->allocator_->
+    Allocate<Skeleton::JointProperties>(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const Skeleton::JointProperties& src = properties.begin[order[i]];
+    assert(src.parent == Skeleton::kNoParentIndex || remap[src.parent] < i);
+    skeleton->joint_properties_[i].parent =
+      src.parent == Skeleton::kNoParentIndex ?
+        static_cast<int>(Skeleton::kNoParentIndex) : remap[src.parent];
+    skeleton->joint_properties_[i].is_leaf = src.is_leaf;
+  }
+
+  // Transfers joint's names: First computes name's buffer size, then allocate
+  // and do the copy.
+  const char* const* names = _skeleton.joint_names();
+  size_t buffer_size = num_joints * sizeof(char*);
+  for (int i = 0; i < num_joints; ++i) {
+    buffer_size += (std::strlen(names[i]) + 1) * sizeof(char);
+  }
+  skeleton->joint_names_ =
+    skeleton->allocator_->Allocate<char*>(buffer_size);
+  char* cursor = reinterpret_cast<char*>(skeleton->joint_names_ + num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const char* name = names[order[i]];
+    skeleton->joint_names_[i] = cursor;
+    std::strcpy(cursor, name);
+    cursor += (std::strlen(name) + 1) * sizeof(char);
+  }
+
+  // Builds joint names lookup table.
+  skeleton->BuildJointNamesLookup(NULL);
+
+  // Transfers bind poses, going through aos transforms.
+  ozz::Vector<math::Transform>::Std bind_poses(num_soa_joints * 4);
+  for (int i = 0; i < num_soa_joints; ++i) {
+    const math::SoaTransform& src = _skeleton.bind_pose().begin[i];
+    math::SimdFloat4 translations[4];
+    math::SimdFloat4 rotations[4];
+    math::SimdFloat4 scales[4];
+    math::Transpose3x4(&src.translation.x, translations);
+    math::Transpose4x4(&src.rotation.x, rotations);
+    math::Transpose3x4(&src.scale.x, scales);
+    for (int j = 0; j < 4; ++j) {
+      math::Transform& transform = bind_poses[i * 4 + j];
+      math::Store3PtrU(translations[j], &transform.translation.x);
+      math::StorePtrU(rotations[j], &transform.rotation.x);
+      math::Store3PtrU(scales[j], &transform.scale.x);
+    }
+  }
+  skeleton->bind_pose_ =
+    skeleton->allocator_->Allocate<math::SoaTransform>(num_soa_joints);
+  for (int i = 0; i < num_soa_joints; ++i) {
+    math::SimdFloat4 translations[4];
+    math::SimdFloat4 rotations[4];
+    math::SimdFloat4 scales[4];
+    for (int j = 0; j < 4; ++j) {
+      if (i * 4 + j < num_joints) {
+        const math::Transform& src = bind_poses[order[i * 4 + j]];
+        translations[j] = math::simd_float4::Load3PtrU(&src.translation.x);
+        rotations[j] = math::simd_float4::LoadPtrU(&src.rotation.x);
+        scales[j] = math::simd_float4::Load3PtrU(&src.scale.x);
+      } else {
+        translations[j] = math::simd_float4::zero();
+        rotations[j] = math::simd_float4::w_axis();
+        scales[j] = math::simd_float4::one();
+      }
+    }
+    math::Transpose4x3(translations, &skeleton->bind_pose_[i].translation.x);
+    math::Transpose4x4(rotations, &skeleton->bind_pose_[i].rotation.x);
+    math::Transpose4x3(scales, &skeleton->bind_pose_[i].scale.x);
+  }
+  skeleton->DetectScale();
+
+  // Computes lods number of joints, extending each lod to the joints that have
+  // the same importance as its last one.
+  const int num_lods = static_cast<int>(lod_ratios.size());
+  skeleton->num_lods_ = num_lods;
+  skeleton->lod_num_joints_ =
+    skeleton->allocator_->Allocate<uint16_t>(num_lods);
+  for (int i = 0; i < num_lods; ++i) {
+    int count = static_cast<int>(std::ceil(lod_ratios[i] * num_joints));
+    count = math::Clamp(num_joints ? 1 : 0, count, num_joints);
+    while (count < num_joints &&
+           importances[order[count]] == importances[order[count - 1]]) {
+      ++count;
+    }
+    skeleton->lod_num_joints_[i] = static_cast<uint16_t>(count);
+  }
+
+  if (_remap) {
+    _remap->swap(remap);
+  }
+
+  return skeleton;  // Success.
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,143 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/sparse_animation_builder.h"
+
+#include <cmath>
+#include <cstddef>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_conversion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+// Returns true if every value of _keys is within _tolerance of _reference. An
+// empty channel is _identity.
+template<typename _Keys, typename _Value>
+bool IsUnchanged(const _Keys& _keys, const _Value& _identity,
+                 const _Value& _reference, float _tolerance) {
+  if (_keys.empty()) {
+    return Compare(_identity, _reference, _tolerance);
+  }
+  for (size_t i = 0; i < _keys.size(); ++i) {
+    if (!Compare(_keys[i].value, _reference, _tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compares rotations, which are the same if they are opposed.
+bool CompareRotation(const math::Quaternion& _a, const math::Quaternion& _b,
+                     float _tolerance) {
+  const float dot = _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+  return std::acos(math::Min(std::fabs(dot), 1.f)) <= _tolerance * .5f;
+}
+
+bool IsUnchanged(const RawAnimation::JointTrack::Rotations& _keys,
+                 const math::Quaternion& _reference, float _tolerance) {
+  if (_keys.empty()) {
+    return CompareRotation(math::Quaternion::identity(), _reference,
+                           _tolerance);
+  }
+  for (size_t i = 0; i < _keys.size(); ++i) {
+    if (!CompareRotation(_keys[i].value, _reference, _tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+SparseAnimationBuilder::SparseAnimationBuilder()
+    : translation_tolerance(1e-5f),
+      scale_tolerance(1e-5f),
+      rotation_tolerance(1e-5f),
+      dispatcher(NULL),
+      seek_interval(0.f),
+      key_links(false) {
+}
+
+Animation* SparseAnimationBuilder::operator()(
+  const RawAnimation& _input,
+  const Skeleton& _skeleton,
+  ozz::Vector<uint16_t>::Std* _joints) const {
+  memory::ScopedTag tag(memory::kTagOffline);
+  if (!_joints || !_input.Validate() ||
+      _input.num_tracks() != _skeleton.num_joints()) {
+    return NULL;
+  }
+
+  // Gets aos bind pose transforms.
+  const int num_joints = _skeleton.num_joints();
+  ozz::Vector<math::Transform>::Std bind_pose(num_joints);
+  if (num_joints != 0) {
+    math::FromSoa(_skeleton.bind_pose(),
+                  ozz::Range<math::Transform>(&bind_pose[0], num_joints));
+  }
+
+  // Copies animated tracks only.
+  RawAnimation sparse;
+  sparse.duration = _input.duration;
+  sparse.interpolation = _input.interpolation;
+  _joints->clear();
+  for (int i = 0; i < num_joints; ++i) {
+    const RawAnimation::JointTrack& track = _input.tracks[i];
+    const math::Transform& bind = bind_pose[i];
+    const bool unchanged =
+      IsUnchanged(track.translations, math::Float3::zero(), bind.translation,
+                  translation_tolerance) &&
+      IsUnchanged(track.rotations, bind.rotation, rotation_tolerance) &&
+      IsUnchanged(track.scales, math::Float3::one(), bind.scale,
+                  scale_tolerance);
+    if (!unchanged) {
+      sparse.tracks.push_back(track);
+      _joints->push_back(static_cast<uint16_t>(i));
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.dispatcher = dispatcher;
+  builder.seek_interval = seek_interval;
+  builder.key_links = key_links;
+  return builder(sparse);
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -0,0 +1,168 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/animation/offline/pose_texture_builder.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+
+#include "ozz/options/options.h"
+
+// anim2texture is a command line tool that bakes an ozz runtime animation to
+// a texture of model-space joint transforms, to evaluate the animation on the
+// GPU only.
+//
+// The animation is sampled at a fixed rate, and the model-space matrices (or
+// dual quaternions) of all the joints are quantized to half floats. See
+// ozz::animation::offline::PoseTexture for the output file layout, that can be
+// uploaded to a RGBA16F texture directly.
+//
+// Use anim2texture integrated help command (anim2texture --help) for more
+// details about available arguments.
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies ozz skeleton input file", "",
+                           true)
+OZZ_OPTIONS_DECLARE_STRING(animation, "Specifies ozz animation input file", "",
+                           true)
+OZZ_OPTIONS_DECLARE_STRING(texture, "Specifies pose texture output file", "",
+                           true)
+
+static bool ValidateSamplingRate(const ozz::options::Option& _option,
+                                 int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+    static_cast<const ozz::options::FloatOption&>(_option);
+  bool valid = option.value() > 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid sampling rate option." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(
+  sampling_rate,
+  "Selects texture sampling rate in hertz",
+  ozz::animation::offline::PoseTextureBuilder().sampling_rate,
+  false,
+  &ValidateSamplingRate)
+
+static bool ValidateFormat(const ozz::options::Option& _option,
+                           int /*_argc*/) {
+  const ozz::options::StringOption& option =
+    static_cast<const ozz::options::StringOption&>(_option);
+  bool valid = std::strcmp(option.value(), "matrix") == 0 ||
+               std::strcmp(option.value(), "dual_quaternion") == 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid format option." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING_FN(
+  format,
+  "Selects joint transforms format. Can be \"matrix\" (3 texels per joint) or "
+  "\"dual_quaternion\" (2 texels per joint, scale isn't supported).",
+  "matrix",
+  false,
+  &ValidateFormat)
+
+namespace {
+// Loads an object of type _Ty from ozz archive file _filename.
+template<typename _Ty>
+bool Load(const char* _filename, _Ty* _object) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open input file " << _filename << "." <<
+      std::endl;
+    return false;
+  }
+  ozz::io::BufferedStream stream(&file);
+  ozz::io::IArchive archive(&stream);
+  if (!archive.TestTag<_Ty>()) {
+    ozz::log::Err() << "Failed to read expected object type from file " <<
+      _filename << "." << std::endl;
+    return false;
+  }
+
+  // Once the tag is validated, reading cannot fail.
+  archive >> *_object;
+  return true;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+    _argc, _argv,
+    "1.0",
+    "Bakes an ozz animation to a texture of model-space joint transforms");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ?
+      EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  ozz::animation::Skeleton skeleton;
+  ozz::animation::Animation animation;
+  if (!Load(OPTIONS_skeleton, &skeleton) ||
+      !Load(OPTIONS_animation, &animation)) {
+    return EXIT_FAILURE;
+  }
+
+  ozz::log::Log() << "Bakes animation texture." << std::endl;
+  ozz::animation::offline::PoseTextureBuilder builder;
+  builder.sampling_rate = OPTIONS_sampling_rate;
+  builder.format = std::strcmp(OPTIONS_format, "matrix") == 0 ?
+    ozz::animation::offline::PoseTexture::kMatrix :
+    ozz::animation::offline::PoseTexture::kDualQuaternion;
+  ozz::animation::offline::PoseTexture texture;
+  if (!builder(animation, skeleton, &texture)) {
+    ozz::log::Err() << "Failed to bake animation texture, the animation " <<
+      "doesn't match the skeleton." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::log::Log() << "Writes " << texture.width() << "x" << texture.height() <<
+    " texture to file: " << OPTIONS_texture << std::endl;
+  ozz::io::File file(OPTIONS_texture, "wb");
+  if (!file.opened() || !texture.Save(&file)) {
+    ozz::log::Err() << "Failed to write output file: " << OPTIONS_texture <<
+      std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/offline/tools/conversion_cache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace internal {
+
+namespace {
+// Cache file header, which is changed whenever the format or the meaning of
+// hashes change, so that old caches are discarded.
+const char kHeader[] = "ozz conversion cache 1";
+
+// Parses 16 hexadecimal digits of _str to _hash.
+bool ParseHash(const char* _str, uint64_t* _hash) {
+  uint64_t hash = 0;
+  for (int i = 0; i < 16; ++i) {
+    const char c = _str[i];
+    uint64_t digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else {
+      return false;
+    }
+    hash = (hash << 4) | digit;
+  }
+  *_hash = hash;
+  return true;
+}
+}  // namespace
+
+const uint64_t kHashSeed = 14695981039346656037ull;
+
+uint64_t Hash(const void* _data, size_t _size, uint64_t _hash) {
+  const unsigned char* data = static_cast<const unsigned char*>(_data);
+  for (size_t i = 0; i < _size; ++i) {
+    _hash = (_hash ^ data[i]) * 1099511628211ull;
+  }
+  return _hash;
+}
+
+uint64_t HashString(const char* _str, uint64_t _hash) {
+  // Includes the terminating zero, so that consecutive strings can't collide.
+  return Hash(_str, std::strlen(_str) + 1, _hash);
+}
+
+bool HashFile(const char* _filename, uint64_t _hash, uint64_t* _result) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    return false;
+  }
+  char buffer[4096];
+  for (size_t read = file.Read(buffer, sizeof(buffer));
+       read != 0;
+       read = file.Read(buffer, sizeof(buffer))) {
+    _hash = Hash(buffer, read, _hash);
+  }
+  *_result = _hash;
+  return true;
+}
+
+void ConversionCache::Load(const char* _filename) {
+  entries_.clear();
+
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Log() << "Conversion cache \"" << _filename <<
+      "\" doesn't exist yet, all files will be converted." << std::endl;
+    return;
+  }
+  ozz::String::Std content;
+  char buffer[256];
+  for (size_t read = file.Read(buffer, sizeof(buffer));
+       read != 0;
+       read = file.Read(buffer, sizeof(buffer))) {
+    content.append(buffer, read);
+  }
+
+  // Checks header, then parses "hash output" lines.
+  bool valid = content.compare(0, sizeof(kHeader) - 1, kHeader) == 0 &&
+               content.size() >= sizeof(kHeader) &&
+               content[sizeof(kHeader) - 1] == '\n';
+  for (size_t begin = sizeof(kHeader); valid && begin < content.size();) {
+    size_t end = content.find('\n', begin);
+    if (end == ozz::String::Std::npos) {
+      end = content.size();
+    }
+    uint64_t hash;
+    valid = end - begin > 17 &&
+            ParseHash(content.c_str() + begin, &hash) &&
+            content[begin + 16] == ' ';
+    if (valid) {
+      entries_[content.substr(begin + 17, end - begin - 17)] = hash;
+    }
+    begin = end + 1;
+  }
+  if (!valid) {
+    ozz::log::Err() << "Invalid conversion cache \"" << _filename <<
+      "\", all files will be converted." << std::endl;
+    entries_.clear();
+  }
+}
+
+bool ConversionCache::Save(const char* _filename) const {
+  ozz::io::File file(_filename, "wb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open conversion cache \"" << _filename <<
+      "\" for writing." << std::endl;
+    return false;
+  }
+  file.Write(kHeader, sizeof(kHeader) - 1);
+  file.Write("\n", 1);
+  for (Entries::const_iterator it = entries_.begin();
+       it != entries_.end();
+       ++it) {
+    char hash[18];
+    std::sprintf(hash, "%08x%08x ",
+                 static_cast<unsigned int>(it->second >> 32),
+                 static_cast<unsigned int>(it->second & 0xffffffff));
+    file.Write(hash, 17);
+    file.Write(it->first.c_str(), it->first.size());
+    file.Write("\n", 1);
+  }
+  return true;
+}
+
+bool ConversionCache::IsUpToDate(const char* _output, uint64_t _hash) const {
+  Entries::const_iterator it = entries_.find(_output);
+  if (it == entries_.end() || it->second != _hash) {
+    return false;
+  }
+  return ozz::io::File(_output, "rb").opened();
+}
+
+void ConversionCache::Update(const char* _output, uint64_t _hash) {
+  entries_[_output] = _hash;
+}
+}  // internal
+}  // offline
+}  // animation
+}  // ozz
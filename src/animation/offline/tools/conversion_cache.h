@@ -0,0 +1,95 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_OFFLINE_TOOLS_CONVERSION_CACHE_H_
+#define OZZ_ANIMATION_OFFLINE_TOOLS_CONVERSION_CACHE_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include <cstddef>
+
+#include "ozz/base/platform.h"
+#include "ozz/base/containers/map.h"
+#include "ozz/base/containers/string.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace internal {
+
+// Hashes _size bytes of _data using 64 bits FNV-1a algorithm, continuing from
+// _hash, which allows to hash multiple buffers.
+uint64_t Hash(const void* _data, size_t _size, uint64_t _hash);
+
+// Hashes _str zero terminated string, see Hash.
+uint64_t HashString(const char* _str, uint64_t _hash);
+
+// Hashes the whole content of file _filename, see Hash.
+// Returns false if the file can't be opened.
+bool HashFile(const char* _filename, uint64_t _hash, uint64_t* _result);
+
+// The initial value of a hash.
+extern const uint64_t kHashSeed;
+
+// Implements the incremental conversion cache, which stores the hash of the
+// inputs (source files, options...) every output file was converted from.
+// An output doesn't need to be converted again if its inputs hash didn't
+// change and the file still exists.
+// The cache is a text file, with a line per output file, made of the
+// hexadecimal hash and the output file name.
+class ConversionCache {
+ public:
+  // Loads cache file _filename, replacing current entries. A missing file is
+  // an empty cache, and an invalid file is discarded with a warning, as the
+  // cache only avoids redundant conversions.
+  void Load(const char* _filename);
+
+  // Saves all entries to cache file _filename.
+  // Returns false if the file can't be opened for writing.
+  bool Save(const char* _filename) const;
+
+  // Tells whether _output was converted from inputs that hashed to _hash, and
+  // still exists.
+  bool IsUpToDate(const char* _output, uint64_t _hash) const;
+
+  // Records that _output was converted from inputs that hashed to _hash.
+  void Update(const char* _output, uint64_t _hash);
+
+ private:
+  typedef ozz::Map<ozz::String::Std, uint64_t>::Std Entries;
+  Entries entries_;
+};
+}  // internal
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_OFFLINE_TOOLS_CONVERSION_CACHE_H_
@@ -30,29 +30,49 @@
 
 #include "ozz/animation/offline/tools/convert2anim.h"
 
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/additive_animation_builder.h"
+#include "ozz/animation/offline/joint_track_sampler.h"
+#include "ozz/animation/offline/root_motion_builder.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/root_motion.h"
 
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
 
 #include "ozz/base/log.h"
 
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/thread_caching_allocator.h"
+#include "ozz/base/tasks/thread_pool.h"
+
 #include "ozz/options/options.h"
 
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/offline/tools/conversion_cache.h"
+#include "animation/offline/tools/manifest.h"
+
 // Declares command line options.
-OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", true)
+OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", false)
 OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies ozz skeleton (raw or runtime) input file", "", true)
-OZZ_OPTIONS_DECLARE_STRING(animation, "Specifies ozz animation output file", "", true)
+OZZ_OPTIONS_DECLARE_STRING(animation, "Specifies ozz animation output file", "", false)
+OZZ_OPTIONS_DECLARE_STRING(
+  manifest,
+  "Specifies a manifest file for batch conversions, instead of file and "
+  "animation options. Every line lists an input file, its ozz animation "
+  "output file and optionally its ozz root motion output file, separated by "
+  "commas. Files are converted in parallel on the requested number of threads",
+  "", false)
 
 OZZ_OPTIONS_DECLARE_FLOAT(
   rotation,
@@ -66,6 +86,71 @@ OZZ_OPTIONS_DECLARE_FLOAT(
   scale,
   "Optimizer scale tolerance in percents",
   ozz::animation::offline::AnimationOptimizer().scale_tolerance, false)
+OZZ_OPTIONS_DECLARE_BOOL(
+  hierarchical,
+  "Optimizes using skeleton hierarchy to measure errors in model space, "
+  "instead of rotation, translation and scale local tolerances",
+  false, false)
+OZZ_OPTIONS_DECLARE_FLOAT(
+  hierarchical_tolerance,
+  "Optimizer hierarchical (model space) tolerance in meters",
+  ozz::animation::offline::AnimationOptimizer().hierarchical_tolerance, false)
+OZZ_OPTIONS_DECLARE_BOOL(
+  hermite,
+  "Optimizes to an animation interpolated with cubic Hermite curves, which "
+  "requires fewer keys than linear interpolation for smooth motions",
+  false, false)
+OZZ_OPTIONS_DECLARE_BOOL(
+  additive,
+  "Builds an additive animation, whose keys are deltas from the first frame "
+  "of the imported animation, to be used as a BlendingJob additive layer",
+  false, false)
+OZZ_OPTIONS_DECLARE_STRING(
+  motion,
+  "Specifies ozz root motion output file. Root motion translation and yaw are "
+  "extracted from the root joint when specified",
+  "", false)
+OZZ_OPTIONS_DECLARE_BOOL(
+  motion_in_place,
+  "Removes the extracted root motion from the root joint, so that the "
+  "animation plays in place",
+  true, false)
+OZZ_OPTIONS_DECLARE_FLOAT(
+  seek_interval,
+  "Interval in seconds between runtime animation seek index entries, which "
+  "speed up sampling at random times. 0 disables the seek index",
+  ozz::animation::offline::AnimationBuilder().seek_interval, false)
+OZZ_OPTIONS_DECLARE_BOOL(
+  key_links,
+  "Builds runtime animation key links, which allow to sample backward as "
+  "efficiently as forward",
+  ozz::animation::offline::AnimationBuilder().key_links, false)
+OZZ_OPTIONS_DECLARE_BOOL(
+  bounds,
+  "Precomputes runtime animation model-space bounds, which allow to cull a "
+  "character before sampling it",
+  false, false)
+OZZ_OPTIONS_DECLARE_FLOAT(
+  bounds_interval,
+  "Duration in seconds of the time segments a bound is precomputed for. 0 "
+  "computes a single bound for the whole animation",
+  ozz::animation::offline::AnimationBuilder().bounds_interval, false)
+OZZ_OPTIONS_DECLARE_FLOAT(
+  bounds_margin,
+  "Distance precomputed bounds are inflated by",
+  ozz::animation::offline::AnimationBuilder().bounds_margin, false)
+OZZ_OPTIONS_DECLARE_STRING(
+  report,
+  "Path to the optimization report (csv) file, which lists per track keys "
+  "reduction, and maximum and RMS errors sampled in local and model space",
+  "", false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+  cache,
+  "Path to the incremental conversion cache file. Files whose source, "
+  "skeleton and options didn't change since their last conversion aren't "
+  "converted again",
+  "", false)
 
 static bool ValidateEndianness(const ozz::options::Option& _option,
                                int /*_argc*/) {
@@ -88,6 +173,18 @@ OZZ_OPTIONS_DECLARE_STRING_FN(
   false,
   &ValidateEndianness)
 
+OZZ_OPTIONS_DECLARE_BOOL(
+  compress,
+  "Compresses output archives by blocks (LZ4), which ozz loaders decompress "
+  "transparently",
+  false, false)
+
+OZZ_OPTIONS_DECLARE_BOOL(
+  checksum,
+  "Stores a checksum with output objects, so that loaders can verify their "
+  "integrity",
+  false, false)
+
 static bool ValidateLogLevel(const ozz::options::Option& _option,
                              int /*_argc*/) {
   const ozz::options::StringOption& option =
@@ -126,6 +223,33 @@ OZZ_OPTIONS_DECLARE_FLOAT_FN(
   false,
   &ValidateSamplingRate)
 
+OZZ_OPTIONS_DECLARE_BOOL(
+  adaptive_sampling,
+  "Samples keys only where curves can't be interpolated within optimizer "
+  "tolerances, instead of all keys at sampling rate. Importers then emit fewer "
+  "keys",
+  false,
+  false)
+
+static bool ValidateThreads(const ozz::options::Option& _option,
+                            int /*_argc*/) {
+  const ozz::options::IntOption& option =
+    static_cast<const ozz::options::IntOption&>(_option);
+  bool valid = option.value() > 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid threads option." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(
+  threads,
+  "Selects the number of threads used to import, optimize and build the "
+  "animation, and to convert manifest files in parallel",
+  1,
+  false,
+  &ValidateThreads)
+
 OZZ_OPTIONS_DECLARE_BOOL(
   raw,
   "Outputs raw animation, instead of runtime animation.",
@@ -170,150 +294,378 @@ void DisplaysOptimizationstatistics(const RawAnimation& _non_optimized,
   ozz::log::Log() << " - Scaling key frames optimization: " <<
     scale_ratio << "%" << std::endl;
 }
+
+// Writes optimization _report of tracks animating _skeleton to csv file
+// _filename. The first row is the whole animation report.
+bool WriteReport(const char* _filename,
+                 const Skeleton& _skeleton,
+                 const AnimationOptimizer::Report& _report) {
+  ozz::io::File file(_filename, "wb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open report file \"" << _filename <<
+      "\" for writing." << std::endl;
+    return false;
+  }
+
+  char line[512];
+  std::sprintf(line,
+               "track,joint,"
+               "input_translations,output_translations,"
+               "input_rotations,output_rotations,"
+               "input_scales,output_scales,"
+               "max_translation_error,rms_translation_error,"
+               "max_rotation_error,rms_rotation_error,"
+               "max_scale_error,rms_scale_error,"
+               "max_model_error,rms_model_error\n");
+  file.Write(line, std::strlen(line));
+  const int num_tracks = static_cast<int>(_report.tracks.size());
+  for (int i = -1; i < num_tracks; ++i) {
+    const AnimationOptimizer::Report::Track& track =
+      i < 0 ? _report.total : _report.tracks[i];
+    char index[16];
+    std::sprintf(index, "%d", i);
+    std::sprintf(line, "%s,%s,%d,%d,%d,%d,%d,%d,%g,%g,%g,%g,%g,%g,%g,%g\n",
+                 i < 0 ? "total" : index,
+                 i >= 0 && i < _skeleton.num_joints() ?
+                   _skeleton.joint_names()[i] : "",
+                 track.input_translations, track.output_translations,
+                 track.input_rotations, track.output_rotations,
+                 track.input_scales, track.output_scales,
+                 track.max_translation_error, track.rms_translation_error,
+                 track.max_rotation_error, track.rms_rotation_error,
+                 track.max_scale_error, track.rms_scale_error,
+                 track.max_model_error, track.rms_model_error);
+    file.Write(line, std::strlen(line));
+  }
+
+  const AnimationOptimizer::Report::Track& total = _report.total;
+  ozz::log::Log() << "Optimization errors (max/rms):" << std::endl;
+  ozz::log::Log() << " - Translations: " << total.max_translation_error <<
+    "/" << total.rms_translation_error << std::endl;
+  ozz::log::Log() << " - Rotations: " << total.max_rotation_error << "/" <<
+    total.rms_rotation_error << std::endl;
+  ozz::log::Log() << " - Scales: " << total.max_scale_error << "/" <<
+    total.rms_scale_error << std::endl;
+  ozz::log::Log() << " - Model space: " << total.max_model_error << "/" <<
+    total.rms_model_error << std::endl;
+  ozz::log::Log() << "Optimization report written to \"" << _filename <<
+    "\"." << std::endl;
+  return true;
 }
 
-int AnimationConverter::operator()(int _argc, const char** _argv) {
-  // Parses arguments.
-  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
-    _argc, _argv,
-    "1.1",
-    "Imports a animation from a file and converts it to ozz binary raw or "
-    "runtime animation format");
-  if (parse_result != ozz::options::kSuccess) {
-    return parse_result == ozz::options::kExitSuccess ?
-      EXIT_SUCCESS : EXIT_FAILURE;
+// Setups the sampler used by importers from sampling and optimizer options.
+JointTrackSampler MakeSampler() {
+  JointTrackSampler sampler;
+  sampler.sampling_rate = OPTIONS_sampling_rate;
+  sampler.adaptive = OPTIONS_adaptive_sampling;
+  sampler.translation_tolerance = OPTIONS_translation;
+  sampler.rotation_tolerance = OPTIONS_rotation;
+  sampler.scale_tolerance = OPTIONS_scale;
+  return sampler;
+}
+
+// Hashes the values of all the options that affect conversion outputs.
+uint64_t HashOptions(uint64_t _hash) {
+  char options[512];
+  std::sprintf(options,
+               "%.9g %d %.9g %.9g %.9g %d %.9g %d %d %d "
+               "%.9g %d %d %.9g %.9g %d %s %d %d",
+               OPTIONS_sampling_rate.value(),
+               OPTIONS_adaptive_sampling.value(),
+               OPTIONS_rotation.value(),
+               OPTIONS_translation.value(),
+               OPTIONS_scale.value(),
+               OPTIONS_hierarchical.value(),
+               OPTIONS_hierarchical_tolerance.value(),
+               OPTIONS_hermite.value(),
+               OPTIONS_additive.value(),
+               OPTIONS_motion_in_place.value(),
+               OPTIONS_seek_interval.value(),
+               OPTIONS_key_links.value(),
+               OPTIONS_bounds.value(),
+               OPTIONS_bounds_interval.value(),
+               OPTIONS_bounds_margin.value(),
+               OPTIONS_raw.value(),
+               OPTIONS_endian.value(),
+               OPTIONS_compress.value(),
+               OPTIONS_checksum.value());
+  return internal::HashString(options, _hash);
+}
+
+// Hashes the inputs of the conversion of _file, including _motion output
+// name as it enables root motion extraction, _seed being the hash of the inputs
+// shared by all conversions.
+// Returns false if _file can't be read.
+bool HashConversion(const char* _file, const char* _motion,
+                    uint64_t _seed, uint64_t* _hash) {
+  return internal::HashFile(_file, internal::HashString(_motion, _seed), _hash);
+}
+
+// Outputs _object to an archive in _stream, through a CompressedStream if
+// compress option is set, with a checksum if checksum option is set.
+// Returns false if compressed data couldn't be written.
+template<typename _Ty>
+bool WriteArchive(ozz::io::Stream* _stream, const _Ty& _object,
+                  ozz::Endianness _endianness) {
+  if (!OPTIONS_compress) {
+    ozz::io::OArchive archive(_stream, _endianness, OPTIONS_checksum);
+    archive << _object;
+    return true;
   }
+  ozz::io::CompressedStream stream(_stream,
+                                   ozz::io::CompressedStream::kWrite);
+  ozz::io::OArchive archive(&stream, _endianness, OPTIONS_checksum);
+  archive << _object;
+  return stream.Close();
+}
 
-  // Initializes log level from options.
-  ozz::log::Level log_level = ozz::log::GetLevel();
-  if (std::strcmp(OPTIONS_log_level, "silent") == 0) {
-    log_level = ozz::log::Silent;
-  } else if (std::strcmp(OPTIONS_log_level, "standard") == 0) {
-    log_level = ozz::log::Standard;
-  } else if (std::strcmp(OPTIONS_log_level, "verbose") == 0) {
-    log_level = ozz::log::Verbose;
+// Reads a runtime skeleton from file _filename.
+// Returns NULL if the file can't be opened or doesn't contain a Skeleton.
+Skeleton* ReadSkeleton(const char* _filename) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    return NULL;
   }
-  ozz::log::SetLevel(log_level);
+  ozz::io::IArchive archive(&file);
+  if (!archive.TestTag<Skeleton>()) {
+    return NULL;
+  }
+  // This operation cannot fail.
+  Skeleton* skeleton = ozz::memory::default_allocator()->New<Skeleton>();
+  archive >> *skeleton;
+  return skeleton;
+}
 
-  // Reads the skeleton from the binary ozz stream.
-  ozz::animation::Skeleton* skeleton = NULL;
-  {
-    ozz::log::Log() << "Opens input skeleton ozz binary file: " <<
+// Loads the runtime skeleton from skeleton option file, which can contain a
+// RawSkeleton or a Skeleton. A RawSkeleton must be built. When a _cache is
+// used, the built skeleton (joint names lookup, hierarchy and bind pose) is
+// saved to a "<cache>.skeleton" artifact, which next conversions load directly
+// as long as the RawSkeleton file doesn't change.
+// Returns NULL on failure.
+Skeleton* LoadSkeleton(internal::ConversionCache* _cache) {
+  ozz::log::Log() << "Opens input skeleton ozz binary file: " <<
+    OPTIONS_skeleton << std::endl;
+  ozz::io::File file(OPTIONS_skeleton, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open input skeleton ozz binary file: " <<
       OPTIONS_skeleton << std::endl;
-    ozz::io::File file(OPTIONS_skeleton, "rb");
-    if (!file.opened()) {
-      ozz::log::Err() << "Failed to open input skeleton ozz binary file: " <<
-        OPTIONS_skeleton << std::endl;
-      return EXIT_FAILURE;
+    return NULL;
+  }
+  ozz::io::IArchive archive(&file);
+
+  // File could contain a RawSkeleton or a Skeleton.
+  if (archive.TestTag<Skeleton>()) {
+    // Reads input archive to the runtime skeleton.
+    // This operation cannot fail.
+    Skeleton* skeleton = ozz::memory::default_allocator()->New<Skeleton>();
+    archive >> *skeleton;
+    return skeleton;
+  } else if (!archive.TestTag<RawSkeleton>()) {
+    ozz::log::Err() << "Failed to read input skeleton from binary file: " <<
+      OPTIONS_skeleton << std::endl;
+    return NULL;
+  }
+
+  // Reuses the skeleton built by a previous conversion.
+  const ozz::String::Std artifact =
+    _cache ? ozz::String::Std(OPTIONS_cache.value()) + ".skeleton" : "";
+  uint64_t hash = 0;
+  const bool hashed = _cache &&
+    internal::HashFile(OPTIONS_skeleton, internal::kHashSeed, &hash);
+  if (hashed && _cache->IsUpToDate(artifact.c_str(), hash)) {
+    Skeleton* skeleton = ReadSkeleton(artifact.c_str());
+    if (skeleton) {
+      ozz::log::Log() << "Reads runtime skeleton built from RawSkeleton by a "
+        "previous conversion from \"" << artifact << "\"." << std::endl;
+      return skeleton;
     }
-    ozz::io::IArchive archive(&file);
-
-    // File could contain a RawSkeleton or a Skeleton.
-    if (archive.TestTag<ozz::animation::offline::RawSkeleton>()) {
-      ozz::log::Log() << "Reading RawSkeleton from file." << std::endl;
-
-      // Reading the skeleton cannot file.
-      ozz::animation::offline::RawSkeleton raw_skeleton;
-      archive >> raw_skeleton;
-
-      // Builds runtime skeleton.
-      ozz::log::Log() << "Builds runtime skeleton." << std::endl;
-      ozz::animation::offline::SkeletonBuilder builder;
-      skeleton = builder(raw_skeleton);
-      if (!skeleton) {
-        ozz::log::Err() << "Failed to build runtime skeleton." << std::endl;
-        return EXIT_FAILURE;
-      }
-    } else if (archive.TestTag<ozz::animation::Skeleton>()) {
-      // Reads input archive to the runtime skeleton.
-      // This operation cannot fail.
-      skeleton =
-        ozz::memory::default_allocator()->New<ozz::animation::Skeleton>();
-      archive >> *skeleton;
+  }
+
+  ozz::log::Log() << "Reading RawSkeleton from file." << std::endl;
+
+  // Reading the skeleton cannot file.
+  RawSkeleton raw_skeleton;
+  archive >> raw_skeleton;
+
+  // Builds runtime skeleton.
+  ozz::log::Log() << "Builds runtime skeleton." << std::endl;
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  if (!skeleton) {
+    ozz::log::Err() << "Failed to build runtime skeleton." << std::endl;
+    return NULL;
+  }
+
+  // Saves the built skeleton for next conversions. Failing to do so isn't an
+  // error, it will just be built again.
+  if (hashed) {
+    ozz::io::File output(artifact.c_str(), "wb");
+    if (output.opened()) {
+      ozz::io::OArchive output_archive(&output);
+      output_archive << *skeleton;
+      _cache->Update(artifact.c_str(), hash);
     } else {
-      ozz::log::Err() << "Failed to read input skeleton from binary file: " <<
-        OPTIONS_skeleton << std::endl;
-      return EXIT_FAILURE;
+      ozz::log::Err() << "Failed to open skeleton cache file \"" <<
+        artifact << "\" for writing." << std::endl;
     }
   }
+  return skeleton;
+}
 
-  // Imports animation from the document.
-  ozz::log::Log() << "Importing file \"" << OPTIONS_file << "\"" <<
-    std::endl;
-  ozz::animation::offline::RawAnimation raw_animation;
-  bool imported =
-    Import(OPTIONS_file, *skeleton, OPTIONS_sampling_rate, &raw_animation);
+// Tells whether _animation and _motion outputs are up to date with inputs
+// hashed to _hash.
+bool IsUpToDate(const internal::ConversionCache& _cache,
+                const char* _animation, const char* _motion,
+                uint64_t _hash) {
+  return _cache.IsUpToDate(_animation, _hash) &&
+         (*_motion == 0 || _cache.IsUpToDate(_motion, _hash));
+}
 
-  // No need for the skeleton anymore.
-  ozz::memory::default_allocator()->Delete(skeleton);
-  if (!imported) {
-    ozz::log::Err() << "Failed to import file \"" << OPTIONS_file << "\"" <<
-      std::endl;
-    return EXIT_FAILURE;
+// Records that _animation and _motion outputs were converted from inputs
+// hashed to _hash.
+void UpdateCache(const char* _animation, const char* _motion, uint64_t _hash,
+                 internal::ConversionCache* _cache) {
+  _cache->Update(_animation, _hash);
+  if (*_motion != 0) {
+    _cache->Update(_motion, _hash);
+  }
+}
+}
+
+bool AnimationConverter::Process(RawAnimation* _raw_animation,
+                                 const Skeleton& _skeleton,
+                                 const char* _animation, const char* _motion,
+                                 const char* _report,
+                                 tasks::Dispatcher* _dispatcher) {
+  ozz::animation::offline::RawAnimation& raw_animation = *_raw_animation;
+
+  // Extracts root motion, before any other processing of the root joint.
+  ozz::animation::RootMotion* motion = NULL;
+  if (*_motion != 0) {
+    ozz::log::Log() << "Extracts root motion." << std::endl;
+    ozz::animation::offline::RootMotionBuilder motion_builder;
+    ozz::animation::offline::RawAnimation raw_in_place_animation;
+    motion = motion_builder(
+      raw_animation, OPTIONS_motion_in_place ? &raw_in_place_animation : NULL);
+    if (!motion) {
+      ozz::log::Err() << "Failed to extract root motion." << std::endl;
+      return false;
+    }
+    if (OPTIONS_motion_in_place) {
+      raw_animation = raw_in_place_animation;
+    }
+  }
+
+  // Converts to an additive animation, before optimizing deltas.
+  if (OPTIONS_additive) {
+    ozz::log::Log() << "Builds additive animation." << std::endl;
+    ozz::animation::offline::AdditiveAnimationBuilder additive_builder;
+    ozz::animation::offline::RawAnimation raw_additive_animation;
+    if (!additive_builder(raw_animation, &raw_additive_animation)) {
+      ozz::log::Err() << "Failed to build additive animation." << std::endl;
+      ozz::memory::default_allocator()->Delete(motion);
+      return false;
+    }
+    raw_animation = raw_additive_animation;
   }
 
   // Optimizes animation.
   ozz::log::Log() << "Optimizing animation." << std::endl;
   ozz::animation::offline::AnimationOptimizer optimizer;
+  optimizer.dispatcher = _dispatcher;
   optimizer.rotation_tolerance = OPTIONS_rotation;
   optimizer.translation_tolerance = OPTIONS_translation;
   optimizer.scale_tolerance = OPTIONS_scale;
+  optimizer.hierarchical_tolerance = OPTIONS_hierarchical_tolerance;
+  optimizer.interpolation = OPTIONS_hermite ?
+    ozz::animation::offline::RawAnimation::kHermite :
+    ozz::animation::offline::RawAnimation::kLinear;
+  AnimationOptimizer::Report report;
+  const bool with_report = *_report != 0;
+  if (with_report) {
+    optimizer.report = &report;
+  }
   ozz::animation::offline::RawAnimation raw_optimized_animation;
-  if (!optimizer(raw_animation, &raw_optimized_animation)) {
+  const bool optimized = OPTIONS_hierarchical ?
+    optimizer(raw_animation, _skeleton, &raw_optimized_animation) :
+    optimizer(raw_animation, &raw_optimized_animation);
+
+  if (!optimized) {
     ozz::log::Err() << "Failed to optimize animation." << std::endl;
-    return EXIT_FAILURE;
+    ozz::memory::default_allocator()->Delete(motion);
+    return false;
   }
 
   // Displays optimization statistics.
   DisplaysOptimizationstatistics(raw_animation, raw_optimized_animation);
 
+  // Outputs optimization report.
+  if (with_report && !WriteReport(_report, _skeleton, report)) {
+    ozz::memory::default_allocator()->Delete(motion);
+    return false;
+  }
+
   // Builds runtime animation.
   ozz::animation::Animation* animation = NULL;
   if (!OPTIONS_raw) {
     ozz::log::Log() << "Builds runtime animation." << std::endl;
     ozz::animation::offline::AnimationBuilder builder;
+    builder.dispatcher = _dispatcher;
+    builder.seek_interval = OPTIONS_seek_interval;
+    builder.key_links = OPTIONS_key_links;
+    if (OPTIONS_bounds) {
+      builder.bounds_skeleton = &_skeleton;
+      builder.bounds_interval = OPTIONS_bounds_interval;
+      builder.bounds_margin = OPTIONS_bounds_margin;
+    }
     animation = builder(raw_optimized_animation);
     if (!animation) {
       ozz::log::Err() << "Failed to build runtime animation." << std::endl;
-      return EXIT_FAILURE;
+      ozz::memory::default_allocator()->Delete(motion);
+      return false;
     }
   }
 
+  // Initializes output endianness from options.
+  ozz::Endianness endianness = ozz::GetNativeEndianness();
+  if (std::strcmp(OPTIONS_endian, "little")) {
+    endianness = ozz::kLittleEndian;
+  } else if (std::strcmp(OPTIONS_endian, "big")) {
+    endianness = ozz::kBigEndian;
+  }
+  ozz::log::Log() << (endianness == ozz::kLittleEndian ? "Little" : "Big") <<
+    " Endian output binary format selected." << std::endl;
+
   {
     // Prepares output stream. File is a RAII so it will close automatically at
     // the end of this scope.
     // Once the file is opened, nothing should fail as it would leave an invalid
     // file on the disk.
-    ozz::log::Log() << "Opens output file: " <<
-      OPTIONS_animation.value() << std::endl;
-    ozz::io::File file(OPTIONS_animation, "wb");
+    ozz::log::Log() << "Opens output file: " << _animation << std::endl;
+    ozz::io::File file(_animation, "wb");
     if (!file.opened()) {
-      ozz::log::Err() << "Failed to open output file: " <<
-        OPTIONS_animation.value() << std::endl;
+      ozz::log::Err() << "Failed to open output file: " << _animation <<
+        std::endl;
       ozz::memory::default_allocator()->Delete(animation);
-      return EXIT_FAILURE;
+      ozz::memory::default_allocator()->Delete(motion);
+      return false;
     }
 
-    // Initializes output endianness from options.
-    ozz::Endianness endianness = ozz::GetNativeEndianness();
-    if (std::strcmp(OPTIONS_endian, "little")) {
-      endianness = ozz::kLittleEndian;
-    } else if (std::strcmp(OPTIONS_endian, "big")) {
-      endianness = ozz::kBigEndian;
-    }
-    ozz::log::Log() << (endianness == ozz::kLittleEndian ? "Little" : "Big") <<
-      " Endian output binary format selected." << std::endl;
-
-    // Initializes output archive.
-    ozz::io::OArchive archive(&file, endianness);
-
     // Fills output archive with the animation.
+    bool written;
     if (OPTIONS_raw) {
       ozz::log::Log() << "Outputs RawAnimation to binary archive." << std::endl;
-      archive << raw_optimized_animation;
+      written = WriteArchive(&file, raw_optimized_animation, endianness);
     } else {
       ozz::log::Log() << "Outputs Animation to binary archive." << std::endl;
-      archive << *animation;      
+      written = WriteArchive(&file, *animation, endianness);
+    }
+    if (!written) {
+      ozz::log::Err() << "Failed to write output file: " << _animation <<
+        std::endl;
+      ozz::memory::default_allocator()->Delete(animation);
+      ozz::memory::default_allocator()->Delete(motion);
+      return false;
     }
   }
 
@@ -323,7 +675,296 @@ int AnimationConverter::operator()(int _argc, const char** _argv) {
   // Delete local objects.
   ozz::memory::default_allocator()->Delete(animation);
 
-  return EXIT_SUCCESS;
+  // Outputs root motion to its own binary archive.
+  if (motion) {
+    ozz::log::Log() << "Opens output file: " << _motion << std::endl;
+    ozz::io::File file(_motion, "wb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open output file: " << _motion <<
+        std::endl;
+      ozz::memory::default_allocator()->Delete(motion);
+      return false;
+    }
+    ozz::log::Log() << "Outputs RootMotion to binary archive." << std::endl;
+    const bool written = WriteArchive(&file, *motion, endianness);
+    ozz::memory::default_allocator()->Delete(motion);
+    if (!written) {
+      ozz::log::Err() << "Failed to write output file: " << _motion <<
+        std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Converts a range of manifest entries, one entry per work item.
+class AnimationConverter::ConvertTask : public tasks::Task {
+ public:
+  // _imported is NULL if entries must be imported by the task, otherwise it
+  // contains the animations already imported for every work item, and
+  // _success their import status.
+  ConvertTask(AnimationConverter* _converter,
+              const Skeleton& _skeleton,
+              const internal::ManifestEntry* _entries,
+              RawAnimation* _imported,
+              bool* _success,
+              tasks::Dispatcher* _dispatcher)
+    : converter_(_converter),
+      skeleton_(_skeleton),
+      entries_(_entries),
+      imported_(_imported),
+      success_(_success),
+      dispatcher_(_dispatcher) {
+  }
+
+  virtual void Run(int _index) const {
+    const internal::ManifestEntry& entry = entries_[_index];
+    RawAnimation local;
+    RawAnimation* raw_animation = imported_ ? &imported_[_index] : &local;
+    if (!imported_) {
+      success_[_index] = converter_->Import(entry.files[0].c_str(),
+                                            skeleton_,
+                                            MakeSampler(),
+                                            raw_animation,
+                                            dispatcher_);
+      if (!success_[_index]) {
+        ozz::log::Err() << "Failed to import file \"" << entry.files[0] <<
+          "\"" << std::endl;
+      }
+    }
+    if (success_[_index]) {
+      success_[_index] = converter_->Process(
+        raw_animation, skeleton_,
+        entry.files[1].c_str(),
+        entry.files.size() > 2 ? entry.files[2].c_str() : "",
+        "",
+        dispatcher_);
+    }
+  }
+
+ private:
+  AnimationConverter* converter_;
+  const Skeleton& skeleton_;
+  const internal::ManifestEntry* entries_;
+  RawAnimation* imported_;
+  bool* success_;
+  tasks::Dispatcher* dispatcher_;
+};
+
+bool AnimationConverter::ConvertManifest(const char* _manifest,
+                                         const Skeleton& _skeleton,
+                                         internal::ConversionCache* _cache,
+                                         uint64_t _seed) {
+  // Each line lists the input file, the animation output file and the
+  // optional root motion output file.
+  internal::Manifest all;
+  if (!internal::LoadManifest(_manifest, 2, 3, &all)) {
+    return false;
+  }
+
+  // Selects entries that aren't up to date. An entry whose input can't be
+  // hashed is converted, so that its import reports the error.
+  internal::Manifest manifest;
+  ozz::Vector<uint64_t>::Std hashes;
+  for (size_t i = 0; i < all.size(); ++i) {
+    const internal::ManifestEntry& entry = all[i];
+    const char* motion = entry.files.size() > 2 ? entry.files[2].c_str() : "";
+    uint64_t hash = 0;
+    if (_cache &&
+        HashConversion(entry.files[0].c_str(), motion, _seed, &hash) &&
+        IsUpToDate(*_cache, entry.files[1].c_str(), motion, hash)) {
+      ozz::log::LogV() << "\"" << entry.files[1] << "\" is up to date." <<
+        std::endl;
+      continue;
+    }
+    manifest.push_back(entry);
+    hashes.push_back(hash);
+  }
+
+  const int num_entries = static_cast<int>(manifest.size());
+  ozz::log::Log() << "Converting " << num_entries << " file(s) out of " <<
+    all.size() << " from manifest \"" << _manifest << "\"." << std::endl;
+  if (num_entries == 0) {
+    return true;
+  }
+
+  // Files are converted in parallel, and each conversion dispatches its
+  // optimization and build to the same pool.
+  tasks::ThreadPool dispatcher(OPTIONS_threads);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  bool* success = allocator->Allocate<bool>(num_entries);
+  if (IsImportThreadSafe()) {
+    const ConvertTask task(
+      this, _skeleton, &manifest[0], NULL, success, &dispatcher);
+    dispatcher.Dispatch(task, num_entries);
+  } else {
+    // Imports a batch of as many files as there are threads from the calling
+    // thread, then processes the batch in parallel.
+    const int batch_size = dispatcher.num_threads();
+    ozz::Vector<RawAnimation>::Std batch(batch_size);
+    for (int first = 0; first < num_entries; first += batch_size) {
+      const int count = num_entries - first < batch_size ?
+        num_entries - first : batch_size;
+      for (int i = 0; i < count; ++i) {
+        const char* filename = manifest[first + i].files[0].c_str();
+        ozz::log::Log() << "Importing file \"" << filename << "\"" <<
+          std::endl;
+        batch[i] = RawAnimation();
+        success[first + i] = Import(
+          filename, _skeleton, MakeSampler(), &batch[i], &dispatcher);
+        if (!success[first + i]) {
+          ozz::log::Err() << "Failed to import file \"" << filename << "\"" <<
+            std::endl;
+        }
+      }
+      const ConvertTask task(this, _skeleton, &manifest[first], &batch[0],
+                             success + first, &dispatcher);
+      dispatcher.Dispatch(task, count);
+    }
+  }
+
+  // Reports failed conversions, and records successful ones to the cache.
+  int num_failures = 0;
+  for (int i = 0; i < num_entries; ++i) {
+    const internal::ManifestEntry& entry = manifest[i];
+    if (!success[i]) {
+      ozz::log::Err() << "Failed to convert \"" << entry.files[0] <<
+        "\"." << std::endl;
+      ++num_failures;
+    } else if (_cache) {
+      UpdateCache(entry.files[1].c_str(),
+                  entry.files.size() > 2 ? entry.files[2].c_str() : "",
+                  hashes[i], _cache);
+    }
+  }
+  allocator->Deallocate(success);
+  ozz::log::Log() << num_entries - num_failures << " file(s) out of " <<
+    num_entries << " successfully converted." << std::endl;
+  return num_failures == 0;
+}
+
+int AnimationConverter::operator()(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+    _argc, _argv,
+    "1.1",
+    "Imports a animation from a file and converts it to ozz binary raw or "
+    "runtime animation format");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ?
+      EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // Initializes log level from options.
+  ozz::log::Level log_level = ozz::log::GetLevel();
+  if (std::strcmp(OPTIONS_log_level, "silent") == 0) {
+    log_level = ozz::log::Silent;
+  } else if (std::strcmp(OPTIONS_log_level, "standard") == 0) {
+    log_level = ozz::log::Standard;
+  } else if (std::strcmp(OPTIONS_log_level, "verbose") == 0) {
+    log_level = ozz::log::Verbose;
+  }
+  ozz::log::SetLevel(log_level);
+
+  // Selects single file or manifest batch conversion.
+  const bool batch = *OPTIONS_manifest.value() != 0;
+  if (batch) {
+    if (*OPTIONS_file.value() != 0 || *OPTIONS_animation.value() != 0 ||
+        *OPTIONS_motion.value() != 0 || *OPTIONS_report.value() != 0) {
+      ozz::log::Err() << "file, animation, motion and report options can't "
+        "be used with manifest option." << std::endl;
+      return EXIT_FAILURE;
+    }
+  } else if (*OPTIONS_file.value() == 0 || *OPTIONS_animation.value() == 0) {
+    ozz::log::Err() << "file and animation options are required, unless "
+      "manifest option is used." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Batch and multi-threaded conversions allocate from many threads, which
+  // requires a thread safe allocator. It's installed before anything is
+  // allocated, and restored once everything is deallocated.
+  const bool threaded = batch || OPTIONS_threads > 1;
+  ozz::memory::Allocator* previous_allocator = NULL;
+  if (threaded) {
+    previous_allocator =
+      ozz::memory::SetDefaulAllocator(ozz::memory::thread_caching_allocator());
+  }
+  const bool converted = Convert(batch);
+  if (threaded) {
+    ozz::memory::SetDefaulAllocator(previous_allocator);
+  }
+  return converted ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool AnimationConverter::Convert(bool _batch) {
+  // Loads the incremental conversion cache, and hashes the inputs shared by
+  // all conversions: options and skeleton.
+  internal::ConversionCache cache;
+  internal::ConversionCache* with_cache = NULL;
+  uint64_t seed = 0;
+  if (*OPTIONS_cache.value() != 0) {
+    cache.Load(OPTIONS_cache);
+    with_cache = &cache;
+    internal::HashFile(
+      OPTIONS_skeleton, HashOptions(internal::kHashSeed), &seed);
+  }
+
+  // Reads the skeleton from the binary ozz stream.
+  ozz::animation::Skeleton* skeleton = LoadSkeleton(with_cache);
+  if (!skeleton) {
+    return false;
+  }
+
+  bool success;
+  if (_batch) {
+    success = ConvertManifest(OPTIONS_manifest, *skeleton, with_cache, seed);
+  } else {
+    // Skips the conversion if outputs are up to date. The report is an output
+    // that isn't cached, so it always requires a conversion.
+    uint64_t hash = 0;
+    const bool hashed = with_cache &&
+      HashConversion(OPTIONS_file, OPTIONS_motion, seed, &hash);
+    if (hashed && *OPTIONS_report.value() == 0 &&
+        IsUpToDate(cache, OPTIONS_animation, OPTIONS_motion, hash)) {
+      ozz::log::Log() << "\"" << OPTIONS_animation.value() <<
+        "\" is up to date." << std::endl;
+      ozz::memory::default_allocator()->Delete(skeleton);
+      return true;
+    }
+
+    // Imports animation from the document.
+    ozz::log::Log() << "Importing file \"" << OPTIONS_file << "\"" <<
+      std::endl;
+    // Dispatches import, optimizer and builder tasks on the requested number
+    // of threads.
+    tasks::ThreadPool dispatcher(OPTIONS_threads);
+    ozz::animation::offline::RawAnimation raw_animation;
+    success = Import(OPTIONS_file, *skeleton, MakeSampler(),
+                     &raw_animation, &dispatcher);
+    if (!success) {
+      ozz::log::Err() << "Failed to import file \"" << OPTIONS_file << "\"" <<
+        std::endl;
+    } else {
+      success = Process(&raw_animation, *skeleton,
+                        OPTIONS_animation, OPTIONS_motion, OPTIONS_report,
+                        &dispatcher);
+    }
+    if (success && hashed) {
+      UpdateCache(OPTIONS_animation, OPTIONS_motion, hash, &cache);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+
+  // Saves the cache, even if some conversions failed, so that successful ones
+  // are not converted again.
+  if (with_cache && !cache.Save(OPTIONS_cache)) {
+    return false;
+  }
+  return success;
 }
 }  // offline
 }  // animation
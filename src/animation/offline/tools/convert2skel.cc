@@ -45,9 +45,18 @@
 
 #include "ozz/options/options.h"
 
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/offline/tools/manifest.h"
+
 // Declares command line options.
-OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", true)
-OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies ozz skeleton ouput file", "", true)
+OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", false)
+OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies ozz skeleton ouput file", "", false)
+OZZ_OPTIONS_DECLARE_STRING(
+  manifest,
+  "Specifies a manifest file for batch conversions, instead of file and "
+  "skeleton options. Every line lists an input file and its ozz skeleton "
+  "output file, separated by a comma",
+  "", false)
 
 static bool ValidateEndianness(const ozz::options::Option& _option,
                                int /*_argc*/) {
@@ -96,6 +105,13 @@ OZZ_OPTIONS_DECLARE_BOOL(
   false,
   false)
 
+OZZ_OPTIONS_DECLARE_BOOL(
+  checksum,
+  "Stores a checksum with the output skeleton, so that loaders can verify its "
+  "integrity",
+  false,
+  false)
+
 namespace ozz {
 namespace animation {
 namespace offline {
@@ -123,14 +139,48 @@ int SkeletonConverter::operator()(int _argc, const char** _argv) {
   }
   ozz::log::SetLevel(log_level);
 
+  // Converts manifest files one after the other, or the single command line
+  // file.
+  if (*OPTIONS_manifest.value() != 0) {
+    if (*OPTIONS_file.value() != 0 || *OPTIONS_skeleton.value() != 0) {
+      ozz::log::Err() << "file and skeleton options can't be used with "
+        "manifest option." << std::endl;
+      return EXIT_FAILURE;
+    }
+    internal::Manifest manifest;
+    if (!internal::LoadManifest(OPTIONS_manifest, 2, 2, &manifest)) {
+      return EXIT_FAILURE;
+    }
+    int num_failures = 0;
+    for (size_t i = 0; i < manifest.size(); ++i) {
+      if (!Convert(manifest[i].files[0].c_str(),
+                   manifest[i].files[1].c_str())) {
+        ++num_failures;
+      }
+    }
+    ozz::log::Log() << manifest.size() - num_failures << " file(s) out of "
+      << manifest.size() << " successfully converted." << std::endl;
+    return num_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if (*OPTIONS_file.value() == 0 || *OPTIONS_skeleton.value() == 0) {
+    ozz::log::Err() << "file and skeleton options are required, unless "
+      "manifest option is used." << std::endl;
+    return EXIT_FAILURE;
+  }
+  return Convert(OPTIONS_file, OPTIONS_skeleton) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool SkeletonConverter::Convert(const char* _filename,
+                                const char* _skeleton) {
   // Imports skeleton from the file.
-  ozz::log::Log() << "Importing file \"" << OPTIONS_file << "\"" <<
+  ozz::log::Log() << "Importing file \"" << _filename << "\"" <<
     std::endl;
   ozz::animation::offline::RawSkeleton raw_skeleton;
-  if (!Import(OPTIONS_file, &raw_skeleton)) {
-    ozz::log::Err() << "Failed to import file \"" << OPTIONS_file << "\"" <<
+  if (!Import(_filename, &raw_skeleton)) {
+    ozz::log::Err() << "Failed to import file \"" << _filename << "\"" <<
       std::endl;
-    return EXIT_FAILURE;
+    return false;
   }
 
   // Needs to be done before opening the output file, so that if it fails then
@@ -143,7 +193,7 @@ int SkeletonConverter::operator()(int _argc, const char** _argv) {
     skeleton = builder(raw_skeleton);
     if (!skeleton) {
       ozz::log::Err() << "Failed to build runtime skeleton." << std::endl;
-      return EXIT_FAILURE;
+      return false;
     }
   }
 
@@ -152,13 +202,13 @@ int SkeletonConverter::operator()(int _argc, const char** _argv) {
   // Once the file is opened, nothing should fail as it would leave an invalid
   // file on the disk.
   {
-    ozz::log::Log() << "Opens output file: " << OPTIONS_skeleton << std::endl;
-    ozz::io::File file(OPTIONS_skeleton, "wb");
+    ozz::log::Log() << "Opens output file: " << _skeleton << std::endl;
+    ozz::io::File file(_skeleton, "wb");
     if (!file.opened()) {
-      ozz::log::Err() << "Failed to open output file: " << OPTIONS_skeleton <<
+      ozz::log::Err() << "Failed to open output file: " << _skeleton <<
         std::endl;
       ozz::memory::default_allocator()->Delete(skeleton);
-      return EXIT_FAILURE;
+      return false;
     }
 
     // Initializes output endianness from options.
@@ -172,7 +222,7 @@ int SkeletonConverter::operator()(int _argc, const char** _argv) {
       " Endian output binary format selected." << std::endl;
 
     // Initializes output archive.
-    ozz::io::OArchive archive(&file, endianness);
+    ozz::io::OArchive archive(&file, endianness, OPTIONS_checksum);
 
     // Fills output archive with the skeleton.
     if (OPTIONS_raw) {
@@ -189,7 +239,7 @@ int SkeletonConverter::operator()(int _argc, const char** _argv) {
   // Delete local objects.
   ozz::memory::default_allocator()->Delete(skeleton);
 
-  return EXIT_SUCCESS;
+  return true;
 }
 }  // offline
 }  // animation
@@ -0,0 +1,171 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/options/options.h"
+
+// cookanim is a command line tool that converts an ozz animation archive to an
+// animation blob, the in-memory image of the animation for a target platform
+// (see Animation::SaveBlob). Archives are portable but have to be decoded at
+// load time, where a blob is used in place once it is read or memory mapped
+// (see Animation::MapBlob and AnimationLoader). Blobs only store offsets and
+// are aligned to Animation::kBlobAlignment, so they only depend on the target
+// endianness, which is selected with the endian option.
+//
+// Use cookanim integrated help command (cookanim --help) for more details
+// about available arguments.
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(file, "Specifies ozz animation input file", "",
+                           true)
+OZZ_OPTIONS_DECLARE_STRING(blob, "Specifies animation blob output file", "",
+                           true)
+
+static bool ValidateEndianness(const ozz::options::Option& _option,
+                               int /*_argc*/) {
+  const ozz::options::StringOption& option =
+    static_cast<const ozz::options::StringOption&>(_option);
+  bool valid = std::strcmp(option.value(), "native") == 0 ||
+               std::strcmp(option.value(), "little") == 0 ||
+               std::strcmp(option.value(), "big") == 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid endianess option." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING_FN(
+  endian,
+  "Selects target platform endianness. Can be \"native\" (same as current "\
+  "platform), \"little\" or \"big\".",
+  "native",
+  false,
+  &ValidateEndianness)
+
+namespace {
+
+// Loads an animation from ozz archive file _filename. Archives of any
+// endianness are supported. Returns false if the file can't be opened or
+// doesn't contain an animation.
+bool Load(const char* _filename, ozz::animation::Animation* _animation) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open input file " << _filename << "." <<
+      std::endl;
+    return false;
+  }
+  // Compressed archives are decompressed transparently.
+  ozz::io::BufferedStream buffered(&file);
+  ozz::io::CompressedStream compressed(&buffered,
+                                       ozz::io::CompressedStream::kRead);
+  ozz::io::IArchive archive(compressed.opened() ?
+    static_cast<ozz::io::Stream*>(&compressed) : &buffered);
+  if (!archive.TestTag<ozz::animation::Animation>()) {
+    ozz::log::Err() << "Failed to read an animation from file " <<
+      _filename << "." << std::endl;
+    return false;
+  }
+
+  archive.set_verify(true);
+  archive >> *_animation;
+  if (archive.corrupted()) {
+    ozz::log::Err() << "Corrupted data in input file " << _filename << "." <<
+      std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Writes _animation blob for a platform of _endianness to file _filename.
+bool Cook(const ozz::animation::Animation& _animation,
+          ozz::Endianness _endianness,
+          const char* _filename) {
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = _animation.blob_size();
+  void* blob =
+    allocator->Allocate(size, ozz::animation::Animation::kBlobAlignment);
+  bool success = _animation.SaveBlob(blob, size, _endianness);
+  if (success) {
+    ozz::io::File file(_filename, "wb");
+    success = file.opened() && file.Write(blob, size) == size;
+    if (!success) {
+      ozz::log::Err() << "Failed to write output file " << _filename << "." <<
+        std::endl;
+    }
+  }
+  allocator->Deallocate(blob);
+  return success;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+    _argc, _argv,
+    "1.0",
+    "Cooks ozz animations to blobs for a target platform");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ?
+      EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // Initializes target endianness from options.
+  ozz::Endianness endianness = ozz::GetNativeEndianness();
+  if (std::strcmp(OPTIONS_endian, "little") == 0) {
+    endianness = ozz::kLittleEndian;
+  } else if (std::strcmp(OPTIONS_endian, "big") == 0) {
+    endianness = ozz::kBigEndian;
+  }
+
+  ozz::animation::Animation animation;
+  if (!Load(OPTIONS_file, &animation)) {
+    return EXIT_FAILURE;
+  }
+
+  if (!Cook(animation, endianness, OPTIONS_blob)) {
+    return EXIT_FAILURE;
+  }
+
+  ozz::log::Log() << "Cooked " << OPTIONS_file << " to " <<
+    (endianness == ozz::kLittleEndian ? "little" : "big") <<
+    " endian blob " << OPTIONS_blob << " (" << animation.blob_size() <<
+    " bytes)." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,358 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <windows.h>
+#else  // _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#endif  // _WIN32
+
+#include "ozz/animation/offline/animation_footprint.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+
+#include "ozz/options/options.h"
+
+// dumpanim is a command line tool that analyzes the memory footprint of ozz
+// runtime animations. For every animation, it outputs the size of each buffer,
+// the number of constant tracks, and an estimate of the memory saved by each
+// compression mode and by an optimization with the given tolerances.
+// A per track breakdown (keys and bytes per track) can be output as well.
+//
+// The input can be a single animation file or a directory, in which case all
+// its .ozz animation files are analyzed and listed from the largest to the
+// smallest one.
+//
+// Use dumpanim integrated help command (dumpanim --help) for more details
+// about available arguments.
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(file,
+                           "Specifies ozz animation input file or directory",
+                           "", true)
+OZZ_OPTIONS_DECLARE_STRING(skeleton,
+                           "Specifies an optional ozz skeleton file, used to "
+                           "output joint names in tracks breakdown",
+                           "", false)
+OZZ_OPTIONS_DECLARE_BOOL(tracks, "Outputs per track breakdown", false, false)
+
+static bool ValidateTolerance(const ozz::options::Option& _option,
+                              int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+    static_cast<const ozz::options::FloatOption&>(_option);
+  bool valid = option.value() >= 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid tolerance option." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(
+  translation,
+  "Translation tolerance used to estimate removable keys",
+  ozz::animation::offline::AnimationFootprintAnalyzer().translation_tolerance,
+  false,
+  &ValidateTolerance)
+OZZ_OPTIONS_DECLARE_FLOAT_FN(
+  rotation,
+  "Rotation tolerance (in radians) used to estimate removable keys",
+  ozz::animation::offline::AnimationFootprintAnalyzer().rotation_tolerance,
+  false,
+  &ValidateTolerance)
+OZZ_OPTIONS_DECLARE_FLOAT_FN(
+  scale,
+  "Scale tolerance used to estimate removable keys",
+  ozz::animation::offline::AnimationFootprintAnalyzer().scale_tolerance,
+  false,
+  &ValidateTolerance)
+
+namespace {
+
+// Loads an object of type _Ty from ozz archive file _filename. Returns false
+// if the file can't be opened or doesn't contain an object of type _Ty.
+template<typename _Ty>
+bool Load(const char* _filename, _Ty* _object) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open input file " << _filename << "." <<
+      std::endl;
+    return false;
+  }
+  // Compressed archives are decompressed transparently.
+  ozz::io::BufferedStream buffered(&file);
+  ozz::io::CompressedStream compressed(&buffered,
+                                       ozz::io::CompressedStream::kRead);
+  ozz::io::IArchive archive(compressed.opened() ?
+    static_cast<ozz::io::Stream*>(&compressed) : &buffered);
+  if (!archive.TestTag<_Ty>()) {
+    return false;
+  }
+
+  // Once the tag is validated, reading cannot fail, but data can be
+  // corrupted if the archive stores checksums.
+  archive.set_verify(true);
+  archive >> *_object;
+  if (archive.corrupted()) {
+    ozz::log::Err() << "Corrupted data in input file " << _filename << "." <<
+      std::endl;
+    return false;
+  }
+  return true;
+}
+
+typedef ozz::Vector<ozz::String::Std>::Std Filenames;
+
+// Lists the .ozz files of directory _path to _filenames. Returns false if
+// _path isn't a directory.
+bool ListDirectory(const char* _path, Filenames* _filenames) {
+  const char kExtension[] = ".ozz";
+  const size_t extension_len = sizeof(kExtension) - 1;
+#ifdef _WIN32
+  const DWORD attributes = GetFileAttributesA(_path);
+  if (attributes == INVALID_FILE_ATTRIBUTES ||
+      !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+    return false;
+  }
+  const ozz::String::Std pattern = ozz::String::Std(_path) + "\\*.ozz";
+  WIN32_FIND_DATAA data;
+  HANDLE handle = FindFirstFileA(pattern.c_str(), &data);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return true;  // Empty directory.
+  }
+  do {
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+      _filenames->push_back(ozz::String::Std(_path) + "\\" + data.cFileName);
+    }
+  } while (FindNextFileA(handle, &data));
+  FindClose(handle);
+#else  // _WIN32
+  struct stat path_stat;
+  if (stat(_path, &path_stat) != 0 || !S_ISDIR(path_stat.st_mode)) {
+    return false;
+  }
+  DIR* dir = opendir(_path);
+  if (!dir) {
+    return false;
+  }
+  for (dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+    const size_t len = std::strlen(entry->d_name);
+    if (len > extension_len &&
+        std::strcmp(entry->d_name + len - extension_len, kExtension) == 0) {
+      _filenames->push_back(ozz::String::Std(_path) + "/" + entry->d_name);
+    }
+  }
+  closedir(dir);
+#endif  // _WIN32
+  (void)extension_len;
+  std::sort(_filenames->begin(), _filenames->end());
+  return true;
+}
+
+// Outputs a size in bytes, and its ratio to _total.
+void PrintSize(const char* _label, size_t _size, size_t _total) {
+  ozz::log::Out() << "  " << std::left << std::setw(28) << _label <<
+    std::right << std::setw(10) << _size << " bytes" << std::setw(8) <<
+    std::fixed << std::setprecision(1) <<
+    (_total ? 100.f * _size / _total : 0.f) << "%" << std::endl;
+}
+
+// Outputs _footprint of animation _filename.
+void PrintFootprint(const char* _filename,
+                    const ozz::animation::Animation& _animation,
+                    const ozz::animation::Skeleton* _skeleton,
+                    const ozz::animation::offline::AnimationFootprint&
+                      _footprint) {
+  const size_t total = _footprint.size;
+  ozz::log::Out() << _filename << ": " << _animation.num_tracks() <<
+    " tracks, " << _animation.duration() << "s, " << total << " bytes." <<
+    std::endl;
+
+  ozz::log::Out() << " Buffers:" << std::endl;
+  PrintSize("translations", _footprint.translations_size, total);
+  PrintSize("rotations", _footprint.rotations_size, total);
+  PrintSize("scales", _footprint.scales_size, total);
+  PrintSize("translation ranges", _footprint.translation_ranges_size, total);
+  PrintSize("tangents", _footprint.tangents_size, total);
+  PrintSize("seek index", _footprint.seek_index_size, total);
+  PrintSize("key links", _footprint.key_links_size, total);
+  PrintSize("bounds", _footprint.bounds_size, total);
+
+  ozz::log::Out() << " Keys (constant tracks): " <<
+    _footprint.translations << " (" << _footprint.constant_translations <<
+    ") translations, " <<
+    _footprint.rotations << " (" << _footprint.constant_rotations <<
+    ") rotations, " <<
+    _footprint.scales << " (" << _footprint.constant_scales <<
+    ") scales." << std::endl;
+
+  ozz::log::Out() << " Estimated savings:" << std::endl;
+  PrintSize("constant tracks", _footprint.constant_savings, total);
+  PrintSize("time quantization", _footprint.time_quantization_savings, total);
+  PrintSize("translation quantization",
+            _footprint.translation_quantization_savings, total);
+  PrintSize("quaternion packing", _footprint.quaternion_packing_savings,
+            total);
+  PrintSize("scale quantization", _footprint.scale_quantization_savings,
+            total);
+  PrintSize("tolerances", _footprint.tolerance_savings, total);
+
+  if (!OPTIONS_tracks) {
+    return;
+  }
+  const bool names =
+    _skeleton && _skeleton->num_joints() == _animation.num_tracks();
+  ozz::log::Out() << " Tracks (keys, C for constant tracks):" << std::endl;
+  ozz::log::Out() << "  " << std::setw(5) << "track" << std::setw(14) <<
+    "translations" << std::setw(11) << "rotations" << std::setw(8) <<
+    "scales" << std::setw(10) << "bytes" << std::setw(11) << "removable" <<
+    (names ? "  joint" : "") << std::endl;
+  for (size_t i = 0; i < _footprint.tracks.size(); ++i) {
+    const ozz::animation::offline::AnimationFootprint::Track& track =
+      _footprint.tracks[i];
+    ozz::log::Out() << "  " << std::setw(5) << i <<
+      std::setw(13) << track.translations <<
+      (track.constant_translation ? "C" : " ") <<
+      std::setw(10) << track.rotations <<
+      (track.constant_rotation ? "C" : " ") <<
+      std::setw(7) << track.scales <<
+      (track.constant_scale ? "C" : " ") <<
+      std::setw(10) << track.size << std::setw(11) << track.removable_keys;
+    if (names) {
+      ozz::log::Out() << "  " << _skeleton->joint_names()[i];
+    }
+    ozz::log::Out() << std::endl;
+  }
+}
+
+// Stores the footprint of a file, for the directory summary.
+struct FileFootprint {
+  ozz::String::Std filename;
+  size_t size;
+  size_t tolerance_savings;
+};
+
+bool SizeGreater(const FileFootprint& _a, const FileFootprint& _b) {
+  return _a.size > _b.size;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+    _argc, _argv,
+    "1.0",
+    "Analyzes ozz animations memory footprint");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ?
+      EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // Loads the optional skeleton.
+  ozz::animation::Skeleton skeleton;
+  const bool has_skeleton = *OPTIONS_skeleton.value() != 0;
+  if (has_skeleton && !Load(OPTIONS_skeleton, &skeleton)) {
+    ozz::log::Err() << "Failed to load skeleton file " << OPTIONS_skeleton <<
+      "." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Lists files to analyze.
+  Filenames filenames;
+  const bool directory = ListDirectory(OPTIONS_file, &filenames);
+  if (!directory) {
+    filenames.push_back(OPTIONS_file.value());
+  }
+
+  ozz::animation::offline::AnimationFootprintAnalyzer analyzer;
+  analyzer.translation_tolerance = OPTIONS_translation;
+  analyzer.rotation_tolerance = OPTIONS_rotation;
+  analyzer.scale_tolerance = OPTIONS_scale;
+
+  ozz::Vector<FileFootprint>::Std summary;
+  for (size_t i = 0; i < filenames.size(); ++i) {
+    const char* filename = filenames[i].c_str();
+    ozz::animation::Animation animation;
+    if (!Load(filename, &animation)) {
+      if (!directory) {
+        ozz::log::Err() << "Failed to read an animation from file " <<
+          filename << "." << std::endl;
+        return EXIT_FAILURE;
+      }
+      ozz::log::Log() << "Skips " << filename << ", which isn't an ozz " <<
+        "animation file." << std::endl;
+      continue;
+    }
+
+    ozz::animation::offline::AnimationFootprint footprint;
+    if (!analyzer(animation, &footprint)) {
+      ozz::log::Err() << "Failed to analyze animation " << filename << "." <<
+        std::endl;
+      return EXIT_FAILURE;
+    }
+    PrintFootprint(filename, animation, has_skeleton ? &skeleton : NULL,
+                   footprint);
+
+    const FileFootprint file_footprint = {
+      filenames[i], footprint.size, footprint.tolerance_savings};
+    summary.push_back(file_footprint);
+  }
+
+  if (directory) {
+    std::sort(summary.begin(), summary.end(), &SizeGreater);
+    size_t total = 0;
+    for (size_t i = 0; i < summary.size(); ++i) {
+      total += summary[i].size;
+    }
+    ozz::log::Out() << summary.size() << " animations, " << total <<
+      " bytes:" << std::endl;
+    for (size_t i = 0; i < summary.size(); ++i) {
+      ozz::log::Out() << "  " << std::setw(10) << summary[i].size <<
+        " bytes" << std::setw(8) << std::fixed << std::setprecision(1) <<
+        (total ? 100.f * summary[i].size / total : 0.f) << "%" <<
+        std::setw(10) << summary[i].tolerance_savings <<
+        " bytes removable  " << summary[i].filename << std::endl;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
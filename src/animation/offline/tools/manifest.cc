@@ -0,0 +1,118 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/offline/tools/manifest.h"
+
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace internal {
+
+namespace {
+// Returns _str without its leading and trailing spaces.
+ozz::String::Std Trim(const ozz::String::Std& _str) {
+  const char* spaces = " \t\r";
+  const size_t begin = _str.find_first_not_of(spaces);
+  if (begin == ozz::String::Std::npos) {
+    return ozz::String::Std();
+  }
+  const size_t end = _str.find_last_not_of(spaces);
+  return _str.substr(begin, end - begin + 1);
+}
+}  // namespace
+
+bool LoadManifest(const char* _filename,
+                  int _min_files, int _max_files,
+                  Manifest* _manifest) {
+  _manifest->clear();
+
+  // Reads the whole file content.
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open manifest file \"" << _filename <<
+      "\"." << std::endl;
+    return false;
+  }
+  ozz::String::Std content;
+  char buffer[256];
+  for (size_t read = file.Read(buffer, sizeof(buffer));
+       read != 0;
+       read = file.Read(buffer, sizeof(buffer))) {
+    content.append(buffer, read);
+  }
+
+  // Splits content in lines, and lines in comma separated files.
+  int line_number = 0;
+  for (size_t begin = 0; begin < content.size();) {
+    size_t end = content.find('\n', begin);
+    if (end == ozz::String::Std::npos) {
+      end = content.size();
+    }
+    const ozz::String::Std line = Trim(content.substr(begin, end - begin));
+    begin = end + 1;
+    ++line_number;
+
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    ManifestEntry entry;
+    for (size_t field = 0; field <= line.size();) {
+      size_t comma = line.find(',', field);
+      if (comma == ozz::String::Std::npos) {
+        comma = line.size();
+      }
+      entry.files.push_back(Trim(line.substr(field, comma - field)));
+      field = comma + 1;
+    }
+
+    const int num_files = static_cast<int>(entry.files.size());
+    bool valid = num_files >= _min_files && num_files <= _max_files;
+    for (int i = 0; valid && i < num_files; ++i) {
+      valid = !entry.files[i].empty();
+    }
+    if (!valid) {
+      ozz::log::Err() << "Invalid manifest \"" << _filename << "\" line " <<
+        line_number << ": \"" << line << "\"." << std::endl;
+      _manifest->clear();
+      return false;
+    }
+    _manifest->push_back(entry);
+  }
+  return true;
+}
+}  // internal
+}  // offline
+}  // animation
+}  // ozz
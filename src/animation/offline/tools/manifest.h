@@ -0,0 +1,67 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_OFFLINE_TOOLS_MANIFEST_H_
+#define OZZ_ANIMATION_OFFLINE_TOOLS_MANIFEST_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace internal {
+
+// Defines a manifest entry, ie the comma separated file names of a manifest
+// line.
+struct ManifestEntry {
+  ozz::Vector<ozz::String::Std>::Std files;
+};
+
+typedef ozz::Vector<ManifestEntry>::Std Manifest;
+
+// Loads manifest file _filename, which lists the files of batch conversions,
+// one conversion per line. Files of a line are separated by commas, and
+// leading and trailing spaces are ignored. Empty lines and lines starting
+// with '#' are ignored.
+// Returns false if the file can't be opened, or if a line has less than
+// _min_files or more than _max_files files, or an empty file name.
+bool LoadManifest(const char* _filename,
+                  int _min_files, int _max_files,
+                  Manifest* _manifest);
+}  // internal
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_OFFLINE_TOOLS_MANIFEST_H_
@@ -0,0 +1,206 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/aim_ik_job.h"
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/math_ex.h"
+
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+AimIKJob::AimIKJob()
+    : skeleton(NULL),
+      target(math::simd_float4::zero()),
+      forward(math::simd_float4::x_axis()),
+      weight(1.f) {
+}
+
+bool AimIKJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  if (!skeleton) {
+    return false;
+  }
+  valid &= locals.begin != NULL;
+  valid &= models.begin != NULL;
+  valid &= joints.begin != NULL;
+  valid &= joint_weights.begin != NULL;
+
+  // Test input and output ranges, implicitly tests for NULL end pointers.
+  const int num_joints = skeleton->num_joints();
+  valid &= locals.end - locals.begin >= skeleton->num_soa_joints();
+  valid &= models.end - models.begin >= num_joints;
+  valid &= joints.end - joints.begin > 0;
+  valid &= joint_weights.end - joint_weights.begin >= joints.end - joints.begin;
+  valid &= math::AreAllTrue1(math::IsNormalizedEst3(forward));
+  if (!valid) {
+    return false;
+  }
+
+  // Tests that every joint is a descendant of the previous one. Parents are
+  // always before their children, so the walk ends as soon as it goes beyond
+  // previous joint.
+  Range<const Skeleton::JointProperties> properties =
+      skeleton->joint_properties();
+  int previous = Skeleton::kNoParentIndex;
+  for (const int* joint = joints.begin; joint < joints.end; ++joint) {
+    if (*joint < 0 || *joint >= num_joints) {
+      return false;
+    }
+    if (previous != Skeleton::kNoParentIndex) {
+      int parent = *joint;
+      while (parent > previous) {
+        parent = properties.begin[parent].parent;
+      }
+      valid &= parent == previous;
+    }
+    previous = *joint;
+  }
+  return valid;
+}
+
+namespace {
+// Multiplies quaternions _a and _b, stored as SimdFloat4.
+math::SimdFloat4 MulQuaternion(math::_SimdFloat4 _a, math::_SimdFloat4 _b) {
+  const math::SimdFloat4 aw = math::SplatW(_a);
+  const math::SimdFloat4 bw = math::SplatW(_b);
+  const math::SimdFloat4 xyz = aw * _b + bw * _a + math::Cross3(_a, _b);
+  const math::SimdFloat4 w = aw * bw - math::SplatX(math::Dot3(_a, _b));
+  return math::SetW(xyz, math::GetX(w));
+}
+
+// Computes the quaternion that rotates normalized vector _from to normalized
+// vector _to. Half angle trigonometric functions are derived from the angle
+// cosine, avoiding any transcendental function.
+math::SimdFloat4 FromTo(math::_SimdFloat4 _from, math::_SimdFloat4 _to) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 cos =
+      math::Clamp(-one, math::SplatX(math::Dot3(_from, _to)), one);
+
+  // Opposite vectors rotate around any axis orthogonal to _from.
+  const math::SimdFloat4 orthogonal = math::NormalizeSafe3(
+      math::Cross3(_from, math::simd_float4::x_axis()),
+      math::simd_float4::y_axis());
+  const math::SimdFloat4 axis =
+      math::NormalizeSafe3(math::Cross3(_from, _to), orthogonal);
+  const math::SimdFloat4 c = math::Sqrt((one + cos) * half);
+  const math::SimdFloat4 s = math::Sqrt((one - cos) * half);
+  return math::SetW(axis * s, math::GetX(c));
+}
+}  // namespace
+
+bool AimIKJob::Run() const {
+  OZZ_PROFILE_SCOPE("AimIKJob::Run");
+  using math::SimdFloat4;
+  using math::Float4x4;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_chain_joints = static_cast<int>(joints.end - joints.begin);
+  const int aiming_joint = joints.begin[num_chain_joints - 1];
+  const float global_weight = math::Clamp(0.f, weight, 1.f);
+  const SimdFloat4 identity = math::simd_float4::w_axis();
+
+  for (int i = 0; i < num_chain_joints; ++i) {
+    const float joint_weight =
+        math::Clamp(0.f, joint_weights.begin[i], 1.f) * global_weight;
+    if (joint_weight <= 0.f) {
+      continue;
+    }
+
+    // Computes model space rotation that aligns aiming joint forward axis with
+    // the target, from its current position.
+    const Float4x4& aim = models.begin[aiming_joint];
+    const SimdFloat4 aim_forward =
+        math::NormalizeSafe3(TransformVector(aim, forward), forward);
+    const SimdFloat4 aim_target =
+        math::NormalizeSafe3(target - aim.cols[3], aim_forward);
+    const SimdFloat4 correction_ms = math::Normalize4(math::Lerp(
+        identity, FromTo(aim_forward, aim_target),
+        math::simd_float4::Load1(joint_weight)));
+
+    // Converts the correction to joint local space, rotating its axis with the
+    // inverse joint model space rotation.
+    const int joint = joints.begin[i];
+    const Float4x4& model = models.begin[joint];
+    const SimdFloat4 x =
+        math::NormalizeSafe3(model.cols[0], math::simd_float4::x_axis());
+    const SimdFloat4 y =
+        math::NormalizeSafe3(model.cols[1], math::simd_float4::y_axis());
+    const SimdFloat4 z =
+        math::NormalizeSafe3(model.cols[2], math::simd_float4::z_axis());
+    const SimdFloat4 correction = math::simd_float4::Load(
+        math::GetX(math::Dot3(x, correction_ms)),
+        math::GetX(math::Dot3(y, correction_ms)),
+        math::GetX(math::Dot3(z, correction_ms)),
+        math::GetW(correction_ms));
+
+    // Post-multiplies joint local rotation with the correction.
+    math::SoaQuaternion& soa_rotation = locals.begin[joint / 4].rotation;
+    SimdFloat4 rotations[4];
+    math::Transpose4x4(&soa_rotation.x, rotations);
+    rotations[joint & 3] =
+        math::Normalize4(MulQuaternion(rotations[joint & 3], correction));
+    math::Transpose4x4(rotations, &soa_rotation.x);
+
+    // Rotates remaining chain joints around the corrected joint, so that next
+    // joints work on the updated aiming joint.
+    const SimdFloat4 pivot = model.cols[3];
+    const Float4x4 rotate_around =
+        Float4x4::Translation(pivot) *
+        Float4x4::FromQuaternion(correction_ms) *
+        Float4x4::Translation(-pivot);
+    for (int j = i + 1; j < num_chain_joints; ++j) {
+      Float4x4& descendant = models.begin[joints.begin[j]];
+      descendant = rotate_around * descendant;
+    }
+  }
+
+  // Updates chain joints and all their descendants from the corrected local
+  // transforms.
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton;
+  ltm_job.from = joints.begin[0];
+  ltm_job.input = locals;
+  ltm_job.output = models;
+  return ltm_job.Run();
+}
+}  // animation
+}  // ozz
@@ -30,20 +30,72 @@
 
 #include "ozz/animation/runtime/animation.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/endianness.h"
 #include "ozz/base/io/archive.h"
+#include "ozz/base/maths/box.h"
 #include "ozz/base/maths/math_archive.h"
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/memory/allocator.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
 #include "../runtime/animation_keyframe.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedIncrement)
+#endif  // _MSC_VER
+
 namespace ozz {
 namespace animation {
 
+namespace {
+// Returns a new animation generation id, unique to the program. The counter is
+// atomically incremented as animations can be created from any thread. 0 is
+// skipped when wrapping around, as it's never a valid generation.
+uint32_t NewId() {
+#if defined(_MSC_VER)
+  static volatile long counter = 0;
+  const uint32_t id =
+    static_cast<uint32_t>(_InterlockedIncrement(&counter));
+#else  // _MSC_VER
+  static volatile uint32_t counter = 0;
+  const uint32_t id = __sync_add_and_fetch(&counter, 1);
+#endif  // _MSC_VER
+  return id ? id : NewId();
+}
+
+// Allocator of the key frame buffers, NULL for the default allocator.
+memory::Allocator* g_buffer_allocator = NULL;
+}  // namespace
+
+memory::Allocator* Animation::SetBufferAllocator(
+  memory::Allocator* _allocator) {
+  memory::Allocator* previous = g_buffer_allocator;
+  g_buffer_allocator = _allocator;
+  return previous;
+}
+
+memory::Allocator* Animation::buffer_allocator() {
+  return g_buffer_allocator ? g_buffer_allocator : memory::default_allocator();
+}
+
 Animation::Animation()
-    : duration_(0.f),
-      num_tracks_(0) {
+    : allocator_(buffer_allocator()),
+      duration_(0.f),
+      num_tracks_(0),
+      num_constant_translations_(0),
+      num_constant_rotations_(0),
+      num_constant_scales_(0),
+      scaled_(false),
+      uniformly_scaled_(true),
+      mapped_(false),
+      blob_(NULL),
+      id_(NewId()) {
 }
 
 Animation::~Animation() {
@@ -51,57 +103,512 @@ Animation::~Animation() {
 }
 
 void Animation::Destroy() {
-  memory::Allocator* allocator = memory::default_allocator();
-  allocator->Deallocate(translations_);
+  // Mapped buffers are owned by the blob, and so are loaded buffers.
+  if (!mapped_ && !blob_) {
+    allocator_->Deallocate(translations_);
+    allocator_->Deallocate(rotations_);
+    allocator_->Deallocate(scales_);
+    allocator_->Deallocate(translation_ranges_);
+    allocator_->Deallocate(tangents_);
+    allocator_->Deallocate(seek_index_);
+    allocator_->Deallocate(key_links_);
+    allocator_->Deallocate(bounds_);
+  }
+  allocator_->Deallocate(blob_);
+  blob_ = NULL;
   translations_.begin = NULL; translations_.end = NULL;
-  allocator->Deallocate(rotations_);
   rotations_.begin = NULL; rotations_.end = NULL;
-  allocator->Deallocate(scales_);
   scales_.begin = NULL; scales_.end = NULL;
+  translation_ranges_.begin = NULL; translation_ranges_.end = NULL;
+  tangents_.begin = NULL; tangents_.end = NULL;
+  seek_index_.begin = NULL; seek_index_.end = NULL;
+  key_links_.begin = NULL; key_links_.end = NULL;
+  bounds_.begin = NULL; bounds_.end = NULL;
+
+  // Content is about to change, so does generation id.
+  id_ = NewId();
 
   duration_ = 0.f;
   num_tracks_ = 0;
+  num_constant_translations_ = 0;
+  num_constant_rotations_ = 0;
+  num_constant_scales_ = 0;
+  scaled_ = false;
+  uniformly_scaled_ = true;
+  mapped_ = false;
+}
+
+void Animation::Swap(Animation* _animation) {
+  assert(_animation);
+  std::swap(translations_, _animation->translations_);
+  std::swap(rotations_, _animation->rotations_);
+  std::swap(scales_, _animation->scales_);
+  std::swap(translation_ranges_, _animation->translation_ranges_);
+  std::swap(tangents_, _animation->tangents_);
+  std::swap(seek_index_, _animation->seek_index_);
+  std::swap(key_links_, _animation->key_links_);
+  std::swap(bounds_, _animation->bounds_);
+  std::swap(allocator_, _animation->allocator_);
+  std::swap(duration_, _animation->duration_);
+  std::swap(num_tracks_, _animation->num_tracks_);
+  std::swap(num_constant_translations_,
+            _animation->num_constant_translations_);
+  std::swap(num_constant_rotations_, _animation->num_constant_rotations_);
+  std::swap(num_constant_scales_, _animation->num_constant_scales_);
+  std::swap(scaled_, _animation->scaled_);
+  std::swap(uniformly_scaled_, _animation->uniformly_scaled_);
+  std::swap(mapped_, _animation->mapped_);
+  std::swap(blob_, _animation->blob_);
+
+  // Content of both animations changed, so do their generation ids.
+  id_ = NewId();
+  _animation->id_ = NewId();
 }
 
 size_t Animation::size() const {
   const size_t size =
-    sizeof(*this) + translations_.Size() + rotations_.Size() + scales_.Size();
+    sizeof(*this) + translations_.Size() + rotations_.Size() + scales_.Size() +
+    translation_ranges_.Size() + tangents_.Size() + seek_index_.Size() +
+    key_links_.Size() + bounds_.Size();
   return size;
 }
 
-void Animation::Save(ozz::io::OArchive& _archive) const {
-  _archive << duration_;
-  _archive << static_cast<int32_t>(num_tracks_);
+const math::Box* Animation::bound(float _time) const {
+  const int count = static_cast<int>(bounds_.Count());
+  if (!count) {
+    return NULL;
+  }
+  // Segments have the same duration, the last one includes the end.
+  const float ratio = math::Clamp(0.f, _time / duration_, 1.f);
+  const int segment = static_cast<int>(ratio * count);
+  return bounds_.begin + (segment < count ? segment : count - 1);
+}
+
+namespace internal {
+namespace {
+
+// Translation and scale keys archive layout (time, track, 3 values) matches
+// their in-memory layout, which allows to save/load them as a whole buffer.
+OZZ_STATIC_ASSERT(sizeof(TranslationKey) == 5 * sizeof(uint16_t));
+OZZ_STATIC_ASSERT(sizeof(ScaleKey) == 5 * sizeof(uint16_t));
+OZZ_STATIC_ASSERT(sizeof(KeyTangent) == 4 * sizeof(uint16_t));
 
-  const ptrdiff_t translation_count = translations_.Count();
-  _archive << static_cast<int32_t>(translation_count);
-  for (ptrdiff_t i = 0; i < translation_count; ++i) {
-    const TranslationKey& key = translations_.begin[i];
-    _archive << key.time;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
+// Rotation keys archive layout is time, track, a byte that packs largest
+// component index (2 lower bits) and its sign (third bit), and 3 values, which
+// differs from the in-memory bitfield layout.
+const size_t kRotationKeyArchiveSize =
+  2 * sizeof(uint16_t) + sizeof(uint8_t) + 3 * sizeof(int16_t);
+
+// Number of keys processed per chunk, each chunk being saved/loaded with a
+// single stream call.
+const size_t kKeyChunkSize = 256;
+
+// Swaps in-place the endianness of _count translation/scale keys.
+template <typename _Key>
+void SwapKeys(_Key* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    _Key& key = _keys[i];
+    key.time = EndianSwapper<uint16_t>::Swap(key.time);
+    key.track = EndianSwapper<uint16_t>::Swap(key.track);
+    EndianSwapper<uint16_t>::Swap(key.value, 3);
+  }
+}
+
+template <typename _Key>
+void SaveHalfKeys(ozz::io::OArchive& _archive,
+                  const ozz::Range<const _Key>& _keys) {
+  if (!_archive.endian_swap()) {
+    OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(_keys.begin, _keys.Size());
+    assert(size == _keys.Size());
+    return;
+  }
+  const size_t count = _keys.Count();
+  _Key chunk[kKeyChunkSize];
+  for (size_t i = 0; i < count; i += kKeyChunkSize) {
+    const size_t chunk_count =
+      count - i < kKeyChunkSize ? count - i : kKeyChunkSize;
+    std::memcpy(chunk, _keys.begin + i, chunk_count * sizeof(_Key));
+    SwapKeys(chunk, chunk_count);
+    OZZ_IF_DEBUG(size_t size =)
+      _archive.SaveBinary(chunk, chunk_count * sizeof(_Key));
+    assert(size == chunk_count * sizeof(_Key));
+  }
+}
+
+template <typename _Key>
+void LoadHalfKeys(ozz::io::IArchive& _archive,
+                  const ozz::Range<_Key>& _keys) {
+  OZZ_IF_DEBUG(size_t size =) _archive.LoadBinary(_keys.begin, _keys.Size());
+  assert(size == _keys.Size());
+  if (_archive.endian_swap()) {
+    SwapKeys(_keys.begin, _keys.Count());
   }
+}
+}  // namespace
 
-  const ptrdiff_t rotation_count = rotations_.Count();
-  _archive << static_cast<int32_t>(rotation_count);
-  for (ptrdiff_t i = 0; i < rotation_count; ++i) {
-    const RotationKey& key = rotations_.begin[i];
-    _archive << key.time;
-    uint16_t track = key.track;
-    _archive << track;
-    bool wsign = key.wsign;
-    _archive << wsign;
-    _archive << ozz::io::MakeArray(key.value);
+bool HasScale(const ozz::Range<const ScaleKey>& _keys) {
+  for (const ScaleKey* key = _keys.begin; key < _keys.end; ++key) {
+    if (key->value[0] != kUnitScaleValue || key->value[1] != kUnitScaleValue ||
+        key->value[2] != kUnitScaleValue) {
+      return true;
+    }
   }
+  return false;
+}
 
-  const ptrdiff_t scale_count = scales_.Count();
-  _archive << static_cast<int32_t>(scale_count);
-  for (ptrdiff_t i = 0; i < scale_count; ++i) {
-    const ScaleKey& key = scales_.begin[i];
-    _archive << key.time;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
+bool HasUniformScale(const ozz::Range<const ScaleKey>& _keys) {
+  for (const ScaleKey* key = _keys.begin; key < _keys.end; ++key) {
+    if (key->value[0] != key->value[1] || key->value[0] != key->value[2]) {
+      return false;
+    }
   }
+  return true;
+}
+
+void SaveKeys(ozz::io::OArchive& _archive,
+              const ozz::Range<const TranslationKey>& _keys) {
+  SaveHalfKeys(_archive, _keys);
+}
+
+void SaveKeys(ozz::io::OArchive& _archive,
+              const ozz::Range<const ScaleKey>& _keys) {
+  SaveHalfKeys(_archive, _keys);
+}
+
+void LoadKeys(ozz::io::IArchive& _archive,
+              const ozz::Range<TranslationKey>& _keys) {
+  LoadHalfKeys(_archive, _keys);
+}
+
+void LoadKeys(ozz::io::IArchive& _archive,
+              const ozz::Range<ScaleKey>& _keys) {
+  LoadHalfKeys(_archive, _keys);
+}
+
+void SaveKeys(ozz::io::OArchive& _archive,
+              const ozz::Range<const RotationKey>& _keys) {
+  const size_t count = _keys.Count();
+  const bool swap = _archive.endian_swap();
+  char chunk[kKeyChunkSize * kRotationKeyArchiveSize];
+  for (size_t i = 0; i < count; i += kKeyChunkSize) {
+    const size_t chunk_count =
+      count - i < kKeyChunkSize ? count - i : kKeyChunkSize;
+    char* cursor = chunk;
+    for (size_t j = 0; j < chunk_count; ++j) {
+      const RotationKey& key = _keys.begin[i + j];
+      uint16_t time = key.time;
+      uint16_t track = key.track;
+      uint8_t packed =
+        static_cast<uint8_t>(key.largest | (key.sign << 2));
+      int16_t value[3] = {key.value[0], key.value[1], key.value[2]};
+      if (swap) {
+        time = EndianSwapper<uint16_t>::Swap(time);
+        track = EndianSwapper<uint16_t>::Swap(track);
+        EndianSwapper<int16_t>::Swap(value, 3);
+      }
+      std::memcpy(cursor, &time, sizeof(time)); cursor += sizeof(time);
+      std::memcpy(cursor, &track, sizeof(track)); cursor += sizeof(track);
+      std::memcpy(cursor, &packed, sizeof(packed));
+      cursor += sizeof(packed);
+      std::memcpy(cursor, value, sizeof(value)); cursor += sizeof(value);
+    }
+    const size_t chunk_size = cursor - chunk;
+    OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(chunk, chunk_size);
+    assert(size == chunk_size);
+  }
+}
+
+void LoadKeys(ozz::io::IArchive& _archive,
+              const ozz::Range<RotationKey>& _keys) {
+  const size_t count = _keys.Count();
+  const bool swap = _archive.endian_swap();
+  char chunk[kKeyChunkSize * kRotationKeyArchiveSize];
+  for (size_t i = 0; i < count; i += kKeyChunkSize) {
+    const size_t chunk_count =
+      count - i < kKeyChunkSize ? count - i : kKeyChunkSize;
+    const size_t chunk_size = chunk_count * kRotationKeyArchiveSize;
+    OZZ_IF_DEBUG(size_t size =) _archive.LoadBinary(chunk, chunk_size);
+    assert(size == chunk_size);
+    const char* cursor = chunk;
+    for (size_t j = 0; j < chunk_count; ++j) {
+      uint16_t time;
+      uint16_t track;
+      uint8_t packed;
+      int16_t value[3];
+      std::memcpy(&time, cursor, sizeof(time)); cursor += sizeof(time);
+      std::memcpy(&track, cursor, sizeof(track)); cursor += sizeof(track);
+      std::memcpy(&packed, cursor, sizeof(packed));
+      cursor += sizeof(packed);
+      std::memcpy(value, cursor, sizeof(value)); cursor += sizeof(value);
+      if (swap) {
+        time = EndianSwapper<uint16_t>::Swap(time);
+        track = EndianSwapper<uint16_t>::Swap(track);
+        EndianSwapper<int16_t>::Swap(value, 3);
+      }
+      RotationKey& key = _keys.begin[i + j];
+      key.time = time;
+      key.track = track;
+      key.largest = packed & 3;
+      key.sign = (packed >> 2) & 1;
+      key.value[0] = value[0];
+      key.value[1] = value[1];
+      key.value[2] = value[2];
+    }
+  }
+}
+
+void SaveRanges(ozz::io::OArchive& _archive,
+                const ozz::Range<const SoaTranslationRange>& _ranges) {
+  for (const SoaTranslationRange* range = _ranges.begin;
+       range < _ranges.end;
+       ++range) {
+    _archive << ozz::io::MakeArray(range->min[0], 12);
+    _archive << ozz::io::MakeArray(range->scale[0], 12);
+  }
+}
+
+void LoadRanges(ozz::io::IArchive& _archive,
+                const ozz::Range<SoaTranslationRange>& _ranges) {
+  for (SoaTranslationRange* range = _ranges.begin;
+       range < _ranges.end;
+       ++range) {
+    _archive >> ozz::io::MakeArray(range->min[0], 12);
+    _archive >> ozz::io::MakeArray(range->scale[0], 12);
+  }
+}
+
+// Tangents are contiguous half floats, saved/loaded as a single array.
+void SaveTangents(ozz::io::OArchive& _archive,
+                  const ozz::Range<const KeyTangent>& _tangents) {
+  if (_tangents.Count()) {
+    _archive << ozz::io::MakeArray(_tangents.begin->value,
+                                   _tangents.Count() * 4);
+  }
+}
+
+void LoadTangents(ozz::io::IArchive& _archive,
+                  const ozz::Range<KeyTangent>& _tangents) {
+  if (_tangents.Count()) {
+    _archive >> ozz::io::MakeArray(_tangents.begin->value,
+                                   _tangents.Count() * 4);
+  }
+}
+
+void SaveSeekIndex(ozz::io::OArchive& _archive,
+                   const ozz::Range<const int32_t>& _index) {
+  if (_index.Count()) {
+    _archive << ozz::io::MakeArray(_index.begin, _index.Count());
+  }
+}
+
+void LoadSeekIndex(ozz::io::IArchive& _archive,
+                   const ozz::Range<int32_t>& _index) {
+  if (_index.Count()) {
+    _archive >> ozz::io::MakeArray(_index.begin, _index.Count());
+  }
+}
+
+void SaveKeyLinks(ozz::io::OArchive& _archive,
+                  const ozz::Range<const uint16_t>& _links) {
+  if (_links.Count()) {
+    _archive << ozz::io::MakeArray(_links.begin, _links.Count());
+  }
+}
+
+void LoadKeyLinks(ozz::io::IArchive& _archive,
+                  const ozz::Range<uint16_t>& _links) {
+  if (_links.Count()) {
+    _archive >> ozz::io::MakeArray(_links.begin, _links.Count());
+  }
+}
+}  // internal
+
+namespace {
+// Defines the blob header, which is followed by translation ranges,
+// translation, rotation and scale key frames, key tangents, seek index, key
+// links and bounds buffers, each one aligned to Animation::kBlobAlignment.
+struct BlobHeader {
+  // Identifies an animation blob, and detects endianness mismatches as the
+  // tag is read in native endianness.
+  uint32_t tag;
+
+  // Blob format version.
+  uint32_t version;
+
+  // Key frames and range sizes, which detects layout mismatches.
+  uint16_t translation_key_size;
+  uint16_t rotation_key_size;
+  uint16_t scale_key_size;
+  uint16_t translation_range_size;
+  uint16_t tangent_size;
+  uint16_t padding;
+
+  float duration;
+  int32_t num_tracks;
+
+  int32_t translation_count;
+  int32_t rotation_count;
+  int32_t scale_count;
+
+  int32_t num_constant_translations;
+  int32_t num_constant_rotations;
+  int32_t num_constant_scales;
+
+  int32_t translation_range_count;
+  int32_t tangent_count;
+  int32_t seek_index_size;
+  int32_t key_link_count;
+  int32_t bound_count;
+};
+
+const uint32_t kBlobTag = 0x617a7a6f;  // "ozza" in little endian.
+const uint32_t kBlobVersion = 9;
+
+size_t AlignBlobOffset(size_t _offset) {
+  return (_offset + Animation::kBlobAlignment - 1) &
+         ~(Animation::kBlobAlignment - 1);
+}
+
+// Computes the offset of each buffer in the blob, and returns blob size.
+size_t BlobLayout(int32_t _range_count,
+                  int32_t _translation_count,
+                  int32_t _rotation_count,
+                  int32_t _scale_count,
+                  int32_t _tangent_count,
+                  int32_t _seek_index_size,
+                  int32_t _key_link_count,
+                  int32_t _bound_count,
+                  size_t* _ranges,
+                  size_t* _translations,
+                  size_t* _rotations,
+                  size_t* _scales,
+                  size_t* _tangents,
+                  size_t* _seek_index,
+                  size_t* _key_links,
+                  size_t* _bounds) {
+  *_ranges = AlignBlobOffset(sizeof(BlobHeader));
+  *_translations = AlignBlobOffset(
+    *_ranges + _range_count * sizeof(SoaTranslationRange));
+  *_rotations = AlignBlobOffset(
+    *_translations + _translation_count * sizeof(TranslationKey));
+  *_scales = AlignBlobOffset(
+    *_rotations + _rotation_count * sizeof(RotationKey));
+  *_tangents = AlignBlobOffset(
+    *_scales + _scale_count * sizeof(ScaleKey));
+  *_seek_index = AlignBlobOffset(
+    *_tangents + _tangent_count * sizeof(KeyTangent));
+  *_key_links = AlignBlobOffset(
+    *_seek_index + _seek_index_size * sizeof(int32_t));
+  *_bounds = AlignBlobOffset(
+    *_key_links + _key_link_count * sizeof(uint16_t));
+  return *_bounds + _bound_count * sizeof(math::Box);
+}
+
+bool IsBlobAligned(const void* _blob) {
+  return (reinterpret_cast<uintptr_t>(_blob) &
+          (Animation::kBlobAlignment - 1)) == 0;
+}
+
+// Swaps in place the endianness of all _header fields.
+void SwapBlobHeader(BlobHeader* _header) {
+  _header->tag = EndianSwapper<uint32_t>::Swap(_header->tag);
+  _header->version = EndianSwapper<uint32_t>::Swap(_header->version);
+  // Sizes and padding are 6 consecutive uint16_t.
+  EndianSwapper<uint16_t>::Swap(&_header->translation_key_size, 6);
+  _header->duration = EndianSwapper<float>::Swap(_header->duration);
+  // num_tracks is followed by 11 int32_t counts.
+  EndianSwapper<int32_t>::Swap(&_header->num_tracks, 12);
+}
+
+// Converts in place the _count native rotation keys _keys to the layout of a
+// platform of _endianness, opposite to the native one. Bit fields can't simply
+// be swapped, as compilers allocate them from the least significant bit on
+// little endian platforms and from the most significant one on big endian
+// platforms.
+void SwapRotationKeys(RotationKey* _keys, size_t _count,
+                      Endianness _endianness) {
+  for (size_t i = 0; i < _count; ++i) {
+    RotationKey& key = _keys[i];
+    const uint16_t bits =
+      _endianness == kLittleEndian ?
+        static_cast<uint16_t>(key.track | (key.largest << 13) |
+                              (key.sign << 15)) :
+        static_cast<uint16_t>((key.track << 3) | (key.largest << 1) |
+                              key.sign);
+    const uint16_t swapped = EndianSwapper<uint16_t>::Swap(bits);
+    key.time = EndianSwapper<uint16_t>::Swap(key.time);
+    EndianSwapper<int16_t>::Swap(key.value, 3);
+    memcpy(reinterpret_cast<char*>(&key) + sizeof(key.time), &swapped,
+           sizeof(swapped));
+  }
+}
+
+// Returns true if _header is a valid blob header for the running platform.
+bool IsBlobHeaderValid(const BlobHeader& _header) {
+  return _header.tag == kBlobTag &&
+         _header.version == kBlobVersion &&
+         _header.translation_key_size == sizeof(TranslationKey) &&
+         _header.rotation_key_size == sizeof(RotationKey) &&
+         _header.scale_key_size == sizeof(ScaleKey) &&
+         _header.translation_range_size == sizeof(SoaTranslationRange) &&
+         _header.tangent_size == sizeof(KeyTangent) &&
+         _header.num_tracks >= 0 &&
+         _header.translation_count >= 0 &&
+         _header.rotation_count >= 0 &&
+         _header.scale_count >= 0 &&
+         _header.num_constant_translations >= 0 &&
+         _header.num_constant_translations <= _header.translation_count &&
+         _header.num_constant_rotations >= 0 &&
+         _header.num_constant_rotations <= _header.rotation_count &&
+         _header.num_constant_scales >= 0 &&
+         _header.num_constant_scales <= _header.scale_count &&
+         _header.translation_range_count >= 0 &&
+         (_header.tangent_count == 0 ||
+          _header.tangent_count == _header.translation_count +
+                                   _header.rotation_count +
+                                   _header.scale_count) &&
+         _header.seek_index_size >= 0 &&
+         (_header.seek_index_size == 0 ||
+          (_header.num_tracks != 0 &&
+           _header.seek_index_size %
+             SeekEntrySize((_header.num_tracks + 3) / 4) == 0)) &&
+         (_header.key_link_count == 0 ||
+          _header.key_link_count == _header.translation_count +
+                                    _header.rotation_count +
+                                    _header.scale_count) &&
+         _header.bound_count >= 0;
+}
+}  // namespace
+
+void Animation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+
+  // All buffer sizes are saved first, so that Load can allocate buffers at
+  // once.
+  _archive << static_cast<int32_t>(translation_ranges_.Count());
+  _archive << static_cast<int32_t>(translations_.Count());
+  _archive << static_cast<int32_t>(num_constant_translations_);
+  _archive << static_cast<int32_t>(rotations_.Count());
+  _archive << static_cast<int32_t>(num_constant_rotations_);
+  _archive << static_cast<int32_t>(scales_.Count());
+  _archive << static_cast<int32_t>(num_constant_scales_);
+  _archive << static_cast<int32_t>(tangents_.Count());
+  _archive << static_cast<int32_t>(seek_index_.Count());
+  _archive << static_cast<int32_t>(key_links_.Count());
+  _archive << static_cast<int32_t>(bounds_.Count());
+
+  internal::SaveRanges(_archive, translation_ranges());
+
+  // Key frames are saved by chunks rather than one member at a time.
+  internal::SaveKeys(_archive, translations());
+  internal::SaveKeys(_archive, rotations());
+  internal::SaveKeys(_archive, scales());
+
+  internal::SaveTangents(_archive, tangents());
+  internal::SaveSeekIndex(_archive, seek_index());
+  internal::SaveKeyLinks(_archive, key_links());
+  _archive << ozz::io::MakeArray(bounds_.begin, bounds_.Count());
 }
 
 void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
@@ -109,12 +616,18 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   // Destroy animation in case it was already used before.
   Destroy();
 
-  // No retro-compatibility with anterior versions.
-  if (_version != 2) {
+  memory::ScopedTag tag(memory::kTagAnimation);
+
+  // No retro-compatibility with anterior versions, as their float key times
+  // can't be converted without merging keys, translations were stored as half
+  // floats, rotations didn't use smallest three compression, and tangents,
+  // seek index, key links and bounds weren't stored.
+  if (_version != 10 && _version != 11) {
     return;
   }
 
-  memory::Allocator* allocator = memory::default_allocator();
+  // Buffers are allocated with the current buffer allocator.
+  allocator_ = buffer_allocator();
 
   _archive >> duration_;
 
@@ -122,38 +635,338 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> num_tracks;
   num_tracks_ = num_tracks;
 
+  // Version 10 interleaves buffer sizes and content.
+  if (_version == 10) {
+    LoadV10(_archive);
+    return;
+  }
+
+  int32_t range_count;
+  _archive >> range_count;
   int32_t translation_count;
   _archive >> translation_count;
-  translations_ = allocator->AllocateRange<TranslationKey>(translation_count);
-  for (int i = 0; i < translation_count; ++i) {
-    TranslationKey& key = translations_.begin[i];
-    _archive >> key.time;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+  int32_t num_constant_translations;
+  _archive >> num_constant_translations;
+  num_constant_translations_ = num_constant_translations;
+  int32_t rotation_count;
+  _archive >> rotation_count;
+  int32_t num_constant_rotations;
+  _archive >> num_constant_rotations;
+  num_constant_rotations_ = num_constant_rotations;
+  int32_t scale_count;
+  _archive >> scale_count;
+  int32_t num_constant_scales;
+  _archive >> num_constant_scales;
+  num_constant_scales_ = num_constant_scales;
+  int32_t tangent_count;
+  _archive >> tangent_count;
+  int32_t seek_index_size;
+  _archive >> seek_index_size;
+  int32_t key_link_count;
+  _archive >> key_link_count;
+  int32_t bound_count;
+  _archive >> bound_count;
+
+  // All buffers are packed in a single allocation, laid out like a blob
+  // without its header.
+  size_t ranges, translations, rotations, scales, tangents, seek_index;
+  size_t key_links, bounds;
+  const size_t size = BlobLayout(range_count,
+                                 translation_count,
+                                 rotation_count,
+                                 scale_count,
+                                 tangent_count,
+                                 seek_index_size,
+                                 key_link_count,
+                                 bound_count,
+                                 &ranges, &translations, &rotations,
+                                 &scales, &tangents, &seek_index,
+                                 &key_links, &bounds);
+  char* buffer = static_cast<char*>(
+    allocator_->Allocate(size - ranges, kBlobAlignment));
+  if (!buffer) {
+    return;
   }
+  blob_ = buffer;
+  translation_ranges_ = Range<SoaTranslationRange>(
+    reinterpret_cast<SoaTranslationRange*>(buffer), range_count);
+  translations_ = Range<TranslationKey>(
+    reinterpret_cast<TranslationKey*>(buffer + translations - ranges),
+    translation_count);
+  rotations_ = Range<RotationKey>(
+    reinterpret_cast<RotationKey*>(buffer + rotations - ranges),
+    rotation_count);
+  scales_ = Range<ScaleKey>(
+    reinterpret_cast<ScaleKey*>(buffer + scales - ranges), scale_count);
+  tangents_ = Range<KeyTangent>(
+    reinterpret_cast<KeyTangent*>(buffer + tangents - ranges), tangent_count);
+  seek_index_ = Range<int32_t>(
+    reinterpret_cast<int32_t*>(buffer + seek_index - ranges),
+    seek_index_size);
+  key_links_ = Range<uint16_t>(
+    reinterpret_cast<uint16_t*>(buffer + key_links - ranges), key_link_count);
+  bounds_ = Range<math::Box>(
+    reinterpret_cast<math::Box*>(buffer + bounds - ranges), bound_count);
+
+  internal::LoadRanges(_archive, translation_ranges_);
+
+  // Key frames are loaded by chunks rather than one member at a time.
+  internal::LoadKeys(_archive, translations_);
+  internal::LoadKeys(_archive, rotations_);
+  internal::LoadKeys(_archive, scales_);
+  scaled_ = internal::HasScale(scales_);
+  uniformly_scaled_ = internal::HasUniformScale(scales_);
+
+  internal::LoadTangents(_archive, tangents_);
+  internal::LoadSeekIndex(_archive, seek_index_);
+  internal::LoadKeyLinks(_archive, key_links_);
+  _archive >> ozz::io::MakeArray(bounds_.begin, bounds_.Count());
+}
+
+void Animation::LoadV10(ozz::io::IArchive& _archive) {
+  memory::Allocator* allocator = allocator_;
+
+  int32_t range_count;
+  _archive >> range_count;
+  translation_ranges_ =
+    allocator->AllocateRange<SoaTranslationRange>(range_count);
+  internal::LoadRanges(_archive, translation_ranges_);
+
+  // Key frames are loaded by chunks rather than one member at a time.
+  int32_t translation_count;
+  _archive >> translation_count;
+  int32_t num_constant_translations;
+  _archive >> num_constant_translations;
+  num_constant_translations_ = num_constant_translations;
+  translations_ = allocator->AllocateRange<TranslationKey>(translation_count);
+  internal::LoadKeys(_archive, translations_);
   int32_t rotation_count;
   _archive >> rotation_count;
+  int32_t num_constant_rotations;
+  _archive >> num_constant_rotations;
+  num_constant_rotations_ = num_constant_rotations;
   rotations_ = allocator->AllocateRange<RotationKey>(rotation_count);
-  for (int i = 0; i < rotation_count; ++i) {
-    RotationKey& key = rotations_.begin[i];
-    _archive >> key.time;
-    uint16_t track;
-    _archive >> track;
-    key.track = track;
-    bool wsign;
-    _archive >> wsign;
-    key.wsign = wsign;
-    _archive >> ozz::io::MakeArray(key.value);
-  }
+  internal::LoadKeys(_archive, rotations_);
   int32_t scale_count;
   _archive >> scale_count;
+  int32_t num_constant_scales;
+  _archive >> num_constant_scales;
+  num_constant_scales_ = num_constant_scales;
   scales_ = allocator->AllocateRange<ScaleKey>(scale_count);
-  for (int i = 0; i < scale_count; ++i) {
-    ScaleKey& key = scales_.begin[i];
-    _archive >> key.time;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+  internal::LoadKeys(_archive, scales_);
+  scaled_ = internal::HasScale(scales_);
+  uniformly_scaled_ = internal::HasUniformScale(scales_);
+
+  int32_t tangent_count;
+  _archive >> tangent_count;
+  tangents_ = allocator->AllocateRange<KeyTangent>(tangent_count);
+  internal::LoadTangents(_archive, tangents_);
+
+  int32_t seek_index_size;
+  _archive >> seek_index_size;
+  seek_index_ = allocator->AllocateRange<int32_t>(seek_index_size);
+  internal::LoadSeekIndex(_archive, seek_index_);
+
+  int32_t key_link_count;
+  _archive >> key_link_count;
+  key_links_ = allocator->AllocateRange<uint16_t>(key_link_count);
+  internal::LoadKeyLinks(_archive, key_links_);
+
+  int32_t bound_count;
+  _archive >> bound_count;
+  bounds_ = allocator->AllocateRange<math::Box>(bound_count);
+  _archive >> ozz::io::MakeArray(bounds_.begin, bounds_.Count());
+}
+
+size_t Animation::blob_header_size() {
+  return sizeof(BlobHeader);
+}
+
+size_t Animation::blob_size(const void* _header, size_t _size) {
+  if (!_header || _size < sizeof(BlobHeader)) {
+    return 0;
+  }
+  BlobHeader header;
+  memcpy(&header, _header, sizeof(header));
+  if (!IsBlobHeaderValid(header)) {
+    return 0;
+  }
+  size_t ranges, translations, rotations, scales, tangents, seek_index;
+  size_t key_links, bounds;
+  return BlobLayout(header.translation_range_count,
+                    header.translation_count,
+                    header.rotation_count,
+                    header.scale_count,
+                    header.tangent_count,
+                    header.seek_index_size,
+                    header.key_link_count,
+                    header.bound_count,
+                    &ranges, &translations, &rotations, &scales, &tangents,
+                    &seek_index, &key_links, &bounds);
+}
+
+size_t Animation::blob_size() const {
+  size_t ranges, translations, rotations, scales, tangents, seek_index;
+  size_t key_links, bounds;
+  return BlobLayout(static_cast<int32_t>(translation_ranges_.Count()),
+                    static_cast<int32_t>(translations_.Count()),
+                    static_cast<int32_t>(rotations_.Count()),
+                    static_cast<int32_t>(scales_.Count()),
+                    static_cast<int32_t>(tangents_.Count()),
+                    static_cast<int32_t>(seek_index_.Count()),
+                    static_cast<int32_t>(key_links_.Count()),
+                    static_cast<int32_t>(bounds_.Count()),
+                    &ranges, &translations, &rotations, &scales, &tangents,
+                    &seek_index, &key_links, &bounds);
+}
+
+bool Animation::SaveBlob(void* _blob, size_t _size) const {
+  return SaveBlob(_blob, _size, GetNativeEndianness());
+}
+
+bool Animation::SaveBlob(void* _blob, size_t _size,
+                         Endianness _endianness) const {
+  if (!_blob || !IsBlobAligned(_blob) || _size < blob_size()) {
+    return false;
+  }
+
+  BlobHeader header;
+  header.tag = kBlobTag;
+  header.version = kBlobVersion;
+  header.translation_key_size = sizeof(TranslationKey);
+  header.rotation_key_size = sizeof(RotationKey);
+  header.scale_key_size = sizeof(ScaleKey);
+  header.translation_range_size = sizeof(SoaTranslationRange);
+  header.tangent_size = sizeof(KeyTangent);
+  header.padding = 0;
+  header.duration = duration_;
+  header.num_tracks = num_tracks_;
+  header.translation_count = static_cast<int32_t>(translations_.Count());
+  header.rotation_count = static_cast<int32_t>(rotations_.Count());
+  header.scale_count = static_cast<int32_t>(scales_.Count());
+  header.num_constant_translations = num_constant_translations_;
+  header.num_constant_rotations = num_constant_rotations_;
+  header.num_constant_scales = num_constant_scales_;
+  header.translation_range_count =
+    static_cast<int32_t>(translation_ranges_.Count());
+  header.tangent_count = static_cast<int32_t>(tangents_.Count());
+  header.seek_index_size = static_cast<int32_t>(seek_index_.Count());
+  header.key_link_count = static_cast<int32_t>(key_links_.Count());
+  header.bound_count = static_cast<int32_t>(bounds_.Count());
+
+  size_t ranges, translations, rotations, scales, tangents, seek_index;
+  size_t key_links, bounds;
+  const size_t size = BlobLayout(header.translation_range_count,
+                                 header.translation_count,
+                                 header.rotation_count,
+                                 header.scale_count,
+                                 header.tangent_count,
+                                 header.seek_index_size,
+                                 header.key_link_count,
+                                 header.bound_count,
+                                 &ranges, &translations, &rotations,
+                                 &scales, &tangents, &seek_index,
+                                 &key_links, &bounds);
+
+  // Clears the whole blob first, so that padding bytes are deterministic.
+  char* blob = static_cast<char*>(_blob);
+  memset(blob, 0, size);
+  memcpy(blob, &header, sizeof(header));
+  memcpy(blob + ranges, translation_ranges_.begin, translation_ranges_.Size());
+  memcpy(blob + translations, translations_.begin, translations_.Size());
+  memcpy(blob + rotations, rotations_.begin, rotations_.Size());
+  memcpy(blob + scales, scales_.begin, scales_.Size());
+  memcpy(blob + tangents, tangents_.begin, tangents_.Size());
+  memcpy(blob + seek_index, seek_index_.begin, seek_index_.Size());
+  memcpy(blob + key_links, key_links_.begin, key_links_.Size());
+  memcpy(blob + bounds, bounds_.begin, bounds_.Size());
+
+  // Converts native buffers in place for a platform of opposite endianness.
+  if (_endianness != GetNativeEndianness()) {
+    SwapBlobHeader(reinterpret_cast<BlobHeader*>(blob));
+    EndianSwapper<float>::Swap(reinterpret_cast<float*>(blob + ranges),
+                               translation_ranges_.Size() / sizeof(float));
+    EndianSwapper<uint16_t>::Swap(reinterpret_cast<uint16_t*>(
+      blob + translations), translations_.Size() / sizeof(uint16_t));
+    SwapRotationKeys(reinterpret_cast<RotationKey*>(blob + rotations),
+                     rotations_.Count(), _endianness);
+    EndianSwapper<uint16_t>::Swap(reinterpret_cast<uint16_t*>(blob + scales),
+                                  scales_.Size() / sizeof(uint16_t));
+    EndianSwapper<uint16_t>::Swap(reinterpret_cast<uint16_t*>(
+      blob + tangents), tangents_.Size() / sizeof(uint16_t));
+    EndianSwapper<int32_t>::Swap(reinterpret_cast<int32_t*>(
+      blob + seek_index), seek_index_.Count());
+    EndianSwapper<uint16_t>::Swap(reinterpret_cast<uint16_t*>(
+      blob + key_links), key_links_.Count());
+    EndianSwapper<float>::Swap(reinterpret_cast<float*>(blob + bounds),
+                               bounds_.Size() / sizeof(float));
+  }
+  return true;
+}
+
+bool Animation::MapBlob(const void* _blob, size_t _size) {
+
+  // Destroy animation in case it was already used before.
+  Destroy();
+
+  if (!_blob || !IsBlobAligned(_blob) || _size < sizeof(BlobHeader)) {
+    return false;
+  }
+
+  BlobHeader header;
+  memcpy(&header, _blob, sizeof(header));
+  if (!IsBlobHeaderValid(header)) {
+    return false;
+  }
+
+  size_t ranges, translations, rotations, scales, tangents, seek_index;
+  size_t key_links, bounds;
+  const size_t size = BlobLayout(header.translation_range_count,
+                                 header.translation_count,
+                                 header.rotation_count,
+                                 header.scale_count,
+                                 header.tangent_count,
+                                 header.seek_index_size,
+                                 header.key_link_count,
+                                 header.bound_count,
+                                 &ranges, &translations, &rotations,
+                                 &scales, &tangents, &seek_index,
+                                 &key_links, &bounds);
+  if (_size < size) {
+    return false;
   }
+
+  // Buffers are never written to through these ranges, which are only
+  // non-const because they are otherwise owned by the animation.
+  char* blob = const_cast<char*>(static_cast<const char*>(_blob));
+  translation_ranges_.begin =
+    reinterpret_cast<SoaTranslationRange*>(blob + ranges);
+  translation_ranges_.end =
+    translation_ranges_.begin + header.translation_range_count;
+  translations_.begin = reinterpret_cast<TranslationKey*>(blob + translations);
+  translations_.end = translations_.begin + header.translation_count;
+  rotations_.begin = reinterpret_cast<RotationKey*>(blob + rotations);
+  rotations_.end = rotations_.begin + header.rotation_count;
+  scales_.begin = reinterpret_cast<ScaleKey*>(blob + scales);
+  scales_.end = scales_.begin + header.scale_count;
+  tangents_.begin = reinterpret_cast<KeyTangent*>(blob + tangents);
+  tangents_.end = tangents_.begin + header.tangent_count;
+  seek_index_.begin = reinterpret_cast<int32_t*>(blob + seek_index);
+  seek_index_.end = seek_index_.begin + header.seek_index_size;
+  key_links_.begin = reinterpret_cast<uint16_t*>(blob + key_links);
+  key_links_.end = key_links_.begin + header.key_link_count;
+  bounds_.begin = reinterpret_cast<math::Box*>(blob + bounds);
+  bounds_.end = bounds_.begin + header.bound_count;
+
+  duration_ = header.duration;
+  num_tracks_ = header.num_tracks;
+  num_constant_translations_ = header.num_constant_translations;
+  num_constant_rotations_ = header.num_constant_rotations;
+  num_constant_scales_ = header.num_constant_scales;
+  scaled_ = internal::HasScale(scales_);
+  uniformly_scaled_ = internal::HasUniformScale(scales_);
+  mapped_ = true;
+  return true;
 }
 }  // animation
 }  // ozz
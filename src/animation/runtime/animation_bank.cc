@@ -0,0 +1,404 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_bank.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/math_archive.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Reserves space for _count _Ty in a buffer, whose current size is _size.
+// Returns the offset of the reserved space.
+template<typename _Ty>
+size_t Reserve(size_t* _size, int _count) {
+  const size_t offset = math::Align(*_size, AlignOf<_Ty>::value);
+  *_size = offset + _count * sizeof(_Ty);
+  return offset;
+}
+
+// Sets _range to _count _Ty at _offset in _buffer.
+template<typename _Ty>
+void SetRange(char* _buffer, size_t _offset, int _count,
+              ozz::Range<_Ty>* _range) {
+  _range->begin = reinterpret_cast<_Ty*>(_buffer + _offset);
+  _range->end = _range->begin + _count;
+}
+
+// Hashes _name using FNV-1a algorithm.
+uint32_t HashName(const char* _name) {
+  uint32_t hash = 2166136261u;
+  for (const char* c = _name; *c; ++c) {
+    hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+  }
+  return hash;
+}
+}  // namespace
+
+AnimationBank::AnimationBank()
+    : buffer_(NULL),
+      buffer_size_(0),
+      allocator_(NULL) {
+}
+
+AnimationBank::~AnimationBank() {
+  Destroy();
+}
+
+void AnimationBank::Destroy() {
+  // Animations are mapped to the buffer, so they don't deallocate anything.
+  for (Animation* animation = animations_.begin;
+       animation < animations_.end;
+       ++animation) {
+    animation->~Animation();
+  }
+  if (allocator_) {
+    allocator_->Deallocate(buffer_);
+  }
+  buffer_ = NULL;
+  buffer_size_ = 0;
+  animations_ = ozz::Range<Animation>();
+  name_offsets_ = ozz::Range<int32_t>();
+  name_hashes_ = ozz::Range<uint32_t>();
+  lookup_ = ozz::Range<int32_t>();
+  translation_ranges_ = ozz::Range<SoaTranslationRange>();
+  translations_ = ozz::Range<TranslationKey>();
+  rotations_ = ozz::Range<RotationKey>();
+  scales_ = ozz::Range<ScaleKey>();
+  tangents_ = ozz::Range<KeyTangent>();
+  seek_index_ = ozz::Range<int32_t>();
+  key_links_ = ozz::Range<uint16_t>();
+  bounds_ = ozz::Range<math::Box>();
+  names_ = ozz::Range<char>();
+}
+
+void AnimationBank::Allocate(int _num_animations,
+                             int _num_translation_ranges,
+                             int _num_translations,
+                             int _num_rotations,
+                             int _num_scales,
+                             int _num_tangents,
+                             int _seek_index_size,
+                             int _num_key_links,
+                             int _num_bounds,
+                             int _names_size) {
+  assert(buffer_ == NULL && "Bank must be destroyed first.");
+
+  memory::ScopedTag tag(memory::kTagAnimation);
+
+  // Lookup table size is the power of 2 above twice the number of
+  // animations, which ensures short probing sequences.
+  int lookup_size = 0;
+  if (_num_animations) {
+    for (lookup_size = 1; lookup_size < _num_animations * 2;
+         lookup_size <<= 1) {
+    }
+  }
+
+  // Computes buffer layout.
+  size_t size = 0;
+  const size_t animations = Reserve<Animation>(&size, _num_animations);
+  const size_t name_offsets = Reserve<int32_t>(&size, _num_animations);
+  const size_t name_hashes = Reserve<uint32_t>(&size, _num_animations);
+  const size_t lookup = Reserve<int32_t>(&size, lookup_size);
+  const size_t translation_ranges =
+    Reserve<SoaTranslationRange>(&size, _num_translation_ranges);
+  const size_t translations =
+    Reserve<TranslationKey>(&size, _num_translations);
+  const size_t rotations = Reserve<RotationKey>(&size, _num_rotations);
+  const size_t scales = Reserve<ScaleKey>(&size, _num_scales);
+  const size_t tangents = Reserve<KeyTangent>(&size, _num_tangents);
+  const size_t seek_index = Reserve<int32_t>(&size, _seek_index_size);
+  const size_t key_links = Reserve<uint16_t>(&size, _num_key_links);
+  const size_t bounds = Reserve<math::Box>(&size, _num_bounds);
+  const size_t names = Reserve<char>(&size, _names_size);
+
+  // Allocates the single buffer.
+  buffer_size_ = size;
+  allocator_ = Animation::buffer_allocator();
+  buffer_ = reinterpret_cast<char*>(
+    allocator_->Allocate(size, AlignOf<Animation>::value));
+
+  SetRange(buffer_, animations, _num_animations, &animations_);
+  SetRange(buffer_, name_offsets, _num_animations, &name_offsets_);
+  SetRange(buffer_, name_hashes, _num_animations, &name_hashes_);
+  SetRange(buffer_, lookup, lookup_size, &lookup_);
+  SetRange(buffer_, translation_ranges, _num_translation_ranges,
+           &translation_ranges_);
+  SetRange(buffer_, translations, _num_translations, &translations_);
+  SetRange(buffer_, rotations, _num_rotations, &rotations_);
+  SetRange(buffer_, scales, _num_scales, &scales_);
+  SetRange(buffer_, tangents, _num_tangents, &tangents_);
+  SetRange(buffer_, seek_index, _seek_index_size, &seek_index_);
+  SetRange(buffer_, key_links, _num_key_links, &key_links_);
+  SetRange(buffer_, bounds, _num_bounds, &bounds_);
+  SetRange(buffer_, names, _names_size, &names_);
+
+  // Constructs empty animations, flagged as mapped as they don't own their
+  // key frames.
+  for (Animation* animation = animations_.begin;
+       animation < animations_.end;
+       ++animation) {
+    new(animation) Animation;
+    animation->mapped_ = true;
+  }
+}
+
+void AnimationBank::BuildLookupTable() {
+  for (int32_t* bucket = lookup_.begin; bucket < lookup_.end; ++bucket) {
+    *bucket = -1;
+  }
+  const uint32_t mask = static_cast<uint32_t>(lookup_.Count() - 1);
+  for (int i = 0; i < num_animations(); ++i) {
+    const uint32_t hash = HashName(name(i));
+    name_hashes_.begin[i] = hash;
+    uint32_t bucket = hash & mask;
+    while (lookup_.begin[bucket] != -1) {  // Linear probing.
+      bucket = (bucket + 1) & mask;
+    }
+    lookup_.begin[bucket] = i;
+  }
+}
+
+const Animation& AnimationBank::animation(int _index) const {
+  assert(_index >= 0 && _index < num_animations());
+  return animations_.begin[_index];
+}
+
+const char* AnimationBank::name(int _index) const {
+  assert(_index >= 0 && _index < num_animations());
+  return names_.begin + name_offsets_.begin[_index];
+}
+
+int AnimationBank::Find(const char* _name) const {
+  if (!_name || lookup_.Count() == 0) {
+    return -1;
+  }
+  const uint32_t hash = HashName(_name);
+  const uint32_t mask = static_cast<uint32_t>(lookup_.Count() - 1);
+  for (uint32_t bucket = hash & mask;; bucket = (bucket + 1) & mask) {
+    const int32_t index = lookup_.begin[bucket];
+    if (index == -1) {
+      return -1;
+    }
+    if (name_hashes_.begin[index] == hash &&
+        std::strcmp(name(index), _name) == 0) {
+      return index;
+    }
+  }
+}
+
+size_t AnimationBank::size() const {
+  return sizeof(*this) + buffer_size_;
+}
+
+void AnimationBank::Save(ozz::io::OArchive& _archive) const {
+  const int32_t num_animations = static_cast<int32_t>(animations_.Count());
+  _archive << num_animations;
+  _archive << static_cast<int32_t>(translation_ranges_.Count());
+  _archive << static_cast<int32_t>(translations_.Count());
+  _archive << static_cast<int32_t>(rotations_.Count());
+  _archive << static_cast<int32_t>(scales_.Count());
+  _archive << static_cast<int32_t>(tangents_.Count());
+  _archive << static_cast<int32_t>(seek_index_.Count());
+  _archive << static_cast<int32_t>(key_links_.Count());
+  _archive << static_cast<int32_t>(bounds_.Count());
+
+  // Shared names table.
+  const int32_t names_size = static_cast<int32_t>(names_.Count());
+  _archive << names_size;
+  _archive << ozz::io::MakeArray(names_.begin, names_size);
+
+  // Animations index.
+  for (int i = 0; i < num_animations; ++i) {
+    const Animation& animation = animations_.begin[i];
+    _archive << name_offsets_.begin[i];
+    _archive << animation.duration_;
+    _archive << static_cast<int32_t>(animation.num_tracks_);
+    _archive << static_cast<int32_t>(animation.translation_ranges_.Count());
+    _archive << static_cast<int32_t>(animation.translations_.Count());
+    _archive << static_cast<int32_t>(animation.num_constant_translations_);
+    _archive << static_cast<int32_t>(animation.rotations_.Count());
+    _archive << static_cast<int32_t>(animation.num_constant_rotations_);
+    _archive << static_cast<int32_t>(animation.scales_.Count());
+    _archive << static_cast<int32_t>(animation.num_constant_scales_);
+    _archive << static_cast<int32_t>(animation.tangents_.Count());
+    _archive << static_cast<int32_t>(animation.seek_index_.Count());
+    _archive << static_cast<int32_t>(animation.key_links_.Count());
+    _archive << static_cast<int32_t>(animation.bounds_.Count());
+  }
+
+  // Translation ranges, key frames, tangents, seek index, key links and
+  // bounds, which are contiguous for all animations.
+  internal::SaveRanges(_archive, ozz::Range<const SoaTranslationRange>(
+    translation_ranges_.begin, translation_ranges_.end));
+  internal::SaveKeys(_archive, ozz::Range<const TranslationKey>(
+    translations_.begin, translations_.end));
+  internal::SaveKeys(_archive, ozz::Range<const RotationKey>(
+    rotations_.begin, rotations_.end));
+  internal::SaveKeys(_archive, ozz::Range<const ScaleKey>(
+    scales_.begin, scales_.end));
+  internal::SaveTangents(_archive, ozz::Range<const KeyTangent>(
+    tangents_.begin, tangents_.end));
+  internal::SaveSeekIndex(_archive, ozz::Range<const int32_t>(
+    seek_index_.begin, seek_index_.end));
+  internal::SaveKeyLinks(_archive, ozz::Range<const uint16_t>(
+    key_links_.begin, key_links_.end));
+  _archive << ozz::io::MakeArray(bounds_.begin, bounds_.Count());
+}
+
+void AnimationBank::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+
+  // Destroy bank in case it was already used before.
+  Destroy();
+
+  // No retro-compatibility with anterior versions, whose key frames format
+  // differs.
+  if (_version != 9) {
+    return;
+  }
+
+  int32_t num_animations;
+  _archive >> num_animations;
+  int32_t num_translation_ranges;
+  _archive >> num_translation_ranges;
+  int32_t num_translations;
+  _archive >> num_translations;
+  int32_t num_rotations;
+  _archive >> num_rotations;
+  int32_t num_scales;
+  _archive >> num_scales;
+  int32_t num_tangents;
+  _archive >> num_tangents;
+  int32_t seek_index_size;
+  _archive >> seek_index_size;
+  int32_t num_key_links;
+  _archive >> num_key_links;
+  int32_t num_bounds;
+  _archive >> num_bounds;
+  int32_t names_size;
+  _archive >> names_size;
+
+  // Allocates everything at once.
+  Allocate(num_animations, num_translation_ranges, num_translations,
+           num_rotations, num_scales, num_tangents, seek_index_size,
+           num_key_links, num_bounds, names_size);
+
+  _archive >> ozz::io::MakeArray(names_.begin, names_size);
+
+  // Maps animations to bank translation ranges, key frames, tangents, seek
+  // index, key links and bounds.
+  SoaTranslationRange* translation_ranges = translation_ranges_.begin;
+  TranslationKey* translations = translations_.begin;
+  RotationKey* rotations = rotations_.begin;
+  ScaleKey* scales = scales_.begin;
+  KeyTangent* tangents = tangents_.begin;
+  int32_t* seek_index = seek_index_.begin;
+  uint16_t* key_links = key_links_.begin;
+  math::Box* bounds = bounds_.begin;
+  for (int i = 0; i < num_animations; ++i) {
+    Animation& animation = animations_.begin[i];
+    _archive >> name_offsets_.begin[i];
+    _archive >> animation.duration_;
+    int32_t num_tracks;
+    _archive >> num_tracks;
+    animation.num_tracks_ = num_tracks;
+    int32_t count;
+    int32_t num_constants;
+    _archive >> count;
+    animation.translation_ranges_.begin = translation_ranges;
+    animation.translation_ranges_.end = translation_ranges += count;
+    _archive >> count;
+    _archive >> num_constants;
+    animation.translations_.begin = translations;
+    animation.translations_.end = translations += count;
+    animation.num_constant_translations_ = num_constants;
+    _archive >> count;
+    _archive >> num_constants;
+    animation.rotations_.begin = rotations;
+    animation.rotations_.end = rotations += count;
+    animation.num_constant_rotations_ = num_constants;
+    _archive >> count;
+    _archive >> num_constants;
+    animation.scales_.begin = scales;
+    animation.scales_.end = scales += count;
+    animation.num_constant_scales_ = num_constants;
+    animation.scaled_ = internal::HasScale(animation.scales_);
+    animation.uniformly_scaled_ = internal::HasUniformScale(animation.scales_);
+    _archive >> count;
+    animation.tangents_.begin = tangents;
+    animation.tangents_.end = tangents += count;
+    _archive >> count;
+    animation.seek_index_.begin = seek_index;
+    animation.seek_index_.end = seek_index += count;
+    _archive >> count;
+    animation.key_links_.begin = key_links;
+    animation.key_links_.end = key_links += count;
+    _archive >> count;
+    animation.bounds_.begin = bounds;
+    animation.bounds_.end = bounds += count;
+  }
+  assert(translation_ranges == translation_ranges_.end &&
+         translations == translations_.end &&
+         rotations == rotations_.end &&
+         scales == scales_.end &&
+         tangents == tangents_.end &&
+         seek_index == seek_index_.end &&
+         key_links == key_links_.end &&
+         bounds == bounds_.end);
+
+  internal::LoadRanges(_archive, translation_ranges_);
+  internal::LoadKeys(_archive, translations_);
+  internal::LoadKeys(_archive, rotations_);
+  internal::LoadKeys(_archive, scales_);
+  internal::LoadTangents(_archive, tangents_);
+  internal::LoadSeekIndex(_archive, seek_index_);
+  internal::LoadKeyLinks(_archive, key_links_);
+  _archive >> ozz::io::MakeArray(bounds_.begin, bounds_.Count());
+
+  BuildLookupTable();
+}
+}  // animation
+}  // ozz
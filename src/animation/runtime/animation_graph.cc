@@ -0,0 +1,482 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_graph.h"
+
+#include <cassert>
+#include <new>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+
+struct AnimationGraph::Node {
+  NodeType type;
+
+  // Range of inputs of the node.
+  int first_input;
+  int num_inputs;
+
+  // Sample node parameters.
+  const Animation* animation;
+  SamplingCache* cache;
+  float time;
+
+  // Mask node weights, and their complement, skeleton num_soa_joints each.
+  math::SimdFloat4* mask;
+
+  // Cached result, NULL if node isn't cached. The result is valid if its stamp
+  // isn't older than the node modification stamp.
+  math::SoaTransform* cached;
+  uint32_t cached_stamp;
+
+  // Modification stamp of the node.
+  uint32_t modified;
+
+  // Latest modification stamp of the node and its active inputs, computed
+  // once per evaluation.
+  uint32_t evaluation;
+  uint32_t subtree_modified;
+
+  // Number of scratch postures required to evaluate the node.
+  int scratch_need;
+};
+
+const int AnimationGraph::kInvalidNode;
+
+AnimationGraph::Input::Input()
+    : node(kInvalidNode),
+      weight(0.f) {
+}
+
+AnimationGraph::AnimationGraph(const Skeleton& _skeleton,
+                               int _max_nodes,
+                               int _max_inputs)
+    : skeleton_(_skeleton),
+      nodes_(NULL),
+      max_nodes_(math::Max(_max_nodes, 0)),
+      num_nodes_(0),
+      inputs_(NULL),
+      max_inputs_(math::Max(_max_inputs, 0)),
+      num_inputs_(0),
+      layers_(NULL),
+      scratch_(NULL),
+      scratch_size_(0),
+      scratch_top_(0),
+      stamp_(0),
+      evaluation_(0),
+      num_computed_nodes_(0) {
+  memory::Allocator* allocator = memory::default_allocator();
+  nodes_ = allocator->Allocate<Node>(max_nodes_);
+  inputs_ = allocator->Allocate<Input>(max_inputs_);
+  layers_ = allocator->Allocate<BlendingJob::Layer>(max_inputs_);
+  for (int i = 0; i < max_inputs_; ++i) {
+    new(inputs_ + i) Input;
+    new(layers_ + i) BlendingJob::Layer;
+  }
+}
+
+AnimationGraph::~AnimationGraph() {
+  memory::Allocator* allocator = memory::default_allocator();
+  for (int i = 0; i < num_nodes_; ++i) {
+    allocator->Deallocate(nodes_[i].mask);
+    allocator->Deallocate(nodes_[i].cached);
+  }
+  allocator->Deallocate(nodes_);
+  allocator->Deallocate(inputs_);
+  allocator->Deallocate(layers_);
+  allocator->Deallocate(scratch_);
+}
+
+AnimationGraph::Node* AnimationGraph::NewNode(NodeType _type,
+                                              int _num_inputs) {
+  if (num_nodes_ >= max_nodes_ || num_inputs_ + _num_inputs > max_inputs_) {
+    return NULL;
+  }
+  Node* node = nodes_ + num_nodes_;
+  node->type = _type;
+  node->first_input = num_inputs_;
+  node->num_inputs = _num_inputs;
+  node->animation = NULL;
+  node->cache = NULL;
+  node->time = 0.f;
+  node->mask = NULL;
+  node->cached = NULL;
+  node->cached_stamp = 0;
+  node->modified = 0;
+  node->evaluation = 0;
+  node->subtree_modified = 0;
+  node->scratch_need = 1;
+  return node;
+}
+
+bool AnimationGraph::ValidateInput(
+  int _index, Range<const math::SimdFloat4> _joint_weights) const {
+  bool valid = true;
+  valid &= _index >= 0 && _index < num_nodes_;
+  if (_joint_weights.begin) {
+    valid &= _joint_weights.end - _joint_weights.begin >=
+             skeleton_.num_soa_joints();
+  } else {
+    valid &= _joint_weights.end == NULL;
+  }
+  return valid;
+}
+
+int AnimationGraph::FinalizeNode() {
+  Node& node = nodes_[num_nodes_];
+
+  // Input i result is kept in the scratch while next inputs are evaluated.
+  // The node result is allocated first.
+  int need = 0;
+  for (int i = 0; i < node.num_inputs; ++i) {
+    const Input& input = inputs_[node.first_input + i];
+    need = math::Max(need, i + nodes_[input.node].scratch_need);
+  }
+  node.scratch_need = need + 1;
+
+  // Grows the scratch arena, which is never used concurrently to building.
+  if (node.scratch_need > scratch_size_) {
+    scratch_size_ = node.scratch_need;
+    scratch_ = memory::default_allocator()->Reallocate(
+      scratch_, scratch_size_ * skeleton_.num_soa_joints());
+  }
+
+  num_inputs_ += node.num_inputs;
+  const int index = num_nodes_++;
+  Modify(index);
+  return index;
+}
+
+int AnimationGraph::AddSampleNode(const Animation* _animation,
+                                  SamplingCache* _cache) {
+  if (!_animation || !_cache ||
+      _animation->num_tracks() > skeleton_.num_joints()) {
+    return kInvalidNode;
+  }
+  Node* node = NewNode(kSample, 0);
+  if (!node) {
+    return kInvalidNode;
+  }
+  node->animation = _animation;
+  node->cache = _cache;
+  return FinalizeNode();
+}
+
+int AnimationGraph::AddBlendNode(Range<const Input> _inputs) {
+  bool valid = _inputs.end >= _inputs.begin;
+  for (const Input* input = _inputs.begin;
+       _inputs.begin && input < _inputs.end;  // Handles NULL pointers.
+       ++input) {
+    valid &= ValidateInput(input->node, input->joint_weights);
+  }
+  Node* node = valid ? NewNode(kBlend, static_cast<int>(_inputs.Count())) :
+                       NULL;
+  if (!node) {
+    return kInvalidNode;
+  }
+  for (int i = 0; i < node->num_inputs; ++i) {
+    inputs_[node->first_input + i] = _inputs.begin[i];
+  }
+  return FinalizeNode();
+}
+
+int AnimationGraph::AddAdditiveNode(int _base, int _additive, float _weight) {
+  const Range<const math::SimdFloat4> no_weights;
+  if (!ValidateInput(_base, no_weights) ||
+      !ValidateInput(_additive, no_weights)) {
+    return kInvalidNode;
+  }
+  Node* node = NewNode(kAdditive, 2);
+  if (!node) {
+    return kInvalidNode;
+  }
+  Input* inputs = inputs_ + node->first_input;
+  inputs[0] = Input();
+  inputs[0].node = _base;
+  inputs[0].weight = 1.f;
+  inputs[1] = Input();
+  inputs[1].node = _additive;
+  inputs[1].weight = _weight;
+  return FinalizeNode();
+}
+
+int AnimationGraph::AddMaskNode(int _base,
+                                int _input,
+                                Range<const math::SimdFloat4> _mask) {
+  if (!_mask.begin ||
+      !ValidateInput(_base, Range<const math::SimdFloat4>()) ||
+      !ValidateInput(_input, _mask)) {
+    return kInvalidNode;
+  }
+  Node* node = NewNode(kMask, 2);
+  if (!node) {
+    return kInvalidNode;
+  }
+
+  // Base is blended with the complement of the mask, so that a weight of 1
+  // fully selects the input.
+  const int num_soa_joints = skeleton_.num_soa_joints();
+  node->mask = memory::default_allocator()->Allocate<math::SimdFloat4>(
+    num_soa_joints * 2);
+  const math::SimdFloat4 one = math::simd_float4::one();
+  for (int i = 0; i < num_soa_joints; ++i) {
+    node->mask[i] = _mask.begin[i];
+    node->mask[num_soa_joints + i] = one - _mask.begin[i];
+  }
+
+  Input* inputs = inputs_ + node->first_input;
+  inputs[0] = Input();
+  inputs[0].node = _base;
+  inputs[0].weight = 1.f;
+  inputs[0].joint_weights.begin = node->mask + num_soa_joints;
+  inputs[0].joint_weights.end = node->mask + num_soa_joints * 2;
+  inputs[1] = Input();
+  inputs[1].node = _input;
+  inputs[1].weight = 1.f;
+  inputs[1].joint_weights.begin = node->mask;
+  inputs[1].joint_weights.end = node->mask + num_soa_joints;
+  return FinalizeNode();
+}
+
+void AnimationGraph::SetTime(int _node, float _time) {
+  assert(_node >= 0 && _node < num_nodes_ && nodes_[_node].type == kSample);
+  Node& node = nodes_[_node];
+  if (node.time != _time) {
+    node.time = _time;
+    Modify(_node);
+  }
+}
+
+void AnimationGraph::SetWeight(int _node, int _input, float _weight) {
+  assert(_node >= 0 && _node < num_nodes_);
+  const Node& node = nodes_[_node];
+  assert((node.type == kBlend && _input >= 0 && _input < node.num_inputs) ||
+         (node.type == kAdditive && _input == 1));
+  Input& input = inputs_[node.first_input + _input];
+  if (input.weight != _weight) {
+    input.weight = _weight;
+    Modify(_node);
+  }
+}
+
+void AnimationGraph::SetCached(int _node, bool _cached) {
+  assert(_node >= 0 && _node < num_nodes_);
+  Node& node = nodes_[_node];
+  memory::Allocator* allocator = memory::default_allocator();
+  if (_cached && !node.cached) {
+    node.cached =
+      allocator->Allocate<math::SoaTransform>(skeleton_.num_soa_joints());
+    node.cached_stamp = 0;
+  } else if (!_cached && node.cached) {
+    allocator->Deallocate(node.cached);
+    node.cached = NULL;
+  }
+}
+
+void AnimationGraph::Invalidate(int _node) {
+  assert(_node >= 0 && _node < num_nodes_);
+  Modify(_node);
+}
+
+void AnimationGraph::Modify(int _node) {
+  nodes_[_node].modified = ++stamp_;
+}
+
+uint32_t AnimationGraph::Modified(int _node) {
+  Node& node = nodes_[_node];
+  if (node.evaluation != evaluation_) {
+    // Inputs that aren't evaluated don't affect the result, but activating or
+    // deactivating them modifies the node.
+    uint32_t modified = node.modified;
+    for (int i = 0; i < node.num_inputs; ++i) {
+      const Input& input = inputs_[node.first_input + i];
+      if (input.weight > 0.f) {
+        modified = math::Max(modified, Modified(input.node));
+      }
+    }
+    node.evaluation = evaluation_;
+    node.subtree_modified = modified;
+  }
+  return node.subtree_modified;
+}
+
+bool AnimationGraph::Evaluate(int _node, Range<math::SoaTransform> _output) {
+  if (_node < 0 || _node >= num_nodes_ || !_output.begin ||
+      _output.end < _output.begin + skeleton_.num_soa_joints()) {
+    return false;
+  }
+
+  // Starts a new evaluation.
+  ++evaluation_;
+  num_computed_nodes_ = 0;
+  scratch_top_ = 0;
+
+  return EvaluateNodeTo(_node, _output.begin);
+}
+
+bool AnimationGraph::EvaluateNodeTo(int _node, math::SoaTransform* _dest) {
+  const math::SoaTransform* result = EvaluateNode(_node, _dest);
+  if (!result) {
+    return false;
+  }
+  if (result != _dest) {
+    const int num_soa_joints = skeleton_.num_soa_joints();
+    for (int i = 0; i < num_soa_joints; ++i) {
+      _dest[i] = result[i];
+    }
+  }
+  return true;
+}
+
+bool AnimationGraph::Blend(const Node& _node,
+                           int _num_layers,
+                           int _num_additive_layers,
+                           math::SoaTransform* _output) {
+  const int num_soa_joints = skeleton_.num_soa_joints();
+  BlendingJob::Layer* layers = layers_ + _node.first_input;
+  BlendingJob job;
+  job.layers.begin = layers;
+  job.layers.end = layers + _num_layers;
+  if (_num_additive_layers) {
+    job.additive_layers.begin = job.layers.end;
+    job.additive_layers.end = job.layers.end + _num_additive_layers;
+  }
+  job.bind_pose = skeleton_.bind_pose();
+  job.output.begin = _output;
+  job.output.end = _output + num_soa_joints;
+  return job.Run();
+}
+
+const math::SoaTransform* AnimationGraph::EvaluateNode(
+  int _node, math::SoaTransform* _dest) {
+  Node& node = nodes_[_node];
+  const int num_soa_joints = skeleton_.num_soa_joints();
+
+  // Selects node output, which can be its cached result.
+  uint32_t modified = 0;
+  math::SoaTransform* output;
+  if (node.cached) {
+    modified = Modified(_node);
+    if (node.cached_stamp >= modified) {
+      return node.cached;
+    }
+    output = node.cached;
+  } else if (_dest) {
+    output = _dest;
+  } else {
+    assert(scratch_top_ < scratch_size_);
+    output = scratch_ + scratch_top_++ * num_soa_joints;
+  }
+
+  // Inputs results are released from the scratch once node is computed.
+  const int scratch_top = scratch_top_;
+  bool success = true;
+  const Input* inputs = inputs_ + node.first_input;
+  BlendingJob::Layer* layers = layers_ + node.first_input;
+  switch (node.type) {
+    case kSample: {
+      SamplingJob job;
+      job.animation = node.animation;
+      job.cache = node.cache;
+      job.time = node.time;
+      job.output.begin = output;
+      job.output.end = output + num_soa_joints;
+      success = job.Run();
+
+      // Joints that aren't animated are set to the bind pose.
+      const math::SoaTransform* bind_pose = skeleton_.bind_pose().begin;
+      for (int i = node.animation->num_soa_tracks(); i < num_soa_joints; ++i) {
+        output[i] = bind_pose[i];
+      }
+      break;
+    }
+    case kBlend: {
+      // Zero weight inputs are pruned, active layers are packed.
+      int num_layers = 0;
+      for (int i = 0; success && i < node.num_inputs; ++i) {
+        const Input& input = inputs[i];
+        if (input.weight <= 0.f) {
+          continue;
+        }
+        const math::SoaTransform* result = EvaluateNode(input.node, NULL);
+        success = result != NULL;
+        BlendingJob::Layer& layer = layers[num_layers++];
+        layer.weight = input.weight;
+        layer.transform.begin = result;
+        layer.transform.end = result + num_soa_joints;
+        layer.joint_weights = input.joint_weights;
+      }
+      success = success && Blend(node, num_layers, 0, output);
+      break;
+    }
+    case kAdditive:
+    case kMask: {
+      if (node.type == kAdditive && inputs[1].weight <= 0.f) {
+        // Additive input is pruned, base is thus the result.
+        success = EvaluateNodeTo(inputs[0].node, output);
+        break;
+      }
+      for (int i = 0; success && i < 2; ++i) {
+        const math::SoaTransform* result =
+          EvaluateNode(inputs[i].node, NULL);
+        success = result != NULL;
+        BlendingJob::Layer& layer = layers[i];
+        layer.weight = inputs[i].weight;
+        layer.transform.begin = result;
+        layer.transform.end = result + num_soa_joints;
+        layer.joint_weights = inputs[i].joint_weights;
+      }
+      success = success && (node.type == kAdditive ?
+                              Blend(node, 1, 1, output) :
+                              Blend(node, 2, 0, output));
+      break;
+    }
+  }
+  scratch_top_ = scratch_top;
+
+  if (!success) {
+    return NULL;
+  }
+  if (node.cached) {
+    node.cached_stamp = modified;
+  }
+  ++num_computed_nodes_;
+  return output;
+}
+}  // animation
+}  // ozz
@@ -35,7 +35,10 @@
 #error "This header is private, it cannot be included from public headers."
 #endif  // OZZ_INCLUDE_PRIVATE_HEADER
 
+#include "ozz/base/platform.h"
+
 namespace ozz {
+namespace io { class IArchive; class OArchive; }
 namespace animation {
 
 // Define animation key frame types (translation, rotation, scale). Every type
@@ -44,46 +47,171 @@ namespace animation {
 // coherency.
 // Key frame values are compressed, according on their type. Decompression is
 // efficient because it's done on SoA data and cached during sampling.
+// Key frame times are stored as 16 bits unsigned integers, the ratio of the
+// key time to the animation duration: 0 for t = 0 and kMaxKeyTime for
+// t = duration. Sampling is done in these units, see ToKeyTime().
+
+// Defines the key time of a key at t = duration.
+const uint16_t kMaxKeyTime = 65535;
+
+// Converts _time in seconds to a key time, which isn't rounded or clamped, for
+// an animation of _duration seconds.
+inline float ToKeyTime(float _time, float _duration) {
+  return _time * (static_cast<float>(kMaxKeyTime) / _duration);
+}
 
 // Defines the translation key frame type.
-// Translation values are stored as half precision floats with 16 bits per
-// component.
+// Translation values are quantized on 16 bits unsigned integers per component,
+// normalized to the range of their track, see SoaTranslationRange. Contrary to
+// half precision floats, precision doesn't depend on the distance to the
+// origin but only on the track amplitude.
 struct TranslationKey {
-  float time;
+  uint16_t time;
   uint16_t track;
   uint16_t value[3];
 };
 
+// Defines the range of translation values of 4 consecutive tracks (a soa
+// track), stored in soa layout: the first index is the component (x, y, z) and
+// the second one the track. A quantized value q is decoded as min + q * scale,
+// where scale is the track extent divided by kMaxTranslationValue. scale is 0
+// for constant tracks, whose value is min.
+struct SoaTranslationRange {
+  float min[3][4];
+  float scale[3][4];
+};
+
+// Defines the quantized value of a translation that is at the maximum of its
+// track range.
+const uint16_t kMaxTranslationValue = 65535;
+
 // Defines the rotation key frame type.
-// Rotation value is a quaternion. Quaternion are normalized, which means each
-// component is in range [0:1]. This property allows to quantize the first 3
-// components to 3 signed integer 16 bits values. The 4th component is restored
-// at runtime, using the knowledge that |w| = √(1 - (x^2 + y^2 + z^2)). The sign
-// of this 4th component is stored using 1 bit taken from the track member.
-//
-// It's often recommended to store the 3 smallest components (and restore the
-// largest) as they can be pre-multiplied by √2 to gain some precision. As
-// decompression is done in SoA format, restoring a non-fixed component requires
-// too much code to reshuffle the SoaQuaternion. Furthermore 16 bits quantization
-// is already very precise, not worth a 1.4 factor.
-// Quantization could be reduced to 11-11-10 bits as often used for animation
-// key frames, but in this case RotationKey structure would contain 16 bits of
-// padding.
+// Rotation value is a quaternion. Quaternion are normalized, which means that
+// once its largest component is dropped, the 3 remaining ones ("smallest
+// three") are in range [-1/√2:1/√2]. They are pre-multiplied by √2 and
+// quantized to 3 signed integer 16 bits values, in x, y, z, w order. The index
+// of the dropped component is stored with 2 bits, and is restored at runtime
+// using the knowledge that |c| = √(1 - (a^2 + b^2 + d^2)). Precision is thus
+// uniform across all rotations, where restoring w would lose precision as |w|
+// is small. The sign of the dropped component is also stored, rather than
+// negating the quaternion, as the AnimationBuilder flips keys so that
+// consecutive keys of a track are interpolated along the shortest path. These
+// 3 bits are taken from the track member.
+// Components are restored in SoA format with a few selections that place the
+// dropped component back.
+// Key size could be reduced to 8 bytes with 12 bits components, but it would
+// give up 4 bits of precision which is more than what √2 saves.
 struct RotationKey {
-  float time;
-  uint16_t track:15;
-  bool wsign:1;
+  uint16_t time;
+  uint16_t track:13;
+  uint16_t largest:2;
+  uint16_t sign:1;
   int16_t value[3];
 };
 
+// Defines the factor applied to the smallest three components of a rotation
+// before they are quantized to RotationKey values.
+const float kRotationQuantizationScale = 1.41421356f * 32767.f;
+
 // Defines the scale key frame type.
 // Scale values are stored as half precision floats with 16 bits per
 // component.
 struct ScaleKey {
-  float time;
+  uint16_t time;
   uint16_t track;
   uint16_t value[3];
 };
+
+// Defines the tangent of a key frame, used by Hermite interpolated animations.
+// Tangents are the derivative of key values per animation duration, so that
+// they don't depend on key times quantization. They are stored as half
+// precision floats, in the same order as the keys they belong to. Translation
+// and scale tangents only use the 3 first components, rotation tangents are
+// the derivative of the x, y, z, w quaternion components.
+struct KeyTangent {
+  uint16_t value[4];
+};
+
+// Defines the key frame type of float tracks, see FloatTrack. Float values
+// aren't compressed, as float curves are usually much smaller than joint
+// tracks. Key time uses the same unit as animation keys, and curve is the
+// index of the curve the key belongs to.
+struct FloatKey {
+  uint16_t time;
+  uint16_t curve;
+  float value;
+};
+
+// Defines the layout of the seek index of an animation, whose entries store
+// the sampling cache state at a given key time. An entry starts with its key
+// time (an integer in key time unit), followed by translation, rotation and
+// scale streams states. A stream state is the key cursor, followed by the
+// left and right key indices of every track, soa padding tracks included.
+// Sampling cache can be restored from the closest entry, rather than fetching
+// keys from the beginning of the animation.
+
+// Gets the number of integers of a stream state.
+inline int SeekStreamSize(int _num_soa_tracks) {
+  return 1 + _num_soa_tracks * 4 * 2;
+}
+
+// Gets the number of integers of a seek index entry.
+inline int SeekEntrySize(int _num_soa_tracks) {
+  return 1 + SeekStreamSize(_num_soa_tracks) * 3;
+}
+
+// Defines the half precision float value of 1, which is the value of every
+// component of unit scale keys.
+const uint16_t kUnitScaleValue = 0x3c00;
+
+namespace internal {
+// Returns true if any of _keys isn't the unit scale, see Animation::scaled().
+bool HasScale(const ozz::Range<const ScaleKey>& _keys);
+
+// Returns true if all _keys are uniform scales, see
+// Animation::uniformly_scaled().
+bool HasUniformScale(const ozz::Range<const ScaleKey>& _keys);
+
+// Saves/loads key frames buffers, without their count. These functions
+// implement key frames archive format, shared by all the archives that store
+// animation key frames. Loading functions expect _keys range to be allocated.
+void SaveKeys(ozz::io::OArchive& _archive,
+              const ozz::Range<const TranslationKey>& _keys);
+void SaveKeys(ozz::io::OArchive& _archive,
+              const ozz::Range<const RotationKey>& _keys);
+void SaveKeys(ozz::io::OArchive& _archive,
+              const ozz::Range<const ScaleKey>& _keys);
+void LoadKeys(ozz::io::IArchive& _archive,
+              const ozz::Range<TranslationKey>& _keys);
+void LoadKeys(ozz::io::IArchive& _archive,
+              const ozz::Range<RotationKey>& _keys);
+void LoadKeys(ozz::io::IArchive& _archive,
+              const ozz::Range<ScaleKey>& _keys);
+
+// Saves/loads translation ranges buffers, without their count.
+void SaveRanges(ozz::io::OArchive& _archive,
+                const ozz::Range<const SoaTranslationRange>& _ranges);
+void LoadRanges(ozz::io::IArchive& _archive,
+                const ozz::Range<SoaTranslationRange>& _ranges);
+
+// Saves/loads key tangents buffers, without their count.
+void SaveTangents(ozz::io::OArchive& _archive,
+                  const ozz::Range<const KeyTangent>& _tangents);
+void LoadTangents(ozz::io::IArchive& _archive,
+                  const ozz::Range<KeyTangent>& _tangents);
+
+// Saves/loads seek index buffers, without their size.
+void SaveSeekIndex(ozz::io::OArchive& _archive,
+                   const ozz::Range<const int32_t>& _index);
+void LoadSeekIndex(ozz::io::IArchive& _archive,
+                   const ozz::Range<int32_t>& _index);
+
+// Saves/loads key links buffers, without their count.
+void SaveKeyLinks(ozz::io::OArchive& _archive,
+                  const ozz::Range<const uint16_t>& _links);
+void LoadKeyLinks(ozz::io::IArchive& _archive,
+                  const ozz::Range<uint16_t>& _links);
+}  // internal
 }  // animation
 }  // ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
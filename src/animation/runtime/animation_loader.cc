@@ -0,0 +1,123 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_loader.h"
+
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+AnimationLoader::AnimationLoader(Animation* _animation)
+    : animation_(_animation),
+      state_(kHeader),
+      offset_(0),
+      size_(Animation::blob_header_size()),
+      buffer_(NULL),
+      header_(NULL),
+      allocator_(Animation::buffer_allocator()),
+      blob_(NULL),
+      blob_size_(0) {
+  if (!animation_) {
+    Fail();
+    return;
+  }
+  // Empties the animation, it's mapped to the blob once loaded.
+  animation_->Destroy();
+  header_ = memory::default_allocator()->Allocate(
+    size_, Animation::kBlobAlignment);
+  buffer_ = header_;
+}
+
+AnimationLoader::~AnimationLoader() {
+  memory::default_allocator()->Deallocate(header_);
+  allocator_->Deallocate(blob_);
+}
+
+void AnimationLoader::Fail() {
+  state_ = kFailed;
+  offset_ = 0;
+  size_ = 0;
+  buffer_ = NULL;
+  allocator_->Deallocate(blob_);
+  blob_ = NULL;
+}
+
+bool AnimationLoader::Resume() {
+  switch (state_) {
+    case kHeader: {
+      const size_t header_size = Animation::blob_header_size();
+      blob_size_ = Animation::blob_size(header_, header_size);
+      if (blob_size_ == 0) {
+        Fail();
+        return false;
+      }
+
+      // Allocates the final buffer, which starts with the header already
+      // read. The body is then read in place.
+      blob_ = static_cast<char*>(
+        allocator_->Allocate(blob_size_, Animation::kBlobAlignment));
+      if (!blob_) {
+        Fail();
+        return false;
+      }
+      std::memcpy(blob_, header_, header_size);
+      state_ = kBody;
+      offset_ = header_size;
+      size_ = blob_size_ - header_size;
+      buffer_ = blob_ + header_size;
+      return true;
+    }
+    case kBody: {
+      if (!animation_->MapBlob(blob_, blob_size_)) {
+        Fail();
+        return false;
+      }
+      // Transfers blob ownership to the animation, which deallocates it with
+      // the allocator it was allocated with.
+      animation_->blob_ = blob_;
+      animation_->allocator_ = allocator_;
+      blob_ = NULL;
+      state_ = kLoaded;
+      offset_ = 0;
+      size_ = 0;
+      buffer_ = NULL;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+}  // animation
+}  // ozz
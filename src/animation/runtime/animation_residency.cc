@@ -0,0 +1,197 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_residency.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+namespace ozz {
+namespace animation {
+
+AnimationResidencyManager::AnimationResidencyManager(int _num_clips,
+                                                     size_t _budget,
+                                                     Loader* _loader)
+    : loader_(_loader),
+      num_clips_(_num_clips),
+      budget_(_budget),
+      resident_size_(0) {
+  assert(_loader && _num_clips >= 0);
+
+  clips_ = memory::default_allocator()->AllocateRange<Clip>(num_clips_);
+  candidates_ =
+    memory::default_allocator()->AllocateRange<Candidate>(num_clips_);
+  for (int i = 0; i < num_clips_; ++i) {
+    Clip& clip = clips_.begin[i];
+    clip.animation = NULL;
+    clip.size = 0;
+    clip.last_use = 0.f;
+    clip.low = false;
+    clip.low_variant = false;
+    clip.pending_high = false;
+    clip.pending_low = false;
+  }
+}
+
+AnimationResidencyManager::~AnimationResidencyManager() {
+  for (int i = 0; i < num_clips_; ++i) {
+    if (clips_.begin[i].animation) {
+      loader_->Unload(i, clips_.begin[i].animation);
+    }
+  }
+  memory::default_allocator()->Deallocate(candidates_);
+  memory::default_allocator()->Deallocate(clips_);
+}
+
+void AnimationResidencyManager::set_low_variant(int _clip, bool _available) {
+  assert(_clip >= 0 && _clip < num_clips_);
+  clips_.begin[_clip].low_variant = _available;
+}
+
+const Animation* AnimationResidencyManager::Use(int _clip, float _time) {
+  assert(_clip >= 0 && _clip < num_clips_);
+  Request(_clip, _time);
+  return clips_.begin[_clip].animation;
+}
+
+void AnimationResidencyManager::Prefetch(int _clip, float _time) {
+  assert(_clip >= 0 && _clip < num_clips_);
+  Request(_clip, _time);
+}
+
+void AnimationResidencyManager::Request(int _clip, float _time) {
+  Clip& clip = clips_.begin[_clip];
+  clip.last_use = _time;
+
+  // A downgrade that's still loading isn't needed anymore.
+  clip.pending_low = false;
+
+  // Upgrades low quality variant, keeping it resident until the full quality
+  // one is loaded.
+  if ((!clip.animation || clip.low) && !clip.pending_high) {
+    // Pending state is set before requesting, as the loader is allowed to
+    // call OnLoaded synchronously.
+    clip.pending_high = true;
+    loader_->Load(_clip, false);
+  }
+}
+
+void AnimationResidencyManager::Update(float _time) {
+  if (resident_size_ <= budget_) {
+    return;
+  }
+
+  // Lists resident clips that weren't used since _time.
+  int num_candidates = 0;
+  for (int i = 0; i < num_clips_; ++i) {
+    const Clip& clip = clips_.begin[i];
+    if (clip.animation && clip.last_use < _time) {
+      const Candidate candidate = {clip.last_use, i};
+      candidates_.begin[num_candidates++] = candidate;
+    }
+  }
+  std::sort(candidates_.begin, candidates_.begin + num_candidates);
+
+  // Downgrades or releases them from the least recently used.
+  for (int i = 0; i < num_candidates && resident_size_ > budget_; ++i) {
+    const int index = candidates_.begin[i].clip;
+    Clip& clip = clips_.begin[index];
+    const bool downgrade = clip.low_variant && !clip.low;
+
+    // Late arrivals of pending variants are rejected.
+    clip.pending_high = false;
+    clip.pending_low = false;
+
+    // Releases first, to lower memory peak, even if the clip is downgraded.
+    Release(index);
+    if (downgrade) {
+      clip.pending_low = true;
+      loader_->Load(index, true);
+    }
+  }
+}
+
+void AnimationResidencyManager::Release(int _clip) {
+  Clip& clip = clips_.begin[_clip];
+  assert(clip.animation && resident_size_ >= clip.size);
+  loader_->Unload(_clip, clip.animation);
+  resident_size_ -= clip.size;
+  clip.animation = NULL;
+  clip.size = 0;
+  clip.low = false;
+}
+
+bool AnimationResidencyManager::OnLoaded(int _clip,
+                                         bool _low,
+                                         Animation* _animation) {
+  if (_clip < 0 || _clip >= num_clips_ || !_animation) {
+    return false;
+  }
+  Clip& clip = clips_.begin[_clip];
+  bool& pending = _low ? clip.pending_low : clip.pending_high;
+  if (!pending) {
+    return false;
+  }
+  pending = false;
+
+  // Replaces the previously resident variant.
+  if (clip.animation) {
+    Release(_clip);
+  }
+  clip.animation = _animation;
+  clip.size = _animation->size();
+  clip.low = _low;
+  resident_size_ += clip.size;
+  return true;
+}
+
+const Animation* AnimationResidencyManager::animation(int _clip) const {
+  assert(_clip >= 0 && _clip < num_clips_);
+  return clips_.begin[_clip].animation;
+}
+
+bool AnimationResidencyManager::low_quality(int _clip) const {
+  assert(_clip >= 0 && _clip < num_clips_);
+  return clips_.begin[_clip].animation && clips_.begin[_clip].low;
+}
+
+int AnimationResidencyManager::num_resident_clips() const {
+  int count = 0;
+  for (int i = 0; i < num_clips_; ++i) {
+    count += clips_.begin[i].animation != NULL;
+  }
+  return count;
+}
+}  // animation
+}  // ozz
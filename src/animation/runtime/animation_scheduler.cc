@@ -0,0 +1,190 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_scheduler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Sorts characters from the most overdue to the least, relatively to their
+// interval. Ties are broken by shorter interval, then by index, so that
+// scheduling is deterministic.
+struct MoreOverdue {
+  MoreOverdue(const int* _intervals, const int* _ages)
+      : intervals(_intervals),
+        ages(_ages) {
+  }
+  bool operator()(int _a, int _b) const {
+    // Compares age_a / interval_a and age_b / interval_b without divisions.
+    const int64_t overdue_a = static_cast<int64_t>(ages[_a]) * intervals[_b];
+    const int64_t overdue_b = static_cast<int64_t>(ages[_b]) * intervals[_a];
+    if (overdue_a != overdue_b) {
+      return overdue_a > overdue_b;
+    }
+    if (intervals[_a] != intervals[_b]) {
+      return intervals[_a] < intervals[_b];
+    }
+    return _a < _b;
+  }
+  const int* intervals;
+  const int* ages;
+};
+}  // namespace
+
+const int AnimationScheduler::kMaxAge;
+
+AnimationScheduler::AnimationScheduler(int _capacity,
+                                       int _budget,
+                                       int _max_interval,
+                                       float _full_rate_size)
+    : capacity_(_capacity),
+      budget_(_budget),
+      max_interval_(_max_interval),
+      full_rate_size_(_full_rate_size),
+      buffer_(NULL),
+      intervals_(NULL),
+      ages_(NULL),
+      due_(NULL) {
+  assert(_capacity >= 0 && _budget >= 0 && _max_interval >= 1);
+
+  memory::ScopedTag tag(memory::kTagCache);
+  buffer_ = memory::default_allocator()->Allocate<int>(_capacity * 3);
+  intervals_ = buffer_;
+  ages_ = intervals_ + _capacity;
+  due_ = ages_ + _capacity;
+  for (int i = 0; i < _capacity; ++i) {
+    SetScreenSize(i, 0.f);
+    ages_[i] = kMaxAge;
+  }
+}
+
+AnimationScheduler::~AnimationScheduler() {
+  memory::default_allocator()->Deallocate(buffer_);
+}
+
+void AnimationScheduler::SetScreenSize(int _index, float _screen_size) {
+  assert(_index >= 0 && _index < capacity_);
+
+  // Interval grows inversely proportionally to screen size.
+  int interval = max_interval_;
+  if (_screen_size >= full_rate_size_) {
+    interval = 1;
+  } else if (_screen_size > 0.f) {
+    const float frames = std::ceil(full_rate_size_ / _screen_size);
+    if (frames < max_interval_) {
+      interval = static_cast<int>(frames);
+    }
+  }
+  intervals_[_index] = interval;
+}
+
+void AnimationScheduler::Invalidate(int _index) {
+  assert(_index >= 0 && _index < capacity_);
+  ages_[_index] = kMaxAge;
+}
+
+int AnimationScheduler::Schedule(Range<int> _updates) {
+  // Ages all characters, and collects the ones whose interval is elapsed.
+  int num_due = 0;
+  for (int i = 0; i < capacity_; ++i) {
+    if (ages_[i] < kMaxAge) {
+      ++ages_[i];
+    }
+    if (ages_[i] >= intervals_[i]) {
+      due_[num_due++] = i;
+    }
+  }
+
+  // Keeps the most overdue characters within budget and output size.
+  int num_updates = static_cast<int>(_updates.Count());
+  if (budget_ && budget_ < num_updates) {
+    num_updates = budget_;
+  }
+  if (num_due < num_updates) {
+    num_updates = num_due;
+  }
+  std::partial_sort(due_, due_ + num_updates, due_ + num_due,
+                    MoreOverdue(intervals_, ages_));
+
+  for (int i = 0; i < num_updates; ++i) {
+    const int index = due_[i];
+    _updates.begin[i] = index;
+    ages_[index] = 0;
+  }
+  return num_updates;
+}
+
+bool AnimationScheduler::Interpolate(Range<const math::Float4x4> _from,
+                                     Range<const math::Float4x4> _to,
+                                     float _ratio,
+                                     Range<math::Float4x4> _output) {
+  const size_t count = _from.Count();
+  if (_to.Count() != count || _output.Count() < count) {
+    return false;
+  }
+  const math::SimdFloat4 ratio = math::simd_float4::Load1(_ratio);
+  for (size_t i = 0; i < count; ++i) {
+    const math::Float4x4& from = _from.begin[i];
+    const math::Float4x4& to = _to.begin[i];
+    math::Float4x4& output = _output.begin[i];
+    output.cols[0] = math::Lerp(from.cols[0], to.cols[0], ratio);
+    output.cols[1] = math::Lerp(from.cols[1], to.cols[1], ratio);
+    output.cols[2] = math::Lerp(from.cols[2], to.cols[2], ratio);
+    output.cols[3] = math::Lerp(from.cols[3], to.cols[3], ratio);
+  }
+  return true;
+}
+
+int AnimationScheduler::interval(int _index) const {
+  assert(_index >= 0 && _index < capacity_);
+  return intervals_[_index];
+}
+
+int AnimationScheduler::age(int _index) const {
+  assert(_index >= 0 && _index < capacity_);
+  return ages_[_index];
+}
+
+float AnimationScheduler::ratio(int _index) const {
+  assert(_index >= 0 && _index < capacity_);
+  const int age = ages_[_index];
+  const int interval = intervals_[_index];
+  return age < interval ? static_cast<float>(age) / interval : 1.f;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,159 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_streamer.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+AnimationStreamer::AnimationStreamer(float _duration,
+                                     float _page_duration,
+                                     Loader* _loader)
+    : loader_(_loader),
+      duration_(_duration),
+      page_duration_(_page_duration),
+      num_pages_(0),
+      pages_ahead_(1),
+      pages_behind_(0) {
+  assert(_loader && _duration >= 0.f && _page_duration > 0.f);
+
+  // There's at least one page, even for a 0 duration animation.
+  const float num_pages = _duration / _page_duration;
+  num_pages_ = math::Max(1, static_cast<int>(num_pages));
+  if (num_pages_ < num_pages) {  // Last page is partial.
+    ++num_pages_;
+  }
+
+  pages_ = memory::default_allocator()->AllocateRange<Page>(num_pages_);
+  for (int i = 0; i < num_pages_; ++i) {
+    pages_.begin[i].animation = NULL;
+    pages_.begin[i].pending = false;
+  }
+}
+
+AnimationStreamer::~AnimationStreamer() {
+  for (int i = 0; i < num_pages_; ++i) {
+    if (pages_.begin[i].animation) {
+      loader_->Unload(i, pages_.begin[i].animation);
+    }
+  }
+  memory::default_allocator()->Deallocate(pages_);
+}
+
+int AnimationStreamer::page(float _time) const {
+  const float time = math::Clamp(0.f, _time, duration_);
+  const int page = static_cast<int>(time / page_duration_);
+  return math::Min(page, num_pages_ - 1);
+}
+
+float AnimationStreamer::page_begin(int _page) const {
+  assert(_page >= 0 && _page < num_pages_);
+  return math::Min(_page * page_duration_, duration_);
+}
+
+float AnimationStreamer::page_end(int _page) const {
+  assert(_page >= 0 && _page < num_pages_);
+  if (_page == num_pages_ - 1) {
+    return duration_;
+  }
+  return math::Min((_page + 1) * page_duration_, duration_);
+}
+
+void AnimationStreamer::set_pages_ahead(int _pages) {
+  pages_ahead_ = math::Max(0, _pages);
+}
+
+void AnimationStreamer::set_pages_behind(int _pages) {
+  pages_behind_ = math::Max(0, _pages);
+}
+
+void AnimationStreamer::Update(float _time) {
+  const int current = page(_time);
+  const int first = math::Max(0, current - pages_behind_);
+  const int last = math::Min(num_pages_ - 1, current + pages_ahead_);
+
+  // Releases pages out of the resident window first, to lower memory peak.
+  for (int i = 0; i < num_pages_; ++i) {
+    Page& page = pages_.begin[i];
+    if ((i < first || i > last) && page.animation) {
+      loader_->Unload(i, page.animation);
+      page.animation = NULL;
+    }
+  }
+
+  // Requests current page, then pages ahead in sampling order, then pages
+  // behind.
+  for (int i = current; i <= last; ++i) {
+    Request(i);
+  }
+  for (int i = current - 1; i >= first; --i) {
+    Request(i);
+  }
+}
+
+void AnimationStreamer::Request(int _page) {
+  Page& page = pages_.begin[_page];
+  if (!page.animation && !page.pending) {
+    // Pending state is set before requesting, as the loader is allowed to
+    // call OnLoaded synchronously.
+    page.pending = true;
+    loader_->Load(_page);
+  }
+}
+
+bool AnimationStreamer::OnLoaded(int _page, Animation* _animation) {
+  if (_page < 0 || _page >= num_pages_ || !_animation ||
+      !pages_.begin[_page].pending) {
+    return false;
+  }
+  Page& page = pages_.begin[_page];
+  page.pending = false;
+  page.animation = _animation;
+  return true;
+}
+
+const Animation* AnimationStreamer::animation(float _time) const {
+  return pages_.begin[page(_time)].animation;
+}
+
+int AnimationStreamer::num_resident_pages() const {
+  int count = 0;
+  for (int i = 0; i < num_pages_; ++i) {
+    count += pages_.begin[i].animation != NULL;
+  }
+  return count;
+}
+}  // animation
+}  // ozz
@@ -36,7 +36,14 @@
 #include "ozz/animation/runtime/skeleton.h"
 
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_dispatch.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/blending_pass.h"
 
 namespace ozz {
 namespace animation {
@@ -46,9 +53,62 @@ BlendingJob::Layer::Layer()
 }
 
 BlendingJob::BlendingJob()
-    : threshold(.1f) {
+    : threshold(.1f),
+      num_joints_lod(Skeleton::kMaxJoints),
+      fast_normalization(false),
+      scaled(true),
+      stats(NULL),
+      scratch_allocator(NULL) {
+  soa_range.begin = 0;
+  soa_range.end = Skeleton::kMaxSoAJoints;
+}
+
+BlendingJob::Stats::Stats()
+    : layers(0),
+      partial_layers(0),
+      additive_layers(0),
+      soa_joints(0),
+      bind_pose_joints(0) {
 }
 
+namespace {
+// Validates _layer buffers, which must contain at least _min_range soa joints.
+bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
+  bool valid = true;
+
+  // Tests transforms validity.
+  valid &= _layer.transform.begin != NULL;
+  valid &= _layer.transform.end >= _layer.transform.begin;
+  valid &= _layer.transform.end - _layer.transform.begin >= _min_range;
+
+  // Joint weights are optional.
+  if (_layer.joint_weights.begin != NULL) {
+    valid &= _layer.joint_weights.end >= _layer.joint_weights.begin;
+    valid &= _layer.joint_weights.end - _layer.joint_weights.begin >=
+             _min_range;
+  } else {
+    valid &= _layer.joint_weights.end == NULL;
+  }
+
+  // Soa ranges are optional, but must be sorted and within bind pose range.
+  if (_layer.soa_ranges.begin != NULL) {
+    valid &= _layer.soa_ranges.end >= _layer.soa_ranges.begin;
+    int previous_end = 0;
+    for (const BlendingJob::SoaRange* range = _layer.soa_ranges.begin;
+         range < _layer.soa_ranges.end;
+         ++range) {
+      valid &= range->begin >= previous_end;
+      valid &= range->end >= range->begin;
+      valid &= range->end <= _min_range;
+      previous_end = range->end;
+    }
+  } else {
+    valid &= _layer.soa_ranges.end == NULL;
+  }
+  return valid;
+}
+}  // namespace
+
 bool BlendingJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -58,6 +118,13 @@ bool BlendingJob::Validate() const {
   // Test for valid threshold).
   valid &= threshold > 0.f;
 
+  // Test for valid soa range, which is clamped to the bind pose size.
+  valid &= soa_range.begin >= 0;
+  valid &= soa_range.end >= soa_range.begin;
+
+  // Test for valid lod.
+  valid &= num_joints_lod >= 0;
+
   // Test for NULL begin pointers.
   valid &= layers.begin != NULL;
   valid &= bind_pose.begin != NULL;
@@ -77,18 +144,30 @@ bool BlendingJob::Validate() const {
   for (const Layer* layer = layers.begin;
        layers.begin && layer < layers.end;  // Handles NULL pointers.
        ++layer) {
-    // Tests transforms validity.
-    valid &= layer->transform.begin != NULL;
-    valid &= layer->transform.end >= layer->transform.begin;
-    valid &= layer->transform.end - layer->transform.begin >= min_range;
-
-    // Joint weights are optional.
-    if (layer->joint_weights.begin != NULL) {
-      valid &= layer->joint_weights.end >= layer->joint_weights.begin;
-      valid &= layer->joint_weights.end - layer->joint_weights.begin >= min_range;
-    } else {
-      valid &= layer->joint_weights.end == NULL;
+    valid &= ValidateLayer(*layer, min_range);
+  }
+
+  // Validates additive layers, which are optional.
+  if (additive_layers.begin != NULL) {
+    valid &= additive_layers.end >= additive_layers.begin;
+    for (const Layer* layer = additive_layers.begin;
+         layer < additive_layers.end;
+         ++layer) {
+      valid &= ValidateLayer(*layer, min_range);
+
+      // Additive layers don't support soa ranges.
+      valid &= layer->soa_ranges.begin == NULL;
     }
+  } else {
+    valid &= additive_layers.end == NULL;
+  }
+
+  // Bind pose flags are optional.
+  if (bind_pose_flags.begin != NULL) {
+    valid &= bind_pose_flags.end >= bind_pose_flags.begin;
+    valid &= bind_pose_flags.end - bind_pose_flags.begin >= min_range;
+  } else {
+    valid &= bind_pose_flags.end == NULL;
   }
 
   return valid;
@@ -96,55 +175,29 @@ bool BlendingJob::Validate() const {
 
 namespace {
 
-// Macro that defines the process of blending the 1st pass.
-#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out) { \
-  _out->translation = _in.translation * _simd_weight; \
-  _out->rotation = _in.rotation * _simd_weight; \
-  _out->scale = _in.scale * _simd_weight; \
-}
-
-// Macro that defines the process of blending any pass but the first.
-#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out) { \
-  /* Blends translation. */ \
-  _out->translation = _out->translation + _in.translation * _simd_weight; \
-  /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
-  /* the shortest path between the two.*/ \
-  const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x + \
-                               _out->rotation.y * _in.rotation.y + \
-                               _out->rotation.z * _in.rotation.z + \
-                               _out->rotation.w * _in.rotation.w; \
-  const math::SimdInt4 sign = math::Sign(dot); \
-  const math::SoaQuaternion rotation = {math::Xor(_in.rotation.x, sign), \
-                                        math::Xor(_in.rotation.y, sign), \
-                                        math::Xor(_in.rotation.z, sign), \
-                                        math::Xor(_in.rotation.w, sign)}; \
-  _out->rotation = _out->rotation + rotation * _simd_weight; \
-  /* Blends scales.*/ \
-  _out->scale = _out->scale + _in.scale * _simd_weight; \
-}
-
 // Defines parameters that are exchanged accross blending stages.
 struct ProcessArgs {
   ProcessArgs(const BlendingJob& _job)
     : job(_job),
       num_soa_joints(_job.bind_pose.end - _job.bind_pose.begin),
+      end(math::Min(math::Min(static_cast<size_t>(_job.soa_range.end),
+                              static_cast<size_t>(_job.num_joints_lod + 3) / 4),
+                    num_soa_joints)),
+      begin(math::Min(static_cast<size_t>(_job.soa_range.begin), end)),
       num_passes(0),
       num_partial_passes(0),
-      accumulated_weight(0.f) {
+      num_bind_pose_joints(0),
+      accumulated_weight(0.f),
+      scratch(_job.scratch_allocator ? _job.scratch_allocator
+                                     : memory::default_allocator()),
+      accumulated_weights(scratch->Allocate<math::SimdFloat4>(end - begin)) {
     // The range of all buffers has already been validated.
     assert(job.output.end >= job.output.begin + num_soa_joints);
-    assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
   }
 
-  // Allocates enough space to store a accumulated weights per-joint.
-  // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (16 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
-  // Note that this array is used with SoA data.
-  // This is the first argument in order to avoid wasting too much space with
-  // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+  ~ProcessArgs() {
+    scratch->Deallocate(accumulated_weights);
+  }
 
   // The job to process.
   const BlendingJob& job;
@@ -152,6 +205,11 @@ struct ProcessArgs {
   // The number of transforms to process as defind by the size of the bind pose.
   size_t num_soa_joints;
 
+  // The range [begin,end[ of soa joints processed, see BlendingJob::soa_range
+  // and BlendingJob::num_joints_lod.
+  size_t end;
+  size_t begin;
+
   // Number of processed blended passes (excluding passes with a weight <= 0.f),
   // including partial passes.
   int num_passes;
@@ -159,16 +217,108 @@ struct ProcessArgs {
   // Number of processed partial blending passes (aka with a weight per-joint).
   int num_partial_passes;
 
+  // Number of soa joints set to the bind pose without blending.
+  int num_bind_pose_joints;
+
   // The accumulated weight of all layers.
   float accumulated_weight;
 
+  // The allocator of accumulated_weights, see BlendingJob::scratch_allocator.
+  memory::Allocator* scratch;
+
+  // Accumulated weights of the processed soa joints, soa joint i being at
+  // index i - begin. They're initialized by the first pass processed, if any.
+  // The buffer is sized to the processed range rather than to
+  // Skeleton::kMaxSoAJoints, which would be too big for the stack.
+  math::SimdFloat4* accumulated_weights;
+
  private:
    // Disables assignment operators.
    ProcessArgs(const ProcessArgs&);
    void operator = (const ProcessArgs&);
 };
 
+// Clears accumulated weights of soa joints [_begin,_end[. This is used by the
+// first pass for the joints it doesn't blend. The output isn't cleared, so
+// it can keep the bind pose (see BlendingJob::bind_pose_flags): the next
+// pass that blends one of these joints overwrites it instead of accumulating.
+void ClearJoints(ProcessArgs* _args, size_t _begin, size_t _end) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  for (size_t i = _begin; i < _end; ++i) {
+    _args->accumulated_weights[i - _args->begin] = zero;
+  }
+}
+
+// Returns true if no pass has blended the soa joint _i, meaning its output
+// hasn't been written yet.
+OZZ_INLINE bool IsCleared(const ProcessArgs& _args, size_t _i) {
+  return math::AreAllFalse(
+    math::CmpGt(_args.accumulated_weights[_i - _args.begin],
+                math::simd_float4::zero()));
+}
+
+// Blends soa joints [_begin,_end[ of _layer to the output, with
+// _layer_weight. Scales are only blended if _Scaled. _Weighted is true if
+// _layer has per-joint weights. _First is true for the first blended pass.
+// Variants are selected once per layer range (see SelectBlendJoints), so that
+// inner loops don't branch on these parameters.
+template<bool _Scaled, bool _Weighted, bool _First>
+OZZ_SIMD_DISPATCH
+void BlendJoints(ProcessArgs* _args,
+                 const BlendingJob::Layer& _layer,
+                 math::SimdFloat4 _layer_weight,
+                 size_t _begin,
+                 size_t _end) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  for (size_t i = _begin; i < _end; ++i) {
+    const math::SoaTransform& src = _layer.transform.begin[i];
+    math::SoaTransform* dest = _args->job.output.begin + i;
+    math::SimdFloat4 weight = _layer_weight;
+    if (_Weighted) {
+      // Soa joints whose weights are all 0 are skipped, without reading
+      // their transforms. This allows layers to provide only the joints they
+      // use, for example sampled with a SamplingJob::soa_mask.
+      weight = weight * math::Max0(_layer.joint_weights.begin[i]);
+      if (math::AreAllFalse(math::CmpGt(weight, zero))) {
+        if (_First) {
+          ClearJoints(_args, i, i + 1);
+        }
+        continue;
+      }
+    }
+    math::SimdFloat4& accumulated_weight =
+      _args->accumulated_weights[i - _args->begin];
+    if (_First || IsCleared(*_args, i)) {
+      accumulated_weight = weight;
+      OZZ_BLEND_1ST_PASS(src, weight, _Scaled, dest);
+    } else {
+      accumulated_weight = accumulated_weight + weight;
+      OZZ_BLEND_N_PASS(src, weight, _Scaled, dest);
+    }
+  }
+}
+
+// Selects the BlendJoints variant matching _args job and _layer parameters.
+typedef void (*BlendJointsFct)(ProcessArgs*,
+                               const BlendingJob::Layer&,
+                               math::SimdFloat4,
+                               size_t,
+                               size_t);
+BlendJointsFct SelectBlendJoints(const ProcessArgs& _args,
+                                 const BlendingJob::Layer& _layer,
+                                 bool _first) {
+  static const BlendJointsFct kBlendJoints[2][2][2] = {
+    {{BlendJoints<false, false, false>, BlendJoints<false, false, true>},
+     {BlendJoints<false, true, false>, BlendJoints<false, true, true>}},
+    {{BlendJoints<true, false, false>, BlendJoints<true, false, true>},
+     {BlendJoints<true, true, false>, BlendJoints<true, true, true>}}};
+  return kBlendJoints[_args.job.scaled]
+                     [_layer.joint_weights.begin != NULL]
+                     [_first];
+}
+
 // Blends all layers of the job to its output.
+OZZ_SIMD_DISPATCH
 void BlendLayers(ProcessArgs* _args) {
   assert(_args);
 
@@ -184,7 +334,7 @@ void BlendLayers(ProcessArgs* _args) {
            (layer->joint_weights.end >=
             layer->joint_weights.begin + _args->num_soa_joints));
 
-    // Skip irrelevant layers.
+    // Culls irrelevant layers.
     if (layer->weight <= 0.f) {
       continue;
     }
@@ -192,64 +342,160 @@ void BlendLayers(ProcessArgs* _args) {
     // Accumulates global weights.
     _args->accumulated_weight += layer->weight;
     const math::SimdFloat4 layer_weight = math::simd_float4::Load1(layer->weight);
+    const bool first = _args->num_passes == 0;
+    const BlendJointsFct blend_joints =
+      SelectBlendJoints(*_args, *layer, first);
 
-    if (layer->joint_weights.begin) {
-      // This layer has per-joint weights.
+    if (layer->soa_ranges.begin) {
+      // Only the soa joints of the ranges are blended, the other ones have a
+      // weight of 0. The first pass clears the joints in between.
       ++_args->num_partial_passes;
-
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] = weight;
-          OZZ_BLEND_1ST_PASS(src, weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] =
-            _args->accumulated_weights[i] + weight;
-          OZZ_BLEND_N_PASS(src, weight, dest);
+      // Ranges are clipped to the processed soa joints.
+      size_t cleared = _args->begin;
+      for (const BlendingJob::SoaRange* range = layer->soa_ranges.begin;
+           range < layer->soa_ranges.end;
+           ++range) {
+        const size_t end =
+          math::Min(static_cast<size_t>(range->end), _args->end);
+        const size_t begin = math::Min(
+          math::Max(static_cast<size_t>(range->begin), _args->begin), end);
+        if (first) {
+          ClearJoints(_args, cleared, begin);
+          cleared = end;
         }
+        blend_joints(_args, *layer, layer_weight, begin, end);
+      }
+      if (first) {
+        ClearJoints(_args, cleared, _args->end);
       }
     } else {
-      // This is a full layer.
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] = layer_weight;
-          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] =
-            _args->accumulated_weights[i] + layer_weight;
-          OZZ_BLEND_N_PASS(src, layer_weight, dest);
-        }
+      if (layer->joint_weights.begin) {
+        ++_args->num_partial_passes;
       }
+      blend_joints(_args, *layer, layer_weight, _args->begin, _args->end);
     }
+
     // One more pass blended.
     ++_args->num_passes;
   }
 }
 
+// Macro that defines the process of adding an additive layer to a normalized
+// output. Rotation delta is interpolated from identity with a normalized lerp,
+// after fixing up its sign so that lerp takes the shortest path. _fast selects
+// the fast rotation normalization. Scale delta is only applied if _scaled.
+#define OZZ_ADD_PASS(_in, _simd_weight, _fast, _scaled, _out) { \
+  _out->translation = _out->translation + _in.translation * _simd_weight; \
+  const math::SimdFloat4 one = math::simd_float4::one(); \
+  const math::SimdInt4 sign = math::Sign(_in.rotation.w); \
+  const math::SoaQuaternion rotation = { \
+    math::Xor(_in.rotation.x, sign) * _simd_weight, \
+    math::Xor(_in.rotation.y, sign) * _simd_weight, \
+    math::Xor(_in.rotation.z, sign) * _simd_weight, \
+    (math::Xor(_in.rotation.w, sign) - one) * _simd_weight + one}; \
+  _out->rotation = _out->rotation * \
+    (_fast ? NormalizeFastEst(rotation) : NormalizeEst(rotation)); \
+  if (_scaled) { \
+    const math::SimdFloat4 one_minus_weight = one - _simd_weight; \
+    const math::SoaFloat3 scale = { \
+      _in.scale.x * _simd_weight + one_minus_weight, \
+      _in.scale.y * _simd_weight + one_minus_weight, \
+      _in.scale.z * _simd_weight + one_minus_weight}; \
+    _out->scale = _out->scale * scale; \
+  } \
+}
+
+// Adds additive layers to the soa joint _i of the output. Returns true if any
+// additive layer affects this soa joint.
+OZZ_INLINE bool Add(const ProcessArgs& _args, size_t _i) {
+  math::SoaTransform* dest = _args.job.output.begin + _i;
+  const bool fast = _args.job.fast_normalization;
+  const bool scaled = _args.job.scaled;
+  bool added = false;
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  for (const BlendingJob::Layer* layer = _args.job.additive_layers.begin;
+       layer < _args.job.additive_layers.end;
+       ++layer) {
+    // Skip irrelevant layers.
+    if (layer->weight <= 0.f) {
+      continue;
+    }
+    math::SimdFloat4 weight = math::simd_float4::Load1(layer->weight);
+    if (layer->joint_weights.begin) {
+      // Soa joints whose weights are all 0 aren't read, as for normal layers.
+      weight = weight * math::Max0(layer->joint_weights.begin[_i]);
+      if (math::AreAllFalse(math::CmpGt(weight, zero))) {
+        continue;
+      }
+    }
+    OZZ_ADD_PASS(layer->transform.begin[_i], weight, fast, scaled, dest);
+    added = true;
+  }
+  return added;
+}
+
+// Normalizes the soa joint _i of the output, then adds additive layers to it.
+// Output rotation length cannot be zero as opposed quaternions have been fixed
+// up during blending passes. Translations and scales are normalized by _ratio,
+// the inverse of the accumulated weight. Scales are set to unit scales if the
+// job isn't scaled.
+OZZ_INLINE void NormalizeAndAdd(const ProcessArgs& _args,
+                                size_t _i,
+                                math::SimdFloat4 _ratio) {
+  math::SoaTransform* dest = _args.job.output.begin + _i;
+  const bool fast = _args.job.fast_normalization;
+  dest->rotation =
+    fast ? NormalizeFastEst(dest->rotation) : NormalizeEst(dest->rotation);
+  dest->translation = dest->translation * _ratio;
+  const bool scaled = _args.job.scaled;
+  dest->scale = scaled ? dest->scale * _ratio : math::SoaFloat3::one();
+  Add(_args, _i);
+}
+
+// Sets the soa joint _i of the output to the bind pose, then adds additive
+// layers to it. This is used for soa joints that no layer affects, in which
+// case the weighted blending of the bind pose is an expensive copy. The copy
+// itself is skipped if the output already holds the bind pose, according to
+// bind pose flags. Flags are updated.
+OZZ_INLINE void SetBindPoseAndAdd(ProcessArgs* _args, size_t _i) {
+  bool* flag =
+    _args->job.bind_pose_flags.begin ? _args->job.bind_pose_flags.begin + _i
+                                     : NULL;
+  if (!flag || !*flag) {
+    math::SoaTransform* dest = _args->job.output.begin + _i;
+    *dest = _args->job.bind_pose.begin[_i];
+    if (!_args->job.scaled) {
+      dest->scale = math::SoaFloat3::one();
+    }
+  }
+  const bool added = Add(*_args, _i);
+  if (flag) {
+    *flag = !added;
+  }
+  ++_args->num_bind_pose_joints;
+}
+
+// Clears bind pose flags of soa joints [_begin,_end[, which are blended.
+void ClearBindPoseFlags(const ProcessArgs& _args, size_t _begin, size_t _end) {
+  if (_args.job.bind_pose_flags.begin) {
+    for (size_t i = _begin; i < _end; ++i) {
+      _args.job.bind_pose_flags.begin[i] = false;
+    }
+  }
+}
+
 // Blends bind pose to the output if accumulated weight is less than the
-// threshold value.
-void BlendBindPose(ProcessArgs* _args) {
+// threshold value, normalizes the output and adds additive layers. All these
+// stages are processed in a single pass over the output.
+OZZ_SIMD_DISPATCH
+void BlendBindPoseAndNormalize(ProcessArgs* _args) {
   assert(_args);
 
   // Asserts buffer sizes, which must never fail as it has been validated.
   assert(_args->job.bind_pose.end >=
          _args->job.bind_pose.begin + _args->num_soa_joints);
 
+  const bool scaled = _args->job.scaled;
   if (_args->num_partial_passes == 0) {
     // No partial blending pass detected, threshold can be tested globaly.
     const float bp_weight =
@@ -259,77 +505,69 @@ void BlendBindPose(ProcessArgs* _args) {
       const math::SimdFloat4 simd_bp_weight =
         math::simd_float4::Load1(bp_weight);
 
-      // Updates global accumulated weight, but not per-joint weight any more
-      // because normalization stage will be global also.
-      _args->accumulated_weight = _args->job.threshold;
+      // Normalization of a non-partial blending requires to apply the same
+      // division to all joints, whose accumulated weight is now the threshold.
+      const math::SimdFloat4 ratio =
+        math::simd_float4::Load1(1.f / _args->job.threshold);
       if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          OZZ_BLEND_1ST_PASS(src, simd_bp_weight, dest);
+        // No layer is blended, output is the bind pose.
+        for (size_t i = _args->begin; i < _args->end; ++i) {
+          SetBindPoseAndAdd(_args, i);
         }
       } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        ClearBindPoseFlags(*_args, _args->begin, _args->end);
+        for (size_t i = _args->begin; i < _args->end; ++i) {
           const math::SoaTransform& src = _args->job.bind_pose.begin[i];
           math::SoaTransform* dest = _args->job.output.begin + i;
-          OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
+          OZZ_BLEND_N_PASS(src, simd_bp_weight, scaled, dest);
+          NormalizeAndAdd(*_args, i, ratio);
         }
       }
+    } else {
+      ClearBindPoseFlags(*_args, _args->begin, _args->end);
+      const math::SimdFloat4 ratio =
+        math::simd_float4::Load1(1.f / _args->accumulated_weight);
+      for (size_t i = _args->begin; i < _args->end; ++i) {
+        NormalizeAndAdd(*_args, i, ratio);
+      }
     }
   } else {
     // Blending passes contain partial blending, threshold must be tested for
-    // each joint.
-    const math::SimdFloat4 threshold = 
+    // each joint, and normalization requires to compute the divider per-joint.
+    const math::SimdFloat4 threshold =
       math::simd_float4::Load1(_args->job.threshold);
+    const math::SimdFloat4 one = math::simd_float4::one();
 
     // There's been at least 1 pass as num_partial_passes != 0.
     assert(_args->num_passes != 0);
 
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+    for (size_t i = _args->begin; i < _args->end; ++i) {
+      // Soa joints that no layer blended are set to the bind pose, as their
+      // output hasn't been written.
+      if (IsCleared(*_args, i)) {
+        SetBindPoseAndAdd(_args, i);
+        continue;
+      }
+      if (_args->job.bind_pose_flags.begin) {
+        _args->job.bind_pose_flags.begin[i] = false;
+      }
       const math::SoaTransform& src = _args->job.bind_pose.begin[i];
       math::SoaTransform* dest = _args->job.output.begin + i;
+      const math::SimdFloat4 accumulated_weight =
+        _args->accumulated_weights[i - _args->begin];
       const math::SimdFloat4 bp_weight =
-        math::Max0(threshold - _args->accumulated_weights[i]);
-      _args->accumulated_weights[i] =
-        math::Max(threshold, _args->accumulated_weights[i]);
-      OZZ_BLEND_N_PASS(src, bp_weight, dest);
-    }
-  }
-}
-
-// Normalizes output rotations. Quaternion length cannot be zero as opposed
-// quaternions have been fixed up during blending passes.
-// Translations and scales are already normalized because weights were
-// pre-multiplied by the normalization ratio.
-void Normalize(ProcessArgs* _args) {
-  assert(_args);
-
-  if (_args->num_partial_passes == 0) {
-    // Normalization of a non-partial blending requires to apply the same
-    // division to all joints.
-    const math::SimdFloat4 ratio =
-      math::simd_float4::Load1(1.f / _args->accumulated_weight);
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      math::SoaTransform& dest = _args->job.output.begin[i];
-      dest.rotation = NormalizeEst(dest.rotation);
-      dest.translation = dest.translation * ratio;
-      dest.scale = dest.scale * ratio;
-    }
-  } else {
-    // Partial blending normalization requires to compute the divider per-joint.
-    const math::SimdFloat4 one = math::simd_float4::one();
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
-      math::SoaTransform& dest = _args->job.output.begin[i];
-      dest.rotation = NormalizeEst(dest.rotation);
-      dest.translation = dest.translation * ratio;
-      dest.scale = dest.scale * ratio;
+        math::Max0(threshold - accumulated_weight);
+      OZZ_BLEND_N_PASS(src, bp_weight, scaled, dest);
+      const math::SimdFloat4 ratio =
+        one / math::Max(threshold, accumulated_weight);
+      NormalizeAndAdd(*_args, i, ratio);
     }
   }
 }
 }  // namespace
 
 bool BlendingJob::Run() const {
+  OZZ_PROFILE_SCOPE("BlendingJob::Run");
   if (!Validate()) {
     return false;
   }
@@ -340,11 +578,23 @@ bool BlendingJob::Run() const {
   // Blends all layers to the job output buffers.
   BlendLayers(&process_args);
 
-  // Applies bind pose.
-  BlendBindPose(&process_args);
-
-  // Normalizes output.
-  Normalize(&process_args);
+  // Applies bind pose, normalizes output and adds additive layers.
+  BlendBindPoseAndNormalize(&process_args);
+
+#ifdef OZZ_HAS_STATS
+  if (stats) {
+    stats->layers += process_args.num_passes;
+    stats->partial_layers += process_args.num_partial_passes;
+    for (const Layer* layer = additive_layers.begin;
+         layer < additive_layers.end;
+         ++layer) {
+      stats->additive_layers += layer->weight > 0.f;
+    }
+    stats->soa_joints +=
+      static_cast<int>(process_args.end - process_args.begin);
+    stats->bind_pose_joints += process_args.num_bind_pose_joints;
+  }
+#endif  // OZZ_HAS_STATS
 
   return true;
 }
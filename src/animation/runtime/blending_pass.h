@@ -0,0 +1,76 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_RUNTIME_BLENDING_PASS_H_
+#define OZZ_ANIMATION_RUNTIME_BLENDING_PASS_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include "ozz/base/maths/soa_transform.h"
+
+// Defines the weighted accumulation passes shared by blending jobs (see
+// BlendingJob and SampleBlendJob). Accumulated transforms are normalized once
+// all passes are done.
+
+// Macro that defines the process of blending the 1st pass. Scales are only
+// blended if _scaled is true.
+#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _scaled, _out) { \
+  _out->translation = _in.translation * _simd_weight; \
+  _out->rotation = _in.rotation * _simd_weight; \
+  if (_scaled) { \
+    _out->scale = _in.scale * _simd_weight; \
+  } \
+}
+
+// Macro that defines the process of blending any pass but the first. Scales
+// are only blended if _scaled is true.
+#define OZZ_BLEND_N_PASS(_in, _simd_weight, _scaled, _out) { \
+  /* Blends translation. */ \
+  _out->translation = _out->translation + _in.translation * _simd_weight; \
+  /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
+  /* the shortest path between the two.*/ \
+  const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x + \
+                               _out->rotation.y * _in.rotation.y + \
+                               _out->rotation.z * _in.rotation.z + \
+                               _out->rotation.w * _in.rotation.w; \
+  const math::SimdInt4 sign = math::Sign(dot); \
+  const math::SoaQuaternion rotation = {math::Xor(_in.rotation.x, sign), \
+                                        math::Xor(_in.rotation.y, sign), \
+                                        math::Xor(_in.rotation.z, sign), \
+                                        math::Xor(_in.rotation.w, sign)}; \
+  _out->rotation = _out->rotation + rotation * _simd_weight; \
+  /* Blends scales.*/ \
+  if (_scaled) { \
+    _out->scale = _out->scale + _in.scale * _simd_weight; \
+  } \
+}
+#endif  // OZZ_ANIMATION_RUNTIME_BLENDING_PASS_H_
@@ -0,0 +1,243 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/character_pipeline.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else  // _WIN32
+#include <time.h>
+#endif  // _WIN32
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/tasks/task_dispatcher.h"
+
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Gets a monotonic time, in seconds.
+double Now() {
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+#else  // _WIN32
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif  // _WIN32
+}
+}  // namespace
+
+class CharacterPipeline::LocalToModelStage : public CharacterPipeline::Stage {
+ public:
+  explicit LocalToModelStage(const Skeleton& _skeleton)
+      : skeleton_(_skeleton) {
+  }
+
+  virtual bool Run(const Context& _context) const {
+    LocalToModelJob job;
+    job.skeleton = &skeleton_;
+    job.input = _context.locals;
+    job.output = _context.models;
+    return job.Run();
+  }
+
+ private:
+  const Skeleton& skeleton_;
+};
+
+class CharacterPipeline::ChunkTask : public tasks::Task {
+ public:
+  ChunkTask(CharacterPipeline* _pipeline, int _num_characters, int _num_chunks)
+      : pipeline_(_pipeline),
+        num_characters_(_num_characters),
+        num_chunks_(_num_chunks) {
+  }
+
+  virtual void Run(int _chunk) const {
+    CharacterPipeline& pipeline = *pipeline_;
+    const int num_stages = pipeline.num_stages_;
+    const int num_joints = pipeline.skeleton_.num_joints();
+    const int num_soa_joints = pipeline.skeleton_.num_soa_joints();
+    double* times = pipeline.chunk_times_ + _chunk * pipeline.max_stages_;
+    for (int i = 0; i < num_stages; ++i) {
+      times[i] = 0.;
+    }
+
+    Context context;
+    context.locals = Range<math::SoaTransform>(
+      pipeline.locals_ + _chunk * num_soa_joints, num_soa_joints);
+
+    bool success = true;
+    const int begin = num_characters_ * _chunk / num_chunks_;
+    const int end = num_characters_ * (_chunk + 1) / num_chunks_;
+    for (int c = begin; c < end; ++c) {
+      context.character = c;
+      context.models = Range<math::Float4x4>(
+        pipeline.models_ + c * num_joints, num_joints);
+      double time = Now();
+      for (int i = 0; i < num_stages; ++i) {
+        const bool stage_success = pipeline.stages_[i]->Run(context);
+        const double now = Now();
+        times[i] += now - time;
+        time = now;
+        if (!stage_success) {
+          success = false;
+          break;
+        }
+      }
+    }
+    pipeline.chunk_results_[_chunk] = success;
+  }
+
+ private:
+  CharacterPipeline* pipeline_;
+  int num_characters_;
+  int num_chunks_;
+};
+
+const int CharacterPipeline::kInvalidStage;
+
+CharacterPipeline::CharacterPipeline(const Skeleton& _skeleton,
+                                     int _max_characters,
+                                     int _max_stages,
+                                     int _max_chunks)
+    : skeleton_(_skeleton),
+      max_characters_(math::Max(_max_characters, 0)),
+      max_stages_(math::Max(_max_stages, 0)),
+      max_chunks_(math::Max(_max_chunks, 1)),
+      stages_(NULL),
+      names_(NULL),
+      num_stages_(0),
+      local_to_model_(NULL),
+      models_(NULL),
+      locals_(NULL),
+      chunk_times_(NULL),
+      stage_times_(NULL),
+      chunk_results_(NULL) {
+  memory::Allocator* allocator = memory::default_allocator();
+  stages_ = allocator->Allocate<const Stage*>(max_stages_);
+  names_ = allocator->Allocate<const char*>(max_stages_);
+  local_to_model_ = allocator->New<LocalToModelStage>(_skeleton);
+  models_ = allocator->Allocate<math::Float4x4>(
+    max_characters_ * _skeleton.num_joints());
+  locals_ = allocator->Allocate<math::SoaTransform>(
+    max_chunks_ * _skeleton.num_soa_joints());
+  chunk_times_ = allocator->Allocate<double>(max_chunks_ * max_stages_);
+  stage_times_ = allocator->Allocate<float>(max_stages_);
+  chunk_results_ = allocator->Allocate<bool>(max_chunks_);
+  for (int i = 0; i < max_characters_ * _skeleton.num_joints(); ++i) {
+    models_[i] = math::Float4x4::identity();
+  }
+}
+
+CharacterPipeline::~CharacterPipeline() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(stages_);
+  allocator->Deallocate(names_);
+  allocator->Delete(local_to_model_);
+  allocator->Deallocate(models_);
+  allocator->Deallocate(locals_);
+  allocator->Deallocate(chunk_times_);
+  allocator->Deallocate(stage_times_);
+  allocator->Deallocate(chunk_results_);
+}
+
+int CharacterPipeline::AddStage(const Stage* _stage, const char* _name) {
+  if (!_stage || num_stages_ >= max_stages_) {
+    return kInvalidStage;
+  }
+  stages_[num_stages_] = _stage;
+  names_[num_stages_] = _name;
+  stage_times_[num_stages_] = 0.f;
+  return num_stages_++;
+}
+
+int CharacterPipeline::AddLocalToModelStage() {
+  return AddStage(local_to_model_, "local_to_model");
+}
+
+bool CharacterPipeline::Run(int _num_characters,
+                            tasks::Dispatcher* _dispatcher) {
+  if (_num_characters < 0 || _num_characters > max_characters_) {
+    return false;
+  }
+
+  // Every chunk processes contiguous characters.
+  const int num_chunks = math::Max(math::Min(_num_characters, max_chunks_), 1);
+  const ChunkTask task(this, _num_characters, num_chunks);
+  tasks::Dispatcher* dispatcher =
+    _dispatcher ? _dispatcher : tasks::serial_dispatcher();
+  dispatcher->Dispatch(task, num_chunks);
+
+  // Gathers chunks results and timings.
+  bool success = true;
+  for (int i = 0; i < num_stages_; ++i) {
+    stage_times_[i] = 0.f;
+  }
+  for (int c = 0; c < num_chunks; ++c) {
+    success &= chunk_results_[c];
+    const double* times = chunk_times_ + c * max_stages_;
+    for (int i = 0; i < num_stages_; ++i) {
+      stage_times_[i] += static_cast<float>(times[i]);
+    }
+  }
+  return success;
+}
+
+Range<const math::Float4x4> CharacterPipeline::models(int _character) const {
+  assert(_character >= 0 && _character < max_characters_);
+  const int num_joints = skeleton_.num_joints();
+  return Range<const math::Float4x4>(models_ + _character * num_joints,
+                                     num_joints);
+}
+
+const char* CharacterPipeline::stage_name(int _stage) const {
+  assert(_stage >= 0 && _stage < num_stages_);
+  return names_[_stage];
+}
+
+float CharacterPipeline::stage_time(int _stage) const {
+  assert(_stage >= 0 && _stage < num_stages_);
+  return stage_times_[_stage];
+}
+}  // animation
+}  // ozz
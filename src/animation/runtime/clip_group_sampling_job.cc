@@ -0,0 +1,186 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/clip_group_sampling_job.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/blending_pass.h"
+
+namespace ozz {
+namespace animation {
+
+ClipGroupSamplingJob::ClipGroupSamplingJob()
+    : ratio(0.f),
+      group(NULL),
+      num_clips(0),
+      cache(NULL),
+      fast_normalization(false) {
+}
+
+bool ClipGroupSamplingJob::Validate() const {
+  // Group and cache are mandatory.
+  if (!group || !cache || num_clips < 1) {
+    return false;
+  }
+
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Clips are made of the same number of soa tracks.
+  const int num_soa_tracks = group->num_soa_tracks();
+  valid &= num_soa_tracks % num_clips == 0;
+  valid &= SamplingJob::IsCompatible(*group, *cache);
+
+  // Weights are optional, but there must be one per clip.
+  valid &= weights.end >= weights.begin;
+  const bool blend = weights.begin != weights.end;
+  if (blend) {
+    valid &= weights.begin != NULL;
+    valid &= weights.end - weights.begin == num_clips;
+    bool weighted = false;
+    for (const float* weight = weights.begin;
+         weights.begin && weight < weights.end;  // Handles NULL pointers.
+         ++weight) {
+      weighted |= *weight > 0.f;
+    }
+    valid &= weighted;
+  }
+
+  // Tests output range, implicitly tests output.end != NULL.
+  valid &= output.begin != NULL;
+  const ptrdiff_t min_range =
+    blend ? num_soa_tracks / num_clips : num_soa_tracks;
+  valid &= output.end - output.begin >= min_range;
+
+  return valid;
+}
+
+namespace {
+
+// Defines the number of soa joints processed by chunk. This is small enough
+// for all the samples of a chunk to remain in L1 cache.
+const int kChunkSize = 8;
+}  // namespace
+
+bool ClipGroupSamplingJob::Run() const {
+  OZZ_PROFILE_SCOPE("ClipGroupSamplingJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = group->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if group contains no joint.
+    return true;
+  }
+
+  // Outputs all clip poses, which is a plain sampling of the group.
+  if (weights.begin == weights.end) {
+    SamplingJob::Sample(*group, ratio, cache, NULL, num_soa_tracks,
+                        fast_normalization, output.begin);
+    return true;
+  }
+
+  // Normalizes weights.
+  float weight_sum = 0.f;
+  for (const float* weight = weights.begin; weight < weights.end; ++weight) {
+    weight_sum += math::Max(*weight, 0.f);
+  }
+  const float inv_weight_sum = 1.f / weight_sum;
+
+  // Masks out the soa tracks of clips that have no weight.
+  assert(num_soa_tracks <= Skeleton::kMaxSoAJoints);
+  const int num_clip_soa_tracks = num_soa_tracks / num_clips;
+  unsigned char mask[(Skeleton::kMaxSoAJoints + 7) / 8];
+  std::memset(mask, 0, sizeof(mask));
+  for (int i = 0; i < num_clips; ++i) {
+    if (weights.begin[i] > 0.f) {
+      const int begin = i * num_clip_soa_tracks;
+      for (int j = begin; j < begin + num_clip_soa_tracks; ++j) {
+        mask[j / 8] |= 1 << (j & 7);
+      }
+    }
+  }
+
+  // Steps the shared cursor once for all clips.
+  SamplingJob::Prepare(*group, ratio, mask, num_soa_tracks, cache);
+  const float key_time = SamplingJob::KeyTime(*group, ratio);
+
+  // Samples and blends chunk by chunk.
+  math::SoaTransform samples[kChunkSize];
+  for (int begin = 0; begin < num_clip_soa_tracks; begin += kChunkSize) {
+    const int end = math::Min(begin + kChunkSize, num_clip_soa_tracks);
+    math::SoaTransform* dest = output.begin + begin;
+    bool first = true;
+    for (int i = 0; i < num_clips; ++i) {
+      if (weights.begin[i] <= 0.f) {
+        continue;
+      }
+      const math::SimdFloat4 weight =
+        math::simd_float4::Load1(weights.begin[i] * inv_weight_sum);
+      const int offset = i * num_clip_soa_tracks;
+      SamplingJob::Interpolate(*group, *cache, key_time, offset + begin,
+                               offset + end, mask, fast_normalization,
+                               samples);
+      for (int j = 0; j < end - begin; ++j) {
+        math::SoaTransform* out = dest + j;
+        if (first) {
+          OZZ_BLEND_1ST_PASS(samples[j], weight, true, out);
+        } else {
+          OZZ_BLEND_N_PASS(samples[j], weight, true, out);
+        }
+      }
+      first = false;
+    }
+
+    // Weights are normalized, only rotations need to be normalized.
+    for (int j = 0; j < end - begin; ++j) {
+      math::SoaTransform* out = dest + j;
+      out->rotation = fast_normalization ? NormalizeFastEst(out->rotation) :
+                                           NormalizeEst(out->rotation);
+    }
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,162 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/compute_bounds_job.h"
+
+#include <limits>
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+ComputeBoundsJob::ComputeBoundsJob()
+    : clip_bound(NULL),
+      transform(NULL),
+      bound(NULL) {
+}
+
+bool ComputeBoundsJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL output pointer.
+  valid &= bound != NULL;
+
+  // Exactly one input must be set.
+  const bool has_models = models.begin != NULL;
+  valid &= has_models != (clip_bound != NULL);
+
+  // Tests ranges.
+  valid &= models.begin <= models.end;
+  valid &= models.begin != NULL || models.end == NULL;
+  if (radii.begin) {
+    valid &= radii.end - radii.begin >= models.end - models.begin;
+  } else {
+    valid &= radii.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+// Reduces the positions of _models, inflated by _radii if not NULL, to _min
+// and _max. Reduction uses 2 accumulators to break dependency chains.
+void ReducePositions(const Range<const math::Float4x4>& _models,
+                     const float* _radii, const math::Float4x4* _transform,
+                     math::SimdFloat4* _min, math::SimdFloat4* _max) {
+  math::SimdFloat4 min0 = *_min, min1 = *_min;
+  math::SimdFloat4 max0 = *_max, max1 = *_max;
+  const ptrdiff_t count = _models.end - _models.begin;
+  const math::Float4x4& transform =
+    _transform ? *_transform : math::Float4x4::identity();
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  ptrdiff_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    math::SimdFloat4 p0 = _models.begin[i].cols[3];
+    math::SimdFloat4 p1 = _models.begin[i + 1].cols[3];
+    if (_transform) {
+      p0 = TransformPoint(transform, p0);
+      p1 = TransformPoint(transform, p1);
+    }
+    const math::SimdFloat4 r0 =
+      _radii ? math::simd_float4::Load1(_radii[i]) : zero;
+    const math::SimdFloat4 r1 =
+      _radii ? math::simd_float4::Load1(_radii[i + 1]) : zero;
+    min0 = math::Min(min0, p0 - r0);
+    max0 = math::Max(max0, p0 + r0);
+    min1 = math::Min(min1, p1 - r1);
+    max1 = math::Max(max1, p1 + r1);
+  }
+  if (i < count) {  // Odd number of joints.
+    math::SimdFloat4 p = _models.begin[i].cols[3];
+    if (_transform) {
+      p = TransformPoint(transform, p);
+    }
+    const math::SimdFloat4 r =
+      _radii ? math::simd_float4::Load1(_radii[i]) : zero;
+    min0 = math::Min(min0, p - r);
+    max0 = math::Max(max0, p + r);
+  }
+  *_min = math::Min(min0, min1);
+  *_max = math::Max(max0, max1);
+}
+
+// Reduces the 8 corners of _box, transformed by _transform, to _min and _max.
+void ReduceCorners(const math::Box& _box, const math::Float4x4& _transform,
+                   math::SimdFloat4* _min, math::SimdFloat4* _max) {
+  const math::SimdFloat4 bmin = math::simd_float4::Load3PtrU(&_box.min.x);
+  const math::SimdFloat4 bmax = math::simd_float4::Load3PtrU(&_box.max.x);
+  for (int c = 0; c < 8; ++c) {
+    const math::SimdInt4 mask = math::simd_int4::Load(
+      (c & 1) != 0, (c & 2) != 0, (c & 4) != 0, false);
+    const math::SimdFloat4 corner =
+      TransformPoint(_transform, math::Select(mask, bmax, bmin));
+    *_min = math::Min(*_min, corner);
+    *_max = math::Max(*_max, corner);
+  }
+}
+}  // namespace
+
+bool ComputeBoundsJob::Run() const {
+  OZZ_PROFILE_SCOPE("ComputeBoundsJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  math::SimdFloat4 min =
+    math::simd_float4::Load1(std::numeric_limits<float>::max());
+  math::SimdFloat4 max = -min;
+
+  if (clip_bound) {
+    if (!clip_bound->is_valid()) {
+      *bound = math::Box();
+      return true;
+    }
+    if (!transform) {
+      *bound = *clip_bound;
+      return true;
+    }
+    ReduceCorners(*clip_bound, *transform, &min, &max);
+  } else {
+    ReducePositions(models, radii.begin, transform, &min, &max);
+  }
+
+  math::Store3PtrU(min, &bound->min.x);
+  math::Store3PtrU(max, &bound->max.x);
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,167 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/event_query_job.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+EventQueryJob::EventQueryJob()
+    : track(NULL),
+      cache(NULL),
+      from(0.f),
+      to(0.f),
+      loop(false),
+      events(NULL),
+      looped_events(NULL) {
+}
+
+bool EventQueryJob::Validate() const {
+  bool valid = true;
+  valid &= track != NULL;
+  valid &= events != NULL;
+  valid &= looped_events != NULL;
+  return valid;
+}
+
+namespace {
+// Compares event times, for binary searches.
+struct EventTimeLess {
+  bool operator()(const EventTrack::Event& _event, float _time) const {
+    return _event.time < _time;
+  }
+  bool operator()(float _time, const EventTrack::Event& _event) const {
+    return _time < _event.time;
+  }
+};
+
+// Returns the index of the first event of _events whose time isn't lower than
+// _time.
+int LowerBound(const Range<const EventTrack::Event>& _events, float _time) {
+  return static_cast<int>(
+    std::lower_bound(_events.begin, _events.end, _time, EventTimeLess()) -
+    _events.begin);
+}
+
+// Returns the index of the first event of _events whose time is greater than
+// _time.
+int UpperBound(const Range<const EventTrack::Event>& _events, float _time) {
+  return static_cast<int>(
+    std::upper_bound(_events.begin, _events.end, _time, EventTimeLess()) -
+    _events.begin);
+}
+
+// Returns the index of the first event after _begin whose time isn't lower
+// than _time, iterating fired events.
+int ScanForward(const Range<const EventTrack::Event>& _events, int _begin,
+                float _time) {
+  const int num_events = static_cast<int>(_events.Count());
+  int end = _begin;
+  while (end < num_events && _events.begin[end].time < _time) {
+    ++end;
+  }
+  return end;
+}
+}  // namespace
+
+bool EventQueryJob::Run() const {
+  OZZ_PROFILE_SCOPE("EventQueryJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const Range<const EventTrack::Event> all = track->events();
+  const int num_events = track->num_events();
+  const float duration = track->duration();
+  const float t0 = math::Clamp(0.f, from, duration);
+  const float t1 = math::Clamp(0.f, to, duration);
+
+  // Finds the first event that wasn't fired before t0 when playing forward,
+  // which cache spares the binary search of if queries are continuous.
+  int cursor;
+  if (cache && cache->track_ == track && cache->time_ == t0) {
+    cursor = cache->cursor_;
+  } else {
+    cursor = LowerBound(all, t0);
+  }
+  assert(cursor >= 0 && cursor <= num_events);
+
+  int begin = cursor, end = cursor;
+  int looped_end = 0;
+  if (t0 < t1) {  // Playing forward.
+    end = t1 == duration ? num_events : ScanForward(all, cursor, t1);
+    cursor = end;
+  } else if (t1 < t0 && loop) {  // Looping over the end.
+    end = num_events;
+    looped_end = ScanForward(all, 0, t1);
+    cursor = looped_end;
+  } else if (t1 < t0) {  // Playing backward.
+    begin = t1 == 0.f ? 0 : UpperBound(all, t1);
+    end = UpperBound(all, t0);
+    // Events at t1 weren't fired, so they will be if playing forward.
+    cursor = begin;
+    while (cursor > 0 && all.begin[cursor - 1].time >= t1) {
+      --cursor;
+    }
+  }
+
+  *events = Range<const EventTrack::Event>(all.begin + begin, all.begin + end);
+  *looped_events =
+    Range<const EventTrack::Event>(all.begin, all.begin + looped_end);
+
+  // Stores the cursor for the next query.
+  if (cache) {
+    cache->track_ = track;
+    cache->time_ = t1;
+    cache->cursor_ = cursor;
+  }
+
+  return true;
+}
+
+EventQueryCache::EventQueryCache()
+    : track_(NULL),
+      time_(0.f),
+      cursor_(0) {
+}
+
+void EventQueryCache::Invalidate() {
+  track_ = NULL;
+  time_ = 0.f;
+  cursor_ = 0;
+}
+}  // animation
+}  // ozz
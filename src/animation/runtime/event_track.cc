@@ -0,0 +1,93 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/event_track.h"
+
+#include <cassert>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+EventTrack::EventTrack()
+    : events_(NULL),
+      num_events_(0),
+      duration_(0.f) {
+}
+
+EventTrack::~EventTrack() {
+  Destroy();
+}
+
+void EventTrack::Allocate(int _num_events) {
+  assert(!events_);
+  num_events_ = _num_events;
+  events_ = memory::default_allocator()->Allocate<Event>(_num_events);
+}
+
+void EventTrack::Destroy() {
+  memory::default_allocator()->Deallocate(events_);
+  events_ = NULL;
+  num_events_ = 0;
+  duration_ = 0.f;
+}
+
+void EventTrack::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_events_);
+  for (int i = 0; i < num_events_; ++i) {
+    const Event& event = events_[i];
+    _archive << event.time;
+    _archive << event.id;
+  }
+}
+
+void EventTrack::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  (void)_version;
+
+  // Destroy track in case it was already used before.
+  Destroy();
+
+  memory::ScopedTag tag(memory::kTagAnimation);
+
+  _archive >> duration_;
+  int32_t num_events;
+  _archive >> num_events;
+  Allocate(num_events);
+  for (int i = 0; i < num_events_; ++i) {
+    Event& event = events_[i];
+    _archive >> event.time;
+    _archive >> event.id;
+  }
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,104 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/float_track.h"
+
+#include <cassert>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/memory/allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+
+FloatTrack::FloatTrack()
+    : num_curves_(0),
+      duration_(0.f) {
+}
+
+FloatTrack::~FloatTrack() {
+  Destroy();
+}
+
+void FloatTrack::Allocate(int _num_keys) {
+  assert(!keys_.begin);
+  keys_ = memory::default_allocator()->AllocateRange<FloatKey>(_num_keys);
+}
+
+void FloatTrack::Destroy() {
+  memory::default_allocator()->Deallocate(keys_);
+  keys_.begin = NULL;
+  keys_.end = NULL;
+  num_curves_ = 0;
+  duration_ = 0.f;
+}
+
+size_t FloatTrack::size() const {
+  return sizeof(*this) + keys_.Size();
+}
+
+void FloatTrack::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_curves_);
+  _archive << static_cast<int32_t>(keys_.Count());
+  for (const FloatKey* key = keys_.begin; key < keys_.end; ++key) {
+    _archive << key->time;
+    _archive << key->curve;
+    _archive << key->value;
+  }
+}
+
+void FloatTrack::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  (void)_version;
+
+  // Destroy track in case it was already used before.
+  Destroy();
+
+  memory::ScopedTag tag(memory::kTagAnimation);
+
+  _archive >> duration_;
+  int32_t num_curves;
+  _archive >> num_curves;
+  num_curves_ = num_curves;
+  int32_t num_keys;
+  _archive >> num_keys;
+  Allocate(num_keys);
+  for (FloatKey* key = keys_.begin; key < keys_.end; ++key) {
+    _archive >> key->time;
+    _archive >> key->curve;
+    _archive >> key->value;
+  }
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,279 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/float_track_sampling_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/animation/runtime/float_track.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+
+namespace internal {
+struct InterpSoaFloat {
+  math::SimdFloat4 time[2];
+  math::SimdFloat4 value[2];
+};
+}  // internal
+
+FloatTrackSamplingJob::FloatTrackSamplingJob()
+    : time(0.f),
+      track(NULL),
+      cache(NULL) {
+}
+
+bool FloatTrackSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!track || !cache) {
+    return false;
+  }
+  valid &= output.begin != NULL;
+
+  // Tests output range, implicitly tests output.end != NULL.
+  valid &= output.end - output.begin >= track->num_curves();
+
+  // Tests cache size.
+  valid &= cache->max_soa_curves_ >= track->num_soa_curves();
+
+  return valid;
+}
+
+namespace {
+// Flags all the _num_soa_curves soa entries as outdated.
+void OutdateAll(int _num_soa_curves, unsigned char* _outdated) {
+  const int num_outdated_flags = (_num_soa_curves + 7) / 8;
+  for (int i = 0; i < num_outdated_flags - 1; ++i) {
+    _outdated[i] = 0xff;
+  }
+  _outdated[num_outdated_flags - 1] =
+    0xff >> (num_outdated_flags * 8 - _num_soa_curves);
+}
+
+// Loops through the sorted key frames and updates the cache, the same way
+// SamplingJob does for animation keys. The cache is filled with the first 2
+// keys of every curve if _cursor is 0.
+void UpdateKeys(float _key_time, int _num_soa_curves,
+                ozz::Range<const FloatKey> _keys,
+                int* _cursor, int* _cache, unsigned char* _outdated) {
+  const int num_curves = _num_soa_curves * 4;
+  assert(_keys.begin + num_curves * 2 <= _keys.end);
+
+  const FloatKey* cursor = _keys.begin + *_cursor;
+  if (!*_cursor) {
+    // Initializes interpolated entries with the first 2 sets of key frames.
+    // The sorting algorithm ensures that the first 2 key frames of a curve
+    // are consecutive, and sorted by curve.
+    for (int i = 0; i < num_curves; ++i) {
+      const int base = _keys.begin[i].curve * 2;
+      _cache[base + 0] = i;
+      _cache[base + 1] = i + num_curves;
+    }
+    cursor = _keys.begin + num_curves * 2;  // New cursor position.
+
+    // All entries are outdated.
+    OutdateAll(_num_soa_curves, _outdated);
+  }
+
+  // Iterates while the cache is not updated with left and right keys required
+  // for interpolation at time _key_time, for all curves. Thanks to the
+  // keyframe sorting, the loop can end as soon as it finds a key greater than
+  // _key_time.
+  while (cursor < _keys.end &&
+         _keys.begin[_cache[cursor->curve * 2 + 1]].time <= _key_time) {
+    // Flag this soa entry as outdated.
+    _outdated[cursor->curve / 32] |= (1 << ((cursor->curve & 0x1f) / 4));
+    // Updates cache.
+    const int base = cursor->curve * 2;
+    _cache[base] = _cache[base + 1];
+    _cache[base + 1] = static_cast<int>(cursor - _keys.begin);
+    // Process next key.
+    ++cursor;
+  }
+  assert(cursor <= _keys.end);
+
+  // Updates cursor output.
+  *_cursor = static_cast<int>(cursor - _keys.begin);
+}
+
+// Decodes the 4 keys whose indices are _interp[0], [2], [4] and [6].
+void DecodeKeys(const FloatKey* _keys, const int* _interp,
+                math::SimdFloat4* _time, math::SimdFloat4* _value) {
+  const FloatKey& k0 = _keys[_interp[0]];
+  const FloatKey& k1 = _keys[_interp[2]];
+  const FloatKey& k2 = _keys[_interp[4]];
+  const FloatKey& k3 = _keys[_interp[6]];
+  *_time = math::simd_float4::FromInt(
+    math::simd_int4::Load(k0.time, k1.time, k2.time, k3.time));
+  *_value = math::simd_float4::Load(k0.value, k1.value, k2.value, k3.value);
+}
+
+// Decodes outdated soa entries, whose flags are reset.
+void UpdateSoaFloats(int _num_soa_curves, const FloatKey* _keys,
+                     const int* _interp, unsigned char* _outdated,
+                     internal::InterpSoaFloat* _soa_floats) {
+  const int num_outdated_flags = (_num_soa_curves + 7) / 8;
+  for (int j = 0; j < num_outdated_flags; ++j) {
+    unsigned char outdated = _outdated[j];
+    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    for (int i = j * 8; outdated; ++i, outdated >>= 1) {
+      if (!(outdated & 1)) {
+        continue;
+      }
+      const int base = i * 4 * 2;  // * soa size * 2 keys
+      DecodeKeys(_keys, _interp + base, &_soa_floats[i].time[0],
+                 &_soa_floats[i].value[0]);
+      DecodeKeys(_keys, _interp + base + 1, &_soa_floats[i].time[1],
+                 &_soa_floats[i].value[1]);
+    }
+  }
+}
+
+// Linearly interpolates all soa entries, writing the _num_curves first values
+// to _output.
+void Interpolates(float _key_time, int _num_curves,
+                  const internal::InterpSoaFloat* _soa_floats,
+                  float* _output) {
+  const math::SimdFloat4 key_time = math::simd_float4::Load1(_key_time);
+  const int num_soa_curves = (_num_curves + 3) / 4;
+  for (int i = 0; i < num_soa_curves; ++i) {
+    const internal::InterpSoaFloat& soa = _soa_floats[i];
+    // Left and right key times are never equal, as keys that fall in the same
+    // key time unit are merged by the builder.
+    const math::SimdFloat4 alpha =
+      (key_time - soa.time[0]) / (soa.time[1] - soa.time[0]);
+    const math::SimdFloat4 value =
+      math::Lerp(soa.value[0], soa.value[1], alpha);
+    if (i * 4 + 4 <= _num_curves) {
+      math::StorePtrU(value, _output + i * 4);
+    } else {  // Last soa entry is partially output.
+      float values[4];
+      math::StorePtrU(value, values);
+      for (int j = 0; j < _num_curves - i * 4; ++j) {
+        _output[i * 4 + j] = values[j];
+      }
+    }
+  }
+}
+}  // namespace
+
+bool FloatTrackSamplingJob::Run() const {
+  OZZ_PROFILE_SCOPE("FloatTrackSamplingJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+  const int num_soa_curves = track->num_soa_curves();
+  if (num_soa_curves == 0) {  // Early out if track has no curve.
+    return true;
+  }
+
+  // Clamps time in range [0,duration], in key time unit.
+  const float duration = track->duration();
+  const float key_time =
+    ToKeyTime(math::Clamp(0.f, time, duration), duration);
+
+  // Rewinds cache if required.
+  cache->Step(*track, key_time);
+
+  // Fetches keys and decodes outdated soa entries.
+  UpdateKeys(key_time, num_soa_curves, track->keys(),
+             &cache->cursor_, cache->keys_, cache->outdated_);
+  UpdateSoaFloats(num_soa_curves, track->keys().begin, cache->keys_,
+                  cache->outdated_, cache->soa_floats_);
+
+  // Interpolates soa hot data.
+  Interpolates(key_time, track->num_curves(), cache->soa_floats_,
+               output.begin);
+
+  return true;
+}
+
+FloatTrackSamplingCache::FloatTrackSamplingCache(int _max_curves)
+    : track_(NULL),
+      time_(0.f),
+      max_soa_curves_((_max_curves + 3) / 4),
+      cursor_(0) {
+  // Allocate all cache data at once in a single allocation.
+  // Alignment is guaranteed because memory is dispatch from the highest
+  // alignment requirement (Soa data: SimdFloat4) to the lowest (outdated
+  // flag: unsigned char).
+  const size_t max_curves = max_soa_curves_ * 4;
+  const size_t num_outdated = (max_soa_curves_ + 7) / 8;
+  const size_t size =
+    sizeof(internal::InterpSoaFloat) * max_soa_curves_ +
+    sizeof(int) * max_curves * 2 +
+    sizeof(unsigned char) * num_outdated;
+
+  memory::ScopedTag tag(memory::kTagCache);
+  char* alloc_cursor = reinterpret_cast<char*>(
+    memory::default_allocator()->Allocate(
+      size, AlignOf<internal::InterpSoaFloat>::value));
+
+  soa_floats_ = reinterpret_cast<internal::InterpSoaFloat*>(alloc_cursor);
+  alloc_cursor += sizeof(internal::InterpSoaFloat) * max_soa_curves_;
+  keys_ = reinterpret_cast<int*>(alloc_cursor);
+  alloc_cursor += sizeof(int) * max_curves * 2;
+  outdated_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+}
+
+FloatTrackSamplingCache::~FloatTrackSamplingCache() {
+  // Deallocates everything at once.
+  memory::default_allocator()->Deallocate(soa_floats_);
+}
+
+void FloatTrackSamplingCache::Step(const FloatTrack& _track,
+                                   float _key_time) {
+  if (track_ != &_track || _key_time < time_) {
+    track_ = &_track;
+    cursor_ = 0;
+  }
+  time_ = _key_time;
+}
+
+void FloatTrackSamplingCache::Invalidate() {
+  track_ = NULL;
+  time_ = 0.f;
+  cursor_ = 0;
+}
+}  // animation
+}  // ozz
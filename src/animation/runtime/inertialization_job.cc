@@ -0,0 +1,271 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/inertialization_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+InertializationSetupJob::InertializationSetupJob()
+    : delta_time(0.f),
+      duration(.2f) {
+}
+
+bool InertializationSetupJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  valid &= delta_time > 0.f;
+  valid &= duration > 0.f;
+
+  // Test for NULL begin pointers.
+  valid &= previous.begin != NULL;
+  valid &= current.begin != NULL;
+  valid &= target.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= previous.end >= previous.begin;
+  valid &= current.end >= current.begin;
+  valid &= target.end >= target.begin;
+  valid &= output.end >= output.begin;
+
+  // The current pose defines the number of soa joints to process.
+  const ptrdiff_t min_range = current.end - current.begin;
+  valid &= previous.end - previous.begin >= min_range;
+  valid &= target.end - target.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  return valid;
+}
+
+namespace {
+// Setups the decay of offset _x, whose velocity is _v, over _duration.
+// Velocity that moves the offset away from zero would overshoot and is thus
+// ignored. Otherwise duration is shortened so that the offset doesn't
+// overshoot zero (polynomial root), which is the case with durations up to
+// -5 * x / v.
+void SetupDecay(math::SimdFloat4 _x,
+                math::SimdFloat4 _v,
+                math::SimdFloat4 _duration,
+                math::SimdFloat4* _value,
+                math::SimdFloat4* _velocity,
+                math::SimdFloat4* _inv_duration) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+
+  // Decays positive offsets, sign is restored once decay is computed.
+  const math::SimdInt4 sign = math::Sign(_x);
+  const math::SimdFloat4 x = math::Xor(_x, sign);
+  const math::SimdFloat4 v = math::Xor(_v, sign);
+
+  const math::SimdInt4 approaching =
+    math::And(math::CmpGt(x, zero), math::CmpLt(v, zero));
+  const math::SimdFloat4 velocity = math::Select(approaching, v, zero);
+  const math::SimdFloat4 divider = math::Select(approaching, v, -one);
+  const math::SimdFloat4 duration = math::Select(
+    approaching,
+    math::Min(_duration, x * math::simd_float4::Load1(-5.f) / divider),
+    _duration);
+
+  *_value = _x;
+  *_velocity = math::Xor(velocity * duration, sign);
+  *_inv_duration = one / duration;
+}
+
+// Setups the decay of SoaFloat3 offset _x, whose velocity is _v.
+void SetupDecay3(const math::SoaFloat3& _x,
+                 const math::SoaFloat3& _v,
+                 math::SimdFloat4 _duration,
+                 SoaInertializationOffset::Decay* _decay) {
+  SetupDecay(_x.x, _v.x, _duration,
+             &_decay->value.x, &_decay->velocity.x, &_decay->inv_duration.x);
+  SetupDecay(_x.y, _v.y, _duration,
+             &_decay->value.y, &_decay->velocity.y, &_decay->inv_duration.y);
+  SetupDecay(_x.z, _v.z, _duration,
+             &_decay->value.z, &_decay->velocity.z, &_decay->inv_duration.z);
+}
+
+// Returns the rotation offset from _target to _source, whose w is positive.
+math::SoaQuaternion RotationOffset(const math::SoaQuaternion& _source,
+                                   const math::SoaQuaternion& _target) {
+  const math::SoaQuaternion offset = _source * Conjugate(_target);
+  const math::SimdInt4 sign = math::Sign(offset.w);
+  const math::SoaQuaternion r = {math::Xor(offset.x, sign),
+                                 math::Xor(offset.y, sign),
+                                 math::Xor(offset.z, sign),
+                                 math::Xor(offset.w, sign)};
+  return r;
+}
+}  // namespace
+
+bool InertializationSetupJob::Run() const {
+  OZZ_PROFILE_SCOPE("InertializationSetupJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 simd_duration = math::simd_float4::Load1(duration);
+  const math::SimdFloat4 inv_dt = math::simd_float4::Load1(1.f / delta_time);
+  const ptrdiff_t num_soa_joints = current.end - current.begin;
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    const math::SoaTransform& prev = previous.begin[i];
+    const math::SoaTransform& cur = current.begin[i];
+    const math::SoaTransform& tgt = target.begin[i];
+    SoaInertializationOffset* offset = output.begin + i;
+
+    // Translation and scale offsets are differences to the target.
+    SetupDecay3(cur.translation - tgt.translation,
+                (cur.translation - prev.translation) * inv_dt,
+                simd_duration, &offset->translation);
+    SetupDecay3(cur.scale - tgt.scale,
+                (cur.scale - prev.scale) * inv_dt,
+                simd_duration, &offset->scale);
+
+    // Rotation offsets are quaternions from target to the source, whose vector
+    // part is decayed. Previous offset is on the same hemisphere as current
+    // one in order to compute velocity on the shortest path.
+    const math::SoaQuaternion cur_offset =
+      RotationOffset(cur.rotation, tgt.rotation);
+    const math::SoaQuaternion prev_offset =
+      prev.rotation * Conjugate(tgt.rotation);
+    const math::SimdInt4 hemisphere = math::Sign(
+      cur_offset.x * prev_offset.x + cur_offset.y * prev_offset.y +
+      cur_offset.z * prev_offset.z + cur_offset.w * prev_offset.w);
+    const math::SoaFloat3 cur_vector = {
+      cur_offset.x, cur_offset.y, cur_offset.z};
+    const math::SoaFloat3 prev_vector = {
+      math::Xor(prev_offset.x, hemisphere),
+      math::Xor(prev_offset.y, hemisphere),
+      math::Xor(prev_offset.z, hemisphere)};
+    SetupDecay3(cur_vector, (cur_vector - prev_vector) * inv_dt,
+                simd_duration, &offset->rotation);
+  }
+
+  return true;
+}
+
+InertializationJob::InertializationJob()
+    : time(0.f) {
+}
+
+bool InertializationJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  valid &= offsets.begin != NULL;
+  valid &= input.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= offsets.end >= offsets.begin;
+  valid &= input.end >= input.begin;
+  valid &= output.end >= output.begin;
+
+  // The offsets define the number of soa joints to process.
+  const ptrdiff_t min_range = offsets.end - offsets.begin;
+  valid &= input.end - input.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  return valid;
+}
+
+namespace {
+// Evaluates the decay of an offset at _time, using polynomials of the
+// normalized time u:
+// x(u) = x0 * (1 - 10u^2 + 20u^3 - 15u^4 + 4u^5) + v0 * u * (1 - u)^4
+// Both polynomials are 0 for u = 1, which is the end of the decay.
+OZZ_INLINE math::SimdFloat4 Decay(math::SimdFloat4 _value,
+                                  math::SimdFloat4 _velocity,
+                                  math::SimdFloat4 _inv_duration,
+                                  math::SimdFloat4 _time) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 u = math::Min(_time * _inv_duration, one);
+  const math::SimdFloat4 value_poly =
+    one + u * u * (math::simd_float4::Load1(-10.f) +
+                   u * (math::simd_float4::Load1(20.f) +
+                        u * (math::simd_float4::Load1(-15.f) +
+                             u * math::simd_float4::Load1(4.f))));
+  const math::SimdFloat4 one_minus_u = one - u;
+  const math::SimdFloat4 one_minus_u2 = one_minus_u * one_minus_u;
+  const math::SimdFloat4 velocity_poly = u * one_minus_u2 * one_minus_u2;
+  return _value * value_poly + _velocity * velocity_poly;
+}
+
+// Evaluates SoaFloat3 _decay at _time.
+OZZ_INLINE math::SoaFloat3 Decay3(const SoaInertializationOffset::Decay& _decay,
+                                  math::SimdFloat4 _time) {
+  const math::SoaFloat3 r = {
+    Decay(_decay.value.x, _decay.velocity.x, _decay.inv_duration.x, _time),
+    Decay(_decay.value.y, _decay.velocity.y, _decay.inv_duration.y, _time),
+    Decay(_decay.value.z, _decay.velocity.z, _decay.inv_duration.z, _time)};
+  return r;
+}
+}  // namespace
+
+bool InertializationJob::Run() const {
+  OZZ_PROFILE_SCOPE("InertializationJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 simd_time = math::simd_float4::Load1(
+    time > 0.f ? time : 0.f);
+  const ptrdiff_t num_soa_joints = offsets.end - offsets.begin;
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    const SoaInertializationOffset& offset = offsets.begin[i];
+    const math::SoaTransform& in = input.begin[i];
+    math::SoaTransform* out = output.begin + i;
+
+    out->translation = in.translation + Decay3(offset.translation, simd_time);
+    out->scale = in.scale + Decay3(offset.scale, simd_time);
+
+    // Rebuilds the unit rotation offset from its decayed vector part. Vector
+    // part length never increases while decaying, as components don't
+    // overshoot zero.
+    const math::SoaFloat3 vector = Decay3(offset.rotation, simd_time);
+    const math::SoaQuaternion rotation = {
+      vector.x, vector.y, vector.z,
+      math::Sqrt(math::Max0(one - Dot(vector, vector)))};
+    out->rotation = rotation * in.rotation;
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -35,13 +35,37 @@
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_dispatch.h"
+#include "ozz/base/maths/simd_float4x3.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
 
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/local_to_model_pass.h"
 
 namespace ozz {
 namespace animation {
 
+LocalToModelJob::LocalToModelJob()
+    : skeleton(NULL),
+      from(Skeleton::kNoParentIndex),
+      to(Skeleton::kMaxJoints),
+      num_joints_lod(Skeleton::kMaxJoints),
+      scaled(true),
+      stats(NULL),
+      scratch_allocator(NULL) {
+}
+
+LocalToModelJob::Stats::Stats()
+    : joints(0),
+      soa_conversions(0),
+      partial_runs(0) {
+}
+
 bool LocalToModelJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -53,71 +77,450 @@ bool LocalToModelJob::Validate() const {
     return false;
   }
   valid &= input.begin != NULL;
-  valid &= output.begin != NULL;
+
+  // Exactly one of the output ranges must be specified.
+  valid &= (output.begin != NULL) != (output_4x3.begin != NULL);
 
   const int num_joints = skeleton->num_joints();
   const int num_soa_joints = (num_joints + 3) / 4;
 
   // Test input and output ranges, implicitly tests for NULL end pointers.
   valid &= input.end - input.begin >= num_soa_joints;
-  valid &= output.end - output.begin >= num_joints;
+  if (output.begin != NULL) {
+    valid &= output.end - output.begin >= num_joints;
+  } else {
+    valid &= output_4x3.end - output_4x3.begin >= num_joints;
+  }
+
+  // Tests partial update parameters.
+  valid &= from == Skeleton::kNoParentIndex || (from >= 0 && from < num_joints);
+  valid &= num_joints_lod >= 0;
+  if (dirty.begin != NULL) {
+    valid &= dirty.end - dirty.begin >= (num_joints + 31) / 32;
+  } else {
+    valid &= dirty.end == NULL;
+  }
+  if (changed.begin != NULL) {
+    valid &= changed.end - changed.begin >= (num_soa_joints + 7) / 8;
+  } else {
+    valid &= changed.end == NULL;
+  }
 
   return valid;
 }
 
-bool LocalToModelJob::Run() const {
+namespace {
+// Implements partial hierarchy update, when only from's subtree and/or dirty
+// joints should be updated. Soa to aos conversions are done lazily, as soon as
+// a joint of a soa element needs it.
+template <typename _Matrix>
+OZZ_SIMD_DISPATCH
+void RunPartial(const LocalToModelJob& _job, _Matrix* _model_matrices) {
   using math::SoaTransform;
-  using math::SoaFloat4x4;
-  using math::Float4x4;
 
-  if (!Validate()) {
-    return false;
+  const int num_joints =
+    math::Min(_job.skeleton->num_joints(), _job.num_joints_lod);
+  Range<const Skeleton::JointProperties> properties =
+    _job.skeleton->joint_properties();
+  const _Matrix identity = _Matrix::identity();
+
+  const bool whole = _job.from == Skeleton::kNoParentIndex;
+  const int begin = whole ? 0 : _job.from;
+  const int end = math::Min(_job.to + 1, num_joints);
+
+  // Stores per-joint states, used by children to know if they belong to from's
+  // hierarchy, and if their parent was updated. States are only stored for
+  // joints of range [begin,end[, joint i being at index i - begin.
+  enum {
+    kInHierarchy = 1 << 0,
+    kUpdated = 1 << 1,
+  };
+  memory::Allocator* scratch = _job.scratch_allocator ?
+    _job.scratch_allocator : memory::default_allocator();
+  uint8_t* states = scratch->Allocate<uint8_t>(math::Max(end - begin, 0));
+
+  _Matrix local_aos_matrices[4];
+  int cached_soa = -1;
+#ifdef OZZ_HAS_STATS
+  int joints = 0;
+  int soa_conversions = 0;
+#endif  // OZZ_HAS_STATS
+  for (int joint = begin; joint < end; ++joint) {
+    const int parent = properties.begin[joint].parent;
+
+    // Joints before begin are never part of the hierarchy.
+    const uint8_t parent_state =
+      (parent != Skeleton::kNoParentIndex && parent >= begin) ?
+        states[parent - begin] : 0;
+
+    // Tests if joint is in from's hierarchy.
+    if (!whole && joint != begin && !(parent_state & kInHierarchy)) {
+      states[joint - begin] = 0;
+      continue;
+    }
+
+    // Tests if joint, or one of its ancestors, is dirty. Joint is dirty if
+    // it's set in any of the specified dirty and changed masks.
+    const int soa = joint / 4;
+    const bool is_dirty =
+      (!_job.dirty.begin && !_job.changed.begin) ||
+      (_job.dirty.begin &&
+       (_job.dirty.begin[joint / 32] & (1u << (joint & 31))) != 0) ||
+      (_job.changed.begin &&
+       (_job.changed.begin[soa / 8] & (1 << (soa & 7))) != 0);
+    if (!is_dirty && !(parent_state & kUpdated)) {
+      states[joint - begin] = kInHierarchy;
+      continue;
+    }
+    states[joint - begin] = kInHierarchy | kUpdated;
+
+    // Converts joint soa element if not already done.
+    if (soa != cached_soa) {
+      internal::ToAosMatrices(_job.input.begin[soa], _job.scaled,
+                              local_aos_matrices);
+      cached_soa = soa;
+#ifdef OZZ_HAS_STATS
+      ++soa_conversions;
+#endif  // OZZ_HAS_STATS
+    }
+#ifdef OZZ_HAS_STATS
+    ++joints;
+#endif  // OZZ_HAS_STATS
+
+    const _Matrix* parent_matrix =
+      math::Select(parent == Skeleton::kNoParentIndex,
+                   &identity,
+                   &_model_matrices[parent]);
+    _model_matrices[joint] = (*parent_matrix) * local_aos_matrices[joint & 3];
   }
+  scratch->Deallocate(states);
 
-  // Early out if no joint.
-  const int num_joints = skeleton->num_joints();
-  if (num_joints == 0) {
-    return true;
+#ifdef OZZ_HAS_STATS
+  if (_job.stats) {
+    _job.stats->joints += joints;
+    _job.stats->soa_conversions += soa_conversions;
+    _job.stats->partial_runs++;
   }
+#endif  // OZZ_HAS_STATS
+}
 
+// Implements the whole hierarchy update, which is the common case. Scales are
+// ignored unless _Scaled, which is selected once per job rather than per soa
+// joint.
+template <typename _Matrix, bool _Scaled>
+OZZ_SIMD_DISPATCH
+void RunFull(const LocalToModelJob& _job, _Matrix* _model_matrices) {
   // Fetch joint's properties.
+  const int num_joints =
+    math::Min(_job.skeleton->num_joints(), _job.num_joints_lod);
   Range<const Skeleton::JointProperties> properties =
-    skeleton->joint_properties();
-
-  // Output.
-  Float4x4* const model_matrices = output.begin;
+    _job.skeleton->joint_properties();
 
   // Initializes an identity matrix that will be used to compute roots model
   // matrices without requiring a branch.
-  const Float4x4 identity = Float4x4::identity();
+  const _Matrix identity = _Matrix::identity();
 
   // Converts to matrices and applies hierarchical transformation.
   for (int joint = 0; joint < num_joints;) {
-    // Builds soa matrices from soa transforms.
-    const SoaTransform& transform = input.begin[joint / 4];
-    const SoaFloat4x4 local_soa_matrices =
-      SoaFloat4x4::FromAffine(transform.translation,
-                              transform.rotation,
-                              transform.scale);
-    // Converts to aos matrices.
-    math::SimdFloat4 local_aos_matrices[16];
-    math::Transpose16x16(&local_soa_matrices.cols[0].x, local_aos_matrices);
+    // Builds aos matrices from soa transforms.
+    _Matrix local_aos_matrices[4];
+    internal::ToAosMatrices<_Scaled>(_job.input.begin[joint / 4],
+                                     local_aos_matrices);
 
     // Applies hierarchical transformation.
     const int proceed_up_to = joint + math::Min(4, num_joints - joint);
-    const math::SimdFloat4* local_aos_matrix = local_aos_matrices;
-    for (; joint < proceed_up_to; ++joint, local_aos_matrix += 4) {
+    const _Matrix* local_aos_matrix = local_aos_matrices;
+    for (; joint < proceed_up_to; ++joint, ++local_aos_matrix) {
       const int parent = properties.begin[joint].parent;
-      const Float4x4* parent_matrix =
+      const _Matrix* parent_matrix =
         math::Select(parent == Skeleton::kNoParentIndex,
                      &identity,
-                     &model_matrices[parent]);
-      const Float4x4 local_matrix = {{local_aos_matrix[0],
-                                      local_aos_matrix[1],
-                                      local_aos_matrix[2],
-                                      local_aos_matrix[3]}};
-      model_matrices[joint] = (*parent_matrix) * local_matrix;
+                     &_model_matrices[parent]);
+      _model_matrices[joint] = (*parent_matrix) * (*local_aos_matrix);
+    }
+  }
+
+#ifdef OZZ_HAS_STATS
+  if (_job.stats) {
+    _job.stats->joints += num_joints;
+    _job.stats->soa_conversions += (num_joints + 3) / 4;
+  }
+#endif  // OZZ_HAS_STATS
+}
+
+// Dispatches the whole hierarchy update to the variant matching _job scale
+// mode.
+template <typename _Matrix>
+void RunFull(const LocalToModelJob& _job, _Matrix* _model_matrices) {
+  if (_job.scaled) {
+    RunFull<_Matrix, true>(_job, _model_matrices);
+  } else {
+    RunFull<_Matrix, false>(_job, _model_matrices);
+  }
+}
+}  // namespace
+
+bool LocalToModelJob::Run() const {
+  OZZ_PROFILE_SCOPE("LocalToModelJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no joint.
+  const int num_joints = math::Min(skeleton->num_joints(), num_joints_lod);
+  if (num_joints == 0) {
+    return true;
+  }
+
+  // Partial updates are processed by a dedicated, less optimized, path.
+  const bool partial =
+    from != Skeleton::kNoParentIndex || to < num_joints - 1 || dirty.begin ||
+    changed.begin;
+
+  // Dispatches to the output matrix type.
+  if (output.begin != NULL) {
+    if (partial) {
+      RunPartial(*this, output.begin);
+    } else {
+      RunFull(*this, output.begin);
+    }
+  } else {
+    if (partial) {
+      RunPartial(*this, output_4x3.begin);
+    } else {
+      RunFull(*this, output_4x3.begin);
+    }
+  }
+  return true;
+}
+
+BatchLocalToModelJob::BatchLocalToModelJob()
+    : skeleton(NULL) {
+}
+
+bool BatchLocalToModelJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  if (!skeleton) {
+    return false;
+  }
+  valid &= items.begin != NULL;
+  valid &= items.end >= items.begin;
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+
+  // Tests scratch range, implicitly tests for NULL end pointers.
+  valid &= scratch.begin != NULL;
+  valid &= scratch.end - scratch.begin >= num_joints;
+
+  // Tests every item.
+  for (const Item* item = items.begin; valid && item < items.end; ++item) {
+    valid &= item->input.begin != NULL;
+    valid &= item->input.end - item->input.begin >= num_soa_joints;
+    valid &= item->output.begin != NULL;
+    valid &= item->output.end - item->output.begin >= num_joints;
+  }
+
+  return valid;
+}
+
+namespace {
+// Computes the multiplication of soa affine matrices _a and _b. The last row of
+// both matrices is expected to be (0, 0, 0, 1), so it's not computed.
+void MultiplyAffine(const math::SoaFloat4x4& _a,
+                    const math::SoaFloat4x4& _b,
+                    math::SoaFloat4x4* _out) {
+  using math::MAdd;
+  for (int i = 0; i < 3; ++i) {
+    const math::SoaFloat4& b = _b.cols[i];
+    _out->cols[i].x = MAdd(_a.cols[2].x, b.z,
+                           MAdd(_a.cols[1].x, b.y, _a.cols[0].x * b.x));
+    _out->cols[i].y = MAdd(_a.cols[2].y, b.z,
+                           MAdd(_a.cols[1].y, b.y, _a.cols[0].y * b.x));
+    _out->cols[i].z = MAdd(_a.cols[2].z, b.z,
+                           MAdd(_a.cols[1].z, b.y, _a.cols[0].z * b.x));
+    _out->cols[i].w = _b.cols[i].w;
+  }
+  const math::SoaFloat4& t = _b.cols[3];
+  _out->cols[3].x = MAdd(_a.cols[2].x, t.z,
+                         MAdd(_a.cols[1].x, t.y,
+                              MAdd(_a.cols[0].x, t.x, _a.cols[3].x)));
+  _out->cols[3].y = MAdd(_a.cols[2].y, t.z,
+                         MAdd(_a.cols[1].y, t.y,
+                              MAdd(_a.cols[0].y, t.x, _a.cols[3].y)));
+  _out->cols[3].z = MAdd(_a.cols[2].z, t.z,
+                         MAdd(_a.cols[1].z, t.y,
+                              MAdd(_a.cols[0].z, t.x, _a.cols[3].z)));
+  _out->cols[3].w = _b.cols[3].w;
+}
+
+// Processes a group of at most 4 items, each simd lane being an item.
+OZZ_SIMD_DISPATCH
+void RunBatch(const BatchLocalToModelJob& _job,
+              const BatchLocalToModelJob::Item* _items,
+              int _count) {
+  assert(_count > 0 && _count <= 4);
+
+  const int num_joints = _job.skeleton->num_joints();
+  Range<const Skeleton::JointProperties> properties =
+    _job.skeleton->joint_properties();
+  math::SoaFloat4x4* const model_matrices = _job.scratch.begin;
+
+  // Missing lanes reuse the first item input, so that they compute valid
+  // values that aren't output.
+  const math::SoaTransform* inputs[4];
+  for (int i = 0; i < 4; ++i) {
+    inputs[i] = _items[i < _count ? i : 0].input.begin;
+  }
+
+  // Number of SimdFloat4 of a SoaTransform.
+  const int kSoaTransformSize =
+    sizeof(math::SoaTransform) / sizeof(math::SimdFloat4);
+
+  for (int soa = 0; soa * 4 < num_joints; ++soa) {
+    // Transposes the 4 joints of each item soa transform, so that lanes now
+    // store items instead of joints.
+    math::SoaTransform transforms[4];
+    for (int c = 0; c < kSoaTransformSize; ++c) {
+      const math::SimdFloat4 in[4] = {
+        (&inputs[0][soa].translation.x)[c],
+        (&inputs[1][soa].translation.x)[c],
+        (&inputs[2][soa].translation.x)[c],
+        (&inputs[3][soa].translation.x)[c]};
+      math::SimdFloat4 out[4];
+      math::Transpose4x4(in, out);
+      for (int j = 0; j < 4; ++j) {
+        (&transforms[j].translation.x)[c] = out[j];
+      }
     }
+
+    // Applies hierarchical transformation, lanes are processed together.
+    const int proceed_up_to = math::Min(soa * 4 + 4, num_joints);
+    for (int joint = soa * 4; joint < proceed_up_to; ++joint) {
+      const math::SoaTransform& transform = transforms[joint & 3];
+      const math::SoaFloat4x4 local_matrix =
+        math::SoaFloat4x4::FromAffine(transform.translation,
+                                      transform.rotation,
+                                      transform.scale);
+      const int parent = properties.begin[joint].parent;
+      math::SoaFloat4x4& model_matrix = model_matrices[joint];
+      if (parent == Skeleton::kNoParentIndex) {
+        model_matrix = local_matrix;
+      } else {
+        MultiplyAffine(model_matrices[parent], local_matrix, &model_matrix);
+      }
+
+      // Transposes back to every item output.
+      math::Float4x4 aos_matrices[4];
+      math::Transpose16x16(&model_matrix.cols[0].x, aos_matrices[0].cols);
+      for (int i = 0; i < _count; ++i) {
+        _items[i].output.begin[joint] = aos_matrices[i];
+      }
+    }
+  }
+}
+}  // namespace
+
+bool BatchLocalToModelJob::Run() const {
+  OZZ_PROFILE_SCOPE("BatchLocalToModelJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Processes items by groups of 4, the number of soa lanes.
+  for (const Item* item = items.begin; item < items.end; item += 4) {
+    const int count = math::Min(static_cast<int>(items.end - item), 4);
+    RunBatch(*this, item, count);
+  }
+  return true;
+}
+
+SparseLocalToModelJob::SparseLocalToModelJob()
+    : skeleton(NULL),
+      scaled(true) {
+}
+
+bool SparseLocalToModelJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  if (!skeleton) {
+    return false;
+  }
+  valid &= input.begin != NULL;
+
+  // Exactly one of the output ranges must be specified.
+  valid &= (output.begin != NULL) != (output_4x3.begin != NULL);
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+
+  // Test input and output ranges, implicitly tests for NULL end pointers.
+  valid &= input.end - input.begin >= num_soa_joints;
+  if (output.begin != NULL) {
+    valid &= output.end - output.begin >= num_joints;
+  } else {
+    valid &= output_4x3.end - output_4x3.begin >= num_joints;
+  }
+
+  // Tests evaluation list, which must be sorted.
+  valid &= joints.end >= joints.begin;
+  int previous = -1;
+  for (const uint16_t* joint = joints.begin; valid && joint < joints.end;
+       ++joint) {
+    valid &= *joint > previous && *joint < num_joints;
+    previous = *joint;
+  }
+
+  return valid;
+}
+
+namespace {
+// Evaluates listed joints in order. Soa to aos conversions are done lazily, as
+// soon as a joint of a soa element needs it.
+template <typename _Matrix>
+OZZ_SIMD_DISPATCH
+void RunSparse(const SparseLocalToModelJob& _job, _Matrix* _model_matrices) {
+  Range<const Skeleton::JointProperties> properties =
+    _job.skeleton->joint_properties();
+  const _Matrix identity = _Matrix::identity();
+
+  _Matrix local_aos_matrices[4];
+  int cached_soa = -1;
+  for (const uint16_t* it = _job.joints.begin; it < _job.joints.end; ++it) {
+    const int joint = *it;
+
+    // Converts joint soa element if not already done.
+    const int soa = joint / 4;
+    if (soa != cached_soa) {
+      internal::ToAosMatrices(_job.input.begin[soa], _job.scaled,
+                              local_aos_matrices);
+      cached_soa = soa;
+    }
+
+    const int parent = properties.begin[joint].parent;
+    const _Matrix* parent_matrix =
+      math::Select(parent == Skeleton::kNoParentIndex,
+                   &identity,
+                   &_model_matrices[parent]);
+    _model_matrices[joint] = (*parent_matrix) * local_aos_matrices[joint & 3];
+  }
+}
+}  // namespace
+
+bool SparseLocalToModelJob::Run() const {
+  OZZ_PROFILE_SCOPE("SparseLocalToModelJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Dispatches to the output matrix type.
+  if (output.begin != NULL) {
+    RunSparse(*this, output.begin);
+  } else {
+    RunSparse(*this, output_4x3.begin);
   }
   return true;
 }
@@ -0,0 +1,105 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_RUNTIME_LOCAL_TO_MODEL_PASS_H_
+#define OZZ_ANIMATION_RUNTIME_LOCAL_TO_MODEL_PASS_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_float4x3.h"
+
+// Defines the soa to aos conversions shared by local-to-model jobs (see
+// LocalToModelJob and SampleToModelJob).
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+// Converts the 4 transforms of soa transform _transform to soa matrices.
+// Scales are ignored unless _Scaled.
+template<bool _Scaled>
+OZZ_INLINE math::SoaFloat4x4 ToSoaMatrices(
+  const math::SoaTransform& _transform) {
+  return _Scaled ? math::SoaFloat4x4::FromAffine(_transform.translation,
+                                                 _transform.rotation,
+                                                 _transform.scale)
+                 : math::SoaFloat4x4::FromAffine(_transform.translation,
+                                                 _transform.rotation);
+}
+
+// Converts the 4 transforms of soa transform _transform to aos matrices.
+template<bool _Scaled>
+inline void ToAosMatrices(const math::SoaTransform& _transform,
+                          math::Float4x4 _matrices[4]) {
+  const math::SoaFloat4x4 soa_matrices = ToSoaMatrices<_Scaled>(_transform);
+  math::Transpose16x16(&soa_matrices.cols[0].x, _matrices[0].cols);
+}
+
+// Converts the 4 transforms of soa transform _transform to aos affine 4x3
+// matrices. The last row of the soa matrices is never transposed, as it's
+// always (0, 0, 0, 1).
+template<bool _Scaled>
+inline void ToAosMatrices(const math::SoaTransform& _transform,
+                          math::Float4x3 _matrices[4]) {
+  const math::SoaFloat4x4 soa_matrices = ToSoaMatrices<_Scaled>(_transform);
+  for (int i = 0; i < 3; ++i) {
+    const math::SimdFloat4 row[4] = {(&soa_matrices.cols[0].x)[i],
+                                     (&soa_matrices.cols[1].x)[i],
+                                     (&soa_matrices.cols[2].x)[i],
+                                     (&soa_matrices.cols[3].x)[i]};
+    math::SimdFloat4 aos[4];
+    math::Transpose4x4(row, aos);
+    _matrices[0].rows[i] = aos[0];
+    _matrices[1].rows[i] = aos[1];
+    _matrices[2].rows[i] = aos[2];
+    _matrices[3].rows[i] = aos[3];
+  }
+}
+
+// Runtime _scaled variant of ToAosMatrices, for paths where the conversion
+// isn't the inner loop.
+template<typename _Matrix>
+inline void ToAosMatrices(const math::SoaTransform& _transform, bool _scaled,
+                          _Matrix _matrices[4]) {
+  if (_scaled) {
+    ToAosMatrices<true>(_transform, _matrices);
+  } else {
+    ToAosMatrices<false>(_transform, _matrices);
+  }
+}
+}  // internal
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_RUNTIME_LOCAL_TO_MODEL_PASS_H_
@@ -0,0 +1,324 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_space_blending_job.h"
+
+#include <cstddef>
+
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/maths/dual_quaternion.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+ModelSpaceBlendingJob::Layer::Layer()
+    : weight(0.f) {
+}
+
+ModelSpaceBlendingJob::ModelSpaceBlendingJob()
+    : skeleton(NULL),
+      threshold(.1f) {
+}
+
+size_t ModelSpaceBlendingJob::scratch_size(int _num_layers, int _num_joints) {
+  // Translation, rotation and scale of every joint of every layer, plus the
+  // blended ones.
+  return static_cast<size_t>(_num_layers + 1) * _num_joints * 3;
+}
+
+bool ModelSpaceBlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!skeleton) {
+    return false;
+  }
+  valid &= layers.end >= layers.begin;
+  valid &= output.begin != NULL;
+  valid &= scratch.begin != NULL;
+
+  // Test for valid threshold.
+  valid &= threshold > 0.f;
+
+  // Test ranges, implicitly tests for NULL end pointers.
+  const ptrdiff_t num_joints = skeleton->num_joints();
+  const ptrdiff_t num_soa_joints = skeleton->num_soa_joints();
+  valid &= output.end - output.begin >= num_soa_joints;
+  if (models.begin) {
+    valid &= models.end - models.begin >= num_joints;
+  } else {
+    valid &= models.end == NULL;
+  }
+  const int num_layers = static_cast<int>(layers.end - layers.begin);
+  valid &= static_cast<size_t>(scratch.end - scratch.begin) >=
+           scratch_size(num_layers, skeleton->num_joints());
+
+  // Validates layers.
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    valid &= layer->transform.begin != NULL;
+    valid &= layer->transform.end - layer->transform.begin >= num_soa_joints;
+
+    // Joint weights are optional.
+    if (layer->joint_weights.begin) {
+      valid &= layer->joint_weights.end - layer->joint_weights.begin >=
+               num_soa_joints;
+    } else {
+      valid &= layer->joint_weights.end == NULL;
+    }
+  }
+
+  return valid;
+}
+
+namespace {
+// Model-space transform of a joint, as stored in the scratch buffer.
+struct ModelTransform {
+  math::SimdFloat4 translation;
+  math::SimdFloat4 rotation;
+  math::SimdFloat4 scale;
+};
+
+// Transposes the 4 soa transforms of _soa to aos translations, rotations and
+// scales.
+void ToAos(const math::SoaTransform& _soa, math::SimdFloat4 _translations[4],
+           math::SimdFloat4 _rotations[4], math::SimdFloat4 _scales[4]) {
+  const math::SimdFloat4 translations[3] = {
+    _soa.translation.x, _soa.translation.y, _soa.translation.z};
+  const math::SimdFloat4 rotations[4] = {
+    _soa.rotation.x, _soa.rotation.y, _soa.rotation.z, _soa.rotation.w};
+  const math::SimdFloat4 scales[3] = {
+    _soa.scale.x, _soa.scale.y, _soa.scale.z};
+  math::Transpose3x4(translations, _translations);
+  math::Transpose4x4(rotations, _rotations);
+  math::Transpose3x4(scales, _scales);
+}
+
+// Rotates vector _v by unit quaternion _q.
+OZZ_INLINE math::SimdFloat4 Rotate(math::_SimdFloat4 _q,
+                                   math::_SimdFloat4 _v) {
+  // v' = v + 2w(u x v) + 2u x (u x v), with u = q.xyz and w = q.w.
+  const math::SimdFloat4 c = math::Cross3(_q, _v);
+  const math::SimdFloat4 t = c + c;
+  return math::MAdd(math::SplatW(_q), t, _v + math::Cross3(_q, t));
+}
+
+// Computes the model-space transform of a joint whose local transform is
+// (_translation, _rotation, _scale), and whose parent model-space transform is
+// _parent, or NULL for a root.
+OZZ_INLINE ModelTransform ToModel(const ModelTransform* _parent,
+                                  math::_SimdFloat4 _translation,
+                                  math::_SimdFloat4 _rotation,
+                                  math::_SimdFloat4 _scale) {
+  if (!_parent) {
+    const ModelTransform model = {_translation, _rotation, _scale};
+    return model;
+  }
+  const ModelTransform model = {
+    _parent->translation +
+      Rotate(_parent->rotation, _parent->scale * _translation),
+    math::internal::QuaternionMultiply(_parent->rotation, _rotation),
+    _parent->scale * _scale};
+  return model;
+}
+
+// Accumulated weighted model-space transforms of a joint.
+struct Accumulator {
+  math::SimdFloat4 translation;
+  math::SimdFloat4 rotation;
+  math::SimdFloat4 scale;
+  float weight;
+};
+
+// Accumulates _model rotation and translation, and _local_scale, with weight
+// _weight. Rotation is negated if it isn't in the hemisphere of _reference, so
+// that the blend takes the shortest path.
+OZZ_INLINE void Accumulate(const ModelTransform& _model,
+                           math::_SimdFloat4 _local_scale,
+                           float _weight,
+                           math::_SimdFloat4 _reference,
+                           Accumulator* _accumulator) {
+  const math::SimdFloat4 weight = math::simd_float4::Load1(_weight);
+  const math::SimdInt4 sign =
+    math::Sign(math::SplatX(math::Dot4(_reference, _model.rotation)));
+  _accumulator->translation =
+    math::MAdd(_model.translation, weight, _accumulator->translation);
+  _accumulator->rotation =
+    math::MAdd(math::Xor(_model.rotation, sign), weight,
+               _accumulator->rotation);
+  _accumulator->scale = math::MAdd(_local_scale, weight, _accumulator->scale);
+  _accumulator->weight += _weight;
+}
+}  // namespace
+
+bool ModelSpaceBlendingJob::Run() const {
+  OZZ_PROFILE_SCOPE("ModelSpaceBlendingJob::Run");
+  using math::SimdFloat4;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = skeleton->num_soa_joints();
+  const int num_layers = static_cast<int>(layers.end - layers.begin);
+  Range<const Skeleton::JointProperties> properties =
+    skeleton->joint_properties();
+  const math::SoaTransform* bind_pose = skeleton->bind_pose().begin;
+
+  // Layers model-space transforms are stored in the scratch buffer, followed
+  // by the blended ones.
+  ModelTransform* layer_models = reinterpret_cast<ModelTransform*>(
+    scratch.begin);
+  ModelTransform* blended_models = layer_models + num_layers * num_joints;
+
+  const SimdFloat4 zero = math::simd_float4::zero();
+  const SimdFloat4 one = math::simd_float4::one();
+  for (int soa = 0; soa < num_soa_joints; ++soa) {
+    const int soa_begin = soa * 4;
+    const int soa_end = math::Min(num_joints, soa_begin + 4);
+    Accumulator accumulators[4];
+    SimdFloat4 references[4];
+    for (int i = 0; i < 4; ++i) {
+      const Accumulator init = {zero, zero, zero, 0.f};
+      accumulators[i] = init;
+    }
+
+    // Computes and accumulates model-space transforms of every layer.
+    for (int l = 0; l < num_layers; ++l) {
+      const Layer& layer = layers.begin[l];
+      SimdFloat4 translations[4];
+      SimdFloat4 rotations[4];
+      SimdFloat4 scales[4];
+      ToAos(layer.transform.begin[soa], translations, rotations, scales);
+
+      SimdFloat4 weight4 =
+        math::simd_float4::Load1(math::Max(layer.weight, 0.f));
+      if (layer.joint_weights.begin) {
+        weight4 = weight4 * math::Max0(layer.joint_weights.begin[soa]);
+      }
+      float weights[4];
+      math::StorePtrU(weight4, weights);
+
+      ModelTransform* models_l = layer_models + l * num_joints;
+      for (int joint = soa_begin; joint < soa_end; ++joint) {
+        const int lane = joint - soa_begin;
+        const int parent = properties.begin[joint].parent;
+        const ModelTransform model = ToModel(
+          parent == Skeleton::kNoParentIndex ? NULL : models_l + parent,
+          translations[lane], rotations[lane], scales[lane]);
+        models_l[joint] = model;
+        if (l == 0) {
+          references[lane] = model.rotation;
+        }
+        Accumulate(model, scales[lane], weights[lane], references[lane],
+                   &accumulators[lane]);
+      }
+    }
+
+    // Falls back to the bind pose, relatively to the blended parent, and
+    // converts blended transforms back to local-space.
+    SimdFloat4 bind_translations[4];
+    SimdFloat4 bind_rotations[4];
+    SimdFloat4 bind_scales[4];
+    ToAos(bind_pose[soa], bind_translations, bind_rotations, bind_scales);
+    SimdFloat4 translations[4] = {zero, zero, zero, zero};
+    SimdFloat4 rotations[4] = {math::simd_float4::w_axis(),
+                               math::simd_float4::w_axis(),
+                               math::simd_float4::w_axis(),
+                               math::simd_float4::w_axis()};
+    SimdFloat4 scales[4] = {one, one, one, one};
+    for (int joint = soa_begin; joint < soa_end; ++joint) {
+      const int lane = joint - soa_begin;
+      const int parent = properties.begin[joint].parent;
+      const ModelTransform* blended_parent =
+        parent == Skeleton::kNoParentIndex ? NULL : blended_models + parent;
+      Accumulator& accumulator = accumulators[lane];
+      if (accumulator.weight < threshold) {
+        const ModelTransform bind = ToModel(
+          blended_parent, bind_translations[lane], bind_rotations[lane],
+          bind_scales[lane]);
+        Accumulate(bind, bind_scales[lane], threshold - accumulator.weight,
+                   num_layers ? references[lane] : bind.rotation,
+                   &accumulator);
+      }
+
+      const SimdFloat4 inv_weight =
+        math::simd_float4::Load1(1.f / accumulator.weight);
+      ModelTransform& blended = blended_models[joint];
+      blended.translation = accumulator.translation * inv_weight;
+      blended.rotation = math::Normalize4(accumulator.rotation);
+      scales[lane] = accumulator.scale * inv_weight;
+      if (blended_parent) {
+        const SimdFloat4 inv_parent_rotation =
+          math::internal::QuaternionConjugate(blended_parent->rotation);
+        blended.scale = blended_parent->scale * scales[lane];
+        translations[lane] =
+          Rotate(inv_parent_rotation,
+                 blended.translation - blended_parent->translation) /
+          blended_parent->scale;
+        rotations[lane] = math::internal::QuaternionMultiply(
+          inv_parent_rotation, blended.rotation);
+      } else {
+        blended.scale = scales[lane];
+        translations[lane] = blended.translation;
+        rotations[lane] = blended.rotation;
+      }
+      if (models.begin) {
+        models.begin[joint] = math::Float4x4::FromAffine(
+          blended.translation, blended.rotation, blended.scale);
+      }
+    }
+
+    // Transposes back to soa, padding lanes being set to identity.
+    SimdFloat4 soa_translations[3];
+    SimdFloat4 soa_rotations[4];
+    SimdFloat4 soa_scales[3];
+    math::Transpose4x3(translations, soa_translations);
+    math::Transpose4x4(rotations, soa_rotations);
+    math::Transpose4x3(scales, soa_scales);
+    math::SoaTransform& out = output.begin[soa];
+    out.translation = math::SoaFloat3::Load(
+      soa_translations[0], soa_translations[1], soa_translations[2]);
+    out.rotation = math::SoaQuaternion::Load(
+      soa_rotations[0], soa_rotations[1], soa_rotations[2], soa_rotations[3]);
+    out.scale = math::SoaFloat3::Load(soa_scales[0], soa_scales[1],
+                                      soa_scales[2]);
+  }
+  return true;
+}
+}  // animation
+}  // ozz
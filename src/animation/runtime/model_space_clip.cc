@@ -0,0 +1,121 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_space_clip.h"
+
+#include <cassert>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/maths/simd_float4x3.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+ModelSpaceClip::ModelSpaceClip()
+    : matrices_(NULL),
+      num_joints_(0),
+      num_frames_(0),
+      frame_rate_(0.f),
+      duration_(0.f) {
+}
+
+ModelSpaceClip::~ModelSpaceClip() {
+  Destroy();
+}
+
+void ModelSpaceClip::Allocate(int _num_joints, int _num_frames) {
+  assert(!matrices_);
+  num_joints_ = _num_joints;
+  num_frames_ = _num_frames;
+  matrices_ =
+    memory::default_allocator()->Allocate<math::Float4x3>(
+      _num_joints * _num_frames);
+}
+
+void ModelSpaceClip::Destroy() {
+  memory::default_allocator()->Deallocate(matrices_);
+  matrices_ = NULL;
+  num_joints_ = 0;
+  num_frames_ = 0;
+  frame_rate_ = 0.f;
+  duration_ = 0.f;
+}
+
+Range<const math::Float4x3> ModelSpaceClip::frame(int _frame) const {
+  assert(_frame >= 0 && _frame < num_frames_);
+  return Range<const math::Float4x3>(matrices_ + _frame * num_joints_,
+                                     num_joints_);
+}
+
+size_t ModelSpaceClip::size() const {
+  return sizeof(*this) + sizeof(math::Float4x3) * num_joints_ * num_frames_;
+}
+
+void ModelSpaceClip::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << frame_rate_;
+  _archive << static_cast<int32_t>(num_joints_);
+  _archive << static_cast<int32_t>(num_frames_);
+
+  // A Float4x3 is made of 12 floats.
+  const size_t count = static_cast<size_t>(num_joints_) * num_frames_ * 12;
+  if (count) {
+    _archive << ozz::io::MakeArray(reinterpret_cast<float*>(matrices_),
+                                   count);
+  }
+}
+
+void ModelSpaceClip::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  (void)_version;
+
+  // Destroy clip in case it was already used before.
+  Destroy();
+
+  memory::ScopedTag tag(memory::kTagAnimation);
+
+  float duration, frame_rate;
+  _archive >> duration;
+  _archive >> frame_rate;
+  int32_t num_joints, num_frames;
+  _archive >> num_joints;
+  _archive >> num_frames;
+  Allocate(num_joints, num_frames);
+  duration_ = duration;
+  frame_rate_ = frame_rate;
+
+  const size_t count = static_cast<size_t>(num_joints_) * num_frames_ * 12;
+  if (count) {
+    _archive >> ozz::io::MakeArray(reinterpret_cast<float*>(matrices_),
+                                   count);
+  }
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,110 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_space_clip_sampling_job.h"
+
+#include <cmath>
+
+#include "ozz/animation/runtime/model_space_clip.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_float4x3.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+ModelSpaceClipSamplingJob::ModelSpaceClipSamplingJob()
+    : time(0.f),
+      clip(NULL) {
+}
+
+bool ModelSpaceClipSamplingJob::Validate() const {
+  // Test for NULL pointers.
+  if (!clip) {
+    return false;
+  }
+
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+  valid &= clip->num_frames() > 0;
+
+  // Exactly one of the output ranges must be specified. Tests output ranges,
+  // implicitly tests for NULL end pointers.
+  const int num_joints = clip->num_joints();
+  valid &= (output.begin != NULL) != (output_4x3.begin != NULL);
+  if (output.begin != NULL) {
+    valid &= output.end - output.begin >= num_joints;
+  } else {
+    valid &= output_4x3.end - output_4x3.begin >= num_joints;
+  }
+
+  return valid;
+}
+
+bool ModelSpaceClipSamplingJob::Run() const {
+  OZZ_PROFILE_SCOPE("ModelSpaceClipSamplingJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Finds the frames surrounding time, and the interpolation ratio between
+  // them.
+  const int last = clip->num_frames() - 1;
+  const float clamped = math::Clamp(0.f, time, clip->duration());
+  const float position = math::Min(clamped * clip->frame_rate(),
+                                   static_cast<float>(last));
+  const int frame =
+    math::Min(static_cast<int>(position), math::Max(last - 1, 0));
+  const int next = math::Min(frame + 1, last);
+  const math::SimdFloat4 alpha =
+    math::simd_float4::Load1(position - static_cast<float>(frame));
+
+  // Interpolates all joints matrices.
+  const math::Float4x3* a = clip->frame(frame).begin;
+  const math::Float4x3* b = clip->frame(next).begin;
+  const int num_joints = clip->num_joints();
+  for (int i = 0; i < num_joints; ++i) {
+    math::Float4x3 matrix;
+    for (int r = 0; r < 3; ++r) {
+      matrix.rows[r] = math::Lerp(a[i].rows[r], b[i].rows[r], alpha);
+    }
+    if (output.begin != NULL) {
+      output.begin[i] = math::ToFloat4x4(matrix);
+    } else {
+      output_4x3.begin[i] = matrix;
+    }
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,154 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_to_local_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/math_ex.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+ModelToLocalJob::ModelToLocalJob()
+    : skeleton(NULL),
+      from(0),
+      to(Skeleton::kMaxJoints) {
+}
+
+bool ModelToLocalJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  if (!skeleton) {
+    return false;
+  }
+  valid &= input.begin != NULL;
+  valid &= output.begin != NULL;
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+
+  // Test input and output ranges, implicitly tests for NULL end pointers.
+  valid &= input.end - input.begin >= num_joints;
+  valid &= output.end - output.begin >= num_soa_joints;
+
+  // Tests partial update parameters.
+  valid &= from >= 0 && (from < num_joints || num_joints == 0);
+  valid &= to >= from;
+
+  return valid;
+}
+
+bool ModelToLocalJob::Run() const {
+  OZZ_PROFILE_SCOPE("ModelToLocalJob::Run");
+  using math::SimdFloat4;
+  using math::Float4x4;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no joint.
+  const int num_joints = skeleton->num_joints();
+  if (num_joints == 0) {
+    return true;
+  }
+
+  // Fetch joint's properties.
+  Range<const Skeleton::JointProperties> properties =
+    skeleton->joint_properties();
+
+  const int begin = from;
+  const int end = math::Min(to + 1, num_joints);
+
+  // Processes joints by soa element, so that aos transforms are converted back
+  // to soa once per element.
+  for (int soa = begin / 4; soa * 4 < end; ++soa) {
+    math::SoaTransform& soa_transform = output.begin[soa];
+
+    // Converts the soa element to aos, as some of its joints might not be
+    // updated.
+    SimdFloat4 translations[4];
+    SimdFloat4 rotations[4];
+    SimdFloat4 scales[4];
+    math::Transpose3x4(&soa_transform.translation.x, translations);
+    math::Transpose4x4(&soa_transform.rotation.x, rotations);
+    math::Transpose3x4(&soa_transform.scale.x, scales);
+
+    const int soa_begin = math::Max(begin, soa * 4);
+    const int soa_end = math::Min(end, soa * 4 + 4);
+    for (int joint = soa_begin; joint < soa_end; ++joint) {
+      const int parent = properties.begin[joint].parent;
+      const Float4x4& model = input.begin[joint];
+      const Float4x4 local =
+        parent == Skeleton::kNoParentIndex ?
+          model : Invert(input.begin[parent]) * model;
+
+      // Decomposes local matrix, falling back to a null scale for degenerated
+      // matrices.
+      const int lane = joint & 3;
+      if (!ToAffine(local,
+                    &translations[lane],
+                    &rotations[lane],
+                    &scales[lane])) {
+        translations[lane] = local.cols[3];
+        rotations[lane] = math::simd_float4::w_axis();
+        scales[lane] = math::simd_float4::zero();
+      }
+    }
+
+    // Padding lanes of the last soa element are set to identity.
+    if (soa_end == num_joints) {
+      for (int joint = num_joints; joint < soa * 4 + 4; ++joint) {
+        const int lane = joint & 3;
+        translations[lane] = math::simd_float4::zero();
+        rotations[lane] = math::simd_float4::w_axis();
+        scales[lane] = math::simd_float4::one();
+      }
+    }
+
+    // Converts back to soa.
+    math::Transpose4x3(translations, &soa_transform.translation.x);
+    math::Transpose4x4(rotations, &soa_transform.rotation.x);
+    math::Transpose4x3(scales, &soa_transform.scale.x);
+  }
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,131 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_velocity_job.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/math_ex.h"
+
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+ModelVelocityJob::ModelVelocityJob()
+    : skeleton(NULL) {
+}
+
+bool ModelVelocityJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  if (!skeleton) {
+    return false;
+  }
+  valid &= velocities.begin != NULL;
+  valid &= models.begin != NULL;
+  valid &= linear.begin != NULL;
+  valid &= angular.begin != NULL;
+
+  // Test ranges, implicitly tests for NULL end pointers.
+  const ptrdiff_t num_joints = skeleton->num_joints();
+  const ptrdiff_t num_soa_joints = skeleton->num_soa_joints();
+  valid &= velocities.end - velocities.begin >= num_soa_joints;
+  valid &= models.end - models.begin >= num_joints;
+  valid &= linear.end - linear.begin >= num_joints;
+  valid &= angular.end - angular.begin >= num_joints;
+
+  return valid;
+}
+
+namespace {
+// Rotates _v by the rotation of _m, whose axes are normalized to remove
+// scaling.
+OZZ_INLINE math::SimdFloat4 Rotate(const math::Float4x4& _m,
+                                   math::_SimdFloat4 _v) {
+  const math::SimdFloat4 x = math::Normalize3(_m.cols[0]);
+  const math::SimdFloat4 y = math::Normalize3(_m.cols[1]);
+  const math::SimdFloat4 z = math::Normalize3(_m.cols[2]);
+  return x * math::SplatX(_v) + y * math::SplatY(_v) + z * math::SplatZ(_v);
+}
+}  // namespace
+
+bool ModelVelocityJob::Run() const {
+  OZZ_PROFILE_SCOPE("ModelVelocityJob::Run");
+  using math::SimdFloat4;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  Range<const Skeleton::JointProperties> properties =
+    skeleton->joint_properties();
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = skeleton->num_soa_joints();
+  for (int soa = 0; soa < num_soa_joints; ++soa) {
+    // Transposes the 4 joints soa velocities to aos.
+    const SoaJointVelocity& velocity = velocities.begin[soa];
+    const SimdFloat4 soa_translation[3] = {
+      velocity.translation.x, velocity.translation.y, velocity.translation.z};
+    const SimdFloat4 soa_rotation[3] = {
+      velocity.rotation.x, velocity.rotation.y, velocity.rotation.z};
+    SimdFloat4 translations[4];
+    SimdFloat4 rotations[4];
+    math::Transpose3x4(soa_translation, translations);
+    math::Transpose3x4(soa_rotation, rotations);
+
+    const int soa_end = math::Min(num_joints, soa * 4 + 4);
+    for (int joint = soa * 4; joint < soa_end; ++joint) {
+      const int lane = joint & 3;
+      const int parent = properties.begin[joint].parent;
+      if (parent == Skeleton::kNoParentIndex) {
+        linear.begin[joint] = translations[lane];
+        angular.begin[joint] = rotations[lane];
+        continue;
+      }
+      const math::Float4x4& parent_model = models.begin[parent];
+      const SimdFloat4 arm = models.begin[joint].cols[3] - parent_model.cols[3];
+      const SimdFloat4 parent_angular = angular.begin[parent];
+      linear.begin[joint] =
+        linear.begin[parent] + math::Cross3(parent_angular, arm) +
+        TransformVector(parent_model, translations[lane]);
+      angular.begin[joint] =
+        parent_angular + Rotate(parent_model, rotations[lane]);
+    }
+  }
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,213 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/motion_database.h"
+
+#include <cassert>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+const int MotionDatabase::kMaxFeatures;
+const int MotionDatabase::kClusterSize;
+
+MotionDatabase::MotionDatabase()
+    : num_frames_(0),
+      num_features_(0),
+      frames_(NULL),
+      root_(0),
+      joints_(NULL),
+      num_joints_(0),
+      trajectory_(NULL),
+      num_trajectory_(0),
+      means_(NULL),
+      scales_(NULL),
+      features_(NULL),
+      cluster_bounds_(NULL) {
+}
+
+MotionDatabase::~MotionDatabase() {
+  Destroy();
+}
+
+void MotionDatabase::Allocate(int _num_frames,
+                              int _num_joints,
+                              int _num_trajectory) {
+  assert(!frames_ && !features_);
+  num_frames_ = _num_frames;
+  num_joints_ = _num_joints;
+  num_trajectory_ = _num_trajectory;
+  num_features_ = _num_joints * 6 + _num_trajectory * 3;
+
+  memory::Allocator* allocator = memory::default_allocator();
+  frames_ = allocator->Allocate<Frame>(num_frames_);
+  joints_ = allocator->Allocate<int>(num_joints_);
+  trajectory_ = allocator->Allocate<float>(num_trajectory_);
+  means_ = allocator->Allocate<float>(num_features_);
+  scales_ = allocator->Allocate<float>(num_features_);
+  features_ =
+    allocator->Allocate<math::SimdFloat4>(num_blocks() * num_features_);
+  cluster_bounds_ =
+    allocator->Allocate<float>(num_clusters() * num_features_ * 2);
+  for (int i = 0; i < num_blocks() * num_features_; ++i) {
+    features_[i] = math::simd_float4::zero();
+  }
+}
+
+void MotionDatabase::Destroy() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(frames_);
+  frames_ = NULL;
+  allocator->Deallocate(joints_);
+  joints_ = NULL;
+  allocator->Deallocate(trajectory_);
+  trajectory_ = NULL;
+  allocator->Deallocate(means_);
+  means_ = NULL;
+  allocator->Deallocate(scales_);
+  scales_ = NULL;
+  allocator->Deallocate(features_);
+  features_ = NULL;
+  allocator->Deallocate(cluster_bounds_);
+  cluster_bounds_ = NULL;
+  num_frames_ = 0;
+  num_features_ = 0;
+  num_joints_ = 0;
+  num_trajectory_ = 0;
+  root_ = 0;
+}
+
+float MotionDatabase::feature(int _frame, int _feature) const {
+  assert(_frame >= 0 && _frame < num_frames_);
+  assert(_feature >= 0 && _feature < num_features_);
+  float values[4];
+  math::StorePtrU(features_[(_frame / 4) * num_features_ + _feature], values);
+  return values[_frame & 3];
+}
+
+void MotionDatabase::BuildIndex() {
+  const int stride = num_features_ * 2;
+  for (int c = 0; c < num_clusters(); ++c) {
+    float* mins = cluster_bounds_ + c * stride;
+    float* maxs = mins + num_features_;
+    const int begin = c * kClusterSize;
+    const int end = math::Min(begin + kClusterSize, num_frames_);
+    for (int f = 0; f < num_features_; ++f) {
+      mins[f] = maxs[f] = feature(begin, f);
+      for (int i = begin + 1; i < end; ++i) {
+        const float value = feature(i, f);
+        mins[f] = math::Min(mins[f], value);
+        maxs[f] = math::Max(maxs[f], value);
+      }
+    }
+  }
+}
+
+void MotionDatabase::Save(ozz::io::OArchive& _archive) const {
+  _archive << static_cast<int32_t>(num_frames_);
+  _archive << static_cast<int32_t>(num_joints_);
+  _archive << static_cast<int32_t>(num_trajectory_);
+  _archive << static_cast<int32_t>(root_);
+  for (int i = 0; i < num_joints_; ++i) {
+    _archive << static_cast<int32_t>(joints_[i]);
+  }
+  if (num_trajectory_) {
+    _archive << ozz::io::MakeArray(trajectory_, num_trajectory_);
+  }
+  if (num_features_) {
+    _archive << ozz::io::MakeArray(means_, num_features_);
+    _archive << ozz::io::MakeArray(scales_, num_features_);
+  }
+  for (int i = 0; i < num_frames_; ++i) {
+    _archive << static_cast<int32_t>(frames_[i].animation);
+    _archive << frames_[i].time;
+  }
+  // Features are saved by blocks, without the lanes beyond the last frame.
+  for (int b = 0; b < num_blocks(); ++b) {
+    for (int f = 0; f < num_features_; ++f) {
+      float values[4];
+      math::StorePtrU(features_[b * num_features_ + f], values);
+      for (int l = 0; l < 4 && b * 4 + l < num_frames_; ++l) {
+        _archive << values[l];
+      }
+    }
+  }
+}
+
+void MotionDatabase::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  (void)_version;
+
+  // Destroy database in case it was already used before.
+  Destroy();
+
+  memory::ScopedTag tag(memory::kTagAnimation);
+
+  int32_t num_frames, num_joints, num_trajectory, root;
+  _archive >> num_frames;
+  _archive >> num_joints;
+  _archive >> num_trajectory;
+  _archive >> root;
+  Allocate(num_frames, num_joints, num_trajectory);
+  root_ = root;
+  for (int i = 0; i < num_joints_; ++i) {
+    int32_t joint;
+    _archive >> joint;
+    joints_[i] = joint;
+  }
+  if (num_trajectory_) {
+    _archive >> ozz::io::MakeArray(trajectory_, num_trajectory_);
+  }
+  if (num_features_) {
+    _archive >> ozz::io::MakeArray(means_, num_features_);
+    _archive >> ozz::io::MakeArray(scales_, num_features_);
+  }
+  for (int i = 0; i < num_frames_; ++i) {
+    int32_t animation;
+    _archive >> animation;
+    frames_[i].animation = animation;
+    _archive >> frames_[i].time;
+  }
+  for (int b = 0; b < num_blocks(); ++b) {
+    for (int f = 0; f < num_features_; ++f) {
+      float values[4] = {0.f, 0.f, 0.f, 0.f};
+      for (int l = 0; l < 4 && b * 4 + l < num_frames_; ++l) {
+        _archive >> values[l];
+      }
+      features_[b * num_features_ + f] = math::simd_float4::LoadPtrU(values);
+    }
+  }
+  BuildIndex();
+}
+}  // animation
+}  // ozz
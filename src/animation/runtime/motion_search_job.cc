@@ -0,0 +1,147 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/motion_search_job.h"
+
+#include <cfloat>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/animation/runtime/motion_database.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+MotionSearchJob::MotionSearchJob()
+    : database(NULL),
+      use_index(true),
+      frame(NULL),
+      cost(NULL) {
+}
+
+bool MotionSearchJob::Validate() const {
+  if (!database || !frame || !cost || database->num_frames() == 0) {
+    return false;
+  }
+  const size_t num_features = database->num_features();
+  if (!query.begin || query.end < query.begin ||
+      query.Count() < num_features) {
+    return false;
+  }
+  if (weights.begin || weights.end) {
+    if (!weights.begin || weights.end < weights.begin ||
+        weights.Count() < num_features) {
+      return false;
+    }
+    for (size_t i = 0; i < num_features; ++i) {
+      if (!(weights.begin[i] >= 0.f)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool MotionSearchJob::Run() const {
+  OZZ_PROFILE_SCOPE("MotionSearchJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const MotionDatabase& db = *database;
+  const int num_features = db.num_features_;
+  const bool weighted = weights.begin != NULL;
+
+  // Normalizes the query and splats it, along with weights.
+  float normalized[MotionDatabase::kMaxFeatures];
+  float scalar_weights[MotionDatabase::kMaxFeatures];
+  math::SimdFloat4 splat_query[MotionDatabase::kMaxFeatures];
+  math::SimdFloat4 splat_weights[MotionDatabase::kMaxFeatures];
+  for (int f = 0; f < num_features; ++f) {
+    normalized[f] = (query.begin[f] - db.means_[f]) * db.scales_[f];
+    scalar_weights[f] = weighted ? weights.begin[f] : 1.f;
+    splat_query[f] = math::simd_float4::Load1(normalized[f]);
+    splat_weights[f] = math::simd_float4::Load1(scalar_weights[f]);
+  }
+
+  float best_cost = FLT_MAX;
+  int best_frame = 0;
+  const int blocks_per_cluster = MotionDatabase::kClusterSize / 4;
+  const int num_clusters = db.num_clusters();
+  const int num_blocks = db.num_blocks();
+  for (int c = 0; c < num_clusters; ++c) {
+    // Skips the cluster if the lower bound of its cost isn't better.
+    if (use_index) {
+      const float* mins = db.cluster_bounds_ + c * num_features * 2;
+      const float* maxs = mins + num_features;
+      float bound = 0.f;
+      for (int f = 0; f < num_features; ++f) {
+        const float q = normalized[f];
+        const float d = q < mins[f] ? mins[f] - q :
+                        (q > maxs[f] ? q - maxs[f] : 0.f);
+        bound += scalar_weights[f] * d * d;
+      }
+      if (bound >= best_cost) {
+        continue;
+      }
+    }
+
+    // Computes the cost of 4 frames at a time.
+    const int begin = c * blocks_per_cluster;
+    const int end = math::Min(begin + blocks_per_cluster, num_blocks);
+    for (int b = begin; b < end; ++b) {
+      const math::SimdFloat4* features = db.features_ + b * num_features;
+      math::SimdFloat4 block_cost = math::simd_float4::zero();
+      for (int f = 0; f < num_features; ++f) {
+        const math::SimdFloat4 d = features[f] - splat_query[f];
+        block_cost = math::MAdd(splat_weights[f] * d, d, block_cost);
+      }
+
+      float costs[4];
+      math::StorePtrU(block_cost, costs);
+      const int num_lanes = math::Min(4, db.num_frames_ - b * 4);
+      for (int l = 0; l < num_lanes; ++l) {
+        if (costs[l] < best_cost) {
+          best_cost = costs[l];
+          best_frame = b * 4 + l;
+        }
+      }
+    }
+  }
+
+  *frame = best_frame;
+  *cost = best_cost;
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,208 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/numa_replicas.h"
+
+#include <new>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/linear_allocator.h"
+#include "ozz/base/memory/numa_allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+
+// Replicas of a node. Replicas and their buffers are allocated from an arena,
+// whose blocks are placed on the node.
+struct NumaReplicas::Node {
+  explicit Node(int _node)
+      : numa(_node),
+        arena(kBlockSize, &numa),
+        animations(NULL),
+        skeletons(NULL) {
+  }
+
+  // Size of arena blocks. Bigger buffers get their own block.
+  static const size_t kBlockSize = 1 << 20;
+
+  memory::NumaAllocator numa;
+  memory::ArenaAllocator arena;
+  Animation* animations;
+  Skeleton* skeletons;
+};
+
+NumaReplicas::NumaReplicas()
+    : nodes_(NULL),
+      num_nodes_(0),
+      num_animations_(0),
+      num_skeletons_(0) {
+}
+
+NumaReplicas::~NumaReplicas() {
+  Clear();
+}
+
+void NumaReplicas::Clear() {
+  memory::Allocator* allocator = memory::default_allocator();
+  for (int i = 0; i < num_nodes_; ++i) {
+    Node* node = nodes_[i];
+    // Replicas are constructed as the node is filled, so a partially filled
+    // node has NULL arrays.
+    if (node->animations) {
+      for (int j = 0; j < num_animations_; ++j) {
+        node->animations[j].~Animation();
+      }
+    }
+    if (node->skeletons) {
+      for (int j = 0; j < num_skeletons_; ++j) {
+        node->skeletons[j].~Skeleton();
+      }
+    }
+    allocator->Delete(node);
+  }
+  allocator->Deallocate(nodes_);
+  nodes_ = NULL;
+  num_nodes_ = 0;
+  num_animations_ = 0;
+  num_skeletons_ = 0;
+}
+
+bool NumaReplicas::Replicate(const Range<const Animation* const>& _animations,
+                             const Range<const Skeleton* const>& _skeletons,
+                             int _num_nodes) {
+  Clear();
+
+  if (_num_nodes < 1) {
+    return false;
+  }
+  for (const Animation* const* it = _animations.begin; it < _animations.end;
+       ++it) {
+    if (!*it) {
+      return false;
+    }
+  }
+  for (const Skeleton* const* it = _skeletons.begin; it < _skeletons.end;
+       ++it) {
+    if (!*it) {
+      return false;
+    }
+  }
+
+  // Sources are serialized once, and loaded for every node.
+  io::MemoryStream stream;
+  {
+    io::OArchive archive(&stream);
+    for (const Animation* const* it = _animations.begin;
+         it < _animations.end; ++it) {
+      archive << **it;
+    }
+    for (const Skeleton* const* it = _skeletons.begin; it < _skeletons.end;
+         ++it) {
+      archive << **it;
+    }
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  nodes_ = allocator->Allocate<Node*>(_num_nodes);
+  num_animations_ = static_cast<int>(_animations.Count());
+  num_skeletons_ = static_cast<int>(_skeletons.Count());
+
+  // Saves current buffer allocators, which are restored once replicated.
+  memory::Allocator* const animation_allocator =
+    Animation::SetBufferAllocator(NULL);
+  memory::Allocator* const skeleton_allocator =
+    Skeleton::SetBufferAllocator(NULL);
+
+  bool success = nodes_ != NULL;
+  for (int i = 0; success && i < _num_nodes; ++i) {
+    Node* node = allocator->New<Node>(i);
+    nodes_[num_nodes_++] = node;
+
+    // Replicas objects are allocated from the arena too, as they are accessed
+    // as often as their buffers.
+    memory::Allocator* arena = &node->arena;
+    Animation::SetBufferAllocator(arena);
+    Skeleton::SetBufferAllocator(arena);
+
+    Animation* animations = arena->Allocate<Animation>(num_animations_);
+    Skeleton* skeletons = arena->Allocate<Skeleton>(num_skeletons_);
+    if ((num_animations_ && !animations) || (num_skeletons_ && !skeletons)) {
+      success = false;
+      continue;
+    }
+    for (int j = 0; j < num_animations_; ++j) {
+      new(animations + j) Animation;
+    }
+    node->animations = animations;
+    for (int j = 0; j < num_skeletons_; ++j) {
+      new(skeletons + j) Skeleton;
+    }
+    node->skeletons = skeletons;
+
+    stream.Seek(0, io::Stream::kSet);
+    io::IArchive archive(&stream);
+    for (int j = 0; j < num_animations_; ++j) {
+      archive >> animations[j];
+    }
+    for (int j = 0; j < num_skeletons_; ++j) {
+      archive >> skeletons[j];
+    }
+  }
+  Animation::SetBufferAllocator(animation_allocator);
+  Skeleton::SetBufferAllocator(skeleton_allocator);
+
+  if (!success) {
+    Clear();
+  }
+  return success;
+}
+
+const Animation* NumaReplicas::animation(int _index, int _node) const {
+  if (_index < 0 || _index >= num_animations_) {
+    return NULL;
+  }
+  const int node = _node >= 0 && _node < num_nodes_ ? _node : 0;
+  return nodes_[node]->animations + _index;
+}
+
+const Skeleton* NumaReplicas::skeleton(int _index, int _node) const {
+  if (_index < 0 || _index >= num_skeletons_) {
+    return NULL;
+  }
+  const int node = _node >= 0 && _node < num_nodes_ ? _node : 0;
+  return nodes_[node]->skeletons + _index;
+}
+}  // animation
+}  // ozz
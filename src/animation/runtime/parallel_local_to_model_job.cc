@@ -0,0 +1,378 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/parallel_local_to_model_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/tasks/task_dispatcher.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+LocalToModelPartition::LocalToModelPartition()
+    : joints_(NULL),
+      offsets_(NULL),
+      num_partitions_(0),
+      num_joints_(0) {
+}
+
+LocalToModelPartition::~LocalToModelPartition() {
+  Destroy();
+}
+
+void LocalToModelPartition::Destroy() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(joints_);
+  joints_ = NULL;
+  allocator->Deallocate(offsets_);
+  offsets_ = NULL;
+  num_partitions_ = 0;
+  num_joints_ = 0;
+}
+
+bool LocalToModelPartition::Build(const Skeleton& _skeleton,
+                                  int _max_partitions) {
+  if (_max_partitions < 1) {
+    return false;
+  }
+
+  // Destroy partition in case it was already used before.
+  Destroy();
+
+  memory::Allocator* allocator = memory::default_allocator();
+  const int num_joints = _skeleton.num_joints();
+  num_joints_ = num_joints;
+  joints_ = allocator->Allocate<uint16_t>(num_joints);
+  offsets_ = allocator->Allocate<int>(_max_partitions + 1);
+  offsets_[0] = 0;
+
+  // Early out if no joint.
+  if (num_joints == 0) {
+    return true;
+  }
+
+  Range<const Skeleton::JointProperties> properties =
+    _skeleton.joint_properties();
+
+  // Allocates temporary buffers. The last element of children lists (at
+  // kNoParentIndex) is used as a virtual parent for all roots.
+  const int kVirtualRoot = Skeleton::kNoParentIndex;
+  int* sizes = allocator->Allocate<int>(num_joints);
+  int* owners = allocator->Allocate<int>(num_joints);
+  int* subtrees = allocator->Allocate<int>(num_joints);
+  int* bin_loads = allocator->Allocate<int>(_max_partitions);
+  int* bin_remaps = allocator->Allocate<int>(_max_partitions);
+  int* first_children = allocator->Allocate<int>(kVirtualRoot + 1);
+  int* next_siblings = allocator->Allocate<int>(num_joints);
+
+  // Builds children lists and subtree sizes. Joints are ordered such that a
+  // parent is always before its children.
+  for (int i = 0; i <= kVirtualRoot; ++i) {
+    first_children[i] = -1;
+  }
+  for (int i = 0; i < num_joints; ++i) {
+    sizes[i] = 0;
+    owners[i] = -1;  // Trunk until proven otherwise.
+  }
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = properties.begin[i].parent;
+    ++sizes[i];
+    if (parent != Skeleton::kNoParentIndex) {
+      sizes[parent] += sizes[i];
+    }
+    next_siblings[i] = first_children[parent];
+    first_children[parent] = i;
+  }
+
+  // Starts with skeleton roots as subtrees, and splits subtrees that are
+  // bigger than the mean partition size. Split subtree roots are moved to the
+  // trunk.
+  int num_subtrees = 0;
+  for (int child = first_children[kVirtualRoot];
+       child != -1;
+       child = next_siblings[child]) {
+    subtrees[num_subtrees++] = child;
+  }
+  const int target = (num_joints + _max_partitions - 1) / _max_partitions;
+  for (;;) {
+    // Finds the biggest subtree that can be split.
+    int biggest = -1;
+    for (int i = 0; i < num_subtrees; ++i) {
+      const int root = subtrees[i];
+      if (sizes[root] > target && first_children[root] != -1 &&
+          (biggest == -1 || sizes[root] > sizes[subtrees[biggest]])) {
+        biggest = i;
+      }
+    }
+    if (biggest == -1) {
+      break;
+    }
+
+    // Replaces biggest subtree by its children. The number of subtrees can
+    // never exceed the number of joints.
+    const int root = subtrees[biggest];
+    subtrees[biggest] = subtrees[--num_subtrees];
+    for (int child = first_children[root];
+         child != -1;
+         child = next_siblings[child]) {
+      subtrees[num_subtrees++] = child;
+    }
+  }
+
+  // Sorts subtrees by decreasing size.
+  for (int i = 1; i < num_subtrees; ++i) {
+    const int subtree = subtrees[i];
+    int j = i;
+    for (; j > 0 && sizes[subtrees[j - 1]] < sizes[subtree]; --j) {
+      subtrees[j] = subtrees[j - 1];
+    }
+    subtrees[j] = subtree;
+  }
+
+  // Distributes subtrees to the less loaded partition, biggest first.
+  for (int i = 0; i < _max_partitions; ++i) {
+    bin_loads[i] = 0;
+  }
+  for (int i = 0; i < num_subtrees; ++i) {
+    int bin = 0;
+    for (int j = 1; j < _max_partitions; ++j) {
+      if (bin_loads[j] < bin_loads[bin]) {
+        bin = j;
+      }
+    }
+    bin_loads[bin] += sizes[subtrees[i]];
+    owners[subtrees[i]] = bin;
+  }
+
+  // Removes empty partitions.
+  num_partitions_ = 0;
+  for (int i = 0; i < _max_partitions; ++i) {
+    bin_remaps[i] = bin_loads[i] ? num_partitions_++ : -1;
+  }
+
+  // Propagates subtree root ownership to all their descendants, as parents are
+  // always processed before their children. Subtree roots parents belong to
+  // the trunk.
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = properties.begin[i].parent;
+    if (owners[i] != -1) {
+      owners[i] = bin_remaps[owners[i]];
+    } else if (parent != Skeleton::kNoParentIndex &&
+               owners[parent] != -1) {
+      owners[i] = owners[parent];
+    }
+  }
+
+  // Fills joint indices, trunk first, preserving skeleton order. Offsets are
+  // first used to count joints per partition.
+  int trunk_count = 0;
+  for (int i = 0; i <= num_partitions_; ++i) {
+    offsets_[i] = 0;
+  }
+  for (int i = 0; i < num_joints; ++i) {
+    if (owners[i] == -1) {
+      ++trunk_count;
+    } else {
+      ++offsets_[owners[i] + 1];
+    }
+  }
+  offsets_[0] = trunk_count;
+  for (int i = 1; i <= num_partitions_; ++i) {
+    offsets_[i] += offsets_[i - 1];
+  }
+  assert(offsets_[num_partitions_] == num_joints);
+
+  // Uses sizes buffer as per partition insertion cursors.
+  int trunk_cursor = 0;
+  for (int i = 0; i < num_partitions_; ++i) {
+    sizes[i] = offsets_[i];
+  }
+  for (int i = 0; i < num_joints; ++i) {
+    const int owner = owners[i];
+    if (owner == -1) {
+      joints_[trunk_cursor++] = static_cast<uint16_t>(i);
+    } else {
+      joints_[sizes[owner]++] = static_cast<uint16_t>(i);
+    }
+  }
+
+  // Deallocates temporary buffers.
+  allocator->Deallocate(sizes);
+  allocator->Deallocate(owners);
+  allocator->Deallocate(subtrees);
+  allocator->Deallocate(bin_loads);
+  allocator->Deallocate(bin_remaps);
+  allocator->Deallocate(first_children);
+  allocator->Deallocate(next_siblings);
+
+  return true;
+}
+
+ParallelLocalToModelJob::ParallelLocalToModelJob()
+    : skeleton(NULL),
+      partition(NULL),
+      dispatcher(NULL) {
+}
+
+bool ParallelLocalToModelJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  if (!skeleton || !partition) {
+    return false;
+  }
+  valid &= dispatcher != NULL;
+  valid &= input.begin != NULL;
+  valid &= output.begin != NULL;
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+
+  // Partition must match the skeleton.
+  valid &= partition->num_joints() == num_joints;
+
+  // Test input and output ranges, implicitly tests for NULL end pointers.
+  valid &= input.end - input.begin >= num_soa_joints;
+  valid &= output.end - output.begin >= num_joints;
+
+  return valid;
+}
+
+namespace {
+
+// Computes model matrices of _joints, which must be sorted in skeleton order.
+void ProcessJoints(Range<const uint16_t> _joints,
+                   Range<const Skeleton::JointProperties> _properties,
+                   const math::SoaTransform* _input,
+                   math::Float4x4* _output) {
+  using math::SoaTransform;
+  using math::SoaFloat4x4;
+  using math::Float4x4;
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const Float4x4 identity = Float4x4::identity();
+
+  // Local aos matrices are converted once per soa element, which is shared by
+  // consecutive joints.
+  math::SimdFloat4 local_aos_matrices[16];
+  int cached_soa = -1;
+
+  for (const uint16_t* it = _joints.begin; it < _joints.end; ++it) {
+    const int joint = *it;
+    const int soa = joint / 4;
+    if (soa != cached_soa) {
+      // Builds soa matrices from soa transforms.
+      const SoaTransform& transform = _input[soa];
+      const SoaFloat4x4 local_soa_matrices =
+        SoaFloat4x4::FromAffine(transform.translation,
+                                transform.rotation,
+                                transform.scale);
+      // Converts to aos matrices.
+      math::Transpose16x16(&local_soa_matrices.cols[0].x, local_aos_matrices);
+      cached_soa = soa;
+    }
+
+    // Applies hierarchical transformation.
+    const math::SimdFloat4* local_aos_matrix =
+      local_aos_matrices + (joint & 3) * 4;
+    const int parent = _properties.begin[joint].parent;
+    const Float4x4* parent_matrix =
+      math::Select(parent == Skeleton::kNoParentIndex,
+                   &identity,
+                   &_output[parent]);
+    const Float4x4 local_matrix = {{local_aos_matrix[0],
+                                    local_aos_matrix[1],
+                                    local_aos_matrix[2],
+                                    local_aos_matrix[3]}};
+    _output[joint] = (*parent_matrix) * local_matrix;
+  }
+}
+
+// Implements the task that processes every partition as a work item.
+class PartitionTask : public tasks::Task {
+ public:
+  explicit PartitionTask(const ParallelLocalToModelJob& _job)
+    : job_(_job) {
+  }
+
+  virtual void Run(int _index) const {
+    ProcessJoints(job_.partition->partition(_index),
+                  job_.skeleton->joint_properties(),
+                  job_.input.begin,
+                  job_.output.begin);
+  }
+
+ private:
+  // Disables assignment operators.
+  PartitionTask(const PartitionTask&);
+  void operator = (const PartitionTask&);
+
+  const ParallelLocalToModelJob& job_;
+};
+}  // namespace
+
+bool ParallelLocalToModelJob::Run() const {
+  OZZ_PROFILE_SCOPE("ParallelLocalToModelJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no joint.
+  if (skeleton->num_joints() == 0) {
+    return true;
+  }
+
+  // Processes the trunk first, as all partitions depend on it.
+  ProcessJoints(partition->trunk(),
+                skeleton->joint_properties(),
+                input.begin,
+                output.begin);
+
+  // Then dispatches independent partitions.
+  const PartitionTask task(*this);
+  dispatcher->Dispatch(task, partition->num_partitions());
+
+  return true;
+}
+}  // animation
+}  // ozz
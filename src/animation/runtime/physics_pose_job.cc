@@ -0,0 +1,230 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/physics_pose_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/local_to_model_pass.h"
+
+namespace ozz {
+namespace animation {
+
+PhysicsPoseJob::PhysicsPoseJob()
+    : skeleton(NULL),
+      root(math::Float4x4::identity()),
+      scratch_allocator(NULL) {
+}
+
+namespace {
+// Returns true if every body joint is in range and mapped once. _mapped is a
+// temporary buffer of _num_joints entries.
+bool ValidateBodyJoints(Range<const uint16_t> _body_joints,
+                        int _num_joints,
+                        bool* _mapped) {
+  for (int i = 0; i < _num_joints; ++i) {
+    _mapped[i] = false;
+  }
+  for (const uint16_t* joint = _body_joints.begin; joint < _body_joints.end;
+       ++joint) {
+    if (*joint >= _num_joints || _mapped[*joint]) {
+      return false;
+    }
+    _mapped[*joint] = true;
+  }
+  return true;
+}
+}  // namespace
+
+bool PhysicsPoseJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  if (!skeleton) {
+    return false;
+  }
+  valid &= input.begin != NULL;
+  valid &= models.begin != NULL;
+  valid &= output.begin != NULL;
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+
+  // Test input and output ranges, implicitly tests for NULL end pointers.
+  valid &= input.end - input.begin >= num_soa_joints;
+  valid &= models.end - models.begin >= num_joints;
+  valid &= output.end - output.begin >= num_soa_joints;
+
+  // Tests bodies, which can be empty.
+  valid &= body_joints.end >= body_joints.begin;
+  valid &= bodies.end - bodies.begin == body_joints.end - body_joints.begin;
+  if (!valid) {
+    return false;
+  }
+
+  // Joints mapped flags are sized to the skeleton.
+  memory::Allocator* scratch =
+    scratch_allocator ? scratch_allocator : memory::default_allocator();
+  bool* mapped = scratch->Allocate<bool>(num_joints);
+  valid = ValidateBodyJoints(body_joints, num_joints, mapped);
+  scratch->Deallocate(mapped);
+
+  return valid;
+}
+
+namespace {
+// Implements PhysicsPoseJob::Run, once the job is validated. _body_indices is
+// a temporary buffer of num_joints entries.
+void Match(const PhysicsPoseJob& _job, int _num_joints, int* _body_indices) {
+  using math::SimdFloat4;
+  using math::Float4x4;
+
+  // Maps joints to their body, -1 if they don't have any.
+  for (int i = 0; i < _num_joints; ++i) {
+    _body_indices[i] = -1;
+  }
+  for (const uint16_t* joint = _job.body_joints.begin;
+       joint < _job.body_joints.end;
+       ++joint) {
+    _body_indices[*joint] = static_cast<int>(joint - _job.body_joints.begin);
+  }
+
+  // Bodies are converted from world to model-space.
+  const Float4x4 inv_root = Invert(_job.root);
+
+  Range<const Skeleton::JointProperties> properties =
+    _job.skeleton->joint_properties();
+
+  const int num_soa_joints = (_num_joints + 3) / 4;
+  for (int soa = 0; soa < num_soa_joints; ++soa) {
+    const math::SoaTransform& in = _job.input.begin[soa];
+    math::SoaTransform& out = _job.output.begin[soa];
+
+    // Computes the local matrices of the 4 joints at once.
+    Float4x4 locals[4];
+    internal::ToAosMatrices(in, true, locals);
+
+    // Concatenates model-space matrices, replacing the ones of mapped joints
+    // by their body.
+    bool matched = false;
+    const int soa_end = math::Min(_num_joints, soa * 4 + 4);
+    for (int joint = soa * 4; joint < soa_end; ++joint) {
+      const int parent = properties.begin[joint].parent;
+      const int body = _body_indices[joint];
+      if (body >= 0) {
+        _job.models.begin[joint] = inv_root * _job.bodies.begin[body];
+        matched = true;
+      } else if (parent == Skeleton::kNoParentIndex) {
+        _job.models.begin[joint] = locals[joint & 3];
+      } else {
+        _job.models.begin[joint] =
+          _job.models.begin[parent] * locals[joint & 3];
+      }
+    }
+
+    // Copies the animation pose, as soa elements without any mapped joint
+    // don't change.
+    if (&out != &in) {
+      out = in;
+    }
+    if (!matched) {
+      continue;
+    }
+
+    // Decomposes the local transform of mapped joints, in their aos lane.
+    SimdFloat4 translations[4];
+    SimdFloat4 rotations[4];
+    SimdFloat4 scales[4];
+    math::Transpose3x4(&out.translation.x, translations);
+    math::Transpose4x4(&out.rotation.x, rotations);
+    math::Transpose3x4(&out.scale.x, scales);
+    for (int joint = soa * 4; joint < soa_end; ++joint) {
+      if (_body_indices[joint] < 0) {
+        continue;
+      }
+      const int parent = properties.begin[joint].parent;
+      const Float4x4& model = _job.models.begin[joint];
+      const Float4x4 local =
+        parent == Skeleton::kNoParentIndex ?
+          model : Invert(_job.models.begin[parent]) * model;
+      const int lane = joint & 3;
+      if (!ToAffine(local,
+                    &translations[lane],
+                    &rotations[lane],
+                    &scales[lane])) {
+        translations[lane] = local.cols[3];
+        rotations[lane] = math::simd_float4::w_axis();
+        scales[lane] = math::simd_float4::zero();
+      }
+    }
+    math::Transpose4x3(translations, &out.translation.x);
+    math::Transpose4x4(rotations, &out.rotation.x);
+    math::Transpose4x3(scales, &out.scale.x);
+  }
+}
+}  // namespace
+
+bool PhysicsPoseJob::Run() const {
+  OZZ_PROFILE_SCOPE("PhysicsPoseJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no joint.
+  const int num_joints = skeleton->num_joints();
+  if (num_joints == 0) {
+    return true;
+  }
+
+  // The joints to body map is sized to the skeleton.
+  memory::Allocator* scratch =
+    scratch_allocator ? scratch_allocator : memory::default_allocator();
+  int* body_indices = scratch->Allocate<int>(num_joints);
+  Match(*this, num_joints, body_indices);
+  scratch->Deallocate(body_indices);
+  return true;
+}
+}  // animation
+}  // ozz
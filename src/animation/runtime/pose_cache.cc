@@ -0,0 +1,238 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/pose_cache.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Computes the hash of a posture key, from its animation id, time and soa
+// tracks mask.
+uint32_t HashKey(uint32_t _animation_id, float _time,
+                 const unsigned char* _mask, int _mask_size) {
+  uint32_t time;
+  std::memcpy(&time, &_time, sizeof(time));
+  uint32_t hash = 2166136261u;  // FNV-1a.
+  hash = (hash ^ _animation_id) * 16777619u;
+  hash = (hash ^ time) * 16777619u;
+  for (int i = 0; i < _mask_size; ++i) {
+    hash = (hash ^ _mask[i]) * 16777619u;
+  }
+  return hash ^ (hash >> 16);
+}
+}  // namespace
+
+PoseCache::PoseCache(const Skeleton& _skeleton,
+                     int _capacity,
+                     float _time_step,
+                     bool _models)
+    : skeleton_(_skeleton),
+      capacity_(_capacity),
+      time_step_(_time_step),
+      mask_size_((_skeleton.num_soa_joints() + 7) / 8),
+      num_poses_(0),
+      num_hits_(0),
+      num_slots_(1),
+      slab_(NULL),
+      locals_(NULL),
+      models_(NULL),
+      keys_(NULL),
+      masks_(NULL),
+      slots_(NULL),
+      cache_(NULL) {
+  assert(_capacity >= 0 && _time_step >= 0.f);
+
+  // Hash table is kept at most half full.
+  while (num_slots_ < _capacity * 2) {
+    num_slots_ *= 2;
+  }
+
+  // Computes slab layout, from the highest alignment requirement to the
+  // lowest: local transforms, model matrices, keys, hash table and masks.
+  const size_t alignment = AlignOf<math::SoaTransform>::value;
+  const size_t models_offset =
+    sizeof(math::SoaTransform) * _skeleton.num_soa_joints() * _capacity;
+  const size_t models_size =
+    _models ? sizeof(math::Float4x4) * _skeleton.num_joints() * _capacity : 0;
+  const size_t keys_offset = math::Align(models_offset + models_size,
+                                         AlignOf<Key>::value);
+  const size_t slots_offset = math::Align(keys_offset + sizeof(Key) * _capacity,
+                                          AlignOf<int>::value);
+  const size_t masks_offset = slots_offset + sizeof(int) * num_slots_;
+  const size_t size = masks_offset + mask_size_ * _capacity;
+
+  memory::ScopedTag tag(memory::kTagCache);
+  memory::Allocator* allocator = memory::default_allocator();
+  slab_ = reinterpret_cast<char*>(allocator->Allocate(size, alignment));
+  locals_ = reinterpret_cast<math::SoaTransform*>(slab_);
+  if (_models) {
+    models_ = reinterpret_cast<math::Float4x4*>(slab_ + models_offset);
+  }
+  keys_ = reinterpret_cast<Key*>(slab_ + keys_offset);
+  slots_ = reinterpret_cast<int*>(slab_ + slots_offset);
+  masks_ = reinterpret_cast<unsigned char*>(slab_ + masks_offset);
+
+  cache_ = allocator->New<SamplingCache>(_skeleton.num_joints());
+
+  Clear();
+}
+
+PoseCache::~PoseCache() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Delete(cache_);
+  allocator->Deallocate(slab_);
+}
+
+float PoseCache::Quantize(float _time) const {
+  if (time_step_ <= 0.f) {
+    return _time;
+  }
+  return std::floor(_time / time_step_ + .5f) * time_step_;
+}
+
+void PoseCache::Clear() {
+  num_poses_ = 0;
+  num_hits_ = 0;
+  for (int i = 0; i < num_slots_; ++i) {
+    slots_[i] = -1;
+  }
+}
+
+bool PoseCache::Get(const Animation& _animation,
+                    float _time,
+                    Range<const unsigned char> _soa_mask,
+                    Pose* _pose) {
+  // Validates arguments.
+  const int num_soa_joints = skeleton_.num_soa_joints();
+  if (!_pose || _animation.num_soa_tracks() > num_soa_joints) {
+    return false;
+  }
+  if (_soa_mask.begin ? _soa_mask.end - _soa_mask.begin < mask_size_ :
+                        _soa_mask.end != NULL) {
+    return false;
+  }
+
+  // Builds the posture key. The mask is normalized, so that an empty mask
+  // matches a mask with all soa joints set.
+  unsigned char mask[(Skeleton::kMaxSoAJoints + 7) / 8];
+  for (int i = 0; i < mask_size_; ++i) {
+    mask[i] = _soa_mask.begin ? _soa_mask.begin[i] : 0xff;
+  }
+  if (num_soa_joints & 7) {
+    mask[mask_size_ - 1] &= 0xff >> (8 - (num_soa_joints & 7));
+  }
+  const float time = Quantize(_time);
+  const Key key = {_animation.id(), time,
+                   HashKey(_animation.id(), time, mask, mask_size_)};
+
+  // Looks for the posture in the hash table, using linear probing.
+  const int slot_mask = num_slots_ - 1;
+  int slot = static_cast<int>(key.hash & slot_mask);
+  for (; slots_[slot] >= 0; slot = (slot + 1) & slot_mask) {
+    const int index = slots_[slot];
+    const Key& other = keys_[index];
+    if (other.hash == key.hash &&
+        other.animation_id == key.animation_id &&
+        other.time == key.time &&
+        std::memcmp(masks_ + index * mask_size_, mask, mask_size_) == 0) {
+      ++num_hits_;
+      break;
+    }
+  }
+
+  // Samples the posture if it isn't cached yet.
+  int index = slots_[slot];
+  if (index < 0) {
+    if (num_poses_ >= capacity_) {
+      return false;
+    }
+    index = num_poses_;
+
+    // Joints that aren't sampled are set to the bind pose.
+    Range<math::SoaTransform> locals(locals_ + index * num_soa_joints,
+                                     num_soa_joints);
+    std::memcpy(locals.begin, skeleton_.bind_pose().begin, locals.Size());
+
+    SamplingJob sampling_job;
+    sampling_job.animation = &_animation;
+    sampling_job.cache = cache_;
+    sampling_job.time = key.time;
+    sampling_job.output = locals;
+    sampling_job.soa_mask.begin = mask;
+    sampling_job.soa_mask.end = mask + mask_size_;
+    if (!sampling_job.Run()) {
+      return false;
+    }
+
+    if (models_) {
+      LocalToModelJob ltm_job;
+      ltm_job.skeleton = &skeleton_;
+      ltm_job.input = locals;
+      ltm_job.output.begin = models_ + index * skeleton_.num_joints();
+      ltm_job.output.end = ltm_job.output.begin + skeleton_.num_joints();
+      if (!ltm_job.Run()) {
+        return false;
+      }
+    }
+
+    // Registers the new posture.
+    keys_[index] = key;
+    std::memcpy(masks_ + index * mask_size_, mask, mask_size_);
+    slots_[slot] = index;
+    ++num_poses_;
+  }
+
+  _pose->locals.begin = locals_ + index * num_soa_joints;
+  _pose->locals.end = _pose->locals.begin + num_soa_joints;
+  if (models_) {
+    _pose->models.begin = models_ + index * skeleton_.num_joints();
+    _pose->models.end = _pose->models.begin + skeleton_.num_joints();
+  } else {
+    _pose->models = Range<const math::Float4x4>();
+  }
+  return true;
+}
+}  // animation
+}  // ozz
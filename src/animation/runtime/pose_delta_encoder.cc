@@ -0,0 +1,414 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/pose_delta_encoder.h"
+
+#include <cstring>
+
+#include "ozz/base/maths/compact_soa_transform.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Writes values of up to 32 bits to a byte buffer, least significant bits
+// first. Overflowing bits aren't written, and are reported by Flush().
+class BitWriter {
+ public:
+  explicit BitWriter(Range<char> _buffer)
+      : buffer_(_buffer),
+        size_(0),
+        accum_(0),
+        num_accum_(0),
+        overflow_(false) {
+  }
+
+  void Write(uint32_t _value, int _bits) {
+    accum_ |= static_cast<uint64_t>(_value) << num_accum_;
+    num_accum_ += _bits;
+    while (num_accum_ >= 8) {
+      Put(static_cast<char>(accum_ & 0xff));
+      accum_ >>= 8;
+      num_accum_ -= 8;
+    }
+  }
+
+  // Writes pending bits, and returns the number of bytes written, or 0 if the
+  // buffer overflowed.
+  size_t Flush() {
+    if (num_accum_ > 0) {
+      Put(static_cast<char>(accum_ & 0xff));
+      accum_ = 0;
+      num_accum_ = 0;
+    }
+    return overflow_ ? 0 : size_;
+  }
+
+ private:
+  void Put(char _byte) {
+    if (buffer_.begin + size_ < buffer_.end) {
+      buffer_.begin[size_++] = _byte;
+    } else {
+      overflow_ = true;
+    }
+  }
+
+  Range<char> buffer_;
+  size_t size_;
+  uint64_t accum_;
+  int num_accum_;
+  bool overflow_;
+};
+
+// Reads values written by BitWriter. Reading past the end of the buffer
+// returns zeros, and is reported by overflow().
+class BitReader {
+ public:
+  explicit BitReader(Range<const char> _buffer)
+      : buffer_(_buffer),
+        cursor_(0),
+        accum_(0),
+        num_accum_(0),
+        overflow_(false) {
+  }
+
+  uint32_t Read(int _bits) {
+    while (num_accum_ < _bits) {
+      uint64_t byte = 0;
+      if (buffer_.begin + cursor_ < buffer_.end) {
+        byte = static_cast<unsigned char>(buffer_.begin[cursor_++]);
+      } else {
+        overflow_ = true;
+      }
+      accum_ |= byte << num_accum_;
+      num_accum_ += 8;
+    }
+    const uint32_t value =
+      static_cast<uint32_t>(accum_ & ((uint64_t(1) << _bits) - 1));
+    accum_ >>= _bits;
+    num_accum_ -= _bits;
+    return value;
+  }
+
+  // Skips _bits bits, as if they were read.
+  void Skip(int _bits) {
+    for (; _bits > 0; _bits -= 32) {
+      Read(math::Min(_bits, 32));
+    }
+  }
+
+  bool overflow() const {
+    return overflow_;
+  }
+
+ private:
+  Range<const char> buffer_;
+  size_t cursor_;
+  uint64_t accum_;
+  int num_accum_;
+  bool overflow_;
+};
+
+// Channels of a joint, as bits of the channel mask.
+enum Channel {
+  kTranslation = 1 << 0,
+  kRotation = 1 << 1,
+  kScale = 1 << 2,
+};
+
+// Number of bits of a difference length prefix, and of a rotation dropped
+// component index and sign.
+const int kLengthBits = 2;
+const int kLargestBits = 3;
+
+// Maximum number of bits of an encoded joint: channel mask, rotation dropped
+// component, and 9 differences.
+const int kMaxJointBits = 3 + kLargestBits + 9 * (kLengthBits + 16);
+
+// Gets the 12 quantized values (3 components of 4 lanes) of channel _channel
+// (0 for translations, 1 for rotations, 2 for scales), as unsigned integers.
+// Rotation values are signed, but their differences are computed modulo 2^16
+// like other channels.
+uint16_t* ChannelValues(math::CompactSoaTransform* _transform, int _channel) {
+  switch (_channel) {
+    case 0: return &_transform->translation[0][0];
+    case 1: return reinterpret_cast<uint16_t*>(&_transform->rotation[0][0]);
+    default: return &_transform->scale[0][0];
+  }
+}
+
+const uint16_t* ChannelValues(const math::CompactSoaTransform* _transform,
+                              int _channel) {
+  return ChannelValues(const_cast<math::CompactSoaTransform*>(_transform),
+                       _channel);
+}
+
+// Computes the channel mask of lane _lane of _transform, compared to
+// _reference.
+int ChannelMask(const math::CompactSoaTransform& _transform,
+                const math::CompactSoaTransform& _reference,
+                int _lane) {
+  int mask = 0;
+  for (int c = 0; c < 3; ++c) {
+    const uint16_t* values = ChannelValues(&_transform, c);
+    const uint16_t* references = ChannelValues(&_reference, c);
+    for (int i = _lane; i < 12; i += 4) {
+      if (values[i] != references[i]) {
+        mask |= 1 << c;
+        break;
+      }
+    }
+  }
+  if (_transform.largest[_lane] != _reference.largest[_lane]) {
+    mask |= kRotation;
+  }
+  return mask;
+}
+
+// Writes the difference of _value to _reference, zig-zag encoded so that small
+// negative differences remain small, with a length prefix.
+void WriteDifference(uint16_t _value, uint16_t _reference,
+                     BitWriter* _writer) {
+  const int diff = static_cast<int16_t>(static_cast<uint16_t>(_value -
+                                                              _reference));
+  const uint32_t zigzag = static_cast<uint32_t>((diff << 1) ^ (diff >> 31)) &
+                          0xffff;
+  const int length = zigzag < (1 << 4) ? 0 :
+                     zigzag < (1 << 8) ? 1 :
+                     zigzag < (1 << 12) ? 2 : 3;
+  _writer->Write(length, kLengthBits);
+  _writer->Write(zigzag, (length + 1) * 4);
+}
+
+uint16_t ReadDifference(uint16_t _reference, BitReader* _reader) {
+  const int length = static_cast<int>(_reader->Read(kLengthBits));
+  const uint32_t zigzag = _reader->Read((length + 1) * 4);
+  const int diff =
+    static_cast<int>(zigzag >> 1) ^ -static_cast<int>(zigzag & 1);
+  return static_cast<uint16_t>(_reference + diff);
+}
+
+// Computes the channel masks of the first _num_lanes lanes of _transform,
+// compared to _reference. Returns true if any lane changed.
+bool ChannelMasks(const math::CompactSoaTransform& _transform,
+                  const math::CompactSoaTransform& _reference,
+                  int _num_lanes,
+                  int _masks[4]) {
+  bool changed = false;
+  for (int lane = 0; lane < _num_lanes; ++lane) {
+    _masks[lane] = ChannelMask(_transform, _reference, lane);
+    changed |= _masks[lane] != 0;
+  }
+  return changed;
+}
+
+// Copies the lanes of _reference that are >= _num_lanes to _transform.
+void CopyPaddingLanes(const math::CompactSoaTransform& _reference,
+                      int _num_lanes,
+                      math::CompactSoaTransform* _transform) {
+  for (int lane = _num_lanes; lane < 4; ++lane) {
+    for (int c = 0; c < 3; ++c) {
+      uint16_t* values = ChannelValues(_transform, c);
+      const uint16_t* references = ChannelValues(&_reference, c);
+      for (int i = lane; i < 12; i += 4) {
+        values[i] = references[i];
+      }
+    }
+    _transform->largest[lane] = _reference.largest[lane];
+  }
+}
+}  // namespace
+
+PoseDeltaEncoder::PoseDeltaEncoder(const Skeleton& _skeleton)
+    : skeleton_(_skeleton) {
+}
+
+size_t PoseDeltaEncoder::max_size() const {
+  const size_t bits = skeleton_.num_soa_joints() +
+                      skeleton_.num_joints() * (1 + kMaxJointBits);
+  return (bits + 7) / 8;
+}
+
+size_t PoseDeltaEncoder::Encode(
+    Range<const math::SoaTransform> _pose,
+    Range<const math::CompactSoaTransform> _reference,
+    Range<math::CompactSoaTransform> _quantized,
+    Range<char> _buffer) const {
+  const int num_joints = skeleton_.num_joints();
+  const int num_soa_joints = skeleton_.num_soa_joints();
+  if (_pose.Count() < static_cast<size_t>(num_soa_joints) ||
+      _reference.Count() < static_cast<size_t>(num_soa_joints) ||
+      _quantized.Count() < static_cast<size_t>(num_soa_joints)) {
+    return 0;
+  }
+
+  // Quantizes the pose. Padding lanes are the reference ones, as the decoder
+  // can't restore them.
+  math::Pack(Range<const math::SoaTransform>(_pose.begin, num_soa_joints),
+             Range<math::CompactSoaTransform>(_quantized.begin,
+                                              num_soa_joints));
+  if (num_joints & 3) {
+    CopyPaddingLanes(_reference.begin[num_soa_joints - 1], num_joints & 3,
+                     &_quantized.begin[num_soa_joints - 1]);
+  }
+
+  // Writes soa joints changed bits, then joints changed bits, then changed
+  // joints channels. Channel masks are computed again for each section rather
+  // than stored, as a buffer per joint would be too big for the stack.
+  int masks[4];
+  BitWriter writer(_buffer);
+  for (int i = 0; i < num_soa_joints; ++i) {
+    const int num_lanes = math::Min(4, num_joints - i * 4);
+    writer.Write(ChannelMasks(_quantized.begin[i], _reference.begin[i],
+                              num_lanes, masks),
+                 1);
+  }
+  for (int i = 0; i < num_soa_joints; ++i) {
+    const int num_lanes = math::Min(4, num_joints - i * 4);
+    if (!ChannelMasks(_quantized.begin[i], _reference.begin[i], num_lanes,
+                      masks)) {
+      continue;
+    }
+    for (int lane = 0; lane < num_lanes; ++lane) {
+      writer.Write(masks[lane] != 0, 1);
+    }
+  }
+  for (int i = 0; i < num_soa_joints; ++i) {
+    const math::CompactSoaTransform& quantized = _quantized.begin[i];
+    const math::CompactSoaTransform& reference = _reference.begin[i];
+    const int num_lanes = math::Min(4, num_joints - i * 4);
+    if (!ChannelMasks(quantized, reference, num_lanes, masks)) {
+      continue;
+    }
+    for (int lane = 0; lane < num_lanes; ++lane) {
+      const int mask = masks[lane];
+      if (!mask) {
+        continue;
+      }
+      writer.Write(mask, 3);
+      if (mask & kRotation) {
+        writer.Write(quantized.largest[lane], kLargestBits);
+      }
+      for (int c = 0; c < 3; ++c) {
+        if (!(mask & (1 << c))) {
+          continue;
+        }
+        const uint16_t* values = ChannelValues(&quantized, c);
+        const uint16_t* references = ChannelValues(&reference, c);
+        for (int k = lane; k < 12; k += 4) {
+          WriteDifference(values[k], references[k], &writer);
+        }
+      }
+    }
+  }
+
+  return writer.Flush();
+}
+
+bool PoseDeltaEncoder::Decode(
+    Range<const char> _buffer,
+    Range<const math::CompactSoaTransform> _reference,
+    Range<math::CompactSoaTransform> _quantized,
+    Range<math::SoaTransform> _pose) const {
+  const int num_joints = skeleton_.num_joints();
+  const int num_soa_joints = skeleton_.num_soa_joints();
+  if (_pose.Count() < static_cast<size_t>(num_soa_joints) ||
+      _reference.Count() < static_cast<size_t>(num_soa_joints) ||
+      _quantized.Count() < static_cast<size_t>(num_soa_joints)) {
+    return false;
+  }
+
+  // Unchanged joints and padding lanes are the reference ones.
+  std::memcpy(_quantized.begin, _reference.begin,
+              num_soa_joints * sizeof(math::CompactSoaTransform));
+
+  // Soa joints changed bits, joints changed bits and changed joints channels
+  // are read in a single pass, by a reader per section, rather than stored, as
+  // a buffer per joint would be too big for the stack. The channels section
+  // starts after the changed bits of the joints of changed soa joints, which
+  // are counted first.
+  BitReader soa_reader(_buffer);
+  BitReader joint_reader(_buffer);
+  BitReader reader(_buffer);
+  joint_reader.Skip(num_soa_joints);
+  reader.Skip(num_soa_joints);
+  for (int i = 0; i < num_soa_joints; ++i) {
+    if (soa_reader.Read(1)) {
+      reader.Skip(math::Min(4, num_joints - i * 4));
+    }
+  }
+  soa_reader = BitReader(_buffer);
+
+  for (int i = 0; i < num_soa_joints; ++i) {
+    if (!soa_reader.Read(1)) {
+      continue;
+    }
+    math::CompactSoaTransform& quantized = _quantized.begin[i];
+    const math::CompactSoaTransform& reference = _reference.begin[i];
+    const int num_lanes = math::Min(4, num_joints - i * 4);
+    for (int lane = 0; lane < num_lanes; ++lane) {
+      if (!joint_reader.Read(1)) {
+        continue;
+      }
+      const int mask = static_cast<int>(reader.Read(3));
+      if (mask & kRotation) {
+        quantized.largest[lane] =
+          static_cast<uint8_t>(reader.Read(kLargestBits));
+      }
+      for (int c = 0; c < 3; ++c) {
+        if (!(mask & (1 << c))) {
+          continue;
+        }
+        uint16_t* values = ChannelValues(&quantized, c);
+        const uint16_t* references = ChannelValues(&reference, c);
+        for (int k = lane; k < 12; k += 4) {
+          values[k] = ReadDifference(references[k], &reader);
+        }
+      }
+    }
+  }
+
+  // The channels section is the last one, so it's the first to overflow if the
+  // buffer is truncated.
+  if (reader.overflow()) {
+    return false;
+  }
+
+  // Unpacks the quantized pose with simd kernels.
+  return math::Unpack(
+    Range<const math::CompactSoaTransform>(_quantized.begin, num_soa_joints),
+    Range<math::SoaTransform>(_pose.begin, num_soa_joints));
+}
+}  // animation
+}  // ozz
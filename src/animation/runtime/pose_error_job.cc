@@ -0,0 +1,178 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/pose_error_job.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/profile.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+namespace ozz {
+namespace animation {
+
+PoseErrorJob::PoseErrorJob()
+    : error(NULL),
+      max_error(NULL) {
+}
+
+bool PoseErrorJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL output pointer.
+  valid &= error != NULL;
+
+  // Tests poses ranges.
+  valid &= reference.begin <= reference.end;
+  valid &= reference.begin != NULL || reference.end == NULL;
+  valid &= pose.begin != NULL || pose.end == NULL;
+  valid &= pose.end - pose.begin == reference.end - reference.begin;
+
+  // Tests optional weights.
+  if (weights.begin) {
+    valid &= weights.end - weights.begin >= reference.end - reference.begin;
+  } else {
+    valid &= weights.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+// Computes the distance between the positions of 4 joints of _reference and
+// _pose.
+OZZ_INLINE math::SimdFloat4 Distances(const math::Float4x4* _reference,
+                                      const math::Float4x4* _pose) {
+  math::SimdFloat4 diffs[4] = {
+    _pose[0].cols[3] - _reference[0].cols[3],
+    _pose[1].cols[3] - _reference[1].cols[3],
+    _pose[2].cols[3] - _reference[2].cols[3],
+    _pose[3].cols[3] - _reference[3].cols[3]};
+  math::SimdFloat4 soa[4];
+  math::Transpose4x4(diffs, soa);
+  return math::Sqrt(
+    math::MAdd(soa[0], soa[0], math::MAdd(soa[1], soa[1], soa[2] * soa[2])));
+}
+}  // namespace
+
+bool PoseErrorJob::Run() const {
+  OZZ_PROFILE_SCOPE("PoseErrorJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = static_cast<int>(reference.end - reference.begin);
+  const math::SimdFloat4 one = math::simd_float4::one();
+  math::SimdFloat4 weighted = math::simd_float4::zero();
+  math::SimdFloat4 sum_weights = math::simd_float4::zero();
+  math::SimdFloat4 max = math::simd_float4::zero();
+
+  // Processes 4 joints at a time.
+  int i = 0;
+  for (; i + 4 <= num_joints; i += 4) {
+    const math::SimdFloat4 distances =
+      Distances(reference.begin + i, pose.begin + i);
+    const math::SimdFloat4 w =
+      weights.begin ? math::simd_float4::LoadPtrU(weights.begin + i) : one;
+    weighted = math::MAdd(distances, w, weighted);
+    sum_weights = sum_weights + w;
+    max = math::Max(max, distances);
+  }
+
+  // Remaining joints are padded with matching identity matrices and null
+  // weights.
+  if (i < num_joints) {
+    math::Float4x4 references[4] = {math::Float4x4::identity(),
+                                    math::Float4x4::identity(),
+                                    math::Float4x4::identity(),
+                                    math::Float4x4::identity()};
+    math::Float4x4 poses[4] = {references[0], references[1],
+                               references[2], references[3]};
+    float w[4] = {0.f, 0.f, 0.f, 0.f};
+    for (int j = 0; i + j < num_joints; ++j) {
+      references[j] = reference.begin[i + j];
+      poses[j] = pose.begin[i + j];
+      w[j] = weights.begin ? weights.begin[i + j] : 1.f;
+    }
+    const math::SimdFloat4 distances = Distances(references, poses);
+    const math::SimdFloat4 wv = math::simd_float4::LoadPtrU(w);
+    weighted = math::MAdd(distances, wv, weighted);
+    sum_weights = sum_weights + wv;
+    max = math::Max(max, distances);
+  }
+
+  // Reduces lanes.
+  const float total_weight = math::GetX(math::HAdd4(sum_weights));
+  *error = total_weight > 0.f ?
+    math::GetX(math::HAdd4(weighted)) / total_weight : 0.f;
+  if (max_error) {
+    float lanes[4];
+    math::StorePtrU(max, lanes);
+    *max_error = math::Max(math::Max(lanes[0], lanes[1]),
+                           math::Max(lanes[2], lanes[3]));
+  }
+
+  return true;
+}
+
+bool ComputeJointLengthWeights(const Skeleton& _skeleton,
+                               Range<float> _weights) {
+  const int num_joints = _skeleton.num_joints();
+  if (_weights.end - _weights.begin < num_joints) {
+    return false;
+  }
+
+  // Bone lengths are the lengths of the bind-pose local translations. Roots
+  // have no bone, their translation is the character placement.
+  Range<const Skeleton::JointProperties> properties =
+    _skeleton.joint_properties();
+  float longest = 0.f;
+  for (int i = 0; i < num_joints; ++i) {
+    if (properties.begin[i].parent != Skeleton::kNoParentIndex) {
+      const math::Transform bind_pose = GetJointBindPose(_skeleton, i);
+      _weights.begin[i] = Length(bind_pose.translation);
+      longest = math::Max(longest, _weights.begin[i]);
+    }
+  }
+  for (int i = 0; i < num_joints; ++i) {
+    if (properties.begin[i].parent == Skeleton::kNoParentIndex) {
+      _weights.begin[i] = longest;
+    }
+  }
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,236 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/pose_history.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+
+PoseHistory::PoseHistory(const Skeleton& _skeleton, int _capacity)
+    : skeleton_(_skeleton),
+      capacity_(_capacity),
+      first_(0),
+      num_records_(0),
+      entries_(NULL),
+      locals_(NULL) {
+  assert(_capacity > 0);
+
+  memory::ScopedTag tag(memory::kTagCache);
+  memory::Allocator* allocator = memory::default_allocator();
+  entries_ = reinterpret_cast<Entry*>(
+    allocator->Allocate(sizeof(Entry) * _capacity, AlignOf<Entry>::value));
+
+  // Local transforms are initialized to the bind pose, so that joints that
+  // aren't sampled are still valid blending inputs.
+  const int num_soa_joints = _skeleton.num_soa_joints();
+  const int num_buffers = kMaxLayers + 1;
+  locals_ = reinterpret_cast<math::SoaTransform*>(
+    allocator->Allocate(sizeof(math::SoaTransform) * num_soa_joints *
+                        num_buffers, AlignOf<math::SoaTransform>::value));
+  for (int i = 0; i < num_buffers; ++i) {
+    std::memcpy(locals_ + i * num_soa_joints, _skeleton.bind_pose().begin,
+                _skeleton.bind_pose().Size());
+  }
+
+  for (int i = 0; i < kMaxLayers; ++i) {
+    caches_[i] = allocator->New<SamplingCache>(_skeleton.num_joints());
+  }
+}
+
+PoseHistory::~PoseHistory() {
+  memory::Allocator* allocator = memory::default_allocator();
+  for (int i = 0; i < kMaxLayers; ++i) {
+    allocator->Delete(caches_[i]);
+  }
+  allocator->Deallocate(locals_);
+  allocator->Deallocate(entries_);
+}
+
+float PoseHistory::oldest_time() const {
+  assert(num_records_ > 0);
+  return entry(0).time;
+}
+
+float PoseHistory::newest_time() const {
+  assert(num_records_ > 0);
+  return entry(num_records_ - 1).time;
+}
+
+void PoseHistory::Clear() {
+  first_ = 0;
+  num_records_ = 0;
+}
+
+bool PoseHistory::Record(float _time, Range<const Layer> _layers) {
+  // Validates arguments.
+  const ptrdiff_t num_layers = _layers.end - _layers.begin;
+  if (num_layers < 0 || num_layers > kMaxLayers) {
+    return false;
+  }
+  for (const Layer* layer = _layers.begin; layer < _layers.end; ++layer) {
+    if (!layer->animation ||
+        layer->animation->num_soa_tracks() > skeleton_.num_soa_joints()) {
+      return false;
+    }
+  }
+  if (num_records_ > 0 && !(_time > newest_time())) {
+    return false;
+  }
+
+  // Overwrites the oldest record if the ring is full.
+  Entry* entry;
+  if (num_records_ < capacity_) {
+    entry = &entries_[(first_ + num_records_) % capacity_];
+    ++num_records_;
+  } else {
+    entry = &entries_[first_];
+    first_ = (first_ + 1) % capacity_;
+  }
+  entry->time = _time;
+  entry->num_layers = static_cast<int>(num_layers);
+  for (int i = 0; i < num_layers; ++i) {
+    entry->layers[i] = _layers.begin[i];
+  }
+  return true;
+}
+
+bool PoseHistory::Evaluate(float _time,
+                           Range<const uint16_t> _joints,
+                           Range<math::Float4x4> _models) {
+  if (num_records_ == 0 || _time < oldest_time()) {
+    return false;
+  }
+
+  // Binary searches the newest record that isn't after _time.
+  int low = 0;
+  int high = num_records_ - 1;
+  while (low < high) {
+    const int mid = (low + high + 1) / 2;
+    if (entry(mid).time <= _time) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  const Entry& e0 = entry(low);
+  const Entry* e1 = low + 1 < num_records_ ? &entry(low + 1) : NULL;
+  const float alpha = e1 ? (_time - e0.time) / (e1->time - e0.time) : 0.f;
+
+  // Only samples the soa tracks of the evaluated joints.
+  const int num_soa_joints = skeleton_.num_soa_joints();
+  const int mask_size = (num_soa_joints + 7) / 8;
+  unsigned char mask[(Skeleton::kMaxSoAJoints + 7) / 8];
+  std::memset(mask, _joints.begin ? 0 : 0xff, mask_size);
+  for (const uint16_t* joint = _joints.begin; joint < _joints.end; ++joint) {
+    if (*joint >= skeleton_.num_joints()) {
+      return false;
+    }
+    mask[*joint / 32] |= 1 << ((*joint / 4) & 7);
+  }
+
+  // Samples every layer, interpolating its state with the next record's one.
+  BlendingJob::Layer blend_layers[kMaxLayers];
+  for (int i = 0; i < e0.num_layers; ++i) {
+    Layer layer = e0.layers[i];
+    if (e1 && i < e1->num_layers) {
+      const Layer& next = e1->layers[i];
+      if (next.animation == layer.animation && next.time >= layer.time) {
+        layer.time = math::Lerp(layer.time, next.time, alpha);
+        layer.weight = math::Lerp(layer.weight, next.weight, alpha);
+      }
+    }
+
+    const Range<math::SoaTransform> locals(locals_ + i * num_soa_joints,
+                                           num_soa_joints);
+    SamplingJob sampling_job;
+    sampling_job.animation = layer.animation;
+    sampling_job.cache = caches_[i];
+    sampling_job.time = layer.time;
+    sampling_job.output = locals;
+    sampling_job.soa_mask.begin = mask;
+    sampling_job.soa_mask.end = mask + mask_size;
+    if (!sampling_job.Run()) {
+      return false;
+    }
+
+    blend_layers[i].weight = layer.weight;
+    blend_layers[i].transform = locals;
+  }
+
+  // Blends layers, a single layer being used as is.
+  Range<const math::SoaTransform> input;
+  if (e0.num_layers == 0) {
+    input = skeleton_.bind_pose();
+  } else if (e0.num_layers == 1) {
+    input = blend_layers[0].transform;
+  } else {
+    const Range<math::SoaTransform> blended(
+      locals_ + kMaxLayers * num_soa_joints, num_soa_joints);
+    BlendingJob blending_job;
+    blending_job.layers.begin = blend_layers;
+    blending_job.layers.end = blend_layers + e0.num_layers;
+    blending_job.bind_pose = skeleton_.bind_pose();
+    blending_job.output = blended;
+    if (!blending_job.Run()) {
+      return false;
+    }
+    input = blended;
+  }
+
+  // Computes model-space matrices of the evaluated joints only.
+  if (_joints.begin) {
+    SparseLocalToModelJob ltm_job;
+    ltm_job.skeleton = &skeleton_;
+    ltm_job.joints = _joints;
+    ltm_job.input = input;
+    ltm_job.output = _models;
+    return ltm_job.Run();
+  }
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = &skeleton_;
+  ltm_job.input = input;
+  ltm_job.output = _models;
+  return ltm_job.Run();
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,312 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/procedural_jobs.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+JiggleJob::JiggleJob()
+    : delta_time(0.f),
+      stiffness(100.f),
+      damping(10.f),
+      reset(false) {
+}
+
+bool JiggleJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  valid &= delta_time >= 0.f;
+  valid &= stiffness > 0.f;
+  valid &= damping >= 0.f;
+
+  // Test for NULL begin pointers.
+  valid &= input.begin != NULL;
+  valid &= state.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= input.end >= input.begin;
+  valid &= state.end >= state.begin;
+  valid &= output.end >= output.begin;
+
+  // The input pose defines the number of soa joints to process.
+  const ptrdiff_t min_range = input.end - input.begin;
+  valid &= state.end - state.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  // Joint weights are optional.
+  if (joint_weights.begin) {
+    valid &= joint_weights.end - joint_weights.begin >= min_range;
+  } else {
+    valid &= joint_weights.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+// Integrates the spring of component _x, whose velocity is _v, towards
+// _target with an implicit Euler step. Solving the step for the new velocity
+// gives v' = (v + dt * k * (target - x)) / (1 + dt * c + dt^2 * k), where
+// _dt_k is dt * k and _inv_den is the inverse of the denominator.
+OZZ_INLINE void Spring(math::SimdFloat4 _target,
+                       math::SimdFloat4 _dt,
+                       math::SimdFloat4 _dt_k,
+                       math::SimdFloat4 _inv_den,
+                       math::SimdFloat4* _x,
+                       math::SimdFloat4* _v) {
+  *_v = (*_v + _dt_k * (_target - *_x)) * _inv_den;
+  *_x = *_x + _dt * *_v;
+}
+
+// Defines the spring integration constants shared by all joints, see Spring().
+struct SpringConstants {
+  SpringConstants(float _delta_time, float _stiffness, float _damping)
+      : dt(math::simd_float4::Load1(_delta_time)),
+        dt_k(math::simd_float4::Load1(_delta_time * _stiffness)),
+        inv_den(math::simd_float4::Load1(
+          1.f / (1.f + _delta_time * _damping +
+                 _delta_time * _delta_time * _stiffness))) {
+  }
+  math::SimdFloat4 dt;
+  math::SimdFloat4 dt_k;
+  math::SimdFloat4 inv_den;
+};
+
+// Updates the springs of the soa joints of _input, whose state is _state, and
+// outputs the spring pose blended with optional _joint_weights. Arguments are
+// expected to be valid.
+void Jiggle(const SpringConstants& _constants,
+            bool _reset,
+            const math::SimdFloat4* _joint_weights,
+            Range<const math::SoaTransform> _input,
+            SoaJiggleState* _state,
+            math::SoaTransform* _output) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 dt = _constants.dt;
+  const math::SimdFloat4 dt_k = _constants.dt_k;
+  const math::SimdFloat4 inv_den = _constants.inv_den;
+
+  const ptrdiff_t num_soa_joints = _input.end - _input.begin;
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    const math::SoaTransform& in = _input.begin[i];
+    SoaJiggleState& spring = _state[i];
+
+    if (_reset) {
+      const math::SoaFloat3 zero3 = {zero, zero, zero};
+      const math::SoaQuaternion zero4 = {zero, zero, zero, zero};
+      spring.translation = in.translation;
+      spring.translation_velocity = zero3;
+      spring.rotation = in.rotation;
+      spring.rotation_velocity = zero4;
+    } else {
+      Spring(in.translation.x, dt, dt_k, inv_den,
+             &spring.translation.x, &spring.translation_velocity.x);
+      Spring(in.translation.y, dt, dt_k, inv_den,
+             &spring.translation.y, &spring.translation_velocity.y);
+      Spring(in.translation.z, dt, dt_k, inv_den,
+             &spring.translation.z, &spring.translation_velocity.z);
+
+      // Input rotation is moved to the spring rotation hemisphere, so that
+      // the spring follows the shortest path.
+      const math::SimdFloat4 dot =
+        in.rotation.x * spring.rotation.x + in.rotation.y * spring.rotation.y +
+        in.rotation.z * spring.rotation.z + in.rotation.w * spring.rotation.w;
+      const math::SimdInt4 sign = math::Sign(dot);
+      math::SoaQuaternion& rotation = spring.rotation;
+      math::SoaQuaternion& velocity = spring.rotation_velocity;
+      Spring(math::Xor(in.rotation.x, sign), dt, dt_k, inv_den,
+             &rotation.x, &velocity.x);
+      Spring(math::Xor(in.rotation.y, sign), dt, dt_k, inv_den,
+             &rotation.y, &velocity.y);
+      Spring(math::Xor(in.rotation.z, sign), dt, dt_k, inv_den,
+             &rotation.z, &velocity.z);
+      Spring(math::Xor(in.rotation.w, sign), dt, dt_k, inv_den,
+             &rotation.w, &velocity.w);
+      rotation = math::NormalizeEst(rotation);
+    }
+
+    // Blends from the input to the spring pose.
+    math::SoaTransform& out = _output[i];
+    if (_joint_weights) {
+      const math::SimdFloat4 weight = math::Max0(_joint_weights[i]);
+      out.translation = math::Lerp(in.translation, spring.translation, weight);
+      const math::SimdInt4 sign = math::Sign(
+        in.rotation.x * spring.rotation.x + in.rotation.y * spring.rotation.y +
+        in.rotation.z * spring.rotation.z + in.rotation.w * spring.rotation.w);
+      const math::SoaQuaternion rotation = {
+        math::Xor(spring.rotation.x, sign), math::Xor(spring.rotation.y, sign),
+        math::Xor(spring.rotation.z, sign), math::Xor(spring.rotation.w, sign)};
+      out.rotation = math::NLerpEst(in.rotation, rotation, weight);
+    } else {
+      out.translation = spring.translation;
+      out.rotation = spring.rotation;
+    }
+    out.scale = in.scale;
+  }
+}
+}  // namespace
+
+bool JiggleJob::Run() const {
+  OZZ_PROFILE_SCOPE("JiggleJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const SpringConstants constants(delta_time, stiffness, damping);
+  Jiggle(constants, reset, joint_weights.begin, input, state.begin,
+         output.begin);
+
+  return true;
+}
+
+BatchJiggleJob::BatchJiggleJob()
+    : delta_time(0.f),
+      stiffness(100.f),
+      damping(10.f) {
+}
+
+BatchJiggleJob::Item::Item()
+    : reset(false) {
+}
+
+bool BatchJiggleJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test items range, implicitly tests for NULL end pointers.
+  valid &= items.begin != NULL;
+  valid &= items.end >= items.begin;
+
+  // Validates each item.
+  for (const Item* item = items.begin;
+       items.begin && item < items.end;  // Handles NULL pointers.
+       ++item) {
+    JiggleJob job;
+    job.delta_time = delta_time;
+    job.stiffness = stiffness;
+    job.damping = damping;
+    job.joint_weights = item->joint_weights;
+    job.input = item->input;
+    job.state = item->state;
+    job.output = item->output;
+    valid &= job.Validate();
+  }
+
+  return valid;
+}
+
+bool BatchJiggleJob::Run() const {
+  OZZ_PROFILE_SCOPE("BatchJiggleJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const SpringConstants constants(delta_time, stiffness, damping);
+  for (const Item* item = items.begin; item < items.end; ++item) {
+    Jiggle(constants, item->reset, item->joint_weights.begin, item->input,
+           item->state.begin, item->output.begin);
+  }
+
+  return true;
+}
+
+LeanJob::LeanJob()
+    : axis(math::Float3::x_axis()),
+      angle(0.f) {
+}
+
+bool LeanJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  valid &= math::IsNormalized(axis);
+
+  // Test for NULL begin pointers.
+  valid &= joint_weights.begin != NULL;
+  valid &= input.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= joint_weights.end >= joint_weights.begin;
+  valid &= input.end >= input.begin;
+  valid &= output.end >= output.begin;
+
+  // The input pose defines the number of soa joints to process.
+  const ptrdiff_t min_range = input.end - input.begin;
+  valid &= joint_weights.end - joint_weights.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  return valid;
+}
+
+bool LeanJob::Run() const {
+  OZZ_PROFILE_SCOPE("LeanJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // The rotation of every joint is interpolated from identity to the whole
+  // lean rotation, which is accurate enough for the small angles of leaning.
+  const math::Quaternion lean = math::Quaternion::FromAxisAngle(
+    math::Float4(axis, angle));
+  const math::SimdFloat4 x = math::simd_float4::Load1(lean.x);
+  const math::SimdFloat4 y = math::simd_float4::Load1(lean.y);
+  const math::SimdFloat4 z = math::simd_float4::Load1(lean.z);
+  const math::SimdFloat4 w = math::simd_float4::Load1(lean.w);
+  const math::SimdFloat4 one = math::simd_float4::one();
+
+  const ptrdiff_t num_soa_joints = input.end - input.begin;
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    const math::SimdFloat4 weight = math::Max0(joint_weights.begin[i]);
+    const math::SoaQuaternion rotation = {
+      x * weight, y * weight, z * weight, (w - one) * weight + one};
+
+    // Rotates in parent space, before the joint local rotation.
+    const math::SoaTransform& in = input.begin[i];
+    math::SoaTransform& out = output.begin[i];
+    out.translation = in.translation;
+    out.rotation = math::NormalizeEst(rotation) * in.rotation;
+    out.scale = in.scale;
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
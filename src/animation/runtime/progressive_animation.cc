@@ -0,0 +1,137 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/progressive_animation.h"
+
+#include <cassert>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/archive_container.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+namespace ozz {
+namespace animation {
+
+ProgressiveAnimation::ProgressiveAnimation()
+    : num_levels_(0),
+      num_resident_levels_(0) {
+}
+
+ProgressiveAnimation::~ProgressiveAnimation() {
+  Reset(0);
+}
+
+void ProgressiveAnimation::Reset(int _num_levels) {
+  assert(_num_levels >= 0);
+  ReleaseLevels(0);
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(levels_);
+  levels_ = allocator->AllocateRange<Animation*>(_num_levels);
+  for (int i = 0; i < _num_levels; ++i) {
+    levels_.begin[i] = NULL;
+  }
+  num_levels_ = _num_levels;
+}
+
+const Animation* ProgressiveAnimation::level(int _level) const {
+  if (_level < 0 || _level >= num_resident_levels_) {
+    return NULL;
+  }
+  return levels_.begin[_level];
+}
+
+bool ProgressiveAnimation::PushLevel(Animation* _animation) {
+  if (!_animation || num_resident_levels_ >= num_levels_) {
+    return false;
+  }
+  // All levels are the same clip.
+  if (num_resident_levels_) {
+    const Animation* first = levels_.begin[0];
+    if (_animation->duration() != first->duration() ||
+        _animation->num_tracks() != first->num_tracks()) {
+      return false;
+    }
+  }
+  levels_.begin[num_resident_levels_++] = _animation;
+  return true;
+}
+
+bool ProgressiveAnimation::LoadLevel(io::IContainer<Animation>* _container) {
+  if (!_container || !_container->valid()) {
+    return false;
+  }
+  if (!num_resident_levels_) {
+    Reset(_container->count());
+  }
+  if (num_resident_levels_ >= num_levels_) {
+    return false;
+  }
+  memory::Allocator* allocator = memory::default_allocator();
+  Animation* animation = allocator->New<Animation>();
+  if (!_container->Load(num_resident_levels_, animation) ||
+      !PushLevel(animation)) {
+    allocator->Delete(animation);
+    return false;
+  }
+  return true;
+}
+
+void ProgressiveAnimation::ReleaseLevels(int _num_levels) {
+  assert(_num_levels >= 0);
+  memory::Allocator* allocator = memory::default_allocator();
+  while (num_resident_levels_ > _num_levels) {
+    Animation*& animation = levels_.begin[--num_resident_levels_];
+    allocator->Delete(animation);
+    animation = NULL;
+  }
+}
+
+bool ProgressiveAnimation::Save(io::OArchive* _archive) const {
+  if (!_archive || num_resident_levels_ != num_levels_) {
+    return false;
+  }
+  io::OContainer<Animation> container(_archive, num_levels_);
+  for (int i = 0; i < num_levels_; ++i) {
+    container << *levels_.begin[i];
+  }
+  return true;
+}
+
+size_t ProgressiveAnimation::size() const {
+  size_t size = sizeof(*this) + levels_.Size();
+  for (int i = 0; i < num_resident_levels_; ++i) {
+    size += levels_.begin[i]->size();
+  }
+  return size;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,128 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/retarget_job.h"
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/animation/runtime/retarget_table.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+RetargetJob::RetargetJob()
+    : table(NULL) {
+}
+
+bool RetargetJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  if (!table) {
+    return false;
+  }
+  valid &= input.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test input and output ranges, implicitly tests for NULL end pointers.
+  valid &= input.end - input.begin >= (table->num_source_joints() + 3) / 4;
+  valid &= output.end - output.begin >= table->num_soa_joints();
+
+  return valid;
+}
+
+namespace {
+// Number of floats of a SoaTransform, 10 components of 4 lanes.
+const int kSoaTransformFloats = 10 * 4;
+OZZ_STATIC_ASSERT(sizeof(math::SoaTransform) ==
+                  kSoaTransformFloats * sizeof(float));
+
+// Identity transform components, gathered by unmapped joints.
+const float kIdentity[10] = {0.f, 0.f, 0.f,
+                             0.f, 0.f, 0.f, 1.f,
+                             1.f, 1.f, 1.f};
+}  // namespace
+
+bool RetargetJob::Run() const {
+  OZZ_PROFILE_SCOPE("RetargetJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const float* input_floats = reinterpret_cast<const float*>(input.begin);
+  const uint16_t* sources = table->sources().begin;
+  const RetargetTable::SoaCorrection* corrections =
+    table->corrections().begin;
+  const int num_soa_joints = table->num_soa_joints();
+  for (int i = 0; i < num_soa_joints; ++i) {
+    // Finds the components of the source transform of every lane. Source
+    // components are 4 floats apart in soa transforms.
+    const float* lanes[4];
+    int strides[4];
+    for (int j = 0; j < 4; ++j) {
+      const int source = sources[i * 4 + j];
+      if (source == Skeleton::kNoParentIndex) {
+        lanes[j] = kIdentity;
+        strides[j] = 1;
+      } else {
+        lanes[j] =
+          input_floats + (source / 4) * kSoaTransformFloats + (source & 3);
+        strides[j] = 4;
+      }
+    }
+
+    // Gathers source components to soa.
+    math::SimdFloat4 gathered[10];
+    for (int c = 0; c < 10; ++c) {
+      gathered[c] = math::simd_float4::Load(lanes[0][c * strides[0]],
+                                            lanes[1][c * strides[1]],
+                                            lanes[2][c * strides[2]],
+                                            lanes[3][c * strides[3]]);
+    }
+    const math::SoaFloat3 translation = {gathered[0], gathered[1], gathered[2]};
+    const math::SoaQuaternion rotation =
+      {gathered[3], gathered[4], gathered[5], gathered[6]};
+    const math::SoaFloat3 scale = {gathered[7], gathered[8], gathered[9]};
+
+    // Applies bind pose corrections.
+    const RetargetTable::SoaCorrection& correction = corrections[i];
+    math::SoaTransform& out = output.begin[i];
+    out.translation =
+      correction.translation + translation * correction.translation_ratio;
+    out.rotation = correction.rotation * rotation;
+    out.scale = correction.scale * scale;
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,108 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/retarget_table.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/maths/simd_math_archive.h"
+#include "ozz/base/maths/soa_math_archive.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+RetargetTable::RetargetTable()
+    : sources_(NULL),
+      corrections_(NULL),
+      num_joints_(0),
+      num_source_joints_(0) {
+}
+
+RetargetTable::~RetargetTable() {
+  Destroy();
+}
+
+void RetargetTable::Allocate(int _num_joints, int _num_source_joints) {
+  assert(!sources_ && !corrections_);
+  num_joints_ = _num_joints;
+  num_source_joints_ = _num_source_joints;
+  memory::Allocator* allocator = memory::default_allocator();
+  sources_ = allocator->Allocate<uint16_t>(num_soa_joints() * 4);
+  corrections_ = allocator->Allocate<SoaCorrection>(num_soa_joints());
+}
+
+void RetargetTable::Destroy() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(sources_);
+  sources_ = NULL;
+  allocator->Deallocate(corrections_);
+  corrections_ = NULL;
+  num_joints_ = 0;
+  num_source_joints_ = 0;
+}
+
+void RetargetTable::Save(ozz::io::OArchive& _archive) const {
+  _archive << static_cast<int32_t>(num_joints_);
+  _archive << static_cast<int32_t>(num_source_joints_);
+  _archive << ozz::io::MakeArray(sources_, num_soa_joints() * 4);
+  for (int i = 0; i < num_soa_joints(); ++i) {
+    const SoaCorrection& correction = corrections_[i];
+    _archive << correction.rotation;
+    _archive << correction.translation;
+    _archive << correction.translation_ratio;
+    _archive << correction.scale;
+  }
+}
+
+void RetargetTable::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  (void)_version;
+
+  // Destroy table in case it was already used before.
+  Destroy();
+
+  memory::ScopedTag tag(memory::kTagSkeleton);
+
+  int32_t num_joints;
+  _archive >> num_joints;
+  int32_t num_source_joints;
+  _archive >> num_source_joints;
+  Allocate(num_joints, num_source_joints);
+
+  _archive >> ozz::io::MakeArray(sources_, num_soa_joints() * 4);
+  for (int i = 0; i < num_soa_joints(); ++i) {
+    SoaCorrection& correction = corrections_[i];
+    _archive >> correction.rotation;
+    _archive >> correction.translation;
+    _archive >> correction.translation_ratio;
+    _archive >> correction.scale;
+  }
+}
+}  // animation
+}  // ozz
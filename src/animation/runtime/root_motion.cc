@@ -0,0 +1,94 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/root_motion.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/maths/math_archive.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+RootMotion::RootMotion()
+    : keys_(NULL),
+      num_keys_(0),
+      duration_(0.f) {
+}
+
+RootMotion::~RootMotion() {
+  Destroy();
+}
+
+void RootMotion::Allocate(int _num_keys) {
+  assert(!keys_);
+  num_keys_ = _num_keys;
+  keys_ = memory::default_allocator()->Allocate<Key>(_num_keys);
+}
+
+void RootMotion::Destroy() {
+  memory::default_allocator()->Deallocate(keys_);
+  keys_ = NULL;
+  num_keys_ = 0;
+  duration_ = 0.f;
+}
+
+void RootMotion::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_keys_);
+  for (int i = 0; i < num_keys_; ++i) {
+    const Key& key = keys_[i];
+    _archive << key.time;
+    _archive << key.translation;
+    _archive << key.yaw;
+  }
+}
+
+void RootMotion::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  (void)_version;
+
+  // Destroy motion in case it was already used before.
+  Destroy();
+
+  memory::ScopedTag tag(memory::kTagAnimation);
+
+  _archive >> duration_;
+  int32_t num_keys;
+  _archive >> num_keys;
+  Allocate(num_keys);
+  for (int i = 0; i < num_keys_; ++i) {
+    Key& key = keys_[i];
+    _archive >> key.time;
+    _archive >> key.translation;
+    _archive >> key.yaw;
+  }
+}
+}  // animation
+}  // ozz
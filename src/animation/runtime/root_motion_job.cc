@@ -0,0 +1,147 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/root_motion_job.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/vec_float.h"
+
+#include "ozz/animation/runtime/root_motion.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+RootMotionJob::RootMotionJob()
+    : motion(NULL),
+      from(0.f),
+      to(0.f),
+      loop(false),
+      translation(NULL),
+      yaw(NULL) {
+}
+
+bool RootMotionJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+  valid &= motion != NULL;
+  valid &= translation != NULL;
+  valid &= yaw != NULL;
+  return valid;
+}
+
+namespace {
+// Compares key time with a time value, used to search keys.
+struct KeyTimeLess {
+  bool operator()(float _time, const RootMotion::Key& _key) const {
+    return _time < _key.time;
+  }
+};
+
+// Samples _motion translation and yaw at _time.
+void Sample(const RootMotion& _motion, float _time,
+            math::Float3* _translation, float* _yaw) {
+  Range<const RootMotion::Key> keys = _motion.keys();
+  if (keys.begin == keys.end) {
+    *_translation = math::Float3::zero();
+    *_yaw = 0.f;
+    return;
+  }
+
+  // Finds the first key after _time, and interpolates with the previous one.
+  const RootMotion::Key* right =
+      std::upper_bound(keys.begin, keys.end, _time, KeyTimeLess());
+  if (right == keys.begin) {
+    *_translation = right->translation;
+    *_yaw = right->yaw;
+  } else if (right == keys.end) {
+    *_translation = keys.end[-1].translation;
+    *_yaw = keys.end[-1].yaw;
+  } else {
+    const RootMotion::Key* left = right - 1;
+    const float alpha = (_time - left->time) / (right->time - left->time);
+    *_translation = Lerp(left->translation, right->translation, alpha);
+    *_yaw = left->yaw + (right->yaw - left->yaw) * alpha;
+  }
+}
+
+// Computes the delta between _from and _to times.
+void Delta(const RootMotion& _motion, float _from, float _to,
+           math::Float3* _translation, float* _yaw) {
+  math::Float3 from_translation, to_translation;
+  float from_yaw, to_yaw;
+  Sample(_motion, _from, &from_translation, &from_yaw);
+  Sample(_motion, _to, &to_translation, &to_yaw);
+
+  // Expresses translation in the root frame at _from time.
+  const math::Float3 delta = to_translation - from_translation;
+  const float c = std::cos(from_yaw);
+  const float s = std::sin(from_yaw);
+  *_translation = math::Float3(delta.x * c - delta.z * s, delta.y,
+                               delta.x * s + delta.z * c);
+  *_yaw = to_yaw - from_yaw;
+}
+}  // namespace
+
+bool RootMotionJob::Run() const {
+  OZZ_PROFILE_SCOPE("RootMotionJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const float duration = motion->duration();
+  const float clamped_from = math::Clamp(0.f, from, duration);
+  const float clamped_to = math::Clamp(0.f, to, duration);
+
+  if (!loop || clamped_to >= clamped_from) {
+    Delta(*motion, clamped_from, clamped_to, translation, yaw);
+    return true;
+  }
+
+  // Loops over the end of the track, the delta from the beginning is
+  // accumulated after the delta to the end.
+  math::Float3 end_translation, begin_translation;
+  float end_yaw, begin_yaw;
+  Delta(*motion, clamped_from, duration, &end_translation, &end_yaw);
+  Delta(*motion, 0.f, clamped_to, &begin_translation, &begin_yaw);
+  const float c = std::cos(end_yaw);
+  const float s = std::sin(end_yaw);
+  *translation = math::Float3(
+      end_translation.x + begin_translation.x * c + begin_translation.z * s,
+      end_translation.y + begin_translation.y,
+      end_translation.z - begin_translation.x * s + begin_translation.z * c);
+  *yaw = end_yaw + begin_yaw;
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,245 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sample_blend_job.h"
+
+#include <cstddef>
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/blending_pass.h"
+
+namespace ozz {
+namespace animation {
+
+SampleBlendJob::Layer::Layer()
+    : time(0.f),
+      animation(NULL),
+      cache(NULL),
+      weight(0.f) {
+}
+
+SampleBlendJob::SampleBlendJob()
+    : threshold(.1f),
+      fast_normalization(false) {
+}
+
+bool SampleBlendJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
+
+  // Test for NULL begin pointers.
+  valid &= layers.begin != NULL;
+  valid &= bind_pose.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= layers.end >= layers.begin;
+  valid &= bind_pose.end >= bind_pose.begin;
+  valid &= output.end >= output.begin;
+
+  // The bind pose size defines the ranges of transforms to process, so all
+  // other buffers should be bigger.
+  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
+  valid &= output.end - output.begin >= min_range;
+
+  // Validates layers.
+  for (const Layer* layer = layers.begin;
+       layers.begin && layer < layers.end;  // Handles NULL pointers.
+       ++layer) {
+    // Tests animation and cache validity.
+    if (!layer->animation || !layer->cache) {
+      return false;
+    }
+    valid &= SamplingJob::IsCompatible(*layer->animation, *layer->cache);
+
+    // Joint weights are optional.
+    if (layer->joint_weights.begin != NULL) {
+      valid &= layer->joint_weights.end >= layer->joint_weights.begin;
+      valid &= layer->joint_weights.end - layer->joint_weights.begin >=
+               min_range;
+    } else {
+      valid &= layer->joint_weights.end == NULL;
+    }
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Defines the number of soa joints processed by chunk. Chunks are aligned on
+// mask bytes, so that a layer chunk mask is a single byte. This is also small
+// enough for a chunk of all intermediate data to remain in L1 cache.
+const int kChunkSize = 8;
+
+// Computes _layer weights of soa joints [_begin,_end[ to _weights, and returns
+// the mask of the soa joints that have a weight, one bit per soa joint.
+unsigned char ComputeWeights(const SampleBlendJob::Layer& _layer,
+                             int _begin,
+                             int _end,
+                             math::SimdFloat4* _weights) {
+  const math::SimdFloat4 layer_weight =
+    math::simd_float4::Load1(_layer.weight);
+  if (!_layer.joint_weights.begin) {
+    for (int i = _begin; i < _end; ++i) {
+      _weights[i - _begin] = layer_weight;
+    }
+    return static_cast<unsigned char>((1 << (_end - _begin)) - 1);
+  }
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  unsigned char mask = 0;
+  for (int i = _begin; i < _end; ++i) {
+    const math::SimdFloat4 weight =
+      layer_weight * math::Max0(_layer.joint_weights.begin[i]);
+    _weights[i - _begin] = weight;
+    if (!math::AreAllFalse(math::CmpGt(weight, zero))) {
+      mask |= 1 << (i - _begin);
+    }
+  }
+  return mask;
+}
+
+// Gets the number of soa joints sampled for _layer, which can't exceed
+// _num_soa_joints.
+int NumSampledJoints(const SampleBlendJob::Layer& _layer, int _num_soa_joints) {
+  return math::Min(_layer.animation->num_soa_tracks(), _num_soa_joints);
+}
+}  // namespace
+
+bool SampleBlendJob::Run() const {
+  OZZ_PROFILE_SCOPE("SampleBlendJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_joints = static_cast<int>(bind_pose.end - bind_pose.begin);
+  assert(num_soa_joints <= Skeleton::kMaxSoAJoints);
+
+  // Mask of the soa joints to sample, one bit per soa joint. Chunks are
+  // aligned on mask bytes.
+  unsigned char mask[(Skeleton::kMaxSoAJoints + 7) / 8];
+  OZZ_STATIC_ASSERT(kChunkSize == 8);
+
+  // Prepares the cache of every relevant layer, only for the soa joints that
+  // have a weight.
+  math::SimdFloat4 weights[kChunkSize];
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    const int num_sampled = NumSampledJoints(*layer, num_soa_joints);
+    if (layer->weight <= 0.f || num_sampled == 0) {
+      continue;
+    }
+    const int num_bytes = (layer->animation->num_soa_tracks() + 7) / 8;
+    for (int i = 0; i < num_bytes; ++i) {
+      const int begin = i * kChunkSize;
+      const int end = math::Min(begin + kChunkSize, num_sampled);
+      mask[i] = begin < end ? ComputeWeights(*layer, begin, end, weights) : 0;
+    }
+    SamplingJob::Prepare(*layer->animation, layer->time, mask,
+                         layer->animation->num_soa_tracks(), layer->cache);
+  }
+
+  // Samples and blends chunk by chunk.
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 simd_threshold = math::simd_float4::Load1(threshold);
+  const math::SoaQuaternion zero_rotation = {zero, zero, zero, zero};
+  math::SoaTransform samples[kChunkSize];
+  math::SimdFloat4 accumulated_weights[kChunkSize];
+  for (int begin = 0; begin < num_soa_joints; begin += kChunkSize) {
+    const int end = math::Min(begin + kChunkSize, num_soa_joints);
+    math::SoaTransform* dest = output.begin + begin;
+
+    // Clears the chunk, so that all layers can be accumulated the same way.
+    for (int i = 0; i < end - begin; ++i) {
+      accumulated_weights[i] = zero;
+      dest[i].translation = math::SoaFloat3::zero();
+      dest[i].rotation = zero_rotation;
+      dest[i].scale = math::SoaFloat3::zero();
+    }
+
+    // Samples and accumulates every layer.
+    for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+      const int layer_end =
+        math::Min(end, NumSampledJoints(*layer, num_soa_joints));
+      if (layer->weight <= 0.f || begin >= layer_end) {
+        continue;
+      }
+      unsigned char& chunk_mask = mask[begin / kChunkSize];
+      chunk_mask = ComputeWeights(*layer, begin, layer_end, weights);
+      if (!chunk_mask) {
+        continue;
+      }
+      SamplingJob::Interpolate(
+        *layer->animation, *layer->cache,
+        SamplingJob::KeyTime(*layer->animation, layer->time),
+        begin, layer_end, mask, fast_normalization, samples);
+      for (int i = 0; i < layer_end - begin; ++i) {
+        if (chunk_mask & (1 << i)) {
+          accumulated_weights[i] = accumulated_weights[i] + weights[i];
+          math::SoaTransform* out = dest + i;
+          OZZ_BLEND_N_PASS(samples[i], weights[i], true, out);
+        }
+      }
+    }
+
+    // Blends the bind pose where the accumulated weight is less than the
+    // threshold, and normalizes.
+    for (int i = 0; i < end - begin; ++i) {
+      math::SoaTransform* out = dest + i;
+      const math::SimdFloat4 bp_weight =
+        math::Max0(simd_threshold - accumulated_weights[i]);
+      OZZ_BLEND_N_PASS(bind_pose.begin[begin + i], bp_weight, true, out);
+      const math::SimdFloat4 ratio =
+        one / math::Max(simd_threshold, accumulated_weights[i]);
+      out->rotation = fast_normalization ? NormalizeFastEst(out->rotation) :
+                                           NormalizeEst(out->rotation);
+      out->translation = out->translation * ratio;
+      out->scale = out->scale * ratio;
+    }
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,163 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sample_to_model_job.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_dispatch.h"
+#include "ozz/base/maths/simd_float4x3.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/local_to_model_pass.h"
+
+namespace ozz {
+namespace animation {
+
+SampleToModelJob::SampleToModelJob()
+    : time(0.f),
+      animation(NULL),
+      cache(NULL),
+      skeleton(NULL),
+      num_joints_lod(Skeleton::kMaxJoints),
+      fast_normalization(false) {
+}
+
+bool SampleToModelJob::Validate() const {
+  // Test for NULL pointers.
+  if (!animation || !cache || !skeleton) {
+    return false;
+  }
+
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  const int num_joints = skeleton->num_joints();
+  valid &= animation->num_soa_tracks() >= skeleton->num_soa_joints();
+  valid &= SamplingJob::IsCompatible(*animation, *cache);
+
+  // Exactly one of the output ranges must be specified. Tests output ranges,
+  // implicitly tests for NULL end pointers.
+  valid &= (output.begin != NULL) != (output_4x3.begin != NULL);
+  if (output.begin != NULL) {
+    valid &= output.end - output.begin >= num_joints;
+  } else {
+    valid &= output_4x3.end - output_4x3.begin >= num_joints;
+  }
+
+  valid &= num_joints_lod >= 0;
+
+  return valid;
+}
+
+namespace {
+
+// Defines the number of soa joints sampled by chunk, small enough for the
+// chunk samples to remain in L1 cache until they are converted.
+const int kChunkSize = 8;
+}  // namespace
+
+template <typename _Matrix>
+OZZ_SIMD_DISPATCH
+void SampleToModelJob::RunChunks(int _num_joints,
+                                 _Matrix* _model_matrices) const {
+  Range<const Skeleton::JointProperties> properties =
+    skeleton->joint_properties();
+  const float key_time = SamplingJob::KeyTime(*animation, time);
+  const bool scaled = animation->scaled();
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const _Matrix identity = _Matrix::identity();
+
+  const int num_soa_joints = (_num_joints + 3) / 4;
+  math::SoaTransform samples[kChunkSize];
+  for (int begin = 0; begin < num_soa_joints; begin += kChunkSize) {
+    const int end = math::Min(begin + kChunkSize, num_soa_joints);
+    SamplingJob::Interpolate(*animation, *cache, key_time, begin, end, NULL,
+                             fast_normalization, samples);
+
+    // Converts to matrices and applies hierarchical transformation. Parents
+    // are always before their children, so they are already computed.
+    for (int soa = begin; soa < end; ++soa) {
+      _Matrix local_aos_matrices[4];
+      internal::ToAosMatrices(samples[soa - begin], scaled,
+                              local_aos_matrices);
+      const int joint_begin = soa * 4;
+      const int joint_end = math::Min(joint_begin + 4, _num_joints);
+      for (int joint = joint_begin; joint < joint_end; ++joint) {
+        const int parent = properties.begin[joint].parent;
+        const _Matrix* parent_matrix =
+          math::Select(parent == Skeleton::kNoParentIndex,
+                       &identity,
+                       &_model_matrices[parent]);
+        _model_matrices[joint] =
+          (*parent_matrix) * local_aos_matrices[joint & 3];
+      }
+    }
+  }
+}
+
+bool SampleToModelJob::Run() const {
+  OZZ_PROFILE_SCOPE("SampleToModelJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no joint.
+  const int num_joints = math::Min(skeleton->num_joints(), num_joints_lod);
+  if (num_joints == 0) {
+    return true;
+  }
+
+  // Steps the cache and fetches the keys of the processed soa joints only.
+  const int num_soa_joints = (num_joints + 3) / 4;
+  assert(num_soa_joints <= animation->num_soa_tracks());
+  SamplingJob::Prepare(*animation, time, NULL, num_soa_joints, cache);
+
+  // Dispatches to the output matrix type.
+  if (output.begin != NULL) {
+    RunChunks(num_joints, output.begin);
+  } else {
+    RunChunks(num_joints, output_4x3.begin);
+  }
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,111 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sampling_cache_pool.h"
+
+#include <cassert>
+#include <new>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/sampling_job.h"
+
+namespace ozz {
+namespace animation {
+
+SamplingCachePool::SamplingCachePool(int _max_tracks, int _capacity,
+                                     bool _compact)
+    : max_tracks_(_max_tracks),
+      capacity_(_capacity),
+      compact_(_compact),
+      slab_(NULL),
+      caches_(NULL),
+      free_(NULL),
+      num_free_(_capacity) {
+  assert(_capacity >= 0);
+
+  // Computes slab layout: caches, free list and then caches buffers.
+  const size_t alignment = SamplingCache::kBufferAlignment;
+  const size_t buffer_size =
+    math::Align(SamplingCache::buffer_size(_max_tracks, _compact), alignment);
+  const size_t caches_size = sizeof(SamplingCache) * _capacity;
+  const size_t free_offset = math::Align(caches_size, AlignOf<int>::value);
+  const size_t buffers_offset =
+    math::Align(free_offset + sizeof(int) * _capacity, alignment);
+  const size_t size = buffers_offset + buffer_size * _capacity;
+
+  memory::ScopedTag tag(memory::kTagCache);
+  memory::Allocator* allocator = memory::default_allocator();
+  slab_ = reinterpret_cast<char*>(allocator->Allocate(
+    size, math::Max(alignment,
+                    static_cast<size_t>(AlignOf<SamplingCache>::value))));
+
+  caches_ = reinterpret_cast<SamplingCache*>(slab_);
+  free_ = reinterpret_cast<int*>(slab_ + free_offset);
+  for (int i = 0; i < _capacity; ++i) {
+    new(caches_ + i) SamplingCache(_max_tracks,
+                                   slab_ + buffers_offset + buffer_size * i,
+                                   buffer_size,
+                                   _compact);
+    // Caches are acquired in order.
+    free_[i] = _capacity - i - 1;
+  }
+}
+
+SamplingCachePool::~SamplingCachePool() {
+  assert(num_free_ == capacity_ && "All caches must be released.");
+  for (int i = 0; i < capacity_; ++i) {
+    caches_[i].~SamplingCache();
+  }
+  memory::default_allocator()->Deallocate(slab_);
+}
+
+SamplingCache* SamplingCachePool::Acquire() {
+  if (!num_free_) {
+    return NULL;
+  }
+  return caches_ + free_[--num_free_];
+}
+
+void SamplingCachePool::Release(SamplingCache* _cache) {
+  if (!_cache) {
+    return;
+  }
+  assert(_cache >= caches_ && _cache < caches_ + capacity_ &&
+         "Cache doesn't belong to this pool.");
+  assert(num_free_ < capacity_);
+
+  // Invalidates the cache, as it's likely to be reused for another animation.
+  _cache->Invalidate();
+  free_[num_free_++] = static_cast<int>(_cache - caches_);
+}
+}  // animation
+}  // ozz
@@ -31,11 +31,22 @@
 #include "ozz/animation/runtime/sampling_job.h"
 
 #include <cassert>
+#include <cstring>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_BitScanForward)
+#endif  // _MSC_VER
 
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_dispatch.h"
+#include "ozz/base/maths/simd_float8.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/profile.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
@@ -57,8 +68,33 @@ struct InterpSoaScale {
   math::SimdFloat4 time[2];
   math::SoaFloat3 value[2];
 };
+// Tangents of the left and right keys of Hermite animations, scaled to the
+// time range of these keys.
+struct InterpSoaTangents {
+  math::SoaFloat3 translation[2];
+  math::SoaQuaternion rotation[2];
+  math::SoaFloat3 scale[2];
+};
 }  // internal
 
+bool SamplingJob::IsCompatible(const Animation& _animation,
+                               const SamplingCache& _cache) {
+  bool valid = true;
+
+  // Tests cache size.
+  valid &= _cache.max_soa_tracks() >= _animation.num_soa_tracks();
+
+  // Tests that compact cache key indices can address all animation keys.
+  const size_t max_keys =
+    _cache.compact() ? static_cast<size_t>(SamplingCache::kMaxCompactKeys) :
+                       static_cast<size_t>(-1);
+  valid &= _animation.translations().Count() <= max_keys;
+  valid &= _animation.rotations().Count() <= max_keys;
+  valid &= _animation.scales().Count() <= max_keys;
+
+  return valid;
+}
+
 bool SamplingJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -75,53 +111,326 @@ bool SamplingJob::Validate() const {
   const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
   valid &= output.end - output.begin >= num_soa_tracks;
 
-  // Tests cache size.
-  valid &= cache->max_soa_tracks() >= num_soa_tracks;
+  // Tests cache size and key indices.
+  valid &= IsCompatible(*animation, *cache);
+
+  // Tests soa mask range, which is optional.
+  if (soa_mask.begin) {
+    valid &= soa_mask.end - soa_mask.begin >= (num_soa_tracks + 7) / 8;
+  } else {
+    valid &= soa_mask.end == NULL;
+  }
+
+  // Tests lod.
+  valid &= num_joints_lod >= 0;
+
+  // Tests soa update periods range, which is optional.
+  if (soa_update_periods.begin) {
+    valid &= soa_update_periods.end - soa_update_periods.begin >=
+             num_soa_tracks;
+  } else {
+    valid &= soa_update_periods.end == NULL;
+  }
+  valid &= update_frame >= 0;
+
+  // Tests velocities range, which is optional.
+  if (velocities.begin) {
+    valid &= velocities.end - velocities.begin >= num_soa_tracks;
+  } else {
+    valid &= velocities.end == NULL;
+  }
+
+  // Tests changed range, which is optional.
+  if (changed.begin) {
+    valid &= changed.end - changed.begin >= (num_soa_tracks + 7) / 8;
+  } else {
+    valid &= changed.end == NULL;
+  }
 
   return valid;
 }
 
 namespace {
+// Returns the number of soa tracks of _animation that are required to sample
+// the first _num_joints_lod joints.
+int NumSoaLod(const Animation& _animation, int _num_joints_lod) {
+  return math::Min(_animation.num_soa_tracks(), (_num_joints_lod + 3) / 4);
+}
+
+// Fills _mask with the _num_soa_tracks soa tracks whose _periods divides
+// _frame, and that are set in the optional _soa_mask.
+void UpdatePeriodsMask(const unsigned char* _periods,
+                       int _num_soa_tracks,
+                       int _frame,
+                       const unsigned char* _soa_mask,
+                       unsigned char* _mask) {
+  const int num_bytes = (_num_soa_tracks + 7) / 8;
+  std::memset(_mask, 0, num_bytes);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    const int period = _periods[i];
+    if (period <= 1 || _frame % period == 0) {
+      _mask[i / 8] |= 1 << (i & 7);
+    }
+  }
+  if (_soa_mask) {
+    for (int i = 0; i < num_bytes; ++i) {
+      _mask[i] &= _soa_mask[i];
+    }
+  }
+}
+}  // namespace
+
+namespace {
+// Hints the cpu to fetch the cache line addressed by _address, as it will be
+// accessed soon.
+OZZ_INLINE void Prefetch(const void* _address) {
+#if defined(__GNUC__)
+  __builtin_prefetch(_address);
+#elif defined(OZZ_HAS_SSEx)
+  _mm_prefetch(reinterpret_cast<const char*>(_address), _MM_HINT_T0);
+#else
+  (void)_address;
+#endif
+}
+
+// Counts the number of trailing zero bits of _value, which must not be 0.
+OZZ_INLINE int CountTrailingZeros(uint32_t _value) {
+  assert(_value != 0);
+#if defined(__GNUC__)
+  return __builtin_ctz(_value);
+#elif defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, _value);
+  return static_cast<int>(index);
+#else
+  int count = 0;
+  for (; !(_value & 1); _value >>= 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+// Iterates the outdated soa entries of _outdated flags, 32 entries at a time,
+// jumping from an outdated entry to the next one by counting trailing zeros.
+// Only the entries that are set in _mask are iterated, or all of them if
+// _mask is NULL. Flags of iterated entries are reset on the way, as they are
+// expected to be processed. Masked out entries remain outdated.
+class OutdatedIterator {
+ public:
+  OutdatedIterator(int _num_soa_tracks, unsigned char* _outdated,
+                   const unsigned char* _mask)
+      : outdated_(_outdated),
+        mask_(_mask),
+        num_flags_((_num_soa_tracks + 7) / 8),
+        offset_(0),
+        base_(0),
+        flags_(0) {
+  }
+
+  // Returns the index of the next outdated soa entry, or -1 if there's none.
+  int Next() {
+    while (!flags_) {
+      if (offset_ >= num_flags_) {
+        return -1;
+      }
+      // Loads up to 4 flag bytes at once, then resets them.
+      base_ = offset_ * 8;
+      const int end = offset_ + 4 < num_flags_ ? offset_ + 4 : num_flags_;
+      for (int shift = 0; offset_ < end; ++offset_, shift += 8) {
+        const unsigned char mask = mask_ ? mask_[offset_] : 0xff;
+        const unsigned char flags = outdated_[offset_] & mask;
+        flags_ |= static_cast<uint32_t>(flags) << shift;
+        outdated_[offset_] &= ~mask;
+      }
+    }
+    const int bit = CountTrailingZeros(flags_);
+    flags_ &= flags_ - 1;  // Clears lowest bit.
+    return base_ + bit;
+  }
+
+ private:
+  unsigned char* outdated_;
+  const unsigned char* mask_;
+  int num_flags_;
+  int offset_;
+  int base_;
+  uint32_t flags_;
+};
+
+// Prefetches the tangents of the 8 keys of the soa entry whose key indices are
+// _interp. Keys themselves don't need to be prefetched, as UpdateKeys already
+// accessed them, but tangents are only accessed when decoding soa entries.
+template<typename _Index>
+OZZ_INLINE void PrefetchTangents(const KeyTangent* _tangents,
+                                 const _Index* _interp) {
+  for (int i = 0; i < 8; ++i) {
+    Prefetch(_tangents + _interp[i]);
+  }
+}
+
+// Flags all the _num_soa_tracks soa entries as outdated. It cares to only flag
+// valid soa entries as this is the exit condition of other algorithms.
+void OutdateAll(int _num_soa_tracks, unsigned char* _outdated) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (int i = 0; i < num_outdated_flags - 1; ++i) {
+    _outdated[i] = 0xff;
+  }
+  _outdated[num_outdated_flags - 1] =
+    0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+}
+
+// Accumulates the statistics of a stream (translations, rotations or scales)
+// update to _stats: the keys consumed while moving the stream _cursor, and the
+// soa entries decoded, aka no longer flagged as outdated. The object is built
+// before keys are updated, then KeysUpdated and SoaUpdated must be called in
+// order once keys and soa entries are respectively updated.
+// Functions are empty if stats are disabled.
+class StreamStats {
+ public:
+  StreamStats(SamplingCache::Stats* _stats, int _num_soa_tracks,
+              const int* _cursor, const unsigned char* _outdated)
+#ifdef OZZ_HAS_STATS
+      : stats_(_stats),
+        num_flags_((_num_soa_tracks + 7) / 8),
+        cursor_(_cursor),
+        outdated_(_outdated),
+        begin_cursor_(*_cursor),
+        begin_outdated_(0) {
+  }
+#else  // OZZ_HAS_STATS
+  {
+    (void)_stats;
+    (void)_num_soa_tracks;
+    (void)_cursor;
+    (void)_outdated;
+  }
+#endif  // OZZ_HAS_STATS
+
+  // Called once keys are updated, before soa entries are decoded.
+  void KeysUpdated() {
+#ifdef OZZ_HAS_STATS
+    const int traversed = *cursor_ - begin_cursor_;
+    stats_->keys += traversed >= 0 ? traversed : -traversed;
+    begin_outdated_ = CountOutdated();
+#endif  // OZZ_HAS_STATS
+  }
+
+  // Called once soa entries are decoded.
+  void SoaUpdated() {
+#ifdef OZZ_HAS_STATS
+    stats_->soa_updates += begin_outdated_ - CountOutdated();
+#endif  // OZZ_HAS_STATS
+  }
+
+#ifdef OZZ_HAS_STATS
+ private:
+  // Counts soa entries flagged as outdated.
+  int CountOutdated() const {
+    int count = 0;
+    for (int i = 0; i < num_flags_; ++i) {
+      for (unsigned char flags = outdated_[i]; flags; flags &= flags - 1) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  SamplingCache::Stats* stats_;
+  int num_flags_;
+  const int* cursor_;
+  const unsigned char* outdated_;
+  int begin_cursor_;
+  int begin_outdated_;
+#endif  // OZZ_HAS_STATS
+};
+
 // Loops through the sorted key frames and update cache structure.
-template<typename _Key>
-void UpdateKeys(float _time, int _num_soa_tracks,
+// The _num_constants first keys are the single keys of constant tracks, which
+// aren't part of the sorted key frames.
+// _links are the key links of the animation, or NULL if it has none.
+// _cache key indices are of _Index type, int or uint16_t for compact caches.
+template<typename _Key, typename _Index>
+void UpdateKeys(float _time, int _num_soa_tracks, int _num_constants,
                 ozz::Range<const _Key> _keys,
+                const uint16_t* _links,
                 int* _cursor,
-                int* _cache, unsigned char* _outdated) {
+                _Index* _cache, unsigned char* _outdated) {
     assert(_num_soa_tracks >= 1);
     const int num_tracks = _num_soa_tracks * 4;
-    assert(_keys.begin + num_tracks * 2 <= _keys.end);
+    const int num_animated = num_tracks - _num_constants;
+    assert(_num_constants >= 0 && num_animated >= 0);
+    const int num_first_keys = _num_constants + num_animated * 2;
+    assert(_keys.begin + num_first_keys <= _keys.end);
+
+    if (*_cursor) {
+      // Rewinds the keys that were fetched for a time greater than _time, in
+      // the reverse order they were fetched. The last fetched key of a track
+      // is its right key, which was fetched once its left key time was
+      // reached. The left key then becomes the right one, and key links give
+      // the new left one.
+      const _Key* first = _keys.begin + num_first_keys;
+      const _Key* cursor = &_keys.begin[*_cursor];
+      while (_links && cursor > first &&
+             _keys.begin[_cache[cursor[-1].track * 2]].time > _time &&
+             _links[_cache[cursor[-1].track * 2]]) {
+        const int track = cursor[-1].track;
+        const int base = track * 2;
+        const int left = _cache[base];
+        _outdated[track / 32] |= (1 << ((track & 0x1f) / 4));
+        _cache[base + 1] = static_cast<_Index>(left);
+        _cache[base] = static_cast<_Index>(left - _links[left]);
+        --cursor;
+      }
+
+      // Without key links (or if one is missing), the cache is rewound to the
+      // first keys, which happens every cycle of a looped animation. Constant
+      // tracks never change, and only the tracks whose keys change are
+      // outdated, which spares the tracks made of their first and last keys
+      // only.
+      if (cursor > first &&
+          _keys.begin[_cache[cursor[-1].track * 2]].time > _time) {
+        const int row0 = _num_constants;
+        const int row1 = row0 + num_animated;
+        for (int i = 0; i < num_animated; ++i) {
+          const int track = _keys.begin[row0 + i].track;
+          const int base = track * 2;
+          if (_cache[base + 0] != row0 + i || _cache[base + 1] != row1 + i) {
+            _cache[base + 0] = static_cast<_Index>(row0 + i);
+            _cache[base + 1] = static_cast<_Index>(row1 + i);
+            _outdated[track / 32] |= (1 << ((track & 0x1f) / 4));
+          }
+        }
+        cursor = first;
+      }
+      *_cursor = static_cast<int>(cursor - _keys.begin);
+    }
 
     const _Key* cursor = &_keys.begin[*_cursor];
     if (!*_cursor) {
+      // Constant tracks use their single key as both left and right keys.
+      for (int i = 0; i < _num_constants; ++i) {
+        const int base = _keys.begin[i].track * 2;
+        _cache[base + 0] = static_cast<_Index>(i);
+        _cache[base + 1] = static_cast<_Index>(i);
+      }
+
       // Initializes interpolated entries with the first 2 sets of key frames.
       // The sorting algorithm ensures that the first 2 key frames of a track
-      // are consecutive.
-      for (int i = 0; i < _num_soa_tracks; ++i) {
-        const int in_index0 = i * 4;  // * soa size
-        const int in_index1 = in_index0 + num_tracks;  // 2nd row.
-        const int out_index = i * 4 * 2;   
-        _cache[out_index + 0] = in_index0 + 0;
-        _cache[out_index + 1] = in_index1 + 0;
-        _cache[out_index + 2] = in_index0 + 1;
-        _cache[out_index + 3] = in_index1 + 1;
-        _cache[out_index + 4] = in_index0 + 2;
-        _cache[out_index + 5] = in_index1 + 2;
-        _cache[out_index + 6] = in_index0 + 3;
-        _cache[out_index + 7] = in_index1 + 3;
+      // are consecutive, and sorted by track.
+      const int row0 = _num_constants;
+      const int row1 = row0 + num_animated;
+      for (int i = 0; i < num_animated; ++i) {
+        const int base = _keys.begin[row0 + i].track * 2;
+        _cache[base + 0] = static_cast<_Index>(row0 + i);
+        _cache[base + 1] = static_cast<_Index>(row1 + i);
       }
-      cursor = _keys.begin + num_tracks * 2;  // New cursor position.
+      cursor = _keys.begin + num_first_keys;  // New cursor position.
 
-      // All entries are outdated. It cares to only flag valid soa entries as
-      // this is the exit condition of other algorithms.
-      const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-      for (int i = 0; i < num_outdated_flags - 1; ++i) {
-        _outdated[i] = 0xff;
-      }
-      _outdated[num_outdated_flags - 1] =
-        0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+      // All entries are outdated.
+      OutdateAll(_num_soa_tracks, _outdated);
     } else {
-      assert(cursor >= _keys.begin + num_tracks * 2 && cursor <= _keys.end);
+      assert(cursor >= _keys.begin + num_first_keys && cursor <= _keys.end);
     }
 
     // Search for the keys that matches _time.
@@ -137,7 +446,7 @@ void UpdateKeys(float _time, int _num_soa_tracks,
       // Updates cache.
       const int base = cursor->track * 2;
       _cache[base] = _cache[base + 1];
-      _cache[base + 1] = static_cast<int>(cursor - _keys.begin);
+      _cache[base + 1] = static_cast<_Index>(cursor - _keys.begin);
       // Process next key.
       ++cursor;
     }
@@ -147,329 +456,1209 @@ void UpdateKeys(float _time, int _num_soa_tracks,
     *_cursor = static_cast<int>(cursor - _keys.begin);
 }
 
+// Loads and converts the times of 4 keys to float.
+template<typename _Key>
+OZZ_INLINE math::SimdFloat4 KeyTimes(const _Key& _k0, const _Key& _k1,
+                                     const _Key& _k2, const _Key& _k3) {
+  return math::simd_float4::FromInt(
+    math::simd_int4::Load(_k0.time, _k1.time, _k2.time, _k3.time));
+}
+
+// Constant tracks use the same key as left and right keys. Their right time is
+// offset so that interpolation ratio remains finite, which is exact as both
+// interpolated values are the same.
+OZZ_INLINE math::SimdFloat4 RightTime(math::_SimdFloat4 _left,
+                                      math::_SimdFloat4 _right) {
+  return math::Select(math::CmpEq(_left, _right),
+                      _left + math::simd_float4::one(),
+                      _right);
+}
+
+// Computes the factor that converts tangents, in value per animation duration,
+// to the time range of the interpolated keys, whose times are _time[0] and
+// _time[1] in key time unit.
+OZZ_INLINE math::SimdFloat4 TangentScale(const math::SimdFloat4* _time) {
+  return (_time[1] - _time[0]) *
+         math::simd_float4::Load1(1.f / static_cast<float>(kMaxKeyTime));
+}
+
+// Decodes component _c of the half float tangents of the 4 keys whose indices
+// are _interp[0], [2], [4] and [6], and multiplies them by _scale.
+template<typename _Index>
+OZZ_INLINE math::SimdFloat4 DecodeTangent(const KeyTangent* _tangents,
+                                          const _Index* _interp,
+                                          int _c,
+                                          math::_SimdFloat4 _scale) {
+  return _scale * math::HalfToFloat(math::simd_int4::Load(
+    _tangents[_interp[0]].value[_c], _tangents[_interp[2]].value[_c],
+    _tangents[_interp[4]].value[_c], _tangents[_interp[6]].value[_c]));
+}
+
+template<typename _Index>
+OZZ_INLINE void DecodeTangents(const KeyTangent* _tangents,
+                               const _Index* _interp,
+                               math::_SimdFloat4 _scale,
+                               math::SoaFloat3* _tangent) {
+  _tangent->x = DecodeTangent(_tangents, _interp, 0, _scale);
+  _tangent->y = DecodeTangent(_tangents, _interp, 1, _scale);
+  _tangent->z = DecodeTangent(_tangents, _interp, 2, _scale);
+}
+
+template<typename _Index>
+OZZ_INLINE void DecodeTangents(const KeyTangent* _tangents,
+                               const _Index* _interp,
+                               math::_SimdFloat4 _scale,
+                               math::SoaQuaternion* _tangent) {
+  _tangent->x = DecodeTangent(_tangents, _interp, 0, _scale);
+  _tangent->y = DecodeTangent(_tangents, _interp, 1, _scale);
+  _tangent->z = DecodeTangent(_tangents, _interp, 2, _scale);
+  _tangent->w = DecodeTangent(_tangents, _interp, 3, _scale);
+}
+
+// Loads the 4 quantized values of a translation component, and decodes them
+// with a multiply-add to their soa track range.
+OZZ_INLINE math::SimdFloat4 DecodeTranslations(uint16_t _v0, uint16_t _v1,
+                                               uint16_t _v2, uint16_t _v3,
+                                               const float* _min,
+                                               const float* _scale) {
+  return math::MAdd(
+    math::simd_float4::FromInt(math::simd_int4::Load(_v0, _v1, _v2, _v3)),
+    math::simd_float4::LoadPtrU(_scale),
+    math::simd_float4::LoadPtrU(_min));
+}
+
+// Updates outdated soa entries that aren't masked out by _mask, which is NULL
+// if all entries are sampled. _tangents is NULL for linear animations,
+// otherwise key tangents are also decoded to _soa_tangents.
+template<typename _Index>
+OZZ_SIMD_DISPATCH
 void UpdateSoaTranslations(int _num_soa_tracks,
                            ozz::Range<const TranslationKey> _keys,
-                           const int* _interp,
+                           ozz::Range<const SoaTranslationRange> _ranges,
+                           const KeyTangent* _tangents,
+                           const _Index* _interp,
                            unsigned char* _outdated,
-                           internal::InterpSoaTranslation* soa_translations_) {
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
-    for (int i = j * 8; outdated; ++i, outdated >>= 1) {
-      if (!(outdated & 1)) {
-        continue;
-      }
-      const int base = i * 4 * 2;  // * soa size * 2 keys
-
-      // Decompress left side keyframes and store them in soa structures.
-      const TranslationKey& k00 = _keys.begin[_interp[base + 0]];
-      const TranslationKey& k10 = _keys.begin[_interp[base + 2]];
-      const TranslationKey& k20 = _keys.begin[_interp[base + 4]];
-      const TranslationKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_translations_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
-      soa_translations_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      soa_translations_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_translations_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
-
-      // Decompress right side keyframes and store them in soa structures.
-      const TranslationKey& k01 = _keys.begin[_interp[base + 1]];
-      const TranslationKey& k11 = _keys.begin[_interp[base + 3]];
-      const TranslationKey& k21 = _keys.begin[_interp[base + 5]];
-      const TranslationKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_translations_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
-      soa_translations_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_translations_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_translations_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+                           const unsigned char* _mask,
+                           internal::InterpSoaTranslation* soa_translations_,
+                           internal::InterpSoaTangents* _soa_tangents) {
+  assert(_ranges.Count() >= static_cast<size_t>(_num_soa_tracks));
+  OutdatedIterator outdated(_num_soa_tracks, _outdated, _mask);
+  for (int i = outdated.Next(), next; i >= 0; i = next) {
+    // Prefetches the tangents of the next outdated entry while decoding this
+    // one.
+    next = outdated.Next();
+    if (_tangents && next >= 0) {
+      PrefetchTangents(_tangents, _interp + next * 4 * 2);
+    }
+
+    const int base = i * 4 * 2;  // * soa size * 2 keys
+    const SoaTranslationRange& range = _ranges.begin[i];
+
+    // Decompress left side keyframes and store them in soa structures.
+    const TranslationKey& k00 = _keys.begin[_interp[base + 0]];
+    const TranslationKey& k10 = _keys.begin[_interp[base + 2]];
+    const TranslationKey& k20 = _keys.begin[_interp[base + 4]];
+    const TranslationKey& k30 = _keys.begin[_interp[base + 6]];
+    soa_translations_[i].time[0] = KeyTimes(k00, k10, k20, k30);
+    soa_translations_[i].value[0].x = DecodeTranslations(
+      k00.value[0], k10.value[0], k20.value[0], k30.value[0],
+      range.min[0], range.scale[0]);
+    soa_translations_[i].value[0].y = DecodeTranslations(
+      k00.value[1], k10.value[1], k20.value[1], k30.value[1],
+      range.min[1], range.scale[1]);
+    soa_translations_[i].value[0].z = DecodeTranslations(
+      k00.value[2], k10.value[2], k20.value[2], k30.value[2],
+      range.min[2], range.scale[2]);
+
+    // Decompress right side keyframes and store them in soa structures.
+    const TranslationKey& k01 = _keys.begin[_interp[base + 1]];
+    const TranslationKey& k11 = _keys.begin[_interp[base + 3]];
+    const TranslationKey& k21 = _keys.begin[_interp[base + 5]];
+    const TranslationKey& k31 = _keys.begin[_interp[base + 7]];
+    soa_translations_[i].time[1] = RightTime(
+      soa_translations_[i].time[0],
+      KeyTimes(k01, k11, k21, k31));
+    soa_translations_[i].value[1].x = DecodeTranslations(
+      k01.value[0], k11.value[0], k21.value[0], k31.value[0],
+      range.min[0], range.scale[0]);
+    soa_translations_[i].value[1].y = DecodeTranslations(
+      k01.value[1], k11.value[1], k21.value[1], k31.value[1],
+      range.min[1], range.scale[1]);
+    soa_translations_[i].value[1].z = DecodeTranslations(
+      k01.value[2], k11.value[2], k21.value[2], k31.value[2],
+      range.min[2], range.scale[2]);
+
+    if (_tangents) {
+      const math::SimdFloat4 scale =
+        TangentScale(soa_translations_[i].time);
+      DecodeTangents(_tangents, _interp + base, scale,
+                     &_soa_tangents[i].translation[0]);
+      DecodeTangents(_tangents, _interp + base + 1, scale,
+                     &_soa_tangents[i].translation[1]);
     }
   }
 }
 
+// Decodes 4 smallest three compressed rotation keys to _quat. The dropped
+// component is restored, then put back in place with selections according to
+// its index.
+OZZ_INLINE void DecodeRotations(const RotationKey& _k0, const RotationKey& _k1,
+                                const RotationKey& _k2, const RotationKey& _k3,
+                                math::SoaQuaternion* _quat) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
+  const math::SimdFloat4 int_to_float =
+    math::simd_float4::Load1(1.f / kRotationQuantizationScale);
+
+  const math::SimdFloat4 a = int_to_float * math::simd_float4::FromInt(
+    math::simd_int4::Load(_k0.value[0], _k1.value[0],
+                          _k2.value[0], _k3.value[0]));
+  const math::SimdFloat4 b = int_to_float * math::simd_float4::FromInt(
+    math::simd_int4::Load(_k0.value[1], _k1.value[1],
+                          _k2.value[1], _k3.value[1]));
+  const math::SimdFloat4 c = int_to_float * math::simd_float4::FromInt(
+    math::simd_int4::Load(_k0.value[2], _k1.value[2],
+                          _k2.value[2], _k3.value[2]));
+
+  // Get back length of the dropped component. Favors performance over
+  // accuracy by using x * RSqrtEst(x) instead of Sqrt(x).
+  const math::SimdFloat4 dd = math::Max(eps, one - (a * a + b * b + c * c));
+  const math::SimdFloat4 d_abs = dd * math::RSqrtEst(dd);
+  // Reapply its sign.
+  const math::SimdInt4 sign = math::simd_int4::Load(
+    _k0.sign != 0, _k1.sign != 0, _k2.sign != 0, _k3.sign != 0);
+  const math::SimdFloat4 d = math::Select(sign, d_abs, -d_abs);
+
+  // Puts the dropped component back in place.
+  const math::SimdInt4 largest = math::simd_int4::Load(
+    _k0.largest, _k1.largest, _k2.largest, _k3.largest);
+  const math::SimdInt4 is_x = math::CmpEq(largest, math::simd_int4::zero());
+  const math::SimdInt4 is_y = math::CmpEq(largest, math::simd_int4::one());
+  const math::SimdInt4 is_z =
+    math::CmpEq(largest, math::simd_int4::Load(2, 2, 2, 2));
+  const math::SimdInt4 is_w =
+    math::CmpEq(largest, math::simd_int4::Load(3, 3, 3, 3));
+  _quat->x = math::Select(is_x, d, a);
+  _quat->y = math::Select(is_x, a, math::Select(is_y, d, b));
+  _quat->z = math::Select(is_w, c, math::Select(is_z, d, b));
+  _quat->w = math::Select(is_w, d, c);
+}
+
+template<typename _Index>
+OZZ_SIMD_DISPATCH
 void UpdateSoaRotations(int _num_soa_tracks,
                         ozz::Range<const RotationKey> _keys,
-                        const int* _interp,
+                        const KeyTangent* _tangents,
+                        const _Index* _interp,
                         unsigned char* _outdated,
-                        internal::InterpSoaRotation* soa_rotations_) {
-  const math::SimdFloat4 one = math::simd_float4::one();
-  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
-  const math::SimdFloat4 int_to_float = math::simd_float4::Load1(1.f / 32767.f);
+                        const unsigned char* _mask,
+                        internal::InterpSoaRotation* soa_rotations_,
+                        internal::InterpSoaTangents* _soa_tangents) {
+  OutdatedIterator outdated(_num_soa_tracks, _outdated, _mask);
+  for (int i = outdated.Next(), next; i >= 0; i = next) {
+    // Prefetches the tangents of the next outdated entry while decoding this
+    // one.
+    next = outdated.Next();
+    if (_tangents && next >= 0) {
+      PrefetchTangents(_tangents, _interp + next * 4 * 2);
+    }
 
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
-    for (int i = j * 8; outdated; ++i, outdated >>= 1) {
-      if (!(outdated & 1)) {
-        continue;
-      }
+    const int base = i * 4 * 2;  // * soa size * 2 keys per track
 
-      const int base = i * 4 * 2;  // * soa size * 2 keys per track
-
-      // Decompress left side keyframes and store them in soa structures.
-      const RotationKey& k00 = _keys.begin[_interp[base + 0]];
-      const RotationKey& k10 = _keys.begin[_interp[base + 2]];
-      const RotationKey& k20 = _keys.begin[_interp[base + 4]];
-      const RotationKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_rotations_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
-      math::SoaQuaternion& quat0 = soa_rotations_[i].value[0];
-      quat0.x = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      quat0.y = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      quat0.z = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
-
-      // Get back sign of w component.
-      const math::SimdInt4 wsign0 = math::simd_int4::Load(
-        k00.wsign, k10.wsign, k20.wsign, k30.wsign);
-      // Get back length of w component. Favors performance over accuracy by
-      // using x * RSqrtEst(x) instead of Sqrt(x).
-      const math::SimdFloat4 ww0 = math::Max(eps,
-        one - (quat0.x * quat0.x + quat0.y * quat0.y + quat0.z * quat0.z));
-      const math::SimdFloat4 w0 = ww0 * math::RSqrtEst(ww0);
-      // Reapply w's sign.
-      quat0.w = math::Select(wsign0, w0, -w0);
-
-      // Decompress right side keyframes and store them in soa structures.
-      const RotationKey& k01 = _keys.begin[_interp[base + 1]];
-      const RotationKey& k11 = _keys.begin[_interp[base + 3]];
-      const RotationKey& k21 = _keys.begin[_interp[base + 5]];
-      const RotationKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_rotations_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
-      math::SoaQuaternion& quat1 = soa_rotations_[i].value[1];
-      quat1.x = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      quat1.y = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      quat1.z = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
-      // Get back sign of w component.
-      const math::SimdInt4 wsign1 = math::simd_int4::Load(
-        k01.wsign, k11.wsign, k21.wsign, k31.wsign);
-      // Get back length of w component. Favors performance over accuracy by
-      // using x * RSqrtEst(x) instead of Sqrt(x).
-      const math::SimdFloat4 ww1 = math::Max(eps,
-        one - (quat1.x * quat1.x + quat1.y * quat1.y + quat1.z * quat1.z));
-      const math::SimdFloat4 w1 = ww1 * math::RSqrtEst(ww1);
-      // Reapply w's sign.
-      quat1.w = math::Select(wsign1, w1, -w1);
+    // Decompress left side keyframes and store them in soa structures.
+    const RotationKey& k00 = _keys.begin[_interp[base + 0]];
+    const RotationKey& k10 = _keys.begin[_interp[base + 2]];
+    const RotationKey& k20 = _keys.begin[_interp[base + 4]];
+    const RotationKey& k30 = _keys.begin[_interp[base + 6]];
+    soa_rotations_[i].time[0] = KeyTimes(k00, k10, k20, k30);
+    DecodeRotations(k00, k10, k20, k30, &soa_rotations_[i].value[0]);
+
+    // Decompress right side keyframes and store them in soa structures.
+    const RotationKey& k01 = _keys.begin[_interp[base + 1]];
+    const RotationKey& k11 = _keys.begin[_interp[base + 3]];
+    const RotationKey& k21 = _keys.begin[_interp[base + 5]];
+    const RotationKey& k31 = _keys.begin[_interp[base + 7]];
+    soa_rotations_[i].time[1] = RightTime(
+      soa_rotations_[i].time[0],
+      KeyTimes(k01, k11, k21, k31));
+    DecodeRotations(k01, k11, k21, k31, &soa_rotations_[i].value[1]);
+
+    if (_tangents) {
+      const math::SimdFloat4 scale = TangentScale(soa_rotations_[i].time);
+      DecodeTangents(_tangents, _interp + base, scale,
+                     &_soa_tangents[i].rotation[0]);
+      DecodeTangents(_tangents, _interp + base + 1, scale,
+                     &_soa_tangents[i].rotation[1]);
     }
   }
 }
 
+template<typename _Index>
+OZZ_SIMD_DISPATCH
 void UpdateSoaScales(int _num_soa_tracks,
                      ozz::Range<const ScaleKey> _keys,
-                     const int* _interp,
+                     const KeyTangent* _tangents,
+                     const _Index* _interp,
                      unsigned char* _outdated,
-                     internal::InterpSoaScale* soa_scales_) {
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
-    for (int i = j * 8; outdated; ++i, outdated >>= 1) {
-      if (!(outdated & 1)) {
-        continue;
-      }
-      const int base = i * 4 * 2;  // * soa size * 2 keys
-
-      // Decompress left side keyframes and store them in soa structures.
-      const ScaleKey& k00 = _keys.begin[_interp[base + 0]];
-      const ScaleKey& k10 = _keys.begin[_interp[base + 2]];
-      const ScaleKey& k20 = _keys.begin[_interp[base + 4]];
-      const ScaleKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_scales_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
-      soa_scales_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[0],k10.value[0], k20.value[0], k30.value[0]));
-      soa_scales_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_scales_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
-
-      // Decompress right side keyframes and store them in soa structures.
-      const ScaleKey& k01 = _keys.begin[_interp[base + 1]];
-      const ScaleKey& k11 = _keys.begin[_interp[base + 3]];
-      const ScaleKey& k21 = _keys.begin[_interp[base + 5]];
-      const ScaleKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_scales_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
-      soa_scales_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_scales_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_scales_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+                     const unsigned char* _mask,
+                     internal::InterpSoaScale* soa_scales_,
+                     internal::InterpSoaTangents* _soa_tangents) {
+  OutdatedIterator outdated(_num_soa_tracks, _outdated, _mask);
+  for (int i = outdated.Next(), next; i >= 0; i = next) {
+    // Prefetches the tangents of the next outdated entry while decoding this
+    // one.
+    next = outdated.Next();
+    if (_tangents && next >= 0) {
+      PrefetchTangents(_tangents, _interp + next * 4 * 2);
+    }
+
+    const int base = i * 4 * 2;  // * soa size * 2 keys
+
+    // Decompress left side keyframes and store them in soa structures.
+    const ScaleKey& k00 = _keys.begin[_interp[base + 0]];
+    const ScaleKey& k10 = _keys.begin[_interp[base + 2]];
+    const ScaleKey& k20 = _keys.begin[_interp[base + 4]];
+    const ScaleKey& k30 = _keys.begin[_interp[base + 6]];
+    soa_scales_[i].time[0] = KeyTimes(k00, k10, k20, k30);
+    soa_scales_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
+      k00.value[0],k10.value[0], k20.value[0], k30.value[0]));
+    soa_scales_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
+      k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
+    soa_scales_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
+      k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+
+    // Decompress right side keyframes and store them in soa structures.
+    const ScaleKey& k01 = _keys.begin[_interp[base + 1]];
+    const ScaleKey& k11 = _keys.begin[_interp[base + 3]];
+    const ScaleKey& k21 = _keys.begin[_interp[base + 5]];
+    const ScaleKey& k31 = _keys.begin[_interp[base + 7]];
+    soa_scales_[i].time[1] = RightTime(
+      soa_scales_[i].time[0],
+      KeyTimes(k01, k11, k21, k31));
+    soa_scales_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
+      k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
+    soa_scales_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
+      k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
+    soa_scales_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
+      k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+
+    if (_tangents) {
+      const math::SimdFloat4 scale = TangentScale(soa_scales_[i].time);
+      DecodeTangents(_tangents, _interp + base, scale,
+                     &_soa_tangents[i].scale[0]);
+      DecodeTangents(_tangents, _interp + base + 1, scale,
+                     &_soa_tangents[i].scale[1]);
     }
   }
 }
 
-void Interpolates(float _anim_time,
-                  int _num_soa_tracks,
-                  const internal::InterpSoaTranslation* _translations,
-                  const internal::InterpSoaRotation* _rotations,
-                  const internal::InterpSoaScale* _scales,
-                  math::SoaTransform* _output) {
-    const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
-    for (int i = 0; i < _num_soa_tracks; ++i) {
-      // Prepares interpolation coefficients.
+#if defined(OZZ_HAS_AVX)
+// Computes interpolation ratios of two consecutive soa tracks at once.
+template<typename _Interp>
+OZZ_INLINE math::SimdFloat8 InterpRatio8(math::_SimdFloat8 _anim_time,
+                                         const _Interp* _interp) {
+  const math::SimdFloat8 t0 =
+    math::simd_float8::Load(_interp[0].time[0], _interp[1].time[0]);
+  const math::SimdFloat8 t1 =
+    math::simd_float8::Load(_interp[0].time[1], _interp[1].time[1]);
+  return (_anim_time - t0) * math::RcpEst(t1 - t0);
+}
+
+// Lerps one soa component of two consecutive soa tracks at once.
+OZZ_INLINE math::SimdFloat8 Lerp8(math::_SimdFloat4 _a0, math::_SimdFloat4 _a1,
+                                  math::_SimdFloat4 _b0, math::_SimdFloat4 _b1,
+                                  math::_SimdFloat8 _f) {
+  const math::SimdFloat8 a = math::simd_float8::Load(_a0, _a1);
+  const math::SimdFloat8 b = math::simd_float8::Load(_b0, _b1);
+  return (b - a) * _f + a;
+}
+
+// Interpolates two consecutive soa tracks, aka 8 joints, per call. Results
+// match Lerp and NLerpEst 4-wide implementations.
+template<typename _Interp>
+OZZ_INLINE void Lerp8(const _Interp* _interp, math::_SimdFloat8 _f,
+                      math::SoaFloat3* _r0, math::SoaFloat3* _r1) {
+  const math::SimdFloat8 x = Lerp8(_interp[0].value[0].x, _interp[1].value[0].x,
+                                   _interp[0].value[1].x, _interp[1].value[1].x,
+                                   _f);
+  const math::SimdFloat8 y = Lerp8(_interp[0].value[0].y, _interp[1].value[0].y,
+                                   _interp[0].value[1].y, _interp[1].value[1].y,
+                                   _f);
+  const math::SimdFloat8 z = Lerp8(_interp[0].value[0].z, _interp[1].value[0].z,
+                                   _interp[0].value[1].z, _interp[1].value[1].z,
+                                   _f);
+  _r0->x = math::GetLow(x); _r1->x = math::GetHigh(x);
+  _r0->y = math::GetLow(y); _r1->y = math::GetHigh(y);
+  _r0->z = math::GetLow(z); _r1->z = math::GetHigh(z);
+}
+
+template<bool _Fast>
+OZZ_INLINE void NLerpEst8(const internal::InterpSoaRotation* _interp,
+                          math::_SimdFloat8 _f,
+                          math::SoaQuaternion* _r0, math::SoaQuaternion* _r1) {
+  const math::SimdFloat8 x = Lerp8(_interp[0].value[0].x, _interp[1].value[0].x,
+                                   _interp[0].value[1].x, _interp[1].value[1].x,
+                                   _f);
+  const math::SimdFloat8 y = Lerp8(_interp[0].value[0].y, _interp[1].value[0].y,
+                                   _interp[0].value[1].y, _interp[1].value[1].y,
+                                   _f);
+  const math::SimdFloat8 z = Lerp8(_interp[0].value[0].z, _interp[1].value[0].z,
+                                   _interp[0].value[1].z, _interp[1].value[1].z,
+                                   _f);
+  const math::SimdFloat8 w = Lerp8(_interp[0].value[0].w, _interp[1].value[0].w,
+                                   _interp[0].value[1].w, _interp[1].value[1].w,
+                                   _f);
+  const math::SimdFloat8 len2 = x * x + y * y + z * z + w * w;
+  // Uses RSqrtEstNR (with one more Newton-Raphson step) as quaternions loose
+  // much precision due to normalization, unless _Fast.
+  const math::SimdFloat8 inv_len =
+    _Fast ? math::RSqrtEst(len2) : math::RSqrtEstNR(len2);
+  const math::SimdFloat8 nx = x * inv_len;
+  const math::SimdFloat8 ny = y * inv_len;
+  const math::SimdFloat8 nz = z * inv_len;
+  const math::SimdFloat8 nw = w * inv_len;
+  _r0->x = math::GetLow(nx); _r1->x = math::GetHigh(nx);
+  _r0->y = math::GetLow(ny); _r1->y = math::GetHigh(ny);
+  _r0->z = math::GetLow(nz); _r1->z = math::GetHigh(nz);
+  _r0->w = math::GetLow(nw); _r1->w = math::GetHigh(nw);
+}
+#endif  // OZZ_HAS_AVX
+
+// Evaluates the cubic Hermite curves from _p0 to _p1 at interpolation ratio
+// _t, whose tangents _m0 and _m1 are already scaled to the time range of the
+// interpolated keys.
+template<typename _Soa>
+OZZ_INLINE _Soa Hermite(const _Soa& _p0, const _Soa& _p1,
+                        const _Soa& _m0, const _Soa& _m1,
+                        math::_SimdFloat4 _t) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 t2 = _t * _t;
+  const math::SimdFloat4 tm1 = _t - one;
+  const math::SimdFloat4 h01 =
+    t2 * (math::simd_float4::Load1(3.f) - _t - _t);
+  const math::SimdFloat4 h10 = _t * tm1 * tm1;
+  const math::SimdFloat4 h11 = t2 * tm1;
+  return Lerp(_p0, _p1, h01) + _m0 * h10 + _m1 * h11;
+}
+
+// Normalizes _q, with a fast estimation if _Fast, see NormalizeFastEst().
+template<bool _Fast>
+OZZ_INLINE math::SoaQuaternion NormalizeRotation(
+  const math::SoaQuaternion& _q) {
+  return _Fast ? NormalizeFastEst(_q) : NormalizeEst(_q);
+}
+
+// Returns true if soa entry _i isn't masked out by _mask, which is NULL if all
+// entries are sampled.
+OZZ_INLINE bool IsSampled(const unsigned char* _mask, int _i) {
+  return !_mask || (_mask[_i / 8] & (1 << (_i & 7))) != 0;
+}
+
+// Interpolates Hermite animations soa hot data of soa entries [_begin,_end[.
+// _output is the output of soa entry _begin. Rotations normalization is fast
+// estimated if _Fast. Scales are only interpolated if _Scaled, otherwise
+// they're unit scales. Translations are only interpolated if _Translated,
+// otherwise they're all constant and their single key is output.
+template<bool _Fast, bool _Scaled, bool _Translated>
+OZZ_SIMD_DISPATCH
+void InterpolatesHermite(float _anim_time,
+                         int _begin,
+                         int _end,
+                         const internal::InterpSoaTranslation* _translations,
+                         const internal::InterpSoaRotation* _rotations,
+                         const internal::InterpSoaScale* _scales,
+                         const internal::InterpSoaTangents* _tangents,
+                         const unsigned char* _mask,
+                         math::SoaTransform* _output) {
+  const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
+  for (int i = _begin; i < _end; ++i) {
+    if (!IsSampled(_mask, i)) {
+      continue;
+    }
+    math::SoaTransform& output = _output[i - _begin];
+    const math::SimdFloat4 interp_r_time =
+      (anim_time - _rotations[i].time[0]) *
+      math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
+
+    // Rotations are interpolated component-wise and then normalized, as
+    // NLerp does.
+    const internal::InterpSoaTangents& tangents = _tangents[i];
+    if (_Translated) {
       const math::SimdFloat4 interp_t_time =
         (anim_time - _translations[i].time[0]) *
         math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
-      const math::SimdFloat4 interp_r_time =
-        (anim_time - _rotations[i].time[0]) *
-        math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
+      output.translation = Hermite(
+        _translations[i].value[0], _translations[i].value[1],
+        tangents.translation[0], tangents.translation[1], interp_t_time);
+    } else {
+      output.translation = _translations[i].value[0];
+    }
+    output.rotation = NormalizeRotation<_Fast>(Hermite(
+      _rotations[i].value[0], _rotations[i].value[1],
+      tangents.rotation[0], tangents.rotation[1], interp_r_time));
+    if (_Scaled) {
       const math::SimdFloat4 interp_s_time =
         (anim_time - _scales[i].time[0]) *
         math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
+      output.scale = Hermite(
+        _scales[i].value[0], _scales[i].value[1],
+        tangents.scale[0], tangents.scale[1], interp_s_time);
+    } else {
+      output.scale = math::SoaFloat3::one();
+    }
+  }
+}
+
+// Linearly interpolates soa entry _i hot data to _output.
+template<bool _Fast, bool _Scaled, bool _Translated>
+OZZ_INLINE void Interpolate(math::_SimdFloat4 _anim_time,
+                            int _i,
+                            const internal::InterpSoaTranslation* _translations,
+                            const internal::InterpSoaRotation* _rotations,
+                            const internal::InterpSoaScale* _scales,
+                            math::SoaTransform* _output) {
+  // Prepares interpolation coefficients.
+  const math::SimdFloat4 interp_r_time =
+    (_anim_time - _rotations[_i].time[0]) *
+    math::RcpEst(_rotations[_i].time[1] - _rotations[_i].time[0]);
+
+  // Processes interpolations.
+  // The lerp of the rotation uses the shortest path, because opposed
+  // quaternions were negated during animation build stage (AnimationBuilder).
+  if (_Translated) {
+    const math::SimdFloat4 interp_t_time =
+      (_anim_time - _translations[_i].time[0]) *
+      math::RcpEst(_translations[_i].time[1] - _translations[_i].time[0]);
+    _output->translation = Lerp(
+      _translations[_i].value[0], _translations[_i].value[1], interp_t_time);
+  } else {
+    _output->translation = _translations[_i].value[0];
+  }
+  _output->rotation = NormalizeRotation<_Fast>(Lerp(
+    _rotations[_i].value[0], _rotations[_i].value[1], interp_r_time));
+  if (_Scaled) {
+    const math::SimdFloat4 interp_s_time =
+      (_anim_time - _scales[_i].time[0]) *
+      math::RcpEst(_scales[_i].time[1] - _scales[_i].time[0]);
+    _output->scale = Lerp(
+      _scales[_i].value[0], _scales[_i].value[1], interp_s_time);
+  } else {
+    _output->scale = math::SoaFloat3::one();
+  }
+}
 
-      // Processes interpolations.
-      // The lerp of the rotation uses the shortest path, because opposed
-      // quaternions were negated during animation build stage (AnimationBuilder).
-      _output[i].translation = Lerp(
-        _translations[i].value[0], _translations[i].value[1], interp_t_time);
-      _output[i].rotation = NLerpEst(
-        _rotations[i].value[0], _rotations[i].value[1], interp_r_time);
-      _output[i].scale = Lerp(
-        _scales[i].value[0], _scales[i].value[1], interp_s_time);
+// Linearly interpolates soa hot data of soa entries [_begin,_end[. _output is
+// the output of soa entry _begin. Rotations normalization is fast estimated if
+// _Fast. Scales are only interpolated if _Scaled, otherwise they're unit
+// scales. Translations are only interpolated if _Translated, otherwise they're
+// all constant and their single key is output.
+template<bool _Fast, bool _Scaled, bool _Translated>
+OZZ_SIMD_DISPATCH
+void Interpolates(float _anim_time,
+                  int _begin,
+                  int _end,
+                  const internal::InterpSoaTranslation* _translations,
+                  const internal::InterpSoaRotation* _rotations,
+                  const internal::InterpSoaScale* _scales,
+                  const unsigned char* _mask,
+                  math::SoaTransform* _output) {
+    const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
+    int i = _begin;
+#if defined(OZZ_HAS_AVX)
+    // Processes two soa tracks per iteration with 8-wide AVX instructions.
+    // Pairs that are partially masked out are processed one by one.
+    const math::SimdFloat8 anim_time8 = math::simd_float8::Load1(_anim_time);
+    for (; i + 1 < _end; i += 2) {
+      const bool sampled0 = IsSampled(_mask, i);
+      const bool sampled1 = IsSampled(_mask, i + 1);
+      if (!sampled0 || !sampled1) {
+        if (sampled0) {
+          Interpolate<_Fast, _Scaled, _Translated>(
+            anim_time, i, _translations, _rotations, _scales,
+            _output + (i - _begin));
+        }
+        if (sampled1) {
+          Interpolate<_Fast, _Scaled, _Translated>(
+            anim_time, i + 1, _translations, _rotations, _scales,
+            _output + (i + 1 - _begin));
+        }
+        continue;
+      }
+
+      const math::SimdFloat8 interp_r_time =
+        InterpRatio8(anim_time8, _rotations + i);
+
+      math::SoaTransform* output = _output + (i - _begin);
+      if (_Translated) {
+        const math::SimdFloat8 interp_t_time =
+          InterpRatio8(anim_time8, _translations + i);
+        Lerp8(_translations + i, interp_t_time,
+              &output[0].translation, &output[1].translation);
+      } else {
+        output[0].translation = _translations[i].value[0];
+        output[1].translation = _translations[i + 1].value[0];
+      }
+      NLerpEst8<_Fast>(_rotations + i, interp_r_time,
+                &output[0].rotation, &output[1].rotation);
+      if (_Scaled) {
+        const math::SimdFloat8 interp_s_time =
+          InterpRatio8(anim_time8, _scales + i);
+        Lerp8(_scales + i, interp_s_time,
+              &output[0].scale, &output[1].scale);
+      } else {
+        output[0].scale = math::SoaFloat3::one();
+        output[1].scale = math::SoaFloat3::one();
+      }
     }
+#endif  // OZZ_HAS_AVX
+
+    // Processes remaining soa tracks.
+    for (; i < _end; ++i) {
+      if (IsSampled(_mask, i)) {
+        Interpolate<_Fast, _Scaled, _Translated>(
+          anim_time, i, _translations, _rotations, _scales,
+          _output + (i - _begin));
+      }
+    }
+}
+
+// Coefficients of the derivative of the interpolation curves of 4 soa lanes,
+// see Derivative().
+struct DerivativeCoefficients {
+  // Interpolation ratio.
+  math::SimdFloat4 ratio;
+  // Coefficients of (_p1 - _p0), _m0 and _m1.
+  math::SimdFloat4 dp;
+  math::SimdFloat4 dm0;
+  math::SimdFloat4 dm1;
+};
+
+// Computes the coefficients of the derivative, at _anim_time, of the curves
+// interpolating keys whose times are _time[0] and _time[1]. Derivatives are
+// converted from key time unit with _scale. Hermite tangents coefficients are
+// null for linear interpolations.
+OZZ_INLINE DerivativeCoefficients Derivative(math::_SimdFloat4 _anim_time,
+                                             const math::SimdFloat4* _time,
+                                             math::_SimdFloat4 _scale,
+                                             bool _hermite) {
+  DerivativeCoefficients d;
+  const math::SimdFloat4 range = _time[1] - _time[0];
+  const math::SimdFloat4 inv_range = _scale / range;
+  d.ratio = (_anim_time - _time[0]) / range;
+  if (_hermite) {
+    // Derivatives of Hermite basis functions, see Hermite().
+    const math::SimdFloat4 one = math::simd_float4::one();
+    const math::SimdFloat4 t = d.ratio;
+    const math::SimdFloat4 t3 = math::simd_float4::Load1(3.f) * t;
+    d.dp = math::simd_float4::Load1(6.f) * t * (one - t) * inv_range;
+    d.dm0 = (t3 * t - t3 - t + one) * inv_range;
+    d.dm1 = (t3 * t - t - t) * inv_range;
+  } else {
+    d.dp = inv_range;
+    d.dm0 = math::simd_float4::zero();
+    d.dm1 = math::simd_float4::zero();
+  }
+  return d;
+}
+
+// Derivates a single soa component.
+OZZ_INLINE math::SimdFloat4 Derivate(math::_SimdFloat4 _p0,
+                                     math::_SimdFloat4 _p1,
+                                     math::_SimdFloat4 _m0,
+                                     const math::SimdFloat4& _m1,
+                                     const DerivativeCoefficients& _d) {
+  return (_p1 - _p0) * _d.dp + _m0 * _d.dm0 + _m1 * _d.dm1;
+}
+
+// Derivates _values curves, whose tangents are _tangents, or NULL for linear
+// interpolations.
+OZZ_INLINE math::SoaFloat3 Derivate(const math::SoaFloat3* _values,
+                                    const math::SoaFloat3* _tangents,
+                                    const DerivativeCoefficients& _d) {
+  const math::SoaFloat3 d = (_values[1] - _values[0]) * _d.dp;
+  if (!_tangents) {
+    return d;
+  }
+  return d + _tangents[0] * _d.dm0 + _tangents[1] * _d.dm1;
+}
+
+// Computes the angular velocity of _rotations curves, whose tangents are
+// _tangents, or NULL for linear interpolations. The angular velocity of the
+// normalized quaternion n = q / |q| is 2 * vec(dn * conj(n)), which simplifies
+// to 2 * vec(dq * conj(q)) / |q|^2 as dq component along q doesn't rotate.
+OZZ_INLINE math::SoaFloat3 AngularVelocity(
+  const math::SoaQuaternion* _rotations,
+  const math::SoaQuaternion* _tangents,
+  const DerivativeCoefficients& _d) {
+  const math::SoaQuaternion& p0 = _rotations[0];
+  const math::SoaQuaternion& p1 = _rotations[1];
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SoaQuaternion m0 =
+    _tangents ? _tangents[0] : math::SoaQuaternion::Load(zero, zero, zero,
+                                                         zero);
+  const math::SoaQuaternion m1 = _tangents ? _tangents[1] : m0;
+  const math::SoaQuaternion q =
+    _tangents ? Hermite(p0, p1, m0, m1, _d.ratio) : Lerp(p0, p1, _d.ratio);
+  const math::SoaFloat3 dq = math::SoaFloat3::Load(
+    Derivate(p0.x, p1.x, m0.x, m1.x, _d),
+    Derivate(p0.y, p1.y, m0.y, m1.y, _d),
+    Derivate(p0.z, p1.z, m0.z, m1.z, _d));
+  const math::SimdFloat4 dqw = Derivate(p0.w, p1.w, m0.w, m1.w, _d);
+  const math::SoaFloat3 qv = math::SoaFloat3::Load(q.x, q.y, q.z);
+  const math::SimdFloat4 len2 = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+  const math::SoaFloat3 vec = dq * q.w - qv * dqw - CrossProduct(dq, qv);
+  return vec * (math::simd_float4::Load1(2.f) / len2);
 }
 }  // namespace
 
 SamplingJob::SamplingJob()
     : time(0.f),
       animation(NULL),
-      cache(NULL) {
+      cache(NULL),
+      num_joints_lod(Skeleton::kMaxJoints),
+      update_frame(0),
+      fast_normalization(false) {
 }
 
 bool SamplingJob::Run() const {
+  OZZ_PROFILE_SCOPE("SamplingJob::Run");
   if (!Validate()) {
     return false;
   }
 
-  const int num_soa_tracks = animation->num_soa_tracks();
+  // Soa tracks that aren't refreshed this frame are masked out.
+  const unsigned char* mask = soa_mask.begin;
+  unsigned char periods_mask[(Skeleton::kMaxSoAJoints + 7) / 8];
+  if (soa_update_periods.begin) {
+    UpdatePeriodsMask(soa_update_periods.begin, animation->num_soa_tracks(),
+                      update_frame, soa_mask.begin, periods_mask);
+    mask = periods_mask;
+  }
+
+  const int num_soa_lod = NumSoaLod(*animation, num_joints_lod);
+  if (changed.begin) {
+    SampleChanged(*animation, time, cache, mask, num_soa_lod,
+                  fast_normalization, output.begin, changed.begin);
+  } else {
+    Sample(*animation, time, cache, mask, num_soa_lod, fast_normalization,
+           output.begin);
+  }
+
+  // Velocities are derived from the keys the cache has just been updated
+  // with.
+  if (velocities.begin) {
+    Differentiate(*animation, *cache, time, num_soa_lod, mask,
+                  velocities.begin);
+  }
+
+  return true;
+}
+
+template<typename _Index>
+void SamplingJob::UpdateCache(const Animation& _animation,
+                              float _key_time,
+                              const unsigned char* _soa_mask,
+                              int _num_soa_lod,
+                              SamplingCache* _cache) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+
+  // Key indices of every stream.
+  _Index* translation_keys = static_cast<_Index*>(_cache->translation_keys_);
+  _Index* rotation_keys = static_cast<_Index*>(_cache->rotation_keys_);
+  _Index* scale_keys = static_cast<_Index*>(_cache->scale_keys_);
+
+  // Key links of every stream, NULL if the animation has none.
+  const uint16_t* translation_links = NULL;
+  const uint16_t* rotation_links = NULL;
+  const uint16_t* scale_links = NULL;
+  if (_animation.key_links().begin != _animation.key_links().end) {
+    translation_links = _animation.key_links().begin;
+    rotation_links = translation_links + _animation.translations().Count();
+    scale_links = rotation_links + _animation.rotations().Count();
+  }
+
+  // Key tangents of every stream, NULL for linear animations.
+  const KeyTangent* translation_tangents = NULL;
+  const KeyTangent* rotation_tangents = NULL;
+  const KeyTangent* scale_tangents = NULL;
+  if (_animation.hermite()) {
+    translation_tangents = _animation.tangents().begin;
+    rotation_tangents =
+      translation_tangents + _animation.translations().Count();
+    scale_tangents = rotation_tangents + _animation.rotations().Count();
+  }
+
+  // Fetch key frames from the animation to the cache a t = anim_time.
+  // Then updates outdated soa hot values. Keys of all tracks are fetched, as
+  // the cache expects them to be sorted, but only the soa tracks of the lod
+  // are decoded. Others remain outdated.
+  StreamStats translation_stats(&_cache->stats_, num_soa_tracks,
+                                &_cache->translation_cursor_,
+                                _cache->outdated_translations_);
+  UpdateKeys(_key_time, num_soa_tracks,
+             _animation.num_constant_translations(),
+             _animation.translations(),
+             translation_links,
+             &_cache->translation_cursor_,
+             translation_keys,
+             _cache->outdated_translations_);
+  translation_stats.KeysUpdated();
+  UpdateSoaTranslations(_num_soa_lod,
+                        _animation.translations(),
+                        _animation.translation_ranges(),
+                        translation_tangents,
+                        translation_keys,
+                        _cache->outdated_translations_,
+                        _soa_mask,
+                        _cache->soa_translations_,
+                        _cache->soa_tangents_);
+  translation_stats.SoaUpdated();
+
+  StreamStats rotation_stats(&_cache->stats_, num_soa_tracks,
+                             &_cache->rotation_cursor_,
+                             _cache->outdated_rotations_);
+  UpdateKeys(_key_time, num_soa_tracks,
+             _animation.num_constant_rotations(),
+             _animation.rotations(),
+             rotation_links,
+             &_cache->rotation_cursor_,
+             rotation_keys,
+             _cache->outdated_rotations_);
+  rotation_stats.KeysUpdated();
+  UpdateSoaRotations(_num_soa_lod,
+                     _animation.rotations(),
+                     rotation_tangents,
+                     rotation_keys,
+                     _cache->outdated_rotations_,
+                     _soa_mask,
+                     _cache->soa_rotations_,
+                     _cache->soa_tangents_);
+  rotation_stats.SoaUpdated();
+
+  StreamStats scale_stats(&_cache->stats_, num_soa_tracks,
+                          &_cache->scale_cursor_,
+                          _cache->outdated_scales_);
+  UpdateKeys(_key_time, num_soa_tracks,
+             _animation.num_constant_scales(),
+             _animation.scales(),
+             scale_links,
+             &_cache->scale_cursor_,
+             scale_keys,
+             _cache->outdated_scales_);
+  scale_stats.KeysUpdated();
+  // Scale keys of unscaled animations are never decoded, as they're never
+  // interpolated. Keys are still fetched to keep the cache cursor consistent.
+  if (_animation.scaled()) {
+    UpdateSoaScales(_num_soa_lod,
+                    _animation.scales(),
+                    scale_tangents,
+                    scale_keys,
+                    _cache->outdated_scales_,
+                    _soa_mask,
+                    _cache->soa_scales_,
+                    _cache->soa_tangents_);
+  }
+  scale_stats.SoaUpdated();
+}
+
+void SamplingJob::Sample(const Animation& _animation,
+                         float _time,
+                         SamplingCache* _cache,
+                         const unsigned char* _soa_mask,
+                         int _num_soa_lod,
+                         bool _fast_normalization,
+                         math::SoaTransform* _output) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
   if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
-    return true;
+    return;
+  }
+
+  Prepare(_animation, _time, _soa_mask, _num_soa_lod, _cache);
+  Interpolate(_animation, *_cache, KeyTime(_animation, _time), 0,
+              _num_soa_lod, _soa_mask, _fast_normalization, _output);
+}
+
+void SamplingJob::SampleChanged(const Animation& _animation,
+                                float _time,
+                                SamplingCache* _cache,
+                                const unsigned char* _soa_mask,
+                                int _num_soa_lod,
+                                bool _fast_normalization,
+                                math::SoaTransform* _output,
+                                unsigned char* _changed) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  std::memset(_changed, 0, (num_soa_tracks + 7) / 8);
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return;
+  }
+
+  Prepare(_animation, _time, _soa_mask, _num_soa_lod, _cache);
+
+  // Interpolates by chunks of soa tracks, whose previous output is saved to
+  // be compared with the new one.
+  const float key_time = KeyTime(_animation, _time);
+  const int kChunkSize = 8;
+  math::SoaTransform previous[kChunkSize];
+  for (int begin = 0; begin < _num_soa_lod; begin += kChunkSize) {
+    const int end = math::Min(begin + kChunkSize, _num_soa_lod);
+    math::SoaTransform* output = _output + begin;
+    const size_t size = (end - begin) * sizeof(math::SoaTransform);
+    std::memcpy(previous, output, size);
+    Interpolate(_animation, *_cache, key_time, begin, end, _soa_mask,
+                _fast_normalization, output);
+    for (int i = begin; i < end; ++i) {
+      if (std::memcmp(&previous[i - begin], &_output[i],
+                      sizeof(math::SoaTransform)) != 0) {
+        _changed[i / 8] |= 1 << (i & 7);
+      }
+    }
   }
+}
 
+float SamplingJob::KeyTime(const Animation& _animation, float _time) {
   // Clamps time in range [0,duration].
-  const float anim_time = math::Clamp(0.f, time, animation->duration());
+  const float anim_time = math::Clamp(0.f, _time, _animation.duration());
+  return ToKeyTime(anim_time, _animation.duration());
+}
+
+void SamplingJob::Prepare(const Animation& _animation,
+                          float _time,
+                          const unsigned char* _soa_mask,
+                          int _num_soa_lod,
+                          SamplingCache* _cache) {
+  assert(_num_soa_lod >= 0 && _num_soa_lod <= _animation.num_soa_tracks());
+
+  // Clamps time in range [0,duration].
+  const float anim_time = math::Clamp(0.f, _time, _animation.duration());
 
   // Step the cache to this potentially new animation and time.
-  assert(cache->max_soa_tracks() >= num_soa_tracks);
-  cache->Step(*animation, anim_time);
+  assert(_cache->max_soa_tracks() >= _animation.num_soa_tracks());
+  _cache->Step(_animation, anim_time);
 
-  // Fetch key frames from the animation to the cache a t = anim_time.
-  // Then updates outdated soa hot values.
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->translations(),
-             &cache->translation_cursor_,
-             cache->translation_keys_,
-             cache->outdated_translations_);
-  UpdateSoaTranslations(num_soa_tracks,
-                        animation->translations(),
-                        cache->translation_keys_,
-                        cache->outdated_translations_,
-                        cache->soa_translations_);
-
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->rotations(),
-             &cache->rotation_cursor_,
-             cache->rotation_keys_,
-             cache->outdated_rotations_);
-  UpdateSoaRotations(num_soa_tracks,
-                     animation->rotations(),
-                     cache->rotation_keys_,
-                     cache->outdated_rotations_,
-                     cache->soa_rotations_);
-
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->scales(),
-             &cache->scale_cursor_,
-             cache->scale_keys_,
-             cache->outdated_scales_);
-  UpdateSoaScales(num_soa_tracks,
-                  animation->scales(),
-                  cache->scale_keys_,
-                  cache->outdated_scales_,
-                  cache->soa_scales_);
-
-  // Interpolates soa hot data.
-  Interpolates(anim_time,
-               num_soa_tracks,
-               cache->soa_translations_,
-               cache->soa_rotations_,
-               cache->soa_scales_,
-               output.begin);
+  // Fetches key frames to the cache, according to its key indices type.
+  // Keys and interpolation times are all expressed in key time unit.
+  const float key_time = ToKeyTime(anim_time, _animation.duration());
+  if (_cache->compact_) {
+    UpdateCache<uint16_t>(_animation, key_time, _soa_mask, _num_soa_lod,
+                          _cache);
+  } else {
+    UpdateCache<int>(_animation, key_time, _soa_mask, _num_soa_lod, _cache);
+  }
+}
+
+void SamplingJob::Interpolate(const Animation& _animation,
+                              const SamplingCache& _cache,
+                              float _key_time,
+                              int _begin,
+                              int _end,
+                              const unsigned char* _soa_mask,
+                              bool _fast_normalization,
+                              math::SoaTransform* _output) {
+  assert(_begin >= 0 && _begin <= _end &&
+         _end <= _animation.num_soa_tracks());
+
+  // Interpolates soa hot data, selecting normalization, scale and translation
+  // interpolation at compile time.
+  typedef void (*Interpolates_)(float, int, int,
+                                const internal::InterpSoaTranslation*,
+                                const internal::InterpSoaRotation*,
+                                const internal::InterpSoaScale*,
+                                const unsigned char*,
+                                math::SoaTransform*);
+  static const Interpolates_ kInterpolates[2][2][2] = {
+    {{Interpolates<false, false, false>, Interpolates<false, false, true>},
+     {Interpolates<false, true, false>, Interpolates<false, true, true>}},
+    {{Interpolates<true, false, false>, Interpolates<true, false, true>},
+     {Interpolates<true, true, false>, Interpolates<true, true, true>}}};
+  typedef void (*InterpolatesHermite_)(float, int, int,
+                                       const internal::InterpSoaTranslation*,
+                                       const internal::InterpSoaRotation*,
+                                       const internal::InterpSoaScale*,
+                                       const internal::InterpSoaTangents*,
+                                       const unsigned char*,
+                                       math::SoaTransform*);
+  static const InterpolatesHermite_ kInterpolatesHermite[2][2][2] = {
+    {{InterpolatesHermite<false, false, false>,
+      InterpolatesHermite<false, false, true>},
+     {InterpolatesHermite<false, true, false>,
+      InterpolatesHermite<false, true, true>}},
+    {{InterpolatesHermite<true, false, false>,
+      InterpolatesHermite<true, false, true>},
+     {InterpolatesHermite<true, true, false>,
+      InterpolatesHermite<true, true, true>}}};
+  const bool scaled = _animation.scaled();
+  const bool translated = _animation.translated();
+  const Interpolates_ interpolates =
+    kInterpolates[_fast_normalization][scaled][translated];
+  const InterpolatesHermite_ interpolates_hermite =
+    kInterpolatesHermite[_fast_normalization][scaled][translated];
+  if (_animation.hermite()) {
+    interpolates_hermite(_key_time,
+                        _begin,
+                        _end,
+                        _cache.soa_translations_,
+                        _cache.soa_rotations_,
+                        _cache.soa_scales_,
+                        _cache.soa_tangents_,
+                        _soa_mask,
+                        _output);
+  } else {
+    interpolates(_key_time,
+                 _begin,
+                 _end,
+                 _cache.soa_translations_,
+                 _cache.soa_rotations_,
+                 _cache.soa_scales_,
+                 _soa_mask,
+                 _output);
+  }
+}
+
+void SamplingJob::Differentiate(const Animation& _animation,
+                                const SamplingCache& _cache,
+                                float _time,
+                                int _num_soa_lod,
+                                const unsigned char* _soa_mask,
+                                SoaJointVelocity* _velocities) {
+  assert(_num_soa_lod >= 0 && _num_soa_lod <= _animation.num_soa_tracks());
+
+  // Converts derivatives from key time unit to seconds. Velocities are null
+  // out of the animation range, where time is clamped.
+  const float duration = _animation.duration();
+  const bool in_range = _time >= 0.f && _time <= duration && duration > 0.f;
+  const math::SimdFloat4 scale = math::simd_float4::Load1(
+    in_range ? static_cast<float>(kMaxKeyTime) / duration : 0.f);
+  const math::SimdFloat4 key_time =
+    math::simd_float4::Load1(KeyTime(_animation, _time));
+
+  const bool hermite = _animation.hermite();
+  const bool translated = _animation.translated();
+  const bool scaled = _animation.scaled();
+  for (int i = 0; i < _num_soa_lod; ++i) {
+    if (!IsSampled(_soa_mask, i)) {
+      continue;
+    }
+    const internal::InterpSoaTangents* tangents =
+      hermite ? _cache.soa_tangents_ + i : NULL;
+    SoaJointVelocity& velocity = _velocities[i];
+
+    if (translated) {
+      const internal::InterpSoaTranslation& translation =
+        _cache.soa_translations_[i];
+      velocity.translation = Derivate(
+        translation.value, tangents ? tangents->translation : NULL,
+        Derivative(key_time, translation.time, scale, hermite));
+    } else {
+      velocity.translation = math::SoaFloat3::zero();
+    }
+
+    const internal::InterpSoaRotation& rotation = _cache.soa_rotations_[i];
+    velocity.rotation = AngularVelocity(
+      rotation.value, tangents ? tangents->rotation : NULL,
+      Derivative(key_time, rotation.time, scale, hermite));
+
+    if (scaled) {
+      const internal::InterpSoaScale& scale_keys = _cache.soa_scales_[i];
+      velocity.scale = Derivate(
+        scale_keys.value, tangents ? tangents->scale : NULL,
+        Derivative(key_time, scale_keys.time, scale, hermite));
+    } else {
+      velocity.scale = math::SoaFloat3::zero();
+    }
+  }
+}
+
+BatchSamplingJob::Item::Item()
+    : time(0.f),
+      animation(NULL),
+      cache(NULL),
+      num_joints_lod(Skeleton::kMaxJoints),
+      fast_normalization(false) {
+}
+
+bool BatchSamplingJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test items range, implicitly tests for NULL end pointers.
+  valid &= items.begin != NULL;
+  valid &= items.end >= items.begin;
+
+  // Validates each item.
+  for (const Item* item = items.begin;
+       items.begin && item < items.end;  // Handles NULL pointers.
+       ++item) {
+    SamplingJob job;
+    job.time = item->time;
+    job.animation = item->animation;
+    job.cache = item->cache;
+    job.output = item->output;
+    job.soa_mask = item->soa_mask;
+    job.num_joints_lod = item->num_joints_lod;
+    valid &= job.Validate();
+  }
+
+  return valid;
+}
+
+namespace {
+// Prefetches the data that sampling _item will access first.
+void PrefetchItem(const BatchSamplingJob::Item& _item,
+                  const internal::InterpSoaTranslation* _translations) {
+  Prefetch(_item.animation);
+  Prefetch(_translations);
+  Prefetch(_item.output.begin);
+}
+
+// Defines the number of items that are sorted by animation at once. This
+// bounds the stack usage of the job.
+const int kBatchChunkSize = 64;
+}  // namespace
+
+bool BatchSamplingJob::Run() const {
+  OZZ_PROFILE_SCOPE("BatchSamplingJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Processes items chunk by chunk. Each chunk is sorted by animation so that
+  // items sharing the same animation are sampled consecutively.
+  const Item* indices[kBatchChunkSize];
+  for (const Item* chunk = items.begin; chunk < items.end;) {
+    const int count =
+      math::Min(kBatchChunkSize, static_cast<int>(items.end - chunk));
+
+    // Insertion sort is stable and optimal on these small and usually already
+    // sorted ranges.
+    for (int i = 0; i < count; ++i) {
+      const Item* item = chunk + i;
+      int j = i;
+      const uintptr_t key = reinterpret_cast<uintptr_t>(item->animation);
+      for (; j > 0 &&
+             reinterpret_cast<uintptr_t>(indices[j - 1]->animation) > key;
+           --j) {
+        indices[j] = indices[j - 1];
+      }
+      indices[j] = item;
+    }
+
+    // Samples sorted items, prefetching next item data.
+    for (int i = 0; i < count; ++i) {
+      if (i + 1 < count) {
+        const Item& next = *indices[i + 1];
+        PrefetchItem(next, next.cache->soa_translations_);
+      }
+      const Item& item = *indices[i];
+      SamplingJob::Sample(*item.animation, item.time, item.cache,
+                          item.soa_mask.begin,
+                          NumSoaLod(*item.animation, item.num_joints_lod),
+                          item.fast_normalization,
+                          item.output.begin);
+    }
+
+    chunk += count;
+  }
 
   return true;
 }
 
-SamplingCache::SamplingCache(int _max_tracks)
-    : animation_(NULL),
+namespace {
+// Gets the size of a cache key index.
+size_t KeyIndexSize(bool _compact) {
+  return _compact ? sizeof(uint16_t) : sizeof(int);
+}
+
+// Computes the size of the buffer required by a cache for _max_soa_tracks,
+// whose key indices are uint16_t if _compact, or int otherwise.
+size_t CacheBufferSize(int _max_soa_tracks, bool _compact) {
+  using internal::InterpSoaTranslation;
+  using internal::InterpSoaRotation;
+  using internal::InterpSoaScale;
+  using internal::InterpSoaTangents;
+  const size_t max_tracks = _max_soa_tracks * 4;
+  const size_t num_outdated = (_max_soa_tracks + 7) / 8;
+  return
+    sizeof(InterpSoaTranslation) * _max_soa_tracks  +
+    sizeof(InterpSoaRotation) * _max_soa_tracks +
+    sizeof(InterpSoaScale) * _max_soa_tracks +
+    sizeof(InterpSoaTangents) * _max_soa_tracks +
+    KeyIndexSize(_compact) * max_tracks * 2 * 3 +  // 2 keys * 3 streams.
+    sizeof(unsigned char) * 3 * num_outdated;
+}
+}  // namespace
+
+const size_t SamplingCache::kBufferAlignment =
+  AlignOf<internal::InterpSoaTranslation>::value;
+
+size_t SamplingCache::buffer_size(int _max_tracks, bool _compact) {
+  return CacheBufferSize((_max_tracks + 3) / 4, _compact);
+}
+
+SamplingCache::SamplingCache(int _max_tracks, bool _compact)
+    : animation_id_(0),
     time_(0.f),
     max_soa_tracks_((_max_tracks + 3) / 4),
-    soa_translations_(NULL),
-    soa_rotations_(NULL),
-    soa_scales_(NULL),
-    translation_keys_(NULL),
-    rotation_keys_(NULL),
-    scale_keys_(NULL),
+    owns_buffer_(true),
+    compact_(_compact),
     translation_cursor_(0),
     rotation_cursor_(0),
-    scale_cursor_(0),
-    outdated_translations_(NULL),
-    outdated_rotations_(NULL),
-    outdated_scales_(NULL) {
+    scale_cursor_(0) {
+  // Allocate all cache data at once in a single allocation.
+  memory::ScopedTag tag(memory::kTagCache);
+  memory::Allocator* allocator = memory::default_allocator();
+  Dispatch(allocator->Allocate(CacheBufferSize(max_soa_tracks_, compact_),
+                               kBufferAlignment));
+}
+
+SamplingCache::SamplingCache(int _max_tracks, void* _buffer, size_t _size,
+                             bool _compact)
+    : animation_id_(0),
+    time_(0.f),
+    max_soa_tracks_((_max_tracks + 3) / 4),
+    owns_buffer_(false),
+    compact_(_compact),
+    translation_cursor_(0),
+    rotation_cursor_(0),
+    scale_cursor_(0) {
+  (void)_size;
+  assert(_size >= CacheBufferSize(max_soa_tracks_, compact_) &&
+         "Buffer is too small.");
+  assert(math::IsAligned(_buffer, kBufferAlignment) &&
+         "Buffer is not aligned.");
+  Dispatch(_buffer);
+}
+
+void SamplingCache::Dispatch(void* _buffer) {
   using internal::InterpSoaTranslation;
   using internal::InterpSoaRotation;
   using internal::InterpSoaScale;
+  using internal::InterpSoaTangents;
 
-  // Allocate all cache data at once in a single allocation.
   // Alignment is guaranteed because memory is dispatch from the highest
   // alignment requirement (Soa data: SimdFloat4) to the lowest (outdated
   // flag: unsigned char).
-
-  // Computes allocation size.
   const size_t max_tracks = max_soa_tracks_ * 4;
   const size_t num_outdated = (max_soa_tracks_ + 7) / 8;
-  const size_t size =
-    sizeof(InterpSoaTranslation) * max_soa_tracks_  +
-    sizeof(InterpSoaRotation) * max_soa_tracks_ +
-    sizeof(InterpSoaScale) *max_soa_tracks_ +
-    sizeof(int) * max_tracks * 2 * 3 +  // 2 keys * (trans + rot + scale).
-    sizeof(unsigned char) * 3 * num_outdated;
-
-  // Allocates all at once.
-  memory::Allocator* allocator = memory::default_allocator();
-  char* alloc_begin = reinterpret_cast<char*>(
-    allocator->Allocate(size, AlignOf<InterpSoaTranslation>::value));
+  char* alloc_begin = reinterpret_cast<char*>(_buffer);
   char* alloc_cursor = alloc_begin;
 
-  // Dispatches allocated memory, from the highest alignment requirement to the
-  // lowest.
+  // Dispatches memory, from the highest alignment requirement to the lowest.
   soa_translations_ = reinterpret_cast<InterpSoaTranslation*>(alloc_cursor);
   alloc_cursor += sizeof(InterpSoaTranslation) * max_soa_tracks_;
   soa_rotations_ = reinterpret_cast<InterpSoaRotation*>(alloc_cursor);
   alloc_cursor += sizeof(InterpSoaRotation) * max_soa_tracks_;
   soa_scales_ = reinterpret_cast<InterpSoaScale*>(alloc_cursor);
   alloc_cursor += sizeof(InterpSoaScale) * max_soa_tracks_;
+  soa_tangents_ = reinterpret_cast<InterpSoaTangents*>(alloc_cursor);
+  alloc_cursor += sizeof(InterpSoaTangents) * max_soa_tracks_;
 
-  translation_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-  rotation_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-  scale_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
+  const size_t keys_size = KeyIndexSize(compact_) * max_tracks * 2;
+  translation_keys_ = alloc_cursor;
+  alloc_cursor += keys_size;
+  rotation_keys_ = alloc_cursor;
+  alloc_cursor += keys_size;
+  scale_keys_ = alloc_cursor;
+  alloc_cursor += keys_size;
 
   outdated_translations_ = reinterpret_cast<unsigned char*>(alloc_cursor);
   alloc_cursor += sizeof(unsigned char) * num_outdated;
@@ -478,31 +1667,248 @@ SamplingCache::SamplingCache(int _max_tracks)
   outdated_scales_ = reinterpret_cast<unsigned char*>(alloc_cursor);
   alloc_cursor += sizeof(unsigned char) * num_outdated;
 
-  assert(alloc_cursor == alloc_begin + size);
+  assert(alloc_cursor ==
+         alloc_begin + CacheBufferSize(max_soa_tracks_, compact_));
+}
+
+SamplingCache::Stats::Stats()
+    : keys(0),
+      soa_updates(0),
+      resets(0),
+      seeks(0) {
 }
 
 SamplingCache::~SamplingCache() {
   // Deallocates everything at once.
-  memory::default_allocator()->Deallocate(soa_translations_);
+  if (owns_buffer_) {
+    memory::default_allocator()->Deallocate(soa_translations_);
+  }
+}
+
+namespace {
+// Finds the last entry of _animation seek index whose key time is lower or
+// equal to _key_time, using a binary search. Returns NULL if there's none.
+const int32_t* FindSeekEntry(const Animation& _animation, float _key_time) {
+  const ozz::Range<const int32_t> index = _animation.seek_index();
+  const ptrdiff_t entry_size = SeekEntrySize(_animation.num_soa_tracks());
+  ptrdiff_t first = 0;
+  ptrdiff_t count = index.Count() / entry_size;
+  while (count > 0) {
+    const ptrdiff_t step = count / 2;
+    if (index.begin[(first + step) * entry_size] <= _key_time) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return first ? index.begin + (first - 1) * entry_size : NULL;
+}
+
+// Returns true if updating a stream keys to _key_time would rewind it, which
+// happens if the left key of the last fetched key was fetched after
+// _key_time (see UpdateKeys). Backward steps within the current keys interval
+// of every track, like time jitter, don't rewind.
+template<typename _Key, typename _Index>
+bool StreamRewinds(float _key_time, int _num_soa_tracks, int _num_constants,
+                   ozz::Range<const _Key> _keys, int _cursor,
+                   const _Index* _cache) {
+  const int num_first_keys = _num_constants +
+    (_num_soa_tracks * 4 - _num_constants) * 2;
+  return _cursor > num_first_keys &&
+    _keys.begin[_cache[_keys.begin[_cursor - 1].track * 2]].time > _key_time;
+}
+
+// Returns the key time at which a stream, whose keys were fetched up to
+// _cursor, needs its next key: the time of the right key of the track of the
+// key at _cursor. Returns a key time greater than kMaxKeyTime if all the keys
+// were fetched.
+template<typename _Key, typename _Index>
+int StreamNextKey(ozz::Range<const _Key> _keys, int _cursor,
+                  const _Index* _cache) {
+  if (_keys.begin + _cursor >= _keys.end) {
+    return kMaxKeyTime + 1;
+  }
+  return _keys.begin[_cache[_keys.begin[_cursor].track * 2 + 1]].time;
+}
+
+// Restores a stream key cursor and track keys from a seek index entry _state.
+// All soa entries are outdated.
+template<typename _Index>
+const int32_t* SeekKeys(const int32_t* _state, int _num_soa_tracks,
+                        int* _cursor, _Index* _cache,
+                        unsigned char* _outdated) {
+  const int stream_size = SeekStreamSize(_num_soa_tracks);
+  *_cursor = _state[0];
+  for (int i = 1; i < stream_size; ++i) {
+    _cache[i - 1] = static_cast<_Index>(_state[i]);
+  }
+  OutdateAll(_num_soa_tracks, _outdated);
+  return _state + stream_size;
+}
+}  // namespace
+
+template<typename _Index>
+void SamplingCache::Seek(const int32_t* _entry, int _num_soa_tracks) {
+  const int32_t* state = _entry + 1;
+  state = SeekKeys(state, _num_soa_tracks, &translation_cursor_,
+                   static_cast<_Index*>(translation_keys_),
+                   outdated_translations_);
+  state = SeekKeys(state, _num_soa_tracks, &rotation_cursor_,
+                   static_cast<_Index*>(rotation_keys_),
+                   outdated_rotations_);
+  SeekKeys(state, _num_soa_tracks, &scale_cursor_,
+           static_cast<_Index*>(scale_keys_),
+           outdated_scales_);
+}
+
+template<typename _Index>
+bool SamplingCache::Rewinds(const Animation& _animation,
+                            float _key_time) const {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  return StreamRewinds(_key_time, num_soa_tracks,
+                       _animation.num_constant_translations(),
+                       _animation.translations(), translation_cursor_,
+                       static_cast<const _Index*>(translation_keys_)) ||
+         StreamRewinds(_key_time, num_soa_tracks,
+                       _animation.num_constant_rotations(),
+                       _animation.rotations(), rotation_cursor_,
+                       static_cast<const _Index*>(rotation_keys_)) ||
+         StreamRewinds(_key_time, num_soa_tracks,
+                       _animation.num_constant_scales(),
+                       _animation.scales(), scale_cursor_,
+                       static_cast<const _Index*>(scale_keys_));
+}
+
+template<typename _Index>
+int SamplingCache::NextKey(const Animation& _animation) const {
+  const int translation =
+    StreamNextKey(_animation.translations(), translation_cursor_,
+                  static_cast<const _Index*>(translation_keys_));
+  const int rotation =
+    StreamNextKey(_animation.rotations(), rotation_cursor_,
+                  static_cast<const _Index*>(rotation_keys_));
+  const int scale =
+    StreamNextKey(_animation.scales(), scale_cursor_,
+                  static_cast<const _Index*>(scale_keys_));
+  return math::Min(translation, math::Min(rotation, scale));
+}
+
+float SamplingCache::NextKeyTime(const Animation& _animation) const {
+  // Keys are fetched as soon as the cache is used with another animation.
+  if (animation_id_ != _animation.id() || !translation_cursor_) {
+    return 0.f;
+  }
+  const int key = compact_ ? NextKey<uint16_t>(_animation) :
+                             NextKey<int>(_animation);
+  if (key > kMaxKeyTime) {
+    return std::numeric_limits<float>::max();
+  }
+  return key * (_animation.duration() / kMaxKeyTime);
 }
 
 void SamplingCache::Step(const Animation& _animation, float _time) {
-  // The cache is invalidated if animation has changed or if it is being rewind.
-  if (animation_ != &_animation || _time < time_) {
-    animation_ = &_animation;
+  // The cache is invalidated if animation has changed. It is rewound while
+  // updating keys otherwise, see UpdateKeys.
+  if (animation_id_ != _animation.id()) {
+    animation_id_ = _animation.id();
     translation_cursor_ = 0;
     rotation_cursor_ = 0;
     scale_cursor_ = 0;
+#ifdef OZZ_HAS_STATS
+    ++stats_.resets;
+#endif  // OZZ_HAS_STATS
+  }
+
+  // Restores the cache from the last seek index entry before _time, if the
+  // cache is invalid or late compared to this entry, or if it would otherwise
+  // be rewound to the first keys.
+  if (_animation.seek_index().begin != _animation.seek_index().end) {
+    const float duration = _animation.duration();
+    const int32_t* entry = FindSeekEntry(_animation,
+                                         ToKeyTime(_time, duration));
+    const bool rewind = _time < time_ &&
+      _animation.key_links().begin == _animation.key_links().end &&
+      (compact_ ? Rewinds<uint16_t>(_animation, ToKeyTime(_time, duration)) :
+                  Rewinds<int>(_animation, ToKeyTime(_time, duration)));
+    if (entry &&
+        (!translation_cursor_ || rewind ||
+         entry[0] > ToKeyTime(time_, duration))) {
+      if (compact_) {
+        Seek<uint16_t>(entry, _animation.num_soa_tracks());
+      } else {
+        Seek<int>(entry, _animation.num_soa_tracks());
+      }
+#ifdef OZZ_HAS_STATS
+      ++stats_.seeks;
+#endif  // OZZ_HAS_STATS
+    }
   }
   time_ = _time;
 }
 
 void SamplingCache::Invalidate() {
-  animation_ = NULL;
+  animation_id_ = 0;
   time_ = 0.f;
   translation_cursor_ = 0;
   rotation_cursor_ = 0;
   scale_cursor_ = 0;
 }
+
+namespace {
+// Defines the header of a cache snapshot, followed by a copy of the cache
+// buffer.
+struct SnapshotHeader {
+  uint32_t animation_id;
+  float time;
+  int max_soa_tracks;
+  int compact;
+  int translation_cursor;
+  int rotation_cursor;
+  int scale_cursor;
+};
+}  // namespace
+
+size_t SamplingCache::snapshot_size() const {
+  return sizeof(SnapshotHeader) + CacheBufferSize(max_soa_tracks_, compact_);
+}
+
+bool SamplingCache::Snapshot(void* _snapshot, size_t _size) const {
+  if (!_snapshot || _size < snapshot_size()) {
+    return false;
+  }
+  const SnapshotHeader header = {animation_id_, time_, max_soa_tracks_,
+                                 compact_, translation_cursor_,
+                                 rotation_cursor_, scale_cursor_};
+  char* snapshot = static_cast<char*>(_snapshot);
+  std::memcpy(snapshot, &header, sizeof(header));
+
+  // Cache buffers are contiguous, starting with soa translations.
+  std::memcpy(snapshot + sizeof(header), soa_translations_,
+              CacheBufferSize(max_soa_tracks_, compact_));
+  return true;
+}
+
+bool SamplingCache::Restore(const void* _snapshot, size_t _size) {
+  if (!_snapshot || _size < snapshot_size()) {
+    return false;
+  }
+  const char* snapshot = static_cast<const char*>(_snapshot);
+  SnapshotHeader header;
+  std::memcpy(&header, snapshot, sizeof(header));
+  if (header.max_soa_tracks != max_soa_tracks_ ||
+      (header.compact != 0) != compact_) {
+    return false;
+  }
+
+  animation_id_ = header.animation_id;
+  time_ = header.time;
+  translation_cursor_ = header.translation_cursor;
+  rotation_cursor_ = header.rotation_cursor;
+  scale_cursor_ = header.scale_cursor;
+  std::memcpy(soa_translations_, snapshot + sizeof(header),
+              CacheBufferSize(max_soa_tracks_, compact_));
+  return true;
+}
 }  // animation
 }  // ozz
@@ -0,0 +1,196 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/shared_sampling_cache.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/base/containers/internal/atomic.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Computes the hash of an entry key, from its animation id and time.
+uint32_t HashKey(uint32_t _animation_id, float _time) {
+  uint32_t time;
+  std::memcpy(&time, &_time, sizeof(time));
+  uint32_t hash = 2166136261u;  // FNV-1a.
+  hash = (hash ^ _animation_id) * 16777619u;
+  hash = (hash ^ time) * 16777619u;
+  return hash ^ (hash >> 16);
+}
+
+// Slot states are frame * 2 + kClaimed while the entry is being sampled, and
+// frame * 2 + kPublished once it's published. A slot whose state is lower than
+// the current frame claimed state is free.
+enum {
+  kClaimed = 0,
+  kPublished = 1,
+};
+}  // namespace
+
+SharedSamplingCache::SharedSamplingCache(int _max_tracks,
+                                         int _capacity,
+                                         float _time_step)
+    : max_soa_tracks_((_max_tracks + 3) / 4),
+      num_slots_(1),
+      time_step_(_time_step),
+      frame_(1),
+      slab_(NULL),
+      locals_(NULL),
+      states_(NULL),
+      keys_(NULL) {
+  assert(_max_tracks >= 0 && _capacity >= 0 && _time_step >= 0.f);
+
+  while (num_slots_ < _capacity) {
+    num_slots_ *= 2;
+  }
+
+  // Computes slab layout, from the highest alignment requirement to the
+  // lowest: local transforms, states and keys.
+  const size_t alignment = AlignOf<math::SoaTransform>::value;
+  const size_t states_offset = math::Align(
+    sizeof(math::SoaTransform) * max_soa_tracks_ * num_slots_,
+    AlignOf<int64_t>::value);
+  const size_t keys_offset = states_offset + sizeof(int64_t) * num_slots_;
+  const size_t size = keys_offset + sizeof(Key) * num_slots_;
+
+  memory::ScopedTag tag(memory::kTagCache);
+  memory::Allocator* allocator = memory::default_allocator();
+  slab_ = reinterpret_cast<char*>(allocator->Allocate(size, alignment));
+  locals_ = reinterpret_cast<math::SoaTransform*>(slab_);
+  states_ = reinterpret_cast<int64_t*>(slab_ + states_offset);
+  keys_ = reinterpret_cast<Key*>(slab_ + keys_offset);
+
+  // All slots are free, as they belong to frame 0.
+  for (int i = 0; i < num_slots_; ++i) {
+    states_[i] = 0;
+  }
+}
+
+SharedSamplingCache::~SharedSamplingCache() {
+  memory::default_allocator()->Deallocate(slab_);
+}
+
+float SharedSamplingCache::Quantize(float _time) const {
+  if (time_step_ <= 0.f) {
+    return _time;
+  }
+  return std::floor(_time / time_step_ + .5f) * time_step_;
+}
+
+void SharedSamplingCache::NewFrame() {
+  ++frame_;
+}
+
+int SharedSamplingCache::num_entries() const {
+  const int64_t published = frame_ * 2 + kPublished;
+  int count = 0;
+  for (int i = 0; i < num_slots_; ++i) {
+    count += containers::internal::Load(states_ + i) == published;
+  }
+  return count;
+}
+
+bool SharedSamplingCache::Sample(const Animation& _animation,
+                                 float _time,
+                                 SamplingCache* _cache,
+                                 Range<math::SoaTransform> _output) {
+  using containers::internal::CompareExchange;
+  using containers::internal::Exchange;
+  using containers::internal::Load;
+
+  // Validates arguments, so that sampling can't fail once a slot is claimed.
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  if (!_cache || num_soa_tracks > max_soa_tracks_ ||
+      _output.end - _output.begin < num_soa_tracks ||
+      !SamplingJob::IsCompatible(_animation, *_cache)) {
+    return false;
+  }
+
+  const Key key = {_animation.id(), Quantize(_time)};
+  const int64_t claimed = frame_ * 2 + kClaimed;
+  const int64_t published = frame_ * 2 + kPublished;
+  const size_t size = sizeof(math::SoaTransform) * num_soa_tracks;
+
+  SamplingJob job;
+  job.animation = &_animation;
+  job.cache = _cache;
+  job.time = key.time;
+
+  // Looks for the entry in the hash table, using linear probing. Entries are
+  // never removed within a frame, so the first free slot ends the search.
+  const int slot_mask = num_slots_ - 1;
+  int slot = static_cast<int>(HashKey(key.animation_id, key.time) & slot_mask);
+  for (int i = 0; i < num_slots_; ++i, slot = (slot + 1) & slot_mask) {
+    int64_t state = Load(states_ + slot);
+    if (state < claimed) {
+      if (CompareExchange(states_ + slot, claimed, state) == state) {
+        // The slot is claimed, samples and publishes the entry. Publishing is
+        // a full memory barrier, so the key and transforms are visible to
+        // other threads once they see the published state.
+        math::SoaTransform* locals = locals_ + slot * max_soa_tracks_;
+        job.output.begin = locals;
+        job.output.end = locals + num_soa_tracks;
+        if (!job.Run()) {
+          Exchange(states_ + slot, state);  // Releases the slot.
+          return false;
+        }
+        keys_[slot] = key;
+        Exchange(states_ + slot, published);
+        std::memcpy(_output.begin, locals, size);
+        return true;
+      }
+      // Another thread claimed the slot first.
+      state = Load(states_ + slot);
+    }
+    if (state == published &&
+        keys_[slot].animation_id == key.animation_id &&
+        keys_[slot].time == key.time) {
+      std::memcpy(_output.begin, locals_ + slot * max_soa_tracks_, size);
+      return true;
+    }
+  }
+
+  // The cache is full, samples directly to the output.
+  job.output = _output;
+  return job.Run();
+}
+}  // animation
+}  // ozz
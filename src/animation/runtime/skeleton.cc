@@ -33,27 +33,53 @@
 #include <cstring>
 
 #include "ozz/base/io/archive.h"
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_math_archive.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/tasks/task_dispatcher.h"
 
 namespace ozz {
 namespace io {
 // JointProperties' version can be declared locally as it will be saved from this
 // cpp file only.
-OZZ_IO_TYPE_VERSION(1, animation::Skeleton::JointProperties)
+OZZ_IO_TYPE_VERSION(2, animation::Skeleton::JointProperties)
 
 // Specializes Skeleton::JointProperties. This structure's bitset isn't written
-// as-is because of endianness issues.
+// as-is because of endianness issues. Each joint is written as a uint16_t
+// parent index followed by a bool leaf flag. Joints are processed by chunks,
+// each chunk being saved/loaded with a single stream call.
+namespace {
+const size_t kJointArchiveSize = sizeof(uint16_t) + sizeof(bool);
+const size_t kJointChunkSize = 256;
+
+// Parent index of root joints in version 1, where joint indices were stored
+// with 10 bits.
+const uint16_t kNoParentIndexV1 = (1 << 10) - 1;
+}  // namespace
+
 template <>
 void Save(OArchive& _archive,
           const animation::Skeleton::JointProperties* _properties,
           size_t _count) {
-  for (size_t i = 0; i < _count; ++i) {
-    uint16_t parent = _properties[i].parent;
-    _archive << parent;
-    bool is_leaf = _properties[i].is_leaf != 0;
-    _archive << is_leaf;
+  const bool swap = _archive.endian_swap();
+  char chunk[kJointChunkSize * kJointArchiveSize];
+  for (size_t i = 0; i < _count; i += kJointChunkSize) {
+    const size_t chunk_count =
+      _count - i < kJointChunkSize ? _count - i : kJointChunkSize;
+    char* cursor = chunk;
+    for (size_t j = 0; j < chunk_count; ++j) {
+      uint16_t parent = _properties[i + j].parent;
+      if (swap) {
+        parent = EndianSwapper<uint16_t>::Swap(parent);
+      }
+      const bool is_leaf = _properties[i + j].is_leaf != 0;
+      std::memcpy(cursor, &parent, sizeof(parent)); cursor += sizeof(parent);
+      std::memcpy(cursor, &is_leaf, sizeof(is_leaf)); cursor += sizeof(is_leaf);
+    }
+    const size_t chunk_size = chunk_count * kJointArchiveSize;
+    OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(chunk, chunk_size);
+    assert(size == chunk_size);
   }
 }
 
@@ -62,25 +88,108 @@ void Load(IArchive& _archive,
           animation::Skeleton::JointProperties* _properties,
           size_t _count,
           uint32_t _version) {
-  (void)_version;
-  for (size_t i = 0; i < _count; ++i) {
-    uint16_t parent;
-    _archive >> parent;
-    _properties[i].parent = parent;
-    bool is_leaf;
-    _archive >> is_leaf;
-    _properties[i].is_leaf = is_leaf;
+  const bool swap = _archive.endian_swap();
+  char chunk[kJointChunkSize * kJointArchiveSize];
+  for (size_t i = 0; i < _count; i += kJointChunkSize) {
+    const size_t chunk_count =
+      _count - i < kJointChunkSize ? _count - i : kJointChunkSize;
+    const size_t chunk_size = chunk_count * kJointArchiveSize;
+    OZZ_IF_DEBUG(size_t size =) _archive.LoadBinary(chunk, chunk_size);
+    assert(size == chunk_size);
+    const char* cursor = chunk;
+    for (size_t j = 0; j < chunk_count; ++j) {
+      uint16_t parent;
+      bool is_leaf;
+      std::memcpy(&parent, cursor, sizeof(parent)); cursor += sizeof(parent);
+      std::memcpy(&is_leaf, cursor, sizeof(is_leaf)); cursor += sizeof(is_leaf);
+      if (swap) {
+        parent = EndianSwapper<uint16_t>::Swap(parent);
+      }
+      // Remaps version 1 roots to the current kNoParentIndex.
+      if (_version < 2 && parent == kNoParentIndexV1) {
+        parent = animation::Skeleton::kNoParentIndex;
+      }
+      _properties[i + j].parent = parent;
+      _properties[i + j].is_leaf = is_leaf;
+    }
   }
 }
 }  // io
 
 namespace animation {
 
+namespace {
+// Hashes _name using FNV-1a algorithm.
+uint32_t HashName(const char* _name) {
+  uint32_t hash = 2166136261u;
+  for (const char* c = _name; *c; ++c) {
+    hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+  }
+  return hash;
+}
+
+// Skips _size bytes of _archive, to seek past data that aren't loaded.
+void Skip(ozz::io::IArchive& _archive, int64_t _size) {
+  OZZ_IF_DEBUG(int seek =) _archive.stream()->Seek(_size,
+                                                   ozz::io::Stream::kCurrent);
+  assert(seek == 0);
+}
+
+// Number of joint names hashed by a HashTask work item.
+const int kHashChunkSize = 256;
+
+// Hashes a chunk of kHashChunkSize joint names per work item.
+class HashTask : public tasks::Task {
+ public:
+  HashTask(const char* const* _names, int _num_names, uint32_t* _hashes)
+      : names_(_names),
+        num_names_(_num_names),
+        hashes_(_hashes) {
+  }
+  virtual void Run(int _index) const {
+    const int begin = _index * kHashChunkSize;
+    const int end = begin + kHashChunkSize < num_names_ ?
+                    begin + kHashChunkSize : num_names_;
+    for (int i = begin; i < end; ++i) {
+      hashes_[i] = HashName(names_[i]);
+    }
+  }
+
+ private:
+  const char* const* names_;
+  int num_names_;
+  uint32_t* hashes_;
+};
+
+// Allocator of the skeleton buffers, NULL for the default allocator.
+memory::Allocator* g_buffer_allocator = NULL;
+}  // namespace
+
+memory::Allocator* Skeleton::SetBufferAllocator(
+  memory::Allocator* _allocator) {
+  memory::Allocator* previous = g_buffer_allocator;
+  g_buffer_allocator = _allocator;
+  return previous;
+}
+
+memory::Allocator* Skeleton::buffer_allocator() {
+  return g_buffer_allocator ? g_buffer_allocator : memory::default_allocator();
+}
+
 Skeleton::Skeleton()
-    : joint_properties_(NULL),
+    : allocator_(buffer_allocator()),
+      joint_properties_(NULL),
       bind_pose_(NULL),
       joint_names_(NULL),
-      num_joints_(0) {
+      joint_name_hashes_(NULL),
+      joint_names_lookup_(NULL),
+      joint_names_lookup_size_(0),
+      lod_num_joints_(NULL),
+      num_lods_(0),
+      num_joints_(0),
+      scaled_(false),
+      uniformly_scaled_(true),
+      joint_names_loading_(kLoadJointNames) {
 }
 
 Skeleton::~Skeleton() {
@@ -88,15 +197,25 @@ Skeleton::~Skeleton() {
 }
 
 void Skeleton::Destroy() {
-  memory::Allocator* allocator = memory::default_allocator();
+  memory::Allocator* allocator = allocator_;
   allocator->Deallocate(joint_properties_);
   joint_properties_ = NULL;
   allocator->Deallocate(bind_pose_);
   bind_pose_ = NULL;
   allocator->Deallocate(joint_names_);
   joint_names_ = NULL;
+  allocator->Deallocate(joint_name_hashes_);
+  joint_name_hashes_ = NULL;
+  allocator->Deallocate(joint_names_lookup_);
+  joint_names_lookup_ = NULL;
+  joint_names_lookup_size_ = 0;
+  allocator->Deallocate(lod_num_joints_);
+  lod_num_joints_ = NULL;
+  num_lods_ = 0;
 
   num_joints_ = 0;
+  scaled_ = false;
+  uniformly_scaled_ = true;
 }
 
 // This function is not inlined in order to avoid the inclusion of SoaTransform.
@@ -105,6 +224,84 @@ Range<const math::SoaTransform> Skeleton::bind_pose() const {
                                          bind_pose_ + ((num_joints_ + 3) / 4));
 }
 
+void Skeleton::DetectScale() {
+  // Soa padding joints have unit scales.
+  const math::SimdFloat4 one = math::simd_float4::one();
+  scaled_ = false;
+  uniformly_scaled_ = true;
+  for (int i = 0; i < num_soa_joints(); ++i) {
+    const math::SoaFloat3& scale = bind_pose_[i].scale;
+    scaled_ |= !math::AreAllTrue(math::And(
+      math::And(math::CmpEq(scale.x, one), math::CmpEq(scale.y, one)),
+      math::CmpEq(scale.z, one)));
+    uniformly_scaled_ &= math::AreAllTrue(math::And(
+      math::CmpEq(scale.x, scale.y), math::CmpEq(scale.x, scale.z)));
+  }
+}
+
+void Skeleton::BuildJointNamesLookup(tasks::Dispatcher* _dispatcher) {
+  assert(!joint_name_hashes_ && !joint_names_lookup_);
+
+  // Lookup table size is the power of 2 above twice the number of joints,
+  // which ensures short probing sequences.
+  int lookup_size = 1;
+  while (lookup_size < num_joints_ * 2) {
+    lookup_size <<= 1;
+  }
+
+  memory::Allocator* allocator = allocator_;
+  joint_name_hashes_ = allocator->Allocate<uint32_t>(num_joints_);
+  joint_names_lookup_ = allocator->Allocate<uint16_t>(lookup_size);
+  joint_names_lookup_size_ = lookup_size;
+
+  for (int i = 0; i < lookup_size; ++i) {
+    joint_names_lookup_[i] = kNoParentIndex;
+  }
+
+  // Hashes names concurrently, then fills the lookup table sequentially as
+  // probing depends on the joints inserted before.
+  if (num_joints_) {
+    const HashTask task(joint_names_, num_joints_, joint_name_hashes_);
+    tasks::Dispatcher* task_dispatcher =
+      _dispatcher ? _dispatcher : tasks::serial_dispatcher();
+    task_dispatcher->Dispatch(
+      task, (num_joints_ + kHashChunkSize - 1) / kHashChunkSize);
+  }
+  const uint32_t mask = static_cast<uint32_t>(lookup_size - 1);
+  for (int i = 0; i < num_joints_; ++i) {
+    uint32_t bucket = joint_name_hashes_[i] & mask;
+    while (joint_names_lookup_[bucket] != kNoParentIndex) {  // Linear probing.
+      bucket = (bucket + 1) & mask;
+    }
+    joint_names_lookup_[bucket] = static_cast<uint16_t>(i);
+  }
+}
+
+int Skeleton::FindJoint(const char* _name) const {
+  if (!_name || !joint_names_lookup_) {
+    return -1;
+  }
+  const uint32_t hash = HashName(_name);
+  const uint32_t mask = static_cast<uint32_t>(joint_names_lookup_size_ - 1);
+  for (uint32_t bucket = hash & mask;; bucket = (bucket + 1) & mask) {
+    const int index = joint_names_lookup_[bucket];
+    if (index == kNoParentIndex) {
+      return -1;
+    }
+    if (joint_name_hashes_[index] == hash &&
+        (!joint_names_ || std::strcmp(joint_names_[index], _name) == 0)) {
+      return index;
+    }
+  }
+}
+
+int Skeleton::num_joints_lod(int _lod) const {
+  if (!num_lods_) {
+    return num_joints_;
+  }
+  return lod_num_joints_[math::Clamp(0, _lod, num_lods_ - 1)];
+}
+
 void Skeleton::Save(ozz::io::OArchive& _archive) const {
 
   // Early out if skeleton's empty.
@@ -113,28 +310,48 @@ void Skeleton::Save(ozz::io::OArchive& _archive) const {
     return;
   }
 
-  // Stores names. They are all concatenated in the same buffer, starting at
-  // joint_names_[0].
-  size_t chars_count = 0;
-  for (int i = 0; i < num_joints_; ++i) {
-    chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
-  }
-  _archive << static_cast<int32_t>(chars_count);
-  _archive << ozz::io::MakeArray(joint_names_[0], chars_count);
-
-  // Stores joint's properties.
+  // Stores hot data first: joint's properties, bind poses and lods.
   _archive << ozz::io::MakeArray(joint_properties_, num_joints_);
-
-  // Stores bind poses.
   _archive << ozz::io::MakeArray(bind_pose_, num_soa_joints());
+  _archive << static_cast<int32_t>(num_lods_);
+  _archive << ozz::io::MakeArray(lod_num_joints_, num_lods_);
+
+  // Stores joint names hashes and lookup table, which can be omitted if they
+  // weren't loaded.
+  _archive << static_cast<int32_t>(joint_names_lookup_size_);
+  if (joint_names_lookup_size_) {
+    _archive << ozz::io::MakeArray(joint_name_hashes_, num_joints_);
+    _archive << ozz::io::MakeArray(joint_names_lookup_,
+                                   joint_names_lookup_size_);
+  }
+
+  // Stores names, last so they can be skipped. They are all concatenated in
+  // the same buffer, starting at joint_names_[0]. Names that weren't loaded
+  // are stored as empty strings.
+  if (joint_names_) {
+    size_t chars_count = 0;
+    for (int i = 0; i < num_joints_; ++i) {
+      chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
+    }
+    _archive << static_cast<int32_t>(chars_count);
+    _archive << ozz::io::MakeArray(joint_names_[0], chars_count);
+  } else {
+    _archive << static_cast<int32_t>(num_joints_);
+    for (int i = 0; i < num_joints_; ++i) {
+      _archive << '\0';
+    }
+  }
 }
 
 void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
-  (void)_version;
-
   // Destroy skeleton in case it was already used before.
   Destroy();
 
+  // Buffers are allocated with the current buffer allocator.
+  allocator_ = buffer_allocator();
+
+  memory::ScopedTag tag(memory::kTagSkeleton);
+
   int32_t num_joints;
   _archive >> num_joints;
   num_joints_ = num_joints;
@@ -144,14 +361,108 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
     return;
   }
 
-  // Read names.
+  // Versions prior to 4 stored names first.
+  if (_version < 4) {
+    LoadJointNames(_archive, _version);
+  }
+
+  // Reads joint's properties.
+  memory::Allocator* allocator = allocator_;
+  joint_properties_ =
+    allocator->Allocate<Skeleton::JointProperties>(num_joints_);
+  _archive >> ozz::io::MakeArray(joint_properties_, num_joints_);
+
+  // Reads bind pose.
+  bind_pose_ = allocator->Allocate<math::SoaTransform>(num_soa_joints());
+  _archive >> ozz::io::MakeArray(bind_pose_, num_soa_joints());
+  DetectScale();
+
+  if (_version < 4) {
+    // Version 1 didn't store joint names lookup table, so it's rebuilt.
+    if (_version < 2) {
+      BuildJointNamesLookup(NULL);
+    } else {
+      LoadJointNamesLookup(_archive, _version);
+      // Version 2 didn't store lods.
+      if (_version >= 3) {
+        LoadLods(_archive);
+      }
+    }
+    // Names were loaded first, so they are released now if they aren't
+    // required.
+    if (joint_names_loading_ == kSkipJointNames) {
+      allocator->Deallocate(joint_name_hashes_);
+      joint_name_hashes_ = NULL;
+      allocator->Deallocate(joint_names_lookup_);
+      joint_names_lookup_ = NULL;
+      joint_names_lookup_size_ = 0;
+    }
+    if (joint_names_loading_ != kLoadJointNames) {
+      allocator->Deallocate(joint_names_);
+      joint_names_ = NULL;
+    }
+    return;
+  }
+
+  LoadLods(_archive);
+  LoadJointNamesLookup(_archive, _version);
+  LoadJointNames(_archive, _version);
+}
+
+void Skeleton::LoadLods(ozz::io::IArchive& _archive) {
+  int32_t num_lods;
+  _archive >> num_lods;
+  num_lods_ = num_lods;
+  if (num_lods_) {
+    lod_num_joints_ =
+      allocator_->Allocate<uint16_t>(num_lods_);
+    _archive >> ozz::io::MakeArray(lod_num_joints_, num_lods_);
+  }
+}
+
+void Skeleton::LoadJointNamesLookup(ozz::io::IArchive& _archive,
+                                    uint32_t _version) {
+  // Versions prior to 4 always stored the lookup table, and its size after
+  // joint names hashes.
+  int32_t lookup_size = 0;
+  if (_version >= 4) {
+    _archive >> lookup_size;
+    if (!lookup_size) {
+      return;
+    }
+    if (joint_names_loading_ == kSkipJointNames) {
+      Skip(_archive, num_joints_ * sizeof(uint32_t) +
+                     lookup_size * sizeof(uint16_t));
+      return;
+    }
+  }
+
+  memory::Allocator* allocator = allocator_;
+  joint_name_hashes_ = allocator->Allocate<uint32_t>(num_joints_);
+  _archive >> ozz::io::MakeArray(joint_name_hashes_, num_joints_);
+  if (_version < 4) {
+    _archive >> lookup_size;
+  }
+  joint_names_lookup_size_ = lookup_size;
+  joint_names_lookup_ = allocator->Allocate<uint16_t>(lookup_size);
+  _archive >> ozz::io::MakeArray(joint_names_lookup_, lookup_size);
+}
+
+void Skeleton::LoadJointNames(ozz::io::IArchive& _archive, uint32_t _version) {
   int32_t chars_count;
   _archive >> chars_count;
 
+  // Versions prior to 4 stored names first, they are always loaded as hashes
+  // are rebuilt from them for version 1.
+  if (_version >= 4 && joint_names_loading_ != kLoadJointNames) {
+    Skip(_archive, chars_count);
+    return;
+  }
+
   // Allocates and reads name's buffer. Names are stored at the end off the
   // array of pointers.
   const size_t buffer_size = num_joints_ * sizeof(char*) + chars_count;
-  joint_names_ = memory::default_allocator()->Allocate<char*>(buffer_size);
+  joint_names_ = allocator_->Allocate<char*>(buffer_size);
   char* cursor = reinterpret_cast<char*>(joint_names_ + num_joints_);
   _archive >> ozz::io::MakeArray(cursor, chars_count);
 
@@ -160,16 +471,6 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
     joint_names_[i] = cursor;
     cursor += std::strlen(joint_names_[i]) + 1;
   }
-
-  // Reads joint's properties.
-  joint_properties_ = 
-    memory::default_allocator()->Allocate<Skeleton::JointProperties>(num_joints_);
-  _archive >> ozz::io::MakeArray(joint_properties_, num_joints_);
-
-  // Reads bind pose.
-  bind_pose_ =
-    memory::default_allocator()->Allocate<math::SoaTransform>(num_soa_joints());
-  _archive >> ozz::io::MakeArray(bind_pose_, num_soa_joints());
 }
 }  // animation
 }  // ozz
@@ -30,9 +30,12 @@
 
 #include "ozz/animation/runtime/skeleton_utils.h"
 
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
 
 #include <assert.h>
+#include <cstring>
 
 namespace ozz {
 namespace animation {
@@ -68,40 +71,30 @@ ozz::math::Transform GetJointBindPose(const Skeleton& _skeleton, int _joint) {
   ((_i + 1 < _num_joints) &&\
    (_properties[_i].parent == _properties[_i + 1].parent))
 
+namespace {
+// Traversal stack entry, used to unroll usual recursive implementation.
+struct DFContext {
+  uint16_t joint:15;
+  uint16_t has_brother:1;
+};
+
 // Implement joint hierarchy depth-first traversal.
 // Uses a non-recursive implementation to control stack usage (ie: making
 // algorithm behavior (stack consumption) independent off the data being
-// processed).
-void IterateJointsDF(const Skeleton& _skeleton,
-                     int _from,
-                     JointsIterator* _iterator) {
-  assert(_iterator);
+// processed). _joints and _stack must both be able to store num_joints
+// entries. Returns the number of joints written to _joints.
+int IterateDF(const Skeleton& _skeleton,
+              int _from,
+              uint16_t* _joints,
+              DFContext* _stack) {
   const int num_joints = _skeleton.num_joints();
   Range<const Skeleton::JointProperties> properties =
     _skeleton.joint_properties();
-
-  // Initialize iterator.
-  _iterator->num_joints = 0;
-
-  // Validates input range first.
-  if (num_joints == 0) {
-    return;
-  }
-  if ((_from < 0 || _from >= num_joints) &&
-      _from != Skeleton::kNoParentIndex) {
-    return;
-  }
-
-  // Simulate a stack to unroll usual recursive implementation.
-  struct Context {
-    uint16_t joint:15;
-    uint16_t has_brother:1;
-  };
-  Context stack[Skeleton::kMaxJoints];
+  int num_iterated = 0;
   int stack_size = 0;
 
   // Initializes iteration start.
-  Context start;
+  DFContext start;
   if (_from != Skeleton::kNoParentIndex) {
     start.joint = _from;
     start.has_brother = false;  // Disallow brother processing.
@@ -109,14 +102,14 @@ void IterateJointsDF(const Skeleton& _skeleton,
     start.joint = 0;
     start.has_brother = _HAS_SIBLING(0, num_joints, properties.begin);
   }
-  stack[stack_size++] = start;
+  _stack[stack_size++] = start;
 
   for (; stack_size != 0;) {
     // Process next joint on the stack.
-    const Context& top = stack[stack_size - 1];
+    const DFContext& top = _stack[stack_size - 1];
 
     // Push that joint to the list and then process its child.
-    _iterator->joints[_iterator->num_joints++] = top.joint;
+    _joints[num_iterated++] = top.joint;
 
     // Skip all the joints until the first child is found.
     if (!properties.begin[top.joint].is_leaf) {  // A leaf has no child anyway.
@@ -127,28 +120,146 @@ void IterateJointsDF(const Skeleton& _skeleton,
            ++next_joint) {
       }
       if (next_joint < num_joints) {
-        const Context next = {
+        const DFContext next = {
           next_joint,
           _HAS_SIBLING(next_joint, num_joints, properties.begin)};
-        stack[stack_size++] = next;  // Push child and process it.
+        _stack[stack_size++] = next;  // Push child and process it.
         continue;
       }
     }
 
     // Rewind the stack while there's no brother to process.
-    for (;stack_size != 0 && !stack[stack_size - 1].has_brother; --stack_size) {
+    for (; stack_size != 0 && !_stack[stack_size - 1].has_brother;
+         --stack_size) {
     }
 
     // Replace top joint by its brother.
     if (stack_size != 0) {
-      Context& next = stack[stack_size - 1];
+      DFContext& next = _stack[stack_size - 1];
       assert(next.has_brother && next.joint + 1 < num_joints);
 
       ++next.joint;  // The brother is the next joint in breadth-first order.
       next.has_brother = _HAS_SIBLING(next.joint, num_joints, properties.begin);
     }
   }
+
+  return num_iterated;
+}
+
+// Validates IterateJointsDF inputs.
+bool ValidateDF(const Skeleton& _skeleton, int _from) {
+  const int num_joints = _skeleton.num_joints();
+  if (num_joints == 0) {
+    return false;
+  }
+  return (_from >= 0 && _from < num_joints) ||
+         _from == Skeleton::kNoParentIndex;
+}
+}  // namespace
+
+void IterateJointsDF(const Skeleton& _skeleton,
+                     int _from,
+                     JointsIterator* _iterator) {
+  assert(_iterator);
+  _iterator->num_joints = 0;
+  if (!ValidateDF(_skeleton, _from)) {
+    return;
+  }
+  DFContext stack[Skeleton::kMaxJoints];
+  _iterator->num_joints = IterateDF(_skeleton, _from, _iterator->joints, stack);
+}
+
+int IterateJointsDF(const Skeleton& _skeleton,
+                    int _from,
+                    Range<uint16_t> _joints,
+                    memory::Allocator* _scratch) {
+  const int num_joints = _skeleton.num_joints();
+  if (!ValidateDF(_skeleton, _from) ||
+      _joints.end - _joints.begin < num_joints) {
+    return 0;
+  }
+  memory::Allocator* scratch =
+    _scratch ? _scratch : memory::default_allocator();
+  DFContext* stack = scratch->Allocate<DFContext>(num_joints);
+  const int num_iterated = IterateDF(_skeleton, _from, _joints.begin, stack);
+  scratch->Deallocate(stack);
+  return num_iterated;
 }
 #undef _HAS_SIBLING
+
+int BuildJointEvaluationList(const Skeleton& _skeleton,
+                             Range<const int> _joints,
+                             Range<uint16_t> _list,
+                             Range<unsigned char> _soa_mask) {
+  const int num_joints = _skeleton.num_joints();
+  Range<const Skeleton::JointProperties> properties =
+    _skeleton.joint_properties();
+
+  // Flags requested joints and their ancestors. Walking up stops as soon as an
+  // already flagged joint is found, as its ancestors are flagged also.
+  bool required[Skeleton::kMaxJoints];
+  std::memset(required, 0, sizeof(required[0]) * num_joints);
+  int count = 0;
+  for (const int* joint = _joints.begin; joint < _joints.end; ++joint) {
+    if (*joint < 0 || *joint >= num_joints) {
+      return 0;
+    }
+    for (int i = *joint;
+         i != Skeleton::kNoParentIndex && !required[i];
+         i = properties.begin[i].parent) {
+      required[i] = true;
+      ++count;
+    }
+  }
+
+  // Validates output buffers.
+  const int num_soa_joints = (num_joints + 3) / 4;
+  if (_list.end - _list.begin < count) {
+    return 0;
+  }
+  if (_soa_mask.begin != NULL) {
+    if (_soa_mask.end - _soa_mask.begin < (num_soa_joints + 7) / 8) {
+      return 0;
+    }
+    std::memset(_soa_mask.begin, 0, (num_soa_joints + 7) / 8);
+  }
+
+  // Joints are sorted such that parents are before their children, so
+  // outputting flagged joints in order is enough.
+  uint16_t* out = _list.begin;
+  for (int i = 0; i < num_joints; ++i) {
+    if (!required[i]) {
+      continue;
+    }
+    *(out++) = static_cast<uint16_t>(i);
+    if (_soa_mask.begin != NULL) {
+      _soa_mask.begin[i / 32] |= 1 << ((i / 4) & 7);
+    }
+  }
+  assert(out - _list.begin == count);
+  return count;
+}
+
+bool BuildSoaUpdatePeriods(const Skeleton& _skeleton,
+                           Range<const unsigned char> _joint_periods,
+                           Range<unsigned char> _soa_periods) {
+  const int num_joints = _skeleton.num_joints();
+  const int num_soa_joints = _skeleton.num_soa_joints();
+  if (_joint_periods.end - _joint_periods.begin < num_joints ||
+      _soa_periods.end - _soa_periods.begin < num_soa_joints) {
+    return false;
+  }
+
+  // A period of 0 means every frame, as 1 does.
+  for (int i = 0; i < num_soa_joints; ++i) {
+    int period = 255;
+    for (int j = i * 4; j < num_joints && j < i * 4 + 4; ++j) {
+      const int joint_period = _joint_periods.begin[j];
+      period = math::Min(period, math::Max(1, joint_period));
+    }
+    _soa_periods.begin[i] = static_cast<unsigned char>(period);
+  }
+  return true;
+}
 }  // animation
 }  // ozz
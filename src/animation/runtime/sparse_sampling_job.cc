@@ -0,0 +1,148 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sparse_sampling_job.h"
+
+#include <cstddef>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+SparseSamplingJob::SparseSamplingJob()
+    : time(0.f),
+      animation(NULL),
+      cache(NULL),
+      fast_normalization(false) {
+}
+
+bool SparseSamplingJob::Validate() const {
+  // Animation and cache are mandatory.
+  if (!animation || !cache) {
+    return false;
+  }
+
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  valid &= SamplingJob::IsCompatible(*animation, *cache);
+
+  // Tests joints range, implicitly tests joints.end != NULL.
+  const int num_tracks = animation->num_tracks();
+  valid &= joints.begin != NULL || num_tracks == 0;
+  valid &= joints.end - joints.begin == num_tracks;
+  if (!valid) {
+    return false;
+  }
+  for (int i = 1; i < num_tracks; ++i) {
+    valid &= joints.begin[i - 1] < joints.begin[i];
+  }
+
+  // Tests output range, which must store the last joint.
+  valid &= output.begin != NULL;
+  if (num_tracks != 0) {
+    valid &= output.end - output.begin > joints.begin[num_tracks - 1] / 4;
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Defines the number of soa tracks sampled by chunk. This is small enough for
+// all the samples of a chunk to remain in L1 cache.
+const int kChunkSize = 8;
+
+// Number of floats of each lane of a soa transform.
+const int kSoaTransformFloats =
+  static_cast<int>(sizeof(math::SoaTransform) / sizeof(math::SimdFloat4));
+
+// Copies lane _src_lane of _src to lane _dest_lane of _dest.
+OZZ_INLINE void CopyLane(const math::SoaTransform& _src, int _src_lane,
+                         math::SoaTransform* _dest, int _dest_lane) {
+  const float* src = reinterpret_cast<const float*>(&_src) + _src_lane;
+  float* dest = reinterpret_cast<float*>(_dest) + _dest_lane;
+  for (int i = 0; i < kSoaTransformFloats; ++i) {
+    dest[i * 4] = src[i * 4];
+  }
+}
+}  // namespace
+
+bool SparseSamplingJob::Run() const {
+  OZZ_PROFILE_SCOPE("SparseSamplingJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_tracks = animation->num_tracks();
+  if (num_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+  const int num_soa_tracks = animation->num_soa_tracks();
+
+  SamplingJob::Prepare(*animation, time, NULL, num_soa_tracks, cache);
+  const float key_time = SamplingJob::KeyTime(*animation, time);
+
+  // Samples chunk by chunk, and writes tracks to their joints.
+  math::SoaTransform samples[kChunkSize];
+  for (int begin = 0; begin < num_soa_tracks; begin += kChunkSize) {
+    const int end = math::Min(begin + kChunkSize, num_soa_tracks);
+    SamplingJob::Interpolate(*animation, *cache, key_time, begin, end, NULL,
+                             fast_normalization, samples);
+    for (int i = begin; i < end; ++i) {
+      const math::SoaTransform& sample = samples[i - begin];
+      const int track = i * 4;
+      const int num_lanes = math::Min(4, num_tracks - track);
+      const uint16_t* soa_joints = joints.begin + track;
+
+      // Joints are sorted, so 4 tracks match a whole soa joint if the first
+      // one is aligned and the last one is 3 joints further.
+      if (num_lanes == 4 && (soa_joints[0] & 3) == 0 &&
+          soa_joints[3] == soa_joints[0] + 3) {
+        output.begin[soa_joints[0] / 4] = sample;
+        continue;
+      }
+      for (int lane = 0; lane < num_lanes; ++lane) {
+        const int joint = soa_joints[lane];
+        CopyLane(sample, lane, output.begin + joint / 4, joint & 3);
+      }
+    }
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
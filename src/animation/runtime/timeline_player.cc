@@ -0,0 +1,199 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/timeline_player.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Orders the queue of clips to start as a min-heap of start times. Ties are
+// broken by index, so that clips start in a deterministic order.
+struct StartsLater {
+  explicit StartsLater(const TimelinePlayer::Clip* _clips)
+      : clips(_clips) {
+  }
+  bool operator()(int _a, int _b) const {
+    if (clips[_a].start != clips[_b].start) {
+      return clips[_a].start > clips[_b].start;
+    }
+    return _a > _b;
+  }
+  const TimelinePlayer::Clip* clips;
+};
+}  // namespace
+
+TimelinePlayer::Clip::Clip()
+    : animation(NULL),
+      start(0.f),
+      cache(NULL) {
+}
+
+TimelinePlayer::TimelinePlayer(int _capacity)
+    : capacity_(_capacity),
+      num_clips_(0),
+      time_(0.f),
+      num_pending_(0),
+      num_playing_(0),
+      transitions_(0),
+      clips_(NULL),
+      next_keys_(NULL),
+      pending_(NULL),
+      playing_(NULL),
+      slots_(NULL) {
+  assert(_capacity >= 0);
+
+  memory::Allocator* allocator = memory::default_allocator();
+  clips_ = allocator->Allocate<Clip>(_capacity);
+  next_keys_ = allocator->Allocate<float>(_capacity);
+  pending_ = allocator->Allocate<int>(_capacity * 3);
+  playing_ = pending_ + _capacity;
+  slots_ = playing_ + _capacity;
+}
+
+TimelinePlayer::~TimelinePlayer() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(clips_);
+  allocator->Deallocate(next_keys_);
+  allocator->Deallocate(pending_);
+}
+
+int TimelinePlayer::AddClip(const Clip& _clip) {
+  if (num_clips_ >= capacity_ || !_clip.animation || !_clip.cache) {
+    return -1;
+  }
+  const int num_soa_tracks = _clip.animation->num_soa_tracks();
+  if (_clip.cache->max_soa_tracks() < num_soa_tracks ||
+      _clip.output.end - _clip.output.begin < num_soa_tracks) {
+    return -1;
+  }
+
+  const int index = num_clips_++;
+  clips_[index] = _clip;
+  slots_[index] = -1;
+
+  // Clips that start after the current time are queued. Others start playing
+  // on the next update.
+  if (_clip.start > time_) {
+    pending_[num_pending_++] = index;
+    std::push_heap(pending_, pending_ + num_pending_, StartsLater(clips_));
+  } else {
+    next_keys_[index] = _clip.start;
+    slots_[index] = num_playing_;
+    playing_[num_playing_++] = index;
+  }
+  return index;
+}
+
+void TimelinePlayer::Rewind() {
+  num_playing_ = 0;
+  num_pending_ = 0;
+  for (int i = 0; i < num_clips_; ++i) {
+    slots_[i] = -1;
+    pending_[num_pending_++] = i;
+  }
+  std::make_heap(pending_, pending_ + num_pending_, StartsLater(clips_));
+}
+
+bool TimelinePlayer::Update(float _time) {
+  OZZ_PROFILE_SCOPE("TimelinePlayer::Update");
+
+  // Scrubbing backward restarts the timeline, as ended clips might be playing
+  // again.
+  if (_time < time_) {
+    Rewind();
+  }
+  time_ = _time;
+
+  // Starts the clips whose start time is reached.
+  const StartsLater starts_later(clips_);
+  while (num_pending_ && clips_[pending_[0]].start <= _time) {
+    std::pop_heap(pending_, pending_ + num_pending_, starts_later);
+    const int index = pending_[--num_pending_];
+    next_keys_[index] = clips_[index].start;
+    slots_[index] = num_playing_;
+    playing_[num_playing_++] = index;
+  }
+
+  // Samples playing clips. Ended clips are sampled a last time at their end.
+  bool success = true;
+  transitions_ = 0;
+  SamplingJob job;
+  for (int i = 0; i < num_playing_;) {
+    const int index = playing_[i];
+    const Clip& clip = clips_[index];
+
+    // Key transition times are known from the cache, so the clips that fetch
+    // keys are counted without touching the animation.
+    if (next_keys_[index] <= _time) {
+      ++transitions_;
+    }
+
+    job.animation = clip.animation;
+    job.cache = clip.cache;
+    job.time = _time - clip.start;
+    job.output = clip.output;
+    success &= job.Run();
+
+    if (job.time >= clip.animation->duration()) {
+      // Removes ended clip, replaced by the last playing one.
+      const int last = playing_[--num_playing_];
+      playing_[i] = last;
+      slots_[last] = i;
+      slots_[index] = -1;
+    } else {
+      next_keys_[index] =
+        clip.start + clip.cache->NextKeyTime(*clip.animation);
+      ++i;
+    }
+  }
+  return success;
+}
+
+bool TimelinePlayer::playing(int _index) const {
+  assert(_index >= 0 && _index < num_clips_);
+  return slots_[_index] >= 0;
+}
+
+const TimelinePlayer::Clip& TimelinePlayer::clip(int _index) const {
+  assert(_index >= 0 && _index < num_clips_);
+  return clips_[_index];
+}
+}  // animation
+}  // ozz
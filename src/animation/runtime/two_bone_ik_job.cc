@@ -0,0 +1,347 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/two_bone_ik_job.h"
+
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+TwoBoneIKJob::TwoBoneIKJob()
+    : target(math::simd_float4::zero()),
+      pole_vector(math::simd_float4::y_axis()),
+      mid_axis(math::simd_float4::z_axis()),
+      weight(1.f),
+      start_joint(NULL),
+      mid_joint(NULL),
+      end_joint(NULL),
+      start_joint_correction(NULL),
+      mid_joint_correction(NULL),
+      reached(NULL) {
+}
+
+bool TwoBoneIKJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+  valid &= start_joint != NULL;
+  valid &= mid_joint != NULL;
+  valid &= end_joint != NULL;
+  valid &= start_joint_correction != NULL;
+  valid &= mid_joint_correction != NULL;
+  valid &= math::AreAllTrue1(math::IsNormalizedEst3(mid_axis));
+  return valid;
+}
+
+bool TwoBoneIKJob::Run() const {
+  OZZ_PROFILE_SCOPE("TwoBoneIKJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Solves the chain in the first lane of the batched job.
+  BatchTwoBoneIKJob batch;
+  const math::SoaFloat3 soa_target = {math::SplatX(target),
+                                      math::SplatY(target),
+                                      math::SplatZ(target)};
+  batch.target = soa_target;
+  const math::SoaFloat3 soa_pole = {math::SplatX(pole_vector),
+                                    math::SplatY(pole_vector),
+                                    math::SplatZ(pole_vector)};
+  batch.pole_vector = soa_pole;
+  const math::SoaFloat3 soa_axis = {math::SplatX(mid_axis),
+                                    math::SplatY(mid_axis),
+                                    math::SplatZ(mid_axis)};
+  batch.mid_axis = soa_axis;
+  batch.weight = math::simd_float4::Load1(weight);
+  batch.start_joints[0] = start_joint;
+  batch.mid_joints[0] = mid_joint;
+  batch.end_joints[0] = end_joint;
+
+  math::SoaQuaternion start_correction;
+  math::SoaQuaternion mid_correction;
+  math::SimdInt4 batch_reached;
+  batch.start_joint_corrections = &start_correction;
+  batch.mid_joint_corrections = &mid_correction;
+  batch.reached = &batch_reached;
+  if (!batch.Run()) {
+    return false;
+  }
+
+  // Extracts first lane outputs.
+  *start_joint_correction = math::Quaternion(math::GetX(start_correction.x),
+                                             math::GetX(start_correction.y),
+                                             math::GetX(start_correction.z),
+                                             math::GetX(start_correction.w));
+  *mid_joint_correction = math::Quaternion(math::GetX(mid_correction.x),
+                                           math::GetX(mid_correction.y),
+                                           math::GetX(mid_correction.z),
+                                           math::GetX(mid_correction.w));
+  if (reached) {
+    *reached = math::GetX(batch_reached) != 0;
+  }
+  return true;
+}
+
+BatchTwoBoneIKJob::BatchTwoBoneIKJob()
+    : target(math::SoaFloat3::zero()),
+      pole_vector(math::SoaFloat3::y_axis()),
+      mid_axis(math::SoaFloat3::z_axis()),
+      weight(math::simd_float4::one()),
+      start_joint_corrections(NULL),
+      mid_joint_corrections(NULL),
+      reached(NULL) {
+  for (int i = 0; i < 4; ++i) {
+    start_joints[i] = NULL;
+    mid_joints[i] = NULL;
+    end_joints[i] = NULL;
+  }
+}
+
+bool BatchTwoBoneIKJob::Validate() const {
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+  valid &= start_joint_corrections != NULL;
+  valid &= mid_joint_corrections != NULL;
+  for (int i = 0; i < 4; ++i) {
+    const bool active = start_joints[i] != NULL;
+    valid &= (mid_joints[i] != NULL) == active;
+    valid &= (end_joints[i] != NULL) == active;
+  }
+  valid &= math::AreAllTrue(math::IsNormalizedEst(mid_axis));
+  return valid;
+}
+
+namespace {
+
+// Gathers the 3 first columns and the translation of 4 matrices, to soa
+// format. NULL matrices are replaced by identity.
+void GatherJoints(const math::Float4x4* const _joints[4],
+                  math::SoaFloat3 _cols[4]) {
+  const math::Float4x4 identity = math::Float4x4::identity();
+  for (int c = 0; c < 4; ++c) {
+    math::SimdFloat4 aos[4];
+    for (int i = 0; i < 4; ++i) {
+      aos[i] = (_joints[i] ? _joints[i] : &identity)->cols[c];
+    }
+    math::Transpose4x3(aos, &_cols[c].x);
+  }
+}
+
+// Rotates vector _v by the unit quaternion _q.
+math::SoaFloat3 Rotate(const math::SoaQuaternion& _q,
+                       const math::SoaFloat3& _v) {
+  const math::SoaFloat3 qv = {_q.x, _q.y, _q.z};
+  const math::SoaFloat3 a = CrossProduct(qv, _v) + _v * _q.w;
+  const math::SoaFloat3 b = CrossProduct(qv, a);
+  return _v + b + b;
+}
+
+// Computes the quaternion of the rotation around _axis (normalized), from
+// the cosine and the sign of the angle. Half angle trigonometric functions are
+// derived from _cos, avoiding any transcendental function.
+math::SoaQuaternion FromCosAxis(const math::SoaFloat3& _axis,
+                                math::_SimdFloat4 _cos,
+                                math::_SimdInt4 _negative) {
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 c = math::Sqrt((one + _cos) * half);
+  const math::SimdFloat4 s = math::Sqrt((one - _cos) * half);
+  const math::SimdFloat4 ss = math::Select(_negative, -s, s);
+  const math::SoaQuaternion q = {_axis.x * ss, _axis.y * ss, _axis.z * ss, c};
+  return q;
+}
+
+// Selects quaternion _a lanes where _b is true, _c lanes otherwise.
+math::SoaQuaternion Select(math::_SimdInt4 _b,
+                           const math::SoaQuaternion& _a,
+                           const math::SoaQuaternion& _c) {
+  const math::SoaQuaternion q = {math::Select(_b, _a.x, _c.x),
+                                 math::Select(_b, _a.y, _c.y),
+                                 math::Select(_b, _a.z, _c.z),
+                                 math::Select(_b, _a.w, _c.w)};
+  return q;
+}
+}  // namespace
+
+bool BatchTwoBoneIKJob::Run() const {
+  OZZ_PROFILE_SCOPE("BatchTwoBoneIKJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 epsilon = math::simd_float4::Load1(1e-8f);
+
+  const math::SimdInt4 active = math::simd_int4::Load(start_joints[0] != NULL,
+                                                      start_joints[1] != NULL,
+                                                      start_joints[2] != NULL,
+                                                      start_joints[3] != NULL);
+
+  // Gathers chain joints to soa.
+  math::SoaFloat3 start[4];
+  GatherJoints(start_joints, start);
+  math::SoaFloat3 mid[4];
+  GatherJoints(mid_joints, mid);
+  math::SoaFloat3 end[4];
+  GatherJoints(end_joints, end);
+
+  // Chain vectors and lengths.
+  const math::SoaFloat3 start_mid = mid[3] - start[3];
+  const math::SoaFloat3 mid_end = end[3] - mid[3];
+  const math::SoaFloat3 start_target = target - start[3];
+  const math::SimdFloat4 sm_len2 = Dot(start_mid, start_mid);
+  const math::SimdFloat4 me_len2 = Dot(mid_end, mid_end);
+  const math::SimdFloat4 sm_len = math::Sqrt(sm_len2);
+  const math::SimdFloat4 me_len = math::Sqrt(me_len2);
+  const math::SimdFloat4 st_len = Length(start_target);
+
+  // The target is reachable if its distance to the start joint is in range of
+  // the chain folded and stretched lengths. It's clamped to that range
+  // otherwise.
+  const math::SimdFloat4 st_min = math::Abs(sm_len - me_len);
+  const math::SimdFloat4 st_max = sm_len + me_len;
+  const math::SimdInt4 in_range = math::And(math::CmpGe(st_len, st_min),
+                                            math::CmpLe(st_len, st_max));
+  const math::SimdFloat4 st_clamped = math::Clamp(st_min, st_len, st_max);
+
+  // Computes the mid joint interior angle required to reach the target, using
+  // the law of cosines, and the current interior angle.
+  const math::SimdFloat4 lengths = math::Max(sm_len * me_len, epsilon);
+  const math::SimdFloat4 cos_target = math::Clamp(
+      -one, (sm_len2 + me_len2 - st_clamped * st_clamped) / (lengths + lengths),
+      one);
+  const math::SimdFloat4 cos_current =
+      math::Clamp(-one, -Dot(start_mid, mid_end) / lengths, one);
+
+  // Half angle cosines and sines of both angles, which are in range [0,pi].
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 ct = math::Sqrt((one + cos_target) * half);
+  const math::SimdFloat4 st = math::Sqrt((one - cos_target) * half);
+  const math::SimdFloat4 cc = math::Sqrt((one + cos_current) * half);
+  const math::SimdFloat4 sc = math::Sqrt((one - cos_current) * half);
+
+  // Half angle of the mid joint delta rotation, target minus current angle.
+  const math::SimdFloat4 cos_half_delta = ct * cc + st * sc;
+  const math::SimdFloat4 sin_half_delta = st * cc - ct * sc;
+
+  // Mid joint axis in model space. Rotating around it opens the interior
+  // angle if the chain plane normal matches its direction, the delta angle
+  // is negated otherwise.
+  const math::SoaFloat3 mid_axis_ms = NormalizeSafe(
+      mid[0] * mid_axis.x + mid[1] * mid_axis.y + mid[2] * mid_axis.z,
+      math::SoaFloat3::z_axis());
+  const math::SimdInt4 flip =
+      math::CmpGt(Dot(CrossProduct(start_mid, mid_end), mid_axis_ms), zero);
+  const math::SimdFloat4 sin_bend =
+      math::Select(flip, -sin_half_delta, sin_half_delta);
+
+  const math::SoaQuaternion mid_rot_ms = {
+      mid_axis_ms.x * sin_bend, mid_axis_ms.y * sin_bend,
+      mid_axis_ms.z * sin_bend, cos_half_delta};
+  const math::SoaQuaternion mid_correction = {
+      mid_axis.x * sin_bend, mid_axis.y * sin_bend, mid_axis.z * sin_bend,
+      cos_half_delta};
+
+  // Aligns start to end joint vector, once mid joint is corrected, with start
+  // to target vector.
+  const math::SoaFloat3 start_end = start_mid + Rotate(mid_rot_ms, mid_end);
+  const math::SoaFloat3 se_norm =
+      NormalizeSafe(start_end, math::SoaFloat3::x_axis());
+  const math::SoaFloat3 st_norm =
+      NormalizeSafe(start_target, math::SoaFloat3::x_axis());
+  const math::SoaFloat3 align_axis = NormalizeSafe(
+      CrossProduct(se_norm, st_norm),
+      NormalizeSafe(CrossProduct(se_norm, pole_vector),
+                    math::SoaFloat3::y_axis()));
+  const math::SoaQuaternion align = FromCosAxis(
+      align_axis, math::Clamp(-one, Dot(se_norm, st_norm), one),
+      math::simd_int4::all_false());
+
+  // Twists the chain around start to target axis, so that the mid joint lies
+  // in the plane defined by the pole vector. Twist is skipped if the mid joint
+  // or the pole vector are aligned with the axis.
+  const math::SoaFloat3 mid_aligned = Rotate(align, start_mid);
+  const math::SoaFloat3 mid_plane =
+      mid_aligned - st_norm * Dot(mid_aligned, st_norm);
+  const math::SoaFloat3 pole_plane =
+      pole_vector - st_norm * Dot(pole_vector, st_norm);
+  const math::SimdFloat4 mid_plane_len2 = Dot(mid_plane, mid_plane);
+  const math::SimdFloat4 pole_plane_len2 = Dot(pole_plane, pole_plane);
+  const math::SimdInt4 twistable =
+      math::And(math::CmpGt(mid_plane_len2, epsilon),
+                math::CmpGt(pole_plane_len2, epsilon));
+  const math::SimdFloat4 cos_twist = math::Clamp(
+      -one,
+      Dot(mid_plane, pole_plane) /
+          math::Sqrt(math::Max(mid_plane_len2 * pole_plane_len2, epsilon)),
+      one);
+  const math::SimdInt4 twist_negative = math::CmpLt(
+      Dot(CrossProduct(mid_plane, pole_plane), st_norm), zero);
+  const math::SoaQuaternion identity = math::SoaQuaternion::identity();
+  const math::SoaQuaternion twist =
+      Select(twistable, FromCosAxis(st_norm, cos_twist, twist_negative),
+             identity);
+
+  // Start joint model space correction, converted to start joint local space
+  // by rotating its axis with the inverse start joint rotation.
+  const math::SoaQuaternion start_ms = twist * align;
+  const math::SoaFloat3 start_axis_ms = {start_ms.x, start_ms.y, start_ms.z};
+  const math::SoaFloat3 x =
+      NormalizeSafe(start[0], math::SoaFloat3::x_axis());
+  const math::SoaFloat3 y =
+      NormalizeSafe(start[1], math::SoaFloat3::y_axis());
+  const math::SoaFloat3 z =
+      NormalizeSafe(start[2], math::SoaFloat3::z_axis());
+  const math::SoaQuaternion start_local = {
+      Dot(x, start_axis_ms), Dot(y, start_axis_ms), Dot(z, start_axis_ms),
+      start_ms.w};
+
+  // Ensures the shortest path is used when weighting corrections.
+  const math::SimdInt4 start_negative = math::CmpLt(start_local.w, zero);
+  const math::SoaQuaternion start_correction =
+      Select(start_negative, -start_local, start_local);
+
+  // Weights corrections and outputs identity for inactive lanes.
+  const math::SimdFloat4 w = math::Clamp(zero, weight, one);
+  *start_joint_corrections = Select(
+      active, NLerp(identity, start_correction, w), identity);
+  *mid_joint_corrections = Select(
+      active, NLerp(identity, mid_correction, w), identity);
+  if (reached) {
+    *reached = math::And(in_range, active);
+  }
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,135 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/endianness.h"
+
+#include "ozz/base/maths/internal/simd_math_config.h"
+
+namespace ozz {
+namespace internal {
+
+namespace {
+// Swaps from _begin to _end, the scalar way, for the elements that don't fill
+// a whole SIMD register.
+template <size_t _size>
+void SwapTail(char* _begin, char* _end) {
+  for (; _begin < _end; _begin += _size) {
+    for (size_t i = 0; i < _size / 2; ++i) {
+      const char temp = _begin[i];
+      _begin[i] = _begin[_size - 1 - i];
+      _begin[_size - 1 - i] = temp;
+    }
+  }
+}
+
+#if defined(OZZ_HAS_SSSE3)
+// Swaps 16 bytes blocks using a pshufb byte shuffle.
+char* SwapBlocks(char* _data, char* _end, __m128i _shuffle) {
+  for (; _end - _data >= 16; _data += 16) {
+    __m128i* block = reinterpret_cast<__m128i*>(_data);
+    _mm_storeu_si128(block, _mm_shuffle_epi8(_mm_loadu_si128(block), _shuffle));
+  }
+  return _data;
+}
+#elif defined(OZZ_HAS_SSE2)
+// Swaps bytes of every 16 bits words of _v.
+OZZ_INLINE __m128i Swap16(__m128i _v) {
+  return _mm_or_si128(_mm_slli_epi16(_v, 8), _mm_srli_epi16(_v, 8));
+}
+#endif  // OZZ_HAS_SSSE3
+}  // namespace
+
+void EndianSwap16(void* _data, size_t _count) {
+  char* data = static_cast<char*>(_data);
+  char* end = data + _count * 2;
+#if defined(OZZ_HAS_SSSE3)
+  data = SwapBlocks(data, end, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                                             9, 8, 11, 10, 13, 12, 15, 14));
+#elif defined(OZZ_HAS_SSE2)
+  for (; end - data >= 16; data += 16) {
+    __m128i* block = reinterpret_cast<__m128i*>(data);
+    _mm_storeu_si128(block, Swap16(_mm_loadu_si128(block)));
+  }
+#elif defined(OZZ_HAS_NEON)
+  for (; end - data >= 16; data += 16) {
+    uint8_t* block = reinterpret_cast<uint8_t*>(data);
+    vst1q_u8(block, vrev16q_u8(vld1q_u8(block)));
+  }
+#endif  // OZZ_HAS_x
+  SwapTail<2>(data, end);
+}
+
+void EndianSwap32(void* _data, size_t _count) {
+  char* data = static_cast<char*>(_data);
+  char* end = data + _count * 4;
+#if defined(OZZ_HAS_SSSE3)
+  data = SwapBlocks(data, end, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                             11, 10, 9, 8, 15, 14, 13, 12));
+#elif defined(OZZ_HAS_SSE2)
+  for (; end - data >= 16; data += 16) {
+    __m128i* block = reinterpret_cast<__m128i*>(data);
+    __m128i v = _mm_loadu_si128(block);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    _mm_storeu_si128(block, Swap16(v));
+  }
+#elif defined(OZZ_HAS_NEON)
+  for (; end - data >= 16; data += 16) {
+    uint8_t* block = reinterpret_cast<uint8_t*>(data);
+    vst1q_u8(block, vrev32q_u8(vld1q_u8(block)));
+  }
+#endif  // OZZ_HAS_x
+  SwapTail<4>(data, end);
+}
+
+void EndianSwap64(void* _data, size_t _count) {
+  char* data = static_cast<char*>(_data);
+  char* end = data + _count * 8;
+#if defined(OZZ_HAS_SSSE3)
+  data = SwapBlocks(data, end, _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                                             15, 14, 13, 12, 11, 10, 9, 8));
+#elif defined(OZZ_HAS_SSE2)
+  for (; end - data >= 16; data += 16) {
+    __m128i* block = reinterpret_cast<__m128i*>(data);
+    __m128i v = _mm_loadu_si128(block);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    _mm_storeu_si128(block, Swap16(v));
+  }
+#elif defined(OZZ_HAS_NEON)
+  for (; end - data >= 16; data += 16) {
+    uint8_t* block = reinterpret_cast<uint8_t*>(data);
+    vst1q_u8(block, vrev64q_u8(vld1q_u8(block)));
+  }
+#endif  // OZZ_HAS_x
+  SwapTail<8>(data, end);
+}
+}  // internal
+}  // ozz
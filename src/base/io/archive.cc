@@ -32,32 +32,142 @@
 
 #include <cassert>
 
+#include "ozz/base/io/checksum.h"
+#include "ozz/base/memory/allocator.h"
+
 namespace ozz {
 namespace io {
 
+namespace {
+// Flags the archive endianness byte when objects are checksummed.
+const uint8_t kChecksumFlag = 0x80;
+
+// Size of the buffer used to copy or verify objects data.
+const size_t kChunkSize = 4 << 10;
+}  // namespace
+
 // OArchive implementation.
 
-OArchive::OArchive(Stream* _stream, Endianness _endianness)
+OArchive::OArchive(Stream* _stream, Endianness _endianness, bool _checksum)
     : stream_(_stream),
-      endian_swap_(_endianness != GetNativeEndianness()) {
+      output_(NULL),
+      endian_swap_(_endianness != GetNativeEndianness()),
+      checksum_(_checksum),
+      depth_(0) {
   assert(stream_ && stream_->opened() &&
          L"_stream argument must point a valid opened stream.");
   // Save as a single byte as it does not need to be swapped.
   uint8_t endianness = static_cast<uint8_t>(_endianness);
+  if (checksum_) {
+    endianness |= kChecksumFlag;
+  }
   *this << endianness;
 }
 
+OArchive::~OArchive() {
+  assert(!output_ && "An object is still being saved.");
+}
+
+bool OArchive::BeginObject() {
+  if (!checksum_ || depth_++ != 0) {
+    return false;
+  }
+  output_ = stream_;
+  stream_ = memory::default_allocator()->New<MemoryStream>();
+  return true;
+}
+
+void OArchive::EndObject(bool _checksummed) {
+  if (!checksum_) {
+    return;
+  }
+  --depth_;
+  if (!_checksummed) {
+    return;
+  }
+
+  // Computes object data checksum, then writes the checksum section followed
+  // by the data to the output stream.
+  MemoryStream* memory = static_cast<MemoryStream*>(stream_);
+  stream_ = output_;
+  output_ = NULL;
+
+  const uint64_t size = static_cast<uint64_t>(memory->Tell());
+  char chunk[kChunkSize];
+  uint32_t crc = 0;
+  memory->Seek(0, Stream::kSet);
+  for (size_t read; (read = memory->Read(chunk, kChunkSize)) != 0;) {
+    crc = Crc32c(chunk, read, crc);
+  }
+  *this << size;
+  *this << crc;
+  memory->Seek(0, Stream::kSet);
+  for (size_t read; (read = memory->Read(chunk, kChunkSize)) != 0;) {
+    OZZ_IF_DEBUG(size_t written =) stream_->Write(chunk, read);
+    assert(written == read);
+  }
+  memory::default_allocator()->Delete(memory);
+}
+
 // IArchive implementation.
 
 IArchive::IArchive(Stream* _stream)
     : stream_(_stream),
-      endian_swap_(false) {
+      endian_swap_(false),
+      checksum_(false),
+      verify_(false),
+      corrupted_(false),
+      depth_(0) {
   assert(stream_ && stream_->opened() &&
          L"_stream argument must point a valid opened stream.");
   // Endianness was saved as a single byte, as it does not need to be swapped.
   uint8_t endianness;
   *this >> endianness;
+  checksum_ = (endianness & kChecksumFlag) != 0;
+  endianness &= ~kChecksumFlag;
   endian_swap_ = endianness != GetNativeEndianness();
 }
+
+bool IArchive::BeginObject() {
+  if (!checksum_ || depth_++ != 0) {
+    return true;
+  }
+  uint64_t size;
+  uint32_t crc;
+  *this >> size;
+  *this >> crc;
+  if (!verify_) {
+    return true;
+  }
+
+  // Verifies the whole object data in a single pass, then rewinds to load it.
+  const int64_t begin = stream_->Tell();
+  char chunk[kChunkSize];
+  uint32_t data_crc = 0;
+  uint64_t remaining = size;
+  while (remaining) {
+    const size_t to_read =
+      remaining < kChunkSize ? static_cast<size_t>(remaining) : kChunkSize;
+    const size_t read = stream_->Read(chunk, to_read);
+    data_crc = Crc32c(chunk, read, data_crc);
+    if (read != to_read) {
+      break;  // Truncated data.
+    }
+    remaining -= read;
+  }
+  if (remaining || data_crc != crc) {
+    corrupted_ = true;
+    stream_->Seek(begin + static_cast<int64_t>(size), Stream::kSet);
+    return false;
+  }
+  stream_->Seek(begin, Stream::kSet);
+  return true;
+}
+
+void IArchive::EndObject() {
+  if (checksum_) {
+    --depth_;
+  }
+}
 }  // io
 }  // ozz
@@ -0,0 +1,259 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/async_stream.h"
+
+#include <cassert>
+
+#include "ozz/base/memory/allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../tasks/thread.h"
+
+namespace ozz {
+namespace io {
+
+struct ThreadedAsyncStream::Impl : public tasks::internal::Runnable {
+  explicit Impl(Stream* _stream)
+      : stream(_stream),
+        head(NULL),
+        tail(NULL),
+        quit(false),
+        started(false) {
+  }
+
+  // The decorated stream, only accessed by the I/O thread once it's started.
+  Stream* stream;
+
+  // Protects everything below, and requests state.
+  tasks::internal::Mutex mutex;
+
+  // Signaled when a request is submitted, or when the stream is destroyed.
+  tasks::internal::Condition wake;
+
+  // Signaled when a request is completed.
+  tasks::internal::Condition done;
+
+  // Pending requests queue, in submission order.
+  AsyncReadRequest* head;
+  AsyncReadRequest* tail;
+
+  // Requests the I/O thread to quit, once the queue is empty.
+  bool quit;
+
+  // The I/O thread.
+  tasks::internal::Thread thread;
+  bool started;
+
+  // Executes requests until the stream is destroyed.
+  virtual void Run() {
+    mutex.Lock();
+    for (;;) {
+      AsyncReadRequest* request = head;
+      if (!request) {
+        if (quit) {
+          break;
+        }
+        wake.Wait(&mutex);
+        continue;
+      }
+      mutex.Unlock();
+
+      size_t read = 0;
+      if (stream->Seek(request->offset, Stream::kSet) == 0) {
+        read = stream->Read(request->buffer, request->size);
+      }
+
+      mutex.Lock();
+      head = request->next_;
+      if (!head) {
+        tail = NULL;
+      }
+      request->next_ = NULL;
+      request->read = read;
+      request->state_ = AsyncReadRequest::kCompleted;
+      done.Broadcast();
+    }
+    mutex.Unlock();
+  }
+};
+
+ThreadedAsyncStream::ThreadedAsyncStream(Stream* _stream)
+    : impl_(NULL),
+      size_(-1) {
+  assert(_stream);
+  if (!_stream->opened()) {
+    return;
+  }
+
+  // Computes stream size before the I/O thread owns the stream.
+  const int64_t tell = _stream->Tell();
+  if (tell >= 0 && _stream->Seek(0, Stream::kEnd) == 0) {
+    size_ = _stream->Tell();
+    _stream->Seek(tell, Stream::kSet);
+  }
+
+  impl_ = memory::default_allocator()->New<Impl>(_stream);
+  impl_->started = tasks::internal::StartThread(&impl_->thread, impl_);
+}
+
+ThreadedAsyncStream::~ThreadedAsyncStream() {
+  if (!impl_) {
+    return;
+  }
+  if (impl_->started) {
+    impl_->mutex.Lock();
+    impl_->quit = true;
+    impl_->mutex.Unlock();
+    impl_->wake.Broadcast();
+    tasks::internal::JoinThread(impl_->thread);
+  }
+  memory::default_allocator()->Delete(impl_);
+}
+
+bool ThreadedAsyncStream::opened() const {
+  return impl_ != NULL && impl_->started;
+}
+
+int64_t ThreadedAsyncStream::size() const {
+  return size_;
+}
+
+bool ThreadedAsyncStream::Submit(AsyncReadRequest* _request) {
+  if (!opened() || !_request ||
+      _request->state_ == AsyncReadRequest::kPending ||
+      (!_request->buffer && _request->size != 0)) {
+    return false;
+  }
+  impl_->mutex.Lock();
+  _request->read = 0;
+  _request->next_ = NULL;
+  _request->state_ = AsyncReadRequest::kPending;
+  if (impl_->tail) {
+    impl_->tail->next_ = _request;
+  } else {
+    impl_->head = _request;
+  }
+  impl_->tail = _request;
+  impl_->mutex.Unlock();
+  impl_->wake.Broadcast();
+  return true;
+}
+
+bool ThreadedAsyncStream::Poll(const AsyncReadRequest& _request) {
+  if (!opened()) {
+    return true;
+  }
+  impl_->mutex.Lock();
+  const bool completed = _request.state_ != AsyncReadRequest::kPending;
+  impl_->mutex.Unlock();
+  return completed;
+}
+
+bool ThreadedAsyncStream::Wait(const AsyncReadRequest& _request) {
+  if (!opened()) {
+    return false;
+  }
+  impl_->mutex.Lock();
+  while (_request.state_ == AsyncReadRequest::kPending) {
+    impl_->done.Wait(&impl_->mutex);
+  }
+  impl_->mutex.Unlock();
+  return _request.succeeded();
+}
+
+// Starts AsyncLoad implementation.
+AsyncLoad::AsyncLoad()
+    : stream_(NULL),
+      memory_(NULL) {
+}
+
+AsyncLoad::~AsyncLoad() {
+  End();
+}
+
+bool AsyncLoad::Begin(AsyncStream* _stream) {
+  const int64_t size = _stream ? _stream->size() : -1;
+  if (size < 0 || static_cast<uint64_t>(size) >
+                  static_cast<uint64_t>(static_cast<size_t>(-1))) {
+    End();
+    return false;
+  }
+  return Begin(_stream, 0, static_cast<size_t>(size));
+}
+
+bool AsyncLoad::Begin(AsyncStream* _stream, int64_t _offset, size_t _size) {
+  End();
+  if (!_stream || !_stream->opened() || _offset < 0) {
+    return false;
+  }
+
+  // Allocates at least a byte, so that an empty range is still a valid load.
+  request_.offset = _offset;
+  request_.size = _size;
+  request_.buffer = memory::default_allocator()->Allocate(
+    _size != 0 ? _size : 1, 16);
+  if (!request_.buffer || !_stream->Submit(&request_)) {
+    End();
+    return false;
+  }
+  stream_ = _stream;
+  return true;
+}
+
+bool AsyncLoad::done() const {
+  return !stream_ || stream_->Poll(request_);
+}
+
+Stream* AsyncLoad::Finalize() {
+  if (!stream_ || !stream_->Wait(request_)) {
+    return NULL;
+  }
+  if (!memory_) {
+    memory_ = memory::default_allocator()->New<ReadOnlyMemoryStream>(
+      request_.buffer, request_.size);
+  }
+  return memory_;
+}
+
+void AsyncLoad::End() {
+  if (stream_) {
+    stream_->Wait(request_);
+    stream_ = NULL;
+  }
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Delete(memory_);
+  memory_ = NULL;
+  allocator->Deallocate(request_.buffer);
+  request_ = AsyncReadRequest();
+}
+}  // io
+}  // ozz
@@ -0,0 +1,110 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/checksum.h"
+
+#include <cstring>
+
+#include "ozz/base/maths/internal/simd_math_config.h"
+
+namespace ozz {
+namespace io {
+
+#if defined(OZZ_HAS_SSE4_2)
+uint32_t Crc32c(const void* _data, size_t _size, uint32_t _crc) {
+  const unsigned char* data = static_cast<const unsigned char*>(_data);
+  const unsigned char* end = data + _size;
+  uint32_t crc = ~_crc;
+#if defined(__x86_64__) || defined(_M_X64)
+  uint64_t crc64 = crc;
+  for (; end - data >= 8; data += 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+#endif  // __x86_64__
+  for (; end - data >= 4; data += 4) {
+    uint32_t word;
+    std::memcpy(&word, data, sizeof(word));
+    crc = _mm_crc32_u32(crc, word);
+  }
+  for (; data < end; ++data) {
+    crc = _mm_crc32_u8(crc, *data);
+  }
+  return ~crc;
+}
+#else  // OZZ_HAS_SSE4_2
+namespace {
+// Slicing-by-8 lookup tables of the reflected Castagnoli polynomial.
+struct Crc32cTables {
+  Crc32cTables() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int j = 0; j < 8; ++j) {
+        crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1)));
+      }
+      table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (int j = 1; j < 8; ++j) {
+        table[j][i] = (table[j - 1][i] >> 8) ^ table[0][table[j - 1][i] & 0xff];
+      }
+    }
+  }
+  uint32_t table[8][256];
+};
+const Crc32cTables kTables;
+}  // namespace
+
+uint32_t Crc32c(const void* _data, size_t _size, uint32_t _crc) {
+  const uint32_t (*table)[256] = kTables.table;
+  const unsigned char* data = static_cast<const unsigned char*>(_data);
+  const unsigned char* end = data + _size;
+  uint32_t crc = ~_crc;
+  for (; end - data >= 8; data += 8) {
+    // Processes bytes explicitly, so that the result doesn't depend on
+    // endianness.
+    const uint32_t low = crc ^ (data[0] | (data[1] << 8) |
+                                (data[2] << 16) |
+                                (static_cast<uint32_t>(data[3]) << 24));
+    crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+          table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+          table[3][data[4]] ^ table[2][data[5]] ^
+          table[1][data[6]] ^ table[0][data[7]];
+  }
+  for (; data < end; ++data) {
+    crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xff];
+  }
+  return ~crc;
+}
+#endif  // OZZ_HAS_SSE4_2
+}  // io
+}  // ozz
@@ -28,6 +28,11 @@
 //                                                                            //
 //============================================================================//
 
+// Enables 64 bits file offsets on 32 bits posix platforms.
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif  // _FILE_OFFSET_BITS
+
 #include "ozz/base/io/stream.h"
 
 #include <cstdio>
@@ -35,6 +40,7 @@
 #include <cstring>
 #include <cassert>
 
+#include "ozz/base/endianness.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/maths/math_ex.h"
 
@@ -77,18 +83,26 @@ size_t File::Write(const void* _buffer, size_t _size) {
   return std::fwrite(_buffer, 1, _size, file);
 }
 
-int File::Seek(int _offset, Origin _origin) {
+int File::Seek(int64_t _offset, Origin _origin) {
   int origins[] = {SEEK_CUR, SEEK_END, SEEK_SET};
   if (_origin >= static_cast<int>(OZZ_ARRAY_SIZE(origins))) {
     return -1;
   }
   std::FILE* file = reinterpret_cast<std::FILE*>(file_);
-  return std::fseek(file, _offset, origins[_origin]);
+#ifdef _MSC_VER
+  return _fseeki64(file, _offset, origins[_origin]);
+#else  // _MSC_VER
+  return fseeko(file, static_cast<off_t>(_offset), origins[_origin]);
+#endif  // _MSC_VER
 }
 
-int File::Tell() const {
+int64_t File::Tell() const {
   std::FILE* file = reinterpret_cast<std::FILE*>(file_);
-  return std::ftell(file);
+#ifdef _MSC_VER
+  return _ftelli64(file);
+#else  // _MSC_VER
+  return ftello(file);
+#endif  // _MSC_VER
 }
 
 // Starts MemoryStream implementation.
@@ -155,7 +169,7 @@ size_t MemoryStream::Write(const void* _buffer, size_t _size) {
   return 0;
 }
 
-int MemoryStream::Seek(int _offset, Origin _origin) {
+int MemoryStream::Seek(int64_t _offset, Origin _origin) {
   int origin;
   switch (_origin) {
     case kCurrent: origin = tell_; break;
@@ -165,18 +179,19 @@ int MemoryStream::Seek(int _offset, Origin _origin) {
   }
 
   // Exit if seeking before file begin or beyond max file size.
-  if (origin < -_offset ||  
-      (_offset > 0 && origin > static_cast<int>(kMaxSize - _offset))) {
+  if (origin < -_offset ||
+      (_offset > 0 &&
+       origin > static_cast<int64_t>(kMaxSize) - _offset)) {
     return -1;
   }
 
   // So tell_ is moved but end_ pointer is not moved until something is later
   // written.
-  tell_ = origin + _offset;
+  tell_ = static_cast<int>(origin + _offset);
   return 0;
 }
 
-int MemoryStream::Tell() const {
+int64_t MemoryStream::Tell() const {
   return tell_;
 }
 
@@ -192,5 +207,744 @@ bool MemoryStream::Resize(size_t _size) {
   }
   return _size == 0 || buffer_ != NULL;
 }
+
+// Starts ReadOnlyMemoryStream implementation.
+ReadOnlyMemoryStream::ReadOnlyMemoryStream(const void* _data, size_t _size)
+    : data_(static_cast<const char*>(_data)),
+      size_(static_cast<int64_t>(_size)),
+      tell_(0) {
+  assert(_data || _size == 0);
+}
+
+ReadOnlyMemoryStream::~ReadOnlyMemoryStream() {
+}
+
+bool ReadOnlyMemoryStream::opened() const {
+  return data_ != NULL || size_ == 0;
+}
+
+size_t ReadOnlyMemoryStream::Read(void* _buffer, size_t _size) {
+  const size_t read_size = math::Min(remaining(), _size);
+  if (read_size == 0) {
+    return 0;
+  }
+  std::memcpy(_buffer, data_ + tell_, read_size);
+  tell_ += static_cast<int64_t>(read_size);
+  return read_size;
+}
+
+size_t ReadOnlyMemoryStream::Write(const void* _buffer, size_t _size) {
+  (void)_buffer;
+  (void)_size;
+  return 0;
+}
+
+int ReadOnlyMemoryStream::Seek(int64_t _offset, Origin _origin) {
+  int64_t origin;
+  switch (_origin) {
+    case kCurrent: origin = tell_; break;
+    case kEnd: origin = size_; break;
+    case kSet: origin = 0; break;
+    default: return -1;
+  }
+
+  // Exit if seeking before buffer begin or if position overflows. Seeking
+  // beyond the end is allowed, subsequent reads will fail.
+  if (origin < -_offset ||
+      (_offset > 0 &&
+       origin > std::numeric_limits<int64_t>::max() - _offset)) {
+    return -1;
+  }
+  tell_ = origin + _offset;
+  return 0;
+}
+
+int64_t ReadOnlyMemoryStream::Tell() const {
+  return tell_;
+}
+
+const void* ReadOnlyMemoryStream::current() const {
+  return tell_ <= size_ && data_ ? data_ + tell_ : NULL;
+}
+
+size_t ReadOnlyMemoryStream::remaining() const {
+  return tell_ < size_ ? static_cast<size_t>(size_ - tell_) : 0;
+}
+
+// Starts BufferedStream implementation.
+const size_t BufferedStream::kDefaultBlockSize = 64<<10;
+
+BufferedStream::BufferedStream(Stream* _stream, size_t _block_size)
+    : stream_(_stream),
+      buffer_(NULL),
+      block_size_(_block_size),
+      cursor_(0),
+      end_(0),
+      writing_(false) {
+  assert(_stream && _block_size > 0);
+  buffer_ = ozz::memory::default_allocator()->Allocate<char>(block_size_);
+}
+
+BufferedStream::~BufferedStream() {
+  Flush();
+  ozz::memory::default_allocator()->Deallocate(buffer_);
+  buffer_ = NULL;
+}
+
+bool BufferedStream::opened() const {
+  return buffer_ != NULL && stream_->opened();
+}
+
+bool BufferedStream::Flush() {
+  bool success = true;
+  if (writing_) {
+    success = stream_->Write(buffer_, cursor_) == cursor_;
+    writing_ = false;
+  } else if (cursor_ != end_) {
+    // Moves decorated stream back to the position of *this stream.
+    const int64_t ahead = static_cast<int64_t>(end_ - cursor_);
+    success = stream_->Seek(-ahead, kCurrent) == 0;
+  }
+  cursor_ = 0;
+  end_ = 0;
+  return success;
+}
+
+size_t BufferedStream::Read(void* _buffer, size_t _size) {
+  if (writing_ && !Flush()) {
+    return 0;
+  }
+
+  // Consumes read-ahead data first.
+  char* buffer = static_cast<char*>(_buffer);
+  const size_t buffered = math::Min(end_ - cursor_, _size);
+  std::memcpy(buffer, buffer_ + cursor_, buffered);
+  cursor_ += buffered;
+  if (buffered == _size) {
+    return _size;
+  }
+
+  // Read-ahead data are exhausted.
+  const size_t remaining = _size - buffered;
+  cursor_ = 0;
+  end_ = 0;
+  if (remaining >= block_size_) {
+    // Big reads bypass the buffer.
+    return buffered + stream_->Read(buffer + buffered, remaining);
+  }
+
+  // Reads ahead a new block.
+  end_ = stream_->Read(buffer_, block_size_);
+  cursor_ = math::Min(end_, remaining);
+  std::memcpy(buffer + buffered, buffer_, cursor_);
+  return buffered + cursor_;
+}
+
+size_t BufferedStream::Write(const void* _buffer, size_t _size) {
+  if (!writing_) {
+    // Discards read-ahead data.
+    if (!Flush()) {
+      return 0;
+    }
+    writing_ = true;
+  }
+
+  if (_size <= block_size_ - cursor_) {
+    std::memcpy(buffer_ + cursor_, _buffer, _size);
+    cursor_ += _size;
+    return _size;
+  }
+
+  // Buffer is full.
+  if (!Flush()) {
+    return 0;
+  }
+  if (_size >= block_size_) {
+    // Big writes bypass the buffer.
+    return stream_->Write(_buffer, _size);
+  }
+  writing_ = true;
+  std::memcpy(buffer_, _buffer, _size);
+  cursor_ = _size;
+  return _size;
+}
+
+int BufferedStream::Seek(int64_t _offset, Origin _origin) {
+  // Seeking within read-ahead data doesn't require to access decorated
+  // stream.
+  if (!writing_ && end_ != 0 && (_origin == kCurrent || _origin == kSet)) {
+    const int64_t stream_tell = stream_->Tell();
+    const int64_t buffer_begin = stream_tell - static_cast<int64_t>(end_);
+    const int64_t target = _origin == kCurrent ?
+      buffer_begin + static_cast<int64_t>(cursor_) + _offset : _offset;
+    if (stream_tell >= 0 &&
+        target >= buffer_begin && target <= stream_tell) {
+      cursor_ = static_cast<size_t>(target - buffer_begin);
+      return 0;
+    }
+  }
+
+  // Decorated stream position must match *this one before seeking.
+  if (!Flush()) {
+    return -1;
+  }
+  return stream_->Seek(_offset, _origin);
+}
+
+int64_t BufferedStream::Tell() const {
+  const int64_t tell = stream_->Tell();
+  if (tell < 0) {
+    return tell;
+  }
+  if (writing_) {
+    return tell + static_cast<int64_t>(cursor_);
+  }
+  return tell - static_cast<int64_t>(end_ - cursor_);
+}
+
+// Starts CompressedStream implementation.
+
+namespace {
+
+// Implements LZ4 block format compression and decompression.
+// See https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md.
+namespace lz4 {
+
+// Minimum length of a match.
+const size_t kMinMatch = 4;
+
+// The last match must start at least kMatchStartLimit bytes before the end of
+// the block, and the last kLastLiterals bytes are always literals.
+const size_t kMatchStartLimit = 12;
+const size_t kLastLiterals = 5;
+
+// Matches offsets are 16 bits.
+const size_t kMaxOffset = 65535;
+
+// Size in bits of the hash table used to find matches.
+const int kHashBits = 12;
+
+// Returns the maximum compressed size of _size bytes.
+size_t Bound(size_t _size) {
+  return _size + _size / 255 + 16;
+}
+
+uint32_t Load32(const unsigned char* _src) {
+  uint32_t value;
+  std::memcpy(&value, _src, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t _sequence) {
+  return (_sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+// Writes a token length extension, for lengths greater or equal to 15.
+unsigned char* WriteLength(size_t _length, unsigned char* _dest) {
+  for (; _length >= 255; _length -= 255) {
+    *_dest++ = 255;
+  }
+  *_dest++ = static_cast<unsigned char>(_length);
+  return _dest;
+}
+
+// Writes a sequence of _num_literals literals from _literals, followed by a
+// match of _match_length at _offset, or no match if _match_length is 0.
+unsigned char* WriteSequence(const unsigned char* _literals,
+                             size_t _num_literals,
+                             size_t _offset,
+                             size_t _match_length,
+                             unsigned char* _dest) {
+  unsigned char* token = _dest++;
+  *token =
+    static_cast<unsigned char>(math::Min<size_t>(_num_literals, 15) << 4);
+  if (_num_literals >= 15) {
+    _dest = WriteLength(_num_literals - 15, _dest);
+  }
+  std::memcpy(_dest, _literals, _num_literals);
+  _dest += _num_literals;
+  if (_match_length) {
+    *_dest++ = static_cast<unsigned char>(_offset & 0xff);
+    *_dest++ = static_cast<unsigned char>(_offset >> 8);
+    const size_t length = _match_length - kMinMatch;
+    *token |= static_cast<unsigned char>(math::Min<size_t>(length, 15));
+    if (length >= 15) {
+      _dest = WriteLength(length - 15, _dest);
+    }
+  }
+  return _dest;
+}
+
+// Compresses _size bytes from _src to _dest, which must be able to store
+// Bound(_size) bytes. Returns compressed size.
+// Matches are searched greedily with a hash table of the last position of
+// every 4 bytes sequence.
+size_t Compress(const unsigned char* _src, size_t _size,
+                unsigned char* _dest) {
+  unsigned char* dest = _dest;
+  size_t anchor = 0;
+  if (_size > kMatchStartLimit) {
+    uint32_t table[1 << kHashBits];
+    std::memset(table, 0xff, sizeof(table));
+    const size_t match_start_limit = _size - kMatchStartLimit;
+    const size_t match_end_limit = _size - kLastLiterals;
+    size_t ip = 0;
+    while (ip < match_start_limit) {
+      const uint32_t sequence = Load32(_src + ip);
+      const uint32_t hash = Hash(sequence);
+      const uint32_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(ip);
+      if (candidate == 0xffffffff || ip - candidate > kMaxOffset ||
+          Load32(_src + candidate) != sequence) {
+        ++ip;
+        continue;
+      }
+      size_t length = kMinMatch;
+      while (ip + length < match_end_limit &&
+             _src[candidate + length] == _src[ip + length]) {
+        ++length;
+      }
+      dest = WriteSequence(_src + anchor, ip - anchor, ip - candidate, length,
+                           dest);
+      ip += length;
+      anchor = ip;
+    }
+  }
+  // Last literals.
+  dest = WriteSequence(_src + anchor, _size - anchor, 0, 0, dest);
+  return static_cast<size_t>(dest - _dest);
+}
+
+// Reads a token length extension. Returns false if _src is exhausted.
+bool ReadLength(const unsigned char* _src, size_t _size, size_t* _cursor,
+                size_t* _length) {
+  for (;;) {
+    if (*_cursor >= _size) {
+      return false;
+    }
+    const unsigned char byte = _src[(*_cursor)++];
+    *_length += byte;
+    if (byte != 255) {
+      return true;
+    }
+  }
+}
+
+// Decompresses _size bytes from _src to _dest, which must decompress to
+// exactly _dest_size bytes. Returns false if _src is corrupted.
+bool Decompress(const unsigned char* _src, size_t _size,
+                unsigned char* _dest, size_t _dest_size) {
+  size_t ip = 0;
+  size_t op = 0;
+  for (;;) {
+    if (ip >= _size) {
+      return false;
+    }
+    const unsigned char token = _src[ip++];
+
+    // Copies literals.
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !ReadLength(_src, _size, &ip, &num_literals)) {
+      return false;
+    }
+    if (num_literals > _size - ip || num_literals > _dest_size - op) {
+      return false;
+    }
+    std::memcpy(_dest + op, _src + ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+    if (ip == _size) {  // The last sequence has no match.
+      return op == _dest_size;
+    }
+
+    // Copies match, which can overlap the bytes being written.
+    if (_size - ip < 2) {
+      return false;
+    }
+    const size_t offset = _src[ip] | (_src[ip + 1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > op) {
+      return false;
+    }
+    size_t length = token & 15;
+    if (length == 15 && !ReadLength(_src, _size, &ip, &length)) {
+      return false;
+    }
+    length += kMinMatch;
+    if (length > _dest_size - op) {
+      return false;
+    }
+    const unsigned char* match = _dest + op - offset;
+    if (offset >= length) {
+      std::memcpy(_dest + op, match, length);
+    } else {
+      for (size_t i = 0; i < length; ++i) {
+        _dest[op + i] = match[i];
+      }
+    }
+    op += length;
+  }
+}
+}  // lz4
+
+// Compressed stream header, stored little endian.
+struct CompressedHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t block_size;
+  uint32_t num_blocks;
+  uint64_t size;  // Uncompressed size.
+  uint64_t table;  // Offset of the seek table from the header.
+};
+
+const char kCompressedMagic[4] = {'o', 'z', 'l', 'z'};
+const uint32_t kCompressedVersion = 1;
+
+// Header is written field by field, so that its size doesn't depend on
+// padding.
+const size_t kCompressedHeaderSize = 32;
+
+template<typename _Ty>
+_Ty ToLittleEndian(_Ty _value) {
+  return GetNativeEndianness() == kLittleEndian ?
+    _value : EndianSwapper<_Ty>::Swap(_value);
+}
+
+bool WriteHeader(Stream* _stream, const CompressedHeader& _header) {
+  char buffer[kCompressedHeaderSize];
+  std::memcpy(buffer, _header.magic, 4);
+  const uint32_t version = ToLittleEndian(_header.version);
+  std::memcpy(buffer + 4, &version, 4);
+  const uint32_t block_size = ToLittleEndian(_header.block_size);
+  std::memcpy(buffer + 8, &block_size, 4);
+  const uint32_t num_blocks = ToLittleEndian(_header.num_blocks);
+  std::memcpy(buffer + 12, &num_blocks, 4);
+  const uint64_t size = ToLittleEndian(_header.size);
+  std::memcpy(buffer + 16, &size, 8);
+  const uint64_t table = ToLittleEndian(_header.table);
+  std::memcpy(buffer + 24, &table, 8);
+  return _stream->Write(buffer, sizeof(buffer)) == sizeof(buffer);
+}
+
+bool ReadHeader(Stream* _stream, CompressedHeader* _header) {
+  char buffer[kCompressedHeaderSize];
+  if (_stream->Read(buffer, sizeof(buffer)) != sizeof(buffer)) {
+    return false;
+  }
+  std::memcpy(_header->magic, buffer, 4);
+  std::memcpy(&_header->version, buffer + 4, 4);
+  _header->version = ToLittleEndian(_header->version);
+  std::memcpy(&_header->block_size, buffer + 8, 4);
+  _header->block_size = ToLittleEndian(_header->block_size);
+  std::memcpy(&_header->num_blocks, buffer + 12, 4);
+  _header->num_blocks = ToLittleEndian(_header->num_blocks);
+  std::memcpy(&_header->size, buffer + 16, 8);
+  _header->size = ToLittleEndian(_header->size);
+  std::memcpy(&_header->table, buffer + 24, 8);
+  _header->table = ToLittleEndian(_header->table);
+  return std::memcmp(_header->magic, kCompressedMagic, 4) == 0 &&
+         _header->version == kCompressedVersion;
+}
+}  // namespace
+
+const size_t CompressedStream::kDefaultBlockSize = 64<<10;
+
+bool CompressedStream::IsCompressed(Stream* _stream) {
+  if (!_stream || !_stream->opened()) {
+    return false;
+  }
+  const int64_t tell = _stream->Tell();
+  CompressedHeader header;
+  const bool compressed = ReadHeader(_stream, &header);
+  if (_stream->Seek(tell, kSet) != 0) {
+    return false;
+  }
+  return compressed;
+}
+
+CompressedStream::CompressedStream(Stream* _stream,
+                                   Mode _mode,
+                                   size_t _block_size)
+    : stream_(_stream),
+      mode_(_mode),
+      block_size_(_block_size),
+      origin_(-1),
+      block_(NULL),
+      compressed_(NULL),
+      table_(NULL),
+      num_blocks_(0),
+      table_capacity_(0),
+      loaded_block_(~size_t(0)),
+      pending_(0),
+      size_(0),
+      position_(0),
+      opened_(false) {
+  if (!stream_ || !stream_->opened()) {
+    return;
+  }
+  origin_ = stream_->Tell();
+  if (origin_ < 0) {
+    return;
+  }
+  if (mode_ == kRead) {
+    opened_ = OpenRead();
+    if (!opened_) {
+      memory::Allocator* allocator = memory::default_allocator();
+      allocator->Deallocate(table_);
+      table_ = NULL;
+      num_blocks_ = 0;
+      stream_->Seek(origin_, kSet);
+    }
+  } else {
+    if (block_size_ == 0 || block_size_ > 0xffffffff) {
+      return;
+    }
+    // Header is written again once the stream is closed.
+    const CompressedHeader header = {
+      {kCompressedMagic[0], kCompressedMagic[1], kCompressedMagic[2],
+       kCompressedMagic[3]},
+      kCompressedVersion, 0, 0, 0, 0};
+    opened_ = WriteHeader(stream_, header);
+  }
+  if (opened_) {
+    memory::Allocator* allocator = memory::default_allocator();
+    block_ = allocator->Allocate<char>(block_size_);
+    compressed_ = allocator->Allocate<char>(
+      mode_ == kRead ? block_size_ : lz4::Bound(block_size_));
+  }
+}
+
+CompressedStream::~CompressedStream() {
+  Close();
+}
+
+bool CompressedStream::OpenRead() {
+  CompressedHeader header;
+  if (!ReadHeader(stream_, &header) || header.block_size == 0) {
+    return false;
+  }
+  // Tests header consistency.
+  const uint64_t num_blocks =
+    (header.size + header.block_size - 1) / header.block_size;
+  if (num_blocks != header.num_blocks ||
+      header.table < kCompressedHeaderSize ||
+      header.size > static_cast<uint64_t>(
+        std::numeric_limits<int64_t>::max())) {
+    return false;
+  }
+  block_size_ = header.block_size;
+  size_ = static_cast<int64_t>(header.size);
+  num_blocks_ = header.num_blocks;
+
+  // Tests that the seek table fits in the decorated stream before allocating
+  // it, as a corrupted header can specify any number of blocks.
+  if (stream_->Seek(0, kEnd) != 0) {
+    return false;
+  }
+  const int64_t end = stream_->Tell();
+  if (end < origin_) {
+    return false;
+  }
+  const uint64_t available = static_cast<uint64_t>(end - origin_);
+  if (header.table > available ||
+      num_blocks * sizeof(uint32_t) > available - header.table) {
+    return false;
+  }
+
+  // Reads seek table, and converts block sizes to offsets.
+  if (stream_->Seek(origin_ + static_cast<int64_t>(header.table), kSet) != 0) {
+    return false;
+  }
+  memory::Allocator* allocator = memory::default_allocator();
+  table_ = allocator->Allocate<uint64_t>(num_blocks_ + 1);
+  if (!table_) {
+    return false;
+  }
+  table_[0] = kCompressedHeaderSize;
+  for (size_t i = 0; i < num_blocks_; ++i) {
+    uint32_t size;
+    if (stream_->Read(&size, sizeof(size)) != sizeof(size)) {
+      return false;
+    }
+    size = ToLittleEndian(size);
+    if (size > block_size_) {
+      return false;
+    }
+    table_[i + 1] = table_[i] + size;
+  }
+  return table_[num_blocks_] == header.table;
+}
+
+bool CompressedStream::Close() {
+  if (!opened_) {
+    return false;
+  }
+  opened_ = false;
+  bool success = true;
+  if (mode_ == kWrite) {
+    // Writes last block, seek table and final header.
+    success = FlushBlock();
+    const int64_t table = stream_->Tell();
+    for (size_t i = 0; success && i < num_blocks_; ++i) {
+      const uint32_t size = ToLittleEndian(static_cast<uint32_t>(table_[i]));
+      success = stream_->Write(&size, sizeof(size)) == sizeof(size);
+    }
+    const int64_t end = stream_->Tell();
+    if (success && table >= 0 && end >= 0 &&
+        stream_->Seek(origin_, kSet) == 0) {
+      const CompressedHeader header = {
+        {kCompressedMagic[0], kCompressedMagic[1], kCompressedMagic[2],
+         kCompressedMagic[3]},
+        kCompressedVersion,
+        static_cast<uint32_t>(block_size_),
+        static_cast<uint32_t>(num_blocks_),
+        static_cast<uint64_t>(size_),
+        static_cast<uint64_t>(table - origin_)};
+      success = WriteHeader(stream_, header) &&
+                stream_->Seek(end, kSet) == 0;
+    } else {
+      success = false;
+    }
+  } else {
+    // Leaves decorated stream at the end of compressed data.
+    success = stream_->Seek(
+      origin_ + static_cast<int64_t>(table_[num_blocks_]) +
+      static_cast<int64_t>(num_blocks_ * sizeof(uint32_t)), kSet) == 0;
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(block_);
+  block_ = NULL;
+  allocator->Deallocate(compressed_);
+  compressed_ = NULL;
+  allocator->Deallocate(table_);
+  table_ = NULL;
+  return success;
+}
+
+bool CompressedStream::opened() const {
+  return opened_;
+}
+
+bool CompressedStream::LoadBlock(size_t _block) {
+  assert(mode_ == kRead && _block < num_blocks_);
+  const size_t size = static_cast<size_t>(table_[_block + 1] - table_[_block]);
+  const size_t uncompressed_size = _block + 1 < num_blocks_ ?
+    block_size_ : static_cast<size_t>(size_ - _block * block_size_);
+  if (size > uncompressed_size) {
+    return false;
+  }
+  loaded_block_ = ~size_t(0);
+  if (stream_->Seek(origin_ + static_cast<int64_t>(table_[_block]),
+                    kSet) != 0) {
+    return false;
+  }
+  // Blocks that didn't compress are stored as is.
+  if (size == uncompressed_size) {
+    if (stream_->Read(block_, size) != size) {
+      return false;
+    }
+  } else {
+    if (stream_->Read(compressed_, size) != size ||
+        !lz4::Decompress(reinterpret_cast<unsigned char*>(compressed_), size,
+                         reinterpret_cast<unsigned char*>(block_),
+                         uncompressed_size)) {
+      return false;
+    }
+  }
+  loaded_block_ = _block;
+  return true;
+}
+
+bool CompressedStream::FlushBlock() {
+  assert(mode_ == kWrite);
+  if (pending_ == 0) {
+    return true;
+  }
+  if (num_blocks_ == table_capacity_) {
+    table_capacity_ = table_capacity_ ? table_capacity_ * 2 : 16;
+    table_ = memory::default_allocator()->Reallocate(table_, table_capacity_);
+  }
+  const size_t size = lz4::Compress(
+    reinterpret_cast<const unsigned char*>(block_), pending_,
+    reinterpret_cast<unsigned char*>(compressed_));
+  bool success;
+  if (size < pending_) {
+    table_[num_blocks_] = size;
+    success = stream_->Write(compressed_, size) == size;
+  } else {
+    table_[num_blocks_] = pending_;
+    success = stream_->Write(block_, pending_) == pending_;
+  }
+  ++num_blocks_;
+  pending_ = 0;
+  return success;
+}
+
+size_t CompressedStream::Read(void* _buffer, size_t _size) {
+  if (!opened_ || mode_ != kRead) {
+    return 0;
+  }
+  char* buffer = static_cast<char*>(_buffer);
+  size_t read = 0;
+  while (read < _size && position_ < size_) {
+    const size_t block = static_cast<size_t>(position_ / block_size_);
+    if (block != loaded_block_ && !LoadBlock(block)) {
+      break;
+    }
+    const size_t block_end = block + 1 < num_blocks_ ?
+      block_size_ : static_cast<size_t>(size_ - block * block_size_);
+    const size_t offset =
+      static_cast<size_t>(position_ - block * block_size_);
+    const size_t count = math::Min(block_end - offset, _size - read);
+    std::memcpy(buffer + read, block_ + offset, count);
+    read += count;
+    position_ += count;
+  }
+  return read;
+}
+
+size_t CompressedStream::Write(const void* _buffer, size_t _size) {
+  if (!opened_ || mode_ != kWrite) {
+    return 0;
+  }
+  const char* buffer = static_cast<const char*>(_buffer);
+  size_t written = 0;
+  while (written < _size) {
+    const size_t count = math::Min(block_size_ - pending_, _size - written);
+    std::memcpy(block_ + pending_, buffer + written, count);
+    pending_ += count;
+    written += count;
+    if (pending_ == block_size_ && !FlushBlock()) {
+      break;
+    }
+  }
+  size_ += written;
+  position_ = size_;
+  return written;
+}
+
+int CompressedStream::Seek(int64_t _offset, Origin _origin) {
+  if (!opened_) {
+    return -1;
+  }
+  int64_t target;
+  switch (_origin) {
+    case kCurrent: target = position_ + _offset; break;
+    case kEnd: target = size_ + _offset; break;
+    case kSet: target = _offset; break;
+    default: return -1;
+  }
+  if (target < 0 || target > size_ ||
+      (mode_ == kWrite && target != position_)) {
+    return -1;
+  }
+  position_ = target;
+  return 0;
+}
+
+int64_t CompressedStream::Tell() const {
+  return opened_ ? position_ : -1;
+}
 }  // io
 }  // ozz
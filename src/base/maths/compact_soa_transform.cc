@@ -0,0 +1,182 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/compact_soa_transform.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace math {
+
+namespace {
+// Stores the 16 bits values of the 4 lanes of _v to _out.
+OZZ_INLINE void Store16(_SimdInt4 _v, uint16_t _out[4]) {
+  int lanes[4];
+  StorePtrU(_v, lanes);
+  _out[0] = static_cast<uint16_t>(lanes[0]);
+  _out[1] = static_cast<uint16_t>(lanes[1]);
+  _out[2] = static_cast<uint16_t>(lanes[2]);
+  _out[3] = static_cast<uint16_t>(lanes[3]);
+}
+
+OZZ_INLINE void Store16(_SimdInt4 _v, int16_t _out[4]) {
+  int lanes[4];
+  StorePtrU(_v, lanes);
+  _out[0] = static_cast<int16_t>(lanes[0]);
+  _out[1] = static_cast<int16_t>(lanes[1]);
+  _out[2] = static_cast<int16_t>(lanes[2]);
+  _out[3] = static_cast<int16_t>(lanes[3]);
+}
+
+template<typename _Ty>
+OZZ_INLINE SimdInt4 Load16(const _Ty _in[4]) {
+  return simd_int4::Load(_in[0], _in[1], _in[2], _in[3]);
+}
+
+// Packs soa float3 _in to half precision floats _out.
+OZZ_INLINE void PackHalves(const SoaFloat3& _in, uint16_t _out[3][4]) {
+  Store16(FloatToHalf(_in.x), _out[0]);
+  Store16(FloatToHalf(_in.y), _out[1]);
+  Store16(FloatToHalf(_in.z), _out[2]);
+}
+
+OZZ_INLINE void UnpackHalves(const uint16_t _in[3][4], SoaFloat3* _out) {
+  _out->x = HalfToFloat(Load16(_in[0]));
+  _out->y = HalfToFloat(Load16(_in[1]));
+  _out->z = HalfToFloat(Load16(_in[2]));
+}
+
+// Packs soa quaternion _quat with smallest three compression. The largest
+// component of each lane is found with comparisons to the lane maximum, so
+// that the 3 others can be selected in order.
+OZZ_INLINE void PackRotations(const SoaQuaternion& _quat,
+                              CompactSoaTransform* _out) {
+  const SimdFloat4 ax = Abs(_quat.x);
+  const SimdFloat4 ay = Abs(_quat.y);
+  const SimdFloat4 az = Abs(_quat.z);
+  const SimdFloat4 aw = Abs(_quat.w);
+  const SimdFloat4 max = Max(Max(ax, ay), Max(az, aw));
+  const SimdInt4 is_x = CmpEq(ax, max);
+  const SimdInt4 is_y = And(Not(is_x), CmpEq(ay, max));
+  const SimdInt4 is_xy = Or(is_x, is_y);
+  const SimdInt4 is_z = And(Not(is_xy), CmpEq(az, max));
+  const SimdInt4 is_w = Not(Or(is_xy, is_z));
+
+  // Quantizes smallest three.
+  const SimdFloat4 scale = simd_float4::Load1(kCompactRotationScale);
+  const SimdFloat4 a = Select(is_x, _quat.y, _quat.x);
+  const SimdFloat4 b = Select(is_xy, _quat.z, _quat.y);
+  const SimdFloat4 c = Select(is_w, _quat.z, _quat.w);
+  Store16(simd_int4::FromFloatRound(a * scale), _out->rotation[0]);
+  Store16(simd_int4::FromFloatRound(b * scale), _out->rotation[1]);
+  Store16(simd_int4::FromFloatRound(c * scale), _out->rotation[2]);
+
+  // Encodes dropped component index and sign.
+  const SimdFloat4 d =
+    Select(is_x, _quat.x,
+           Select(is_y, _quat.y, Select(is_z, _quat.z, _quat.w)));
+  const SimdInt4 index =
+    Or(Or(And(is_y, simd_int4::one()),
+          And(is_z, simd_int4::Load(2, 2, 2, 2))),
+       And(is_w, simd_int4::Load(3, 3, 3, 3)));
+  const SimdInt4 sign = And(CmpGe(d, simd_float4::zero()),
+                            simd_int4::Load(4, 4, 4, 4));
+  int largest[4];
+  StorePtrU(Or(index, sign), largest);
+  for (int i = 0; i < 4; ++i) {
+    _out->largest[i] = static_cast<uint8_t>(largest[i]);
+  }
+}
+
+// Unpacks smallest three compressed rotations. The dropped component is
+// restored, then put back in place with selections according to its index.
+OZZ_INLINE void UnpackRotations(const CompactSoaTransform& _in,
+                                SoaQuaternion* _quat) {
+  const SimdFloat4 int_to_float =
+    simd_float4::Load1(1.f / kCompactRotationScale);
+  const SimdFloat4 a =
+    int_to_float * simd_float4::FromInt(Load16(_in.rotation[0]));
+  const SimdFloat4 b =
+    int_to_float * simd_float4::FromInt(Load16(_in.rotation[1]));
+  const SimdFloat4 c =
+    int_to_float * simd_float4::FromInt(Load16(_in.rotation[2]));
+
+  // Restores the dropped component, and reapplies its sign.
+  const SimdFloat4 dd =
+    Max(simd_float4::zero(), simd_float4::one() - (a * a + b * b + c * c));
+  const SimdFloat4 d_abs = Sqrt(dd);
+  const SimdInt4 largest = Load16(_in.largest);
+  const SimdInt4 four = simd_int4::Load(4, 4, 4, 4);
+  const SimdFloat4 d = Select(CmpEq(And(largest, four), four), d_abs, -d_abs);
+
+  const SimdInt4 index = And(largest, simd_int4::Load(3, 3, 3, 3));
+  const SimdInt4 is_x = CmpEq(index, simd_int4::zero());
+  const SimdInt4 is_y = CmpEq(index, simd_int4::one());
+  const SimdInt4 is_z = CmpEq(index, simd_int4::Load(2, 2, 2, 2));
+  const SimdInt4 is_w = CmpEq(index, simd_int4::Load(3, 3, 3, 3));
+  _quat->x = Select(is_x, d, a);
+  _quat->y = Select(is_x, a, Select(is_y, d, b));
+  _quat->z = Select(is_w, c, Select(is_z, d, b));
+  _quat->w = Select(is_w, d, c);
+}
+}  // namespace
+
+bool Pack(const Range<const SoaTransform>& _input,
+          const Range<CompactSoaTransform>& _output) {
+  if (_output.Count() < _input.Count()) {
+    return false;
+  }
+  for (size_t i = 0; i < _input.Count(); ++i) {
+    const SoaTransform& in = _input.begin[i];
+    CompactSoaTransform& out = _output.begin[i];
+    PackHalves(in.translation, out.translation);
+    PackRotations(in.rotation, &out);
+    PackHalves(in.scale, out.scale);
+  }
+  return true;
+}
+
+bool Unpack(const Range<const CompactSoaTransform>& _input,
+            const Range<SoaTransform>& _output) {
+  if (_output.Count() < _input.Count()) {
+    return false;
+  }
+  for (size_t i = 0; i < _input.Count(); ++i) {
+    const CompactSoaTransform& in = _input.begin[i];
+    SoaTransform& out = _output.begin[i];
+    UnpackHalves(in.translation, &out.translation);
+    UnpackRotations(in, &out.rotation);
+    UnpackHalves(in.scale, &out.scale);
+  }
+  return true;
+}
+}  // math
+}  // ozz
@@ -0,0 +1,74 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/simd_dispatch.h"
+
+namespace ozz {
+namespace math {
+
+bool IsSimdDispatchEnabled() {
+#ifdef OZZ_SIMD_DISPATCH_ENABLED
+  return true;
+#else   // OZZ_SIMD_DISPATCH_ENABLED
+  return false;
+#endif  // OZZ_SIMD_DISPATCH_ENABLED
+}
+
+SimdLevel GetDispatchedSimdLevel() {
+#ifdef OZZ_SIMD_DISPATCH_ENABLED
+  // Follows the same priority order as the loader, see OZZ_SIMD_DISPATCH.
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return kSimdLevelAvx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return kSimdLevelAvx2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return kSimdLevelSse4_1;
+  }
+#endif  // OZZ_SIMD_DISPATCH_ENABLED
+  return kSimdLevelDefault;
+}
+
+const char* GetSimdLevelName(SimdLevel _level) {
+  switch (_level) {
+    case kSimdLevelSse4_1:
+      return "SSE4.1";
+    case kSimdLevelAvx2:
+      return "AVX2";
+    case kSimdLevelAvx512:
+      return "AVX-512";
+    default:
+      return "Default";
+  }
+}
+}  // math
+}  // ozz
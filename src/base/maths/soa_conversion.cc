@@ -0,0 +1,249 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/soa_conversion.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
+
+namespace ozz {
+namespace math {
+
+namespace {
+// Loads the 4 float3 that start at _f, _f + _stride, _f + 2 * _stride and
+// _f + 3 * _stride. Unaligned full width loads are used, so the unused w
+// component is read from the float that follows each float3. This float
+// must be readable, which is always true for the first 3, and must be
+// specified with _overread for the last one.
+OZZ_INLINE void LoadFloat3x4(const float* _f, size_t _stride, bool _overread,
+                             SimdFloat4 _out[4]) {
+  _out[0] = simd_float4::LoadPtrU(_f);
+  _out[1] = simd_float4::LoadPtrU(_f + _stride);
+  _out[2] = simd_float4::LoadPtrU(_f + _stride * 2);
+  _out[3] = _overread ? simd_float4::LoadPtrU(_f + _stride * 3)
+                      : simd_float4::Load3PtrU(_f + _stride * 3);
+}
+
+// Loads the 4 float4 that start at _f, _f + _stride, _f + 2 * _stride and
+// _f + 3 * _stride.
+OZZ_INLINE void LoadFloat4x4(const float* _f, size_t _stride,
+                             SimdFloat4 _out[4]) {
+  _out[0] = simd_float4::LoadPtrU(_f);
+  _out[1] = simd_float4::LoadPtrU(_f + _stride);
+  _out[2] = simd_float4::LoadPtrU(_f + _stride * 2);
+  _out[3] = simd_float4::LoadPtrU(_f + _stride * 3);
+}
+
+// Stores float3 _v to _f. A full width store is used if _overwrite, which
+// also writes the float that follows _f + 2. The caller must then write this
+// float afterwards.
+OZZ_INLINE void StoreFloat3(_SimdFloat4 _v, bool _overwrite, float* _f) {
+  if (_overwrite) {
+    StorePtrU(_v, _f);
+  } else {
+    Store3PtrU(_v, _f);
+  }
+}
+
+// Number of floats of Float3, Quaternion and Transform.
+const size_t kFloat3Stride = sizeof(Float3) / sizeof(float);
+const size_t kQuaternionStride = sizeof(Quaternion) / sizeof(float);
+const size_t kTransformStride = sizeof(Transform) / sizeof(float);
+OZZ_STATIC_ASSERT(kTransformStride == 10);
+}  // namespace
+
+bool ToSoa(const Range<const Float3>& _aos, const Range<SoaFloat3>& _soa) {
+  const size_t count = _aos.Count();
+  const size_t num_soa = (count + 3) / 4;
+  if (_soa.Count() < num_soa) {
+    return false;
+  }
+
+  // Full soa elements. The last float3 is over read if another one follows.
+  const size_t num_full = count / 4;
+  const Float3* aos = _aos.begin;
+  for (size_t i = 0; i < num_full; ++i, aos += 4) {
+    SimdFloat4 in[4];
+    LoadFloat3x4(&aos->x, kFloat3Stride, aos + 4 < _aos.end, in);
+    Transpose4x3(in, &_soa.begin[i].x);
+  }
+
+  // Partial last soa element.
+  if (num_full != num_soa) {
+    const SimdFloat4 zero = simd_float4::zero();
+    SimdFloat4 in[4] = {zero, zero, zero, zero};
+    for (size_t j = 0; aos + j < _aos.end; ++j) {
+      in[j] = simd_float4::Load3PtrU(&aos[j].x);
+    }
+    Transpose4x3(in, &_soa.begin[num_full].x);
+  }
+  return true;
+}
+
+bool ToSoa(const Range<const Quaternion>& _aos,
+           const Range<SoaQuaternion>& _soa) {
+  const size_t count = _aos.Count();
+  const size_t num_soa = (count + 3) / 4;
+  if (_soa.Count() < num_soa) {
+    return false;
+  }
+
+  const size_t num_full = count / 4;
+  const Quaternion* aos = _aos.begin;
+  for (size_t i = 0; i < num_full; ++i, aos += 4) {
+    SimdFloat4 in[4];
+    LoadFloat4x4(&aos->x, kQuaternionStride, in);
+    Transpose4x4(in, &_soa.begin[i].x);
+  }
+
+  if (num_full != num_soa) {
+    const SimdFloat4 identity = simd_float4::w_axis();
+    SimdFloat4 in[4] = {identity, identity, identity, identity};
+    for (size_t j = 0; aos + j < _aos.end; ++j) {
+      in[j] = simd_float4::LoadPtrU(&aos[j].x);
+    }
+    Transpose4x4(in, &_soa.begin[num_full].x);
+  }
+  return true;
+}
+
+bool ToSoa(const Range<const Transform>& _aos,
+           const Range<SoaTransform>& _soa) {
+  const size_t count = _aos.Count();
+  const size_t num_soa = (count + 3) / 4;
+  if (_soa.Count() < num_soa) {
+    return false;
+  }
+
+  // Translations are followed by rotations, so they can always be over read.
+  // Scales are followed by the next transform, if any.
+  const size_t num_full = count / 4;
+  const Transform* aos = _aos.begin;
+  for (size_t i = 0; i < num_full; ++i, aos += 4) {
+    SoaTransform& soa = _soa.begin[i];
+    SimdFloat4 in[4];
+    LoadFloat3x4(&aos->translation.x, kTransformStride, true, in);
+    Transpose4x3(in, &soa.translation.x);
+    LoadFloat4x4(&aos->rotation.x, kTransformStride, in);
+    Transpose4x4(in, &soa.rotation.x);
+    LoadFloat3x4(&aos->scale.x, kTransformStride, aos + 4 < _aos.end, in);
+    Transpose4x3(in, &soa.scale.x);
+  }
+
+  if (num_full != num_soa) {
+    SoaTransform& soa = _soa.begin[num_full];
+    const SimdFloat4 zero = simd_float4::zero();
+    const SimdFloat4 one = simd_float4::one();
+    const SimdFloat4 identity = simd_float4::w_axis();
+    SimdFloat4 translations[4] = {zero, zero, zero, zero};
+    SimdFloat4 rotations[4] = {identity, identity, identity, identity};
+    SimdFloat4 scales[4] = {one, one, one, one};
+    for (size_t j = 0; aos + j < _aos.end; ++j) {
+      translations[j] = simd_float4::LoadPtrU(&aos[j].translation.x);
+      rotations[j] = simd_float4::LoadPtrU(&aos[j].rotation.x);
+      scales[j] = simd_float4::Load3PtrU(&aos[j].scale.x);
+    }
+    Transpose4x3(translations, &soa.translation.x);
+    Transpose4x4(rotations, &soa.rotation.x);
+    Transpose4x3(scales, &soa.scale.x);
+  }
+  return true;
+}
+
+bool FromSoa(const Range<const SoaFloat3>& _soa, const Range<Float3>& _aos) {
+  const size_t count = _aos.Count();
+  const size_t num_soa = (count + 3) / 4;
+  if (_soa.Count() < num_soa) {
+    return false;
+  }
+
+  // Float3 are stored in order, so that each full width store is fixed up by
+  // the next one. The last float3 of the array can't be overwritten.
+  Float3* aos = _aos.begin;
+  for (size_t i = 0; i < num_soa; ++i, aos += 4) {
+    SimdFloat4 out[4];
+    Transpose3x4(&_soa.begin[i].x, out);
+    for (size_t j = 0; j < 4 && aos + j < _aos.end; ++j) {
+      StoreFloat3(out[j], aos + j + 1 < _aos.end, &aos[j].x);
+    }
+  }
+  return true;
+}
+
+bool FromSoa(const Range<const SoaQuaternion>& _soa,
+             const Range<Quaternion>& _aos) {
+  const size_t count = _aos.Count();
+  const size_t num_soa = (count + 3) / 4;
+  if (_soa.Count() < num_soa) {
+    return false;
+  }
+
+  Quaternion* aos = _aos.begin;
+  for (size_t i = 0; i < num_soa; ++i, aos += 4) {
+    SimdFloat4 out[4];
+    Transpose4x4(&_soa.begin[i].x, out);
+    for (size_t j = 0; j < 4 && aos + j < _aos.end; ++j) {
+      StorePtrU(out[j], &aos[j].x);
+    }
+  }
+  return true;
+}
+
+bool FromSoa(const Range<const SoaTransform>& _soa,
+             const Range<Transform>& _aos) {
+  const size_t count = _aos.Count();
+  const size_t num_soa = (count + 3) / 4;
+  if (_soa.Count() < num_soa) {
+    return false;
+  }
+
+  // Each transform is stored translation first, then rotation and scale, so
+  // that full width stores are fixed up by the following one.
+  Transform* aos = _aos.begin;
+  for (size_t i = 0; i < num_soa; ++i, aos += 4) {
+    const SoaTransform& soa = _soa.begin[i];
+    SimdFloat4 translations[4];
+    SimdFloat4 rotations[4];
+    SimdFloat4 scales[4];
+    Transpose3x4(&soa.translation.x, translations);
+    Transpose4x4(&soa.rotation.x, rotations);
+    Transpose3x4(&soa.scale.x, scales);
+    for (size_t j = 0; j < 4 && aos + j < _aos.end; ++j) {
+      Transform& transform = aos[j];
+      StoreFloat3(translations[j], true, &transform.translation.x);
+      StorePtrU(rotations[j], &transform.rotation.x);
+      StoreFloat3(scales[j], aos + j + 1 < _aos.end, &transform.scale.x);
+    }
+  }
+  return true;
+}
+}  // math
+}  // ozz
@@ -0,0 +1,102 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/soa_quaternion_batch.h"
+
+#include "ozz/base/maths/simd_dispatch.h"
+#include "ozz/base/maths/soa_quaternion.h"
+
+namespace ozz {
+namespace math {
+
+namespace {
+OZZ_SIMD_DISPATCH
+void NLerpEstKernel(const SoaQuaternion* _a, const SoaQuaternion* _b,
+                    float _alpha, size_t _count, SoaQuaternion* _output) {
+  const SimdFloat4 alpha = simd_float4::Load1(_alpha);
+  for (size_t i = 0; i < _count; ++i) {
+    _output[i] = NLerpEst(_a[i], _b[i], alpha);
+  }
+}
+
+OZZ_SIMD_DISPATCH
+void SlerpEstKernel(const SoaQuaternion* _a, const SoaQuaternion* _b,
+                    float _alpha, size_t _count, SoaQuaternion* _output) {
+  const SimdFloat4 alpha = simd_float4::Load1(_alpha);
+  for (size_t i = 0; i < _count; ++i) {
+    _output[i] = SlerpEst(_a[i], _b[i], alpha);
+  }
+}
+
+OZZ_SIMD_DISPATCH
+void AngleEstKernel(const SoaQuaternion* _a, const SoaQuaternion* _b,
+                    size_t _count, SimdFloat4* _angles) {
+  for (size_t i = 0; i < _count; ++i) {
+    _angles[i] = AngleEst(_a[i], _b[i]);
+  }
+}
+}  // namespace
+
+bool NLerpEst(const Range<const SoaQuaternion>& _a,
+              const Range<const SoaQuaternion>& _b,
+              float _alpha,
+              const Range<SoaQuaternion>& _output) {
+  const size_t count = _a.Count();
+  if (_b.Count() < count || _output.Count() < count) {
+    return false;
+  }
+  NLerpEstKernel(_a.begin, _b.begin, _alpha, count, _output.begin);
+  return true;
+}
+
+bool SlerpEst(const Range<const SoaQuaternion>& _a,
+              const Range<const SoaQuaternion>& _b,
+              float _alpha,
+              const Range<SoaQuaternion>& _output) {
+  const size_t count = _a.Count();
+  if (_b.Count() < count || _output.Count() < count) {
+    return false;
+  }
+  SlerpEstKernel(_a.begin, _b.begin, _alpha, count, _output.begin);
+  return true;
+}
+
+bool AngleEst(const Range<const SoaQuaternion>& _a,
+              const Range<const SoaQuaternion>& _b,
+              const Range<SimdFloat4>& _angles) {
+  const size_t count = _a.Count();
+  if (_b.Count() < count || _angles.Count() < count) {
+    return false;
+  }
+  AngleEstKernel(_a.begin, _b.begin, count, _angles.begin);
+  return true;
+}
+}  // math
+}  // ozz
@@ -127,5 +127,24 @@ Allocator* SetDefaulAllocator(Allocator* _allocator) {
   g_default_allocator = _allocator;
   return previous;
 }
+
+namespace {
+// The tag that currently applies to allocations.
+Tag g_current_tag = kTagDefault;
+}  // namespace
+
+Tag current_tag() {
+  return g_current_tag;
+}
+
+ScopedTag::ScopedTag(Tag _tag)
+    : previous_(g_current_tag) {
+  assert(_tag >= kTagDefault && _tag < kTagCount);
+  g_current_tag = _tag;
+}
+
+ScopedTag::~ScopedTag() {
+  g_current_tag = previous_;
+}
 }  // memory
 }  // ozz
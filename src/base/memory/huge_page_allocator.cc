@@ -0,0 +1,195 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/huge_page_allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else  // _WIN32
+#include <sys/mman.h>
+#endif  // _WIN32
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+
+// Header stored in front of every block.
+struct Header {
+  // Address returned by the mapping or by the default allocator.
+  void* base;
+  // Allocator the block was forwarded to, NULL for mapped blocks.
+  Allocator* allocator;
+  // Size requested by the user.
+  size_t size;
+  // Size of the mapping, 0 for forwarded blocks.
+  size_t mapped;
+};
+
+Header* GetHeader(void* _block) {
+  return reinterpret_cast<Header*>(
+    reinterpret_cast<char*>(_block) - sizeof(Header));
+}
+
+// Maps _size bytes, a multiple of kHugePageSize, preferably to huge pages.
+// Returns NULL on failure.
+void* MapPages(size_t _size) {
+#if defined(_WIN32)
+  // Large pages require SeLockMemoryPrivilege, and fail otherwise.
+  const SIZE_T large_page = GetLargePageMinimum();
+  if (large_page != 0 && _size % large_page == 0) {
+    void* block = VirtualAlloc(NULL, _size,
+                               MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                               PAGE_READWRITE);
+    if (block) {
+      return block;
+    }
+  }
+  return VirtualAlloc(NULL, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else  // _WIN32
+#if defined(MAP_HUGETLB)
+  // Explicit huge pages fail if none were reserved by the system.
+  void* block = mmap(NULL, _size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (block != MAP_FAILED) {
+    return block;
+  }
+#endif  // MAP_HUGETLB
+
+  // Over-maps by a huge page, so that the block can be aligned on a huge page
+  // boundary, which is required for transparent huge pages to back it.
+  const size_t over_mapped = _size + kHugePageSize;
+  void* raw = mmap(NULL, over_mapped, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    return NULL;
+  }
+  char* begin = reinterpret_cast<char*>(raw);
+  char* aligned = math::Align(begin, kHugePageSize);
+  if (aligned != begin) {
+    munmap(begin, aligned - begin);
+  }
+  const size_t tail = begin + over_mapped - (aligned + _size);
+  if (tail != 0) {
+    munmap(aligned + _size, tail);
+  }
+#if defined(MADV_HUGEPAGE)
+  // Advising is only a hint, its failure isn't an allocation failure.
+  madvise(aligned, _size, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+  return aligned;
+#endif  // _WIN32
+}
+
+void UnmapPages(void* _block, size_t _size) {
+#if defined(_WIN32)
+  (void)_size;
+  VirtualFree(_block, 0, MEM_RELEASE);
+#else  // _WIN32
+  munmap(_block, _size);
+#endif  // _WIN32
+}
+}  // namespace
+
+// Implements the huge page allocator. It has no state, so it's thread safe as
+// long as the default allocator is.
+class HugePageAllocator : public Allocator {
+ protected:
+  void* Allocate(size_t _size, size_t _alignment) {
+    assert(math::IsAligned(kHugePageSize, _alignment) &&
+           "Alignment must be a power of 2 lower than kHugePageSize.");
+    // The header fits in front of the block, without breaking its alignment.
+    const size_t offset = math::Align(sizeof(Header), _alignment);
+    const size_t to_allocate = offset + _size;
+
+    char* base;
+    Allocator* allocator = NULL;
+    size_t mapped = 0;
+    if (to_allocate >= kHugePageThreshold) {
+      mapped = math::Align(to_allocate, kHugePageSize);
+      base = reinterpret_cast<char*>(MapPages(mapped));
+    } else {
+      allocator = default_allocator();
+      base = reinterpret_cast<char*>(
+        allocator->Allocate(to_allocate, _alignment));
+    }
+    if (!base) {
+      return NULL;
+    }
+
+    char* block = base + offset;
+    Header* header = GetHeader(block);
+    header->base = base;
+    header->allocator = allocator;
+    header->size = _size;
+    header->mapped = mapped;
+    return block;
+  }
+
+  void* Reallocate(void* _block, size_t _size, size_t _alignment) {
+    void* new_block = Allocate(_size, _alignment);
+    // Copies and deallocates the old block, which is kept if allocation failed.
+    if (_block && new_block) {
+      const size_t old_size = GetHeader(_block)->size;
+      memcpy(new_block, _block, old_size < _size ? old_size : _size);
+      Deallocate(_block);
+    }
+    return new_block;
+  }
+
+  void Deallocate(void* _block) {
+    if (!_block) {
+      return;
+    }
+    const Header* header = GetHeader(_block);
+    if (header->allocator) {
+      header->allocator->Deallocate(header->base);
+    } else {
+      UnmapPages(header->base, header->mapped);
+    }
+  }
+};
+
+namespace {
+// Instantiates the huge page allocator.
+HugePageAllocator g_huge_page_allocator;
+}  // namespace
+
+Allocator* huge_page_allocator() {
+  return &g_huge_page_allocator;
+}
+}  // memory
+}  // ozz
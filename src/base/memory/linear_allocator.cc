@@ -0,0 +1,243 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/linear_allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+LinearAllocator::LinearAllocator(size_t _size, Allocator* _backing)
+    : backing_(_backing),
+      begin_(reinterpret_cast<char*>(
+        _backing->Allocate(_size, kDefaultAlignment))),
+      end_(begin_ ? begin_ + _size : NULL),
+      top_(begin_),
+      last_(NULL) {
+}
+
+LinearAllocator::LinearAllocator(void* _buffer, size_t _size)
+    : backing_(NULL),
+      begin_(reinterpret_cast<char*>(_buffer)),
+      end_(begin_ ? begin_ + _size : NULL),
+      top_(begin_),
+      last_(NULL) {
+}
+
+LinearAllocator::~LinearAllocator() {
+  if (backing_) {
+    backing_->Deallocate(begin_);
+  }
+}
+
+void* LinearAllocator::Allocate(size_t _size, size_t _alignment) {
+  char* block = ozz::math::Align(top_, _alignment);
+  if (!begin_ || block > end_ || _size > static_cast<size_t>(end_ - block)) {
+    return NULL;
+  }
+  top_ = block + _size;
+  last_ = block;
+  return block;
+}
+
+void LinearAllocator::Deallocate(void* _block) {
+  if (_block && _block == last_) {
+    top_ = last_;
+    last_ = NULL;
+  }
+}
+
+void* LinearAllocator::Reallocate(void* _block,
+                                  size_t _size,
+                                  size_t _alignment) {
+  if (!_block) {
+    return Allocate(_size, _alignment);
+  }
+  char* block = reinterpret_cast<char*>(_block);
+  assert(block >= begin_ && block <= top_ && "Block not owned by allocator.");
+
+  // The latest allocation can be resized in place.
+  if (block == last_ && ozz::math::IsAligned(block, _alignment) &&
+      _size <= static_cast<size_t>(end_ - block)) {
+    top_ = block + _size;
+    return block;
+  }
+
+  // Old block size isn't known, but copying up to top_ remains in the buffer.
+  const size_t available = static_cast<size_t>(top_ - block);
+  void* new_block = Allocate(_size, _alignment);
+  if (new_block) {
+    std::memcpy(new_block, block, _size < available ? _size : available);
+  }
+  return new_block;
+}
+
+struct ArenaAllocator::Block {
+  // Next block in the arena.
+  Block* next;
+
+  // Size of block memory, that follows this header.
+  size_t size;
+
+  char* begin() {
+    return reinterpret_cast<char*>(this + 1);
+  }
+  char* end() {
+    return begin() + size;
+  }
+};
+
+const size_t ArenaAllocator::kDefaultBlockSize = 64 << 10;
+
+ArenaAllocator::ArenaAllocator(size_t _block_size, Allocator* _backing)
+    : backing_(_backing),
+      block_size_(_block_size),
+      capacity_(0),
+      first_(NULL),
+      current_(NULL),
+      top_(NULL),
+      last_(NULL) {
+}
+
+ArenaAllocator::~ArenaAllocator() {
+  for (Block* block = first_; block;) {
+    Block* next = block->next;
+    backing_->Deallocate(block);
+    block = next;
+  }
+}
+
+void ArenaAllocator::Reset() {
+  current_ = first_;
+  top_ = first_ ? first_->begin() : NULL;
+  last_ = NULL;
+}
+
+size_t ArenaAllocator::used() const {
+  if (!current_) {
+    return 0;
+  }
+  size_t used = static_cast<size_t>(top_ - current_->begin());
+  for (Block* block = first_; block != current_; block = block->next) {
+    used += block->size;
+  }
+  return used;
+}
+
+void* ArenaAllocator::Allocate(size_t _size, size_t _alignment) {
+  // Tries to allocate from current block, then from the following ones,
+  // which are available after a Reset.
+  while (current_) {
+    char* block = ozz::math::Align(top_, _alignment);
+    if (block <= current_->end() &&
+        _size <= static_cast<size_t>(current_->end() - block)) {
+      top_ = block + _size;
+      last_ = block;
+      return block;
+    }
+    if (!current_->next) {
+      break;
+    }
+    current_ = current_->next;
+    top_ = current_->begin();
+  }
+
+  // Allocates a new block, big enough for the requested size.
+  const size_t min_size = _size + _alignment;
+  const size_t size = min_size > block_size_ ? min_size : block_size_;
+  Block* new_block = reinterpret_cast<Block*>(
+    backing_->Allocate(sizeof(Block) + size, kDefaultAlignment));
+  if (!new_block) {
+    return NULL;
+  }
+  new_block->next = NULL;
+  new_block->size = size;
+  capacity_ += size;
+  if (current_) {
+    current_->next = new_block;
+  } else {
+    first_ = new_block;
+  }
+  current_ = new_block;
+
+  char* block = ozz::math::Align(new_block->begin(), _alignment);
+  assert(block + _size <= new_block->end());
+  top_ = block + _size;
+  last_ = block;
+  return block;
+}
+
+void ArenaAllocator::Deallocate(void* _block) {
+  if (_block && _block == last_) {
+    top_ = last_;
+    last_ = NULL;
+  }
+}
+
+void* ArenaAllocator::Reallocate(void* _block,
+                                 size_t _size,
+                                 size_t _alignment) {
+  if (!_block) {
+    return Allocate(_size, _alignment);
+  }
+  char* block = reinterpret_cast<char*>(_block);
+
+  // The latest allocation can be resized in place.
+  if (block == last_ && ozz::math::IsAligned(block, _alignment) &&
+      _size <= static_cast<size_t>(current_->end() - block)) {
+    top_ = block + _size;
+    return block;
+  }
+
+  // Old block size isn't known, but copying up to the end of the used part of
+  // its arena block remains in the arena.
+  size_t available = 0;
+  for (Block* arena_block = first_; arena_block;
+       arena_block = arena_block->next) {
+    if (block >= arena_block->begin() && block <= arena_block->end()) {
+      char* end = arena_block == current_ ? top_ : arena_block->end();
+      available = static_cast<size_t>(end - block);
+      break;
+    }
+  }
+  assert((available || block == top_) && "Block not owned by allocator.");
+
+  void* new_block = Allocate(_size, _alignment);
+  if (new_block) {
+    std::memcpy(new_block, block, _size < available ? _size : available);
+  }
+  return new_block;
+}
+}  // memory
+}  // ozz
@@ -0,0 +1,168 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/numa_allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else  // _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif  // __linux__
+#endif  // _WIN32
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+
+// Header stored in front of every block.
+struct Header {
+  // Address of the mapping.
+  void* base;
+  // Size requested by the user.
+  size_t size;
+  // Size of the mapping.
+  size_t mapped;
+};
+
+Header* GetHeader(void* _block) {
+  return reinterpret_cast<Header*>(
+    reinterpret_cast<char*>(_block) - sizeof(Header));
+}
+
+size_t PageSize() {
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return static_cast<size_t>(info.dwPageSize);
+#else  // _WIN32
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif  // _WIN32
+}
+
+// Maps _size bytes, a multiple of the page size, preferably on NUMA node
+// _node. Returns NULL on failure.
+void* MapPages(size_t _size, int _node) {
+#if defined(_WIN32)
+  void* block = VirtualAllocExNuma(GetCurrentProcess(), NULL, _size,
+                                   MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+                                   static_cast<DWORD>(_node));
+  if (block) {
+    return block;
+  }
+  return VirtualAlloc(NULL, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else  // _WIN32
+  void* block = mmap(NULL, _size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (block == MAP_FAILED) {
+    return NULL;
+  }
+#if defined(__linux__) && defined(SYS_mbind)
+  // Binds pages before they are touched, with the preferred policy
+  // (MPOL_PREFERRED from linux/mempolicy.h). The kernel reads one bit less
+  // than the specified maximum node count. Failing to bind isn't an
+  // allocation failure, pages are then placed by the default policy.
+  const int kPreferredPolicy = 1;
+  const unsigned long kMaxNodes = sizeof(unsigned long) * 8;
+  if (_node >= 0 && static_cast<unsigned long>(_node) < kMaxNodes) {
+    const unsigned long mask = 1ul << _node;
+    syscall(SYS_mbind, block, _size, kPreferredPolicy, &mask, kMaxNodes + 1,
+            0);
+  }
+#else  // __linux__
+  (void)_node;
+#endif  // __linux__
+  return block;
+#endif  // _WIN32
+}
+
+void UnmapPages(void* _block, size_t _size) {
+#if defined(_WIN32)
+  (void)_size;
+  VirtualFree(_block, 0, MEM_RELEASE);
+#else  // _WIN32
+  munmap(_block, _size);
+#endif  // _WIN32
+}
+}  // namespace
+
+NumaAllocator::NumaAllocator(int _node)
+    : node_(_node) {
+}
+
+void* NumaAllocator::Allocate(size_t _size, size_t _alignment) {
+  const size_t page_size = PageSize();
+  assert(math::IsAligned(page_size, _alignment) &&
+         "Alignment must be a power of 2 lower than the page size.");
+  // The header fits in front of the block, without breaking its alignment.
+  const size_t offset = math::Align(sizeof(Header), _alignment);
+  const size_t mapped = math::Align(offset + _size, page_size);
+  char* base = reinterpret_cast<char*>(MapPages(mapped, node_));
+  if (!base) {
+    return NULL;
+  }
+  char* block = base + offset;
+  Header* header = GetHeader(block);
+  header->base = base;
+  header->size = _size;
+  header->mapped = mapped;
+  return block;
+}
+
+void* NumaAllocator::Reallocate(void* _block,
+                                size_t _size,
+                                size_t _alignment) {
+  void* new_block = Allocate(_size, _alignment);
+  // Copies and deallocates the old block, which is kept if allocation failed.
+  if (_block && new_block) {
+    const size_t old_size = GetHeader(_block)->size;
+    memcpy(new_block, _block, old_size < _size ? old_size : _size);
+    Deallocate(_block);
+  }
+  return new_block;
+}
+
+void NumaAllocator::Deallocate(void* _block) {
+  if (_block) {
+    const Header* header = GetHeader(_block);
+    UnmapPages(header->base, header->mapped);
+  }
+}
+}  // memory
+}  // ozz
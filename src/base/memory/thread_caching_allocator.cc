@@ -0,0 +1,348 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/thread_caching_allocator.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedCompareExchange)
+#define OZZ_THREAD_LOCAL __declspec(thread)
+#else  // _MSC_VER
+#define OZZ_THREAD_LOCAL __thread
+#endif  // _MSC_VER
+
+namespace ozz {
+namespace memory {
+
+namespace {
+
+// Atomically compares *_dest with _comparand and sets it to _exchange if they
+// are equal. Returns the initial value of *_dest. Acts as a full barrier.
+void* CompareExchange(void* volatile* _dest,
+                      void* _exchange,
+                      void* _comparand) {
+#if defined(_MSC_VER)
+  return _InterlockedCompareExchangePointer(_dest, _exchange, _comparand);
+#else  // _MSC_VER
+  return __sync_val_compare_and_swap(_dest, _comparand, _exchange);
+#endif  // _MSC_VER
+}
+
+// Atomically loads *_src value. Acts as a full barrier.
+void* Load(void* volatile* _src) {
+  return CompareExchange(_src, NULL, NULL);
+}
+
+// Atomically sets *_dest to _exchange and returns its previous value.
+void* Exchange(void* volatile* _dest, void* _exchange) {
+  void* previous;
+  do {
+    previous = Load(_dest);
+  } while (CompareExchange(_dest, _exchange, previous) != previous);
+  return previous;
+}
+
+// Alignment guaranteed by size classes.
+const size_t kClassAlignment = 16;
+
+// Number of size classes, from 16 to 32KB bytes.
+const int kNumClasses = 12;
+const size_t kMinClassSize = 16;
+const size_t kMaxClassSize = kMinClassSize << (kNumClasses - 1);
+
+// Size of the spans cache memory is allocated by.
+const size_t kSpanSize = 64 << 10;
+
+// Minimum number of blocks per span, for big size classes.
+const size_t kMinSpanBlocks = 4;
+
+// Header stored in front of every block.
+// For small blocks, _link is the owner cache and _info is the size class.
+// For large ones, _link is the address returned by malloc and _info is the
+// requested size, flagged with kLargeFlag.
+struct Header {
+  void* link;
+  size_t info;
+};
+
+// Space reserved for the header, which preserves class alignment.
+const size_t kHeaderSize = 16;
+OZZ_STATIC_ASSERT(sizeof(Header) <= kHeaderSize);
+
+const size_t kLargeFlag = ~(~size_t(0) >> 1);
+
+Header* GetHeader(void* _block) {
+  return reinterpret_cast<Header*>(
+    reinterpret_cast<char*>(_block) - sizeof(Header));
+}
+
+// Free blocks are linked through their first bytes.
+void*& NextFree(void* _block) {
+  return *reinterpret_cast<void**>(_block);
+}
+
+// Finds the size class of _size bytes.
+int SizeClass(size_t _size) {
+  int size_class = 0;
+  for (size_t size = kMinClassSize; size < _size; size <<= 1) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+// Defines a span of memory, carved out in blocks of the same class.
+struct Span {
+  Span* next;
+};
+
+// Defines a thread cache.
+struct ThreadCache {
+  // Free lists per size class, only accessed by the owner thread.
+  void* lists[kNumClasses];
+
+  // Lock-free stack of blocks deallocated by other threads.
+  void* volatile remote;
+
+  // Spans allocated by this cache.
+  Span* spans;
+
+  // Next cache in the global list of caches.
+  ThreadCache* next;
+
+  // Non-NULL while a thread owns this cache.
+  void* volatile owner;
+};
+
+// Global lock-free list of all caches, which are never removed.
+void* volatile g_caches = NULL;
+
+// Cache of the calling thread.
+OZZ_THREAD_LOCAL ThreadCache* t_cache = NULL;
+
+// Gets calling thread cache, adopting a released cache or creating a new one
+// if needed.
+ThreadCache* GetThreadCache() {
+  if (t_cache) {
+    return t_cache;
+  }
+
+  // Any non-NULL value identifies an owner.
+  void* owner = &t_cache;
+
+  // Tries to adopt a released cache.
+  for (ThreadCache* cache = static_cast<ThreadCache*>(Load(&g_caches));
+       cache;
+       cache = cache->next) {
+    if (CompareExchange(&cache->owner, owner, NULL) == NULL) {
+      t_cache = cache;
+      return cache;
+    }
+  }
+
+  // Creates and registers a new cache.
+  ThreadCache* cache = static_cast<ThreadCache*>(malloc(sizeof(ThreadCache)));
+  if (!cache) {
+    return NULL;
+  }
+  std::memset(cache, 0, sizeof(ThreadCache));
+  cache->owner = owner;
+  void* head;
+  do {
+    head = Load(&g_caches);
+    cache->next = static_cast<ThreadCache*>(head);
+  } while (CompareExchange(&g_caches, cache, head) != head);
+
+  t_cache = cache;
+  return cache;
+}
+
+// Moves blocks deallocated by other threads to _cache free lists. Returns
+// false if there was none.
+bool ReclaimRemote(ThreadCache* _cache) {
+  void* block = Exchange(&_cache->remote, NULL);
+  if (!block) {
+    return false;
+  }
+  while (block) {
+    void* next = NextFree(block);
+    void*& list = _cache->lists[GetHeader(block)->info];
+    NextFree(block) = list;
+    list = block;
+    block = next;
+  }
+  return true;
+}
+
+// Allocates a new span for _size_class blocks, and pushes them to _cache free
+// list.
+bool Refill(ThreadCache* _cache, int _size_class) {
+  const size_t stride = kHeaderSize + (kMinClassSize << _size_class);
+  const size_t count = math::Max(kSpanSize / stride, kMinSpanBlocks);
+  const size_t size = sizeof(Span) + kClassAlignment + count * stride;
+  Span* span = static_cast<Span*>(malloc(size));
+  if (!span) {
+    return false;
+  }
+  span->next = _cache->spans;
+  _cache->spans = span;
+
+  char* block = math::Align(reinterpret_cast<char*>(span + 1) + kHeaderSize,
+                            kClassAlignment);
+  void*& list = _cache->lists[_size_class];
+  for (size_t i = 0; i < count; ++i, block += stride) {
+    Header* header = GetHeader(block);
+    header->link = _cache;
+    header->info = _size_class;
+    NextFree(block) = list;
+    list = block;
+  }
+  return true;
+}
+
+// Implements the thread caching allocator.
+class ThreadCachingAllocator : public Allocator {
+ public:
+  virtual ~ThreadCachingAllocator() {
+    // Threads must not use the allocator anymore.
+    for (ThreadCache* cache = static_cast<ThreadCache*>(g_caches); cache;) {
+      for (Span* span = cache->spans; span;) {
+        Span* next = span->next;
+        free(span);
+        span = next;
+      }
+      ThreadCache* next = cache->next;
+      free(cache);
+      cache = next;
+    }
+    g_caches = NULL;
+    t_cache = NULL;
+  }
+
+ protected:
+  virtual void* Allocate(size_t _size, size_t _alignment) {
+    if (_size > kMaxClassSize || _alignment > kClassAlignment) {
+      return AllocateLarge(_size, _alignment);
+    }
+
+    ThreadCache* cache = GetThreadCache();
+    if (!cache) {
+      return NULL;
+    }
+    const int size_class = SizeClass(_size);
+    void*& list = cache->lists[size_class];
+    if (!list && !(ReclaimRemote(cache) && list) &&
+        !Refill(cache, size_class)) {
+      return NULL;
+    }
+    void* block = list;
+    list = NextFree(block);
+    return block;
+  }
+
+  virtual void Deallocate(void* _block) {
+    if (!_block) {
+      return;
+    }
+    Header* header = GetHeader(_block);
+    if (header->info & kLargeFlag) {
+      free(header->link);
+      return;
+    }
+
+    ThreadCache* owner = static_cast<ThreadCache*>(header->link);
+    if (owner == t_cache) {
+      // Pushes back to calling thread own cache.
+      void*& list = owner->lists[header->info];
+      NextFree(_block) = list;
+      list = _block;
+    } else {
+      // Pushes to owner cache remote stack.
+      void* head;
+      do {
+        head = Load(&owner->remote);
+        NextFree(_block) = head;
+      } while (CompareExchange(&owner->remote, _block, head) != head);
+    }
+  }
+
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment) {
+    void* new_block = Allocate(_size, _alignment);
+    if (_block && new_block) {
+      const size_t info = GetHeader(_block)->info;
+      const size_t old_size =
+        info & kLargeFlag ? info & ~kLargeFlag : kMinClassSize << info;
+      std::memcpy(new_block, _block, math::Min(old_size, _size));
+      Deallocate(_block);
+    }
+    return new_block;
+  }
+
+ private:
+  void* AllocateLarge(size_t _size, size_t _alignment) {
+    const size_t alignment = math::Max(_alignment, kClassAlignment);
+    char* unaligned =
+      static_cast<char*>(malloc(_size + kHeaderSize + alignment - 1));
+    if (!unaligned) {
+      return NULL;
+    }
+    char* block = math::Align(unaligned + kHeaderSize, alignment);
+    Header* header = GetHeader(block);
+    header->link = unaligned;
+    header->info = _size | kLargeFlag;
+    return block;
+  }
+};
+
+// Instantiates the thread caching allocator.
+ThreadCachingAllocator g_thread_caching_allocator;
+}  // namespace
+
+Allocator* thread_caching_allocator() {
+  return &g_thread_caching_allocator;
+}
+
+void ReleaseThreadCache() {
+  ThreadCache* cache = t_cache;
+  if (!cache) {
+    return;
+  }
+  t_cache = NULL;
+
+  // Barrier ensures cache updates are visible to the next owner.
+  Exchange(&cache->owner, NULL);
+}
+}  // memory
+}  // ozz
@@ -0,0 +1,133 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+// Header stored in front of every tracked block.
+struct Header {
+  // Size requested by the user.
+  size_t size;
+
+  // Offset of the user block from the backing block.
+  uint32_t offset;
+
+  // Tag the block is attributed to.
+  uint32_t tag;
+};
+
+Header* GetHeader(void* _block) {
+  return reinterpret_cast<Header*>(
+    reinterpret_cast<char*>(_block) - sizeof(Header));
+}
+
+void Track(TrackingAllocator::Stats* _stats, size_t _size) {
+  _stats->live_bytes += _size;
+  _stats->peak_bytes = math::Max(_stats->peak_bytes, _stats->live_bytes);
+  ++_stats->live_count;
+  ++_stats->total_count;
+}
+
+void Untrack(TrackingAllocator::Stats* _stats, size_t _size) {
+  assert(_stats->live_bytes >= _size && _stats->live_count > 0);
+  _stats->live_bytes -= _size;
+  --_stats->live_count;
+}
+}  // namespace
+
+TrackingAllocator::TrackingAllocator(Allocator* _backing)
+    : backing_(_backing) {
+  std::memset(&snapshot_, 0, sizeof(snapshot_));
+}
+
+TrackingAllocator::~TrackingAllocator() {
+  assert(snapshot_.total.live_count == 0 && "Memory leak detected");
+}
+
+void TrackingAllocator::ResetPeaks() {
+  for (int i = 0; i < kTagCount; ++i) {
+    snapshot_.tags[i].peak_bytes = snapshot_.tags[i].live_bytes;
+  }
+  snapshot_.total.peak_bytes = snapshot_.total.live_bytes;
+}
+
+void* TrackingAllocator::Allocate(size_t _size, size_t _alignment) {
+  // Header is stored in front of the user block, which keeps the requested
+  // alignment.
+  const size_t alignment =
+    math::Max(_alignment, static_cast<size_t>(AlignOf<Header>::value));
+  const size_t offset = math::Align(sizeof(Header), alignment);
+  char* backing_block =
+    reinterpret_cast<char*>(backing_->Allocate(offset + _size, alignment));
+  if (!backing_block) {
+    return NULL;
+  }
+  char* block = backing_block + offset;
+  Header* header = GetHeader(block);
+  header->size = _size;
+  header->offset = static_cast<uint32_t>(offset);
+  header->tag = current_tag();
+
+  Track(&snapshot_.tags[header->tag], _size);
+  Track(&snapshot_.total, _size);
+  return block;
+}
+
+void TrackingAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  Header* header = GetHeader(_block);
+  Untrack(&snapshot_.tags[header->tag], header->size);
+  Untrack(&snapshot_.total, header->size);
+  backing_->Deallocate(reinterpret_cast<char*>(_block) - header->offset);
+}
+
+void* TrackingAllocator::Reallocate(void* _block,
+                                    size_t _size,
+                                    size_t _alignment) {
+  void* new_block = Allocate(_size, _alignment);
+  if (_block && new_block) {
+    const size_t old_size = GetHeader(_block)->size;
+    std::memcpy(new_block, _block, math::Min(old_size, _size));
+    Deallocate(_block);
+  }
+  return new_block;
+}
+}  // memory
+}  // ozz
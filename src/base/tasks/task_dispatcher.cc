@@ -0,0 +1,55 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/tasks/task_dispatcher.h"
+
+namespace ozz {
+namespace tasks {
+
+namespace {
+// Implements a dispatcher that runs all work items on the calling thread.
+class SerialDispatcher : public Dispatcher {
+ public:
+  virtual void Dispatch(const Task& _task, int _count) {
+    for (int i = 0; i < _count; ++i) {
+      _task.Run(i);
+    }
+  }
+};
+
+// Instantiates the serial dispatcher.
+SerialDispatcher g_serial_dispatcher;
+}  // namespace
+
+Dispatcher* serial_dispatcher() {
+  return &g_serial_dispatcher;
+}
+}  // tasks
+}  // ozz
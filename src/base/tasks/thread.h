@@ -0,0 +1,147 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_BASE_TASKS_THREAD_H_
+#define OZZ_BASE_TASKS_THREAD_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Implements the minimal set of platform threading primitives used internally
+// by ozz optional threading utilities (thread pool, asynchronous streams).
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else  // _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace tasks {
+namespace internal {
+
+// Declares the function executed by a thread.
+class Runnable {
+ public:
+  virtual ~Runnable() {
+  }
+  virtual void Run() = 0;
+};
+
+#ifdef _WIN32
+typedef HANDLE Thread;
+
+class Mutex {
+ public:
+  Mutex() { InitializeCriticalSection(&section_); }
+  ~Mutex() { DeleteCriticalSection(&section_); }
+  void Lock() { EnterCriticalSection(&section_); }
+  void Unlock() { LeaveCriticalSection(&section_); }
+ private:
+  friend class Condition;
+  CRITICAL_SECTION section_;
+};
+
+class Condition {
+ public:
+  Condition() { InitializeConditionVariable(&condition_); }
+  void Wait(Mutex* _mutex) {
+    SleepConditionVariableCS(&condition_, &_mutex->section_, INFINITE);
+  }
+  void Broadcast() { WakeAllConditionVariable(&condition_); }
+ private:
+  CONDITION_VARIABLE condition_;
+};
+
+inline unsigned __stdcall ThreadMain(void* _runnable) {
+  static_cast<Runnable*>(_runnable)->Run();
+  return 0;
+}
+
+// Starts a thread that executes _runnable->Run(). Returns false on failure.
+inline bool StartThread(Thread* _thread, Runnable* _runnable) {
+  *_thread = reinterpret_cast<HANDLE>(
+    _beginthreadex(NULL, 0, &ThreadMain, _runnable, 0, NULL));
+  return *_thread != NULL;
+}
+
+// Waits for _thread to exit, and releases it.
+inline void JoinThread(Thread _thread) {
+  WaitForSingleObject(_thread, INFINITE);
+  CloseHandle(_thread);
+}
+#else  // _WIN32
+typedef pthread_t Thread;
+
+class Mutex {
+ public:
+  Mutex() { pthread_mutex_init(&mutex_, NULL); }
+  ~Mutex() { pthread_mutex_destroy(&mutex_); }
+  void Lock() { pthread_mutex_lock(&mutex_); }
+  void Unlock() { pthread_mutex_unlock(&mutex_); }
+ private:
+  friend class Condition;
+  pthread_mutex_t mutex_;
+};
+
+class Condition {
+ public:
+  Condition() { pthread_cond_init(&condition_, NULL); }
+  ~Condition() { pthread_cond_destroy(&condition_); }
+  void Wait(Mutex* _mutex) { pthread_cond_wait(&condition_, &_mutex->mutex_); }
+  void Broadcast() { pthread_cond_broadcast(&condition_); }
+ private:
+  pthread_cond_t condition_;
+};
+
+inline void* ThreadMain(void* _runnable) {
+  static_cast<Runnable*>(_runnable)->Run();
+  return NULL;
+}
+
+// Starts a thread that executes _runnable->Run(). Returns false on failure.
+inline bool StartThread(Thread* _thread, Runnable* _runnable) {
+  return pthread_create(_thread, NULL, &ThreadMain, _runnable) == 0;
+}
+
+// Waits for _thread to exit, and releases it.
+inline void JoinThread(Thread _thread) {
+  pthread_join(_thread, NULL);
+}
+#endif  // _WIN32
+}  // internal
+}  // tasks
+}  // ozz
+#endif  // OZZ_BASE_TASKS_THREAD_H_
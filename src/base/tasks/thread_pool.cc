@@ -0,0 +1,472 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/tasks/thread_pool.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <cstdio>
+#include <cstdlib>
+#endif  // __linux__
+
+#include "ozz/base/memory/allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "thread.h"
+
+namespace ozz {
+namespace tasks {
+
+namespace {
+using internal::Thread;
+using internal::Mutex;
+using internal::Condition;
+
+#ifdef _WIN32
+bool CompareAndSwap(volatile int64_t* _value,
+                    int64_t _expected,
+                    int64_t _desired) {
+  return InterlockedCompareExchange64(
+    reinterpret_cast<volatile LONGLONG*>(_value), _desired, _expected) ==
+    _expected;
+}
+
+int64_t Load(volatile int64_t* _value) {
+  return InterlockedCompareExchange64(
+    reinterpret_cast<volatile LONGLONG*>(_value), 0, 0);
+}
+#else  // _WIN32
+bool CompareAndSwap(volatile int64_t* _value,
+                    int64_t _expected,
+                    int64_t _desired) {
+  return __sync_bool_compare_and_swap(_value, _expected, _desired);
+}
+
+int64_t Load(volatile int64_t* _value) {
+  return __sync_fetch_and_add(_value, 0);
+}
+#endif  // _WIN32
+
+// Work items ranges [begin,end[ are packed in a 64 bits integer, so that they
+// can be updated atomically with a single compare and swap.
+int64_t Pack(int _begin, int _end) {
+  return static_cast<int64_t>(
+    (static_cast<uint64_t>(static_cast<uint32_t>(_begin)) << 32) |
+    static_cast<uint32_t>(_end));
+}
+int Begin(int64_t _range) {
+  return static_cast<int>(static_cast<uint64_t>(_range) >> 32);
+}
+int End(int64_t _range) {
+  return static_cast<int>(static_cast<uint32_t>(_range));
+}
+
+// Stores the work items range of a worker. Slots are padded to a cache line
+// to prevent false sharing between workers.
+struct Slot {
+  volatile int64_t range;
+  char padding[64 - sizeof(int64_t)];
+};
+
+// Maximum number of workers that can join a dispatch.
+const int kMaxSlots = 32;
+
+// Atomically sets _slot range.
+void Store(Slot* _slot, int64_t _range) {
+  for (;;) {
+    const int64_t range = Load(&_slot->range);
+    if (CompareAndSwap(&_slot->range, range, _range)) {
+      return;
+    }
+  }
+}
+
+// Defines the work items of a dispatch. Unless specified, members are
+// protected by the pool mutex.
+struct Batch {
+  const Task* task;
+
+  // One slot per worker that can join the batch. Slots are accessed
+  // atomically.
+  Slot* slots;
+  int num_slots;
+
+  // Number of slots attributed to workers, the first one being the dispatch
+  // caller.
+  int num_joined;
+
+  // Number of workers, except the caller, still executing items.
+  int num_running;
+
+  // Set as soon as a worker found no work item to execute, so that no other
+  // worker joins the batch.
+  bool exhausted;
+
+  // Next batch of the pool.
+  Batch* next;
+};
+
+// Gets a work item to execute, from _slot range, or stolen from another slot.
+// Returns -1 if no item remains.
+int Acquire(Batch* _batch, int _slot) {
+  // Pops from the beginning of its own range.
+  Slot* slot = _batch->slots + _slot;
+  for (;;) {
+    const int64_t range = Load(&slot->range);
+    const int begin = Begin(range);
+    const int end = End(range);
+    if (begin >= end) {
+      break;
+    }
+    if (CompareAndSwap(&slot->range, range, Pack(begin + 1, end))) {
+      return begin;
+    }
+  }
+
+  // Steals the second half of another range, executes the first stolen item
+  // and keeps the others.
+  for (int i = 1; i < _batch->num_slots; ++i) {
+    Slot* victim = _batch->slots + (_slot + i) % _batch->num_slots;
+    for (;;) {
+      const int64_t range = Load(&victim->range);
+      const int begin = Begin(range);
+      const int end = End(range);
+      if (begin >= end) {
+        break;
+      }
+      const int middle = begin + (end - begin) / 2;
+      if (CompareAndSwap(&victim->range, range, Pack(begin, middle))) {
+        Store(slot, Pack(middle + 1, end));
+        return middle;
+      }
+    }
+  }
+  return -1;
+}
+
+// Executes work items until none remains.
+void Execute(Batch* _batch, int _slot) {
+  for (int index; (index = Acquire(_batch, _slot)) >= 0;) {
+    _batch->task->Run(index);
+  }
+}
+
+#if defined(__linux__)
+// Reads the processors of NUMA node _node from sysfs. Returns false if the
+// node doesn't exist or has no processor.
+bool ReadNodeCpus(int _node, cpu_set_t* _cpus) {
+  char path[64];
+  std::sprintf(path, "/sys/devices/system/node/node%d/cpulist", _node);
+  std::FILE* file = std::fopen(path, "r");
+  if (!file) {
+    return false;
+  }
+  char list[4096];
+  const bool read = std::fgets(list, sizeof(list), file) != NULL;
+  std::fclose(file);
+  if (!read) {
+    return false;
+  }
+
+  // Parses comma separated ranges of processors, like "0-7,16-23".
+  CPU_ZERO(_cpus);
+  for (const char* c = list; *c >= '0' && *c <= '9';) {
+    char* end;
+    const long first = std::strtol(c, &end, 10);
+    long last = first;
+    if (*end == '-') {
+      last = std::strtol(end + 1, &end, 10);
+    }
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+      CPU_SET(cpu, _cpus);
+    }
+    c = *end == ',' ? end + 1 : end;
+  }
+  return CPU_COUNT(_cpus) != 0;
+}
+#endif  // __linux__
+}  // namespace
+
+struct ThreadPool::Impl : public internal::Runnable {
+  Impl()
+      : batches(NULL),
+        quit(false),
+        threads(NULL),
+        num_threads(0),
+        numa_node(-1) {
+  }
+
+  // Protects everything below, and batches members.
+  Mutex mutex;
+
+  // Signaled when a batch is added, or when the pool is stopped.
+  Condition wake;
+
+  // Signaled when a worker leaves a batch.
+  Condition done;
+
+  // Running dispatches, the most recent first.
+  Batch* batches;
+
+  // Requests workers to quit.
+  bool quit;
+
+  // Worker threads, not including the thread calling Dispatch.
+  Thread* threads;
+  int num_threads;
+
+  // NUMA node workers pin themselves to, -1 if they aren't pinned. It's
+  // constant once threads are started.
+  int numa_node;
+
+  // Executes work items of dispatches until the pool is stopped.
+  virtual void Run() {
+    if (numa_node >= 0) {
+      ThreadPool::PinCurrentThread(numa_node);
+    }
+
+    mutex.Lock();
+    for (;;) {
+      if (quit) {
+        break;
+      }
+      Batch* batch = batches;
+      while (batch && (batch->exhausted ||
+                       batch->num_joined == batch->num_slots)) {
+        batch = batch->next;
+      }
+      if (!batch) {
+        wake.Wait(&mutex);
+        continue;
+      }
+      const int slot = batch->num_joined++;
+      ++batch->num_running;
+      mutex.Unlock();
+
+      Execute(batch, slot);
+
+      mutex.Lock();
+      batch->exhausted = true;
+      if (--batch->num_running == 0) {
+        done.Broadcast();
+      }
+    }
+    mutex.Unlock();
+  }
+};
+
+ThreadPool::ThreadPool(int _num_threads)
+    : num_threads_(1),
+      numa_node_(-1),
+      impl_(NULL) {
+  Start(_num_threads);
+}
+
+ThreadPool::ThreadPool(int _num_threads, int _numa_node)
+    : num_threads_(1),
+      numa_node_(-1),
+      impl_(NULL) {
+  if (_numa_node >= 0 && _numa_node < num_numa_nodes()) {
+    numa_node_ = _numa_node;
+  }
+  Start(_num_threads);
+}
+
+void ThreadPool::Start(int _num_threads) {
+  assert(_num_threads >= 1);
+  if (_num_threads <= 1) {
+    return;
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  impl_ = allocator->New<Impl>();
+  impl_->numa_node = numa_node_;
+  impl_->threads = allocator->Allocate<Thread>(_num_threads - 1);
+  for (int i = 1; i < _num_threads; ++i) {
+    Thread* thread = impl_->threads + impl_->num_threads;
+    if (!internal::StartThread(thread, impl_)) {
+      break;
+    }
+    ++impl_->num_threads;
+  }
+  num_threads_ = impl_->num_threads + 1;
+}
+
+ThreadPool::~ThreadPool() {
+  if (!impl_) {
+    return;
+  }
+  assert(!impl_->batches && "No dispatch must be running.");
+
+  impl_->mutex.Lock();
+  impl_->quit = true;
+  impl_->mutex.Unlock();
+  impl_->wake.Broadcast();
+
+  for (int i = 0; i < impl_->num_threads; ++i) {
+    internal::JoinThread(impl_->threads[i]);
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(impl_->threads);
+  allocator->Delete(impl_);
+}
+
+void ThreadPool::Dispatch(const Task& _task, int _count) {
+  if (_count <= 0) {
+    return;
+  }
+  if (num_threads_ == 1 || _count == 1) {
+    serial_dispatcher()->Dispatch(_task, _count);
+    return;
+  }
+
+  // Splits work items in contiguous ranges, one per slot. Slots are stored on
+  // the stack, so that dispatching doesn't allocate.
+  Slot slots[kMaxSlots];
+  int num_slots = _count < num_threads_ ? _count : num_threads_;
+  num_slots = num_slots < kMaxSlots ? num_slots : kMaxSlots;
+  for (int i = 0; i < num_slots; ++i) {
+    slots[i].range = Pack(static_cast<int>(
+                            static_cast<int64_t>(_count) * i / num_slots),
+                          static_cast<int>(
+                            static_cast<int64_t>(_count) * (i + 1) /
+                            num_slots));
+  }
+
+  Batch batch;
+  batch.task = &_task;
+  batch.slots = slots;
+  batch.num_slots = num_slots;
+  batch.num_joined = 1;  // The first slot is the caller's one.
+  batch.num_running = 0;
+  batch.exhausted = false;
+
+  // Publishes the batch to idle workers.
+  impl_->mutex.Lock();
+  batch.next = impl_->batches;
+  impl_->batches = &batch;
+  impl_->mutex.Unlock();
+  impl_->wake.Broadcast();
+
+  Execute(&batch, 0);
+
+  // Waits for workers that are still executing work items, then unlinks the
+  // batch.
+  impl_->mutex.Lock();
+  batch.exhausted = true;
+  while (batch.num_running) {
+    impl_->done.Wait(&impl_->mutex);
+  }
+  Batch** link = &impl_->batches;
+  while (*link != &batch) {
+    link = &(*link)->next;
+  }
+  *link = batch.next;
+  impl_->mutex.Unlock();
+}
+
+int ThreadPool::hardware_concurrency() {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  const int count = static_cast<int>(info.dwNumberOfProcessors);
+#else  // _WIN32
+  const int count = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+#endif  // _WIN32
+  return count > 1 ? count : 1;
+}
+
+int ThreadPool::num_numa_nodes() {
+#if defined(_WIN32)
+  ULONG highest;
+  if (GetNumaHighestNodeNumber(&highest)) {
+    return static_cast<int>(highest) + 1;
+  }
+#elif defined(__linux__)
+  int count = 0;
+  for (;; ++count) {
+    char path[64];
+    std::sprintf(path, "/sys/devices/system/node/node%d", count);
+    if (access(path, F_OK) != 0) {
+      break;
+    }
+  }
+  if (count > 1) {
+    return count;
+  }
+#endif  // _WIN32
+  return 1;
+}
+
+int ThreadPool::current_numa_node() {
+#if defined(_WIN32)
+  PROCESSOR_NUMBER number;
+  GetCurrentProcessorNumberEx(&number);
+  USHORT node;
+  if (GetNumaProcessorNodeEx(&number, &node)) {
+    return static_cast<int>(node);
+  }
+#elif defined(__linux__) && defined(SYS_getcpu)
+  unsigned int cpu;
+  unsigned int node;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+    return static_cast<int>(node);
+  }
+#endif  // _WIN32
+  return 0;
+}
+
+bool ThreadPool::PinCurrentThread(int _numa_node) {
+  if (_numa_node < 0 || _numa_node >= num_numa_nodes()) {
+    return false;
+  }
+#if defined(_WIN32)
+  GROUP_AFFINITY affinity;
+  if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(_numa_node),
+                                  &affinity) ||
+      affinity.Mask == 0) {
+    return false;
+  }
+  return SetThreadGroupAffinity(GetCurrentThread(), &affinity, NULL) != 0;
+#elif defined(__linux__)
+  cpu_set_t cpus;
+  if (!ReadNodeCpus(_numa_node, &cpus)) {
+    return false;
+  }
+  return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else  // _WIN32
+  return false;
+#endif  // _WIN32
+}
+}  // tasks
+}  // ozz
@@ -0,0 +1,183 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/offline/influence_partition_builder.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+namespace {
+
+// Defines a joint influence, used to sort vertex influences by weight.
+struct Influence {
+  uint16_t joint;
+  float weight;
+};
+
+bool CompareWeight(const Influence& _a, const Influence& _b) {
+  return _a.weight > _b.weight;
+}
+}  // namespace
+
+InfluencePartitionBuilder::InfluencePartitionBuilder()
+    : weight_epsilon(0.f),
+      min_partition_vertices(16) {
+}
+
+bool InfluencePartitionBuilder::operator()(
+    int _vertex_count,
+    int _influences_count,
+    Range<const uint16_t> _joint_indices,
+    Range<const float> _joint_weights,
+    InfluencePartitions* _partitions) const {
+  // Validates inputs.
+  if (!_partitions || _influences_count < 1 || _vertex_count < 0) {
+    return false;
+  }
+  const size_t num_influences =
+    static_cast<size_t>(_vertex_count) * _influences_count;
+  const size_t num_weights =
+    static_cast<size_t>(_vertex_count) * (_influences_count - 1);
+  if (_joint_indices.Count() < num_influences ||
+      (num_weights != 0 && _joint_weights.Count() < num_weights)) {
+    return false;
+  }
+
+  // Builds per vertex influences, with weights restored, sorted by weight and
+  // pruned. Also deduces vertices influences count.
+  ozz::Vector<Influence>::Std influences(num_influences);
+  ozz::Vector<int>::Std counts(_vertex_count);
+  for (int v = 0; v < _vertex_count; ++v) {
+    Influence* vertex = &influences[v * _influences_count];
+    const uint16_t* indices = _joint_indices.begin + v * _influences_count;
+    const float* weights = _joint_weights.begin + v * (_influences_count - 1);
+    float sum = 0.f;
+    for (int i = 0; i < _influences_count - 1; ++i) {
+      vertex[i].joint = indices[i];
+      vertex[i].weight = weights[i];
+      sum += weights[i];
+    }
+    vertex[_influences_count - 1].joint = indices[_influences_count - 1];
+    vertex[_influences_count - 1].weight = 1.f - sum;
+    std::stable_sort(vertex, vertex + _influences_count, &CompareWeight);
+
+    int count = 1;
+    while (count < _influences_count &&
+           vertex[count].weight > weight_epsilon) {
+      ++count;
+    }
+    counts[v] = count;
+  }
+
+  // Counts vertices per influences count, then merges small partitions into
+  // the next one, which can then become big enough. The last partition can't
+  // be merged.
+  ozz::Vector<int>::Std sizes(_influences_count, 0);
+  for (int v = 0; v < _vertex_count; ++v) {
+    ++sizes[counts[v] - 1];
+  }
+  for (int i = 0; i < _influences_count - 1; ++i) {
+    if (sizes[i] < min_partition_vertices) {
+      sizes[i + 1] += sizes[i];
+      sizes[i] = 0;
+    }
+  }
+
+  // Finds the partition of each influences count, which is the first non
+  // empty one from there.
+  ozz::Vector<int>::Std partition_of(_influences_count);
+  for (int i = _influences_count - 1; i >= 0; --i) {
+    const bool last = i == _influences_count - 1;
+    partition_of[i] = (sizes[i] != 0 || last) ? i : partition_of[i + 1];
+  }
+
+  // Allocates partitions, and their first vertex index in vertex_remap.
+  _partitions->partitions.clear();
+  ozz::Vector<int>::Std first(_influences_count, 0);
+  ozz::Vector<int>::Std index(_influences_count, -1);
+  int offset = 0;
+  for (int i = 0; i < _influences_count; ++i) {
+    if (sizes[i] == 0) {
+      continue;
+    }
+    first[i] = offset;
+    offset += sizes[i];
+    index[i] = static_cast<int>(_partitions->partitions.size());
+    _partitions->partitions.resize(_partitions->partitions.size() + 1);
+    InfluencePartitions::Partition& partition =
+      _partitions->partitions.back();
+    partition.influences_count = i + 1;
+    partition.vertex_count = 0;
+    partition.joint_indices.clear();
+    partition.joint_indices.reserve(sizes[i] * (i + 1));
+    partition.joint_weights.clear();
+    partition.joint_weights.reserve(sizes[i] * i);
+  }
+  assert(offset == _vertex_count);
+
+  // Fills partitions, preserving source vertices order.
+  _partitions->vertex_remap.resize(_vertex_count);
+  for (int v = 0; v < _vertex_count; ++v) {
+    const int p = partition_of[counts[v] - 1];
+    InfluencePartitions::Partition& partition =
+      _partitions->partitions[index[p]];
+    _partitions->vertex_remap[first[p] + partition.vertex_count] = v;
+    ++partition.vertex_count;
+
+    // Renormalizes remaining weights.
+    const Influence* vertex = &influences[v * _influences_count];
+    const int count = counts[v];
+    float sum = 0.f;
+    for (int i = 0; i < count; ++i) {
+      sum += vertex[i].weight;
+    }
+    const float inv_sum = 1.f / (sum > 0.f ? sum : 1.f);
+
+    // Merged vertices are padded with null weight influences, using their
+    // biggest weight joint.
+    for (int i = 0; i < partition.influences_count; ++i) {
+      const Influence& influence = vertex[i < count ? i : 0];
+      partition.joint_indices.push_back(influence.joint);
+      if (i != partition.influences_count - 1) {
+        partition.joint_weights.push_back(
+          i < count ? influence.weight * inv_sum : 0.f);
+      }
+    }
+  }
+
+  return true;
+}
+}  // offline
+}  // geometry
+}  // ozz
@@ -0,0 +1,199 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/offline/packed_influences_builder.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+namespace {
+
+// Defines a joint influence, used to sort vertex influences by joint index.
+struct Influence {
+  uint16_t joint;
+  float weight;
+};
+
+bool CompareJoint(const Influence& _a, const Influence& _b) {
+  return _a.joint < _b.joint;
+}
+
+// Compares vertices influence sets, which are stored contiguously with
+// influences_count sorted influences per vertex.
+class CompareInfluenceSets {
+ public:
+  CompareInfluenceSets(const Influence* _influences, int _influences_count)
+    : influences_(_influences),
+      influences_count_(_influences_count) {
+  }
+  bool operator()(int _a, int _b) const {
+    const Influence* a = influences_ + _a * influences_count_;
+    const Influence* b = influences_ + _b * influences_count_;
+    for (int i = 0; i < influences_count_; ++i) {
+      if (a[i].joint != b[i].joint) {
+        return a[i].joint < b[i].joint;
+      }
+    }
+    return false;
+  }
+ private:
+  const Influence* influences_;
+  int influences_count_;
+};
+
+// Tests if vertices _a and _b have the same influence set.
+bool SameSet(const Influence* _a, const Influence* _b, int _influences_count) {
+  for (int i = 0; i < _influences_count; ++i) {
+    if (_a[i].joint != _b[i].joint) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Quantizes weight _weight to a normalized integer of _max value.
+int Quantize(float _weight, int _max) {
+  const float clamped = _weight < 0.f ? 0.f : (_weight > 1.f ? 1.f : _weight);
+  return static_cast<int>(clamped * _max + .5f);
+}
+}  // namespace
+
+PackedInfluencesBuilder::PackedInfluencesBuilder()
+    : weight_bits(16) {
+}
+
+bool PackedInfluencesBuilder::operator()(int _vertex_count,
+                                         int _influences_count,
+                                         Range<const uint16_t> _joint_indices,
+                                         Range<const float> _joint_weights,
+                                         PackedInfluences* _packed) const {
+  // Validates inputs.
+  if (!_packed ||
+      _influences_count < 1 ||
+      _vertex_count < 0 ||
+      (weight_bits != 8 && weight_bits != 16)) {
+    return false;
+  }
+  const size_t num_influences =
+    static_cast<size_t>(_vertex_count) * _influences_count;
+  const size_t num_weights =
+    static_cast<size_t>(_vertex_count) * (_influences_count - 1);
+  if (_joint_indices.Count() < num_influences ||
+      (num_weights != 0 && _joint_weights.Count() < num_weights)) {
+    return false;
+  }
+
+  // Builds per vertex influences, with weights restored and sorted by joint.
+  ozz::Vector<Influence>::Std influences(num_influences);
+  for (int v = 0; v < _vertex_count; ++v) {
+    Influence* vertex = &influences[v * _influences_count];
+    const uint16_t* indices = _joint_indices.begin + v * _influences_count;
+    const float* weights = _joint_weights.begin + v * (_influences_count - 1);
+    float sum = 0.f;
+    for (int i = 0; i < _influences_count - 1; ++i) {
+      vertex[i].joint = indices[i];
+      vertex[i].weight = weights[i];
+      sum += weights[i];
+    }
+    vertex[_influences_count - 1].joint = indices[_influences_count - 1];
+    vertex[_influences_count - 1].weight = 1.f - sum;
+    std::stable_sort(vertex, vertex + _influences_count, &CompareJoint);
+  }
+
+  // Sorts vertices by influence set, preserving source order inside a set.
+  _packed->vertex_remap.resize(_vertex_count);
+  for (int v = 0; v < _vertex_count; ++v) {
+    _packed->vertex_remap[v] = v;
+  }
+  if (_vertex_count != 0) {
+    std::stable_sort(_packed->vertex_remap.begin(),
+                     _packed->vertex_remap.end(),
+                     CompareInfluenceSets(&influences[0], _influences_count));
+  }
+
+  // Builds palette, indexed by joint index.
+  ozz::Vector<int>::Std local_indices;
+  _packed->palette.clear();
+  for (size_t i = 0; i < num_influences; ++i) {
+    const uint16_t joint = influences[i].joint;
+    if (joint >= local_indices.size()) {
+      local_indices.resize(joint + 1, -1);
+    }
+    if (local_indices[joint] == -1) {
+      local_indices[joint] = static_cast<int>(_packed->palette.size());
+      _packed->palette.push_back(joint);
+    }
+  }
+  if (_packed->palette.size() > 256) {
+    return false;
+  }
+
+  // Builds sets and quantized weights.
+  _packed->influences_count = _influences_count;
+  _packed->set_vertex_counts.clear();
+  _packed->set_joint_indices.clear();
+  _packed->joint_weights_8.clear();
+  _packed->joint_weights_16.clear();
+  const int max_weight = (1 << weight_bits) - 1;
+  const Influence* previous = NULL;
+  for (int v = 0; v < _vertex_count; ++v) {
+    const Influence* vertex =
+      &influences[_packed->vertex_remap[v] * _influences_count];
+    if (!previous ||
+        !SameSet(previous, vertex, _influences_count) ||
+        _packed->set_vertex_counts.back() == 0xffff) {
+      _packed->set_vertex_counts.push_back(0);
+      for (int i = 0; i < _influences_count; ++i) {
+        _packed->set_joint_indices.push_back(
+          static_cast<uint8_t>(local_indices[vertex[i].joint]));
+      }
+    }
+    ++_packed->set_vertex_counts.back();
+    previous = vertex;
+
+    for (int i = 0; i < _influences_count - 1; ++i) {
+      const int quantized = Quantize(vertex[i].weight, max_weight);
+      if (weight_bits == 8) {
+        _packed->joint_weights_8.push_back(static_cast<uint8_t>(quantized));
+      } else {
+        _packed->joint_weights_16.push_back(static_cast<uint16_t>(quantized));
+      }
+    }
+  }
+
+  return true;
+}
+}  // offline
+}  // geometry
+}  // ozz
@@ -0,0 +1,79 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/offline/skinning_lod_builder.h"
+
+#include <cassert>
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+bool SkinningLodBuilder::operator()(int _vertex_count,
+                                    Range<const int> _vertex_levels,
+                                    SkinningLods* _lods) const {
+  // Validates inputs.
+  if (!_lods || _vertex_count < 0 ||
+      _vertex_levels.Count() < static_cast<size_t>(_vertex_count)) {
+    return false;
+  }
+  int max_level = 0;
+  for (int i = 0; i < _vertex_count; ++i) {
+    const int level = _vertex_levels[i];
+    if (level < 0) {
+      return false;
+    }
+    max_level = level > max_level ? level : max_level;
+  }
+
+  // Counts vertices per level, then accumulates counts such that they are the
+  // first index of each level.
+  const int levels = _vertex_count > 0 ? max_level + 1 : 0;
+  ozz::Vector<int>::Std first(levels + 1, 0);
+  for (int i = 0; i < _vertex_count; ++i) {
+    ++first[_vertex_levels[i] + 1];
+  }
+  for (int l = 0; l < levels; ++l) {
+    first[l + 1] += first[l];
+  }
+  _lods->level_vertex_counts.assign(first.begin() + 1, first.end());
+
+  // Stable counting sort of vertices by level.
+  _lods->vertex_remap.resize(_vertex_count);
+  for (int i = 0; i < _vertex_count; ++i) {
+    _lods->vertex_remap[first[_vertex_levels[i]]++] = i;
+  }
+  assert(levels == 0 || first[levels - 1] == _vertex_count);
+
+  return true;
+}
+}  // offline
+}  // geometry
+}  // ozz
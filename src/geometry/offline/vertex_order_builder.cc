@@ -0,0 +1,279 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/offline/vertex_order_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+namespace {
+
+// Vertex cache optimization scoring constants, as proposed by Tom Forsyth.
+const float kCacheDecayPower = 1.5f;
+const float kLastTriangleScore = .75f;
+const float kValenceBoostScale = 2.f;
+const float kValenceBoostPower = .5f;
+
+// Computes the score of a vertex at position _cache_position in a cache of
+// _cache_size entries (-1 if not cached), still used by _remaining triangles.
+// High scores are given to recently used vertices, and to vertices with few
+// remaining triangles, so that they're completed and leave the cache.
+float VertexScore(int _cache_position, int _remaining, int _cache_size) {
+  if (_remaining == 0) {
+    return -1.f;  // No triangle needs this vertex anymore.
+  }
+  float score = 0.f;
+  if (_cache_position >= 0) {
+    if (_cache_position < 3) {
+      // Vertices of the last triangle get a fixed score, so that the next
+      // triangle doesn't necessarily share an edge with it, which is bad for
+      // strip like orders.
+      score = kLastTriangleScore;
+    } else {
+      const float scaler = 1.f / (_cache_size - 3);
+      score = std::pow(1.f - (_cache_position - 3) * scaler, kCacheDecayPower);
+    }
+  }
+  score += kValenceBoostScale *
+    std::pow(static_cast<float>(_remaining), -kValenceBoostPower);
+  return score;
+}
+
+// Sorts vertices that are used by triangles first, then by dominant joint if
+// any, and finally by the order they are first used by triangles.
+struct CompareVertices {
+  bool operator()(int _a, int _b) const {
+    const bool used_a = rank[_a] < used;
+    const bool used_b = rank[_b] < used;
+    if (used_a != used_b) {
+      return used_a;
+    }
+    if (joints && joints[_a] != joints[_b]) {
+      return joints[_a] < joints[_b];
+    }
+    return rank[_a] < rank[_b];
+  }
+  const uint16_t* joints;
+  const int* rank;
+  int used;
+};
+}  // namespace
+
+VertexOrderBuilder::VertexOrderBuilder()
+    : cache_size(32) {
+}
+
+bool VertexOrderBuilder::operator()(int _vertex_count,
+                                    Range<const uint16_t> _triangle_indices,
+                                    Range<const uint16_t> _dominant_joints,
+                                    VertexOrder* _order) const {
+  // Validates inputs.
+  if (!_order || _vertex_count < 0 || cache_size < 4) {
+    return false;
+  }
+  const size_t index_count = _triangle_indices.Count();
+  if (index_count % 3 != 0) {
+    return false;
+  }
+  const uint16_t* indices = _triangle_indices.begin;
+  for (size_t i = 0; i < index_count; ++i) {
+    if (indices[i] >= _vertex_count) {
+      return false;
+    }
+  }
+  if (_dominant_joints.begin &&
+      _dominant_joints.Count() < static_cast<size_t>(_vertex_count)) {
+    return false;
+  }
+  const int triangle_count = static_cast<int>(index_count / 3);
+
+  // Builds vertex to triangles adjacency. Triangles of vertex v are stored in
+  // range [offsets[v], offsets[v] + remaining[v][ of the adjacency buffer.
+  ozz::Vector<int>::Std offsets(_vertex_count + 1, 0);
+  for (size_t i = 0; i < index_count; ++i) {
+    ++offsets[indices[i] + 1];
+  }
+  for (int v = 0; v < _vertex_count; ++v) {
+    offsets[v + 1] += offsets[v];
+  }
+  ozz::Vector<int>::Std adjacency(index_count);
+  ozz::Vector<int>::Std remaining(_vertex_count, 0);
+  for (size_t i = 0; i < index_count; ++i) {
+    const int v = indices[i];
+    adjacency[offsets[v] + remaining[v]++] = static_cast<int>(i / 3);
+  }
+
+  // Initializes scores.
+  ozz::Vector<int>::Std cache_positions(_vertex_count, -1);
+  ozz::Vector<float>::Std vertex_scores(_vertex_count);
+  for (int v = 0; v < _vertex_count; ++v) {
+    vertex_scores[v] = VertexScore(-1, remaining[v], cache_size);
+  }
+  ozz::Vector<float>::Std triangle_scores(triangle_count);
+  ozz::Vector<bool>::Std added(triangle_count, false);
+  for (int t = 0; t < triangle_count; ++t) {
+    triangle_scores[t] = vertex_scores[indices[t * 3 + 0]] +
+                         vertex_scores[indices[t * 3 + 1]] +
+                         vertex_scores[indices[t * 3 + 2]];
+  }
+
+  // Greedily emits the best scored triangle, simulating the cache.
+  ozz::Vector<int>::Std triangles;
+  triangles.reserve(triangle_count);
+  ozz::Vector<int>::Std cache;
+  ozz::Vector<int>::Std next_cache;
+  int best = -1;
+  for (int n = 0; n < triangle_count; ++n) {
+    if (best < 0) {
+      // No cached vertex has a remaining triangle, searches all of them.
+      float best_score = -1.f;
+      for (int t = 0; t < triangle_count; ++t) {
+        if (!added[t] && triangle_scores[t] > best_score) {
+          best_score = triangle_scores[t];
+          best = t;
+        }
+      }
+    }
+    assert(best >= 0 && !added[best]);
+    triangles.push_back(best);
+    added[best] = true;
+
+    // Removes the triangle from its vertices adjacency, and pushes them to
+    // the front of the cache.
+    const uint16_t* triangle = indices + best * 3;
+    next_cache.clear();
+    for (int k = 0; k < 3; ++k) {
+      const int v = triangle[k];
+      int* begin = &adjacency[offsets[v]];
+      int* end = begin + remaining[v];
+      int* it = std::find(begin, end, best);
+      if (it != end) {  // Might have already be removed if degenerated.
+        *it = *(end - 1);
+        --remaining[v];
+      }
+      if (std::find(next_cache.begin(), next_cache.end(), v) ==
+          next_cache.end()) {
+        next_cache.push_back(v);
+      }
+    }
+    for (size_t i = 0; i < cache.size(); ++i) {
+      if (std::find(next_cache.begin(), next_cache.end(), cache[i]) ==
+          next_cache.end()) {
+        next_cache.push_back(cache[i]);
+      }
+    }
+
+    // Updates vertices scores, including the ones pushed out of the cache.
+    for (size_t i = 0; i < next_cache.size(); ++i) {
+      const int v = next_cache[i];
+      const int position = i < static_cast<size_t>(cache_size) ?
+        static_cast<int>(i) : -1;
+      cache_positions[v] = position;
+      vertex_scores[v] = VertexScore(position, remaining[v], cache_size);
+    }
+
+    // Updates scores of the triangles of these vertices, and selects the best
+    // one from the cached vertices.
+    best = -1;
+    float best_score = -1.f;
+    for (size_t i = 0; i < next_cache.size(); ++i) {
+      const int v = next_cache[i];
+      for (int j = 0; j < remaining[v]; ++j) {
+        const int t = adjacency[offsets[v] + j];
+        const float score = vertex_scores[indices[t * 3 + 0]] +
+                            vertex_scores[indices[t * 3 + 1]] +
+                            vertex_scores[indices[t * 3 + 2]];
+        triangle_scores[t] = score;
+        if (cache_positions[v] >= 0 && score > best_score) {
+          best_score = score;
+          best = t;
+        }
+      }
+    }
+
+    if (next_cache.size() > static_cast<size_t>(cache_size)) {
+      next_cache.resize(cache_size);
+    }
+    cache.swap(next_cache);
+  }
+
+  // Ranks vertices in the order triangles first use them. Unused vertices
+  // are ranked last.
+  ozz::Vector<int>::Std ranks(_vertex_count, -1);
+  int used = 0;
+  for (int n = 0; n < triangle_count; ++n) {
+    for (int k = 0; k < 3; ++k) {
+      const int v = indices[triangles[n] * 3 + k];
+      if (ranks[v] < 0) {
+        ranks[v] = used++;
+      }
+    }
+  }
+  int rank = used;
+  for (int v = 0; v < _vertex_count; ++v) {
+    if (ranks[v] < 0) {
+      ranks[v] = rank++;
+    }
+  }
+
+  // Sorts vertices.
+  _order->vertex_remap.resize(_vertex_count);
+  for (int v = 0; v < _vertex_count; ++v) {
+    _order->vertex_remap[v] = v;
+  }
+  const CompareVertices compare = {_dominant_joints.begin,
+                                   _vertex_count ? &ranks[0] : NULL,
+                                   used};
+  std::sort(_order->vertex_remap.begin(), _order->vertex_remap.end(),
+            compare);
+
+  // Remaps reordered triangles indices.
+  ozz::Vector<int>::Std new_indices(_vertex_count);
+  for (int v = 0; v < _vertex_count; ++v) {
+    new_indices[_order->vertex_remap[v]] = v;
+  }
+  _order->triangle_indices.resize(index_count);
+  for (int n = 0; n < triangle_count; ++n) {
+    for (int k = 0; k < 3; ++k) {
+      _order->triangle_indices[n * 3 + k] = static_cast<uint16_t>(
+        new_indices[indices[triangles[n] * 3 + k]]);
+    }
+  }
+
+  return true;
+}
+}  // offline
+}  // geometry
+}  // ozz
@@ -0,0 +1,246 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/dual_quaternion_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/dual_quaternion.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+DualQuaternionSkinningJob::DualQuaternionSkinningJob()
+ : vertex_count(0),
+   influences_count(0),
+   joint_indices_stride(0),
+   joint_weights_stride(0),
+   in_positions_stride(0),
+   in_normals_stride(0),
+   in_tangents_stride(0),
+   out_positions_stride(0),
+   out_normals_stride(0),
+   out_tangents_stride(0) {
+}
+
+bool DualQuaternionSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks influences bounds.
+  valid &= influences_count > 0;
+
+  // Checks joints dual quaternions, required.
+  valid &= joint_dual_quaternions.begin != NULL;
+  valid &= joint_dual_quaternions.end >= joint_dual_quaternions.begin;
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks indices, required.
+  valid &= joint_indices.begin != NULL;
+  valid &= joint_indices.Size() >=
+    joint_indices_stride * vertex_count_minus_1 +
+    sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count != 1) {
+    valid &= joint_weights.begin != NULL;
+    valid &= joint_weights.Size() >=
+      joint_weights_stride * vertex_count_minus_1 +
+      sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.begin != NULL;
+  valid &= in_positions.Size() >=
+      in_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.Size() >=
+      out_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks normals, optional.
+  if (in_normals.begin) {
+    valid &= in_normals.Size() >=
+      in_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= out_normals.begin != NULL;
+    valid &= out_normals.Size() >=
+      out_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+    // Checks tangents, optional but requires normals.
+    if (in_tangents.begin) {
+      valid &= in_tangents.Size() >=
+        in_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+      valid &= out_tangents.begin != NULL;
+      valid &= out_tangents.Size() >=
+        out_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= in_tangents.begin == NULL;
+    valid &= in_tangents.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Implements pointer striding.
+template <typename _Ty>
+_Ty* Next(_Ty* _current, size_t _stride) {
+  return reinterpret_cast<_Ty*>(
+    reinterpret_cast<uintptr_t>(_current) + _stride);
+}
+
+// Blends the dual quaternions influencing a vertex, and normalizes the result.
+// Dual quaternions whose real part isn't in the same hemisphere as the first
+// one are negated, so that the shortest rotation path is blended.
+OZZ_INLINE math::DualQuaternion BlendDualQuaternions(
+    const DualQuaternionSkinningJob& _job,
+    const uint16_t* _indices,
+    const float* _weights) {
+  const math::DualQuaternion& dq0 = _job.joint_dual_quaternions[_indices[0]];
+  const int last = _job.influences_count - 1;
+  if (last == 0) {
+    return dq0;
+  }
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(_weights);
+  math::DualQuaternion blend = {dq0.real * wsum, dq0.dual * wsum};
+  for (int j = 1; j <= last; ++j) {
+    const math::DualQuaternion& dq = _job.joint_dual_quaternions[_indices[j]];
+    math::SimdFloat4 w;
+    if (j < last) {
+      w = math::simd_float4::Load1PtrU(_weights + j);
+      wsum = wsum + w;
+    } else {
+      w = math::simd_float4::one() - wsum;
+    }
+    const math::SimdInt4 antipodal =
+      math::CmpLt(math::SplatX(math::Dot4(dq0.real, dq.real)), zero);
+    const math::SimdFloat4 sw = math::Select(antipodal, -w, w);
+    blend.real = math::MAdd(dq.real, sw, blend.real);
+    blend.dual = math::MAdd(dq.dual, sw, blend.dual);
+  }
+
+  // Normalizes.
+  const math::SimdFloat4 inv_len =
+    math::RSqrtEstNR(math::SplatX(math::Dot4(blend.real, blend.real)));
+  blend.real = blend.real * inv_len;
+  blend.dual = blend.dual * inv_len;
+  return blend;
+}
+
+// Skins one vertex. _Inner specifies that there's enough remaining data in
+// input buffers to read 4 floats per attribute.
+template <bool _Inner>
+OZZ_INLINE void SkinVertex(const math::DualQuaternion& _dq,
+                           const float* _in,
+                           float* _out,
+                           bool _point) {
+  const math::SimdFloat4 in = _Inner ?
+    math::simd_float4::LoadPtrU(_in) : math::simd_float4::Load3PtrU(_in);
+  const math::SimdFloat4 out = _point ?
+    math::TransformPoint(_dq, in) : math::TransformVector(_dq, in);
+  math::Store3PtrU(out, _out);
+}
+
+template <bool _Inner>
+OZZ_INLINE void SkinVertex(const DualQuaternionSkinningJob& _job,
+                           const uint16_t* _indices,
+                           const float* _weights,
+                           const float* const* _in,
+                           float* const* _out,
+                           int _attributes) {
+  const math::DualQuaternion dq =
+    BlendDualQuaternions(_job, _indices, _weights);
+  for (int a = 0; a < _attributes; ++a) {
+    SkinVertex<_Inner>(dq, _in[a], _out[a], a == 0);
+  }
+}
+}  // namespace
+
+// Implements job Run function.
+bool DualQuaternionSkinningJob::Run() const {
+  OZZ_PROFILE_SCOPE("DualQuaternionSkinningJob::Run");
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no vertex. This isn't an error.
+  if (vertex_count == 0) {
+    return true;
+  }
+
+  // Collects vertex attributes.
+  const int attributes =
+    1 + (in_normals.begin != NULL) + (in_tangents.begin != NULL);
+  const float* in[3] = {in_positions.begin, in_normals.begin,
+                        in_tangents.begin};
+  float* out[3] = {out_positions.begin, out_normals.begin,
+                   out_tangents.begin};
+  const size_t in_strides[3] = {in_positions_stride, in_normals_stride,
+                                in_tangents_stride};
+  const size_t out_strides[3] = {out_positions_stride, out_normals_stride,
+                                 out_tangents_stride};
+  const uint16_t* indices = joint_indices.begin;
+  const float* weights = joint_weights.begin;
+
+  // Last vertex is processed out of the loop, as it can't read beyond the end
+  // of input buffers.
+  const int loops = vertex_count - 1;
+  for (int i = 0; i < loops; ++i) {
+    SkinVertex<true>(*this, indices, weights, in, out, attributes);
+    indices = Next(indices, joint_indices_stride);
+    weights = Next(weights, joint_weights_stride);
+    for (int a = 0; a < attributes; ++a) {
+      in[a] = Next(in[a], in_strides[a]);
+      out[a] = Next(out[a], out_strides[a]);
+    }
+  }
+  SkinVertex<false>(*this, indices, weights, in, out, attributes);
+
+  return true;
+}
+}  // geometry
+}  // ozz
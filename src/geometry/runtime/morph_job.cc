@@ -0,0 +1,179 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/morph_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+MorphJob::MorphJob()
+ : vertex_count(0),
+   in_positions_stride(0),
+   in_normals_stride(0),
+   out_positions_stride(0),
+   out_normals_stride(0) {
+}
+
+bool MorphJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  valid &= vertex_count >= 0;
+
+  // Checks targets and weights.
+  valid &= targets.end >= targets.begin;
+  valid &= weights.end >= weights.begin;
+  valid &= weights.Count() >= targets.Count();
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks positions, mandatory.
+  valid &= in_positions.begin != NULL;
+  valid &= in_positions.Size() >=
+      in_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.Size() >=
+      out_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks normals, optional.
+  const bool normals = in_normals.begin != NULL;
+  if (normals) {
+    valid &= in_normals.Size() >=
+      in_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= out_normals.begin != NULL;
+    valid &= out_normals.Size() >=
+      out_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+  }
+
+  // Checks every target deltas.
+  for (const Target* target = targets.begin;
+       valid && target < targets.end; ++target) {
+    valid &= target->indices.end >= target->indices.begin;
+    valid &= target->position_deltas.end >= target->position_deltas.begin;
+    valid &= target->normal_deltas.end >= target->normal_deltas.begin;
+    const size_t count = target->indices.Count();
+    valid &= target->position_deltas.Count() >= count * 3;
+    if (target->normal_deltas.begin) {
+      valid &= normals;
+      valid &= target->normal_deltas.Count() >= count * 3;
+    }
+  }
+
+  return valid;
+}
+
+namespace {
+// Copies _count vertices of 3 floats from _in to _out, unless they are the
+// same buffer.
+void Copy(const float* _in, size_t _in_stride,
+          float* _out, size_t _out_stride, int _count) {
+  if (_in == _out && _in_stride == _out_stride) {
+    return;
+  }
+  const char* in = reinterpret_cast<const char*>(_in);
+  char* out = reinterpret_cast<char*>(_out);
+  for (int i = 0; i < _count; ++i) {
+    math::Store3PtrU(
+      math::simd_float4::Load3PtrU(reinterpret_cast<const float*>(in)),
+      reinterpret_cast<float*>(out));
+    in += _in_stride;
+    out += _out_stride;
+  }
+}
+
+// Accumulates _count deltas of 3 floats weighted by _weight to the vertices
+// of _out indexed by _indices.
+void Accumulate(const uint32_t* _indices, const float* _deltas, int _count,
+                math::_SimdFloat4 _weight, float* _out, size_t _out_stride,
+                int _vertex_count) {
+  (void)_vertex_count;
+  char* out = reinterpret_cast<char*>(_out);
+  for (int i = 0; i < _count; ++i, _deltas += 3) {
+    assert(_indices[i] < static_cast<uint32_t>(_vertex_count) &&
+           "Morph target index out of range");
+    float* vertex = reinterpret_cast<float*>(out + _indices[i] * _out_stride);
+    const math::SimdFloat4 delta = math::simd_float4::Load3PtrU(_deltas);
+    math::Store3PtrU(
+      math::MAdd(delta, _weight, math::simd_float4::Load3PtrU(vertex)),
+      vertex);
+  }
+}
+}  // namespace
+
+bool MorphJob::Run() const {
+  OZZ_PROFILE_SCOPE("MorphJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Starts from base vertices.
+  const bool normals = in_normals.begin != NULL;
+  Copy(in_positions.begin, in_positions_stride,
+       out_positions.begin, out_positions_stride, vertex_count);
+  if (normals) {
+    Copy(in_normals.begin, in_normals_stride,
+         out_normals.begin, out_normals_stride, vertex_count);
+  }
+
+  // Accumulates active targets.
+  const int num_targets = static_cast<int>(targets.Count());
+  for (int t = 0; t < num_targets; ++t) {
+    const float weight = weights.begin[t];
+    if (weight == 0.f) {
+      continue;
+    }
+    const Target& target = targets.begin[t];
+    const int count = static_cast<int>(target.indices.Count());
+    const math::SimdFloat4 splat = math::simd_float4::Load1(weight);
+    Accumulate(target.indices.begin, target.position_deltas.begin, count,
+               splat, out_positions.begin, out_positions_stride,
+               vertex_count);
+    if (target.normal_deltas.begin) {
+      Accumulate(target.indices.begin, target.normal_deltas.begin, count,
+                 splat, out_normals.begin, out_normals_stride, vertex_count);
+    }
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
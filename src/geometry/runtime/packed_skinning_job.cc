@@ -0,0 +1,325 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/packed_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+PackedSkinningJob::PackedSkinningJob()
+ : vertex_count(0),
+   influences_count(0),
+   in_positions_stride(0),
+   in_normals_stride(0),
+   in_tangents_stride(0),
+   out_positions_stride(0),
+   out_normals_stride(0),
+   out_tangents_stride(0) {
+}
+
+bool PackedSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks influences bounds.
+  valid &= influences_count > 0;
+
+  // Checks joints matrices, required.
+  valid &= joint_matrices.begin != NULL;
+  valid &= joint_matrices.end >= joint_matrices.begin;
+
+  // Checks optional inverse transpose matrices.
+  if (joint_inverse_transpose_matrices.begin) {
+    valid &= joint_inverse_transpose_matrices.end >=
+             joint_inverse_transpose_matrices.begin;
+  }
+
+  // Checks palette, which can't address more than 256 joints.
+  valid &= palette.begin != NULL;
+  valid &= palette.Count() <= 256;
+
+  // Checks sets, that must cover all vertices.
+  valid &= set_vertex_counts.begin != NULL;
+  valid &= set_joint_indices.begin != NULL;
+  const size_t num_sets = set_vertex_counts.Count();
+  if (influences_count > 0) {
+    valid &= set_joint_indices.Count() >= num_sets * influences_count;
+  }
+  int set_vertices = 0;
+  for (size_t i = 0; i < num_sets; ++i) {
+    set_vertices += set_vertex_counts.begin[i];
+  }
+  valid &= set_vertices == vertex_count;
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks weights, one format is required if influences_count > 1.
+  if (influences_count > 1) {
+    const size_t num_weights =
+      static_cast<size_t>(influences_count - 1) * vertex_count;
+    const bool has_8 = joint_weights_8.begin != NULL;
+    const bool has_16 = joint_weights_16.begin != NULL;
+    valid &= has_8 != has_16;
+    valid &= !has_8 || joint_weights_8.Count() >= num_weights;
+    valid &= !has_16 || joint_weights_16.Count() >= num_weights;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.begin != NULL;
+  valid &= in_positions.Size() >=
+      in_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.Size() >=
+      out_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks normals, optional.
+  if (in_normals.begin) {
+    valid &= in_normals.Size() >=
+      in_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= out_normals.begin != NULL;
+    valid &= out_normals.Size() >=
+      out_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+    // Checks tangents, optional but requires normals.
+    if (in_tangents.begin) {
+      valid &= in_tangents.Size() >=
+        in_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+      valid &= out_tangents.begin != NULL;
+      valid &= out_tangents.Size() >=
+        out_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= in_tangents.begin == NULL;
+    valid &= in_tangents.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Number of joints matrices of a set that are fetched once for all the
+// vertices of the set. Remaining ones are fetched for every vertex.
+const int kMaxCachedInfluences = 8;
+
+// Implements pointer striding.
+template <typename _Ty>
+_Ty* Next(_Ty* _current, size_t _stride) {
+  return reinterpret_cast<_Ty*>(
+    reinterpret_cast<uintptr_t>(_current) + _stride);
+}
+
+// Stores the palette matrices of an influence set.
+class SetMatrices {
+ public:
+  SetMatrices(const math::Float4x4* _matrices,
+              const uint16_t* _palette,
+              const uint8_t* _set_joints,
+              int _influences_count)
+    : matrices_(_matrices),
+      palette_(_palette),
+      set_joints_(_set_joints) {
+    const int cached = _influences_count < kMaxCachedInfluences ?
+      _influences_count : kMaxCachedInfluences;
+    for (int j = 0; j < cached; ++j) {
+      cached_[j] = _matrices + _palette[_set_joints[j]];
+    }
+  }
+
+  // Gets the matrix of influence _j.
+  const math::Float4x4& operator[](int _j) const {
+    return _j < kMaxCachedInfluences ?
+      *cached_[_j] : matrices_[palette_[set_joints_[_j]]];
+  }
+
+ private:
+  const math::Float4x4* matrices_;
+  const uint16_t* palette_;
+  const uint8_t* set_joints_;
+  const math::Float4x4* cached_[kMaxCachedInfluences];
+};
+
+// Blends set matrices _matrices with the _influences_count - 1 quantized
+// weights _weights, normalized with _scale.
+template <typename _Weight>
+OZZ_INLINE math::Float4x4 Blend(const SetMatrices& _matrices,
+                                const _Weight* _weights,
+                                int _influences_count,
+                                math::_SimdFloat4 _scale) {
+  const int last = _influences_count - 1;
+  math::SimdFloat4 wsum = math::simd_float4::Load1(
+    static_cast<float>(_weights[0])) * _scale;
+  math::Float4x4 transform = math::ColumnMultiply(_matrices[0], wsum);
+  for (int j = 1; j < last; ++j) {
+    const math::SimdFloat4 w = math::simd_float4::Load1(
+      static_cast<float>(_weights[j])) * _scale;
+    wsum = wsum + w;
+    transform = transform + math::ColumnMultiply(_matrices[j], w);
+  }
+  return transform + math::ColumnMultiply(_matrices[last],
+                                          math::simd_float4::one() - wsum);
+}
+
+// Transforms one vertex attribute. _Inner specifies that there's enough
+// remaining data in input buffers to read 4 floats.
+template <bool _Inner>
+OZZ_INLINE void Transform(const math::Float4x4& _transform,
+                          const float* _in,
+                          float* _out,
+                          bool _point) {
+  const math::SimdFloat4 in = _Inner ?
+    math::simd_float4::LoadPtrU(_in) : math::simd_float4::Load3PtrU(_in);
+  const math::SimdFloat4 out = _point ?
+    TransformPoint(_transform, in) : TransformVector(_transform, in);
+  math::Store3PtrU(out, _out);
+}
+
+// Defines vertex streams iteration state.
+struct Streams {
+  int attributes;
+  const float* in[3];
+  float* out[3];
+  size_t in_strides[3];
+  size_t out_strides[3];
+};
+
+// Skins one vertex with _transform and _it_transform, and moves streams to the
+// next vertex.
+template <bool _Inner>
+OZZ_INLINE void SkinVertex(const math::Float4x4& _transform,
+                           const math::Float4x4& _it_transform,
+                           Streams* _streams) {
+  for (int a = 0; a < _streams->attributes; ++a) {
+    Transform<_Inner>(a == 0 ? _transform : _it_transform,
+                      _streams->in[a], _streams->out[a], a == 0);
+    _streams->in[a] = Next(_streams->in[a], _streams->in_strides[a]);
+    _streams->out[a] = Next(_streams->out[a], _streams->out_strides[a]);
+  }
+}
+
+// Skins all job influence sets, with weights format _Weight.
+template <typename _Weight>
+void SkinSets(const PackedSkinningJob& _job,
+              const _Weight* _weights,
+              float _scale,
+              Streams* _streams) {
+  const math::SimdFloat4 scale = math::simd_float4::Load1(_scale);
+  const bool it = _job.joint_inverse_transpose_matrices.begin != NULL;
+  const int influences = _job.influences_count;
+  const int last_vertex = _job.vertex_count - 1;
+  const uint8_t* set_joints = _job.set_joint_indices.begin;
+  int vertex = 0;
+  for (const uint16_t* set = _job.set_vertex_counts.begin;
+       set < _job.set_vertex_counts.end;
+       ++set, set_joints += influences) {
+    const SetMatrices matrices(_job.joint_matrices.begin,
+                               _job.palette.begin,
+                               set_joints,
+                               influences);
+    const SetMatrices it_matrices(
+      it ? _job.joint_inverse_transpose_matrices.begin :
+           _job.joint_matrices.begin,
+      _job.palette.begin,
+      set_joints,
+      influences);
+    const int set_end = vertex + *set;
+
+    if (influences == 1) {
+      // Single influence sets share the same matrix for all vertices.
+      const math::Float4x4& transform = matrices[0];
+      const math::Float4x4& it_transform = it_matrices[0];
+      for (; vertex < set_end; ++vertex) {
+        if (vertex != last_vertex) {
+          SkinVertex<true>(transform, it_transform, _streams);
+        } else {
+          SkinVertex<false>(transform, it_transform, _streams);
+        }
+      }
+    } else {
+      for (; vertex < set_end; ++vertex, _weights += influences - 1) {
+        const math::Float4x4 transform =
+          Blend(matrices, _weights, influences, scale);
+        const math::Float4x4 it_transform = it ?
+          Blend(it_matrices, _weights, influences, scale) : transform;
+        if (vertex != last_vertex) {
+          SkinVertex<true>(transform, it_transform, _streams);
+        } else {
+          SkinVertex<false>(transform, it_transform, _streams);
+        }
+      }
+    }
+  }
+  assert(vertex == _job.vertex_count);
+}
+}  // namespace
+
+// Implements job Run function.
+bool PackedSkinningJob::Run() const {
+  OZZ_PROFILE_SCOPE("PackedSkinningJob::Run");
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Collects vertex streams.
+  Streams streams = {
+    1 + (in_normals.begin != NULL) + (in_tangents.begin != NULL),
+    {in_positions.begin, in_normals.begin, in_tangents.begin},
+    {out_positions.begin, out_normals.begin, out_tangents.begin},
+    {in_positions_stride, in_normals_stride, in_tangents_stride},
+    {out_positions_stride, out_normals_stride, out_tangents_stride}};
+
+  // Dispatches to weights format.
+  if (joint_weights_16.begin) {
+    SkinSets(*this, joint_weights_16.begin, 1.f / 65535.f, &streams);
+  } else {
+    // Single influence sets have no weight, 8 bits path handles it.
+    SkinSets(*this, joint_weights_8.begin, 1.f / 255.f, &streams);
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
@@ -0,0 +1,228 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/tasks/task_dispatcher.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+namespace {
+
+// Cache line size used to align chunks.
+const size_t kCacheLineSize = 64;
+
+// Computes the minimum number of vertices such that _stride * vertices is a
+// multiple of the cache line size.
+int StrideGranularity(size_t _stride) {
+  if (_stride == 0) {
+    return 1;
+  }
+  size_t a = _stride;
+  size_t b = kCacheLineSize;
+  while (b != 0) {
+    const size_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return static_cast<int>(kCacheLineSize / a);
+}
+
+// Offsets range _range begin pointer by _count elements of _stride bytes.
+// Empty ranges are left unchanged.
+template <typename _Ty>
+void Offset(Range<_Ty>* _range, size_t _stride, int _count) {
+  if (_range->begin) {
+    _range->begin = reinterpret_cast<_Ty*>(
+      reinterpret_cast<uintptr_t>(_range->begin) + _stride * _count);
+  }
+}
+
+// Implements the task that processes every chunk as a work item.
+class ChunkTask : public tasks::Task {
+ public:
+  ChunkTask(const SkinningJob& _job,
+            int _chunk_vertex_count,
+            math::Box* _chunk_bounds,
+            SkinningJob::Stats* _chunk_stats)
+    : job_(_job),
+      chunk_vertex_count_(_chunk_vertex_count),
+      chunk_bounds_(_chunk_bounds),
+      chunk_stats_(_chunk_stats) {
+  }
+
+  virtual void Run(int _index) const {
+    const int first = _index * chunk_vertex_count_;
+    const int remaining = job_.vertex_count - first;
+    assert(remaining > 0);
+
+    // Builds a job restricted to chunk's vertex range.
+    SkinningJob chunk = job_;
+    chunk.vertex_count =
+      remaining < chunk_vertex_count_ ? remaining : chunk_vertex_count_;
+    Offset(&chunk.joint_indices, chunk.joint_indices_stride, first);
+    Offset(&chunk.joint_weights, chunk.joint_weights_stride, first);
+    Offset(&chunk.in_positions, chunk.in_positions_stride, first);
+    Offset(&chunk.in_normals, chunk.in_normals_stride, first);
+    Offset(&chunk.in_tangents, chunk.in_tangents_stride, first);
+    Offset(&chunk.out_positions, chunk.out_positions_stride, first);
+    Offset(&chunk.out_positions_x, sizeof(float), first);
+    Offset(&chunk.out_positions_y, sizeof(float), first);
+    Offset(&chunk.out_positions_z, sizeof(float), first);
+    Offset(&chunk.out_normals, chunk.out_normals_stride, first);
+    Offset(&chunk.out_tangents, chunk.out_tangents_stride, first);
+
+    // Every chunk outputs its own bounds, merged once all chunks are done.
+    chunk.out_bounds = chunk_bounds_ ? chunk_bounds_ + _index : NULL;
+
+    // Same for stats, which can't be updated concurrently.
+    chunk.stats = chunk_stats_ ? chunk_stats_ + _index : NULL;
+
+    // Cannot fail as a subset of a valid job is valid.
+    const bool success = chunk.Run();
+    assert(success);
+    (void)success;
+  }
+
+ private:
+  // Disables assignment operators.
+  ChunkTask(const ChunkTask&);
+  void operator = (const ChunkTask&);
+
+  const SkinningJob& job_;
+  const int chunk_vertex_count_;
+  math::Box* const chunk_bounds_;
+  SkinningJob::Stats* const chunk_stats_;
+};
+}  // namespace
+
+ParallelSkinningJob::ParallelSkinningJob()
+    : dispatcher(NULL),
+      chunk_size(1024) {
+}
+
+bool ParallelSkinningJob::Validate() const {
+  bool valid = skinning.Validate();
+  valid &= dispatcher != NULL;
+  valid &= chunk_size > 0;
+  return valid;
+}
+
+int ParallelSkinningJob::chunk_vertex_count() const {
+  // Output strides granularities are powers of 2, the biggest one is thus a
+  // multiple of the others.
+  int granularity = StrideGranularity(
+    skinning.out_positions_x.begin ? sizeof(float) :
+                                     skinning.out_positions_stride);
+  if (skinning.out_normals.begin) {
+    const int normals = StrideGranularity(skinning.out_normals_stride);
+    granularity = normals > granularity ? normals : granularity;
+  }
+  if (skinning.out_tangents.begin) {
+    const int tangents = StrideGranularity(skinning.out_tangents_stride);
+    granularity = tangents > granularity ? tangents : granularity;
+  }
+  const int size = chunk_size > 0 ? chunk_size : 1;
+  return (size + granularity - 1) / granularity * granularity;
+}
+
+bool ParallelSkinningJob::Run() const {
+  OZZ_PROFILE_SCOPE("ParallelSkinningJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no vertex. This isn't an error.
+  if (skinning.vertex_count == 0) {
+    if (skinning.out_bounds) {
+      *skinning.out_bounds = math::Box();
+    }
+    return true;
+  }
+
+  // Allocates per chunk bounds, as skinning.out_bounds can't be shared.
+  const int chunk_vertices = chunk_vertex_count();
+  const int chunks = (skinning.vertex_count + chunk_vertices - 1) /
+                     chunk_vertices;
+  math::Box* chunk_bounds = NULL;
+  if (skinning.out_bounds) {
+    chunk_bounds = memory::default_allocator()->Allocate<math::Box>(chunks);
+  }
+
+  // Allocates per chunk stats, for the same reason.
+  SkinningJob::Stats* chunk_stats = NULL;
+#ifdef OZZ_HAS_STATS
+  if (skinning.stats) {
+    chunk_stats =
+      memory::default_allocator()->Allocate<SkinningJob::Stats>(chunks);
+    for (int i = 0; i < chunks; ++i) {
+      chunk_stats[i] = SkinningJob::Stats();
+    }
+  }
+#endif  // OZZ_HAS_STATS
+
+  // Dispatches chunks.
+  const ChunkTask task(skinning, chunk_vertices, chunk_bounds, chunk_stats);
+  dispatcher->Dispatch(task, chunks);
+
+  // Merges chunks bounds.
+  if (chunk_bounds) {
+    math::Box bounds = chunk_bounds[0];
+    for (int i = 1; i < chunks; ++i) {
+      bounds = math::Merge(bounds, chunk_bounds[i]);
+    }
+    *skinning.out_bounds = bounds;
+    memory::default_allocator()->Deallocate(chunk_bounds);
+  }
+
+  // Merges chunks stats.
+  if (chunk_stats) {
+    const int num_counters = sizeof(skinning.stats->vertices) /
+                             sizeof(skinning.stats->vertices[0][0]);
+    int* counters = &skinning.stats->vertices[0][0];
+    for (int i = 0; i < chunks; ++i) {
+      const int* chunk_counters = &chunk_stats[i].vertices[0][0];
+      for (int c = 0; c < num_counters; ++c) {
+        counters[c] += chunk_counters[c];
+      }
+    }
+    memory::default_allocator()->Deallocate(chunk_stats);
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
@@ -0,0 +1,349 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/qtangent_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/dual_quaternion.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+const float kQTangentBias = 1.f / 32767.f;
+
+QTangentSkinningJob::QTangentSkinningJob()
+ : vertex_count(0),
+   influences_count(0),
+   joint_indices_stride(0),
+   joint_weights_stride(0),
+   in_positions_stride(0),
+   in_qtangents_stride(0),
+   out_positions_stride(0),
+   out_qtangents_stride(0),
+   out_normals_stride(0),
+   out_tangents_stride(0) {
+}
+
+bool QTangentSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks influences bounds.
+  valid &= influences_count > 0;
+
+  // Checks joints palette, exactly one is required.
+  const bool dual_quaternions = joint_dual_quaternions.begin != NULL;
+  const bool matrices = joint_matrices.begin != NULL;
+  valid &= dual_quaternions != matrices;
+  valid &= joint_dual_quaternions.end >= joint_dual_quaternions.begin;
+  valid &= joint_matrices.end >= joint_matrices.begin;
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks indices, required.
+  valid &= joint_indices.begin != NULL;
+  valid &= joint_indices.Size() >=
+    joint_indices_stride * vertex_count_minus_1 +
+    sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count != 1) {
+    valid &= joint_weights.begin != NULL;
+    valid &= joint_weights.Size() >=
+      joint_weights_stride * vertex_count_minus_1 +
+      sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.begin != NULL;
+  valid &= in_positions.Size() >=
+      in_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.Size() >=
+      out_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks tangent frames, optional.
+  const bool frame_outputs = out_qtangents.begin != NULL ||
+                             out_normals.begin != NULL ||
+                             out_tangents.begin != NULL;
+  if (in_qtangents.begin) {
+    valid &= frame_outputs;
+    valid &= in_qtangents.Size() >=
+      in_qtangents_stride * vertex_count_minus_1 +
+      sizeof(float) * 4 * vertex_count_at_least_1;
+
+    // QTangents output requires a dual quaternion palette.
+    if (out_qtangents.begin) {
+      valid &= dual_quaternions;
+      valid &= out_qtangents.Size() >=
+        out_qtangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 4 * vertex_count_at_least_1;
+    }
+    if (out_normals.begin) {
+      valid &= out_normals.Size() >=
+        out_normals_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+    }
+    if (out_tangents.begin) {
+      valid &= out_tangents.Size() >=
+        out_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 4 * vertex_count_at_least_1;
+    }
+  } else {
+    // Tangent frames can't be output if there's no input.
+    valid &= !frame_outputs;
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Implements pointer striding.
+template <typename _Ty>
+OZZ_INLINE _Ty* Next(_Ty* _current, size_t _stride) {
+  return reinterpret_cast<_Ty*>(
+    reinterpret_cast<uintptr_t>(_current) + _stride);
+}
+
+// Blends the dual quaternions influencing a vertex, and normalizes the result.
+// This is the same blending as DualQuaternionSkinningJob.
+OZZ_INLINE math::DualQuaternion BlendDualQuaternions(
+    const QTangentSkinningJob& _job,
+    const uint16_t* _indices,
+    const float* _weights) {
+  const math::DualQuaternion& dq0 = _job.joint_dual_quaternions[_indices[0]];
+  const int last = _job.influences_count - 1;
+  if (last == 0) {
+    return dq0;
+  }
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(_weights);
+  math::DualQuaternion blend = {dq0.real * wsum, dq0.dual * wsum};
+  for (int j = 1; j <= last; ++j) {
+    const math::DualQuaternion& dq = _job.joint_dual_quaternions[_indices[j]];
+    math::SimdFloat4 w;
+    if (j < last) {
+      w = math::simd_float4::Load1PtrU(_weights + j);
+      wsum = wsum + w;
+    } else {
+      w = math::simd_float4::one() - wsum;
+    }
+    const math::SimdInt4 antipodal =
+      math::CmpLt(math::SplatX(math::Dot4(dq0.real, dq.real)), zero);
+    const math::SimdFloat4 sw = math::Select(antipodal, -w, w);
+    blend.real = math::MAdd(dq.real, sw, blend.real);
+    blend.dual = math::MAdd(dq.dual, sw, blend.dual);
+  }
+
+  // Normalizes.
+  const math::SimdFloat4 inv_len =
+    math::RSqrtEstNR(math::SplatX(math::Dot4(blend.real, blend.real)));
+  blend.real = blend.real * inv_len;
+  blend.dual = blend.dual * inv_len;
+  return blend;
+}
+
+// Blends the matrices influencing a vertex. This is the same blending as
+// SkinningJob.
+OZZ_INLINE math::Float4x4 BlendMatrices(const QTangentSkinningJob& _job,
+                                        const uint16_t* _indices,
+                                        const float* _weights) {
+  const math::Float4x4* matrices = _job.joint_matrices.begin;
+  const int last = _job.influences_count - 1;
+  if (last == 0) {
+    return matrices[_indices[0]];
+  }
+
+  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(_weights);
+  math::Float4x4 blend = ColumnMultiply(matrices[_indices[0]], wsum);
+  for (int j = 1; j < last; ++j) {
+    const math::SimdFloat4 w = math::simd_float4::Load1PtrU(_weights + j);
+    wsum = wsum + w;
+    blend = blend + ColumnMultiply(matrices[_indices[j]], w);
+  }
+  return blend + ColumnMultiply(matrices[_indices[last]],
+                                math::simd_float4::one() - wsum);
+}
+
+// Decodes tangent frame of QTangent _q, aka _q applied to z (normal) and x
+// (tangent) axes. Tangent w component is set to the handedness.
+OZZ_INLINE void DecodeQTangent(math::_SimdFloat4 _q,
+                               math::SimdFloat4* _normal,
+                               math::SimdFloat4* _tangent) {
+  const math::DualQuaternion rotation = {_q, math::simd_float4::zero()};
+  *_normal = TransformVector(rotation, math::simd_float4::z_axis());
+  const math::SimdFloat4 tangent =
+    TransformVector(rotation, math::simd_float4::x_axis());
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdInt4 negative =
+    math::CmpLt(math::SplatW(_q), math::simd_float4::zero());
+  *_tangent = math::Select(math::simd_int4::mask_fff0(), tangent,
+                           math::Select(negative, -one, one));
+}
+
+// Rotates QTangent _q with joint rotation _rotation, preserving its handedness
+// and biasing w away from 0.
+OZZ_INLINE math::SimdFloat4 RotateQTangent(math::_SimdFloat4 _rotation,
+                                           math::_SimdFloat4 _q) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 q = math::internal::QuaternionMultiply(_rotation, _q);
+
+  // Restores input handedness, q and -q being the same rotation.
+  const math::SimdInt4 negative = math::CmpLt(math::SplatW(_q), zero);
+  const math::SimdInt4 flip =
+    math::Xor(negative, math::CmpLt(math::SplatW(q), zero));
+  const math::SimdFloat4 xyz = math::Select(flip, -q, q);
+
+  // Biases w.
+  const math::SimdFloat4 abs_w =
+    math::Max(math::Abs(math::SplatW(q)),
+              math::simd_float4::Load1(kQTangentBias));
+  return math::Select(math::simd_int4::mask_fff0(), xyz,
+                      math::Select(negative, -abs_w, abs_w));
+}
+
+// Skins all vertices with dual quaternion palette.
+void SkinDualQuaternions(const QTangentSkinningJob& _job) {
+  const uint16_t* indices = _job.joint_indices.begin;
+  const float* weights = _job.joint_weights.begin;
+  const float* in_positions = _job.in_positions.begin;
+  const float* in_qtangents = _job.in_qtangents.begin;
+  float* out_positions = _job.out_positions.begin;
+  float* out_qtangents = _job.out_qtangents.begin;
+  float* out_normals = _job.out_normals.begin;
+  float* out_tangents = _job.out_tangents.begin;
+
+  for (int i = 0; i < _job.vertex_count; ++i) {
+    const math::DualQuaternion dq =
+      BlendDualQuaternions(_job, indices, weights);
+    indices = Next(indices, _job.joint_indices_stride);
+    weights = Next(weights, _job.joint_weights_stride);
+
+    const math::SimdFloat4 in_p = math::simd_float4::Load3PtrU(in_positions);
+    math::Store3PtrU(TransformPoint(dq, in_p), out_positions);
+    in_positions = Next(in_positions, _job.in_positions_stride);
+    out_positions = Next(out_positions, _job.out_positions_stride);
+
+    if (!in_qtangents) {
+      continue;
+    }
+    const math::SimdFloat4 in_q = math::simd_float4::LoadPtrU(in_qtangents);
+    const math::SimdFloat4 q = RotateQTangent(dq.real, in_q);
+    in_qtangents = Next(in_qtangents, _job.in_qtangents_stride);
+    if (out_qtangents) {
+      math::StorePtrU(q, out_qtangents);
+      out_qtangents = Next(out_qtangents, _job.out_qtangents_stride);
+    }
+    if (out_normals || out_tangents) {
+      math::SimdFloat4 normal, tangent;
+      DecodeQTangent(q, &normal, &tangent);
+      if (out_normals) {
+        math::Store3PtrU(normal, out_normals);
+        out_normals = Next(out_normals, _job.out_normals_stride);
+      }
+      if (out_tangents) {
+        math::StorePtrU(tangent, out_tangents);
+        out_tangents = Next(out_tangents, _job.out_tangents_stride);
+      }
+    }
+  }
+}
+
+// Skins all vertices with matrix palette.
+void SkinMatrices(const QTangentSkinningJob& _job) {
+  const uint16_t* indices = _job.joint_indices.begin;
+  const float* weights = _job.joint_weights.begin;
+  const float* in_positions = _job.in_positions.begin;
+  const float* in_qtangents = _job.in_qtangents.begin;
+  float* out_positions = _job.out_positions.begin;
+  float* out_normals = _job.out_normals.begin;
+  float* out_tangents = _job.out_tangents.begin;
+
+  for (int i = 0; i < _job.vertex_count; ++i) {
+    const math::Float4x4 transform = BlendMatrices(_job, indices, weights);
+    indices = Next(indices, _job.joint_indices_stride);
+    weights = Next(weights, _job.joint_weights_stride);
+
+    const math::SimdFloat4 in_p = math::simd_float4::Load3PtrU(in_positions);
+    math::Store3PtrU(TransformPoint(transform, in_p), out_positions);
+    in_positions = Next(in_positions, _job.in_positions_stride);
+    out_positions = Next(out_positions, _job.out_positions_stride);
+
+    if (!in_qtangents) {
+      continue;
+    }
+    math::SimdFloat4 normal, tangent;
+    DecodeQTangent(math::simd_float4::LoadPtrU(in_qtangents),
+                   &normal, &tangent);
+    in_qtangents = Next(in_qtangents, _job.in_qtangents_stride);
+    if (out_normals) {
+      math::Store3PtrU(TransformVector(transform, normal), out_normals);
+      out_normals = Next(out_normals, _job.out_normals_stride);
+    }
+    if (out_tangents) {
+      // Handedness is restored in w, as TransformVector ignores it.
+      const math::SimdFloat4 skinned = TransformVector(transform, tangent);
+      math::StorePtrU(
+        math::Select(math::simd_int4::mask_fff0(), skinned, tangent),
+        out_tangents);
+      out_tangents = Next(out_tangents, _job.out_tangents_stride);
+    }
+  }
+}
+}  // namespace
+
+// Implements job Run function.
+bool QTangentSkinningJob::Run() const {
+  OZZ_PROFILE_SCOPE("QTangentSkinningJob::Run");
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  if (joint_dual_quaternions.begin) {
+    SkinDualQuaternions(*this);
+  } else {
+    SkinMatrices(*this);
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
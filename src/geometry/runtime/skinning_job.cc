@@ -31,8 +31,15 @@
 #include "ozz/geometry/runtime/skinning_job.h"
 
 #include <cassert>
+#include <cstring>
+#include <limits>
 
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/simd_dispatch.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_float4x3.h"
+#include "ozz/base/profile.h"
+#include "ozz/base/tasks/task_dispatcher.h"
 
 namespace ozz {
 namespace geometry {
@@ -47,7 +54,14 @@ SkinningJob::SkinningJob()
    in_tangents_stride(0),
    out_positions_stride(0),
    out_normals_stride(0),
-   out_tangents_stride(0) {
+   out_tangents_stride(0),
+   normalization(kNoNormalization),
+   out_bounds(NULL),
+   stats(NULL) {
+}
+
+SkinningJob::Stats::Stats() {
+  std::memset(vertices, 0, sizeof(vertices));
 }
 
 bool SkinningJob::Validate() const {
@@ -58,9 +72,11 @@ bool SkinningJob::Validate() const {
   // Checks influences bounds.
   valid &= influences_count > 0;
 
-  // Checks joints matrices, required.
-  valid &= joint_matrices.begin != NULL;
+  // Checks joints matrices, required in exactly one of the two formats.
+  const bool affine = joint_matrices_4x3.begin != NULL;
+  valid &= (joint_matrices.begin != NULL) != affine;
   valid &= joint_matrices.end >= joint_matrices.begin;
+  valid &= joint_matrices_4x3.end >= joint_matrices_4x3.begin;
 
   // Checks optional inverse transpose matrices. 
   if (joint_inverse_transpose_matrices.begin) {
@@ -68,6 +84,17 @@ bool SkinningJob::Validate() const {
     valid &= joint_inverse_transpose_matrices.end >=
              joint_inverse_transpose_matrices.begin;
   }
+  if (joint_inverse_transpose_matrices_4x3.begin) {
+    valid &= joint_inverse_transpose_matrices_4x3.end >=
+             joint_inverse_transpose_matrices_4x3.begin;
+  }
+
+  // Inverse transpose matrices must use the same format as joint matrices.
+  if (affine) {
+    valid &= joint_inverse_transpose_matrices.begin == NULL;
+  } else {
+    valid &= joint_inverse_transpose_matrices_4x3.begin == NULL;
+  }
 
   // Prepares local variables used to compute buffer size.
   const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
@@ -79,6 +106,13 @@ bool SkinningJob::Validate() const {
     joint_indices_stride * vertex_count_minus_1 +
     sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
 
+  // Checks optional joint indices remapping table.
+  if (joint_remap.begin) {
+    valid &= joint_remap.end >= joint_remap.begin;
+  } else {
+    valid &= joint_remap.end == NULL;
+  }
+
   // Checks weights, required if influences_count > 1. 
   if (influences_count != 1) {
     valid &= joint_weights.begin != NULL;
@@ -92,10 +126,26 @@ bool SkinningJob::Validate() const {
   valid &= in_positions.Size() >=
       in_positions_stride * vertex_count_minus_1 +
       sizeof(float) * 3 * vertex_count_at_least_1;
-  valid &= out_positions.begin != NULL;
-  valid &= out_positions.Size() >=
-      out_positions_stride * vertex_count_minus_1 +
-      sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks output positions, mandatory in exactly one of the two layouts.
+  if (out_positions_x.begin) {
+    valid &= out_positions.begin == NULL;
+    valid &= out_positions.end == NULL;
+    valid &= out_positions_y.begin != NULL;
+    valid &= out_positions_z.begin != NULL;
+    const size_t soa_size =
+      sizeof(float) * (vertex_count_minus_1 + vertex_count_at_least_1);
+    valid &= out_positions_x.Size() >= soa_size;
+    valid &= out_positions_y.Size() >= soa_size;
+    valid &= out_positions_z.Size() >= soa_size;
+  } else {
+    valid &= out_positions_y.begin == NULL;
+    valid &= out_positions_z.begin == NULL;
+    valid &= out_positions.begin != NULL;
+    valid &= out_positions.Size() >=
+        out_positions_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+  }
 
   // Checks normals, optional.
   if (in_normals.begin) {
@@ -133,22 +183,59 @@ bool SkinningJob::Validate() const {
 // define a skeleton code (SKINNING_FN) for the skinning loop, which internally
 // calls MACRO that are shared or specialized according to skinning variants.
 
+// Weights matrix _m with the splatted weight _w.
+OZZ_INLINE math::Float4x4 WeightMatrix(const math::Float4x4& _m,
+                                       math::_SimdFloat4 _w) {
+  return math::ColumnMultiply(_m, _w);
+}
+
+OZZ_INLINE math::Float4x3 WeightMatrix(const math::Float4x3& _m,
+                                       math::_SimdFloat4 _w) {
+  return math::RowMultiply(_m, _w);
+}
+
+// Normalizes skinned vector _v according to _Normalization mode. Branches are
+// resolved at compile time.
+template <SkinningJob::Normalization _Normalization>
+OZZ_INLINE math::SimdFloat4 NormalizeVector(math::_SimdFloat4 _v) {
+  if (_Normalization == SkinningJob::kNormalizeEst) {
+    return math::NormalizeEst3(_v);
+  } else if (_Normalization == SkinningJob::kNormalize) {
+    return math::Normalize3(_v);
+  }
+  return _v;
+}
+
 // Defines the skeleton code for the per vertex skinning loop.
+// Skinning functions are templates of the joint matrix type, which can be
+// Float4x4 or compact Float4x3 affine matrices, of _Bounds, which enables
+// output positions bounds accumulation, of _Normalization, the output vectors
+// normalization mode, and of _Remap, which enables joint indices remapping.
 #define SKINNING_FN(_type, _it, _inf) \
-  void SKINNING_FN_NAME(_type, _it, _inf)(const SkinningJob& _job) { \
+  template <typename _Matrix, bool _Bounds, \
+            SkinningJob::Normalization _Normalization, bool _Remap> \
+  OZZ_SIMD_DISPATCH \
+  void SKINNING_FN_NAME(_type, _it, _inf)(const SkinningJob& _job, \
+                                          const _Matrix* _matrices, \
+                                          const _Matrix* _it_matrices) { \
+    (void)_it_matrices; \
     ASSERT_##_type() \
     ASSERT_##_it() \
     INIT_##_type() \
     INIT_W##_inf() \
+    INIT_BOUNDS() \
     const int loops = _job.vertex_count - 1; \
     for (int i = 0; i < loops; ++i) { \
       PREPARE_##_inf##_INNER(_it) \
       TRANSFORM_##_type##_INNER() \
+      ACCUMULATE_BOUNDS() \
       NEXT_##_type() \
       NEXT_W##_inf() \
     } \
     PREPARE_##_inf##_OUTER(_it) \
     TRANSFORM_##_type##_OUTER() \
+    ACCUMULATE_BOUNDS() \
+    STORE_BOUNDS() \
   }
 
 // Defines skinning function name.
@@ -177,13 +264,19 @@ bool SkinningJob::Validate() const {
 #define ASSERT_NOIT()
 
 #define ASSERT_IT() \
-  assert(_job.joint_inverse_transpose_matrices.begin);
+  assert(_it_matrices);
 
 // Implements loop initializations for positions, ...
 #define INIT_P() \
   const uint16_t* joint_indices = _job.joint_indices.begin; \
+  const uint16_t* joint_remap = _job.joint_remap.begin; \
+  (void)joint_remap; \
   const float* in_positions = _job.in_positions.begin; \
-  float* out_positions = _job.out_positions.begin;
+  float* out_positions = _job.out_positions.begin; \
+  float* out_positions_x = _job.out_positions_x.begin; \
+  float* out_positions_y = _job.out_positions_y.begin; \
+  float* out_positions_z = _job.out_positions_z.begin; \
+  const bool soa_positions = out_positions_x != NULL;
 
 #define INIT_PN() \
   INIT_P(); \
@@ -213,6 +306,25 @@ bool SkinningJob::Validate() const {
 #define INIT_WN() \
   INIT_W2()
 
+// Implements bounds accumulation, while transformed positions are still in
+// registers. Compiled out if _Bounds is false.
+#define INIT_BOUNDS() \
+  math::SimdFloat4 bounds_min = \
+    math::simd_float4::Load1(std::numeric_limits<float>::max()); \
+  math::SimdFloat4 bounds_max = -bounds_min;
+
+#define ACCUMULATE_BOUNDS() \
+  if (_Bounds) { \
+    bounds_min = math::Min(bounds_min, out_p); \
+    bounds_max = math::Max(bounds_max, out_p); \
+  }
+
+#define STORE_BOUNDS() \
+  if (_Bounds) { \
+    math::Store3PtrU(bounds_min, &_job.out_bounds->min.x); \
+    math::Store3PtrU(bounds_max, &_job.out_bounds->max.x); \
+  }
+
 // Implements pointer striding.
 #define NEXT(_type, _current, _stride) \
   reinterpret_cast<_type>(reinterpret_cast<uintptr_t>(_current) + _stride)
@@ -234,7 +346,13 @@ bool SkinningJob::Validate() const {
 #define NEXT_P() \
   joint_indices = NEXT(const uint16_t*, joint_indices, _job.joint_indices_stride); \
   in_positions = NEXT(const float*, in_positions, _job.in_positions_stride); \
-  out_positions = NEXT(float*, out_positions, _job.out_positions_stride);
+  if (soa_positions) { \
+    ++out_positions_x; \
+    ++out_positions_y; \
+    ++out_positions_z; \
+  } else { \
+    out_positions = NEXT(float*, out_positions, _job.out_positions_stride); \
+  }
 
 #define NEXT_PN() \
   NEXT_P(); \
@@ -246,6 +364,11 @@ bool SkinningJob::Validate() const {
   in_tangents = NEXT(const float*, in_tangents, _job.in_tangents_stride); \
   out_tangents = NEXT(float*, out_tangents, _job.out_tangents_stride);
 
+// Reads influence _j joint index of the current vertex, remapped through
+// joint_remap if _Remap. The branch is compiled out.
+#define INDEX(_j) \
+  (_Remap ? joint_remap[joint_indices[_j]] : joint_indices[_j])
+
 // Implements weighted matrix preparation.
 // _INNER functions are intended to be used inside the vertex loop. They take
 // advantage of the fact that the buffers they are reading from contain enough
@@ -253,69 +376,69 @@ bool SkinningJob::Validate() const {
 // _OUTER functions restrict access to data that are sure to be readable from
 // the buffer.
 #define PREPARE_1_INNER(_it) \
-  const uint16_t i0 = joint_indices[0]; \
-  const math::Float4x4& transform = _job.joint_matrices[i0]; \
+  const uint16_t i0 = INDEX(0); \
+  const _Matrix& transform = _matrices[i0]; \
   PREPARE_##_it##_1()
 
 #define PREPARE_1_OUTER(_it) \
   PREPARE_1_INNER(_it)
 
 #define PREPARE_NOIT() \
-  const math::Float4x4& it_transform = transform; \
+  const _Matrix& it_transform = transform; \
   (void)it_transform;
 
 #define PREPARE_NOIT_1() \
   PREPARE_NOIT()
 
 #define PREPARE_IT_1() \
-  const math::Float4x4& it_transform = _job.joint_inverse_transpose_matrices[i0];
+  const _Matrix& it_transform = _it_matrices[i0];
 
 #define PREPARE_2_INNER(_it) \
   const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
-  const math::Float4x4& m0 = _job.joint_matrices[i0]; \
-  const math::Float4x4& m1 = _job.joint_matrices[i1]; \
+  const uint16_t i0 = INDEX(0); \
+  const uint16_t i1 = INDEX(1); \
+  const _Matrix& m0 = _matrices[i0]; \
+  const _Matrix& m1 = _matrices[i1]; \
   const math::SimdFloat4 w1 = one - w0; \
-  const math::Float4x4 transform = math::ColumnMultiply(m0, w0) + \
-                                   math::ColumnMultiply(m1, w1); \
+  const _Matrix transform = WeightMatrix(m0, w0) + \
+                                   WeightMatrix(m1, w1); \
   PREPARE_##_it##_2()
 
 #define PREPARE_NOIT_2() \
   PREPARE_NOIT()
 
 #define PREPARE_IT_2() \
-  const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
-  const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
-  const math::Float4x4 it_transform = math::ColumnMultiply(mit0, w0) + \
-                                      math::ColumnMultiply(mit1, w1);
+  const _Matrix& mit0 = _it_matrices[i0]; \
+  const _Matrix& mit1 = _it_matrices[i1]; \
+  const _Matrix it_transform = WeightMatrix(mit0, w0) + \
+                                      WeightMatrix(mit1, w1);
 
 #define PREPARE_2_OUTER(_it) \
   PREPARE_2_INNER(_it)
 
 #define PREPARE_3_CONCAT(_it) \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
-  const uint16_t i2 = joint_indices[2]; \
-  const math::Float4x4& m0 = _job.joint_matrices[i0]; \
-  const math::Float4x4& m1 = _job.joint_matrices[i1]; \
-  const math::Float4x4& m2 = _job.joint_matrices[i2]; \
+  const uint16_t i0 = INDEX(0); \
+  const uint16_t i1 = INDEX(1); \
+  const uint16_t i2 = INDEX(2); \
+  const _Matrix& m0 = _matrices[i0]; \
+  const _Matrix& m1 = _matrices[i1]; \
+  const _Matrix& m2 = _matrices[i2]; \
   const math::SimdFloat4 w2 = one - (w0 + w1); \
-  const math::Float4x4 transform = math::ColumnMultiply(m0, w0) + \
-                                   math::ColumnMultiply(m1, w1) + \
-                                   math::ColumnMultiply(m2, w2); \
+  const _Matrix transform = WeightMatrix(m0, w0) + \
+                                   WeightMatrix(m1, w1) + \
+                                   WeightMatrix(m2, w2); \
   PREPARE_##_it##_3()
 
 #define PREPARE_NOIT_3() \
   PREPARE_NOIT()
 
 #define PREPARE_IT_3() \
-  const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
-  const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
-  const math::Float4x4& mit2 = _job.joint_inverse_transpose_matrices[i2]; \
-  const math::Float4x4 it_transform = math::ColumnMultiply(mit0, w0) + \
-                                      math::ColumnMultiply(mit1, w1) + \
-                                      math::ColumnMultiply(mit2, w2); \
+  const _Matrix& mit0 = _it_matrices[i0]; \
+  const _Matrix& mit1 = _it_matrices[i1]; \
+  const _Matrix& mit2 = _it_matrices[i2]; \
+  const _Matrix it_transform = WeightMatrix(mit0, w0) + \
+                                      WeightMatrix(mit1, w1) + \
+                                      WeightMatrix(mit2, w2); \
 
 #define PREPARE_3_INNER(_it) \
   const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
@@ -329,33 +452,33 @@ bool SkinningJob::Validate() const {
   PREPARE_3_CONCAT(_it)
 
 #define PREPARE_4_CONCAT(_it) \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
-  const uint16_t i2 = joint_indices[2]; \
-  const uint16_t i3 = joint_indices[3]; \
-  const math::Float4x4& m0 = _job.joint_matrices[i0]; \
-  const math::Float4x4& m1 = _job.joint_matrices[i1]; \
-  const math::Float4x4& m2 = _job.joint_matrices[i2]; \
-  const math::Float4x4& m3 = _job.joint_matrices[i3]; \
+  const uint16_t i0 = INDEX(0); \
+  const uint16_t i1 = INDEX(1); \
+  const uint16_t i2 = INDEX(2); \
+  const uint16_t i3 = INDEX(3); \
+  const _Matrix& m0 = _matrices[i0]; \
+  const _Matrix& m1 = _matrices[i1]; \
+  const _Matrix& m2 = _matrices[i2]; \
+  const _Matrix& m3 = _matrices[i3]; \
   const math::SimdFloat4 w3 = one - (w0 + w1 + w2); \
-  const math::Float4x4 transform = math::ColumnMultiply(m0, w0) + \
-                                   math::ColumnMultiply(m1, w1) + \
-                                   math::ColumnMultiply(m2, w2) + \
-                                   math::ColumnMultiply(m3, w3); \
+  const _Matrix transform = WeightMatrix(m0, w0) + \
+                                   WeightMatrix(m1, w1) + \
+                                   WeightMatrix(m2, w2) + \
+                                   WeightMatrix(m3, w3); \
   PREPARE_##_it##_4()
 
 #define PREPARE_NOIT_4() \
   PREPARE_NOIT()
 
 #define PREPARE_IT_4() \
-  const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
-  const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
-  const math::Float4x4& mit2 = _job.joint_inverse_transpose_matrices[i2]; \
-  const math::Float4x4& mit3 = _job.joint_inverse_transpose_matrices[i3]; \
-  const math::Float4x4 it_transform = math::ColumnMultiply(mit0, w0) + \
-                                      math::ColumnMultiply(mit1, w1) + \
-                                      math::ColumnMultiply(mit2, w2) + \
-                                      math::ColumnMultiply(mit3, w3); \
+  const _Matrix& mit0 = _it_matrices[i0]; \
+  const _Matrix& mit1 = _it_matrices[i1]; \
+  const _Matrix& mit2 = _it_matrices[i2]; \
+  const _Matrix& mit3 = _it_matrices[i3]; \
+  const _Matrix it_transform = WeightMatrix(mit0, w0) + \
+                                      WeightMatrix(mit1, w1) + \
+                                      WeightMatrix(mit2, w2) + \
+                                      WeightMatrix(mit3, w3); \
 
 #define PREPARE_4_INNER(_it) \
   const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
@@ -372,42 +495,42 @@ bool SkinningJob::Validate() const {
 
 #define PREPARE_NOIT_N() \
   math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  math::Float4x4 transform = \
-    math::ColumnMultiply(_job.joint_matrices[joint_indices[0]], wsum); \
+  _Matrix transform = \
+    WeightMatrix(_matrices[INDEX(0)], wsum); \
   const int last = _job.influences_count - 1; \
   for (int j = 1; j < last; ++j) { \
     const math::SimdFloat4 w = math::simd_float4::Load1PtrU(joint_weights + j); \
     wsum = wsum + w; \
     transform = transform + \
-      math::ColumnMultiply(_job.joint_matrices[joint_indices[j]], w); \
+      WeightMatrix(_matrices[INDEX(j)], w); \
   } \
   transform = transform + \
-    math::ColumnMultiply(_job.joint_matrices[joint_indices[last]], one - wsum); \
+    WeightMatrix(_matrices[INDEX(last)], one - wsum); \
   PREPARE_NOIT()
 
 #define PREPARE_IT_N() \
   math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const uint16_t i0 = joint_indices[0]; \
-  math::Float4x4 transform = \
-    math::ColumnMultiply(_job.joint_matrices[i0], wsum); \
-  math::Float4x4 it_transform = \
-    math::ColumnMultiply(_job.joint_inverse_transpose_matrices[i0], wsum); \
+  const uint16_t i0 = INDEX(0); \
+  _Matrix transform = \
+    WeightMatrix(_matrices[i0], wsum); \
+  _Matrix it_transform = \
+    WeightMatrix(_it_matrices[i0], wsum); \
   const int last = _job.influences_count - 1; \
   for (int j = 1; j < last; ++j) { \
-    const uint16_t ij = joint_indices[j]; \
+    const uint16_t ij = INDEX(j); \
     const math::SimdFloat4 w = math::simd_float4::Load1PtrU(joint_weights + j); \
     wsum = wsum + w; \
     transform = transform + \
-      math::ColumnMultiply(_job.joint_matrices[ij], w); \
+      WeightMatrix(_matrices[ij], w); \
     it_transform = it_transform + \
-      math::ColumnMultiply(_job.joint_inverse_transpose_matrices[ij], w); \
+      WeightMatrix(_it_matrices[ij], w); \
   } \
   const math::SimdFloat4 wlast = one - wsum; \
-  const int ilast = joint_indices[last]; \
+  const int ilast = INDEX(last); \
   transform = transform + \
-    math::ColumnMultiply(_job.joint_matrices[ilast], wlast); \
+    WeightMatrix(_matrices[ilast], wlast); \
   it_transform = it_transform + \
-    math::ColumnMultiply(_job.joint_inverse_transpose_matrices[ilast], wlast);
+    WeightMatrix(_it_matrices[ilast], wlast);
 
 #define PREPARE_N_INNER(_it) \
   PREPARE_##_it##_N()
@@ -415,40 +538,57 @@ bool SkinningJob::Validate() const {
 #define PREPARE_N_OUTER(_it) \
   PREPARE_##_it##_N()
 
+// Stores transformed position out_p, either to strided xyz floats or to
+// separate x, y and z arrays. The layout is invariant for the whole loop, so
+// the branch is always predicted. It isn't a template parameter to limit the
+// number of kernel instantiations.
+#define STORE_P() \
+  if (soa_positions) { \
+    math::Store1PtrU(out_p, out_positions_x); \
+    math::Store1PtrU(math::SplatY(out_p), out_positions_y); \
+    math::Store1PtrU(math::SplatZ(out_p), out_positions_z); \
+  } else { \
+    math::Store3PtrU(out_p, out_positions); \
+  }
+
 // Implement point and vector transformation. _INNER and _OUTER have the same
 // meaning as defined for the PREPARE functions.
 #define TRANSFORM_P_INNER() \
   const math::SimdFloat4 in_p = math::simd_float4::LoadPtrU(in_positions); \
   const math::SimdFloat4 out_p = TransformPoint(transform, in_p); \
-  math::Store3PtrU(out_p, out_positions);
+  STORE_P()
 
 #define TRANSFORM_PN_INNER() \
   TRANSFORM_P_INNER(); \
   const math::SimdFloat4 in_n = math::simd_float4::LoadPtrU(in_normals); \
-  const math::SimdFloat4 out_n = TransformVector(it_transform, in_n); \
+  const math::SimdFloat4 out_n = \
+    NormalizeVector<_Normalization>(TransformVector(it_transform, in_n)); \
   math::Store3PtrU(out_n, out_normals);
 
 #define TRANSFORM_PNT_INNER() \
   TRANSFORM_PN_INNER(); \
   const math::SimdFloat4 in_t = math::simd_float4::LoadPtrU(in_tangents); \
-  const math::SimdFloat4 out_t = TransformVector(it_transform, in_t); \
+  const math::SimdFloat4 out_t = \
+    NormalizeVector<_Normalization>(TransformVector(it_transform, in_t)); \
   math::Store3PtrU(out_t, out_tangents);
 
 #define TRANSFORM_P_OUTER() \
   const math::SimdFloat4 in_p = math::simd_float4::Load3PtrU(in_positions); \
   const math::SimdFloat4 out_p = TransformPoint(transform, in_p); \
-  math::Store3PtrU(out_p, out_positions);
+  STORE_P()
 
 #define TRANSFORM_PN_OUTER() \
   TRANSFORM_P_OUTER(); \
   const math::SimdFloat4 in_n = math::simd_float4::Load3PtrU(in_normals); \
-  const math::SimdFloat4 out_n = TransformVector(it_transform, in_n); \
+  const math::SimdFloat4 out_n = \
+    NormalizeVector<_Normalization>(TransformVector(it_transform, in_n)); \
   math::Store3PtrU(out_n, out_normals);
 
 #define TRANSFORM_PNT_OUTER() \
   TRANSFORM_PN_OUTER(); \
   const math::SimdFloat4 in_t = math::simd_float4::Load3PtrU(in_tangents); \
-  const math::SimdFloat4 out_t = TransformVector(it_transform, in_t); \
+  const math::SimdFloat4 out_t = \
+    NormalizeVector<_Normalization>(TransformVector(it_transform, in_t)); \
   math::Store3PtrU(out_t, out_tangents);
 
 // Instantiates all skinning function variants.
@@ -480,50 +620,246 @@ SKINNING_FN(PNT, IT, N)
 
 // Defines a matrix of skinning function pointers. This matrix will then be
 // indexed according to skinning jobs parameters.
-typedef void (*SkiningFct)(const SkinningJob&);
-static const SkiningFct kSkinningFct[2][5][3] = {
+template <typename _Matrix, bool _Bounds,
+          SkinningJob::Normalization _Normalization, bool _Remap>
+struct SkinningFct {
+  typedef void (*Fct)(const SkinningJob&, const _Matrix*, const _Matrix*);
+  static const Fct kFct[2][5][3];
+};
+
+template <typename _Matrix, bool _Bounds,
+          SkinningJob::Normalization _Normalization, bool _Remap>
+const typename SkinningFct<_Matrix, _Bounds, _Normalization, _Remap>::Fct
+  SkinningFct<_Matrix, _Bounds, _Normalization, _Remap>::kFct[2][5][3] = {
   {
-    {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, NOIT, 1), &SKINNING_FN_NAME(PNT, NOIT, 1)},
-    {&SKINNING_FN_NAME(P, NOIT, 2), &SKINNING_FN_NAME(PN, NOIT, 2), &SKINNING_FN_NAME(PNT, NOIT, 2)},
-    {&SKINNING_FN_NAME(P, NOIT, 3), &SKINNING_FN_NAME(PN, NOIT, 3), &SKINNING_FN_NAME(PNT, NOIT, 3)},
-    {&SKINNING_FN_NAME(P, NOIT, 4), &SKINNING_FN_NAME(PN, NOIT, 4), &SKINNING_FN_NAME(PNT, NOIT, 4)},
-    {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, NOIT, N), &SKINNING_FN_NAME(PNT, NOIT, N)},
+    {&SKINNING_FN_NAME(P, NOIT, 1)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, NOIT, 1)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, NOIT, 1)<_Matrix, _Bounds, _Normalization, _Remap>},
+    {&SKINNING_FN_NAME(P, NOIT, 2)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, NOIT, 2)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, NOIT, 2)<_Matrix, _Bounds, _Normalization, _Remap>},
+    {&SKINNING_FN_NAME(P, NOIT, 3)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, NOIT, 3)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, NOIT, 3)<_Matrix, _Bounds, _Normalization, _Remap>},
+    {&SKINNING_FN_NAME(P, NOIT, 4)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, NOIT, 4)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, NOIT, 4)<_Matrix, _Bounds, _Normalization, _Remap>},
+    {&SKINNING_FN_NAME(P, NOIT, N)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, NOIT, N)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, NOIT, N)<_Matrix, _Bounds, _Normalization, _Remap>},
   },
   {
-    {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, IT, 1), &SKINNING_FN_NAME(PNT, IT, 1)},
-    {&SKINNING_FN_NAME(P, NOIT, 2), &SKINNING_FN_NAME(PN, IT, 2), &SKINNING_FN_NAME(PNT, IT, 2)},
-    {&SKINNING_FN_NAME(P, NOIT, 3), &SKINNING_FN_NAME(PN, IT, 3), &SKINNING_FN_NAME(PNT, IT, 3)},
-    {&SKINNING_FN_NAME(P, NOIT, 4), &SKINNING_FN_NAME(PN, IT, 4), &SKINNING_FN_NAME(PNT, IT, 4)},
-    {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, IT, N), &SKINNING_FN_NAME(PNT, IT, N)},
+    {&SKINNING_FN_NAME(P, NOIT, 1)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, IT, 1)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, IT, 1)<_Matrix, _Bounds, _Normalization, _Remap>},
+    {&SKINNING_FN_NAME(P, NOIT, 2)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, IT, 2)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, IT, 2)<_Matrix, _Bounds, _Normalization, _Remap>},
+    {&SKINNING_FN_NAME(P, NOIT, 3)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, IT, 3)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, IT, 3)<_Matrix, _Bounds, _Normalization, _Remap>},
+    {&SKINNING_FN_NAME(P, NOIT, 4)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, IT, 4)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, IT, 4)<_Matrix, _Bounds, _Normalization, _Remap>},
+    {&SKINNING_FN_NAME(P, NOIT, N)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PN, IT, N)<_Matrix, _Bounds, _Normalization, _Remap>, &SKINNING_FN_NAME(PNT, IT, N)<_Matrix, _Bounds, _Normalization, _Remap>},
   }
 };
 
+// Selects the skinning function variant matching _job normalization mode, from
+// tables indices _it, _inf and _fct.
+template <typename _Matrix, bool _Bounds, bool _Remap>
+typename SkinningFct<_Matrix, _Bounds, SkinningJob::kNoNormalization,
+                     _Remap>::Fct
+  SelectSkinningFct(const SkinningJob& _job,
+                    size_t _it, size_t _inf, size_t _fct) {
+  switch (_job.normalization) {
+    case SkinningJob::kNormalizeEst:
+      return SkinningFct<_Matrix, _Bounds, SkinningJob::kNormalizeEst,
+                         _Remap>::kFct[_it][_inf][_fct];
+    case SkinningJob::kNormalize:
+      return SkinningFct<_Matrix, _Bounds, SkinningJob::kNormalize,
+                         _Remap>::kFct[_it][_inf][_fct];
+    default:
+      return SkinningFct<_Matrix, _Bounds, SkinningJob::kNoNormalization,
+                         _Remap>::kFct[_it][_inf][_fct];
+  }
+}
+
+// Selects and calls the skinning function variant matching _job parameters,
+// for joint matrices of type _Matrix.
+template <typename _Matrix>
+void RunSkinning(const SkinningJob& _job,
+                 const _Matrix* _matrices,
+                 const _Matrix* _it_matrices) {
+  typedef SkinningFct<_Matrix, false, SkinningJob::kNoNormalization, false>
+    Fct;
+
+  // Find skinning function index.
+  const size_t it = _it_matrices != NULL;
+  assert(it < OZZ_ARRAY_SIZE(Fct::kFct));
+  const size_t inf =
+    static_cast<size_t>(_job.influences_count) > OZZ_ARRAY_SIZE(Fct::kFct[0]) ?
+      OZZ_ARRAY_SIZE(Fct::kFct[0]) -1 : _job.influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(Fct::kFct[0]));
+  const size_t fct =
+    (_job.in_normals.begin != NULL) + (_job.in_tangents.begin != NULL);
+  assert(fct < OZZ_ARRAY_SIZE(Fct::kFct[0][0]));
+
+  // Selects function variant, with bounds accumulation and joint indices
+  // remapping if requested.
+  typename Fct::Fct fn;
+  if (_job.joint_remap.begin) {
+    fn = _job.out_bounds ?
+      SelectSkinningFct<_Matrix, true, true>(_job, it, inf, fct) :
+      SelectSkinningFct<_Matrix, false, true>(_job, it, inf, fct);
+  } else {
+    fn = _job.out_bounds ?
+      SelectSkinningFct<_Matrix, true, false>(_job, it, inf, fct) :
+      SelectSkinningFct<_Matrix, false, false>(_job, it, inf, fct);
+  }
+
+  // Calls skinning function. Cannot fail because job is valid.
+  fn(_job, _matrices, _it_matrices);
+
+#ifdef OZZ_HAS_STATS
+  OZZ_STATIC_ASSERT(SkinningJob::Stats::kMaxKernelInfluences ==
+                    OZZ_ARRAY_SIZE(Fct::kFct[0]));
+  OZZ_STATIC_ASSERT(SkinningJob::Stats::kNumComponentKernels ==
+                    OZZ_ARRAY_SIZE(Fct::kFct[0][0]));
+  if (_job.stats) {
+    _job.stats->vertices[inf][fct] += _job.vertex_count;
+  }
+#endif  // OZZ_HAS_STATS
+}
+
+namespace {
+// Dispatches valid job _job to the skinning function variant matching its
+// parameters.
+void Skin(const SkinningJob& _job) {
+  // Early out if no vertex. This isn't an error.
+  // Skinning function algorithm doesn't support the case.
+  if (_job.vertex_count == 0) {
+    if (_job.out_bounds) {
+      *_job.out_bounds = math::Box();
+    }
+    return;
+  }
+
+  // Dispatches to the joint matrices type.
+  if (_job.joint_matrices.begin != NULL) {
+    RunSkinning(_job,
+                _job.joint_matrices.begin,
+                _job.joint_inverse_transpose_matrices.begin);
+  } else {
+    RunSkinning(_job,
+                _job.joint_matrices_4x3.begin,
+                _job.joint_inverse_transpose_matrices_4x3.begin);
+  }
+}
+}  // namespace
+
 // Implements job Run function.
 bool SkinningJob::Run() const {
+  OZZ_PROFILE_SCOPE("SkinningJob::Run");
   // Exit with an error if job is invalid.
   if (!Validate()) {
     return false;
   }
 
-  // Early out if no vertex. This isn't an error.
-  // Skinning function algorithm doesn't support the case.
-  if (vertex_count == 0) {
-    return true;
+  Skin(*this);
+
+  return true;
+}
+
+BatchSkinningJob::BatchSkinningJob()
+    : normalization(SkinningJob::kNoNormalization),
+      dispatcher(NULL) {
+}
+
+BatchSkinningJob::Part::Part()
+    : vertex_count(0),
+      influences_count(0),
+      joint_indices_stride(0),
+      joint_weights_stride(0),
+      in_positions_stride(0),
+      in_normals_stride(0),
+      in_tangents_stride(0),
+      out_positions_stride(0),
+      out_normals_stride(0),
+      out_tangents_stride(0),
+      out_bounds(NULL) {
+}
+
+namespace {
+// Builds the SkinningJob that skins _part with _batch shared parameters.
+SkinningJob PartJob(const BatchSkinningJob& _batch,
+                    const BatchSkinningJob::Part& _part) {
+  SkinningJob job;
+  job.joint_matrices = _batch.joint_matrices;
+  job.joint_inverse_transpose_matrices =
+    _batch.joint_inverse_transpose_matrices;
+  job.joint_matrices_4x3 = _batch.joint_matrices_4x3;
+  job.joint_inverse_transpose_matrices_4x3 =
+    _batch.joint_inverse_transpose_matrices_4x3;
+  job.normalization = _batch.normalization;
+  job.vertex_count = _part.vertex_count;
+  job.influences_count = _part.influences_count;
+  job.joint_indices = _part.joint_indices;
+  job.joint_indices_stride = _part.joint_indices_stride;
+  job.joint_remap = _part.joint_remap;
+  job.joint_weights = _part.joint_weights;
+  job.joint_weights_stride = _part.joint_weights_stride;
+  job.in_positions = _part.in_positions;
+  job.in_positions_stride = _part.in_positions_stride;
+  job.in_normals = _part.in_normals;
+  job.in_normals_stride = _part.in_normals_stride;
+  job.in_tangents = _part.in_tangents;
+  job.in_tangents_stride = _part.in_tangents_stride;
+  job.out_positions = _part.out_positions;
+  job.out_positions_stride = _part.out_positions_stride;
+  job.out_normals = _part.out_normals;
+  job.out_normals_stride = _part.out_normals_stride;
+  job.out_tangents = _part.out_tangents;
+  job.out_tangents_stride = _part.out_tangents_stride;
+  job.out_bounds = _part.out_bounds;
+  return job;
+}
+
+// Implements the task that processes every part as a work item.
+class PartTask : public tasks::Task {
+ public:
+  explicit PartTask(const BatchSkinningJob& _batch)
+    : batch_(_batch) {
   }
 
-  // Find skinning function index.
-  const size_t it = joint_inverse_transpose_matrices.begin != NULL;
-  assert(it < OZZ_ARRAY_SIZE(kSkinningFct));
-  const size_t inf =
-    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSkinningFct[0]) ?
-      OZZ_ARRAY_SIZE(kSkinningFct[0]) -1 : influences_count - 1;
-  assert(inf < OZZ_ARRAY_SIZE(kSkinningFct[0]));
-  const size_t fct = (in_normals.begin != NULL) + (in_tangents.begin != NULL);
-  assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0][0]));
+  virtual void Run(int _index) const {
+    Skin(PartJob(batch_, batch_.parts.begin[_index]));
+  }
 
-  // Calls skinning function. Cannot fail because job is valid.
-  kSkinningFct[it][inf][fct](*this);
+ private:
+  // Disables assignment operators.
+  PartTask(const PartTask&);
+  void operator = (const PartTask&);
+
+  const BatchSkinningJob& batch_;
+};
+}  // namespace
+
+bool BatchSkinningJob::Validate() const {
+  bool valid = true;
+
+  // Checks parts range, an empty batch is valid.
+  if (parts.begin) {
+    valid &= parts.end >= parts.begin;
+  } else {
+    valid &= parts.end == NULL;
+  }
+
+  // Checks every part, along with shared parameters.
+  for (const Part* part = parts.begin; valid && part < parts.end; ++part) {
+    valid &= PartJob(*this, *part).Validate();
+  }
+
+  return valid;
+}
 
+bool BatchSkinningJob::Run() const {
+  OZZ_PROFILE_SCOPE("BatchSkinningJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int count = static_cast<int>(parts.Count());
+  if (dispatcher && count > 1) {
+    const PartTask task(*this);
+    dispatcher->Dispatch(task, count);
+  } else {
+    for (const Part* part = parts.begin; part < parts.end; ++part) {
+      Skin(PartJob(*this, *part));
+    }
+  }
   return true;
 }
 }  // geometry
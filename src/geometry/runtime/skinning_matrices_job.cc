@@ -0,0 +1,107 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/skinning_matrices_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+SkinningMatricesJob::SkinningMatricesJob() {
+}
+
+bool SkinningMatricesJob::Validate() const {
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks inputs.
+  valid &= model_matrices.begin != NULL;
+  valid &= inverse_bind_poses.begin != NULL;
+  const size_t num_entries = inverse_bind_poses.Count();
+
+  // Checks remaps, which must all refer to a model matrix.
+  if (joint_remaps.begin) {
+    valid &= joint_remaps.Count() == num_entries;
+    const size_t num_joints = model_matrices.Count();
+    for (const uint16_t* it = joint_remaps.begin; it < joint_remaps.end; ++it) {
+      valid &= *it < num_joints;
+    }
+  } else {
+    valid &= model_matrices.Count() >= num_entries;
+  }
+
+  // Checks outputs.
+  valid &= skinning_matrices.begin != NULL;
+  valid &= skinning_matrices.Count() >= num_entries;
+  if (inverse_transpose_matrices.begin) {
+    valid &= inverse_transpose_matrices.Count() >= num_entries;
+  }
+
+  return valid;
+}
+
+bool SkinningMatricesJob::Run() const {
+  OZZ_PROFILE_SCOPE("SkinningMatricesJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_entries = static_cast<int>(inverse_bind_poses.Count());
+  const math::Float4x4* models = model_matrices.begin;
+  const math::Float4x4* inverse_binds = inverse_bind_poses.begin;
+  const uint16_t* remaps = joint_remaps.begin;
+  math::Float4x4* skinning = skinning_matrices.begin;
+  math::Float4x4* inverse_transposes = inverse_transpose_matrices.begin;
+
+  if (inverse_transposes) {
+    for (int i = 0; i < num_entries; ++i) {
+      const int joint = remaps ? remaps[i] : i;
+      const math::Float4x4 matrix = models[joint] * inverse_binds[i];
+      skinning[i] = matrix;
+      inverse_transposes[i] = Transpose(Invert(matrix));
+    }
+  } else if (remaps) {
+    for (int i = 0; i < num_entries; ++i) {
+      skinning[i] = models[remaps[i]] * inverse_binds[i];
+    }
+  } else {
+    for (int i = 0; i < num_entries; ++i) {
+      skinning[i] = models[i] * inverse_binds[i];
+    }
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
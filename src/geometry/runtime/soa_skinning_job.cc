@@ -0,0 +1,409 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/soa_skinning_job.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_float8.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+SoaSkinningJob::SoaSkinningJob()
+ : vertex_count(0),
+   influences_count(0),
+   joint_indices_stride(0),
+   joint_weights_stride(0) {
+}
+
+namespace {
+
+// Validates that all the components of the stream _s can store _count floats.
+template <typename _Stream>
+bool ValidateStream(const _Stream& _s, int _count) {
+  const size_t size = sizeof(float) * _count;
+  bool valid = true;
+  valid &= _s.x.begin != NULL && _s.x.Size() >= size;
+  valid &= _s.y.begin != NULL && _s.y.Size() >= size;
+  valid &= _s.z.begin != NULL && _s.z.Size() >= size;
+  return valid;
+}
+
+// Tests if any component of the stream _s is set.
+template <typename _Stream>
+bool IsStreamSet(const _Stream& _s) {
+  return _s.x.begin != NULL || _s.y.begin != NULL || _s.z.begin != NULL;
+}
+}  // namespace
+
+bool SoaSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks influences bounds.
+  valid &= influences_count > 0;
+
+  // Checks vertex count.
+  valid &= vertex_count >= 0;
+
+  // Checks joints matrices, required.
+  valid &= joint_matrices.begin != NULL;
+  valid &= joint_matrices.end >= joint_matrices.begin;
+
+  // Checks optional inverse transpose matrices.
+  if (joint_inverse_transpose_matrices.begin) {
+    valid &= joint_inverse_transpose_matrices.end >=
+             joint_inverse_transpose_matrices.begin;
+  }
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks indices, required.
+  valid &= joint_indices.begin != NULL;
+  valid &= joint_indices.Size() >=
+    joint_indices_stride * vertex_count_minus_1 +
+    sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count != 1) {
+    valid &= joint_weights.begin != NULL;
+    valid &= joint_weights.Size() >=
+      joint_weights_stride * vertex_count_minus_1 +
+      sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+  }
+
+  // Checks positions, mandatory.
+  valid &= ValidateStream(in_positions, vertex_count);
+  valid &= ValidateStream(out_positions, vertex_count);
+
+  // Checks normals, optional.
+  if (IsStreamSet(in_normals)) {
+    valid &= ValidateStream(in_normals, vertex_count);
+    valid &= ValidateStream(out_normals, vertex_count);
+
+    // Checks tangents, optional but requires normals.
+    if (IsStreamSet(in_tangents)) {
+      valid &= ValidateStream(in_tangents, vertex_count);
+      valid &= ValidateStream(out_tangents, vertex_count);
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= !IsStreamSet(in_tangents);
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Skinning kernels transform kWidth vertices at once, each SIMD lane
+// processing a different vertex. Joint matrices are thus transposed to soa
+// matrices, stored as 12 SIMD vectors: soa[c * 3 + r] stores the r-th row of
+// the c-th column of all lanes matrices. The last row (w) isn't needed for
+// affine transformations.
+
+// Implements 4 lanes operations using SimdFloat4.
+struct Lanes4 {
+  typedef math::SimdFloat4 Simd;
+  enum {
+    kWidth = 4
+  };
+
+  static Simd zero() { return math::simd_float4::zero(); }
+  static Simd one() { return math::simd_float4::one(); }
+  static Simd Load(const float* _f) {
+    return math::simd_float4::LoadPtrU(_f);
+  }
+  static void Store(const Simd& _v, float* _f) {
+    math::StorePtrU(_v, _f);
+  }
+
+  // Gathers the _j-th float of every lane.
+  static Simd Gather(const float* const* _f, int _j) {
+    return math::simd_float4::Load(_f[0][_j], _f[1][_j], _f[2][_j], _f[3][_j]);
+  }
+
+  // Transposes the 4 lanes matrices _m to soa matrix _soa.
+  static void GatherMatrix(const math::Float4x4* const* _m, Simd _soa[12]) {
+    for (int c = 0; c < 4; ++c) {
+      const math::SimdFloat4 cols[4] = {
+        _m[0]->cols[c], _m[1]->cols[c], _m[2]->cols[c], _m[3]->cols[c]};
+      math::Transpose4x3(cols, _soa + c * 3);
+    }
+  }
+
+  // Broadcasts matrix _m to all lanes of soa matrix _soa.
+  static void SplatMatrix(const math::Float4x4& _m, Simd _soa[12]) {
+    for (int c = 0; c < 4; ++c) {
+      _soa[c * 3 + 0] = math::SplatX(_m.cols[c]);
+      _soa[c * 3 + 1] = math::SplatY(_m.cols[c]);
+      _soa[c * 3 + 2] = math::SplatZ(_m.cols[c]);
+    }
+  }
+};
+
+#if defined(OZZ_HAS_AVX)
+// Implements 8 lanes operations using SimdFloat8. Gathering is done as two
+// 4 lanes gathers.
+struct Lanes8 {
+  typedef math::SimdFloat8 Simd;
+  enum {
+    kWidth = 8
+  };
+
+  static Simd zero() { return math::simd_float8::zero(); }
+  static Simd one() { return math::simd_float8::one(); }
+  static Simd Load(const float* _f) {
+    return math::simd_float8::LoadPtrU(_f);
+  }
+  static void Store(const Simd& _v, float* _f) {
+    math::StorePtrU(_v, _f);
+  }
+  static Simd Gather(const float* const* _f, int _j) {
+    return math::simd_float8::Load(Lanes4::Gather(_f, _j),
+                                   Lanes4::Gather(_f + 4, _j));
+  }
+  static void GatherMatrix(const math::Float4x4* const* _m, Simd _soa[12]) {
+    math::SimdFloat4 lo[12];
+    math::SimdFloat4 hi[12];
+    Lanes4::GatherMatrix(_m, lo);
+    Lanes4::GatherMatrix(_m + 4, hi);
+    for (int i = 0; i < 12; ++i) {
+      _soa[i] = math::simd_float8::Load(lo[i], hi[i]);
+    }
+  }
+  static void SplatMatrix(const math::Float4x4& _m, Simd _soa[12]) {
+    math::SimdFloat4 splat[12];
+    Lanes4::SplatMatrix(_m, splat);
+    for (int i = 0; i < 12; ++i) {
+      _soa[i] = math::simd_float8::Load(splat[i], splat[i]);
+    }
+  }
+};
+#endif  // OZZ_HAS_AVX
+
+// Computes the weighted soa matrix of all lanes, from _matrices palette.
+// Matrices of a given influence are broadcasted rather than gathered if
+// all lanes share the same joint.
+template <typename _Lanes>
+void BlendMatrices(const SoaSkinningJob& _job,
+                   const math::Float4x4* _matrices,
+                   const uint16_t* const* _indices,
+                   const float* const* _weights,
+                   typename _Lanes::Simd _soa[12]) {
+  typedef typename _Lanes::Simd Simd;
+  const int last = _job.influences_count - 1;
+  Simd wsum = _Lanes::zero();
+  for (int j = 0; j <= last; ++j) {
+
+    // Finds joint matrices of every lane.
+    const math::Float4x4* matrices[_Lanes::kWidth];
+    bool shared = true;
+    for (int l = 0; l < _Lanes::kWidth; ++l) {
+      const uint16_t index = _indices[l][j];
+      shared &= index == _indices[0][j];
+      matrices[l] = _matrices + index;
+    }
+    Simd joint[12];
+    if (shared) {
+      _Lanes::SplatMatrix(*matrices[0], joint);
+    } else {
+      _Lanes::GatherMatrix(matrices, joint);
+    }
+
+    // Single influence doesn't need weighting.
+    if (last == 0) {
+      for (int i = 0; i < 12; ++i) {
+        _soa[i] = joint[i];
+      }
+      return;
+    }
+
+    // The weight of the last joint is restored, as the sum of the weights is 1.
+    Simd w;
+    if (j < last) {
+      w = _Lanes::Gather(_weights, j);
+      wsum = wsum + w;
+    } else {
+      w = _Lanes::one() - wsum;
+    }
+    if (j == 0) {
+      for (int i = 0; i < 12; ++i) {
+        _soa[i] = joint[i] * w;
+      }
+    } else {
+      for (int i = 0; i < 12; ++i) {
+        _soa[i] = math::MAdd(joint[i], w, _soa[i]);
+      }
+    }
+  }
+}
+
+// Implements pointer striding.
+template <typename _Ty>
+_Ty* Stride(_Ty* _begin, size_t _stride, int _count) {
+  return reinterpret_cast<_Ty*>(
+    reinterpret_cast<uintptr_t>(_begin) + _stride * _count);
+}
+
+// Skins kWidth vertices, starting from vertex _vertex. _in and _out contain
+// _attributes * 3 streams (x, y and z of positions, normals and tangents),
+// pointing to the first vertex of the group. Lanes beyond the last job vertex
+// reuse the last vertex indices and weights.
+template <typename _Lanes>
+void SkinGroup(const SoaSkinningJob& _job,
+               int _vertex,
+               int _attributes,
+               const float* const* _in,
+               float* const* _out) {
+  typedef typename _Lanes::Simd Simd;
+
+  // Finds indices and weights of every lane.
+  const uint16_t* indices[_Lanes::kWidth];
+  const float* weights[_Lanes::kWidth];
+  for (int l = 0; l < _Lanes::kWidth; ++l) {
+    const int vertex =
+      _vertex + l < _job.vertex_count ? _vertex + l : _job.vertex_count - 1;
+    indices[l] =
+      Stride(_job.joint_indices.begin, _job.joint_indices_stride, vertex);
+    weights[l] =
+      Stride(_job.joint_weights.begin, _job.joint_weights_stride, vertex);
+  }
+
+  // Prepares lanes matrices.
+  Simd transform[12];
+  BlendMatrices<_Lanes>(
+    _job, _job.joint_matrices.begin, indices, weights, transform);
+  Simd it_transform[12];
+  const bool it =
+    _attributes > 1 && _job.joint_inverse_transpose_matrices.begin != NULL;
+  if (it) {
+    BlendMatrices<_Lanes>(_job, _job.joint_inverse_transpose_matrices.begin,
+                          indices, weights, it_transform);
+  }
+
+  // Transforms positions, then normals and tangents.
+  for (int a = 0; a < _attributes; ++a) {
+    const Simd* m = a != 0 && it ? it_transform : transform;
+    const Simd x = _Lanes::Load(_in[a * 3 + 0]);
+    const Simd y = _Lanes::Load(_in[a * 3 + 1]);
+    const Simd z = _Lanes::Load(_in[a * 3 + 2]);
+    for (int r = 0; r < 3; ++r) {
+      const Simd t = a == 0 ? m[9 + r] : _Lanes::zero();
+      const Simd v = math::MAdd(
+        m[r], x, math::MAdd(m[3 + r], y, math::MAdd(m[6 + r], z, t)));
+      _Lanes::Store(v, _out[a * 3 + r]);
+    }
+  }
+}
+
+// Skins all the groups of kWidth vertices that fit in the job, starting from
+// vertex _vertex. Returns the first vertex that wasn't skinned.
+template <typename _Lanes>
+int SkinGroups(const SoaSkinningJob& _job,
+               int _vertex,
+               int _attributes,
+               const float* const* _in,
+               float* const* _out) {
+  const int streams = _attributes * 3;
+  for (; _vertex + _Lanes::kWidth <= _job.vertex_count;
+       _vertex += _Lanes::kWidth) {
+    const float* in[9];
+    float* out[9];
+    for (int s = 0; s < streams; ++s) {
+      in[s] = _in[s] + _vertex;
+      out[s] = _out[s] + _vertex;
+    }
+    SkinGroup<_Lanes>(_job, _vertex, _attributes, in, out);
+  }
+  return _vertex;
+}
+}  // namespace
+
+// Implements job Run function.
+bool SoaSkinningJob::Run() const {
+  OZZ_PROFILE_SCOPE("SoaSkinningJob::Run");
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Collects vertex streams.
+  const bool normals = in_normals.x.begin != NULL;
+  const bool tangents = in_tangents.x.begin != NULL;
+  const int attributes = 1 + normals + tangents;
+  const float* in[9] = {
+    in_positions.x.begin, in_positions.y.begin, in_positions.z.begin,
+    in_normals.x.begin, in_normals.y.begin, in_normals.z.begin,
+    in_tangents.x.begin, in_tangents.y.begin, in_tangents.z.begin};
+  float* out[9] = {
+    out_positions.x.begin, out_positions.y.begin, out_positions.z.begin,
+    out_normals.x.begin, out_normals.y.begin, out_normals.z.begin,
+    out_tangents.x.begin, out_tangents.y.begin, out_tangents.z.begin};
+
+  // Skins groups of vertices with the widest available SIMD lanes.
+  int vertex = 0;
+#if defined(OZZ_HAS_AVX)
+  vertex = SkinGroups<Lanes8>(*this, vertex, attributes, in, out);
+#endif  // OZZ_HAS_AVX
+  vertex = SkinGroups<Lanes4>(*this, vertex, attributes, in, out);
+
+  // Remaining vertices are copied to a local padded group, as streams can't be
+  // read nor written beyond vertex_count.
+  const int remaining = vertex_count - vertex;
+  if (remaining > 0) {
+    assert(remaining < Lanes4::kWidth);
+    const int streams = attributes * 3;
+    float in_pad[9][Lanes4::kWidth] = {{0.f}};
+    float out_pad[9][Lanes4::kWidth];
+    const float* in_group[9];
+    float* out_group[9];
+    for (int s = 0; s < streams; ++s) {
+      std::memcpy(in_pad[s], in[s] + vertex, remaining * sizeof(float));
+      in_group[s] = in_pad[s];
+      out_group[s] = out_pad[s];
+    }
+    SkinGroup<Lanes4>(*this, vertex, attributes, in_group, out_group);
+    for (int s = 0; s < streams; ++s) {
+      std::memcpy(out[s] + vertex, out_pad[s], remaining * sizeof(float));
+    }
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
@@ -0,0 +1,239 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/streamed_skinning_job.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+StreamedSkinningJob::StreamedSkinningJob()
+ : vertex_count(0),
+   influences_count(0),
+   joint_indices_stride(0),
+   joint_weights_stride(0),
+   in_positions_stride(0),
+   in_normals_stride(0),
+   in_tangents_stride(0) {
+}
+
+bool StreamedSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks influences bounds.
+  valid &= influences_count > 0;
+
+  // Checks joints matrices.
+  valid &= joint_matrices.begin != NULL;
+  valid &= joint_matrices.end >= joint_matrices.begin;
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks indices, required.
+  valid &= joint_indices.begin != NULL;
+  valid &= joint_indices.Size() >=
+    joint_indices_stride * vertex_count_minus_1 +
+    sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count != 1) {
+    valid &= joint_weights.begin != NULL;
+    valid &= joint_weights.Size() >=
+      joint_weights_stride * vertex_count_minus_1 +
+      sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.begin != NULL;
+  valid &= in_positions.Size() >=
+      in_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks normals and tangents, optional.
+  if (in_normals.begin) {
+    valid &= in_normals.Size() >=
+      in_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+    if (in_tangents.begin) {
+      valid &= in_tangents.Size() >=
+        in_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= in_tangents.begin == NULL;
+    valid &= in_tangents.end == NULL;
+  }
+
+  // Checks output vertices, which must be aligned for streaming stores.
+  valid &= out_vertices.begin != NULL;
+  valid &= (reinterpret_cast<uintptr_t>(out_vertices.begin) & 0xf) == 0;
+  valid &= out_vertices.Size() >= vertex_size() * vertex_count;
+
+  return valid;
+}
+
+namespace {
+// Implements pointer striding.
+template <typename _Ty>
+OZZ_INLINE _Ty* Next(_Ty* _current, size_t _stride) {
+  return reinterpret_cast<_Ty*>(
+    reinterpret_cast<uintptr_t>(_current) + _stride);
+}
+
+// Quantizes _f in range [-1,1] to a 16 bits signed normalized integer.
+OZZ_INLINE uint32_t QuantizeSnorm16(float _f) {
+  const float clamped = _f < -1.f ? -1.f : (_f > 1.f ? 1.f : _f);
+  const int quantized = static_cast<int>(
+    std::floor(clamped * 32767.f + .5f));
+  return static_cast<uint32_t>(quantized) & 0xffff;
+}
+
+// Packs vector _v as 2 octahedral encoded 16 bits signed normalized integers.
+OZZ_INLINE uint32_t PackOctahedral(math::_SimdFloat4 _v) {
+  float v[4];
+  math::StorePtrU(_v, v);
+  const float l1 = std::abs(v[0]) + std::abs(v[1]) + std::abs(v[2]);
+  float x = 0.f;
+  float y = 0.f;
+  if (l1 > 0.f) {
+    x = v[0] / l1;
+    y = v[1] / l1;
+    if (v[2] < 0.f) {  // Folds the lower hemisphere.
+      const float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+      const float fy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+      x = fx;
+      y = fy;
+    }
+  }
+  return QuantizeSnorm16(x) | (QuantizeSnorm16(y) << 16);
+}
+
+// Defines an output vertex, aligned for streaming stores.
+union Vertex {
+  math::SimdFloat4 simd[2];
+  float f[8];
+  uint32_t u[8];
+};
+
+// Skins all vertices of _job, streaming vertices made of _Normals and
+// _Tangents.
+template <bool _Normals, bool _Tangents>
+void Skin(const StreamedSkinningJob& _job) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::Float4x4* matrices = _job.joint_matrices.begin;
+  const uint16_t* joint_indices = _job.joint_indices.begin;
+  const float* joint_weights = _job.joint_weights.begin;
+  const float* in_positions = _job.in_positions.begin;
+  const float* in_normals = _job.in_normals.begin;
+  const float* in_tangents = _job.in_tangents.begin;
+  float* out = _job.out_vertices.begin;
+  const int last = _job.influences_count - 1;
+
+  Vertex vertex;
+  vertex.simd[1] = math::simd_float4::zero();
+  for (int i = 0; i < _job.vertex_count; ++i) {
+    // Blends joint matrices.
+    math::Float4x4 transform;
+    if (last == 0) {
+      transform = matrices[joint_indices[0]];
+    } else {
+      math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights);
+      transform = ColumnMultiply(matrices[joint_indices[0]], wsum);
+      for (int j = 1; j < last; ++j) {
+        const math::SimdFloat4 w =
+          math::simd_float4::Load1PtrU(joint_weights + j);
+        wsum = wsum + w;
+        transform = transform + ColumnMultiply(matrices[joint_indices[j]], w);
+      }
+      transform = transform +
+        ColumnMultiply(matrices[joint_indices[last]], one - wsum);
+      joint_weights = Next(joint_weights, _job.joint_weights_stride);
+    }
+    joint_indices = Next(joint_indices, _job.joint_indices_stride);
+
+    // Transforms and packs the vertex.
+    const math::SimdFloat4 in_p = math::simd_float4::Load3PtrU(in_positions);
+    math::StorePtr(math::SetW(TransformPoint(transform, in_p), 1.f),
+                   vertex.f);
+    in_positions = Next(in_positions, _job.in_positions_stride);
+    if (_Normals) {
+      const math::SimdFloat4 in_n = math::simd_float4::Load3PtrU(in_normals);
+      vertex.u[3] = PackOctahedral(TransformVector(transform, in_n));
+      in_normals = Next(in_normals, _job.in_normals_stride);
+    }
+    if (_Tangents) {
+      const math::SimdFloat4 in_t =
+        math::simd_float4::Load3PtrU(in_tangents);
+      vertex.u[4] = PackOctahedral(TransformVector(transform, in_t));
+      in_tangents = Next(in_tangents, _job.in_tangents_stride);
+    }
+
+    // Streams the full vertex.
+    math::StreamPtr(vertex.simd[0], out);
+    out += 4;
+    if (_Tangents) {
+      math::StreamPtr(vertex.simd[1], out);
+      out += 4;
+    }
+  }
+
+  // Makes streamed vertices visible.
+  math::StreamFence();
+}
+}  // namespace
+
+bool StreamedSkinningJob::Run() const {
+  OZZ_PROFILE_SCOPE("StreamedSkinningJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  if (in_tangents.begin) {
+    Skin<true, true>(*this);
+  } else if (in_normals.begin) {
+    Skin<true, false>(*this);
+  } else {
+    Skin<false, false>(*this);
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
@@ -37,7 +37,9 @@
 #include <cassert>
 #include <cctype>
 #include <cstring>
+#include <fstream>
 #include <new>
+#include <vector>
 
 namespace ozz {
 namespace options {
@@ -404,6 +406,8 @@ Parser::Parser()
                        &ValidateExclusiveOption),
       builtin_help_("help", "Displays help", false, false,
                     &ValidateExclusiveOption) {
+  std::fill(hash_table_, hash_table_ + kHashTableSize,
+            static_cast<Option*>(NULL));
   // Set default values.
   set_version(NULL);
   set_usage(NULL);
@@ -418,6 +422,131 @@ Parser::~Parser() {
   UnregisterOption(&builtin_help_);
 }
 
+namespace {
+// Sort required options first, and then based on their names.
+bool SortOptions(Option* _left, Option* _right) {
+  return (_left->required() && !_right->required()) ||
+         ( _left->required() == _right->required() &&
+           std::strcmp(_left->name(), _right->name()) < 0);
+}
+
+// Computes the case insensitive hash of [_begin,_end[ string, using FNV-1a.
+size_t HashName(const char* _begin, const char* _end) {
+  size_t hash = 2166136261u;
+  for (; _begin < _end; ++_begin) {
+    hash ^= static_cast<unsigned char>(
+      std::tolower(static_cast<unsigned char>(*_begin)));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Reads response file _filename arguments, and appends them to _storage. Each
+// argument is terminated by a '\0'. Arguments are separated by white spaces,
+// and can be grouped with double quotes.
+// Returns false if the file can't be read.
+bool ReadResponseFile(const char* _filename, std::string* _storage) {
+  std::ifstream file(_filename, std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  bool quoted = false;
+  bool argument = false;
+  for (char c; file.get(c);) {
+    if (c == '"') {
+      quoted = !quoted;
+      argument = true;  // Allows empty quoted arguments.
+    } else if (!quoted && std::isspace(static_cast<unsigned char>(c))) {
+      if (argument) {
+        _storage->push_back('\0');
+        argument = false;
+      }
+    } else {
+      _storage->push_back(c);
+      argument = true;
+    }
+  }
+  if (argument) {
+    _storage->push_back('\0');
+  }
+  return true;
+}
+
+// Outputs to _arguments all _argv arguments until the first "--" one, while
+// replacing "@file" arguments with the arguments of response file "file".
+// Response files arguments are stored in _storage, so _arguments remain valid
+// until _storage is modified.
+// Returns false if a response file can't be read.
+bool ExpandArguments(int _argc, const char* const* _argv,
+                     std::string* _storage,
+                     std::vector<const char*>* _arguments) {
+  // Reads all response files first, as _storage can reallocate.
+  _storage->clear();
+  std::vector<size_t> ends(_argc, 0);
+  int argc_trunc = 0;
+  for (; argc_trunc < _argc && std::strcmp(_argv[argc_trunc], "--") != 0;
+       ++argc_trunc) {
+    const char* argv = _argv[argc_trunc];
+    if (argv[0] == '@') {
+      if (!ReadResponseFile(argv + 1, _storage)) {
+        std::cout << "Failed to read response file:\"" << argv + 1 << "\"."
+          << std::endl;
+        return false;
+      }
+      ends[argc_trunc] = _storage->size();
+    }
+  }
+
+  // Outputs arguments.
+  size_t begin = 0;
+  for (int i = 0; i < argc_trunc; ++i) {
+    if (_argv[i][0] != '@') {
+      _arguments->push_back(_argv[i]);
+      continue;
+    }
+    while (begin < ends[i]) {
+      const char* argument = _storage->c_str() + begin;
+      _arguments->push_back(argument);
+      begin += std::strlen(argument) + 1;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+Option* Parser::FindOption(const char* _begin, const char* _end) const {
+  const size_t len = static_cast<size_t>(_end - _begin);
+  for (size_t i = HashName(_begin, _end);; ++i) {
+    Option* option = hash_table_[i & (kHashTableSize - 1)];
+    if (!option) {
+      return NULL;
+    }
+    const char* name = option->name();
+    if (StrNICmp(name, _begin, len) == 0 && name[len] == '\0') {
+      return option;
+    }
+  }
+}
+
+void Parser::HashOption(Option* _option) {
+  const char* name = _option->name();
+  for (size_t i = HashName(name, name + std::strlen(name));; ++i) {
+    Option*& slot = hash_table_[i & (kHashTableSize - 1)];
+    if (!slot) {
+      slot = _option;
+      return;
+    }
+  }
+}
+
+void Parser::RebuildHashTable() {
+  std::fill(hash_table_, hash_table_ + kHashTableSize,
+            static_cast<Option*>(NULL));
+  for (int i = 0; i < options_count_; ++i) {
+    HashOption(options_[i]);
+  }
+}
+
 ParseResult Parser::Parse(int _argc, const char* const* _argv) {
   if (_argc < 1 || !_argv) {
     return kExitFailure;
@@ -441,12 +570,13 @@ ParseResult Parser::Parse(int _argc, const char* const* _argv) {
   ++_argv;
   --_argc;
 
-  // Hides all arguments after a "--" argument, substitutes argc to argc_trunc.
-  int argc_trunc = 0;
-  for (;
-       argc_trunc < _argc && std::strcmp(_argv[argc_trunc], "--") != 0;
-       ++argc_trunc) {
+  // Hides all arguments after a "--" argument, and expands response files.
+  ParseResult result = kSuccess;
+  std::vector<const char*> arguments;
+  if (!ExpandArguments(_argc, _argv, &response_files_, &arguments)) {
+    result = kExitFailure;
   }
+  const int argc_trunc = static_cast<int>(arguments.size());
 
   // Restores built-in options to their default value in case parsing in done
   // multiple times.
@@ -454,22 +584,35 @@ ParseResult Parser::Parse(int _argc, const char* const* _argv) {
     options_[i]->RestoreDefault();
   }
 
-  // Iterates all arguments and all options.
-  ParseResult result = kSuccess;
-  for (int i = 0; i < argc_trunc; ++i) {
-    const char* argv = _argv[i];
-    int j = 0;
-    for (; j < options_count_; ++j) {
-      if (options_[j]->Parse(argv)) {
-        break;  // Also breaks if argument is duplicated.
+  // Iterates all arguments, and finds the option they refer to from the hash
+  // table.
+  for (int i = 0; i < argc_trunc && result == kSuccess; ++i) {
+    const char* argv = arguments[i];
+
+    // Extracts option name, after the "--" prefix and before '='.
+    const char* name = std::strncmp(argv, "--", 2) == 0 ? argv + 2 : NULL;
+    bool parsed = false;
+    if (name) {
+      const char* name_end = std::strchr(name, '=');
+      if (!name_end) {
+        name_end = name + std::strlen(name);
+      }
+      // Parsing fails if argument is duplicated.
+      Option* option = FindOption(name, name_end);
+      parsed = option && option->Parse(argv);
+
+      // Boolean options can also be prefixed with "no".
+      if (!parsed && name_end - name > 2 && StrNICmp(name, "no", 2) == 0) {
+        option = FindOption(name + 2, name_end);
+        parsed = option && option->Parse(argv);
       }
     }
+
     // An invalid (or duplicated) command line argument is a fatal failure.
-    if (j == options_count_) {
+    if (!parsed) {
       std::cout << "Invalid command line argument:\"" << argv << "\"."
         << std::endl;
       result = kExitFailure;
-      break;
     }
   }
 
@@ -512,6 +655,10 @@ ParseResult Parser::Parse(int _argc, const char* const* _argv) {
 }
 
 void Parser::Help() {
+  // Options are sorted for display only, as they're found from the hash
+  // table.
+  std::sort(options_, options_end(), &SortOptions);
+
   std::cout << std::endl;
   std::cout << executable_name() << " version " << version() << std::endl;
   std::cout << usage() << std::endl;
@@ -565,15 +712,6 @@ void Parser::Help() {
   std::cout << how_to << std::endl;
 }
 
-namespace {
-// Sort required options first, and then based on their names.
-bool sort_options(Option* _left, Option* _right) {
-  return (_left->required() && !_right->required()) ||
-         ( _left->required() == _right->required() &&
-           std::strcmp(_left->name(), _right->name()) < 0);
-}
-}  // namespace
-
 bool Parser::RegisterOption(Option* _option) {
   if (!_option) {
     return false;
@@ -582,29 +720,27 @@ bool Parser::RegisterOption(Option* _option) {
     return false;
   }
 
-  // Tests for duplicate options.
-  if (std::count(options_, options_end(), _option) != 0) {
-    return false;
-  }
-
   // Empty (or NULL) names aren't allowed.
-  if (_option->name()[0] == '\0') {
+  const char* name = _option->name();
+  if (name[0] == '\0') {
     std::cerr << "Empty (or NULL) names aren't allowed." << std::endl;
     return false;
   }
 
-  // Test for duplicate options' name.
-  for (int i = 0; i < options_count_; ++i) {
-    if (StrICmp(options_[i]->name(), _option->name()) == 0) {
-      std::cerr << "Option name:\"" << _option->name() <<
-        "\" already registered." << std::endl;
-      return false;
-    }
+  // Tests for duplicate options, which also have the same name, and for
+  // duplicate options' name.
+  Option* registered = FindOption(name, name + std::strlen(name));
+  if (registered == _option) {
+    return false;
+  } else if (registered) {
+    std::cerr << "Option name:\"" << name << "\" already registered." <<
+      std::endl;
+    return false;
   }
 
-  // Adds the option and maintains lexical order.
+  // Adds the option, options are only sorted for display.
   options_[options_count_++] = _option;
-  std::inplace_merge(options_, options_end() - 1, options_end(), &sort_options);
+  HashOption(_option);
 
   return true;
 }
@@ -617,7 +753,9 @@ bool Parser::UnregisterOption(Option* _option) {
   // Finds and removes _option from the collection.
   Option** it = std::remove(options_, options_end(), _option);
   if (it != options_end()) {
-    return --options_count_ == builtin_options_count_;
+    --options_count_;
+    RebuildHashTable();
+    return options_count_ == builtin_options_count_;
   }
   return false;
 }
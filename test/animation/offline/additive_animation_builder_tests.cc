@@ -0,0 +1,219 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/additive_animation_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/transform.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::offline::AdditiveAnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+TEST(Error, AdditiveAnimationBuilder) {
+  AdditiveAnimationBuilder builder;
+
+  { // NULL output.
+    RawAnimation input;
+    EXPECT_TRUE(input.Validate());
+    EXPECT_FALSE(builder(input, NULL));
+  }
+
+  { // Invalid input animation.
+    RawAnimation input;
+    input.duration = -1.f;
+    EXPECT_FALSE(input.Validate());
+
+    // Builds animation
+    RawAnimation output;
+    output.duration = -1.f;
+    output.tracks.resize(1);
+    EXPECT_FALSE(builder(input, &output));
+    EXPECT_FLOAT_EQ(output.duration, RawAnimation().duration);
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+
+  { // Reference pose too small.
+    RawAnimation input;
+    input.tracks.resize(2);
+    const ozz::math::Transform reference[1] = {
+      ozz::math::Transform::identity()};
+    RawAnimation output;
+    EXPECT_FALSE(builder(input, ozz::Range<const ozz::math::Transform>(),
+                         &output));
+    EXPECT_FALSE(builder(input,
+                         ozz::Range<const ozz::math::Transform>(reference),
+                         &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+
+  { // Non invertible reference scale.
+    RawAnimation input;
+    input.tracks.resize(1);
+    const RawAnimation::ScaleKey key = {
+      0.f, ozz::math::Float3(1.f, 0.f, 1.f)};
+    input.tracks[0].scales.push_back(key);
+    RawAnimation output;
+    EXPECT_FALSE(builder(input, &output));
+  }
+
+  { // Empty animation.
+    RawAnimation input;
+    RawAnimation output;
+    EXPECT_TRUE(builder(input, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+}
+
+TEST(FirstFrame, AdditiveAnimationBuilder) {
+  AdditiveAnimationBuilder builder;
+
+  RawAnimation input;
+  input.duration = 2.f;
+  input.tracks.resize(2);
+  RawAnimation::JointTrack& track = input.tracks[0];
+  const RawAnimation::TranslationKey t0 = {
+    0.f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  const RawAnimation::TranslationKey t1 = {
+    1.f, ozz::math::Float3(2.f, 4.f, 6.f)};
+  track.translations.push_back(t0);
+  track.translations.push_back(t1);
+  const RawAnimation::RotationKey r0 = {
+    0.f, ozz::math::Quaternion(0.f, 0.f, .70710677f, .70710677f)};
+  const RawAnimation::RotationKey r1 = {
+    2.f, ozz::math::Quaternion(0.f, 0.f, 1.f, 0.f)};
+  track.rotations.push_back(r0);
+  track.rotations.push_back(r1);
+  const RawAnimation::ScaleKey s0 = {
+    .5f, ozz::math::Float3(2.f, 4.f, 8.f)};
+  const RawAnimation::ScaleKey s1 = {
+    1.5f, ozz::math::Float3(4.f, 4.f, 4.f)};
+  track.scales.push_back(s0);
+  track.scales.push_back(s1);
+
+  RawAnimation output;
+  ASSERT_TRUE(builder(input, &output));
+  EXPECT_FLOAT_EQ(output.duration, 2.f);
+  EXPECT_EQ(output.interpolation, RawAnimation::kLinear);
+  ASSERT_EQ(output.num_tracks(), 2);
+
+  const RawAnimation::JointTrack& additive = output.tracks[0];
+  ASSERT_EQ(additive.translations.size(), 2u);
+  EXPECT_FLOAT_EQ(additive.translations[1].time, 1.f);
+  EXPECT_FLOAT3_EQ(additive.translations[0].value, 0.f, 0.f, 0.f);
+  EXPECT_FLOAT3_EQ(additive.translations[1].value, 1.f, 2.f, 3.f);
+
+  ASSERT_EQ(additive.rotations.size(), 2u);
+  EXPECT_FLOAT_EQ(additive.rotations[1].time, 2.f);
+  EXPECT_QUATERNION_EQ(additive.rotations[0].value, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(additive.rotations[1].value,
+                       0.f, 0.f, .70710677f, .70710677f);
+
+  ASSERT_EQ(additive.scales.size(), 2u);
+  EXPECT_FLOAT_EQ(additive.scales[0].time, .5f);
+  EXPECT_FLOAT3_EQ(additive.scales[0].value, 1.f, 1.f, 1.f);
+  EXPECT_FLOAT3_EQ(additive.scales[1].value, 2.f, 1.f, .5f);
+
+  // Empty tracks remain empty.
+  EXPECT_TRUE(output.tracks[1].translations.empty());
+  EXPECT_TRUE(output.tracks[1].rotations.empty());
+  EXPECT_TRUE(output.tracks[1].scales.empty());
+}
+
+TEST(ReferencePose, AdditiveAnimationBuilder) {
+  AdditiveAnimationBuilder builder;
+
+  RawAnimation input;
+  input.interpolation = RawAnimation::kHermite;
+  input.tracks.resize(2);
+  RawAnimation::JointTrack& track = input.tracks[0];
+  const RawAnimation::TranslationKey t0 = {
+    0.f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  track.translations.push_back(t0);
+  track.translation_tangents.push_back(ozz::math::Float3(1.f, 0.f, 0.f));
+  const RawAnimation::RotationKey r0 = {
+    0.f, ozz::math::Quaternion(0.f, 0.f, 1.f, 0.f)};
+  track.rotations.push_back(r0);
+  track.rotation_tangents.push_back(ozz::math::Float4(0.f, 0.f, 0.f, 1.f));
+  const RawAnimation::ScaleKey s0 = {
+    0.f, ozz::math::Float3(2.f, 4.f, 8.f)};
+  track.scales.push_back(s0);
+  track.scale_tangents.push_back(ozz::math::Float3(2.f, 2.f, 2.f));
+  ASSERT_TRUE(input.Validate());
+
+  ozz::math::Transform reference[2] = {
+    ozz::math::Transform::identity(), ozz::math::Transform::identity()};
+  reference[0].translation = ozz::math::Float3(1.f, 1.f, 1.f);
+  reference[0].rotation =
+    ozz::math::Quaternion(0.f, 0.f, .70710677f, .70710677f);
+  reference[0].scale = ozz::math::Float3(2.f, 2.f, 2.f);
+  reference[1].translation = ozz::math::Float3(0.f, 1.f, 0.f);
+
+  RawAnimation output;
+  ASSERT_TRUE(builder(input,
+                      ozz::Range<const ozz::math::Transform>(reference),
+                      &output));
+  EXPECT_EQ(output.interpolation, RawAnimation::kHermite);
+  ASSERT_EQ(output.num_tracks(), 2);
+
+  const RawAnimation::JointTrack& additive = output.tracks[0];
+  ASSERT_EQ(additive.translations.size(), 1u);
+  EXPECT_FLOAT3_EQ(additive.translations[0].value, 0.f, 1.f, 2.f);
+  ASSERT_EQ(additive.translation_tangents.size(), 1u);
+  EXPECT_FLOAT3_EQ(additive.translation_tangents[0], 1.f, 0.f, 0.f);
+
+  // Reference * delta gives back the input rotation.
+  ASSERT_EQ(additive.rotations.size(), 1u);
+  EXPECT_QUATERNION_EQ(additive.rotations[0].value,
+                       0.f, 0.f, .70710677f, .70710677f);
+  const ozz::math::Quaternion rotation =
+    reference[0].rotation * additive.rotations[0].value;
+  EXPECT_QUATERNION_EQ(rotation, 0.f, 0.f, 1.f, 0.f);
+  ASSERT_EQ(additive.rotation_tangents.size(), 1u);
+  EXPECT_FLOAT4_EQ(additive.rotation_tangents[0],
+                   0.f, 0.f, -.70710677f, .70710677f);
+
+  ASSERT_EQ(additive.scales.size(), 1u);
+  EXPECT_FLOAT3_EQ(additive.scales[0].value, 1.f, 2.f, 4.f);
+  ASSERT_EQ(additive.scale_tangents.size(), 1u);
+  EXPECT_FLOAT3_EQ(additive.scale_tangents[0], 1.f, 1.f, 1.f);
+
+  // Empty streams get a key if their reference isn't identity.
+  const RawAnimation::JointTrack& empty = output.tracks[1];
+  ASSERT_EQ(empty.translations.size(), 1u);
+  EXPECT_FLOAT3_EQ(empty.translations[0].value, 0.f, -1.f, 0.f);
+  EXPECT_EQ(empty.translation_tangents.size(), 1u);
+  EXPECT_TRUE(empty.rotations.empty());
+  EXPECT_TRUE(empty.scales.empty());
+  EXPECT_TRUE(output.Validate());
+}
@@ -0,0 +1,167 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_bank_builder.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/animation_bank.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationBank;
+using ozz::animation::offline::AnimationBankBuilder;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+TEST(Error, AnimationBankBuilder) {
+  AnimationBankBuilder builder;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  Animation* animation = AnimationBuilder()(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  { // Invalid range.
+    EXPECT_TRUE(!builder(ozz::Range<const AnimationBankBuilder::Entry>(
+      NULL, reinterpret_cast<const AnimationBankBuilder::Entry*>(NULL) + 1)));
+  }
+
+  { // NULL name.
+    const AnimationBankBuilder::Entry entries[] = {{NULL, animation}};
+    EXPECT_TRUE(!builder(
+      ozz::Range<const AnimationBankBuilder::Entry>(entries)));
+  }
+
+  { // NULL animation.
+    const AnimationBankBuilder::Entry entries[] = {{"run", NULL}};
+    EXPECT_TRUE(!builder(
+      ozz::Range<const AnimationBankBuilder::Entry>(entries)));
+  }
+
+  { // Duplicated names.
+    const AnimationBankBuilder::Entry entries[] = {
+      {"run", animation}, {"walk", animation}, {"run", animation}};
+    EXPECT_TRUE(!builder(
+      ozz::Range<const AnimationBankBuilder::Entry>(entries)));
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Empty, AnimationBankBuilder) {
+  AnimationBankBuilder builder;
+  AnimationBank* bank =
+    builder(ozz::Range<const AnimationBankBuilder::Entry>());
+  ASSERT_TRUE(bank != NULL);
+  EXPECT_EQ(bank->num_animations(), 0);
+  EXPECT_EQ(bank->Find("run"), -1);
+  EXPECT_EQ(bank->Find(""), -1);
+  ozz::memory::default_allocator()->Delete(bank);
+}
+
+TEST(Build, AnimationBankBuilder) {
+  Animation* animations[3];
+  for (int i = 0; i < 3; ++i) {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f + i;
+    raw_animation.tracks.resize(i + 1);
+    RawAnimation::TranslationKey key = {
+      .5f, ozz::math::Float3(1.f, 2.f, 3.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+    animations[i] = AnimationBuilder()(raw_animation);
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+
+  AnimationBankBuilder builder;
+  const AnimationBankBuilder::Entry entries[] = {
+    {"idle", animations[0]}, {"walk", animations[1]}, {"run", animations[2]}};
+  AnimationBank* bank =
+    builder(ozz::Range<const AnimationBankBuilder::Entry>(entries));
+  ASSERT_TRUE(bank != NULL);
+
+  ASSERT_EQ(bank->num_animations(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_STREQ(bank->name(i), entries[i].name);
+    EXPECT_EQ(bank->Find(entries[i].name), i);
+    const Animation& animation = bank->animation(i);
+    EXPECT_FLOAT_EQ(animation.duration(), animations[i]->duration());
+    EXPECT_EQ(animation.num_tracks(), animations[i]->num_tracks());
+  }
+  EXPECT_EQ(bank->Find("jump"), -1);
+  EXPECT_EQ(bank->Find("walking"), -1);
+  EXPECT_EQ(bank->Find(NULL), -1);
+
+  // Source animations can be destroyed once the bank is built.
+  for (int i = 0; i < 3; ++i) {
+    ozz::memory::default_allocator()->Delete(animations[i]);
+  }
+  EXPECT_EQ(bank->Find("run"), 2);
+  EXPECT_EQ(bank->animation(2).num_tracks(), 3);
+
+  ozz::memory::default_allocator()->Delete(bank);
+}
+
+TEST(Many, AnimationBankBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  Animation* animation = AnimationBuilder()(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  const int kNumEntries = 257;
+  char names[kNumEntries][8];
+  AnimationBankBuilder::Entry entries[kNumEntries];
+  for (int i = 0; i < kNumEntries; ++i) {
+    std::sprintf(names[i], "clip%d", i);
+    entries[i].name = names[i];
+    entries[i].animation = animation;
+  }
+
+  AnimationBank* bank = AnimationBankBuilder()(
+    ozz::Range<const AnimationBankBuilder::Entry>(entries));
+  ASSERT_TRUE(bank != NULL);
+  ASSERT_EQ(bank->num_animations(), kNumEntries);
+  for (int i = 0; i < kNumEntries; ++i) {
+    EXPECT_EQ(bank->Find(names[i]), i);
+  }
+  EXPECT_EQ(bank->Find("clip257"), -1);
+
+  ozz::memory::default_allocator()->Delete(bank);
+  ozz::memory::default_allocator()->Delete(animation);
+}
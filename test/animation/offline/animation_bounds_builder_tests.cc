@@ -0,0 +1,272 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_bounds_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBoundsBuilder;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton with a root and a child, 1m along x.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(1);
+  RawSkeleton::Joint& child = root.children[0];
+  child.name = "child";
+  child.transform = ozz::math::Transform::identity();
+  child.transform.translation = ozz::math::Float3(1.f, 0.f, 0.f);
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds a 1s animation, moving the root from the origin to 2m along z.
+Animation* BuildAnimation(int _num_tracks) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  const RawAnimation::TranslationKey first = {0.f,
+                                              ozz::math::Float3::zero()};
+  const RawAnimation::TranslationKey last = {
+    1.f, ozz::math::Float3(0.f, 0.f, 2.f)};
+  raw_animation.tracks[0].translations.push_back(first);
+  raw_animation.tracks[0].translations.push_back(last);
+  if (_num_tracks > 1) {
+    const RawAnimation::TranslationKey child = {
+      0.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+    raw_animation.tracks[1].translations.push_back(child);
+  }
+
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Error, AnimationBoundsBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+  Animation* mismatching = BuildAnimation(1);
+  ASSERT_TRUE(mismatching != NULL);
+  ozz::math::Box bound;
+
+  AnimationBoundsBuilder builder;
+  EXPECT_TRUE(builder(*animation, *skeleton, &bound));
+
+  // Missing output.
+  EXPECT_FALSE(builder(*animation, *skeleton, NULL));
+
+  // Animation doesn't match skeleton.
+  EXPECT_FALSE(builder(*mismatching, *skeleton, &bound));
+
+  // Invalid parameters.
+  builder.sampling_rate = 0.f;
+  EXPECT_FALSE(builder(*animation, *skeleton, &bound));
+  builder.sampling_rate = 30.f;
+  builder.margin = -1.f;
+  EXPECT_FALSE(builder(*animation, *skeleton, &bound));
+  builder.margin = 0.f;
+  const float radii[1] = {1.f};
+  builder.radii = radii;
+  EXPECT_FALSE(builder(*animation, *skeleton, &bound));
+
+  ozz::memory::default_allocator()->Delete(mismatching);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Build, AnimationBoundsBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+  ozz::math::Box bound;
+
+  AnimationBoundsBuilder builder;
+
+  // Sampling rate doesn't match duration, end must still be sampled.
+  builder.sampling_rate = 7.f;
+  ASSERT_TRUE(builder(*animation, *skeleton, &bound));
+  // Translations are quantized.
+  EXPECT_NEAR(bound.min.x, 0.f, 1e-3f);
+  EXPECT_NEAR(bound.min.y, 0.f, 1e-3f);
+  EXPECT_NEAR(bound.min.z, 0.f, 1e-3f);
+  EXPECT_NEAR(bound.max.x, 1.f, 1e-3f);
+  EXPECT_NEAR(bound.max.y, 0.f, 1e-3f);
+  EXPECT_NEAR(bound.max.z, 2.f, 1e-3f);
+
+  // Inflated by radii and margin.
+  const float radii[2] = {.5f, .1f};
+  builder.radii = radii;
+  builder.margin = .2f;
+  ASSERT_TRUE(builder(*animation, *skeleton, &bound));
+  EXPECT_NEAR(bound.min.x, -.7f, 1e-3f);
+  EXPECT_NEAR(bound.min.y, -.7f, 1e-3f);
+  EXPECT_NEAR(bound.min.z, -.7f, 1e-3f);
+  EXPECT_NEAR(bound.max.x, 1.3f, 1e-3f);
+  EXPECT_NEAR(bound.max.y, .7f, 1e-3f);
+  EXPECT_NEAR(bound.max.z, 2.7f, 1e-3f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(TimeRange, AnimationBoundsBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+  ozz::math::Box bound;
+
+  AnimationBoundsBuilder builder;
+
+  // Invalid ranges.
+  EXPECT_FALSE(builder(*animation, *skeleton, -.1f, .5f, &bound));
+  EXPECT_FALSE(builder(*animation, *skeleton, .5f, .4f, &bound));
+  EXPECT_FALSE(builder(*animation, *skeleton, .5f, 1.1f, &bound));
+  EXPECT_FALSE(builder(*animation, *skeleton, 0.f, 1.f, NULL));
+
+  ASSERT_TRUE(builder(*animation, *skeleton, .25f, .5f, &bound));
+  EXPECT_NEAR(bound.min.z, .5f, 1e-3f);
+  EXPECT_NEAR(bound.max.z, 1.f, 1e-3f);
+
+  // A single time.
+  ASSERT_TRUE(builder(*animation, *skeleton, .75f, .75f, &bound));
+  EXPECT_NEAR(bound.min.z, 1.5f, 1e-3f);
+  EXPECT_NEAR(bound.max.z, 1.5f, 1e-3f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(AnimationBuilder, AnimationBoundsBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey first = {0.f,
+                                              ozz::math::Float3::zero()};
+  const RawAnimation::TranslationKey last = {
+    1.f, ozz::math::Float3(0.f, 0.f, 2.f)};
+  raw_animation.tracks[0].translations.push_back(first);
+  raw_animation.tracks[0].translations.push_back(last);
+  const RawAnimation::TranslationKey child = {
+    0.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(child);
+
+  AnimationBuilder builder;
+
+  {  // No bounds by default.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->bounds().Count(), 0u);
+    EXPECT_TRUE(animation->bound(.5f) == NULL);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Invalid bounds parameters.
+    builder.bounds_skeleton = skeleton;
+    builder.bounds_margin = -1.f;
+    EXPECT_TRUE(builder(raw_animation) == NULL);
+    builder.bounds_margin = 0.f;
+
+    RawAnimation mismatching = raw_animation;
+    mismatching.tracks.resize(1);
+    EXPECT_TRUE(builder(mismatching) == NULL);
+  }
+
+  {  // A single box for the whole animation.
+    builder.bounds_skeleton = skeleton;
+    builder.bounds_margin = .1f;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    ASSERT_EQ(animation->bounds().Count(), 1u);
+    const ozz::math::Box* bound = animation->bound(.3f);
+    ASSERT_TRUE(bound != NULL);
+    EXPECT_NEAR(bound->min.x, -.1f, 1e-3f);
+    EXPECT_NEAR(bound->min.z, -.1f, 1e-3f);
+    EXPECT_NEAR(bound->max.x, 1.1f, 1e-3f);
+    EXPECT_NEAR(bound->max.z, 2.1f, 1e-3f);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Time segments.
+    builder.bounds_skeleton = skeleton;
+    builder.bounds_margin = 0.f;
+    builder.bounds_interval = .4f;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+
+    // 3 segments evenly divide the animation.
+    ASSERT_EQ(animation->bounds().Count(), 3u);
+    const ozz::math::Box* bounds = animation->bounds().begin;
+    EXPECT_NEAR(bounds[0].min.z, 0.f, 1e-3f);
+    EXPECT_NEAR(bounds[0].max.z, 2.f / 3.f, 1e-3f);
+    EXPECT_NEAR(bounds[1].min.z, 2.f / 3.f, 1e-3f);
+    EXPECT_NEAR(bounds[1].max.z, 4.f / 3.f, 1e-3f);
+    EXPECT_NEAR(bounds[2].min.z, 4.f / 3.f, 1e-3f);
+    EXPECT_NEAR(bounds[2].max.z, 2.f, 1e-3f);
+
+    // Time is clamped, and the end belongs to the last segment.
+    EXPECT_EQ(animation->bound(-1.f), bounds);
+    EXPECT_EQ(animation->bound(.2f), bounds);
+    EXPECT_EQ(animation->bound(.5f), bounds + 1);
+    EXPECT_EQ(animation->bound(.8f), bounds + 2);
+    EXPECT_EQ(animation->bound(1.f), bounds + 2);
+    EXPECT_EQ(animation->bound(2.f), bounds + 2);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -33,8 +33,16 @@
 #include "gtest/gtest.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
+#include <cstdlib>
+#include <cstring>
+
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/huge_page_allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/quaternion.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/tasks/task_dispatcher.h"
 
 #include "ozz/animation/offline/raw_animation.h"
 
@@ -310,3 +318,670 @@ TEST(Sort, AnimationBuilder) {
     ozz::memory::default_allocator()->Delete(animation);
   }
 }
+
+TEST(Constant, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  // 6 tracks, plus 2 soa padding tracks.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+
+  // Track 0 has animated translations and constant rotations, whose keys are
+  // opposite quaternions. Scales are empty, hence constant.
+  RawAnimation::JointTrack& track0 = raw_animation.tracks[0];
+  const RawAnimation::TranslationKey t00 = {
+    0.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  track0.translations.push_back(t00);
+  const RawAnimation::TranslationKey t01 = {
+    1.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  track0.translations.push_back(t01);
+  const ozz::math::Quaternion q = ozz::math::Quaternion::FromAxisAngle(
+    ozz::math::Float4(0.f, 1.f, 0.f, ozz::math::kPi_2));
+  const RawAnimation::RotationKey r00 = {0.f, q};
+  track0.rotations.push_back(r00);
+  const RawAnimation::RotationKey r01 = {.5f, -q};
+  track0.rotations.push_back(r01);
+  const RawAnimation::RotationKey r02 = {1.f, q};
+  track0.rotations.push_back(r02);
+
+  // Track 1 has constant translations and scales, and animated rotations.
+  RawAnimation::JointTrack& track1 = raw_animation.tracks[1];
+  for (int i = 0; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+      i * .4f, ozz::math::Float3(0.f, 3.f, 0.f)};
+    track1.translations.push_back(key);
+  }
+  const RawAnimation::RotationKey r10 = {
+    0.f, ozz::math::Quaternion::identity()};
+  track1.rotations.push_back(r10);
+  const RawAnimation::RotationKey r11 = {.5f, q};
+  track1.rotations.push_back(r11);
+  const RawAnimation::ScaleKey s10 = {.5f, ozz::math::Float3(2.f, 2.f, 2.f)};
+  track1.scales.push_back(s10);
+
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Constant tracks, including soa padding tracks.
+  EXPECT_EQ(animation->num_constant_translations(), 7);
+  EXPECT_EQ(animation->num_constant_rotations(), 7);
+  EXPECT_EQ(animation->num_constant_scales(), 8);
+
+  // Samples forward, then backward.
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(6);
+  ozz::math::SoaTransform output[2];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  const float times[] = {0.f, .25f, .5f, 1.f, .5f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+    const float t = times[i];
+    const float r = t < .5f ? t * 2.f : 1.f;  // Track 1 rotation lerp ratio.
+    const ozz::math::Quaternion q1 = NLerp(
+      ozz::math::Quaternion::identity(), q, r);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f + t, 0.f, 0.f, 0.f,
+                                                   0.f, 3.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, q.x, q1.x, 0.f, 0.f,
+                                                    q.y, q1.y, 0.f, 0.f,
+                                                    q.z, q1.z, 0.f, 0.f,
+                                                    q.w, q1.w, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 2.f, 1.f, 1.f,
+                                             1.f, 2.f, 1.f, 1.f,
+                                             1.f, 2.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 0.f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[1].rotation, 0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f,
+                                                    1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 1.f, 1.f, 1.f, 1.f,
+                                             1.f, 1.f, 1.f, 1.f,
+                                             1.f, 1.f, 1.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Scaled, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+
+  // Empty scale tracks and unit scale keys aren't scaled.
+  const RawAnimation::ScaleKey unit = {.5f, ozz::math::Float3::one()};
+  raw_animation.tracks[1].scales.push_back(unit);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->scaled());
+    EXPECT_TRUE(animation->uniformly_scaled());
+
+    // Sampled scales are unit scales.
+    ozz::animation::SamplingJob job;
+    ozz::animation::SamplingCache cache(2);
+    ozz::math::SoaTransform output[1];
+    job.animation = animation;
+    job.cache = &cache;
+    job.time = .3f;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output[0].scale, 1.f, 1.f, 1.f, 1.f,
+                                         1.f, 1.f, 1.f, 1.f,
+                                         1.f, 1.f, 1.f, 1.f);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Uniform scale keys.
+  const RawAnimation::ScaleKey uniform = {.7f, ozz::math::Float3(2.f)};
+  raw_animation.tracks[1].scales.push_back(uniform);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_TRUE(animation->scaled());
+    EXPECT_TRUE(animation->uniformly_scaled());
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // A single non unit scale key makes the animation scaled.
+  const RawAnimation::ScaleKey scale = {1.f, ozz::math::Float3(1.f, 1.f, 2.f)};
+  raw_animation.tracks[1].scales.push_back(scale);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_TRUE(animation->scaled());
+    EXPECT_FALSE(animation->uniformly_scaled());
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(Translated, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  // A rigid hierarchy, whose tracks only rotate around constant translations.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey t0 = {
+    .2f, ozz::math::Float3(0.f, 4.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(t0);
+  const RawAnimation::RotationKey r0 = {
+    0.f, ozz::math::Quaternion::identity()};
+  raw_animation.tracks[1].rotations.push_back(r0);
+  const RawAnimation::RotationKey r1 = {
+    1.f, ozz::math::Quaternion::FromAxisAngle(
+           ozz::math::Float4(0.f, 1.f, 0.f, ozz::math::kPi_2))};
+  raw_animation.tracks[1].rotations.push_back(r1);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->translated());
+
+    // Constant translations are output as is.
+    ozz::animation::SamplingJob job;
+    ozz::animation::SamplingCache cache(2);
+    ozz::math::SoaTransform output[1];
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    const float times[] = {0.f, .5f, 1.f};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+      job.time = times[i];
+      ASSERT_TRUE(job.Run());
+      EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 4.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f);
+    }
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // A second translation key animates the track.
+  const RawAnimation::TranslationKey t1 = {
+    .8f, ozz::math::Float3(0.f, 8.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(t1);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_TRUE(animation->translated());
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(BufferAllocator, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey first = {
+    0.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(first);
+  const RawAnimation::TranslationKey last = {
+    1.f, ozz::math::Float3(3.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(last);
+
+  EXPECT_EQ(Animation::buffer_allocator(), ozz::memory::default_allocator());
+
+  // Animation buffers are allocated with the buffer allocator.
+  ozz::memory::TrackingAllocator tracking;
+  EXPECT_TRUE(Animation::SetBufferAllocator(&tracking) == NULL);
+  EXPECT_EQ(Animation::buffer_allocator(), &tracking);
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_GT(tracking.total().live_count, 0);
+
+  // Restoring the default allocator doesn't change the allocator of existing
+  // animations.
+  EXPECT_EQ(Animation::SetBufferAllocator(NULL), &tracking);
+  EXPECT_EQ(Animation::buffer_allocator(), ozz::memory::default_allocator());
+  ozz::memory::default_allocator()->Delete(animation);
+  EXPECT_EQ(tracking.total().live_count, 0);
+
+  // Animations can be sampled from huge pages.
+  Animation::SetBufferAllocator(ozz::memory::huge_page_allocator());
+  animation = builder(raw_animation);
+  Animation::SetBufferAllocator(NULL);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  job.animation = animation;
+  job.cache = &cache;
+  job.time = .5f;
+  job.output.begin = output;
+  job.output.end = output + 1;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 2.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(KeyTime, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  // Keys closer than a key time unit (duration / 65535) are merged.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1000.f;
+  raw_animation.tracks.resize(1);
+
+  RawAnimation::JointTrack& track = raw_animation.tracks[0];
+  const RawAnimation::TranslationKey t0 = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  track.translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {  // Merged with t0.
+    .001f, ozz::math::Float3(5.f, 0.f, 0.f)};
+  track.translations.push_back(t1);
+  const RawAnimation::TranslationKey t2 = {
+    500.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  track.translations.push_back(t2);
+  const RawAnimation::TranslationKey t3 = {  // Replaced by t4.
+    999.999f, ozz::math::Float3(7.f, 0.f, 0.f)};
+  track.translations.push_back(t3);
+  const RawAnimation::TranslationKey t4 = {
+    1000.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  track.translations.push_back(t4);
+
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  const float times[] = {0.f, 250.f, 500.f, 750.f, 1000.f, 0.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, times[i] / 500.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(TimeStep, AnimationBuilder) {
+#ifdef OZZ_HAS_STATS
+  const bool enabled = true;
+#else  // OZZ_HAS_STATS
+  const bool enabled = false;
+#endif  // OZZ_HAS_STATS
+
+  // 8 tracks (2 soa groups) whose keys are every .1s, slightly jittered per
+  // track.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(8);
+  for (int i = 0; i < 8; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int j = 0; j <= 10; ++j) {
+      const float jitter = j > 0 && j < 10 ? (i - 4) * 2e-3f : 0.f;
+      const RawAnimation::TranslationKey key = {
+        j * .1f + jitter, ozz::math::Float3(j * 1.f, 0.f, 0.f)};
+      track.translations.push_back(key);
+    }
+  }
+  ASSERT_TRUE(raw_animation.Validate());
+
+  AnimationBuilder builder;
+  builder.time_step = -1.f;
+  EXPECT_TRUE(builder(raw_animation) == NULL);
+
+  builder.time_step = 0.f;
+  Animation* jittered = builder(raw_animation);
+  ASSERT_TRUE(jittered != NULL);
+  builder.time_step = .05f;
+  Animation* snapped = builder(raw_animation);
+  ASSERT_TRUE(snapped != NULL);
+
+  // No key was merged.
+  EXPECT_EQ(snapped->size(), jittered->size());
+
+  // Keys are rounded to multiples of the time step.
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(8);
+  ozz::math::SoaTransform output[2];
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  job.animation = snapped;
+  for (int j = 0; j <= 10; ++j) {
+    job.time = j * .1f;
+    ASSERT_TRUE(job.Run());
+    const float x = j * 1.f;
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, x, x, x, x,
+                                                   0.f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, x, x, x, x,
+                                                   0.f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+  }
+
+  // Playing the snapped animation decodes fewer soa entries, as the keys of
+  // a soa group are fetched together.
+  int soa_updates[2];
+  const Animation* animations[2] = {jittered, snapped};
+  for (int a = 0; a < 2; ++a) {
+    job.animation = animations[a];
+    job.time = 0.f;
+    ASSERT_TRUE(job.Run());
+    cache.ResetStats();
+    for (int f = 1; f <= 240; ++f) {
+      job.time = f / 240.f;
+      ASSERT_TRUE(job.Run());
+    }
+    soa_updates[a] = cache.stats().soa_updates;
+  }
+  if (enabled) {
+    EXPECT_LT(soa_updates[1], soa_updates[0]);
+  }
+
+  ozz::memory::default_allocator()->Delete(jittered);
+  ozz::memory::default_allocator()->Delete(snapped);
+}
+
+TEST(TranslationRange, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  // Translations far from the origin keep the precision of their range.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+
+  RawAnimation::JointTrack& track0 = raw_animation.tracks[0];
+  const RawAnimation::TranslationKey t00 = {
+    0.f, ozz::math::Float3(1000.f, -2000.f, 0.f)};
+  track0.translations.push_back(t00);
+  const RawAnimation::TranslationKey t01 = {
+    1.f, ozz::math::Float3(1000.02f, -2000.f, 0.f)};
+  track0.translations.push_back(t01);
+
+  RawAnimation::JointTrack& track1 = raw_animation.tracks[1];
+  const RawAnimation::TranslationKey t10 = {
+    0.f, ozz::math::Float3(-1.f, 0.f, 5000.f)};
+  track1.translations.push_back(t10);
+  const RawAnimation::TranslationKey t11 = {
+    1.f, ozz::math::Float3(1.f, 0.f, 5000.f)};
+  track1.translations.push_back(t11);
+
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_constant_translations(), 2);
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(2);
+  ozz::math::SoaTransform output[1];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  const float times[] = {0.f, .25f, .5f, 1.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    const float t = times[i];
+    job.time = t;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                            1000.f + t * .02f, -1.f + t * 2.f, 0.f, 0.f,
+                            -2000.f, 0.f, 0.f, 0.f,
+                            0.f, 5000.f, 0.f, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Rotation, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  // Every track has a first key whose largest component differs, including a
+  // rotation whose w is 0.
+  const ozz::math::Quaternion quats[] = {
+    ozz::math::Quaternion(.8f, .4f, -.4f, .2f),
+    ozz::math::Quaternion(-.4f, -.8f, .2f, .4f),
+    ozz::math::Quaternion(.2f, -.4f, .8f, .4f),
+    ozz::math::Quaternion(.6f, 0.f, .8f, 0.f)};
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(4);
+  for (int i = 0; i < 4; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const RawAnimation::RotationKey first = {0.f, quats[i]};
+    track.rotations.push_back(first);
+    const RawAnimation::RotationKey last = {
+      1.f, ozz::math::Quaternion::identity()};
+    track.rotations.push_back(last);
+  }
+
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_constant_rotations(), 0);
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(4);
+  ozz::math::SoaTransform output[1];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  job.time = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, .8f, -.4f, .2f, .6f,
+                                                  .4f, -.8f, -.4f, 0.f,
+                                                  -.4f, .2f, .8f, .8f,
+                                                  .2f, .4f, .4f, 0.f);
+  job.time = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  1.f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Hermite, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.interpolation = RawAnimation::kHermite;
+  raw_animation.tracks.resize(3);
+
+  // Track 0 eases in and out from 0 to 1 as its tangents are null.
+  RawAnimation::JointTrack& track0 = raw_animation.tracks[0];
+  const RawAnimation::TranslationKey t00 = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  track0.translations.push_back(t00);
+  track0.translation_tangents.push_back(ozz::math::Float3::zero());
+  const RawAnimation::TranslationKey t01 = {
+    2.f, ozz::math::Float3(1.f, 2.f, 0.f)};
+  track0.translations.push_back(t01);
+
+  // Tangents are required for every key.
+  EXPECT_TRUE(!builder(raw_animation));
+  track0.translation_tangents.push_back(ozz::math::Float3::zero());
+
+  // Track 1 tangents match the slope between its keys, so it's linear.
+  RawAnimation::JointTrack& track1 = raw_animation.tracks[1];
+  const RawAnimation::TranslationKey t10 = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  track1.translations.push_back(t10);
+  track1.translation_tangents.push_back(ozz::math::Float3(1.f, 0.f, 0.f));
+  const RawAnimation::TranslationKey t11 = {
+    2.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  track1.translations.push_back(t11);
+  track1.translation_tangents.push_back(ozz::math::Float3(1.f, 0.f, 0.f));
+
+  // Track 2 rotation and scale ease in and out.
+  RawAnimation::JointTrack& track2 = raw_animation.tracks[2];
+  const ozz::math::Quaternion q0 = ozz::math::Quaternion::identity();
+  const ozz::math::Quaternion q1(0.f, .70710677f, 0.f, .70710677f);
+  const RawAnimation::RotationKey r20 = {0.f, q0};
+  track2.rotations.push_back(r20);
+  track2.rotation_tangents.push_back(ozz::math::Float4::zero());
+  const RawAnimation::RotationKey r21 = {2.f, q1};
+  track2.rotations.push_back(r21);
+  track2.rotation_tangents.push_back(ozz::math::Float4::zero());
+  const RawAnimation::ScaleKey s20 = {0.f, ozz::math::Float3(1.f, 1.f, 1.f)};
+  track2.scales.push_back(s20);
+  track2.scale_tangents.push_back(ozz::math::Float3::zero());
+  const RawAnimation::ScaleKey s21 = {2.f, ozz::math::Float3(3.f, 1.f, 1.f)};
+  track2.scales.push_back(s21);
+  track2.scale_tangents.push_back(ozz::math::Float3::zero());
+
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_TRUE(animation->hermite());
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(3);
+  ozz::math::SoaTransform output[1];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  // At a quarter of the duration, Hermite basis with null tangents is
+  // 3.(1/4)^2 - 2.(1/4)^3 = .15625.
+  const float h = .15625f;
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                          h, .5f, 0.f, 0.f,
+                          2.f * h, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+  const ozz::math::Quaternion q = NLerp(q0, q1, h);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                              0.f, 0.f, q.x, 0.f,
+                              0.f, 0.f, q.y, 0.f,
+                              0.f, 0.f, q.z, 0.f,
+                              1.f, 1.f, q.w, 1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale,
+                          1.f, 1.f, 1.f + 2.f * h, 1.f,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f);
+
+  // Curves are symmetric at the middle of the duration.
+  job.time = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                          .5f, 1.f, 0.f, 0.f,
+                          1.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale,
+                          1.f, 1.f, 2.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+
+  // Tangents are ignored by linear animations.
+  raw_animation.interpolation = RawAnimation::kLinear;
+  animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_FALSE(animation->hermite());
+  EXPECT_TRUE(animation->tangents().begin == animation->tangents().end);
+  job.animation = animation;
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                          .25f, .5f, 0.f, 0.f,
+                          .5f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Implements a dispatcher that runs work items in reverse order.
+class ReverseDispatcher : public ozz::tasks::Dispatcher {
+ public:
+  ReverseDispatcher()
+      : count(0) {
+  }
+  virtual void Dispatch(const ozz::tasks::Task& _task, int _count) {
+    for (int i = _count - 1; i >= 0; --i) {
+      _task.Run(i);
+    }
+    count += _count;
+  }
+  int count;
+};
+
+// Saves _animation to a blob allocated with the default allocator.
+void* SaveBlob(const Animation& _animation) {
+  void* blob = ozz::memory::default_allocator()->Allocate(
+    _animation.blob_size(), Animation::kBlobAlignment);
+  EXPECT_TRUE(_animation.SaveBlob(blob, _animation.blob_size()));
+  return blob;
+}
+}  // namespace
+
+TEST(Dispatcher, AnimationBuilder) {
+  // Builds a raw animation with random keys, and a different number of keys
+  // per track.
+  RawAnimation raw_animation;
+  raw_animation.duration = 10.f;
+  raw_animation.tracks.resize(67);
+  srand(46);
+  for (int i = 0; i < raw_animation.num_tracks(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const int num_keys = i * 7 % 23;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = (k + static_cast<float>(rand()) / RAND_MAX) * 10.f /
+                         (num_keys + 1);
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(static_cast<float>(rand() % 100), 0.f, 1.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion(0.f, (rand() % 2) ? 1.f : -1.f, 0.f, 1.f)};
+      track.rotations.push_back(rkey);
+      if (k % 2) {
+        const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f, static_cast<float>(rand() % 10), 1.f)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+  ASSERT_TRUE(raw_animation.Validate());
+
+  AnimationBuilder builder;
+  EXPECT_TRUE(builder.dispatcher == NULL);
+  Animation* serial = builder(raw_animation);
+  ASSERT_TRUE(serial != NULL);
+
+  ReverseDispatcher dispatcher;
+  builder.dispatcher = &dispatcher;
+  Animation* dispatched = builder(raw_animation);
+  ASSERT_TRUE(dispatched != NULL);
+  EXPECT_EQ(dispatcher.count, 3);
+
+  // Both animations are identical.
+  ASSERT_EQ(serial->blob_size(), dispatched->blob_size());
+  void* serial_blob = SaveBlob(*serial);
+  void* dispatched_blob = SaveBlob(*dispatched);
+  EXPECT_EQ(std::memcmp(serial_blob, dispatched_blob, serial->blob_size()), 0);
+
+  ozz::memory::default_allocator()->Deallocate(serial_blob);
+  ozz::memory::default_allocator()->Deallocate(dispatched_blob);
+  ozz::memory::default_allocator()->Delete(serial);
+  ozz::memory::default_allocator()->Delete(dispatched);
+}
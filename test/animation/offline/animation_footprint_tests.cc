@@ -0,0 +1,199 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_footprint.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::AnimationFootprint;
+using ozz::animation::offline::AnimationFootprintAnalyzer;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a 1s animation with 2 tracks. The first one has linear rotation keys,
+// and translation keys whose middle key is 1cm away from linear
+// interpolation. Second track has non linear translation keys, and constant
+// rotation and scale.
+Animation* BuildAnimation(bool _key_links) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+
+  for (int i = 0; i < 3; ++i) {
+    const float time = i * .5f;
+    const RawAnimation::TranslationKey linear = {
+      time, ozz::math::Float3(2.f * time + (i == 1 ? .01f : 0.f), 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(linear);
+    const RawAnimation::RotationKey rotation = {
+      time,
+      ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float4(0.f, 1.f, 0.f, time * ozz::math::kPi_2))};
+    raw_animation.tracks[0].rotations.push_back(rotation);
+    const RawAnimation::TranslationKey bump = {
+      time, ozz::math::Float3(0.f, i == 1 ? 5.f : 0.f, 0.f)};
+    raw_animation.tracks[1].translations.push_back(bump);
+  }
+
+  AnimationBuilder builder;
+  builder.key_links = _key_links;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Error, AnimationFootprintAnalyzer) {
+  Animation* animation = BuildAnimation(false);
+  ASSERT_TRUE(animation != NULL);
+  AnimationFootprint footprint;
+
+  AnimationFootprintAnalyzer analyzer;
+  EXPECT_TRUE(analyzer(*animation, &footprint));
+
+  // Missing output.
+  EXPECT_FALSE(analyzer(*animation, NULL));
+
+  // Invalid tolerances.
+  analyzer.translation_tolerance = -1.f;
+  EXPECT_FALSE(analyzer(*animation, &footprint));
+  EXPECT_EQ(footprint.tracks.size(), 0u);
+  analyzer.translation_tolerance = 0.f;
+  analyzer.rotation_tolerance = -1.f;
+  EXPECT_FALSE(analyzer(*animation, &footprint));
+  analyzer.rotation_tolerance = 0.f;
+  analyzer.scale_tolerance = -1.f;
+  EXPECT_FALSE(analyzer(*animation, &footprint));
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Empty, AnimationFootprintAnalyzer) {
+  Animation animation;
+  AnimationFootprint footprint;
+  AnimationFootprintAnalyzer analyzer;
+  ASSERT_TRUE(analyzer(animation, &footprint));
+  EXPECT_EQ(footprint.tracks.size(), 0u);
+  EXPECT_EQ(footprint.size, animation.size());
+  EXPECT_EQ(footprint.translations, 0);
+  EXPECT_EQ(footprint.tolerance_savings, 0u);
+}
+
+TEST(Analyze, AnimationFootprintAnalyzer) {
+  Animation* animation = BuildAnimation(false);
+  ASSERT_TRUE(animation != NULL);
+  AnimationFootprint footprint;
+
+  AnimationFootprintAnalyzer analyzer;
+  ASSERT_TRUE(analyzer(*animation, &footprint));
+
+  // Buffers.
+  EXPECT_EQ(footprint.size, animation->size());
+  EXPECT_EQ(footprint.translations_size, animation->translations().Size());
+  EXPECT_EQ(footprint.rotations_size, animation->rotations().Size());
+  EXPECT_EQ(footprint.scales_size, animation->scales().Size());
+  EXPECT_EQ(footprint.tangents_size, 0u);
+  EXPECT_EQ(footprint.key_links_size, 0u);
+  EXPECT_EQ(footprint.constant_rotations,
+            animation->num_constant_rotations());
+
+  // Tracks breakdown.
+  ASSERT_EQ(footprint.tracks.size(), 2u);
+  const AnimationFootprint::Track& track0 = footprint.tracks[0];
+  EXPECT_EQ(track0.translations, 3);
+  EXPECT_EQ(track0.rotations, 3);
+  EXPECT_EQ(track0.scales, 1);
+  EXPECT_FALSE(track0.constant_translation);
+  EXPECT_FALSE(track0.constant_rotation);
+  EXPECT_TRUE(track0.constant_scale);
+  EXPECT_EQ(track0.size, 7u * 10u);
+  EXPECT_EQ(track0.removable_keys, 1);
+
+  const AnimationFootprint::Track& track1 = footprint.tracks[1];
+  EXPECT_EQ(track1.translations, 3);
+  EXPECT_EQ(track1.rotations, 1);
+  EXPECT_EQ(track1.scales, 1);
+  EXPECT_FALSE(track1.constant_translation);
+  EXPECT_TRUE(track1.constant_rotation);
+  EXPECT_TRUE(track1.constant_scale);
+  EXPECT_EQ(track1.size, 5u * 10u);
+  EXPECT_EQ(track1.removable_keys, 0);
+
+  // Savings.
+  EXPECT_EQ(footprint.tolerance_savings, 10u);
+  EXPECT_EQ(footprint.constant_savings,
+            (footprint.constant_translations + footprint.constant_rotations +
+             footprint.constant_scales) * 10u);
+  EXPECT_EQ(footprint.time_quantization_savings,
+            (footprint.translations + footprint.rotations +
+             footprint.scales) * 2u);
+  EXPECT_EQ(footprint.quaternion_packing_savings,
+            footprint.rotations * 10u);
+
+  // Looser translation tolerance allows to remove middle translation key.
+  analyzer.translation_tolerance = 2e-2f;
+  ASSERT_TRUE(analyzer(*animation, &footprint));
+  EXPECT_EQ(footprint.tracks[0].removable_keys, 2);
+  EXPECT_EQ(footprint.tracks[1].removable_keys, 0);
+  EXPECT_EQ(footprint.tolerance_savings, 2u * 10u);
+
+  // Quantized rotation key is out of a null tolerance.
+  analyzer.rotation_tolerance = 0.f;
+  ASSERT_TRUE(analyzer(*animation, &footprint));
+  EXPECT_EQ(footprint.tracks[0].removable_keys, 1);
+  EXPECT_EQ(footprint.tolerance_savings, 10u);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(KeyLinks, AnimationFootprintAnalyzer) {
+  Animation* animation = BuildAnimation(true);
+  ASSERT_TRUE(animation != NULL);
+  AnimationFootprint footprint;
+
+  AnimationFootprintAnalyzer analyzer;
+  ASSERT_TRUE(analyzer(*animation, &footprint));
+
+  // Every key has a link.
+  EXPECT_EQ(footprint.key_links_size, animation->key_links().Size());
+  ASSERT_EQ(footprint.tracks.size(), 2u);
+  EXPECT_EQ(footprint.tracks[0].size, 7u * 12u);
+  EXPECT_EQ(footprint.tracks[1].size, 5u * 12u);
+  EXPECT_EQ(footprint.tolerance_savings, 12u);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
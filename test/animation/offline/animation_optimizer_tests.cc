@@ -30,12 +30,22 @@
 
 #include "ozz/animation/offline/animation_optimizer.h"
 
+#include <cmath>
+#include <cstdlib>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/maths/math_constant.h"
+#include "ozz/base/tasks/task_dispatcher.h"
+
+#include "ozz/base/memory/allocator.h"
 
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
 
 using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::AnimationOptimizer;
@@ -64,6 +74,144 @@ TEST(Error, AnimationOptimizer) {
     EXPECT_FLOAT_EQ(output.duration, RawAnimation().duration);
     EXPECT_EQ(output.num_tracks(), 0);
   }
+
+  { // Invalid reduction window.
+    RawAnimation input;
+    EXPECT_TRUE(input.Validate());
+
+    AnimationOptimizer windowed;
+    windowed.reduction = AnimationOptimizer::kWindowed;
+    windowed.reduction_window = 0;
+
+    RawAnimation output;
+    output.tracks.resize(1);
+    EXPECT_FALSE(windowed(input, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+
+    // Window is ignored by exhaustive reduction.
+    windowed.reduction = AnimationOptimizer::kExhaustive;
+    EXPECT_TRUE(windowed(input, &output));
+  }
+}
+
+TEST(Windowed, AnimationOptimizer) {
+  // Builds a track of 101 constant keys, which can all be interpolated from
+  // the first and last ones.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  for (int i = 0; i <= 100; ++i) {
+    const RawAnimation::TranslationKey key = {
+      i / 100.f, ozz::math::Float3(1.f, 2.f, 3.f)};
+    input.tracks[0].translations.push_back(key);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  EXPECT_EQ(optimizer.reduction, AnimationOptimizer::kExhaustive);
+
+  { // Exhaustive reduction only keeps first and last keys.
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, &output));
+    ASSERT_EQ(output.tracks[0].translations.size(), 2u);
+    EXPECT_FLOAT_EQ(output.tracks[0].translations[0].time, 0.f);
+    EXPECT_FLOAT_EQ(output.tracks[0].translations[1].time, 1.f);
+  }
+
+  optimizer.reduction = AnimationOptimizer::kWindowed;
+
+  { // At most 10 consecutive keys are removed.
+    optimizer.reduction_window = 10;
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, &output));
+    const RawAnimation::JointTrack::Translations& translations =
+      output.tracks[0].translations;
+    ASSERT_EQ(translations.size(), 11u);
+    for (size_t i = 0; i < translations.size() - 1; ++i) {
+      EXPECT_FLOAT_EQ(translations[i].time, i * 11 / 100.f);
+    }
+    EXPECT_FLOAT_EQ(translations.back().time, 1.f);
+  }
+
+  { // A single key is removed at most.
+    optimizer.reduction_window = 1;
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, &output));
+    EXPECT_EQ(output.tracks[0].translations.size(), 51u);
+  }
+
+  { // Window bigger than the track matches exhaustive reduction.
+    optimizer.reduction_window = 1000;
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, &output));
+    EXPECT_EQ(output.tracks[0].translations.size(), 2u);
+  }
+
+  { // Keys that cannot be interpolated are kept.
+    RawAnimation::TranslationKey& key = input.tracks[0].translations[5];
+    key.value = ozz::math::Float3(0.f, 0.f, 0.f);
+    optimizer.reduction_window = 10;
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, &output));
+    const RawAnimation::JointTrack::Translations& translations =
+      output.tracks[0].translations;
+    ASSERT_GE(translations.size(), 4u);
+    EXPECT_FLOAT_EQ(translations[1].time, .04f);
+    EXPECT_FLOAT_EQ(translations[2].time, .05f);
+    EXPECT_FLOAT_EQ(translations[3].time, .06f);
+  }
+}
+
+TEST(Hermite, AnimationOptimizer) {
+  // Builds a translation track that samples a sine curve.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  for (int i = 0; i <= 100; ++i) {
+    const float time = i / 100.f;
+    const float x = std::sin(time * 2.f * ozz::math::kPi);
+    const RawAnimation::TranslationKey key = {
+      time, ozz::math::Float3(x, 0.f, 0.f)};
+    input.tracks[0].translations.push_back(key);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  EXPECT_EQ(optimizer.interpolation, RawAnimation::kLinear);
+
+  RawAnimation linear;
+  ASSERT_TRUE(optimizer(input, &linear));
+  EXPECT_EQ(linear.interpolation, RawAnimation::kLinear);
+  EXPECT_EQ(linear.tracks[0].translation_tangents.size(), 0u);
+
+  // Tangents are estimated from the linear input.
+  optimizer.interpolation = RawAnimation::kHermite;
+  RawAnimation hermite;
+  ASSERT_TRUE(optimizer(input, &hermite));
+  ASSERT_TRUE(hermite.Validate());
+  EXPECT_EQ(hermite.interpolation, RawAnimation::kHermite);
+  const RawAnimation::JointTrack& track = hermite.tracks[0];
+  EXPECT_EQ(track.translation_tangents.size(), track.translations.size());
+  EXPECT_LT(track.translations.size(),
+            linear.tracks[0].translations.size());
+
+  // Tangents of a Hermite input are kept.
+  RawAnimation rehermite;
+  ASSERT_TRUE(optimizer(hermite, &rehermite));
+  ASSERT_TRUE(rehermite.Validate());
+  const RawAnimation::JointTrack& retrack = rehermite.tracks[0];
+  ASSERT_EQ(retrack.translations.size(), track.translations.size());
+  for (size_t i = 0; i < retrack.translations.size(); ++i) {
+    EXPECT_FLOAT_EQ(retrack.translation_tangents[i].x,
+                    track.translation_tangents[i].x);
+  }
+
+  // The optimized animation can be built.
+  ozz::animation::offline::AnimationBuilder builder;
+  ozz::animation::Animation* animation = builder(hermite);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_TRUE(animation->hermite());
+  ozz::memory::default_allocator()->Delete(animation);
 }
 
 TEST(Optimize, AnimationOptimizer) {
@@ -181,3 +329,567 @@ TEST(Optimize, AnimationOptimizer) {
     EXPECT_FLOAT_EQ(rotations[1].value.w, .9998477f);  // Track 0 end.
   }
 }
+
+namespace {
+// Builds a chain of 3 joints, each 1 meter from its parent.
+ozz::animation::Skeleton* BuildChain() {
+  using ozz::animation::offline::RawSkeleton;
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 0; i < 3; ++i) {
+    joint->name = i == 0 ? "root" : i == 1 ? "j1" : "j2";
+    joint->transform = ozz::math::Transform::identity();
+    if (i < 2) {
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+  }
+  return ozz::animation::offline::SkeletonBuilder()(raw_skeleton);
+}
+
+// Pushes 3 rotation keys, the middle one being rotated of _angle.
+void PushRotations(float _angle, RawAnimation::JointTrack* _track) {
+  const RawAnimation::RotationKey first = {
+    0.f, ozz::math::Quaternion::identity()};
+  _track->rotations.push_back(first);
+  const RawAnimation::RotationKey middle = {
+    .5f, ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(0.f, 0.f, 1.f, _angle))};
+  _track->rotations.push_back(middle);
+  const RawAnimation::RotationKey last = {
+    1.f, ozz::math::Quaternion::identity()};
+  _track->rotations.push_back(last);
+}
+}  // namespace
+
+TEST(HierarchicalError, AnimationOptimizer) {
+  AnimationOptimizer optimizer;
+  ozz::animation::Skeleton* skeleton = BuildChain();
+  ASSERT_TRUE(skeleton != NULL);
+
+  { // NULL output.
+    RawAnimation input;
+    input.tracks.resize(3);
+    EXPECT_FALSE(optimizer(input, *skeleton, NULL));
+  }
+
+  { // Track count doesn't match skeleton.
+    RawAnimation input;
+    input.tracks.resize(2);
+    RawAnimation output;
+    output.tracks.resize(1);
+    EXPECT_FALSE(optimizer(input, *skeleton, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+
+  { // Invalid input animation.
+    RawAnimation input;
+    input.duration = -1.f;
+    input.tracks.resize(3);
+    RawAnimation output;
+    EXPECT_FALSE(optimizer(input, *skeleton, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Hierarchical, AnimationOptimizer) {
+  ozz::animation::Skeleton* skeleton = BuildChain();
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(3);
+  for (int i = 1; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+      0.f, ozz::math::Float3(0.f, 1.f, 0.f)};
+    input.tracks[i].translations.push_back(key);
+  }
+
+  // 0.05 degree on the root moves the leaf of almost 2mm.
+  PushRotations(.05f * ozz::math::kPi / 180.f, &input.tracks[0]);
+
+  // 0.15 degree on the leaf moves skinned vertices of less than 1mm.
+  PushRotations(.15f * ozz::math::kPi / 180.f, &input.tracks[2]);
+
+  AnimationOptimizer optimizer;
+  ASSERT_TRUE(optimizer.rotation_tolerance > .05f * ozz::math::kPi / 180.f);
+  ASSERT_TRUE(optimizer.rotation_tolerance < .15f * ozz::math::kPi / 180.f);
+
+  { // Local tolerances.
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, &output));
+    ASSERT_EQ(output.num_tracks(), 3);
+    EXPECT_EQ(output.tracks[0].rotations.size(), 2u);
+    EXPECT_EQ(output.tracks[2].rotations.size(), 3u);
+  }
+
+  { // Hierarchical tolerances.
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    ASSERT_EQ(output.num_tracks(), 3);
+    EXPECT_FLOAT_EQ(output.duration, input.duration);
+    EXPECT_EQ(output.tracks[0].rotations.size(), 3u);
+    EXPECT_EQ(output.tracks[1].translations.size(), 1u);
+    EXPECT_EQ(output.tracks[2].rotations.size(), 2u);
+  }
+
+  { // Looser hierarchical tolerance.
+    optimizer.hierarchical_tolerance = 1e-2f;
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    EXPECT_EQ(output.tracks[0].rotations.size(), 2u);
+    EXPECT_EQ(output.tracks[2].rotations.size(), 2u);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Report, AnimationOptimizer) {
+  ozz::animation::Skeleton* skeleton = BuildChain();
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(3);
+  for (int i = 1; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+      0.f, ozz::math::Float3(0.f, 1.f, 0.f)};
+    input.tracks[i].translations.push_back(key);
+  }
+  const float root_angle = .05f * ozz::math::kPi / 180.f;
+  PushRotations(root_angle, &input.tracks[0]);
+  const float leaf_angle = .15f * ozz::math::kPi / 180.f;
+  PushRotations(leaf_angle, &input.tracks[2]);
+
+  AnimationOptimizer optimizer;
+  AnimationOptimizer::Report report;
+  optimizer.report = &report;
+
+  { // Invalid sampling rate.
+    optimizer.report_sampling_rate = 0.f;
+    RawAnimation output;
+    EXPECT_FALSE(optimizer(input, &output));
+    EXPECT_FALSE(optimizer(input, *skeleton, &output));
+    optimizer.report_sampling_rate = 30.f;
+  }
+
+  { // Local tolerances, root middle key is removed.
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, &output));
+    ASSERT_EQ(report.tracks.size(), 3u);
+
+    const AnimationOptimizer::Report::Track& root = report.tracks[0];
+    EXPECT_EQ(root.input_rotations, 3);
+    EXPECT_EQ(root.output_rotations, 2);
+    EXPECT_EQ(root.input_translations, 0);
+    EXPECT_EQ(root.output_translations, 0);
+    // Middle key time is sampled.
+    EXPECT_NEAR(root.max_rotation_error, root_angle, 1e-5f);
+    EXPECT_GT(root.rms_rotation_error, 0.f);
+    EXPECT_LT(root.rms_rotation_error, root.max_rotation_error);
+    EXPECT_FLOAT_EQ(root.max_translation_error, 0.f);
+    EXPECT_FLOAT_EQ(root.max_scale_error, 0.f);
+    // Model space isn't measured without skeleton.
+    EXPECT_FLOAT_EQ(root.max_model_error, 0.f);
+
+    const AnimationOptimizer::Report::Track& leaf = report.tracks[2];
+    EXPECT_EQ(leaf.input_rotations, 3);
+    EXPECT_EQ(leaf.output_rotations, 3);
+    EXPECT_EQ(leaf.input_translations, 1);
+    EXPECT_EQ(leaf.output_translations, 1);
+    EXPECT_NEAR(leaf.max_rotation_error, 0.f, 1e-5f);
+
+    const AnimationOptimizer::Report::Track& total = report.total;
+    EXPECT_EQ(total.input_rotations, 6);
+    EXPECT_EQ(total.output_rotations, 5);
+    EXPECT_EQ(total.input_translations, 2);
+    EXPECT_EQ(total.output_translations, 2);
+    EXPECT_FLOAT_EQ(total.max_rotation_error, root.max_rotation_error);
+    EXPECT_LT(total.rms_rotation_error, root.rms_rotation_error);
+    EXPECT_FLOAT_EQ(total.max_model_error, 0.f);
+  }
+
+  { // Hierarchical tolerances, leaf middle key is removed.
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    ASSERT_EQ(report.tracks.size(), 3u);
+
+    const AnimationOptimizer::Report::Track& root = report.tracks[0];
+    EXPECT_EQ(root.output_rotations, 3);
+    EXPECT_NEAR(root.max_rotation_error, 0.f, 1e-5f);
+
+    const AnimationOptimizer::Report::Track& leaf = report.tracks[2];
+    EXPECT_EQ(leaf.output_rotations, 2);
+    EXPECT_NEAR(leaf.max_rotation_error, leaf_angle, 1e-5f);
+
+    // Leaf rotation moves points at hierarchical_distance.
+    EXPECT_NEAR(leaf.max_model_error,
+                optimizer.hierarchical_distance * leaf_angle, 1e-5f);
+    EXPECT_NEAR(report.tracks[0].max_model_error, 0.f, 1e-5f);
+    EXPECT_NEAR(report.tracks[1].max_model_error, 0.f, 1e-5f);
+    EXPECT_FLOAT_EQ(report.total.max_model_error, leaf.max_model_error);
+    EXPECT_LT(report.total.max_model_error, optimizer.hierarchical_tolerance);
+    EXPECT_GT(report.total.rms_model_error, 0.f);
+  }
+
+  { // Empty animation.
+    RawAnimation empty;
+    RawAnimation output;
+    optimizer.report = &report;
+    ASSERT_TRUE(optimizer(empty, &output));
+    EXPECT_EQ(report.tracks.size(), 0u);
+    EXPECT_EQ(report.total.input_rotations, 0);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Implements a dispatcher that runs work items in reverse order.
+class ReverseDispatcher : public ozz::tasks::Dispatcher {
+ public:
+  ReverseDispatcher()
+      : count(0) {
+  }
+  virtual void Dispatch(const ozz::tasks::Task& _task, int _count) {
+    for (int i = _count - 1; i >= 0; --i) {
+      _task.Run(i);
+    }
+    count += _count;
+  }
+  int count;
+};
+
+float Random() {
+  return static_cast<float>(rand()) / RAND_MAX;
+}
+}  // namespace
+
+TEST(Dispatcher, AnimationOptimizer) {
+  // Builds a raw animation with random keys, and a different number of keys
+  // per track.
+  RawAnimation input;
+  input.duration = 10.f;
+  input.tracks.resize(37);
+  srand(17);
+  for (int i = 0; i < input.num_tracks(); ++i) {
+    RawAnimation::JointTrack& track = input.tracks[i];
+    const int num_keys = i * 5 % 19;
+    for (int j = 0; j < num_keys; ++j) {
+      const float time = input.duration * j / num_keys;
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(Random(), 0.f, Random() * 1e-3f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromEuler(
+          ozz::math::Float3(Random() * 1e-2f, 0.f, 0.f))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+        time, ozz::math::Float3(1.f, 1.f + Random() * 1e-2f, 1.f)};
+      track.scales.push_back(skey);
+    }
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  RawAnimation serial;
+  ASSERT_TRUE(optimizer(input, &serial));
+
+  ReverseDispatcher dispatcher;
+  optimizer.dispatcher = &dispatcher;
+  RawAnimation dispatched;
+  ASSERT_TRUE(optimizer(input, &dispatched));
+  EXPECT_EQ(dispatcher.count, input.num_tracks());
+
+  // Both animations are identical.
+  EXPECT_FLOAT_EQ(serial.duration, dispatched.duration);
+  ASSERT_EQ(serial.num_tracks(), dispatched.num_tracks());
+  for (int i = 0; i < serial.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& a = serial.tracks[i];
+    const RawAnimation::JointTrack& b = dispatched.tracks[i];
+    ASSERT_EQ(a.translations.size(), b.translations.size());
+    for (size_t j = 0; j < a.translations.size(); ++j) {
+      EXPECT_EQ(a.translations[j].time, b.translations[j].time);
+      EXPECT_EQ(a.translations[j].value.x, b.translations[j].value.x);
+      EXPECT_EQ(a.translations[j].value.z, b.translations[j].value.z);
+    }
+    ASSERT_EQ(a.rotations.size(), b.rotations.size());
+    for (size_t j = 0; j < a.rotations.size(); ++j) {
+      EXPECT_EQ(a.rotations[j].time, b.rotations[j].time);
+      EXPECT_EQ(a.rotations[j].value.x, b.rotations[j].value.x);
+      EXPECT_EQ(a.rotations[j].value.w, b.rotations[j].value.w);
+    }
+    ASSERT_EQ(a.scales.size(), b.scales.size());
+    for (size_t j = 0; j < a.scales.size(); ++j) {
+      EXPECT_EQ(a.scales[j].time, b.scales[j].time);
+      EXPECT_EQ(a.scales[j].value.y, b.scales[j].value.y);
+    }
+  }
+}
+
+TEST(AnalysisError, AnimationOptimizer) {
+  AnimationOptimizer optimizer;
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(2);
+
+  { // NULL analysis.
+    EXPECT_FALSE(optimizer.Analyze(input, NULL));
+  }
+
+  { // Invalid input animation.
+    RawAnimation invalid;
+    invalid.duration = -1.f;
+    AnimationOptimizer::Analysis analysis;
+    analysis.tracks.resize(1);
+    EXPECT_FALSE(optimizer.Analyze(invalid, &analysis));
+    EXPECT_EQ(analysis.tracks.size(), 0u);
+    EXPECT_EQ(analysis.animation.num_tracks(), 0);
+  }
+
+  { // Invalid reduction window.
+    AnimationOptimizer windowed;
+    windowed.reduction = AnimationOptimizer::kWindowed;
+    windowed.reduction_window = 0;
+    AnimationOptimizer::Analysis analysis;
+    EXPECT_FALSE(windowed.Analyze(input, &analysis));
+  }
+
+  AnimationOptimizer::Analysis analysis;
+  ASSERT_TRUE(optimizer.Analyze(input, &analysis));
+  EXPECT_EQ(analysis.tracks.size(), 2u);
+  EXPECT_EQ(analysis.animation.num_tracks(), 2);
+
+  { // NULL output.
+    EXPECT_FALSE(optimizer(analysis, NULL));
+  }
+
+  { // Analysis doesn't match its animation.
+    AnimationOptimizer::Analysis mismatch = analysis;
+    const RawAnimation::TranslationKey key = {0.f, ozz::math::Float3::one()};
+    mismatch.animation.tracks[1].translations.push_back(key);
+    RawAnimation output;
+    output.tracks.resize(1);
+    EXPECT_FALSE(optimizer(mismatch, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+
+    mismatch = analysis;
+    mismatch.tracks.resize(1);
+    EXPECT_FALSE(optimizer(mismatch, &output));
+  }
+
+  { // Invalid report sampling rate.
+    AnimationOptimizer::Report report;
+    AnimationOptimizer reporting;
+    reporting.report = &report;
+    reporting.report_sampling_rate = 0.f;
+    RawAnimation output;
+    EXPECT_FALSE(reporting(analysis, &output));
+  }
+
+  { // Skeleton doesn't match.
+    ozz::animation::Skeleton* skeleton = BuildChain();
+    ASSERT_TRUE(skeleton != NULL);
+    RawAnimation output;
+    EXPECT_FALSE(optimizer(analysis, *skeleton, &output));
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  { // Valid.
+    RawAnimation output;
+    EXPECT_TRUE(optimizer(analysis, &output));
+    EXPECT_EQ(output.num_tracks(), 2);
+  }
+}
+
+TEST(Analysis, AnimationOptimizer) {
+  // Keys are sampled at the report rate, so report errors are measured at
+  // every key.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  srand(11);
+  RawAnimation::JointTrack& track = input.tracks[0];
+  for (int i = 0; i <= 30; ++i) {
+    const float time = i / 30.f;
+    const RawAnimation::TranslationKey key = {
+      time, ozz::math::Float3(std::sin(time * 6.f) + Random() * 1e-3f,
+                              0.f,
+                              time * time)};
+    track.translations.push_back(key);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  AnimationOptimizer::Analysis analysis;
+  ASSERT_TRUE(optimizer.Analyze(input, &analysis));
+  EXPECT_EQ(analysis.interpolation, RawAnimation::kLinear);
+  ASSERT_EQ(analysis.tracks.size(), 1u);
+  const ozz::Vector<float>::Std& ranks = analysis.tracks[0].translations;
+  ASSERT_EQ(ranks.size(), track.translations.size());
+  EXPECT_GT(ranks.front(), 1e30f);
+  EXPECT_GT(ranks.back(), 1e30f);
+
+  // Every tier is within its tolerance, and keeps a subset of the keys of
+  // the finer tiers.
+  const float tolerances[] = {0.f, 1e-4f, 1e-3f, 1e-2f, 1e-1f, 1.f};
+  AnimationOptimizer::Report report;
+  optimizer.report = &report;
+  optimizer.report_sampling_rate = 30.f;
+  RawAnimation previous = input;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(tolerances); ++i) {
+    optimizer.translation_tolerance = tolerances[i];
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(analysis, &output));
+    ASSERT_EQ(output.num_tracks(), 1);
+    EXPECT_EQ(output.interpolation, RawAnimation::kLinear);
+    EXPECT_FLOAT_EQ(output.duration, input.duration);
+    EXPECT_LE(report.total.max_translation_error, tolerances[i] + 1e-5f);
+
+    const RawAnimation::JointTrack::Translations& keys =
+      output.tracks[0].translations;
+    const RawAnimation::JointTrack::Translations& previous_keys =
+      previous.tracks[0].translations;
+    EXPECT_GE(keys.size(), 2u);
+    EXPECT_LE(keys.size(), previous_keys.size());
+    size_t found = 0;
+    for (size_t j = 0; j < keys.size(); ++j) {
+      for (size_t k = 0; k < previous_keys.size(); ++k) {
+        found += keys[j].time == previous_keys[k].time;
+      }
+    }
+    EXPECT_EQ(found, keys.size());
+    previous = output;
+  }
+  EXPECT_LT(previous.tracks[0].translations.size(),
+            track.translations.size() / 2);
+
+  // Analysis doesn't depend on the dispatcher.
+  ReverseDispatcher dispatcher;
+  optimizer.dispatcher = &dispatcher;
+  AnimationOptimizer::Analysis dispatched;
+  ASSERT_TRUE(optimizer.Analyze(input, &dispatched));
+  EXPECT_EQ(dispatcher.count, 1);
+  ASSERT_EQ(dispatched.tracks.size(), 1u);
+  EXPECT_TRUE(dispatched.tracks[0].translations == ranks);
+}
+
+TEST(AnalysisWindowed, AnimationOptimizer) {
+  // Constant keys can all be removed, but at most 2 consecutive ones.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  for (int i = 0; i < 10; ++i) {
+    const RawAnimation::ScaleKey key = {i / 9.f, ozz::math::Float3::one()};
+    input.tracks[0].scales.push_back(key);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  optimizer.scale_tolerance = 1.f;
+  AnimationOptimizer::Analysis analysis;
+  RawAnimation output;
+
+  ASSERT_TRUE(optimizer.Analyze(input, &analysis));
+  ASSERT_TRUE(optimizer(analysis, &output));
+  EXPECT_EQ(output.tracks[0].scales.size(), 2u);
+
+  optimizer.reduction = AnimationOptimizer::kWindowed;
+  optimizer.reduction_window = 2;
+  ASSERT_TRUE(optimizer.Analyze(input, &analysis));
+  ASSERT_TRUE(optimizer(analysis, &output));
+  const RawAnimation::JointTrack::Scales& scales = output.tracks[0].scales;
+  ASSERT_GE(scales.size(), 4u);
+  for (size_t i = 1; i < scales.size(); ++i) {
+    EXPECT_LE(scales[i].time - scales[i - 1].time, 3.f / 9.f + 1e-5f);
+  }
+}
+
+TEST(AnalysisHermite, AnimationOptimizer) {
+  // A smooth curve, which Hermite interpolation approximates with far fewer
+  // keys.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  for (int i = 0; i <= 30; ++i) {
+    const float time = i / 30.f;
+    const RawAnimation::TranslationKey key = {
+      time, ozz::math::Float3(std::sin(time * 3.f), 0.f, 0.f)};
+    input.tracks[0].translations.push_back(key);
+  }
+
+  AnimationOptimizer optimizer;
+  AnimationOptimizer::Analysis linear;
+  ASSERT_TRUE(optimizer.Analyze(input, &linear));
+  RawAnimation linear_output;
+  ASSERT_TRUE(optimizer(linear, &linear_output));
+
+  optimizer.interpolation = RawAnimation::kHermite;
+  AnimationOptimizer::Analysis hermite;
+  ASSERT_TRUE(optimizer.Analyze(input, &hermite));
+  EXPECT_EQ(hermite.interpolation, RawAnimation::kHermite);
+
+  // Extraction interpolation is the analysis one.
+  optimizer.interpolation = RawAnimation::kLinear;
+  AnimationOptimizer::Report report;
+  optimizer.report = &report;
+  RawAnimation output;
+  ASSERT_TRUE(optimizer(hermite, &output));
+  EXPECT_EQ(output.interpolation, RawAnimation::kHermite);
+  EXPECT_TRUE(output.Validate());
+  EXPECT_EQ(output.tracks[0].translation_tangents.size(),
+            output.tracks[0].translations.size());
+  EXPECT_LT(output.tracks[0].translations.size(),
+            linear_output.tracks[0].translations.size());
+  EXPECT_LE(report.total.max_translation_error,
+            optimizer.translation_tolerance + 1e-5f);
+}
+
+TEST(AnalysisHierarchical, AnimationOptimizer) {
+  ozz::animation::Skeleton* skeleton = BuildChain();
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Same animation as the Hierarchical test.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(3);
+  for (int i = 1; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+      0.f, ozz::math::Float3(0.f, 1.f, 0.f)};
+    input.tracks[i].translations.push_back(key);
+  }
+  PushRotations(.05f * ozz::math::kPi / 180.f, &input.tracks[0]);
+  PushRotations(.15f * ozz::math::kPi / 180.f, &input.tracks[2]);
+
+  AnimationOptimizer optimizer;
+  AnimationOptimizer::Analysis analysis;
+  ASSERT_TRUE(optimizer.Analyze(input, &analysis));
+
+  { // Local tolerances.
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(analysis, &output));
+    EXPECT_EQ(output.tracks[0].rotations.size(), 2u);
+    EXPECT_EQ(output.tracks[2].rotations.size(), 3u);
+  }
+
+  { // Hierarchical tolerances.
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(analysis, *skeleton, &output));
+    EXPECT_EQ(output.tracks[0].rotations.size(), 3u);
+    EXPECT_EQ(output.tracks[1].translations.size(), 1u);
+    EXPECT_EQ(output.tracks[2].rotations.size(), 2u);
+  }
+
+  { // Looser hierarchical tolerance.
+    optimizer.hierarchical_tolerance = 1e-2f;
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(analysis, *skeleton, &output));
+    EXPECT_EQ(output.tracks[0].rotations.size(), 2u);
+    EXPECT_EQ(output.tracks[2].rotations.size(), 2u);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,162 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_page_builder.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+using ozz::animation::Animation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::AnimationPageBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a 5 tracks animation (to test soa padding) with keys at different
+// times for every track.
+Animation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(5);
+  for (int t = 0; t < 5; ++t) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[t];
+    // Track 4 has constant values, with no key.
+    if (t == 4) {
+      continue;
+    }
+    const float step = .05f * (t + 1);
+    for (int k = 0; k * step <= raw_animation.duration; ++k) {
+      const float time = k * step;
+      const float value = static_cast<float>(k * (t + 1));
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(value, -value, 1.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion(0.f, 0.f, (k & 1) * .7071f, .7071f)};
+      track.rotations.push_back(rkey);
+      if (k % 3 == 0) {
+        const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f, 1.f + value, 1.f)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Samples _animation at _time, using _cache.
+void Sample(const Animation& _animation, float _time,
+            ozz::animation::SamplingCache* _cache,
+            ozz::math::SoaTransform* _output, int _count) {
+  ozz::animation::SamplingJob job;
+  job.animation = &_animation;
+  job.cache = _cache;
+  job.time = _time;
+  job.output.begin = _output;
+  job.output.end = _output + _count;
+  ASSERT_TRUE(job.Run());
+}
+}  // namespace
+
+TEST(Error, AnimationPageBuilder) {
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  AnimationPageBuilder builder;
+  EXPECT_TRUE(builder(*animation, -.1f, 1.f) == NULL);
+  EXPECT_TRUE(builder(*animation, 1.f, .5f) == NULL);
+  EXPECT_TRUE(builder(*animation, 1.f, 2.1f) == NULL);
+
+  Animation* page = builder(*animation, 0.f, 2.f);
+  ASSERT_TRUE(page != NULL);
+  EXPECT_EQ(page->num_tracks(), animation->num_tracks());
+  EXPECT_FLOAT_EQ(page->duration(), animation->duration());
+  ozz::memory::default_allocator()->Delete(page);
+
+  // Empty range.
+  page = builder(*animation, 1.f, 1.f);
+  ASSERT_TRUE(page != NULL);
+  ozz::memory::default_allocator()->Delete(page);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, AnimationPageBuilder) {
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+  const int num_soa_tracks = animation->num_soa_tracks();
+  ASSERT_EQ(num_soa_tracks, 2);
+
+  AnimationPageBuilder builder;
+  ozz::animation::SamplingCache reference_cache(animation->num_tracks());
+  ozz::animation::SamplingCache page_cache(animation->num_tracks());
+
+  const float kPageDuration = .3f;
+  for (float begin = 0.f; begin < animation->duration();
+       begin += kPageDuration) {
+    const float end = ozz::math::Min(begin + kPageDuration,
+                                     animation->duration());
+    Animation* page = builder(*animation, begin, end);
+    ASSERT_TRUE(page != NULL);
+
+    // Page can be allocated at the address of the previous one.
+    page_cache.Invalidate();
+
+    // Pages are smaller than the original animation.
+    EXPECT_LT(page->size(), animation->size());
+
+    // Samples forward, and then backward, along page range. Page and original
+    // animation use the same keys, so results must be strictly identical.
+    for (int dir = 0; dir < 2; ++dir) {
+      for (int i = 0; i <= 20; ++i) {
+        const float ratio = (dir == 0 ? i : 20 - i) / 20.f;
+        const float time = begin + (end - begin) * ratio;
+        ozz::math::SoaTransform reference[2];
+        Sample(*animation, time, &reference_cache, reference, 2);
+        ozz::math::SoaTransform paged[2];
+        Sample(*page, time, &page_cache, paged, 2);
+        EXPECT_EQ(std::memcmp(reference, paged, sizeof(reference)), 0) <<
+          "time " << time;
+      }
+    }
+    ozz::memory::default_allocator()->Delete(page);
+  }
+  ozz::memory::default_allocator()->Delete(animation);
+}
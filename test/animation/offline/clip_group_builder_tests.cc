@@ -0,0 +1,204 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/clip_group_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::ClipGroupBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a clip of _num_tracks tracks, whose translation x goes from 0 to
+// _value over _duration.
+void BuildClip(int _num_tracks, float _duration, float _value,
+               RawAnimation* _clip) {
+  _clip->duration = _duration;
+  _clip->tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    const RawAnimation::TranslationKey first = {
+      0.f, ozz::math::Float3::zero()};
+    const RawAnimation::TranslationKey last = {
+      _duration, ozz::math::Float3(_value, 0.f, 0.f)};
+    _clip->tracks[i].translations.push_back(first);
+    _clip->tracks[i].translations.push_back(last);
+  }
+}
+}  // namespace
+
+TEST(Error, ClipGroupBuilder) {
+  ClipGroupBuilder builder;
+  RawAnimation clip;
+  BuildClip(3, 1.f, 1.f, &clip);
+
+  {  // Empty group.
+    EXPECT_TRUE(!builder(ozz::Range<const RawAnimation* const>()));
+  }
+
+  {  // NULL clip.
+    const RawAnimation* clips[] = {&clip, NULL};
+    EXPECT_TRUE(!builder(ozz::Range<const RawAnimation* const>(clips)));
+  }
+
+  {  // Invalid clip.
+    RawAnimation invalid;
+    BuildClip(3, 1.f, 1.f, &invalid);
+    invalid.duration = -1.f;
+    const RawAnimation* clips[] = {&clip, &invalid};
+    EXPECT_TRUE(!builder(ozz::Range<const RawAnimation* const>(clips)));
+  }
+
+  {  // Number of tracks mismatch.
+    RawAnimation other;
+    BuildClip(4, 1.f, 1.f, &other);
+    const RawAnimation* clips[] = {&clip, &other};
+    EXPECT_TRUE(!builder(ozz::Range<const RawAnimation* const>(clips)));
+  }
+
+  {  // Interpolation mismatch.
+    RawAnimation other;
+    BuildClip(3, 1.f, 1.f, &other);
+    other.interpolation = RawAnimation::kHermite;
+    other.tracks.clear();
+    const RawAnimation* clips[] = {&clip, &other};
+    EXPECT_TRUE(!builder(ozz::Range<const RawAnimation* const>(clips)));
+  }
+
+  {  // Too many tracks.
+    RawAnimation big;
+    BuildClip(Skeleton::kMaxJoints / 2 + 1, 1.f, 1.f, &big);
+    const RawAnimation* clips[] = {&big, &big};
+    EXPECT_TRUE(!builder(ozz::Range<const RawAnimation* const>(clips)));
+  }
+
+  {  // Valid group.
+    const RawAnimation* clips[] = {&clip, &clip};
+    Animation* group = builder(ozz::Range<const RawAnimation* const>(clips));
+    ASSERT_TRUE(group != NULL);
+    ozz::memory::default_allocator()->Delete(group);
+  }
+}
+
+TEST(Layout, ClipGroupBuilder) {
+  RawAnimation clip0;
+  BuildClip(5, 2.f, 4.f, &clip0);
+  RawAnimation clip1;
+  BuildClip(5, .5f, -2.f, &clip1);
+  RawAnimation clip2;
+  BuildClip(5, 1.f, 1.f, &clip2);
+  const RawAnimation* clips[] = {&clip0, &clip1, &clip2};
+
+  ClipGroupBuilder builder;
+  Animation* group = builder(ozz::Range<const RawAnimation* const>(clips));
+  ASSERT_TRUE(group != NULL);
+
+  // Every clip is padded to 2 soa tracks, and normalized to 1s.
+  EXPECT_EQ(group->num_tracks(), 24);
+  EXPECT_EQ(group->num_soa_tracks(), 6);
+  EXPECT_FLOAT_EQ(group->duration(), 1.f);
+
+  SamplingCache cache(group->num_tracks());
+  ozz::math::SoaTransform output[6];
+  SamplingJob job;
+  job.animation = group;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 6;
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+
+  // Clip 0, 5th track is the first of the 2nd soa track.
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 2.f, 2.f, 2.f, 2.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 2.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  // Clip 1.
+  EXPECT_SOAFLOAT3_EQ_EST(output[2].translation, -1.f, -1.f, -1.f, -1.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[3].translation, -1.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  // Clip 2.
+  EXPECT_SOAFLOAT3_EQ_EST(output[4].translation, .5f, .5f, .5f, .5f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[5].translation, .5f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(group);
+}
+
+TEST(Hermite, ClipGroupBuilder) {
+  // A 2s clip whose tangents are 1 unit per second.
+  RawAnimation clip;
+  clip.duration = 2.f;
+  clip.interpolation = RawAnimation::kHermite;
+  clip.tracks.resize(1);
+  const RawAnimation::TranslationKey first = {0.f, ozz::math::Float3::zero()};
+  const RawAnimation::TranslationKey last = {
+    2.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  clip.tracks[0].translations.push_back(first);
+  clip.tracks[0].translations.push_back(last);
+  clip.tracks[0].translation_tangents.push_back(
+    ozz::math::Float3(1.f, 0.f, 0.f));
+  clip.tracks[0].translation_tangents.push_back(
+    ozz::math::Float3(1.f, 0.f, 0.f));
+  const RawAnimation* clips[] = {&clip};
+
+  ClipGroupBuilder builder;
+  Animation* group = builder(ozz::Range<const RawAnimation* const>(clips));
+  ASSERT_TRUE(group != NULL);
+
+  // Tangents are rescaled, so the curve remains linear once normalized.
+  SamplingCache cache(group->num_tracks());
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = group;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+  job.time = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .5f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(group);
+}
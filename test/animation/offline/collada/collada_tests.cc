@@ -0,0 +1,414 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/collada/collada.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+#include "ozz/animation/offline/joint_track_sampler.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/thread_caching_allocator.h"
+#include "ozz/base/tasks/thread_pool.h"
+
+#include "ozz/options/options.h"
+
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/offline/collada/collada_base.h"
+
+OZZ_OPTIONS_DECLARE_STRING(media, "Specifies media directory", "", true)
+OZZ_OPTIONS_DECLARE_STRING(temp, "Specifies temporary directory", "", true)
+
+int main(int _argc, char** _argv) {
+  // Parses arguments.
+  testing::InitGoogleTest(&_argc, _argv);
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+    _argc, _argv,
+    "1.0",
+    "Test Collada streaming import against document import");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ?
+      EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  return RUN_ALL_TESTS();
+}
+
+using ozz::animation::offline::JointTrackSampler;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+
+namespace {
+ozz::String::Std MediaPath(const char* _filename) {
+  return ozz::String::Std(OPTIONS_media.value()) + "/" + _filename;
+}
+
+// Loads _filename content to a string, for ImportFromMemory.
+ozz::String::Std LoadFile(const char* _filename) {
+  ozz::String::Std content;
+  ozz::io::File file(_filename, "rb");
+  char buffer[4096];
+  for (size_t read = file.opened() ? file.Read(buffer, sizeof(buffer)) : 0;
+       read != 0;
+       read = file.Read(buffer, sizeof(buffer))) {
+    content.append(buffer, read);
+  }
+  return content;
+}
+
+void WriteFile(const char* _filename, const char* _content) {
+  ozz::io::File file(_filename, "wb");
+  ASSERT_TRUE(file.opened());
+  file.Write(_content, std::strlen(_content));
+}
+
+void ExpectJointsEq(const RawSkeleton::Joint& _a,
+                    const RawSkeleton::Joint& _b) {
+  EXPECT_STREQ(_a.name.c_str(), _b.name.c_str());
+  EXPECT_EQ(_a.transform.translation.x, _b.transform.translation.x);
+  EXPECT_EQ(_a.transform.translation.y, _b.transform.translation.y);
+  EXPECT_EQ(_a.transform.translation.z, _b.transform.translation.z);
+  EXPECT_EQ(_a.transform.rotation.x, _b.transform.rotation.x);
+  EXPECT_EQ(_a.transform.rotation.y, _b.transform.rotation.y);
+  EXPECT_EQ(_a.transform.rotation.z, _b.transform.rotation.z);
+  EXPECT_EQ(_a.transform.rotation.w, _b.transform.rotation.w);
+  EXPECT_EQ(_a.transform.scale.x, _b.transform.scale.x);
+  EXPECT_EQ(_a.transform.scale.y, _b.transform.scale.y);
+  EXPECT_EQ(_a.transform.scale.z, _b.transform.scale.z);
+  ASSERT_EQ(_a.children.size(), _b.children.size());
+  for (size_t i = 0; i < _a.children.size(); ++i) {
+    ExpectJointsEq(_a.children[i], _b.children[i]);
+  }
+}
+
+// Imports _filename skeleton from file (streamed) and from memory (document),
+// and expects both to be the same.
+bool ExpectSkeletonImportsEq(const char* _filename, RawSkeleton* _skeleton) {
+  const bool streamed =
+    ozz::animation::offline::collada::ImportFromFile(_filename, _skeleton);
+  RawSkeleton document;
+  const bool loaded = ozz::animation::offline::collada::ImportFromMemory(
+    LoadFile(_filename).c_str(), &document);
+  EXPECT_EQ(streamed, loaded) << _filename;
+  EXPECT_EQ(_skeleton->roots.size(), document.roots.size()) << _filename;
+  for (size_t i = 0;
+       i < _skeleton->roots.size() && i < document.roots.size();
+       ++i) {
+    ExpectJointsEq(_skeleton->roots[i], document.roots[i]);
+  }
+  return streamed;
+}
+
+template<typename _Keys>
+void ExpectKeysEq(const _Keys& _a, const _Keys& _b) {
+  ASSERT_EQ(_a.size(), _b.size());
+  for (size_t i = 0; i < _a.size(); ++i) {
+    EXPECT_EQ(_a[i].time, _b[i].time);
+  }
+}
+
+// Imports _filename animation from file (streamed), baking tracks with the
+// optional _dispatcher, and from memory (document) sequentially, and expects
+// both to be the same.
+bool ExpectAnimationImportsEq(const char* _filename,
+                              const ozz::animation::Skeleton& _skeleton,
+                              ozz::tasks::Dispatcher* _dispatcher = NULL) {
+  const JointTrackSampler sampler;
+  RawAnimation streamed;
+  const bool streamed_success =
+    ozz::animation::offline::collada::ImportFromFile(
+      _filename, _skeleton, sampler, &streamed, _dispatcher);
+  RawAnimation document;
+  const bool document_success =
+    ozz::animation::offline::collada::ImportFromMemory(
+      LoadFile(_filename).c_str(), _skeleton, sampler, &document);
+  EXPECT_EQ(streamed_success, document_success) << _filename;
+  EXPECT_EQ(streamed.duration, document.duration);
+  EXPECT_EQ(streamed.tracks.size(), document.tracks.size());
+  for (size_t i = 0;
+       i < streamed.tracks.size() && i < document.tracks.size();
+       ++i) {
+    const RawAnimation::JointTrack& a = streamed.tracks[i];
+    const RawAnimation::JointTrack& b = document.tracks[i];
+    ExpectKeysEq(a.translations, b.translations);
+    ExpectKeysEq(a.rotations, b.rotations);
+    ExpectKeysEq(a.scales, b.scales);
+    for (size_t j = 0;
+         j < a.translations.size() && j < b.translations.size();
+         ++j) {
+      EXPECT_EQ(a.translations[j].value.x, b.translations[j].value.x);
+      EXPECT_EQ(a.translations[j].value.y, b.translations[j].value.y);
+      EXPECT_EQ(a.translations[j].value.z, b.translations[j].value.z);
+    }
+    for (size_t j = 0; j < a.rotations.size() && j < b.rotations.size(); ++j) {
+      EXPECT_EQ(a.rotations[j].value.x, b.rotations[j].value.x);
+      EXPECT_EQ(a.rotations[j].value.w, b.rotations[j].value.w);
+    }
+  }
+  return streamed_success;
+}
+}  // namespace
+
+TEST(Skeleton, ColladaStream) {
+  const char* succeed[] = {
+    "collada/alain/skeleton.dae", "collada/seymour.dae",
+    "collada/astro_max.dae", "collada/astro_maya.dae"};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(succeed); ++i) {
+    RawSkeleton skeleton;
+    EXPECT_TRUE(
+      ExpectSkeletonImportsEq(MediaPath(succeed[i]).c_str(), &skeleton));
+    EXPECT_GT(skeleton.num_joints(), 0);
+  }
+
+  const char* fail[] = {
+    "collada/cube.dae", "collada/malformed/malformed_matrix.dae",
+    "collada/malformed/malformed_rotate.dae",
+    "collada/malformed/unsupported_skew.dae", "collada/should_not_exist.dae"};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(fail); ++i) {
+    RawSkeleton skeleton;
+    EXPECT_FALSE(
+      ExpectSkeletonImportsEq(MediaPath(fail[i]).c_str(), &skeleton));
+  }
+}
+
+TEST(Animation, ColladaStream) {
+  RawSkeleton raw_skeleton;
+  ASSERT_TRUE(ozz::animation::offline::collada::ImportFromFile(
+    MediaPath("collada/alain/skeleton.dae").c_str(), &raw_skeleton));
+  ozz::animation::offline::SkeletonBuilder builder;
+  ozz::animation::Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  EXPECT_TRUE(ExpectAnimationImportsEq(
+    MediaPath("collada/alain/atlas.dae").c_str(), *skeleton));
+  EXPECT_FALSE(ExpectAnimationImportsEq(
+    MediaPath("collada/should_not_exist.dae").c_str(), *skeleton));
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Animation, ColladaParallel) {
+  // Tracks are baked from many threads, which requires a thread safe
+  // allocator.
+  ozz::memory::Allocator* previous_allocator =
+    ozz::memory::SetDefaulAllocator(ozz::memory::thread_caching_allocator());
+  {
+    RawSkeleton raw_skeleton;
+    ASSERT_TRUE(ozz::animation::offline::collada::ImportFromFile(
+      MediaPath("collada/alain/skeleton.dae").c_str(), &raw_skeleton));
+    ozz::animation::offline::SkeletonBuilder builder;
+    ozz::animation::Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+
+    ozz::tasks::ThreadPool pool(4);
+    const char* files[] = {"collada/alain/atlas.dae", "collada/alain/walk.dae",
+                           "collada/alain/run.dae", "collada/alain/jog.dae"};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(files); ++i) {
+      EXPECT_TRUE(ExpectAnimationImportsEq(
+        MediaPath(files[i]).c_str(), *skeleton, &pool)) << files[i];
+    }
+    EXPECT_FALSE(ExpectAnimationImportsEq(
+      MediaPath("collada/should_not_exist.dae").c_str(), *skeleton, &pool));
+
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+  ozz::memory::SetDefaulAllocator(previous_allocator);
+}
+
+TEST(Animation, ColladaSampling) {
+  RawSkeleton raw_skeleton;
+  ASSERT_TRUE(ozz::animation::offline::collada::ImportFromFile(
+    MediaPath("collada/seymour.dae").c_str(), &raw_skeleton));
+  ozz::animation::offline::SkeletonBuilder builder;
+  ozz::animation::Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Imports the bezier curves of the animation with different samplers.
+  const ozz::String::Std filename = MediaPath("collada/seymour.dae");
+  JointTrackSampler sampler;
+  RawAnimation fixed;
+  ASSERT_TRUE(ozz::animation::offline::collada::ImportFromFile(
+    filename.c_str(), *skeleton, sampler, &fixed));
+  sampler.sampling_rate = 60.f;
+  RawAnimation fast;
+  ASSERT_TRUE(ozz::animation::offline::collada::ImportFromFile(
+    filename.c_str(), *skeleton, sampler, &fast));
+  sampler.sampling_rate = 30.f;
+  sampler.adaptive = true;
+  RawAnimation adaptive;
+  ASSERT_TRUE(ozz::animation::offline::collada::ImportFromFile(
+    filename.c_str(), *skeleton, sampler, &adaptive));
+  EXPECT_TRUE(fixed.Validate());
+  EXPECT_TRUE(fast.Validate());
+  EXPECT_TRUE(adaptive.Validate());
+  EXPECT_EQ(fixed.duration, adaptive.duration);
+
+  // Only rotations are animated.
+  size_t num_fixed = 0, num_fast = 0, num_adaptive = 0;
+  for (size_t i = 0; i < fixed.tracks.size(); ++i) {
+    num_fixed += fixed.tracks[i].rotations.size();
+    num_fast += fast.tracks[i].rotations.size();
+    num_adaptive += adaptive.tracks[i].rotations.size();
+  }
+  EXPECT_GT(num_fast, num_fixed);
+  EXPECT_LT(num_adaptive, num_fixed);
+
+  // Fails with an invalid sampler.
+  sampler.sampling_rate = 0.f;
+  RawAnimation invalid;
+  EXPECT_FALSE(ozz::animation::offline::collada::ImportFromFile(
+    filename.c_str(), *skeleton, sampler, &invalid));
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Syntax, ColladaStream) {
+  const ozz::String::Std filename =
+    ozz::String::Std(OPTIONS_temp.value()) + "/syntax.dae";
+
+  // Declaration, doctype, comments, cdata, entities and empty elements are
+  // supported.
+  WriteFile(filename.c_str(),
+    "\xef\xbb\xbf<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<!DOCTYPE COLLADA>\n"
+    "<!-- A <comment> -->\n"
+    "<COLLADA version='1.4.1'>\n"
+    "  <asset><unit meter=\"0.01\"/><up_axis> Z_UP </up_axis></asset>\n"
+    "  <library_geometries><geometry><![CDATA[<skipped>]]></geometry>"
+    "</library_geometries>\n"
+    "  <library_visual_scenes><visual_scene id=\"scene\">\n"
+    "    <node id=\"root\" name=\"a&amp;b&#x41;&#66;\" type=\"JOINT\">\n"
+    "      <translate sid=\"t\"> 1\t2\n 3 </translate>\n"
+    "      <node name=\"child\"><scale sid=\"s\"><![CDATA[2 2 2]]></scale>"
+    "</node>\n"
+    "      <node name='empty'/>\n"
+    "    </node>\n"
+    "  </visual_scene></library_visual_scenes>\n"
+    "</COLLADA>\n");
+  RawSkeleton skeleton;
+  ASSERT_TRUE(ExpectSkeletonImportsEq(filename.c_str(), &skeleton));
+  ASSERT_EQ(skeleton.num_joints(), 3);
+  EXPECT_STREQ(skeleton.roots[0].name.c_str(), "a&bAB");
+  EXPECT_STREQ(skeleton.roots[0].children[1].name.c_str(), "empty");
+
+  // Malformed documents.
+  const char* malformed[] = {
+    "",
+    "not xml",
+    "<COLLADA><library_visual_scenes></COLLADA>",
+    "<COLLADA><library_visual_scenes>",
+    "<COLLADA version=1.4></COLLADA>",
+    "<COLLADA><!-- unterminated comment </COLLADA>"};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(malformed); ++i) {
+    WriteFile(filename.c_str(), malformed[i]);
+    EXPECT_FALSE(ozz::animation::offline::collada::ImportFromFile(
+      filename.c_str(), &skeleton)) << malformed[i];
+  }
+}
+
+TEST(FloatParser, Collada) {
+  using ozz::animation::offline::collada::internal::ParseFloat;
+  using ozz::animation::offline::collada::internal::ParseFloats;
+
+  // Matches strtod for the values written by exporters.
+  const char* texts[] = {
+    "0", "-0", "+1", "1.", ".5", "-.5", "3.14159265", "1e3", "1E-3", "1.5e+2",
+    "0.000123456789", "123456789", "-2.5e-7", "16777217", "0.1", "1e-45",
+    "3.4028234e38", "9.99999999999999999999", "1234567890123456789012",
+    "00012.5000", "1e400", "1e-400"};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(texts); ++i) {
+    float value;
+    const char* end = ParseFloat(texts[i], &value);
+    ASSERT_TRUE(end != NULL) << texts[i];
+    EXPECT_EQ(*end, 0) << texts[i];
+    EXPECT_EQ(value, static_cast<float>(std::strtod(texts[i], NULL))) <<
+      texts[i];
+  }
+
+  // Matches strtod for random values printed with float precision.
+  std::srand(0);
+  for (int i = 0; i < 100000; ++i) {
+    const float random = (std::rand() - RAND_MAX / 2) *
+      (i % 2 ? 1e-4f : 1e-9f);
+    char text[32];
+    std::sprintf(text, "%.9g", random);
+    float value;
+    ASSERT_TRUE(ParseFloat(text, &value) != NULL);
+    ASSERT_EQ(value, static_cast<float>(std::strtod(text, NULL))) << text;
+  }
+
+  // Special values.
+  float value;
+  EXPECT_TRUE(ParseFloat("INF", &value) != NULL);
+  EXPECT_EQ(value, std::numeric_limits<float>::infinity());
+  EXPECT_TRUE(ParseFloat("-infinity", &value) != NULL);
+  EXPECT_EQ(value, -std::numeric_limits<float>::infinity());
+  EXPECT_TRUE(ParseFloat("NaN", &value) != NULL);
+  EXPECT_TRUE(value != value);
+
+  // Invalid values.
+  const char* invalid[] = {"", " ", "-", ".", "e5", "x1", "+.e1"};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(invalid); ++i) {
+    EXPECT_TRUE(ParseFloat(invalid[i], &value) == NULL) << invalid[i];
+  }
+
+  // Invalid exponents aren't consumed.
+  const char* text = "2e";
+  EXPECT_EQ(ParseFloat(text, &value), text + 1);
+  EXPECT_EQ(value, 2.f);
+  text = "2e+x";
+  EXPECT_EQ(ParseFloat(text, &value), text + 1);
+
+  // Arrays.
+  float values[4];
+  const char* end;
+  text = " 1 2.5\n\t-3e1  ";
+  EXPECT_EQ(ParseFloats(text, values, 4, &end), 3u);
+  EXPECT_EQ(values[0], 1.f);
+  EXPECT_EQ(values[1], 2.5f);
+  EXPECT_EQ(values[2], -30.f);
+  EXPECT_EQ(end, text + 12);
+  EXPECT_EQ(ParseFloats(text, values, 2, &end), 2u);
+  EXPECT_EQ(end, text + 6);
+  text = "1 2 x 4";
+  EXPECT_EQ(ParseFloats(text, values, 4, &end), 2u);
+  EXPECT_EQ(end, text + 3);
+}
@@ -0,0 +1,105 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/event_track_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_event_track.h"
+#include "ozz/animation/runtime/event_track.h"
+
+using ozz::animation::EventTrack;
+using ozz::animation::offline::RawEventTrack;
+using ozz::animation::offline::EventTrackBuilder;
+
+TEST(Validate, RawEventTrack) {
+  RawEventTrack raw_track;
+  EXPECT_TRUE(raw_track.Validate());
+
+  // Invalid duration.
+  raw_track.duration = 0.f;
+  EXPECT_FALSE(raw_track.Validate());
+  raw_track.duration = 1.f;
+
+  // Events out of range.
+  const RawEventTrack::Event late = {1.5f, 0};
+  raw_track.events.push_back(late);
+  EXPECT_FALSE(raw_track.Validate());
+  raw_track.events.back().time = -1.f;
+  EXPECT_FALSE(raw_track.Validate());
+  raw_track.events.clear();
+
+  // Events at the same time are valid, unsorted ones aren't.
+  const RawEventTrack::Event first = {.5f, 0};
+  const RawEventTrack::Event second = {.5f, 1};
+  raw_track.events.push_back(first);
+  raw_track.events.push_back(second);
+  EXPECT_TRUE(raw_track.Validate());
+  raw_track.events.back().time = .2f;
+  EXPECT_FALSE(raw_track.Validate());
+}
+
+TEST(Build, EventTrackBuilder) {
+  EventTrackBuilder builder;
+
+  {  // Invalid raw track.
+    RawEventTrack raw_track;
+    raw_track.duration = -1.f;
+    EXPECT_TRUE(!builder(raw_track));
+  }
+
+  {  // Track without any event.
+    RawEventTrack raw_track;
+    raw_track.duration = 2.f;
+    EventTrack* track = builder(raw_track);
+    ASSERT_TRUE(track != NULL);
+    EXPECT_FLOAT_EQ(track->duration(), 2.f);
+    EXPECT_EQ(track->num_events(), 0);
+    ozz::memory::default_allocator()->Delete(track);
+  }
+
+  {  // Events are copied.
+    RawEventTrack raw_track;
+    const RawEventTrack::Event events[] = {{0.f, 46}, {.5f, 69}, {1.f, 7}};
+    for (int i = 0; i < 3; ++i) {
+      raw_track.events.push_back(events[i]);
+    }
+    EventTrack* track = builder(raw_track);
+    ASSERT_TRUE(track != NULL);
+    ASSERT_EQ(track->num_events(), 3);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_FLOAT_EQ(track->events().begin[i].time, events[i].time);
+      EXPECT_EQ(track->events().begin[i].id, events[i].id);
+    }
+    ozz::memory::default_allocator()->Delete(track);
+  }
+}
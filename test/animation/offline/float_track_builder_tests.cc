@@ -0,0 +1,136 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/float_track_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_float_track.h"
+#include "ozz/animation/runtime/float_track.h"
+
+using ozz::animation::FloatTrack;
+using ozz::animation::offline::RawFloatTrack;
+using ozz::animation::offline::FloatTrackBuilder;
+
+TEST(Validate, RawFloatTrack) {
+  RawFloatTrack raw_track;
+  EXPECT_TRUE(raw_track.Validate());
+
+  // Invalid duration.
+  raw_track.duration = 0.f;
+  EXPECT_FALSE(raw_track.Validate());
+  raw_track.duration = 1.f;
+
+  raw_track.curves.resize(2);
+  EXPECT_TRUE(raw_track.Validate());
+
+  // Key out of range.
+  const RawFloatTrack::Key late = {1.5f, 0.f};
+  raw_track.curves[1].keys.push_back(late);
+  EXPECT_FALSE(raw_track.Validate());
+  raw_track.curves[1].keys.clear();
+
+  // Unsorted keys.
+  const RawFloatTrack::Key first = {.5f, 0.f};
+  const RawFloatTrack::Key second = {.2f, 1.f};
+  raw_track.curves[0].keys.push_back(first);
+  raw_track.curves[0].keys.push_back(second);
+  EXPECT_FALSE(raw_track.Validate());
+  raw_track.curves[0].keys[1].time = .5f;
+  EXPECT_FALSE(raw_track.Validate());
+  raw_track.curves[0].keys[1].time = .7f;
+  EXPECT_TRUE(raw_track.Validate());
+
+  // Too many curves.
+  raw_track.curves.resize(RawFloatTrack::kMaxCurves + 1);
+  EXPECT_FALSE(raw_track.Validate());
+}
+
+TEST(Build, FloatTrackBuilder) {
+  FloatTrackBuilder builder;
+
+  {  // Invalid raw track.
+    RawFloatTrack raw_track;
+    raw_track.duration = -1.f;
+    EXPECT_TRUE(!builder(raw_track));
+  }
+
+  {  // Track without any curve.
+    RawFloatTrack raw_track;
+    raw_track.duration = 2.f;
+    FloatTrack* track = builder(raw_track);
+    ASSERT_TRUE(track != NULL);
+    EXPECT_FLOAT_EQ(track->duration(), 2.f);
+    EXPECT_EQ(track->num_curves(), 0);
+    EXPECT_EQ(track->num_soa_curves(), 0);
+    EXPECT_EQ(track->size(), sizeof(FloatTrack));
+    ozz::memory::default_allocator()->Delete(track);
+  }
+
+  {  // Curves are fixed up and padded.
+    RawFloatTrack raw_track;
+    raw_track.curves.resize(5);
+    const RawFloatTrack::Key key0 = {.5f, 2.f};
+    raw_track.curves[1].keys.push_back(key0);
+    const RawFloatTrack::Key key1 = {0.f, 1.f};
+    const RawFloatTrack::Key key2 = {.2f, 3.f};
+    const RawFloatTrack::Key key3 = {1.f, 4.f};
+    raw_track.curves[4].keys.push_back(key1);
+    raw_track.curves[4].keys.push_back(key2);
+    raw_track.curves[4].keys.push_back(key3);
+
+    FloatTrack* track = builder(raw_track);
+    ASSERT_TRUE(track != NULL);
+    EXPECT_EQ(track->num_curves(), 5);
+    EXPECT_EQ(track->num_soa_curves(), 2);
+
+    // 8 curves of 2 keys, curves 1 and 4 having one more. Keys are 8 bytes.
+    EXPECT_EQ(track->size(), sizeof(FloatTrack) + 18 * 8);
+    ozz::memory::default_allocator()->Delete(track);
+  }
+
+  {  // Keys in the same key time unit are merged.
+    RawFloatTrack raw_track;
+    raw_track.curves.resize(1);
+    const RawFloatTrack::Key key0 = {0.f, 1.f};
+    const RawFloatTrack::Key key1 = {1e-7f, 2.f};
+    const RawFloatTrack::Key key2 = {1.f - 1e-7f, 3.f};
+    raw_track.curves[0].keys.push_back(key0);
+    raw_track.curves[0].keys.push_back(key1);
+    raw_track.curves[0].keys.push_back(key2);
+
+    FloatTrack* track = builder(raw_track);
+    ASSERT_TRUE(track != NULL);
+    EXPECT_EQ(track->size(), sizeof(FloatTrack) + 8 * 8);
+    ozz::memory::default_allocator()->Delete(track);
+  }
+}
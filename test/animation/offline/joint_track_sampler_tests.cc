@@ -0,0 +1,213 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/joint_track_sampler.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/transform.h"
+
+using ozz::animation::offline::JointTrackSampler;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Translates along x, linearly or along a sine if _sine is true, after
+// _failure time evaluation fails.
+class TestFunction : public JointTrackSampler::Function {
+ public:
+  explicit TestFunction(bool _sine, float _failure = 1e10f)
+    : sine_(_sine),
+      failure_(_failure),
+      evaluations_(0) {
+  }
+
+  virtual bool Evaluate(float _time, ozz::math::Transform* _transform) const {
+    ++evaluations_;
+    *_transform = ozz::math::Transform::identity();
+    _transform->translation.x = sine_ ? std::sin(_time * 4.f) : _time * 2.f;
+    return _time < failure_;
+  }
+
+  int evaluations() const {
+    return evaluations_;
+  }
+
+ private:
+  bool sine_;
+  float failure_;
+  mutable int evaluations_;
+};
+
+// Expects _track keys times to be increasing, for all key types.
+void ExpectSorted(const RawAnimation::JointTrack& _track) {
+  ASSERT_EQ(_track.translations.size(), _track.rotations.size());
+  ASSERT_EQ(_track.translations.size(), _track.scales.size());
+  for (size_t i = 0; i < _track.translations.size(); ++i) {
+    EXPECT_EQ(_track.translations[i].time, _track.rotations[i].time);
+    EXPECT_EQ(_track.translations[i].time, _track.scales[i].time);
+    if (i != 0) {
+      EXPECT_LT(_track.translations[i - 1].time, _track.translations[i].time);
+    }
+  }
+}
+}  // namespace
+
+TEST(Error, JointTrackSampler) {
+  const TestFunction function(false);
+  RawAnimation::JointTrack track;
+
+  {  // No output.
+    JointTrackSampler sampler;
+    EXPECT_FALSE(sampler(function, 0.f, 1.f, NULL));
+  }
+
+  {  // Invalid sampling rate.
+    JointTrackSampler sampler;
+    sampler.sampling_rate = 0.f;
+    EXPECT_FALSE(sampler(function, 0.f, 1.f, &track));
+    sampler.sampling_rate = -1.f;
+    EXPECT_FALSE(sampler(function, 0.f, 1.f, &track));
+  }
+
+  {  // Invalid range.
+    JointTrackSampler sampler;
+    EXPECT_FALSE(sampler(function, 1.f, 0.f, &track));
+  }
+
+  {  // Evaluation failure.
+    const TestFunction failing(false, .5f);
+    JointTrackSampler sampler;
+    EXPECT_FALSE(sampler(failing, 0.f, 1.f, &track));
+    sampler.adaptive = true;
+    EXPECT_FALSE(sampler(failing, 0.f, 1.f, &track));
+  }
+}
+
+TEST(Fixed, JointTrackSampler) {
+  JointTrackSampler sampler;
+  sampler.sampling_rate = 10.f;
+
+  {  // Single key.
+    const TestFunction function(false);
+    RawAnimation::JointTrack track;
+    ASSERT_TRUE(sampler(function, 2.f, 2.f, &track));
+    ASSERT_EQ(track.translations.size(), 1u);
+    EXPECT_FLOAT_EQ(track.translations[0].time, 2.f);
+    EXPECT_FLOAT3_EQ(track.translations[0].value, 4.f, 0.f, 0.f);
+  }
+
+  {  // Range that isn't a multiple of the sampling period.
+    const TestFunction function(false);
+    RawAnimation::JointTrack track;
+    ASSERT_TRUE(sampler(function, 1.f, 2.05f, &track));
+    ExpectSorted(track);
+    ASSERT_EQ(track.translations.size(), 12u);
+    EXPECT_FLOAT_EQ(track.translations[0].time, 1.f);
+    EXPECT_FLOAT_EQ(track.translations[5].time, 1.5f);
+    EXPECT_FLOAT3_EQ(track.translations[5].value, 3.f, 0.f, 0.f);
+    EXPECT_FLOAT_EQ(track.translations[10].time, 2.f);
+    EXPECT_FLOAT_EQ(track.translations[11].time, 2.05f);
+    EXPECT_EQ(function.evaluations(), 12);
+  }
+
+  {  // Keys are appended.
+    const TestFunction function(false);
+    RawAnimation::JointTrack track;
+    ASSERT_TRUE(sampler(function, 0.f, 1.f, &track));
+    ASSERT_TRUE(sampler(function, 1.5f, 2.f, &track));
+    EXPECT_EQ(track.translations.size(), 17u);
+    ExpectSorted(track);
+  }
+}
+
+TEST(Adaptive, JointTrackSampler) {
+  JointTrackSampler sampler;
+  sampler.sampling_rate = 30.f;
+  sampler.adaptive = true;
+
+  {  // Linear curves only need coarse keys.
+    const TestFunction function(false);
+    RawAnimation::JointTrack track;
+    ASSERT_TRUE(sampler(function, 0.f, 1.f, &track));
+    ExpectSorted(track);
+    ASSERT_EQ(track.translations.size(), 5u);
+    EXPECT_FLOAT_EQ(track.translations[0].time, 0.f);
+    EXPECT_FLOAT_EQ(track.translations[1].time, 8.f / 30.f);
+    EXPECT_FLOAT_EQ(track.translations[4].time, 1.f);
+    EXPECT_FLOAT3_EQ(track.translations[4].value, 2.f, 0.f, 0.f);
+    EXPECT_LT(function.evaluations(), 31);
+  }
+
+  {  // Single key.
+    const TestFunction function(true);
+    RawAnimation::JointTrack track;
+    ASSERT_TRUE(sampler(function, 1.f, 1.f, &track));
+    EXPECT_EQ(track.translations.size(), 1u);
+  }
+
+  {  // Curves are subdivided within tolerance.
+    const TestFunction function(true);
+    RawAnimation::JointTrack track;
+    ASSERT_TRUE(sampler(function, 0.f, 2.f, &track));
+    ExpectSorted(track);
+    const size_t num_keys = track.translations.size();
+    EXPECT_GT(num_keys, 8u);
+    EXPECT_LT(num_keys, 61u);
+
+    // Interpolated keys match fixed rate keys within tolerance.
+    JointTrackSampler fixed_sampler;
+    fixed_sampler.sampling_rate = 30.f;
+    RawAnimation::JointTrack fixed;
+    ASSERT_TRUE(fixed_sampler(function, 0.f, 2.f, &fixed));
+    ASSERT_EQ(fixed.translations.size(), 61u);
+    size_t k = 0;
+    for (size_t i = 0; i < fixed.translations.size(); ++i) {
+      const RawAnimation::TranslationKey& key = fixed.translations[i];
+      while (k + 2 < num_keys && track.translations[k + 1].time <= key.time) {
+        ++k;
+      }
+      const RawAnimation::TranslationKey& a = track.translations[k];
+      const RawAnimation::TranslationKey& b = track.translations[k + 1];
+      const float alpha = (key.time - a.time) / (b.time - a.time);
+      const ozz::math::Float3 value = Lerp(a.value, b.value, alpha);
+      EXPECT_NEAR(value.x, key.value.x, sampler.translation_tolerance * 1.01f);
+    }
+
+    // Lower tolerance requires more keys.
+    sampler.translation_tolerance *= .1f;
+    RawAnimation::JointTrack precise;
+    ASSERT_TRUE(sampler(function, 0.f, 2.f, &precise));
+    EXPECT_GT(precise.translations.size(), num_keys);
+  }
+}
@@ -0,0 +1,180 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/model_space_clip_builder.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_float4x3.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/model_space_clip.h"
+#include "ozz/animation/runtime/sample_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::ModelSpaceClip;
+using ozz::animation::SampleToModelJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::ModelSpaceClipBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton of a root and a child.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "child";
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds a 2s animation of _num_tracks tracks, whose root moves along x while
+// the other tracks rotate around y.
+Animation* BuildAnimation(int _num_tracks) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 3; ++k) {
+      const float time = k * 1.f;
+      const RawAnimation::TranslationKey t = {
+        time, i == 0 ? ozz::math::Float3(time, 0.f, 0.f) :
+                       ozz::math::Float3(0.f, 1.f, 0.f)};
+      track.translations.push_back(t);
+      const float angle = i == 0 ? 0.f : time * ozz::math::kPi_2 * .25f;
+      const RawAnimation::RotationKey r = {
+        time, ozz::math::Quaternion(0.f, std::sin(angle), 0.f,
+                                    std::cos(angle))};
+      track.rotations.push_back(r);
+    }
+  }
+  return AnimationBuilder()(raw_animation);
+}
+}  // namespace
+
+TEST(Error, ModelSpaceClipBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+  Animation* mismatching = BuildAnimation(3);
+  ASSERT_TRUE(mismatching != NULL);
+
+  ModelSpaceClipBuilder builder;
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+
+  {  // Invalid sampling rate.
+    builder.sampling_rate = 0.f;
+    EXPECT_TRUE(!builder(*animation, *skeleton));
+    builder.sampling_rate = 30.f;
+  }
+
+  {  // Tracks mismatch.
+    EXPECT_TRUE(!builder(*mismatching, *skeleton));
+  }
+
+  {  // Valid.
+    ModelSpaceClip* clip = builder(*animation, *skeleton);
+    ASSERT_TRUE(clip != NULL);
+    allocator->Delete(clip);
+  }
+
+  allocator->Delete(mismatching);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(Bake, ModelSpaceClipBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+
+  ModelSpaceClipBuilder builder;
+  builder.sampling_rate = 3.7f;  // Adjusted to 4 frames per second.
+  ModelSpaceClip* clip = builder(*animation, *skeleton);
+  ASSERT_TRUE(clip != NULL);
+
+  EXPECT_EQ(clip->num_joints(), 2);
+  EXPECT_EQ(clip->num_frames(), 9);
+  EXPECT_FLOAT_EQ(clip->frame_rate(), 4.f);
+  EXPECT_FLOAT_EQ(clip->duration(), 2.f);
+  EXPECT_GT(clip->size(), 9 * 2 * sizeof(ozz::math::Float4x3));
+
+  // Every frame matches the model-space pose at frame time.
+  SamplingCache cache(2);
+  ozz::math::Float4x3 expected[2];
+  for (int f = 0; f < clip->num_frames(); ++f) {
+    SampleToModelJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.skeleton = skeleton;
+    job.time = f / 4.f;
+    job.output_4x3.begin = expected;
+    job.output_4x3.end = expected + 2;
+    ASSERT_TRUE(job.Run());
+
+    const ozz::Range<const ozz::math::Float4x3> frame = clip->frame(f);
+    for (int j = 0; j < 2; ++j) {
+      for (int r = 0; r < 3; ++r) {
+        const ozz::math::SimdFloat4 e = expected[j].rows[r];
+        EXPECT_SIMDFLOAT_EQ(frame.begin[j].rows[r],
+                            ozz::math::GetX(e), ozz::math::GetY(e),
+                            ozz::math::GetZ(e), ozz::math::GetW(e));
+      }
+    }
+  }
+
+  // Root moves along x, as the last row component.
+  const ozz::math::Float4x3& last = clip->frame(8).begin[0];
+  EXPECT_SIMDFLOAT_EQ_EST(last.rows[0], 1.f, 0.f, 0.f, 2.f);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(clip);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
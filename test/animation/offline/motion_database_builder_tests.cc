@@ -0,0 +1,223 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/motion_database_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/motion_database.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::MotionDatabase;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::MotionDatabaseBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton of 2 joints, a root and its child.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(1);
+  root.children[0].name = "child";
+  root.children[0].transform = ozz::math::Transform::identity();
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation of _num_tracks tracks, whose root translates along x
+// from 0 to 2 in 1 second, and whose child is 1 unit above the root.
+Animation* BuildAnimation(int _num_tracks) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  const RawAnimation::TranslationKey first = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(first);
+  const RawAnimation::TranslationKey last = {
+    1.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(last);
+  for (int i = 1; i < _num_tracks; ++i) {
+    const RawAnimation::TranslationKey up = {
+      0.f, ozz::math::Float3(0.f, 1.f, 0.f)};
+    raw_animation.tracks[i].translations.push_back(up);
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Error, MotionDatabaseBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+  Animation* mismatch = BuildAnimation(3);
+  ASSERT_TRUE(mismatch != NULL);
+
+  MotionDatabaseBuilder builder;
+  builder.joints.push_back(1);
+  const Animation* animations[] = {animation, NULL, mismatch};
+  typedef ozz::Range<const Animation* const> Animations;
+  const Animations valid(animations, 1);
+
+  // No animation.
+  EXPECT_TRUE(!builder(*skeleton, Animations()));
+  EXPECT_TRUE(!builder(*skeleton, Animations(animations, animations)));
+
+  // Invalid animations.
+  EXPECT_TRUE(!builder(*skeleton, Animations(animations, 2)));
+  EXPECT_TRUE(!builder(*skeleton, Animations(animations + 2, 1)));
+
+  {  // Invalid sampling rate.
+    MotionDatabaseBuilder invalid = builder;
+    invalid.sampling_rate = 0.f;
+    EXPECT_TRUE(!invalid(*skeleton, valid));
+  }
+  {  // Invalid root.
+    MotionDatabaseBuilder invalid = builder;
+    invalid.root = 2;
+    EXPECT_TRUE(!invalid(*skeleton, valid));
+    invalid.root = -1;
+    EXPECT_TRUE(!invalid(*skeleton, valid));
+  }
+  {  // Invalid joint.
+    MotionDatabaseBuilder invalid = builder;
+    invalid.joints.push_back(2);
+    EXPECT_TRUE(!invalid(*skeleton, valid));
+  }
+  {  // Invalid trajectory.
+    MotionDatabaseBuilder invalid = builder;
+    invalid.trajectory.push_back(-1.f);
+    EXPECT_TRUE(!invalid(*skeleton, valid));
+  }
+  {  // No feature.
+    MotionDatabaseBuilder invalid;
+    EXPECT_TRUE(!invalid(*skeleton, valid));
+  }
+  {  // Too many features.
+    MotionDatabaseBuilder invalid;
+    invalid.joints.resize(MotionDatabase::kMaxFeatures / 6 + 1, 0);
+    EXPECT_TRUE(!invalid(*skeleton, valid));
+  }
+
+  MotionDatabase* database = builder(*skeleton, valid);
+  EXPECT_TRUE(database != NULL);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(database);
+  allocator->Delete(mismatch);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(Features, MotionDatabaseBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+
+  MotionDatabaseBuilder builder;
+  builder.sampling_rate = 10.f;
+  builder.joints.push_back(1);
+  builder.trajectory.push_back(.5f);
+  const Animation* animations[] = {animation, animation};
+  MotionDatabase* database =
+    builder(*skeleton, ozz::Range<const Animation* const>(animations, 2));
+  ASSERT_TRUE(database != NULL);
+
+  ASSERT_EQ(database->num_frames(), 22);
+  ASSERT_EQ(database->num_features(), 9);
+  EXPECT_EQ(database->root(), 0);
+  ASSERT_EQ(database->joints().Count(), 1u);
+  EXPECT_EQ(database->joints().begin[0], 1);
+  ASSERT_EQ(database->trajectory().Count(), 1u);
+  EXPECT_FLOAT_EQ(database->trajectory().begin[0], .5f);
+
+  for (int i = 0; i < database->num_frames(); ++i) {
+    const MotionDatabase::Frame& frame = database->frames().begin[i];
+    EXPECT_EQ(frame.animation, i / 11);
+    EXPECT_NEAR(frame.time, (i % 11) * .1f, 1e-5f);
+  }
+
+  // Child position, 1 unit above the root.
+  const ozz::Range<const float> means = database->means();
+  const ozz::Range<const float> scales = database->scales();
+  EXPECT_NEAR(means.begin[0], 0.f, 1e-3f);
+  EXPECT_NEAR(means.begin[1], 1.f, 1e-3f);
+  EXPECT_NEAR(means.begin[2], 0.f, 1e-3f);
+
+  // Child velocity, 2 units per second along x.
+  EXPECT_NEAR(means.begin[3], 2.f, 1e-2f);
+  EXPECT_NEAR(means.begin[4], 0.f, 1e-3f);
+  EXPECT_NEAR(means.begin[5], 0.f, 1e-3f);
+
+  // Trajectory position, 1 unit ahead until the end of the animation is
+  // reached.
+  float sum = 0.f;
+  for (int i = 0; i < 11; ++i) {
+    sum += i <= 5 ? 1.f : 2.f - i * .2f;
+  }
+  EXPECT_NEAR(means.begin[6], sum / 11.f, 1e-3f);
+  EXPECT_NEAR(means.begin[7], 0.f, 1e-3f);
+  for (int i = 0; i < 11; ++i) {
+    const float expected = i <= 5 ? 1.f : 2.f - i * .2f;
+    EXPECT_NEAR(database->feature(i, 6) / scales.begin[6] + means.begin[6],
+                expected, 1e-3f);
+    EXPECT_NEAR(database->feature(i + 11, 6), database->feature(i, 6), 1e-5f);
+  }
+
+  // Constant features aren't scaled.
+  EXPECT_FLOAT_EQ(scales.begin[1], 1.f);
+  for (int i = 0; i < database->num_frames(); ++i) {
+    EXPECT_NEAR(database->feature(i, 1), 0.f, 1e-3f);
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(database);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
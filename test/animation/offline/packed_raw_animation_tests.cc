@@ -0,0 +1,296 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/packed_raw_animation.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::PackedRawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::AnimationOptimizer;
+
+namespace {
+
+// Builds a raw animation with random keys, and a different number of keys
+// per track.
+void BuildRandomAnimation(RawAnimation::Interpolation _interpolation,
+                          RawAnimation* _animation) {
+  _animation->duration = 10.f;
+  _animation->interpolation = _interpolation;
+  _animation->tracks.resize(29);
+  srand(46);
+  for (int i = 0; i < _animation->num_tracks(); ++i) {
+    RawAnimation::JointTrack& track = _animation->tracks[i];
+    const int num_keys = i * 7 % 23;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = (k + static_cast<float>(rand()) / RAND_MAX) * 10.f /
+                         (num_keys + 1);
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(static_cast<float>(rand() % 100), 0.f, 1.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion(0.f, (rand() % 2) ? 1.f : -1.f, 0.f, 1.f)};
+      track.rotations.push_back(rkey);
+      if (k % 2) {
+        const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f, static_cast<float>(rand() % 10), 1.f)};
+        track.scales.push_back(skey);
+      }
+    }
+    if (_interpolation == RawAnimation::kHermite) {
+      track.translation_tangents.resize(track.translations.size(),
+                                        ozz::math::Float3(1.f, 2.f, 3.f));
+      track.rotation_tangents.resize(track.rotations.size(),
+                                     ozz::math::Float4(0.f, 1.f, 0.f, 0.f));
+      track.scale_tangents.resize(track.scales.size(),
+                                  ozz::math::Float3::zero());
+    }
+  }
+}
+
+// Saves _animation to a blob allocated with the default allocator.
+void* SaveBlob(const Animation& _animation) {
+  void* blob = ozz::memory::default_allocator()->Allocate(
+    _animation.blob_size(), Animation::kBlobAlignment);
+  EXPECT_TRUE(_animation.SaveBlob(blob, _animation.blob_size()));
+  return blob;
+}
+
+// Expects animations built from _raw and its packed version to be the same.
+void ExpectSameBuild(const RawAnimation& _raw) {
+  PackedRawAnimation packed;
+  ASSERT_TRUE(packed.Pack(_raw));
+  EXPECT_TRUE(packed.Validate());
+
+  AnimationBuilder builder;
+  Animation* from_raw = builder(_raw);
+  ASSERT_TRUE(from_raw != NULL);
+  Animation* from_packed = builder(packed);
+  ASSERT_TRUE(from_packed != NULL);
+
+  ASSERT_EQ(from_raw->blob_size(), from_packed->blob_size());
+  void* raw_blob = SaveBlob(*from_raw);
+  void* packed_blob = SaveBlob(*from_packed);
+  EXPECT_EQ(std::memcmp(raw_blob, packed_blob, from_raw->blob_size()), 0);
+
+  ozz::memory::default_allocator()->Deallocate(raw_blob);
+  ozz::memory::default_allocator()->Deallocate(packed_blob);
+  ozz::memory::default_allocator()->Delete(from_raw);
+  ozz::memory::default_allocator()->Delete(from_packed);
+}
+}  // namespace
+
+TEST(Error, PackedRawAnimation) {
+  {  // Default packed animation is valid and empty.
+    PackedRawAnimation packed;
+    EXPECT_TRUE(packed.Validate());
+    EXPECT_EQ(packed.num_tracks(), 0);
+    EXPECT_EQ(packed.num_translations(), 0u);
+    EXPECT_EQ(packed.num_rotations(), 0u);
+    EXPECT_EQ(packed.num_scales(), 0u);
+  }
+
+  {  // Invalid raw animation.
+    RawAnimation raw;
+    raw.tracks.resize(1);
+    const RawAnimation::TranslationKey key = {2.f, ozz::math::Float3::zero()};
+    raw.tracks[0].translations.push_back(key);
+    ASSERT_FALSE(raw.Validate());
+
+    PackedRawAnimation packed;
+    EXPECT_FALSE(packed.Pack(raw));
+    EXPECT_EQ(packed.num_tracks(), 0);
+    EXPECT_EQ(packed.num_translations(), 0u);
+  }
+
+  {  // Invalid duration.
+    RawAnimation raw;
+    PackedRawAnimation packed;
+    ASSERT_TRUE(packed.Pack(raw));
+    packed.duration = 0.f;
+    EXPECT_FALSE(packed.Validate());
+    EXPECT_TRUE(AnimationBuilder()(packed) == NULL);
+  }
+
+  {  // Hermite interpolation requires packed tangents.
+    RawAnimation raw;
+    BuildRandomAnimation(RawAnimation::kLinear, &raw);
+    PackedRawAnimation packed;
+    ASSERT_TRUE(packed.Pack(raw));
+    EXPECT_TRUE(packed.Validate());
+    packed.interpolation = RawAnimation::kHermite;
+    EXPECT_FALSE(packed.Validate());
+  }
+}
+
+TEST(Pack, PackedRawAnimation) {
+  RawAnimation raw;
+  BuildRandomAnimation(RawAnimation::kHermite, &raw);
+  ASSERT_TRUE(raw.Validate());
+
+  PackedRawAnimation packed;
+  ASSERT_TRUE(packed.Pack(raw));
+  EXPECT_FLOAT_EQ(packed.duration, raw.duration);
+  EXPECT_EQ(packed.interpolation, RawAnimation::kHermite);
+  ASSERT_EQ(packed.num_tracks(), raw.num_tracks());
+
+  // Tracks views match raw tracks, and keys are contiguous.
+  size_t num_translations = 0;
+  for (int i = 0; i < raw.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& src = raw.tracks[i];
+    const PackedRawAnimation::JointTrack track = packed.track(i);
+    ASSERT_EQ(track.translations.size(), src.translations.size());
+    ASSERT_EQ(track.rotations.size(), src.rotations.size());
+    ASSERT_EQ(track.scales.size(), src.scales.size());
+    ASSERT_EQ(track.translation_tangents.size(), src.translations.size());
+    ASSERT_EQ(track.rotation_tangents.size(), src.rotations.size());
+    ASSERT_EQ(track.scale_tangents.size(), src.scales.size());
+    for (size_t k = 0; k < src.translations.size(); ++k) {
+      EXPECT_FLOAT_EQ(track.translations[k].time, src.translations[k].time);
+      EXPECT_FLOAT_EQ(track.translations.times()[k], src.translations[k].time);
+      EXPECT_FLOAT3_EQ(track.translations[k].value,
+                       src.translations[k].value.x,
+                       src.translations[k].value.y,
+                       src.translations[k].value.z);
+    }
+    for (size_t k = 0; k < src.rotations.size(); ++k) {
+      EXPECT_FLOAT_EQ(track.rotations[k].time, src.rotations[k].time);
+      EXPECT_QUATERNION_EQ(track.rotations[k].value,
+                           src.rotations[k].value.x,
+                           src.rotations[k].value.y,
+                           src.rotations[k].value.z,
+                           src.rotations[k].value.w);
+    }
+    if (i && track.translations.size() &&
+        packed.track(i - 1).translations.size()) {
+      EXPECT_EQ(track.translations.times(),
+                packed.track(i - 1).translations.times() +
+                packed.track(i - 1).translations.size());
+    }
+    num_translations += src.translations.size();
+  }
+  EXPECT_EQ(packed.num_translations(), num_translations);
+
+  // Unpacking restores the same raw animation.
+  RawAnimation unpacked;
+  packed.Unpack(&unpacked);
+  EXPECT_TRUE(unpacked.Validate());
+  EXPECT_FLOAT_EQ(unpacked.duration, raw.duration);
+  EXPECT_EQ(unpacked.interpolation, raw.interpolation);
+  ASSERT_EQ(unpacked.num_tracks(), raw.num_tracks());
+  for (int i = 0; i < raw.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& src = raw.tracks[i];
+    const RawAnimation::JointTrack& dest = unpacked.tracks[i];
+    ASSERT_EQ(dest.scales.size(), src.scales.size());
+    ASSERT_EQ(dest.scale_tangents.size(), src.scale_tangents.size());
+    for (size_t k = 0; k < src.scales.size(); ++k) {
+      EXPECT_FLOAT_EQ(dest.scales[k].time, src.scales[k].time);
+      EXPECT_FLOAT3_EQ(dest.scales[k].value,
+                       src.scales[k].value.x,
+                       src.scales[k].value.y,
+                       src.scales[k].value.z);
+    }
+    ASSERT_EQ(dest.rotation_tangents.size(), src.rotation_tangents.size());
+    for (size_t k = 0; k < src.rotation_tangents.size(); ++k) {
+      EXPECT_FLOAT4_EQ(dest.rotation_tangents[k],
+                       src.rotation_tangents[k].x,
+                       src.rotation_tangents[k].y,
+                       src.rotation_tangents[k].z,
+                       src.rotation_tangents[k].w);
+    }
+  }
+
+  // Repacking replaces previous content.
+  RawAnimation linear;
+  BuildRandomAnimation(RawAnimation::kLinear, &linear);
+  linear.tracks.resize(3);
+  ASSERT_TRUE(packed.Pack(linear));
+  EXPECT_EQ(packed.num_tracks(), 3);
+  EXPECT_EQ(packed.track(2).translation_tangents.size(), 0u);
+}
+
+TEST(Build, PackedRawAnimation) {
+  {  // Linear.
+    RawAnimation raw;
+    BuildRandomAnimation(RawAnimation::kLinear, &raw);
+    ExpectSameBuild(raw);
+  }
+  {  // Hermite.
+    RawAnimation raw;
+    BuildRandomAnimation(RawAnimation::kHermite, &raw);
+    ExpectSameBuild(raw);
+  }
+  {  // No track.
+    RawAnimation raw;
+    ExpectSameBuild(raw);
+  }
+}
+
+TEST(Optimize, PackedRawAnimation) {
+  RawAnimation raw;
+  BuildRandomAnimation(RawAnimation::kLinear, &raw);
+  PackedRawAnimation packed;
+  ASSERT_TRUE(packed.Pack(raw));
+
+  AnimationOptimizer optimizer;
+  RawAnimation raw_optimized;
+  ASSERT_TRUE(optimizer(raw, &raw_optimized));
+  PackedRawAnimation packed_optimized;
+  ASSERT_TRUE(optimizer(packed, NULL, &packed_optimized));
+
+  ASSERT_EQ(packed_optimized.num_tracks(), raw_optimized.num_tracks());
+  for (int i = 0; i < raw_optimized.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& src = raw_optimized.tracks[i];
+    const PackedRawAnimation::JointTrack track = packed_optimized.track(i);
+    EXPECT_EQ(track.translations.size(), src.translations.size());
+    EXPECT_EQ(track.rotations.size(), src.rotations.size());
+    EXPECT_EQ(track.scales.size(), src.scales.size());
+  }
+
+  // Failure resets output.
+  optimizer.reduction = AnimationOptimizer::kWindowed;
+  optimizer.reduction_window = 0;
+  EXPECT_FALSE(optimizer(packed, NULL, &packed_optimized));
+  EXPECT_EQ(packed_optimized.num_tracks(), 0);
+}
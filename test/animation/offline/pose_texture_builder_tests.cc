@@ -0,0 +1,246 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/pose_texture_builder.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::PoseTexture;
+using ozz::animation::offline::PoseTextureBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton of 2 joints, a root and its child.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(1);
+  root.children[0].name = "child";
+  root.children[0].transform = ozz::math::Transform::identity();
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation of _num_tracks tracks, whose root translates along x
+// from 0 to 2 in 1 second, and whose child is 1 unit above the root and
+// rotates a full turn around y.
+Animation* BuildAnimation(int _num_tracks) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  const RawAnimation::TranslationKey first = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(first);
+  const RawAnimation::TranslationKey last = {
+    1.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(last);
+  for (int i = 1; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const RawAnimation::TranslationKey up = {
+      0.f, ozz::math::Float3(0.f, 1.f, 0.f)};
+    track.translations.push_back(up);
+    for (int k = 0; k <= 8; ++k) {
+      const RawAnimation::RotationKey key = {
+        k / 8.f, ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float4(0.f, 1.f, 0.f, k * ozz::math::k2Pi / 8.f))};
+      track.rotations.push_back(key);
+    }
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Gets component _c of texel _texel of joint _joint at frame _frame.
+float Texel(const PoseTexture& _texture, int _frame, int _joint, int _texel,
+            int _c) {
+  const int index = (_frame * _texture.width() +
+                     _joint * _texture.texels_per_joint() + _texel) * 4 + _c;
+  return ozz::math::HalfToFloat(_texture.texels[index]);
+}
+}  // namespace
+
+TEST(Error, PoseTextureBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+  Animation* mismatch = BuildAnimation(3);
+  ASSERT_TRUE(mismatch != NULL);
+
+  PoseTexture texture;
+  EXPECT_FALSE(texture.Save(NULL));
+
+  PoseTextureBuilder builder;
+  EXPECT_FALSE(builder(*animation, *skeleton, NULL));
+  EXPECT_FALSE(builder(*mismatch, *skeleton, &texture));
+  builder.sampling_rate = 0.f;
+  EXPECT_FALSE(builder(*animation, *skeleton, &texture));
+  builder.sampling_rate = 30.f;
+  EXPECT_TRUE(builder(*animation, *skeleton, &texture));
+
+  // Empty texture can't be saved.
+  ozz::io::MemoryStream stream;
+  EXPECT_FALSE(PoseTexture().Save(&stream));
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(mismatch);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(Matrix, PoseTextureBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+
+  PoseTextureBuilder builder;
+  builder.sampling_rate = 7.5f;
+  PoseTexture texture;
+  ASSERT_TRUE(builder(*animation, *skeleton, &texture));
+
+  // Frame rate is adjusted so that frames are evenly spaced.
+  EXPECT_EQ(texture.format, PoseTexture::kMatrix);
+  EXPECT_EQ(texture.num_joints, 2);
+  ASSERT_EQ(texture.num_frames, 9);
+  EXPECT_FLOAT_EQ(texture.frame_rate, 8.f);
+  EXPECT_FLOAT_EQ(texture.duration, 1.f);
+  EXPECT_EQ(texture.width(), 6);
+  EXPECT_EQ(texture.height(), 9);
+  ASSERT_EQ(texture.texels.size(), 6u * 9u * 4u);
+
+  for (int f = 0; f < texture.num_frames; ++f) {
+    const float x = f * 2.f / 8.f;
+
+    // Root translates along x.
+    EXPECT_NEAR(Texel(texture, f, 0, 0, 0), 1.f, 1e-3f);
+    EXPECT_NEAR(Texel(texture, f, 0, 0, 3), x, 2e-3f);
+    EXPECT_NEAR(Texel(texture, f, 0, 1, 1), 1.f, 1e-3f);
+    EXPECT_NEAR(Texel(texture, f, 0, 1, 3), 0.f, 1e-3f);
+    EXPECT_NEAR(Texel(texture, f, 0, 2, 2), 1.f, 1e-3f);
+
+    // Child is above the root, and rotates around y.
+    const float angle = f * ozz::math::k2Pi / 8.f;
+    EXPECT_NEAR(Texel(texture, f, 1, 0, 0), std::cos(angle), 2e-3f);
+    EXPECT_NEAR(Texel(texture, f, 1, 0, 2), std::sin(angle), 2e-3f);
+    EXPECT_NEAR(Texel(texture, f, 1, 0, 3), x, 2e-3f);
+    EXPECT_NEAR(Texel(texture, f, 1, 1, 1), 1.f, 1e-3f);
+    EXPECT_NEAR(Texel(texture, f, 1, 1, 3), 1.f, 1e-3f);
+  }
+
+  // Saves the texture.
+  ozz::io::MemoryStream stream;
+  ASSERT_TRUE(texture.Save(&stream));
+  EXPECT_EQ(stream.Tell(),
+            static_cast<int64_t>(36 + texture.texels.size() * 2));
+  stream.Seek(0, ozz::io::Stream::kSet);
+  char identifier[4];
+  ASSERT_EQ(stream.Read(identifier, 4), 4u);
+  EXPECT_EQ(std::memcmp(identifier, "ozzt", 4), 0);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(DualQuaternion, PoseTextureBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(2);
+  ASSERT_TRUE(animation != NULL);
+
+  PoseTextureBuilder builder;
+  builder.sampling_rate = 32.f;
+  builder.format = PoseTexture::kDualQuaternion;
+  PoseTexture texture;
+  ASSERT_TRUE(builder(*animation, *skeleton, &texture));
+  ASSERT_EQ(texture.num_frames, 33);
+  EXPECT_EQ(texture.width(), 4);
+
+  for (int f = 0; f < texture.num_frames; ++f) {
+    const float x = f * 2.f / 32.f;
+
+    // Root isn't rotated, dual part is half the translation.
+    EXPECT_NEAR(std::abs(Texel(texture, f, 0, 0, 3)), 1.f, 1e-3f);
+    const float sign = Texel(texture, f, 0, 0, 3) > 0.f ? 1.f : -1.f;
+    EXPECT_NEAR(Texel(texture, f, 0, 1, 0), sign * x * .5f, 2e-3f);
+    EXPECT_NEAR(Texel(texture, f, 0, 1, 1), 0.f, 1e-3f);
+    EXPECT_NEAR(Texel(texture, f, 0, 1, 3), 0.f, 1e-3f);
+
+    // Child real part is on the previous frame hemisphere.
+    if (f > 0) {
+      float dot = 0.f;
+      for (int c = 0; c < 4; ++c) {
+        dot += Texel(texture, f, 1, 0, c) * Texel(texture, f - 1, 1, 0, c);
+      }
+      EXPECT_GT(dot, 0.f);
+    }
+
+    // Child translation is recovered from dual quaternion: t = 2 * d * q*.
+    const ozz::math::Quaternion q(
+      Texel(texture, f, 1, 0, 0), Texel(texture, f, 1, 0, 1),
+      Texel(texture, f, 1, 0, 2), Texel(texture, f, 1, 0, 3));
+    const ozz::math::Quaternion d(
+      Texel(texture, f, 1, 1, 0), Texel(texture, f, 1, 1, 1),
+      Texel(texture, f, 1, 1, 2), Texel(texture, f, 1, 1, 3));
+    const ozz::math::Quaternion t = d * Conjugate(q);
+    EXPECT_NEAR(t.x * 2.f, x, 4e-3f);
+    EXPECT_NEAR(t.y * 2.f, 1.f, 4e-3f);
+    EXPECT_NEAR(t.z * 2.f, 0.f, 4e-3f);
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
@@ -0,0 +1,147 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/progressive_animation_builder.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/progressive_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::ProgressiveAnimation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::ProgressiveAnimationBuilder;
+
+namespace {
+// Builds a 2 tracks animation, whose second track translates along a sine
+// wave, sampled at 30hz.
+void BuildWave(RawAnimation* _animation) {
+  _animation->duration = 1.f;
+  _animation->tracks.resize(2);
+  for (int i = 0; i <= 30; ++i) {
+    const float time = i / 30.f;
+    const RawAnimation::TranslationKey key = {
+      time, ozz::math::Float3(0.f, std::sin(time * 6.f), 0.f)};
+    _animation->tracks[1].translations.push_back(key);
+  }
+}
+}  // namespace
+
+TEST(Error, ProgressiveAnimationBuilder) {
+  RawAnimation raw_animation;
+  BuildWave(&raw_animation);
+
+  { // Invalid raw animation.
+    RawAnimation invalid;
+    invalid.duration = -1.f;
+    ProgressiveAnimationBuilder builder;
+    EXPECT_TRUE(builder(invalid) == NULL);
+  }
+
+  { // No level.
+    ProgressiveAnimationBuilder builder;
+    builder.tolerance_scales.clear();
+    EXPECT_TRUE(builder(raw_animation) == NULL);
+  }
+
+  { // Scales aren't decreasing.
+    ProgressiveAnimationBuilder builder;
+    builder.tolerance_scales[1] = builder.tolerance_scales[0];
+    EXPECT_TRUE(builder(raw_animation) == NULL);
+  }
+
+  { // Scales aren't positive.
+    ProgressiveAnimationBuilder builder;
+    builder.tolerance_scales.back() = 0.f;
+    EXPECT_TRUE(builder(raw_animation) == NULL);
+  }
+
+  { // Skeleton doesn't match.
+    ozz::animation::offline::RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    raw_skeleton.roots[0].transform = ozz::math::Transform::identity();
+    ozz::animation::Skeleton* skeleton =
+      ozz::animation::offline::SkeletonBuilder()(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    ProgressiveAnimationBuilder builder;
+    EXPECT_TRUE(builder(raw_animation, *skeleton) == NULL);
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+}
+
+TEST(Build, ProgressiveAnimationBuilder) {
+  RawAnimation raw_animation;
+  BuildWave(&raw_animation);
+
+  ProgressiveAnimationBuilder builder;
+  builder.optimizer.translation_tolerance = 1e-4f;
+  ProgressiveAnimation* progressive = builder(raw_animation);
+  ASSERT_TRUE(progressive != NULL);
+  EXPECT_EQ(progressive->num_levels(), 3);
+  EXPECT_EQ(progressive->num_resident_levels(), 3);
+
+  // Levels are the same clip, with more and more keys.
+  for (int i = 0; i < 3; ++i) {
+    const Animation* level = progressive->level(i);
+    ASSERT_TRUE(level != NULL);
+    EXPECT_EQ(level->num_tracks(), 2);
+    EXPECT_FLOAT_EQ(level->duration(), 1.f);
+    if (i > 0) {
+      EXPECT_LE(progressive->level(i - 1)->size(), level->size());
+    }
+  }
+  EXPECT_LT(progressive->level(0)->size(), progressive->level(2)->size());
+  ozz::memory::default_allocator()->Delete(progressive);
+
+  // A single level is the animation optimized with optimizer tolerances.
+  builder.tolerance_scales.resize(1);
+  builder.tolerance_scales[0] = 1.f;
+  builder.optimizer.translation_tolerance = 0.f;
+  progressive = builder(raw_animation);
+  ASSERT_TRUE(progressive != NULL);
+  EXPECT_EQ(progressive->num_levels(), 1);
+  ozz::animation::offline::AnimationBuilder animation_builder;
+  Animation* full = animation_builder(raw_animation);
+  ASSERT_TRUE(full != NULL);
+  EXPECT_EQ(progressive->animation()->size(),
+            full->size());
+  ozz::memory::default_allocator()->Delete(full);
+  ozz::memory::default_allocator()->Delete(progressive);
+}
@@ -116,6 +116,52 @@ TEST(Filled, RawAnimationSerialize) {
   }
 }
 
+TEST(Hermite, RawAnimationSerialize) {
+
+  RawAnimation o_animation;
+  o_animation.duration = 46.f;
+  o_animation.interpolation = RawAnimation::kHermite;
+  o_animation.tracks.resize(1);
+  RawAnimation::JointTrack& o_track = o_animation.tracks[0];
+  const RawAnimation::TranslationKey t_key = {0.f, ozz::math::Float3(46.f, 93.f, 99.f)};
+  o_track.translations.push_back(t_key);
+  o_track.translation_tangents.push_back(ozz::math::Float3(1.f, 2.f, 3.f));
+  const RawAnimation::RotationKey r_key = {46.f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+  o_track.rotations.push_back(r_key);
+  o_track.rotation_tangents.push_back(ozz::math::Float4(4.f, 5.f, 6.f, 7.f));
+  const RawAnimation::ScaleKey s_key = {1.f, ozz::math::Float3(93.f, 46.f, 99.f)};
+  o_track.scales.push_back(s_key);
+  o_track.scale_tangents.push_back(ozz::math::Float3(8.f, 9.f, 10.f));
+  EXPECT_TRUE(o_animation.Validate());
+
+  ozz::io::MemoryStream stream;
+
+  // Streams out.
+  ozz::io::OArchive o(&stream);
+  o << o_animation;
+
+  // Streams in.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+
+  RawAnimation i_animation;
+  i >> i_animation;
+
+  EXPECT_TRUE(i_animation.Validate());
+  EXPECT_EQ(i_animation.interpolation, RawAnimation::kHermite);
+  ASSERT_EQ(i_animation.num_tracks(), 1);
+  const RawAnimation::JointTrack& i_track = i_animation.tracks[0];
+  ASSERT_EQ(i_track.translation_tangents.size(), 1u);
+  EXPECT_TRUE(Compare(i_track.translation_tangents[0],
+                      o_track.translation_tangents[0], 0.f));
+  ASSERT_EQ(i_track.rotation_tangents.size(), 1u);
+  EXPECT_TRUE(Compare(i_track.rotation_tangents[0],
+                      o_track.rotation_tangents[0], 0.f));
+  ASSERT_EQ(i_track.scale_tangents.size(), 1u);
+  EXPECT_TRUE(Compare(i_track.scale_tangents[0],
+                      o_track.scale_tangents[0], 0.f));
+}
+
 TEST(AlreadyInitialized, RawAnimationSerialize) {
 
   RawAnimation o_animation;
@@ -0,0 +1,201 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/root_motion_builder.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/root_motion.h"
+
+using ozz::animation::RootMotion;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RootMotionBuilder;
+
+namespace {
+// Pushes a root key with translation _t and yaw _yaw at _time.
+void PushKey(RawAnimation::JointTrack* _track, float _time,
+             const ozz::math::Float3& _t, float _yaw) {
+  const RawAnimation::TranslationKey translation = {_time, _t};
+  _track->translations.push_back(translation);
+  const RawAnimation::RotationKey rotation = {
+      _time, ozz::math::Quaternion::FromAxisAngle(
+                 ozz::math::Float4(0.f, 1.f, 0.f, _yaw))};
+  _track->rotations.push_back(rotation);
+}
+}  // namespace
+
+TEST(Error, RootMotionBuilder) {
+  RootMotionBuilder builder;
+
+  {  // Invalid input animation.
+    RawAnimation input;
+    input.duration = -1.f;
+    input.tracks.resize(1);
+    EXPECT_FALSE(input.Validate());
+    EXPECT_TRUE(!builder(input, NULL));
+  }
+
+  {  // No track is a motionless animation.
+    RawAnimation input;
+    EXPECT_TRUE(input.Validate());
+    RawAnimation output;
+    RootMotion* motion = builder(input, &output);
+    ASSERT_TRUE(motion != NULL);
+    EXPECT_EQ(motion->num_keys(), 1);
+    EXPECT_EQ(output.num_tracks(), 0);
+    ozz::memory::default_allocator()->Delete(motion);
+  }
+
+  {  // Invalid root track.
+    RawAnimation input;
+    input.tracks.resize(1);
+    RootMotionBuilder invalid_builder;
+    invalid_builder.root = 1;
+    EXPECT_TRUE(!invalid_builder(input, NULL));
+  }
+
+  {  // Hermite animation can't be modified.
+    RawAnimation input;
+    input.interpolation = RawAnimation::kHermite;
+    input.tracks.resize(1);
+    EXPECT_TRUE(input.Validate());
+    RawAnimation output;
+    EXPECT_TRUE(!builder(input, &output));
+
+    // But motion can still be extracted.
+    RootMotion* motion = builder(input, NULL);
+    ASSERT_TRUE(motion != NULL);
+    ozz::memory::default_allocator()->Delete(motion);
+  }
+
+  {  // Empty root track is a motionless track.
+    RawAnimation input;
+    input.tracks.resize(1);
+    RootMotion* motion = builder(input, NULL);
+    ASSERT_TRUE(motion != NULL);
+    EXPECT_FLOAT_EQ(motion->duration(), 1.f);
+    ASSERT_EQ(motion->num_keys(), 1);
+    EXPECT_FLOAT3_EQ(motion->keys().begin[0].translation, 0.f, 0.f, 0.f);
+    EXPECT_FLOAT_EQ(motion->keys().begin[0].yaw, 0.f);
+    ozz::memory::default_allocator()->Delete(motion);
+  }
+}
+
+TEST(Extract, RootMotionBuilder) {
+  RawAnimation input;
+  input.duration = 2.f;
+  input.tracks.resize(2);
+  RawAnimation::JointTrack& root = input.tracks[0];
+  PushKey(&root, 0.f, ozz::math::Float3(0.f, 1.f, 0.f), 0.f);
+  PushKey(&root, .5f, ozz::math::Float3(0.f, 1.f, 1.f), ozz::math::kPi_2 * .5f);
+  PushKey(&root, 1.f, ozz::math::Float3(0.f, 1.f, 2.f), ozz::math::kPi_2);
+  PushKey(&root, 2.f, ozz::math::Float3(2.f, 1.f, 2.f), ozz::math::kPi);
+  ASSERT_TRUE(input.Validate());
+
+  {  // Horizontal translation and yaw, linear keys are removed.
+    RootMotionBuilder builder;
+    RootMotion* motion = builder(input, NULL);
+    ASSERT_TRUE(motion != NULL);
+    EXPECT_FLOAT_EQ(motion->duration(), 2.f);
+    ASSERT_EQ(motion->num_keys(), 3);
+    const RootMotion::Key* keys = motion->keys().begin;
+    EXPECT_FLOAT_EQ(keys[0].time, 0.f);
+    EXPECT_FLOAT3_EQ(keys[0].translation, 0.f, 0.f, 0.f);
+    EXPECT_NEAR(keys[0].yaw, 0.f, 1e-5f);
+    EXPECT_FLOAT_EQ(keys[1].time, 1.f);
+    EXPECT_FLOAT3_EQ(keys[1].translation, 0.f, 0.f, 2.f);
+    EXPECT_NEAR(keys[1].yaw, ozz::math::kPi_2, 1e-5f);
+    EXPECT_FLOAT_EQ(keys[2].time, 2.f);
+    EXPECT_FLOAT3_EQ(keys[2].translation, 2.f, 0.f, 2.f);
+    EXPECT_NEAR(keys[2].yaw, ozz::math::kPi, 1e-5f);
+    ozz::memory::default_allocator()->Delete(motion);
+  }
+
+  {  // Vertical translation, no yaw.
+    RootMotionBuilder builder;
+    builder.vertical = true;
+    builder.yaw = false;
+    RootMotion* motion = builder(input, NULL);
+    ASSERT_TRUE(motion != NULL);
+    ASSERT_EQ(motion->num_keys(), 3);
+    const RootMotion::Key* keys = motion->keys().begin;
+    EXPECT_FLOAT3_EQ(keys[1].translation, 0.f, 1.f, 2.f);
+    EXPECT_FLOAT_EQ(keys[1].yaw, 0.f);
+    ozz::memory::default_allocator()->Delete(motion);
+  }
+
+  {  // Motion removal.
+    RootMotionBuilder builder;
+    RawAnimation output;
+    RootMotion* motion = builder(input, &output);
+    ASSERT_TRUE(motion != NULL);
+    ozz::memory::default_allocator()->Delete(motion);
+
+    ASSERT_TRUE(output.Validate());
+    ASSERT_EQ(output.num_tracks(), 2);
+    EXPECT_FLOAT_EQ(output.duration, 2.f);
+    const RawAnimation::JointTrack& in_place = output.tracks[0];
+    ASSERT_EQ(in_place.translations.size(), 4u);
+    ASSERT_EQ(in_place.rotations.size(), 4u);
+    for (size_t i = 0; i < 4; ++i) {
+      EXPECT_FLOAT_EQ(in_place.translations[i].time, root.translations[i].time);
+      EXPECT_FLOAT3_EQ(in_place.translations[i].value, 0.f, 1.f, 0.f);
+      const ozz::math::Quaternion& q = in_place.rotations[i].value;
+      EXPECT_NEAR(std::abs(q.w), 1.f, 1e-5f);
+    }
+  }
+}
+
+TEST(Yaw, RootMotionBuilder) {
+  RawAnimation input;
+  input.tracks.resize(1);
+  RawAnimation::JointTrack& root = input.tracks[0];
+  PushKey(&root, 0.f, ozz::math::Float3::zero(), ozz::math::kPi * .9f);
+  PushKey(&root, .5f, ozz::math::Float3::zero(), ozz::math::kPi * 1.1f);
+  PushKey(&root, 1.f, ozz::math::Float3::zero(), ozz::math::kPi * 1.3f);
+  ASSERT_TRUE(input.Validate());
+
+  // Yaw is continuous over pi, so intermediate key is removed.
+  RootMotionBuilder builder;
+  RootMotion* motion = builder(input, NULL);
+  ASSERT_TRUE(motion != NULL);
+  ASSERT_EQ(motion->num_keys(), 2);
+  const RootMotion::Key* keys = motion->keys().begin;
+  EXPECT_NEAR(keys[0].yaw, ozz::math::kPi * .9f, 1e-5f);
+  EXPECT_NEAR(keys[1].yaw, ozz::math::kPi * 1.3f, 1e-5f);
+  ozz::memory::default_allocator()->Delete(motion);
+}
@@ -31,6 +31,7 @@
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 
+#include <cstdio>
 #include <cstring>
 
 #include "gtest/gtest.h"
@@ -38,6 +39,7 @@
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/tasks/thread_pool.h"
 #include "ozz/animation/runtime/skeleton.h"
 
 #include "ozz/base/maths/gtest_math_helper.h"
@@ -834,6 +836,25 @@ TEST(TPose, SkeletonBuilder) {
   EXPECT_SIMDFLOAT_EQ(rotations[3], 0.f, 0.f, 0.f, 1.f);
   EXPECT_SIMDFLOAT_EQ(scales[3], 1.f, 1.f, 1.f, 0.f);
 
+  // j1 is scaled, non uniformly.
+  EXPECT_TRUE(skeleton->scaled());
+  EXPECT_FALSE(skeleton->uniformly_scaled());
+  ozz::memory::default_allocator()->Delete(skeleton);
+
+  // Uniform j1 scale.
+  root.children[1].transform.scale = Float3(3.f);
+  skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  EXPECT_TRUE(skeleton->scaled());
+  EXPECT_TRUE(skeleton->uniformly_scaled());
+  ozz::memory::default_allocator()->Delete(skeleton);
+
+  // Without j1 scale, the bind pose has only unit scales.
+  root.children[1].transform.scale = Float3::one();
+  skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  EXPECT_FALSE(skeleton->scaled());
+  EXPECT_TRUE(skeleton->uniformly_scaled());
   ozz::memory::default_allocator()->Delete(skeleton);
 }
 
@@ -864,3 +885,118 @@ TEST(MaxJoints, SkeletonBuilder) {
     EXPECT_TRUE(!builder(raw_skeleton));
   }
 }
+
+TEST(FindJoint, SkeletonBuilder) {
+  // Instantiates a builder objects with default parameters.
+  SkeletonBuilder builder;
+
+  { // Empty skeleton.
+    RawSkeleton raw_skeleton;
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    EXPECT_EQ(skeleton->FindJoint("root"), -1);
+    EXPECT_EQ(skeleton->FindJoint(NULL), -1);
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  { // Many joints, some of them sharing the same name.
+    const int kNumJoints = 300;
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(kNumJoints);
+    for (int i = 0; i < kNumJoints; ++i) {
+      char name[16];
+      std::sprintf(name, "joint%d", i < kNumJoints - 2 ? i : 7);
+      raw_skeleton.roots[i].name = name;
+    }
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+
+    for (int i = 0; i < kNumJoints - 2; ++i) {
+      const int joint = skeleton->FindJoint(skeleton->joint_names()[i]);
+      EXPECT_EQ(joint, i);
+    }
+
+    // The first joint is returned if names are shared.
+    EXPECT_EQ(skeleton->FindJoint("joint7"), 7);
+
+    // Unknown names.
+    EXPECT_EQ(skeleton->FindJoint(""), -1);
+    EXPECT_EQ(skeleton->FindJoint("joint"), -1);
+    EXPECT_EQ(skeleton->FindJoint("joint298"), -1);
+    EXPECT_EQ(skeleton->FindJoint(NULL), -1);
+
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+}
+
+TEST(Deep, SkeletonBuilder) {
+  // Builds a single chain of joints, as deep as possible.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 1; i < Skeleton::kMaxJoints; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+  }
+  ASSERT_TRUE(raw_skeleton.Validate());
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), Skeleton::kMaxJoints);
+  for (int i = 0; i < skeleton->num_joints(); ++i) {
+    EXPECT_EQ(skeleton->joint_properties()[i].parent,
+              i == 0 ? Skeleton::kNoParentIndex : i - 1);
+    EXPECT_EQ(skeleton->joint_properties()[i].is_leaf,
+              i == skeleton->num_joints() - 1);
+  }
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Dispatcher, SkeletonBuilder) {
+  // Builds a wide and deep hierarchy, with uniquely named joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(3);
+  int num_joints = 0;
+  char name[32];
+  for (size_t r = 0; r < raw_skeleton.roots.size(); ++r) {
+    RawSkeleton::Joint& root = raw_skeleton.roots[r];
+    std::sprintf(name, "joint%d", num_joints++);
+    root.name = name;
+    root.children.resize(40);
+    for (size_t c = 0; c < root.children.size(); ++c) {
+      RawSkeleton::Joint& child = root.children[c];
+      std::sprintf(name, "joint%d", num_joints++);
+      child.name = name;
+      child.children.resize(c + 1);
+      for (size_t l = 0; l < child.children.size(); ++l) {
+        std::sprintf(name, "joint%d", num_joints++);
+        child.children[l].name = name;
+      }
+    }
+  }
+  ASSERT_EQ(raw_skeleton.num_joints(), num_joints);
+
+  SkeletonBuilder builder;
+  EXPECT_TRUE(builder.dispatcher == NULL);
+  Skeleton* serial = builder(raw_skeleton);
+  ASSERT_TRUE(serial != NULL);
+
+  ozz::tasks::ThreadPool pool(4);
+  builder.dispatcher = &pool;
+  Skeleton* dispatched = builder(raw_skeleton);
+  ASSERT_TRUE(dispatched != NULL);
+
+  // Both skeletons are identical.
+  ASSERT_EQ(serial->num_joints(), num_joints);
+  ASSERT_EQ(dispatched->num_joints(), num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    EXPECT_EQ(serial->joint_properties()[i].parent,
+              dispatched->joint_properties()[i].parent);
+    EXPECT_STREQ(serial->joint_names()[i], dispatched->joint_names()[i]);
+    EXPECT_EQ(dispatched->FindJoint(serial->joint_names()[i]), i);
+  }
+
+  ozz::memory::default_allocator()->Delete(serial);
+  ozz::memory::default_allocator()->Delete(dispatched);
+}
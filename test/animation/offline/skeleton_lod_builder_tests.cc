@@ -0,0 +1,238 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/skeleton_lod_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::SkeletonLodBuilder;
+
+namespace {
+// Builds a skeleton whose joints are ordered this way by the SkeletonBuilder:
+// root(0), spine(1), twist(2), head(3), arm_l(4), arm_r(5), finger_l(6),
+// finger_r(7). Every joint translation x component is its index.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  RawSkeleton::Joint& spine = root.children[0];
+  spine.name = "spine";
+  root.children[1].name = "twist";
+  spine.children.resize(3);
+  spine.children[0].name = "head";
+  spine.children[1].name = "arm_l";
+  spine.children[2].name = "arm_r";
+  spine.children[1].children.resize(1);
+  spine.children[1].children[0].name = "finger_l";
+  spine.children[2].children.resize(1);
+  spine.children[2].children[0].name = "finger_r";
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+
+  // Sets translations from the built skeleton, as joint indices are only
+  // known once it's built.
+  ozz::math::SoaTransform* bind_pose =
+    const_cast<ozz::math::SoaTransform*>(skeleton->bind_pose().begin);
+  for (int i = 0; i < skeleton->num_soa_joints(); ++i) {
+    const float base = static_cast<float>(i * 4);
+    bind_pose[i].translation.x =
+      ozz::math::simd_float4::Load(base, base + 1.f, base + 2.f, base + 3.f);
+  }
+  return skeleton;
+}
+
+// Expects _skeleton joint _index to be named _name, with parent named
+// _parent, and to have translation x component _x.
+void ExpectJoint(const Skeleton& _skeleton, int _index, const char* _name,
+                 const char* _parent, float _x) {
+  EXPECT_STREQ(_skeleton.joint_names()[_index], _name);
+  EXPECT_EQ(_skeleton.FindJoint(_name), _index);
+  const int parent = _skeleton.joint_properties().begin[_index].parent;
+  if (_parent) {
+    ASSERT_LT(parent, _index);
+    EXPECT_STREQ(_skeleton.joint_names()[parent], _parent);
+  } else {
+    EXPECT_EQ(parent, Skeleton::kNoParentIndex);
+  }
+  float x[4];
+  ozz::math::StorePtrU(
+    _skeleton.bind_pose().begin[_index / 4].translation.x, x);
+  EXPECT_FLOAT_EQ(x[_index & 3], _x);
+}
+}  // namespace
+
+TEST(Error, SkeletonLodBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  {  // No lod.
+    SkeletonLodBuilder builder;
+    builder.lod_ratios.clear();
+    EXPECT_TRUE(builder(*skeleton) == NULL);
+  }
+  {  // Invalid ratio.
+    SkeletonLodBuilder builder;
+    builder.lod_ratios[1] = 0.f;
+    EXPECT_TRUE(builder(*skeleton) == NULL);
+    builder.lod_ratios[1] = 1.1f;
+    EXPECT_TRUE(builder(*skeleton) == NULL);
+  }
+  {  // Increasing ratios.
+    SkeletonLodBuilder builder;
+    builder.lod_ratios[2] = .75f;
+    EXPECT_TRUE(builder(*skeleton) == NULL);
+  }
+  {  // Influences size doesn't match the number of joints.
+    SkeletonLodBuilder builder;
+    builder.influences.resize(7, 1);
+    EXPECT_TRUE(builder(*skeleton) == NULL);
+  }
+  {  // Negative influence.
+    SkeletonLodBuilder builder;
+    builder.influences.resize(8, 1);
+    builder.influences[3] = -1;
+    EXPECT_TRUE(builder(*skeleton) == NULL);
+  }
+  {  // Empty skeleton.
+    SkeletonLodBuilder builder;
+    Skeleton empty;
+    Skeleton* lod_skeleton = builder(empty);
+    ASSERT_TRUE(lod_skeleton != NULL);
+    EXPECT_EQ(lod_skeleton->num_joints(), 0);
+    EXPECT_EQ(lod_skeleton->num_lods(), 3);
+    EXPECT_EQ(lod_skeleton->num_joints_lod(0), 0);
+    EXPECT_EQ(lod_skeleton->num_joints_lod(2), 0);
+    ozz::memory::default_allocator()->Delete(lod_skeleton);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Hierarchy, SkeletonLodBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  EXPECT_EQ(skeleton->num_lods(), 1);
+  EXPECT_EQ(skeleton->num_joints_lod(0), 8);
+  EXPECT_EQ(skeleton->num_joints_lod(1), 8);
+
+  SkeletonLodBuilder builder;
+  ozz::Vector<int>::Std remap;
+  Skeleton* lod_skeleton = builder(*skeleton, &remap);
+  ASSERT_TRUE(lod_skeleton != NULL);
+  ASSERT_EQ(lod_skeleton->num_joints(), 8);
+
+  // Joints with bigger hierarchies come first, leaves last.
+  ExpectJoint(*lod_skeleton, 0, "root", NULL, 0.f);
+  ExpectJoint(*lod_skeleton, 1, "spine", "root", 1.f);
+  ExpectJoint(*lod_skeleton, 2, "arm_l", "spine", 4.f);
+  ExpectJoint(*lod_skeleton, 3, "arm_r", "spine", 5.f);
+  ExpectJoint(*lod_skeleton, 4, "twist", "root", 2.f);
+  ExpectJoint(*lod_skeleton, 5, "head", "spine", 3.f);
+  ExpectJoint(*lod_skeleton, 6, "finger_l", "arm_l", 6.f);
+  ExpectJoint(*lod_skeleton, 7, "finger_r", "arm_r", 7.f);
+
+  for (int i = 0; i < lod_skeleton->num_joints(); ++i) {
+    EXPECT_EQ(lod_skeleton->joint_properties().begin[i].is_leaf != 0,
+              i >= 4) << i;
+  }
+
+  ASSERT_EQ(remap.size(), 8u);
+  const int expected_remap[] = {0, 1, 4, 5, 2, 3, 6, 7};
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(remap[i], expected_remap[i]);
+  }
+
+  // Lods.
+  EXPECT_EQ(lod_skeleton->num_lods(), 3);
+  EXPECT_EQ(lod_skeleton->num_joints_lod(-1), 8);
+  EXPECT_EQ(lod_skeleton->num_joints_lod(0), 8);
+  EXPECT_EQ(lod_skeleton->num_joints_lod(1), 4);
+  EXPECT_EQ(lod_skeleton->num_joints_lod(2), 2);
+  EXPECT_EQ(lod_skeleton->num_joints_lod(3), 2);
+
+  ozz::memory::default_allocator()->Delete(lod_skeleton);
+
+  // Joints of equal importance belong to the same lod.
+  builder.lod_ratios[2] = .3f;
+  lod_skeleton = builder(*skeleton);
+  ASSERT_TRUE(lod_skeleton != NULL);
+  EXPECT_EQ(lod_skeleton->num_joints_lod(2), 4);
+  ozz::memory::default_allocator()->Delete(lod_skeleton);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Influences, SkeletonLodBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Only head and fingers influence vertices.
+  SkeletonLodBuilder builder;
+  builder.lod_ratios.resize(2);
+  builder.lod_ratios[1] = .375f;
+  builder.influences.resize(8, 0);
+  builder.influences[3] = 100;
+  builder.influences[6] = 10;
+  builder.influences[7] = 10;
+
+  Skeleton* lod_skeleton = builder(*skeleton);
+  ASSERT_TRUE(lod_skeleton != NULL);
+  ASSERT_EQ(lod_skeleton->num_joints(), 8);
+
+  ExpectJoint(*lod_skeleton, 0, "root", NULL, 0.f);
+  ExpectJoint(*lod_skeleton, 1, "spine", "root", 1.f);
+  ExpectJoint(*lod_skeleton, 2, "head", "spine", 3.f);
+  ExpectJoint(*lod_skeleton, 3, "arm_l", "spine", 4.f);
+  ExpectJoint(*lod_skeleton, 4, "arm_r", "spine", 5.f);
+  ExpectJoint(*lod_skeleton, 5, "finger_l", "arm_l", 6.f);
+  ExpectJoint(*lod_skeleton, 6, "finger_r", "arm_r", 7.f);
+  ExpectJoint(*lod_skeleton, 7, "twist", "root", 2.f);
+
+  EXPECT_EQ(lod_skeleton->num_lods(), 2);
+  EXPECT_EQ(lod_skeleton->num_joints_lod(0), 8);
+  EXPECT_EQ(lod_skeleton->num_joints_lod(1), 3);
+
+  ozz::memory::default_allocator()->Delete(lod_skeleton);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
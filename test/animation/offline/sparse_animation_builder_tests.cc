@@ -0,0 +1,159 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/sparse_animation_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/transform.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::SparseAnimationBuilder;
+
+namespace {
+// Builds a skeleton of 6 root joints, whose bind pose is translated along y
+// by the joint index.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(6);
+  for (int i = 0; i < 6; ++i) {
+    RawSkeleton::Joint& joint = raw_skeleton.roots[i];
+    joint.name = "joint";
+    joint.name += static_cast<char>('0' + i);
+    joint.transform = ozz::math::Transform::identity();
+    joint.transform.translation.y = static_cast<float>(i);
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+}  // namespace
+
+TEST(Error, SparseAnimationBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  SparseAnimationBuilder builder;
+  ozz::Vector<uint16_t>::Std joints;
+  RawAnimation raw_animation;
+
+  {  // Number of tracks mismatch.
+    raw_animation.tracks.resize(5);
+    EXPECT_TRUE(!builder(raw_animation, *skeleton, &joints));
+  }
+
+  {  // Invalid animation.
+    raw_animation.tracks.resize(6);
+    raw_animation.duration = -1.f;
+    EXPECT_TRUE(!builder(raw_animation, *skeleton, &joints));
+    raw_animation.duration = 1.f;
+  }
+
+  {  // NULL joints.
+    EXPECT_TRUE(!builder(raw_animation, *skeleton, NULL));
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Build, SparseAnimationBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+  for (int i = 0; i < 6; ++i) {
+    // Keys match the bind pose.
+    const RawAnimation::TranslationKey key = {
+      .5f, ozz::math::Float3(0.f, static_cast<float>(i), 0.f)};
+    raw_animation.tracks[i].translations.push_back(key);
+  }
+
+  SparseAnimationBuilder builder;
+  ozz::Vector<uint16_t>::Std joints;
+
+  {  // No joint is animated.
+    Animation* animation = builder(raw_animation, *skeleton, &joints);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_tracks(), 0);
+    EXPECT_EQ(joints.size(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Animates joints 1, 3 and 4.
+  raw_animation.tracks[1].translations[0].value.x = 1.f;
+  const RawAnimation::RotationKey rotation = {
+    0.f, ozz::math::Quaternion::FromAxisAngle(
+           ozz::math::Float4(0.f, 1.f, 0.f, .1f))};
+  raw_animation.tracks[3].rotations.push_back(rotation);
+  const RawAnimation::ScaleKey scale = {
+    1.f, ozz::math::Float3(1.f, 2.f, 1.f)};
+  raw_animation.tracks[4].scales.push_back(scale);
+
+  // Opposed rotations are the same.
+  const RawAnimation::RotationKey opposed = {
+    0.f, -ozz::math::Quaternion::identity()};
+  raw_animation.tracks[5].rotations.push_back(opposed);
+
+  {
+    Animation* animation = builder(raw_animation, *skeleton, &joints);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_tracks(), 3);
+    ASSERT_EQ(joints.size(), 3u);
+    EXPECT_EQ(joints[0], 1);
+    EXPECT_EQ(joints[1], 3);
+    EXPECT_EQ(joints[2], 4);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Tolerances.
+    builder.translation_tolerance = 2.f;
+    builder.rotation_tolerance = .2f;
+    Animation* animation = builder(raw_animation, *skeleton, &joints);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_tracks(), 1);
+    ASSERT_EQ(joints.size(), 1u);
+    EXPECT_EQ(joints[0], 4);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -39,14 +39,22 @@
 class TestAnimationConverter :
   public ozz::animation::offline::AnimationConverter {
 private:
+  // Files are read independently, with no shared state.
+  virtual bool IsImportThreadSafe() const {
+    return true;
+  }
+
   // Implement SkeletonConverter::Import function.
-  virtual bool Import(const char* _filename,
-                      const ozz::animation::Skeleton& _skeleton,
-                      float _sampling_rate,
-                      ozz::animation::offline::RawAnimation* _animation) {
-    (void)_sampling_rate;
+  virtual bool Import(
+    const char* _filename,
+    const ozz::animation::Skeleton& _skeleton,
+    const ozz::animation::offline::JointTrackSampler& _sampler,
+    ozz::animation::offline::RawAnimation* _animation,
+    ozz::tasks::Dispatcher* _dispatcher) {
+    (void)_sampler;
     (void)_skeleton;
     (void)_animation;
+    (void)_dispatcher;
 
     ozz::io::File file(_filename, "rb");
     if (file.opened()) {
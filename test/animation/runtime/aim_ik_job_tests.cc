@@ -0,0 +1,290 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/aim_ik_job.h"
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::AimIKJob;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds the skeleton:
+/*
+      root
+     /    \
+  spine   leg
+    |
+  neck
+    |
+  head
+    |
+   hat
+*/
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(2);
+  RawSkeleton::Joint& spine = root.children[0];
+  spine.name = "spine";
+  spine.transform = ozz::math::Transform::identity();
+  spine.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  RawSkeleton::Joint& leg = root.children[1];
+  leg.name = "leg";
+  leg.transform = ozz::math::Transform::identity();
+  leg.transform.translation = ozz::math::Float3(0.f, -1.f, 0.f);
+  spine.children.resize(1);
+  RawSkeleton::Joint& neck = spine.children[0];
+  neck.name = "neck";
+  neck.transform = ozz::math::Transform::identity();
+  neck.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  neck.transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(0.f, 1.f, 0.f, .3f));
+  neck.children.resize(1);
+  RawSkeleton::Joint& head = neck.children[0];
+  head.name = "head";
+  head.transform = ozz::math::Transform::identity();
+  head.transform.translation = ozz::math::Float3(0.f, .5f, 0.f);
+  head.children.resize(1);
+  RawSkeleton::Joint& hat = head.children[0];
+  hat.name = "hat";
+  hat.transform = ozz::math::Transform::identity();
+  hat.transform.translation = ozz::math::Float3(0.f, .2f, 0.f);
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+void ComputeModels(const Skeleton& _skeleton,
+                   const ozz::math::SoaTransform* _locals,
+                   ozz::math::Float4x4* _models) {
+  LocalToModelJob job;
+  job.skeleton = &_skeleton;
+  job.input.begin = _locals;
+  job.input.end = _locals + _skeleton.num_soa_joints();
+  job.output.begin = _models;
+  job.output.end = _models + _skeleton.num_joints();
+  ASSERT_TRUE(job.Run());
+}
+
+void ExpectMatrixNear(const ozz::math::Float4x4& _a,
+                      const ozz::math::Float4x4& _b) {
+  for (int c = 0; c < 4; ++c) {
+    union {
+      ozz::math::SimdFloat4 ret;
+      float af[4];
+    } a = {_a.cols[c]}, b = {_b.cols[c]};
+    for (int r = 0; r < 4; ++r) {
+      EXPECT_NEAR(a.af[r], b.af[r], 1e-4f);
+    }
+  }
+}
+}  // namespace
+
+TEST(JobValidity, AimIKJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  const int spine = skeleton->FindJoint("spine");
+  const int leg = skeleton->FindJoint("leg");
+  const int head = skeleton->FindJoint("head");
+
+  ozz::math::SoaTransform locals[2];
+  ozz::math::Float4x4 models[6];
+  const int chain[] = {spine, head};
+  const int bad_chain[] = {spine, leg};
+  const int bad_index[] = {spine, 6};
+  const float weights[] = {.5f, 1.f};
+
+  {  // Default is invalid.
+    AimIKJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Missing chain.
+    AimIKJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    job.joint_weights = weights;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Too small models.
+    AimIKJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models.begin = models;
+    job.models.end = models + 5;
+    job.joints = chain;
+    job.joint_weights = weights;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Too small weights.
+    AimIKJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    job.joints = chain;
+    job.joint_weights.begin = weights;
+    job.joint_weights.end = weights + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Not a chain.
+    AimIKJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    job.joints = bad_chain;
+    job.joint_weights = weights;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid joint index.
+    AimIKJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    job.joints = bad_index;
+    job.joint_weights = weights;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Non normalized forward.
+    AimIKJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    job.joints = chain;
+    job.joint_weights = weights;
+    job.forward = ozz::math::simd_float4::Load(2.f, 0.f, 0.f, 0.f);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid.
+    AimIKJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    job.joints = chain;
+    job.joint_weights = weights;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Aim, AimIKJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  const int leg = skeleton->FindJoint("leg");
+  const int head = skeleton->FindJoint("head");
+  const int chain[] = {skeleton->FindJoint("spine"),
+                       skeleton->FindJoint("neck"),
+                       head};
+  const float weights[] = {.2f, .5f, 1.f};
+
+  ozz::math::SoaTransform locals[2];
+  ozz::math::Float4x4 models[6];
+  std::copy(skeleton->bind_pose().begin, skeleton->bind_pose().end, locals);
+  ComputeModels(*skeleton, locals, models);
+  const ozz::math::Float4x4 leg_model = models[leg];
+
+  AimIKJob job;
+  job.skeleton = skeleton;
+  job.locals = locals;
+  job.models = models;
+  job.joints = chain;
+  job.joint_weights = weights;
+
+  {  // Null weight leaves the pose unchanged.
+    job.target = ozz::math::simd_float4::Load(3.f, 4.f, -5.f, 0.f);
+    job.weight = 0.f;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform bind_locals[2];
+    ozz::math::Float4x4 bind_models[6];
+    std::copy(skeleton->bind_pose().begin, skeleton->bind_pose().end,
+              bind_locals);
+    ComputeModels(*skeleton, bind_locals, bind_models);
+    for (int i = 0; i < skeleton->num_joints(); ++i) {
+      ExpectMatrixNear(models[i], bind_models[i]);
+    }
+    job.weight = 1.f;
+  }
+
+  const float targets[][3] = {{3.f, 4.f, -5.f},
+                              {0.f, 2.5f, 10.f},
+                              {-1.f, 0.f, 0.f},
+                              {2.f, 3.f, 0.f}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(targets); ++i) {
+    job.target = ozz::math::simd_float4::Load(targets[i][0], targets[i][1],
+                                              targets[i][2], 0.f);
+    ASSERT_TRUE(job.Run());
+
+    // Head forward axis points to the target.
+    const ozz::math::SimdFloat4 forward =
+        ozz::math::Normalize3(models[head].cols[0]);
+    const ozz::math::SimdFloat4 to_target =
+        ozz::math::Normalize3(job.target - models[head].cols[3]);
+    EXPECT_NEAR(ozz::math::GetX(ozz::math::Dot3(forward, to_target)), 1.f,
+                1e-4f);
+
+    // Model matrices match corrected local transforms.
+    ozz::math::Float4x4 check[6];
+    ComputeModels(*skeleton, locals, check);
+    for (int j = 0; j < skeleton->num_joints(); ++j) {
+      ExpectMatrixNear(models[j], check[j]);
+    }
+
+    // Joints out of the chain aren't affected.
+    ExpectMatrixNear(models[leg], leg_model);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
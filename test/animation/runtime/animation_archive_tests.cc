@@ -36,13 +36,19 @@
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/linear_allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
+#include "ozz/base/maths/box.h"
 #include "ozz/base/maths/soa_transform.h"
 
 #include "ozz/animation/runtime/sampling_job.h"
 
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
 
 using ozz::animation::Animation;
 using ozz::animation::TranslationKey;
@@ -93,9 +99,24 @@ TEST(Filled, AnimationSerialize) {
       0.1f, ozz::math::Float3(99.f, 26.f, 14.f)};
     raw_animation.tracks[0].scales.push_back(s_key);
 
+    // Bounds need a skeleton matching the animation.
+    ozz::animation::offline::RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    raw_skeleton.roots[0].name = "root";
+    ozz::animation::offline::SkeletonBuilder skeleton_builder;
+    ozz::animation::Skeleton* skeleton = skeleton_builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+
     AnimationBuilder builder;
+    builder.seek_interval = .25f;
+    builder.key_links = true;
+    builder.bounds_skeleton = skeleton;
+    builder.bounds_interval = .5f;
     o_animation = builder(raw_animation);
+    ozz::memory::default_allocator()->Delete(skeleton);
     ASSERT_TRUE(o_animation != NULL);
+    ASSERT_TRUE(o_animation->seek_index().Count() != 0);
+    ASSERT_EQ(o_animation->bounds().Count(), 2u);
   }
 
   for (int e = 0; e < 2; ++e) {
@@ -115,7 +136,34 @@ TEST(Filled, AnimationSerialize) {
 
     ASSERT_FLOAT_EQ(o_animation->duration(), i_animation.duration());
     ASSERT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
+    EXPECT_EQ(o_animation->num_constant_translations(),
+              i_animation.num_constant_translations());
+    EXPECT_EQ(o_animation->num_constant_rotations(),
+              i_animation.num_constant_rotations());
+    EXPECT_EQ(o_animation->num_constant_scales(),
+              i_animation.num_constant_scales());
     EXPECT_EQ(o_animation->size(), i_animation.size());
+    ASSERT_EQ(o_animation->seek_index().Count(),
+              i_animation.seek_index().Count());
+    for (size_t j = 0; j < o_animation->seek_index().Count(); ++j) {
+      EXPECT_EQ(o_animation->seek_index().begin[j],
+                i_animation.seek_index().begin[j]);
+    }
+    ASSERT_EQ(o_animation->key_links().Count(),
+              i_animation.key_links().Count());
+    for (size_t j = 0; j < o_animation->key_links().Count(); ++j) {
+      EXPECT_EQ(o_animation->key_links().begin[j],
+                i_animation.key_links().begin[j]);
+    }
+    ASSERT_EQ(o_animation->bounds().Count(), i_animation.bounds().Count());
+    for (size_t j = 0; j < o_animation->bounds().Count(); ++j) {
+      const ozz::math::Box& o_bound = o_animation->bounds().begin[j];
+      const ozz::math::Box& i_bound = i_animation.bounds().begin[j];
+      EXPECT_FLOAT3_EQ(i_bound.min, o_bound.min.x, o_bound.min.y,
+                       o_bound.min.z);
+      EXPECT_FLOAT3_EQ(i_bound.max, o_bound.max.x, o_bound.max.y,
+                       o_bound.max.z);
+    }
 
     // Needs to sample to test the animation.
     ozz::animation::SamplingJob job;
@@ -201,3 +249,88 @@ TEST(AlreadyInitialized, AnimationSerialize) {
     ASSERT_EQ(i_animation.num_tracks(), 2);
   }
 }
+
+TEST(BufferAllocator, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  const RawAnimation::TranslationKey t_key0 = {
+    0.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[3].translations.push_back(t_key0);
+  const RawAnimation::TranslationKey t_key1 = {
+    1.f, ozz::math::Float3(4.f, 0.f, 0.f)};
+  raw_animation.tracks[3].translations.push_back(t_key1);
+  const RawAnimation::ScaleKey s_key = {
+    .5f, ozz::math::Float3(2.f, 2.f, 2.f)};
+  raw_animation.tracks[4].scales.push_back(s_key);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .25f;
+  builder.key_links = true;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    o << *o_animation;
+  }
+
+  // Loaded buffers are packed in a single allocation.
+  ozz::memory::TrackingAllocator tracking;
+  Animation::SetBufferAllocator(&tracking);
+  {
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Animation i_animation;
+    i >> i_animation;
+    EXPECT_EQ(tracking.total().live_count, 1);
+    EXPECT_EQ(i_animation.size(), o_animation->size());
+    EXPECT_FALSE(i_animation.mapped());
+
+    // Reloading releases the previous buffer.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i2(&stream);
+    i2 >> i_animation;
+    EXPECT_EQ(tracking.total().live_count, 1);
+  }
+  EXPECT_EQ(tracking.total().live_count, 0);
+
+  // Animations can be loaded to caller memory.
+  OZZ_ALIGN(16) char buffer[4096];
+  ozz::memory::LinearAllocator linear(buffer, sizeof(buffer));
+  Animation::SetBufferAllocator(&linear);
+  {
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Animation i_animation;
+    i >> i_animation;
+    Animation::SetBufferAllocator(NULL);
+    EXPECT_GT(linear.used(), 0u);
+    EXPECT_LE(linear.used(),
+              i_animation.size() - sizeof(Animation) +
+              8 * Animation::kBlobAlignment);
+    EXPECT_EQ(i_animation.num_tracks(), 5);
+    EXPECT_EQ(i_animation.seek_index().Count(),
+              o_animation->seek_index().Count());
+
+    ozz::animation::SamplingJob job;
+    ozz::animation::SamplingCache cache(5);
+    ozz::math::SoaTransform output[2];
+    job.animation = &i_animation;
+    job.cache = &cache;
+    job.time = .5f;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 0.f, 0.f, 3.f,
+                                                   0.f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 2.f, 1.f, 1.f, 1.f,
+                                             2.f, 1.f, 1.f, 1.f,
+                                             2.f, 1.f, 1.f, 1.f);
+  }
+  Animation::SetBufferAllocator(NULL);
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
@@ -0,0 +1,162 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_bank.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_bank_builder.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationBank;
+using ozz::animation::offline::AnimationBankBuilder;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds an animation whose translation x moves from 0 to _value.
+Animation* BuildAnimation(float _value, int _num_tracks) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::TranslationKey t0 = {0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+    raw_animation.tracks[i].translations.push_back(t0);
+    RawAnimation::TranslationKey t1 = {
+      1.f, ozz::math::Float3(_value, 0.f, 0.f)};
+    raw_animation.tracks[i].translations.push_back(t1);
+    RawAnimation::ScaleKey s = {.5f, ozz::math::Float3(2.f, 2.f, 2.f)};
+    raw_animation.tracks[i].scales.push_back(s);
+  }
+  return AnimationBuilder()(raw_animation);
+}
+}  // namespace
+
+TEST(Empty, AnimationBank) {
+  AnimationBank bank;
+  EXPECT_EQ(bank.num_animations(), 0);
+  EXPECT_EQ(bank.Find("run"), -1);
+  EXPECT_EQ(bank.size(), sizeof(AnimationBank));
+
+  // Serializes an empty bank.
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << bank;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  ASSERT_TRUE(i.TestTag<AnimationBank>());
+  AnimationBank i_bank;
+  i >> i_bank;
+  EXPECT_EQ(i_bank.num_animations(), 0);
+  EXPECT_EQ(i_bank.Find("run"), -1);
+}
+
+TEST(Serialize, AnimationBank) {
+  Animation* walk = BuildAnimation(1.f, 1);
+  ASSERT_TRUE(walk != NULL);
+  Animation* run = BuildAnimation(2.f, 5);
+  ASSERT_TRUE(run != NULL);
+
+  const AnimationBankBuilder::Entry entries[] = {
+    {"walk", walk}, {"run", run}};
+  AnimationBank* o_bank = AnimationBankBuilder()(
+    ozz::Range<const AnimationBankBuilder::Entry>(entries));
+  ASSERT_TRUE(o_bank != NULL);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_bank;
+
+    // Streams in, twice to test bank reuse.
+    AnimationBank i_bank;
+    for (int l = 0; l < 2; ++l) {
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      ASSERT_TRUE(i.TestTag<AnimationBank>());
+      i >> i_bank;
+
+      ASSERT_EQ(i_bank.num_animations(), 2);
+      EXPECT_EQ(i_bank.size(), o_bank->size());
+      EXPECT_STREQ(i_bank.name(0), "walk");
+      EXPECT_STREQ(i_bank.name(1), "run");
+      EXPECT_EQ(i_bank.Find("walk"), 0);
+      EXPECT_EQ(i_bank.Find("run"), 1);
+      EXPECT_EQ(i_bank.Find("jump"), -1);
+
+      for (int a = 0; a < 2; ++a) {
+        const Animation& animation = i_bank.animation(a);
+        EXPECT_FLOAT_EQ(animation.duration(),
+                        entries[a].animation->duration());
+        EXPECT_EQ(animation.num_tracks(), entries[a].animation->num_tracks());
+        EXPECT_EQ(animation.size(), entries[a].animation->size());
+      }
+
+      // Samples loaded "run" animation.
+      ozz::animation::SamplingJob job;
+      ozz::animation::SamplingCache cache(8);
+      ozz::math::SoaTransform output[2];
+      job.animation = &i_bank.animation(i_bank.Find("run"));
+      job.cache = &cache;
+      job.output.begin = output;
+      job.output.end = output + 2;
+      job.time = .5f;
+      ASSERT_TRUE(job.Run());
+      EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 1.f, 1.f, 1.f,
+                                                     0.f, 0.f, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f);
+      EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 1.f, 0.f, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f);
+      EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 2.f, 1.f, 1.f, 1.f,
+                                               2.f, 1.f, 1.f, 1.f,
+                                               2.f, 1.f, 1.f, 1.f);
+      cache.Invalidate();
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(o_bank);
+  ozz::memory::default_allocator()->Delete(walk);
+  ozz::memory::default_allocator()->Delete(run);
+}
@@ -0,0 +1,319 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+
+namespace {
+Animation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  RawAnimation::TranslationKey t_key0 = {
+    0.f, ozz::math::Float3(93.f, 58.f, 46.f)};
+  raw_animation.tracks[0].translations.push_back(t_key0);
+  RawAnimation::TranslationKey t_key1 = {
+    .9f, ozz::math::Float3(46.f, 58.f, 93.f)};
+  raw_animation.tracks[0].translations.push_back(t_key1);
+
+  RawAnimation::RotationKey r_key = {
+    0.7f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].rotations.push_back(r_key);
+
+  RawAnimation::ScaleKey s_key = {
+    0.1f, ozz::math::Float3(99.f, 26.f, 14.f)};
+  raw_animation.tracks[0].scales.push_back(s_key);
+
+  // Bounds need a skeleton matching the animation.
+  ozz::animation::offline::RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  ozz::animation::offline::SkeletonBuilder skeleton_builder;
+  ozz::animation::Skeleton* skeleton = skeleton_builder(raw_skeleton);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .25f;
+  builder.key_links = true;
+  builder.bounds_skeleton = skeleton;
+  builder.bounds_interval = .5f;
+  Animation* animation = builder(raw_animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+  return animation;
+}
+
+// Key frame types are private, so buffers are compared as bytes. Also checks
+// that _mapped buffer is in [_blob_begin,_blob_end[ range.
+template<typename _Key>
+bool BytesEqual(const ozz::Range<const _Key>& _original,
+                const ozz::Range<const _Key>& _mapped,
+                const char* _blob_begin,
+                const char* _blob_end) {
+  const char* o_begin = reinterpret_cast<const char*>(_original.begin);
+  const char* o_end = reinterpret_cast<const char*>(_original.end);
+  const char* m_begin = reinterpret_cast<const char*>(_mapped.begin);
+  const char* m_end = reinterpret_cast<const char*>(_mapped.end);
+  return o_end - o_begin == m_end - m_begin &&
+         m_begin >= _blob_begin && m_end <= _blob_end &&
+         memcmp(o_begin, m_begin, o_end - o_begin) == 0;
+}
+}  // namespace
+
+TEST(Validity, AnimationBlob) {
+  Animation* o_animation = BuildAnimation();
+  ASSERT_TRUE(o_animation != NULL);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = o_animation->blob_size();
+  char* blob = static_cast<char*>(
+    allocator->Allocate(size + Animation::kBlobAlignment,
+                        Animation::kBlobAlignment));
+
+  // Invalid save buffers.
+  EXPECT_FALSE(o_animation->SaveBlob(NULL, size));
+  EXPECT_FALSE(o_animation->SaveBlob(blob, size - 1));
+  EXPECT_FALSE(o_animation->SaveBlob(blob + 4, size));
+  EXPECT_TRUE(o_animation->SaveBlob(blob, size));
+
+  Animation i_animation;
+
+  // Invalid map buffers.
+  EXPECT_FALSE(i_animation.MapBlob(NULL, size));
+  EXPECT_FALSE(i_animation.MapBlob(blob, size - 1));
+  EXPECT_FALSE(i_animation.MapBlob(blob, 4));
+  EXPECT_FALSE(i_animation.mapped());
+  EXPECT_EQ(i_animation.num_tracks(), 0);
+
+  // Unaligned buffer.
+  memmove(blob + 4, blob, size);
+  EXPECT_FALSE(i_animation.MapBlob(blob + 4, size));
+  memmove(blob, blob + 4, size);
+
+  // Corrupted tag, which also detects endianness mismatch.
+  blob[0] ^= 0xff;
+  EXPECT_FALSE(i_animation.MapBlob(blob, size));
+  blob[0] ^= 0xff;
+
+  // Unsupported version.
+  blob[4] ^= 0xff;
+  EXPECT_FALSE(i_animation.MapBlob(blob, size));
+  blob[4] ^= 0xff;
+
+  EXPECT_TRUE(i_animation.MapBlob(blob, size));
+  EXPECT_TRUE(i_animation.mapped());
+
+  // Failing to remap leaves the animation empty and unmapped.
+  EXPECT_FALSE(i_animation.MapBlob(blob, size - 1));
+  EXPECT_FALSE(i_animation.mapped());
+  EXPECT_EQ(i_animation.num_tracks(), 0);
+  EXPECT_TRUE(i_animation.translations().begin == NULL);
+
+  allocator->Deallocate(blob);
+  allocator->Delete(o_animation);
+}
+
+TEST(Empty, AnimationBlob) {
+  Animation o_animation;
+  const size_t size = o_animation.blob_size();
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  void* blob = allocator->Allocate(size, Animation::kBlobAlignment);
+  ASSERT_TRUE(o_animation.SaveBlob(blob, size));
+
+  Animation i_animation;
+  EXPECT_TRUE(i_animation.MapBlob(blob, size));
+  EXPECT_EQ(i_animation.num_tracks(), 0);
+  EXPECT_FLOAT_EQ(i_animation.duration(), 0.f);
+  EXPECT_TRUE(i_animation.translations().begin ==
+              i_animation.translations().end);
+  EXPECT_TRUE(i_animation.rotations().begin == i_animation.rotations().end);
+  EXPECT_TRUE(i_animation.scales().begin == i_animation.scales().end);
+
+  allocator->Deallocate(blob);
+}
+
+TEST(Filled, AnimationBlob) {
+  Animation* o_animation = BuildAnimation();
+  ASSERT_TRUE(o_animation != NULL);
+
+  // Writes the blob to a stream, then reads it back with a single Read call,
+  // as it would be done when loading from a file.
+  ozz::io::MemoryStream stream;
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = o_animation->blob_size();
+  {
+    void* blob = allocator->Allocate(size, Animation::kBlobAlignment);
+    ASSERT_TRUE(o_animation->SaveBlob(blob, size));
+    ASSERT_EQ(stream.Write(blob, size), size);
+    allocator->Deallocate(blob);
+  }
+  void* blob = allocator->Allocate(size, Animation::kBlobAlignment);
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ASSERT_EQ(stream.Read(blob, size), size);
+
+  Animation i_animation;
+  ASSERT_TRUE(i_animation.MapBlob(blob, size));
+  EXPECT_TRUE(i_animation.mapped());
+  EXPECT_FALSE(o_animation->mapped());
+
+  ASSERT_FLOAT_EQ(o_animation->duration(), i_animation.duration());
+  ASSERT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
+  EXPECT_EQ(o_animation->num_constant_translations(),
+            i_animation.num_constant_translations());
+  EXPECT_EQ(o_animation->num_constant_rotations(),
+            i_animation.num_constant_rotations());
+  EXPECT_EQ(o_animation->num_constant_scales(),
+            i_animation.num_constant_scales());
+  EXPECT_EQ(o_animation->size(), i_animation.size());
+
+  // Key frames are used in place, and are identical to the original ones.
+  const char* blob_begin = static_cast<const char*>(blob);
+  const char* blob_end = blob_begin + size;
+  EXPECT_TRUE(BytesEqual(o_animation->translations(),
+                         i_animation.translations(),
+                         blob_begin, blob_end));
+  EXPECT_TRUE(BytesEqual(o_animation->rotations(),
+                         i_animation.rotations(),
+                         blob_begin, blob_end));
+  EXPECT_TRUE(BytesEqual(o_animation->scales(),
+                         i_animation.scales(),
+                         blob_begin, blob_end));
+  ASSERT_TRUE(o_animation->seek_index().Count() != 0);
+  EXPECT_TRUE(BytesEqual(o_animation->seek_index(),
+                         i_animation.seek_index(),
+                         blob_begin, blob_end));
+  ASSERT_TRUE(o_animation->key_links().Count() != 0);
+  EXPECT_TRUE(BytesEqual(o_animation->key_links(),
+                         i_animation.key_links(),
+                         blob_begin, blob_end));
+  ASSERT_TRUE(o_animation->bounds().Count() != 0);
+  EXPECT_TRUE(BytesEqual(o_animation->bounds(),
+                         i_animation.bounds(),
+                         blob_begin, blob_end));
+
+  // Samples the mapped animation.
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  job.animation = &i_animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  { // Samples at t = 0
+    job.time = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 93.f, 0.f, 0.f, 0.f,
+                                                   58.f, 0.f, 0.f, 0.f,
+                                                   46.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f,
+                                                    1.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 99.f, 1.f, 1.f, 1.f,
+                                             26.f, 1.f, 1.f, 1.f,
+                                             14.f, 1.f, 1.f, 1.f);
+  }
+  { // Samples at t = 1
+    job.time = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 46.f, 0.f, 0.f, 0.f,
+                                                   58.f, 0.f, 0.f, 0.f,
+                                                   93.f, 0.f, 0.f, 0.f);
+  }
+
+  // The mapped animation doesn't own the blob, which can be released first.
+  allocator->Deallocate(blob);
+  allocator->Delete(o_animation);
+}
+
+TEST(Endianness, AnimationBlob) {
+  Animation* o_animation = BuildAnimation();
+  ASSERT_TRUE(o_animation != NULL);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = o_animation->blob_size();
+  char* native = static_cast<char*>(
+    allocator->Allocate(size, Animation::kBlobAlignment));
+  char* cooked = static_cast<char*>(
+    allocator->Allocate(size, Animation::kBlobAlignment));
+
+  // Native endianness blob is the default one.
+  ASSERT_TRUE(o_animation->SaveBlob(native, size));
+  ASSERT_TRUE(o_animation->SaveBlob(cooked, size,
+                                    ozz::GetNativeEndianness()));
+  EXPECT_EQ(memcmp(native, cooked, size), 0);
+
+  // Opposite endianness blob can't be used on this platform.
+  const ozz::Endianness opposite =
+    ozz::GetNativeEndianness() == ozz::kLittleEndian ?
+      ozz::kBigEndian : ozz::kLittleEndian;
+  EXPECT_FALSE(o_animation->SaveBlob(NULL, size, opposite));
+  EXPECT_FALSE(o_animation->SaveBlob(cooked, size - 1, opposite));
+  ASSERT_TRUE(o_animation->SaveBlob(cooked, size, opposite));
+  EXPECT_NE(memcmp(native, cooked, size), 0);
+  EXPECT_EQ(Animation::blob_size(cooked, size), 0u);
+  Animation i_animation;
+  EXPECT_FALSE(i_animation.MapBlob(cooked, size));
+
+  // Tag and version (4 bytes each), then duration that follows 6 uint16_t
+  // sizes, are byte swapped.
+  const size_t swapped[] = {0, 4, 20};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(swapped); ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      EXPECT_EQ(native[swapped[i] + j], cooked[swapped[i] + 3 - j]);
+    }
+  }
+
+  allocator->Deallocate(cooked);
+  allocator->Deallocate(native);
+  allocator->Delete(o_animation);
+}
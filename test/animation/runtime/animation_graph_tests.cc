@@ -0,0 +1,477 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_graph.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationGraph;
+using ozz::animation::BlendingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Number of joints of the test skeleton, which makes 2 soa joints.
+const int kNumJoints = 6;
+const int kNumSoaJoints = 2;
+
+// Builds a skeleton of kNumJoints joints, all children of the root, whose
+// bind pose is translated by 1 along z.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.transform.translation = ozz::math::Float3(0.f, 0.f, 1.f);
+  root.children.resize(kNumJoints - 1);
+  for (int i = 0; i < kNumJoints - 1; ++i) {
+    RawSkeleton::Joint& child = root.children[i];
+    child.name = std::string("j") + static_cast<char>('0' + i);
+    child.transform = root.transform;
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation of _num_tracks tracks, whose tracks translate along x
+// from 0 to _distance in 1 second, and rotate around y.
+Animation* BuildAnimation(int _num_tracks, float _distance) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const RawAnimation::TranslationKey first = {
+      0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+    track.translations.push_back(first);
+    const RawAnimation::TranslationKey last = {
+      1.f, ozz::math::Float3(_distance, 0.f, i * .1f)};
+    track.translations.push_back(last);
+    const RawAnimation::RotationKey rotation = {
+      0.f, ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float4(0.f, 1.f, 0.f, _distance))};
+    track.rotations.push_back(rotation);
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Expects _a and _b postures to be identical.
+void ExpectEq(const ozz::math::SoaTransform* _a,
+              const ozz::math::SoaTransform* _b) {
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    EXPECT_EQ(std::memcmp(_a + i, _b + i, sizeof(*_a)), 0);
+  }
+}
+
+// Samples _animation at _time to _output.
+void Sample(const Animation& _animation, float _time,
+            ozz::math::SoaTransform* _output) {
+  SamplingCache cache(kNumJoints);
+  SamplingJob job;
+  job.animation = &_animation;
+  job.cache = &cache;
+  job.time = _time;
+  job.output.begin = _output;
+  job.output.end = _output + kNumSoaJoints;
+  ASSERT_TRUE(job.Run());
+}
+}  // namespace
+
+TEST(Validity, AnimationGraph) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(kNumJoints, 1.f);
+  ASSERT_TRUE(animation != NULL);
+  Animation* too_big = BuildAnimation(kNumJoints + 1, 1.f);
+  ASSERT_TRUE(too_big != NULL);
+  SamplingCache cache(kNumJoints);
+
+  AnimationGraph graph(*skeleton, 4, 3);
+  EXPECT_EQ(graph.num_nodes(), 0);
+
+  // Invalid sample nodes.
+  EXPECT_EQ(graph.AddSampleNode(NULL, &cache), AnimationGraph::kInvalidNode);
+  EXPECT_EQ(graph.AddSampleNode(animation, NULL),
+            AnimationGraph::kInvalidNode);
+  EXPECT_EQ(graph.AddSampleNode(too_big, &cache),
+            AnimationGraph::kInvalidNode);
+  const int sample = graph.AddSampleNode(animation, &cache);
+  EXPECT_EQ(sample, 0);
+
+  // Inputs must refer to existing nodes.
+  AnimationGraph::Input inputs[2];
+  inputs[0].node = sample;
+  inputs[0].weight = 1.f;
+  inputs[1].node = 1;
+  EXPECT_EQ(graph.AddBlendNode(
+    ozz::Range<const AnimationGraph::Input>(inputs, 2)),
+    AnimationGraph::kInvalidNode);
+  EXPECT_EQ(graph.AddAdditiveNode(sample, 1, 1.f),
+            AnimationGraph::kInvalidNode);
+  EXPECT_EQ(graph.AddAdditiveNode(-1, sample, 1.f),
+            AnimationGraph::kInvalidNode);
+
+  // Joint weights must be big enough.
+  const ozz::math::SimdFloat4 weights[kNumSoaJoints] = {
+    ozz::math::simd_float4::one(), ozz::math::simd_float4::one()};
+  inputs[1].node = sample;
+  inputs[1].joint_weights.begin = weights;
+  inputs[1].joint_weights.end = weights + 1;
+  EXPECT_EQ(graph.AddBlendNode(
+    ozz::Range<const AnimationGraph::Input>(inputs, 2)),
+    AnimationGraph::kInvalidNode);
+  EXPECT_EQ(graph.AddMaskNode(sample, sample,
+                              ozz::Range<const ozz::math::SimdFloat4>()),
+            AnimationGraph::kInvalidNode);
+  EXPECT_EQ(graph.AddMaskNode(sample, sample, inputs[1].joint_weights),
+            AnimationGraph::kInvalidNode);
+  inputs[1].joint_weights.end = weights + kNumSoaJoints;
+  EXPECT_EQ(graph.AddBlendNode(
+    ozz::Range<const AnimationGraph::Input>(inputs, 2)), 1);
+
+  // Inputs capacity is exhausted.
+  EXPECT_EQ(graph.AddAdditiveNode(sample, 1, 1.f),
+            AnimationGraph::kInvalidNode);
+  EXPECT_EQ(graph.AddBlendNode(
+    ozz::Range<const AnimationGraph::Input>(inputs, 1)), 2);
+
+  // Nodes capacity is exhausted.
+  EXPECT_EQ(graph.AddSampleNode(animation, &cache), 3);
+  EXPECT_EQ(graph.AddSampleNode(animation, &cache),
+            AnimationGraph::kInvalidNode);
+  EXPECT_EQ(graph.num_nodes(), 4);
+
+  // Invalid evaluation.
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  EXPECT_FALSE(graph.Evaluate(
+    -1, ozz::Range<ozz::math::SoaTransform>(output, kNumSoaJoints)));
+  EXPECT_FALSE(graph.Evaluate(
+    4, ozz::Range<ozz::math::SoaTransform>(output, kNumSoaJoints)));
+  EXPECT_FALSE(graph.Evaluate(
+    1, ozz::Range<ozz::math::SoaTransform>(output, kNumSoaJoints - 1)));
+  EXPECT_FALSE(graph.Evaluate(1, ozz::Range<ozz::math::SoaTransform>()));
+  EXPECT_TRUE(graph.Evaluate(
+    1, ozz::Range<ozz::math::SoaTransform>(output, kNumSoaJoints)));
+
+  // Sampling failure is reported.
+  SamplingCache small_cache(1);
+  AnimationGraph failing(*skeleton, 1, 0);
+  const int small = failing.AddSampleNode(animation, &small_cache);
+  EXPECT_FALSE(failing.Evaluate(
+    small, ozz::Range<ozz::math::SoaTransform>(output, kNumSoaJoints)));
+
+  ozz::memory::default_allocator()->Delete(too_big);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Nodes, AnimationGraph) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  const int kNumAnimations = 3;
+  Animation* animations[kNumAnimations] = {
+    BuildAnimation(kNumJoints, 1.f),
+    BuildAnimation(kNumJoints, -1.f),
+    BuildAnimation(kNumJoints - 3, .5f)};
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  SamplingCache* caches[kNumAnimations];
+  for (int i = 0; i < kNumAnimations; ++i) {
+    ASSERT_TRUE(animations[i] != NULL);
+    caches[i] = allocator->New<SamplingCache>(kNumJoints);
+  }
+
+  // Builds a graph that blends 2 animations, masks the result with a third
+  // one, whose joints that aren't animated are set to the bind pose, and adds
+  // the first animation to it.
+  AnimationGraph graph(*skeleton, 8, 8);
+  int samples[kNumAnimations];
+  for (int i = 0; i < kNumAnimations; ++i) {
+    samples[i] = graph.AddSampleNode(animations[i], caches[i]);
+    ASSERT_NE(samples[i], AnimationGraph::kInvalidNode);
+  }
+  AnimationGraph::Input inputs[2];
+  inputs[0].node = samples[0];
+  inputs[0].weight = .3f;
+  inputs[1].node = samples[1];
+  inputs[1].weight = .7f;
+  const int blend = graph.AddBlendNode(
+    ozz::Range<const AnimationGraph::Input>(inputs, 2));
+  ASSERT_NE(blend, AnimationGraph::kInvalidNode);
+  const ozz::math::SimdFloat4 mask[kNumSoaJoints] = {
+    ozz::math::simd_float4::Load(1.f, 0.f, .5f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 1.f, 1.f, 1.f)};
+  const int masked = graph.AddMaskNode(
+    blend, samples[2],
+    ozz::Range<const ozz::math::SimdFloat4>(mask, kNumSoaJoints));
+  ASSERT_NE(masked, AnimationGraph::kInvalidNode);
+  const int additive = graph.AddAdditiveNode(masked, samples[0], .5f);
+  ASSERT_NE(additive, AnimationGraph::kInvalidNode);
+
+  ozz::math::SoaTransform locals[kNumAnimations][kNumSoaJoints];
+  ozz::math::SoaTransform expected_blend[kNumSoaJoints];
+  ozz::math::SoaTransform expected_mask[kNumSoaJoints];
+  ozz::math::SoaTransform expected[kNumSoaJoints];
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  const ozz::Range<ozz::math::SoaTransform> output_range(output,
+                                                         kNumSoaJoints);
+  for (float time = 0.f; time <= 1.f; time += .25f) {
+    for (int i = 0; i < kNumAnimations; ++i) {
+      graph.SetTime(samples[i], time);
+      Sample(*animations[i], time, locals[i]);
+    }
+    // Joints that aren't animated are set to the bind pose.
+    locals[2][1] = skeleton->bind_pose().begin[1];
+
+    // Computes expected postures with sampling and blending jobs.
+    BlendingJob::Layer layers[2];
+    BlendingJob job;
+    job.bind_pose = skeleton->bind_pose();
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+
+    layers[0].weight = .3f;
+    layers[0].transform.begin = locals[0];
+    layers[0].transform.end = locals[0] + kNumSoaJoints;
+    layers[1].weight = .7f;
+    layers[1].transform.begin = locals[1];
+    layers[1].transform.end = locals[1] + kNumSoaJoints;
+    job.output.begin = expected_blend;
+    job.output.end = expected_blend + kNumSoaJoints;
+    ASSERT_TRUE(job.Run());
+
+    const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+    const ozz::math::SimdFloat4 complement[kNumSoaJoints] = {
+      one - mask[0], one - mask[1]};
+    layers[0].weight = 1.f;
+    layers[0].transform.begin = expected_blend;
+    layers[0].transform.end = expected_blend + kNumSoaJoints;
+    layers[0].joint_weights.begin = complement;
+    layers[0].joint_weights.end = complement + kNumSoaJoints;
+    layers[1].weight = 1.f;
+    layers[1].transform.begin = locals[2];
+    layers[1].transform.end = locals[2] + kNumSoaJoints;
+    layers[1].joint_weights.begin = mask;
+    layers[1].joint_weights.end = mask + kNumSoaJoints;
+    job.output.begin = expected_mask;
+    job.output.end = expected_mask + kNumSoaJoints;
+    ASSERT_TRUE(job.Run());
+
+    BlendingJob::Layer base;
+    base.weight = 1.f;
+    base.transform.begin = expected_mask;
+    base.transform.end = expected_mask + kNumSoaJoints;
+    BlendingJob::Layer additive_layer;
+    additive_layer.weight = .5f;
+    additive_layer.transform.begin = locals[0];
+    additive_layer.transform.end = locals[0] + kNumSoaJoints;
+    job.layers.begin = &base;
+    job.layers.end = &base + 1;
+    job.additive_layers.begin = &additive_layer;
+    job.additive_layers.end = &additive_layer + 1;
+    job.output.begin = expected;
+    job.output.end = expected + kNumSoaJoints;
+    ASSERT_TRUE(job.Run());
+
+    // Evaluates every node.
+    ASSERT_TRUE(graph.Evaluate(samples[2], output_range));
+    ExpectEq(output, locals[2]);
+    EXPECT_EQ(graph.num_computed_nodes(), 1);
+    ASSERT_TRUE(graph.Evaluate(blend, output_range));
+    ExpectEq(output, expected_blend);
+    EXPECT_EQ(graph.num_computed_nodes(), 3);
+    ASSERT_TRUE(graph.Evaluate(masked, output_range));
+    ExpectEq(output, expected_mask);
+    EXPECT_EQ(graph.num_computed_nodes(), 5);
+    ASSERT_TRUE(graph.Evaluate(additive, output_range));
+    ExpectEq(output, expected);
+    EXPECT_EQ(graph.num_computed_nodes(), 7);
+  }
+
+  { // Zero weight inputs aren't evaluated.
+    graph.SetWeight(additive, 1, 0.f);
+    ASSERT_TRUE(graph.Evaluate(additive, output_range));
+    ExpectEq(output, expected_mask);
+    EXPECT_EQ(graph.num_computed_nodes(), 6);
+
+    graph.SetWeight(blend, 0, 0.f);
+    ASSERT_TRUE(graph.Evaluate(blend, output_range));
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      const ozz::math::SoaTransform& l = locals[1][i];
+      EXPECT_SOAFLOAT3_EQ_EST(
+        output[i].translation,
+        ozz::math::GetX(l.translation.x), ozz::math::GetY(l.translation.x),
+        ozz::math::GetZ(l.translation.x), ozz::math::GetW(l.translation.x),
+        ozz::math::GetX(l.translation.y), ozz::math::GetY(l.translation.y),
+        ozz::math::GetZ(l.translation.y), ozz::math::GetW(l.translation.y),
+        ozz::math::GetX(l.translation.z), ozz::math::GetY(l.translation.z),
+        ozz::math::GetZ(l.translation.z), ozz::math::GetW(l.translation.z));
+    }
+    EXPECT_EQ(graph.num_computed_nodes(), 2);
+  }
+
+  for (int i = 0; i < kNumAnimations; ++i) {
+    allocator->Delete(caches[i]);
+    allocator->Delete(animations[i]);
+  }
+  allocator->Delete(skeleton);
+}
+
+TEST(Cache, AnimationGraph) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animations[2] = {
+    BuildAnimation(kNumJoints, 1.f),
+    BuildAnimation(kNumJoints, -1.f)};
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  SamplingCache* caches[2];
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(animations[i] != NULL);
+    caches[i] = allocator->New<SamplingCache>(kNumJoints);
+  }
+
+  // The blend node uses the first sample node twice, and blends the result of
+  // another blend.
+  AnimationGraph graph(*skeleton, 4, 5);
+  const int sample0 = graph.AddSampleNode(animations[0], caches[0]);
+  const int sample1 = graph.AddSampleNode(animations[1], caches[1]);
+  AnimationGraph::Input inputs[3];
+  inputs[0].node = sample0;
+  inputs[0].weight = 1.f;
+  inputs[1].node = sample1;
+  inputs[1].weight = 1.f;
+  const int blend = graph.AddBlendNode(
+    ozz::Range<const AnimationGraph::Input>(inputs, 2));
+  inputs[1].node = blend;
+  inputs[2].node = sample0;
+  inputs[2].weight = 1.f;
+  const int root = graph.AddBlendNode(
+    ozz::Range<const AnimationGraph::Input>(inputs, 3));
+  ASSERT_NE(root, AnimationGraph::kInvalidNode);
+
+  ozz::math::SoaTransform expected[kNumSoaJoints];
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  const ozz::Range<ozz::math::SoaTransform> output_range(output,
+                                                         kNumSoaJoints);
+  const ozz::Range<ozz::math::SoaTransform> expected_range(expected,
+                                                           kNumSoaJoints);
+
+  { // Without caching, shared nodes are evaluated by each node that uses them.
+    graph.SetTime(sample0, .2f);
+    ASSERT_TRUE(graph.Evaluate(root, expected_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 6);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 6);
+    ExpectEq(output, expected);
+  }
+
+  graph.SetCached(sample0, true);
+  graph.SetCached(blend, true);
+  graph.SetCached(root, true);
+
+  { // Cached results are reused within an evaluation and across evaluations.
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 4);
+    ExpectEq(output, expected);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 0);
+    ExpectEq(output, expected);
+  }
+
+  { // Modifying a node only recomputes the nodes that depend on it.
+    graph.SetTime(sample1, .5f);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 3);
+    graph.SetTime(sample1, .5f);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 0);
+    graph.SetTime(sample1, 0.f);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 3);
+    ExpectEq(output, expected);
+    graph.Invalidate(sample0);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 4);
+    ExpectEq(output, expected);
+  }
+
+  { // Deactivating and reactivating an input recomputes the node.
+    graph.SetWeight(root, 1, 0.f);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 1);
+    graph.SetTime(sample1, .5f);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 0);
+    graph.SetTime(sample1, 0.f);
+    graph.SetWeight(root, 1, 1.f);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 3);
+    ExpectEq(output, expected);
+  }
+
+  { // Intermediate nodes can be evaluated, and a cached node can be disabled.
+    graph.SetCached(blend, false);
+    ASSERT_TRUE(graph.Evaluate(blend, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 2);
+    ASSERT_TRUE(graph.Evaluate(root, output_range));
+    EXPECT_EQ(graph.num_computed_nodes(), 0);
+    ExpectEq(output, expected);
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    allocator->Delete(caches[i]);
+    allocator->Delete(animations[i]);
+  }
+  allocator->Delete(skeleton);
+}
@@ -0,0 +1,191 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_loader.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationLoader;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+
+namespace {
+Animation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  RawAnimation::TranslationKey t_key0 = {
+    0.f, ozz::math::Float3(93.f, 58.f, 46.f)};
+  raw_animation.tracks[0].translations.push_back(t_key0);
+  RawAnimation::TranslationKey t_key1 = {
+    .9f, ozz::math::Float3(46.f, 58.f, 93.f)};
+  raw_animation.tracks[0].translations.push_back(t_key1);
+
+  RawAnimation::RotationKey r_key = {
+    0.7f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+  raw_animation.tracks[3].rotations.push_back(r_key);
+
+  RawAnimation::ScaleKey s_key = {
+    0.1f, ozz::math::Float3(99.f, 26.f, 14.f)};
+  raw_animation.tracks[4].scales.push_back(s_key);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .25f;
+  builder.key_links = true;
+  return builder(raw_animation);
+}
+
+// Saves _animation to a new blob, whose size is output to _size.
+char* SaveBlob(const Animation& _animation, size_t* _size) {
+  *_size = _animation.blob_size();
+  char* blob = static_cast<char*>(ozz::memory::default_allocator()->Allocate(
+    *_size, Animation::kBlobAlignment));
+  EXPECT_TRUE(_animation.SaveBlob(blob, *_size));
+  return blob;
+}
+}  // namespace
+
+TEST(BlobSize, AnimationLoader) {
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+  size_t size;
+  char* blob = SaveBlob(*animation, &size);
+
+  const size_t header_size = Animation::blob_header_size();
+  EXPECT_GT(header_size, 0u);
+  EXPECT_LT(header_size, size);
+
+  // The header is enough to know the blob size.
+  EXPECT_EQ(Animation::blob_size(blob, header_size), size);
+  EXPECT_EQ(Animation::blob_size(blob, size), size);
+  EXPECT_EQ(Animation::blob_size(NULL, header_size), 0u);
+  EXPECT_EQ(Animation::blob_size(blob, header_size - 1), 0u);
+
+  // Invalid header.
+  blob[0] ^= 0xff;
+  EXPECT_EQ(Animation::blob_size(blob, header_size), 0u);
+
+  ozz::memory::default_allocator()->Deallocate(blob);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Load, AnimationLoader) {
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+  size_t size;
+  char* blob = SaveBlob(*animation, &size);
+
+  { // NULL animation.
+    AnimationLoader loader(NULL);
+    EXPECT_EQ(loader.state(), AnimationLoader::kFailed);
+    EXPECT_TRUE(loader.buffer() == NULL);
+    EXPECT_EQ(loader.size(), 0u);
+    EXPECT_FALSE(loader.Resume());
+  }
+
+  { // Invalid header.
+    Animation loaded;
+    AnimationLoader loader(&loaded);
+    ASSERT_EQ(loader.state(), AnimationLoader::kHeader);
+    std::memcpy(loader.buffer(), blob + loader.offset(), loader.size());
+    static_cast<char*>(loader.buffer())[0] ^= 0xff;
+    EXPECT_FALSE(loader.Resume());
+    EXPECT_EQ(loader.state(), AnimationLoader::kFailed);
+    EXPECT_TRUE(loader.buffer() == NULL);
+    EXPECT_EQ(loaded.num_tracks(), 0);
+  }
+
+  { // Loading is aborted by the loader destruction.
+    Animation loaded;
+    AnimationLoader loader(&loaded);
+    std::memcpy(loader.buffer(), blob + loader.offset(), loader.size());
+    EXPECT_TRUE(loader.Resume());
+    EXPECT_EQ(loader.state(), AnimationLoader::kBody);
+  }
+
+  Animation loaded;
+  {
+    AnimationLoader loader(&loaded);
+    EXPECT_EQ(loader.blob_size(), 0u);
+
+    // Reads the header.
+    ASSERT_EQ(loader.state(), AnimationLoader::kHeader);
+    EXPECT_EQ(loader.offset(), 0u);
+    EXPECT_EQ(loader.size(), Animation::blob_header_size());
+    ASSERT_TRUE(loader.buffer() != NULL);
+    std::memcpy(loader.buffer(), blob + loader.offset(), loader.size());
+    ASSERT_TRUE(loader.Resume());
+
+    // Reads the body, whose range is known from the header.
+    ASSERT_EQ(loader.state(), AnimationLoader::kBody);
+    EXPECT_EQ(loader.blob_size(), size);
+    EXPECT_EQ(loader.offset(), Animation::blob_header_size());
+    EXPECT_EQ(loader.offset() + loader.size(), size);
+    ASSERT_TRUE(loader.buffer() != NULL);
+    std::memcpy(loader.buffer(), blob + loader.offset(), loader.size());
+    ASSERT_TRUE(loader.Resume());
+
+    EXPECT_EQ(loader.state(), AnimationLoader::kLoaded);
+    EXPECT_TRUE(loader.buffer() == NULL);
+    EXPECT_EQ(loader.size(), 0u);
+    EXPECT_FALSE(loader.Resume());
+  }
+
+  // The animation owns its blob, which outlives the loader.
+  EXPECT_TRUE(loaded.mapped());
+  EXPECT_EQ(loaded.num_tracks(), animation->num_tracks());
+  EXPECT_EQ(loaded.duration(), animation->duration());
+  size_t loaded_size;
+  char* loaded_blob = SaveBlob(loaded, &loaded_size);
+  ASSERT_EQ(loaded_size, size);
+  EXPECT_EQ(std::memcmp(loaded_blob, blob, size), 0);
+
+  // Reloading releases the blob.
+  {
+    AnimationLoader loader(&loaded);
+    EXPECT_EQ(loaded.num_tracks(), 0);
+    EXPECT_FALSE(loaded.mapped());
+  }
+
+  ozz::memory::default_allocator()->Deallocate(loaded_blob);
+  ozz::memory::default_allocator()->Deallocate(blob);
+  ozz::memory::default_allocator()->Delete(animation);
+}
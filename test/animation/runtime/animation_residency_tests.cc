@@ -0,0 +1,262 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_residency.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationResidencyManager;
+
+namespace {
+// Implements a loader that builds full quality clips of 8 tracks, and low
+// quality ones of 1 track. Loading is synchronous, unless deferred.
+class TestLoader : public AnimationResidencyManager::Loader {
+ public:
+  TestLoader()
+      : manager(NULL),
+        deferred(false),
+        loads(0),
+        unloads(0) {
+  }
+  virtual void Load(int _clip, bool _low) {
+    ++loads;
+    const Request request = {_clip, _low};
+    if (deferred) {
+      pending.push_back(request);
+    } else {
+      Complete(request, true);
+    }
+  }
+  virtual void Unload(int _clip, Animation* _animation) {
+    (void)_clip;
+    ++unloads;
+    ozz::memory::default_allocator()->Delete(_animation);
+  }
+
+  struct Request {
+    int clip;
+    bool low;
+  };
+
+  // Completes a request, expecting it to be accepted or not.
+  void Complete(const Request& _request, bool _accepted) {
+    Animation* animation = Build(_request.low);
+    const bool accepted =
+      manager->OnLoaded(_request.clip, _request.low, animation);
+    EXPECT_EQ(accepted, _accepted);
+    if (!accepted) {
+      ozz::memory::default_allocator()->Delete(animation);
+    }
+  }
+
+  static Animation* Build(bool _low) {
+    ozz::animation::offline::RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(_low ? 1 : 8);
+    ozz::animation::offline::AnimationBuilder builder;
+    return builder(raw_animation);
+  }
+
+  AnimationResidencyManager* manager;
+  bool deferred;
+  ozz::Vector<Request>::Std pending;
+  int loads;
+  int unloads;
+};
+}  // namespace
+
+TEST(Budget, AnimationResidencyManager) {
+  const size_t high_size = TestLoader::Build(false)->size();
+  TestLoader loader;
+  {
+    // Budget fits 3 full quality clips.
+    AnimationResidencyManager manager(5, high_size * 3, &loader);
+    loader.manager = &manager;
+    EXPECT_EQ(manager.num_clips(), 5);
+    EXPECT_EQ(manager.budget(), high_size * 3);
+    EXPECT_EQ(manager.num_resident_clips(), 0);
+    EXPECT_EQ(manager.resident_size(), 0u);
+    EXPECT_TRUE(manager.animation(0) == NULL);
+
+    // Uses all clips, at increasing times.
+    for (int i = 0; i < 5; ++i) {
+      const Animation* animation = manager.Use(i, static_cast<float>(i));
+      EXPECT_TRUE(animation != NULL);
+      EXPECT_TRUE(animation == manager.animation(i));
+      EXPECT_FALSE(manager.low_quality(i));
+    }
+    EXPECT_EQ(loader.loads, 5);
+    EXPECT_EQ(manager.num_resident_clips(), 5);
+    EXPECT_EQ(manager.resident_size(), high_size * 5);
+
+    // Using a resident clip doesn't load it.
+    EXPECT_TRUE(manager.Use(4, 4.f) != NULL);
+    EXPECT_EQ(loader.loads, 5);
+
+    // The 2 least recently used clips are released.
+    manager.Update(4.f);
+    EXPECT_EQ(loader.unloads, 2);
+    EXPECT_EQ(manager.num_resident_clips(), 3);
+    EXPECT_EQ(manager.resident_size(), high_size * 3);
+    EXPECT_TRUE(manager.animation(0) == NULL);
+    EXPECT_TRUE(manager.animation(1) == NULL);
+    EXPECT_TRUE(manager.animation(2) != NULL);
+
+    // Within budget, nothing happens.
+    manager.Update(5.f);
+    EXPECT_EQ(loader.unloads, 2);
+
+    // Clip 2 is used again, so 3 is the least recently used.
+    manager.Use(2, 5.f);
+    manager.Use(0, 5.f);
+    EXPECT_EQ(loader.loads, 6);
+    manager.Update(5.f);
+    EXPECT_EQ(loader.unloads, 3);
+    EXPECT_TRUE(manager.animation(3) == NULL);
+    EXPECT_TRUE(manager.animation(0) != NULL);
+    EXPECT_TRUE(manager.animation(2) != NULL);
+    EXPECT_TRUE(manager.animation(4) != NULL);
+
+    // Clips used at update time are never released, even over budget.
+    manager.set_budget(0);
+    manager.Use(1, 6.f);
+    manager.Use(2, 6.f);
+    manager.Update(6.f);
+    EXPECT_EQ(manager.num_resident_clips(), 2);
+    EXPECT_EQ(manager.resident_size(), high_size * 2);
+    EXPECT_TRUE(manager.animation(1) != NULL);
+    EXPECT_TRUE(manager.animation(2) != NULL);
+  }
+  // Destruction releases remaining clips.
+  EXPECT_EQ(loader.loads, loader.unloads);
+}
+
+TEST(Downgrade, AnimationResidencyManager) {
+  const size_t high_size = TestLoader::Build(false)->size();
+  const size_t low_size = TestLoader::Build(true)->size();
+  ASSERT_LT(low_size, high_size);
+
+  TestLoader loader;
+  {
+    AnimationResidencyManager manager(3, high_size * 2 + low_size, &loader);
+    loader.manager = &manager;
+    manager.set_low_variant(0, true);
+    manager.set_low_variant(1, true);
+
+    manager.Use(0, 0.f);
+    manager.Use(1, 1.f);
+    manager.Use(2, 2.f);
+    EXPECT_EQ(manager.resident_size(), high_size * 3);
+
+    // Clip 0 is downgraded rather than released.
+    manager.Update(2.f);
+    EXPECT_EQ(loader.loads, 4);
+    EXPECT_EQ(loader.unloads, 1);
+    EXPECT_EQ(manager.num_resident_clips(), 3);
+    EXPECT_TRUE(manager.low_quality(0));
+    EXPECT_FALSE(manager.low_quality(1));
+    EXPECT_EQ(manager.resident_size(), high_size * 2 + low_size);
+
+    // A downgraded clip is released if the budget is still exceeded.
+    manager.set_budget(high_size * 2);
+    manager.Use(1, 3.f);
+    manager.Use(2, 3.f);
+    manager.Update(3.f);
+    EXPECT_TRUE(manager.animation(0) == NULL);
+    EXPECT_EQ(manager.num_resident_clips(), 2);
+
+    // Using a downgraded clip upgrades it.
+    manager.set_budget(high_size * 3);
+    manager.Use(1, 4.f);
+    manager.Use(2, 4.f);
+    manager.Update(4.f);
+    manager.Use(0, 5.f);
+    EXPECT_FALSE(manager.low_quality(0));
+  }
+  EXPECT_EQ(loader.loads, loader.unloads);
+}
+
+TEST(Asynchronous, AnimationResidencyManager) {
+  const size_t high_size = TestLoader::Build(false)->size();
+  TestLoader loader;
+  loader.deferred = true;
+  {
+    AnimationResidencyManager manager(2, high_size, &loader);
+    loader.manager = &manager;
+    manager.set_low_variant(0, true);
+
+    // Nothing is resident until loading completes, and requests aren't
+    // duplicated.
+    EXPECT_TRUE(manager.Use(0, 0.f) == NULL);
+    EXPECT_TRUE(manager.Use(0, 0.f) == NULL);
+    manager.Prefetch(1, 0.f);
+    ASSERT_EQ(loader.pending.size(), 2u);
+    loader.Complete(loader.pending[0], true);
+    loader.Complete(loader.pending[1], true);
+    loader.pending.clear();
+    EXPECT_TRUE(manager.Use(0, 1.f) != NULL);
+    EXPECT_TRUE(manager.animation(1) != NULL);
+
+    // Unexpected notifications are rejected.
+    const TestLoader::Request unexpected = {1, false};
+    loader.Complete(unexpected, false);
+    const TestLoader::Request invalid = {2, false};
+    loader.Complete(invalid, false);
+    EXPECT_FALSE(manager.OnLoaded(0, false, NULL));
+
+    // Clip 1 is released, clip 0 is downgraded and keeps no animation until
+    // its low quality variant is loaded.
+    manager.set_budget(0);
+    manager.Update(2.f);
+    EXPECT_EQ(manager.num_resident_clips(), 0);
+    ASSERT_EQ(loader.pending.size(), 1u);
+    EXPECT_TRUE(loader.pending[0].low);
+
+    // Using clip 0 again requests the full quality variant, and cancels the
+    // downgrade.
+    EXPECT_TRUE(manager.Use(0, 3.f) == NULL);
+    ASSERT_EQ(loader.pending.size(), 2u);
+    loader.Complete(loader.pending[0], false);
+    loader.Complete(loader.pending[1], true);
+    loader.pending.clear();
+    EXPECT_FALSE(manager.low_quality(0));
+    EXPECT_TRUE(manager.animation(0) != NULL);
+  }
+  // The cancelled downgrade was rejected, hence never unloaded.
+  EXPECT_EQ(loader.loads, loader.unloads + 1);
+}
@@ -0,0 +1,190 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_scheduler.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::animation::AnimationScheduler;
+
+TEST(Interval, AnimationScheduler) {
+  AnimationScheduler scheduler(7, 0, 8, 1.f);
+  EXPECT_EQ(scheduler.capacity(), 7);
+  EXPECT_EQ(scheduler.budget(), 0);
+  EXPECT_EQ(scheduler.max_interval(), 8);
+  EXPECT_FLOAT_EQ(scheduler.full_rate_size(), 1.f);
+
+  // Characters are initially considered off screen.
+  for (int i = 0; i < scheduler.capacity(); ++i) {
+    EXPECT_EQ(scheduler.interval(i), 8);
+    EXPECT_EQ(scheduler.age(i), AnimationScheduler::kMaxAge);
+    EXPECT_FLOAT_EQ(scheduler.ratio(i), 1.f);
+  }
+
+  const float sizes[] = {2.f, 1.f, .5f, .3f, .01f, 0.f, -1.f};
+  const int intervals[] = {1, 1, 2, 4, 8, 8, 8};
+  for (int i = 0; i < scheduler.capacity(); ++i) {
+    scheduler.SetScreenSize(i, sizes[i]);
+    EXPECT_EQ(scheduler.interval(i), intervals[i]);
+  }
+}
+
+TEST(Schedule, AnimationScheduler) {
+  AnimationScheduler scheduler(3, 0, 8, 1.f);
+  scheduler.SetScreenSize(0, 1.f);
+  scheduler.SetScreenSize(1, .5f);
+  scheduler.SetScreenSize(2, .25f);
+
+  int updates[3];
+  const ozz::Range<int> output(updates);
+  int counts[3] = {0, 0, 0};
+
+  // All characters are updated the first frame.
+  ASSERT_EQ(scheduler.Schedule(output), 3);
+  EXPECT_EQ(updates[0], 0);
+  EXPECT_EQ(updates[1], 1);
+  EXPECT_EQ(updates[2], 2);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(scheduler.age(i), 0);
+    EXPECT_FLOAT_EQ(scheduler.ratio(i), 0.f);
+  }
+
+  // Then at their own rate.
+  for (int f = 0; f < 8; ++f) {
+    const int num_updates = scheduler.Schedule(output);
+    for (int i = 0; i < num_updates; ++i) {
+      ++counts[updates[i]];
+    }
+    if (f == 0) {
+      EXPECT_EQ(num_updates, 1);
+      EXPECT_EQ(scheduler.age(1), 1);
+      EXPECT_FLOAT_EQ(scheduler.ratio(1), .5f);
+      EXPECT_EQ(scheduler.age(2), 1);
+      EXPECT_FLOAT_EQ(scheduler.ratio(2), .25f);
+    }
+  }
+  EXPECT_EQ(counts[0], 8);
+  EXPECT_EQ(counts[1], 4);
+  EXPECT_EQ(counts[2], 2);
+
+  // Invalidated character is updated next frame.
+  scheduler.SetScreenSize(2, 0.f);
+  scheduler.Invalidate(2);
+  EXPECT_EQ(scheduler.age(2), AnimationScheduler::kMaxAge);
+  ASSERT_EQ(scheduler.Schedule(output), 2);
+  EXPECT_EQ(updates[0], 2);
+  EXPECT_EQ(updates[1], 0);
+}
+
+TEST(Budget, AnimationScheduler) {
+  AnimationScheduler scheduler(10, 3, 8, 1.f);
+  for (int i = 0; i < scheduler.capacity(); ++i) {
+    scheduler.SetScreenSize(i, 1.f);
+  }
+
+  // Initial updates are spread over frames.
+  int updates[10];
+  const ozz::Range<int> output(updates);
+  ASSERT_EQ(scheduler.Schedule(output), 3);
+  EXPECT_EQ(updates[0], 0);
+  EXPECT_EQ(updates[1], 1);
+  EXPECT_EQ(updates[2], 2);
+  ASSERT_EQ(scheduler.Schedule(output), 3);
+  EXPECT_EQ(updates[0], 3);
+  EXPECT_EQ(updates[1], 4);
+  EXPECT_EQ(updates[2], 5);
+  ASSERT_EQ(scheduler.Schedule(output), 3);
+  EXPECT_EQ(updates[0], 6);
+  EXPECT_EQ(updates[1], 7);
+  EXPECT_EQ(updates[2], 8);
+
+  // The most overdue characters first.
+  ASSERT_EQ(scheduler.Schedule(output), 3);
+  EXPECT_EQ(updates[0], 9);
+  EXPECT_EQ(updates[1], 0);
+  EXPECT_EQ(updates[2], 1);
+  EXPECT_EQ(scheduler.age(2), 3);
+
+  // Output range limits the number of updates too.
+  ASSERT_EQ(scheduler.Schedule(ozz::Range<int>(updates, 2)), 2);
+  EXPECT_EQ(updates[0], 2);
+  EXPECT_EQ(updates[1], 3);
+  EXPECT_EQ(scheduler.Schedule(ozz::Range<int>(updates, updates)), 0);
+
+  // Longer intervals are less overdue for the same age.
+  AnimationScheduler mixed(2, 1, 8, 1.f);
+  mixed.SetScreenSize(0, .5f);
+  mixed.SetScreenSize(1, 1.f);
+  ASSERT_EQ(mixed.Schedule(output), 1);
+  EXPECT_EQ(updates[0], 1);
+  ASSERT_EQ(mixed.Schedule(output), 1);
+  EXPECT_EQ(updates[0], 0);
+  ASSERT_EQ(mixed.Schedule(output), 1);
+  EXPECT_EQ(updates[0], 1);
+  ASSERT_EQ(mixed.Schedule(output), 1);
+  EXPECT_EQ(updates[0], 1);
+}
+
+TEST(Interpolate, AnimationScheduler) {
+  const ozz::math::Float4x4 from[2] = {
+    ozz::math::Float4x4::identity(),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(2.f, 0.f, 0.f, 0.f))};
+  const ozz::math::Float4x4 to[2] = {
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(0.f, 4.f, 0.f, 0.f)),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(2.f, 0.f, 8.f, 0.f))};
+  ozz::math::Float4x4 output[3];
+  typedef ozz::Range<const ozz::math::Float4x4> ConstRange;
+
+  // Invalid sizes.
+  EXPECT_FALSE(AnimationScheduler::Interpolate(
+    ConstRange(from, 1), ConstRange(to), .5f,
+    ozz::Range<ozz::math::Float4x4>(output)));
+  EXPECT_FALSE(AnimationScheduler::Interpolate(
+    ConstRange(from), ConstRange(to), .5f,
+    ozz::Range<ozz::math::Float4x4>(output, 1)));
+
+  ASSERT_TRUE(AnimationScheduler::Interpolate(
+    ConstRange(from), ConstRange(to), .25f,
+    ozz::Range<ozz::math::Float4x4>(output)));
+  EXPECT_FLOAT4x4_EQ(output[0], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                0.f, 1.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[1], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                2.f, 0.f, 2.f, 1.f);
+}
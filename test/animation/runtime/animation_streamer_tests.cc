@@ -0,0 +1,270 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_streamer.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_page_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationStreamer;
+
+namespace {
+// Implements a loader that records requests, and completes them on demand.
+class TestLoader : public AnimationStreamer::Loader {
+ public:
+  TestLoader()
+      : loads(0),
+        unloads(0) {
+  }
+  virtual void Load(int _page) {
+    ++loads;
+    pending.push_back(_page);
+  }
+  virtual void Unload(int _page, Animation* _animation) {
+    (void)_page;
+    ++unloads;
+    ozz::memory::default_allocator()->Delete(_animation);
+  }
+  // Completes all pending requests.
+  void Complete(AnimationStreamer* _streamer) {
+    for (size_t i = 0; i < pending.size(); ++i) {
+      Animation* animation =
+        ozz::memory::default_allocator()->New<Animation>();
+      EXPECT_TRUE(_streamer->OnLoaded(pending[i], animation));
+    }
+    pending.clear();
+  }
+  ozz::Vector<int>::Std pending;
+  int loads;
+  int unloads;
+};
+
+// Implements a loader that synchronously builds pages from an animation.
+class PageLoader : public AnimationStreamer::Loader {
+ public:
+  PageLoader(const Animation& _animation)
+      : streamer(NULL),
+        animation_(_animation) {
+  }
+  virtual void Load(int _page) {
+    ozz::animation::offline::AnimationPageBuilder builder;
+    Animation* page = builder(animation_,
+                              streamer->page_begin(_page),
+                              streamer->page_end(_page));
+    ASSERT_TRUE(page != NULL);
+    EXPECT_TRUE(streamer->OnLoaded(_page, page));
+  }
+  virtual void Unload(int _page, Animation* _animation) {
+    (void)_page;
+    ozz::memory::default_allocator()->Delete(_animation);
+  }
+  AnimationStreamer* streamer;
+ private:
+  const Animation& animation_;
+};
+}  // namespace
+
+TEST(Pages, AnimationStreamer) {
+  TestLoader loader;
+  {
+    AnimationStreamer streamer(10.f, 3.f, &loader);
+    EXPECT_EQ(streamer.num_pages(), 4);
+    EXPECT_EQ(streamer.page(-1.f), 0);
+    EXPECT_EQ(streamer.page(0.f), 0);
+    EXPECT_EQ(streamer.page(2.9f), 0);
+    EXPECT_EQ(streamer.page(3.f), 1);
+    EXPECT_EQ(streamer.page(9.5f), 3);
+    EXPECT_EQ(streamer.page(10.f), 3);
+    EXPECT_EQ(streamer.page(46.f), 3);
+    EXPECT_FLOAT_EQ(streamer.page_begin(0), 0.f);
+    EXPECT_FLOAT_EQ(streamer.page_end(0), 3.f);
+    EXPECT_FLOAT_EQ(streamer.page_begin(3), 9.f);
+    EXPECT_FLOAT_EQ(streamer.page_end(3), 10.f);
+  }
+  {
+    AnimationStreamer streamer(9.f, 3.f, &loader);
+    EXPECT_EQ(streamer.num_pages(), 3);
+    EXPECT_EQ(streamer.page(9.f), 2);
+    EXPECT_FLOAT_EQ(streamer.page_end(2), 9.f);
+  }
+  {
+    AnimationStreamer streamer(0.f, 3.f, &loader);
+    EXPECT_EQ(streamer.num_pages(), 1);
+    EXPECT_EQ(streamer.page(1.f), 0);
+  }
+  EXPECT_EQ(loader.loads, 0);
+}
+
+TEST(Residency, AnimationStreamer) {
+  TestLoader loader;
+  {
+    AnimationStreamer streamer(10.f, 1.f, &loader);
+    EXPECT_EQ(streamer.num_resident_pages(), 0);
+    EXPECT_TRUE(streamer.animation(0.f) == NULL);
+
+    // Requests current page and the one ahead.
+    streamer.Update(0.f);
+    EXPECT_EQ(loader.loads, 2);
+    ASSERT_EQ(loader.pending.size(), 2u);
+    EXPECT_EQ(loader.pending[0], 0);
+    EXPECT_EQ(loader.pending[1], 1);
+    EXPECT_TRUE(streamer.animation(0.f) == NULL);
+
+    // Pending pages aren't requested again.
+    streamer.Update(.5f);
+    EXPECT_EQ(loader.loads, 2);
+
+    // Completes loading.
+    loader.Complete(&streamer);
+    EXPECT_EQ(streamer.num_resident_pages(), 2);
+    EXPECT_TRUE(streamer.animation(0.f) != NULL);
+    EXPECT_TRUE(streamer.animation(1.5f) != NULL);
+    EXPECT_TRUE(streamer.animation(2.5f) == NULL);
+
+    // Unrequested pages are rejected.
+    Animation unrequested;
+    EXPECT_FALSE(streamer.OnLoaded(5, &unrequested));
+    EXPECT_FALSE(streamer.OnLoaded(0, &unrequested));
+    EXPECT_FALSE(streamer.OnLoaded(-1, &unrequested));
+    EXPECT_FALSE(streamer.OnLoaded(46, &unrequested));
+
+    // Moves forward, page 0 is evicted.
+    streamer.Update(1.2f);
+    EXPECT_EQ(loader.unloads, 1);
+    EXPECT_EQ(loader.loads, 3);
+    loader.Complete(&streamer);
+    EXPECT_EQ(streamer.num_resident_pages(), 2);
+    EXPECT_TRUE(streamer.animation(0.f) == NULL);
+
+    // Keeps more pages.
+    streamer.set_pages_ahead(2);
+    streamer.set_pages_behind(1);
+    streamer.Update(1.2f);
+    EXPECT_EQ(loader.loads, 5);
+    ASSERT_EQ(loader.pending.size(), 2u);
+    EXPECT_EQ(loader.pending[0], 3);  // Ahead pages first.
+    EXPECT_EQ(loader.pending[1], 0);
+    loader.Complete(&streamer);
+    EXPECT_EQ(streamer.num_resident_pages(), 4);
+
+    // Jumps to the end.
+    streamer.Update(10.f);
+    EXPECT_EQ(loader.unloads, 5);
+    EXPECT_EQ(loader.loads, 7);
+    // Page 9 and 8 requested.
+    loader.Complete(&streamer);
+    EXPECT_EQ(streamer.num_resident_pages(), 2);
+
+    // A page loaded after leaving the resident window is evicted at next
+    // update.
+    streamer.Update(0.f);
+    EXPECT_EQ(loader.unloads, 7);
+    streamer.Update(5.f);
+    loader.Complete(&streamer);
+    EXPECT_EQ(streamer.num_resident_pages(), 7);
+    EXPECT_TRUE(streamer.animation(0.f) != NULL);
+    streamer.Update(5.f);
+    EXPECT_EQ(streamer.num_resident_pages(), 4);
+    EXPECT_TRUE(streamer.animation(0.f) == NULL);
+    EXPECT_EQ(loader.unloads, 10);
+  }
+  // Remaining resident pages are released.
+  EXPECT_EQ(loader.loads, loader.unloads);
+}
+
+TEST(Sampling, AnimationStreamer) {
+  // Builds an animation with one key every 10ms.
+  ozz::animation::offline::RawAnimation raw_animation;
+  raw_animation.duration = 6.f;
+  raw_animation.tracks.resize(1);
+  for (int k = 0; k <= 600; ++k) {
+    const float time = k * .01f;
+    const ozz::animation::offline::RawAnimation::TranslationKey key = {
+      time, ozz::math::Float3(time, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  ozz::animation::offline::AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  PageLoader loader(*animation);
+  AnimationStreamer streamer(animation->duration(), .5f, &loader);
+  loader.streamer = &streamer;
+
+  ozz::animation::SamplingCache reference_cache(1);
+  ozz::animation::SamplingCache cache(1);
+  int current_page = -1;
+  for (float time = 0.f; time <= animation->duration(); time += 1.f / 60.f) {
+    streamer.Update(time);
+    const Animation* page = streamer.animation(time);
+    ASSERT_TRUE(page != NULL);
+
+    // Cache must be invalidated when sampled page changes.
+    if (streamer.page(time) != current_page) {
+      current_page = streamer.page(time);
+      cache.Invalidate();
+    }
+
+    // Resident pages use less memory than the whole animation.
+    EXPECT_LE(streamer.num_resident_pages(), 2);
+    EXPECT_LT(page->size() * 2, animation->size());
+
+    ozz::math::SoaTransform reference;
+    ozz::animation::SamplingJob job;
+    job.animation = animation;
+    job.cache = &reference_cache;
+    job.time = time;
+    job.output.begin = &reference;
+    job.output.end = &reference + 1;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform paged;
+    job.animation = page;
+    job.cache = &cache;
+    job.output.begin = &paged;
+    job.output.end = &paged + 1;
+    ASSERT_TRUE(job.Run());
+
+    EXPECT_EQ(std::memcmp(&reference, &paged, sizeof(paged)), 0);
+  }
+  ozz::memory::default_allocator()->Delete(animation);
+}
@@ -30,6 +30,9 @@
 
 #include "ozz/animation/runtime/blending_job.h"
 
+#include <cstring>
+#include <limits>
+
 #include "gtest/gtest.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
@@ -502,6 +505,79 @@ TEST(JointWeights, BlendingJob) {
   }
 }
 
+TEST(ZeroJointWeights, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // The second soa joint of the partial layer has all its weights set to 0,
+  // so its transform, which could have been masked out from sampling, must
+  // not be read.
+  const ozz::math::SimdFloat4 nan = ozz::math::simd_float4::Load1(
+    std::numeric_limits<float>::quiet_NaN());
+  ozz::math::SoaTransform input_transforms[2][2] = {
+    {identity, identity},
+    {identity, identity}};
+  input_transforms[0][0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+    ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f));
+  input_transforms[0][1].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(12.f, 13.f, 14.f, 15.f),
+    ozz::math::simd_float4::Load(16.f, 17.f, 18.f, 19.f),
+    ozz::math::simd_float4::Load(20.f, 21.f, 22.f, 23.f));
+  input_transforms[1][0].translation = -input_transforms[0][0].translation;
+  input_transforms[1][1].translation =
+    ozz::math::SoaFloat3::Load(nan, nan, nan);
+  input_transforms[1][1].rotation =
+    ozz::math::SoaQuaternion::Load(nan, nan, nan, nan);
+  input_transforms[1][1].scale = ozz::math::SoaFloat3::Load(nan, nan, nan);
+  const ozz::math::SimdFloat4 joint_weights[2] = {
+    ozz::math::simd_float4::one(), ozz::math::simd_float4::zero()};
+  const ozz::math::SoaTransform bind_poses[2] = {identity, identity};
+
+  // Tests with the partial layer blended first and last.
+  for (int i = 0; i < 2; ++i) {
+    BlendingJob::Layer layers[2];
+    BlendingJob::Layer& full = layers[i];
+    full.weight = 1.f;
+    full.transform.begin = input_transforms[0];
+    full.transform.end = input_transforms[0] + 2;
+    BlendingJob::Layer& partial = layers[1 - i];
+    partial.weight = 1.f;
+    partial.transform.begin = input_transforms[1];
+    partial.transform.end = input_transforms[1] + 2;
+    partial.joint_weights.begin = joint_weights;
+    partial.joint_weights.end = joint_weights + 2;
+
+    BlendingJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    ozz::math::SoaTransform output_transforms[2];
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation,
+                        12.f, 13.f, 14.f, 15.f,
+                        16.f, 17.f, 18.f, 19.f,
+                        20.f, 21.f, 22.f, 23.f);
+    EXPECT_SOAQUATERNION_EQ(output_transforms[1].rotation,
+                            0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f,
+                            1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].scale,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f);
+  }
+}
+
 TEST(Normalize, BlendingJob) {
   const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
 
@@ -754,3 +830,726 @@ TEST(Threshold, BlendingJob) {
                         8.f, 9.f, 10.f, 11.f);
   }
 }
+
+TEST(Unscaled, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Initialize inputs, with scales that are ignored by the unscaled job.
+  ozz::math::SoaTransform input_transforms[2][1] = {{identity}, {identity}};
+  input_transforms[0][0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(2.f, 3.f, 4.f, 5.f),
+    ozz::math::simd_float4::Load(6.f, 7.f, 8.f, 9.f),
+    ozz::math::simd_float4::Load(10.f, 11.f, 12.f, 13.f));
+  input_transforms[0][0].scale = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+    ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f));
+  input_transforms[1][0].scale = input_transforms[0][0].scale;
+
+  ozz::math::SoaTransform bind_poses[1] = {identity};
+
+  BlendingJob::Layer layers[1];
+  layers[0].weight = .5f;
+  layers[0].transform.begin = input_transforms[0];
+  layers[0].transform.end = input_transforms[0] + 1;
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].weight = 1.f;
+  additive_layers[0].transform.begin = input_transforms[1];
+  additive_layers[0].transform.end = input_transforms[1] + 1;
+
+  BlendingJob job;
+  job.scaled = false;
+  job.layers.begin = layers;
+  job.layers.end = layers + 1;
+  job.additive_layers.begin = additive_layers;
+  job.additive_layers.end = additive_layers + 1;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 1;
+  ozz::math::SoaTransform output_transforms[1];
+  job.output.begin = output_transforms;
+  job.output.end = output_transforms + 1;
+
+  EXPECT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation,
+                      2.f, 3.f, 4.f, 5.f,
+                      6.f, 7.f, 8.f, 9.f,
+                      10.f, 11.f, 12.f, 13.f);
+  EXPECT_SOAFLOAT3_EQ(output_transforms[0].scale,
+                      1.f, 1.f, 1.f, 1.f,
+                      1.f, 1.f, 1.f, 1.f,
+                      1.f, 1.f, 1.f, 1.f);
+}
+
+TEST(AdditiveJobValidity, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+  ozz::math::SoaTransform bind_poses[2] = {identity, identity};
+  ozz::math::SoaTransform input_transforms[2] = {identity, identity};
+  ozz::math::SoaTransform output_transforms[2] = {identity, identity};
+  ozz::math::SimdFloat4 joint_weights[2] = {one, one};
+
+  BlendingJob::Layer layers[1];
+  layers[0].transform.begin = input_transforms;
+  layers[0].transform.end = input_transforms + 2;
+
+  BlendingJob job;
+  job.layers.begin = layers;
+  job.layers.end = layers + 1;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 2;
+  job.output.begin = output_transforms;
+  job.output.end = output_transforms + 2;
+  EXPECT_TRUE(job.Validate());
+
+  { // Invalid additive layers range.
+    BlendingJob::Layer additive_layers[1];
+    additive_layers[0].transform.begin = input_transforms;
+    additive_layers[0].transform.end = input_transforms + 2;
+    job.additive_layers.begin = additive_layers + 1;
+    job.additive_layers.end = additive_layers;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+
+    job.additive_layers.begin = NULL;
+    job.additive_layers.end = additive_layers + 1;
+    EXPECT_FALSE(job.Validate());
+
+    // Empty additive layers range.
+    job.additive_layers.begin = additive_layers;
+    job.additive_layers.end = additive_layers;
+    EXPECT_TRUE(job.Validate());
+
+    job.additive_layers.end = additive_layers + 1;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  { // Invalid additive layer transforms and joint weights.
+    BlendingJob::Layer additive_layers[1];
+    additive_layers[0].transform.begin = input_transforms;
+    additive_layers[0].transform.end = input_transforms + 1;
+    job.additive_layers.begin = additive_layers;
+    job.additive_layers.end = additive_layers + 1;
+    EXPECT_FALSE(job.Validate());
+
+    additive_layers[0].transform.end = input_transforms + 2;
+    additive_layers[0].joint_weights.begin = joint_weights;
+    additive_layers[0].joint_weights.end = joint_weights + 1;
+    EXPECT_FALSE(job.Validate());
+
+    additive_layers[0].joint_weights.end = joint_weights + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Additive, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+
+  // The normal layer.
+  ozz::math::SoaTransform input_transforms[2] = {identity, identity};
+  input_transforms[0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+    ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f));
+  input_transforms[1].translation = input_transforms[0].translation;
+
+  // The additive layer, whose first soa joint rotates 90 degrees around z
+  // (with an opposed quaternion in lane 0), translates by 2 along x and doubles
+  // the scale, but lane 3 has a 0 joint weight. Its second soa joint is masked
+  // out by joint weights, so it mustn't be read.
+  const ozz::math::SimdFloat4 nan = ozz::math::simd_float4::Load1(
+    std::numeric_limits<float>::quiet_NaN());
+  ozz::math::SoaTransform additive_transforms[2] = {identity, identity};
+  additive_transforms[0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load1(2.f), zero, zero);
+  additive_transforms[0].rotation = ozz::math::SoaQuaternion::Load(
+    zero, zero,
+    ozz::math::simd_float4::Load(-.70710677f, 0.f, 0.f, .70710677f),
+    ozz::math::simd_float4::Load(-.70710677f, 1.f, 1.f, .70710677f));
+  additive_transforms[0].scale = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load1(2.f), ozz::math::simd_float4::Load1(2.f),
+    ozz::math::simd_float4::Load1(2.f));
+  additive_transforms[1].translation =
+    ozz::math::SoaFloat3::Load(nan, nan, nan);
+  additive_transforms[1].rotation =
+    ozz::math::SoaQuaternion::Load(nan, nan, nan, nan);
+  additive_transforms[1].scale = ozz::math::SoaFloat3::Load(nan, nan, nan);
+  const ozz::math::SimdFloat4 joint_weights[2] = {
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 0.f), zero};
+
+  const ozz::math::SoaTransform bind_poses[2] = {identity, identity};
+
+  BlendingJob::Layer layers[1];
+  layers[0].weight = 1.f;
+  layers[0].transform.begin = input_transforms;
+  layers[0].transform.end = input_transforms + 2;
+
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].weight = 1.f;
+  additive_layers[0].transform.begin = additive_transforms;
+  additive_layers[0].transform.end = additive_transforms + 2;
+  additive_layers[0].joint_weights.begin = joint_weights;
+  additive_layers[0].joint_weights.end = joint_weights + 2;
+
+  BlendingJob job;
+  job.layers.begin = layers;
+  job.layers.end = layers + 1;
+  job.additive_layers.begin = additive_layers;
+  job.additive_layers.end = additive_layers + 1;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 2;
+  ozz::math::SoaTransform output_transforms[2];
+  job.output.begin = output_transforms;
+  job.output.end = output_transforms + 2;
+
+  { // A 0 weight additive layer has no effect.
+    additive_layers[0].weight = 0.f;
+    EXPECT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation,
+                        0.f, 1.f, 2.f, 3.f,
+                        4.f, 5.f, 6.f, 7.f,
+                        8.f, 9.f, 10.f, 11.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output_transforms[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].scale,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f);
+  }
+
+  { // Full additive layer weight.
+    additive_layers[0].weight = 1.f;
+    EXPECT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation,
+                        2.f, 3.f, 4.f, 3.f,
+                        4.f, 5.f, 6.f, 7.f,
+                        8.f, 9.f, 10.f, 11.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output_transforms[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                .7071068f, 0.f, 0.f, 0.f,
+                                .7071068f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].scale,
+                        2.f, 2.f, 2.f, 1.f,
+                        2.f, 2.f, 2.f, 1.f,
+                        2.f, 2.f, 2.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation,
+                        0.f, 1.f, 2.f, 3.f,
+                        4.f, 5.f, 6.f, 7.f,
+                        8.f, 9.f, 10.f, 11.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].scale,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f);
+  }
+
+  { // Half additive layer weight.
+    additive_layers[0].weight = .5f;
+    EXPECT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation,
+                        1.f, 2.f, 3.f, 3.f,
+                        4.f, 5.f, 6.f, 7.f,
+                        8.f, 9.f, 10.f, 11.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output_transforms[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                .3826834f, 0.f, 0.f, 0.f,
+                                .9238795f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].scale,
+                        1.5f, 1.5f, 1.5f, 1.f,
+                        1.5f, 1.5f, 1.5f, 1.f,
+                        1.5f, 1.5f, 1.5f, 1.f);
+  }
+
+  { // Fast normalization estimates the same rotations.
+    job.fast_normalization = true;
+    EXPECT_TRUE(job.Run());
+    job.fast_normalization = false;
+    EXPECT_SOAQUATERNION_EQ_EST(output_transforms[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                .3826834f, 0.f, 0.f, 0.f,
+                                .9238795f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].scale,
+                        1.5f, 1.5f, 1.5f, 1.f,
+                        1.5f, 1.5f, 1.5f, 1.f,
+                        1.5f, 1.5f, 1.5f, 1.f);
+  }
+
+  { // Additive layers are applied to bind pose fallback too.
+    layers[0].weight = 0.f;
+    additive_layers[0].weight = 1.f;
+    EXPECT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation,
+                        2.f, 2.f, 2.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+  }
+}
+
+TEST(SoaRangesValidity, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::math::SoaTransform bind_poses[3] = {identity, identity, identity};
+  ozz::math::SoaTransform input_transforms[3] = {identity, identity, identity};
+  ozz::math::SoaTransform output_transforms[3];
+
+  BlendingJob::Layer layers[1];
+  layers[0].weight = 1.f;
+  layers[0].transform.begin = input_transforms;
+  layers[0].transform.end = input_transforms + 3;
+
+  BlendingJob job;
+  job.layers.begin = layers;
+  job.layers.end = layers + 1;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 3;
+  job.output.begin = output_transforms;
+  job.output.end = output_transforms + 3;
+
+  const BlendingJob::SoaRange ranges[] = {{0, 1}, {1, 3}, {2, 3}, {2, 4}};
+
+  // Valid ranges, including empty ones.
+  layers[0].soa_ranges.begin = ranges;
+  layers[0].soa_ranges.end = ranges + 2;
+  EXPECT_TRUE(job.Validate());
+  layers[0].soa_ranges.end = ranges;
+  EXPECT_TRUE(job.Validate());
+
+  // Invalid range.
+  layers[0].soa_ranges.end = ranges + 2;
+  layers[0].soa_ranges.begin = NULL;
+  EXPECT_FALSE(job.Validate());
+  layers[0].soa_ranges.begin = ranges + 1;
+  layers[0].soa_ranges.end = ranges;
+  EXPECT_FALSE(job.Validate());
+
+  // Overlapping ranges.
+  layers[0].soa_ranges.begin = ranges + 1;
+  layers[0].soa_ranges.end = ranges + 3;
+  EXPECT_FALSE(job.Validate());
+
+  // Bigger than the bind pose.
+  layers[0].soa_ranges.begin = ranges + 3;
+  layers[0].soa_ranges.end = ranges + 4;
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  // Unsorted and negative ranges.
+  const BlendingJob::SoaRange invalid_ranges[] = {{1, 2}, {0, 1}, {-1, 0}};
+  layers[0].soa_ranges.begin = invalid_ranges;
+  layers[0].soa_ranges.end = invalid_ranges + 2;
+  EXPECT_FALSE(job.Validate());
+  layers[0].soa_ranges.begin = invalid_ranges + 2;
+  layers[0].soa_ranges.end = invalid_ranges + 3;
+  EXPECT_FALSE(job.Validate());
+
+  // Additive layers don't support soa ranges.
+  layers[0].soa_ranges.begin = ranges;
+  layers[0].soa_ranges.end = ranges + 1;
+  EXPECT_TRUE(job.Validate());
+  job.additive_layers.begin = layers;
+  job.additive_layers.end = layers + 1;
+  EXPECT_FALSE(job.Validate());
+}
+
+TEST(SoaRanges, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Soa joints outside of the ranges of the ranged layer are set to NaN, as
+  // they mustn't be read.
+  const ozz::math::SimdFloat4 nan = ozz::math::simd_float4::Load1(
+    std::numeric_limits<float>::quiet_NaN());
+  ozz::math::SoaTransform nan_transform;
+  nan_transform.translation = ozz::math::SoaFloat3::Load(nan, nan, nan);
+  nan_transform.rotation = ozz::math::SoaQuaternion::Load(nan, nan, nan, nan);
+  nan_transform.scale = ozz::math::SoaFloat3::Load(nan, nan, nan);
+
+  const ozz::math::SoaFloat3 translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+    ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f));
+  ozz::math::SoaTransform input_transforms[2][4] = {
+    {identity, identity, identity, identity},
+    {nan_transform, identity, nan_transform, identity}};
+  for (int i = 0; i < 4; ++i) {
+    input_transforms[0][i].translation = translation;
+  }
+  input_transforms[1][1].translation = -translation;
+  input_transforms[1][3].translation = -translation;
+
+  const ozz::math::SoaTransform bind_poses[4] = {
+    identity, identity, identity, identity};
+  const BlendingJob::SoaRange ranges[] = {{1, 2}, {3, 4}};
+
+  BlendingJob::Layer ranged;
+  ranged.weight = 1.f;
+  ranged.transform.begin = input_transforms[1];
+  ranged.transform.end = input_transforms[1] + 4;
+  ranged.soa_ranges.begin = ranges;
+  ranged.soa_ranges.end = ranges + 2;
+
+  BlendingJob job;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 4;
+  ozz::math::SoaTransform output_transforms[4];
+  job.output.begin = output_transforms;
+  job.output.end = output_transforms + 4;
+
+  { // Ranged layer only, other joints fall back to the bind pose.
+    job.layers.begin = &ranged;
+    job.layers.end = &ranged + 1;
+    EXPECT_TRUE(job.Run());
+    for (int i = 0; i < 4; i += 2) {
+      EXPECT_SOAFLOAT3_EQ(output_transforms[i].translation,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+      EXPECT_SOAQUATERNION_EQ_EST(output_transforms[i].rotation,
+                                  0.f, 0.f, 0.f, 0.f,
+                                  0.f, 0.f, 0.f, 0.f,
+                                  0.f, 0.f, 0.f, 0.f,
+                                  1.f, 1.f, 1.f, 1.f);
+      EXPECT_SOAFLOAT3_EQ(output_transforms[i].scale,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f);
+    }
+    EXPECT_SOAFLOAT3_EQ(output_transforms[3].translation,
+                        -0.f, -1.f, -2.f, -3.f,
+                        -4.f, -5.f, -6.f, -7.f,
+                        -8.f, -9.f, -10.f, -11.f);
+  }
+
+  // Tests with the ranged layer blended first and last.
+  for (int i = 0; i < 2; ++i) {
+    BlendingJob::Layer layers[2];
+    BlendingJob::Layer& full = layers[i];
+    full.weight = 1.f;
+    full.transform.begin = input_transforms[0];
+    full.transform.end = input_transforms[0] + 4;
+    layers[1 - i] = ranged;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    EXPECT_TRUE(job.Run());
+
+    for (int j = 0; j < 4; j += 2) {
+      EXPECT_SOAFLOAT3_EQ(output_transforms[j].translation,
+                          0.f, 1.f, 2.f, 3.f,
+                          4.f, 5.f, 6.f, 7.f,
+                          8.f, 9.f, 10.f, 11.f);
+      EXPECT_SOAFLOAT3_EQ(output_transforms[j].scale,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f);
+    }
+    for (int j = 1; j < 4; j += 2) {
+      EXPECT_SOAFLOAT3_EQ(output_transforms[j].translation,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+      EXPECT_SOAFLOAT3_EQ(output_transforms[j].scale,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f);
+    }
+  }
+}
+
+TEST(JobSoaRange, BlendingJob) {
+  const int kNumSoaJoints = 5;
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  ozz::math::SoaTransform input_transforms[3][kNumSoaJoints];
+  ozz::math::SimdFloat4 joint_weights[kNumSoaJoints];
+  ozz::math::SoaTransform bind_poses[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    for (int l = 0; l < 3; ++l) {
+      const float value = 1.f + i + l * .5f;
+      input_transforms[l][i] = identity;
+      input_transforms[l][i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(value, -value, 0.f, 1.f),
+        ozz::math::simd_float4::Load1(value),
+        ozz::math::simd_float4::Load1(-value));
+      input_transforms[l][i].rotation.z =
+        ozz::math::simd_float4::Load1(value * .1f);
+    }
+    joint_weights[i] = ozz::math::simd_float4::Load(.1f * i, 0.f, 1.f, .5f);
+    bind_poses[i] = identity;
+  }
+  const BlendingJob::SoaRange ranges[] = {{1, 3}};
+
+  BlendingJob::Layer layers[2];
+  layers[0].weight = .6f;
+  layers[0].transform.begin = input_transforms[0];
+  layers[0].transform.end = input_transforms[0] + kNumSoaJoints;
+  layers[0].joint_weights.begin = joint_weights;
+  layers[0].joint_weights.end = joint_weights + kNumSoaJoints;
+  layers[1].weight = .8f;
+  layers[1].transform.begin = input_transforms[1];
+  layers[1].transform.end = input_transforms[1] + kNumSoaJoints;
+  layers[1].soa_ranges.begin = ranges;
+  layers[1].soa_ranges.end = ranges + 1;
+
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].weight = .5f;
+  additive_layers[0].transform.begin = input_transforms[2];
+  additive_layers[0].transform.end = input_transforms[2] + kNumSoaJoints;
+
+  BlendingJob job;
+  job.layers.begin = layers;
+  job.layers.end = layers + 2;
+  job.additive_layers.begin = additive_layers;
+  job.additive_layers.end = additive_layers + 1;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + kNumSoaJoints;
+  ozz::math::SoaTransform expected[kNumSoaJoints];
+  job.output.begin = expected;
+  job.output.end = expected + kNumSoaJoints;
+  ASSERT_TRUE(job.Run());
+
+  { // Invalid soa ranges.
+    BlendingJob invalid_job = job;
+    invalid_job.soa_range.begin = -1;
+    invalid_job.soa_range.end = 2;
+    EXPECT_FALSE(invalid_job.Validate());
+    invalid_job.soa_range.begin = 3;
+    EXPECT_FALSE(invalid_job.Validate());
+    invalid_job.soa_range.end = 3;
+    EXPECT_TRUE(invalid_job.Validate());
+  }
+
+  // Splits the job in soa ranges, which cut layers soa ranges and exceed the
+  // bind pose size.
+  const BlendingJob::SoaRange splits[] = {{0, 2}, {2, 2}, {2, 4}, {4, 10}};
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    output[i] = identity;
+  }
+  job.output.begin = output;
+  job.output.end = output + kNumSoaJoints;
+  for (size_t s = 0; s < OZZ_ARRAY_SIZE(splits); ++s) {
+    job.soa_range = splits[s];
+    ASSERT_TRUE(job.Run());
+
+    // Soa joints beyond the range are left unchanged.
+    for (int i = splits[s].end; i < kNumSoaJoints; ++i) {
+      EXPECT_EQ(std::memcmp(&output[i], &identity, sizeof(identity)), 0);
+    }
+  }
+
+  // The split output is the same as the full one.
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    EXPECT_EQ(std::memcmp(&output[i], &expected[i], sizeof(expected[i])), 0);
+  }
+
+  { // Invalid lod.
+    BlendingJob invalid_job = job;
+    invalid_job.num_joints_lod = -1;
+    EXPECT_FALSE(invalid_job.Validate());
+    invalid_job.num_joints_lod = 0;
+    EXPECT_TRUE(invalid_job.Validate());
+  }
+
+  // Blends a lod, which stops at the soa joint that contains its last joint
+  // and is combined with the soa range.
+  job.soa_range.begin = 1;
+  job.soa_range.end = kNumSoaJoints;
+  job.num_joints_lod = 10;
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    output[i] = identity;
+  }
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    const bool blended = i >= 1 && i < 3;
+    EXPECT_EQ(std::memcmp(&output[i], blended ? &expected[i] : &identity,
+                          sizeof(identity)), 0) << i;
+  }
+}
+
+TEST(BindPoseFlags, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::math::SoaTransform bind_poses[3] = {identity, identity, identity};
+  bind_poses[1].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f),
+    ozz::math::simd_float4::Load(5.f, 6.f, 7.f, 8.f),
+    ozz::math::simd_float4::Load(9.f, 10.f, 11.f, 12.f));
+  bind_poses[2].scale = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(2.f, 3.f, 4.f, 5.f),
+    ozz::math::simd_float4::Load(6.f, 7.f, 8.f, 9.f),
+    ozz::math::simd_float4::Load(10.f, 11.f, 12.f, 13.f));
+  ozz::math::SoaTransform input_transforms[3] = {identity, identity, identity};
+  input_transforms[0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(-1.f, -2.f, -3.f, -4.f),
+    ozz::math::simd_float4::zero(), ozz::math::simd_float4::zero());
+
+  // Only soa joint 0 is blended.
+  const BlendingJob::SoaRange ranges[] = {{0, 1}};
+  BlendingJob::Layer layers[1];
+  layers[0].weight = 1.f;
+  layers[0].transform.begin = input_transforms;
+  layers[0].transform.end = input_transforms + 3;
+  layers[0].soa_ranges.begin = ranges;
+  layers[0].soa_ranges.end = ranges + 1;
+
+  bool flags[3] = {true, false, false};
+  ozz::math::SoaTransform output[3];
+  BlendingJob::Stats stats;
+
+  BlendingJob job;
+  EXPECT_TRUE(job.bind_pose_flags.begin == NULL);
+  job.layers.begin = layers;
+  job.layers.end = layers + 1;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 3;
+  job.output.begin = output;
+  job.output.end = output + 3;
+  job.stats = &stats;
+
+  { // Invalid flags.
+    BlendingJob invalid_job = job;
+    invalid_job.bind_pose_flags.begin = flags;
+    invalid_job.bind_pose_flags.end = flags + 2;
+    EXPECT_FALSE(invalid_job.Validate());
+    invalid_job.bind_pose_flags.begin = NULL;
+    EXPECT_FALSE(invalid_job.Validate());
+  }
+
+  job.bind_pose_flags.begin = flags;
+  job.bind_pose_flags.end = flags + 3;
+  ASSERT_TRUE(job.Run());
+
+  // Soa joints no layer affects are copied from the bind pose.
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, -1.f, -2.f, -3.f, -4.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  for (int i = 1; i < 3; ++i) {
+    EXPECT_EQ(std::memcmp(&output[i], &bind_poses[i], sizeof(output[i])), 0);
+  }
+  EXPECT_FALSE(flags[0]);
+  EXPECT_TRUE(flags[1]);
+  EXPECT_TRUE(flags[2]);
+#ifdef OZZ_HAS_STATS
+  EXPECT_EQ(stats.bind_pose_joints, 2);
+#endif  // OZZ_HAS_STATS
+
+  // The copy is skipped for flagged soa joints.
+  output[1] = identity;
+  flags[2] = false;
+  output[2] = identity;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(std::memcmp(&output[1], &identity, sizeof(output[1])), 0);
+  EXPECT_EQ(std::memcmp(&output[2], &bind_poses[2], sizeof(output[2])), 0);
+
+  // Additive layers are applied on top of the bind pose, which clears flags.
+  BlendingJob::Layer additive_layers[1];
+  ozz::math::SoaTransform additive_transforms[3] = {identity, identity,
+                                                    identity};
+  additive_transforms[2].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::one(), ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::zero());
+  additive_layers[0].weight = 1.f;
+  additive_layers[0].transform.begin = additive_transforms;
+  additive_layers[0].transform.end = additive_transforms + 3;
+  job.additive_layers.begin = additive_layers;
+  job.additive_layers.end = additive_layers + 1;
+  flags[1] = false;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[1].translation, 1.f, 2.f, 3.f, 4.f,
+                      5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f);
+  EXPECT_SOAFLOAT3_EQ(output[2].translation, 1.f, 1.f, 1.f, 1.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[2].scale, 2.f, 3.f, 4.f, 5.f,
+                      6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f, 13.f);
+  EXPECT_FALSE(flags[0]);
+  EXPECT_FALSE(flags[1]);
+  EXPECT_FALSE(flags[2]);
+
+  // A layer blended on a soa joint the output holds the bind pose for
+  // overwrites it.
+  job.additive_layers.begin = NULL;
+  job.additive_layers.end = NULL;
+  ASSERT_TRUE(job.Run());
+  EXPECT_TRUE(flags[1]);
+  job.soa_range.begin = 1;
+  layers[0].soa_ranges.begin = NULL;
+  layers[0].soa_ranges.end = NULL;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FALSE(flags[1]);
+  EXPECT_SOAFLOAT3_EQ(output[1].translation, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+}
+
+TEST(Stats, BlendingJob) {
+  // Counters are only updated if stats are enabled.
+#ifdef OZZ_HAS_STATS
+  const int enabled = 1;
+#else  // OZZ_HAS_STATS
+  const int enabled = 0;
+#endif  // OZZ_HAS_STATS
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::math::SoaTransform bind_poses[2] = {identity, identity};
+  ozz::math::SoaTransform input_transforms[2] = {identity, identity};
+  ozz::math::SoaTransform output_transforms[2];
+  ozz::math::SimdFloat4 joint_weights[2] = {
+    ozz::math::simd_float4::one(), ozz::math::simd_float4::one()};
+
+  // Layer 1 has a weight of 0, so it isn't blended.
+  BlendingJob::Layer layers[3];
+  for (int i = 0; i < 3; ++i) {
+    layers[i].weight = i == 1 ? 0.f : 1.f;
+    layers[i].transform.begin = input_transforms;
+    layers[i].transform.end = input_transforms + 2;
+  }
+  layers[2].joint_weights.begin = joint_weights;
+  layers[2].joint_weights.end = joint_weights + 2;
+
+  BlendingJob::Layer additive_layers[2];
+  for (int i = 0; i < 2; ++i) {
+    additive_layers[i].weight = i == 0 ? 1.f : 0.f;
+    additive_layers[i].transform.begin = input_transforms;
+    additive_layers[i].transform.end = input_transforms + 2;
+  }
+
+  BlendingJob::Stats stats;
+  EXPECT_EQ(stats.layers, 0);
+  EXPECT_EQ(stats.partial_layers, 0);
+  EXPECT_EQ(stats.additive_layers, 0);
+  EXPECT_EQ(stats.soa_joints, 0);
+  EXPECT_EQ(stats.bind_pose_joints, 0);
+
+  BlendingJob job;
+  EXPECT_TRUE(job.stats == NULL);
+  job.layers.begin = layers;
+  job.layers.end = layers + 3;
+  job.additive_layers.begin = additive_layers;
+  job.additive_layers.end = additive_layers + 2;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 2;
+  job.output.begin = output_transforms;
+  job.output.end = output_transforms + 2;
+  job.stats = &stats;
+
+  EXPECT_TRUE(job.Run());
+  EXPECT_EQ(stats.layers, 2 * enabled);
+  EXPECT_EQ(stats.partial_layers, 1 * enabled);
+  EXPECT_EQ(stats.additive_layers, 1 * enabled);
+  EXPECT_EQ(stats.soa_joints, 2 * enabled);
+
+  // Stats are accumulated.
+  job.soa_range.begin = 1;
+  EXPECT_TRUE(job.Run());
+  EXPECT_EQ(stats.layers, 4 * enabled);
+  EXPECT_EQ(stats.partial_layers, 2 * enabled);
+  EXPECT_EQ(stats.additive_layers, 2 * enabled);
+  EXPECT_EQ(stats.soa_joints, 3 * enabled);
+}
@@ -0,0 +1,225 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/character_pipeline.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/tasks/thread_pool.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::CharacterPipeline;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton of 6 joints, a root and 5 children.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    RawSkeleton::Joint& child = root.children[i];
+    child.name = std::string("j") + static_cast<char>('0' + i);
+    child.transform = ozz::math::Transform::identity();
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Sets all local-space transforms of a character to a translation along x,
+// of the character index.
+class PoseStage : public CharacterPipeline::Stage {
+ public:
+  virtual bool Run(const CharacterPipeline::Context& _context) const {
+    const float x = static_cast<float>(_context.character);
+    const ozz::math::SoaTransform transform = {
+      ozz::math::SoaFloat3::Load(ozz::math::simd_float4::Load1(x),
+                                 ozz::math::simd_float4::zero(),
+                                 ozz::math::simd_float4::zero()),
+      ozz::math::SoaQuaternion::identity(),
+      ozz::math::SoaFloat3::one()};
+    for (size_t i = 0; i < _context.locals.Count(); ++i) {
+      _context.locals.begin[i] = transform;
+    }
+    return true;
+  }
+};
+
+// Fails for character _character, and records the characters that reached
+// this stage.
+class FailingStage : public CharacterPipeline::Stage {
+ public:
+  FailingStage(int _character, bool* _reached)
+      : character_(_character),
+        reached_(_reached) {
+  }
+
+  virtual bool Run(const CharacterPipeline::Context& _context) const {
+    reached_[_context.character] = true;
+    return _context.character != character_;
+  }
+
+ private:
+  int character_;
+  bool* reached_;
+};
+}  // namespace
+
+TEST(Stages, CharacterPipeline) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  CharacterPipeline pipeline(*skeleton, 4, 2, 2);
+  EXPECT_EQ(pipeline.max_characters(), 4);
+  EXPECT_EQ(pipeline.num_stages(), 0);
+
+  const PoseStage pose;
+  EXPECT_EQ(pipeline.AddStage(NULL, "null"), CharacterPipeline::kInvalidStage);
+  EXPECT_EQ(pipeline.AddStage(&pose, "pose"), 0);
+  EXPECT_EQ(pipeline.AddLocalToModelStage(), 1);
+  EXPECT_EQ(pipeline.AddStage(&pose, "full"), CharacterPipeline::kInvalidStage);
+  EXPECT_EQ(pipeline.AddLocalToModelStage(), CharacterPipeline::kInvalidStage);
+  ASSERT_EQ(pipeline.num_stages(), 2);
+  EXPECT_STREQ(pipeline.stage_name(0), "pose");
+  EXPECT_STREQ(pipeline.stage_name(1), "local_to_model");
+
+  // Invalid number of characters.
+  EXPECT_FALSE(pipeline.Run(-1, NULL));
+  EXPECT_FALSE(pipeline.Run(5, NULL));
+
+  // No character to process.
+  EXPECT_TRUE(pipeline.Run(0, NULL));
+
+  EXPECT_TRUE(pipeline.Run(3, NULL));
+  for (int c = 0; c < 3; ++c) {
+    const ozz::Range<const ozz::math::Float4x4> models = pipeline.models(c);
+    ASSERT_EQ(models.Count(), 6u);
+    const float x = static_cast<float>(c);
+    EXPECT_FLOAT4x4_EQ(models[0],
+                       1.f, 0.f, 0.f, 0.f,
+                       0.f, 1.f, 0.f, 0.f,
+                       0.f, 0.f, 1.f, 0.f,
+                       x, 0.f, 0.f, 1.f);
+    for (size_t i = 1; i < models.Count(); ++i) {
+      EXPECT_FLOAT4x4_EQ(models[i],
+                         1.f, 0.f, 0.f, 0.f,
+                         0.f, 1.f, 0.f, 0.f,
+                         0.f, 0.f, 1.f, 0.f,
+                         x * 2.f, 0.f, 0.f, 1.f);
+    }
+  }
+
+  // Character 3 wasn't processed.
+  EXPECT_FLOAT4x4_EQ(pipeline.models(3)[0],
+                     1.f, 0.f, 0.f, 0.f,
+                     0.f, 1.f, 0.f, 0.f,
+                     0.f, 0.f, 1.f, 0.f,
+                     0.f, 0.f, 0.f, 1.f);
+
+  for (int i = 0; i < pipeline.num_stages(); ++i) {
+    EXPECT_GE(pipeline.stage_time(i), 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Failure, CharacterPipeline) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  bool failing_reached[4];
+  bool next_reached[4];
+  std::memset(failing_reached, 0, sizeof(failing_reached));
+  std::memset(next_reached, 0, sizeof(next_reached));
+  const FailingStage failing(1, failing_reached);
+  const FailingStage next(-1, next_reached);
+
+  CharacterPipeline pipeline(*skeleton, 4, 2, 1);
+  EXPECT_EQ(pipeline.AddStage(&failing, "failing"), 0);
+  EXPECT_EQ(pipeline.AddStage(&next, "next"), 1);
+
+  // Following stages are skipped for the failing character only.
+  EXPECT_FALSE(pipeline.Run(4, NULL));
+  for (int c = 0; c < 4; ++c) {
+    EXPECT_TRUE(failing_reached[c]);
+    EXPECT_EQ(next_reached[c], c != 1);
+  }
+
+  // Succeeds if the failing character isn't processed.
+  EXPECT_TRUE(pipeline.Run(1, NULL));
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(ThreadPool, CharacterPipeline) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  const int kNumCharacters = 67;
+  CharacterPipeline pipeline(*skeleton, kNumCharacters, 2, 8);
+  const PoseStage pose;
+  EXPECT_EQ(pipeline.AddStage(&pose, "pose"), 0);
+  EXPECT_EQ(pipeline.AddLocalToModelStage(), 1);
+
+  ozz::tasks::ThreadPool pool(4);
+  for (int run = 0; run < 4; ++run) {
+    EXPECT_TRUE(pipeline.Run(kNumCharacters, &pool));
+    for (int c = 0; c < kNumCharacters; ++c) {
+      const float x = static_cast<float>(c);
+      const ozz::Range<const ozz::math::Float4x4> models = pipeline.models(c);
+      EXPECT_FLOAT4x4_EQ(models[0],
+                         1.f, 0.f, 0.f, 0.f,
+                         0.f, 1.f, 0.f, 0.f,
+                         0.f, 0.f, 1.f, 0.f,
+                         x, 0.f, 0.f, 1.f);
+      EXPECT_FLOAT4x4_EQ(models[5],
+                         1.f, 0.f, 0.f, 0.f,
+                         0.f, 1.f, 0.f, 0.f,
+                         0.f, 0.f, 1.f, 0.f,
+                         x * 2.f, 0.f, 0.f, 1.f);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
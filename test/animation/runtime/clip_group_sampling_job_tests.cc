@@ -0,0 +1,303 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/clip_group_sampling_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/clip_group_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::ClipGroupSamplingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::ClipGroupBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a clip of _num_tracks tracks and _duration, whose keys depend on
+// _seed.
+void BuildClip(int _num_tracks, float _duration, float _seed, bool _hermite,
+               RawAnimation* _clip) {
+  _clip->duration = _duration;
+  _clip->interpolation =
+    _hermite ? RawAnimation::kHermite : RawAnimation::kLinear;
+  _clip->tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = _clip->tracks[i];
+    for (int k = 0; k < 3; ++k) {
+      const float time = _duration * k * (.25f + (i % 4) * .08f);
+      const float value = _seed + i + k * _seed;
+      const RawAnimation::TranslationKey t = {
+        time, ozz::math::Float3(value, -value, value * .5f)};
+      track.translations.push_back(t);
+      track.translation_tangents.push_back(ozz::math::Float3(1.f, 0.f, -1.f));
+      const float angle = value * .1f;
+      const RawAnimation::RotationKey r = {
+        time, ozz::math::Quaternion(0.f, std::sin(angle), 0.f,
+                                    std::cos(angle))};
+      track.rotations.push_back(r);
+      track.rotation_tangents.push_back(ozz::math::Float4::zero());
+      const RawAnimation::ScaleKey s = {
+        time, ozz::math::Float3(1.f + value * .1f, 1.f, 1.f)};
+      track.scales.push_back(s);
+      track.scale_tangents.push_back(ozz::math::Float3(0.f, .5f, 0.f));
+    }
+  }
+}
+
+// Compares _a and _b soa transforms, with _tolerance.
+void ExpectNear(const ozz::math::SoaTransform& _a,
+                const ozz::math::SoaTransform& _b,
+                float _tolerance = 2e-3f) {
+  const ozz::math::SimdFloat4* a =
+    reinterpret_cast<const ozz::math::SimdFloat4*>(&_a);
+  const ozz::math::SimdFloat4* b =
+    reinterpret_cast<const ozz::math::SimdFloat4*>(&_b);
+  for (size_t i = 0; i < sizeof(_a) / sizeof(*a); ++i) {
+    float fa[4];
+    float fb[4];
+    ozz::math::StorePtrU(a[i], fa);
+    ozz::math::StorePtrU(b[i], fb);
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(fa[j], fb[j], _tolerance);
+    }
+  }
+}
+
+const int kNumClips = 3;
+const int kNumTracks = 9;
+const int kNumSoaTracks = 3;
+
+// Builds kNumClips clips, their group and every clip animation.
+struct Fixture {
+  explicit Fixture(bool _hermite) {
+    const RawAnimation* clips[kNumClips];
+    for (int i = 0; i < kNumClips; ++i) {
+      BuildClip(kNumTracks, .5f + i, 1.f + i, _hermite, &raw[i]);
+      clips[i] = &raw[i];
+      animations[i] = AnimationBuilder()(raw[i]);
+    }
+    group = ClipGroupBuilder()(ozz::Range<const RawAnimation* const>(clips));
+  }
+  ~Fixture() {
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    for (int i = 0; i < kNumClips; ++i) {
+      allocator->Delete(animations[i]);
+    }
+    allocator->Delete(group);
+  }
+  RawAnimation raw[kNumClips];
+  Animation* animations[kNumClips];
+  Animation* group;
+};
+}  // namespace
+
+TEST(JobValidity, ClipGroupSamplingJob) {
+  Fixture fixture(false);
+  ASSERT_TRUE(fixture.group != NULL);
+  SamplingCache cache(fixture.group->num_tracks());
+  SamplingCache small_cache(kNumTracks);
+  ozz::math::SoaTransform output[kNumClips * kNumSoaTracks];
+  const float weights[kNumClips] = {1.f, 0.f, 2.f};
+  const float zero_weights[kNumClips] = {0.f, -1.f, 0.f};
+
+  { // Empty/default job.
+    ClipGroupSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  ClipGroupSamplingJob job;
+  job.group = fixture.group;
+  job.num_clips = kNumClips;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + kNumClips * kNumSoaTracks;
+  EXPECT_TRUE(job.Validate());
+
+  { // Invalid number of clips.
+    ClipGroupSamplingJob invalid = job;
+    invalid.num_clips = 0;
+    EXPECT_FALSE(invalid.Validate());
+    invalid.num_clips = 2;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // Cache too small.
+    ClipGroupSamplingJob invalid = job;
+    invalid.cache = &small_cache;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // Output too small for all poses.
+    ClipGroupSamplingJob invalid = job;
+    invalid.output.end = output + kNumSoaTracks;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // Blending only needs a single pose.
+    ClipGroupSamplingJob blend = job;
+    blend.weights.begin = weights;
+    blend.weights.end = weights + kNumClips;
+    blend.output.end = output + kNumSoaTracks;
+    EXPECT_TRUE(blend.Validate());
+    EXPECT_TRUE(blend.Run());
+
+    blend.output.end = output + kNumSoaTracks - 1;
+    EXPECT_FALSE(blend.Validate());
+  }
+
+  { // Invalid number of weights.
+    ClipGroupSamplingJob invalid = job;
+    invalid.weights.begin = weights;
+    invalid.weights.end = weights + kNumClips - 1;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // No positive weight.
+    ClipGroupSamplingJob invalid = job;
+    invalid.weights.begin = zero_weights;
+    invalid.weights.end = zero_weights + kNumClips;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  EXPECT_TRUE(job.Run());
+}
+
+TEST(Poses, ClipGroupSamplingJob) {
+  for (int hermite = 0; hermite < 2; ++hermite) {
+    Fixture fixture(hermite != 0);
+    ASSERT_TRUE(fixture.group != NULL);
+    SamplingCache group_cache(fixture.group->num_tracks());
+    SamplingCache cache(kNumTracks);
+    ozz::math::SoaTransform poses[kNumClips * kNumSoaTracks];
+    ozz::math::SoaTransform expected[kNumSoaTracks];
+
+    ClipGroupSamplingJob job;
+    job.group = fixture.group;
+    job.num_clips = kNumClips;
+    job.cache = &group_cache;
+    job.output.begin = poses;
+    job.output.end = poses + kNumClips * kNumSoaTracks;
+
+    // Plays forward then seeks backward, sharing the group cache.
+    const float ratios[] = {0.f, .1f, .35f, .6f, 1.f, .2f};
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+      job.ratio = ratios[r];
+      ASSERT_TRUE(job.Run());
+
+      for (int i = 0; i < kNumClips; ++i) {
+        SamplingJob sampling;
+        sampling.animation = fixture.animations[i];
+        sampling.cache = &cache;
+        sampling.time = ratios[r] * fixture.raw[i].duration;
+        sampling.output.begin = expected;
+        sampling.output.end = expected + kNumSoaTracks;
+        ASSERT_TRUE(sampling.Run());
+        for (int j = 0; j < kNumSoaTracks; ++j) {
+          ExpectNear(poses[i * kNumSoaTracks + j], expected[j]);
+        }
+      }
+    }
+  }
+}
+
+TEST(Blend, ClipGroupSamplingJob) {
+  Fixture fixture(false);
+  ASSERT_TRUE(fixture.group != NULL);
+  SamplingCache group_cache(fixture.group->num_tracks());
+  SamplingCache cache(fixture.group->num_tracks());
+  ozz::math::SoaTransform poses[kNumClips * kNumSoaTracks];
+  ozz::math::SoaTransform blended[kNumSoaTracks];
+  ozz::math::SoaTransform expected[kNumSoaTracks];
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_pose[kNumSoaTracks] = {
+    identity, identity, identity};
+
+  const float weights[kNumClips] = {.5f, 0.f, 1.5f};
+
+  ClipGroupSamplingJob job;
+  job.group = fixture.group;
+  job.num_clips = kNumClips;
+  job.cache = &group_cache;
+  job.weights.begin = weights;
+  job.weights.end = weights + kNumClips;
+  job.output.begin = blended;
+  job.output.end = blended + kNumSoaTracks;
+
+  const float ratios[] = {0.f, .3f, .7f, 1.f};
+  for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+    job.ratio = ratios[r];
+    ASSERT_TRUE(job.Run());
+
+    // Blends all poses with a BlendingJob.
+    SamplingJob sampling;
+    sampling.animation = fixture.group;
+    sampling.cache = &cache;
+    sampling.time = ratios[r];
+    sampling.output.begin = poses;
+    sampling.output.end = poses + kNumClips * kNumSoaTracks;
+    ASSERT_TRUE(sampling.Run());
+
+    BlendingJob::Layer layers[kNumClips];
+    for (int i = 0; i < kNumClips; ++i) {
+      layers[i].weight = weights[i];
+      layers[i].transform.begin = poses + i * kNumSoaTracks;
+      layers[i].transform.end = poses + (i + 1) * kNumSoaTracks;
+    }
+    BlendingJob blending;
+    blending.layers.begin = layers;
+    blending.layers.end = layers + kNumClips;
+    blending.bind_pose.begin = bind_pose;
+    blending.bind_pose.end = bind_pose + kNumSoaTracks;
+    blending.output.begin = expected;
+    blending.output.end = expected + kNumSoaTracks;
+    ASSERT_TRUE(blending.Run());
+
+    for (int j = 0; j < kNumSoaTracks; ++j) {
+      ExpectNear(blended[j], expected[j]);
+    }
+  }
+}
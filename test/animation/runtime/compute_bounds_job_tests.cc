@@ -0,0 +1,191 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/compute_bounds_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::animation::ComputeBoundsJob;
+
+TEST(JobValidity, ComputeBoundsJob) {
+  const ozz::math::Float4x4 models[3] = {ozz::math::Float4x4::identity(),
+                                         ozz::math::Float4x4::identity(),
+                                         ozz::math::Float4x4::identity()};
+  const float radii[3] = {0.f, 0.f, 0.f};
+  const ozz::math::Box clip_bound(ozz::math::Float3(-1.f),
+                                  ozz::math::Float3(1.f));
+  ozz::math::Box bound;
+
+  {  // Empty/default job.
+    ComputeBoundsJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Missing output.
+    ComputeBoundsJob job;
+    job.models = models;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Missing input.
+    ComputeBoundsJob job;
+    job.bound = &bound;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Both inputs.
+    ComputeBoundsJob job;
+    job.models = models;
+    job.clip_bound = &clip_bound;
+    job.bound = &bound;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid models range.
+    ComputeBoundsJob job;
+    job.models.begin = models + 2;
+    job.models.end = models;
+    job.bound = &bound;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Radii range too small.
+    ComputeBoundsJob job;
+    job.models = models;
+    job.radii = ozz::Range<const float>(radii, 2);
+    job.bound = &bound;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Valid models job.
+    ComputeBoundsJob job;
+    job.models = models;
+    job.radii = radii;
+    job.bound = &bound;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid clip job.
+    ComputeBoundsJob job;
+    job.clip_bound = &clip_bound;
+    job.bound = &bound;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Models, ComputeBoundsJob) {
+  const ozz::math::Float4x4 models[] = {
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 1.f)),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(-1.f, 0.f, 5.f, 1.f)),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(0.f, -4.f, 4.f, 1.f))};
+  const float radii[] = {.1f, .2f, .3f};
+  ozz::math::Box bound;
+
+  ComputeBoundsJob job;
+  job.bound = &bound;
+
+  // Empty range outputs an invalid box.
+  job.models = ozz::Range<const ozz::math::Float4x4>(models, models);
+  ASSERT_TRUE(job.Run());
+  EXPECT_FALSE(bound.is_valid());
+
+  // All counts, to test odd and even reductions.
+  job.models = ozz::Range<const ozz::math::Float4x4>(models, 1);
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(bound.min, 1.f, 2.f, 3.f);
+  EXPECT_FLOAT3_EQ(bound.max, 1.f, 2.f, 3.f);
+
+  job.models = ozz::Range<const ozz::math::Float4x4>(models, 2);
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(bound.min, -1.f, 0.f, 3.f);
+  EXPECT_FLOAT3_EQ(bound.max, 1.f, 2.f, 5.f);
+
+  job.models = models;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(bound.min, -1.f, -4.f, 3.f);
+  EXPECT_FLOAT3_EQ(bound.max, 1.f, 2.f, 5.f);
+
+  // Inflated by radii.
+  job.radii = radii;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(bound.min, -1.2f, -4.3f, 2.9f);
+  EXPECT_FLOAT3_EQ(bound.max, 1.1f, 2.1f, 5.2f);
+
+  // Transformed.
+  const ozz::math::Float4x4 transform = ozz::math::Float4x4::Translation(
+    ozz::math::simd_float4::Load(10.f, 0.f, -10.f, 1.f));
+  job.transform = &transform;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(bound.min, 8.8f, -4.3f, -7.1f);
+  EXPECT_FLOAT3_EQ(bound.max, 11.1f, 2.1f, -4.8f);
+}
+
+TEST(ClipBound, ComputeBoundsJob) {
+  const ozz::math::Box clip_bound(ozz::math::Float3(-1.f, 0.f, -2.f),
+                                  ozz::math::Float3(1.f, 2.f, 2.f));
+  ozz::math::Box bound;
+
+  ComputeBoundsJob job;
+  job.clip_bound = &clip_bound;
+  job.bound = &bound;
+
+  // Copied if not transformed.
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(bound.min, -1.f, 0.f, -2.f);
+  EXPECT_FLOAT3_EQ(bound.max, 1.f, 2.f, 2.f);
+
+  // Rotated by pi/2 around y and translated.
+  const ozz::math::Float4x4 transform =
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 1.f)) *
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, ozz::math::kPi_2));
+  job.transform = &transform;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(bound.min, -2.f, 1.f, -1.f);
+  EXPECT_FLOAT3_EQ(bound.max, 2.f, 3.f, 1.f);
+
+  // Invalid clip bound remains invalid.
+  const ozz::math::Box invalid;
+  job.clip_bound = &invalid;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FALSE(bound.is_valid());
+}
@@ -0,0 +1,237 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/event_query_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_event_track.h"
+#include "ozz/animation/offline/event_track_builder.h"
+#include "ozz/animation/runtime/event_track.h"
+
+using ozz::animation::EventTrack;
+using ozz::animation::EventQueryJob;
+using ozz::animation::EventQueryCache;
+using ozz::animation::offline::RawEventTrack;
+using ozz::animation::offline::EventTrackBuilder;
+
+namespace {
+// Builds a 2s track, with events at the beginning, middle and end. Event ids
+// are their index.
+EventTrack* BuildTrack() {
+  RawEventTrack raw_track;
+  raw_track.duration = 2.f;
+  const RawEventTrack::Event events[] = {
+    {0.f, 0}, {.5f, 1}, {1.f, 2}, {1.f, 3}, {2.f, 4}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(events); ++i) {
+    raw_track.events.push_back(events[i]);
+  }
+  EventTrackBuilder builder;
+  return builder(raw_track);
+}
+
+// Expects _range to contain events of ids [_first,_last[.
+void ExpectEvents(const ozz::Range<const EventTrack::Event>& _range,
+                  uint32_t _first, uint32_t _last) {
+  ASSERT_EQ(_range.Count(), static_cast<size_t>(_last - _first));
+  for (uint32_t i = _first; i < _last; ++i) {
+    EXPECT_EQ(_range.begin[i - _first].id, i);
+  }
+}
+}  // namespace
+
+TEST(JobValidity, EventQueryJob) {
+  EventTrack* track = BuildTrack();
+  ASSERT_TRUE(track != NULL);
+  ozz::Range<const EventTrack::Event> events;
+  ozz::Range<const EventTrack::Event> looped_events;
+
+  {  // Empty/default job.
+    EventQueryJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Missing outputs.
+    EventQueryJob job;
+    job.track = track;
+    EXPECT_FALSE(job.Validate());
+    job.events = &events;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Valid job, cache is optional.
+    EventQueryJob job;
+    job.track = track;
+    job.events = &events;
+    job.looped_events = &looped_events;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job on an empty track.
+    EventTrack empty;
+    EventQueryCache cache;
+    EventQueryJob job;
+    job.track = &empty;
+    job.cache = &cache;
+    job.to = 1.f;
+    job.events = &events;
+    job.looped_events = &looped_events;
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(events.Count(), 0u);
+    EXPECT_EQ(looped_events.Count(), 0u);
+  }
+
+  ozz::memory::default_allocator()->Delete(track);
+}
+
+TEST(Query, EventQueryJob) {
+  EventTrack* track = BuildTrack();
+  ASSERT_TRUE(track != NULL);
+  ozz::Range<const EventTrack::Event> events;
+  ozz::Range<const EventTrack::Event> looped_events;
+
+  // Queries are run with and without cache.
+  for (int c = 0; c < 2; ++c) {
+    EventQueryCache cache;
+    EventQueryJob job;
+    job.track = track;
+    job.cache = c ? &cache : NULL;
+    job.events = &events;
+    job.looped_events = &looped_events;
+
+    const struct {
+      float from;
+      float to;
+      bool loop;
+      uint32_t first;
+      uint32_t last;
+      uint32_t looped_last;
+    } queries[] = {{0.f, 0.f, false, 0, 0, 0},   // Empty range.
+                   {0.f, .5f, false, 0, 1, 0},   // Beginning is fired.
+                   {.5f, 1.f, false, 1, 2, 0},   // Events at "to" aren't.
+                   {1.f, 1.5f, false, 2, 4, 0},
+                   {1.5f, 2.f, false, 4, 5, 0},  // End is fired.
+                   {2.f, 2.f, false, 0, 0, 0},   // Not fired again.
+                   {1.5f, .75f, true, 4, 5, 2},  // Loops.
+                   {.75f, 3.f, false, 2, 5, 0},  // Clamped.
+                   {1.f, .5f, false, 2, 4, 0},   // Backward.
+                   {.5f, -1.f, false, 0, 2, 0}};  // Backward to beginning.
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(queries); ++i) {
+      job.from = queries[i].from;
+      job.to = queries[i].to;
+      job.loop = queries[i].loop;
+      ASSERT_TRUE(job.Run());
+      if (queries[i].first == queries[i].last) {
+        EXPECT_EQ(events.Count(), 0u);
+      } else {
+        ExpectEvents(events, queries[i].first, queries[i].last);
+      }
+      ExpectEvents(looped_events, 0, queries[i].looped_last);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(track);
+}
+
+TEST(Playback, EventQueryJob) {
+  EventTrack* track = BuildTrack();
+  ASSERT_TRUE(track != NULL);
+  ozz::Range<const EventTrack::Event> events;
+  ozz::Range<const EventTrack::Event> looped_events;
+
+  // Plays the track in a loop with a 0.1s time step. Every event must be
+  // fired exactly once every cycle.
+  EventQueryCache cache;
+  EventQueryJob job;
+  job.track = track;
+  job.cache = &cache;
+  job.loop = true;
+  job.events = &events;
+  job.looped_events = &looped_events;
+  uint32_t counts[5] = {0, 0, 0, 0, 0};
+  float time = 0.f;
+  for (int i = 0; i < 100; ++i) {  // 5 cycles.
+    const float next = i % 20 == 19 ? 0.f : time + .1f;
+    job.from = time;
+    job.to = next;
+    ASSERT_TRUE(job.Run());
+    for (const EventTrack::Event* e = events.begin; e < events.end; ++e) {
+      ++counts[e->id];
+    }
+    for (const EventTrack::Event* e = looped_events.begin;
+         e < looped_events.end; ++e) {
+      ++counts[e->id];
+    }
+    time = next;
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(counts[i], 5u);
+  }
+
+  ozz::memory::default_allocator()->Delete(track);
+}
+
+TEST(Serialize, EventQueryJob) {
+  EventTrack* o_track = BuildTrack();
+  ASSERT_TRUE(o_track != NULL);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_track;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    EventTrack i_track;
+    i >> i_track;
+
+    // Compares tracks.
+    EXPECT_FLOAT_EQ(i_track.duration(), o_track->duration());
+    ASSERT_EQ(i_track.num_events(), o_track->num_events());
+    for (int k = 0; k < i_track.num_events(); ++k) {
+      EXPECT_FLOAT_EQ(i_track.events().begin[k].time,
+                      o_track->events().begin[k].time);
+      EXPECT_EQ(i_track.events().begin[k].id, o_track->events().begin[k].id);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(o_track);
+}
@@ -0,0 +1,254 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/float_track_sampling_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_float_track.h"
+#include "ozz/animation/offline/float_track_builder.h"
+#include "ozz/animation/runtime/float_track.h"
+
+using ozz::animation::FloatTrack;
+using ozz::animation::FloatTrackSamplingJob;
+using ozz::animation::FloatTrackSamplingCache;
+using ozz::animation::offline::RawFloatTrack;
+using ozz::animation::offline::FloatTrackBuilder;
+
+namespace {
+// Builds a 2s track of 5 curves:
+// -curve 0 has no key.
+// -curve 1 is constant.
+// -curve 2 goes from 0 to 2 then back to 0.
+// -curves 3 and 4 are a vector channel, stepping at t = 1.
+FloatTrack* BuildTrack() {
+  RawFloatTrack raw_track;
+  raw_track.duration = 2.f;
+  raw_track.curves.resize(5);
+  const RawFloatTrack::Key constant = {.5f, 46.f};
+  raw_track.curves[1].keys.push_back(constant);
+  const RawFloatTrack::Key ramp[] = {{0.f, 0.f}, {1.f, 2.f}, {2.f, 0.f}};
+  for (int i = 0; i < 3; ++i) {
+    raw_track.curves[2].keys.push_back(ramp[i]);
+  }
+  for (int c = 3; c < 5; ++c) {
+    const RawFloatTrack::Key step[] = {{.999f, 0.f},
+                                       {1.f, static_cast<float>(c)}};
+    raw_track.curves[c].keys.push_back(step[0]);
+    raw_track.curves[c].keys.push_back(step[1]);
+  }
+  FloatTrackBuilder builder;
+  return builder(raw_track);
+}
+}  // namespace
+
+TEST(JobValidity, FloatTrackSamplingJob) {
+  FloatTrack* track = BuildTrack();
+  ASSERT_TRUE(track != NULL);
+  FloatTrackSamplingCache cache(5);
+  float output[5];
+
+  {  // Empty/default job.
+    FloatTrackSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    FloatTrackSamplingJob job;
+    job.track = track;
+    job.cache = &cache;
+    EXPECT_FALSE(job.Validate());
+    job.output = ozz::Range<float>(output, 4);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid cache size.
+    FloatTrackSamplingCache small_cache(4);
+    FloatTrackSamplingJob job;
+    job.track = track;
+    job.cache = &small_cache;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Valid job.
+    FloatTrackSamplingJob job;
+    job.track = track;
+    job.cache = &cache;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job without any curve.
+    FloatTrack empty;
+    FloatTrackSamplingJob job;
+    job.track = &empty;
+    job.cache = &cache;
+    job.output = ozz::Range<float>(output, output);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(track);
+}
+
+TEST(Sampling, FloatTrackSamplingJob) {
+  FloatTrack* track = BuildTrack();
+  ASSERT_TRUE(track != NULL);
+  FloatTrackSamplingCache cache(5);
+  float output[6] = {-1.f, -1.f, -1.f, -1.f, -1.f, -1.f};
+
+  FloatTrackSamplingJob job;
+  job.track = track;
+  job.cache = &cache;
+  job.output = output;
+
+  // Samples forward, backward, then out of range. Key times are quantized, so
+  // the step is sampled slightly after its time.
+  const struct {
+    float time;
+    float values[5];
+  } expected[] = {{0.f, {0.f, 46.f, 0.f, 0.f, 0.f}},
+                  {.5f, {0.f, 46.f, 1.f, 0.f, 0.f}},
+                  {1.001f, {0.f, 46.f, 1.998f, 3.f, 4.f}},
+                  {1.5f, {0.f, 46.f, 1.f, 3.f, 4.f}},
+                  {2.f, {0.f, 46.f, 0.f, 3.f, 4.f}},
+                  {.25f, {0.f, 46.f, .5f, 0.f, 0.f}},
+                  {1.75f, {0.f, 46.f, .5f, 3.f, 4.f}},
+                  {-1.f, {0.f, 46.f, 0.f, 0.f, 0.f}},
+                  {3.f, {0.f, 46.f, 0.f, 3.f, 4.f}}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected); ++i) {
+    job.time = expected[i].time;
+    ASSERT_TRUE(job.Run());
+    for (int c = 0; c < 5; ++c) {
+      EXPECT_NEAR(output[c], expected[i].values[c], 2e-4f);
+    }
+    // Output after the number of curves is left unchanged.
+    EXPECT_FLOAT_EQ(output[5], -1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(track);
+}
+
+TEST(ManyCurves, FloatTrackSamplingJob) {
+  // Every curve is a ramp from 0 to its index, between times that differ for
+  // every curve.
+  const int num_curves = 321;
+  RawFloatTrack raw_track;
+  raw_track.duration = 1.f;
+  raw_track.curves.resize(num_curves);
+  for (int c = 0; c < num_curves; ++c) {
+    const float begin = (c % 7) * .1f;
+    const float end = begin + .2f + (c % 3) * .1f;
+    const RawFloatTrack::Key keys[] = {{begin, 0.f},
+                                       {end, static_cast<float>(c)}};
+    raw_track.curves[c].keys.push_back(keys[0]);
+    raw_track.curves[c].keys.push_back(keys[1]);
+  }
+  FloatTrackBuilder builder;
+  FloatTrack* track = builder(raw_track);
+  ASSERT_TRUE(track != NULL);
+
+  FloatTrackSamplingCache cache(num_curves);
+  float output[num_curves];
+  FloatTrackSamplingJob job;
+  job.track = track;
+  job.cache = &cache;
+  job.output = output;
+
+  // Samples forward twice, so that the cache is rewound once.
+  for (int loop = 0; loop < 2; ++loop) {
+    for (float time = 0.f; time <= 1.f; time += .01f) {
+      job.time = time;
+      ASSERT_TRUE(job.Run());
+      for (int c = 0; c < num_curves; ++c) {
+        const float begin = (c % 7) * .1f;
+        const float end = begin + .2f + (c % 3) * .1f;
+        const float alpha = time <= begin ? 0.f :
+                            time >= end ? 1.f : (time - begin) / (end - begin);
+        EXPECT_NEAR(output[c], alpha * c, 2e-3f * c);
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(track);
+}
+
+TEST(Serialize, FloatTrackSamplingJob) {
+  FloatTrack* o_track = BuildTrack();
+  ASSERT_TRUE(o_track != NULL);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_track;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    FloatTrack i_track;
+    i >> i_track;
+
+    EXPECT_FLOAT_EQ(i_track.duration(), o_track->duration());
+    EXPECT_EQ(i_track.num_curves(), o_track->num_curves());
+    EXPECT_EQ(i_track.size(), o_track->size());
+
+    // Compares sampled values.
+    FloatTrackSamplingCache cache(5);
+    float i_output[5];
+    float o_output[5];
+    FloatTrackSamplingJob job;
+    job.cache = &cache;
+    for (float time = 0.f; time <= 2.f; time += .1f) {
+      job.time = time;
+      job.track = &i_track;
+      job.output = i_output;
+      ASSERT_TRUE(job.Run());
+      job.track = o_track;
+      job.output = o_output;
+      ASSERT_TRUE(job.Run());
+      for (int c = 0; c < 5; ++c) {
+        EXPECT_FLOAT_EQ(i_output[c], o_output[c]);
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(o_track);
+}
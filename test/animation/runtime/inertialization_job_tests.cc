@@ -0,0 +1,312 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/inertialization_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::InertializationJob;
+using ozz::animation::InertializationSetupJob;
+using ozz::animation::SoaInertializationOffset;
+
+TEST(SetupJobValidity, InertializationJob) {
+  const ozz::math::SoaTransform poses[2] = {
+    ozz::math::SoaTransform::identity(), ozz::math::SoaTransform::identity()};
+  SoaInertializationOffset offsets[2];
+
+  { // Empty/default job.
+    InertializationSetupJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  InertializationSetupJob valid;
+  valid.delta_time = 1.f / 30.f;
+  valid.previous.begin = poses;
+  valid.previous.end = poses + 2;
+  valid.current.begin = poses;
+  valid.current.end = poses + 2;
+  valid.target.begin = poses;
+  valid.target.end = poses + 2;
+  valid.output.begin = offsets;
+  valid.output.end = offsets + 2;
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_TRUE(valid.Run());
+
+  { // Invalid delta time and duration.
+    InertializationSetupJob job = valid;
+    job.delta_time = 0.f;
+    EXPECT_FALSE(job.Validate());
+    job.delta_time = 1.f;
+    job.duration = -1.f;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Invalid previous.
+    InertializationSetupJob job = valid;
+    job.previous.end = poses + 1;
+    EXPECT_FALSE(job.Validate());
+    job.previous.begin = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Invalid target.
+    InertializationSetupJob job = valid;
+    job.target.end = poses + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Invalid output.
+    InertializationSetupJob job = valid;
+    job.output.end = offsets + 1;
+    EXPECT_FALSE(job.Validate());
+    job.output.begin = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Invalid current.
+    InertializationSetupJob job = valid;
+    job.current.end = poses;
+    job.current.begin = poses + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Smaller current pose is valid.
+    InertializationSetupJob job = valid;
+    job.current.end = poses + 1;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(JobValidity, InertializationJob) {
+  ozz::math::SoaTransform poses[2] = {
+    ozz::math::SoaTransform::identity(), ozz::math::SoaTransform::identity()};
+  const SoaInertializationOffset offsets[2] = {};
+
+  { // Empty/default job.
+    InertializationJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  InertializationJob valid;
+  valid.offsets.begin = offsets;
+  valid.offsets.end = offsets + 2;
+  valid.input.begin = poses;
+  valid.input.end = poses + 2;
+  valid.output.begin = poses;
+  valid.output.end = poses + 2;
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_TRUE(valid.Run());
+
+  { // Invalid offsets.
+    InertializationJob job = valid;
+    job.offsets.begin = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Invalid input.
+    InertializationJob job = valid;
+    job.input.end = poses + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Invalid output.
+    InertializationJob job = valid;
+    job.output.end = poses + 1;
+    EXPECT_FALSE(job.Validate());
+    job.output.end = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Smaller offsets are valid.
+    InertializationJob job = valid;
+    job.offsets.end = offsets + 1;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Decay, InertializationJob) {
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Translation x offsets are 1 in lanes 0 to 2 and -1 in lane 3. Lane 0 has
+  // no velocity, lane 1 approaches target slowly, lane 2 goes away from the
+  // target and lane 3 approaches target quickly. Rotation offset is 90 degrees
+  // around y, and scale offset is 1.
+  const float kDeltaTime = .01f;
+  const float kDuration = .5f;
+  ozz::math::SoaTransform previous = identity;
+  previous.translation.x =
+    ozz::math::simd_float4::Load(1.f, 1.01f, .99f, -2.f);
+  previous.rotation.y = ozz::math::simd_float4::Load1(.70710677f);
+  previous.rotation.w = ozz::math::simd_float4::Load1(.70710677f);
+  previous.scale.x = ozz::math::simd_float4::Load1(2.f);
+  ozz::math::SoaTransform current = previous;
+  current.translation.x = ozz::math::simd_float4::Load(1.f, 1.f, 1.f, -1.f);
+
+  // Target rotation is 90 degrees around x.
+  ozz::math::SoaTransform target = identity;
+  target.rotation.x = ozz::math::simd_float4::Load1(.70710677f);
+  target.rotation.w = ozz::math::simd_float4::Load1(.70710677f);
+  target.translation.y = ozz::math::simd_float4::Load1(3.f);
+  target.translation.x = zero;
+
+  SoaInertializationOffset offset;
+  InertializationSetupJob setup_job;
+  setup_job.delta_time = kDeltaTime;
+  setup_job.duration = kDuration;
+  setup_job.previous.begin = &previous;
+  setup_job.previous.end = &previous + 1;
+  setup_job.current.begin = &current;
+  setup_job.current.end = &current + 1;
+  setup_job.target.begin = &target;
+  setup_job.target.end = &target + 1;
+  setup_job.output.begin = &offset;
+  setup_job.output.end = &offset + 1;
+  ASSERT_TRUE(setup_job.Run());
+
+  ozz::math::SoaTransform output;
+  InertializationJob job;
+  job.offsets.begin = &offset;
+  job.offsets.end = &offset + 1;
+  job.input.begin = &target;
+  job.input.end = &target + 1;
+  job.output.begin = &output;
+  job.output.end = &output + 1;
+
+  { // Output matches source pose at transition time.
+    job.time = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output.translation,
+                            1.f, 1.f, 1.f, -1.f,
+                            0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output.rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                .70710677f, .70710677f, .70710677f, .70710677f,
+                                0.f, 0.f, 0.f, 0.f,
+                                .70710677f, .70710677f, .70710677f, .70710677f);
+    EXPECT_SOAFLOAT3_EQ_EST(output.scale,
+                            2.f, 2.f, 2.f, 2.f,
+                            1.f, 1.f, 1.f, 1.f,
+                            1.f, 1.f, 1.f, 1.f);
+
+    // Negative time is clamped.
+    job.time = -1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output.translation,
+                            1.f, 1.f, 1.f, -1.f,
+                            0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f);
+  }
+
+  { // Output velocity matches source velocity at transition time, but for
+    // the lane moving away from the target.
+    const float kH = 1e-3f;
+    job.time = 0.f;
+    ASSERT_TRUE(job.Run());
+    float x0[4];
+    ozz::math::StorePtrU(output.translation.x, x0);
+    job.time = kH;
+    ASSERT_TRUE(job.Run());
+    float x1[4];
+    ozz::math::StorePtrU(output.translation.x, x1);
+    EXPECT_NEAR((x1[0] - x0[0]) / kH, 0.f, .1f);
+    EXPECT_NEAR((x1[1] - x0[1]) / kH, -1.f, .1f);
+    EXPECT_NEAR((x1[2] - x0[2]) / kH, 0.f, .1f);
+    EXPECT_NEAR((x1[3] - x0[3]) / kH, 100.f, 10.f);
+  }
+
+  { // Offsets never overshoot target (but for float precision), and rotations
+    // remain normalized.
+    const ozz::math::SimdFloat4 min =
+      ozz::math::simd_float4::Load(-1e-5f, -1e-5f, -1e-5f, -1.f);
+    const ozz::math::SimdFloat4 max =
+      ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1e-5f);
+    for (float time = 0.f; time < kDuration; time += .01f) {
+      job.time = time;
+      ASSERT_TRUE(job.Run());
+      EXPECT_TRUE(ozz::math::AreAllTrue(
+        ozz::math::CmpGe(output.translation.x, min)));
+      EXPECT_TRUE(ozz::math::AreAllTrue(
+        ozz::math::CmpLe(output.translation.x, max)));
+      EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(output.rotation)));
+    }
+  }
+
+  { // Quick lane 3 decay duration is shortened.
+    job.time = .05f;
+    ASSERT_TRUE(job.Run());
+    float x[4];
+    ozz::math::StorePtrU(output.translation.x, x);
+    EXPECT_GT(x[0], .1f);
+    EXPECT_NEAR(x[3], 0.f, 1e-5f);
+  }
+
+  { // Output matches target once decayed.
+    for (int i = 0; i < 2; ++i) {
+      job.time = kDuration + i;
+      ASSERT_TRUE(job.Run());
+      EXPECT_SOAFLOAT3_EQ_EST(output.translation,
+                              0.f, 0.f, 0.f, 0.f,
+                              3.f, 3.f, 3.f, 3.f,
+                              0.f, 0.f, 0.f, 0.f);
+      EXPECT_SOAQUATERNION_EQ_EST(output.rotation,
+                                  .70710677f, .70710677f, .70710677f,
+                                  .70710677f,
+                                  0.f, 0.f, 0.f, 0.f,
+                                  0.f, 0.f, 0.f, 0.f,
+                                  .70710677f, .70710677f, .70710677f,
+                                  .70710677f);
+      EXPECT_SOAFLOAT3_EQ_EST(output.scale,
+                              1.f, 1.f, 1.f, 1.f,
+                              1.f, 1.f, 1.f, 1.f,
+                              1.f, 1.f, 1.f, 1.f);
+    }
+  }
+
+  { // Input and output can be the same buffer.
+    ozz::math::SoaTransform in_out = target;
+    job.time = 0.f;
+    job.input.begin = &in_out;
+    job.input.end = &in_out + 1;
+    job.output.begin = &in_out;
+    job.output.end = &in_out + 1;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(in_out.translation,
+                            1.f, 1.f, 1.f, -1.f,
+                            0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f);
+  }
+}
@@ -30,18 +30,40 @@
 
 #include "ozz/animation/runtime/local_to_model_job.h"
 
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
 #include "gtest/gtest.h"
 
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/linear_allocator.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/simd_float4x3.h"
+#include "ozz/base/maths/soa_float4x4.h"
 
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
 #include "ozz/animation/runtime/skeleton.h"
 
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
 using ozz::animation::Skeleton;
 using ozz::animation::LocalToModelJob;
+using ozz::animation::BatchLocalToModelJob;
+using ozz::animation::SparseLocalToModelJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::RawSkeleton;
 using ozz::animation::offline::SkeletonBuilder;
 
@@ -155,6 +177,38 @@ TEST(JobValidity, LocalToModel) {
     EXPECT_TRUE(job.Validate());
     EXPECT_TRUE(job.Run());
   }
+  // Both outputs specified.
+  {
+    ozz::math::Float4x3 output_4x3[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.output_4x3 = output_4x3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Invalid 4x3 output range: too small.
+  {
+    ozz::math::Float4x3 output_4x3[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output_4x3.begin = output_4x3;
+    job.output_4x3.end = output_4x3 + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Valid job with 4x3 output.
+  {
+    ozz::math::Float4x3 output_4x3[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output_4x3 = output_4x3;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
   // Valid job with empty skeleton.
   {
     LocalToModelJob job;
@@ -276,3 +330,949 @@ TEST(Transformation, LocalToModel) {
                                 0.f, 0.f, 0.f, 1.f);
   ozz::memory::default_allocator()->Delete(skeleton);
 }
+
+TEST(Unscaled, LocalToModel) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(1);
+  root.children[0].name = "j0";
+  root.children[0].transform = ozz::math::Transform::identity();
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  EXPECT_FALSE(skeleton->scaled());
+
+  // Scales are ignored by the unscaled job.
+  const ozz::math::SoaTransform input[1] = {
+    {{ozz::math::simd_float4::Load(2.f, 1.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f)},
+     {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(.70710677f, 1.f, 1.f, 1.f)},
+     {ozz::math::simd_float4::Load(3.f, 3.f, 1.f, 1.f),
+      ozz::math::simd_float4::Load(3.f, 3.f, 1.f, 1.f),
+      ozz::math::simd_float4::Load(3.f, 3.f, 1.f, 1.f)}}};
+
+  ozz::math::Float4x4 output[2];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.scaled = false;
+  job.input.begin = input;
+  job.input.end = input + 1;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+
+  EXPECT_FLOAT4x4_EQ(output[0], 0.f, 0.f, -1.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                1.f, 0.f, 0.f, 0.f,
+                                2.f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[1], 0.f, 0.f, -1.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                1.f, 0.f, 0.f, 0.f,
+                                2.f, 0.f, -1.f, 1.f);
+
+  // Scales are applied by default.
+  job.scaled = true;
+  EXPECT_TRUE(job.Run());
+  EXPECT_FLOAT4x4_EQ(output[0], 0.f, 0.f, -3.f, 0.f,
+                                0.f, 3.f, 0.f, 0.f,
+                                3.f, 0.f, 0.f, 0.f,
+                                2.f, 0.f, 0.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Compares 2 matrices for exact equality.
+bool AreEqual(const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  for (int i = 0; i < 4; ++i) {
+    if (!ozz::math::AreAllTrue(ozz::math::CmpEq(_a.cols[i], _b.cols[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compares 2 matrices within a small tolerance, as 4x3 and soa
+// multiplications aren't processed in the same order.
+bool AreNear(const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  const ozz::math::SimdFloat4 tolerance =
+    ozz::math::simd_float4::Load1(1e-4f);
+  for (int i = 0; i < 4; ++i) {
+    const ozz::math::SimdFloat4 diff = ozz::math::Abs(_a.cols[i] - _b.cols[i]);
+    if (!ozz::math::AreAllTrue(ozz::math::CmpLe(diff, tolerance))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool AreNear(const ozz::math::Float4x3& _a, const ozz::math::Float4x4& _b) {
+  return AreNear(ToFloat4x4(_a), _b);
+}
+}  // namespace
+
+TEST(PartialTransformation, LocalToModel) {
+  // Builds the skeleton
+  /*
+   6 joints, breadth-first indices
+   root(0)
+    /    \
+   j0(1)  j2(2)
+    |     /   \
+   j1(3) j3(4) j4(5)
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j2";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 6);
+
+  ozz::math::SoaTransform input[2] = {
+    {{ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 1.f),
+      ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 2.f),
+      ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 4.f)},
+     {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(1.f, .70710677f, 1.f, 1.f)},
+     {ozz::math::simd_float4::Load(1.f, 1.f, 10.f, 1.f),
+      ozz::math::simd_float4::Load(1.f, 1.f, 10.f, 1.f),
+      ozz::math::simd_float4::Load(1.f, 1.f, 10.f, 1.f)}},
+    {{ozz::math::simd_float4::Load(12.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(46.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(-12.f, 0.f, 0.f, 0.f)},
+     {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)},
+     {ozz::math::simd_float4::Load(1.f, -.1f, 1.f, 1.f),
+      ozz::math::simd_float4::Load(1.f, -.1f, 1.f, 1.f),
+      ozz::math::simd_float4::Load(1.f, -.1f, 1.f, 1.f)}}};
+
+  // Computes reference full update.
+  ozz::math::Float4x4 expected[6];
+  LocalToModelJob full;
+  full.skeleton = skeleton;
+  full.input = input;
+  full.output = expected;
+  ASSERT_TRUE(full.Run());
+
+  const ozz::math::Float4x4 sentinel =
+    ozz::math::Float4x4::Scaling(ozz::math::simd_float4::Load1(46.f));
+
+  {  // Invalid from.
+    ozz::math::Float4x4 output[6];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 6;
+    EXPECT_FALSE(job.Validate());
+    job.from = -1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid dirty range.
+    ozz::math::Float4x4 output[6];
+    const uint32_t dirty[1] = {0};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.dirty.begin = dirty;
+    job.dirty.end = dirty;
+    EXPECT_FALSE(job.Validate());
+    job.dirty = dirty;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Updates from j2 hierarchy.
+    ozz::math::Float4x4 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = i == 0 ? expected[0] : sentinel;
+    }
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 2;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(AreEqual(output[0], expected[0]));
+    EXPECT_TRUE(AreEqual(output[1], sentinel));
+    EXPECT_TRUE(AreEqual(output[2], expected[2]));
+    EXPECT_TRUE(AreEqual(output[3], sentinel));
+    EXPECT_TRUE(AreEqual(output[4], expected[4]));
+    EXPECT_TRUE(AreEqual(output[5], expected[5]));
+  }
+
+  {  // Updates up to j2.
+    ozz::math::Float4x4 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = sentinel;
+    }
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.to = 2;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(AreEqual(output[0], expected[0]));
+    EXPECT_TRUE(AreEqual(output[1], expected[1]));
+    EXPECT_TRUE(AreEqual(output[2], expected[2]));
+    EXPECT_TRUE(AreEqual(output[3], sentinel));
+    EXPECT_TRUE(AreEqual(output[4], sentinel));
+    EXPECT_TRUE(AreEqual(output[5], sentinel));
+  }
+
+  {  // Invalid lod.
+    ozz::math::Float4x4 output[6];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.num_joints_lod = -1;
+    EXPECT_FALSE(job.Validate());
+    job.num_joints_lod = 0;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Updates the first 5 joints lod, with and without from.
+    for (int f = 0; f < 2; ++f) {
+      ozz::math::Float4x4 output[6];
+      for (int i = 0; i < 6; ++i) {
+        output[i] = i == 0 ? expected[0] : sentinel;
+      }
+      LocalToModelJob job;
+      job.skeleton = skeleton;
+      job.input = input;
+      job.output = output;
+      job.num_joints_lod = 5;
+      job.from = f ? 2 : Skeleton::kNoParentIndex;
+      ASSERT_TRUE(job.Run());
+      EXPECT_TRUE(AreEqual(output[0], expected[0]));
+      EXPECT_TRUE(AreEqual(output[1], f ? sentinel : expected[1]));
+      EXPECT_TRUE(AreEqual(output[2], expected[2]));
+      EXPECT_TRUE(AreEqual(output[3], f ? sentinel : expected[3]));
+      EXPECT_TRUE(AreEqual(output[4], expected[4]));
+      EXPECT_TRUE(AreEqual(output[5], sentinel));
+    }
+  }
+
+  {  // Updates dirty j0 and j3, and their descendants.
+    ozz::math::Float4x4 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = (i == 0 || i == 2) ? expected[i] : sentinel;
+    }
+    const uint32_t dirty[1] = {(1u << 1) | (1u << 4)};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.dirty = dirty;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(AreEqual(output[0], expected[0]));
+    EXPECT_TRUE(AreEqual(output[1], expected[1]));
+    EXPECT_TRUE(AreEqual(output[2], expected[2]));
+    EXPECT_TRUE(AreEqual(output[3], expected[3]));
+    EXPECT_TRUE(AreEqual(output[4], expected[4]));
+    EXPECT_TRUE(AreEqual(output[5], sentinel));
+  }
+
+  {  // Dirty joints outside of from's hierarchy are ignored.
+    ozz::math::Float4x4 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = i == 0 ? expected[0] : sentinel;
+    }
+    const uint32_t dirty[1] = {(1u << 1) | (1u << 2)};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.dirty = dirty;
+    job.from = 2;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(AreEqual(output[1], sentinel));
+    EXPECT_TRUE(AreEqual(output[2], expected[2]));
+    EXPECT_TRUE(AreEqual(output[3], sentinel));
+    EXPECT_TRUE(AreEqual(output[4], expected[4]));
+    EXPECT_TRUE(AreEqual(output[5], expected[5]));
+  }
+
+  {  // Invalid changed range.
+    ozz::math::Float4x4 output[6];
+    const unsigned char changed[1] = {0};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.changed.begin = changed;
+    job.changed.end = changed;
+    EXPECT_FALSE(job.Validate());
+    job.changed = changed;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Updates joints of changed soa joint 1 (j3, j4) only.
+    ozz::math::Float4x4 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = i < 4 ? expected[i] : sentinel;
+    }
+    const unsigned char changed[1] = {1 << 1};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.changed = changed;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreEqual(output[i], expected[i]));
+    }
+  }
+
+  {  // Nothing changed, previous output matrices are kept.
+    ozz::math::Float4x4 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = sentinel;
+    }
+    const unsigned char changed[1] = {0};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.changed = changed;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreEqual(output[i], sentinel));
+    }
+  }
+
+  {  // Changed soa joint 0 updates all its joints and their descendants.
+    ozz::math::Float4x4 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = sentinel;
+    }
+    const unsigned char changed[1] = {1 << 0};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.changed = changed;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreEqual(output[i], expected[i]));
+    }
+  }
+
+  {  // Combines dirty j0 and changed soa joint 1.
+    ozz::math::Float4x4 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = (i == 0 || i == 2) ? expected[i] : sentinel;
+    }
+    const uint32_t dirty[1] = {1u << 1};
+    const unsigned char changed[1] = {1 << 1};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.dirty = dirty;
+    job.changed = changed;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreEqual(output[i], expected[i]));
+    }
+  }
+
+  {  // Full update to 4x3 output.
+    ozz::math::Float4x3 output[6];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output_4x3 = output;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreNear(output[i], expected[i]));
+    }
+  }
+
+  {  // Updates dirty j0 and j3 to 4x3 output, and their descendants.
+    const ozz::math::Float4x3 sentinel_4x3 =
+      ozz::math::Float4x3::FromFloat4x4(sentinel);
+    ozz::math::Float4x3 output[6];
+    for (int i = 0; i < 6; ++i) {
+      output[i] = (i == 0 || i == 2) ?
+        ozz::math::Float4x3::FromFloat4x4(expected[i]) : sentinel_4x3;
+    }
+    const uint32_t dirty[1] = {(1u << 1) | (1u << 4)};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output_4x3 = output;
+    job.dirty = dirty;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_TRUE(AreNear(output[i], expected[i]));
+    }
+    EXPECT_TRUE(AreNear(output[5], sentinel));
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Batch, LocalToModel) {
+  // Builds the skeleton
+  /*
+   6 joints, breadth-first indices
+   root(0)
+    /    \
+   j0(1)  j2(2)
+    |     /   \
+   j1(3) j3(4) j4(5)
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j2";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 6);
+
+  // Builds a different pose for every character.
+  const int kNumItems = 6;
+  ozz::math::SoaTransform inputs[kNumItems][2];
+  for (int i = 0; i < kNumItems; ++i) {
+    const float f = static_cast<float>(i);
+    const float angle = .3f * f;
+    for (int j = 0; j < 2; ++j) {
+      const ozz::math::SoaTransform transform = {
+        {ozz::math::simd_float4::Load(2.f + f, 0.f, -2.f, 1.f),
+         ozz::math::simd_float4::Load(2.f, f, -2.f, 2.f),
+         ozz::math::simd_float4::Load(2.f, 0.f, -2.f - f, 4.f)},
+        {ozz::math::simd_float4::zero(),
+         ozz::math::simd_float4::Load1(std::sin(angle * .5f)),
+         ozz::math::simd_float4::zero(),
+         ozz::math::simd_float4::Load1(std::cos(angle * .5f))},
+        {ozz::math::simd_float4::Load(1.f, 1.f + f, 10.f, 1.f),
+         ozz::math::simd_float4::Load(1.f, 1.f, 1.f + f, 1.f),
+         ozz::math::simd_float4::Load(1.f + f * .1f, 1.f, 10.f, 1.f)}};
+      inputs[i][j] = transform;
+    }
+  }
+
+  // Computes reference outputs.
+  ozz::math::Float4x4 expected[kNumItems][6];
+  for (int i = 0; i < kNumItems; ++i) {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = inputs[i];
+    job.output = expected[i];
+    ASSERT_TRUE(job.Run());
+  }
+
+  ozz::math::Float4x4 outputs[kNumItems][6];
+  BatchLocalToModelJob::Item items[kNumItems];
+  for (int i = 0; i < kNumItems; ++i) {
+    items[i].input = inputs[i];
+    items[i].output = outputs[i];
+  }
+  ozz::math::SoaFloat4x4 scratch[6];
+
+  {  // Default job.
+    BatchLocalToModelJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No scratch.
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.items = items;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Scratch too small.
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.items = items;
+    job.scratch.begin = scratch;
+    job.scratch.end = scratch + 5;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid item output.
+    BatchLocalToModelJob::Item invalid_items[2] = {items[0], items[1]};
+    invalid_items[1].output.end = invalid_items[1].output.begin + 5;
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.items = invalid_items;
+    job.scratch = scratch;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid item input.
+    BatchLocalToModelJob::Item invalid_items[2] = {items[0], items[1]};
+    invalid_items[0].input.end = invalid_items[0].input.begin + 1;
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.items = invalid_items;
+    job.scratch = scratch;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Empty batch.
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.items.begin = items;
+    job.items.end = items;
+    job.scratch = scratch;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  // Runs batches of all sizes, some of them with incomplete lane groups.
+  for (int count = 1; count <= kNumItems; ++count) {
+    for (int i = 0; i < kNumItems; ++i) {
+      for (int j = 0; j < 6; ++j) {
+        outputs[i][j] = ozz::math::Float4x4::identity();
+      }
+    }
+
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.items.begin = items;
+    job.items.end = items + count;
+    job.scratch = scratch;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kNumItems; ++i) {
+      for (int j = 0; j < 6; ++j) {
+        if (i < count) {
+          EXPECT_TRUE(AreNear(outputs[i][j], expected[i][j]));
+        } else {  // Items out of the batch aren't written.
+          EXPECT_TRUE(AreEqual(outputs[i][j],
+                               ozz::math::Float4x4::identity()));
+        }
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Sparse, LocalToModel) {
+  // Builds the skeleton
+  /*
+   6 joints, breadth-first indices
+   root(0)
+    /    \
+   j0(1)  j2(2)
+    |     /   \
+   j1(3) j3(4) j4(5)
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j2";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 6);
+
+  const ozz::math::SoaTransform transform = {
+    {ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 1.f),
+     ozz::math::simd_float4::Load(2.f, 1.f, -2.f, 2.f),
+     ozz::math::simd_float4::Load(2.f, 0.f, -3.f, 4.f)},
+    {ozz::math::simd_float4::zero(),
+     ozz::math::simd_float4::Load1(std::sin(.3f)),
+     ozz::math::simd_float4::zero(),
+     ozz::math::simd_float4::Load1(std::cos(.3f))},
+    {ozz::math::simd_float4::Load(1.f, 2.f, 10.f, 1.f),
+     ozz::math::simd_float4::Load(1.f, 1.f, 3.f, 1.f),
+     ozz::math::simd_float4::Load(1.5f, 1.f, 10.f, 1.f)}};
+  const ozz::math::SoaTransform input[2] = {transform, transform};
+
+  // Computes reference outputs.
+  ozz::math::Float4x4 expected[6];
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = expected;
+    ASSERT_TRUE(job.Run());
+  }
+
+  // j3 and j4 evaluation list.
+  const uint16_t joints[] = {0, 2, 4, 5};
+
+  ozz::math::Float4x4 output[6];
+  ozz::math::Float4x3 output_4x3[6];
+
+  {  // Default job.
+    SparseLocalToModelJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No output.
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = joints;
+    job.input = input;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Both outputs.
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = joints;
+    job.input = input;
+    job.output = output;
+    job.output_4x3 = output_4x3;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Input too small.
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = joints;
+    job.input.begin = input;
+    job.input.end = input + 1;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Output too small.
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = joints;
+    job.input = input;
+    job.output.begin = output;
+    job.output.end = output + 5;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Unsorted list.
+    const uint16_t unsorted[] = {0, 4, 2};
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = unsorted;
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Duplicated joint.
+    const uint16_t duplicated[] = {0, 2, 2};
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = duplicated;
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid joint.
+    const uint16_t invalid[] = {0, 2, 6};
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = invalid;
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Empty list.
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job.
+    for (int i = 0; i < 6; ++i) {
+      output[i] = ozz::math::Float4x4::identity();
+    }
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = joints;
+    job.input = input;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    // Listed joints are computed, others are left unchanged.
+    EXPECT_TRUE(AreNear(output[0], expected[0]));
+    EXPECT_TRUE(AreEqual(output[1], ozz::math::Float4x4::identity()));
+    EXPECT_TRUE(AreNear(output[2], expected[2]));
+    EXPECT_TRUE(AreEqual(output[3], ozz::math::Float4x4::identity()));
+    EXPECT_TRUE(AreNear(output[4], expected[4]));
+    EXPECT_TRUE(AreNear(output[5], expected[5]));
+  }
+
+  {  // Valid job, 4x3 output.
+    SparseLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.joints = joints;
+    job.input = input;
+    job.output_4x3 = output_4x3;
+    ASSERT_TRUE(job.Run());
+
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(joints); ++i) {
+      EXPECT_TRUE(AreNear(output_4x3[joints[i]], expected[joints[i]]));
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Stats, LocalToModel) {
+  // Counters are only updated if stats are enabled.
+#ifdef OZZ_HAS_STATS
+  const int enabled = 1;
+#else  // OZZ_HAS_STATS
+  const int enabled = 0;
+#endif  // OZZ_HAS_STATS
+
+  // Builds a 6 joints skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].name = "j2";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::Float4x4 output[6];
+  LocalToModelJob::Stats stats;
+  EXPECT_EQ(stats.joints, 0);
+  EXPECT_EQ(stats.soa_conversions, 0);
+  EXPECT_EQ(stats.partial_runs, 0);
+
+  LocalToModelJob job;
+  EXPECT_TRUE(job.stats == NULL);
+  job.skeleton = skeleton;
+  job.input = skeleton->bind_pose();
+  job.output.begin = output;
+  job.output.end = output + 6;
+  job.stats = &stats;
+
+  // Full update.
+  EXPECT_TRUE(job.Run());
+  EXPECT_EQ(stats.joints, 6 * enabled);
+  EXPECT_EQ(stats.soa_conversions, 2 * enabled);
+  EXPECT_EQ(stats.partial_runs, 0);
+
+  // Partial update of j2 hierarchy, which is accumulated.
+  for (int i = 0; i < skeleton->num_joints(); ++i) {
+    if (std::strcmp(skeleton->joint_names()[i], "j2") == 0) {
+      job.from = i;
+    }
+  }
+  ASSERT_NE(job.from, Skeleton::kNoParentIndex);
+  EXPECT_TRUE(job.Run());
+  EXPECT_EQ(stats.joints, 9 * enabled);
+  EXPECT_EQ(stats.soa_conversions, 4 * enabled);
+  EXPECT_EQ(stats.partial_runs, 1 * enabled);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Builds an animation of _num_tracks tracks, whose joints are all translated
+// by _translation.
+Animation* BuildTranslationAnimation(int _num_tracks,
+                                     const ozz::math::Float3& _translation) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    const RawAnimation::TranslationKey key = {0.f, _translation};
+    raw_animation.tracks[i].translations.push_back(key);
+  }
+  return AnimationBuilder()(raw_animation);
+}
+}  // namespace
+
+TEST(MoreThan1023Joints, LocalToModel) {
+  // Builds 2 chains of 750 joints, whose joints are interleaved by the
+  // breadth-first order of the skeleton. Parents of half the joints are thus
+  // above the former 1023 joints limit.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  for (int c = 0; c < 2; ++c) {
+    RawSkeleton::Joint* joint = &raw_skeleton.roots[c];
+    for (int i = 0; i < 750; ++i) {
+      char name[16];
+      std::sprintf(name, "j%d_%d", c, i);
+      joint->name = name;
+      joint->transform = ozz::math::Transform::identity();
+      if (i != 749) {
+        joint->children.resize(1);
+        joint = &joint->children[0];
+      }
+    }
+  }
+  ASSERT_EQ(raw_skeleton.num_joints(), 1500);
+
+  // Serializes the skeleton, so that parent indices are also stored and loaded
+  // to and from an archive.
+  Skeleton* o_skeleton = SkeletonBuilder()(raw_skeleton);
+  ASSERT_TRUE(o_skeleton != NULL);
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *o_skeleton;
+  ozz::memory::default_allocator()->Delete(o_skeleton);
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  Skeleton skeleton;
+  i >> skeleton;
+  const int num_joints = skeleton.num_joints();
+  const int num_soa_joints = skeleton.num_soa_joints();
+  ASSERT_EQ(num_joints, 1500);
+
+  // The last joint is the deepest of the second chain.
+  const int deep = num_joints - 1;
+  ozz::Range<const Skeleton::JointProperties> properties =
+    skeleton.joint_properties();
+  int depth = 0;
+  for (int joint = deep;
+       joint != Skeleton::kNoParentIndex;
+       joint = properties.begin[joint].parent) {
+    ASSERT_LT(joint, num_joints);
+    ++depth;
+  }
+  EXPECT_EQ(depth, 750);
+
+  // Blends 2 sampled animations, translating every joint by (.25, 1.5, 0).
+  Animation* animations[2] = {
+    BuildTranslationAnimation(num_joints, ozz::math::Float3(1.f, 0.f, 0.f)),
+    BuildTranslationAnimation(num_joints, ozz::math::Float3(0.f, 2.f, 0.f))};
+  ASSERT_TRUE(animations[0] != NULL && animations[1] != NULL);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  ozz::math::SoaTransform* sampled[2] = {
+    allocator->Allocate<ozz::math::SoaTransform>(num_soa_joints),
+    allocator->Allocate<ozz::math::SoaTransform>(num_soa_joints)};
+  ozz::math::SoaTransform* locals =
+    allocator->Allocate<ozz::math::SoaTransform>(num_soa_joints);
+  ozz::math::Float4x4* models =
+    allocator->Allocate<ozz::math::Float4x4>(num_joints);
+
+  SamplingCache cache(num_joints);
+  BlendingJob::Layer layers[2];
+  for (int a = 0; a < 2; ++a) {
+    cache.Invalidate();
+    SamplingJob sampling_job;
+    sampling_job.animation = animations[a];
+    sampling_job.cache = &cache;
+    sampling_job.time = 0.f;
+    sampling_job.output.begin = sampled[a];
+    sampling_job.output.end = sampled[a] + num_soa_joints;
+    ASSERT_TRUE(sampling_job.Run());
+    layers[a].transform.begin = sampled[a];
+    layers[a].transform.end = sampled[a] + num_soa_joints;
+  }
+  layers[0].weight = .25f;
+  layers[1].weight = .75f;
+
+  // Temporary buffers of the jobs are allocated from an arena.
+  ozz::memory::ArenaAllocator arena;
+
+  BlendingJob blending_job;
+  blending_job.layers.begin = layers;
+  blending_job.layers.end = layers + 2;
+  blending_job.bind_pose = skeleton.bind_pose();
+  blending_job.output.begin = locals;
+  blending_job.output.end = locals + num_soa_joints;
+  blending_job.scratch_allocator = &arena;
+  ASSERT_TRUE(blending_job.Run());
+
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = &skeleton;
+  ltm_job.input.begin = locals;
+  ltm_job.input.end = locals + num_soa_joints;
+  ltm_job.output.begin = models;
+  ltm_job.output.end = models + num_joints;
+  ltm_job.scratch_allocator = &arena;
+  ASSERT_TRUE(ltm_job.Run());
+
+  float translation[4];
+  ozz::math::StorePtrU(models[deep].cols[3], translation);
+  EXPECT_NEAR(translation[0], depth * .25f, 1e-2f);
+  EXPECT_NEAR(translation[1], depth * 1.5f, 1e-2f);
+  EXPECT_NEAR(translation[2], 0.f, 1e-2f);
+
+  // Updates again the last 100 joints of the second chain only, from a joint
+  // above the former limit.
+  int from = deep;
+  for (int j = 0; j < 100; ++j) {
+    from = properties.begin[from].parent;
+  }
+  ASSERT_GT(from, 1023);
+  for (int joint = from + 1; joint < num_joints; ++joint) {
+    models[joint] = ozz::math::Float4x4::identity();
+  }
+  ltm_job.from = from;
+  ASSERT_TRUE(ltm_job.Run());
+
+  ozz::math::StorePtrU(models[deep].cols[3], translation);
+  EXPECT_NEAR(translation[0], depth * .25f, 1e-2f);
+  EXPECT_NEAR(translation[1], depth * 1.5f, 1e-2f);
+  EXPECT_NEAR(translation[2], 0.f, 1e-2f);
+
+  allocator->Deallocate(models);
+  allocator->Deallocate(locals);
+  allocator->Deallocate(sampled[1]);
+  allocator->Deallocate(sampled[0]);
+  allocator->Delete(animations[1]);
+  allocator->Delete(animations[0]);
+}
@@ -0,0 +1,328 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_space_blending_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::LocalToModelJob;
+using ozz::animation::ModelSpaceBlendingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 6 joints skeleton:
+/*
+ root(0)
+  /    \
+ j0(1)  j2(2)
+  |     /   \
+ j1(3) j3(4) j4(5)
+*/
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j2";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  // Bind pose is identity.
+  const ozz::math::Transform identity = ozz::math::Transform::identity();
+  root.transform = identity;
+  root.children[0].transform = identity;
+  root.children[1].transform = identity;
+  root.children[0].children[0].transform = identity;
+  root.children[1].children[0].transform = identity;
+  root.children[1].children[1].transform = identity;
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Compares 2 matrices within a small tolerance.
+bool AreNear(const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  const ozz::math::SimdFloat4 tolerance =
+    ozz::math::simd_float4::Load1(1e-4f);
+  for (int i = 0; i < 4; ++i) {
+    const ozz::math::SimdFloat4 diff = ozz::math::Abs(_a.cols[i] - _b.cols[i]);
+    if (!ozz::math::AreAllTrue(ozz::math::CmpLe(diff, tolerance))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Computes _skeleton model-space matrices of _locals pose.
+void ToModels(const Skeleton& _skeleton,
+              const ozz::math::SoaTransform* _locals,
+              ozz::math::Float4x4* _models) {
+  LocalToModelJob job;
+  job.skeleton = &_skeleton;
+  job.input.begin = _locals;
+  job.input.end = _locals + 2;
+  job.output.begin = _models;
+  job.output.end = _models + 6;
+  ASSERT_TRUE(job.Run());
+}
+
+// Local transforms of the first layer.
+const ozz::math::SoaTransform kInput0[2] = {
+  {{ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 1.f),
+    ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 2.f),
+    ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 4.f)},
+   {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, .5f),
+    ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .5f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .6f, .5f),
+    ozz::math::simd_float4::Load(1.f, .70710677f, .8f, .5f)},
+   {ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)}},
+  {{ozz::math::simd_float4::Load(12.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(46.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(-12.f, 0.f, 0.f, 0.f)},
+   {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)},
+   {ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)}}};
+
+// Local transforms of the second layer, whose hierarchy is rotated
+// differently, with a uniform scale.
+const ozz::math::SoaTransform kInput1[2] = {
+  {{ozz::math::simd_float4::Load(1.f, 1.f, -1.f, 3.f),
+    ozz::math::simd_float4::Load(0.f, 2.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 2.f, 1.f)},
+   {ozz::math::simd_float4::Load(0.f, .6f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(.6f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+    ozz::math::simd_float4::Load(.8f, .8f, .70710677f, 1.f)},
+   {ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 1.f)}},
+  {{ozz::math::simd_float4::Load(6.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(-4.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(3.f, 0.f, 0.f, 0.f)},
+   {ozz::math::simd_float4::Load(.6f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(.8f, 1.f, 1.f, 1.f)},
+   {ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)}}};
+}  // namespace
+
+TEST(JobValidity, ModelSpaceBlendingJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ModelSpaceBlendingJob::Layer layers[2];
+  layers[0].transform = kInput0;
+  layers[1].transform = kInput1;
+  ozz::math::SimdFloat4 scratch[3 * 3 * 6];
+  ozz::math::SoaTransform output[2];
+  ozz::math::Float4x4 models[6];
+  EXPECT_EQ(ModelSpaceBlendingJob::scratch_size(2, 6),
+            OZZ_ARRAY_SIZE(scratch));
+
+  {  // Default job.
+    ModelSpaceBlendingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  ModelSpaceBlendingJob valid;
+  valid.skeleton = skeleton;
+  valid.layers = layers;
+  valid.scratch = scratch;
+  valid.output = output;
+  EXPECT_TRUE(valid.Validate());
+
+  {  // Optional models.
+    ModelSpaceBlendingJob job = valid;
+    job.models = models;
+    EXPECT_TRUE(job.Validate());
+    job.models.end = models + 5;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Scratch too small.
+    ModelSpaceBlendingJob job = valid;
+    job.scratch.end = scratch + 3 * 3 * 6 - 1;
+    EXPECT_FALSE(job.Validate());
+    job.layers.end = layers + 1;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Output too small.
+    ModelSpaceBlendingJob job = valid;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid threshold.
+    ModelSpaceBlendingJob job = valid;
+    job.threshold = 0.f;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid layers.
+    ModelSpaceBlendingJob::Layer invalid_layers[2] = {layers[0], layers[1]};
+    ModelSpaceBlendingJob job = valid;
+    job.layers = invalid_layers;
+    invalid_layers[1].transform.end = kInput1 + 1;
+    EXPECT_FALSE(job.Validate());
+    invalid_layers[1].transform = kInput1;
+    const ozz::math::SimdFloat4 joint_weights[1] = {
+      ozz::math::simd_float4::one()};
+    invalid_layers[1].joint_weights = joint_weights;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Blend, ModelSpaceBlendingJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::Float4x4 models0[6];
+  ozz::math::Float4x4 models1[6];
+  ToModels(*skeleton, kInput0, models0);
+  ToModels(*skeleton, kInput1, models1);
+
+  ModelSpaceBlendingJob::Layer layers[2];
+  layers[0].transform = kInput0;
+  layers[1].transform = kInput1;
+  ozz::math::SimdFloat4 scratch[3 * 3 * 6];
+  ozz::math::SoaTransform output[2];
+  ozz::math::Float4x4 models[6];
+  ozz::math::Float4x4 output_models[6];
+
+  ModelSpaceBlendingJob job;
+  job.skeleton = skeleton;
+  job.layers = layers;
+  job.scratch = scratch;
+  job.output = output;
+  job.models = models;
+
+  {  // A single layer outputs its own pose.
+    layers[0].weight = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 2.f, 0.f, -2.f, 1.f,
+                                                   2.f, 0.f, -2.f, 2.f,
+                                                   2.f, 0.f, -2.f, 4.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                                0.f, 0.f, 0.f, .5f,
+                                0.f, .70710677f, 0.f, .5f,
+                                0.f, 0.f, .6f, .5f,
+                                1.f, .70710677f, .8f, .5f);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreNear(models[i], models0[i])) << "joint " << i;
+    }
+  }
+
+  {  // Joints translations are blended in model-space.
+    layers[0].weight = .5f;
+    layers[1].weight = .5f;
+    ASSERT_TRUE(job.Run());
+    ToModels(*skeleton, output, output_models);
+    const ozz::math::SimdFloat4 half = ozz::math::simd_float4::Load1(.5f);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreNear(models[i], output_models[i])) << "joint " << i;
+      const ozz::math::SimdFloat4 average =
+        (models0[i].cols[3] + models1[i].cols[3]) * half;
+      EXPECT_SIMDFLOAT_EQ_EST(models[i].cols[3],
+                              ozz::math::GetX(average),
+                              ozz::math::GetY(average),
+                              ozz::math::GetZ(average), 1.f);
+    }
+  }
+
+  {  // Per joint weights select a layer per joint.
+    const ozz::math::SimdFloat4 joint_weights0[2] = {
+      ozz::math::simd_float4::Load(1.f, 0.f, 1.f, 0.f),
+      ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)};
+    const ozz::math::SimdFloat4 joint_weights1[2] = {
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 1.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f)};
+    layers[0].weight = 1.f;
+    layers[0].joint_weights = joint_weights0;
+    layers[1].weight = 1.f;
+    layers[1].joint_weights = joint_weights1;
+    ASSERT_TRUE(job.Run());
+    ToModels(*skeleton, output, output_models);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreNear(models[i], output_models[i])) << "joint " << i;
+    }
+
+    // Model-space transforms of j0 and j1 are the ones of the second layer,
+    // whatever the blended hierarchy.
+    EXPECT_TRUE(AreNear(models[0], models0[0]));
+    EXPECT_TRUE(AreNear(models[1], models1[1]));
+    EXPECT_TRUE(AreNear(models[3], models1[3]));
+    layers[0].joint_weights = ozz::Range<const ozz::math::SimdFloat4>();
+    layers[1].joint_weights = ozz::Range<const ozz::math::SimdFloat4>();
+  }
+
+  {  // Falls back to the bind pose.
+    layers[0].weight = 0.f;
+    layers[1].weight = 0.f;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_SOAFLOAT3_EQ_EST(output[i].translation, 0.f, 0.f, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f);
+      EXPECT_SOAQUATERNION_EQ_EST(output[i].rotation, 0.f, 0.f, 0.f, 0.f,
+                                                      0.f, 0.f, 0.f, 0.f,
+                                                      0.f, 0.f, 0.f, 0.f,
+                                                      1.f, 1.f, 1.f, 1.f);
+      EXPECT_SOAFLOAT3_EQ_EST(output[i].scale, 1.f, 1.f, 1.f, 1.f,
+                                               1.f, 1.f, 1.f, 1.f,
+                                               1.f, 1.f, 1.f, 1.f);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,261 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_space_clip_sampling_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_float4x3.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/model_space_clip_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/model_space_clip.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::ModelSpaceClip;
+using ozz::animation::ModelSpaceClipSamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::ModelSpaceClipBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 1s clip of a root and a child, baked at 2 frames per second. The
+// root moves from 0 to 4 along x, the child is 1 above the root and moves
+// from 0 to -2 along z.
+ModelSpaceClip* BuildClip() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "child";
+  Skeleton* skeleton = SkeletonBuilder()(raw_skeleton);
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey root_keys[] = {
+    {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+    {1.f, ozz::math::Float3(4.f, 0.f, 0.f)}};
+  const RawAnimation::TranslationKey child_keys[] = {
+    {0.f, ozz::math::Float3(0.f, 1.f, 0.f)},
+    {1.f, ozz::math::Float3(0.f, 1.f, -2.f)}};
+  for (int i = 0; i < 2; ++i) {
+    raw_animation.tracks[0].translations.push_back(root_keys[i]);
+    raw_animation.tracks[1].translations.push_back(child_keys[i]);
+  }
+  Animation* animation = AnimationBuilder()(raw_animation);
+
+  ModelSpaceClipBuilder builder;
+  builder.sampling_rate = 2.f;
+  ModelSpaceClip* clip = builder(*animation, *skeleton);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+  return clip;
+}
+}  // namespace
+
+TEST(JobValidity, ModelSpaceClipSamplingJob) {
+  ModelSpaceClip* clip = BuildClip();
+  ASSERT_TRUE(clip != NULL);
+  ModelSpaceClip empty;
+  ozz::math::Float4x4 output[2];
+  ozz::math::Float4x3 output_4x3[2];
+
+  { // Empty/default job.
+    ModelSpaceClipSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  { // Empty clip.
+    ModelSpaceClipSamplingJob job;
+    job.clip = &empty;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // No output.
+    ModelSpaceClipSamplingJob job;
+    job.clip = clip;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Both outputs.
+    ModelSpaceClipSamplingJob job;
+    job.clip = clip;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    job.output_4x3.begin = output_4x3;
+    job.output_4x3.end = output_4x3 + 2;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Output too small.
+    ModelSpaceClipSamplingJob job;
+    job.clip = clip;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Valid 4x4 output.
+    ModelSpaceClipSamplingJob job;
+    job.clip = clip;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  { // Valid 4x3 output.
+    ModelSpaceClipSamplingJob job;
+    job.clip = clip;
+    job.output_4x3.begin = output_4x3;
+    job.output_4x3.end = output_4x3 + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(clip);
+}
+
+TEST(Sample, ModelSpaceClipSamplingJob) {
+  ModelSpaceClip* clip = BuildClip();
+  ASSERT_TRUE(clip != NULL);
+  ASSERT_EQ(clip->num_frames(), 3);
+
+  ozz::math::Float4x4 output[2];
+  ozz::math::Float4x3 output_4x3[2];
+  ModelSpaceClipSamplingJob job;
+  job.clip = clip;
+  job.output_4x3.begin = output_4x3;
+  job.output_4x3.end = output_4x3 + 2;
+
+  // Translations are quantized by the animation compression.
+
+  // Before the beginning.
+  job.time = -1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[0].rows[0], 1.f, 0.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[1].rows[1], 0.f, 1.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[1].rows[2], 0.f, 0.f, 1.f, 0.f);
+
+  // Between frames.
+  job.time = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[0].rows[0], 1.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[1].rows[0], 1.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[1].rows[2], 0.f, 0.f, 1.f, -.5f);
+
+  // On a frame.
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[0].rows[0], 1.f, 0.f, 0.f, 2.f);
+
+  // Last frame, and after the end.
+  job.time = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[1].rows[0], 1.f, 0.f, 0.f, 4.f);
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[1].rows[2], 0.f, 0.f, 1.f, -2.f);
+  job.time = 2.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SIMDFLOAT_EQ_EST(output_4x3[1].rows[0], 1.f, 0.f, 0.f, 4.f);
+
+  // 4x4 output.
+  job.output_4x3.begin = NULL;
+  job.output_4x3.end = NULL;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  job.time = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SIMDFLOAT_EQ_EST(output[1].cols[0], 1.f, 0.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ_EST(output[1].cols[1], 0.f, 1.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ_EST(output[1].cols[2], 0.f, 0.f, 1.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ_EST(output[1].cols[3], 3.f, 1.f, -1.5f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(clip);
+}
+
+TEST(Serialize, ModelSpaceClipSamplingJob) {
+  ModelSpaceClip* o_clip = BuildClip();
+  ASSERT_TRUE(o_clip != NULL);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_clip;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    ModelSpaceClip i_clip;
+    i >> i_clip;
+
+    // Compares clips.
+    EXPECT_FLOAT_EQ(i_clip.duration(), o_clip->duration());
+    EXPECT_FLOAT_EQ(i_clip.frame_rate(), o_clip->frame_rate());
+    ASSERT_EQ(i_clip.num_joints(), o_clip->num_joints());
+    ASSERT_EQ(i_clip.num_frames(), o_clip->num_frames());
+    for (int f = 0; f < i_clip.num_frames(); ++f) {
+      for (int j = 0; j < i_clip.num_joints(); ++j) {
+        for (int r = 0; r < 3; ++r) {
+          const ozz::math::SimdFloat4 o_row =
+            o_clip->frame(f).begin[j].rows[r];
+          EXPECT_SIMDFLOAT_EQ(i_clip.frame(f).begin[j].rows[r],
+                              ozz::math::GetX(o_row),
+                              ozz::math::GetY(o_row),
+                              ozz::math::GetZ(o_row),
+                              ozz::math::GetW(o_row));
+        }
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(o_clip);
+}
@@ -0,0 +1,337 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_to_local_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Skeleton;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::ModelToLocalJob;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 6 joints skeleton:
+/*
+ root(0)
+  /    \
+ j0(1)  j2(2)
+  |     /   \
+ j1(3) j3(4) j4(5)
+*/
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j2";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Compares 2 matrices within a small tolerance.
+bool AreNear(const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  const ozz::math::SimdFloat4 tolerance =
+    ozz::math::simd_float4::Load1(1e-4f);
+  for (int i = 0; i < 4; ++i) {
+    const ozz::math::SimdFloat4 diff = ozz::math::Abs(_a.cols[i] - _b.cols[i]);
+    if (!ozz::math::AreAllTrue(ozz::math::CmpLe(diff, tolerance))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Local transforms used as tests input. Rotations all have a positive w, so
+// they can be compared with decomposed ones.
+const ozz::math::SoaTransform kInput[2] = {
+  {{ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 1.f),
+    ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 2.f),
+    ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 4.f)},
+   {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, .5f),
+    ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .5f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .6f, .5f),
+    ozz::math::simd_float4::Load(1.f, .70710677f, .8f, .5f)},
+   {ozz::math::simd_float4::Load(1.f, 1.f, 10.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 10.f, 2.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 10.f, 3.f)}},
+  {{ozz::math::simd_float4::Load(12.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(46.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(-12.f, 0.f, 0.f, 0.f)},
+   {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)},
+   {ozz::math::simd_float4::Load(1.f, .1f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, .1f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, .1f, 1.f, 1.f)}}};
+}  // namespace
+
+TEST(JobValidity, ModelToLocal) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::Float4x4 input[6];
+  for (int i = 0; i < 6; ++i) {
+    input[i] = ozz::math::Float4x4::identity();
+  }
+  ozz::math::SoaTransform output[2];
+
+  {  // Default job.
+    ModelToLocalJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // NULL output.
+    ModelToLocalJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // NULL input.
+    ModelToLocalJob job;
+    job.skeleton = skeleton;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Input too small.
+    ModelToLocalJob job;
+    job.skeleton = skeleton;
+    job.input.begin = input;
+    job.input.end = input + 5;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Output too small.
+    ModelToLocalJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid from.
+    ModelToLocalJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 6;
+    EXPECT_FALSE(job.Validate());
+    job.from = -1;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid to.
+    ModelToLocalJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 3;
+    job.to = 2;
+    EXPECT_FALSE(job.Validate());
+    job.to = 3;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Valid job.
+    ModelToLocalJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Transformation, ModelToLocal) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Computes model-space matrices.
+  ozz::math::Float4x4 models[6];
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton;
+  ltm_job.input = kInput;
+  ltm_job.output = models;
+  ASSERT_TRUE(ltm_job.Run());
+
+  // Converts back to local-space.
+  ozz::math::SoaTransform output[2];
+  ModelToLocalJob job;
+  job.skeleton = skeleton;
+  job.input = models;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                          2.f, 0.f, -2.f, 1.f,
+                          2.f, 0.f, -2.f, 2.f,
+                          2.f, 0.f, -2.f, 4.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                              0.f, 0.f, 0.f, .5f,
+                              0.f, .70710677f, 0.f, .5f,
+                              0.f, 0.f, .6f, .5f,
+                              1.f, .70710677f, .8f, .5f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale,
+                          1.f, 1.f, 10.f, 1.f,
+                          1.f, 1.f, 10.f, 2.f,
+                          1.f, 1.f, 10.f, 3.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation,
+                          12.f, 0.f, 0.f, 0.f,
+                          46.f, 0.f, 0.f, 0.f,
+                          -12.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].scale,
+                          1.f, .1f, 1.f, 1.f,
+                          1.f, .1f, 1.f, 1.f,
+                          1.f, .1f, 1.f, 1.f);
+
+  // Round trip to model-space.
+  ozz::math::Float4x4 round_trip[6];
+  ltm_job.input = output;
+  ltm_job.output = round_trip;
+  ASSERT_TRUE(ltm_job.Run());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(AreNear(round_trip[i], models[i]));
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(PartialTransformation, ModelToLocal) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::Float4x4 models[6];
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton;
+  ltm_job.input = kInput;
+  ltm_job.output = models;
+  ASSERT_TRUE(ltm_job.Run());
+
+  // Updates joints 2 to 4, crossing soa elements boundary.
+  ozz::math::SoaTransform output[2] = {ozz::math::SoaTransform::identity(),
+                                       ozz::math::SoaTransform::identity()};
+  ModelToLocalJob job;
+  job.skeleton = skeleton;
+  job.input = models;
+  job.output = output;
+  job.from = 2;
+  job.to = 4;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                          0.f, 0.f, -2.f, 1.f,
+                          0.f, 0.f, -2.f, 2.f,
+                          0.f, 0.f, -2.f, 4.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                              0.f, 0.f, 0.f, .5f,
+                              0.f, 0.f, 0.f, .5f,
+                              0.f, 0.f, .6f, .5f,
+                              1.f, 1.f, .8f, .5f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale,
+                          1.f, 1.f, 10.f, 1.f,
+                          1.f, 1.f, 10.f, 2.f,
+                          1.f, 1.f, 10.f, 3.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation,
+                          12.f, 0.f, 0.f, 0.f,
+                          46.f, 0.f, 0.f, 0.f,
+                          -12.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[1].rotation,
+                              0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f,
+                              1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].scale,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Degenerated, ModelToLocal) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Joint 3 is scaled to 0 on 2 axes, which can't be decomposed.
+  ozz::math::Float4x4 models[6];
+  for (int i = 0; i < 6; ++i) {
+    models[i] = ozz::math::Float4x4::identity();
+  }
+  models[3] = ozz::math::Float4x4::Translation(
+    ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)) *
+    ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(0.f, 0.f, 1.f, 0.f));
+
+  ozz::math::SoaTransform output[2];
+  ModelToLocalJob job;
+  job.skeleton = skeleton;
+  job.input = models;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                          0.f, 0.f, 0.f, 1.f,
+                          0.f, 0.f, 0.f, 2.f,
+                          0.f, 0.f, 0.f, 3.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                              0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f,
+                              1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale,
+                          1.f, 1.f, 1.f, 0.f,
+                          1.f, 1.f, 1.f, 0.f,
+                          1.f, 1.f, 1.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
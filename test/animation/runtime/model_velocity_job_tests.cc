@@ -0,0 +1,263 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/model_velocity_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::ModelVelocityJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::SoaJointVelocity;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 6 joints skeleton:
+/*
+ root(0)
+  /    \
+ j0(1)  j2(2)
+  |     /   \
+ j1(3) j3(4) j4(5)
+*/
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j2";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds a 6 tracks animation, with constant uniform scales.
+Animation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(6);
+  for (int i = 0; i < 6; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 3; ++k) {
+      const float time = static_cast<float>(k);
+      const float value = static_cast<float>((k * (i + 2)) % 5);
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(1.f + value * .2f, i * .3f, -value * .1f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time,
+        ozz::math::Quaternion::FromAxisAngle(ozz::math::Float4(
+          Normalize(ozz::math::Float3(i * .2f, 1.f, value)), value * .3f))};
+      track.rotations.push_back(rkey);
+    }
+    const RawAnimation::ScaleKey skey = {
+      0.f, ozz::math::Float3(1.f + i * .1f)};
+    track.scales.push_back(skey);
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Samples _animation at _time and computes model-space matrices. Local-space
+// velocities are output if _velocities isn't NULL.
+void SampleModels(const Skeleton& _skeleton, const Animation& _animation,
+                  float _time, SamplingCache* _cache,
+                  ozz::math::Float4x4* _models,
+                  SoaJointVelocity* _velocities) {
+  ozz::math::SoaTransform locals[2];
+  SamplingJob sampling_job;
+  sampling_job.animation = &_animation;
+  sampling_job.cache = _cache;
+  sampling_job.time = _time;
+  sampling_job.output.begin = locals;
+  sampling_job.output.end = locals + 2;
+  if (_velocities) {
+    sampling_job.velocities.begin = _velocities;
+    sampling_job.velocities.end = _velocities + 2;
+  }
+  ASSERT_TRUE(sampling_job.Run());
+
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = &_skeleton;
+  ltm_job.input.begin = locals;
+  ltm_job.input.end = locals + 2;
+  ltm_job.output.begin = _models;
+  ltm_job.output.end = _models + 6;
+  ASSERT_TRUE(ltm_job.Run());
+}
+
+// Expects _a and _b xyz components to be near.
+void ExpectNear(ozz::math::SimdFloat4 _a, ozz::math::SimdFloat4 _b,
+                float _tolerance) {
+  float a[4];
+  float b[4];
+  ozz::math::StorePtrU(_a, a);
+  ozz::math::StorePtrU(_b, b);
+  for (int c = 0; c < 3; ++c) {
+    EXPECT_NEAR(a[c], b[c], _tolerance) << "component " << c;
+  }
+}
+}  // namespace
+
+TEST(JobValidity, ModelVelocityJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  SoaJointVelocity velocities[2];
+  ozz::math::Float4x4 models[6];
+  ozz::math::SimdFloat4 linear[6];
+  ozz::math::SimdFloat4 angular[6];
+
+  {  // Default job.
+    ModelVelocityJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  ModelVelocityJob valid_job;
+  valid_job.skeleton = skeleton;
+  valid_job.velocities.begin = velocities;
+  valid_job.velocities.end = velocities + 2;
+  valid_job.models.begin = models;
+  valid_job.models.end = models + 6;
+  valid_job.linear.begin = linear;
+  valid_job.linear.end = linear + 6;
+  valid_job.angular.begin = angular;
+  valid_job.angular.end = angular + 6;
+  EXPECT_TRUE(valid_job.Validate());
+
+  {  // No skeleton.
+    ModelVelocityJob job = valid_job;
+    job.skeleton = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Velocities too small.
+    ModelVelocityJob job = valid_job;
+    job.velocities.end = velocities + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Models too small.
+    ModelVelocityJob job = valid_job;
+    job.models.end = models + 5;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Linear output too small.
+    ModelVelocityJob job = valid_job;
+    job.linear.end = linear + 5;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Angular output too small.
+    ModelVelocityJob job = valid_job;
+    job.angular.begin = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(FiniteDifferences, ModelVelocityJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(6);
+  SoaJointVelocity velocities[2];
+  ozz::math::Float4x4 models[6];
+  ozz::math::Float4x4 models0[6];
+  ozz::math::Float4x4 models1[6];
+  ozz::math::SimdFloat4 linear[6];
+  ozz::math::SimdFloat4 angular[6];
+
+  ModelVelocityJob job;
+  job.skeleton = skeleton;
+  job.velocities.begin = velocities;
+  job.velocities.end = velocities + 2;
+  job.models.begin = models;
+  job.models.end = models + 6;
+  job.linear.begin = linear;
+  job.linear.end = linear + 6;
+  job.angular.begin = angular;
+  job.angular.end = angular + 6;
+
+  const float times[] = {.3f, .6f, 1.4f, 1.9f};
+  const float h = 1e-3f;
+  const ozz::math::SimdFloat4 inv_2h = ozz::math::simd_float4::Load1(.5f / h);
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(times); ++t) {
+    SampleModels(*skeleton, *animation, times[t] - h, &cache, models0, NULL);
+    SampleModels(*skeleton, *animation, times[t] + h, &cache, models1, NULL);
+    SampleModels(*skeleton, *animation, times[t], &cache, models, velocities);
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < 6; ++i) {
+      // Linear velocity is the derivative of joint origin.
+      ExpectNear(linear[i], (models1[i].cols[3] - models0[i].cols[3]) * inv_2h,
+                 2e-2f);
+
+      // Normalized axes derivatives are angular velocity cross axes.
+      for (int c = 0; c < 3; ++c) {
+        const ozz::math::SimdFloat4 axis =
+          ozz::math::Normalize3(models[i].cols[c]);
+        const ozz::math::SimdFloat4 derivative =
+          (ozz::math::Normalize3(models1[i].cols[c]) -
+           ozz::math::Normalize3(models0[i].cols[c])) * inv_2h;
+        ExpectNear(ozz::math::Cross3(angular[i], axis), derivative, 2e-2f);
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,310 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/motion_search_job.h"
+
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/motion_database.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/motion_database_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::MotionDatabase;
+using ozz::animation::MotionSearchJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::MotionDatabaseBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton of 2 joints, a root and its child.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(1);
+  root.children[0].name = "child";
+  root.children[0].transform = ozz::math::Transform::identity();
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Gets a pseudo random value in range [-1,1].
+float Random() {
+  return std::rand() * 2.f / RAND_MAX - 1.f;
+}
+
+// Builds a 10 seconds animation whose root and child wander randomly.
+Animation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 10.f;
+  raw_animation.tracks.resize(2);
+  ozz::math::Float3 position(0.f, 0.f, 0.f);
+  for (int i = 0; i <= 20; ++i) {
+    position = position + ozz::math::Float3(Random(), 0.f, Random());
+    const RawAnimation::TranslationKey root = {i * .5f, position};
+    raw_animation.tracks[0].translations.push_back(root);
+    const RawAnimation::TranslationKey child = {
+      i * .5f, ozz::math::Float3(Random(), 1.f, Random())};
+    raw_animation.tracks[1].translations.push_back(child);
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Builds the database of _animation, with child and trajectory features.
+MotionDatabase* BuildDatabase(const Skeleton& _skeleton,
+                              const Animation& _animation) {
+  MotionDatabaseBuilder builder;
+  builder.joints.push_back(1);
+  builder.trajectory.push_back(.2f);
+  builder.trajectory.push_back(.4f);
+  builder.trajectory.push_back(.6f);
+  const Animation* animations[] = {&_animation};
+  return builder(_skeleton, ozz::Range<const Animation* const>(animations));
+}
+
+// Gets the non-normalized features of frame _frame.
+void GetFeatures(const MotionDatabase& _database, int _frame, float* _query) {
+  for (int f = 0; f < _database.num_features(); ++f) {
+    _query[f] = _database.feature(_frame, f) / _database.scales().begin[f] +
+                _database.means().begin[f];
+  }
+}
+}  // namespace
+
+TEST(Validate, MotionSearchJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+  MotionDatabase* database = BuildDatabase(*skeleton, *animation);
+  ASSERT_TRUE(database != NULL);
+  ASSERT_EQ(database->num_features(), 15);
+
+  float query[15] = {0.f};
+  float weights[15] = {0.f};
+  int frame;
+  float cost;
+
+  {  // Default is invalid.
+    MotionSearchJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Empty database.
+    MotionDatabase empty;
+    MotionSearchJob job;
+    job.database = &empty;
+    job.query = ozz::Range<const float>(query);
+    job.frame = &frame;
+    job.cost = &cost;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Query too small.
+    MotionSearchJob job;
+    job.database = database;
+    job.query = ozz::Range<const float>(query, 14);
+    job.frame = &frame;
+    job.cost = &cost;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Weights too small.
+    MotionSearchJob job;
+    job.database = database;
+    job.query = ozz::Range<const float>(query);
+    job.weights = ozz::Range<const float>(weights, 14);
+    job.frame = &frame;
+    job.cost = &cost;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Negative weight.
+    weights[3] = -1.f;
+    MotionSearchJob job;
+    job.database = database;
+    job.query = ozz::Range<const float>(query);
+    job.weights = ozz::Range<const float>(weights);
+    job.frame = &frame;
+    job.cost = &cost;
+    EXPECT_FALSE(job.Validate());
+    weights[3] = 0.f;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Missing outputs.
+    MotionSearchJob job;
+    job.database = database;
+    job.query = ozz::Range<const float>(query);
+    job.frame = &frame;
+    EXPECT_FALSE(job.Validate());
+    job.cost = &cost;
+    job.frame = NULL;
+    EXPECT_FALSE(job.Validate());
+    job.frame = &frame;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(database);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(Search, MotionSearchJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+  MotionDatabase* database = BuildDatabase(*skeleton, *animation);
+  ASSERT_TRUE(database != NULL);
+  ASSERT_EQ(database->num_frames(), 301);
+
+  float query[15];
+  MotionSearchJob job;
+  job.database = database;
+  job.query = ozz::Range<const float>(query);
+  int frame;
+  float cost;
+  job.frame = &frame;
+  job.cost = &cost;
+
+  // Every frame matches itself, including the last one of a partial block.
+  for (int i = 0; i < database->num_frames(); i += 7) {
+    GetFeatures(*database, i, query);
+    for (int use_index = 0; use_index < 2; ++use_index) {
+      job.use_index = use_index != 0;
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(frame, i);
+      EXPECT_NEAR(cost, 0.f, 1e-4f);
+    }
+  }
+  GetFeatures(*database, 300, query);
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(frame, 300);
+
+  // The index doesn't affect the result of perturbed weighted queries.
+  float weights[15];
+  job.weights = ozz::Range<const float>(weights);
+  for (int i = 0; i < 100; ++i) {
+    GetFeatures(*database, std::rand() % database->num_frames(), query);
+    for (int f = 0; f < 15; ++f) {
+      query[f] += Random() * .5f;
+      weights[f] = Random() + 1.f;
+    }
+    job.use_index = false;
+    ASSERT_TRUE(job.Run());
+    const int brute_frame = frame;
+    const float brute_cost = cost;
+    job.use_index = true;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(frame, brute_frame);
+    EXPECT_FLOAT_EQ(cost, brute_cost);
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(database);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(Serialize, MotionSearchJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+  MotionDatabase* database = BuildDatabase(*skeleton, *animation);
+  ASSERT_TRUE(database != NULL);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+  o << *database;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  MotionDatabase loaded;
+  i >> loaded;
+
+  ASSERT_EQ(loaded.num_frames(), database->num_frames());
+  ASSERT_EQ(loaded.num_features(), database->num_features());
+  EXPECT_EQ(loaded.root(), database->root());
+  ASSERT_EQ(loaded.joints().Count(), 1u);
+  EXPECT_EQ(loaded.joints().begin[0], 1);
+  ASSERT_EQ(loaded.trajectory().Count(), 3u);
+  EXPECT_FLOAT_EQ(loaded.trajectory().begin[2], .6f);
+  for (int f = 0; f < loaded.num_features(); ++f) {
+    EXPECT_FLOAT_EQ(loaded.means().begin[f], database->means().begin[f]);
+    EXPECT_FLOAT_EQ(loaded.scales().begin[f], database->scales().begin[f]);
+  }
+  for (int j = 0; j < loaded.num_frames(); ++j) {
+    EXPECT_EQ(loaded.frames().begin[j].animation,
+              database->frames().begin[j].animation);
+    EXPECT_FLOAT_EQ(loaded.frames().begin[j].time,
+                    database->frames().begin[j].time);
+    for (int f = 0; f < loaded.num_features(); ++f) {
+      EXPECT_FLOAT_EQ(loaded.feature(j, f), database->feature(j, f));
+    }
+  }
+
+  // Loaded index is valid.
+  float query[15];
+  GetFeatures(*database, 123, query);
+  MotionSearchJob job;
+  job.database = &loaded;
+  job.query = ozz::Range<const float>(query);
+  int frame;
+  float cost;
+  job.frame = &frame;
+  job.cost = &cost;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(frame, 123);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(database);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
@@ -0,0 +1,182 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/numa_replicas.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/tasks/thread_pool.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::NumaReplicas;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds an animation whose translation x moves from 0 to _value.
+Animation* BuildAnimation(float _value) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  for (int i = 0; i < 2; ++i) {
+    RawAnimation::TranslationKey t0 = {0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+    raw_animation.tracks[i].translations.push_back(t0);
+    RawAnimation::TranslationKey t1 = {
+      1.f, ozz::math::Float3(_value, 0.f, 0.f)};
+    raw_animation.tracks[i].translations.push_back(t1);
+  }
+  return AnimationBuilder()(raw_animation);
+}
+
+// Builds a skeleton of 2 joints.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "child";
+  return SkeletonBuilder()(raw_skeleton);
+}
+}  // namespace
+
+TEST(Empty, NumaReplicas) {
+  NumaReplicas replicas;
+  EXPECT_EQ(replicas.num_nodes(), 0);
+  EXPECT_EQ(replicas.num_animations(), 0);
+  EXPECT_EQ(replicas.num_skeletons(), 0);
+  EXPECT_TRUE(replicas.animation(0, 0) == NULL);
+  EXPECT_TRUE(replicas.skeleton(0, 0) == NULL);
+
+  // Invalid node count.
+  EXPECT_FALSE(replicas.Replicate(ozz::Range<const Animation* const>(),
+                                  ozz::Range<const Skeleton* const>(), 0));
+
+  // Nothing to replicate.
+  EXPECT_TRUE(replicas.Replicate(ozz::Range<const Animation* const>(),
+                                 ozz::Range<const Skeleton* const>(), 2));
+  EXPECT_EQ(replicas.num_nodes(), 2);
+  EXPECT_TRUE(replicas.animation(0, 1) == NULL);
+}
+
+TEST(Invalid, NumaReplicas) {
+  Animation* animation = BuildAnimation(1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  NumaReplicas replicas;
+  const Animation* animations[] = {animation, NULL};
+  EXPECT_FALSE(replicas.Replicate(
+    ozz::Range<const Animation* const>(animations),
+    ozz::Range<const Skeleton* const>(), 1));
+  EXPECT_EQ(replicas.num_nodes(), 0);
+  EXPECT_EQ(replicas.num_animations(), 0);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Replicate, NumaReplicas) {
+  Animation* walk = BuildAnimation(1.f);
+  ASSERT_TRUE(walk != NULL);
+  Animation* run = BuildAnimation(2.f);
+  ASSERT_TRUE(run != NULL);
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  const Animation* animations[] = {walk, run};
+  const Skeleton* skeletons[] = {skeleton};
+  const int num_nodes = ozz::tasks::ThreadPool::num_numa_nodes() + 1;
+
+  NumaReplicas replicas;
+  ASSERT_TRUE(replicas.Replicate(
+    ozz::Range<const Animation* const>(animations),
+    ozz::Range<const Skeleton* const>(skeletons), num_nodes));
+  EXPECT_EQ(replicas.num_nodes(), num_nodes);
+  EXPECT_EQ(replicas.num_animations(), 2);
+  EXPECT_EQ(replicas.num_skeletons(), 1);
+
+  // Buffer allocators are restored.
+  EXPECT_EQ(Animation::buffer_allocator(), ozz::memory::default_allocator());
+  EXPECT_EQ(Skeleton::buffer_allocator(), ozz::memory::default_allocator());
+
+  // Sources aren't referenced anymore.
+  ozz::memory::default_allocator()->Delete(walk);
+  ozz::memory::default_allocator()->Delete(run);
+  ozz::memory::default_allocator()->Delete(skeleton);
+
+  for (int n = 0; n < num_nodes; ++n) {
+    const Skeleton* replica_skeleton = replicas.skeleton(0, n);
+    ASSERT_TRUE(replica_skeleton != NULL);
+    EXPECT_EQ(replica_skeleton->num_joints(), 2);
+    EXPECT_STREQ(replica_skeleton->joint_names()[1], "child");
+
+    for (int a = 0; a < 2; ++a) {
+      const Animation* replica = replicas.animation(a, n);
+      ASSERT_TRUE(replica != NULL);
+      EXPECT_TRUE(replica != replicas.animation(a, (n + 1) % num_nodes));
+
+      ozz::animation::SamplingJob job;
+      ozz::animation::SamplingCache cache(2);
+      ozz::math::SoaTransform output[1];
+      job.animation = replica;
+      job.cache = &cache;
+      job.time = .5f;
+      job.output.begin = output;
+      job.output.end = output + 1;
+      ASSERT_TRUE(job.Run());
+      const float x = a == 0 ? .5f : 1.f;
+      EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, x, x, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f);
+    }
+  }
+
+  // Out of range nodes fall back to node 0, out of range indices are NULL.
+  EXPECT_EQ(replicas.animation(1, -1), replicas.animation(1, 0));
+  EXPECT_EQ(replicas.skeleton(0, num_nodes), replicas.skeleton(0, 0));
+  EXPECT_TRUE(replicas.animation(2, 0) == NULL);
+  EXPECT_TRUE(replicas.skeleton(-1, 0) == NULL);
+
+  replicas.Clear();
+  EXPECT_EQ(replicas.num_nodes(), 0);
+  EXPECT_TRUE(replicas.animation(0, 0) == NULL);
+}
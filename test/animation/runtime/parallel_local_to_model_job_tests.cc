@@ -0,0 +1,296 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/parallel_local_to_model_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/tasks/task_dispatcher.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Skeleton;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::LocalToModelPartition;
+using ozz::animation::ParallelLocalToModelJob;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Dispatches work items in reverse order, to detect dependencies between
+// partitions.
+class ReverseDispatcher : public ozz::tasks::Dispatcher {
+ public:
+  ReverseDispatcher()
+    : dispatched(0) {
+  }
+  virtual void Dispatch(const ozz::tasks::Task& _task, int _count) {
+    for (int i = _count - 1; i >= 0; --i) {
+      _task.Run(i);
+      ++dispatched;
+    }
+  }
+  int dispatched;
+};
+
+// Recursively adds _depth levels of _width children to _joint.
+void AddChildren(RawSkeleton::Joint* _joint, int _width, int _depth) {
+  if (_depth == 0) {
+    return;
+  }
+  _joint->children.resize(_width);
+  for (int i = 0; i < _width; ++i) {
+    RawSkeleton::Joint& child = _joint->children[i];
+    child.name = _joint->name + static_cast<char>('a' + i);
+    child.transform = ozz::math::Transform::identity();
+    child.transform.translation =
+      ozz::math::Float3(static_cast<float>(i), 1.f, static_cast<float>(_depth));
+    AddChildren(&child, _width, _depth - 1);
+  }
+}
+}  // namespace
+
+TEST(Partition, ParallelLocalToModel) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "r";
+  raw_skeleton.roots[0].transform = ozz::math::Transform::identity();
+  AddChildren(&raw_skeleton.roots[0], 3, 4);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  const int num_joints = skeleton->num_joints();
+  EXPECT_EQ(num_joints, 1 + 3 + 9 + 27 + 81);
+
+  LocalToModelPartition partition;
+  EXPECT_FALSE(partition.Build(*skeleton, 0));
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  int* owners = allocator->Allocate<int>(num_joints);
+  for (int max_partitions = 1; max_partitions < 12; ++max_partitions) {
+    ASSERT_TRUE(partition.Build(*skeleton, max_partitions));
+    EXPECT_EQ(partition.num_joints(), num_joints);
+    EXPECT_GE(partition.num_partitions(), 1);
+    EXPECT_LE(partition.num_partitions(), max_partitions);
+
+    // Every joint must belong to a single set, whose parent was processed
+    // before.
+    for (int i = 0; i < num_joints; ++i) {
+      owners[i] = -2;
+    }
+    ozz::Range<const uint16_t> trunk = partition.trunk();
+    for (const uint16_t* it = trunk.begin; it < trunk.end; ++it) {
+      EXPECT_EQ(owners[*it], -2);
+      owners[*it] = -1;
+    }
+    for (int p = 0; p < partition.num_partitions(); ++p) {
+      ozz::Range<const uint16_t> joints = partition.partition(p);
+      EXPECT_TRUE(joints.Count() > 0);
+      for (const uint16_t* it = joints.begin; it < joints.end; ++it) {
+        EXPECT_EQ(owners[*it], -2);
+        owners[*it] = p;
+        const int parent = skeleton->joint_properties().begin[*it].parent;
+        if (parent != Skeleton::kNoParentIndex) {
+          EXPECT_TRUE(owners[parent] == -1 || owners[parent] == p);
+        }
+      }
+    }
+    for (int i = 0; i < num_joints; ++i) {
+      EXPECT_NE(owners[i], -2);
+    }
+  }
+  allocator->Deallocate(owners);
+
+  // Empty skeleton.
+  Skeleton empty;
+  EXPECT_TRUE(partition.Build(empty, 4));
+  EXPECT_EQ(partition.num_joints(), 0);
+  EXPECT_EQ(partition.num_partitions(), 0);
+  EXPECT_EQ(partition.trunk().Count(), 0u);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(JobValidity, ParallelLocalToModel) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(1);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  LocalToModelPartition partition;
+  ASSERT_TRUE(partition.Build(*skeleton, 2));
+  LocalToModelPartition unbuilt_partition;
+
+  ozz::math::SoaTransform input[1] = {ozz::math::SoaTransform::identity()};
+  ozz::math::Float4x4 output[2];
+
+  {  // Default job.
+    ParallelLocalToModelJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // No dispatcher.
+    ParallelLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.partition = &partition;
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // No partition.
+    ParallelLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.dispatcher = ozz::tasks::serial_dispatcher();
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Partition doesn't match skeleton.
+    ParallelLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.partition = &unbuilt_partition;
+    job.dispatcher = ozz::tasks::serial_dispatcher();
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Output too small.
+    ParallelLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.partition = &partition;
+    job.dispatcher = ozz::tasks::serial_dispatcher();
+    job.input = input;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid job.
+    ParallelLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.partition = &partition;
+    job.dispatcher = ozz::tasks::serial_dispatcher();
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Transformation, ParallelLocalToModel) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  raw_skeleton.roots[0].name = "r";
+  raw_skeleton.roots[0].transform = ozz::math::Transform::identity();
+  AddChildren(&raw_skeleton.roots[0], 2, 5);
+  raw_skeleton.roots[1].name = "s";
+  raw_skeleton.roots[1].transform = ozz::math::Transform::identity();
+  AddChildren(&raw_skeleton.roots[1], 3, 2);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = skeleton->num_soa_joints();
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  ozz::math::SoaTransform* input =
+    allocator->Allocate<ozz::math::SoaTransform>(num_soa_joints);
+  ozz::math::Float4x4* expected =
+    allocator->Allocate<ozz::math::Float4x4>(num_joints);
+  ozz::math::Float4x4* output =
+    allocator->Allocate<ozz::math::Float4x4>(num_joints);
+
+  // Uses a non trivial local pose.
+  for (int i = 0; i < num_soa_joints; ++i) {
+    input[i] = skeleton->bind_pose().begin[i];
+    input[i].rotation.y = ozz::math::simd_float4::Load1(.70710677f);
+    input[i].rotation.w = ozz::math::simd_float4::Load1(.70710677f);
+  }
+
+  LocalToModelJob ltm;
+  ltm.skeleton = skeleton;
+  ltm.input.begin = input;
+  ltm.input.end = input + num_soa_joints;
+  ltm.output.begin = expected;
+  ltm.output.end = expected + num_joints;
+  ASSERT_TRUE(ltm.Run());
+
+  for (int max_partitions = 1; max_partitions < 8; ++max_partitions) {
+    LocalToModelPartition partition;
+    ASSERT_TRUE(partition.Build(*skeleton, max_partitions));
+
+    ReverseDispatcher dispatcher;
+    ParallelLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.partition = &partition;
+    job.dispatcher = &dispatcher;
+    job.input.begin = input;
+    job.input.end = input + num_soa_joints;
+    job.output.begin = output;
+    job.output.end = output + num_joints;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(dispatcher.dispatched, partition.num_partitions());
+
+    for (int i = 0; i < num_joints; ++i) {
+      for (int c = 0; c < 4; ++c) {
+        float e[4];
+        float o[4];
+        ozz::math::StorePtrU(expected[i].cols[c], e);
+        ozz::math::StorePtrU(output[i].cols[c], o);
+        EXPECT_FLOAT_EQ(e[0], o[0]);
+        EXPECT_FLOAT_EQ(e[1], o[1]);
+        EXPECT_FLOAT_EQ(e[2], o[2]);
+        EXPECT_FLOAT_EQ(e[3], o[3]);
+      }
+    }
+  }
+
+  allocator->Deallocate(output);
+  allocator->Deallocate(expected);
+  allocator->Deallocate(input);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
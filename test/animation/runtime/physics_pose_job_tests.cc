@@ -0,0 +1,278 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/physics_pose_job.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/linear_allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::LocalToModelJob;
+using ozz::animation::PhysicsPoseJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 6 joints skeleton:
+/*
+ root(0)
+  /    \
+ j0(1)  j2(2)
+  |     /   \
+ j1(3) j3(4) j4(5)
+*/
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j2";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Compares 2 matrices within a small tolerance.
+bool AreNear(const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  const ozz::math::SimdFloat4 tolerance =
+    ozz::math::simd_float4::Load1(1e-4f);
+  for (int i = 0; i < 4; ++i) {
+    const ozz::math::SimdFloat4 diff = ozz::math::Abs(_a.cols[i] - _b.cols[i]);
+    if (!ozz::math::AreAllTrue(ozz::math::CmpLe(diff, tolerance))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Computes _skeleton model-space matrices of _locals pose.
+void ToModels(const Skeleton& _skeleton,
+              const ozz::math::SoaTransform* _locals,
+              ozz::math::Float4x4* _models) {
+  LocalToModelJob job;
+  job.skeleton = &_skeleton;
+  job.input.begin = _locals;
+  job.input.end = _locals + 2;
+  job.output.begin = _models;
+  job.output.end = _models + 6;
+  ASSERT_TRUE(job.Run());
+}
+
+// Local transforms used as animation pose.
+const ozz::math::SoaTransform kInput[2] = {
+  {{ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 1.f),
+    ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 2.f),
+    ozz::math::simd_float4::Load(2.f, 0.f, -2.f, 4.f)},
+   {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, .5f),
+    ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .5f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .6f, .5f),
+    ozz::math::simd_float4::Load(1.f, .70710677f, .8f, .5f)},
+   {ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)}},
+  {{ozz::math::simd_float4::Load(12.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(46.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(-12.f, 0.f, 0.f, 0.f)},
+   {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)},
+   {ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f)}}};
+}  // namespace
+
+TEST(JobValidity, PhysicsPoseJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::Float4x4 bodies[2] = {ozz::math::Float4x4::identity(),
+                                   ozz::math::Float4x4::identity()};
+  ozz::math::Float4x4 models[6];
+  ozz::math::SoaTransform output[2];
+
+  {  // Default job.
+    PhysicsPoseJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  PhysicsPoseJob valid;
+  valid.skeleton = skeleton;
+  valid.input = kInput;
+  valid.models = models;
+  valid.output = output;
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_TRUE(valid.Run());
+
+  {  // Buffers too small.
+    PhysicsPoseJob job = valid;
+    job.input.end = kInput + 1;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.models.end = models + 5;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Bodies.
+    PhysicsPoseJob job = valid;
+    const uint16_t joints[] = {2, 5};
+    job.body_joints = joints;
+    EXPECT_FALSE(job.Validate());
+    job.bodies = bodies;
+    EXPECT_TRUE(job.Validate());
+    job.bodies.end = bodies + 1;
+    EXPECT_FALSE(job.Validate());
+
+    const uint16_t out_of_range[] = {2, 6};
+    job.bodies = bodies;
+    job.body_joints = out_of_range;
+    EXPECT_FALSE(job.Validate());
+
+    const uint16_t twice[] = {2, 2};
+    job.body_joints = twice;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Match, PhysicsPoseJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::Float4x4 input_models[6];
+  ToModels(*skeleton, kInput, input_models);
+
+  // Physics moved the pose, which is emulated by moving every joint.
+  ozz::math::SoaTransform physics[2] = {kInput[0], kInput[1]};
+  for (int i = 0; i < 2; ++i) {
+    physics[i].translation.y =
+      physics[i].translation.y + ozz::math::simd_float4::one();
+  }
+  ozz::math::Float4x4 physics_models[6];
+  ToModels(*skeleton, physics, physics_models);
+
+  ozz::math::Float4x4 models[6];
+  ozz::math::SoaTransform output[2];
+  PhysicsPoseJob job;
+  job.skeleton = skeleton;
+  job.root = ozz::math::Float4x4::Translation(
+    ozz::math::simd_float4::Load(10.f, 20.f, 30.f, 0.f));
+  job.input = kInput;
+  job.models = models;
+  job.output = output;
+
+  {  // Without bodies, output is the animation pose.
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(output, kInput, sizeof(output)), 0);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreNear(models[i], input_models[i])) << "joint " << i;
+    }
+  }
+
+  {  // Bodies mapped to j2 and j1, in world-space.
+    const uint16_t joints[] = {2, 3};
+    const ozz::math::Float4x4 bodies[] = {job.root * physics_models[2],
+                                          job.root * physics_models[3]};
+    job.body_joints = joints;
+    job.bodies = bodies;
+    ASSERT_TRUE(job.Run());
+
+    // Mapped joints match their body, j3 and j4 follow j2.
+    ozz::math::Float4x4 output_models[6];
+    ToModels(*skeleton, output, output_models);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(AreNear(models[i], output_models[i])) << "joint " << i;
+    }
+    EXPECT_TRUE(AreNear(models[0], input_models[0]));
+    EXPECT_TRUE(AreNear(models[1], input_models[1]));
+    EXPECT_TRUE(AreNear(models[2], physics_models[2]));
+    EXPECT_TRUE(AreNear(models[3], physics_models[3]));
+    EXPECT_TRUE(AreNear(models[4],
+                        physics_models[2] * Invert(input_models[2]) *
+                          input_models[4]));
+
+    // Unmapped joints keep their animation local transform.
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 12.f, 0.f, 0.f, 0.f,
+                                                   46.f, 0.f, 0.f, 0.f,
+                                                   -12.f, 0.f, 0.f, 0.f);
+    EXPECT_SIMDFLOAT_EQ(output[0].translation.x, 2.f, 0.f, -2.f, 1.f);
+
+    // Output can be the input.
+    ozz::math::SoaTransform in_place[2] = {kInput[0], kInput[1]};
+    job.input = in_place;
+    job.output = in_place;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(in_place, output, sizeof(output)), 0);
+
+    // Temporary buffers can be allocated from a scratch arena.
+    ozz::memory::ArenaAllocator arena(256);
+    job.scratch_allocator = &arena;
+    ozz::math::SoaTransform scratch_output[2];
+    ozz::math::Float4x4 scratch_models[6];
+    job.input = kInput;
+    job.output = scratch_output;
+    job.models = scratch_models;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(scratch_output, output, sizeof(output)), 0);
+    EXPECT_EQ(std::memcmp(scratch_models, models, sizeof(models)), 0);
+    EXPECT_EQ(arena.used(), 0u);
+
+    // Validation uses the arena too.
+    const uint16_t twice[] = {2, 2};
+    job.body_joints = twice;
+    EXPECT_FALSE(job.Run());
+    EXPECT_EQ(arena.used(), 0u);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
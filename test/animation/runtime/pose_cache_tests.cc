@@ -0,0 +1,260 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/pose_cache.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::PoseCache;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton of 6 joints, all children of the root, whose bind pose is
+// translated by 1 along z.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.transform.translation = ozz::math::Float3(0.f, 0.f, 1.f);
+  root.children.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    RawSkeleton::Joint& child = root.children[i];
+    child.name = std::string("j") + static_cast<char>('0' + i);
+    child.transform = root.transform;
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation of _num_tracks tracks, whose first track translates
+// along x from 0 to _distance in 1 second.
+Animation* BuildAnimation(int _num_tracks, float _distance) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  const RawAnimation::TranslationKey first = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(first);
+  const RawAnimation::TranslationKey last = {
+    1.f, ozz::math::Float3(_distance, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(last);
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Validity, PoseCache) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(animation != NULL);
+  Animation* too_big = BuildAnimation(9, 1.f);
+  ASSERT_TRUE(too_big != NULL);
+
+  PoseCache cache(*skeleton, 4, 0.f, false);
+  EXPECT_EQ(cache.capacity(), 4);
+  EXPECT_FLOAT_EQ(cache.time_step(), 0.f);
+
+  PoseCache::Pose pose;
+  const ozz::Range<const unsigned char> no_mask;
+  EXPECT_FALSE(cache.Get(*animation, 0.f, no_mask, NULL));
+  EXPECT_FALSE(cache.Get(*too_big, 0.f, no_mask, &pose));
+
+  const unsigned char mask[1] = {0xff};
+  EXPECT_FALSE(cache.Get(*animation, 0.f,
+                         ozz::Range<const unsigned char>(mask, mask), &pose));
+  EXPECT_FALSE(cache.Get(*animation, 0.f,
+                         ozz::Range<const unsigned char>(NULL, mask + 1),
+                         &pose));
+  EXPECT_EQ(cache.num_poses(), 0);
+
+  EXPECT_TRUE(cache.Get(*animation, 0.f,
+                        ozz::Range<const unsigned char>(mask, mask + 1),
+                        &pose));
+  EXPECT_EQ(cache.num_poses(), 1);
+
+  ozz::memory::default_allocator()->Delete(too_big);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Share, PoseCache) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animations[2] = {BuildAnimation(6, 1.f),
+                              BuildAnimation(6, -1.f)};
+  ASSERT_TRUE(animations[0] != NULL && animations[1] != NULL);
+
+  PoseCache cache(*skeleton, 8, .1f, false);
+  EXPECT_FLOAT_EQ(cache.Quantize(.52f), .5f);
+  EXPECT_FLOAT_EQ(cache.Quantize(.46f), .5f);
+  EXPECT_FLOAT_EQ(cache.Quantize(.56f), .6f);
+
+  const ozz::Range<const unsigned char> no_mask;
+  PoseCache::Pose pose0;
+  ASSERT_TRUE(cache.Get(*animations[0], .52f, no_mask, &pose0));
+  EXPECT_EQ(pose0.locals.end - pose0.locals.begin, 2);
+  EXPECT_TRUE(pose0.models.begin == NULL && pose0.models.end == NULL);
+  EXPECT_SOAFLOAT3_EQ_EST(pose0.locals.begin[0].translation,
+                          .5f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+  EXPECT_EQ(cache.num_poses(), 1);
+  EXPECT_EQ(cache.num_hits(), 0);
+
+  // Times that are quantized the same share the same posture.
+  PoseCache::Pose pose1;
+  ASSERT_TRUE(cache.Get(*animations[0], .48f, no_mask, &pose1));
+  EXPECT_EQ(pose0.locals.begin, pose1.locals.begin);
+  EXPECT_EQ(cache.num_poses(), 1);
+  EXPECT_EQ(cache.num_hits(), 1);
+
+  // An explicit mask with all soa joints is the same as no mask.
+  const unsigned char full_mask[1] = {0x3};
+  ASSERT_TRUE(cache.Get(*animations[0], .5f,
+                        ozz::Range<const unsigned char>(full_mask), &pose1));
+  EXPECT_EQ(pose0.locals.begin, pose1.locals.begin);
+  EXPECT_EQ(cache.num_hits(), 2);
+
+  // Other times, animations or masks use other postures.
+  ASSERT_TRUE(cache.Get(*animations[0], .56f, no_mask, &pose1));
+  EXPECT_NE(pose0.locals.begin, pose1.locals.begin);
+  EXPECT_SOAFLOAT3_EQ_EST(pose1.locals.begin[0].translation,
+                          .6f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+
+  ASSERT_TRUE(cache.Get(*animations[1], .5f, no_mask, &pose1));
+  EXPECT_NE(pose0.locals.begin, pose1.locals.begin);
+  EXPECT_SOAFLOAT3_EQ_EST(pose1.locals.begin[0].translation,
+                          -.5f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+
+  // Masked out soa joints are set to the bind pose.
+  const unsigned char mask[1] = {0x2};
+  ASSERT_TRUE(cache.Get(*animations[0], .5f,
+                        ozz::Range<const unsigned char>(mask), &pose1));
+  EXPECT_NE(pose0.locals.begin, pose1.locals.begin);
+  EXPECT_SOAFLOAT3_EQ_EST(pose1.locals.begin[0].translation,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(pose1.locals.begin[1].translation,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+  EXPECT_EQ(cache.num_poses(), 4);
+  EXPECT_EQ(cache.num_hits(), 2);
+
+  // First posture is still valid.
+  EXPECT_SOAFLOAT3_EQ_EST(pose0.locals.begin[0].translation,
+                          .5f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animations[0]);
+  ozz::memory::default_allocator()->Delete(animations[1]);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Models, PoseCache) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  PoseCache cache(*skeleton, 2, 0.f, true);
+  PoseCache::Pose pose;
+  ASSERT_TRUE(cache.Get(*animation, .5f, ozz::Range<const unsigned char>(),
+                        &pose));
+  EXPECT_EQ(pose.models.end - pose.models.begin, 6);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_SIMDFLOAT_EQ_EST(pose.models.begin[i].cols[3], .5f, 0.f, 0.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Capacity, PoseCache) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  PoseCache cache(*skeleton, 2, 0.f, false);
+  const ozz::Range<const unsigned char> no_mask;
+  PoseCache::Pose pose;
+  EXPECT_TRUE(cache.Get(*animation, .1f, no_mask, &pose));
+  EXPECT_TRUE(cache.Get(*animation, .2f, no_mask, &pose));
+  EXPECT_FALSE(cache.Get(*animation, .3f, no_mask, &pose));
+
+  // Cached postures can still be shared.
+  EXPECT_TRUE(cache.Get(*animation, .1f, no_mask, &pose));
+  EXPECT_EQ(cache.num_poses(), 2);
+  EXPECT_EQ(cache.num_hits(), 1);
+
+  // Clearing releases all postures.
+  cache.Clear();
+  EXPECT_EQ(cache.num_poses(), 0);
+  EXPECT_EQ(cache.num_hits(), 0);
+  EXPECT_TRUE(cache.Get(*animation, .3f, no_mask, &pose));
+  EXPECT_SOAFLOAT3_EQ_EST(pose.locals.begin[0].translation,
+                          .3f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f);
+
+  PoseCache empty(*skeleton, 0, 0.f, false);
+  EXPECT_FALSE(empty.Get(*animation, .3f, no_mask, &pose));
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,202 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/pose_delta_encoder.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/compact_soa_transform.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::PoseDeltaEncoder;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::math::CompactSoaTransform;
+using ozz::math::SoaTransform;
+
+namespace {
+// Builds a skeleton of 6 joints, all children of the root.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.transform.translation = ozz::math::Float3(0.f, 0.f, 1.f);
+  root.children.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    RawSkeleton::Joint& child = root.children[i];
+    child.name = std::string("j") + static_cast<char>('0' + i);
+    child.transform = root.transform;
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Compares quantized poses.
+bool AreEqual(const CompactSoaTransform* _a, const CompactSoaTransform* _b,
+              int _count) {
+  return std::memcmp(_a, _b, _count * sizeof(CompactSoaTransform)) == 0;
+}
+}  // namespace
+
+TEST(Validity, PoseDeltaEncoder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_soa_joints(), 2);
+
+  const PoseDeltaEncoder encoder(*skeleton);
+  SoaTransform pose[2];
+  CompactSoaTransform reference[2];
+  CompactSoaTransform quantized[2];
+  char buffer[256];
+  ASSERT_LE(encoder.max_size(), sizeof(buffer));
+  ozz::math::Pack(skeleton->bind_pose(),
+                  ozz::Range<CompactSoaTransform>(reference));
+
+  // Ranges too small.
+  EXPECT_EQ(encoder.Encode(ozz::Range<const SoaTransform>(pose, 1),
+                           ozz::Range<const CompactSoaTransform>(reference),
+                           ozz::Range<CompactSoaTransform>(quantized),
+                           ozz::Range<char>(buffer)), 0u);
+  EXPECT_EQ(encoder.Encode(skeleton->bind_pose(),
+                           ozz::Range<const CompactSoaTransform>(reference, 1),
+                           ozz::Range<CompactSoaTransform>(quantized),
+                           ozz::Range<char>(buffer)), 0u);
+  EXPECT_EQ(encoder.Encode(skeleton->bind_pose(),
+                           ozz::Range<const CompactSoaTransform>(reference),
+                           ozz::Range<CompactSoaTransform>(quantized, 1),
+                           ozz::Range<char>(buffer)), 0u);
+  EXPECT_FALSE(encoder.Decode(ozz::Range<const char>(buffer),
+                              ozz::Range<const CompactSoaTransform>(reference),
+                              ozz::Range<CompactSoaTransform>(quantized),
+                              ozz::Range<SoaTransform>(pose, 1)));
+
+  // Buffer too small.
+  SoaTransform moved[2] = {skeleton->bind_pose()[0],
+                           skeleton->bind_pose()[1]};
+  moved[0].translation.x = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f);
+  EXPECT_EQ(encoder.Encode(ozz::Range<const SoaTransform>(moved),
+                           ozz::Range<const CompactSoaTransform>(reference),
+                           ozz::Range<CompactSoaTransform>(quantized),
+                           ozz::Range<char>(buffer, 2)), 0u);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Encode, PoseDeltaEncoder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  const PoseDeltaEncoder encoder(*skeleton);
+  CompactSoaTransform reference[2];
+  ozz::math::Pack(skeleton->bind_pose(),
+                  ozz::Range<CompactSoaTransform>(reference));
+
+  CompactSoaTransform sent[2];
+  CompactSoaTransform received[2];
+  SoaTransform decoded[2];
+  char buffer[256];
+
+  // An unchanged pose only costs the soa joints changed bits.
+  size_t size =
+    encoder.Encode(skeleton->bind_pose(),
+                   ozz::Range<const CompactSoaTransform>(reference),
+                   ozz::Range<CompactSoaTransform>(sent),
+                   ozz::Range<char>(buffer));
+  EXPECT_EQ(size, 1u);
+  EXPECT_TRUE(AreEqual(sent, reference, 2));
+  EXPECT_TRUE(encoder.Decode(ozz::Range<const char>(buffer, size),
+                             ozz::Range<const CompactSoaTransform>(reference),
+                             ozz::Range<CompactSoaTransform>(received),
+                             ozz::Range<SoaTransform>(decoded)));
+  EXPECT_TRUE(AreEqual(received, reference, 2));
+
+  // Moves and rotates joint 5, and scales joint 1.
+  SoaTransform pose[2] = {skeleton->bind_pose()[0], skeleton->bind_pose()[1]};
+  pose[1].translation.x = ozz::math::simd_float4::Load(0.f, .5f, 0.f, 0.f);
+  pose[1].rotation = ozz::math::SoaQuaternion::Load(
+    ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, 0.f),
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::Load(1.f, .70710677f, 1.f, 1.f));
+  pose[0].scale.y = ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 1.f);
+
+  size = encoder.Encode(ozz::Range<const SoaTransform>(pose),
+                        ozz::Range<const CompactSoaTransform>(reference),
+                        ozz::Range<CompactSoaTransform>(sent),
+                        ozz::Range<char>(buffer));
+  EXPECT_GT(size, 1u);
+  EXPECT_LT(size, 2 * sizeof(CompactSoaTransform));
+  EXPECT_TRUE(encoder.Decode(ozz::Range<const char>(buffer, size),
+                             ozz::Range<const CompactSoaTransform>(reference),
+                             ozz::Range<CompactSoaTransform>(received),
+                             ozz::Range<SoaTransform>(decoded)));
+  EXPECT_TRUE(AreEqual(received, sent, 2));
+  EXPECT_SOAFLOAT3_EQ_EST(decoded[1].translation, 0.f, .5f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  1.f, 1.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(decoded[1].rotation, 0.f, .70710677f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f,
+                                                   1.f, .70710677f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(decoded[0].scale, 1.f, 1.f, 1.f, 1.f,
+                                            1.f, 2.f, 1.f, 1.f,
+                                            1.f, 1.f, 1.f, 1.f);
+
+  // Once acknowledged, the sent pose becomes the reference.
+  size = encoder.Encode(ozz::Range<const SoaTransform>(pose),
+                        ozz::Range<const CompactSoaTransform>(sent),
+                        ozz::Range<CompactSoaTransform>(received),
+                        ozz::Range<char>(buffer));
+  EXPECT_EQ(size, 1u);
+
+  // Truncated buffer.
+  size = encoder.Encode(ozz::Range<const SoaTransform>(pose),
+                        ozz::Range<const CompactSoaTransform>(reference),
+                        ozz::Range<CompactSoaTransform>(sent),
+                        ozz::Range<char>(buffer));
+  EXPECT_FALSE(encoder.Decode(ozz::Range<const char>(buffer, size - 1),
+                              ozz::Range<const CompactSoaTransform>(reference),
+                              ozz::Range<CompactSoaTransform>(received),
+                              ozz::Range<SoaTransform>(decoded)));
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,198 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/pose_error_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::PoseErrorJob;
+
+namespace {
+ozz::math::Float4x4 Translation(float _x, float _y, float _z) {
+  return ozz::math::Float4x4::Translation(
+    ozz::math::simd_float4::Load(_x, _y, _z, 1.f));
+}
+}  // namespace
+
+TEST(JobValidity, PoseErrorJob) {
+  const ozz::math::Float4x4 models[3] = {ozz::math::Float4x4::identity(),
+                                         ozz::math::Float4x4::identity(),
+                                         ozz::math::Float4x4::identity()};
+  const float weights[3] = {1.f, 1.f, 1.f};
+  float error;
+
+  {  // Empty/default job.
+    PoseErrorJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Empty poses.
+    PoseErrorJob job;
+    job.error = &error;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_FLOAT_EQ(error, 0.f);
+  }
+
+  {  // Missing output.
+    PoseErrorJob job;
+    job.reference = models;
+    job.pose = models;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Different sizes.
+    PoseErrorJob job;
+    job.reference = models;
+    job.pose = ozz::Range<const ozz::math::Float4x4>(models, 2);
+    job.error = &error;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Weights too small.
+    PoseErrorJob job;
+    job.reference = models;
+    job.pose = models;
+    job.weights = ozz::Range<const float>(weights, 2);
+    job.error = &error;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid.
+    PoseErrorJob job;
+    job.reference = models;
+    job.pose = models;
+    job.weights = weights;
+    job.error = &error;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_FLOAT_EQ(error, 0.f);
+  }
+}
+
+TEST(Error, PoseErrorJob) {
+  // 6 joints, so that both 4 joints and remaining joints paths are used.
+  const ozz::math::Float4x4 reference[6] = {
+    Translation(0.f, 0.f, 0.f), Translation(1.f, 0.f, 0.f),
+    Translation(2.f, 0.f, 0.f), Translation(3.f, 0.f, 0.f),
+    Translation(4.f, 0.f, 0.f), Translation(5.f, 0.f, 0.f)};
+  const ozz::math::Float4x4 pose[6] = {
+    Translation(0.f, 0.f, 0.f), Translation(1.f, 3.f, 4.f),
+    Translation(2.f, 0.f, 0.f), Translation(3.f, 0.f, -1.f),
+    Translation(4.f, 0.f, 0.f), Translation(5.f, 2.f, 0.f)};
+
+  // Rotations don't contribute to the error.
+  ozz::math::Float4x4 rotated[6];
+  for (int i = 0; i < 6; ++i) {
+    rotated[i] = pose[i] * ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 1.f));
+  }
+
+  float error;
+  float max_error;
+  PoseErrorJob job;
+  job.reference = reference;
+  job.pose = pose;
+  job.error = &error;
+  job.max_error = &max_error;
+
+  // Unweighted.
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(error, (5.f + 1.f + 2.f) / 6.f);
+  EXPECT_FLOAT_EQ(max_error, 5.f);
+
+  job.pose = rotated;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(error, (5.f + 1.f + 2.f) / 6.f);
+  EXPECT_FLOAT_EQ(max_error, 5.f);
+
+  // Weighted.
+  const float weights[6] = {1.f, 0.f, 2.f, 1.f, 1.f, 3.f};
+  job.weights = weights;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(error, (0.f + 1.f + 6.f) / 8.f);
+  EXPECT_FLOAT_EQ(max_error, 5.f);
+
+  // Null weights.
+  const float nulls[6] = {0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+  job.weights = nulls;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(error, 0.f);
+
+  // Identical poses.
+  job.weights = ozz::Range<const float>();
+  job.pose = reference;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(error, 0.f);
+  EXPECT_FLOAT_EQ(max_error, 0.f);
+}
+
+TEST(JointLengthWeights, PoseErrorJob) {
+  ozz::animation::offline::RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  ozz::animation::offline::RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.transform.translation = ozz::math::Float3(10.f, 0.f, 0.f);
+  root.children.resize(2);
+  root.children[0].transform.translation = ozz::math::Float3(0.f, 2.f, 0.f);
+  root.children[1].transform.translation = ozz::math::Float3(3.f, 0.f, 4.f);
+  root.children[1].children.resize(1);
+  root.children[1].children[0].transform.translation =
+    ozz::math::Float3(0.f, 0.f, .5f);
+
+  ozz::animation::offline::SkeletonBuilder builder;
+  ozz::animation::Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 4);
+
+  float weights_buffer[4];
+  const ozz::Range<float> weights(weights_buffer);
+  EXPECT_FALSE(ozz::animation::ComputeJointLengthWeights(
+    *skeleton, ozz::Range<float>(weights_buffer, 3)));
+  ASSERT_TRUE(ozz::animation::ComputeJointLengthWeights(*skeleton, weights));
+
+  // Joints are in breadth-first order.
+  EXPECT_FLOAT_EQ(weights_buffer[0], 5.f);  // Root, longest bone.
+  EXPECT_FLOAT_EQ(weights_buffer[1], 2.f);
+  EXPECT_FLOAT_EQ(weights_buffer[2], 5.f);
+  EXPECT_FLOAT_EQ(weights_buffer[3], .5f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
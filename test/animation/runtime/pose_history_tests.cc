@@ -0,0 +1,247 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/pose_history.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::PoseHistory;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+typedef ozz::Range<const PoseHistory::Layer> Layers;
+typedef ozz::Range<ozz::math::Float4x4> Models;
+
+namespace {
+// Builds a skeleton of 6 joints, all children of the root.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    RawSkeleton::Joint& child = root.children[i];
+    child.name = std::string("j") + static_cast<char>('0' + i);
+    child.transform = ozz::math::Transform::identity();
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation of _num_tracks tracks, whose first track translates
+// along x from 0 to _distance in 1 second. The animation has a seek index.
+Animation* BuildAnimation(int _num_tracks, float _distance) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  const RawAnimation::TranslationKey first = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(first);
+  const RawAnimation::TranslationKey last = {
+    1.f, ozz::math::Float3(_distance, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(last);
+  AnimationBuilder builder;
+  builder.seek_interval = .25f;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Validity, PoseHistory) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(animation != NULL);
+  Animation* too_big = BuildAnimation(9, 1.f);
+  ASSERT_TRUE(too_big != NULL);
+
+  PoseHistory history(*skeleton, 4);
+  EXPECT_EQ(history.capacity(), 4);
+  EXPECT_EQ(history.num_records(), 0);
+
+  ozz::math::Float4x4 models[6];
+  const ozz::Range<const uint16_t> all;
+
+  // Nothing recorded yet.
+  EXPECT_FALSE(history.Evaluate(0.f, all, Models(models)));
+
+  {  // Too many layers.
+    const PoseHistory::Layer layers[PoseHistory::kMaxLayers + 1] = {
+      {animation, 0.f, 1.f}, {animation, 0.f, 1.f}, {animation, 0.f, 1.f},
+      {animation, 0.f, 1.f}, {animation, 0.f, 1.f}};
+    EXPECT_FALSE(history.Record(0.f, Layers(layers)));
+  }
+
+  {  // Invalid animations.
+    const PoseHistory::Layer null[] = {{NULL, 0.f, 1.f}};
+    EXPECT_FALSE(history.Record(0.f, Layers(null)));
+    const PoseHistory::Layer big[] = {{too_big, 0.f, 1.f}};
+    EXPECT_FALSE(history.Record(0.f, Layers(big)));
+  }
+  EXPECT_EQ(history.num_records(), 0);
+
+  const PoseHistory::Layer layers[] = {{animation, 0.f, 1.f}};
+  EXPECT_TRUE(history.Record(1.f, Layers(layers)));
+  EXPECT_EQ(history.num_records(), 1);
+
+  // Time must increase.
+  EXPECT_FALSE(history.Record(1.f, Layers(layers)));
+  EXPECT_FALSE(history.Record(.5f, Layers(layers)));
+  EXPECT_EQ(history.num_records(), 1);
+
+  // Before the oldest record.
+  EXPECT_FALSE(history.Evaluate(.9f, all, Models(models)));
+
+  // Output too small.
+  EXPECT_FALSE(history.Evaluate(
+    1.f, all, Models(models, 5)));
+
+  // Invalid joint.
+  const uint16_t invalid[] = {0, 6};
+  EXPECT_FALSE(history.Evaluate(
+    1.f, ozz::Range<const uint16_t>(invalid), Models(models)));
+
+  EXPECT_TRUE(history.Evaluate(1.f, all, Models(models)));
+  EXPECT_TRUE(history.Evaluate(2.f, all, Models(models)));
+
+  // Empty record, evaluated as the bind pose.
+  EXPECT_TRUE(history.Record(2.f, Layers()));
+  EXPECT_TRUE(history.Evaluate(2.f, all, Models(models)));
+  EXPECT_SIMDFLOAT_EQ(models[0].cols[3], 0.f, 0.f, 0.f, 1.f);
+
+  history.Clear();
+  EXPECT_EQ(history.num_records(), 0);
+  EXPECT_FALSE(history.Evaluate(2.f, all, Models(models)));
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(too_big);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(Rewind, PoseHistory) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  PoseHistory history(*skeleton, 8);
+  const ozz::Range<const uint16_t> all;
+
+  // Records 12 ticks of 1/20s, the animation playing at half speed from
+  // simulation time 10. Only the last 8 ones remain.
+  for (int i = 0; i < 12; ++i) {
+    const PoseHistory::Layer layers[] = {{animation, i * .025f, 1.f}};
+    ASSERT_TRUE(history.Record(10.f + i * .05f, Layers(layers)));
+  }
+  EXPECT_EQ(history.num_records(), 8);
+  EXPECT_FLOAT_EQ(history.oldest_time(), 10.2f);
+  EXPECT_FLOAT_EQ(history.newest_time(), 10.55f);
+
+  ozz::math::Float4x4 models[6];
+  EXPECT_FALSE(history.Evaluate(10.15f, all, Models(models)));
+
+  // Rewinds to recorded times, from the newest to the oldest.
+  for (int i = 11; i >= 4; --i) {
+    ASSERT_TRUE(history.Evaluate(10.f + i * .05f, all, Models(models)));
+    EXPECT_SIMDFLOAT_EQ_EST(models[0].cols[3], i * .025f, 0.f, 0.f, 1.f);
+  }
+
+  // Times in between records are interpolated.
+  ASSERT_TRUE(history.Evaluate(10.325f, all, Models(models)));
+  EXPECT_SIMDFLOAT_EQ_EST(models[0].cols[3], .1625f, 0.f, 0.f, 1.f);
+
+  // Times after the newest record use the newest one.
+  ASSERT_TRUE(history.Evaluate(11.f, all, Models(models)));
+  EXPECT_SIMDFLOAT_EQ_EST(models[0].cols[3], .275f, 0.f, 0.f, 1.f);
+
+  // Loops aren't interpolated.
+  const PoseHistory::Layer looped[] = {{animation, 0.f, 1.f}};
+  ASSERT_TRUE(history.Record(10.6f, Layers(looped)));
+  ASSERT_TRUE(history.Evaluate(10.575f, all, Models(models)));
+  EXPECT_SIMDFLOAT_EQ_EST(models[0].cols[3], .275f, 0.f, 0.f, 1.f);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(Layers, PoseHistory) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* forward = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(forward != NULL);
+  Animation* backward = BuildAnimation(6, -2.f);
+  ASSERT_TRUE(backward != NULL);
+
+  PoseHistory history(*skeleton, 4);
+  for (int i = 0; i < 4; ++i) {
+    const PoseHistory::Layer layers[] = {
+      {forward, i * .1f, .75f},
+      {backward, i * .1f, .25f}};
+    ASSERT_TRUE(history.Record(i * .1f, Layers(layers)));
+  }
+
+  // Evaluates the root and j2 only, other matrices are left unchanged.
+  ozz::math::Float4x4 models[6];
+  for (int i = 0; i < 6; ++i) {
+    models[i] = ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load1(2.f));
+  }
+  const uint16_t joints[] = {0, 3};
+  ASSERT_TRUE(history.Evaluate(.2f, ozz::Range<const uint16_t>(joints),
+                               Models(models)));
+  EXPECT_SIMDFLOAT_EQ_EST(models[0].cols[3], .05f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ_EST(models[3].cols[3], .05f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(models[1].cols[0], 2.f, 0.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(models[1].cols[3], 0.f, 0.f, 0.f, 1.f);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(backward);
+  allocator->Delete(forward);
+  allocator->Delete(skeleton);
+}
@@ -0,0 +1,332 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/procedural_jobs.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::BatchJiggleJob;
+using ozz::animation::JiggleJob;
+using ozz::animation::LeanJob;
+using ozz::animation::SoaJiggleState;
+
+TEST(JiggleJobValidity, ProceduralJobs) {
+  const ozz::math::SoaTransform input[2] = {
+    ozz::math::SoaTransform::identity(), ozz::math::SoaTransform::identity()};
+  const ozz::math::SimdFloat4 weights[2] = {
+    ozz::math::simd_float4::one(), ozz::math::simd_float4::one()};
+  SoaJiggleState state[2];
+  ozz::math::SoaTransform output[2];
+
+  { // Empty/default job.
+    JiggleJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  JiggleJob valid;
+  valid.reset = true;
+  valid.input.begin = input;
+  valid.input.end = input + 2;
+  valid.state.begin = state;
+  valid.state.end = state + 2;
+  valid.output.begin = output;
+  valid.output.end = output + 2;
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_TRUE(valid.Run());
+
+  { // Invalid parameters.
+    JiggleJob job = valid;
+    job.delta_time = -1.f;
+    EXPECT_FALSE(job.Validate());
+    job.delta_time = 1.f;
+    job.stiffness = 0.f;
+    EXPECT_FALSE(job.Validate());
+    job.stiffness = 1.f;
+    job.damping = -1.f;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Invalid state and output.
+    JiggleJob job = valid;
+    job.state.end = state + 1;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+    job.output.begin = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Joint weights.
+    JiggleJob job = valid;
+    job.joint_weights.end = weights + 2;
+    EXPECT_FALSE(job.Validate());
+    job.joint_weights.begin = weights;
+    job.joint_weights.end = weights + 1;
+    EXPECT_FALSE(job.Validate());
+    job.joint_weights.end = weights + 2;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  { // Smaller input is valid.
+    JiggleJob job = valid;
+    job.input.end = input + 1;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Jiggle, ProceduralJobs) {
+  ozz::math::SoaTransform input[1] = {ozz::math::SoaTransform::identity()};
+  SoaJiggleState state[1];
+  ozz::math::SoaTransform output[1];
+
+  // Joint 3 doesn't jiggle, joint 2 is half way.
+  const ozz::math::SimdFloat4 weights[1] = {
+    ozz::math::simd_float4::Load(1.f, 1.f, .5f, 0.f)};
+
+  JiggleJob job;
+  job.delta_time = 1.f / 60.f;
+  job.joint_weights.begin = weights;
+  job.joint_weights.end = weights + 1;
+  job.input.begin = input;
+  job.input.end = input + 1;
+  job.state.begin = state;
+  job.state.end = state + 1;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  // Reset matches the input.
+  job.reset = true;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 0.f, 0.f, 0.f,
+                                             0.f, 0.f, 0.f, 0.f,
+                                             0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ(output[0].rotation, 0.f, 0.f, 0.f, 0.f,
+                                              0.f, 0.f, 0.f, 0.f,
+                                              0.f, 0.f, 0.f, 0.f,
+                                              1.f, 1.f, 1.f, 1.f);
+  job.reset = false;
+
+  // Moves and rotates the input suddenly, springs lag behind.
+  const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+  const float s = std::sin(ozz::math::kPi_2 * .5f);
+  input[0].translation.x = one;
+  input[0].rotation.x = ozz::math::simd_float4::Load1(s);
+  input[0].rotation.w = ozz::math::simd_float4::Load1(s);
+  ASSERT_TRUE(job.Run());
+  const float x0 = ozz::math::GetX(output[0].translation.x);
+  EXPECT_GT(x0, 0.f);
+  EXPECT_LT(x0, 1.f);
+  EXPECT_FLOAT_EQ(ozz::math::GetZ(output[0].translation.x), (1.f + x0) * .5f);
+  EXPECT_FLOAT_EQ(ozz::math::GetW(output[0].translation.x), 1.f);
+  EXPECT_LT(ozz::math::GetX(output[0].rotation.x), s);
+  EXPECT_FLOAT_EQ(ozz::math::GetW(output[0].rotation.x), s);
+  EXPECT_SIMDINT_EQ(ozz::math::IsNormalizedEst(output[0].rotation),
+                    -1, -1, -1, -1);
+
+  // Springs converge to the input, whatever the frame rate.
+  job.delta_time = 1.f;
+  for (int i = 0; i < 60; ++i) {
+    ASSERT_TRUE(job.Run());
+  }
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 1.f, 1.f, 1.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, s, s, s, s,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  s, s, s, s);
+}
+
+TEST(LeanJobValidity, ProceduralJobs) {
+  const ozz::math::SoaTransform input[2] = {
+    ozz::math::SoaTransform::identity(), ozz::math::SoaTransform::identity()};
+  const ozz::math::SimdFloat4 weights[2] = {
+    ozz::math::simd_float4::one(), ozz::math::simd_float4::one()};
+  ozz::math::SoaTransform output[2];
+
+  { // Empty/default job.
+    LeanJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  LeanJob valid;
+  valid.joint_weights.begin = weights;
+  valid.joint_weights.end = weights + 2;
+  valid.input.begin = input;
+  valid.input.end = input + 2;
+  valid.output.begin = output;
+  valid.output.end = output + 2;
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_TRUE(valid.Run());
+
+  { // Invalid axis.
+    LeanJob job = valid;
+    job.axis = ozz::math::Float3(1.f, 1.f, 0.f);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Invalid weights and output.
+    LeanJob job = valid;
+    job.joint_weights.end = weights + 1;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  { // Smaller input is valid.
+    LeanJob job = valid;
+    job.input.end = input + 1;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Lean, ProceduralJobs) {
+  ozz::math::SoaTransform input[1] = {ozz::math::SoaTransform::identity()};
+  input[0].translation.y = ozz::math::simd_float4::one();
+
+  // Lean is distributed over 3 joints.
+  const ozz::math::SimdFloat4 weights[1] = {
+    ozz::math::simd_float4::Load(1.f, .5f, 0.f, -1.f)};
+
+  LeanJob job;
+  job.axis = ozz::math::Float3::z_axis();
+  job.angle = ozz::math::kPi_2;
+  job.joint_weights.begin = weights;
+  job.joint_weights.end = weights + 1;
+  job.input.begin = input;
+  job.input.end = input + 1;
+  job.output.begin = input;
+  job.output.end = input + 1;
+  ASSERT_TRUE(job.Run());
+
+  // Translations and scales are unchanged, negative weights are 0.
+  const float s = std::sin(ozz::math::kPi_2 * .5f);
+  const float hz = s * .5f;
+  const float hw = (s - 1.f) * .5f + 1.f;
+  const float n = 1.f / std::sqrt(hz * hz + hw * hw);
+  EXPECT_SOAFLOAT3_EQ(input[0].translation, 0.f, 0.f, 0.f, 0.f,
+                                            1.f, 1.f, 1.f, 1.f,
+                                            0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(input[0].scale, 1.f, 1.f, 1.f, 1.f,
+                                      1.f, 1.f, 1.f, 1.f,
+                                      1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAQUATERNION_EQ_EST(input[0].rotation,
+                              0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f,
+                              s, hz * n, 0.f, 0.f,
+                              s, hw * n, 1.f, 1.f);
+}
+
+TEST(BatchJiggle, ProceduralJobs) {
+  // Two characters, the second one with a smaller pose.
+  ozz::math::SoaTransform inputs[3] = {ozz::math::SoaTransform::identity(),
+                                       ozz::math::SoaTransform::identity(),
+                                       ozz::math::SoaTransform::identity()};
+  SoaJiggleState states[3];
+  SoaJiggleState reference_states[3];
+  ozz::math::SoaTransform outputs[3];
+  ozz::math::SoaTransform reference_outputs[3];
+
+  BatchJiggleJob::Item items[2];
+  items[0].reset = true;
+  items[0].input.begin = inputs;
+  items[0].input.end = inputs + 2;
+  items[0].state.begin = states;
+  items[0].state.end = states + 2;
+  items[0].output.begin = outputs;
+  items[0].output.end = outputs + 2;
+  items[1].reset = true;
+  items[1].input.begin = inputs + 2;
+  items[1].input.end = inputs + 3;
+  items[1].state.begin = states + 2;
+  items[1].state.end = states + 3;
+  items[1].output.begin = outputs + 2;
+  items[1].output.end = outputs + 3;
+
+  { // Empty/default job.
+    BatchJiggleJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  BatchJiggleJob job;
+  job.delta_time = 1.f / 30.f;
+  job.items.begin = items;
+  job.items.end = items + 2;
+  EXPECT_TRUE(job.Validate());
+
+  { // Invalid item.
+    BatchJiggleJob::Item invalid_items[2] = {items[0], items[1]};
+    invalid_items[1].output.end = outputs + 2;
+    BatchJiggleJob invalid = job;
+    invalid.items.begin = invalid_items;
+    invalid.items.end = invalid_items + 2;
+    EXPECT_FALSE(invalid.Validate());
+    invalid.stiffness = 0.f;
+    invalid.items.end = invalid_items + 1;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  // Batch output matches a JiggleJob per character.
+  JiggleJob reference;
+  reference.delta_time = job.delta_time;
+  for (int frame = 0; frame < 4; ++frame) {
+    const ozz::math::SimdFloat4 offset =
+      ozz::math::simd_float4::Load1(static_cast<float>(frame));
+    for (int i = 0; i < 3; ++i) {
+      inputs[i].translation.y = offset;
+    }
+    ASSERT_TRUE(job.Run());
+    for (int c = 0; c < 2; ++c) {
+      const ptrdiff_t begin = items[c].input.begin - inputs;
+      reference.reset = items[c].reset;
+      reference.input = items[c].input;
+      reference.state.begin = reference_states + begin;
+      reference.state.end = reference_states + begin + items[c].input.Count();
+      reference.output.begin = reference_outputs + begin;
+      reference.output.end =
+        reference_outputs + begin + items[c].input.Count();
+      ASSERT_TRUE(reference.Run());
+    }
+    EXPECT_EQ(std::memcmp(outputs, reference_outputs, sizeof(outputs)), 0);
+    items[0].reset = items[1].reset = false;
+  }
+}
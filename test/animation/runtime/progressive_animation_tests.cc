@@ -0,0 +1,172 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/progressive_animation.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/archive_container.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::ProgressiveAnimation;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a 2 tracks animation of _duration, whose first track has _num_keys
+// translation keys.
+Animation* BuildLevel(int _num_keys, float _duration) {
+  RawAnimation raw_animation;
+  raw_animation.duration = _duration;
+  raw_animation.tracks.resize(2);
+  for (int i = 0; i < _num_keys; ++i) {
+    const RawAnimation::TranslationKey key = {
+      _duration * i / _num_keys, ozz::math::Float3(i * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  ozz::animation::offline::AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Levels, ProgressiveAnimation) {
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  ProgressiveAnimation progressive;
+  EXPECT_EQ(progressive.num_levels(), 0);
+  EXPECT_EQ(progressive.num_resident_levels(), 0);
+  EXPECT_TRUE(progressive.animation() == NULL);
+  EXPECT_TRUE(progressive.level(0) == NULL);
+
+  // No level to push.
+  Animation* extra = BuildLevel(2, 1.f);
+  EXPECT_FALSE(progressive.PushLevel(extra));
+
+  progressive.Reset(3);
+  EXPECT_EQ(progressive.num_levels(), 3);
+  EXPECT_EQ(progressive.num_resident_levels(), 0);
+  EXPECT_FALSE(progressive.PushLevel(NULL));
+
+  Animation* levels[3] = {
+    BuildLevel(2, 1.f), BuildLevel(5, 1.f), BuildLevel(11, 1.f)};
+  const size_t empty_size = progressive.size();
+  EXPECT_TRUE(progressive.PushLevel(levels[0]));
+  EXPECT_TRUE(progressive.animation() == levels[0]);
+  EXPECT_EQ(progressive.size(), empty_size + levels[0]->size());
+
+  // Levels must be the same clip.
+  Animation* mismatch = BuildLevel(5, 2.f);
+  EXPECT_FALSE(progressive.PushLevel(mismatch));
+  allocator->Delete(mismatch);
+
+  EXPECT_TRUE(progressive.PushLevel(levels[1]));
+  EXPECT_TRUE(progressive.PushLevel(levels[2]));
+  EXPECT_FALSE(progressive.PushLevel(extra));
+  allocator->Delete(extra);
+  EXPECT_EQ(progressive.num_resident_levels(), 3);
+  EXPECT_TRUE(progressive.animation() == levels[2]);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(progressive.level(i) == levels[i]);
+  }
+  EXPECT_TRUE(progressive.level(3) == NULL);
+
+  // Releases finest levels.
+  progressive.ReleaseLevels(1);
+  EXPECT_EQ(progressive.num_levels(), 3);
+  EXPECT_EQ(progressive.num_resident_levels(), 1);
+  EXPECT_TRUE(progressive.animation() == levels[0]);
+  EXPECT_TRUE(progressive.level(1) == NULL);
+
+  // Levels can be pushed again.
+  EXPECT_TRUE(progressive.PushLevel(BuildLevel(5, 1.f)));
+  EXPECT_EQ(progressive.num_resident_levels(), 2);
+
+  progressive.Reset(1);
+  EXPECT_EQ(progressive.num_levels(), 1);
+  EXPECT_EQ(progressive.num_resident_levels(), 0);
+  EXPECT_TRUE(progressive.animation() == NULL);
+}
+
+TEST(Serialize, ProgressiveAnimation) {
+  const int num_keys[] = {2, 5, 11};
+  ProgressiveAnimation progressive;
+  progressive.Reset(3);
+
+  {  // Levels must all be resident.
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream);
+    const int64_t position = stream.Tell();
+    EXPECT_FALSE(progressive.Save(NULL));
+    EXPECT_FALSE(progressive.Save(&o));
+    EXPECT_EQ(stream.Tell(), position);
+  }
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(progressive.PushLevel(BuildLevel(num_keys[i], 1.f)));
+  }
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    EXPECT_TRUE(progressive.Save(&o));
+  }
+
+  // Loads levels one by one, coarsest first.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  ozz::io::IContainer<Animation> container(&i);
+  ASSERT_TRUE(container.valid());
+  EXPECT_EQ(container.count(), 3);
+
+  ProgressiveAnimation loaded;
+  EXPECT_FALSE(loaded.LoadLevel(NULL));
+  for (int l = 0; l < 3; ++l) {
+    ASSERT_TRUE(loaded.LoadLevel(&container));
+    EXPECT_EQ(loaded.num_levels(), 3);
+    EXPECT_EQ(loaded.num_resident_levels(), l + 1);
+    const Animation* animation = loaded.animation();
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_tracks(), 2);
+    EXPECT_FLOAT_EQ(animation->duration(), 1.f);
+    EXPECT_EQ(animation->size(),
+              progressive.level(l)->size());
+  }
+  EXPECT_FALSE(loaded.LoadLevel(&container));
+
+  // A released level can be reloaded.
+  loaded.ReleaseLevels(2);
+  EXPECT_TRUE(loaded.LoadLevel(&container));
+  EXPECT_EQ(loaded.num_resident_levels(), 3);
+  EXPECT_EQ(loaded.animation()->size(),
+            progressive.animation()->size());
+}
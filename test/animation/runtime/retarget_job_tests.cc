@@ -0,0 +1,333 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/retarget_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/retarget_table_builder.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/retarget_table.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::RetargetJob;
+using ozz::animation::RetargetTable;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::RetargetTableBuilder;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds source skeleton:
+/*
+   root(0)
+   /     \
+ a(1)   b(2)
+  |
+ a_end(3)
+*/
+void BuildSource(RawSkeleton* _skeleton) {
+  _skeleton->roots.resize(1);
+  RawSkeleton::Joint& root = _skeleton->roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  root.children.resize(2);
+  RawSkeleton::Joint& a = root.children[0];
+  a.name = "a";
+  a.transform = ozz::math::Transform::identity();
+  a.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  a.transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+    ozz::math::Float4(0.f, 1.f, 0.f, ozz::math::kPi_2));
+  RawSkeleton::Joint& b = root.children[1];
+  b.name = "b";
+  b.transform = ozz::math::Transform::identity();
+  b.transform.translation = ozz::math::Float3(1.f, 0.f, 0.f);
+  b.transform.scale = ozz::math::Float3(2.f, 2.f, 2.f);
+  a.children.resize(1);
+  RawSkeleton::Joint& a_end = a.children[0];
+  a_end.name = "a_end";
+  a_end.transform = ozz::math::Transform::identity();
+  a_end.transform.translation = ozz::math::Float3(0.f, .5f, 0.f);
+}
+
+// Builds target skeleton, whose c joint isn't in the source skeleton:
+/*
+       root(0)
+   /     |    \
+ a(1)  c(2)   b(3)
+  |
+ a_end(4)
+*/
+void BuildTarget(RawSkeleton* _skeleton) {
+  _skeleton->roots.resize(1);
+  RawSkeleton::Joint& root = _skeleton->roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.transform.translation = ozz::math::Float3(0.f, 2.f, 0.f);
+  root.children.resize(3);
+  RawSkeleton::Joint& a = root.children[0];
+  a.name = "a";
+  a.transform = ozz::math::Transform::identity();
+  a.transform.translation = ozz::math::Float3(0.f, 3.f, 0.f);
+  RawSkeleton::Joint& c = root.children[1];
+  c.name = "c";
+  c.transform = ozz::math::Transform::identity();
+  c.transform.translation = ozz::math::Float3(0.f, 0.f, 1.f);
+  c.transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+    ozz::math::Float4(1.f, 0.f, 0.f, ozz::math::kPi_2));
+  RawSkeleton::Joint& b = root.children[2];
+  b.name = "b";
+  b.transform = ozz::math::Transform::identity();
+  b.transform.translation = ozz::math::Float3(2.f, 0.f, 0.f);
+  a.children.resize(1);
+  RawSkeleton::Joint& a_end = a.children[0];
+  a_end.name = "a_end";
+  a_end.transform = ozz::math::Transform::identity();
+  a_end.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+}
+
+// Extracts transform of joint _joint from soa _pose.
+ozz::math::Transform GetTransform(const ozz::math::SoaTransform* _pose,
+                                  int _joint) {
+  const ozz::math::SoaTransform& soa = _pose[_joint / 4];
+  ozz::math::SimdFloat4 translations[4];
+  ozz::math::SimdFloat4 rotations[4];
+  ozz::math::SimdFloat4 scales[4];
+  ozz::math::Transpose3x4(&soa.translation.x, translations);
+  ozz::math::Transpose4x4(&soa.rotation.x, rotations);
+  ozz::math::Transpose3x4(&soa.scale.x, scales);
+  ozz::math::Transform transform;
+  ozz::math::Store3PtrU(translations[_joint & 3], &transform.translation.x);
+  ozz::math::StorePtrU(rotations[_joint & 3], &transform.rotation.x);
+  ozz::math::Store3PtrU(scales[_joint & 3], &transform.scale.x);
+  return transform;
+}
+}  // namespace
+
+TEST(JobValidity, RetargetJob) {
+  RawSkeleton source;
+  BuildSource(&source);
+  RawSkeleton target;
+  BuildTarget(&target);
+  RetargetTableBuilder builder;
+  RetargetTable* table = builder(source, target);
+  ASSERT_TRUE(table != NULL);
+
+  ozz::math::SoaTransform input[1];
+  ozz::math::SoaTransform output[2];
+
+  {  // Default job.
+    RetargetJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // No input.
+    RetargetJob job;
+    job.table = table;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // No output.
+    RetargetJob job;
+    job.table = table;
+    job.input = input;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Output too small.
+    RetargetJob job;
+    job.table = table;
+    job.input = input;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Valid.
+    RetargetJob job;
+    job.table = table;
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(table);
+}
+
+TEST(Retarget, RetargetJob) {
+  RawSkeleton raw_source;
+  BuildSource(&raw_source);
+  RawSkeleton raw_target;
+  BuildTarget(&raw_target);
+
+  SkeletonBuilder skeleton_builder;
+  Skeleton* source = skeleton_builder(raw_source);
+  ASSERT_TRUE(source != NULL);
+  Skeleton* target = skeleton_builder(raw_target);
+  ASSERT_TRUE(target != NULL);
+
+  RetargetTableBuilder builder;
+  RetargetTable* table = builder(raw_source, raw_target);
+  ASSERT_TRUE(table != NULL);
+  EXPECT_EQ(table->num_joints(), 5);
+  EXPECT_EQ(table->num_source_joints(), 4);
+
+  // Target joints are mapped by name.
+  EXPECT_EQ(table->sources().Count(), 8u);
+  EXPECT_EQ(table->sources().begin[0], 0);
+  EXPECT_EQ(table->sources().begin[1], 1);
+  EXPECT_EQ(table->sources().begin[2], Skeleton::kNoParentIndex);
+  EXPECT_EQ(table->sources().begin[3], 2);
+  EXPECT_EQ(table->sources().begin[4], 3);
+
+  ozz::math::SoaTransform output[2];
+  RetargetJob job;
+  job.table = table;
+  job.output = output;
+
+  {  // Source bind pose is retargeted to target bind pose.
+    job.input = source->bind_pose();
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < target->num_joints(); ++i) {
+      const ozz::math::Transform bind =
+        GetTransform(target->bind_pose().begin, i);
+      const ozz::math::Transform transform = GetTransform(output, i);
+      EXPECT_FLOAT3_EQ(transform.translation, bind.translation.x,
+                       bind.translation.y, bind.translation.z);
+      EXPECT_QUATERNION_EQ(transform.rotation, bind.rotation.x,
+                           bind.rotation.y, bind.rotation.z, bind.rotation.w);
+      EXPECT_FLOAT3_EQ(transform.scale, bind.scale.x, bind.scale.y,
+                       bind.scale.z);
+    }
+  }
+
+  {  // Deviations from the source bind pose are retargeted.
+    ozz::math::SoaTransform input[1] = {source->bind_pose().begin[0]};
+
+    // Root is moved along x, in the source skeleton proportions.
+    input[0].translation.x = ozz::math::simd_float4::Load(1.f, 0.f, 1.f, 0.f);
+
+    // a is rotated around its own x axis.
+    const ozz::math::Quaternion a_rotation =
+      ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float4(0.f, 1.f, 0.f, ozz::math::kPi_2)) *
+      ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float4(1.f, 0.f, 0.f, ozz::math::kPi_2));
+    input[0].rotation.x =
+      ozz::math::simd_float4::Load(0.f, a_rotation.x, 0.f, 0.f);
+    input[0].rotation.y =
+      ozz::math::simd_float4::Load(0.f, a_rotation.y, 0.f, 0.f);
+    input[0].rotation.z =
+      ozz::math::simd_float4::Load(0.f, a_rotation.z, 0.f, 0.f);
+    input[0].rotation.w =
+      ozz::math::simd_float4::Load(1.f, a_rotation.w, 1.f, 1.f);
+
+    // b is scaled twice its bind pose scale.
+    input[0].scale.x = ozz::math::simd_float4::Load(1.f, 1.f, 4.f, 1.f);
+
+    job.input = input;
+    ASSERT_TRUE(job.Run());
+
+    const ozz::math::Transform root = GetTransform(output, 0);
+    EXPECT_FLOAT3_EQ(root.translation, 2.f, 2.f, 0.f);
+    EXPECT_QUATERNION_EQ(root.rotation, 0.f, 0.f, 0.f, 1.f);
+
+    const ozz::math::Transform a = GetTransform(output, 1);
+    EXPECT_FLOAT3_EQ(a.translation, 0.f, 3.f, 0.f);
+    EXPECT_QUATERNION_EQ(a.rotation, .7071068f, 0.f, 0.f, .7071068f);
+
+    const ozz::math::Transform c = GetTransform(output, 2);
+    EXPECT_FLOAT3_EQ(c.translation, 0.f, 0.f, 1.f);
+    EXPECT_QUATERNION_EQ(c.rotation, .7071068f, 0.f, 0.f, .7071068f);
+    EXPECT_FLOAT3_EQ(c.scale, 1.f, 1.f, 1.f);
+
+    const ozz::math::Transform b = GetTransform(output, 3);
+    EXPECT_FLOAT3_EQ(b.translation, 2.f, 0.f, 0.f);
+    EXPECT_FLOAT3_EQ(b.scale, 2.f, 1.f, 1.f);
+
+    const ozz::math::Transform a_end = GetTransform(output, 4);
+    EXPECT_FLOAT3_EQ(a_end.translation, 0.f, 1.f, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(table);
+  ozz::memory::default_allocator()->Delete(source);
+  ozz::memory::default_allocator()->Delete(target);
+}
+
+TEST(Serialize, RetargetJob) {
+  RawSkeleton source;
+  BuildSource(&source);
+  RawSkeleton target;
+  BuildTarget(&target);
+  RetargetTableBuilder builder;
+  RetargetTable* o_table = builder(source, target);
+  ASSERT_TRUE(o_table != NULL);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_table;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    RetargetTable i_table;
+    i >> i_table;
+
+    // Compares tables.
+    ASSERT_EQ(i_table.num_joints(), o_table->num_joints());
+    EXPECT_EQ(i_table.num_source_joints(), o_table->num_source_joints());
+    for (size_t j = 0; j < i_table.sources().Count(); ++j) {
+      EXPECT_EQ(i_table.sources().begin[j], o_table->sources().begin[j]);
+    }
+    for (int j = 0; j < i_table.num_soa_joints(); ++j) {
+      const RetargetTable::SoaCorrection& ic = i_table.corrections().begin[j];
+      const RetargetTable::SoaCorrection& oc = o_table->corrections().begin[j];
+      EXPECT_TRUE(ozz::math::AreAllTrue(ic.rotation == oc.rotation));
+      EXPECT_TRUE(ozz::math::AreAllTrue(ic.translation == oc.translation));
+      EXPECT_TRUE(ozz::math::AreAllTrue(
+        ic.translation_ratio == oc.translation_ratio));
+      EXPECT_TRUE(ozz::math::AreAllTrue(ic.scale == oc.scale));
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(o_table);
+}
@@ -0,0 +1,210 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/root_motion_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/root_motion_builder.h"
+#include "ozz/animation/runtime/root_motion.h"
+
+using ozz::animation::RootMotion;
+using ozz::animation::RootMotionJob;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RootMotionBuilder;
+
+namespace {
+// Builds a 2s root motion, moving 2m forward while turning by pi/2, then 1m
+// sideways.
+RootMotion* BuildMotion() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(1);
+  RawAnimation::JointTrack& root = raw_animation.tracks[0];
+  const float times[] = {0.f, 1.f, 2.f};
+  const ozz::math::Float3 translations[] = {ozz::math::Float3(0.f, 0.f, 0.f),
+                                            ozz::math::Float3(0.f, 0.f, 2.f),
+                                            ozz::math::Float3(2.f, 0.f, 2.f)};
+  const float yaws[] = {0.f, ozz::math::kPi_2, ozz::math::kPi_2};
+  for (int i = 0; i < 3; ++i) {
+    const RawAnimation::TranslationKey translation = {times[i],
+                                                      translations[i]};
+    root.translations.push_back(translation);
+    const RawAnimation::RotationKey rotation = {
+        times[i], ozz::math::Quaternion::FromAxisAngle(
+                      ozz::math::Float4(0.f, 1.f, 0.f, yaws[i]))};
+    root.rotations.push_back(rotation);
+  }
+  RootMotionBuilder builder;
+  return builder(raw_animation, NULL);
+}
+}  // namespace
+
+TEST(JobValidity, RootMotionJob) {
+  RootMotion motion;
+  ozz::math::Float3 translation;
+  float yaw;
+
+  {  // Default is invalid.
+    RootMotionJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Missing output.
+    RootMotionJob job;
+    job.motion = &motion;
+    job.translation = &translation;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid, empty motion is motionless.
+    RootMotionJob job;
+    job.motion = &motion;
+    job.translation = &translation;
+    job.yaw = &yaw;
+    job.to = 1.f;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, 0.f, 0.f, 0.f);
+    EXPECT_FLOAT_EQ(yaw, 0.f);
+  }
+}
+
+TEST(Delta, RootMotionJob) {
+  RootMotion* motion = BuildMotion();
+  ASSERT_TRUE(motion != NULL);
+
+  ozz::math::Float3 translation;
+  float yaw;
+  RootMotionJob job;
+  job.motion = motion;
+  job.translation = &translation;
+  job.yaw = &yaw;
+
+  {  // No motion.
+    job.from = job.to = .3f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, 0.f, 0.f, 0.f);
+    EXPECT_FLOAT_EQ(yaw, 0.f);
+  }
+  {  // Forward.
+    job.from = 0.f;
+    job.to = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, 0.f, 0.f, 2.f);
+    EXPECT_FLOAT_EQ(yaw, ozz::math::kPi_2);
+  }
+  {  // Translation is expressed in the frame at "from" time.
+    job.from = .5f;
+    job.to = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, -.7071068f, 0.f, .7071068f);
+    EXPECT_FLOAT_EQ(yaw, ozz::math::kPi_2 * .5f);
+
+    job.from = 1.f;
+    job.to = 2.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, 0.f, 0.f, 2.f);
+    EXPECT_NEAR(yaw, 0.f, 1e-5f);
+  }
+  {  // Backward.
+    job.from = 1.f;
+    job.to = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, 2.f, 0.f, 0.f);
+    EXPECT_FLOAT_EQ(yaw, -ozz::math::kPi_2);
+  }
+  {  // Times are clamped.
+    job.from = -1.f;
+    job.to = 3.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, 2.f, 0.f, 2.f);
+    EXPECT_FLOAT_EQ(yaw, ozz::math::kPi_2);
+  }
+  {  // Loops over the end.
+    job.loop = true;
+    job.from = 1.5f;
+    job.to = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, 0.f, 0.f, 2.f);
+    EXPECT_FLOAT_EQ(yaw, ozz::math::kPi_2 * .5f);
+
+    // Doesn't loop if "to" is after "from".
+    job.from = 0.f;
+    job.to = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(translation, 0.f, 0.f, 2.f);
+    EXPECT_FLOAT_EQ(yaw, ozz::math::kPi_2);
+  }
+
+  ozz::memory::default_allocator()->Delete(motion);
+}
+
+TEST(Serialize, RootMotionJob) {
+  RootMotion* o_motion = BuildMotion();
+  ASSERT_TRUE(o_motion != NULL);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_motion;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    RootMotion i_motion;
+    i >> i_motion;
+
+    // Compares motions.
+    EXPECT_FLOAT_EQ(i_motion.duration(), o_motion->duration());
+    ASSERT_EQ(i_motion.num_keys(), o_motion->num_keys());
+    for (int k = 0; k < i_motion.num_keys(); ++k) {
+      const RootMotion::Key& ik = i_motion.keys().begin[k];
+      const RootMotion::Key& ok = o_motion->keys().begin[k];
+      EXPECT_FLOAT_EQ(ik.time, ok.time);
+      EXPECT_FLOAT3_EQ(ik.translation, ok.translation.x, ok.translation.y,
+                       ok.translation.z);
+      EXPECT_FLOAT_EQ(ik.yaw, ok.yaw);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(o_motion);
+}
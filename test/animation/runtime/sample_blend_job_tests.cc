@@ -0,0 +1,425 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sample_blend_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::SampleBlendJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds an animation of _num_tracks tracks, whose keys depend on _seed.
+Animation* BuildAnimation(int _num_tracks, float _seed, bool _hermite) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.interpolation =
+    _hermite ? RawAnimation::kHermite : RawAnimation::kLinear;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 3; ++k) {
+      const float time = k * (.5f + (i % 5) * .1f);
+      const float value = _seed + i + k * _seed;
+      const RawAnimation::TranslationKey t = {
+        time, ozz::math::Float3(value, -value, value * .5f)};
+      track.translations.push_back(t);
+      track.translation_tangents.push_back(ozz::math::Float3(1.f, 0.f, -1.f));
+      const float angle = value * .1f;
+      const RawAnimation::RotationKey r = {
+        time, ozz::math::Quaternion(0.f, std::sin(angle), 0.f,
+                                    std::cos(angle))};
+      track.rotations.push_back(r);
+      track.rotation_tangents.push_back(ozz::math::Float4::zero());
+      const RawAnimation::ScaleKey s = {
+        time, ozz::math::Float3(1.f + value * .1f, 1.f, 1.f)};
+      track.scales.push_back(s);
+      track.scale_tangents.push_back(ozz::math::Float3::zero());
+    }
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Compares _a and _b soa transforms, with _tolerance.
+void ExpectNear(const ozz::math::SoaTransform& _a,
+                const ozz::math::SoaTransform& _b,
+                float _tolerance = 1e-4f) {
+  const ozz::math::SimdFloat4* a =
+    reinterpret_cast<const ozz::math::SimdFloat4*>(&_a);
+  const ozz::math::SimdFloat4* b =
+    reinterpret_cast<const ozz::math::SimdFloat4*>(&_b);
+  for (size_t i = 0; i < sizeof(_a) / sizeof(*a); ++i) {
+    float fa[4];
+    float fb[4];
+    ozz::math::StorePtrU(a[i], fa);
+    ozz::math::StorePtrU(b[i], fb);
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(fa[j], fb[j], _tolerance);
+    }
+  }
+}
+}  // namespace
+
+TEST(JobValidity, SampleBlendJob) {
+  Animation* animation = BuildAnimation(8, 1.f, false);
+  ASSERT_TRUE(animation != NULL);
+  SamplingCache cache(8);
+  SamplingCache small_cache(4);
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_poses[2] = {identity, identity};
+  ozz::math::SoaTransform output[2];
+  const ozz::math::SimdFloat4 joint_weights[2] = {
+    ozz::math::simd_float4::one(), ozz::math::simd_float4::one()};
+
+  SampleBlendJob::Layer layers[1];
+  layers[0].animation = animation;
+  layers[0].cache = &cache;
+  layers[0].weight = 1.f;
+
+  { // Empty/default job.
+    SampleBlendJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  SampleBlendJob job;
+  job.layers.begin = layers;
+  job.layers.end = layers + 1;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 2;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  EXPECT_TRUE(job.Validate());
+
+  { // Invalid threshold.
+    SampleBlendJob invalid = job;
+    invalid.threshold = 0.f;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // Invalid output.
+    SampleBlendJob invalid = job;
+    invalid.output.end = output + 1;
+    EXPECT_FALSE(invalid.Validate());
+    EXPECT_FALSE(invalid.Run());
+  }
+
+  { // Invalid layers range.
+    SampleBlendJob invalid = job;
+    invalid.layers.begin = layers + 1;
+    invalid.layers.end = layers;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // Empty layers.
+    SampleBlendJob empty = job;
+    empty.layers.end = layers;
+    EXPECT_TRUE(empty.Validate());
+  }
+
+  { // Invalid layer animation, cache and joint weights.
+    SampleBlendJob::Layer invalid_layers[1] = {layers[0]};
+    SampleBlendJob invalid = job;
+    invalid.layers.begin = invalid_layers;
+    invalid.layers.end = invalid_layers + 1;
+
+    invalid_layers[0].animation = NULL;
+    EXPECT_FALSE(invalid.Validate());
+    invalid_layers[0].animation = animation;
+    invalid_layers[0].cache = NULL;
+    EXPECT_FALSE(invalid.Validate());
+    invalid_layers[0].cache = &small_cache;
+    EXPECT_FALSE(invalid.Validate());
+    invalid_layers[0].cache = &cache;
+    EXPECT_TRUE(invalid.Validate());
+
+    invalid_layers[0].joint_weights.begin = joint_weights;
+    invalid_layers[0].joint_weights.end = joint_weights + 1;
+    EXPECT_FALSE(invalid.Validate());
+    invalid_layers[0].joint_weights.end = joint_weights + 2;
+    EXPECT_TRUE(invalid.Validate());
+    EXPECT_TRUE(invalid.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+// Compares SampleBlendJob to SamplingJob followed by a BlendingJob.
+TEST(SampleBlend, SampleBlendJob) {
+  // 40 tracks makes 10 soa joints, which is more than a chunk.
+  const int kNumTracks = 40;
+  const int kNumSoaJoints = kNumTracks / 4;
+  const int kNumLayers = 3;
+  Animation* animations[kNumLayers] = {
+    BuildAnimation(kNumTracks, 1.f, false),
+    BuildAnimation(kNumTracks, 2.f, true),
+    BuildAnimation(kNumTracks, -1.f, false)};
+  for (int i = 0; i < kNumLayers; ++i) {
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+
+  // Bind pose.
+  ozz::math::SoaTransform bind_pose[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    bind_pose[i] = ozz::math::SoaTransform::identity();
+    bind_pose[i].translation.y = ozz::math::simd_float4::Load1(i * 1.f);
+  }
+
+  // Partial layer joint weights, with soa joints of null weights.
+  ozz::math::SimdFloat4 joint_weights[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    joint_weights[i] = i % 3 ? ozz::math::simd_float4::Load(
+      .1f * i, 0.f, 1.f, .5f) : ozz::math::simd_float4::zero();
+  }
+
+  // Last layer uses a compact cache.
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  SamplingCache* caches[kNumLayers];
+  SamplingCache* reference_caches[kNumLayers];
+  for (int i = 0; i < kNumLayers; ++i) {
+    caches[i] =
+      allocator->New<SamplingCache>(kNumTracks, i == kNumLayers - 1);
+    reference_caches[i] = allocator->New<SamplingCache>(kNumTracks);
+  }
+  ozz::math::SoaTransform locals[kNumLayers][kNumSoaJoints];
+  ozz::math::SoaTransform expected[kNumSoaJoints];
+  ozz::math::SoaTransform output[kNumSoaJoints];
+
+  const float weights[][kNumLayers] = {
+    {1.f, 0.f, 0.f}, {.5f, .3f, 1.f}, {0.f, 0.f, .5f}, {.01f, .02f, .03f},
+    {0.f, 0.f, 0.f}, {2.f, 1.f, 0.f}};
+  for (size_t w = 0; w < OZZ_ARRAY_SIZE(weights); ++w) {
+    for (float time = 0.f; time < 2.2f; time += .35f) {
+      SampleBlendJob::Layer layers[kNumLayers];
+      BlendingJob::Layer reference_layers[kNumLayers];
+      for (int i = 0; i < kNumLayers; ++i) {
+        layers[i].animation = animations[i];
+        layers[i].cache = caches[i];
+        layers[i].time = time * (1.f + i * .5f);
+        layers[i].weight = weights[w][i];
+
+        SamplingJob sampling_job;
+        sampling_job.animation = animations[i];
+        sampling_job.cache = reference_caches[i];
+        sampling_job.time = layers[i].time;
+        sampling_job.output.begin = locals[i];
+        sampling_job.output.end = locals[i] + kNumSoaJoints;
+        ASSERT_TRUE(sampling_job.Run());
+
+        reference_layers[i].weight = weights[w][i];
+        reference_layers[i].transform.begin = locals[i];
+        reference_layers[i].transform.end = locals[i] + kNumSoaJoints;
+      }
+      // Last layer is partial.
+      layers[kNumLayers - 1].joint_weights.begin = joint_weights;
+      layers[kNumLayers - 1].joint_weights.end = joint_weights + kNumSoaJoints;
+      reference_layers[kNumLayers - 1].joint_weights =
+        layers[kNumLayers - 1].joint_weights;
+
+      BlendingJob blending_job;
+      blending_job.layers.begin = reference_layers;
+      blending_job.layers.end = reference_layers + kNumLayers;
+      blending_job.bind_pose.begin = bind_pose;
+      blending_job.bind_pose.end = bind_pose + kNumSoaJoints;
+      blending_job.output.begin = expected;
+      blending_job.output.end = expected + kNumSoaJoints;
+      ASSERT_TRUE(blending_job.Run());
+
+      SampleBlendJob job;
+      job.layers.begin = layers;
+      job.layers.end = layers + kNumLayers;
+      job.bind_pose.begin = bind_pose;
+      job.bind_pose.end = bind_pose + kNumSoaJoints;
+      job.output.begin = output;
+      job.output.end = output + kNumSoaJoints;
+      ASSERT_TRUE(job.Run());
+
+      for (int i = 0; i < kNumSoaJoints; ++i) {
+        ExpectNear(output[i], expected[i]);
+      }
+    }
+  }
+
+  for (int i = 0; i < kNumLayers; ++i) {
+    allocator->Delete(caches[i]);
+    allocator->Delete(reference_caches[i]);
+    allocator->Delete(animations[i]);
+  }
+}
+
+TEST(FewerTracks, SampleBlendJob) {
+  // The animation has fewer joints than the bind pose, remaining joints have
+  // a null weight and fall back to the bind pose.
+  Animation* animation = BuildAnimation(5, 1.f, false);
+  ASSERT_TRUE(animation != NULL);
+  SamplingCache cache(5);
+
+  ozz::math::SoaTransform bind_pose[3];
+  for (int i = 0; i < 3; ++i) {
+    bind_pose[i] = ozz::math::SoaTransform::identity();
+    bind_pose[i].translation.z = ozz::math::simd_float4::Load1(3.f);
+  }
+
+  SampleBlendJob::Layer layer;
+  layer.animation = animation;
+  layer.cache = &cache;
+  layer.weight = 1.f;
+  layer.time = 0.f;
+
+  SampleBlendJob job;
+  job.layers.begin = &layer;
+  job.layers.end = &layer + 1;
+  job.bind_pose.begin = bind_pose;
+  job.bind_pose.end = bind_pose + 3;
+  ozz::math::SoaTransform output[3];
+  job.output.begin = output;
+  job.output.end = output + 3;
+  ASSERT_TRUE(job.Run());
+
+  // Joint 4 is the 5th track, lanes 1 to 3 of soa joint 1 are padding.
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation,
+                          5.f, 0.f, 0.f, 0.f,
+                          -5.f, 0.f, 0.f, 0.f,
+                          2.5f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[2].translation,
+                      0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f,
+                      3.f, 3.f, 3.f, 3.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(FastNormalization, SampleBlendJob) {
+  const int kNumTracks = 40;
+  const int kNumSoaJoints = kNumTracks / 4;
+  const int kNumLayers = 2;
+  Animation* animations[kNumLayers] = {
+    BuildAnimation(kNumTracks, 1.f, false),
+    BuildAnimation(kNumTracks, 2.f, true)};
+  for (int i = 0; i < kNumLayers; ++i) {
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+
+  ozz::math::SoaTransform bind_pose[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    bind_pose[i] = ozz::math::SoaTransform::identity();
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  SamplingCache* caches[kNumLayers];
+  SamplingCache* fast_caches[kNumLayers];
+  for (int i = 0; i < kNumLayers; ++i) {
+    caches[i] = allocator->New<SamplingCache>(kNumTracks);
+    fast_caches[i] = allocator->New<SamplingCache>(kNumTracks);
+  }
+  ozz::math::SoaTransform expected[kNumSoaJoints];
+  ozz::math::SoaTransform output[kNumSoaJoints];
+
+  for (float time = 0.f; time < 2.2f; time += .35f) {
+    // Fast sampling is close to the default one, for every interpolation.
+    for (int i = 0; i < kNumLayers; ++i) {
+      SamplingJob sampling_job;
+      sampling_job.animation = animations[i];
+      sampling_job.cache = caches[i];
+      sampling_job.time = time;
+      sampling_job.output.begin = expected;
+      sampling_job.output.end = expected + kNumSoaJoints;
+      ASSERT_TRUE(sampling_job.Run());
+
+      sampling_job.cache = fast_caches[i];
+      sampling_job.output.begin = output;
+      sampling_job.output.end = output + kNumSoaJoints;
+      sampling_job.fast_normalization = true;
+      ASSERT_TRUE(sampling_job.Run());
+
+      for (int j = 0; j < kNumSoaJoints; ++j) {
+        ExpectNear(output[j], expected[j], 2e-3f);
+      }
+    }
+
+    // Fast sampling and blending is close to the default one.
+    SampleBlendJob::Layer layers[kNumLayers];
+    SampleBlendJob::Layer fast_layers[kNumLayers];
+    for (int i = 0; i < kNumLayers; ++i) {
+      layers[i].animation = animations[i];
+      layers[i].cache = caches[i];
+      layers[i].time = time;
+      layers[i].weight = .3f + i * .4f;
+      fast_layers[i] = layers[i];
+      fast_layers[i].cache = fast_caches[i];
+    }
+
+    SampleBlendJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + kNumLayers;
+    job.bind_pose.begin = bind_pose;
+    job.bind_pose.end = bind_pose + kNumSoaJoints;
+    job.output.begin = expected;
+    job.output.end = expected + kNumSoaJoints;
+    ASSERT_TRUE(job.Run());
+
+    job.layers.begin = fast_layers;
+    job.layers.end = fast_layers + kNumLayers;
+    job.output.begin = output;
+    job.output.end = output + kNumSoaJoints;
+    job.fast_normalization = true;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      ExpectNear(output[i], expected[i], 2e-3f);
+    }
+  }
+
+  for (int i = 0; i < kNumLayers; ++i) {
+    allocator->Delete(caches[i]);
+    allocator->Delete(fast_caches[i]);
+    allocator->Delete(animations[i]);
+  }
+}
@@ -0,0 +1,289 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sample_to_model_job.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_float4x3.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::SampleToModelJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Appends a chain of _depth joints to _parent, with a leaf every 3 joints.
+void AddChain(int _depth, RawSkeleton::Joint* _parent) {
+  if (_depth == 0) {
+    return;
+  }
+  _parent->children.resize(_depth % 3 == 0 ? 2 : 1);
+  for (size_t i = 0; i < _parent->children.size(); ++i) {
+    char name[16];
+    std::sprintf(name, "j%d_%d", _depth, static_cast<int>(i));
+    _parent->children[i].name = name;
+  }
+  AddChain(_depth - 1, &_parent->children[0]);
+}
+
+// Builds a skeleton of 2 chains.
+Skeleton* BuildSkeleton(int _depth) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  raw_skeleton.roots[0].name = "root0";
+  raw_skeleton.roots[1].name = "root1";
+  AddChain(_depth, &raw_skeleton.roots[0]);
+  AddChain(_depth, &raw_skeleton.roots[1]);
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds an animation of _num_tracks tracks.
+Animation* BuildAnimation(int _num_tracks, bool _scaled) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 3; ++k) {
+      const float time = k * (.25f + (i % 4) * .08f);
+      const float value = i * .1f + k;
+      const RawAnimation::TranslationKey t = {
+        time, ozz::math::Float3(value, 1.f, -value * .5f)};
+      track.translations.push_back(t);
+      const float angle = value * .2f;
+      const RawAnimation::RotationKey r = {
+        time, ozz::math::Quaternion(std::sin(angle), 0.f, 0.f,
+                                    std::cos(angle))};
+      track.rotations.push_back(r);
+      const RawAnimation::ScaleKey s = {
+        time, ozz::math::Float3(_scaled ? 1.f + value * .1f : 1.f, 1.f, 1.f)};
+      track.scales.push_back(s);
+    }
+  }
+  return AnimationBuilder()(raw_animation);
+}
+
+// Compares _a and _b matrices.
+template <typename _Matrix>
+void ExpectNear(const _Matrix& _a, const _Matrix& _b) {
+  const float* a = reinterpret_cast<const float*>(&_a);
+  const float* b = reinterpret_cast<const float*>(&_b);
+  for (size_t i = 0; i < sizeof(_a) / sizeof(float); ++i) {
+    EXPECT_NEAR(a[i], b[i], 1e-4f);
+  }
+}
+}  // namespace
+
+TEST(JobValidity, SampleToModelJob) {
+  Skeleton* skeleton = BuildSkeleton(5);
+  ASSERT_TRUE(skeleton != NULL);
+  const int num_joints = skeleton->num_joints();
+  Animation* animation = BuildAnimation(num_joints, false);
+  ASSERT_TRUE(animation != NULL);
+  Animation* small_animation = BuildAnimation(2, false);
+  ASSERT_TRUE(small_animation != NULL);
+  SamplingCache cache(num_joints);
+  SamplingCache small_cache(2);
+  ozz::math::Float4x4 output[16];
+  ozz::math::Float4x3 output_4x3[16];
+  ASSERT_LE(num_joints, 16);
+
+  { // Empty/default job.
+    SampleToModelJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  SampleToModelJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.skeleton = skeleton;
+  job.output.begin = output;
+  job.output.end = output + num_joints;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+
+  { // Animation with fewer tracks than the skeleton.
+    SampleToModelJob invalid = job;
+    invalid.animation = small_animation;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // Cache too small.
+    SampleToModelJob invalid = job;
+    invalid.cache = &small_cache;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // Output too small.
+    SampleToModelJob invalid = job;
+    invalid.output.end = output + num_joints - 1;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // Both outputs.
+    SampleToModelJob invalid = job;
+    invalid.output_4x3.begin = output_4x3;
+    invalid.output_4x3.end = output_4x3 + num_joints;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  { // 4x3 output.
+    SampleToModelJob valid = job;
+    valid.output.begin = NULL;
+    valid.output.end = NULL;
+    valid.output_4x3.begin = output_4x3;
+    valid.output_4x3.end = output_4x3 + num_joints;
+    EXPECT_TRUE(valid.Validate());
+    EXPECT_TRUE(valid.Run());
+  }
+
+  { // Invalid lod.
+    SampleToModelJob invalid = job;
+    invalid.num_joints_lod = -1;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  allocator->Delete(small_animation);
+  allocator->Delete(animation);
+  allocator->Delete(skeleton);
+}
+
+TEST(Equivalence, SampleToModelJob) {
+  // More than a chunk of soa joints.
+  Skeleton* skeleton = BuildSkeleton(30);
+  ASSERT_TRUE(skeleton != NULL);
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = skeleton->num_soa_joints();
+  ASSERT_GT(num_soa_joints, 8);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  ozz::math::SoaTransform* locals =
+    allocator->Allocate<ozz::math::SoaTransform>(num_soa_joints);
+  ozz::math::Float4x4* expected =
+    allocator->Allocate<ozz::math::Float4x4>(num_joints);
+  ozz::math::Float4x4* output =
+    allocator->Allocate<ozz::math::Float4x4>(num_joints);
+  ozz::math::Float4x3* expected_4x3 =
+    allocator->Allocate<ozz::math::Float4x3>(num_joints);
+  ozz::math::Float4x3* output_4x3 =
+    allocator->Allocate<ozz::math::Float4x3>(num_joints);
+
+  for (int scaled = 0; scaled < 2; ++scaled) {
+    Animation* animation = BuildAnimation(num_joints, scaled != 0);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->scaled(), scaled != 0);
+    SamplingCache cache(num_joints);
+    SamplingCache reference_cache(num_joints);
+
+    const int lods[] = {Skeleton::kMaxJoints, num_joints / 2, 1, 0};
+    const float times[] = {0.f, .2f, .5f, .9f, .1f};
+    for (size_t l = 0; l < OZZ_ARRAY_SIZE(lods); ++l) {
+      const int num_lod = ozz::math::Min(lods[l], num_joints);
+      for (size_t t = 0; t < OZZ_ARRAY_SIZE(times); ++t) {
+        // Reference.
+        SamplingJob sampling;
+        sampling.animation = animation;
+        sampling.cache = &reference_cache;
+        sampling.time = times[t];
+        sampling.output.begin = locals;
+        sampling.output.end = locals + num_soa_joints;
+        ASSERT_TRUE(sampling.Run());
+
+        LocalToModelJob ltm;
+        ltm.skeleton = skeleton;
+        ltm.input.begin = locals;
+        ltm.input.end = locals + num_soa_joints;
+        ltm.num_joints_lod = lods[l];
+        ltm.output.begin = expected;
+        ltm.output.end = expected + num_joints;
+        ASSERT_TRUE(ltm.Run());
+        ltm.output.begin = NULL;
+        ltm.output.end = NULL;
+        ltm.output_4x3.begin = expected_4x3;
+        ltm.output_4x3.end = expected_4x3 + num_joints;
+        ASSERT_TRUE(ltm.Run());
+
+        // Fused job.
+        SampleToModelJob job;
+        job.animation = animation;
+        job.cache = &cache;
+        job.skeleton = skeleton;
+        job.time = times[t];
+        job.num_joints_lod = lods[l];
+        job.output.begin = output;
+        job.output.end = output + num_joints;
+        ASSERT_TRUE(job.Run());
+        job.output.begin = NULL;
+        job.output.end = NULL;
+        job.output_4x3.begin = output_4x3;
+        job.output_4x3.end = output_4x3 + num_joints;
+        ASSERT_TRUE(job.Run());
+
+        for (int i = 0; i < num_lod; ++i) {
+          ExpectNear(output[i], expected[i]);
+          ExpectNear(output_4x3[i], expected_4x3[i]);
+        }
+      }
+    }
+    allocator->Delete(animation);
+  }
+
+  allocator->Deallocate(output_4x3);
+  allocator->Deallocate(expected_4x3);
+  allocator->Deallocate(output);
+  allocator->Deallocate(expected);
+  allocator->Deallocate(locals);
+  allocator->Delete(skeleton);
+}
@@ -0,0 +1,201 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sampling_cache_pool.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingCachePool;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a one track animation whose translation x moves from 0 to 1.
+Animation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  RawAnimation::TranslationKey t0 = {0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  RawAnimation::TranslationKey t1 = {1.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t1);
+  return AnimationBuilder()(raw_animation);
+}
+}  // namespace
+
+TEST(ExternalBuffer, SamplingCache) {
+  EXPECT_EQ(SamplingCache::buffer_size(0), 0u);
+  EXPECT_EQ(SamplingCache::buffer_size(1), SamplingCache::buffer_size(4));
+  EXPECT_TRUE(SamplingCache::buffer_size(5) > SamplingCache::buffer_size(4));
+
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = SamplingCache::buffer_size(7);
+  void* buffer = allocator->Allocate(size, SamplingCache::kBufferAlignment);
+  {
+    SamplingCache cache(7, buffer, size);
+    EXPECT_EQ(cache.max_tracks(), 8);
+
+    ozz::math::SoaTransform output[1];
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    job.time = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .5f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+  }
+  // Buffer isn't owned by the cache.
+  allocator->Deallocate(buffer);
+  allocator->Delete(animation);
+}
+
+TEST(Empty, SamplingCachePool) {
+  SamplingCachePool pool(10, 0);
+  EXPECT_EQ(pool.capacity(), 0);
+  EXPECT_EQ(pool.num_free(), 0);
+  EXPECT_TRUE(pool.Acquire() == NULL);
+  pool.Release(NULL);
+}
+
+TEST(AcquireRelease, SamplingCachePool) {
+  SamplingCachePool pool(10, 3);
+  EXPECT_EQ(pool.max_tracks(), 10);
+  EXPECT_EQ(pool.capacity(), 3);
+  EXPECT_EQ(pool.num_free(), 3);
+
+  SamplingCache* caches[3];
+  for (int i = 0; i < 3; ++i) {
+    caches[i] = pool.Acquire();
+    ASSERT_TRUE(caches[i] != NULL);
+    EXPECT_TRUE(caches[i]->max_tracks() >= 10);
+    for (int j = 0; j < i; ++j) {
+      EXPECT_TRUE(caches[i] != caches[j]);
+    }
+  }
+  EXPECT_EQ(pool.num_free(), 0);
+  EXPECT_TRUE(pool.Acquire() == NULL);
+
+  // Releasing gives the cache back for the next acquisition.
+  pool.Release(caches[1]);
+  EXPECT_EQ(pool.num_free(), 1);
+  EXPECT_EQ(pool.Acquire(), caches[1]);
+
+  pool.Release(NULL);
+  for (int i = 0; i < 3; ++i) {
+    pool.Release(caches[i]);
+  }
+  EXPECT_EQ(pool.num_free(), 3);
+}
+
+TEST(Compact, SamplingCachePool) {
+  SamplingCachePool pool(10, 2, true);
+  EXPECT_TRUE(pool.compact());
+  SamplingCache* caches[2];
+  for (int i = 0; i < 2; ++i) {
+    caches[i] = pool.Acquire();
+    ASSERT_TRUE(caches[i] != NULL);
+    EXPECT_TRUE(caches[i]->compact());
+    EXPECT_TRUE(caches[i]->max_tracks() >= 10);
+  }
+  for (int i = 0; i < 2; ++i) {
+    pool.Release(caches[i]);
+  }
+
+  SamplingCachePool default_pool(10, 1);
+  EXPECT_FALSE(default_pool.compact());
+}
+
+TEST(Sampling, SamplingCachePool) {
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCachePool pool(1, 8);
+  SamplingCache* caches[8];
+  for (int i = 0; i < 8; ++i) {
+    caches[i] = pool.Acquire();
+    ASSERT_TRUE(caches[i] != NULL);
+  }
+
+  // All caches sample independently.
+  for (int k = 0; k < 3; ++k) {
+    for (int i = 0; i < 8; ++i) {
+      ozz::math::SoaTransform output[1];
+      SamplingJob job;
+      job.animation = animation;
+      job.cache = caches[i];
+      job.output.begin = output;
+      job.output.end = output + 1;
+      job.time = (i + k) / 10.f;
+      ASSERT_TRUE(job.Run());
+      EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, job.time, 0.f, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f,
+                                                     0.f, 0.f, 0.f, 0.f);
+    }
+  }
+
+  for (int i = 0; i < 8; ++i) {
+    pool.Release(caches[i]);
+  }
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(MemoryTag, SamplingCachePool) {
+  ozz::memory::TrackingAllocator tracking;
+  ozz::memory::Allocator* previous =
+    ozz::memory::SetDefaulAllocator(&tracking);
+  {
+    SamplingCachePool pool(10, 4);
+    SamplingCache cache(10);
+    EXPECT_EQ(tracking.stats(ozz::memory::kTagCache).live_count, 2);
+    EXPECT_EQ(tracking.stats(ozz::memory::kTagDefault).live_count, 0);
+  }
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagCache).live_bytes, 0u);
+  ozz::memory::SetDefaulAllocator(previous);
+}
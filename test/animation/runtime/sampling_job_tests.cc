@@ -30,10 +30,15 @@
 
 #include "ozz/animation/runtime/sampling_job.h"
 
+#include <cstring>
+#include <limits>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/quaternion.h"
 #include "ozz/base/maths/soa_transform.h"
 
 #include "ozz/animation/runtime/animation.h"
@@ -690,3 +695,1416 @@ TEST(SamplingCache, SamplingJob) {
   ozz::memory::default_allocator()->Delete(animations[0]);
   ozz::memory::default_allocator()->Delete(animations[1]);
 }
+
+TEST(SamplingCacheReload, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);  // Adds a joint.
+  const RawAnimation::TranslationKey empty_key = {0};
+  raw_animation.tracks[0].translations.push_back(empty_key);
+
+  // Builds 2 animations, and saves them to blobs.
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  void* blobs[2];
+  size_t blob_sizes[2];
+  for (int i = 0; i < 2; ++i) {
+    const float sign = i == 0 ? 1.f : -1.f;
+    const RawAnimation::TranslationKey tkey =
+      {.3f, ozz::math::Float3(sign, -sign, 5.f * sign)};
+    raw_animation.tracks[0].translations[0] = tkey;
+
+    AnimationBuilder builder;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    blob_sizes[i] = animation->blob_size();
+    blobs[i] = allocator->Allocate(blob_sizes[i], Animation::kBlobAlignment);
+    EXPECT_TRUE(animation->SaveBlob(blobs[i], blob_sizes[i]));
+    allocator->Delete(animation);
+  }
+
+  // Generation ids are renewed when animation content changes.
+  Animation animation;
+  const uint32_t default_id = animation.id();
+  EXPECT_NE(default_id, 0u);
+  ASSERT_TRUE(animation.MapBlob(blobs[0], blob_sizes[0]));
+  const uint32_t first_id = animation.id();
+  EXPECT_NE(first_id, default_id);
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+
+  SamplingJob job;
+  job.animation = &animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f,
+                                                  -1.f, 0.f, 0.f, 0.f,
+                                                  5.f, 0.f, 0.f, 0.f);
+
+  // Reloads another animation in place, at the same address, without
+  // invalidating the cache.
+  ASSERT_TRUE(animation.MapBlob(blobs[1], blob_sizes[1]));
+  EXPECT_NE(animation.id(), first_id);
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, -1.f, 0.f, 0.f, 0.f,
+                                                  1.f, 0.f, 0.f, 0.f,
+                                                  -5.f, 0.f, 0.f, 0.f);
+
+  // Reverts to the first animation.
+  ASSERT_TRUE(animation.MapBlob(blobs[0], blob_sizes[0]));
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f,
+                                                  -1.f, 0.f, 0.f, 0.f,
+                                                  5.f, 0.f, 0.f, 0.f);
+
+  allocator->Deallocate(blobs[0]);
+  allocator->Deallocate(blobs[1]);
+}
+
+TEST(SamplingCacheSwap, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);  // Adds a joint.
+  RawAnimation::TranslationKey key = {.1f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+  key.time = .9f;
+  key.value = ozz::math::Float3(9.f, 2.f, 3.f);
+  raw_animation.tracks[0].translations.push_back(key);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .1f;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // The reloaded animation is slower, and has another duration.
+  raw_animation.duration = 2.f;
+  raw_animation.tracks[0].translations[1].time = 1.9f;
+  Animation* reloaded = builder(raw_animation);
+  ASSERT_TRUE(reloaded != NULL);
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.time = .5f;
+  job.output.begin = output;
+  job.output.end = output + 1;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 5.f, 0.f, 0.f, 0.f,
+                                                  2.f, 0.f, 0.f, 0.f,
+                                                  3.f, 0.f, 0.f, 0.f);
+
+  // Swaps in place, the job still refers to the same animation object.
+  const SamplingCache::Stats stats = cache.stats();
+  const uint32_t id = animation->id();
+  const uint32_t reloaded_id = reloaded->id();
+  animation->Swap(reloaded);
+  EXPECT_NE(animation->id(), id);
+  EXPECT_NE(animation->id(), reloaded_id);
+  EXPECT_NE(reloaded->id(), id);
+  EXPECT_FLOAT_EQ(animation->duration(), 2.f);
+  EXPECT_FLOAT_EQ(reloaded->duration(), 1.f);
+
+  // The cache migrates at the current time, further in the new animation.
+  job.time = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 5.f, 0.f, 0.f, 0.f,
+                                                  2.f, 0.f, 0.f, 0.f,
+                                                  3.f, 0.f, 0.f, 0.f);
+#ifdef OZZ_HAS_STATS
+  EXPECT_EQ(cache.stats().resets, stats.resets + 1);
+  EXPECT_EQ(cache.stats().seeks, stats.seeks + 1);
+#else  // OZZ_HAS_STATS
+  (void)stats;
+#endif  // OZZ_HAS_STATS
+
+  // Swaps back, and deletes the reloaded animation that owns new buffers.
+  animation->Swap(reloaded);
+  ozz::memory::default_allocator()->Delete(reloaded);
+  job.time = .9f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 9.f, 0.f, 0.f, 0.f,
+                                                  2.f, 0.f, 0.f, 0.f,
+                                                  3.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Fills _raw_animation with 5 tracks, whose keys have different times.
+void FillRawAnimation(RawAnimation* _raw_animation) {
+  RawAnimation& raw_animation = *_raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const int num_keys = 10 + i * 7;
+    for (int k = 0; k <= num_keys; ++k) {
+      const float time = raw_animation.duration * k / num_keys;
+      const float value = static_cast<float>((k * (i + 3)) % 11);
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(value, -value, i * value)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time,
+        ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float4(0.f, 1.f, 0.f, value * .3f))};
+      track.rotations.push_back(rkey);
+      if (i & 1) {
+        const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + value, 1.f, 2.f)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+}
+}  // namespace
+
+TEST(SeekIndex, SamplingJob) {
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  AnimationBuilder builder;
+  EXPECT_FLOAT_EQ(builder.seek_interval, 0.f);
+  Animation* linear = builder(raw_animation);
+  ASSERT_TRUE(linear != NULL);
+  EXPECT_EQ(linear->seek_index().Count(), 0u);
+
+  builder.seek_interval = .1f;
+  Animation* indexed = builder(raw_animation);
+  ASSERT_TRUE(indexed != NULL);
+  EXPECT_NE(indexed->seek_index().Count(), 0u);
+
+  // Samples both animations at the same times, forward, backward and with
+  // random jumps. Results must be identical.
+  const float times[] = {0.f, .05f, .6f, .61f, .3f, 1.9f, 2.f, .1f, .15f,
+                         1.23f, 1.2f, .95f, .95f, 2.f, 0.f, 1.f, .99f, 1.01f};
+  SamplingCache linear_cache(5);
+  SamplingCache indexed_cache(5);
+  ozz::math::SoaTransform linear_output[2];
+  ozz::math::SoaTransform indexed_output[2];
+
+  SamplingJob linear_job;
+  linear_job.animation = linear;
+  linear_job.cache = &linear_cache;
+  linear_job.output.begin = linear_output;
+  linear_job.output.end = linear_output + 2;
+
+  SamplingJob indexed_job;
+  indexed_job.animation = indexed;
+  indexed_job.cache = &indexed_cache;
+  indexed_job.output.begin = indexed_output;
+  indexed_job.output.end = indexed_output + 2;
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    linear_job.time = times[i];
+    ASSERT_TRUE(linear_job.Run());
+    indexed_job.time = times[i];
+    ASSERT_TRUE(indexed_job.Run());
+    EXPECT_EQ(std::memcmp(linear_output, indexed_output,
+                          sizeof(linear_output)), 0) << "time " << times[i];
+
+    // A new cache starts from the seek index too.
+    SamplingCache cache(5);
+    indexed_job.cache = &cache;
+    ASSERT_TRUE(indexed_job.Run());
+    indexed_job.cache = &indexed_cache;
+    EXPECT_EQ(std::memcmp(linear_output, indexed_output,
+                          sizeof(linear_output)), 0) << "time " << times[i];
+  }
+
+  ozz::memory::default_allocator()->Delete(linear);
+  ozz::memory::default_allocator()->Delete(indexed);
+}
+
+TEST(BackwardJitter, SamplingJob) {
+#ifdef OZZ_HAS_STATS
+  const bool enabled = true;
+#else  // OZZ_HAS_STATS
+  const bool enabled = false;
+#endif  // OZZ_HAS_STATS
+
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .1f;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(5);
+  const SamplingCache::Stats& stats = cache.stats();
+  ozz::math::SoaTransform output[2];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  job.time = 1.013f;
+  ASSERT_TRUE(job.Run());
+
+  // Small backward steps within the current keys interval of every track
+  // neither seek nor rewind the cache.
+  const SamplingCache::Stats previous = stats;
+  const float times[] = {1.012f, 1.0125f, 1.001f, 1.013f, 1.0005f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(stats.seeks, previous.seeks);
+    EXPECT_EQ(stats.soa_updates, previous.soa_updates);
+
+    // Output matches a new cache.
+    ozz::math::SoaTransform expected[2];
+    SamplingCache new_cache(5);
+    job.cache = &new_cache;
+    job.output.begin = expected;
+    job.output.end = expected + 2;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0)
+      << "time " << times[i];
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 2;
+  }
+
+  // Stepping back past the current keys restores the cache from the seek
+  // index.
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.seeks, previous.seeks + (enabled ? 1 : 0));
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(KeyLinks, SamplingJob) {
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  AnimationBuilder builder;
+  EXPECT_FALSE(builder.key_links);
+  Animation* reference = builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+  EXPECT_EQ(reference->key_links().Count(), 0u);
+
+  builder.key_links = true;
+  Animation* linked = builder(raw_animation);
+  ASSERT_TRUE(linked != NULL);
+  EXPECT_NE(linked->key_links().Count(), 0u);
+
+  builder.seek_interval = .3f;
+  Animation* indexed = builder(raw_animation);
+  ASSERT_TRUE(indexed != NULL);
+
+  // Reference is sampled with an invalidated cache, linked animations are
+  // played forward, backward, ping-pong and with random jumps.
+  const float times[] = {0.f, .5f, 2.f, 1.9f, 1.7f, 1.65f, 1.2f, 1.21f, 1.2f,
+                         .8f, .01f, 0.f, .3f, .4f, 1.5f, .2f, 1.99f, 2.f};
+  SamplingCache reference_cache(5);
+  SamplingCache linked_cache(5);
+  SamplingCache indexed_cache(5);
+  ozz::math::SoaTransform reference_output[2];
+  ozz::math::SoaTransform output[2];
+
+  SamplingJob job;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  SamplingJob reference_job;
+  reference_job.animation = reference;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference_output;
+  reference_job.output.end = reference_output + 2;
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    reference_cache.Invalidate();
+    reference_job.time = times[i];
+    ASSERT_TRUE(reference_job.Run());
+
+    job.time = times[i];
+    job.animation = linked;
+    job.cache = &linked_cache;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(reference_output, output, sizeof(output)), 0) <<
+      "time " << times[i];
+
+    job.animation = indexed;
+    job.cache = &indexed_cache;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(reference_output, output, sizeof(output)), 0) <<
+      "time " << times[i];
+  }
+
+  ozz::memory::default_allocator()->Delete(reference);
+  ozz::memory::default_allocator()->Delete(linked);
+  ozz::memory::default_allocator()->Delete(indexed);
+}
+
+TEST(Loop, SamplingJob) {
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+  // Adds a track made of its first and last keys only.
+  raw_animation.tracks.resize(6);
+  const RawAnimation::TranslationKey first = {
+    0.f, ozz::math::Float3(0.f, 1.f, 2.f)};
+  raw_animation.tracks[5].translations.push_back(first);
+  const RawAnimation::TranslationKey last = {
+    2.f, ozz::math::Float3(2.f, 1.f, 0.f)};
+  raw_animation.tracks[5].translations.push_back(last);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Loops 3 times, with different wrap times. The cache is rewound to first
+  // keys at every loop, which must match sampling with an invalidated cache.
+  const float times[] = {0.f, .7f, 1.4f, 1.95f, 2.f, .05f, .75f, 1.45f, 1.9f,
+                         .1f, .8f, 1.5f, 1.99f, 0.f, .6f};
+  SamplingCache reference_cache(6);
+  SamplingCache cache(6);
+  ozz::math::SoaTransform reference_output[2];
+  ozz::math::SoaTransform output[2];
+
+  SamplingJob reference_job;
+  reference_job.animation = animation;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference_output;
+  reference_job.output.end = reference_output + 2;
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    reference_cache.Invalidate();
+    reference_job.time = times[i];
+    ASSERT_TRUE(reference_job.Run());
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(reference_output, output, sizeof(output)), 0) <<
+      "time " << times[i];
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SoaMask, SamplingJob) {
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  AnimationBuilder builder;
+  Animation* animations[2];
+  animations[0] = builder(raw_animation);
+  ASSERT_TRUE(animations[0] != NULL);
+  raw_animation.interpolation = RawAnimation::kHermite;
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    track.translation_tangents.resize(track.translations.size(),
+                                      ozz::math::Float3(1.f, 0.f, -1.f));
+    track.rotation_tangents.resize(track.rotations.size(),
+                                   ozz::math::Float4(0.f, .1f, 0.f, 0.f));
+    track.scale_tangents.resize(track.scales.size(),
+                                ozz::math::Float3(0.f, 1.f, 0.f));
+  }
+  animations[1] = builder(raw_animation);
+  ASSERT_TRUE(animations[1] != NULL);
+
+  SamplingCache reference_cache(5);
+  SamplingCache cache(5);
+  ozz::math::SoaTransform reference_output[2];
+  ozz::math::SoaTransform output[2];
+
+  { // Validates mask ranges.
+    unsigned char mask[1] = {0};
+    SamplingJob job;
+    job.animation = animations[0];
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_TRUE(job.Validate());
+    job.soa_mask.end = mask + 1;
+    EXPECT_FALSE(job.Validate());
+    job.soa_mask.begin = mask;
+    job.soa_mask.end = mask;
+    EXPECT_FALSE(job.Validate());
+    job.soa_mask.end = mask + 1;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  SamplingJob reference_job;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference_output;
+  reference_job.output.end = reference_output + 2;
+
+  SamplingJob job;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  // Samples with masks that change over time, so that soa tracks that were
+  // masked out while their keys changed are then sampled again.
+  const float times[] = {0.f, .3f, .6f, 1.3f, .4f, 1.9f, 2.f};
+  const unsigned char masks[] = {1, 2, 3, 0, 2, 1, 3};
+  for (int a = 0; a < 2; ++a) {
+    reference_job.animation = animations[a];
+    job.animation = animations[a];
+    cache.Invalidate();
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+      reference_job.time = times[i];
+      ASSERT_TRUE(reference_job.Run());
+
+      // Masked out soa tracks output must be left unchanged.
+      std::memset(output, 0xcd, sizeof(output));
+      job.time = times[i];
+      job.soa_mask.begin = masks + i;
+      job.soa_mask.end = masks + i + 1;
+      ASSERT_TRUE(job.Run());
+      for (int j = 0; j < 2; ++j) {
+        if (masks[i] & (1 << j)) {
+          EXPECT_EQ(std::memcmp(reference_output + j, output + j,
+                                sizeof(output[j])), 0) <<
+            "animation " << a << ", time " << times[i] << ", soa " << j;
+        } else {
+          unsigned char untouched[sizeof(output[j])];
+          std::memset(untouched, 0xcd, sizeof(untouched));
+          EXPECT_EQ(std::memcmp(untouched, output + j, sizeof(untouched)),
+                    0) <<
+            "animation " << a << ", time " << times[i] << ", soa " << j;
+        }
+      }
+    }
+  }
+
+  for (int a = 0; a < 2; ++a) {
+    ozz::memory::default_allocator()->Delete(animations[a]);
+  }
+}
+
+TEST(Changed, SamplingJob) {
+  // Soa track 0 is constant, soa track 1 translates during the first second
+  // and stays still after.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(8);
+  const RawAnimation::TranslationKey keys[] = {
+    {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+    {1.f, ozz::math::Float3(1.f, 0.f, 0.f)},
+    {2.f, ozz::math::Float3(1.f, 0.f, 0.f)}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(keys); ++i) {
+    raw_animation.tracks[5].translations.push_back(keys[i]);
+  }
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(8);
+  SamplingCache reference_cache(8);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform reference_output[2];
+  unsigned char changed[1];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  { // Validates changed ranges.
+    SamplingJob invalid_job = job;
+    EXPECT_TRUE(invalid_job.Validate());
+    invalid_job.changed.end = changed + 1;
+    EXPECT_FALSE(invalid_job.Validate());
+    invalid_job.changed.begin = changed;
+    invalid_job.changed.end = changed;
+    EXPECT_FALSE(invalid_job.Validate());
+    invalid_job.changed.end = changed + 1;
+    EXPECT_TRUE(invalid_job.Validate());
+  }
+
+  SamplingJob reference_job;
+  reference_job.animation = animation;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference_output;
+  reference_job.output.end = reference_output + 2;
+
+  job.changed.begin = changed;
+  job.changed.end = changed + 1;
+  std::memset(output, 0xcd, sizeof(output));
+
+  const float times[] = {0.f, .5f, .5f, 1.2f, 1.5f, .8f, .8f, 0.f};
+  const unsigned char masks[] = {3, 3, 3, 3, 3, 1, 3, 3};
+  const unsigned char expected[] = {3, 2, 0, 2, 0, 0, 2, 2};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    job.time = times[i];
+    job.soa_mask.begin = masks + i;
+    job.soa_mask.end = masks + i + 1;
+    changed[0] = 0xff;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(changed[0], expected[i]) << "time " << times[i];
+
+    // Output is the same as without change detection.
+    reference_job.time = times[i];
+    ASSERT_TRUE(reference_job.Run());
+    for (int j = 0; j < 2; ++j) {
+      if (masks[i] & (1 << j)) {
+        EXPECT_EQ(std::memcmp(reference_output + j, output + j,
+                              sizeof(output[j])), 0) << "time " << times[i];
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(NextKeyTime, SamplingJob) {
+  // Track 0 translates with a key every .5s.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  for (int i = 0; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+      i * .5f, ozz::math::Float3(i * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Key times are quantized, see kMaxKeyTime.
+  SamplingCache cache(1);
+  EXPECT_FLOAT_EQ(cache.NextKeyTime(*animation), 0.f);
+
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+
+  job.time = .2f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(cache.NextKeyTime(*animation), .5f, 1e-4f);
+
+  // Last key was fetched.
+  job.time = .7f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(cache.NextKeyTime(*animation),
+            std::numeric_limits<float>::max());
+
+  // Rewinding fetches keys again.
+  job.time = .1f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(cache.NextKeyTime(*animation), .5f, 1e-4f);
+
+  cache.Invalidate();
+  EXPECT_FLOAT_EQ(cache.NextKeyTime(*animation), 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(UpdatePeriods, SamplingJob) {
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache reference_cache(5);
+  SamplingCache cache(5);
+  ozz::math::SoaTransform reference_output[2];
+  ozz::math::SoaTransform output[2];
+
+  // Soa track 0 is sampled every frame, soa track 1 every 3 frames.
+  const unsigned char periods[] = {1, 3};
+
+  { // Validates periods ranges.
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_TRUE(job.Validate());
+    job.soa_update_periods.end = periods + 2;
+    EXPECT_FALSE(job.Validate());
+    job.soa_update_periods.begin = periods;
+    job.soa_update_periods.end = periods + 1;
+    EXPECT_FALSE(job.Validate());
+    job.soa_update_periods.end = periods + 2;
+    EXPECT_TRUE(job.Validate());
+    job.update_frame = -1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  SamplingJob reference_job;
+  reference_job.animation = animation;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference_output;
+  reference_job.output.end = reference_output + 2;
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  job.soa_update_periods.begin = periods;
+  job.soa_update_periods.end = periods + 2;
+
+  // Also combines with a soa mask, that masks out soa track 1 on frame 6.
+  for (int frame = 0; frame < 10; ++frame) {
+    reference_job.time = frame * .15f;
+    ASSERT_TRUE(reference_job.Run());
+
+    const unsigned char mask = frame == 6 ? 1 : 3;
+    std::memset(output, 0xcd, sizeof(output));
+    job.time = reference_job.time;
+    job.update_frame = frame;
+    job.soa_mask.begin = &mask;
+    job.soa_mask.end = &mask + 1;
+    ASSERT_TRUE(job.Run());
+
+    EXPECT_EQ(std::memcmp(reference_output, output, sizeof(output[0])), 0) <<
+      "frame " << frame;
+    if (frame % 3 == 0 && frame != 6) {
+      EXPECT_EQ(std::memcmp(reference_output + 1, output + 1,
+                            sizeof(output[1])), 0) << "frame " << frame;
+    } else {
+      unsigned char untouched[sizeof(output[1])];
+      std::memset(untouched, 0xcd, sizeof(untouched));
+      EXPECT_EQ(std::memcmp(untouched, output + 1, sizeof(untouched)), 0) <<
+        "frame " << frame;
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Stores the 4 lanes of each component of _v to _out[component][lane].
+void StoreSoa(const ozz::math::SoaFloat3& _v, float _out[3][4]) {
+  ozz::math::StorePtrU(_v.x, _out[0]);
+  ozz::math::StorePtrU(_v.y, _out[1]);
+  ozz::math::StorePtrU(_v.z, _out[2]);
+}
+void StoreSoa(const ozz::math::SoaQuaternion& _q, float _out[4][4]) {
+  ozz::math::StorePtrU(_q.x, _out[0]);
+  ozz::math::StorePtrU(_q.y, _out[1]);
+  ozz::math::StorePtrU(_q.z, _out[2]);
+  ozz::math::StorePtrU(_q.w, _out[3]);
+}
+
+// Builds a 4 tracks animation, keyed at 0, 1 and 2s.
+void FillVelocityAnimation(RawAnimation* _raw_animation, bool _hermite) {
+  RawAnimation& raw_animation = *_raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(4);
+  if (_hermite) {
+    raw_animation.interpolation = RawAnimation::kHermite;
+  }
+  for (int i = 0; i < 4; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 3; ++k) {
+      const float time = static_cast<float>(k);
+      const float value = static_cast<float>((k * (i + 2)) % 5);
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(value, -value * .5f, i * value)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time,
+        ozz::math::Quaternion::FromAxisAngle(ozz::math::Float4(
+          Normalize(ozz::math::Float3(1.f, i * .5f, value)), value * .4f))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+        time, ozz::math::Float3(1.f + value, 1.f, 2.f - value * .1f)};
+      track.scales.push_back(skey);
+      if (_hermite) {
+        track.translation_tangents.push_back(
+          ozz::math::Float3(1.f, 0.f, -i * 1.f));
+        track.rotation_tangents.push_back(
+          ozz::math::Float4(.1f * i, .2f, 0.f, -.1f));
+        track.scale_tangents.push_back(ozz::math::Float3(0.f, .5f, .2f));
+      }
+    }
+  }
+}
+}  // namespace
+
+TEST(Velocities, SamplingJob) {
+  SamplingCache cache(4);
+  ozz::math::SoaTransform output[3];
+  ozz::animation::SoaJointVelocity velocities[1];
+
+  for (int hermite = 0; hermite < 2; ++hermite) {
+    RawAnimation raw_animation;
+    FillVelocityAnimation(&raw_animation, hermite != 0);
+    AnimationBuilder builder;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->hermite(), hermite != 0);
+
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 1;
+
+    {  // Validates velocities range.
+      SamplingJob invalid_job = job;
+      EXPECT_TRUE(invalid_job.Validate());
+      invalid_job.velocities.end = velocities + 1;
+      EXPECT_FALSE(invalid_job.Validate());
+      invalid_job.velocities.begin = velocities;
+      invalid_job.velocities.end = velocities;
+      EXPECT_FALSE(invalid_job.Validate());
+      invalid_job.velocities.end = velocities + 1;
+      EXPECT_TRUE(invalid_job.Validate());
+    }
+
+    // Compares analytic velocities with central finite differences.
+    const float times[] = {.25f, .5f, .7f, 1.3f, 1.8f};
+    const float h = 1e-3f;
+    for (size_t t = 0; t < OZZ_ARRAY_SIZE(times); ++t) {
+      job.velocities.begin = NULL;
+      job.velocities.end = NULL;
+      for (int s = 0; s < 2; ++s) {
+        job.time = times[t] + (s ? h : -h);
+        job.output.begin = output + 1 + s;
+        job.output.end = output + 2 + s;
+        ASSERT_TRUE(job.Run());
+      }
+      job.time = times[t];
+      job.output.begin = output;
+      job.output.end = output + 1;
+      job.velocities.begin = velocities;
+      job.velocities.end = velocities + 1;
+      ASSERT_TRUE(job.Run());
+
+      float translation[3][4], translation0[3][4], translation1[3][4];
+      StoreSoa(velocities[0].translation, translation);
+      StoreSoa(output[1].translation, translation0);
+      StoreSoa(output[2].translation, translation1);
+      float scale[3][4], scale0[3][4], scale1[3][4];
+      StoreSoa(velocities[0].scale, scale);
+      StoreSoa(output[1].scale, scale0);
+      StoreSoa(output[2].scale, scale1);
+      float angular[3][4], q[4][4], q0[4][4], q1[4][4];
+      StoreSoa(velocities[0].rotation, angular);
+      StoreSoa(output[0].rotation, q);
+      StoreSoa(output[1].rotation, q0);
+      StoreSoa(output[2].rotation, q1);
+
+      for (int l = 0; l < 4; ++l) {
+        for (int c = 0; c < 3; ++c) {
+          EXPECT_NEAR(translation[c][l],
+                      (translation1[c][l] - translation0[c][l]) / (2.f * h),
+                      2e-2f) << "time " << times[t] << " lane " << l;
+          EXPECT_NEAR(scale[c][l],
+                      (scale1[c][l] - scale0[c][l]) / (2.f * h),
+                      2e-2f) << "time " << times[t] << " lane " << l;
+        }
+
+        // Angular velocity is 2 * vec(dq * conj(q)).
+        float dq[4];
+        for (int c = 0; c < 4; ++c) {
+          dq[c] = (q1[c][l] - q0[c][l]) / (2.f * h);
+        }
+        const float expected[3] = {
+          2.f * (q[3][l] * dq[0] - dq[3] * q[0][l] -
+                 (dq[1] * q[2][l] - dq[2] * q[1][l])),
+          2.f * (q[3][l] * dq[1] - dq[3] * q[1][l] -
+                 (dq[2] * q[0][l] - dq[0] * q[2][l])),
+          2.f * (q[3][l] * dq[2] - dq[3] * q[2][l] -
+                 (dq[0] * q[1][l] - dq[1] * q[0][l]))};
+        for (int c = 0; c < 3; ++c) {
+          EXPECT_NEAR(angular[c][l], expected[c], 2e-2f) <<
+            "time " << times[t] << " lane " << l;
+        }
+      }
+    }
+
+    // Velocities are null out of the animation range.
+    job.time = 2.5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(velocities[0].translation, 0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(velocities[0].rotation, 0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(Lod, SamplingJob) {
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache reference_cache(5);
+  SamplingCache cache(5);
+  ozz::math::SoaTransform reference_output[2];
+  ozz::math::SoaTransform output[2];
+
+  SamplingJob reference_job;
+  reference_job.animation = animation;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference_output;
+  reference_job.output.end = reference_output + 2;
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  { // Validates lod.
+    SamplingJob invalid_job = job;
+    invalid_job.num_joints_lod = -1;
+    EXPECT_FALSE(invalid_job.Validate());
+    invalid_job.num_joints_lod = 0;
+    EXPECT_TRUE(invalid_job.Validate());
+  }
+
+  // Samples with lods that change over time, so that soa tracks that were
+  // out of the lod while their keys changed are then sampled again.
+  const float times[] = {0.f, .3f, .6f, 1.3f, .4f, 1.9f, 2.f};
+  const int lods[] = {4, 5, 0, 1, 8, 2, 5};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    reference_job.time = times[i];
+    ASSERT_TRUE(reference_job.Run());
+
+    // Soa tracks out of the lod must be left unchanged.
+    std::memset(output, 0xcd, sizeof(output));
+    job.time = times[i];
+    job.num_joints_lod = lods[i];
+    ASSERT_TRUE(job.Run());
+    for (int j = 0; j < 2; ++j) {
+      if (j * 4 < lods[i]) {
+        EXPECT_EQ(std::memcmp(reference_output + j, output + j,
+                              sizeof(output[j])), 0) <<
+          "time " << times[i] << ", soa " << j;
+      } else {
+        unsigned char untouched[sizeof(output[j])];
+        std::memset(untouched, 0xcd, sizeof(untouched));
+        EXPECT_EQ(std::memcmp(untouched, output + j, sizeof(untouched)), 0) <<
+          "time " << times[i] << ", soa " << j;
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(ManyTracks, SamplingJob) {
+  // Uses more than 32 soa tracks, so that outdated flags span multiple words,
+  // with only some tracks changing keys at every sampled time.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(150);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    const int num_keys = i % 37 == 0 ? 20 : 1;
+    for (int k = 0; k <= num_keys; ++k) {
+      const float value = static_cast<float>((k + i) % 5);
+      const RawAnimation::TranslationKey key = {
+        static_cast<float>(k) / num_keys, ozz::math::Float3(value, 0.f, 0.f)};
+      raw_animation.tracks[i].translations.push_back(key);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache reference_cache(150);
+  SamplingCache cache(150);
+  ozz::math::SoaTransform reference_output[38];
+  ozz::math::SoaTransform output[38];
+
+  SamplingJob reference_job;
+  reference_job.animation = animation;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference_output;
+  reference_job.output.end = reference_output + 38;
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 38;
+
+  for (int i = 0; i <= 30; ++i) {
+    const float time = i / 30.f;
+    reference_cache.Invalidate();
+    reference_job.time = time;
+    ASSERT_TRUE(reference_job.Run());
+    job.time = time;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(reference_output, output, sizeof(output)), 0) <<
+      "time " << time;
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Compact, SamplingJob) {
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  // Compact caches are smaller.
+  EXPECT_LT(SamplingCache::buffer_size(5, true),
+            SamplingCache::buffer_size(5, false));
+
+  // Builds a linear, a Hermite and an indexed and linked animation.
+  AnimationBuilder builder;
+  Animation* animations[3];
+  animations[0] = builder(raw_animation);
+  ASSERT_TRUE(animations[0] != NULL);
+  raw_animation.interpolation = RawAnimation::kHermite;
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    track.translation_tangents.resize(track.translations.size(),
+                                      ozz::math::Float3(1.f, 0.f, -1.f));
+    track.rotation_tangents.resize(track.rotations.size(),
+                                   ozz::math::Float4(0.f, .1f, 0.f, 0.f));
+    track.scale_tangents.resize(track.scales.size(),
+                                ozz::math::Float3(0.f, 1.f, 0.f));
+  }
+  animations[1] = builder(raw_animation);
+  ASSERT_TRUE(animations[1] != NULL);
+  ASSERT_TRUE(animations[1]->hermite());
+  builder.seek_interval = .3f;
+  builder.key_links = true;
+  animations[2] = builder(raw_animation);
+  ASSERT_TRUE(animations[2] != NULL);
+
+  // Compact cache sampling must match regular cache sampling, forward,
+  // backward and with random jumps.
+  const float times[] = {0.f, .5f, 2.f, 1.9f, 1.7f, 1.2f, 1.21f, .8f, .01f,
+                         0.f, .3f, .4f, 1.5f, .2f, 1.99f, 2.f, .6f};
+  SamplingCache reference_cache(5);
+  SamplingCache cache(5, true);
+  EXPECT_FALSE(reference_cache.compact());
+  EXPECT_TRUE(cache.compact());
+  ozz::math::SoaTransform reference_output[2];
+  ozz::math::SoaTransform output[2];
+
+  SamplingJob reference_job;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference_output;
+  reference_job.output.end = reference_output + 2;
+
+  SamplingJob job;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  for (int a = 0; a < 3; ++a) {
+    reference_job.animation = animations[a];
+    job.animation = animations[a];
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+      reference_job.time = times[i];
+      ASSERT_TRUE(reference_job.Run());
+      job.time = times[i];
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(std::memcmp(reference_output, output, sizeof(output)), 0) <<
+        "animation " << a << ", time " << times[i];
+    }
+  }
+
+  for (int a = 0; a < 3; ++a) {
+    ozz::memory::default_allocator()->Delete(animations[a]);
+  }
+}
+
+TEST(CompactValidity, SamplingJob) {
+  // Builds an animation with more keys than a compact cache can address.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(8);
+  const int num_keys = SamplingCache::kMaxCompactKeys / 8 + 1;
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k <= num_keys; ++k) {
+      const float value = static_cast<float>(k & 1);
+      const RawAnimation::TranslationKey key = {
+        static_cast<float>(k) / num_keys, ozz::math::Float3(value, 0.f, 0.f)};
+      track.translations.push_back(key);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache reference_cache(8);
+  SamplingCache cache(8, true);
+  ozz::math::SoaTransform output[2];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  job.cache = &reference_cache;
+  EXPECT_TRUE(job.Validate());
+  job.cache = &cache;
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(KeyLinksOverflow, SamplingJob) {
+  // Track 0 keys at t = .02 and t = .97 are more than 65535 keys away from
+  // each other in the sorted keys, so they can't be linked.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(60);
+  const float times[] = {0.f, .02f, .97f, .98f, 1.f};
+  for (int i = 0; i < 5; ++i) {
+    const RawAnimation::TranslationKey key = {
+      times[i], ozz::math::Float3(i < 2 ? 0.f : i - 1.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  for (int i = 1; i < 60; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k <= 2400; ++k) {
+      const RawAnimation::TranslationKey key = {
+        k / 2400.f, ozz::math::Float3(static_cast<float>(k & 1), 0.f, 0.f)};
+      track.translations.push_back(key);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.key_links = true;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(60);
+  ozz::math::SoaTransform output[15];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 15;
+
+  // Rewinding from the last keys to the middle of the track requires the
+  // missing link.
+  job.time = .99f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), 2.5f, 1e-2f);
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), .48f / .95f, 1e-2f);
+  job.time = .985f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), 2.25f, 1e-2f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(BatchJobValidity, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+
+  {  // Default job.
+    ozz::animation::BatchSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid items range.
+    ozz::animation::BatchSamplingJob::Item items[1];
+    ozz::animation::BatchSamplingJob job;
+    job.items.begin = items + 1;
+    job.items.end = items;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid item.
+    ozz::animation::BatchSamplingJob::Item items[1];
+    items[0].animation = animation;
+    items[0].cache = &cache;
+    ozz::animation::BatchSamplingJob job;
+    job.items = items;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Empty batch.
+    ozz::animation::BatchSamplingJob::Item items[1];
+    ozz::animation::BatchSamplingJob job;
+    job.items.begin = items;
+    job.items.end = items;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job.
+    ozz::animation::BatchSamplingJob::Item items[1];
+    items[0].animation = animation;
+    items[0].cache = &cache;
+    items[0].output = output;
+    ozz::animation::BatchSamplingJob job;
+    job.items = items;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(BatchSampling, SamplingJob) {
+  AnimationBuilder builder;
+
+  // Builds 2 animations with different translations.
+  Animation* animations[2] = {NULL, NULL};
+  for (int i = 0; i < 2; ++i) {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(1);
+    const float sign = i == 0 ? 1.f : -1.f;
+    const RawAnimation::TranslationKey t0 =
+      {0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(t0);
+    const RawAnimation::TranslationKey t1 =
+      {1.f, ozz::math::Float3(sign * 4.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(t1);
+    animations[i] = builder(raw_animation);
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+
+  // Interleaves items of both animations, with more items than a batch chunk.
+  const int kNumItems = 150;
+  ozz::animation::BatchSamplingJob::Item items[kNumItems];
+  SamplingCache* caches[kNumItems];
+  ozz::math::SoaTransform outputs[kNumItems];
+  for (int i = 0; i < kNumItems; ++i) {
+    caches[i] = ozz::memory::default_allocator()->New<SamplingCache>(1);
+    items[i].animation = animations[i % 2];
+    items[i].cache = caches[i];
+    items[i].time = (i % 5) * .25f;
+    items[i].output.begin = outputs + i;
+    items[i].output.end = outputs + i + 1;
+  }
+
+  ozz::animation::BatchSamplingJob job;
+  job.items = items;
+  ASSERT_TRUE(job.Run());
+
+  // Compares batch results with single jobs.
+  for (int i = 0; i < kNumItems; ++i) {
+    ozz::math::SoaTransform expected[1];
+    SamplingCache cache(1);
+    SamplingJob single;
+    single.animation = items[i].animation;
+    single.cache = &cache;
+    single.time = items[i].time;
+    single.output = expected;
+    ASSERT_TRUE(single.Run());
+
+    const float x = ozz::math::GetX(expected[0].translation.x);
+    EXPECT_SOAFLOAT3_EQ_EST(outputs[i].translation, x, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f);
+    EXPECT_NEAR(x, (i % 2 == 0 ? 4.f : -4.f) * (i % 5) * .25f, 1e-2f);
+  }
+
+  // Runs again, cache are coherent.
+  for (int i = 0; i < kNumItems; ++i) {
+    items[i].time += .1f;
+  }
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kNumItems; ++i) {
+    const float time = ozz::math::Min(items[i].time, 1.f);
+    const float sign = i % 2 == 0 ? 1.f : -1.f;
+    EXPECT_NEAR(ozz::math::GetX(outputs[i].translation.x),
+                sign * 4.f * time, 1e-2f);
+  }
+
+  for (int i = 0; i < kNumItems; ++i) {
+    ozz::memory::default_allocator()->Delete(caches[i]);
+  }
+  ozz::memory::default_allocator()->Delete(animations[0]);
+  ozz::memory::default_allocator()->Delete(animations[1]);
+}
+
+TEST(Stats, SamplingJob) {
+  // Counters are only updated if stats are enabled.
+#ifdef OZZ_HAS_STATS
+  const bool enabled = true;
+#else  // OZZ_HAS_STATS
+  const bool enabled = false;
+#endif  // OZZ_HAS_STATS
+
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  AnimationBuilder builder;
+  Animation* linear = builder(raw_animation);
+  ASSERT_TRUE(linear != NULL);
+  builder.seek_interval = .1f;
+  Animation* indexed = builder(raw_animation);
+  ASSERT_TRUE(indexed != NULL);
+
+  SamplingCache cache(5);
+  const SamplingCache::Stats& stats = cache.stats();
+  EXPECT_EQ(stats.keys, 0);
+  EXPECT_EQ(stats.soa_updates, 0);
+  EXPECT_EQ(stats.resets, 0);
+  EXPECT_EQ(stats.seeks, 0);
+
+  ozz::math::SoaTransform output[2];
+  SamplingJob job;
+  job.animation = linear;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  // First sampling resets the cache and decodes all soa entries (2 soa tracks
+  // of translations, rotations and scales).
+  job.time = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.resets, enabled ? 1 : 0);
+  EXPECT_EQ(stats.soa_updates, enabled ? 6 : 0);
+  EXPECT_EQ(stats.keys > 0, enabled);
+  EXPECT_EQ(stats.seeks, 0);
+
+  // Sampling again at the same time consumes nothing.
+  const SamplingCache::Stats previous = stats;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.keys, previous.keys);
+  EXPECT_EQ(stats.soa_updates, previous.soa_updates);
+  EXPECT_EQ(stats.resets, previous.resets);
+
+  // Moving forward consumes keys.
+  job.time = 1.9f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.keys > previous.keys, enabled);
+  EXPECT_EQ(stats.soa_updates > previous.soa_updates, enabled);
+  EXPECT_EQ(stats.resets, previous.resets);
+
+  // Changing animation resets the cache, which is then restored from the seek
+  // index.
+  job.animation = indexed;
+  job.time = 1.5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.resets, enabled ? 2 : 0);
+  EXPECT_EQ(stats.seeks, enabled ? 1 : 0);
+
+  // So does invalidation.
+  cache.Invalidate();
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.resets, enabled ? 3 : 0);
+
+  cache.ResetStats();
+  EXPECT_EQ(stats.keys, 0);
+  EXPECT_EQ(stats.soa_updates, 0);
+  EXPECT_EQ(stats.resets, 0);
+  EXPECT_EQ(stats.seeks, 0);
+
+  ozz::memory::default_allocator()->Delete(linear);
+  ozz::memory::default_allocator()->Delete(indexed);
+}
+
+TEST(Snapshot, SamplingJob) {
+  RawAnimation raw_animation;
+  FillRawAnimation(&raw_animation);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(5);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform expected[2];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  // Invalid snapshot buffers.
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = cache.snapshot_size();
+  EXPECT_GT(size, cache.buffer_size(5, false));
+  char* snapshot = allocator->Allocate<char>(size);
+  EXPECT_FALSE(cache.Snapshot(NULL, size));
+  EXPECT_FALSE(cache.Snapshot(snapshot, size - 1));
+  EXPECT_FALSE(cache.Restore(NULL, size));
+  EXPECT_FALSE(cache.Restore(snapshot, size - 1));
+
+  // Samples forward up to the snapshot time.
+  for (float t = 0.f; t < .6f; t += .1f) {
+    job.time = t;
+    ASSERT_TRUE(job.Run());
+  }
+  job.time = .6f;
+  ASSERT_TRUE(job.Run());
+  ASSERT_TRUE(cache.Snapshot(snapshot, size));
+
+  // Reference output, from a new cache.
+  SamplingCache reference_cache(5);
+  job.cache = &reference_cache;
+  job.time = .75f;
+  ASSERT_TRUE(job.Run());
+  std::memcpy(expected, output, sizeof(output));
+  job.cache = &cache;
+
+  // Continues sampling forward, then rolls back.
+  job.time = 1.9f;
+  ASSERT_TRUE(job.Run());
+  ASSERT_TRUE(cache.Restore(snapshot, size));
+  const SamplingCache::Stats previous = cache.stats();
+  job.time = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+
+  // Restored cache is neither reset nor rewound.
+  EXPECT_EQ(cache.stats().resets, previous.resets);
+
+  // Restoring also works after invalidation, and in a different cache.
+  cache.Invalidate();
+  ASSERT_TRUE(cache.Restore(snapshot, size));
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+
+  SamplingCache other_cache(5);
+  ASSERT_TRUE(other_cache.Restore(snapshot, size));
+  job.cache = &other_cache;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+
+  // Caches with a different layout can't restore the snapshot.
+  SamplingCache compact_cache(5, true);
+  EXPECT_FALSE(compact_cache.Restore(snapshot, size));
+  SamplingCache bigger_cache(9);
+  const size_t bigger_size = bigger_cache.snapshot_size();
+  char* bigger_snapshot = allocator->Allocate<char>(bigger_size);
+  ASSERT_TRUE(bigger_cache.Snapshot(bigger_snapshot, bigger_size));
+  EXPECT_FALSE(cache.Restore(bigger_snapshot, bigger_size));
+  allocator->Deallocate(bigger_snapshot);
+
+  // Cache is left unchanged by failed restorations.
+  job.cache = &cache;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+
+  allocator->Deallocate(snapshot);
+  allocator->Delete(animation);
+}
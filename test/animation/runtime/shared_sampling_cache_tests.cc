@@ -0,0 +1,231 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/shared_sampling_cache.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/tasks/thread_pool.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::SharedSamplingCache;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds an animation of _num_tracks tracks, whose first track translates
+// along x from 0 to _distance in 1 second.
+Animation* BuildAnimation(int _num_tracks, float _distance) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i <= 10; ++i) {
+    const RawAnimation::TranslationKey key = {
+      i * .1f, ozz::math::Float3(_distance * i * .1f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Samples _animation at _time with a new cache, to compare with shared
+// entries.
+void SampleReference(const Animation& _animation, float _time,
+                     ozz::math::SoaTransform* _output) {
+  SamplingCache cache(_animation.num_tracks());
+  SamplingJob job;
+  job.animation = &_animation;
+  job.cache = &cache;
+  job.time = _time;
+  job.output.begin = _output;
+  job.output.end = _output + _animation.num_soa_tracks();
+  ASSERT_TRUE(job.Run());
+}
+
+const int kNumAgents = 256;
+const int kNumTimes = 5;
+
+// Agent _index samples one of the kNumTimes shared times, with its own
+// private cache.
+class SampleTask : public ozz::tasks::Task {
+ public:
+  SampleTask(SharedSamplingCache* _shared, const Animation* _animation,
+             SamplingCache** _caches, ozz::math::SoaTransform* _outputs)
+      : shared_(_shared),
+        animation_(_animation),
+        caches_(_caches),
+        outputs_(_outputs) {
+  }
+  virtual void Run(int _index) const {
+    ozz::math::SoaTransform* output = outputs_ + _index * 2;
+    const float time = (_index % kNumTimes) * .2f;
+    shared_->Sample(*animation_, time, caches_[_index],
+                    ozz::Range<ozz::math::SoaTransform>(output, 2));
+  }
+ private:
+  SharedSamplingCache* shared_;
+  const Animation* animation_;
+  SamplingCache** caches_;
+  ozz::math::SoaTransform* outputs_;
+};
+}  // namespace
+
+TEST(Validity, SharedSamplingCache) {
+  Animation* animation = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(animation != NULL);
+  Animation* too_big = BuildAnimation(9, 1.f);
+  ASSERT_TRUE(too_big != NULL);
+
+  SharedSamplingCache shared(8, 3, 0.f);
+  EXPECT_EQ(shared.capacity(), 4);
+  EXPECT_EQ(shared.max_tracks(), 8);
+  EXPECT_FLOAT_EQ(shared.time_step(), 0.f);
+  EXPECT_EQ(shared.num_entries(), 0);
+
+  SamplingCache cache(8);
+  SamplingCache small_cache(4);
+  ozz::math::SoaTransform output[3];
+  const ozz::Range<ozz::math::SoaTransform> range(output, 2);
+  EXPECT_FALSE(shared.Sample(*animation, 0.f, NULL, range));
+  EXPECT_FALSE(shared.Sample(*too_big, 0.f, &cache,
+                             ozz::Range<ozz::math::SoaTransform>(output)));
+  EXPECT_FALSE(shared.Sample(*animation, 0.f, &small_cache, range));
+  EXPECT_FALSE(shared.Sample(*animation, 0.f, &cache,
+                             ozz::Range<ozz::math::SoaTransform>(output, 1)));
+  EXPECT_EQ(shared.num_entries(), 0);
+
+  EXPECT_TRUE(shared.Sample(*animation, 0.f, &cache, range));
+  EXPECT_EQ(shared.num_entries(), 1);
+
+  ozz::memory::default_allocator()->Delete(too_big);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Share, SharedSamplingCache) {
+  Animation* animation = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(animation != NULL);
+  Animation* other = BuildAnimation(6, 2.f);
+  ASSERT_TRUE(other != NULL);
+
+  SharedSamplingCache shared(6, 2, .1f);
+  EXPECT_FLOAT_EQ(shared.Quantize(.26f), .3f);
+  const int64_t frame = shared.frame();
+
+  SamplingCache cache(6);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform expected[2];
+  const ozz::Range<ozz::math::SoaTransform> range(output);
+
+  // Close times share the same entry, whatever the private cache.
+  SampleReference(*animation, .3f, expected);
+  ASSERT_TRUE(shared.Sample(*animation, .29f, &cache, range));
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+  SamplingCache other_cache(6);
+  ASSERT_TRUE(shared.Sample(*animation, .31f, &other_cache, range));
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+  EXPECT_EQ(shared.num_entries(), 1);
+
+  // Different animations or times don't.
+  SampleReference(*other, .3f, expected);
+  ASSERT_TRUE(shared.Sample(*other, .3f, &cache, range));
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+  EXPECT_EQ(shared.num_entries(), 2);
+
+  // The cache is full, next entries are sampled directly.
+  SampleReference(*animation, .7f, expected);
+  ASSERT_TRUE(shared.Sample(*animation, .7f, &cache, range));
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+  EXPECT_EQ(shared.num_entries(), 2);
+
+  // New frame invalidates all entries.
+  shared.NewFrame();
+  EXPECT_EQ(shared.frame(), frame + 1);
+  EXPECT_EQ(shared.num_entries(), 0);
+  ASSERT_TRUE(shared.Sample(*animation, .7f, &cache, range));
+  EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+  EXPECT_EQ(shared.num_entries(), 1);
+
+  ozz::memory::default_allocator()->Delete(other);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Concurrent, SharedSamplingCache) {
+  Animation* animation = BuildAnimation(6, 1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  SharedSamplingCache shared(6, 8, 0.f);
+  ozz::Vector<SamplingCache*>::Std caches(kNumAgents);
+  for (int i = 0; i < kNumAgents; ++i) {
+    caches[i] = allocator->New<SamplingCache>(6);
+  }
+  ozz::math::SoaTransform* outputs =
+    allocator->Allocate<ozz::math::SoaTransform>(kNumAgents * 2);
+
+  ozz::math::SoaTransform expected[kNumTimes][2];
+  for (int i = 0; i < kNumTimes; ++i) {
+    SampleReference(*animation, i * .2f, expected[i]);
+  }
+
+  ozz::tasks::ThreadPool pool(4);
+  for (int frame = 0; frame < 3; ++frame) {
+    std::memset(outputs, 0, sizeof(ozz::math::SoaTransform) * kNumAgents * 2);
+    pool.Dispatch(SampleTask(&shared, animation, &caches[0], outputs),
+                  kNumAgents);
+
+    // Every agent gets the right posture. An entry is exceptionally sampled
+    // more than once, when a thread requests it while it's being sampled.
+    for (int i = 0; i < kNumAgents; ++i) {
+      EXPECT_EQ(std::memcmp(outputs + i * 2, expected[i % kNumTimes],
+                            sizeof(expected[0])), 0) << "agent " << i;
+    }
+    EXPECT_GE(shared.num_entries(), kNumTimes);
+    shared.NewFrame();
+  }
+
+  allocator->Deallocate(outputs);
+  for (int i = 0; i < kNumAgents; ++i) {
+    allocator->Delete(caches[i]);
+  }
+  ozz::memory::default_allocator()->Delete(animation);
+}
@@ -38,10 +38,12 @@
 #include "ozz/base/memory/allocator.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/skeleton_lod_builder.h"
 
 using ozz::animation::Skeleton;
 using ozz::animation::offline::RawSkeleton;
 using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::SkeletonLodBuilder;
 
 TEST(Empty, SkeletonSerialize) {
   ozz::io::MemoryStream stream;
@@ -115,7 +117,10 @@ TEST(Filled, SkeletonSerialize) {
                 o_skeleton->joint_properties().begin[i].is_leaf);
       EXPECT_STREQ(i_skeleton.joint_names()[i],
                    o_skeleton->joint_names()[i]);
+      EXPECT_EQ(i_skeleton.FindJoint(o_skeleton->joint_names()[i]), i);
     }
+    EXPECT_EQ(i_skeleton.FindJoint("j2"), -1);
+    EXPECT_EQ(i_skeleton.num_lods(), 1);
     for (int i = 0; i < (i_skeleton.num_joints() + 3) / 4; ++i) {
       EXPECT_TRUE(ozz::math::AreAllTrue(
         i_skeleton.bind_pose().begin[i].translation ==
@@ -131,6 +136,55 @@ TEST(Filled, SkeletonSerialize) {
   ozz::memory::default_allocator()->Delete(o_skeleton);
 }
 
+TEST(Lods, SkeletonSerialize) {
+  Skeleton* o_skeleton = NULL;
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    RawSkeleton::Joint& root = raw_skeleton.roots[0];
+    root.name = "root";
+    root.children.resize(2);
+    root.children[0].name = "j0";
+    root.children[1].name = "j1";
+    root.children[1].children.resize(1);
+    root.children[1].children[0].name = "j2";
+
+    SkeletonBuilder builder;
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+
+    SkeletonLodBuilder lod_builder;
+    o_skeleton = lod_builder(*skeleton);
+    ozz::memory::default_allocator()->Delete(skeleton);
+    ASSERT_TRUE(o_skeleton != NULL);
+    ASSERT_EQ(o_skeleton->num_lods(), 3);
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_skeleton;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    Skeleton i_skeleton;
+    i >> i_skeleton;
+
+    // Compares skeletons lods.
+    EXPECT_EQ(o_skeleton->num_joints(), i_skeleton.num_joints());
+    EXPECT_EQ(o_skeleton->num_lods(), i_skeleton.num_lods());
+    for (int l = 0; l < i_skeleton.num_lods(); ++l) {
+      EXPECT_EQ(o_skeleton->num_joints_lod(l), i_skeleton.num_joints_lod(l));
+    }
+  }
+  ozz::memory::default_allocator()->Delete(o_skeleton);
+}
+
 TEST(AlreadyInitialized, SkeletonSerialize) {
   Skeleton* o_skeleton[2] = {NULL, NULL};
   /* Builds output skeleton.
@@ -187,3 +241,88 @@ TEST(AlreadyInitialized, SkeletonSerialize) {
   ozz::memory::default_allocator()->Delete(o_skeleton[0]);
   ozz::memory::default_allocator()->Delete(o_skeleton[1]);
 }
+
+TEST(JointNamesLoading, SkeletonSerialize) {
+  Skeleton* o_skeleton = NULL;
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    RawSkeleton::Joint& root = raw_skeleton.roots[0];
+    root.name = "root";
+    root.children.resize(2);
+    root.children[0].name = "j0";
+    root.children[1].name = "j1";
+
+    SkeletonBuilder builder;
+    o_skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(o_skeleton != NULL);
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_skeleton;
+    const int64_t end = stream.Tell();
+
+    {  // Only loads hashes.
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      Skeleton i_skeleton;
+      i_skeleton.set_joint_names_loading(Skeleton::kLoadJointNameHashes);
+      i >> i_skeleton;
+      EXPECT_EQ(stream.Tell(), end);
+      EXPECT_EQ(i_skeleton.joint_names_loading(),
+                Skeleton::kLoadJointNameHashes);
+
+      ASSERT_EQ(i_skeleton.num_joints(), 3);
+      EXPECT_TRUE(i_skeleton.joint_names() == NULL);
+      EXPECT_EQ(i_skeleton.joint_properties().begin[2].parent, 0);
+      EXPECT_EQ(i_skeleton.FindJoint("root"), 0);
+      EXPECT_EQ(i_skeleton.FindJoint("j1"), 2);
+      EXPECT_EQ(i_skeleton.FindJoint("j2"), -1);
+
+      // Saves it again, names are lost but hashes remain.
+      ozz::io::MemoryStream restream;
+      ozz::io::OArchive ro(&restream, endianess);
+      ro << i_skeleton;
+      restream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive ri(&restream);
+      Skeleton ri_skeleton;
+      ri >> ri_skeleton;
+      ASSERT_EQ(ri_skeleton.num_joints(), 3);
+      ASSERT_TRUE(ri_skeleton.joint_names() != NULL);
+      EXPECT_STREQ(ri_skeleton.joint_names()[1], "");
+      EXPECT_EQ(ri_skeleton.FindJoint("j0"), -1);
+    }
+
+    {  // Skips names.
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      Skeleton i_skeleton;
+      i_skeleton.set_joint_names_loading(Skeleton::kSkipJointNames);
+      i >> i_skeleton;
+      EXPECT_EQ(stream.Tell(), end);
+
+      ASSERT_EQ(i_skeleton.num_joints(), 3);
+      EXPECT_TRUE(i_skeleton.joint_names() == NULL);
+      EXPECT_EQ(i_skeleton.joint_properties().begin[1].parent, 0);
+      EXPECT_EQ(i_skeleton.FindJoint("root"), -1);
+
+      // Saves it again, without lookup table.
+      ozz::io::MemoryStream restream;
+      ozz::io::OArchive ro(&restream, endianess);
+      ro << i_skeleton;
+      restream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive ri(&restream);
+      Skeleton ri_skeleton;
+      ri >> ri_skeleton;
+      const int64_t tell = restream.Tell();
+      EXPECT_EQ(restream.Seek(0, ozz::io::Stream::kEnd), 0);
+      EXPECT_EQ(restream.Tell(), tell);
+      ASSERT_EQ(ri_skeleton.num_joints(), 3);
+      EXPECT_EQ(ri_skeleton.FindJoint("root"), -1);
+    }
+  }
+  ozz::memory::default_allocator()->Delete(o_skeleton);
+}
@@ -38,6 +38,8 @@
 #include "ozz/options/options.h"
 #include "ozz/base/log.h"
 
+using ozz::animation::Skeleton;
+
 OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", true)
 OZZ_OPTIONS_DECLARE_INT(joints, "Number of joints", 0, true)
 OZZ_OPTIONS_DECLARE_STRING(root_name, "Name of the root joint", "", true)
@@ -75,5 +77,36 @@ TEST(Versioning, SkeletonSerialize) {
   EXPECT_EQ(skeleton.num_joints(), OPTIONS_joints);
   if (skeleton.num_joints()) {
     EXPECT_STREQ(skeleton.joint_names()[0], OPTIONS_root_name);
+    EXPECT_EQ(skeleton.FindJoint(OPTIONS_root_name), 0);
+    EXPECT_EQ(skeleton.joint_properties().begin[0].parent,
+              ozz::animation::Skeleton::kNoParentIndex);
+  }
+}
+
+TEST(VersioningNamesLoading, SkeletonSerialize) {
+  const Skeleton::JointNamesLoading modes[] = {
+    Skeleton::kLoadJointNameHashes, Skeleton::kSkipJointNames};
+  for (size_t m = 0; m < OZZ_ARRAY_SIZE(modes); ++m) {
+    ozz::io::File file(OPTIONS_file, "rb");
+    ASSERT_TRUE(file.opened());
+    ozz::io::IArchive archive(&file);
+
+    Skeleton skeleton;
+    skeleton.set_joint_names_loading(modes[m]);
+    archive >> skeleton;
+
+    // The whole object is read whatever names were loaded.
+    const int64_t tell = file.Tell();
+    EXPECT_EQ(file.Seek(0, ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(tell, file.Tell());
+
+    EXPECT_EQ(skeleton.num_joints(), OPTIONS_joints);
+    EXPECT_TRUE(skeleton.joint_names() == NULL);
+    if (skeleton.num_joints()) {
+      EXPECT_EQ(skeleton.FindJoint(OPTIONS_root_name),
+                modes[m] == Skeleton::kSkipJointNames ? -1 : 0);
+      EXPECT_EQ(skeleton.joint_properties().begin[0].parent,
+                Skeleton::kNoParentIndex);
+    }
   }
 }
@@ -31,6 +31,7 @@
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 
+#include <cstdio>
 #include <cstring>
 
 #include "gtest/gtest.h"
@@ -38,6 +39,7 @@
 #include "ozz/base/maths/gtest_math_helper.h"
 
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/linear_allocator.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
 
@@ -306,3 +308,191 @@ TEST(InterateWorstDepthDF, SkeletonUtils) {
   }
   ozz::memory::default_allocator()->Delete(skeleton);
 }
+
+namespace {
+// Counts iterated joints, and tests them against _expected ones.
+struct IterateDFCounter {
+  explicit IterateDFCounter(const uint16_t* _expected)
+    : expected(_expected),
+      num_iterations(0) {
+  }
+  void operator()(int _current, int /*_parent*/) {
+    EXPECT_EQ(expected[num_iterations], _current);
+    ++num_iterations;
+  }
+  const uint16_t* expected;
+  int num_iterations;
+};
+}  // namespace
+
+TEST(InterateScratchDF, SkeletonUtils) {
+  // Builds a skeleton with a chain and a few siblings:
+  // r0(0) has children a(1) and b(2), a(1) has a 20 joints chain.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(2);
+  RawSkeleton::Joint::Children* child =
+    &raw_skeleton.roots[0].children[0].children;
+  for (int i = 0; i < 20; ++i) {
+    child->resize(1);
+    child = &child->at(0).children;
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  const int num_joints = skeleton->num_joints();
+  ASSERT_EQ(num_joints, 23);
+
+  ozz::memory::ArenaAllocator arena(256);
+  uint16_t joints_buffer[23];
+  const ozz::Range<uint16_t> joints(joints_buffer);
+
+  // Invalid arguments.
+  EXPECT_EQ(ozz::animation::IterateJointsDF(*skeleton, 23, joints, &arena), 0);
+  EXPECT_EQ(ozz::animation::IterateJointsDF(
+    *skeleton, Skeleton::kNoParentIndex,
+    ozz::Range<uint16_t>(joints_buffer, 22), &arena), 0);
+
+  // Matches JointsIterator variant, for every starting joint.
+  for (int from = Skeleton::kNoParentIndex; from < num_joints; ++from) {
+    ozz::animation::JointsIterator it;
+    ozz::animation::IterateJointsDF(*skeleton, from, &it);
+    const int num_iterated =
+      ozz::animation::IterateJointsDF(*skeleton, from, joints, &arena);
+    ASSERT_EQ(num_iterated, it.num_joints);
+    EXPECT_EQ(std::memcmp(joints_buffer, it.joints,
+                          num_iterated * sizeof(uint16_t)), 0);
+
+    IterateDFCounter fct = ozz::animation::IterateJointsDF(
+      *skeleton, from, IterateDFCounter(it.joints), &arena);
+    EXPECT_EQ(fct.num_iterations, it.num_joints);
+
+    // Scratch memory is released.
+    EXPECT_EQ(arena.used(), 0u);
+  }
+
+  // Default allocator is used without scratch allocator.
+  EXPECT_EQ(ozz::animation::IterateJointsDF(
+    *skeleton, Skeleton::kNoParentIndex, joints, NULL), num_joints);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(BuildJointEvaluationList, SkeletonUtils) {
+  // Builds a 42 joints skeleton, breadth-first indices:
+  // root(0) has 40 children c(1) to c(40), c(1) has a child g(41).
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(40);
+  for (int i = 0; i < 40; ++i) {
+    char name[16];
+    std::sprintf(name, "c%d", i + 1);
+    root.children[i].name = name;
+  }
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "g";
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 42);
+  ASSERT_EQ(skeleton->joint_properties()[41].parent, 1);
+
+  uint16_t list_buffer[42];
+  unsigned char mask_buffer[2];
+  const ozz::Range<uint16_t> list(list_buffer);
+  const ozz::Range<unsigned char> mask(mask_buffer);
+  const ozz::Range<unsigned char> no_mask;
+
+  {  // Invalid joint indices.
+    const int negative[] = {41, -1};
+    EXPECT_EQ(ozz::animation::BuildJointEvaluationList(
+      *skeleton, ozz::Range<const int>(negative), list, no_mask), 0);
+    const int too_big[] = {42};
+    EXPECT_EQ(ozz::animation::BuildJointEvaluationList(
+      *skeleton, ozz::Range<const int>(too_big), list, no_mask), 0);
+  }
+
+  {  // Empty request.
+    EXPECT_EQ(ozz::animation::BuildJointEvaluationList(
+      *skeleton, ozz::Range<const int>(), list, mask), 0);
+    EXPECT_EQ(mask_buffer[0], 0);
+    EXPECT_EQ(mask_buffer[1], 0);
+  }
+
+  const int joints_buffer[] = {41, 38, 41};
+  const ozz::Range<const int> joints(joints_buffer);
+
+  {  // List too small.
+    EXPECT_EQ(ozz::animation::BuildJointEvaluationList(
+      *skeleton, joints, ozz::Range<uint16_t>(list_buffer, 3), no_mask), 0);
+  }
+
+  {  // Mask too small.
+    EXPECT_EQ(ozz::animation::BuildJointEvaluationList(
+      *skeleton, joints, list, ozz::Range<unsigned char>(mask_buffer, 1)), 0);
+  }
+
+  {  // Without mask.
+    EXPECT_EQ(ozz::animation::BuildJointEvaluationList(
+      *skeleton, joints, list, no_mask), 4);
+    EXPECT_EQ(list_buffer[0], 0);
+    EXPECT_EQ(list_buffer[1], 1);
+    EXPECT_EQ(list_buffer[2], 38);
+    EXPECT_EQ(list_buffer[3], 41);
+  }
+
+  {  // With mask, soa joints 0, 9 and 10.
+    mask_buffer[0] = mask_buffer[1] = 0xff;
+    EXPECT_EQ(ozz::animation::BuildJointEvaluationList(
+      *skeleton, joints, ozz::Range<uint16_t>(list_buffer, 4), mask), 4);
+    EXPECT_EQ(list_buffer[0], 0);
+    EXPECT_EQ(list_buffer[3], 41);
+    EXPECT_EQ(mask_buffer[0], 0x01);
+    EXPECT_EQ(mask_buffer[1], 0x06);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(BuildSoaUpdatePeriods, SkeletonUtils) {
+  // Builds a 6 joints skeleton, root(0) has 5 children.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    char name[16];
+    std::sprintf(name, "c%d", i + 1);
+    root.children[i].name = name;
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_soa_joints(), 2);
+
+  const unsigned char joint_periods_buffer[] = {4, 4, 2, 4, 0, 3};
+  const ozz::Range<const unsigned char> joint_periods(joint_periods_buffer);
+  unsigned char soa_periods_buffer[2];
+  const ozz::Range<unsigned char> soa_periods(soa_periods_buffer);
+
+  EXPECT_FALSE(ozz::animation::BuildSoaUpdatePeriods(
+    *skeleton, ozz::Range<const unsigned char>(joint_periods_buffer, 5),
+    soa_periods));
+  EXPECT_FALSE(ozz::animation::BuildSoaUpdatePeriods(
+    *skeleton, joint_periods,
+    ozz::Range<unsigned char>(soa_periods_buffer, 1)));
+
+  // The smallest period of soa joints, 0 meaning every frame.
+  EXPECT_TRUE(ozz::animation::BuildSoaUpdatePeriods(
+    *skeleton, joint_periods, soa_periods));
+  EXPECT_EQ(soa_periods_buffer[0], 2);
+  EXPECT_EQ(soa_periods_buffer[1], 1);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,227 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sparse_sampling_job.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/sparse_animation_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::SparseSamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::SparseAnimationBuilder;
+
+namespace {
+// Builds a skeleton of 10 root joints, whose bind pose is translated along y
+// by the joint index.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(10);
+  for (int i = 0; i < 10; ++i) {
+    RawSkeleton::Joint& joint = raw_skeleton.roots[i];
+    joint.name = "joint";
+    joint.name += static_cast<char>('0' + i);
+    joint.transform = ozz::math::Transform::identity();
+    joint.transform.translation.y = static_cast<float>(i);
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation of the 10 joints, that only animates joints 4 to 7
+// and 9. Others are at bind pose.
+void BuildRawAnimation(RawAnimation* _raw_animation) {
+  _raw_animation->duration = 1.f;
+  _raw_animation->tracks.resize(10);
+  for (int i = 0; i < 10; ++i) {
+    RawAnimation::JointTrack& track = _raw_animation->tracks[i];
+    const bool animated = (i >= 4 && i <= 7) || i == 9;
+    const RawAnimation::TranslationKey first = {
+      0.f, ozz::math::Float3(0.f, static_cast<float>(i), 0.f)};
+    const RawAnimation::TranslationKey last = {
+      1.f, ozz::math::Float3(animated ? i * 1.f : 0.f,
+                             static_cast<float>(i), 0.f)};
+    track.translations.push_back(first);
+    track.translations.push_back(last);
+    if (animated) {
+      const RawAnimation::RotationKey rotation = {
+        1.f, ozz::math::Quaternion::FromAxisAngle(
+               ozz::math::Float4(0.f, 1.f, 0.f, i * .1f))};
+      track.rotations.push_back(rotation);
+    }
+  }
+}
+}  // namespace
+
+TEST(JobValidity, SparseSamplingJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+  ozz::Vector<uint16_t>::Std joints;
+  SparseAnimationBuilder builder;
+  Animation* animation = builder(raw_animation, *skeleton, &joints);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_EQ(joints.size(), 5u);
+
+  SamplingCache cache(5);
+  ozz::math::SoaTransform output[3];
+
+  {  // Default job.
+    SparseSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  SparseSamplingJob valid;
+  valid.animation = animation;
+  valid.cache = &cache;
+  valid.joints.begin = &joints[0];
+  valid.joints.end = &joints[0] + joints.size();
+  valid.output = output;
+  EXPECT_TRUE(valid.Validate());
+
+  {  // Joints size mismatch.
+    SparseSamplingJob job = valid;
+    job.joints.end = job.joints.begin + 4;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Unsorted joints.
+    const uint16_t unsorted[] = {4, 5, 5, 7, 9};
+    SparseSamplingJob job = valid;
+    job.joints = unsorted;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Output too small for joint 9.
+    SparseSamplingJob job = valid;
+    job.output.end = output + 2;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Cache too small.
+    SamplingCache small_cache(4);
+    SparseSamplingJob job = valid;
+    job.cache = &small_cache;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Sample, SparseSamplingJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+
+  // Dense animation is the reference.
+  AnimationBuilder dense_builder;
+  Animation* dense = dense_builder(raw_animation);
+  ASSERT_TRUE(dense != NULL);
+
+  ozz::Vector<uint16_t>::Std joints;
+  SparseAnimationBuilder builder;
+  Animation* sparse = builder(raw_animation, *skeleton, &joints);
+  ASSERT_TRUE(sparse != NULL);
+  EXPECT_EQ(sparse->num_soa_tracks(), 2);
+
+  SamplingCache dense_cache(10);
+  SamplingCache sparse_cache(5);
+  ozz::math::SoaTransform dense_output[3];
+  ozz::math::SoaTransform output[3];
+
+  SamplingJob dense_job;
+  dense_job.animation = dense;
+  dense_job.cache = &dense_cache;
+  dense_job.output = dense_output;
+
+  SparseSamplingJob job;
+  job.animation = sparse;
+  job.cache = &sparse_cache;
+  job.joints.begin = &joints[0];
+  job.joints.end = &joints[0] + joints.size();
+  job.output = output;
+
+  const float times[] = {0.f, .3f, .7f, 1.f, .1f};
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(times); ++t) {
+    dense_job.time = times[t];
+    ASSERT_TRUE(dense_job.Run());
+
+    // Output is pre-filled with the bind pose.
+    std::memcpy(output, skeleton->bind_pose().begin, sizeof(output));
+    job.time = times[t];
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < 3; ++i) {
+      const ozz::math::SoaTransform& a = output[i];
+      const ozz::math::SoaTransform& b = dense_output[i];
+      const ozz::math::SimdFloat4 tolerance =
+        ozz::math::simd_float4::Load1(1e-4f);
+      const ozz::math::SimdFloat4 diffs[] = {
+        a.translation.x - b.translation.x, a.translation.y - b.translation.y,
+        a.translation.z - b.translation.z, a.rotation.x - b.rotation.x,
+        a.rotation.y - b.rotation.y, a.rotation.z - b.rotation.z,
+        a.rotation.w - b.rotation.w, a.scale.x - b.scale.x,
+        a.scale.y - b.scale.y, a.scale.z - b.scale.z};
+      for (size_t d = 0; d < OZZ_ARRAY_SIZE(diffs); ++d) {
+        // Padding lanes of the last soa element aren't compared.
+        const ozz::math::SimdInt4 near =
+          ozz::math::CmpLe(ozz::math::Abs(diffs[d]), tolerance);
+        const int lanes = i == 2 ? 0x3 : 0xf;
+        EXPECT_EQ(ozz::math::MoveMask(near) & lanes, lanes) <<
+          "time " << times[t] << " soa " << i << " component " << d;
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(sparse);
+  ozz::memory::default_allocator()->Delete(dense);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
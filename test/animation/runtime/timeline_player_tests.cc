@@ -0,0 +1,180 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/timeline_player.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::TimelinePlayer;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+
+namespace {
+// Builds a 1s animation whose track 0 translates along x from 0 to 2, with a
+// key every .5s.
+Animation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  for (int i = 0; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+      i * .5f, ozz::math::Float3(i * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(AddClip, TimelinePlayer) {
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+
+  TimelinePlayer player(1);
+  EXPECT_EQ(player.num_clips(), 0);
+
+  TimelinePlayer::Clip clip;
+  EXPECT_EQ(player.AddClip(clip), -1);
+  clip.animation = animation;
+  EXPECT_EQ(player.AddClip(clip), -1);
+  clip.cache = &cache;
+  EXPECT_EQ(player.AddClip(clip), -1);
+  clip.output = output;
+  EXPECT_EQ(player.AddClip(clip), 0);
+  EXPECT_EQ(player.num_clips(), 1);
+  EXPECT_EQ(player.clip(0).animation, animation);
+
+  // Player is full.
+  EXPECT_EQ(player.AddClip(clip), -1);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Update, TimelinePlayer) {
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  // 3 clips, of which the first two overlap.
+  SamplingCache cache0(1), cache1(1), cache2(1);
+  SamplingCache* caches[3] = {&cache0, &cache1, &cache2};
+  ozz::math::SoaTransform outputs[3];
+  const float starts[3] = {0.f, .5f, 3.f};
+  TimelinePlayer player(3);
+  for (int i = 0; i < 3; ++i) {
+    TimelinePlayer::Clip clip;
+    clip.animation = animation;
+    clip.start = starts[i];
+    clip.cache = caches[i];
+    clip.output.begin = &outputs[i];
+    clip.output.end = &outputs[i] + 1;
+    EXPECT_EQ(player.AddClip(clip), i);
+  }
+  for (int i = 0; i < 3; ++i) {
+    outputs[i] = ozz::math::SoaTransform::identity();
+  }
+
+  // First clip starts.
+  ASSERT_TRUE(player.Update(0.f));
+  EXPECT_EQ(player.num_playing(), 1);
+  EXPECT_EQ(player.transitions(), 1);
+  EXPECT_TRUE(player.playing(0));
+  EXPECT_FALSE(player.playing(1));
+
+  // Cached keys are only interpolated.
+  ASSERT_TRUE(player.Update(.25f));
+  EXPECT_FLOAT_EQ(player.time(), .25f);
+  EXPECT_EQ(player.transitions(), 0);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[0].translation, .5f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f);
+
+  // Second clip starts, first one crosses its middle key.
+  ASSERT_TRUE(player.Update(.75f));
+  EXPECT_EQ(player.num_playing(), 2);
+  EXPECT_EQ(player.transitions(), 2);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[0].translation, 1.5f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[1].translation, .5f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f);
+
+  // First clip ends, holding its last pose.
+  ASSERT_TRUE(player.Update(1.25f));
+  EXPECT_EQ(player.num_playing(), 1);
+  EXPECT_FALSE(player.playing(0));
+  EXPECT_TRUE(player.playing(1));
+  EXPECT_EQ(player.transitions(), 1);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[0].translation, 2.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[1].translation, 1.5f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f);
+
+  // Nothing plays in between clips.
+  ASSERT_TRUE(player.Update(2.f));
+  EXPECT_EQ(player.num_playing(), 0);
+  EXPECT_EQ(player.transitions(), 0);
+
+  // Last clip.
+  ASSERT_TRUE(player.Update(3.1f));
+  EXPECT_EQ(player.num_playing(), 1);
+  EXPECT_TRUE(player.playing(2));
+
+  // Scrubbing backward plays the first clips again.
+  ASSERT_TRUE(player.Update(.6f));
+  EXPECT_EQ(player.num_playing(), 2);
+  EXPECT_TRUE(player.playing(0));
+  EXPECT_TRUE(player.playing(1));
+  EXPECT_FALSE(player.playing(2));
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[0].translation, 1.2f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[1].translation, .2f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
@@ -0,0 +1,363 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/two_bone_ik_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/soa_quaternion.h"
+
+using ozz::animation::BatchTwoBoneIKJob;
+using ozz::animation::TwoBoneIKJob;
+
+namespace {
+ozz::math::SimdFloat4 ToSimd(const ozz::math::Quaternion& _q) {
+  return ozz::math::simd_float4::Load(_q.x, _q.y, _q.z, _q.w);
+}
+
+// Applies local corrections to the chain and returns the corrected model space
+// matrices of the mid and end joints.
+void ApplyCorrections(const ozz::math::Float4x4& _start,
+                      const ozz::math::Float4x4& _mid,
+                      const ozz::math::Float4x4& _end,
+                      const ozz::math::Quaternion& _start_correction,
+                      const ozz::math::Quaternion& _mid_correction,
+                      ozz::math::Float4x4* _corrected_mid,
+                      ozz::math::Float4x4* _corrected_end) {
+  const ozz::math::Float4x4 start =
+      _start * ozz::math::Float4x4::FromQuaternion(ToSimd(_start_correction));
+  *_corrected_mid =
+      start * Invert(_start) * _mid *
+      ozz::math::Float4x4::FromQuaternion(ToSimd(_mid_correction));
+  *_corrected_end = *_corrected_mid * Invert(_mid) * _end;
+}
+
+void ExpectPositionNear(const ozz::math::Float4x4& _m, float _x, float _y,
+                        float _z) {
+  union {
+    ozz::math::SimdFloat4 ret;
+    float af[4];
+  } u = {_m.cols[3]};
+  EXPECT_NEAR(u.af[0], _x, 1e-4f);
+  EXPECT_NEAR(u.af[1], _y, 1e-4f);
+  EXPECT_NEAR(u.af[2], _z, 1e-4f);
+}
+}  // namespace
+
+TEST(JobValidity, TwoBoneIKJob) {
+  const ozz::math::Float4x4 identity = ozz::math::Float4x4::identity();
+  ozz::math::Quaternion start_correction;
+  ozz::math::Quaternion mid_correction;
+
+  {  // Default is invalid.
+    TwoBoneIKJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Missing end joint.
+    TwoBoneIKJob job;
+    job.start_joint = &identity;
+    job.mid_joint = &identity;
+    job.start_joint_correction = &start_correction;
+    job.mid_joint_correction = &mid_correction;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Missing output.
+    TwoBoneIKJob job;
+    job.start_joint = &identity;
+    job.mid_joint = &identity;
+    job.end_joint = &identity;
+    job.start_joint_correction = &start_correction;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Non normalized mid axis.
+    TwoBoneIKJob job;
+    job.start_joint = &identity;
+    job.mid_joint = &identity;
+    job.end_joint = &identity;
+    job.start_joint_correction = &start_correction;
+    job.mid_joint_correction = &mid_correction;
+    job.mid_axis = ozz::math::simd_float4::Load(0.f, 0.f, 2.f, 0.f);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid, "reached" is optional.
+    TwoBoneIKJob job;
+    job.start_joint = &identity;
+    job.mid_joint = &identity;
+    job.end_joint = &identity;
+    job.start_joint_correction = &start_correction;
+    job.mid_joint_correction = &mid_correction;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(JobValidity, BatchTwoBoneIKJob) {
+  const ozz::math::Float4x4 identity = ozz::math::Float4x4::identity();
+  ozz::math::SoaQuaternion start_corrections;
+  ozz::math::SoaQuaternion mid_corrections;
+
+  {  // Default is invalid.
+    BatchTwoBoneIKJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Inconsistent lane.
+    BatchTwoBoneIKJob job;
+    job.start_joint_corrections = &start_corrections;
+    job.mid_joint_corrections = &mid_corrections;
+    job.start_joints[2] = &identity;
+    job.mid_joints[2] = &identity;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid, all lanes inactive.
+    BatchTwoBoneIKJob job;
+    job.start_joint_corrections = &start_corrections;
+    job.mid_joint_corrections = &mid_corrections;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_SOAQUATERNION_EQ(start_corrections, 0.f, 0.f, 0.f, 0.f,
+                                               0.f, 0.f, 0.f, 0.f,
+                                               0.f, 0.f, 0.f, 0.f,
+                                               1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAQUATERNION_EQ(mid_corrections, 0.f, 0.f, 0.f, 0.f,
+                                             0.f, 0.f, 0.f, 0.f,
+                                             0.f, 0.f, 0.f, 0.f,
+                                             1.f, 1.f, 1.f, 1.f);
+  }
+}
+
+TEST(Straight, TwoBoneIKJob) {
+  // A straight chain along x axis.
+  const ozz::math::Float4x4 start = ozz::math::Float4x4::identity();
+  const ozz::math::Float4x4 mid = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 0.f, 0.f, 0.f));
+  const ozz::math::Float4x4 end = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(2.f, 0.f, 0.f, 0.f));
+
+  ozz::math::Quaternion start_correction;
+  ozz::math::Quaternion mid_correction;
+  bool reached = false;
+
+  TwoBoneIKJob job;
+  job.start_joint = &start;
+  job.mid_joint = &mid;
+  job.end_joint = &end;
+  job.start_joint_correction = &start_correction;
+  job.mid_joint_correction = &mid_correction;
+  job.reached = &reached;
+
+  {  // Target at chain end requires no correction.
+    job.target = ozz::math::simd_float4::Load(2.f, 0.f, 0.f, 0.f);
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+    EXPECT_QUATERNION_EQ(start_correction, 0.f, 0.f, 0.f, 1.f);
+    EXPECT_QUATERNION_EQ(mid_correction, 0.f, 0.f, 0.f, 1.f);
+  }
+
+  {  // Bends mid joint by 90 degrees, towards the pole.
+    job.target = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+    EXPECT_QUATERNION_EQ(start_correction, 0.f, 0.f, .7071068f, .7071068f);
+    EXPECT_QUATERNION_EQ(mid_correction, 0.f, 0.f, -.7071068f, .7071068f);
+
+    ozz::math::Float4x4 corrected_mid, corrected_end;
+    ApplyCorrections(start, mid, end, start_correction, mid_correction,
+                     &corrected_mid, &corrected_end);
+    ExpectPositionNear(corrected_mid, 0.f, 1.f, 0.f);
+    ExpectPositionNear(corrected_end, 1.f, 1.f, 0.f);
+  }
+
+  {  // Pole vector flips the bending side.
+    job.target = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+    job.pole_vector = ozz::math::simd_float4::Load(0.f, -1.f, 0.f, 0.f);
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+
+    ozz::math::Float4x4 corrected_mid, corrected_end;
+    ApplyCorrections(start, mid, end, start_correction, mid_correction,
+                     &corrected_mid, &corrected_end);
+    ExpectPositionNear(corrected_mid, 1.f, 0.f, 0.f);
+    ExpectPositionNear(corrected_end, 1.f, 1.f, 0.f);
+    job.pole_vector = ozz::math::simd_float4::y_axis();
+  }
+
+  {  // Unreachable target, the chain is stretched towards it.
+    job.target = ozz::math::simd_float4::Load(0.f, 3.f, 0.f, 0.f);
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(reached);
+
+    ozz::math::Float4x4 corrected_mid, corrected_end;
+    ApplyCorrections(start, mid, end, start_correction, mid_correction,
+                     &corrected_mid, &corrected_end);
+    ExpectPositionNear(corrected_mid, 0.f, 1.f, 0.f);
+    ExpectPositionNear(corrected_end, 0.f, 2.f, 0.f);
+  }
+
+  {  // Null weight disables correction.
+    job.target = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+    job.weight = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_QUATERNION_EQ(start_correction, 0.f, 0.f, 0.f, 1.f);
+    EXPECT_QUATERNION_EQ(mid_correction, 0.f, 0.f, 0.f, 1.f);
+  }
+
+  {  // Weight is clamped.
+    job.weight = 2.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_QUATERNION_EQ(start_correction, 0.f, 0.f, .7071068f, .7071068f);
+    EXPECT_QUATERNION_EQ(mid_correction, 0.f, 0.f, -.7071068f, .7071068f);
+  }
+}
+
+TEST(Transformed, TwoBoneIKJob) {
+  // A bent chain, whose joints are rotated and scaled.
+  const ozz::math::Quaternion rotation = ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(0.f, 1.f, 0.f, ozz::math::kPi_2));
+  const ozz::math::SimdFloat4 scale = ozz::math::simd_float4::Load1(2.f);
+  const ozz::math::Float4x4 start = ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f), ToSimd(rotation),
+      scale);
+  const ozz::math::Float4x4 mid =
+      start * ozz::math::Float4x4::Translation(
+                  ozz::math::simd_float4::Load(1.f, 0.f, 0.f, 0.f)) *
+      ozz::math::Float4x4::FromQuaternion(
+          ToSimd(ozz::math::Quaternion::FromAxisAngle(
+              ozz::math::Float4(0.f, 0.f, 1.f, ozz::math::kPi_2 * .5f))));
+  const ozz::math::Float4x4 end =
+      mid * ozz::math::Float4x4::Translation(
+                ozz::math::simd_float4::Load(1.f, 0.f, 0.f, 0.f));
+
+  ozz::math::Quaternion start_correction;
+  ozz::math::Quaternion mid_correction;
+  bool reached = false;
+
+  TwoBoneIKJob job;
+  job.start_joint = &start;
+  job.mid_joint = &mid;
+  job.end_joint = &end;
+  job.start_joint_correction = &start_correction;
+  job.mid_joint_correction = &mid_correction;
+  job.reached = &reached;
+
+  const float targets[][3] = {{1.f, 2.f, 0.f},
+                              {2.f, 4.f, 3.f},
+                              {-1.f, 1.f, 4.f},
+                              {1.f, 2.f, 5.5f}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(targets); ++i) {
+    job.target = ozz::math::simd_float4::Load(targets[i][0], targets[i][1],
+                                              targets[i][2], 0.f);
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+
+    ozz::math::Float4x4 corrected_mid, corrected_end;
+    ApplyCorrections(start, mid, end, start_correction, mid_correction,
+                     &corrected_mid, &corrected_end);
+    ExpectPositionNear(corrected_end, targets[i][0], targets[i][1],
+                       targets[i][2]);
+  }
+}
+
+TEST(Batch, TwoBoneIKJob) {
+  const ozz::math::Float4x4 start = ozz::math::Float4x4::identity();
+  const ozz::math::Float4x4 mid = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 0.f, 0.f, 0.f));
+  const ozz::math::Float4x4 end = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f));
+
+  const float targets[4][3] = {{1.f, 1.f, 0.f},
+                               {0.f, 1.4f, .5f},
+                               {1.f, 1.f, 1.f},
+                               {0.f, 4.f, 0.f}};
+
+  ozz::math::SoaQuaternion start_corrections;
+  ozz::math::SoaQuaternion mid_corrections;
+  ozz::math::SimdInt4 reached;
+
+  BatchTwoBoneIKJob batch;
+  for (int i = 0; i < 4; ++i) {
+    if (i != 2) {  // Lane 2 is inactive.
+      batch.start_joints[i] = &start;
+      batch.mid_joints[i] = &mid;
+      batch.end_joints[i] = &end;
+    }
+  }
+  const ozz::math::SoaFloat3 target = {
+      ozz::math::simd_float4::Load(targets[0][0], targets[1][0],
+                                   targets[2][0], targets[3][0]),
+      ozz::math::simd_float4::Load(targets[0][1], targets[1][1],
+                                   targets[2][1], targets[3][1]),
+      ozz::math::simd_float4::Load(targets[0][2], targets[1][2],
+                                   targets[2][2], targets[3][2])};
+  batch.target = target;
+  batch.weight = ozz::math::simd_float4::Load(1.f, .5f, 1.f, 1.f);
+  batch.start_joint_corrections = &start_corrections;
+  batch.mid_joint_corrections = &mid_corrections;
+  batch.reached = &reached;
+  ASSERT_TRUE(batch.Run());
+  EXPECT_SIMDINT_EQ(reached, 0xffffffff, 0xffffffff, 0, 0);
+
+  union {
+    ozz::math::SoaQuaternion soa;
+    float af[4][4];
+  } starts = {start_corrections}, mids = {mid_corrections};
+
+  // Compares each lane with its single chain equivalent.
+  for (int i = 0; i < 4; ++i) {
+    ozz::math::Quaternion start_correction;
+    ozz::math::Quaternion mid_correction;
+    TwoBoneIKJob job;
+    job.start_joint = &start;
+    job.mid_joint = &mid;
+    job.end_joint = &end;
+    job.target = ozz::math::simd_float4::Load(targets[i][0], targets[i][1],
+                                              targets[i][2], 0.f);
+    job.weight = i == 1 ? .5f : 1.f;
+    job.start_joint_correction = &start_correction;
+    job.mid_joint_correction = &mid_correction;
+    ASSERT_TRUE(job.Run());
+    if (i == 2) {
+      start_correction = ozz::math::Quaternion::identity();
+      mid_correction = ozz::math::Quaternion::identity();
+    }
+    EXPECT_QUATERNION_EQ(start_correction, starts.af[0][i], starts.af[1][i],
+                         starts.af[2][i], starts.af[3][i]);
+    EXPECT_QUATERNION_EQ(mid_correction, mids.af[0][i], mids.af[1][i],
+                         mids.af[2][i], mids.af[3][i]);
+  }
+}
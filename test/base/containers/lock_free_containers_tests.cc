@@ -0,0 +1,184 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/containers/mpsc_queue.h"
+#include "ozz/base/containers/work_stealing_deque.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/tasks/thread_pool.h"
+
+namespace {
+// Queued element, that inherits from two hooks so it can be in two queues.
+struct Job : public ozz::containers::MpscQueue<Job>::Hook,
+             public ozz::containers::MpscQueue<Job, 1>::Hook {
+  Job() : value(0), count(0) {}
+  int value;
+  int count;
+};
+
+const int kNumJobs = 10000;
+const int kNumThreads = 4;
+
+// Pushes job _index to the queue, from any worker.
+class PushTask : public ozz::tasks::Task {
+ public:
+  PushTask(ozz::containers::MpscQueue<Job>* _queue, Job* _jobs)
+      : queue_(_queue),
+        jobs_(_jobs) {
+  }
+  virtual void Run(int _index) const {
+    queue_->push(jobs_ + _index);
+  }
+ private:
+  ozz::containers::MpscQueue<Job>* queue_;
+  Job* jobs_;
+};
+
+// Work item 0 is the deque owner, which pops until the deque is
+// empty. Others are thieves.
+class StealTask : public ozz::tasks::Task {
+ public:
+  explicit StealTask(ozz::containers::WorkStealingDeque<Job>* _deque)
+      : deque_(_deque) {
+  }
+  virtual void Run(int _index) const {
+    while (!deque_->empty()) {
+      Job* job = _index == 0 ? deque_->pop() : deque_->steal();
+      if (job) {
+        ++job->count;
+      }
+    }
+  }
+ private:
+  ozz::containers::WorkStealingDeque<Job>* deque_;
+};
+}  // namespace
+
+TEST(MpscQueue, Containers) {
+  ozz::containers::MpscQueue<Job> queue;
+  ozz::containers::MpscQueue<Job, 1> other;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.pop() == NULL);
+
+  Job jobs[3];
+  for (int i = 0; i < 3; ++i) {
+    jobs[i].value = i;
+    queue.push(jobs + i);
+  }
+  other.push(jobs + 2);
+  EXPECT_FALSE(queue.empty());
+
+  // FIFO order.
+  EXPECT_EQ(queue.pop(), jobs + 0);
+  EXPECT_EQ(queue.pop(), jobs + 1);
+
+  // Interleaves pushes and pops, including of the last element.
+  queue.push(jobs + 0);
+  EXPECT_EQ(queue.pop(), jobs + 2);
+  EXPECT_EQ(queue.pop(), jobs + 0);
+  EXPECT_TRUE(queue.pop() == NULL);
+  EXPECT_TRUE(queue.empty());
+  queue.push(jobs + 1);
+  EXPECT_FALSE(queue.empty());
+  EXPECT_EQ(queue.pop(), jobs + 1);
+  EXPECT_TRUE(queue.empty());
+
+  // The other queue isn't affected.
+  EXPECT_EQ(other.pop(), jobs + 2);
+  EXPECT_TRUE(other.empty());
+}
+
+TEST(MpscQueueConcurrent, Containers) {
+  ozz::Vector<Job>::Std jobs(kNumJobs);
+  ozz::containers::MpscQueue<Job> queue;
+  ozz::tasks::ThreadPool pool(kNumThreads);
+  pool.Dispatch(PushTask(&queue, &jobs[0]), kNumJobs);
+
+  // Every job is popped once.
+  int popped = 0;
+  for (Job* job; (job = queue.pop()) != NULL; ++popped) {
+    ++job->count;
+  }
+  EXPECT_EQ(popped, kNumJobs);
+  EXPECT_TRUE(queue.empty());
+  for (int i = 0; i < kNumJobs; ++i) {
+    EXPECT_EQ(jobs[i].count, 1);
+  }
+}
+
+TEST(WorkStealingDeque, Containers) {
+  ozz::containers::WorkStealingDeque<Job> deque(3);
+  EXPECT_EQ(deque.capacity(), 4);
+  EXPECT_TRUE(deque.empty());
+  EXPECT_TRUE(deque.pop() == NULL);
+  EXPECT_TRUE(deque.steal() == NULL);
+
+  Job jobs[5];
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(deque.push(jobs + i));
+  }
+  EXPECT_FALSE(deque.push(jobs + 4));
+  EXPECT_EQ(deque.size(), 4);
+
+  // Owner pops LIFO, thieves steal FIFO.
+  EXPECT_EQ(deque.pop(), jobs + 3);
+  EXPECT_EQ(deque.steal(), jobs + 0);
+  EXPECT_EQ(deque.size(), 2);
+
+  // Wraps around the circular buffer.
+  EXPECT_TRUE(deque.push(jobs + 4));
+  EXPECT_TRUE(deque.push(jobs + 0));
+  EXPECT_FALSE(deque.push(jobs + 3));
+  EXPECT_EQ(deque.steal(), jobs + 1);
+  EXPECT_EQ(deque.steal(), jobs + 2);
+  EXPECT_EQ(deque.pop(), jobs + 0);
+  EXPECT_EQ(deque.pop(), jobs + 4);
+  EXPECT_TRUE(deque.pop() == NULL);
+  EXPECT_TRUE(deque.steal() == NULL);
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDequeConcurrent, Containers) {
+  ozz::Vector<Job>::Std jobs(kNumJobs);
+  ozz::containers::WorkStealingDeque<Job> deque(kNumJobs);
+  for (int i = 0; i < kNumJobs; ++i) {
+    EXPECT_TRUE(deque.push(&jobs[i]));
+  }
+
+  // Every job is taken once, either popped by the owner or stolen.
+  ozz::tasks::ThreadPool pool(kNumThreads);
+  pool.Dispatch(StealTask(&deque), kNumThreads);
+  EXPECT_TRUE(deque.empty());
+  for (int i = 0; i < kNumJobs; ++i) {
+    EXPECT_EQ(jobs[i].count, 1);
+  }
+}
@@ -0,0 +1,227 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/containers/small_vector.h"
+#include "ozz/base/containers/flat_map.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/string.h"
+
+namespace {
+// Counts alive instances, to check construction/destruction balance.
+struct Counted {
+  Counted(int _value = 0) : value(_value) { ++alive; }
+  Counted(const Counted& _other) : value(_other.value) { ++alive; }
+  ~Counted() { --alive; }
+  int value;
+  static int alive;
+};
+int Counted::alive = 0;
+
+// Requires a 16 bytes alignment, as SIMD types.
+struct Aligned {
+  Aligned(float _x = 0.f) : x(_x) {}
+  OZZ_ALIGN(16) float x;
+};
+}  // namespace
+
+TEST(SmallVector, Containers) {
+  ozz::SmallVector<int, 4> vector;
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(vector.size(), 0u);
+  EXPECT_EQ(vector.capacity(), 4u);
+  EXPECT_TRUE(vector.is_local());
+  EXPECT_EQ(vector.begin(), vector.end());
+
+  // In place.
+  for (int i = 0; i < 4; ++i) {
+    vector.push_back(i);
+  }
+  EXPECT_EQ(vector.size(), 4u);
+  EXPECT_TRUE(vector.is_local());
+  EXPECT_EQ(vector.front(), 0);
+  EXPECT_EQ(vector.back(), 3);
+
+  // Grows to the heap.
+  vector.push_back(vector[0]);
+  EXPECT_FALSE(vector.is_local());
+  EXPECT_EQ(vector.size(), 5u);
+  EXPECT_GE(vector.capacity(), 5u);
+  EXPECT_EQ(vector[4], 0);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(vector[i], i);
+  }
+
+  // Insert and erase.
+  EXPECT_EQ(*vector.insert(vector.begin() + 1, 46), 46);
+  EXPECT_EQ(vector.size(), 6u);
+  EXPECT_EQ(vector[0], 0);
+  EXPECT_EQ(vector[1], 46);
+  EXPECT_EQ(vector[2], 1);
+  EXPECT_EQ(*vector.insert(vector.end(), 93), 93);
+  EXPECT_EQ(vector.back(), 93);
+  EXPECT_EQ(*vector.erase(vector.begin() + 1), 1);
+  const int* erased = vector.erase(vector.begin() + 4, vector.end());
+  EXPECT_EQ(erased, vector.end());
+  EXPECT_EQ(vector.size(), 4u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(vector[i], i);
+  }
+  vector.pop_back();
+  EXPECT_EQ(vector.size(), 3u);
+
+  // Copy.
+  const ozz::SmallVector<int, 4> copy(vector);
+  EXPECT_TRUE(copy.is_local());
+  EXPECT_EQ(copy.size(), 3u);
+  EXPECT_EQ(copy[2], 2);
+  ozz::SmallVector<int, 4> assigned;
+  assigned.resize(6, 7);
+  EXPECT_FALSE(assigned.is_local());
+  assigned = copy;
+  EXPECT_EQ(assigned.size(), 3u);
+  EXPECT_EQ(assigned[0], 0);
+
+  // Resize and clear.
+  vector.resize(8, 9);
+  EXPECT_EQ(vector.size(), 8u);
+  EXPECT_EQ(vector[7], 9);
+  vector.resize(2);
+  EXPECT_EQ(vector.size(), 2u);
+  const size_t capacity = vector.capacity();
+  vector.clear();
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(vector.capacity(), capacity);
+}
+
+TEST(SmallVectorLifetime, Containers) {
+  {
+    ozz::SmallVector<Counted, 2> vector;
+    vector.push_back(Counted(1));
+    EXPECT_EQ(Counted::alive, 1);
+    vector.resize(5, Counted(2));
+    EXPECT_EQ(Counted::alive, 5);
+    vector.erase(vector.begin(), vector.begin() + 2);
+    EXPECT_EQ(Counted::alive, 3);
+    EXPECT_EQ(vector[0].value, 2);
+    vector.insert(vector.begin(), Counted(3));
+    EXPECT_EQ(Counted::alive, 4);
+    EXPECT_EQ(vector[0].value, 3);
+    ozz::SmallVector<Counted, 2> copy(vector);
+    EXPECT_EQ(Counted::alive, 8);
+  }
+  EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(SmallVectorAlignment, Containers) {
+  ozz::SmallVector<Aligned, 3> vector;
+  vector.push_back(Aligned(46.f));
+  EXPECT_TRUE(vector.is_local());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(vector.data()) & 15, 0u);
+  vector.resize(4, Aligned(93.f));
+  EXPECT_FALSE(vector.is_local());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(vector.data()) & 15, 0u);
+  EXPECT_FLOAT_EQ(vector[0].x, 46.f);
+  EXPECT_FLOAT_EQ(vector[3].x, 93.f);
+}
+
+TEST(FlatMap, Containers) {
+  typedef ozz::FlatMap<int, int> Map;
+  Map map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.find(46) == map.end());
+  EXPECT_EQ(map.count(46), 0u);
+
+  EXPECT_TRUE(map.insert(std::make_pair(93, 0)).second);
+  EXPECT_TRUE(map.insert(std::make_pair(46, 1)).second);
+  EXPECT_TRUE(map.insert(std::make_pair(69, 2)).second);
+  std::pair<Map::iterator, bool> failed = map.insert(std::make_pair(46, 3));
+  EXPECT_FALSE(failed.second);
+  EXPECT_EQ(failed.first->second, 1);
+  EXPECT_EQ(map.size(), 3u);
+
+  // Elements are sorted.
+  Map::const_iterator it = map.begin();
+  EXPECT_EQ((it++)->first, 46);
+  EXPECT_EQ((it++)->first, 69);
+  EXPECT_EQ((it++)->first, 93);
+  EXPECT_TRUE(it == map.end());
+
+  EXPECT_EQ(map.find(69)->second, 2);
+  EXPECT_EQ(map.count(93), 1u);
+  EXPECT_TRUE(map.find(70) == map.end());
+  EXPECT_EQ(map.lower_bound(70)->first, 93);
+
+  map[70] = 4;
+  EXPECT_EQ(map.size(), 4u);
+  EXPECT_EQ(map[70], 4);
+  EXPECT_EQ(map[0], 0);
+  EXPECT_EQ(map.begin()->first, 0);
+
+  EXPECT_EQ(map.erase(70), 1u);
+  EXPECT_EQ(map.erase(70), 0u);
+  map.erase(map.begin());
+  EXPECT_EQ(map.size(), 3u);
+  EXPECT_EQ(map.begin()->first, 46);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(FlatMapAssign, Containers) {
+  const std::pair<int, int> elements[] = {
+    std::make_pair(3, 0), std::make_pair(1, 1), std::make_pair(3, 2),
+    std::make_pair(2, 3), std::make_pair(1, 4)};
+  ozz::FlatMap<int, int> map;
+  map[46] = 46;
+  map.assign(elements, elements + OZZ_ARRAY_SIZE(elements));
+  EXPECT_EQ(map.size(), 3u);
+  EXPECT_EQ(map.count(46), 0u);
+
+  // First of duplicated keys is kept.
+  EXPECT_EQ(map.find(1)->second, 1);
+  EXPECT_EQ(map.find(2)->second, 3);
+  EXPECT_EQ(map.find(3)->second, 0);
+}
+
+TEST(CStringFlatMap, Containers) {
+  typedef ozz::CStringFlatMap<int>::Type Map;
+  Map map;
+  EXPECT_TRUE(map.insert(std::make_pair("joint1", 1)).second);
+  EXPECT_TRUE(map.insert(std::make_pair("joint0", 0)).second);
+
+  // Compares string content rather than pointers.
+  ozz::String::Std key("joint1");
+  EXPECT_FALSE(map.insert(std::make_pair(key.c_str(), 2)).second);
+  EXPECT_EQ(map.find(key.c_str())->second, 1);
+  EXPECT_EQ(map.begin()->second, 0);
+  EXPECT_TRUE(map.find("joint2") == map.end());
+}
@@ -30,6 +30,8 @@
 
 #include "ozz/base/endianness.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 TEST(NativeEndianness, Endianness) {
@@ -105,3 +107,41 @@ TEST(Swap, Endianness) {
     EXPECT_EQ(uo[1], 0x3507086946261458ull);
   }
 }
+
+namespace {
+// Swaps _count elements of an array at _offset bytes of an aligned buffer,
+// and compares with single element swapping.
+template <typename _Ty>
+void TestBulkSwap(size_t _count, size_t _offset) {
+  union {
+    uint64_t align;
+    unsigned char bytes[8 * 64 + 16];
+  } buffer;
+  for (size_t i = 0; i < sizeof(buffer.bytes); ++i) {
+    buffer.bytes[i] = static_cast<unsigned char>(i * 13 + 1);
+  }
+  _Ty expected[64];
+  std::memcpy(expected, buffer.bytes + _offset, _count * sizeof(_Ty));
+  for (size_t i = 0; i < _count; ++i) {
+    expected[i] = ozz::EndianSwap(expected[i]);
+  }
+  unsigned char guard = buffer.bytes[_offset + _count * sizeof(_Ty)];
+
+  _Ty* array = reinterpret_cast<_Ty*>(buffer.bytes + _offset);
+  ozz::EndianSwap(array, _count);
+  EXPECT_EQ(std::memcmp(array, expected, _count * sizeof(_Ty)), 0);
+  EXPECT_EQ(buffer.bytes[_offset + _count * sizeof(_Ty)], guard);
+}
+}  // namespace
+
+TEST(BulkSwap, Endianness) {
+  // Covers arrays smaller, equal and bigger than SIMD registers, aligned or
+  // not.
+  for (size_t count = 0; count <= 64; ++count) {
+    for (size_t offset = 0; offset < 8; offset += 3) {
+      TestBulkSwap<uint16_t>(count, offset);
+      TestBulkSwap<uint32_t>(count, offset);
+      TestBulkSwap<uint64_t>(count, offset);
+    }
+  }
+}
@@ -29,6 +29,7 @@
 //============================================================================//
 
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/archive_container.h"
 
 #include <cstring>
 #include <stdint.h>
@@ -36,6 +37,7 @@
 #include "gtest/gtest.h"
 
 #include "ozz/base/gtest_helper.h"
+#include "ozz/base/memory/allocator.h"
 
 #include "archive_tests_objects.h"
 
@@ -189,6 +191,46 @@ TEST(PrimitiveArrays, Archive) {
   }
 }
 
+TEST(LargePrimitiveArrays, Archive) {
+  // Arrays bigger than the internal swapping chunk size.
+  const size_t kCount = 2049;
+  static uint32_t ui32o[kCount];
+  static uint16_t ui16o[kCount];
+  for (size_t j = 0; j < kCount; ++j) {
+    ui32o[j] = static_cast<uint32_t>(j * 0x01020304);
+    ui16o[j] = static_cast<uint16_t>(j * 0x0102);
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+
+    ozz::io::MemoryStream stream;
+    ASSERT_TRUE(stream.opened());
+
+    ozz::io::OArchive o(&stream, endianess);
+    o << ozz::io::MakeArray(ui32o);
+    o << ozz::io::MakeArray(ui16o);
+
+    // Swapped values are written in archive endianness.
+    uint32_t first;
+    stream.Seek(1, ozz::io::Stream::kSet);
+    stream.Read(&first, sizeof(first));
+    if (o.endian_swap()) {
+      first = ozz::EndianSwapper<uint32_t>::Swap(first);
+    }
+    EXPECT_EQ(first, ui32o[0]);
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    static uint32_t ui32i[kCount];
+    i >> ozz::io::MakeArray(ui32i);
+    EXPECT_EQ(std::memcmp(ui32i, ui32o, sizeof(ui32o)), 0);
+    static uint16_t ui16i[kCount];
+    i >> ozz::io::MakeArray(ui16i);
+    EXPECT_EQ(std::memcmp(ui16i, ui16o, sizeof(ui16o)), 0);
+  }
+}
+
 TEST(Class, Archive) {
   for (int e = 0; e < 2; ++e) {
     ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
@@ -274,3 +316,301 @@ TEST(Tag, Archive) {
   EXPECT_TRUE(i.TestTag<Tagged1>());
   EXPECT_NO_FATAL_FAILURE(i >> it1);
 }
+
+TEST(Compressed, Archive) {
+  ozz::io::MemoryStream memory;
+  ASSERT_TRUE(memory.opened());
+
+  // Writes to an archive through a compressed stream.
+  {
+    ozz::io::CompressedStream stream(&memory,
+                                     ozz::io::CompressedStream::kWrite, 64);
+    ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+    Tagged1 ot;
+    o << ot;
+    for (int32_t i = 0; i < 1000; ++i) {
+      o << i;
+    }
+  }
+
+  // Reads from archive, which tests tag by seeking back in the stream.
+  memory.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::CompressedStream stream(&memory, ozz::io::CompressedStream::kRead);
+  ASSERT_TRUE(stream.opened());
+  ozz::io::IArchive i(&stream);
+  EXPECT_FALSE(i.TestTag<Tagged2>());
+  EXPECT_TRUE(i.TestTag<Tagged1>());
+  Tagged1 it1;
+  EXPECT_NO_FATAL_FAILURE(i >> it1);
+  for (int32_t n = 0; n < 1000; ++n) {
+    int32_t value = -1;
+    i >> value;
+    EXPECT_EQ(value, n);
+  }
+}
+
+TEST(ReadOnlyMemoryStream, Archive) {
+  // Serializes to a memory stream, then loads back from a copy of its buffer
+  // without copying it to another stream.
+  ozz::io::MemoryStream memory;
+  {
+    ozz::io::OArchive o(&memory);
+    const int32_t ints[] = {46, -27, 93};
+    o << ozz::io::MakeArray(ints);
+    o << 3.14f;
+  }
+  const size_t size = static_cast<size_t>(memory.Tell());
+  char* buffer = ozz::memory::default_allocator()->Allocate<char>(size);
+  memory.Seek(0, ozz::io::Stream::kSet);
+  ASSERT_EQ(memory.Read(buffer, size), size);
+
+  ozz::io::ReadOnlyMemoryStream stream(buffer, size);
+  {
+    ozz::io::IArchive i(&stream);
+    int32_t ints[3];
+    i >> ozz::io::MakeArray(ints);
+    EXPECT_EQ(ints[0], 46);
+    EXPECT_EQ(ints[1], -27);
+    EXPECT_EQ(ints[2], 93);
+    float f;
+    i >> f;
+    EXPECT_FLOAT_EQ(f, 3.14f);
+  }
+  EXPECT_EQ(stream.remaining(), 0u);
+  ozz::memory::default_allocator()->Deallocate(buffer);
+}
+
+TEST(Checksum, Archive) {
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream, endianess, true);
+    EXPECT_TRUE(o.checksum());
+    const Intrusive oi(46);
+    o << oi;
+    const Intrusive oa[3] = {Intrusive(1), Intrusive(2), Intrusive(3)};
+    o << ozz::io::MakeArray(oa);
+    const int64_t third = stream.Tell();
+    const Extrusive oe = {58};
+    o << oe;
+    o << int32_t(27);
+    const int64_t end = stream.Tell();
+
+    {  // Reads back with verification.
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      EXPECT_TRUE(i.checksum());
+      i.set_verify(true);
+      Intrusive ii;
+      i >> ii;
+      EXPECT_EQ(ii.i, 46);
+      Intrusive ia[3];
+      i >> ozz::io::MakeArray(ia);
+      EXPECT_EQ(ia[2].i, 3);
+      Extrusive ie;
+      i >> ie;
+      EXPECT_EQ(ie.i, 58u);
+      int32_t ip;
+      i >> ip;
+      EXPECT_EQ(ip, 27);
+      EXPECT_FALSE(i.corrupted());
+      EXPECT_EQ(stream.Tell(), end);
+    }
+
+    // Corrupts the last byte of the array.
+    const int64_t corrupted = third - 1;
+    stream.Seek(corrupted, ozz::io::Stream::kSet);
+    char byte;
+    ASSERT_EQ(stream.Read(&byte, 1), 1u);
+    byte = ~byte;
+    stream.Seek(corrupted, ozz::io::Stream::kSet);
+    ASSERT_EQ(stream.Write(&byte, 1), 1u);
+
+    {  // The corrupted object is skipped with verification.
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      i.set_verify(true);
+      Intrusive ii;
+      i >> ii;
+      EXPECT_EQ(ii.i, 46);
+      EXPECT_FALSE(i.corrupted());
+      Intrusive ia[3] = {Intrusive(0), Intrusive(0), Intrusive(0)};
+      i >> ozz::io::MakeArray(ia);
+      EXPECT_TRUE(i.corrupted());
+      EXPECT_EQ(ia[0].i, 0);
+      EXPECT_EQ(ia[2].i, 0);
+      Extrusive ie;
+      i >> ie;
+      EXPECT_EQ(ie.i, 58u);
+      EXPECT_EQ(stream.Tell(), end - static_cast<int64_t>(sizeof(int32_t)));
+    }
+
+    {  // The corrupted object is loaded without verification.
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      Intrusive ii;
+      i >> ii;
+      Intrusive ia[3];
+      i >> ozz::io::MakeArray(ia);
+      EXPECT_FALSE(i.corrupted());
+      EXPECT_NE(ia[2].i, 3);
+      Extrusive ie;
+      i >> ie;
+      EXPECT_EQ(ie.i, 58u);
+    }
+  }
+}
+
+TEST(ChecksumTruncated, Archive) {
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream, ozz::GetNativeEndianness(), true);
+    const Intrusive oa[64];
+    o << ozz::io::MakeArray(oa);
+  }
+
+  // Copies all but the last byte.
+  const size_t size = static_cast<size_t>(stream.Tell()) - 1;
+  char* buffer = ozz::memory::default_allocator()->Allocate<char>(size);
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ASSERT_EQ(stream.Read(buffer, size), size);
+
+  ozz::io::ReadOnlyMemoryStream truncated(buffer, size);
+  ozz::io::IArchive i(&truncated);
+  i.set_verify(true);
+  Intrusive ia[64];
+  i >> ozz::io::MakeArray(ia);
+  EXPECT_TRUE(i.corrupted());
+  ozz::memory::default_allocator()->Deallocate(buffer);
+}
+
+TEST(Container, Archive) {
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    for (int c = 0; c < 2; ++c) {
+      const bool checksum = c != 0;
+
+      ozz::io::MemoryStream stream;
+      ozz::io::OArchive o(&stream, endianess, checksum);
+      o << int32_t(46);
+      {  // Saves a container, followed by another object.
+        ozz::io::OContainer<Intrusive> container(&o, 5);
+        EXPECT_EQ(container.count(), 5);
+        for (int i = 0; i < 5; ++i) {
+          container << Intrusive(i * 10);
+        }
+      }
+      {  // Saves an empty container.
+        ozz::io::OContainer<Extrusive> container(&o, 0);
+      }
+      o << int32_t(58);
+      const int64_t end = stream.Tell();
+
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      i.set_verify(true);
+      int32_t i46;
+      i >> i46;
+      EXPECT_EQ(i46, 46);
+
+      ozz::io::IContainer<Intrusive> container(&i);
+      EXPECT_TRUE(container.valid());
+      EXPECT_EQ(container.count(), 5);
+      EXPECT_EQ(container.version(), 46u);
+
+      // Loads in random order.
+      Intrusive ii(0);
+      EXPECT_TRUE(container.Load(3, &ii));
+      EXPECT_EQ(ii.i, 30);
+      EXPECT_TRUE(container.Load(1, &ii));
+      EXPECT_EQ(ii.i, 10);
+      EXPECT_TRUE(container.Load(2, &ii));
+      EXPECT_EQ(ii.i, 20);
+      EXPECT_TRUE(container.Load(4, &ii));
+      EXPECT_EQ(ii.i, 40);
+      EXPECT_TRUE(container.Load(0, &ii));
+      EXPECT_EQ(ii.i, 0);
+
+      // Out of range.
+      EXPECT_FALSE(container.Load(-1, &ii));
+      EXPECT_FALSE(container.Load(5, &ii));
+      EXPECT_EQ(ii.i, 0);
+      EXPECT_FALSE(i.corrupted());
+
+      // Skips to the next container.
+      container.Skip();
+      ozz::io::IContainer<Extrusive> empty(&i);
+      EXPECT_TRUE(empty.valid());
+      EXPECT_EQ(empty.count(), 0);
+      empty.Skip();
+
+      int32_t i58;
+      i >> i58;
+      EXPECT_EQ(i58, 58);
+      EXPECT_EQ(stream.Tell(), end);
+    }
+  }
+}
+
+TEST(ContainerTag, Archive) {
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+  {
+    ozz::io::OContainer<Tagged1> container(&o, 2);
+    container << Tagged1();
+    container << Tagged1();
+  }
+
+  {  // Wrong type.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    ozz::io::IContainer<Tagged2> container(&i);
+    EXPECT_FALSE(container.valid());
+    EXPECT_EQ(container.count(), 0);
+    Tagged2 it2;
+    EXPECT_FALSE(container.Load(0, &it2));
+  }
+
+  {  // Right type.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    ozz::io::IContainer<Tagged1> container(&i);
+    EXPECT_TRUE(container.valid());
+    EXPECT_EQ(container.count(), 2);
+    Tagged1 it1;
+    EXPECT_TRUE(container.Load(1, &it1));
+  }
+}
+
+TEST(ContainerChecksum, Archive) {
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness(), true);
+  {
+    ozz::io::OContainer<Intrusive> container(&o, 3);
+    container << Intrusive(1);
+    container << Intrusive(2);
+    container << Intrusive(3);
+  }
+
+  // Corrupts the last byte, which belongs to the last object.
+  const int64_t corrupted = stream.Tell() - 1;
+  stream.Seek(corrupted, ozz::io::Stream::kSet);
+  char byte;
+  ASSERT_EQ(stream.Read(&byte, 1), 1u);
+  byte = ~byte;
+  stream.Seek(corrupted, ozz::io::Stream::kSet);
+  ASSERT_EQ(stream.Write(&byte, 1), 1u);
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  i.set_verify(true);
+  ozz::io::IContainer<Intrusive> container(&i);
+  ASSERT_EQ(container.count(), 3);
+  Intrusive ii(0);
+  EXPECT_FALSE(container.Load(2, &ii));
+  EXPECT_TRUE(i.corrupted());
+  EXPECT_EQ(ii.i, 0);
+  EXPECT_TRUE(container.Load(1, &ii));
+  EXPECT_EQ(ii.i, 2);
+}
@@ -0,0 +1,170 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/async_stream.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+
+namespace {
+// Fills _stream with _size bytes of known data.
+void FillStream(ozz::io::Stream* _stream, int _size) {
+  for (int i = 0; i < _size; ++i) {
+    const unsigned char byte = static_cast<unsigned char>(i * 7);
+    ASSERT_EQ(_stream->Write(&byte, 1), 1u);
+  }
+}
+}  // namespace
+
+TEST(Error, ThreadedAsyncStream) {
+  ozz::io::File file(NULL);
+  ozz::io::ThreadedAsyncStream stream(&file);
+  EXPECT_FALSE(stream.opened());
+
+  char buffer[4];
+  ozz::io::AsyncReadRequest request;
+  request.buffer = buffer;
+  request.size = sizeof(buffer);
+  EXPECT_FALSE(stream.Submit(&request));
+  EXPECT_FALSE(stream.Wait(request));
+  EXPECT_FALSE(request.succeeded());
+
+  ozz::io::AsyncLoad load;
+  EXPECT_FALSE(load.Begin(&stream));
+  EXPECT_TRUE(load.done());
+  EXPECT_TRUE(load.Finalize() == NULL);
+}
+
+TEST(Read, ThreadedAsyncStream) {
+  const int kSize = 100000;
+  ozz::io::MemoryStream memory;
+  FillStream(&memory, kSize);
+
+  ozz::io::ThreadedAsyncStream stream(&memory);
+  ASSERT_TRUE(stream.opened());
+  EXPECT_EQ(stream.size(), kSize);
+
+  // Submits many requests at once, including one that goes beyond the end of
+  // the stream.
+  const int kRequests = 16;
+  const int kRequestSize = 8000;
+  char buffers[kRequests][kRequestSize];
+  ozz::io::AsyncReadRequest requests[kRequests];
+  for (int i = 0; i < kRequests; ++i) {
+    requests[i].offset = i * (kSize / (kRequests - 1));
+    requests[i].buffer = buffers[i];
+    requests[i].size = kRequestSize;
+    EXPECT_TRUE(stream.Submit(requests + i));
+  }
+
+  for (int i = kRequests - 1; i >= 0; --i) {
+    const int64_t offset = requests[i].offset;
+    const bool complete = offset + kRequestSize <= kSize;
+    EXPECT_EQ(stream.Wait(requests[i]), complete);
+    EXPECT_TRUE(stream.Poll(requests[i]));
+    const size_t expected =
+      complete ? kRequestSize : static_cast<size_t>(kSize - offset);
+    ASSERT_EQ(requests[i].read, expected);
+    for (size_t j = 0; j < expected; ++j) {
+      ASSERT_EQ(static_cast<unsigned char>(buffers[i][j]),
+                static_cast<unsigned char>((offset + j) * 7));
+    }
+  }
+
+  // Requests can be submitted again once completed.
+  EXPECT_TRUE(stream.Submit(requests));
+  EXPECT_TRUE(stream.Wait(requests[0]));
+
+  // Waiting for a request that was never submitted returns immediately.
+  ozz::io::AsyncReadRequest idle;
+  EXPECT_TRUE(stream.Poll(idle));
+  EXPECT_FALSE(stream.Wait(idle));
+}
+
+TEST(Load, AsyncLoad) {
+  ozz::io::MemoryStream memory;
+  {
+    ozz::io::OArchive o(&memory);
+    const int32_t header = 46;
+    o << header;
+    const float body[] = {1.f, 2.f, 3.f, 4.f};
+    o << ozz::io::MakeArray(body);
+  }
+
+  ozz::io::ThreadedAsyncStream stream(&memory);
+  ASSERT_TRUE(stream.opened());
+
+  {  // Loads the whole stream.
+    ozz::io::AsyncLoad load;
+    ASSERT_TRUE(load.Begin(&stream));
+    ozz::io::Stream* loaded = load.Finalize();
+    ASSERT_TRUE(loaded != NULL);
+    EXPECT_TRUE(load.done());
+    EXPECT_EQ(load.Finalize(), loaded);
+
+    ozz::io::IArchive i(loaded);
+    int32_t header;
+    i >> header;
+    EXPECT_EQ(header, 46);
+    float body[4];
+    i >> ozz::io::MakeArray(body);
+    EXPECT_FLOAT_EQ(body[0], 1.f);
+    EXPECT_FLOAT_EQ(body[3], 4.f);
+  }
+
+  {  // Two-phase load: reads the header, then the body.
+    ozz::io::AsyncLoad load;
+    ASSERT_TRUE(load.Begin(&stream, 0, sizeof(int32_t)));
+    ozz::io::Stream* header_stream = load.Finalize();
+    ASSERT_TRUE(header_stream != NULL);
+    int32_t header = 0;
+    EXPECT_EQ(header_stream->Read(&header, sizeof(header)), sizeof(header));
+
+    // Begin ends the previous load.
+    const size_t body_size = 4 * sizeof(float);
+    ASSERT_TRUE(load.Begin(&stream, sizeof(int32_t), body_size));
+    ozz::io::Stream* body_stream = load.Finalize();
+    ASSERT_TRUE(body_stream != NULL);
+    float body[4];
+    EXPECT_EQ(body_stream->Read(body, body_size), body_size);
+    EXPECT_EQ(body_stream->Read(body, 1), 0u);
+  }
+
+  {  // Out of range load fails.
+    ozz::io::AsyncLoad load;
+    ASSERT_TRUE(load.Begin(&stream, stream.size(), 1));
+    EXPECT_TRUE(load.Finalize() == NULL);
+    EXPECT_FALSE(load.Begin(&stream, -1, 1));
+    EXPECT_FALSE(load.Begin(NULL));
+  }
+}
@@ -0,0 +1,68 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/checksum.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+TEST(Crc32c, Checksum) {
+  // Reference values.
+  EXPECT_EQ(ozz::io::Crc32c(NULL, 0), 0u);
+  const char* check = "123456789";
+  EXPECT_EQ(ozz::io::Crc32c(check, std::strlen(check)), 0xe3069283u);
+  const unsigned char zeros[32] = {0};
+  EXPECT_EQ(ozz::io::Crc32c(zeros, sizeof(zeros)), 0x8a9136aau);
+  unsigned char ones[32];
+  std::memset(ones, 0xff, sizeof(ones));
+  EXPECT_EQ(ozz::io::Crc32c(ones, sizeof(ones)), 0x62a8ab43u);
+
+  // Incremental computation matches single pass, for all split points and
+  // alignments.
+  unsigned char data[67];
+  for (size_t i = 0; i < sizeof(data); ++i) {
+    data[i] = static_cast<unsigned char>(i * 31 + 7);
+  }
+  for (size_t offset = 0; offset < 8; ++offset) {
+    const size_t size = sizeof(data) - offset;
+    const uint32_t crc = ozz::io::Crc32c(data + offset, size);
+    for (size_t split = 0; split <= size; ++split) {
+      const uint32_t first = ozz::io::Crc32c(data + offset, split);
+      EXPECT_EQ(ozz::io::Crc32c(data + offset + split, size - split, first),
+                crc);
+    }
+  }
+
+  // A single bit change is detected.
+  const uint32_t crc = ozz::io::Crc32c(data, sizeof(data));
+  data[33] ^= 4;
+  EXPECT_NE(ozz::io::Crc32c(data, sizeof(data)), crc);
+}
@@ -30,12 +30,14 @@
 
 #include "ozz/base/io/stream.h"
 
+#include <cstring>
 #include <limits>
 #include <stdint.h>
 
 #include "gtest/gtest.h"
 
 #include "ozz/base/platform.h"
+#include "ozz/base/maths/math_ex.h"
 
 void TestStream(ozz::io::Stream* _stream) {
   ASSERT_TRUE(_stream->opened());
@@ -169,3 +171,399 @@ TEST(File, Stream) {
     TestSeek(&file);
   }
 }
+
+TEST(LargeFile, Stream) {
+  ozz::io::File file("test.bin", "w+b");
+  ASSERT_TRUE(file.opened());
+
+  // Seeks beyond 4GB, without writing to the file.
+  const int64_t kOffset = (int64_t(1) << 32) + 46;
+  EXPECT_EQ(file.Seek(kOffset, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(file.Tell(), kOffset);
+  EXPECT_EQ(file.Seek(-kOffset, ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(file.Tell(), 0);
+}
+
+namespace {
+// Decorates a stream to count the number of calls.
+class CountingStream : public ozz::io::Stream {
+ public:
+  explicit CountingStream(ozz::io::Stream* _stream)
+      : stream_(_stream),
+        reads(0),
+        writes(0) {
+  }
+  virtual bool opened() const {
+    return stream_->opened();
+  }
+  virtual size_t Read(void* _buffer, size_t _size) {
+    ++reads;
+    return stream_->Read(_buffer, _size);
+  }
+  virtual size_t Write(const void* _buffer, size_t _size) {
+    ++writes;
+    return stream_->Write(_buffer, _size);
+  }
+  virtual int Seek(int64_t _offset, Origin _origin) {
+    return stream_->Seek(_offset, _origin);
+  }
+  virtual int64_t Tell() const {
+    return stream_->Tell();
+  }
+ private:
+  ozz::io::Stream* stream_;
+ public:
+  int reads;
+  int writes;
+};
+}  // namespace
+
+TEST(BufferedStream, Stream) {
+  for (size_t block_size = 1; block_size < 16; block_size += 3) {
+    {
+      ozz::io::MemoryStream memory;
+      ozz::io::BufferedStream stream(&memory, block_size);
+      EXPECT_EQ(stream.block_size(), block_size);
+      TestStream(&stream);
+    }
+    {
+      ozz::io::MemoryStream memory;
+      ozz::io::BufferedStream stream(&memory, block_size);
+      TestSeek(&stream);
+    }
+    {
+      ozz::io::File file("test.bin", "w+b");
+      ozz::io::BufferedStream stream(&file, block_size);
+      TestSeek(&stream);
+    }
+  }
+  {
+    ozz::io::MemoryStream memory;
+    ozz::io::BufferedStream stream(&memory);
+    EXPECT_EQ(stream.block_size(), ozz::io::BufferedStream::kDefaultBlockSize);
+    TestSeek(&stream);
+  }
+}
+
+TEST(BufferedStreamCalls, Stream) {
+  ozz::io::MemoryStream memory;
+  CountingStream counting(&memory);
+
+  const int kCount = 1000;
+  {
+    ozz::io::BufferedStream stream(&counting, 1024);
+    for (int i = 0; i < kCount; ++i) {
+      EXPECT_EQ(stream.Write(&i, sizeof(i)), sizeof(i));
+    }
+    EXPECT_EQ(stream.Tell(), static_cast<int64_t>(kCount * sizeof(int)));
+
+    // Everything is written once flushed.
+    EXPECT_TRUE(stream.Flush());
+    EXPECT_EQ(memory.Tell(), static_cast<int64_t>(kCount * sizeof(int)));
+  }
+  EXPECT_EQ(counting.writes, 4);
+
+  {
+    ozz::io::BufferedStream stream(&counting, 1024);
+    EXPECT_EQ(stream.Seek(0, ozz::io::Stream::kSet), 0);
+    for (int i = 0; i < kCount; ++i) {
+      int value = -1;
+      EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+      EXPECT_EQ(value, i);
+    }
+    int value;
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), 0u);
+
+    // Seeking back within read-ahead data.
+    const int reads = counting.reads;
+    EXPECT_EQ(stream.Seek(-static_cast<int>(sizeof(int)) * 2,
+                          ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, kCount - 2);
+    EXPECT_EQ(stream.Seek(0, ozz::io::Stream::kCurrent), 0);
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, kCount - 1);
+    EXPECT_EQ(stream.Seek(-static_cast<int>(sizeof(int)),
+                          ozz::io::Stream::kCurrent), 0);
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, kCount - 1);
+    EXPECT_LE(counting.reads - reads, 2);
+  }
+  EXPECT_LE(counting.reads, 6 + 2);
+}
+
+TEST(BufferedStreamMixed, Stream) {
+  ozz::io::MemoryStream memory;
+  const char kData[] = "0123456789abcdef";
+  EXPECT_EQ(memory.Write(kData, sizeof(kData)), sizeof(kData));
+  EXPECT_EQ(memory.Seek(0, ozz::io::Stream::kSet), 0);
+
+  {
+    ozz::io::BufferedStream stream(&memory, 8);
+    char c;
+    EXPECT_EQ(stream.Read(&c, 1), 1u);
+    EXPECT_EQ(c, '0');
+
+    // Writes after a read overwrite data at the logical position.
+    EXPECT_EQ(stream.Write("xy", 2), 2u);
+    EXPECT_EQ(stream.Tell(), 3);
+
+    // Reads after a write see written data.
+    EXPECT_EQ(stream.Read(&c, 1), 1u);
+    EXPECT_EQ(c, '3');
+    EXPECT_EQ(stream.Seek(1, ozz::io::Stream::kSet), 0);
+    char buffer[3];
+    EXPECT_EQ(stream.Read(buffer, 3), 3u);
+    EXPECT_EQ(std::memcmp(buffer, "xy3", 3), 0);
+
+    // Big reads bypass the buffer.
+    char big[10];
+    EXPECT_EQ(stream.Read(big, 10), 10u);
+    EXPECT_EQ(std::memcmp(big, "456789abcd", 10), 0);
+
+    // Destruction restores decorated stream position.
+  }
+  EXPECT_EQ(memory.Tell(), 14);
+
+  {
+    ozz::io::BufferedStream stream(&memory, 8);
+    EXPECT_EQ(stream.Seek(0, ozz::io::Stream::kSet), 0);
+
+    // Big writes bypass the buffer.
+    EXPECT_EQ(stream.Write("ABCDEFGHIJ", 10), 10u);
+    EXPECT_EQ(stream.Write("K", 1), 1u);
+    EXPECT_EQ(stream.Tell(), 11);
+  }
+  char buffer[sizeof(kData)];
+  EXPECT_EQ(memory.Seek(0, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(memory.Read(buffer, sizeof(buffer)), sizeof(buffer));
+  EXPECT_EQ(std::memcmp(buffer, "ABCDEFGHIJKbcdef", sizeof(kData)), 0);
+}
+
+namespace {
+// Fills _buffer with _size bytes of data, compressible or not.
+void FillData(char* _buffer, size_t _size, bool _compressible) {
+  uint32_t seed = 46;
+  for (size_t i = 0; i < _size; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    _buffer[i] = _compressible ? static_cast<char>("ozz-animation"[i % 13] +
+                                                   (i / 1000) % 3) :
+                                 static_cast<char>(seed >> 24);
+  }
+}
+}  // namespace
+
+TEST(CompressedStream, Stream) {
+  const size_t kSizes[] = {0, 1, 12, 13, 100, 4096, 100000};
+  const size_t kBlockSizes[] = {1, 16, 1000, 65536};
+  for (int c = 0; c < 2; ++c) {
+    for (size_t s = 0; s < OZZ_ARRAY_SIZE(kSizes); ++s) {
+      for (size_t b = 0; b < OZZ_ARRAY_SIZE(kBlockSizes); ++b) {
+        const size_t size = kSizes[s];
+        char* data = new char[size + 1];
+        FillData(data, size, c == 0);
+
+        ozz::io::MemoryStream memory;
+        EXPECT_EQ(memory.Write("prefix", 6), 6u);
+        {
+          ozz::io::CompressedStream stream(
+            &memory, ozz::io::CompressedStream::kWrite, kBlockSizes[b]);
+          ASSERT_TRUE(stream.opened());
+          EXPECT_EQ(stream.block_size(), kBlockSizes[b]);
+          EXPECT_EQ(stream.Tell(), 0);
+
+          // Writes in chunks of different sizes.
+          for (size_t written = 0, chunk = 1; written < size;
+               written += chunk, chunk = chunk * 3 + 1) {
+            chunk = ozz::math::Min(chunk, size - written);
+            EXPECT_EQ(stream.Write(data + written, chunk), chunk);
+          }
+          EXPECT_EQ(stream.Tell(), static_cast<int64_t>(size));
+
+          // Seeking isn't supported while writing.
+          EXPECT_EQ(stream.Seek(0, ozz::io::Stream::kCurrent), 0);
+          EXPECT_EQ(stream.Seek(0, ozz::io::Stream::kSet) == 0, size == 0);
+          char byte;
+          EXPECT_EQ(stream.Read(&byte, 1), 0u);
+
+          EXPECT_TRUE(stream.Close());
+          EXPECT_FALSE(stream.opened());
+        }
+        const int64_t end = memory.Tell();
+        if (c == 0 && size >= 4096 && kBlockSizes[b] >= 1000) {
+          EXPECT_LT(end, static_cast<int64_t>(size / 4));
+        }
+
+        // Reads back.
+        EXPECT_EQ(memory.Seek(6, ozz::io::Stream::kSet), 0);
+        EXPECT_TRUE(ozz::io::CompressedStream::IsCompressed(&memory));
+        EXPECT_EQ(memory.Tell(), 6);
+        {
+          ozz::io::CompressedStream stream(&memory,
+                                           ozz::io::CompressedStream::kRead);
+          ASSERT_TRUE(stream.opened());
+          EXPECT_EQ(stream.block_size(), kBlockSizes[b]);
+          char* read = new char[size + 1];
+          EXPECT_EQ(stream.Read(read, size + 1), size);
+          EXPECT_EQ(std::memcmp(read, data, size), 0);
+          EXPECT_EQ(stream.Tell(), static_cast<int64_t>(size));
+
+          // Seeks and reads at random positions.
+          for (size_t i = 0; size && i < 20; ++i) {
+            const size_t position = (i * 7919) % size;
+            EXPECT_EQ(stream.Seek(static_cast<int64_t>(position),
+                                  ozz::io::Stream::kSet), 0);
+            EXPECT_EQ(stream.Tell(), static_cast<int64_t>(position));
+            const size_t count = ozz::math::Min<size_t>(size - position, 77);
+            EXPECT_EQ(stream.Read(read, count), count);
+            EXPECT_EQ(std::memcmp(read, data + position, count), 0);
+          }
+          EXPECT_EQ(stream.Seek(0, ozz::io::Stream::kEnd), 0);
+          EXPECT_EQ(stream.Tell(), static_cast<int64_t>(size));
+          EXPECT_NE(stream.Seek(1, ozz::io::Stream::kEnd), 0);
+          EXPECT_NE(stream.Seek(-1, ozz::io::Stream::kSet), 0);
+          EXPECT_EQ(stream.Write(data, 1), 0u);
+          delete [] read;
+        }
+        // Closing leaves decorated stream at the end of compressed data.
+        EXPECT_EQ(memory.Tell(), end);
+        delete [] data;
+      }
+    }
+  }
+}
+
+TEST(CompressedStreamError, Stream) {
+  {  // Not a compressed stream.
+    ozz::io::MemoryStream memory;
+    EXPECT_FALSE(ozz::io::CompressedStream::IsCompressed(&memory));
+    const char kData[] = "not a compressed stream, not a compressed stream";
+    EXPECT_EQ(memory.Write(kData, sizeof(kData)), sizeof(kData));
+    EXPECT_EQ(memory.Seek(2, ozz::io::Stream::kSet), 0);
+    EXPECT_FALSE(ozz::io::CompressedStream::IsCompressed(&memory));
+    ozz::io::CompressedStream stream(&memory,
+                                     ozz::io::CompressedStream::kRead);
+    EXPECT_FALSE(stream.opened());
+    EXPECT_EQ(stream.Tell(), -1);
+    EXPECT_EQ(memory.Tell(), 2);
+  }
+
+  {  // Invalid block size.
+    ozz::io::MemoryStream memory;
+    ozz::io::CompressedStream stream(&memory,
+                                     ozz::io::CompressedStream::kWrite, 0);
+    EXPECT_FALSE(stream.opened());
+    EXPECT_FALSE(stream.Close());
+  }
+
+  {  // Corrupted data.
+    ozz::io::MemoryStream memory;
+    char data[2000];
+    FillData(data, sizeof(data), true);
+    {
+      ozz::io::CompressedStream stream(
+        &memory, ozz::io::CompressedStream::kWrite, 1000);
+      EXPECT_EQ(stream.Write(data, sizeof(data)), sizeof(data));
+    }
+    // Corrupts the seek table.
+    EXPECT_EQ(memory.Seek(-4, ozz::io::Stream::kEnd), 0);
+    uint32_t size = 0;
+    EXPECT_EQ(memory.Read(&size, 4), 4u);
+    EXPECT_EQ(memory.Seek(-4, ozz::io::Stream::kEnd), 0);
+    ++size;
+    EXPECT_EQ(memory.Write(&size, 4), 4u);
+
+    EXPECT_EQ(memory.Seek(0, ozz::io::Stream::kSet), 0);
+    EXPECT_TRUE(ozz::io::CompressedStream::IsCompressed(&memory));
+    ozz::io::CompressedStream stream(&memory,
+                                     ozz::io::CompressedStream::kRead);
+    EXPECT_FALSE(stream.opened());
+    EXPECT_EQ(memory.Tell(), 0);
+  }
+
+  {  // Corrupted header, whose seek table doesn't fit in the stream.
+    ozz::io::MemoryStream memory;
+    char data[2000];
+    FillData(data, sizeof(data), true);
+    {
+      ozz::io::CompressedStream stream(
+        &memory, ozz::io::CompressedStream::kWrite, 1000);
+      EXPECT_EQ(stream.Write(data, sizeof(data)), sizeof(data));
+    }
+    // Sets block size to 1, and number of blocks and size to 2^32-1, as
+    // little endian values. The header remains consistent, but the seek
+    // table would be 16GB.
+    const char kCorrupted[] = {1, 0, 0, 0,
+                               '\xff', '\xff', '\xff', '\xff',
+                               '\xff', '\xff', '\xff', '\xff', 0, 0, 0, 0};
+    EXPECT_EQ(memory.Seek(8, ozz::io::Stream::kSet), 0);
+    EXPECT_EQ(memory.Write(kCorrupted, sizeof(kCorrupted)),
+              sizeof(kCorrupted));
+
+    EXPECT_EQ(memory.Seek(0, ozz::io::Stream::kSet), 0);
+    EXPECT_TRUE(ozz::io::CompressedStream::IsCompressed(&memory));
+    ozz::io::CompressedStream stream(&memory,
+                                     ozz::io::CompressedStream::kRead);
+    EXPECT_FALSE(stream.opened());
+    EXPECT_EQ(memory.Tell(), 0);
+  }
+}
+
+TEST(ReadOnlyMemoryStream, Stream) {
+  char data[64];
+  FillData(data, sizeof(data), false);
+
+  {  // Empty stream.
+    ozz::io::ReadOnlyMemoryStream stream(NULL, 0);
+    EXPECT_TRUE(stream.opened());
+    EXPECT_EQ(stream.remaining(), 0u);
+    char byte;
+    EXPECT_EQ(stream.Read(&byte, 1), 0u);
+    EXPECT_EQ(stream.Tell(), 0);
+  }
+
+  ozz::io::ReadOnlyMemoryStream stream(data, sizeof(data));
+  ASSERT_TRUE(stream.opened());
+  EXPECT_EQ(stream.Tell(), 0);
+  EXPECT_EQ(stream.remaining(), sizeof(data));
+  EXPECT_EQ(stream.current(), data);
+
+  // Writes always fail.
+  EXPECT_EQ(stream.Write(data, 1), 0u);
+  EXPECT_EQ(stream.Tell(), 0);
+
+  // Reads.
+  char read[sizeof(data)];
+  EXPECT_EQ(stream.Read(read, 16), 16u);
+  EXPECT_EQ(std::memcmp(read, data, 16), 0);
+  EXPECT_EQ(stream.Tell(), 16);
+  EXPECT_EQ(stream.current(), data + 16);
+  EXPECT_EQ(stream.remaining(), sizeof(data) - 16);
+
+  // Reads are clamped to the end of the buffer.
+  EXPECT_EQ(stream.Read(read, sizeof(read)), sizeof(data) - 16);
+  EXPECT_EQ(std::memcmp(read, data + 16, sizeof(data) - 16), 0);
+  EXPECT_EQ(stream.Tell(), static_cast<int64_t>(sizeof(data)));
+  EXPECT_EQ(stream.Read(read, 1), 0u);
+
+  // Seeks.
+  EXPECT_NE(stream.Seek(-1, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(stream.Seek(-4, ozz::io::Stream::kEnd), 0);
+  EXPECT_EQ(stream.Tell(), static_cast<int64_t>(sizeof(data) - 4));
+  EXPECT_EQ(stream.Seek(-8, ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(stream.Tell(), static_cast<int64_t>(sizeof(data) - 12));
+  EXPECT_EQ(stream.Read(read, 4), 4u);
+  EXPECT_EQ(std::memcmp(read, data + sizeof(data) - 12, 4), 0);
+  EXPECT_EQ(stream.Seek(46, ozz::io::Stream::Origin(27)), -1);
+
+  // Seeking beyond the end is allowed, but reads fail.
+  const int64_t kBeyond = static_cast<int64_t>(1) << 40;
+  EXPECT_EQ(stream.Seek(kBeyond, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(stream.Tell(), kBeyond);
+  EXPECT_TRUE(stream.current() == NULL);
+  EXPECT_EQ(stream.remaining(), 0u);
+  EXPECT_EQ(stream.Read(read, 1), 0u);
+  EXPECT_NE(stream.Seek(std::numeric_limits<int64_t>::max(),
+                        ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(stream.Tell(), kBeyond);
+}
@@ -0,0 +1,116 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/compact_soa_transform.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::math::CompactSoaTransform;
+using ozz::math::SoaTransform;
+
+TEST(Size, CompactSoaTransform) {
+  EXPECT_EQ(sizeof(CompactSoaTransform), 76u);
+}
+
+TEST(PackUnpack, CompactSoaTransform) {
+  // Rotations whose largest component is each of x, y, z and w, with both
+  // signs.
+  const ozz::math::Quaternion quats[8] = {
+    ozz::math::Quaternion::FromAxisAngle(ozz::math::Float4(1.f, 0.f, 0.f, 3.f)),
+    ozz::math::Quaternion::FromAxisAngle(ozz::math::Float4(0.f, 1.f, 0.f, 2.5f)),
+    ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(0.f, .6f, -.8f, 2.f)),
+    ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(0.f, .8f, .6f, .3f)),
+    -ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(1.f, 0.f, 0.f, 3.f)),
+    -ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(0.f, 0.f, 1.f, 2.5f)),
+    ozz::math::Quaternion::identity(),
+    -ozz::math::Quaternion::identity()};
+
+  SoaTransform input[2];
+  for (int i = 0; i < 2; ++i) {
+    const ozz::math::Quaternion* q = quats + i * 4;
+    input[i].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(0.f, 1.f, -2.5f, 100.f),
+      ozz::math::simd_float4::Load(.001f, -46.f, 12.f, 7.f),
+      ozz::math::simd_float4::Load(3.f, 0.f, -1.f, .5f));
+    input[i].rotation = ozz::math::SoaQuaternion::Load(
+      ozz::math::simd_float4::Load(q[0].x, q[1].x, q[2].x, q[3].x),
+      ozz::math::simd_float4::Load(q[0].y, q[1].y, q[2].y, q[3].y),
+      ozz::math::simd_float4::Load(q[0].z, q[1].z, q[2].z, q[3].z),
+      ozz::math::simd_float4::Load(q[0].w, q[1].w, q[2].w, q[3].w));
+    input[i].scale = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(1.f, 2.f, .5f, -1.f),
+      ozz::math::simd_float4::Load(1.f, 2.f, .5f, -1.f),
+      ozz::math::simd_float4::Load(1.f, 2.f, .5f, -1.f));
+  }
+
+  CompactSoaTransform compact[2];
+  SoaTransform output[2];
+
+  // Output too small.
+  EXPECT_FALSE(ozz::math::Pack(ozz::Range<const SoaTransform>(input, 2),
+                               ozz::Range<CompactSoaTransform>(compact, 1)));
+  EXPECT_FALSE(ozz::math::Unpack(
+    ozz::Range<const CompactSoaTransform>(compact, 2),
+    ozz::Range<SoaTransform>(output, 1)));
+
+  EXPECT_TRUE(ozz::math::Pack(ozz::Range<const SoaTransform>(input),
+                              ozz::Range<CompactSoaTransform>(compact)));
+  EXPECT_TRUE(ozz::math::Unpack(
+    ozz::Range<const CompactSoaTransform>(compact),
+    ozz::Range<SoaTransform>(output)));
+
+  // Compares lane by lane, within half and 16 bits quantization precision.
+  for (int i = 0; i < 2; ++i) {
+    const float* in_t = reinterpret_cast<const float*>(&input[i].translation);
+    const float* out_t = reinterpret_cast<const float*>(&output[i].translation);
+    const float* in_s = reinterpret_cast<const float*>(&input[i].scale);
+    const float* out_s = reinterpret_cast<const float*>(&output[i].scale);
+    for (int j = 0; j < 12; ++j) {
+      EXPECT_NEAR(in_t[j], out_t[j], std::abs(in_t[j]) * 1e-3f);
+      EXPECT_NEAR(in_s[j], out_s[j], std::abs(in_s[j]) * 1e-3f);
+    }
+    // Rotation hemisphere is preserved.
+    const float* in_r = reinterpret_cast<const float*>(&input[i].rotation);
+    const float* out_r = reinterpret_cast<const float*>(&output[i].rotation);
+    for (int j = 0; j < 16; ++j) {
+      EXPECT_NEAR(in_r[j], out_r[j], 5e-5f);
+    }
+  }
+}
@@ -0,0 +1,125 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/dual_quaternion.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include <cmath>
+
+using ozz::math::DualQuaternion;
+using ozz::math::Float4x4;
+using ozz::math::SimdFloat4;
+
+namespace {
+// Builds a rotation quaternion from axis _x, _y, _z and _angle.
+SimdFloat4 AxisAngle(float _x, float _y, float _z, float _angle) {
+  const float s = std::sin(_angle * .5f);
+  return ozz::math::simd_float4::Load(_x * s, _y * s, _z * s,
+                                      std::cos(_angle * .5f));
+}
+
+// Expects x, y and z components of _a and _b to be equal.
+void ExpectFloat3Near(SimdFloat4 _a, SimdFloat4 _b) {
+  EXPECT_NEAR(ozz::math::GetX(_a), ozz::math::GetX(_b), 1e-5f);
+  EXPECT_NEAR(ozz::math::GetY(_a), ozz::math::GetY(_b), 1e-5f);
+  EXPECT_NEAR(ozz::math::GetZ(_a), ozz::math::GetZ(_b), 1e-5f);
+}
+}  // namespace
+
+TEST(Constant, DualQuaternion) {
+  const DualQuaternion identity = DualQuaternion::identity();
+  EXPECT_SIMDFLOAT_EQ(identity.real, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(identity.dual, 0.f, 0.f, 0.f, 0.f);
+
+  const SimdFloat4 p = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f);
+  ExpectFloat3Near(TransformPoint(identity, p), p);
+  ExpectFloat3Near(TransformVector(identity, p), p);
+}
+
+TEST(Transform, DualQuaternion) {
+  const SimdFloat4 t = ozz::math::simd_float4::Load(4.f, -5.f, 6.f, 99.f);
+  const SimdFloat4 q = AxisAngle(0.f, .6f, .8f, 1.2f);
+  const DualQuaternion dq = DualQuaternion::FromAffine(t, q);
+  EXPECT_SIMDFLOAT_EQ(GetTranslation(dq), 4.f, -5.f, 6.f, 0.f);
+
+  const Float4x4 m =
+    Float4x4::Translation(t) * Float4x4::FromQuaternion(q);
+  const SimdFloat4 p = ozz::math::simd_float4::Load(1.f, -2.f, 3.f, 1.f);
+  ExpectFloat3Near(TransformPoint(dq, p), TransformPoint(m, p));
+  ExpectFloat3Near(TransformVector(dq, p), TransformVector(m, p));
+}
+
+TEST(Compose, DualQuaternion) {
+  const SimdFloat4 ta = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f);
+  const SimdFloat4 qa = AxisAngle(1.f, 0.f, 0.f, .7f);
+  const SimdFloat4 tb = ozz::math::simd_float4::Load(-3.f, 0.f, 5.f, 0.f);
+  const SimdFloat4 qb = AxisAngle(0.f, 0.f, 1.f, -1.9f);
+  const DualQuaternion a = DualQuaternion::FromAffine(ta, qa);
+  const DualQuaternion b = DualQuaternion::FromAffine(tb, qb);
+  const Float4x4 ma = Float4x4::Translation(ta) * Float4x4::FromQuaternion(qa);
+  const Float4x4 mb = Float4x4::Translation(tb) * Float4x4::FromQuaternion(qb);
+
+  const SimdFloat4 p = ozz::math::simd_float4::Load(.5f, -1.5f, 2.f, 1.f);
+  ExpectFloat3Near(TransformPoint(a * b, p), TransformPoint(ma * mb, p));
+
+  // Conjugate is the inverse of a unit dual quaternion.
+  ExpectFloat3Near(TransformPoint(Conjugate(a) * a, p), p);
+  ExpectFloat3Near(TransformPoint(Conjugate(a), TransformPoint(a, p)), p);
+}
+
+TEST(FromSoaTransform, DualQuaternion) {
+  const SimdFloat4 q[4] = {
+    AxisAngle(1.f, 0.f, 0.f, .1f), AxisAngle(0.f, 1.f, 0.f, .2f),
+    AxisAngle(0.f, 0.f, 1.f, .3f), AxisAngle(0.f, .6f, .8f, .4f)};
+  SimdFloat4 soa_q[4];
+  ozz::math::Transpose4x4(q, soa_q);
+  const ozz::math::SoaTransform transform = {
+    {ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+     ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+     ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f)},
+    {soa_q[0], soa_q[1], soa_q[2], soa_q[3]},
+    {ozz::math::simd_float4::one(),
+     ozz::math::simd_float4::one(),
+     ozz::math::simd_float4::one()}};
+
+  DualQuaternion dqs[4];
+  ozz::math::FromSoaTransform(transform, dqs);
+  for (int i = 0; i < 4; ++i) {
+    const float f = static_cast<float>(i);
+    const SimdFloat4 t = ozz::math::simd_float4::Load(f, f + 4.f, f + 8.f, 0.f);
+    const DualQuaternion expected = DualQuaternion::FromAffine(t, q[i]);
+    EXPECT_SIMDFLOAT_EQ(GetTranslation(dqs[i]), f, f + 4.f, f + 8.f, 0.f);
+    ExpectFloat3Near(dqs[i].real, expected.real);
+    EXPECT_NEAR(ozz::math::GetW(dqs[i].real),
+                ozz::math::GetW(expected.real), 1e-5f);
+  }
+}
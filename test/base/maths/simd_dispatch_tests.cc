@@ -0,0 +1,76 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/simd_dispatch.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::math::SimdFloat4;
+
+namespace {
+// A dispatched kernel, whose results must not depend on the selected variant.
+OZZ_SIMD_DISPATCH void MulAdd(const SimdFloat4* _a, const SimdFloat4* _b,
+                              SimdFloat4* _out, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    _out[i] = ozz::math::MAdd(_a[i], _b[i], ozz::math::Sqrt(_a[i]));
+  }
+}
+}  // namespace
+
+TEST(DispatchLevel, ozz_simd_math) {
+  const ozz::math::SimdLevel level = ozz::math::GetDispatchedSimdLevel();
+  if (!ozz::math::IsSimdDispatchEnabled()) {
+    EXPECT_EQ(level, ozz::math::kSimdLevelDefault);
+  }
+  EXPECT_TRUE(std::strlen(ozz::math::GetSimdLevelName(level)) > 0);
+  EXPECT_STREQ(ozz::math::GetSimdLevelName(ozz::math::kSimdLevelAvx2),
+               "AVX2");
+}
+
+TEST(DispatchKernel, ozz_simd_math) {
+  const SimdFloat4 a[2] = {ozz::math::simd_float4::Load(1.f, 4.f, 9.f, 16.f),
+                           ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f)};
+  const SimdFloat4 b[2] = {ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 2.f),
+                           ozz::math::simd_float4::Load(-1.f, 0.f, 1.f, 2.f)};
+  SimdFloat4 out[2];
+  MulAdd(a, b, out, 2);
+  EXPECT_SIMDFLOAT_EQ(out[0], 3.f, 10.f, 21.f, 36.f);
+  EXPECT_SIMDFLOAT_EQ(out[1], 0.f, 1.f, 3.41421356f, 7.7320508f);
+
+  // Also works through a function pointer.
+  void (*fn)(const SimdFloat4*, const SimdFloat4*, SimdFloat4*, int) = &MulAdd;
+  fn(a + 1, b + 1, out, 1);
+  EXPECT_SIMDFLOAT_EQ(out[0], 0.f, 1.f, 3.41421356f, 7.7320508f);
+}
@@ -0,0 +1,121 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/simd_float4x3.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::math::SimdFloat4;
+using ozz::math::Float4x4;
+using ozz::math::Float4x3;
+
+TEST(Constant, Float4x3) {
+  const Float4x3 identity = Float4x3::identity();
+  EXPECT_FLOAT4x3_EQ(identity, 1.f, 0.f, 0.f, 0.f,
+                               0.f, 1.f, 0.f, 0.f,
+                               0.f, 0.f, 1.f, 0.f);
+}
+
+TEST(Conversion, Float4x3) {
+  const Float4x4 m = {{ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 0.f),
+                       ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 0.f),
+                       ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 0.f),
+                       ozz::math::simd_float4::Load(12.f, 13.f, 14.f, 1.f)}};
+
+  const Float4x3 m43 = Float4x3::FromFloat4x4(m);
+  EXPECT_FLOAT4x3_EQ(m43, 0.f, 4.f, 8.f, 12.f,
+                          1.f, 5.f, 9.f, 13.f,
+                          2.f, 6.f, 10.f, 14.f);
+
+  const Float4x4 m44 = ToFloat4x4(m43);
+  EXPECT_FLOAT4x4_EQ(m44, 0.f, 1.f, 2.f, 0.f,
+                          4.f, 5.f, 6.f, 0.f,
+                          8.f, 9.f, 10.f, 0.f,
+                          12.f, 13.f, 14.f, 1.f);
+
+  const Float4x4 identity = ToFloat4x4(Float4x3::identity());
+  EXPECT_FLOAT4x4_EQ(identity, 1.f, 0.f, 0.f, 0.f,
+                               0.f, 1.f, 0.f, 0.f,
+                               0.f, 0.f, 1.f, 0.f,
+                               0.f, 0.f, 0.f, 1.f);
+}
+
+TEST(Arithmetic, Float4x3) {
+  const Float4x4 m0 = {{ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 0.f),
+                        ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 0.f),
+                        ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 0.f),
+                        ozz::math::simd_float4::Load(12.f, 13.f, 14.f, 1.f)}};
+  const Float4x4 m1 = {{ozz::math::simd_float4::Load(0.f, -1.f, 2.f, 0.f),
+                        ozz::math::simd_float4::Load(-4.f, 5.f, 6.f, 0.f),
+                        ozz::math::simd_float4::Load(8.f, -9.f, -10.f, 0.f),
+                        ozz::math::simd_float4::Load(-12.f, 13.f, -14.f, 1.f)}};
+  const Float4x3 m0_43 = Float4x3::FromFloat4x4(m0);
+  const Float4x3 m1_43 = Float4x3::FromFloat4x4(m1);
+  const SimdFloat4 v = ozz::math::simd_float4::Load(-0.f, -1.f, -2.f, -3.f);
+
+  // Transformations match Float4x4 ones, but w which is set to 0.
+  const SimdFloat4 transform_point = TransformPoint(m0_43, v);
+  EXPECT_SIMDFLOAT_EQ(transform_point, -8.f, -10.f, -12.f, 0.f);
+
+  const SimdFloat4 transform_vector = TransformVector(m0_43, v);
+  EXPECT_SIMDFLOAT_EQ(transform_vector, -20.f, -23.f, -26.f, 0.f);
+
+  const Float4x3 mul_mat = m0_43 * m1_43;
+  EXPECT_FLOAT4x3_EQ(mul_mat, 12.f, 68.f, -116.f, -48.f,
+                              13.f, 75.f, -127.f, -60.f,
+                              14.f, 82.f, -138.f, -72.f);
+
+  // Matches Float4x4 multiplication.
+  const Float4x4 mul_mat44 = ToFloat4x4(mul_mat);
+  const Float4x4 expected_mul_mat44 = m0 * m1;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ozz::math::AreAllTrue(
+      ozz::math::CmpEq(mul_mat44.cols[i], expected_mul_mat44.cols[i])));
+  }
+
+  const Float4x3 mul_identity = m0_43 * Float4x3::identity();
+  EXPECT_FLOAT4x3_EQ(mul_identity, 0.f, 4.f, 8.f, 12.f,
+                                   1.f, 5.f, 9.f, 13.f,
+                                   2.f, 6.f, 10.f, 14.f);
+
+  const Float4x3 add_mat = m0_43 + m1_43;
+  EXPECT_FLOAT4x3_EQ(add_mat, 0.f, 0.f, 16.f, 0.f,
+                              0.f, 10.f, 0.f, 26.f,
+                              4.f, 12.f, 0.f, 0.f);
+
+  const Float4x3 row_mul = RowMultiply(m0_43,
+                                       ozz::math::simd_float4::Load1(2.f));
+  EXPECT_FLOAT4x3_EQ(row_mul, 0.f, 8.f, 16.f, 24.f,
+                              2.f, 10.f, 18.f, 26.f,
+                              4.f, 12.f, 20.f, 28.f);
+}
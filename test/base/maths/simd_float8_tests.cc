@@ -0,0 +1,127 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/simd_float8.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::math::SimdFloat4;
+using ozz::math::SimdFloat8;
+
+OZZ_STATIC_ASSERT(sizeof(SimdFloat8) == 8 * sizeof(float));
+
+// Expects 8 components of _expected to be equal to the provided values.
+#define EXPECT_SIMDFLOAT8_EQ(_expected, _a, _b, _c, _d, _e, _f, _g, _h)\
+do {\
+  SCOPED_TRACE("");\
+  const SimdFloat8 expected8(_expected);\
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(expected8), _a, _b, _c, _d);\
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(expected8), _e, _f, _g, _h);\
+} while(void(0), 0)
+
+// Same as EXPECT_SIMDFLOAT8_EQ, with estimated precision.
+#define EXPECT_SIMDFLOAT8_EQ_EST(_expected, _a, _b, _c, _d, _e, _f, _g, _h)\
+do {\
+  SCOPED_TRACE("");\
+  const SimdFloat8 expected8(_expected);\
+  EXPECT_SIMDFLOAT_EQ_EST(ozz::math::GetLow(expected8), _a, _b, _c, _d);\
+  EXPECT_SIMDFLOAT_EQ_EST(ozz::math::GetHigh(expected8), _e, _f, _g, _h);\
+} while(void(0), 0)
+
+TEST(LoadFloat8, ozz_simd_math) {
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::simd_float8::zero(),
+                       0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::simd_float8::one(),
+                       1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::simd_float8::Load1(46.f),
+                       46.f, 46.f, 46.f, 46.f, 46.f, 46.f, 46.f, 46.f);
+
+  const SimdFloat8 f8 = ozz::math::simd_float8::Load(
+    ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f));
+  EXPECT_SIMDFLOAT8_EQ(f8, 0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+
+  const float in[9] = {-1.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f};
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::simd_float8::LoadPtrU(in + 1),
+                       1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f);
+
+  float out[9] = {0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 46.f};
+  ozz::math::StorePtrU(f8, out);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_FLOAT_EQ(out[i], static_cast<float>(i));
+  }
+  EXPECT_FLOAT_EQ(out[8], 46.f);
+}
+
+TEST(ArithmeticFloat8, ozz_simd_math) {
+  const SimdFloat8 a = ozz::math::simd_float8::Load(
+    ozz::math::simd_float4::Load(0.5f, 1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f));
+  const SimdFloat8 b = ozz::math::simd_float8::Load(
+    ozz::math::simd_float4::Load(4.f, -5.f, -6.f, 7.f),
+    ozz::math::simd_float4::Load(-1.f, 2.f, 3.f, -4.f));
+  const SimdFloat8 c = ozz::math::simd_float8::Load1(-2.f);
+
+  EXPECT_SIMDFLOAT8_EQ(a + b, 4.5f, -4.f, -4.f, 10.f, 3.f, 7.f, 9.f, 3.f);
+  EXPECT_SIMDFLOAT8_EQ(a - b, -3.5f, 6.f, 8.f, -4.f, 5.f, 3.f, 3.f, 11.f);
+  EXPECT_SIMDFLOAT8_EQ(-a, -.5f, -1.f, -2.f, -3.f, -4.f, -5.f, -6.f, -7.f);
+  EXPECT_SIMDFLOAT8_EQ(a * b, 2.f, -5.f, -12.f, 21.f, -4.f, 10.f, 18.f, -28.f);
+  EXPECT_SIMDFLOAT8_EQ(a / c,
+                       -.25f, -.5f, -1.f, -1.5f, -2.f, -2.5f, -3.f, -3.5f);
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::MAdd(a, b, c),
+                       0.f, -7.f, -14.f, 19.f, -6.f, 8.f, 16.f, -30.f);
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::Min(a, b),
+                       .5f, -5.f, -6.f, 3.f, -1.f, 2.f, 3.f, -4.f);
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::Max(a, b),
+                       4.f, 1.f, 2.f, 7.f, 4.f, 5.f, 6.f, 7.f);
+}
+
+TEST(ReciprocalFloat8, ozz_simd_math) {
+  const SimdFloat8 a = ozz::math::simd_float8::Load(
+    ozz::math::simd_float4::Load(.25f, 1.f, 4.f, 16.f),
+    ozz::math::simd_float4::Load(64.f, 256.f, 1024.f, 4096.f));
+
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::Sqrt(a),
+                       .5f, 1.f, 2.f, 4.f, 8.f, 16.f, 32.f, 64.f);
+  EXPECT_SIMDFLOAT8_EQ_EST(ozz::math::RcpEst(a),
+                           4.f, 1.f, .25f, .0625f,
+                           .015625f, .00390625f, .0009765625f, .000244140625f);
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::RcpEstNR(a),
+                       4.f, 1.f, .25f, .0625f,
+                       .015625f, .00390625f, .0009765625f, .000244140625f);
+  EXPECT_SIMDFLOAT8_EQ_EST(ozz::math::RSqrtEst(a),
+                           2.f, 1.f, .5f, .25f,
+                           .125f, .0625f, .03125f, .015625f);
+  EXPECT_SIMDFLOAT8_EQ(ozz::math::RSqrtEstNR(a),
+                       2.f, 1.f, .5f, .25f,
+                       .125f, .0625f, .03125f, .015625f);
+}
@@ -174,6 +174,17 @@ TEST(StoreFloatPtr, ozz_simd_math) {
     EXPECT_FLOAT_EQ(d_out.f[4], 0.f);
     EXPECT_ASSERTION(ozz::math::StorePtr(f4, d_out.f + 1), "alignment");
   }
+  {
+    Data d_out = {};
+    ozz::math::StreamPtr(f4, d_out.f);
+    ozz::math::StreamFence();
+    EXPECT_FLOAT_EQ(d_out.f[0], -1.f);
+    EXPECT_FLOAT_EQ(d_out.f[1], 1.f);
+    EXPECT_FLOAT_EQ(d_out.f[2], 2.f);
+    EXPECT_FLOAT_EQ(d_out.f[3], 3.f);
+    EXPECT_FLOAT_EQ(d_out.f[4], 0.f);
+    EXPECT_ASSERTION(ozz::math::StreamPtr(f4, d_out.f + 1), "alignment");
+  }
   {
     Data d_out = {};
     ozz::math::Store1Ptr(f4, d_out.f);
@@ -328,6 +339,40 @@ TEST(ArithmeticFloat, ozz_simd_math) {
   EXPECT_SIMDINT_EQ(sign, 0, 0, 0x80000000, 0);
 }
 
+#ifdef OZZ_HAS_DETERMINISM
+TEST(DeterministicFloat, ozz_simd_math) {
+  // Estimations are expected to be correctly rounded, and reductions to be
+  // evaluated in a fixed order, whatever the SIMD implementation.
+  const float fa[4] = {.1f, 1.3f, 2.7f, 3.3f};
+  const float fb[4] = {4.1f, 5.3f, -6.7f, 7.9f};
+  const SimdFloat4 a = ozz::math::simd_float4::LoadPtrU(fa);
+  const SimdFloat4 b = ozz::math::simd_float4::LoadPtrU(fb);
+
+  float rcp[4], rcpnr[4], rsqrt[4], rsqrtnr[4];
+  ozz::math::StorePtrU(ozz::math::RcpEst(b), rcp);
+  ozz::math::StorePtrU(ozz::math::RcpEstNR(b), rcpnr);
+  ozz::math::StorePtrU(ozz::math::RSqrtEst(a), rsqrt);
+  ozz::math::StorePtrU(ozz::math::RSqrtEstNR(a), rsqrtnr);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(rcp[i], 1.f / fb[i]);
+    EXPECT_EQ(rcpnr[i], 1.f / fb[i]);
+    EXPECT_EQ(rsqrt[i], 1.f / std::sqrt(fa[i]));
+    EXPECT_EQ(rsqrtnr[i], 1.f / std::sqrt(fa[i]));
+  }
+  EXPECT_EQ(ozz::math::GetX(ozz::math::RcpEstX(b)), 1.f / fb[0]);
+  EXPECT_EQ(ozz::math::GetX(ozz::math::RSqrtEstX(a)), 1.f / std::sqrt(fa[0]));
+
+  const float ab[4] = {fa[0] * fb[0], fa[1] * fb[1],
+                       fa[2] * fb[2], fa[3] * fb[3]};
+  EXPECT_EQ(ozz::math::GetX(ozz::math::HAdd3(a)), (fa[0] + fa[2]) + fa[1]);
+  EXPECT_EQ(ozz::math::GetX(ozz::math::HAdd4(a)),
+            (fa[0] + fa[2]) + (fa[1] + fa[3]));
+  EXPECT_EQ(ozz::math::GetX(ozz::math::Dot3(a, b)), (ab[0] + ab[2]) + ab[1]);
+  EXPECT_EQ(ozz::math::GetX(ozz::math::Dot4(a, b)),
+            (ab[0] + ab[2]) + (ab[1] + ab[3]));
+}
+#endif  // OZZ_HAS_DETERMINISM
+
 TEST(LengthFloat, ozz_simd_math) {
   const SimdFloat4 f = ozz::math::simd_float4::Load(1.f, 2.f, 4.f, 8.f);
 
@@ -527,6 +572,28 @@ TEST(TrigonometryFloat, ozz_simd_math) {
   EXPECT_SIMDFLOAT_EQ(ozz::math::ATanX(tan), 0.f, .57735f, -1.73205f, 1.f);
 }
 
+TEST(ACosEst, ozz_simd_math) {
+  // Sweeps range [-1,1], including its bounds.
+  for (int i = 0; i <= 2000; ++i) {
+    const float x = -1.f + i * .001f;
+    const ozz::math::SimdFloat4 acos =
+      ozz::math::ACosEst(ozz::math::simd_float4::Load(x, -x, x * .5f, 0.f));
+    EXPECT_NEAR(ozz::math::GetX(acos), std::acos(ozz::math::Min(x, 1.f)),
+                7e-5f);
+    EXPECT_NEAR(ozz::math::GetY(acos), std::acos(ozz::math::Max(-x, -1.f)),
+                7e-5f);
+    EXPECT_NEAR(ozz::math::GetZ(acos), std::acos(x * .5f), 7e-5f);
+  }
+
+  // Out of range values are clamped.
+  const ozz::math::SimdFloat4 out =
+    ozz::math::ACosEst(ozz::math::simd_float4::Load(1.1f, -1.1f, 1.f, -1.f));
+  EXPECT_NEAR(ozz::math::GetX(out), 0.f, 1e-6f);
+  EXPECT_NEAR(ozz::math::GetY(out), ozz::math::kPi, 1e-6f);
+  EXPECT_NEAR(ozz::math::GetZ(out), 0.f, 1e-6f);
+  EXPECT_NEAR(ozz::math::GetW(out), ozz::math::kPi, 1e-6f);
+}
+
 TEST(LogicalFloat, ozz_simd_math) {
   const SimdFloat4 a = ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f);
   const SimdFloat4 b = ozz::math::simd_float4::Load(1.f, -1.f, -3.f, -4.f);
@@ -611,6 +678,25 @@ TEST(Half, ozz_simd_math) {
   }
 }
 
+TEST(HalfRoundTrip, ozz_simd_math) {
+  // Every half that isn't a NaN converts to a float and back exactly, whether
+  // conversions are emulated or use hardware instructions.
+  for (int i = 0; i <= 0xffff; ++i) {
+    if ((i & 0x7c00) == 0x7c00 && (i & 0x03ff) != 0) {
+      continue;
+    }
+    const uint16_t h = static_cast<uint16_t>(i);
+    EXPECT_EQ(ozz::math::FloatToHalf(ozz::math::HalfToFloat(h)), h);
+  }
+
+  // Simd version only considers the low 16 bits of each lane.
+  const SimdFloat4 f = ozz::math::HalfToFloat(
+    ozz::math::simd_int4::Load(0x12343c00, 0xffffbc00, 0x7bff, 0x0001));
+  EXPECT_SIMDFLOAT_EQ(f, 1.f, -1.f, 65504.f, 5.96046448e-8f);
+  EXPECT_SIMDINT_EQ(ozz::math::FloatToHalf(f),
+                    0x00003c00, 0x0000bc00, 0x00007bff, 0x00000001);
+}
+
 TEST(SimdHalf, ozz_simd_math) {
   // 0
   EXPECT_SIMDINT_EQ(ozz::math::FloatToHalf(
@@ -0,0 +1,183 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/soa_conversion.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
+
+using ozz::math::Float3;
+using ozz::math::Quaternion;
+using ozz::math::Transform;
+using ozz::math::SoaFloat3;
+using ozz::math::SoaQuaternion;
+using ozz::math::SoaTransform;
+
+namespace {
+// Builds a transform whose components all differ from other transforms'.
+Transform MakeTransform(int _i) {
+  const float f = static_cast<float>(_i);
+  const Transform transform = {
+    Float3(f, f + .1f, f + .2f),
+    Quaternion(f + .3f, f + .4f, f + .5f, f + .6f),
+    Float3(f + .7f, f + .8f, f + .9f)};
+  return transform;
+}
+
+// Sentinel value of the element that follows converted aos elements.
+const float kSentinel = -46.f;
+}  // namespace
+
+TEST(Float3, ozz_soa_conversion) {
+  for (int count = 0; count <= 9; ++count) {
+    Float3 aos[10];
+    for (int i = 0; i < count; ++i) {
+      aos[i] = MakeTransform(i).translation;
+    }
+    SoaFloat3 soa[3];
+    EXPECT_TRUE(ozz::math::ToSoa(
+      ozz::Range<const Float3>(aos, count), ozz::Range<SoaFloat3>(soa)));
+
+    // Last soa element is padded with zeros.
+    if (count & 3) {
+      const float* lanes = reinterpret_cast<const float*>(&soa[count / 4]);
+      for (int i = count & 3; i < 4; ++i) {
+        EXPECT_EQ(lanes[i], 0.f);
+        EXPECT_EQ(lanes[4 + i], 0.f);
+        EXPECT_EQ(lanes[8 + i], 0.f);
+      }
+    }
+
+    // Converts back, without writing further than count.
+    Float3 back[10];
+    for (int i = 0; i < 10; ++i) {
+      back[i] = Float3(kSentinel);
+    }
+    EXPECT_TRUE(ozz::math::FromSoa(
+      ozz::Range<const SoaFloat3>(soa, 3), ozz::Range<Float3>(back, count)));
+    for (int i = 0; i < count; ++i) {
+      EXPECT_FLOAT3_EQ(back[i], aos[i].x, aos[i].y, aos[i].z);
+    }
+    EXPECT_FLOAT3_EQ(back[count], kSentinel, kSentinel, kSentinel);
+  }
+
+  // Soa output is too small.
+  Float3 aos[5];
+  SoaFloat3 soa[1];
+  EXPECT_FALSE(ozz::math::ToSoa(ozz::Range<const Float3>(aos, 5),
+                                ozz::Range<SoaFloat3>(soa)));
+  EXPECT_FALSE(ozz::math::FromSoa(ozz::Range<const SoaFloat3>(soa, 1),
+                                  ozz::Range<Float3>(aos)));
+}
+
+TEST(Quaternion, ozz_soa_conversion) {
+  for (int count = 0; count <= 9; ++count) {
+    Quaternion aos[10];
+    for (int i = 0; i < count; ++i) {
+      aos[i] = MakeTransform(i).rotation;
+    }
+    SoaQuaternion soa[3];
+    EXPECT_TRUE(ozz::math::ToSoa(
+      ozz::Range<const Quaternion>(aos, count), ozz::Range<SoaQuaternion>(soa)));
+
+    // Last soa element is padded with identity quaternions.
+    if (count & 3) {
+      const float* lanes = reinterpret_cast<const float*>(&soa[count / 4]);
+      for (int i = count & 3; i < 4; ++i) {
+        EXPECT_EQ(lanes[i], 0.f);
+        EXPECT_EQ(lanes[4 + i], 0.f);
+        EXPECT_EQ(lanes[8 + i], 0.f);
+        EXPECT_EQ(lanes[12 + i], 1.f);
+      }
+    }
+
+    Quaternion back[10];
+    for (int i = 0; i < 10; ++i) {
+      back[i] = Quaternion(kSentinel, kSentinel, kSentinel, kSentinel);
+    }
+    EXPECT_TRUE(ozz::math::FromSoa(ozz::Range<const SoaQuaternion>(soa, 3),
+                                   ozz::Range<Quaternion>(back, count)));
+    for (int i = 0; i < count; ++i) {
+      EXPECT_QUATERNION_EQ(back[i], aos[i].x, aos[i].y, aos[i].z, aos[i].w);
+    }
+    EXPECT_QUATERNION_EQ(back[count], kSentinel, kSentinel, kSentinel,
+                         kSentinel);
+  }
+}
+
+TEST(Transform, ozz_soa_conversion) {
+  for (int count = 0; count <= 9; ++count) {
+    Transform aos[10];
+    for (int i = 0; i < count; ++i) {
+      aos[i] = MakeTransform(i);
+    }
+    SoaTransform soa[3];
+    EXPECT_TRUE(ozz::math::ToSoa(
+      ozz::Range<const Transform>(aos, count), ozz::Range<SoaTransform>(soa)));
+
+    // Last soa element is padded with identity transforms.
+    if (count & 3) {
+      const SoaTransform& last = soa[count / 4];
+      const float* t = reinterpret_cast<const float*>(&last.translation);
+      const float* r = reinterpret_cast<const float*>(&last.rotation);
+      const float* s = reinterpret_cast<const float*>(&last.scale);
+      for (int i = count & 3; i < 4; ++i) {
+        EXPECT_EQ(t[i], 0.f);
+        EXPECT_EQ(t[8 + i], 0.f);
+        EXPECT_EQ(r[i], 0.f);
+        EXPECT_EQ(r[12 + i], 1.f);
+        EXPECT_EQ(s[i], 1.f);
+        EXPECT_EQ(s[8 + i], 1.f);
+      }
+    }
+
+    Transform back[10];
+    for (int i = 0; i < 10; ++i) {
+      back[i].translation = Float3(kSentinel);
+      back[i].rotation = Quaternion(kSentinel, kSentinel, kSentinel, kSentinel);
+      back[i].scale = Float3(kSentinel);
+    }
+    EXPECT_TRUE(ozz::math::FromSoa(ozz::Range<const SoaTransform>(soa, 3),
+                                   ozz::Range<Transform>(back, count)));
+    for (int i = 0; i < count; ++i) {
+      const Transform& t = aos[i];
+      EXPECT_FLOAT3_EQ(back[i].translation,
+                       t.translation.x, t.translation.y, t.translation.z);
+      EXPECT_QUATERNION_EQ(back[i].rotation, t.rotation.x, t.rotation.y,
+                           t.rotation.z, t.rotation.w);
+      EXPECT_FLOAT3_EQ(back[i].scale, t.scale.x, t.scale.y, t.scale.z);
+    }
+    EXPECT_FLOAT3_EQ(back[count].translation,
+                     kSentinel, kSentinel, kSentinel);
+  }
+}
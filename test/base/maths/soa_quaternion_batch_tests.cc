@@ -0,0 +1,143 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/soa_quaternion_batch.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::math::SoaQuaternion;
+
+namespace {
+// Builds soa quaternions rotating around z axis, with various angles.
+void BuildRotations(float _offset, SoaQuaternion* _quaternions, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    float sins[4];
+    float coss[4];
+    for (int j = 0; j < 4; ++j) {
+      const float half = (_offset + (i * 4 + j) * .1f) * .5f;
+      sins[j] = std::sin(half);
+      coss[j] = std::cos(half);
+    }
+    _quaternions[i] = SoaQuaternion::Load(
+      ozz::math::simd_float4::zero(),
+      ozz::math::simd_float4::zero(),
+      ozz::math::simd_float4::LoadPtrU(sins),
+      ozz::math::simd_float4::LoadPtrU(coss));
+  }
+}
+}  // namespace
+
+TEST(Batch, ozz_soa_quaternion_batch) {
+  const int kCount = 5;
+  SoaQuaternion a[kCount];
+  SoaQuaternion b[kCount];
+  BuildRotations(0.f, a, kCount);
+  BuildRotations(.7f, b, kCount);
+
+  SoaQuaternion nlerp[kCount];
+  EXPECT_TRUE(ozz::math::NLerpEst(ozz::Range<const SoaQuaternion>(a),
+                                  ozz::Range<const SoaQuaternion>(b),
+                                  .3f,
+                                  ozz::Range<SoaQuaternion>(nlerp)));
+  SoaQuaternion slerp[kCount];
+  EXPECT_TRUE(ozz::math::SlerpEst(ozz::Range<const SoaQuaternion>(a),
+                                  ozz::Range<const SoaQuaternion>(b),
+                                  .3f,
+                                  ozz::Range<SoaQuaternion>(slerp)));
+  ozz::math::SimdFloat4 angles[kCount];
+  EXPECT_TRUE(ozz::math::AngleEst(ozz::Range<const SoaQuaternion>(a),
+                                  ozz::Range<const SoaQuaternion>(b),
+                                  ozz::Range<ozz::math::SimdFloat4>(angles)));
+
+  const ozz::math::SimdFloat4 alpha = ozz::math::simd_float4::Load1(.3f);
+  for (int i = 0; i < kCount; ++i) {
+    const SoaQuaternion expected_nlerp = NLerpEst(a[i], b[i], alpha);
+    EXPECT_TRUE(ozz::math::AreAllTrue(
+      ozz::math::CmpEq(nlerp[i].z, expected_nlerp.z) &
+      ozz::math::CmpEq(nlerp[i].w, expected_nlerp.w)));
+
+    const SoaQuaternion expected_slerp = SlerpEst(a[i], b[i], alpha);
+    EXPECT_TRUE(ozz::math::AreAllTrue(
+      ozz::math::CmpEq(slerp[i].z, expected_slerp.z) &
+      ozz::math::CmpEq(slerp[i].w, expected_slerp.w)));
+
+    // Rotations are .7 radians apart, slerp rotates by .3 of it.
+    EXPECT_SIMDFLOAT_EQ_EST(angles[i], .7f, .7f, .7f, .7f);
+    EXPECT_SIMDFLOAT_EQ_EST(AngleEst(a[i], slerp[i]), .21f, .21f, .21f, .21f);
+  }
+}
+
+TEST(InPlace, ozz_soa_quaternion_batch) {
+  const int kCount = 3;
+  SoaQuaternion a[kCount];
+  SoaQuaternion b[kCount];
+  BuildRotations(0.f, a, kCount);
+  BuildRotations(.4f, b, kCount);
+
+  // Output can be the same as an input.
+  EXPECT_TRUE(ozz::math::SlerpEst(ozz::Range<const SoaQuaternion>(a),
+                                  ozz::Range<const SoaQuaternion>(b),
+                                  .5f,
+                                  ozz::Range<SoaQuaternion>(a)));
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_SIMDFLOAT_EQ_EST(AngleEst(a[i], b[i]), .2f, .2f, .2f, .2f);
+  }
+}
+
+TEST(Invalid, ozz_soa_quaternion_batch) {
+  SoaQuaternion a[3];
+  SoaQuaternion b[2];
+  BuildRotations(0.f, a, 3);
+  BuildRotations(.4f, b, 2);
+  SoaQuaternion output[3];
+  ozz::math::SimdFloat4 angles[2];
+
+  EXPECT_FALSE(ozz::math::NLerpEst(ozz::Range<const SoaQuaternion>(a),
+                                   ozz::Range<const SoaQuaternion>(b),
+                                   .5f,
+                                   ozz::Range<SoaQuaternion>(output)));
+  EXPECT_FALSE(ozz::math::SlerpEst(ozz::Range<const SoaQuaternion>(a),
+                                   ozz::Range<const SoaQuaternion>(b),
+                                   .5f,
+                                   ozz::Range<SoaQuaternion>(output)));
+  EXPECT_FALSE(ozz::math::AngleEst(ozz::Range<const SoaQuaternion>(b),
+                                   ozz::Range<const SoaQuaternion>(a, 2),
+                                   ozz::Range<ozz::math::SimdFloat4>(angles, 1)));
+
+  // Empty ranges are valid.
+  EXPECT_TRUE(ozz::math::AngleEst(ozz::Range<const SoaQuaternion>(),
+                                  ozz::Range<const SoaQuaternion>(),
+                                  ozz::Range<ozz::math::SimdFloat4>()));
+}
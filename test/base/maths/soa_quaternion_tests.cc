@@ -30,6 +30,8 @@
 
 #include "ozz/base/maths/soa_quaternion.h"
 
+#include <cmath>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/gtest_helper.h"
@@ -120,6 +122,13 @@ TEST(QuaternionArithmetic, ozz_math) {
                                              .80133667f, 1.f, .763762f, .74627789f);
   EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(normalize_est)));
 
+  const SoaQuaternion normalize_fast_est = NormalizeFastEst(denorm);
+  EXPECT_SOAQUATERNION_EQ_EST(normalize_fast_est, .033389f, 0.f, .1091089f, .1492555f,
+                                                  .267112f, 0.f, .3273268f, .348263f,
+                                                  .53422445f, 0.f, .545544f, .547270f,
+                                                  .80133667f, 1.f, .763762f, .74627789f);
+  EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(normalize_fast_est)));
+
   const SoaQuaternion lerp_0 = Lerp(a, b, ozz::math::simd_float4::zero());
   EXPECT_SOAQUATERNION_EQ(lerp_0, .70710677f, 0.f, 0.f, .382683432f,
                                   0.f, 0.f, .70710677f, 0.f,
@@ -180,4 +189,53 @@ TEST(QuaternionArithmetic, ozz_math) {
                                            0.f, 0.f, 0.f, 0.f,
                                            .70710677f, .70710677f, .70710677f, .97047764f);
   EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(nlerp_est_m)));
+
+  const SoaQuaternion nlerp_fast_est_m = NLerpFastEst(a, b, ozz::math::simd_float4::Load(0.f, 1.f, 1.f, .2f));
+  EXPECT_SOAQUATERNION_EQ_EST(nlerp_fast_est_m, .70710677f, .70710677f, 0.f, .24119100f,
+                                                0.f, 0.f, .70710677f, 0.f,
+                                                0.f, 0.f, 0.f, 0.f,
+                                                .70710677f, .70710677f, .70710677f, .97047764f);
+  EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(nlerp_fast_est_m)));
+}
+
+TEST(QuaternionSlerpEst, ozz_math) {
+  // Rotations around z axis, from identity.
+  const float angles[4] = {.001f, .5f, 1.5f, 3.f};
+  const SoaQuaternion a = SoaQuaternion::identity();
+  const SoaQuaternion b = SoaQuaternion::Load(
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::Load(std::sin(angles[0] * .5f),
+                                 std::sin(angles[1] * .5f),
+                                 std::sin(angles[2] * .5f),
+                                 std::sin(angles[3] * .5f)),
+    ozz::math::simd_float4::Load(std::cos(angles[0] * .5f),
+                                 std::cos(angles[1] * .5f),
+                                 std::cos(angles[2] * .5f),
+                                 std::cos(angles[3] * .5f)));
+
+  const ozz::math::SimdFloat4 angle = AngleEst(a, b);
+  EXPECT_SIMDFLOAT_EQ_EST(angle, angles[0], angles[1], angles[2], angles[3]);
+
+  // Opposite quaternions are the same rotation.
+  const SoaQuaternion neg_b = {-b.x, -b.y, -b.z, -b.w};
+  const ozz::math::SimdFloat4 neg_angle = AngleEst(b, neg_b);
+  EXPECT_SIMDFLOAT_EQ_EST(neg_angle, 0.f, 0.f, 0.f, 0.f);
+
+  for (int i = 0; i <= 8; ++i) {
+    const float f = i / 8.f;
+    const SoaQuaternion slerp =
+      SlerpEst(a, b, ozz::math::simd_float4::Load1(f));
+    EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(slerp)));
+    EXPECT_SOAQUATERNION_EQ_EST(slerp, 0.f, 0.f, 0.f, 0.f,
+                                    0.f, 0.f, 0.f, 0.f,
+                                    std::sin(f * angles[0] * .5f),
+                                    std::sin(f * angles[1] * .5f),
+                                    std::sin(f * angles[2] * .5f),
+                                    std::sin(f * angles[3] * .5f),
+                                    std::cos(f * angles[0] * .5f),
+                                    std::cos(f * angles[1] * .5f),
+                                    std::cos(f * angles[2] * .5f),
+                                    std::cos(f * angles[3] * .5f));
+  }
 }
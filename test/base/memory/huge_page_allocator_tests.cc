@@ -0,0 +1,90 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/huge_page_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+
+using ozz::memory::Allocator;
+
+TEST(Allocate, HugePageAllocator) {
+  Allocator* allocator = ozz::memory::huge_page_allocator();
+
+  // Small blocks, and blocks mapped to huge pages.
+  const size_t sizes[] = {0, 1, 46, 4096, ozz::memory::kHugePageThreshold - 1,
+                          ozz::memory::kHugePageThreshold,
+                          ozz::memory::kHugePageSize,
+                          ozz::memory::kHugePageSize * 3 + 7};
+  const size_t alignments[] = {4, 16, 64, 4096};
+  for (size_t s = 0; s < OZZ_ARRAY_SIZE(sizes); ++s) {
+    for (size_t a = 0; a < OZZ_ARRAY_SIZE(alignments); ++a) {
+      char* p = static_cast<char*>(
+        allocator->Allocate(sizes[s], alignments[a]));
+      ASSERT_TRUE(p != NULL);
+      EXPECT_TRUE(ozz::math::IsAligned(p, alignments[a]));
+      memset(p, 0xaa, sizes[s]);
+      allocator->Deallocate(p);
+    }
+  }
+
+  // Freeing of a NULL pointer is valid.
+  allocator->Deallocate(NULL);
+}
+
+TEST(Reallocate, HugePageAllocator) {
+  Allocator* allocator = ozz::memory::huge_page_allocator();
+
+  // Grows from a small block to a mapped one.
+  char* p = static_cast<char*>(allocator->Reallocate(NULL, 64, 16));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 64; ++i) {
+    p[i] = static_cast<char>(i);
+  }
+  const size_t big = ozz::memory::kHugePageSize + 1;
+  p = static_cast<char*>(allocator->Reallocate(p, big, 16));
+  ASSERT_TRUE(p != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p, 16));
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ(p[i], static_cast<char>(i));
+  }
+  p[big - 1] = 42;
+
+  // Shrinks back, preserving the beginning of the block.
+  p = static_cast<char*>(allocator->Reallocate(p, 32, 16));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_EQ(p[i], static_cast<char>(i));
+  }
+  allocator->Deallocate(p);
+}
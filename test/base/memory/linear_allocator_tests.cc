@@ -0,0 +1,240 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/linear_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::memory::Allocator;
+using ozz::memory::ArenaAllocator;
+using ozz::memory::LinearAllocator;
+
+TEST(Allocate, LinearAllocator) {
+  LinearAllocator linear(1024);
+  Allocator* allocator = &linear;
+  EXPECT_EQ(linear.capacity(), 1024u);
+  EXPECT_EQ(linear.used(), 0u);
+
+  void* p0 = allocator->Allocate(12, 4);
+  ASSERT_TRUE(p0 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p0, 4));
+  memset(p0, 0, 12);
+  EXPECT_EQ(linear.used(), 12u);
+
+  void* p1 = allocator->Allocate(46, 64);
+  ASSERT_TRUE(p1 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p1, 64));
+  EXPECT_TRUE(p1 > p0);
+  memset(p1, 0, 46);
+
+  // Allocating 0 byte gives a valid pointer.
+  void* p2 = allocator->Allocate(0, 4);
+  EXPECT_TRUE(p2 != NULL);
+
+  // Exhausted.
+  EXPECT_TRUE(allocator->Allocate(1024, 4) == NULL);
+
+  // Deallocation is a no-op, but for the latest allocation.
+  const size_t used = linear.used();
+  allocator->Deallocate(p0);
+  EXPECT_EQ(linear.used(), used);
+  allocator->Deallocate(NULL);
+  EXPECT_EQ(linear.used(), used);
+
+  void* p3 = allocator->Allocate(32, 4);
+  ASSERT_TRUE(p3 != NULL);
+  EXPECT_EQ(linear.used(), used + 32);
+  allocator->Deallocate(p3);
+  EXPECT_EQ(linear.used(), used);
+
+  // Reset releases everything.
+  linear.Reset();
+  EXPECT_EQ(linear.used(), 0u);
+  EXPECT_EQ(allocator->Allocate(12, 4), p0);
+  void* p4 = allocator->Allocate(1000, 4);
+  EXPECT_TRUE(p4 != NULL);
+}
+
+TEST(External, LinearAllocator) {
+  ozz::math::SimdFloat4 buffer[4];
+  LinearAllocator linear(buffer, sizeof(buffer));
+  Allocator* allocator = &linear;
+  EXPECT_EQ(linear.capacity(), sizeof(buffer));
+
+  // Typed allocations through Allocator interface.
+  ozz::Range<ozz::math::SimdFloat4> range =
+    allocator->AllocateRange<ozz::math::SimdFloat4>(3);
+  EXPECT_EQ(range.begin, buffer);
+  EXPECT_EQ(range.end, buffer + 3);
+  EXPECT_TRUE(allocator->Allocate<ozz::math::SimdFloat4>(2) == NULL);
+  EXPECT_EQ(allocator->Allocate<ozz::math::SimdFloat4>(1), buffer + 3);
+
+  // Empty buffer.
+  LinearAllocator empty(static_cast<void*>(NULL), 0);
+  EXPECT_TRUE(static_cast<Allocator&>(empty).Allocate(0, 4) == NULL);
+}
+
+TEST(Reallocate, LinearAllocator) {
+  LinearAllocator linear(1024);
+  Allocator* allocator = &linear;
+
+  // Reallocating NULL allocates.
+  char* p0 = reinterpret_cast<char*>(allocator->Reallocate(NULL, 8, 4));
+  ASSERT_TRUE(p0 != NULL);
+  for (int i = 0; i < 8; ++i) {
+    p0[i] = static_cast<char>(i);
+  }
+
+  // The latest allocation grows in place.
+  char* p1 = reinterpret_cast<char*>(allocator->Reallocate(p0, 16, 4));
+  EXPECT_EQ(p1, p0);
+  EXPECT_EQ(linear.used(), 16u);
+  for (int i = 8; i < 16; ++i) {
+    p1[i] = static_cast<char>(i);
+  }
+
+  allocator->Allocate(4, 4);
+
+  // Otherwise content is moved.
+  char* p2 = reinterpret_cast<char*>(allocator->Reallocate(p1, 32, 16));
+  ASSERT_TRUE(p2 != NULL);
+  EXPECT_TRUE(p2 != p1);
+  EXPECT_TRUE(ozz::math::IsAligned(p2, 16));
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(p2[i], static_cast<char>(i));
+  }
+
+  // Shrinks.
+  char* p3 = reinterpret_cast<char*>(allocator->Reallocate(p2, 8, 16));
+  EXPECT_EQ(p3, p2);
+
+  // Can't grow beyond capacity.
+  EXPECT_TRUE(allocator->Reallocate(p3, 2048, 16) == NULL);
+}
+
+TEST(Allocate, ArenaAllocator) {
+  ArenaAllocator arena(256);
+  Allocator* allocator = &arena;
+  EXPECT_EQ(arena.block_size(), 256u);
+  EXPECT_EQ(arena.capacity(), 0u);
+  EXPECT_EQ(arena.used(), 0u);
+
+  void* p0 = allocator->Allocate(100, 4);
+  ASSERT_TRUE(p0 != NULL);
+  memset(p0, 0, 100);
+  EXPECT_EQ(arena.capacity(), 256u);
+  EXPECT_EQ(arena.used(), 100u);
+
+  void* p1 = allocator->Allocate(100, 16);
+  ASSERT_TRUE(p1 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p1, 16));
+  memset(p1, 0, 100);
+  EXPECT_EQ(arena.capacity(), 256u);
+
+  // Grows with a new block.
+  void* p2 = allocator->Allocate(100, 4);
+  ASSERT_TRUE(p2 != NULL);
+  memset(p2, 0, 100);
+  EXPECT_EQ(arena.capacity(), 512u);
+
+  // Big allocations get their own block.
+  void* p3 = allocator->Allocate(1000, 64);
+  ASSERT_TRUE(p3 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p3, 64));
+  memset(p3, 0, 1000);
+  EXPECT_EQ(arena.capacity(), 512u + 1064u);
+
+  // Latest allocation can be deallocated.
+  const size_t used = arena.used();
+  allocator->Deallocate(p2);
+  EXPECT_EQ(arena.used(), used);
+  allocator->Deallocate(p3);
+  EXPECT_TRUE(arena.used() < used);
+
+  // Reset keeps blocks, which are reused.
+  arena.Reset();
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(arena.capacity(), 512u + 1064u);
+  EXPECT_EQ(allocator->Allocate(100, 4), p0);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(allocator->Allocate(100, 4) != NULL);
+  }
+  EXPECT_EQ(arena.capacity(), 512u + 1064u);
+}
+
+TEST(Reallocate, ArenaAllocator) {
+  ArenaAllocator arena(64);
+  Allocator* allocator = &arena;
+
+  char* p0 = reinterpret_cast<char*>(allocator->Reallocate(NULL, 8, 4));
+  ASSERT_TRUE(p0 != NULL);
+  for (int i = 0; i < 8; ++i) {
+    p0[i] = static_cast<char>(i);
+  }
+
+  // The latest allocation grows in place.
+  char* p1 = reinterpret_cast<char*>(allocator->Reallocate(p0, 32, 4));
+  EXPECT_EQ(p1, p0);
+
+  // Otherwise content is moved, potentially to a new block.
+  char* p2 = reinterpret_cast<char*>(allocator->Reallocate(p1, 128, 16));
+  ASSERT_TRUE(p2 != NULL);
+  EXPECT_TRUE(p2 != p1);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(p2[i], static_cast<char>(i));
+  }
+  allocator->Allocate(4, 4);
+  char* p3 = reinterpret_cast<char*>(allocator->Reallocate(p2, 256, 16));
+  ASSERT_TRUE(p3 != NULL);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(p3[i], static_cast<char>(i));
+  }
+}
+
+TEST(Typed, ArenaAllocator) {
+  ArenaAllocator arena;
+  Allocator* allocator = &arena;
+  EXPECT_EQ(arena.block_size(), ArenaAllocator::kDefaultBlockSize);
+
+  ozz::Range<ozz::math::SimdFloat4> range =
+    allocator->AllocateRange<ozz::math::SimdFloat4>(46);
+  ASSERT_TRUE(range.begin != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(range.begin, 16));
+  allocator->Deallocate(range);
+
+  int* i = allocator->New<int>(46);
+  EXPECT_EQ(*i, 46);
+  allocator->Delete(i);
+}
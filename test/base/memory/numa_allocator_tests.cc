@@ -0,0 +1,105 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/numa_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/linear_allocator.h"
+
+using ozz::memory::Allocator;
+using ozz::memory::NumaAllocator;
+
+TEST(Allocate, NumaAllocator) {
+  NumaAllocator numa(0);
+  EXPECT_EQ(numa.node(), 0);
+  Allocator* allocator = &numa;
+
+  const size_t sizes[] = {0, 1, 46, 4096, 100000};
+  const size_t alignments[] = {4, 16, 256};
+  for (size_t s = 0; s < OZZ_ARRAY_SIZE(sizes); ++s) {
+    for (size_t a = 0; a < OZZ_ARRAY_SIZE(alignments); ++a) {
+      char* p = static_cast<char*>(
+        allocator->Allocate(sizes[s], alignments[a]));
+      ASSERT_TRUE(p != NULL);
+      EXPECT_TRUE(ozz::math::IsAligned(p, alignments[a]));
+      memset(p, 0xaa, sizes[s]);
+      allocator->Deallocate(p);
+    }
+  }
+
+  // Freeing of a NULL pointer is valid.
+  allocator->Deallocate(NULL);
+
+  // Nodes that don't exist fall back to the default policy.
+  NumaAllocator missing(1000);
+  Allocator* fallback = &missing;
+  void* p = fallback->Allocate(64, 16);
+  ASSERT_TRUE(p != NULL);
+  memset(p, 0, 64);
+  fallback->Deallocate(p);
+}
+
+TEST(Reallocate, NumaAllocator) {
+  NumaAllocator numa(0);
+  Allocator* allocator = &numa;
+
+  char* p = static_cast<char*>(allocator->Reallocate(NULL, 64, 16));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 64; ++i) {
+    p[i] = static_cast<char>(i);
+  }
+  p = static_cast<char*>(allocator->Reallocate(p, 10000, 16));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ(p[i], static_cast<char>(i));
+  }
+  p = static_cast<char*>(allocator->Reallocate(p, 8, 16));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(p[i], static_cast<char>(i));
+  }
+  allocator->Deallocate(p);
+}
+
+TEST(Arena, NumaAllocator) {
+  // NumaAllocator is meant to back an arena.
+  NumaAllocator numa(0);
+  ozz::memory::ArenaAllocator arena(1 << 16, &numa);
+  Allocator* allocator = &arena;
+  for (int i = 0; i < 100; ++i) {
+    void* p = allocator->Allocate(1000, 16);
+    ASSERT_TRUE(p != NULL);
+    memset(p, i, 1000);
+  }
+}
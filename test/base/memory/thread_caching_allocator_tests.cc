@@ -0,0 +1,184 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/thread_caching_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif  // _WIN32
+
+using ozz::memory::Allocator;
+
+TEST(Allocate, ThreadCachingAllocator) {
+  Allocator* allocator = ozz::memory::thread_caching_allocator();
+
+  // Every size class, and large allocations.
+  for (size_t size = 0; size < (1 << 17); size = size * 2 + 1) {
+    void* p = allocator->Allocate(size, 4);
+    ASSERT_TRUE(p != NULL);
+    EXPECT_TRUE(ozz::math::IsAligned(p, 16));
+    memset(p, 0, size);
+    allocator->Deallocate(p);
+  }
+
+  // Over-aligned allocations.
+  void* p = allocator->Allocate(12, 1024);
+  ASSERT_TRUE(p != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p, 1024));
+  allocator->Deallocate(p);
+
+  // Freed blocks are reused.
+  void* p0 = allocator->Allocate(46, 16);
+  allocator->Deallocate(p0);
+  void* p1 = allocator->Allocate(46, 16);
+  EXPECT_EQ(p0, p1);
+  allocator->Deallocate(p1);
+
+  // Freeing of a NULL pointer is valid.
+  allocator->Deallocate(NULL);
+}
+
+TEST(Reallocate, ThreadCachingAllocator) {
+  Allocator* allocator = ozz::memory::thread_caching_allocator();
+
+  char* p = static_cast<char*>(allocator->Reallocate(NULL, 8, 4));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 8; ++i) {
+    p[i] = static_cast<char>(i);
+  }
+
+  // Small to small, then large, then over-aligned.
+  p = static_cast<char*>(allocator->Reallocate(p, 100, 4));
+  ASSERT_TRUE(p != NULL);
+  p = static_cast<char*>(allocator->Reallocate(p, 100000, 4));
+  ASSERT_TRUE(p != NULL);
+  p = static_cast<char*>(allocator->Reallocate(p, 16, 256));
+  ASSERT_TRUE(p != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p, 256));
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(p[i], static_cast<char>(i));
+  }
+  allocator->Deallocate(p);
+}
+
+TEST(ReleaseCache, ThreadCachingAllocator) {
+  Allocator* allocator = ozz::memory::thread_caching_allocator();
+
+  // Releasing without a cache is valid.
+  ozz::memory::ReleaseThreadCache();
+  ozz::memory::ReleaseThreadCache();
+
+  void* p0 = allocator->Allocate(46, 16);
+  ASSERT_TRUE(p0 != NULL);
+
+  // Deallocating after releasing the cache goes through the remote path, as
+  // if deallocated from another thread.
+  ozz::memory::ReleaseThreadCache();
+  allocator->Deallocate(p0);
+
+  // The cache is adopted back, remote blocks are reclaimed when needed.
+  void* blocks[4096];
+  bool reclaimed = false;
+  for (int i = 0; i < 4096; ++i) {
+    blocks[i] = allocator->Allocate(46, 16);
+    ASSERT_TRUE(blocks[i] != NULL);
+    reclaimed |= blocks[i] == p0;
+  }
+  EXPECT_TRUE(reclaimed);
+  for (int i = 0; i < 4096; ++i) {
+    allocator->Deallocate(blocks[i]);
+  }
+}
+
+#ifndef _WIN32
+namespace {
+const int kNumThreads = 8;
+const int kNumBlocks = 1024;
+
+struct ThreadData {
+  // Blocks allocated by this thread, and deallocated by the next one.
+  void* blocks[kNumBlocks];
+  int index;
+};
+
+ThreadData g_data[kNumThreads];
+pthread_barrier_t g_barrier;
+
+void* Allocates(void* _data) {
+  ThreadData& data = *static_cast<ThreadData*>(_data);
+  Allocator* allocator = ozz::memory::thread_caching_allocator();
+  for (int k = 0; k < 8; ++k) {
+    for (int i = 0; i < kNumBlocks; ++i) {
+      const size_t size = (i * 7919) % 2048;
+      data.blocks[i] = allocator->Allocate(size, 16);
+      memset(data.blocks[i], data.index, size);
+    }
+    pthread_barrier_wait(&g_barrier);
+
+    // Deallocates blocks allocated by the next thread.
+    ThreadData& next = g_data[(data.index + 1) % kNumThreads];
+    for (int i = 0; i < kNumBlocks; ++i) {
+      const size_t size = (i * 7919) % 2048;
+      const unsigned char* block =
+        static_cast<const unsigned char*>(next.blocks[i]);
+      for (size_t j = 0; j < size; ++j) {
+        if (block[j] != next.index) {
+          ADD_FAILURE();
+          break;
+        }
+      }
+      allocator->Deallocate(next.blocks[i]);
+    }
+    pthread_barrier_wait(&g_barrier);
+  }
+  ozz::memory::ReleaseThreadCache();
+  return NULL;
+}
+}  // namespace
+
+TEST(Threads, ThreadCachingAllocator) {
+  pthread_barrier_init(&g_barrier, NULL, kNumThreads);
+  pthread_t threads[kNumThreads];
+  for (int i = 0; i < kNumThreads; ++i) {
+    g_data[i].index = i;
+    ASSERT_EQ(pthread_create(&threads[i], NULL, Allocates, &g_data[i]), 0);
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+  pthread_barrier_destroy(&g_barrier);
+}
+#endif  // _WIN32
@@ -0,0 +1,135 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+
+using ozz::memory::Allocator;
+using ozz::memory::ScopedTag;
+using ozz::memory::TrackingAllocator;
+
+TEST(ScopedTag, Memory) {
+  EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagDefault);
+  {
+    ScopedTag tag(ozz::memory::kTagAnimation);
+    EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagAnimation);
+    {
+      ScopedTag nested(ozz::memory::kTagCache);
+      EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagCache);
+    }
+    EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagAnimation);
+  }
+  EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagDefault);
+}
+
+TEST(Stats, TrackingAllocator) {
+  TrackingAllocator tracking;
+  Allocator* allocator = &tracking;
+  EXPECT_EQ(tracking.total().live_bytes, 0u);
+  EXPECT_EQ(tracking.total().live_count, 0);
+
+  void* p0 = allocator->Allocate(12, 1024);
+  ASSERT_TRUE(p0 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p0, 1024));
+  memset(p0, 0, 12);
+
+  void* p1 = NULL;
+  {
+    ScopedTag tag(ozz::memory::kTagSkeleton);
+    p1 = allocator->Allocate(46, 4);
+    ASSERT_TRUE(p1 != NULL);
+    memset(p1, 0, 46);
+  }
+
+  const TrackingAllocator::Stats& untagged =
+    tracking.stats(ozz::memory::kTagDefault);
+  EXPECT_EQ(untagged.live_bytes, 12u);
+  EXPECT_EQ(untagged.live_count, 1);
+  const TrackingAllocator::Stats& skeleton =
+    tracking.stats(ozz::memory::kTagSkeleton);
+  EXPECT_EQ(skeleton.live_bytes, 46u);
+  EXPECT_EQ(skeleton.peak_bytes, 46u);
+  EXPECT_EQ(skeleton.live_count, 1);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagAnimation).total_count, 0);
+  EXPECT_EQ(tracking.total().live_bytes, 58u);
+  EXPECT_EQ(tracking.total().live_count, 2);
+
+  // Deallocation is attributed to the allocation tag.
+  allocator->Deallocate(p1);
+  EXPECT_EQ(skeleton.live_bytes, 0u);
+  EXPECT_EQ(skeleton.peak_bytes, 46u);
+  EXPECT_EQ(skeleton.live_count, 0);
+  EXPECT_EQ(skeleton.total_count, 1);
+  EXPECT_EQ(tracking.total().live_bytes, 12u);
+  EXPECT_EQ(tracking.total().peak_bytes, 58u);
+
+  // Reallocation keeps content.
+  static_cast<char*>(p0)[11] = 46;
+  p0 = allocator->Reallocate(p0, 64, 16);
+  ASSERT_TRUE(p0 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p0, 16));
+  EXPECT_EQ(static_cast<char*>(p0)[11], 46);
+  EXPECT_EQ(untagged.live_bytes, 64u);
+  EXPECT_EQ(untagged.live_count, 1);
+  EXPECT_EQ(untagged.total_count, 2);
+
+  // Snapshots.
+  TrackingAllocator::Snapshot snapshot;
+  tracking.GetSnapshot(&snapshot);
+  EXPECT_EQ(snapshot.total.live_bytes, 64u);
+  EXPECT_EQ(snapshot.tags[ozz::memory::kTagSkeleton].peak_bytes, 46u);
+
+  tracking.ResetPeaks();
+  EXPECT_EQ(skeleton.peak_bytes, 0u);
+  EXPECT_EQ(tracking.total().peak_bytes, 64u);
+
+  allocator->Deallocate(p0);
+  allocator->Deallocate(NULL);
+  EXPECT_EQ(tracking.total().live_bytes, 0u);
+  EXPECT_EQ(tracking.total().live_count, 0);
+}
+
+TEST(Default, TrackingAllocator) {
+  TrackingAllocator tracking;
+  Allocator* previous = ozz::memory::SetDefaulAllocator(&tracking);
+  {
+    ScopedTag tag(ozz::memory::kTagCache);
+    int* i = ozz::memory::default_allocator()->New<int>(46);
+    EXPECT_EQ(tracking.stats(ozz::memory::kTagCache).live_bytes, sizeof(int));
+    ozz::memory::default_allocator()->Delete(i);
+  }
+  EXPECT_EQ(ozz::memory::SetDefaulAllocator(previous), &tracking);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagCache).total_count, 1);
+}
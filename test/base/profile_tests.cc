@@ -0,0 +1,116 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/profile.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+struct Record {
+  int begins;
+  int ends;
+  const char* last_name;
+  void* last_context;
+};
+
+void* TestBegin(const char* _name, void* _user_data) {
+  Record* record = static_cast<Record*>(_user_data);
+  ++record->begins;
+  record->last_name = _name;
+  return record;
+}
+
+void TestEnd(const char* _name, void* _context, void* _user_data) {
+  Record* record = static_cast<Record*>(_user_data);
+  ++record->ends;
+  record->last_name = _name;
+  record->last_context = _context;
+}
+
+void ProfiledFunction() {
+  OZZ_PROFILE_SCOPE("ProfiledFunction");
+}
+}  // namespace
+
+TEST(Hooks, Profile) {
+  // Default hooks are disabled.
+  EXPECT_TRUE(ozz::profile::GetHooks().begin == NULL);
+  EXPECT_TRUE(ozz::profile::GetHooks().end == NULL);
+  EXPECT_TRUE(ozz::profile::internal::g_hooks == NULL);
+
+  Record record = {0, 0, NULL, NULL};
+
+  // Incomplete hooks are disabled.
+  ozz::profile::Hooks hooks;
+  hooks.begin = &TestBegin;
+  hooks.user_data = &record;
+  ozz::profile::SetHooks(hooks);
+  EXPECT_TRUE(ozz::profile::internal::g_hooks == NULL);
+  {
+    ozz::profile::Scope scope("incomplete");
+  }
+  EXPECT_EQ(record.begins, 0);
+  EXPECT_EQ(record.ends, 0);
+
+  // Complete hooks.
+  hooks.end = &TestEnd;
+  ozz::profile::SetHooks(hooks);
+  EXPECT_TRUE(ozz::profile::GetHooks().begin == &TestBegin);
+  EXPECT_TRUE(ozz::profile::GetHooks().end == &TestEnd);
+  EXPECT_TRUE(ozz::profile::GetHooks().user_data == &record);
+  {
+    ozz::profile::Scope scope("scope");
+    EXPECT_EQ(record.begins, 1);
+    EXPECT_EQ(record.ends, 0);
+    EXPECT_STREQ(record.last_name, "scope");
+  }
+  EXPECT_EQ(record.begins, 1);
+  EXPECT_EQ(record.ends, 1);
+  EXPECT_STREQ(record.last_name, "scope");
+  EXPECT_TRUE(record.last_context == &record);
+
+  // Macro only notifies hooks when enabled.
+  ProfiledFunction();
+#ifdef OZZ_HAS_PROFILE_HOOKS
+  EXPECT_EQ(record.begins, 2);
+  EXPECT_EQ(record.ends, 2);
+  EXPECT_STREQ(record.last_name, "ProfiledFunction");
+#else  // OZZ_HAS_PROFILE_HOOKS
+  EXPECT_EQ(record.begins, 1);
+  EXPECT_EQ(record.ends, 1);
+#endif  // OZZ_HAS_PROFILE_HOOKS
+
+  // Restores default hooks.
+  ozz::profile::SetHooks(ozz::profile::Hooks());
+  EXPECT_TRUE(ozz::profile::internal::g_hooks == NULL);
+  const int begins = record.begins;
+  ProfiledFunction();
+  EXPECT_EQ(record.begins, begins);
+}
@@ -0,0 +1,171 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/tasks/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+
+using ozz::tasks::Task;
+using ozz::tasks::ThreadPool;
+
+namespace {
+// Counts the number of times every work item is executed. Every item is
+// expected to be executed once, so counters aren't shared between threads.
+class CountTask : public Task {
+ public:
+  explicit CountTask(int _count)
+      : counts_(_count, 0) {
+  }
+
+  virtual void Run(int _index) const {
+    // Makes work items cost uneven.
+    volatile int sink = 0;
+    for (int i = 0; i < (_index % 7) * 100; ++i) {
+      sink += i;
+    }
+    ++counts_[_index];
+  }
+
+  bool ExecutedOnce() const {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      if (counts_[i] != 1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  mutable ozz::Vector<int>::Std counts_;
+};
+
+// Dispatches a nested CountTask from every work item. Nested tasks are
+// allocated upfront, as the default allocator isn't thread-safe.
+class NestedTask : public Task {
+ public:
+  NestedTask(ThreadPool* _pool, int _count, int _nested_count)
+      : pool_(_pool),
+        nested_(_count, CountTask(_nested_count)),
+        nested_count_(_nested_count) {
+  }
+
+  virtual void Run(int _index) const {
+    pool_->Dispatch(nested_[_index], nested_count_);
+  }
+
+  bool Succeeded() const {
+    for (size_t i = 0; i < nested_.size(); ++i) {
+      if (!nested_[i].ExecutedOnce()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  ThreadPool* pool_;
+  ozz::Vector<CountTask>::Std nested_;
+  int nested_count_;
+};
+}  // namespace
+
+TEST(Construction, ThreadPool) {
+  EXPECT_GE(ThreadPool::hardware_concurrency(), 1);
+
+  {
+    ThreadPool pool(1);
+    EXPECT_EQ(pool.num_threads(), 1);
+  }
+  {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.num_threads(), 4);
+  }
+}
+
+TEST(Dispatch, ThreadPool) {
+  const int num_threads[] = {1, 2, 3, 8};
+  const int counts[] = {0, 1, 2, 3, 7, 64, 1000};
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(num_threads); ++t) {
+    ThreadPool pool(num_threads[t]);
+    for (size_t c = 0; c < OZZ_ARRAY_SIZE(counts); ++c) {
+      // Dispatches several times, as workers persist between dispatches.
+      for (int r = 0; r < 10; ++r) {
+        CountTask task(counts[c]);
+        pool.Dispatch(task, counts[c]);
+        EXPECT_TRUE(task.ExecutedOnce());
+      }
+    }
+  }
+}
+
+TEST(Nested, ThreadPool) {
+  ThreadPool pool(4);
+  for (int r = 0; r < 10; ++r) {
+    NestedTask task(&pool, 16, 100);
+    pool.Dispatch(task, 16);
+    EXPECT_TRUE(task.Succeeded());
+  }
+}
+
+TEST(Numa, ThreadPool) {
+  const int num_nodes = ThreadPool::num_numa_nodes();
+  EXPECT_GE(num_nodes, 1);
+  const int current = ThreadPool::current_numa_node();
+  EXPECT_GE(current, 0);
+  EXPECT_LT(current, num_nodes);
+
+  // Out of range nodes can't be pinned.
+  EXPECT_FALSE(ThreadPool::PinCurrentThread(-1));
+  EXPECT_FALSE(ThreadPool::PinCurrentThread(num_nodes));
+
+  // Workers of a pinned pool execute work items like any other.
+  for (int n = 0; n < num_nodes; ++n) {
+    ThreadPool pool(4, n);
+    EXPECT_EQ(pool.numa_node(), n);
+    CountTask task(1000);
+    pool.Dispatch(task, 1000);
+    EXPECT_TRUE(task.ExecutedOnce());
+  }
+
+  // Out of range nodes leave workers unpinned.
+  {
+    ThreadPool pool(2, num_nodes);
+    EXPECT_EQ(pool.numa_node(), -1);
+    CountTask task(100);
+    pool.Dispatch(task, 100);
+    EXPECT_TRUE(task.ExecutedOnce());
+  }
+  {
+    ThreadPool pool(2);
+    EXPECT_EQ(pool.numa_node(), -1);
+  }
+}
@@ -0,0 +1,255 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/offline/influence_partition_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::offline::InfluencePartitions;
+using ozz::geometry::offline::InfluencePartitionBuilder;
+
+TEST(Error, InfluencePartitionBuilder) {
+  const uint16_t indices_buffer[4] = {0, 1, 2, 3};
+  const float weights_buffer[2] = {.5f, .5f};
+  const ozz::Range<const uint16_t> indices(indices_buffer);
+  const ozz::Range<const float> weights(weights_buffer);
+  InfluencePartitions partitions;
+  InfluencePartitionBuilder builder;
+
+  // NULL output.
+  EXPECT_FALSE(builder(2, 2, indices, weights, NULL));
+
+  // Invalid influences count.
+  EXPECT_FALSE(builder(2, 0, indices, weights, &partitions));
+
+  // Invalid vertex count.
+  EXPECT_FALSE(builder(-1, 2, indices, weights, &partitions));
+
+  // Ranges too small.
+  EXPECT_FALSE(builder(3, 2, indices, weights, &partitions));
+  EXPECT_FALSE(builder(2, 2, indices,
+                       ozz::Range<const float>(weights_buffer, 1),
+                       &partitions));
+
+  // Valid, no weights needed for a single influence.
+  EXPECT_TRUE(builder(4, 1, indices, ozz::Range<const float>(), &partitions));
+  ASSERT_EQ(partitions.partitions.size(), 1u);
+  EXPECT_EQ(partitions.partitions[0].influences_count, 1);
+  EXPECT_EQ(partitions.partitions[0].vertex_count, 4);
+
+  // Empty mesh.
+  EXPECT_TRUE(builder(0, 2, indices, weights, &partitions));
+  EXPECT_EQ(partitions.partitions.size(), 0u);
+  EXPECT_EQ(partitions.vertex_remap.size(), 0u);
+}
+
+TEST(Partition, InfluencePartitionBuilder) {
+  // 5 vertices with up to 3 influences.
+  const uint16_t indices[15] = {0, 1, 2,   // 2 influences, weight 0 pruned.
+                                3, 4, 5,   // 3 influences.
+                                6, 7, 8,   // 1 influence.
+                                1, 2, 3,   // 2 influences, .01 pruned.
+                                4, 5, 6};  // 3 influences.
+  const float weights[10] = {.4f, 0.f,
+                             .2f, .3f,
+                             0.f, 0.f,
+                             .69f, .01f,
+                             .1f, .6f};
+  InfluencePartitions partitions;
+  InfluencePartitionBuilder builder;
+  builder.min_partition_vertices = 0;
+  builder.weight_epsilon = .02f;
+  ASSERT_TRUE(builder(5, 3, ozz::Range<const uint16_t>(indices),
+                      ozz::Range<const float>(weights), &partitions));
+
+  ASSERT_EQ(partitions.partitions.size(), 3u);
+  const int expected_remap[5] = {2, 0, 3, 1, 4};
+  ASSERT_EQ(partitions.vertex_remap.size(), 5u);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(partitions.vertex_remap[i], expected_remap[i]);
+  }
+
+  // 1 influence.
+  const InfluencePartitions::Partition& p1 = partitions.partitions[0];
+  EXPECT_EQ(p1.influences_count, 1);
+  EXPECT_EQ(p1.vertex_count, 1);
+  ASSERT_EQ(p1.joint_indices.size(), 1u);
+  EXPECT_EQ(p1.joint_indices[0], 8);
+  EXPECT_EQ(p1.joint_weights.size(), 0u);
+
+  // 2 influences, sorted by weight and renormalized.
+  const InfluencePartitions::Partition& p2 = partitions.partitions[1];
+  EXPECT_EQ(p2.influences_count, 2);
+  EXPECT_EQ(p2.vertex_count, 2);
+  ASSERT_EQ(p2.joint_indices.size(), 4u);
+  EXPECT_EQ(p2.joint_indices[0], 2);
+  EXPECT_EQ(p2.joint_indices[1], 0);
+  EXPECT_EQ(p2.joint_indices[2], 1);
+  EXPECT_EQ(p2.joint_indices[3], 3);
+  ASSERT_EQ(p2.joint_weights.size(), 2u);
+  EXPECT_FLOAT_EQ(p2.joint_weights[0], .6f);
+  EXPECT_FLOAT_EQ(p2.joint_weights[1], .69f / .99f);
+
+  // 3 influences.
+  const InfluencePartitions::Partition& p3 = partitions.partitions[2];
+  EXPECT_EQ(p3.influences_count, 3);
+  EXPECT_EQ(p3.vertex_count, 2);
+  ASSERT_EQ(p3.joint_indices.size(), 6u);
+  EXPECT_EQ(p3.joint_indices[0], 5);
+  EXPECT_EQ(p3.joint_indices[1], 4);
+  EXPECT_EQ(p3.joint_indices[2], 3);
+  ASSERT_EQ(p3.joint_weights.size(), 4u);
+  EXPECT_FLOAT_EQ(p3.joint_weights[0], .5f);
+  EXPECT_FLOAT_EQ(p3.joint_weights[1], .3f);
+}
+
+TEST(Merge, InfluencePartitionBuilder) {
+  // 1 vertex with 1 influences, 2 with 2 and 1 with 3.
+  const uint16_t indices[12] = {0, 1, 2, 3, 4, 5,
+                                6, 7, 8, 9, 10, 11};
+  const float weights[8] = {1.f, 0.f, .5f, 0.f, .5f, 0.f, .5f, .3f};
+  InfluencePartitions partitions;
+  InfluencePartitionBuilder builder;
+  builder.min_partition_vertices = 2;
+  ASSERT_TRUE(builder(4, 3, ozz::Range<const uint16_t>(indices),
+                      ozz::Range<const float>(weights), &partitions));
+
+  // The 1 influence vertex is merged with 2 influences ones, which are then
+  // enough. The last partition is never merged.
+  ASSERT_EQ(partitions.partitions.size(), 2u);
+  const InfluencePartitions::Partition& p2 = partitions.partitions[0];
+  EXPECT_EQ(p2.influences_count, 2);
+  EXPECT_EQ(p2.vertex_count, 3);
+  ASSERT_EQ(p2.joint_indices.size(), 6u);
+  EXPECT_EQ(p2.joint_indices[0], 0);
+  EXPECT_EQ(p2.joint_indices[1], 0);  // Padding.
+  EXPECT_FLOAT_EQ(p2.joint_weights[0], 1.f);
+  const InfluencePartitions::Partition& p3 = partitions.partitions[1];
+  EXPECT_EQ(p3.influences_count, 3);
+  EXPECT_EQ(p3.vertex_count, 1);
+}
+
+TEST(Skinning, InfluencePartitionBuilder) {
+  const int kVertices = 40;
+  const int kInfluences = 4;
+  uint16_t indices[kVertices * kInfluences];
+  float weights[kVertices * (kInfluences - 1)];
+  float positions[kVertices * 3];
+  for (int v = 0; v < kVertices; ++v) {
+    const int used = v % kInfluences;  // Non null weights, the last is too.
+    for (int i = 0; i < kInfluences; ++i) {
+      indices[v * kInfluences + i] = static_cast<uint16_t>((v + i) % 3);
+    }
+    for (int i = 0; i < kInfluences - 1; ++i) {
+      weights[v * (kInfluences - 1) + i] = i < used ? .1f * (i + 1) : 0.f;
+    }
+    for (int c = 0; c < 3; ++c) {
+      positions[v * 3 + c] = v * .5f - c;
+    }
+  }
+  ozz::math::Float4x4 matrices[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+      ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(f, 1.f, -f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(
+        ozz::math::simd_float4::Load(0.f, 1.f, 0.f, f));
+  }
+
+  // Reference skinning with the maximum influences count.
+  float expected[kVertices * 3];
+  ozz::geometry::SkinningJob reference;
+  reference.vertex_count = kVertices;
+  reference.influences_count = kInfluences;
+  reference.joint_matrices = matrices;
+  reference.joint_indices = indices;
+  reference.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+  reference.joint_weights = weights;
+  reference.joint_weights_stride = sizeof(float) * (kInfluences - 1);
+  reference.in_positions = positions;
+  reference.in_positions_stride = sizeof(float) * 3;
+  reference.out_positions = expected;
+  reference.out_positions_stride = sizeof(float) * 3;
+  ASSERT_TRUE(reference.Run());
+
+  InfluencePartitions partitions;
+  InfluencePartitionBuilder builder;
+  builder.min_partition_vertices = 5;
+  ASSERT_TRUE(builder(kVertices, kInfluences,
+                      ozz::Range<const uint16_t>(indices),
+                      ozz::Range<const float>(weights), &partitions));
+  EXPECT_EQ(partitions.partitions.size(), 4u);
+
+  // Skins every partition with its own job.
+  float remapped[kVertices * 3];
+  for (int v = 0; v < kVertices; ++v) {
+    for (int c = 0; c < 3; ++c) {
+      remapped[v * 3 + c] = positions[partitions.vertex_remap[v] * 3 + c];
+    }
+  }
+  float out[kVertices * 3];
+  int offset = 0;
+  for (size_t p = 0; p < partitions.partitions.size(); ++p) {
+    const InfluencePartitions::Partition& partition = partitions.partitions[p];
+    ozz::geometry::SkinningJob job;
+    job.vertex_count = partition.vertex_count;
+    job.influences_count = partition.influences_count;
+    job.joint_matrices = matrices;
+    job.joint_indices =
+      ozz::Range<const uint16_t>(ozz::array_begin(partition.joint_indices),
+                                 ozz::array_end(partition.joint_indices));
+    job.joint_indices_stride = sizeof(uint16_t) * partition.influences_count;
+    job.joint_weights =
+      ozz::Range<const float>(ozz::array_begin(partition.joint_weights),
+                              ozz::array_end(partition.joint_weights));
+    job.joint_weights_stride =
+      sizeof(float) * (partition.influences_count - 1);
+    job.in_positions = ozz::Range<const float>(remapped + offset * 3,
+                                               partition.vertex_count * 3);
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = ozz::Range<float>(out + offset * 3,
+                                          partition.vertex_count * 3);
+    job.out_positions_stride = sizeof(float) * 3;
+    ASSERT_TRUE(job.Run());
+    offset += partition.vertex_count;
+  }
+  ASSERT_EQ(offset, kVertices);
+
+  for (int v = 0; v < kVertices; ++v) {
+    const int source = partitions.vertex_remap[v];
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_NEAR(out[v * 3 + c], expected[source * 3 + c], 1e-5f);
+    }
+  }
+}
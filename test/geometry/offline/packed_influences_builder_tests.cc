@@ -0,0 +1,155 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/offline/packed_influences_builder.h"
+
+#include "gtest/gtest.h"
+
+using ozz::geometry::offline::PackedInfluences;
+using ozz::geometry::offline::PackedInfluencesBuilder;
+
+TEST(Error, PackedInfluencesBuilder) {
+  const uint16_t indices_buffer[4] = {0, 1, 2, 3};
+  const float weights_buffer[2] = {.5f, .5f};
+  const ozz::Range<const uint16_t> indices(indices_buffer);
+  const ozz::Range<const float> weights(weights_buffer);
+  PackedInfluences packed;
+  PackedInfluencesBuilder builder;
+
+  // NULL output.
+  EXPECT_FALSE(builder(2, 2, indices, weights, NULL));
+
+  // Invalid influences count.
+  EXPECT_FALSE(builder(2, 0, indices, weights, &packed));
+
+  // Invalid vertex count.
+  EXPECT_FALSE(builder(-1, 2, indices, weights, &packed));
+
+  // Ranges too small.
+  EXPECT_FALSE(builder(3, 2, indices, weights, &packed));
+  EXPECT_FALSE(builder(2, 2, indices,
+                       ozz::Range<const float>(weights_buffer, 1), &packed));
+
+  // Invalid weight bits.
+  builder.weight_bits = 12;
+  EXPECT_FALSE(builder(2, 2, indices, weights, &packed));
+
+  // Valid.
+  builder.weight_bits = 8;
+  EXPECT_TRUE(builder(2, 2, indices, weights, &packed));
+  builder.weight_bits = 16;
+  EXPECT_TRUE(builder(2, 2, indices, weights, &packed));
+
+  // Valid without any vertex.
+  EXPECT_TRUE(builder(0, 2, ozz::Range<const uint16_t>(),
+                      ozz::Range<const float>(), &packed));
+  EXPECT_EQ(packed.vertex_remap.size(), 0u);
+  EXPECT_EQ(packed.set_vertex_counts.size(), 0u);
+}
+
+TEST(PaletteOverflow, PackedInfluencesBuilder) {
+  uint16_t indices[257];
+  for (int i = 0; i < 257; ++i) {
+    indices[i] = static_cast<uint16_t>(i * 3);
+  }
+  PackedInfluences packed;
+  PackedInfluencesBuilder builder;
+  EXPECT_TRUE(builder(256, 1, ozz::Range<const uint16_t>(indices),
+                      ozz::Range<const float>(), &packed));
+  EXPECT_EQ(packed.palette.size(), 256u);
+  EXPECT_FALSE(builder(257, 1, ozz::Range<const uint16_t>(indices),
+                       ozz::Range<const float>(), &packed));
+}
+
+TEST(Sort, PackedInfluencesBuilder) {
+  // Vertex 0 and 2 share the same set (joints 5 and 9 in different orders),
+  // vertex 1 and 3 share another one.
+  const uint16_t indices[] = {9, 5, 2, 5, 5, 9, 2, 5};
+  const float weights[] = {.25f, .5f, .75f, 1.f};
+  PackedInfluences packed;
+  PackedInfluencesBuilder builder;
+  ASSERT_TRUE(builder(4, 2, ozz::Range<const uint16_t>(indices),
+                      ozz::Range<const float>(weights), &packed));
+
+  EXPECT_EQ(packed.influences_count, 2);
+
+  // Sets are sorted by joints, source order is kept inside a set.
+  ASSERT_EQ(packed.vertex_remap.size(), 4u);
+  EXPECT_EQ(packed.vertex_remap[0], 1);
+  EXPECT_EQ(packed.vertex_remap[1], 3);
+  EXPECT_EQ(packed.vertex_remap[2], 0);
+  EXPECT_EQ(packed.vertex_remap[3], 2);
+
+  ASSERT_EQ(packed.set_vertex_counts.size(), 2u);
+  EXPECT_EQ(packed.set_vertex_counts[0], 2);
+  EXPECT_EQ(packed.set_vertex_counts[1], 2);
+
+  ASSERT_EQ(packed.set_joint_indices.size(), 4u);
+  ASSERT_EQ(packed.palette.size(), 3u);
+  EXPECT_EQ(packed.palette[packed.set_joint_indices[0]], 2);
+  EXPECT_EQ(packed.palette[packed.set_joint_indices[1]], 5);
+  EXPECT_EQ(packed.palette[packed.set_joint_indices[2]], 5);
+  EXPECT_EQ(packed.palette[packed.set_joint_indices[3]], 9);
+
+  // Weights of the first joint of each sorted vertex.
+  EXPECT_EQ(packed.joint_weights_8.size(), 0u);
+  ASSERT_EQ(packed.joint_weights_16.size(), 4u);
+  EXPECT_EQ(packed.joint_weights_16[0], 32768);  // Vertex 1, joint 2.
+  EXPECT_EQ(packed.joint_weights_16[1], 65535);  // Vertex 3, joint 2.
+  EXPECT_EQ(packed.joint_weights_16[2], 49151);  // Vertex 0, joint 5.
+  EXPECT_EQ(packed.joint_weights_16[3], 49151);  // Vertex 2, joint 5.
+
+  // 8 bits quantization.
+  builder.weight_bits = 8;
+  ASSERT_TRUE(builder(4, 2, ozz::Range<const uint16_t>(indices),
+                      ozz::Range<const float>(weights), &packed));
+  EXPECT_EQ(packed.joint_weights_16.size(), 0u);
+  ASSERT_EQ(packed.joint_weights_8.size(), 4u);
+  EXPECT_EQ(packed.joint_weights_8[0], 128);
+  EXPECT_EQ(packed.joint_weights_8[1], 255);
+  EXPECT_EQ(packed.joint_weights_8[2], 191);
+  EXPECT_EQ(packed.joint_weights_8[3], 191);
+}
+
+TEST(SplitSets, PackedInfluencesBuilder) {
+  // Sets can't store more than 65535 vertices.
+  const int kVertices = 70000;
+  ozz::Vector<uint16_t>::Std indices(kVertices, 1);
+  PackedInfluences packed;
+  PackedInfluencesBuilder builder;
+  ASSERT_TRUE(builder(kVertices, 1,
+                      ozz::Range<const uint16_t>(&indices[0], kVertices),
+                      ozz::Range<const float>(), &packed));
+  ASSERT_EQ(packed.set_vertex_counts.size(), 2u);
+  EXPECT_EQ(packed.set_vertex_counts[0], 65535);
+  EXPECT_EQ(packed.set_vertex_counts[1], kVertices - 65535);
+  EXPECT_EQ(packed.set_joint_indices.size(), 2u);
+  EXPECT_EQ(packed.palette.size(), 1u);
+}
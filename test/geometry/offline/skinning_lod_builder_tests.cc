@@ -0,0 +1,137 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/offline/skinning_lod_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::offline::SkinningLods;
+using ozz::geometry::offline::SkinningLodBuilder;
+
+TEST(Error, SkinningLodBuilder) {
+  const int levels_buffer[3] = {0, 1, 0};
+  const ozz::Range<const int> levels(levels_buffer);
+  SkinningLods lods;
+  SkinningLodBuilder builder;
+
+  // NULL output.
+  EXPECT_FALSE(builder(3, levels, NULL));
+
+  // Invalid vertex count.
+  EXPECT_FALSE(builder(-1, levels, &lods));
+
+  // Range too small.
+  EXPECT_FALSE(builder(4, levels, &lods));
+
+  // Negative level.
+  const int negative_buffer[2] = {0, -1};
+  EXPECT_FALSE(builder(2, ozz::Range<const int>(negative_buffer), &lods));
+
+  // Empty mesh.
+  EXPECT_TRUE(builder(0, ozz::Range<const int>(), &lods));
+  EXPECT_EQ(lods.vertex_remap.size(), 0u);
+  EXPECT_EQ(lods.level_vertex_counts.size(), 0u);
+}
+
+TEST(Build, SkinningLodBuilder) {
+  // Level 1 is empty, level 2 is the full mesh.
+  const int levels_buffer[7] = {2, 0, 3, 0, 2, 2, 0};
+  SkinningLods lods;
+  SkinningLodBuilder builder;
+  ASSERT_TRUE(builder(7, ozz::Range<const int>(levels_buffer), &lods));
+
+  ASSERT_EQ(lods.level_vertex_counts.size(), 4u);
+  EXPECT_EQ(lods.level_vertex_counts[0], 3);
+  EXPECT_EQ(lods.level_vertex_counts[1], 3);
+  EXPECT_EQ(lods.level_vertex_counts[2], 6);
+  EXPECT_EQ(lods.level_vertex_counts[3], 7);
+
+  // Vertices order is preserved within each level.
+  const int expected[7] = {1, 3, 6, 0, 4, 5, 2};
+  ASSERT_EQ(lods.vertex_remap.size(), 7u);
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_EQ(lods.vertex_remap[i], expected[i]);
+  }
+}
+
+TEST(Skinning, SkinningLodBuilder) {
+  const int kVertices = 5;
+  const int levels_buffer[kVertices] = {1, 0, 1, 1, 0};
+  const float positions[kVertices * 3] = {0.f, 1.f, 2.f, 3.f, 4.f, 5.f,
+                                          6.f, 7.f, 8.f, 9.f, 10.f, 11.f,
+                                          12.f, 13.f, 14.f};
+  const uint16_t joints[kVertices] = {0, 1, 0, 0, 1};
+  SkinningLods lods;
+  SkinningLodBuilder builder;
+  ASSERT_TRUE(builder(kVertices, ozz::Range<const int>(levels_buffer), &lods));
+
+  // Remaps vertices.
+  float remapped_positions[kVertices * 3];
+  uint16_t remapped_joints[kVertices];
+  for (int i = 0; i < kVertices; ++i) {
+    const int source = lods.vertex_remap[i];
+    remapped_joints[i] = joints[source];
+    for (int c = 0; c < 3; ++c) {
+      remapped_positions[i * 3 + c] = positions[source * 3 + c];
+    }
+  }
+
+  // Skins the cheapest level only.
+  const ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::identity(),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f))};
+  float out_positions[kVertices * 3] = {0.f};
+  ozz::geometry::SkinningJob job;
+  job.vertex_count = lods.level_vertex_counts[0];
+  job.influences_count = 1;
+  job.joint_matrices = matrices;
+  job.joint_indices = remapped_joints;
+  job.joint_indices_stride = sizeof(uint16_t);
+  job.in_positions = remapped_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+
+  ASSERT_EQ(job.vertex_count, 2);
+  const float expected[6] = {4.f, 6.f, 8.f, 13.f, 15.f, 17.f};
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_FLOAT_EQ(out_positions[i], expected[i]);
+  }
+
+  // Vertices beyond the level aren't touched.
+  for (int i = 6; i < kVertices * 3; ++i) {
+    EXPECT_FLOAT_EQ(out_positions[i], 0.f);
+  }
+}
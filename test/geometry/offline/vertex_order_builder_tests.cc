@@ -0,0 +1,208 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/offline/vertex_order_builder.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+using ozz::geometry::offline::VertexOrder;
+using ozz::geometry::offline::VertexOrderBuilder;
+
+namespace {
+// Builds a _size * _size quads grid, whose triangles are emitted in a
+// scattered order.
+void BuildGrid(int _size, ozz::Vector<uint16_t>::Std* _indices) {
+  const int quads = _size * _size;
+  _indices->clear();
+  for (int i = 0; i < quads; ++i) {
+    // 37 is prime with the number of quads used by tests, so every quad is
+    // visited once.
+    const int quad = (i * 37) % quads;
+    const int x = quad % _size;
+    const int y = quad / _size;
+    const uint16_t v0 = static_cast<uint16_t>(y * (_size + 1) + x);
+    const uint16_t v1 = static_cast<uint16_t>(v0 + 1);
+    const uint16_t v2 = static_cast<uint16_t>(v0 + _size + 1);
+    const uint16_t v3 = static_cast<uint16_t>(v2 + 1);
+    const uint16_t triangles[6] = {v0, v1, v2, v2, v1, v3};
+    _indices->insert(_indices->end(), triangles, triangles + 6);
+  }
+}
+
+// Counts the misses of a _size entries fifo post-transform cache.
+int CacheMisses(const ozz::Vector<uint16_t>::Std& _indices, int _size) {
+  ozz::Vector<uint16_t>::Std cache;
+  int misses = 0;
+  for (size_t i = 0; i < _indices.size(); ++i) {
+    if (std::find(cache.begin(), cache.end(), _indices[i]) == cache.end()) {
+      ++misses;
+      cache.push_back(_indices[i]);
+      if (cache.size() > static_cast<size_t>(_size)) {
+        cache.erase(cache.begin());
+      }
+    }
+  }
+  return misses;
+}
+}  // namespace
+
+TEST(Error, VertexOrderBuilder) {
+  const uint16_t indices_buffer[6] = {0, 1, 2, 2, 1, 3};
+  const uint16_t joints_buffer[4] = {0, 0, 1, 1};
+  const ozz::Range<const uint16_t> indices(indices_buffer);
+  const ozz::Range<const uint16_t> joints(joints_buffer);
+  VertexOrder order;
+  VertexOrderBuilder builder;
+
+  // NULL output.
+  EXPECT_FALSE(builder(4, indices, joints, NULL));
+
+  // Invalid vertex count.
+  EXPECT_FALSE(builder(-1, indices, joints, &order));
+
+  // Index out of range.
+  EXPECT_FALSE(builder(3, indices, ozz::Range<const uint16_t>(), &order));
+
+  // Not triangles.
+  EXPECT_FALSE(builder(4,
+                       ozz::Range<const uint16_t>(indices_buffer,
+                                                  indices_buffer + 5),
+                       joints, &order));
+
+  // Joints range too small.
+  EXPECT_FALSE(builder(4, indices,
+                       ozz::Range<const uint16_t>(joints_buffer,
+                                                  joints_buffer + 3),
+                       &order));
+
+  // Invalid cache size.
+  builder.cache_size = 3;
+  EXPECT_FALSE(builder(4, indices, joints, &order));
+  builder.cache_size = 4;
+  EXPECT_TRUE(builder(4, indices, joints, &order));
+
+  // Empty mesh.
+  EXPECT_TRUE(builder(0, ozz::Range<const uint16_t>(),
+                      ozz::Range<const uint16_t>(), &order));
+  EXPECT_TRUE(order.vertex_remap.empty());
+  EXPECT_TRUE(order.triangle_indices.empty());
+}
+
+TEST(CacheOrder, VertexOrderBuilder) {
+  const int kSize = 16;
+  const int kVertices = (kSize + 1) * (kSize + 1) + 1;  // One unused vertex.
+  ozz::Vector<uint16_t>::Std indices;
+  BuildGrid(kSize, &indices);
+
+  VertexOrderBuilder builder;
+  VertexOrder order;
+  ASSERT_TRUE(builder(kVertices,
+                      ozz::Range<const uint16_t>(ozz::array_begin(indices),
+                                                 ozz::array_end(indices)),
+                      ozz::Range<const uint16_t>(),
+                      &order));
+  ASSERT_EQ(order.vertex_remap.size(), static_cast<size_t>(kVertices));
+  ASSERT_EQ(order.triangle_indices.size(), indices.size());
+
+  // Remap is a permutation, with the unused vertex last.
+  ozz::Vector<int>::Std sorted = order.vertex_remap;
+  std::sort(sorted.begin(), sorted.end());
+  for (int i = 0; i < kVertices; ++i) {
+    EXPECT_EQ(sorted[i], i);
+  }
+  EXPECT_EQ(order.vertex_remap.back(), kVertices - 1);
+
+  // The same triangles are output, with the same winding.
+  ozz::Vector<ozz::Vector<int>::Std>::Std in_triangles;
+  ozz::Vector<ozz::Vector<int>::Std>::Std out_triangles;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    ozz::Vector<int>::Std in(3);
+    ozz::Vector<int>::Std out(3);
+    for (int k = 0; k < 3; ++k) {
+      in[k] = indices[i + k];
+      out[k] = order.vertex_remap[order.triangle_indices[i + k]];
+    }
+    std::rotate(in.begin(), std::min_element(in.begin(), in.end()), in.end());
+    std::rotate(out.begin(), std::min_element(out.begin(), out.end()),
+                out.end());
+    in_triangles.push_back(in);
+    out_triangles.push_back(out);
+  }
+  std::sort(in_triangles.begin(), in_triangles.end());
+  std::sort(out_triangles.begin(), out_triangles.end());
+  EXPECT_TRUE(in_triangles == out_triangles);
+
+  // Vertices are numbered in first use order.
+  int next = 0;
+  for (size_t i = 0; i < order.triangle_indices.size(); ++i) {
+    EXPECT_LE(order.triangle_indices[i], next);
+    next = std::max(next, order.triangle_indices[i] + 1);
+  }
+
+  // Post-transform cache misses are reduced.
+  const int before = CacheMisses(indices, 16);
+  const int after = CacheMisses(order.triangle_indices, 16);
+  EXPECT_LT(after * 3, before * 2);
+}
+
+TEST(JointOrder, VertexOrderBuilder) {
+  const int kSize = 10;
+  const int kVertices = (kSize + 1) * (kSize + 1);
+  ozz::Vector<uint16_t>::Std indices;
+  BuildGrid(kSize, &indices);
+
+  // Dominant joint is the grid column band.
+  ozz::Vector<uint16_t>::Std joints(kVertices);
+  for (int v = 0; v < kVertices; ++v) {
+    joints[v] = static_cast<uint16_t>((v % (kSize + 1)) / 4);
+  }
+
+  VertexOrderBuilder builder;
+  VertexOrder order;
+  ASSERT_TRUE(builder(kVertices,
+                      ozz::Range<const uint16_t>(ozz::array_begin(indices),
+                                                 ozz::array_end(indices)),
+                      ozz::Range<const uint16_t>(ozz::array_begin(joints),
+                                                 ozz::array_end(joints)),
+                      &order));
+
+  // Vertices are grouped by dominant joint.
+  for (int v = 1; v < kVertices; ++v) {
+    EXPECT_LE(joints[order.vertex_remap[v - 1]],
+              joints[order.vertex_remap[v]]);
+  }
+
+  // Triangle order is still optimized.
+  const int before = CacheMisses(indices, 16);
+  const int after = CacheMisses(order.triangle_indices, 16);
+  EXPECT_LT(after, before);
+}
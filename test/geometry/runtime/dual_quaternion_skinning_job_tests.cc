@@ -0,0 +1,303 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/dual_quaternion_skinning_job.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+#include "ozz/base/maths/dual_quaternion.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::DualQuaternionSkinningJob;
+using ozz::geometry::SkinningJob;
+using ozz::math::DualQuaternion;
+
+namespace {
+// Builds a rotation quaternion from axis _x, _y, _z and _angle.
+ozz::math::SimdFloat4 AxisAngle(float _x, float _y, float _z, float _angle) {
+  const float s = std::sin(_angle * .5f);
+  return ozz::math::simd_float4::Load(_x * s, _y * s, _z * s,
+                                      std::cos(_angle * .5f));
+}
+}  // namespace
+
+TEST(JobValidity, DualQuaternionSkinningJob) {
+  const DualQuaternion dqs[2] = {DualQuaternion::identity(),
+                                 DualQuaternion::identity()};
+  uint16_t joint_indices[8];
+  float joint_weights[6];
+  float in_positions[6];
+  float in_normals[6];
+  float in_tangents[6];
+  float out_positions[6];
+  float out_normals[6];
+  float out_tangents[6];
+
+  { // Default is invalid.
+    DualQuaternionSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid job with 0 vertex.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 0;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t);
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Invalid job with 0 influence.
+    DualQuaternionSkinningJob job;
+    job.influences_count = 0;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid job without dual quaternions.
+    DualQuaternionSkinningJob job;
+    job.influences_count = 1;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // 2 vertices, 2 influences.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 2;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 2;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());  // Requires weights.
+
+    job.joint_weights = joint_weights;
+    job.joint_weights_stride = sizeof(float);
+    EXPECT_TRUE(job.Validate());
+
+    // Tangents requires normals.
+    job.in_tangents = in_tangents;
+    job.in_tangents_stride = sizeof(float) * 3;
+    job.out_tangents = out_tangents;
+    job.out_tangents_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());  // Requires output normals.
+
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+
+    // Output too small.
+    job.out_normals.end = out_normals + 5;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+// Compares with matrix palette skinning, which is the same as dual quaternion
+// skinning for a single influence or for joints that share the same rotation.
+TEST(JobResult, DualQuaternionSkinningJob) {
+  const ozz::math::SimdFloat4 rotations[3] = {
+    AxisAngle(1.f, 0.f, 0.f, .5f),
+    AxisAngle(0.f, .6f, .8f, -2.f),
+    AxisAngle(1.f, 0.f, 0.f, .5f)};
+  const ozz::math::SimdFloat4 translations[3] = {
+    ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f),
+    ozz::math::simd_float4::Load(-4.f, 0.f, 1.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, -1.f, 7.f, 0.f)};
+  DualQuaternion dqs[3];
+  ozz::math::Float4x4 matrices[3];
+  for (int i = 0; i < 3; ++i) {
+    dqs[i] = DualQuaternion::FromAffine(translations[i], rotations[i]);
+    matrices[i] = ozz::math::Float4x4::Translation(translations[i]) *
+                  ozz::math::Float4x4::FromQuaternion(rotations[i]);
+  }
+
+  // Vertex 0 and 1 are influenced by a single joint, vertex 2 by joints 0 and
+  // 2 which share the same rotation.
+  const uint16_t indices[] = {0, 0, 1, 1, 0, 2};
+  const float weights[] = {1.f, 1.f, .3f};
+  const float in[] = {1.f, 2.f, 3.f, -1.f, 0.f, 5.f, .5f, .5f, -2.f};
+
+  for (int attributes = 1; attributes <= 3; ++attributes) {
+    float expected[3][9];
+    float out[3][9];
+
+    SkinningJob reference;
+    reference.vertex_count = 3;
+    reference.influences_count = 2;
+    reference.joint_matrices = matrices;
+    reference.joint_indices = indices;
+    reference.joint_indices_stride = sizeof(uint16_t) * 2;
+    reference.joint_weights = weights;
+    reference.joint_weights_stride = sizeof(float);
+    reference.in_positions = in;
+    reference.in_positions_stride = sizeof(float) * 3;
+    reference.out_positions = expected[0];
+    reference.out_positions_stride = sizeof(float) * 3;
+
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 3;
+    job.influences_count = 2;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 2;
+    job.joint_weights = weights;
+    job.joint_weights_stride = sizeof(float);
+    job.in_positions = in;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out[0];
+    job.out_positions_stride = sizeof(float) * 3;
+
+    if (attributes > 1) {
+      reference.in_normals = in;
+      reference.in_normals_stride = sizeof(float) * 3;
+      reference.out_normals = expected[1];
+      reference.out_normals_stride = sizeof(float) * 3;
+      job.in_normals = in;
+      job.in_normals_stride = sizeof(float) * 3;
+      job.out_normals = out[1];
+      job.out_normals_stride = sizeof(float) * 3;
+    }
+    if (attributes > 2) {
+      reference.in_tangents = in;
+      reference.in_tangents_stride = sizeof(float) * 3;
+      reference.out_tangents = expected[2];
+      reference.out_tangents_stride = sizeof(float) * 3;
+      job.in_tangents = in;
+      job.in_tangents_stride = sizeof(float) * 3;
+      job.out_tangents = out[2];
+      job.out_tangents_stride = sizeof(float) * 3;
+    }
+
+    ASSERT_TRUE(reference.Run());
+    ASSERT_TRUE(job.Run());
+    for (int a = 0; a < attributes; ++a) {
+      for (int i = 0; i < 9; ++i) {
+        EXPECT_NEAR(out[a][i], expected[a][i], 1e-4f);
+      }
+    }
+
+    // Single influence.
+    reference.influences_count = 1;
+    reference.joint_indices_stride = sizeof(uint16_t) * 2;
+    job.influences_count = 1;
+    ASSERT_TRUE(reference.Run());
+    ASSERT_TRUE(job.Run());
+    for (int a = 0; a < attributes; ++a) {
+      for (int i = 0; i < 9; ++i) {
+        EXPECT_NEAR(out[a][i], expected[a][i], 1e-4f);
+      }
+    }
+  }
+}
+
+// Blending a joint with its almost 180 degrees twisted copy collapses matrix
+// palette skinning vertices to the twist axis (candy-wrapper), whereas dual
+// quaternions preserve the distance to the axis.
+TEST(Twist, DualQuaternionSkinningJob) {
+  const DualQuaternion dqs[2] = {
+    DualQuaternion::identity(),
+    DualQuaternion::FromAffine(ozz::math::simd_float4::zero(),
+                               AxisAngle(1.f, 0.f, 0.f, 3.f))};
+  const uint16_t indices[] = {0, 1};
+  const float weights[] = {.5f};
+  const float in[] = {2.f, 1.f, 0.f};
+  float out[3];
+
+  DualQuaternionSkinningJob job;
+  job.vertex_count = 1;
+  job.influences_count = 2;
+  job.joint_dual_quaternions = dqs;
+  job.joint_indices = indices;
+  job.joint_indices_stride = sizeof(indices);
+  job.joint_weights = weights;
+  job.joint_weights_stride = sizeof(weights);
+  job.in_positions = in;
+  job.in_positions_stride = sizeof(in);
+  job.out_positions = out;
+  job.out_positions_stride = sizeof(out);
+  ASSERT_TRUE(job.Run());
+
+  // Vertex is rotated by half the twist.
+  EXPECT_NEAR(out[0], 2.f, 1e-5f);
+  EXPECT_NEAR(out[1], std::cos(1.5f), 1e-5f);
+  EXPECT_NEAR(out[2], std::sin(1.5f), 1e-5f);
+}
+
+// Tests that antipodal dual quaternions, which represent the same
+// transformation, are blended along the shortest path.
+TEST(Antipodal, DualQuaternionSkinningJob) {
+  const DualQuaternion dq =
+    DualQuaternion::FromAffine(ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f),
+                               AxisAngle(0.f, 1.f, 0.f, 1.f));
+  const DualQuaternion dqs[2] = {dq, {-dq.real, -dq.dual}};
+  const uint16_t indices[] = {0, 1};
+  const float weights[] = {.5f};
+  const float in[] = {2.f, 1.f, 0.f};
+  float out[3];
+
+  DualQuaternionSkinningJob job;
+  job.vertex_count = 1;
+  job.influences_count = 2;
+  job.joint_dual_quaternions = dqs;
+  job.joint_indices = indices;
+  job.joint_indices_stride = sizeof(indices);
+  job.joint_weights = weights;
+  job.joint_weights_stride = sizeof(weights);
+  job.in_positions = in;
+  job.in_positions_stride = sizeof(in);
+  job.out_positions = out;
+  job.out_positions_stride = sizeof(out);
+  ASSERT_TRUE(job.Run());
+
+  const ozz::math::SimdFloat4 expected =
+    TransformPoint(dq, ozz::math::simd_float4::Load(2.f, 1.f, 0.f, 1.f));
+  EXPECT_NEAR(out[0], ozz::math::GetX(expected), 1e-5f);
+  EXPECT_NEAR(out[1], ozz::math::GetY(expected), 1e-5f);
+  EXPECT_NEAR(out[2], ozz::math::GetZ(expected), 1e-5f);
+}
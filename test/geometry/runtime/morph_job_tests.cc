@@ -0,0 +1,248 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/morph_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::MorphJob;
+
+TEST(JobValidity, MorphJob) {
+  const uint32_t indices[2] = {0, 1};
+  const float deltas[6] = {0.f};
+  const float weights[2] = {1.f, 1.f};
+  float in_positions[6];
+  float in_normals[6];
+  float out_positions[6];
+  float out_normals[6];
+
+  MorphJob::Target targets[2];
+  targets[0].indices = ozz::Range<const uint32_t>(indices);
+  targets[0].position_deltas = ozz::Range<const float>(deltas);
+  targets[1] = targets[0];
+
+  { // Default is invalid.
+    MorphJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid job with positions only.
+    MorphJob job;
+    job.vertex_count = 2;
+    job.targets = ozz::Range<const MorphJob::Target>(targets);
+    job.weights = ozz::Range<const float>(weights);
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+
+    // No target.
+    job.targets = ozz::Range<const MorphJob::Target>();
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Not enough weights.
+    MorphJob job;
+    job.vertex_count = 2;
+    job.targets = ozz::Range<const MorphJob::Target>(targets);
+    job.weights = ozz::Range<const float>(weights, 1);
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Output positions too small.
+    MorphJob job;
+    job.vertex_count = 2;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = ozz::Range<float>(out_positions, 5);
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Missing output normals.
+    MorphJob job;
+    job.vertex_count = 2;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Not enough deltas.
+    MorphJob::Target invalid = targets[0];
+    invalid.position_deltas = ozz::Range<const float>(deltas, 5);
+    MorphJob job;
+    job.vertex_count = 2;
+    job.targets = ozz::Range<const MorphJob::Target>(&invalid, 1);
+    job.weights = ozz::Range<const float>(weights);
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Normal deltas without normals.
+    MorphJob::Target invalid = targets[0];
+    invalid.normal_deltas = ozz::Range<const float>(deltas);
+    MorphJob job;
+    job.vertex_count = 2;
+    job.targets = ozz::Range<const MorphJob::Target>(&invalid, 1);
+    job.weights = ozz::Range<const float>(weights);
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Morph, MorphJob) {
+  // 4 vertices, interleaved positions and normals.
+  const float in_vertices[24] = {0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                                 1.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                                 2.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                                 3.f, 0.f, 0.f, 0.f, 1.f, 0.f};
+  float out_vertices[24];
+
+  // Target 0 moves vertices 1 and 3 up, and tilts their normals.
+  const uint32_t indices0[2] = {3, 1};
+  const float position_deltas0[6] = {0.f, 1.f, 0.f, 0.f, 2.f, 0.f};
+  const float normal_deltas0[6] = {1.f, 0.f, 0.f, 1.f, 0.f, 0.f};
+
+  // Target 1 moves vertex 1 along z.
+  const uint32_t indices1[1] = {1};
+  const float position_deltas1[3] = {0.f, 0.f, 4.f};
+
+  MorphJob::Target targets[2];
+  targets[0].indices = ozz::Range<const uint32_t>(indices0);
+  targets[0].position_deltas = ozz::Range<const float>(position_deltas0);
+  targets[0].normal_deltas = ozz::Range<const float>(normal_deltas0);
+  targets[1].indices = ozz::Range<const uint32_t>(indices1);
+  targets[1].position_deltas = ozz::Range<const float>(position_deltas1);
+
+  MorphJob job;
+  job.vertex_count = 4;
+  job.targets = ozz::Range<const MorphJob::Target>(targets);
+  job.in_positions = in_vertices;
+  job.in_positions_stride = sizeof(float) * 6;
+  job.in_normals = ozz::Range<const float>(in_vertices + 3, in_vertices + 24);
+  job.in_normals_stride = sizeof(float) * 6;
+  job.out_positions = out_vertices;
+  job.out_positions_stride = sizeof(float) * 6;
+  job.out_normals = ozz::Range<float>(out_vertices + 3, out_vertices + 24);
+  job.out_normals_stride = sizeof(float) * 6;
+
+  { // Zero weights leave base vertices.
+    const float weights[2] = {0.f, 0.f};
+    job.weights = ozz::Range<const float>(weights);
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 24; ++i) {
+      EXPECT_FLOAT_EQ(out_vertices[i], in_vertices[i]);
+    }
+  }
+  { // Weighted targets.
+    const float weights[2] = {.5f, -1.f};
+    job.weights = ozz::Range<const float>(weights);
+    ASSERT_TRUE(job.Run());
+    const float expected[24] = {0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                                1.f, 1.f, -4.f, .5f, 1.f, 0.f,
+                                2.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                                3.f, .5f, 0.f, .5f, 1.f, 0.f};
+    for (int i = 0; i < 24; ++i) {
+      EXPECT_FLOAT_EQ(out_vertices[i], expected[i]);
+    }
+  }
+}
+
+TEST(InPlace, MorphJob) {
+  // Morphs positions in-place, and feeds them to the SkinningJob.
+  float positions[9] = {0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 2.f, 0.f, 0.f};
+  float skinned[9];
+
+  const uint32_t indices[1] = {2};
+  const float deltas[3] = {0.f, 0.f, 1.f};
+  MorphJob::Target target;
+  target.indices = ozz::Range<const uint32_t>(indices);
+  target.position_deltas = ozz::Range<const float>(deltas);
+  const float weight = 2.f;
+
+  MorphJob job;
+  job.vertex_count = 3;
+  job.targets = ozz::Range<const MorphJob::Target>(&target, 1);
+  job.weights = ozz::Range<const float>(&weight, 1);
+  job.in_positions = positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_positions = positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+  const float morphed[9] = {0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 2.f, 0.f, 2.f};
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_FLOAT_EQ(positions[i], morphed[i]);
+  }
+
+  const ozz::math::Float4x4 matrix =
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(0.f, 10.f, 0.f, 0.f));
+  const uint16_t joint_indices[3] = {0, 0, 0};
+  ozz::geometry::SkinningJob skinning_job;
+  skinning_job.vertex_count = 3;
+  skinning_job.influences_count = 1;
+  skinning_job.joint_matrices = ozz::Range<const ozz::math::Float4x4>(&matrix,
+                                                                      1);
+  skinning_job.joint_indices = joint_indices;
+  skinning_job.joint_indices_stride = sizeof(uint16_t);
+  skinning_job.in_positions = job.out_positions;
+  skinning_job.in_positions_stride = job.out_positions_stride;
+  skinning_job.out_positions = skinned;
+  skinning_job.out_positions_stride = sizeof(float) * 3;
+  ASSERT_TRUE(skinning_job.Run());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FLOAT_EQ(skinned[i * 3 + 0], morphed[i * 3 + 0]);
+    EXPECT_FLOAT_EQ(skinned[i * 3 + 1], morphed[i * 3 + 1] + 10.f);
+    EXPECT_FLOAT_EQ(skinned[i * 3 + 2], morphed[i * 3 + 2]);
+  }
+}
@@ -0,0 +1,251 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/packed_skinning_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/geometry/offline/packed_influences_builder.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::PackedSkinningJob;
+using ozz::geometry::SkinningJob;
+using ozz::geometry::offline::PackedInfluences;
+using ozz::geometry::offline::PackedInfluencesBuilder;
+
+TEST(JobValidity, PackedSkinningJob) {
+  const ozz::math::Float4x4 matrices[2] = {ozz::math::Float4x4::identity(),
+                                           ozz::math::Float4x4::identity()};
+  const uint16_t palette[2] = {0, 1};
+  const uint16_t set_vertex_counts[2] = {1, 1};
+  const uint8_t set_joint_indices[4] = {0, 1, 1, 0};
+  const uint8_t weights_8[2] = {0};
+  const uint16_t weights_16[2] = {0};
+  const float in[6] = {0.f};
+  float out[6];
+
+  { // Default is invalid.
+    PackedSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  PackedSkinningJob job;
+  job.vertex_count = 2;
+  job.influences_count = 2;
+  job.joint_matrices = matrices;
+  job.palette = palette;
+  job.set_vertex_counts = set_vertex_counts;
+  job.set_joint_indices = set_joint_indices;
+  job.in_positions = in;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_positions = out;
+  job.out_positions_stride = sizeof(float) * 3;
+
+  // Weights are required.
+  EXPECT_FALSE(job.Validate());
+  job.joint_weights_8 = weights_8;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+
+  // Only one weight format is allowed.
+  job.joint_weights_16 = weights_16;
+  EXPECT_FALSE(job.Validate());
+  job.joint_weights_8 = ozz::Range<const uint8_t>();
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+
+  // Weights too small.
+  job.joint_weights_16.end = weights_16 + 1;
+  EXPECT_FALSE(job.Validate());
+  job.joint_weights_16.end = weights_16 + 2;
+
+  // Sets must cover all vertices.
+  job.vertex_count = 1;
+  EXPECT_FALSE(job.Validate());
+  job.vertex_count = 2;
+
+  // Set joint indices too small.
+  job.set_joint_indices.end = set_joint_indices + 3;
+  EXPECT_FALSE(job.Validate());
+  job.set_joint_indices.end = set_joint_indices + 4;
+
+  // Tangents requires normals.
+  job.in_tangents = in;
+  job.in_tangents_stride = sizeof(float) * 3;
+  job.out_tangents = out;
+  job.out_tangents_stride = sizeof(float) * 3;
+  EXPECT_FALSE(job.Validate());
+  job.in_normals = in;
+  job.in_normals_stride = sizeof(float) * 3;
+  EXPECT_FALSE(job.Validate());  // Requires output normals.
+  job.out_normals = out;
+  job.out_normals_stride = sizeof(float) * 3;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+
+  // Invalid without palette.
+  job.palette = ozz::Range<const uint16_t>();
+  EXPECT_FALSE(job.Validate());
+}
+
+// Packs random-ish influences with the PackedInfluencesBuilder and compares
+// PackedSkinningJob results with SkinningJob ones.
+TEST(JobResult, PackedSkinningJob) {
+  const int kVertices = 37;
+  const int kJoints = 6;
+  const int kMaxInfluences = 5;
+
+  ozz::math::Float4x4 matrices[kJoints];
+  ozz::math::Float4x4 it_matrices[kJoints];
+  for (int i = 0; i < kJoints; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+      ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(f, -f, 2.f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(
+        ozz::math::simd_float4::Load(0.f, 0.f, 1.f, f * .4f)) *
+      ozz::math::Float4x4::Scaling(
+        ozz::math::simd_float4::Load(1.f, 1.f + f * .1f, 1.f, 1.f));
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+  }
+
+  float in[kVertices * 3];
+  for (int i = 0; i < kVertices * 3; ++i) {
+    in[i] = (i % 7) * .5f - 1.f;
+  }
+
+  for (int bits = 8; bits <= 16; bits += 8) {
+    for (int influences = 1; influences <= kMaxInfluences; ++influences) {
+      for (int it = 0; it < 2; ++it) {
+        // Few different sets, in unsorted order.
+        uint16_t indices[kVertices * kMaxInfluences];
+        float weights[kVertices * kMaxInfluences];
+        for (int v = 0; v < kVertices; ++v) {
+          for (int j = 0; j < influences; ++j) {
+            indices[v * influences + j] =
+              static_cast<uint16_t>((v % 3 + j * (v % 2 + 1)) % kJoints);
+          }
+          for (int j = 0; j < influences - 1; ++j) {
+            weights[v * (influences - 1) + j] =
+              1.f / (influences + 1) + (v % 4) * .01f;
+          }
+        }
+
+        PackedInfluences packed;
+        PackedInfluencesBuilder builder;
+        builder.weight_bits = bits;
+        ASSERT_TRUE(builder(
+          kVertices, influences,
+          ozz::Range<const uint16_t>(indices, kVertices * influences),
+          ozz::Range<const float>(weights, kVertices * (influences - 1)),
+          &packed));
+
+        // Remaps vertex attributes.
+        float packed_in[kVertices * 3];
+        for (int v = 0; v < kVertices; ++v) {
+          for (int c = 0; c < 3; ++c) {
+            packed_in[v * 3 + c] = in[packed.vertex_remap[v] * 3 + c];
+          }
+        }
+
+        float expected[2][kVertices * 3];
+        SkinningJob reference;
+        reference.vertex_count = kVertices;
+        reference.influences_count = influences;
+        reference.joint_matrices = matrices;
+        if (it) {
+          reference.joint_inverse_transpose_matrices = it_matrices;
+        }
+        reference.joint_indices =
+          ozz::Range<const uint16_t>(indices, kVertices * influences);
+        reference.joint_indices_stride = sizeof(uint16_t) * influences;
+        reference.joint_weights =
+          ozz::Range<const float>(weights, kVertices * (influences - 1));
+        reference.joint_weights_stride = sizeof(float) * (influences - 1);
+        reference.in_positions = in;
+        reference.in_positions_stride = sizeof(float) * 3;
+        reference.out_positions = expected[0];
+        reference.out_positions_stride = sizeof(float) * 3;
+        reference.in_normals = in;
+        reference.in_normals_stride = sizeof(float) * 3;
+        reference.out_normals = expected[1];
+        reference.out_normals_stride = sizeof(float) * 3;
+        ASSERT_TRUE(reference.Run());
+
+        float out[2][kVertices * 3];
+        PackedSkinningJob job;
+        job.vertex_count = kVertices;
+        job.influences_count = influences;
+        job.joint_matrices = matrices;
+        if (it) {
+          job.joint_inverse_transpose_matrices = it_matrices;
+        }
+        job.palette = ozz::Range<const uint16_t>(
+          &packed.palette[0], packed.palette.size());
+        job.set_vertex_counts = ozz::Range<const uint16_t>(
+          &packed.set_vertex_counts[0], packed.set_vertex_counts.size());
+        job.set_joint_indices = ozz::Range<const uint8_t>(
+          &packed.set_joint_indices[0], packed.set_joint_indices.size());
+        if (!packed.joint_weights_8.empty()) {
+          job.joint_weights_8 = ozz::Range<const uint8_t>(
+            &packed.joint_weights_8[0], packed.joint_weights_8.size());
+        }
+        if (!packed.joint_weights_16.empty()) {
+          job.joint_weights_16 = ozz::Range<const uint16_t>(
+            &packed.joint_weights_16[0], packed.joint_weights_16.size());
+        }
+        job.in_positions = packed_in;
+        job.in_positions_stride = sizeof(float) * 3;
+        job.out_positions = out[0];
+        job.out_positions_stride = sizeof(float) * 3;
+        job.in_normals = packed_in;
+        job.in_normals_stride = sizeof(float) * 3;
+        job.out_normals = out[1];
+        job.out_normals_stride = sizeof(float) * 3;
+        ASSERT_TRUE(job.Run());
+
+        // Quantization error depends on weights precision.
+        const float tolerance = bits == 8 ? 5e-2f : 5e-4f;
+        for (int a = 0; a < 2; ++a) {
+          for (int v = 0; v < kVertices; ++v) {
+            for (int c = 0; c < 3; ++c) {
+              EXPECT_NEAR(out[a][v * 3 + c],
+                          expected[a][packed.vertex_remap[v] * 3 + c],
+                          tolerance);
+            }
+          }
+        }
+      }
+    }
+  }
+}
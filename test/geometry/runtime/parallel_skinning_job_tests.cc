@@ -0,0 +1,306 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/tasks/task_dispatcher.h"
+
+using ozz::geometry::SkinningJob;
+using ozz::geometry::ParallelSkinningJob;
+
+namespace {
+// Dispatches work items in reverse order, to detect dependencies between
+// chunks.
+class ReverseDispatcher : public ozz::tasks::Dispatcher {
+ public:
+  ReverseDispatcher()
+    : dispatched(0) {
+  }
+  virtual void Dispatch(const ozz::tasks::Task& _task, int _count) {
+    for (int i = _count - 1; i >= 0; --i) {
+      _task.Run(i);
+      ++dispatched;
+    }
+  }
+  int dispatched;
+};
+
+// Defines an interleaved vertex, whose stride isn't a power of 2.
+struct Vertex {
+  float position[3];
+  float normal[3];
+  float tangent[3];
+};
+
+// Setups _job to skin _count vertices from _in to _out, with 2 influences.
+void SetupJob(SkinningJob* _job,
+              const ozz::math::Float4x4* _matrices, int _num_matrices,
+              const uint16_t* _indices, const float* _weights,
+              const Vertex* _in, Vertex* _out, int _count) {
+  _job->vertex_count = _count;
+  _job->influences_count = 2;
+  _job->joint_matrices.begin = _matrices;
+  _job->joint_matrices.end = _matrices + _num_matrices;
+  _job->joint_indices.begin = _indices;
+  _job->joint_indices.end = _indices + _count * 2;
+  _job->joint_indices_stride = sizeof(uint16_t) * 2;
+  _job->joint_weights.begin = _weights;
+  _job->joint_weights.end = _weights + _count;
+  _job->joint_weights_stride = sizeof(float);
+  _job->in_positions.begin = _in->position;
+  _job->in_positions.end = _in[_count].position;
+  _job->in_positions_stride = sizeof(Vertex);
+  _job->in_normals.begin = _in->normal;
+  _job->in_normals.end = _in[_count].normal;
+  _job->in_normals_stride = sizeof(Vertex);
+  _job->in_tangents.begin = _in->tangent;
+  _job->in_tangents.end = _in[_count].tangent;
+  _job->in_tangents_stride = sizeof(Vertex);
+  _job->out_positions.begin = _out->position;
+  _job->out_positions.end = _out[_count].position;
+  _job->out_positions_stride = sizeof(Vertex);
+  _job->out_normals.begin = _out->normal;
+  _job->out_normals.end = _out[_count].normal;
+  _job->out_normals_stride = sizeof(Vertex);
+  _job->out_tangents.begin = _out->tangent;
+  _job->out_tangents.end = _out[_count].tangent;
+  _job->out_tangents_stride = sizeof(Vertex);
+}
+}  // namespace
+
+TEST(JobValidity, ParallelSkinningJob) {
+  ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+  uint16_t indices[8] = {0};
+  float weights[4] = {0.f};
+  Vertex in[5] = {{{0.f}, {0.f}, {0.f}}};
+  Vertex out[5];
+
+  { // Default is invalid.
+    ParallelSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Invalid skinning job.
+    ParallelSkinningJob job;
+    job.dispatcher = ozz::tasks::serial_dispatcher();
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Invalid without dispatcher.
+    ParallelSkinningJob job;
+    SetupJob(&job.skinning, matrices, 2, indices, weights, in, out, 4);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Invalid chunk size.
+    ParallelSkinningJob job;
+    SetupJob(&job.skinning, matrices, 2, indices, weights, in, out, 4);
+    job.dispatcher = ozz::tasks::serial_dispatcher();
+    job.chunk_size = 0;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid.
+    ParallelSkinningJob job;
+    SetupJob(&job.skinning, matrices, 2, indices, weights, in, out, 4);
+    job.dispatcher = ozz::tasks::serial_dispatcher();
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Valid with no vertex.
+    ParallelSkinningJob job;
+    SetupJob(&job.skinning, matrices, 2, indices, weights, in, out, 0);
+    ReverseDispatcher dispatcher;
+    job.dispatcher = &dispatcher;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(dispatcher.dispatched, 0);
+  }
+}
+
+TEST(ChunkSize, ParallelSkinningJob) {
+  ParallelSkinningJob job;
+
+  // 12 bytes stride requires multiples of 16 vertices.
+  job.skinning.out_positions_stride = sizeof(float) * 3;
+  job.chunk_size = 1;
+  EXPECT_EQ(job.chunk_vertex_count(), 16);
+  job.chunk_size = 16;
+  EXPECT_EQ(job.chunk_vertex_count(), 16);
+  job.chunk_size = 17;
+  EXPECT_EQ(job.chunk_vertex_count(), 32);
+
+  // 64 bytes stride is always aligned.
+  job.skinning.out_positions_stride = 64;
+  job.chunk_size = 5;
+  EXPECT_EQ(job.chunk_vertex_count(), 5);
+
+  // Normals stride is only considered if outputed.
+  job.skinning.out_normals_stride = 4;
+  EXPECT_EQ(job.chunk_vertex_count(), 5);
+  float normals[3];
+  job.skinning.out_normals = normals;
+  EXPECT_EQ(job.chunk_vertex_count(), 16);
+}
+
+TEST(JobResult, ParallelSkinningJob) {
+  const int kMaxVertices = 203;
+  const int kJoints = 3;
+
+  ozz::math::Float4x4 matrices[kJoints];
+  for (int i = 0; i < kJoints; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+      ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(f, 2.f, -f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(
+        ozz::math::simd_float4::Load(1.f, 0.f, 0.f, f * .5f));
+  }
+
+  uint16_t indices[kMaxVertices * 2];
+  float weights[kMaxVertices];
+  Vertex in[kMaxVertices + 1];
+  for (int v = 0; v < kMaxVertices; ++v) {
+    indices[v * 2 + 0] = static_cast<uint16_t>(v % kJoints);
+    indices[v * 2 + 1] = static_cast<uint16_t>((v / 3) % kJoints);
+    weights[v] = .2f + (v % 5) * .1f;
+    for (int c = 0; c < 3; ++c) {
+      in[v].position[c] = v * .1f + c;
+      in[v].normal[c] = c == 1 ? 1.f : 0.f;
+      in[v].tangent[c] = c == 0 ? 1.f : 0.f;
+    }
+  }
+
+  const int counts[] = {1, 15, 16, 17, 100, kMaxVertices};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(counts); ++i) {
+    const int count = counts[i];
+    Vertex expected[kMaxVertices + 1];
+    Vertex out[kMaxVertices + 1];
+
+    SkinningJob reference;
+    SetupJob(&reference, matrices, kJoints, indices, weights, in, expected,
+             count);
+    ozz::math::Box expected_bounds;
+    reference.out_bounds = &expected_bounds;
+    ASSERT_TRUE(reference.Run());
+
+    ParallelSkinningJob job;
+    SetupJob(&job.skinning, matrices, kJoints, indices, weights, in, out,
+             count);
+    ozz::math::Box bounds;
+    job.skinning.out_bounds = &bounds;
+    ReverseDispatcher dispatcher;
+    job.dispatcher = &dispatcher;
+    job.chunk_size = 7;
+    ASSERT_TRUE(job.Run());
+
+    // Vertex stride is 36 bytes, chunks are thus 16 vertices.
+    EXPECT_EQ(job.chunk_vertex_count(), 16);
+    EXPECT_EQ(dispatcher.dispatched, (count + 15) / 16);
+
+    for (int v = 0; v < count; ++v) {
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_FLOAT_EQ(out[v].position[c], expected[v].position[c]);
+        EXPECT_FLOAT_EQ(out[v].normal[c], expected[v].normal[c]);
+        EXPECT_FLOAT_EQ(out[v].tangent[c], expected[v].tangent[c]);
+      }
+    }
+
+    // Chunks bounds are merged.
+    EXPECT_FLOAT3_EQ(bounds.min, expected_bounds.min.x,
+                     expected_bounds.min.y, expected_bounds.min.z);
+    EXPECT_FLOAT3_EQ(bounds.max, expected_bounds.max.x,
+                     expected_bounds.max.y, expected_bounds.max.z);
+
+    // Soa output positions are offset per chunk.
+    float x[kMaxVertices];
+    float y[kMaxVertices];
+    float z[kMaxVertices];
+    job.skinning.out_positions.begin = NULL;
+    job.skinning.out_positions.end = NULL;
+    job.skinning.out_positions_x.begin = x;
+    job.skinning.out_positions_x.end = x + count;
+    job.skinning.out_positions_y.begin = y;
+    job.skinning.out_positions_y.end = y + count;
+    job.skinning.out_positions_z.begin = z;
+    job.skinning.out_positions_z.end = z + count;
+    ASSERT_TRUE(job.Run());
+    for (int v = 0; v < count; ++v) {
+      EXPECT_FLOAT_EQ(x[v], expected[v].position[0]);
+      EXPECT_FLOAT_EQ(y[v], expected[v].position[1]);
+      EXPECT_FLOAT_EQ(z[v], expected[v].position[2]);
+    }
+  }
+}
+
+TEST(Stats, ParallelSkinningJob) {
+  // Counters are only updated if stats are enabled.
+#ifdef OZZ_HAS_STATS
+  const int enabled = 1;
+#else  // OZZ_HAS_STATS
+  const int enabled = 0;
+#endif  // OZZ_HAS_STATS
+
+  const int kVertices = 37;
+  const ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+  uint16_t indices[kVertices * 2];
+  float weights[kVertices];
+  Vertex in[kVertices + 1];
+  Vertex out[kVertices + 1];
+  for (int v = 0; v < kVertices; ++v) {
+    indices[v * 2 + 0] = 0;
+    indices[v * 2 + 1] = 1;
+    weights[v] = .5f;
+    for (int c = 0; c < 3; ++c) {
+      in[v].position[c] = in[v].normal[c] = in[v].tangent[c] = 1.f;
+    }
+  }
+
+  ParallelSkinningJob job;
+  SetupJob(&job.skinning, matrices, 2, indices, weights, in, out, kVertices);
+  SkinningJob::Stats stats;
+  job.skinning.stats = &stats;
+  ReverseDispatcher dispatcher;
+  job.dispatcher = &dispatcher;
+  job.chunk_size = 7;
+
+  // Chunks stats are merged, and accumulated from a run to the next.
+  ASSERT_TRUE(job.Run());
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(dispatcher.dispatched, 6);
+  EXPECT_EQ(stats.vertices[1][2], kVertices * 2 * enabled);
+}
@@ -0,0 +1,355 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/qtangent_skinning_job.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+#include "ozz/base/maths/dual_quaternion.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/geometry/runtime/dual_quaternion_skinning_job.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::QTangentSkinningJob;
+using ozz::math::DualQuaternion;
+
+namespace {
+// Builds a rotation quaternion from axis _x, _y, _z and _angle.
+ozz::math::SimdFloat4 AxisAngle(float _x, float _y, float _z, float _angle) {
+  const float s = std::sin(_angle * .5f);
+  return ozz::math::simd_float4::Load(_x * s, _y * s, _z * s,
+                                      std::cos(_angle * .5f));
+}
+
+// Test vertices, with QTangents of both handedness.
+const int kVertexCount = 4;
+const float kPositions[kVertexCount * 3] = {1.f, 0.f, 0.f, 0.f, 2.f, 0.f,
+                                            0.f, 0.f, -1.f, 1.f, -1.f, 3.f};
+const uint16_t kIndices[kVertexCount * 2] = {0, 1, 1, 0, 0, 1, 1, 1};
+const float kWeights[kVertexCount] = {1.f, .3f, .7f, .5f};
+
+// Fills _qtangents and the decoded _normals and _tangents (3 floats).
+void BuildFrames(float _qtangents[kVertexCount * 4],
+                 float _normals[kVertexCount * 3],
+                 float _tangents[kVertexCount * 3]) {
+  const ozz::math::SimdFloat4 q[kVertexCount] = {
+    AxisAngle(0.f, 1.f, 0.f, .3f),
+    -AxisAngle(.6f, 0.f, .8f, 1.2f),  // Negative w, left handed.
+    AxisAngle(1.f, 0.f, 0.f, -2.5f),
+    -AxisAngle(0.f, 0.f, 1.f, 3.f)};
+  for (int i = 0; i < kVertexCount; ++i) {
+    ozz::math::StorePtrU(q[i], _qtangents + i * 4);
+    const DualQuaternion r = {q[i], ozz::math::simd_float4::zero()};
+    ozz::math::Store3PtrU(
+      TransformVector(r, ozz::math::simd_float4::z_axis()), _normals + i * 3);
+    ozz::math::Store3PtrU(
+      TransformVector(r, ozz::math::simd_float4::x_axis()), _tangents + i * 3);
+  }
+}
+
+// Sets up _job with test vertices.
+void SetupJob(QTangentSkinningJob* _job, const float* _qtangents) {
+  _job->vertex_count = kVertexCount;
+  _job->influences_count = 2;
+  _job->joint_indices = kIndices;
+  _job->joint_indices_stride = sizeof(uint16_t) * 2;
+  _job->joint_weights = kWeights;
+  _job->joint_weights_stride = sizeof(float);
+  _job->in_positions = kPositions;
+  _job->in_positions_stride = sizeof(float) * 3;
+  _job->in_qtangents = ozz::Range<const float>(_qtangents, kVertexCount * 4);
+  _job->in_qtangents_stride = sizeof(float) * 4;
+}
+}  // namespace
+
+TEST(JobValidity, QTangentSkinningJob) {
+  const DualQuaternion dqs[2] = {DualQuaternion::identity(),
+                                 DualQuaternion::identity()};
+  const ozz::math::Float4x4 matrices[2] = {ozz::math::Float4x4::identity(),
+                                           ozz::math::Float4x4::identity()};
+  float qtangents[kVertexCount * 4];
+  float normals[kVertexCount * 3];
+  float tangents[kVertexCount * 3];
+  BuildFrames(qtangents, normals, tangents);
+  float out_positions[kVertexCount * 3];
+  float out_qtangents[kVertexCount * 4];
+  float out_normals[kVertexCount * 3];
+  float out_tangents[kVertexCount * 4];
+
+  { // Default is invalid.
+    QTangentSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid dual quaternion job.
+    QTangentSkinningJob job;
+    SetupJob(&job, qtangents);
+    job.joint_dual_quaternions = dqs;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    job.out_qtangents = out_qtangents;
+    job.out_qtangents_stride = sizeof(float) * 4;
+    EXPECT_TRUE(job.Validate());
+
+    // Both palettes.
+    job.joint_matrices = matrices;
+    EXPECT_FALSE(job.Validate());
+
+    // Matrices can't output qtangents.
+    job.joint_dual_quaternions = ozz::Range<const DualQuaternion>();
+    EXPECT_FALSE(job.Validate());
+
+    // But can output decoded frames.
+    job.out_qtangents = ozz::Range<float>();
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    job.out_tangents = out_tangents;
+    job.out_tangents_stride = sizeof(float) * 4;
+    EXPECT_TRUE(job.Validate());
+
+    // Not enough tangents, which are 4 floats.
+    job.out_tangents = ozz::Range<float>(out_tangents, kVertexCount * 3);
+    EXPECT_FALSE(job.Validate());
+    job.out_tangents = out_tangents;
+
+    // Not enough input qtangents.
+    job.in_qtangents = ozz::Range<const float>(qtangents, kVertexCount * 3);
+    EXPECT_FALSE(job.Validate());
+
+    // No palette.
+    job.in_qtangents = qtangents;
+    job.joint_matrices = ozz::Range<const ozz::math::Float4x4>();
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Input qtangents without output.
+    QTangentSkinningJob job;
+    SetupJob(&job, qtangents);
+    job.joint_dual_quaternions = dqs;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+
+    // Outputs without input qtangents.
+    job.in_qtangents = ozz::Range<const float>();
+    job.out_normals = out_normals;
+    EXPECT_FALSE(job.Validate());
+
+    // Positions only.
+    job.out_normals = ozz::Range<float>();
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Missing weights and positions.
+    QTangentSkinningJob job;
+    SetupJob(&job, qtangents);
+    job.joint_dual_quaternions = dqs;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+
+    job.joint_weights = ozz::Range<const float>();
+    EXPECT_FALSE(job.Validate());
+
+    job.joint_weights = kWeights;
+    job.out_positions = ozz::Range<float>();
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(DualQuaternions, QTangentSkinningJob) {
+  float qtangents[kVertexCount * 4];
+  float normals[kVertexCount * 3];
+  float tangents[kVertexCount * 3];
+  BuildFrames(qtangents, normals, tangents);
+
+  const DualQuaternion dqs[2] = {
+    DualQuaternion::FromAffine(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f),
+      AxisAngle(0.f, 0.f, 1.f, 1.f)),
+    DualQuaternion::FromAffine(
+      ozz::math::simd_float4::Load(-2.f, 0.f, 1.f, 0.f),
+      AxisAngle(1.f, 0.f, 0.f, -2.f))};
+
+  float out_positions[kVertexCount * 3];
+  float out_qtangents[kVertexCount * 4];
+  float out_normals[kVertexCount * 3];
+  float out_tangents[kVertexCount * 4];
+  QTangentSkinningJob job;
+  SetupJob(&job, qtangents);
+  job.joint_dual_quaternions = dqs;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_qtangents = out_qtangents;
+  job.out_qtangents_stride = sizeof(float) * 4;
+  job.out_normals = out_normals;
+  job.out_normals_stride = sizeof(float) * 3;
+  job.out_tangents = out_tangents;
+  job.out_tangents_stride = sizeof(float) * 4;
+  ASSERT_TRUE(job.Run());
+
+  // Reference result from separate normals and tangents.
+  float ref_positions[kVertexCount * 3];
+  float ref_normals[kVertexCount * 3];
+  float ref_tangents[kVertexCount * 3];
+  ozz::geometry::DualQuaternionSkinningJob ref;
+  ref.vertex_count = kVertexCount;
+  ref.influences_count = 2;
+  ref.joint_dual_quaternions = dqs;
+  ref.joint_indices = kIndices;
+  ref.joint_indices_stride = sizeof(uint16_t) * 2;
+  ref.joint_weights = kWeights;
+  ref.joint_weights_stride = sizeof(float);
+  ref.in_positions = kPositions;
+  ref.in_positions_stride = sizeof(float) * 3;
+  ref.in_normals = normals;
+  ref.in_normals_stride = sizeof(float) * 3;
+  ref.in_tangents = tangents;
+  ref.in_tangents_stride = sizeof(float) * 3;
+  ref.out_positions = ref_positions;
+  ref.out_positions_stride = sizeof(float) * 3;
+  ref.out_normals = ref_normals;
+  ref.out_normals_stride = sizeof(float) * 3;
+  ref.out_tangents = ref_tangents;
+  ref.out_tangents_stride = sizeof(float) * 3;
+  ASSERT_TRUE(ref.Run());
+
+  for (int i = 0; i < kVertexCount; ++i) {
+    const float handedness = qtangents[i * 4 + 3] < 0.f ? -1.f : 1.f;
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(out_positions[i * 3 + j], ref_positions[i * 3 + j], 1e-5f);
+      EXPECT_NEAR(out_normals[i * 3 + j], ref_normals[i * 3 + j], 1e-4f);
+      EXPECT_NEAR(out_tangents[i * 4 + j], ref_tangents[i * 3 + j], 1e-4f);
+    }
+    EXPECT_FLOAT_EQ(out_tangents[i * 4 + 3], handedness);
+
+    // Output qtangents are normalized and keep their handedness.
+    const float* q = out_qtangents + i * 4;
+    EXPECT_NEAR(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3],
+                1.f, 1e-4f);
+    EXPECT_EQ(q[3] < 0.f, handedness < 0.f);
+    EXPECT_GE(std::abs(q[3]), ozz::geometry::kQTangentBias);
+  }
+}
+
+TEST(Matrices, QTangentSkinningJob) {
+  float qtangents[kVertexCount * 4];
+  float normals[kVertexCount * 3];
+  float tangents[kVertexCount * 3];
+  BuildFrames(qtangents, normals, tangents);
+
+  const ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)) *
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 1.f)),
+    ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 0.f))};
+
+  float out_positions[kVertexCount * 3];
+  float out_normals[kVertexCount * 3];
+  float out_tangents[kVertexCount * 4];
+  QTangentSkinningJob job;
+  SetupJob(&job, qtangents);
+  job.joint_matrices = matrices;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals = out_normals;
+  job.out_normals_stride = sizeof(float) * 3;
+  job.out_tangents = out_tangents;
+  job.out_tangents_stride = sizeof(float) * 4;
+  ASSERT_TRUE(job.Run());
+
+  // Reference result from separate normals and tangents.
+  float ref_positions[kVertexCount * 3];
+  float ref_normals[kVertexCount * 3];
+  float ref_tangents[kVertexCount * 3];
+  ozz::geometry::SkinningJob ref;
+  ref.vertex_count = kVertexCount;
+  ref.influences_count = 2;
+  ref.joint_matrices = matrices;
+  ref.joint_indices = kIndices;
+  ref.joint_indices_stride = sizeof(uint16_t) * 2;
+  ref.joint_weights = kWeights;
+  ref.joint_weights_stride = sizeof(float);
+  ref.in_positions = kPositions;
+  ref.in_positions_stride = sizeof(float) * 3;
+  ref.in_normals = normals;
+  ref.in_normals_stride = sizeof(float) * 3;
+  ref.in_tangents = tangents;
+  ref.in_tangents_stride = sizeof(float) * 3;
+  ref.out_positions = ref_positions;
+  ref.out_positions_stride = sizeof(float) * 3;
+  ref.out_normals = ref_normals;
+  ref.out_normals_stride = sizeof(float) * 3;
+  ref.out_tangents = ref_tangents;
+  ref.out_tangents_stride = sizeof(float) * 3;
+  ASSERT_TRUE(ref.Run());
+
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(out_positions[i * 3 + j], ref_positions[i * 3 + j], 1e-5f);
+      EXPECT_NEAR(out_normals[i * 3 + j], ref_normals[i * 3 + j], 1e-5f);
+      EXPECT_NEAR(out_tangents[i * 4 + j], ref_tangents[i * 3 + j], 1e-5f);
+    }
+    EXPECT_FLOAT_EQ(out_tangents[i * 4 + 3],
+                    qtangents[i * 4 + 3] < 0.f ? -1.f : 1.f);
+  }
+}
+
+TEST(Bias, QTangentSkinningJob) {
+  // Rotates a qtangent with w = 1 by 180 degrees, which gives w = 0.
+  const DualQuaternion dqs[1] = {DualQuaternion::FromAffine(
+    ozz::math::simd_float4::zero(), AxisAngle(0.f, 1.f, 0.f, 3.14159265f))};
+  const uint16_t indices[1] = {0};
+  const float positions[3] = {0.f, 0.f, 0.f};
+  const float qtangents[4] = {0.f, 0.f, 0.f, -1.f};
+  float out_positions[3];
+  float out_qtangents[4];
+
+  QTangentSkinningJob job;
+  job.vertex_count = 1;
+  job.influences_count = 1;
+  job.joint_dual_quaternions = dqs;
+  job.joint_indices = indices;
+  job.in_positions = positions;
+  job.in_qtangents = qtangents;
+  job.out_positions = out_positions;
+  job.out_qtangents = out_qtangents;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_FLOAT_EQ(out_qtangents[3], -ozz::geometry::kQTangentBias);
+  EXPECT_NEAR(std::abs(out_qtangents[1]), 1.f, 1e-6f);
+}
@@ -32,10 +32,16 @@
 
 #include "gtest/gtest.h"
 
+#include <cmath>
+#include <cstring>
+
 #include "ozz/base/log.h"
+#include "ozz/base/maths/box.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_float4x3.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/tasks/task_dispatcher.h"
 
 using ozz::geometry::SkinningJob;
 
@@ -1118,6 +1124,700 @@ TEST(JobResult, SkinningJob) {
   }
 }
 
+TEST(Bounds, SkinningJob) {
+  const int kVertices = 11;
+  const int kInfluences = 6;
+  ozz::math::Float4x4 matrices[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+      ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(f, -2.f * f, 3.f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(
+        ozz::math::simd_float4::Load(0.f, 0.f, 1.f, f));
+  }
+  uint16_t joint_indices[kVertices * kInfluences];
+  float joint_weights[kVertices * kInfluences];
+  float in_vectors[kVertices * 3];
+  for (int v = 0; v < kVertices; ++v) {
+    for (int j = 0; j < kInfluences; ++j) {
+      joint_indices[v * kInfluences + j] =
+        static_cast<uint16_t>((v + j) % 3);
+      joint_weights[v * kInfluences + j] = .1f;
+    }
+    for (int c = 0; c < 3; ++c) {
+      in_vectors[v * 3 + c] = (v * 7 + c * 3) % 5 - 2.f;
+    }
+  }
+
+  // Tests all functions variants, including the single vertex case.
+  for (int influences = 1; influences <= kInfluences; ++influences) {
+    for (int fct = 0; fct < 3; ++fct) {
+      for (int vertices = 1; vertices <= kVertices; vertices += 10) {
+        float out_positions[kVertices * 3];
+        float out_vectors[kVertices * 3];
+        ozz::math::Box bounds;
+
+        SkinningJob job;
+        job.vertex_count = vertices;
+        job.influences_count = influences;
+        job.joint_matrices = matrices;
+        job.joint_indices = joint_indices;
+        job.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+        job.joint_weights = joint_weights;
+        job.joint_weights_stride = sizeof(float) * kInfluences;
+        job.in_positions = in_vectors;
+        job.in_positions_stride = sizeof(float) * 3;
+        job.out_positions = out_positions;
+        job.out_positions_stride = sizeof(float) * 3;
+        if (fct > 0) {
+          job.in_normals = in_vectors;
+          job.in_normals_stride = sizeof(float) * 3;
+          job.out_normals = out_vectors;
+          job.out_normals_stride = sizeof(float) * 3;
+        }
+        if (fct > 1) {
+          job.in_tangents = in_vectors;
+          job.in_tangents_stride = sizeof(float) * 3;
+          job.out_tangents = out_vectors;
+          job.out_tangents_stride = sizeof(float) * 3;
+        }
+        job.out_bounds = &bounds;
+        ASSERT_TRUE(job.Run());
+
+        const ozz::math::Box ref(
+          reinterpret_cast<const ozz::math::Float3*>(out_positions),
+          sizeof(float) * 3, vertices);
+        EXPECT_FLOAT3_EQ(bounds.min, ref.min.x, ref.min.y, ref.min.z);
+        EXPECT_FLOAT3_EQ(bounds.max, ref.max.x, ref.max.y, ref.max.z);
+      }
+    }
+  }
+
+  { // Empty job outputs an invalid box.
+    ozz::math::Box bounds(ozz::math::Float3(0.f), ozz::math::Float3(1.f));
+    SkinningJob job;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_vectors;
+    job.out_positions = in_vectors;
+    job.out_bounds = &bounds;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(bounds.is_valid());
+  }
+}
+
+TEST(JointRemap, SkinningJob) {
+  const int kVertices = 11;
+  const int kInfluences = 6;
+  const int kJoints = 7;
+  ozz::math::Float4x4 matrices[kJoints];
+  for (int i = 0; i < kJoints; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+      ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(f, -2.f * f, 3.f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(
+        ozz::math::simd_float4::Load(0.f, 0.f, 1.f, f)) *
+      ozz::math::Float4x4::Scaling(
+        ozz::math::simd_float4::Load(1.f, 1.f + f, 2.f, 0.f));
+  }
+
+  // Part palette, and matrices gathered from it as a reference.
+  const uint16_t remap[3] = {5, 1, 6};
+  ozz::math::Float4x4 gathered[3];
+  for (int i = 0; i < 3; ++i) {
+    gathered[i] = matrices[remap[i]];
+  }
+
+  uint16_t joint_indices[kVertices * kInfluences];
+  float joint_weights[kVertices * kInfluences];
+  float in_vectors[kVertices * 3];
+  for (int v = 0; v < kVertices; ++v) {
+    for (int j = 0; j < kInfluences; ++j) {
+      joint_indices[v * kInfluences + j] =
+        static_cast<uint16_t>((v + j) % 3);
+      joint_weights[v * kInfluences + j] = .1f;
+    }
+    for (int c = 0; c < 3; ++c) {
+      in_vectors[v * 3 + c] = (v * 7 + c * 3) % 5 - 2.f;
+    }
+  }
+
+  { // Remap table end without begin is invalid.
+    SkinningJob job;
+    job.vertex_count = 1;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_vectors;
+    float out_positions[3];
+    job.out_positions = out_positions;
+    job.joint_remap.end = remap;
+    EXPECT_FALSE(job.Validate());
+    job.joint_remap = remap;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  // Tests all functions variants, with and without inverse transpose
+  // matrices, against the same job run on gathered matrices.
+  for (int influences = 1; influences <= kInfluences; ++influences) {
+    for (int fct = 0; fct < 3; ++fct) {
+      for (int it = 0; it < 2; ++it) {
+        float out_positions[2][kVertices * 3];
+        float out_normals[2][kVertices * 3];
+        float out_tangents[2][kVertices * 3];
+        for (int r = 0; r < 2; ++r) {
+          SkinningJob job;
+          job.vertex_count = kVertices;
+          job.influences_count = influences;
+          if (r) {
+            job.joint_matrices = matrices;
+            job.joint_remap = remap;
+          } else {
+            job.joint_matrices = gathered;
+          }
+          if (it) {
+            job.joint_inverse_transpose_matrices = job.joint_matrices;
+          }
+          job.joint_indices = joint_indices;
+          job.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+          job.joint_weights = joint_weights;
+          job.joint_weights_stride = sizeof(float) * kInfluences;
+          job.in_positions = in_vectors;
+          job.in_positions_stride = sizeof(float) * 3;
+          job.out_positions = out_positions[r];
+          job.out_positions_stride = sizeof(float) * 3;
+          if (fct > 0) {
+            job.in_normals = in_vectors;
+            job.in_normals_stride = sizeof(float) * 3;
+            job.out_normals = out_normals[r];
+            job.out_normals_stride = sizeof(float) * 3;
+          }
+          if (fct > 1) {
+            job.in_tangents = in_vectors;
+            job.in_tangents_stride = sizeof(float) * 3;
+            job.out_tangents = out_tangents[r];
+            job.out_tangents_stride = sizeof(float) * 3;
+          }
+          ASSERT_TRUE(job.Run());
+        }
+        for (int i = 0; i < kVertices * 3; ++i) {
+          EXPECT_FLOAT_EQ(out_positions[1][i], out_positions[0][i]);
+          if (fct > 0) {
+            EXPECT_FLOAT_EQ(out_normals[1][i], out_normals[0][i]);
+          }
+          if (fct > 1) {
+            EXPECT_FLOAT_EQ(out_tangents[1][i], out_tangents[0][i]);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(Batch, SkinningJob) {
+  const int kParts = 3;
+  const int kVertices = 9;
+  const int kJoints = 4;
+  ozz::math::Float4x4 matrices[kJoints];
+  for (int i = 0; i < kJoints; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+      ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(f, -2.f * f, 3.f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(
+        ozz::math::simd_float4::Load(0.f, 0.f, 1.f, f));
+  }
+
+  // Parts have 1 to kParts influences, and increasing vertex count.
+  uint16_t joint_indices[kVertices * kParts];
+  float joint_weights[kVertices * kParts];
+  float in_vectors[kVertices * 3];
+  for (int i = 0; i < kVertices * kParts; ++i) {
+    joint_indices[i] = static_cast<uint16_t>(i % kJoints);
+    joint_weights[i] = .2f;
+  }
+  for (int i = 0; i < kVertices * 3; ++i) {
+    in_vectors[i] = (i * 7) % 5 - 2.f;
+  }
+  const uint16_t remap[kJoints] = {3, 2, 1, 0};
+
+  float out_positions[2][kParts][kVertices * 3];
+  float out_normals[2][kParts][kVertices * 3];
+  ozz::math::Box bounds[2][kParts];
+
+  ozz::geometry::BatchSkinningJob::Part parts[kParts];
+  for (int p = 0; p < kParts; ++p) {
+    ozz::geometry::BatchSkinningJob::Part& part = parts[p];
+    part.vertex_count = kVertices - p * 3;
+    part.influences_count = p + 1;
+    part.joint_indices = joint_indices;
+    part.joint_indices_stride = sizeof(uint16_t) * part.influences_count;
+    part.joint_remap.begin = p == 1 ? remap : NULL;
+    part.joint_remap.end = p == 1 ? remap + kJoints : NULL;
+    part.joint_weights = joint_weights;
+    part.joint_weights_stride = sizeof(float) * part.influences_count;
+    part.in_positions = in_vectors;
+    part.in_positions_stride = sizeof(float) * 3;
+    part.out_positions = out_positions[0][p];
+    part.out_positions_stride = sizeof(float) * 3;
+    if (p > 0) {
+      part.in_normals = in_vectors;
+      part.in_normals_stride = sizeof(float) * 3;
+      part.out_normals = out_normals[0][p];
+      part.out_normals_stride = sizeof(float) * 3;
+    }
+    part.out_bounds = &bounds[0][p];
+
+    // Reference, a SkinningJob per part.
+    SkinningJob job;
+    job.vertex_count = part.vertex_count;
+    job.influences_count = part.influences_count;
+    job.joint_matrices = matrices;
+    job.joint_indices = part.joint_indices;
+    job.joint_indices_stride = part.joint_indices_stride;
+    job.joint_remap = part.joint_remap;
+    job.joint_weights = part.joint_weights;
+    job.joint_weights_stride = part.joint_weights_stride;
+    job.in_positions = part.in_positions;
+    job.in_positions_stride = part.in_positions_stride;
+    job.out_positions = out_positions[1][p];
+    job.out_positions_stride = part.out_positions_stride;
+    if (p > 0) {
+      job.in_normals = part.in_normals;
+      job.in_normals_stride = part.in_normals_stride;
+      job.out_normals = out_normals[1][p];
+      job.out_normals_stride = part.out_normals_stride;
+    }
+    job.normalization = SkinningJob::kNormalize;
+    job.out_bounds = &bounds[1][p];
+    ASSERT_TRUE(job.Run());
+  }
+
+  { // Invalid batches.
+    ozz::geometry::BatchSkinningJob batch;
+    EXPECT_TRUE(batch.Validate());  // Empty batch.
+    batch.parts = parts;
+    EXPECT_FALSE(batch.Validate());  // No matrices.
+    batch.joint_matrices = matrices;
+    EXPECT_TRUE(batch.Validate());
+    batch.joint_matrices_4x3.begin =
+      reinterpret_cast<const ozz::math::Float4x3*>(matrices);
+    EXPECT_FALSE(batch.Validate());  // Both matrices types.
+    batch.joint_matrices_4x3.begin = NULL;
+    batch.parts.end = parts;
+    EXPECT_TRUE(batch.Validate());  // Empty parts range.
+    batch.parts.end = NULL;
+    EXPECT_FALSE(batch.Validate());
+  }
+
+  // Runs serially and with a dispatcher.
+  for (int d = 0; d < 2; ++d) {
+    std::memset(out_positions[0], 0, sizeof(out_positions[0]));
+    std::memset(out_normals[0], 0, sizeof(out_normals[0]));
+
+    ozz::geometry::BatchSkinningJob batch;
+    batch.joint_matrices = matrices;
+    batch.normalization = SkinningJob::kNormalize;
+    batch.parts = parts;
+    batch.dispatcher = d ? ozz::tasks::serial_dispatcher() : NULL;
+    ASSERT_TRUE(batch.Run());
+
+    for (int p = 0; p < kParts; ++p) {
+      for (int i = 0; i < parts[p].vertex_count * 3; ++i) {
+        EXPECT_FLOAT_EQ(out_positions[0][p][i], out_positions[1][p][i]);
+        if (p > 0) {
+          EXPECT_FLOAT_EQ(out_normals[0][p][i], out_normals[1][p][i]);
+        }
+      }
+      EXPECT_FLOAT3_EQ(bounds[0][p].min, bounds[1][p].min.x,
+                       bounds[1][p].min.y, bounds[1][p].min.z);
+      EXPECT_FLOAT3_EQ(bounds[0][p].max, bounds[1][p].max.x,
+                       bounds[1][p].max.y, bounds[1][p].max.z);
+    }
+  }
+}
+
+TEST(SoaPositions, SkinningJob) {
+  const int kVertices = 11;
+  const int kInfluences = 6;
+  ozz::math::Float4x4 matrices[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+      ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(f, -2.f * f, 3.f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(
+        ozz::math::simd_float4::Load(0.f, 0.f, 1.f, f));
+  }
+  uint16_t joint_indices[kVertices * kInfluences];
+  float joint_weights[kVertices * kInfluences];
+  float in_vectors[kVertices * 3];
+  for (int v = 0; v < kVertices; ++v) {
+    for (int j = 0; j < kInfluences; ++j) {
+      joint_indices[v * kInfluences + j] =
+        static_cast<uint16_t>((v + j) % 3);
+      joint_weights[v * kInfluences + j] = .1f;
+    }
+    for (int c = 0; c < 3; ++c) {
+      in_vectors[v * 3 + c] = (v * 7 + c * 3) % 5 - 2.f;
+    }
+  }
+
+  float out_x[kVertices];
+  float out_y[kVertices];
+  float out_z[kVertices];
+
+  { // Validation.
+    float out_positions[kVertices * 3];
+    SkinningJob job;
+    job.vertex_count = kVertices;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t);
+    job.in_positions = in_vectors;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions_x = out_x;
+    job.out_positions_y = out_y;
+    EXPECT_FALSE(job.Validate());  // Missing z.
+    job.out_positions_z.begin = out_z;
+    job.out_positions_z.end = out_z + kVertices - 1;
+    EXPECT_FALSE(job.Validate());  // Too small.
+    job.out_positions_z = out_z;
+    EXPECT_TRUE(job.Validate());
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());  // Both layouts.
+    job.out_positions_x.begin = NULL;
+    job.out_positions_x.end = NULL;
+    EXPECT_FALSE(job.Validate());  // y and z without x.
+  }
+
+  // Tests all functions variants against aos output positions.
+  for (int influences = 1; influences <= kInfluences; ++influences) {
+    for (int fct = 0; fct < 3; ++fct) {
+      float out_positions[kVertices * 3];
+      float out_vectors[kVertices * 3];
+      ozz::math::Box bounds[2];
+      for (int soa = 0; soa < 2; ++soa) {
+        SkinningJob job;
+        job.vertex_count = kVertices;
+        job.influences_count = influences;
+        job.joint_matrices = matrices;
+        job.joint_indices = joint_indices;
+        job.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+        job.joint_weights = joint_weights;
+        job.joint_weights_stride = sizeof(float) * kInfluences;
+        job.in_positions = in_vectors;
+        job.in_positions_stride = sizeof(float) * 3;
+        if (soa) {
+          job.out_positions_x = out_x;
+          job.out_positions_y = out_y;
+          job.out_positions_z = out_z;
+        } else {
+          job.out_positions = out_positions;
+          job.out_positions_stride = sizeof(float) * 3;
+        }
+        if (fct > 0) {
+          job.in_normals = in_vectors;
+          job.in_normals_stride = sizeof(float) * 3;
+          job.out_normals = out_vectors;
+          job.out_normals_stride = sizeof(float) * 3;
+        }
+        if (fct > 1) {
+          job.in_tangents = in_vectors;
+          job.in_tangents_stride = sizeof(float) * 3;
+          job.out_tangents = out_vectors;
+          job.out_tangents_stride = sizeof(float) * 3;
+        }
+        job.out_bounds = &bounds[soa];
+        ASSERT_TRUE(job.Run());
+      }
+      for (int v = 0; v < kVertices; ++v) {
+        EXPECT_FLOAT_EQ(out_x[v], out_positions[v * 3 + 0]);
+        EXPECT_FLOAT_EQ(out_y[v], out_positions[v * 3 + 1]);
+        EXPECT_FLOAT_EQ(out_z[v], out_positions[v * 3 + 2]);
+      }
+      EXPECT_FLOAT3_EQ(bounds[1].min, bounds[0].min.x, bounds[0].min.y,
+                       bounds[0].min.z);
+      EXPECT_FLOAT3_EQ(bounds[1].max, bounds[0].max.x, bounds[0].max.y,
+                       bounds[0].max.z);
+    }
+  }
+}
+
+TEST(Normalization, SkinningJob) {
+  const ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 0.f)),
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 1.f)) *
+    ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(.5f, .5f, .5f, 0.f))};
+  const uint16_t joint_indices[6] = {0, 1, 1, 0, 0, 1};
+  const float joint_weights[3] = {.2f, 1.f, .7f};
+  const float in_vectors[9] = {1.f, 0.f, 0.f,
+                               0.f, .5f, .5f,
+                               -1.f, 2.f, 3.f};
+
+  float ref_normals[9];
+  float ref_tangents[9];
+  float out_positions[9];
+  float out_normals[9];
+  float out_tangents[9];
+  SkinningJob job;
+  job.vertex_count = 3;
+  job.influences_count = 2;
+  job.joint_matrices = matrices;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions = in_vectors;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_vectors;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.in_tangents = in_vectors;
+  job.in_tangents_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals_stride = sizeof(float) * 3;
+  job.out_tangents_stride = sizeof(float) * 3;
+
+  // Reference, not normalized, output.
+  EXPECT_EQ(job.normalization, SkinningJob::kNoNormalization);
+  job.out_normals = ref_normals;
+  job.out_tangents = ref_tangents;
+  ASSERT_TRUE(job.Run());
+
+  const SkinningJob::Normalization modes[] = {SkinningJob::kNormalizeEst,
+                                              SkinningJob::kNormalize};
+  const float tolerances[] = {2e-3f, 1e-6f};
+  for (size_t m = 0; m < OZZ_ARRAY_SIZE(modes); ++m) {
+    job.normalization = modes[m];
+    job.out_normals = out_normals;
+    job.out_tangents = out_tangents;
+    ASSERT_TRUE(job.Run());
+
+    for (int v = 0; v < 3; ++v) {
+      const float* n = ref_normals + v * 3;
+      const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_NEAR(out_normals[v * 3 + c], n[c] / len, tolerances[m]);
+        EXPECT_FLOAT_EQ(out_tangents[v * 3 + c], out_normals[v * 3 + c]);
+      }
+    }
+  }
+}
+
+TEST(UniformScale, SkinningJob) {
+  // Uniformly scaled matrices don't need inverse transpose matrices to skin
+  // normals, renormalizing is enough.
+  const int kVertices = 5;
+  const ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f),
+      ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .70710677f),
+      ozz::math::simd_float4::Load1(3.f)),
+    ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(-1.f, 0.f, 2.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .70710677f),
+      ozz::math::simd_float4::Load1(.5f))};
+  const ozz::math::Float4x4 it_matrices[2] = {
+    ozz::math::Transpose(ozz::math::Invert(matrices[0])),
+    ozz::math::Transpose(ozz::math::Invert(matrices[1]))};
+
+  const uint16_t joint_indices[kVertices] = {0, 1, 1, 0, 1};
+  float in_normals[kVertices * 3];
+  for (int i = 0; i < kVertices * 3; ++i) {
+    in_normals[i] = (i * 7) % 5 - 2.f;
+  }
+
+  float out_positions[kVertices * 3];
+  float out_normals[2][kVertices * 3];
+  for (int it = 0; it < 2; ++it) {
+    SkinningJob job;
+    job.vertex_count = kVertices;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    if (it) {
+      job.joint_inverse_transpose_matrices = it_matrices;
+    }
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t);
+    job.in_positions = in_normals;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_normals = out_normals[it];
+    job.out_normals_stride = sizeof(float) * 3;
+    job.normalization = SkinningJob::kNormalize;
+    ASSERT_TRUE(job.Run());
+  }
+  for (int i = 0; i < kVertices * 3; ++i) {
+    EXPECT_NEAR(out_normals[0][i], out_normals[1][i], 1e-5f);
+  }
+}
+
+TEST(JobValidity4x3, SkinningJob) {
+  ozz::math::Float4x4 matrices[2];
+  ozz::math::Float4x3 matrices_4x3[2];
+  uint16_t joint_indices[2] = {0, 1};
+  float in_positions[6];
+  float in_normals[6];
+  float out_positions[6];
+  float out_normals[6];
+
+  SkinningJob base_job;
+  base_job.vertex_count = 2;
+  base_job.influences_count = 1;
+  base_job.joint_indices = joint_indices;
+  base_job.joint_indices_stride = sizeof(uint16_t);
+  base_job.in_positions = in_positions;
+  base_job.in_positions_stride = sizeof(float) * 3;
+  base_job.out_positions = out_positions;
+  base_job.out_positions_stride = sizeof(float) * 3;
+  base_job.in_normals = in_normals;
+  base_job.in_normals_stride = sizeof(float) * 3;
+  base_job.out_normals = out_normals;
+  base_job.out_normals_stride = sizeof(float) * 3;
+
+  { // No matrix.
+    SkinningJob job = base_job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Both matrix types.
+    SkinningJob job = base_job;
+    job.joint_matrices = matrices;
+    job.joint_matrices_4x3 = matrices_4x3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Invalid 4x3 matrices range.
+    SkinningJob job = base_job;
+    job.joint_matrices_4x3.begin = matrices_4x3 + 1;
+    job.joint_matrices_4x3.end = matrices_4x3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Mixed matrix types.
+    SkinningJob job = base_job;
+    job.joint_matrices = matrices;
+    job.joint_inverse_transpose_matrices_4x3 = matrices_4x3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Mixed matrix types.
+    SkinningJob job = base_job;
+    job.joint_matrices_4x3 = matrices_4x3;
+    job.joint_inverse_transpose_matrices = matrices;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid 4x3 job.
+    SkinningJob job = base_job;
+    job.joint_matrices_4x3 = matrices_4x3;
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Valid 4x3 job with inverse transpose matrices.
+    SkinningJob job = base_job;
+    job.joint_matrices_4x3 = matrices_4x3;
+    job.joint_inverse_transpose_matrices_4x3 = matrices_4x3;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(JobResult4x3, SkinningJob) {
+  const ozz::math::Float4x4 matrices[4] = {
+    ozz::math::Float4x4::FromEuler(
+      ozz::math::simd_float4::Load(.1f, .2f, .3f, 0.f)),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+    ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+    ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(-1.f, 2.f, 4.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .70710677f),
+      ozz::math::simd_float4::Load(1.f, 3.f, 2.f, 0.f))};
+  ozz::math::Float4x4 it_matrices[4];
+  ozz::math::Float4x3 matrices_4x3[4];
+  ozz::math::Float4x3 it_matrices_4x3[4];
+  for (int i = 0; i < 4; ++i) {
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+    matrices_4x3[i] = ozz::math::Float4x3::FromFloat4x4(matrices[i]);
+    it_matrices_4x3[i] = ozz::math::Float4x3::FromFloat4x4(it_matrices[i]);
+  }
+
+  uint16_t joint_indices[10] = {0, 1, 2, 3, 0, 3, 2, 1, 0, 3};
+  float joint_weights[8] = {.5f, .25f, .25f, .1f, .1f, .25f, .25f, .15f};
+  float in_positions[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  float in_normals[6] = {.1f, .2f, .3f, .4f, .5f, .6f};
+  float in_tangents[6] = {.01f, .02f, .03f, .04f, .05f, .06f};
+
+  // Compares every skinning variant output with the Float4x4 one.
+  for (int influences = 1; influences <= 5; ++influences) {
+    for (int attributes = 0; attributes < 3; ++attributes) {
+      for (int it = 0; it < 2; ++it) {
+        float out_positions[2][6];
+        float out_normals[2][6];
+        float out_tangents[2][6];
+        for (int affine = 0; affine < 2; ++affine) {
+          SkinningJob job;
+          job.vertex_count = 2;
+          job.influences_count = influences;
+          if (affine) {
+            job.joint_matrices_4x3 = matrices_4x3;
+            if (it) {
+              job.joint_inverse_transpose_matrices_4x3 = it_matrices_4x3;
+            }
+          } else {
+            job.joint_matrices = matrices;
+            if (it) {
+              job.joint_inverse_transpose_matrices = it_matrices;
+            }
+          }
+          job.joint_indices = joint_indices;
+          job.joint_indices_stride = sizeof(uint16_t) * 5;
+          job.joint_weights = joint_weights;
+          job.joint_weights_stride = sizeof(float) * 4;
+          job.in_positions = in_positions;
+          job.in_positions_stride = sizeof(float) * 3;
+          job.out_positions = out_positions[affine];
+          job.out_positions_stride = sizeof(float) * 3;
+          if (attributes > 0) {
+            job.in_normals = in_normals;
+            job.in_normals_stride = sizeof(float) * 3;
+            job.out_normals = out_normals[affine];
+            job.out_normals_stride = sizeof(float) * 3;
+          }
+          if (attributes > 1) {
+            job.in_tangents = in_tangents;
+            job.in_tangents_stride = sizeof(float) * 3;
+            job.out_tangents = out_tangents[affine];
+            job.out_tangents_stride = sizeof(float) * 3;
+          }
+          ASSERT_TRUE(job.Run());
+        }
+        for (int i = 0; i < 6; ++i) {
+          EXPECT_NEAR(out_positions[0][i], out_positions[1][i], 1e-5f);
+          if (attributes > 0) {
+            EXPECT_NEAR(out_normals[0][i], out_normals[1][i], 1e-5f);
+          }
+          if (attributes > 1) {
+            EXPECT_NEAR(out_tangents[0][i], out_tangents[1][i], 1e-5f);
+          }
+        }
+      }
+    }
+  }
+}
+
 struct BenchVertexIn {
   float pos[3];
   float normals[3];
@@ -1245,3 +1945,78 @@ TEST(Benchmark, SkinningJob) {
   allocator->Deallocate(in_vertices);
   allocator->Deallocate(out_vertices);
 }
+
+TEST(Stats, SkinningJob) {
+  // Counters are only updated if stats are enabled.
+#ifdef OZZ_HAS_STATS
+  const int enabled = 1;
+#else  // OZZ_HAS_STATS
+  const int enabled = 0;
+#endif  // OZZ_HAS_STATS
+
+  ozz::math::Float4x4 matrices[4] = {
+    ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity(),
+    ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+  uint16_t joint_indices[10] = {0, 1, 2, 3, 0, 3, 2, 1, 0, 3};
+  float joint_weights[8] = {.5f, .25f, .25f, .1f, .1f, .25f, .25f, .15f};
+  float in_positions[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  float in_normals[6] = {.1f, .2f, .3f, .4f, .5f, .6f};
+  float in_tangents[6] = {.01f, .02f, .03f, .04f, .05f, .06f};
+  float out_positions[6];
+  float out_normals[6];
+  float out_tangents[6];
+
+  SkinningJob::Stats stats;
+  for (int i = 0; i < SkinningJob::Stats::kMaxKernelInfluences; ++i) {
+    for (int j = 0; j < SkinningJob::Stats::kNumComponentKernels; ++j) {
+      EXPECT_EQ(stats.vertices[i][j], 0);
+    }
+  }
+
+  SkinningJob job;
+  EXPECT_TRUE(job.stats == NULL);
+  job.vertex_count = 2;
+  job.influences_count = 1;
+  job.joint_matrices = matrices;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 5;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float) * 4;
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.stats = &stats;
+
+  // Positions only, 1 influence.
+  EXPECT_TRUE(job.Run());
+  EXPECT_EQ(stats.vertices[0][0], 2 * enabled);
+
+  // Positions and normals, 2 influences.
+  job.influences_count = 2;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.out_normals = out_normals;
+  job.out_normals_stride = sizeof(float) * 3;
+  EXPECT_TRUE(job.Run());
+  EXPECT_EQ(stats.vertices[1][1], 2 * enabled);
+
+  // Positions, normals and tangents, 5 influences, accumulated twice.
+  job.influences_count = 5;
+  job.in_tangents = in_tangents;
+  job.in_tangents_stride = sizeof(float) * 3;
+  job.out_tangents = out_tangents;
+  job.out_tangents_stride = sizeof(float) * 3;
+  EXPECT_TRUE(job.Run());
+  EXPECT_TRUE(job.Run());
+  EXPECT_EQ(stats.vertices[4][2], 4 * enabled);
+
+  // Other kernels weren't used.
+  int total = 0;
+  for (int i = 0; i < SkinningJob::Stats::kMaxKernelInfluences; ++i) {
+    for (int j = 0; j < SkinningJob::Stats::kNumComponentKernels; ++j) {
+      total += stats.vertices[i][j];
+    }
+  }
+  EXPECT_EQ(total, 8 * enabled);
+}
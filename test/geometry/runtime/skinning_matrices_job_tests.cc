@@ -0,0 +1,173 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/skinning_matrices_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::geometry::SkinningMatricesJob;
+using ozz::math::Float4x4;
+
+TEST(JobValidity, SkinningMatricesJob) {
+  const Float4x4 models[3] = {
+    Float4x4::identity(), Float4x4::identity(), Float4x4::identity()};
+  const Float4x4 inverse_binds[2] = {
+    Float4x4::identity(), Float4x4::identity()};
+  const uint16_t remaps[2] = {2, 0};
+  const uint16_t invalid_remaps[2] = {3, 0};
+  Float4x4 output[2];
+  Float4x4 it_output[2];
+
+  { // Default is invalid.
+    SkinningMatricesJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Missing output.
+    SkinningMatricesJob job;
+    job.model_matrices = models;
+    job.inverse_bind_poses = inverse_binds;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid without remaps.
+    SkinningMatricesJob job;
+    job.model_matrices = models;
+    job.inverse_bind_poses = inverse_binds;
+    job.skinning_matrices = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Not enough models without remaps.
+    job.model_matrices.end = models + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Remaps.
+    SkinningMatricesJob job;
+    job.model_matrices = models;
+    job.inverse_bind_poses = inverse_binds;
+    job.skinning_matrices = output;
+    job.joint_remaps = remaps;
+    EXPECT_TRUE(job.Validate());
+
+    // Out of range remap.
+    job.joint_remaps = invalid_remaps;
+    EXPECT_FALSE(job.Validate());
+
+    // Remaps count must match inverse bind poses.
+    job.joint_remaps = ozz::Range<const uint16_t>(remaps, 1);
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Output too small.
+    SkinningMatricesJob job;
+    job.model_matrices = models;
+    job.inverse_bind_poses = inverse_binds;
+    job.skinning_matrices = ozz::Range<Float4x4>(output, 1);
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Inverse transpose output too small.
+    SkinningMatricesJob job;
+    job.model_matrices = models;
+    job.inverse_bind_poses = inverse_binds;
+    job.skinning_matrices = output;
+    job.inverse_transpose_matrices = ozz::Range<Float4x4>(it_output, 1);
+    EXPECT_FALSE(job.Validate());
+    job.inverse_transpose_matrices = it_output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Empty palette is valid.
+    SkinningMatricesJob job;
+    job.model_matrices = models;
+    job.inverse_bind_poses =
+      ozz::Range<const Float4x4>(inverse_binds, inverse_binds);
+    job.skinning_matrices = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(JobResult, SkinningMatricesJob) {
+  const Float4x4 models[3] = {
+    Float4x4::Translation(ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+    Float4x4::Scaling(ozz::math::simd_float4::Load(2.f, 4.f, 8.f, 0.f)),
+    Float4x4::Translation(ozz::math::simd_float4::Load(-1.f, 0.f, 5.f, 0.f))};
+  const Float4x4 inverse_binds[2] = {
+    Float4x4::Scaling(ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 0.f)),
+    Float4x4::Translation(ozz::math::simd_float4::Load(0.f, -2.f, 0.f, 0.f))};
+  const uint16_t remaps[2] = {2, 1};
+
+  { // Without remaps.
+    Float4x4 output[2];
+    SkinningMatricesJob job;
+    job.model_matrices = models;
+    job.inverse_bind_poses = inverse_binds;
+    job.skinning_matrices = output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT4x4_EQ(output[0], 2.f, 0.f, 0.f, 0.f,
+                                  0.f, 2.f, 0.f, 0.f,
+                                  0.f, 0.f, 2.f, 0.f,
+                                  1.f, 2.f, 3.f, 1.f);
+    EXPECT_FLOAT4x4_EQ(output[1], 2.f, 0.f, 0.f, 0.f,
+                                  0.f, 4.f, 0.f, 0.f,
+                                  0.f, 0.f, 8.f, 0.f,
+                                  0.f, -8.f, 0.f, 1.f);
+  }
+  { // With remaps and inverse transposes.
+    Float4x4 output[2];
+    Float4x4 it_output[2];
+    SkinningMatricesJob job;
+    job.model_matrices = models;
+    job.inverse_bind_poses = inverse_binds;
+    job.joint_remaps = remaps;
+    job.skinning_matrices = output;
+    job.inverse_transpose_matrices = it_output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT4x4_EQ(output[0], 2.f, 0.f, 0.f, 0.f,
+                                  0.f, 2.f, 0.f, 0.f,
+                                  0.f, 0.f, 2.f, 0.f,
+                                  -1.f, 0.f, 5.f, 1.f);
+    EXPECT_FLOAT4x4_EQ(output[1], 2.f, 0.f, 0.f, 0.f,
+                                  0.f, 4.f, 0.f, 0.f,
+                                  0.f, 0.f, 8.f, 0.f,
+                                  0.f, -8.f, 0.f, 1.f);
+    EXPECT_FLOAT4x4_EQ(it_output[0], .5f, 0.f, 0.f, .5f,
+                                     0.f, .5f, 0.f, 0.f,
+                                     0.f, 0.f, .5f, -2.5f,
+                                     0.f, 0.f, 0.f, 1.f);
+    EXPECT_FLOAT4x4_EQ(it_output[1], .5f, 0.f, 0.f, 0.f,
+                                     0.f, .25f, 0.f, 2.f,
+                                     0.f, 0.f, .125f, 0.f,
+                                     0.f, 0.f, 0.f, 1.f);
+  }
+}
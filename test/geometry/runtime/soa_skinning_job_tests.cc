@@ -0,0 +1,295 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/soa_skinning_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::SoaSkinningJob;
+using ozz::geometry::SkinningJob;
+
+namespace {
+// Sets stream _s components to _x, _y and _z arrays of _count elements.
+template <typename _Stream, typename _Ty>
+void SetStream(_Stream* _s, _Ty* _x, _Ty* _y, _Ty* _z, int _count) {
+  _s->x.begin = _x;
+  _s->x.end = _x + _count;
+  _s->y.begin = _y;
+  _s->y.end = _y + _count;
+  _s->z.begin = _z;
+  _s->z.end = _z + _count;
+}
+}  // namespace
+
+TEST(JobValidity, SoaSkinningJob) {
+
+  ozz::math::Float4x4 matrices[2];
+  uint16_t joint_indices[8];
+  float joint_weights[6];
+  float in[3][9][2];
+  float out[3][9][2];
+
+  { // Default is invalid.
+    SoaSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid job with 0 vertex.
+    SoaSkinningJob job;
+    job.vertex_count = 0;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t);
+    SetStream(&job.in_positions, in[0][0], in[0][1], in[0][2], 0);
+    SetStream(&job.out_positions, out[0][0], out[0][1], out[0][2], 0);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Invalid job with 0 influence.
+    SoaSkinningJob job;
+    job.vertex_count = 0;
+    job.influences_count = 0;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t);
+    SetStream(&job.in_positions, in[0][0], in[0][1], in[0][2], 0);
+    SetStream(&job.out_positions, out[0][0], out[0][1], out[0][2], 0);
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Valid job with 1 influence and 2 vertices.
+    SoaSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t);
+    SetStream(&job.in_positions, in[0][0], in[0][1], in[0][2], 2);
+    SetStream(&job.out_positions, out[0][0], out[0][1], out[0][2], 2);
+    EXPECT_TRUE(job.Validate());
+
+    // Invalid with a stream that is too small.
+    job.in_positions.y.end = job.in_positions.y.begin + 1;
+    EXPECT_FALSE(job.Validate());
+    job.in_positions.y.end = job.in_positions.y.begin + 2;
+
+    // Invalid with a missing output stream component.
+    job.out_positions.z.begin = NULL;
+    EXPECT_FALSE(job.Validate());
+    job.out_positions.z.begin = out[0][2];
+
+    // Invalid with indices buffer too small.
+    job.joint_indices.end = joint_indices + 1;
+    EXPECT_FALSE(job.Validate());
+    job.joint_indices.end = joint_indices + 2;
+
+    // Invalid with tangents but no normals.
+    SetStream(&job.in_tangents, in[2][0], in[2][1], in[2][2], 2);
+    SetStream(&job.out_tangents, out[2][0], out[2][1], out[2][2], 2);
+    EXPECT_FALSE(job.Validate());
+
+    // Valid with normals and tangents.
+    SetStream(&job.in_normals, in[1][0], in[1][1], in[1][2], 2);
+    SetStream(&job.out_normals, out[1][0], out[1][1], out[1][2], 2);
+    EXPECT_TRUE(job.Validate());
+
+    // Invalid without output normals.
+    job.out_normals.x.begin = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Weights are required with 2 influences.
+    SoaSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 2;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 2;
+    SetStream(&job.in_positions, in[0][0], in[0][1], in[0][2], 2);
+    SetStream(&job.out_positions, out[0][0], out[0][1], out[0][2], 2);
+    EXPECT_FALSE(job.Validate());
+
+    job.joint_weights = joint_weights;
+    job.joint_weights_stride = sizeof(float);
+    EXPECT_TRUE(job.Validate());
+
+    // Invalid with weights buffer too small.
+    job.joint_weights.end = joint_weights + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+// Compares SoaSkinningJob results with SkinningJob ones, for all influences
+// counts, attributes and remaining vertex counts.
+TEST(JobResult, SoaSkinningJob) {
+  const int kMaxVertices = 19;
+  const int kMaxInfluences = 5;
+  const int kJoints = 4;
+
+  // Builds joint matrices with non uniform scales.
+  ozz::math::Float4x4 matrices[kJoints];
+  ozz::math::Float4x4 it_matrices[kJoints];
+  for (int i = 0; i < kJoints; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+      ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(f, -f * 2.f, 3.f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(
+        ozz::math::simd_float4::Load(0.f, 1.f, 0.f, f * .7f)) *
+      ozz::math::Float4x4::Scaling(
+        ozz::math::simd_float4::Load(1.f + f, 2.f, 1.f + f * .5f, 1.f));
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+  }
+
+  // Builds per vertex AoS and SoA attributes, indices and weights. The first
+  // vertices share the same joints, to exercise broadcast code path.
+  uint16_t indices[kMaxVertices][kMaxInfluences];
+  float weights[kMaxVertices][kMaxInfluences];
+  float aos_in[3][kMaxVertices][3];
+  float soa_in[3][3][kMaxVertices];
+  for (int v = 0; v < kMaxVertices; ++v) {
+    for (int j = 0; j < kMaxInfluences; ++j) {
+      indices[v][j] = static_cast<uint16_t>(v < 8 ? j % kJoints :
+                                             (v * 7 + j * 3) % kJoints);
+      weights[v][j] = .1f + .05f * ((v + j) % 3);
+    }
+    for (int a = 0; a < 3; ++a) {
+      for (int c = 0; c < 3; ++c) {
+        const float value = (v + 1) * (c - 1.f) * .3f + a;
+        aos_in[a][v][c] = value;
+        soa_in[a][c][v] = value;
+      }
+    }
+  }
+
+  const ozz::Range<const uint16_t> indices_range(
+    indices[0], kMaxVertices * kMaxInfluences);
+  const ozz::Range<const float> weights_range(
+    weights[0], kMaxVertices * kMaxInfluences);
+  ozz::Range<const float> aos_in_ranges[3];
+  for (int a = 0; a < 3; ++a) {
+    aos_in_ranges[a] = ozz::Range<const float>(aos_in[a][0], kMaxVertices * 3);
+  }
+
+  for (int it = 0; it < 2; ++it) {
+    for (int influences = 1; influences <= kMaxInfluences; ++influences) {
+      for (int attributes = 1; attributes <= 3; ++attributes) {
+        for (int count = 0; count <= kMaxVertices; ++count) {
+          float aos_out[3][kMaxVertices][3];
+          float soa_out[3][3][kMaxVertices];
+          ozz::Range<float> aos_out_ranges[3];
+          for (int a = 0; a < 3; ++a) {
+            aos_out_ranges[a] =
+              ozz::Range<float>(aos_out[a][0], kMaxVertices * 3);
+          }
+
+          SkinningJob aos_job;
+          aos_job.vertex_count = count;
+          aos_job.influences_count = influences;
+          aos_job.joint_matrices = matrices;
+          aos_job.joint_indices = indices_range;
+          aos_job.joint_indices_stride = sizeof(indices[0]);
+          aos_job.joint_weights = weights_range;
+          aos_job.joint_weights_stride = sizeof(weights[0]);
+          aos_job.in_positions = aos_in_ranges[0];
+          aos_job.in_positions_stride = sizeof(aos_in[0][0]);
+          aos_job.out_positions = aos_out_ranges[0];
+          aos_job.out_positions_stride = sizeof(aos_out[0][0]);
+
+          SoaSkinningJob soa_job;
+          soa_job.vertex_count = count;
+          soa_job.influences_count = influences;
+          soa_job.joint_matrices = matrices;
+          soa_job.joint_indices = indices_range;
+          soa_job.joint_indices_stride = sizeof(indices[0]);
+          soa_job.joint_weights = weights_range;
+          soa_job.joint_weights_stride = sizeof(weights[0]);
+          SetStream(&soa_job.in_positions, soa_in[0][0], soa_in[0][1],
+                    soa_in[0][2], count);
+          SetStream(&soa_job.out_positions, soa_out[0][0], soa_out[0][1],
+                    soa_out[0][2], count);
+
+          if (it) {
+            aos_job.joint_inverse_transpose_matrices = it_matrices;
+            soa_job.joint_inverse_transpose_matrices = it_matrices;
+          }
+          if (attributes > 1) {
+            aos_job.in_normals = aos_in_ranges[1];
+            aos_job.in_normals_stride = sizeof(aos_in[1][0]);
+            aos_job.out_normals = aos_out_ranges[1];
+            aos_job.out_normals_stride = sizeof(aos_out[1][0]);
+            SetStream(&soa_job.in_normals, soa_in[1][0], soa_in[1][1],
+                      soa_in[1][2], count);
+            SetStream(&soa_job.out_normals, soa_out[1][0], soa_out[1][1],
+                      soa_out[1][2], count);
+          }
+          if (attributes > 2) {
+            aos_job.in_tangents = aos_in_ranges[2];
+            aos_job.in_tangents_stride = sizeof(aos_in[2][0]);
+            aos_job.out_tangents = aos_out_ranges[2];
+            aos_job.out_tangents_stride = sizeof(aos_out[2][0]);
+            SetStream(&soa_job.in_tangents, soa_in[2][0], soa_in[2][1],
+                      soa_in[2][2], count);
+            SetStream(&soa_job.out_tangents, soa_out[2][0], soa_out[2][1],
+                      soa_out[2][2], count);
+          }
+
+          // Canary values ensure nothing is written beyond vertex_count.
+          for (int a = 0; a < 3; ++a) {
+            for (int c = 0; c < 3; ++c) {
+              for (int v = 0; v < kMaxVertices; ++v) {
+                soa_out[a][c][v] = 46.f;
+              }
+            }
+          }
+
+          ASSERT_TRUE(aos_job.Run());
+          ASSERT_TRUE(soa_job.Run());
+
+          for (int a = 0; a < attributes; ++a) {
+            for (int v = 0; v < kMaxVertices; ++v) {
+              for (int c = 0; c < 3; ++c) {
+                if (v < count) {
+                  EXPECT_NEAR(soa_out[a][c][v], aos_out[a][v][c], 1e-4f);
+                } else {
+                  EXPECT_EQ(soa_out[a][c][v], 46.f);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,303 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/geometry/runtime/streamed_skinning_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::StreamedSkinningJob;
+
+namespace {
+// Decodes an octahedral packed vector.
+void Unpack(uint32_t _packed, float _v[3]) {
+  float x = static_cast<int16_t>(_packed & 0xffff) / 32767.f;
+  float y = static_cast<int16_t>(_packed >> 16) / 32767.f;
+  const float z = 1.f - std::abs(x) - std::abs(y);
+  if (z < 0.f) {
+    const float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+    const float fy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+    x = fx;
+    y = fy;
+  }
+  const float len = std::sqrt(x * x + y * y + z * z);
+  _v[0] = x / len;
+  _v[1] = y / len;
+  _v[2] = z / len;
+}
+
+// Reads uint32_t at _offset bytes of _buffer.
+uint32_t ReadU32(const float* _buffer, size_t _offset) {
+  uint32_t u;
+  memcpy(&u, reinterpret_cast<const char*>(_buffer) + _offset, sizeof(u));
+  return u;
+}
+}  // namespace
+
+TEST(JobValidity, StreamedSkinningJob) {
+  const ozz::math::Float4x4 matrices[2] = {ozz::math::Float4x4::identity(),
+                                           ozz::math::Float4x4::identity()};
+  const uint16_t joint_indices[4] = {0, 1, 0, 1};
+  const float joint_weights[2] = {.5f, .5f};
+  const float in_positions[6] = {0.f};
+  const float in_normals[6] = {0.f};
+  const float in_tangents[6] = {0.f};
+  ozz::math::SimdFloat4 out_buffer[4];
+  float* out_vertices = reinterpret_cast<float*>(out_buffer);
+
+  { // Default is invalid.
+    StreamedSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid job, positions only.
+    StreamedSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 2;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 2;
+    job.joint_weights = joint_weights;
+    job.joint_weights_stride = sizeof(float);
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_vertices = ozz::Range<float>(out_vertices, 8);
+    EXPECT_EQ(job.vertex_size(), 16u);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Not enough output.
+    job.out_vertices = ozz::Range<float>(out_vertices, 7);
+    EXPECT_FALSE(job.Validate());
+
+    // Unaligned output.
+    job.out_vertices = ozz::Range<float>(out_vertices + 1, 8);
+    EXPECT_FALSE(job.Validate());
+
+    // No output.
+    job.out_vertices = ozz::Range<float>();
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Valid job with normals and tangents.
+    StreamedSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t);
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.in_tangents = in_tangents;
+    job.in_tangents_stride = sizeof(float) * 3;
+    job.out_vertices = ozz::Range<float>(out_vertices, 16);
+    EXPECT_EQ(job.vertex_size(), 32u);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Tangent vertices are bigger.
+    job.out_vertices = ozz::Range<float>(out_vertices, 8);
+    EXPECT_FALSE(job.Validate());
+    job.out_vertices = ozz::Range<float>(out_vertices, 16);
+
+    // Not enough tangents.
+    job.in_tangents = ozz::Range<const float>(in_tangents, 5);
+    EXPECT_FALSE(job.Validate());
+
+    // Tangents require normals.
+    job.in_tangents = in_tangents;
+    job.in_normals = ozz::Range<const float>();
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Missing weights.
+    StreamedSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 2;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 2;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_vertices = ozz::Range<float>(out_vertices, 8);
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid influences count.
+    StreamedSkinningJob job;
+    job.vertex_count = 2;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_vertices = ozz::Range<float>(out_vertices, 8);
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Empty job is valid.
+    StreamedSkinningJob job;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_vertices = ozz::Range<float>(out_vertices, 8);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Positions, StreamedSkinningJob) {
+  const ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+    ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 0.f))};
+  const uint16_t joint_indices[6] = {0, 1, 1, 0, 0, 1};
+  const float joint_weights[3] = {1.f, .5f, 0.f};
+  const float in_positions[9] = {1.f, 1.f, 1.f,
+                                 2.f, 0.f, 0.f,
+                                 0.f, -1.f, 1.f};
+  ozz::math::SimdFloat4 out_buffer[3];
+  float* out_vertices = reinterpret_cast<float*>(out_buffer);
+
+  StreamedSkinningJob job;
+  job.vertex_count = 3;
+  job.influences_count = 2;
+  job.joint_matrices = matrices;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_vertices = ozz::Range<float>(out_vertices, 12);
+  ASSERT_TRUE(job.Run());
+
+  const float expected[12] = {2.f, 3.f, 4.f, 1.f,
+                              3.5f, 1.f, 1.5f, 1.f,
+                              0.f, -2.f, 2.f, 1.f};
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_FLOAT_EQ(out_vertices[i], expected[i]);
+  }
+}
+
+TEST(NormalsTangents, StreamedSkinningJob) {
+  const float kSqrt2_2 = .7071067f;
+  const ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 1.f)),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f))};
+  const uint16_t joint_indices[8] = {0, 1, 1, 0, 0, 1, 1, 0};
+  const float joint_weights[4] = {1.f, .3f, .6f, 0.f};
+  const float in_positions[12] = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                                  0.f, 0.f, 1.f, 1.f, 1.f, 1.f};
+  const float in_normals[12] = {0.f, 0.f, 1.f, 0.f, 0.f, -1.f,
+                                kSqrt2_2, kSqrt2_2, 0.f, -1.f, 0.f, 0.f};
+  const float in_tangents[12] = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                                 -kSqrt2_2, 0.f, -kSqrt2_2, 0.f, 0.f, -1.f};
+  ozz::math::SimdFloat4 out_buffer[8];
+  float* out_vertices = reinterpret_cast<float*>(out_buffer);
+
+  StreamedSkinningJob job;
+  job.vertex_count = 4;
+  job.influences_count = 2;
+  job.joint_matrices = matrices;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.in_tangents = in_tangents;
+  job.in_tangents_stride = sizeof(float) * 3;
+  job.out_vertices = ozz::Range<float>(out_vertices, 32);
+  ASSERT_TRUE(job.Run());
+
+  // Computes reference results with the SkinningJob.
+  float ref_positions[12];
+  float ref_normals[12];
+  float ref_tangents[12];
+  ozz::geometry::SkinningJob ref;
+  ref.vertex_count = 4;
+  ref.influences_count = 2;
+  ref.joint_matrices = matrices;
+  ref.joint_indices = joint_indices;
+  ref.joint_indices_stride = sizeof(uint16_t) * 2;
+  ref.joint_weights = joint_weights;
+  ref.joint_weights_stride = sizeof(float);
+  ref.in_positions = in_positions;
+  ref.in_positions_stride = sizeof(float) * 3;
+  ref.in_normals = in_normals;
+  ref.in_normals_stride = sizeof(float) * 3;
+  ref.in_tangents = in_tangents;
+  ref.in_tangents_stride = sizeof(float) * 3;
+  ref.out_positions = ref_positions;
+  ref.out_positions_stride = sizeof(float) * 3;
+  ref.out_normals = ref_normals;
+  ref.out_normals_stride = sizeof(float) * 3;
+  ref.out_tangents = ref_tangents;
+  ref.out_tangents_stride = sizeof(float) * 3;
+  ASSERT_TRUE(ref.Run());
+
+  for (int i = 0; i < 4; ++i) {
+    const float* vertex = out_vertices + i * 8;
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(vertex[j], ref_positions[i * 3 + j], 1e-5f);
+    }
+
+    float normal[3];
+    Unpack(ReadU32(vertex, 12), normal);
+    float tangent[3];
+    Unpack(ReadU32(vertex, 16), tangent);
+    // Blended matrices don't preserve length, packed vectors are normalized.
+    const float* ref_n = ref_normals + i * 3;
+    const float* ref_t = ref_tangents + i * 3;
+    const float ref_n_len = std::sqrt(
+      ref_n[0] * ref_n[0] + ref_n[1] * ref_n[1] + ref_n[2] * ref_n[2]);
+    const float ref_t_len = std::sqrt(
+      ref_t[0] * ref_t[0] + ref_t[1] * ref_t[1] + ref_t[2] * ref_t[2]);
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(normal[j], ref_n[j] / ref_n_len, 1e-3f);
+      EXPECT_NEAR(tangent[j], ref_t[j] / ref_t_len, 1e-3f);
+    }
+
+    // Padding is zeroed.
+    EXPECT_EQ(ReadU32(vertex, 20), 0u);
+    EXPECT_EQ(ReadU32(vertex, 24), 0u);
+    EXPECT_EQ(ReadU32(vertex, 28), 0u);
+  }
+}
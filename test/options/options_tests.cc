@@ -30,6 +30,10 @@
 
 #include "ozz/options/options.h"
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
 #include "ozz/base/platform.h"
 
 #include "ozz/base/containers/vector.h"
@@ -844,5 +848,135 @@ TEST(ParseString, Options) {
   }
 }
 
+TEST(PrefixNames, Options) {
+  // Options whose names are prefixes of each other, or start with "no".
+  ozz::options::BoolOption b("b", "", false, false);
+  ozz::options::IntOption bb("bb", "", 0, false);
+  ozz::options::BoolOption nob("nob", "", false, false);
+
+  ozz::options::Parser parser;
+  EXPECT_TRUE(parser.RegisterOption(&b));
+  EXPECT_TRUE(parser.RegisterOption(&bb));
+  EXPECT_TRUE(parser.RegisterOption(&nob));
+
+  EXPECT_FLAG_VALID(parser, "--bb=46");
+  EXPECT_EQ(bb, 46);
+  EXPECT_FALSE(b);
+  EXPECT_FLAG_VALID(parser, "--nob");
+  EXPECT_TRUE(nob);
+  EXPECT_FALSE(b);
+  EXPECT_FLAG_VALID(parser, "--NOB=false");
+  EXPECT_FALSE(nob);
+  EXPECT_FLAG_VALID(parser, "--nonob");
+  EXPECT_FALSE(nob);
+  EXPECT_FLAG_INVALID(parser, "--nobb=46");
+  EXPECT_FLAG_INVALID(parser, "--=46");
+  EXPECT_FLAG_INVALID(parser, "--bbb=46");
+
+  EXPECT_FALSE(parser.UnregisterOption(&b));
+  EXPECT_FALSE(parser.UnregisterOption(&nob));
+  EXPECT_TRUE(parser.UnregisterOption(&bb));
+}
+
+TEST(ManyOptions, Options) {
+  ozz::options::Parser parser;
+  EXPECT_GE(parser.max_options(), 256);
+
+  // Needs to pre-allocate vectors to avoid objects to move in memory.
+  const int kCount = 256;
+  ozz::Vector<ozz::options::IntOption>::Std options;
+  options.reserve(kCount);
+  ozz::Vector<ozz::String::Std>::Std names;
+  names.reserve(kCount);
+  ozz::Vector<ozz::String::Std>::Std arguments;
+  arguments.reserve(kCount);
+  for (int i = 0; i < kCount; ++i) {
+    std::stringstream name;
+    name << "option" << i;
+    names.push_back(name.str().c_str());
+    options.push_back(
+      ozz::options::IntOption(names[i].c_str(), NULL, -1, false));
+    EXPECT_TRUE(parser.RegisterOption(&options.back()));
+
+    std::stringstream argument;
+    argument << "--" << name.str() << "=" << i * 2;
+    arguments.push_back(argument.str().c_str());
+  }
+
+  // Sets every other option.
+  ozz::Vector<const char*>::Std argv;
+  argv.push_back("c:/a path/test.exe");
+  for (int i = 0; i < kCount; i += 2) {
+    argv.push_back(arguments[i].c_str());
+  }
+  EXPECT_EQ(parser.Parse(static_cast<int>(argv.size()), &argv[0]),
+            ozz::options::kSuccess);
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_EQ(options[i], i % 2 ? -1 : i * 2);
+  }
+
+  // Unregistration keeps other options reachable.
+  for (int i = 0; i < kCount; i += 2) {
+    EXPECT_FALSE(parser.UnregisterOption(&options[i]));
+  }
+  EXPECT_FLAG_INVALID(parser, arguments[0].c_str());
+  EXPECT_FLAG_VALID(parser, arguments[kCount - 1].c_str());
+  EXPECT_EQ(options[kCount - 1], (kCount - 1) * 2);
+
+  for (int i = 1; i < kCount; i += 2) {
+    EXPECT_EQ(parser.UnregisterOption(&options[i]), i == kCount - 1);
+  }
+}
+
+TEST(ResponseFile, Options) {
+  ozz::options::BoolOption bool_option("bool", "", false, false);
+  ozz::options::IntOption int_option("int", "", 27, false);
+  ozz::options::StringOption string_option("string", "", "twenty six", false);
+
+  ozz::options::Parser parser;
+  EXPECT_TRUE(parser.RegisterOption(&bool_option));
+  EXPECT_TRUE(parser.RegisterOption(&int_option));
+  EXPECT_TRUE(parser.RegisterOption(&string_option));
+
+  const char* filename = "options_response_file.txt";
+  {
+    std::ofstream file(filename);
+    file << "--bool\n  --string=\"forty six\"\t\n";
+  }
+
+  { // Response file arguments are inserted in place.
+    const char* argv[] = {"c:/a path/test.exe", "@options_response_file.txt",
+                          "--int=46"};
+    const int argc = OZZ_ARRAY_SIZE(argv);
+    EXPECT_EQ(parser.Parse(argc, argv), ozz::options::kSuccess);
+    EXPECT_TRUE(bool_option);
+    EXPECT_EQ(int_option, 46);
+    EXPECT_STREQ(string_option, "forty six");
+  }
+
+  { // Arguments are still duplicated.
+    const char* argv[] = {"c:/a path/test.exe", "@options_response_file.txt",
+                          "--bool"};
+    const int argc = OZZ_ARRAY_SIZE(argv);
+    EXPECT_EQ_LOG(parser.Parse(argc, argv), ozz::options::kExitFailure,
+                  std::cout, "Usage");
+  }
+
+  { // "--" hides response files.
+    const char* argv[] = {"c:/a path/test.exe", "--",
+                          "@options_response_file.txt"};
+    const int argc = OZZ_ARRAY_SIZE(argv);
+    EXPECT_EQ(parser.Parse(argc, argv), ozz::options::kSuccess);
+    EXPECT_FALSE(bool_option);
+  }
+
+  std::remove(filename);
+  EXPECT_FLAG_INVALID(parser, "@options_response_file.txt");
+
+  EXPECT_FALSE(parser.UnregisterOption(&bool_option));
+  EXPECT_FALSE(parser.UnregisterOption(&string_option));
+  EXPECT_TRUE(parser.UnregisterOption(&int_option));
+}
+
 #undef EXPECT_FLAG_INVALID
 #undef EXPECT_FLAG_VALID